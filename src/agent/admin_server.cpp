@@ -0,0 +1,573 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the UNIX-domain socket answering admin commands.
+ */
+
+#include "admin_server.hpp"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+AdminServer::AdminServer(Reactor &aReactor)
+    : mReactor(aReactor)
+    , mFd(-1)
+    , mCommandCount(0)
+{
+    for (int i = 0; i < kMaxConnections; ++i)
+    {
+        mConnections[i].mServer = this;
+        mConnections[i].mFd     = -1;
+    }
+}
+
+AdminServer::~AdminServer(void)
+{
+    Stop();
+}
+
+otbrError AdminServer::AddCommand(const char *aName, const char *aHelp, CommandHandler aHandler, void *aContext)
+{
+    otbrError error = OTBR_ERROR_NONE;
+    Command * command;
+
+    VerifyOrExit(mCommandCount < kMaxCommands, error = OTBR_ERROR_ERRNO, errno = ENOMEM);
+
+    command           = &mCommands[mCommandCount++];
+    command->mName    = aName;
+    command->mHelp    = aHelp;
+    command->mHandler = aHandler;
+    command->mContext = aContext;
+
+exit:
+    return error;
+}
+
+otbrError AdminServer::Start(const char *aPath)
+{
+    otbrError   error = OTBR_ERROR_ERRNO;
+    sockaddr_un sun;
+
+    memset(&sun, 0, sizeof(sun));
+    sun.sun_family = AF_UNIX;
+    VerifyOrExit(strlen(aPath) < sizeof(sun.sun_path), errno = ENAMETOOLONG);
+    strcpy(sun.sun_path, aPath);
+
+    VerifyOrExit((mFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) >= 0);
+
+    // A socket file left by an agent that did not stop cleanly would fail the bind.
+    VerifyOrExit(unlink(aPath) == 0 || errno == ENOENT);
+    VerifyOrExit(bind(mFd, reinterpret_cast<sockaddr *>(&sun), sizeof(sun)) == 0);
+    mPath = aPath;
+    VerifyOrExit(chmod(aPath, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP) == 0);
+    VerifyOrExit(listen(mFd, kMaxConnections) == 0);
+    SuccessOrExit(mReactor.Add(mWatch, mFd, Reactor::kEventReadable, HandleAccept, this, "admin"));
+
+    otbrLog(OTBR_LOG_INFO, "Admin commands served on %s", aPath);
+    error = OTBR_ERROR_NONE;
+
+exit:
+    if (error != OTBR_ERROR_NONE && mFd >= 0)
+    {
+        int saved = errno;
+
+        close(mFd);
+        mFd = -1;
+
+        if (!mPath.empty())
+        {
+            unlink(mPath.c_str());
+            mPath.clear();
+        }
+
+        errno = saved;
+    }
+
+    return error;
+}
+
+void AdminServer::Stop(void)
+{
+    for (int i = 0; i < kMaxConnections; ++i)
+    {
+        if (mConnections[i].mFd >= 0)
+        {
+            Close(mConnections[i]);
+        }
+    }
+
+    VerifyOrExit(mFd >= 0);
+
+    mReactor.Remove(mWatch);
+    close(mFd);
+    mFd = -1;
+    unlink(mPath.c_str());
+    mPath.clear();
+
+exit:
+    return;
+}
+
+void AdminServer::Print(std::string &aOutput, const char *aFormat, ...)
+{
+    char    buffer[256];
+    va_list args;
+    int     length;
+
+    va_start(args, aFormat);
+    length = vsnprintf(buffer, sizeof(buffer), aFormat, args);
+    va_end(args);
+
+    VerifyOrExit(length >= 0);
+
+    if (static_cast<size_t>(length) < sizeof(buffer))
+    {
+        aOutput.append(buffer, static_cast<size_t>(length));
+    }
+    else
+    {
+        // Rare long lines are formatted again in place.
+        size_t offset = aOutput.size();
+
+        aOutput.resize(offset + static_cast<size_t>(length) + 1);
+        va_start(args, aFormat);
+        vsnprintf(&aOutput[offset], static_cast<size_t>(length) + 1, aFormat, args);
+        va_end(args);
+        aOutput.resize(offset + static_cast<size_t>(length));
+    }
+
+exit:
+    return;
+}
+
+void AdminServer::PrintMetrics(std::string &aOutput, const char *aPrefix)
+{
+    size_t prefixLength = strlen(aPrefix);
+
+    for (const Metrics::Metric *metric = Metrics::Metric::GetFirst(); metric != NULL; metric = metric->GetNext())
+    {
+        if (strncmp(metric->GetName(), aPrefix, prefixLength) != 0)
+        {
+            continue;
+        }
+
+        if (metric->GetType() == Metrics::Metric::kTypeCounter)
+        {
+            const Metrics::Counter &counter = *static_cast<const Metrics::Counter *>(metric);
+
+            Print(aOutput, "%s %llu\n", metric->GetName(), static_cast<unsigned long long>(counter.GetValue()));
+        }
+        else if (metric->GetType() == Metrics::Metric::kTypeGauge)
+        {
+            Print(aOutput, "%s %lld\n", metric->GetName(),
+                  static_cast<long long>(static_cast<const Metrics::Gauge *>(metric)->GetValue()));
+        }
+        else if (metric->GetType() == Metrics::Metric::kTypeMemory)
+        {
+            const Metrics::Memory &memory = *static_cast<const Metrics::Memory *>(metric);
+
+            Print(aOutput, "%s bytes=%llu blocks=%llu peak=%llu\n", metric->GetName(),
+                  static_cast<unsigned long long>(memory.GetValue()),
+                  static_cast<unsigned long long>(memory.GetBlocks()),
+                  static_cast<unsigned long long>(memory.GetPeak()));
+        }
+        else
+        {
+            const Metrics::Histogram &histogram = *static_cast<const Metrics::Histogram *>(metric);
+
+            Print(aOutput, "%s count=%llu sum=%llu p50=%llu p90=%llu p99=%llu max=%llu\n", metric->GetName(),
+                  static_cast<unsigned long long>(histogram.GetCount()),
+                  static_cast<unsigned long long>(histogram.GetSum()),
+                  static_cast<unsigned long long>(histogram.GetPercentile(50)),
+                  static_cast<unsigned long long>(histogram.GetPercentile(90)),
+                  static_cast<unsigned long long>(histogram.GetPercentile(99)),
+                  static_cast<unsigned long long>(histogram.GetPercentile(100)));
+        }
+    }
+}
+
+void AdminServer::HandleAccept(void *aContext, int aFd, unsigned int aEvents)
+{
+    (void)aFd;
+    (void)aEvents;
+
+    static_cast<AdminServer *>(aContext)->HandleAccept();
+}
+
+void AdminServer::HandleAccept(void)
+{
+    uint64_t    now        = GetMonotonicNow();
+    Connection *connection = NULL;
+    int         fd;
+
+    VerifyOrExit((fd = accept4(mFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0);
+
+    // Idle connections are evicted to make room, so that forgotten clients cannot lock the socket.
+    for (int i = 0; i < kMaxConnections && connection == NULL; ++i)
+    {
+        if (mConnections[i].mFd < 0)
+        {
+            connection = &mConnections[i];
+        }
+        else if (now - mConnections[i].mLastActivity >= kIdleTimeout)
+        {
+            Close(mConnections[i]);
+            connection = &mConnections[i];
+        }
+    }
+
+    VerifyOrExit(connection != NULL, close(fd), otbrLog(OTBR_LOG_WARNING, "Too many admin connections"));
+
+    if (mReactor.Add(connection->mWatch, fd, Reactor::kEventReadable, HandleConnection, connection, "admin") !=
+        OTBR_ERROR_NONE)
+    {
+        close(fd);
+        ExitNow();
+    }
+
+    connection->mFd            = fd;
+    connection->mLastActivity  = now;
+    connection->mBinary        = false;
+    connection->mRequestLength = 0;
+    connection->mSent          = 0;
+    connection->mResponse.clear();
+
+exit:
+    return;
+}
+
+void AdminServer::HandleConnection(void *aContext, int aFd, unsigned int aEvents)
+{
+    Connection &connection = *static_cast<Connection *>(aContext);
+
+    (void)aFd;
+
+    connection.mServer->HandleConnection(connection, aEvents);
+}
+
+void AdminServer::HandleConnection(Connection &aConnection, unsigned int aEvents)
+{
+    ssize_t rval;
+
+    VerifyOrExit(!(aEvents & Reactor::kEventError), Close(aConnection));
+
+    aConnection.mLastActivity = GetMonotonicNow();
+
+    // Requests are not read while a response is pending, so that a client not reading cannot grow the responses.
+    if (!aConnection.mResponse.empty())
+    {
+        VerifyOrExit(Send(aConnection));
+
+        aConnection.mResponse.clear();
+        aConnection.mSent = 0;
+        mReactor.Modify(aConnection.mWatch, Reactor::kEventReadable);
+        ExitNow();
+    }
+
+    rval = recv(aConnection.mFd, aConnection.mRequest + aConnection.mRequestLength,
+                sizeof(aConnection.mRequest) - aConnection.mRequestLength, 0);
+
+    if (rval < 0 && (errno == EAGAIN || errno == EINTR))
+    {
+        ExitNow();
+    }
+
+    VerifyOrExit(rval > 0, Close(aConnection));
+
+    aConnection.mRequestLength += static_cast<size_t>(rval);
+    HandleRequests(aConnection);
+
+exit:
+    return;
+}
+
+void AdminServer::HandleRequests(Connection &aConnection)
+{
+    char * begin = aConnection.mRequest;
+    size_t left  = aConnection.mRequestLength;
+    char * end;
+
+    while ((end = static_cast<char *>(memchr(begin, '\n', left))) != NULL)
+    {
+        *end = '\0';
+
+        if (end > begin && end[-1] == '\r')
+        {
+            end[-1] = '\0';
+        }
+
+        HandleRequest(aConnection, begin);
+        left -= static_cast<size_t>(end + 1 - begin);
+        begin = end + 1;
+    }
+
+    VerifyOrExit(left < sizeof(aConnection.mRequest),
+                 otbrLog(OTBR_LOG_WARNING, "Admin request too large"), Close(aConnection));
+
+    memmove(aConnection.mRequest, begin, left);
+    aConnection.mRequestLength = left;
+
+    VerifyOrExit(!aConnection.mResponse.empty());
+
+    if (Send(aConnection))
+    {
+        aConnection.mResponse.clear();
+        aConnection.mSent = 0;
+    }
+    else if (aConnection.mFd >= 0)
+    {
+        mReactor.Modify(aConnection.mWatch, Reactor::kEventWritable);
+    }
+
+exit:
+    return;
+}
+
+void AdminServer::HandleRequest(Connection &aConnection, char *aLine)
+{
+    otbrError   error = OTBR_ERROR_NONE;
+    std::string output;
+    char *      args;
+
+    while (*aLine == ' ')
+    {
+        ++aLine;
+    }
+
+    VerifyOrExit(*aLine != '\0');
+
+    if ((args = strchr(aLine, ' ')) != NULL)
+    {
+        *args++ = '\0';
+
+        while (*args == ' ')
+        {
+            ++args;
+        }
+    }
+    else
+    {
+        args = aLine + strlen(aLine);
+    }
+
+    if (strcmp(aLine, "help") == 0)
+    {
+        error = HandleHelp(output);
+    }
+    else if (strcmp(aLine, "metrics") == 0)
+    {
+        PrintMetrics(output, args);
+    }
+    else if (strcmp(aLine, "log") == 0)
+    {
+        error = HandleLog(args, output);
+    }
+    else if (strcmp(aLine, "binary") == 0 || strcmp(aLine, "text") == 0)
+    {
+        // The acknowledgment is already in the new format.
+        aConnection.mBinary = (aLine[0] == 'b');
+    }
+    else
+    {
+        const Command *command = NULL;
+
+        for (unsigned int i = 0; i < mCommandCount && command == NULL; ++i)
+        {
+            if (strcmp(aLine, mCommands[i].mName) == 0)
+            {
+                command = &mCommands[i];
+            }
+        }
+
+        if (command != NULL)
+        {
+            error = command->mHandler(command->mContext, args, output);
+        }
+        else
+        {
+            error = OTBR_ERROR_ERRNO;
+            Print(output, "unknown command %s, try help\n", aLine);
+        }
+    }
+
+    Respond(aConnection, error, output);
+
+exit:
+    return;
+}
+
+otbrError AdminServer::HandleHelp(std::string &aOutput) const
+{
+    Print(aOutput, "%-12s %s\n", "binary", "Frame the following responses");
+    Print(aOutput, "%-12s %s\n", "help", "List the commands");
+    Print(aOutput, "%-12s %s\n", "log", "Print or set the log level of modules");
+    Print(aOutput, "%-12s %s\n", "metrics", "Print the metrics starting with the argument");
+    Print(aOutput, "%-12s %s\n", "text", "Send the following responses as text");
+
+    for (unsigned int i = 0; i < mCommandCount; ++i)
+    {
+        Print(aOutput, "%-12s %s\n", mCommands[i].mName, mCommands[i].mHelp);
+    }
+
+    return OTBR_ERROR_NONE;
+}
+
+otbrError AdminServer::HandleLog(const char *aArgs, std::string &aOutput) const
+{
+    static const char *const kLevelNames[] = {"emerg", "alert", "crit", "err", "warning", "notice", "info", "debug"};
+
+    otbrError   error = OTBR_ERROR_NONE;
+    char        name[16];
+    char        value[16];
+    int         module;
+    int         level = -1;
+    const char *global;
+
+    if (sscanf(aArgs, "%15s %15s", name, value) != 2)
+    {
+        VerifyOrExit(aArgs[0] == '\0', error = OTBR_ERROR_ERRNO, Print(aOutput, "usage: log [MODULE|all LEVEL]\n"));
+
+        Print(aOutput, "%-12s %s\n", "all", kLevelNames[otbrLogGetLevel()]);
+
+        for (module = 0; module < OTBR_LOG_MODULE_COUNT; ++module)
+        {
+            global = otbrLogIsModuleLevelSet(module) ? "" : " (global)";
+            Print(aOutput, "%-12s %s%s\n", otbrLogGetModuleName(module), kLevelNames[otbrLogGetModuleLevel(module)],
+                  global);
+        }
+
+        ExitNow();
+    }
+
+    for (int i = OTBR_LOG_EMERG; i <= OTBR_LOG_DEBUG && level < 0; ++i)
+    {
+        level = (strcmp(value, kLevelNames[i]) == 0) ? i : -1;
+    }
+
+    if (level < 0 && value[0] >= '0' + OTBR_LOG_EMERG && value[0] <= '0' + OTBR_LOG_DEBUG && value[1] == '\0')
+    {
+        level = value[0] - '0';
+    }
+
+    if (strcmp(name, "all") == 0)
+    {
+        VerifyOrExit(level >= 0, error = OTBR_ERROR_ERRNO, Print(aOutput, "invalid level %s\n", value));
+        otbrLogSetLevel(level);
+        ExitNow();
+    }
+
+    module = otbrLogFindModule(name);
+    VerifyOrExit(module >= 0, error = OTBR_ERROR_ERRNO, Print(aOutput, "unknown module %s\n", name));
+    VerifyOrExit(level >= 0 || strcmp(value, "global") == 0, error = OTBR_ERROR_ERRNO,
+                 Print(aOutput, "invalid level %s\n", value));
+    otbrLogSetModuleLevel(module, level);
+
+exit:
+    return error;
+}
+
+void AdminServer::Respond(Connection &aConnection, otbrError aError, const std::string &aOutput)
+{
+    if (aConnection.mBinary)
+    {
+        uint32_t length = static_cast<uint32_t>(aOutput.size());
+        char     header[kFrameHeaderSize];
+
+        header[0] = static_cast<char>(aError == OTBR_ERROR_NONE ? kStatusSuccess : kStatusError);
+        header[1] = static_cast<char>(length >> 24);
+        header[2] = static_cast<char>(length >> 16);
+        header[3] = static_cast<char>(length >> 8);
+        header[4] = static_cast<char>(length);
+        aConnection.mResponse.append(header, sizeof(header));
+        aConnection.mResponse += aOutput;
+    }
+    else
+    {
+        // Text responses end with an empty line, and errors are prefixed, so that scripts can delimit them too.
+        if (aError != OTBR_ERROR_NONE)
+        {
+            aConnection.mResponse += "error: ";
+        }
+
+        aConnection.mResponse += aOutput;
+        aConnection.mResponse += "\n";
+    }
+}
+
+bool AdminServer::Send(Connection &aConnection)
+{
+    bool done = false;
+
+    while (aConnection.mSent < aConnection.mResponse.size())
+    {
+        ssize_t rval = send(aConnection.mFd, aConnection.mResponse.data() + aConnection.mSent,
+                            aConnection.mResponse.size() - aConnection.mSent, MSG_NOSIGNAL);
+
+        if (rval < 0)
+        {
+            VerifyOrExit(errno == EAGAIN || errno == EINTR, Close(aConnection));
+            ExitNow();
+        }
+
+        aConnection.mSent += static_cast<size_t>(rval);
+    }
+
+    done = true;
+
+exit:
+    return done;
+}
+
+void AdminServer::Close(Connection &aConnection)
+{
+    mReactor.Remove(aConnection.mWatch);
+    close(aConnection.mFd);
+    aConnection.mFd = -1;
+    aConnection.mResponse.clear();
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
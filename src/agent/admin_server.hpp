@@ -0,0 +1,203 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the UNIX-domain socket answering admin commands.
+ */
+
+#ifndef ADMIN_SERVER_HPP_
+#define ADMIN_SERVER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "common/reactor.hpp"
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class implements a UNIX-domain stream socket answering admin commands, to inspect the live state of the agent.
+ *
+ * Each request is a line holding a command and its arguments, separated by spaces. Connections stay open for further
+ * commands, and are served from the reactor, so that commands see the state between two mainloop iterations.
+ *
+ * Responses are text by default. After the `binary` command, each response is sent as a frame of a status byte, 0
+ * for success, and the big-endian 32-bit length of the text, followed by the text, so that tools need not parse the
+ * text to delimit responses. The `text` command switches back.
+ *
+ * Besides commands added by AddCommand(), `help` lists the commands and `metrics [PREFIX]` prints the metrics whose
+ * name starts with PREFIX. `log` lists the log level of each module, `log MODULE LEVEL` sets the level of a module,
+ * `log MODULE global` makes it follow the global level again, and `log all LEVEL` sets the global level.
+ *
+ */
+class AdminServer
+{
+public:
+    /**
+     * This function pointer is called to answer a command.
+     *
+     * @param[in]   aContext    A pointer to application-specific context.
+     * @param[in]   aArgs       A pointer to the null-terminated arguments of the command, empty if none.
+     * @param[out]  aOutput     A reference to the string to append the text of the response to.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully answered.
+     * @retval  OTBR_ERROR_ERRNO    Failed to answer, the output is sent as the error message.
+     *
+     */
+    typedef otbrError (*CommandHandler)(void *aContext, const char *aArgs, std::string &aOutput);
+
+    /**
+     * The constructor to initialize the admin server.
+     *
+     * @param[in]   aReactor    A reference to the reactor to register sockets with.
+     *
+     */
+    explicit AdminServer(Reactor &aReactor);
+
+    ~AdminServer(void);
+
+    /**
+     * This method adds a command.
+     *
+     * @param[in]   aName       A pointer to the null-terminated name of the command, which must stay valid.
+     * @param[in]   aHelp       A pointer to the null-terminated description of the command, which must stay valid.
+     * @param[in]   aHandler    A pointer to the function answering the command.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully added the command.
+     * @retval  OTBR_ERROR_ERRNO    Too many commands, errno is set to ENOMEM.
+     *
+     */
+    otbrError AddCommand(const char *aName, const char *aHelp, CommandHandler aHandler, void *aContext);
+
+    /**
+     * This method starts listening.
+     *
+     * A stale socket file left at @p aPath is removed, and the socket is only accessible by its owner and group.
+     *
+     * @param[in]   aPath   A pointer to the null-terminated path of the socket.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully started.
+     * @retval  OTBR_ERROR_ERRNO    Failed to start, error code set in errno.
+     *
+     */
+    otbrError Start(const char *aPath);
+
+    /**
+     * This method closes the listening socket, removing its file, and all connections.
+     *
+     */
+    void Stop(void);
+
+    /**
+     * This function appends formatted text to a response.
+     *
+     * @param[out]  aOutput     A reference to the response.
+     * @param[in]   aFormat     A pointer to the printf-style format.
+     *
+     */
+    static void Print(std::string &aOutput, const char *aFormat, ...) __attribute__((format(printf, 2, 3)));
+
+    /**
+     * This function appends the metrics whose name starts with a prefix to a response, one per line.
+     *
+     * @param[out]  aOutput     A reference to the response.
+     * @param[in]   aPrefix     A pointer to the null-terminated prefix, empty for all metrics.
+     *
+     */
+    static void PrintMetrics(std::string &aOutput, const char *aPrefix);
+
+private:
+    enum
+    {
+        kMaxConnections = 4,     ///< Max number of connections served at a time.
+        kMaxCommands    = 16,    ///< Max number of commands added.
+        kMaxRequestSize = 256,   ///< Max size of a request line.
+        kIdleTimeout    = 60000, ///< Milliseconds a connection may stay idle before it is evicted.
+    };
+
+    enum
+    {
+        kFrameHeaderSize = 5, ///< Size of the header of a binary frame.
+        kStatusSuccess   = 0, ///< The status of a successful response.
+        kStatusError     = 1, ///< The status of a failed response.
+    };
+
+    struct Command
+    {
+        const char *   mName;
+        const char *   mHelp;
+        CommandHandler mHandler;
+        void *         mContext;
+    };
+
+    struct Connection
+    {
+        AdminServer *  mServer;
+        Reactor::Watch mWatch;
+        int            mFd;
+        uint64_t       mLastActivity;
+        bool           mBinary;
+        char           mRequest[kMaxRequestSize];
+        size_t         mRequestLength;
+        std::string    mResponse;
+        size_t         mSent;
+    };
+
+    static void HandleAccept(void *aContext, int aFd, unsigned int aEvents);
+    void        HandleAccept(void);
+    static void HandleConnection(void *aContext, int aFd, unsigned int aEvents);
+    void        HandleConnection(Connection &aConnection, unsigned int aEvents);
+    void        HandleRequests(Connection &aConnection);
+    void        HandleRequest(Connection &aConnection, char *aLine);
+    otbrError   HandleHelp(std::string &aOutput) const;
+    otbrError   HandleLog(const char *aArgs, std::string &aOutput) const;
+    static void Respond(Connection &aConnection, otbrError aError, const std::string &aOutput);
+    bool        Send(Connection &aConnection);
+    void        Close(Connection &aConnection);
+
+    Reactor &      mReactor;
+    Reactor::Watch mWatch;
+    int            mFd;
+    std::string    mPath;
+    Command        mCommands[kMaxCommands];
+    unsigned int   mCommandCount;
+    Connection     mConnections[kMaxConnections];
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // ADMIN_SERVER_HPP_
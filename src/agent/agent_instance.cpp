@@ -31,35 +31,222 @@
  *   This file includes implementation for Thread border router agent instance.
  */
 
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_BORDER_AGENT
+
 #include "agent_instance.hpp"
 
+#include <arpa/inet.h>
 #include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <string>
+#include <vector>
 
+#include "packet_trace.hpp"
 #include "common/code_utils.hpp"
 #include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
+#include "common/timeline.hpp"
+#include "utils/hex.hpp"
 
 namespace ot {
 
 namespace BorderRouter {
 
-AgentInstance::AgentInstance(const char *aIfName)
-    : mNcp(Ncp::Controller::Create(aIfName))
-    , mCoap(Coap::Agent::Create(SendCoap, this))
-    , mBorderAgent(mNcp, mCoap)
+static Metrics::Histogram sLoopTime("agent.loop_us");
+static Metrics::Histogram sReactorTime("agent.loop_reactor_us");
+static Metrics::Histogram sNcpTime("agent.loop_ncp_us");
+static Metrics::Histogram sBorderAgentTime("agent.loop_border_agent_us");
+static Metrics::Histogram sPublisherTime("agent.loop_mdns_us");
+static Metrics::Histogram sTimersTime("agent.loop_timers_us");
+static Metrics::Counter   sLoopStalls("agent.loop_stalls");
+static Metrics::Gauge     sLoadLevel("agent.load_level");
+
+static Metrics::Histogram *const sComponentTimes[] = {&sReactorTime, &sNcpTime, &sBorderAgentTime, &sPublisherTime,
+                                                      &sTimersTime};
+
+// Returns the microseconds since @p aLast and moves it to now.
+static uint32_t Lap(uint64_t &aLast)
+{
+    uint64_t now  = GetMonotonicNowUs();
+    uint32_t time = static_cast<uint32_t>(now - aLast);
+
+    aLast = now;
+
+    return time;
+}
+
+AgentInstance::AgentInstance(const char *const *aInterfaceNames,
+                             uint8_t            aInterfaceCount,
+                             unsigned int       aHandshakeWorkers,
+                             unsigned int       aMaxDtlsSessions,
+                             uint32_t           aDatasetCacheTimeout,
+                             int                aPublishDelay,
+                             uint8_t            aFirstNetwork)
+    : mPublisher(Mdns::Publisher::Create(AF_UNSPEC, NULL, NULL, HandleMdnsState, this, &mReactor, &mTimerWheel))
+    , mNetworkCount(aInterfaceCount < kMaxNetworks ? aInterfaceCount : static_cast<uint8_t>(kMaxNetworks))
+    , mMetricsServer(mReactor)
+    , mAdminServer(mReactor)
+    , mWebApiServer(mReactor)
+    , mStallThreshold(kDefaultStallThreshold * 1000)
+    , mLoadTimer(HandleLoadTimer, this)
+    , mLoopCount(0)
+{
+    mLoadShedder.SetThreshold(kDefaultLoadThreshold * 1000);
+    mPublisher->SetConflictHandler(HandleMdnsConflict, this);
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        Network &network = mNetworks[i];
+        uint16_t port    = static_cast<uint16_t>(BorderAgent::kDefaultPort + aFirstNetwork + i);
+
+        network.mIfName      = aInterfaceNames[i];
+        network.mNcp         = Ncp::Controller::Create(aInterfaceNames[i], &mReactor, &mTimerWheel);
+        network.mCoap        = Coap::Agent::Create(SendCoap, &network, &mTimerWheel);
+        network.mBorderAgent = new BorderAgent(network.mNcp, network.mCoap, &mReactor, &mTimerWheel, mPublisher, port);
+        network.mDiagnostic  = new NetworkDiagnostic(*network.mCoap, mTimerWheel);
+        network.mNetworkData = new NetworkData(*network.mNcp);
+
+        network.mBorderAgent->SetHandshakeWorkers(aHandshakeWorkers);
+        network.mBorderAgent->SetDatasetCacheTimeout(aDatasetCacheTimeout);
+
+        if (aMaxDtlsSessions > 0)
+        {
+            network.mBorderAgent->SetMaxDtlsSessions(aMaxDtlsSessions);
+        }
+
+        if (aPublishDelay >= 0)
+        {
+            network.mBorderAgent->SetPublishDelay(static_cast<uint32_t>(aPublishDelay));
+        }
+    }
+
+    mAdminServer.AddCommand("sessions", "List the DTLS sessions of commissioners", HandleAdminSessions, this);
+    mAdminServer.AddCommand("peers", "Print the CPU time of the DTLS sessions of each peer", HandleAdminPeers, this);
+    mAdminServer.AddCommand("coap", "Print the CoAP requests in flight", HandleAdminCoap, this);
+    mAdminServer.AddCommand("pools", "Print the memory of pools", HandleAdminPools, this);
+    mAdminServer.AddCommand("dbus", "Print the TMF messages queued to wpantund", HandleAdminDbus, this);
+    mAdminServer.AddCommand("mdns", "Print the commissioning services published", HandleAdminMdns, this);
+    mAdminServer.AddCommand("loop", "Print the mainloop latencies", HandleAdminLoop, this);
+    mAdminServer.AddCommand("relay", "Print the messages relayed for each joiner", HandleAdminRelay, this);
+    mAdminServer.AddCommand("netdata", "Print the Network Data of each network", HandleAdminNetworkData, this);
+
+    mWebApiServer.AddRoute("/get_properties", HandleWebProperties, this);
+    mWebApiServer.AddRoute("/get_network_data", HandleWebNetworkData, this);
+}
+
+otbrError AgentInstance::SetRateLimits(const char *aLimits)
+{
+    otbrError error = OTBR_ERROR_NONE;
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        SuccessOrExit(error = mNetworks[i].mBorderAgent->SetRateLimits(aLimits));
+    }
+
+exit:
+    return error;
+}
+
+void AgentInstance::SetDtlsTimeouts(uint32_t aHandshakeTimeout, uint32_t aIdleTimeout)
 {
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        mNetworks[i].mBorderAgent->SetDtlsTimeouts(aHandshakeTimeout, aIdleTimeout);
+    }
+}
+
+void AgentInstance::SetLoadThreshold(uint32_t aThreshold)
+{
+    LoadShedder::Level previous = mLoadShedder.GetLevel();
+
+    mLoadShedder.SetThreshold(aThreshold * 1000);
+    ApplyLoadLevel(previous);
+}
+
+void AgentInstance::SetDtlsLink(uint32_t aMin, uint32_t aMax, uint16_t aMtu)
+{
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        mNetworks[i].mBorderAgent->SetDtlsRetransmissionTimeouts(aMin, aMax);
+        mNetworks[i].mBorderAgent->SetDtlsMtu(aMtu);
+    }
+}
+
+void AgentInstance::SetStateDirectory(const char *aDirectory)
+{
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        Network &   network = mNetworks[i];
+        std::string filename(aDirectory);
+
+        filename += '/';
+
+        for (const char *c = network.mIfName; *c != '\0'; ++c)
+        {
+            filename += (isalnum(static_cast<unsigned char>(*c)) || *c == '-' || *c == '.') ? *c : '_';
+        }
+
+        filename += ".state";
+
+        if (network.mWarmState.Open(filename.c_str(), network.mIfName) == OTBR_ERROR_NONE)
+        {
+            network.mBorderAgent->SetWarmState(&network.mWarmState);
+        }
+    }
+}
+
+void AgentInstance::SetKeepAliveInterval(uint32_t aInterval)
+{
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        mNetworks[i].mBorderAgent->SetKeepAliveInterval(aInterval);
+    }
+}
+
+void AgentInstance::SetDuplicateLifetime(uint32_t aLifetime)
+{
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        mNetworks[i].mBorderAgent->SetDuplicateLifetime(aLifetime);
+    }
+}
+
+void AgentInstance::SetDiagnosticInterval(uint32_t aInterval)
+{
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        mNetworks[i].mDiagnostic->SetInterval(aInterval);
+    }
 }
 
 otbrError AgentInstance::Init(void)
 {
     otbrError error = OTBR_ERROR_NONE;
 
-    SuccessOrExit(error = mNcp->Init());
+    SuccessOrExit(error = mReactor.Init());
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        Network &network = mNetworks[i];
+
+        SuccessOrExit(error = network.mNcp->Init());
 
-    mNcp->On(Ncp::kEventTmfProxyStream, FeedCoap, this);
+        network.mNcp->On(FeedCoap, &network);
 
-    SuccessOrExit(error = mNcp->TmfProxyStart());
+        SuccessOrExit(error = network.mNcp->TmfProxyStart());
 
-    SuccessOrExit(error = mBorderAgent.Start());
+        // Subscribed before the border agent requests the properties, the Network Data among them.
+        network.mNetworkData->Start();
+
+        SuccessOrExit(error = network.mBorderAgent->Start());
+
+        network.mDiagnostic->Start();
+    }
 
 exit:
     if (error != OTBR_ERROR_NONE)
@@ -70,34 +257,633 @@ exit:
     return error;
 }
 
+otbrError AgentInstance::Poll(const timeval &aTimeout)
+{
+    otbrError  error   = OTBR_ERROR_NONE;
+    fd_set     readFdSet;
+    fd_set     writeFdSet;
+    fd_set     errorFdSet;
+    int        maxFd   = -1;
+    timeval    timeout = aTimeout;
+    LoopTiming timing;
+    uint64_t   last;
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+
+    mTimerWheel.UpdateTimeout(timeout);
+
+    // Only file descriptors not registered with the reactor are collected here.
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        mNetworks[i].mNcp->UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd);
+        mNetworks[i].mBorderAgent->UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
+    }
+
+    if (mPublisher->IsStarted())
+    {
+        mPublisher->UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
+    }
+
+    if (mReactor.Poll(readFdSet, writeFdSet, errorFdSet, maxFd, timeout) < 0)
+    {
+        VerifyOrExit(errno == EINTR, error = OTBR_ERROR_ERRNO);
+
+        FD_ZERO(&readFdSet);
+        FD_ZERO(&writeFdSet);
+        FD_ZERO(&errorFdSet);
+    }
+
+    // The rest of the iteration reads the time the reactor woke up at, until it ends below.
+    LoopClock::Start(mReactor.GetWakeTime());
+
+    memset(&timing, 0, sizeof(timing));
+    timing.mWakeTime                 = mReactor.GetWakeTime();
+    timing.mSlowestHandler           = mReactor.GetSlowestHandler();
+    last                             = timing.mWakeTime;
+    timing.mTimes[kComponentReactor] = Lap(last);
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        Timeline::Begin("agent.ncp");
+        mNetworks[i].mNcp->Process(readFdSet, writeFdSet, errorFdSet);
+        FlushCoap(mNetworks[i]);
+        Timeline::End("agent.ncp");
+        timing.mTimes[kComponentNcp] += Lap(last);
+        Timeline::Begin("agent.border_agent");
+        mNetworks[i].mBorderAgent->Process(readFdSet, writeFdSet, errorFdSet);
+        Timeline::End("agent.border_agent");
+        timing.mTimes[kComponentBorderAgent] += Lap(last);
+    }
+
+    if (mPublisher->IsStarted())
+    {
+        Timeline::Begin("agent.mdns");
+        mPublisher->Process(readFdSet, writeFdSet, errorFdSet);
+        Timeline::End("agent.mdns");
+    }
+
+    timing.mTimes[kComponentPublisher] = Lap(last);
+    Timeline::Begin("agent.timers");
+    mTimerWheel.Process();
+    Timeline::End("agent.timers");
+    timing.mTimes[kComponentTimers] = Lap(last);
+
+    // The iteration spans from the wakeup, the reactor handlers being its first spans.
+    Timeline::Complete("agent.loop", timing.mWakeTime, last - timing.mWakeTime);
+
+    RecordLoopTiming(timing);
+
+exit:
+    LoopClock::Stop();
+
+    if (error != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to poll: %s!", strerror(errno));
+    }
+
+    return error;
+}
+
+void AgentInstance::RecordLoopTiming(LoopTiming &aTiming)
+{
+    uint32_t total = 0;
+
+    for (int i = 0; i < kNumComponents; ++i)
+    {
+        sComponentTimes[i]->Record(aTiming.mTimes[i]);
+        total += aTiming.mTimes[i];
+    }
+
+    // Time spent handling the events of one wakeup, which delays the events of the next one.
+    sLoopTime.Record(total);
+    mLoopHistory[mLoopCount++ % kLoopHistorySize] = aTiming;
+
+    if (mStallThreshold != 0 && total >= mStallThreshold)
+    {
+        sLoopStalls.Add();
+        LogLoopTiming(OTBR_LOG_WARNING, "Mainloop stalled", aTiming);
+    }
+
+    UpdateLoad(total);
+}
+
+void AgentInstance::UpdateLoad(uint32_t aLatency)
+{
+    LoadShedder::Level previous = mLoadShedder.GetLevel();
+    uint32_t           queued   = 0;
+    uint32_t           capacity = 0;
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        queued += mNetworks[i].mTxQueue.GetCount();
+        capacity += kMaxTxControl + kMaxTxManagement + kMaxTxBulk;
+    }
+
+    mLoadShedder.Update(aLatency, queued, capacity, LoopClock::GetNow());
+    ApplyLoadLevel(previous);
+}
+
+void AgentInstance::ApplyLoadLevel(LoadShedder::Level aPrevious)
+{
+    LoadShedder::Level level = mLoadShedder.GetLevel();
+
+    VerifyOrExit(level != aPrevious);
+
+    sLoadLevel.Add(level - aPrevious);
+    otbrLog(level > aPrevious ? OTBR_LOG_WARNING : OTBR_LOG_INFO,
+            "Load level %d, mainloop iterations take %u us for a threshold of %u us", level,
+            mLoadShedder.GetLatency(), mLoadShedder.GetThreshold());
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        mNetworks[i].mBorderAgent->SetLoadLevel(level);
+    }
+
+    // Iterations keep being sampled while shedding, the level would otherwise stay until the next event.
+    if (level == LoadShedder::kLevelNormal)
+    {
+        mTimerWheel.Stop(mLoadTimer);
+    }
+    else if (!mLoadTimer.IsRunning())
+    {
+        mTimerWheel.Start(mLoadTimer, mLoadShedder.GetHoldTime());
+    }
+
+exit:
+    return;
+}
+
+void AgentInstance::HandleLoadTimer(void *aContext)
+{
+    AgentInstance &agentInstance = *static_cast<AgentInstance *>(aContext);
+
+    if (agentInstance.mLoadShedder.GetLevel() != LoadShedder::kLevelNormal)
+    {
+        agentInstance.mTimerWheel.Start(agentInstance.mLoadTimer, agentInstance.mLoadShedder.GetHoldTime());
+    }
+}
+
+void AgentInstance::LogLoopTiming(int aLevel, const char *aWhat, const LoopTiming &aTiming) const
+{
+    const Reactor::HandlerTime &slowest = aTiming.mSlowestHandler;
+    uint32_t                    total   = 0;
+
+    for (int i = 0; i < kNumComponents; ++i)
+    {
+        total += aTiming.mTimes[i];
+    }
+
+    otbrLog(aLevel,
+            "%s: %u us at %llu ms, reactor %u (slowest %s fd %d %u), ncp %u, border agent %u, mdns %u, "
+            "timers %u",
+            aWhat, total, static_cast<unsigned long long>(aTiming.mWakeTime / 1000), aTiming.mTimes[kComponentReactor],
+            slowest.mName != NULL ? slowest.mName : "none", slowest.mFd, slowest.mTime, aTiming.mTimes[kComponentNcp],
+            aTiming.mTimes[kComponentBorderAgent], aTiming.mTimes[kComponentPublisher],
+            aTiming.mTimes[kComponentTimers]);
+}
+
+void AgentInstance::DumpLoopHistory(int aLevel) const
+{
+    unsigned int count = mLoopCount < kLoopHistorySize ? mLoopCount : static_cast<unsigned int>(kLoopHistorySize);
+
+    for (unsigned int i = mLoopCount - count; i != mLoopCount; ++i)
+    {
+        LogLoopTiming(aLevel, "Mainloop", mLoopHistory[i % kLoopHistorySize]);
+    }
+}
+
+otbrError AgentInstance::HandleAdminSessions(void *aContext, const char *aArgs, std::string &aOutput)
+{
+    (void)aArgs;
+
+    static_cast<const AgentInstance *>(aContext)->PrintSessions(aOutput);
+
+    return OTBR_ERROR_NONE;
+}
+
+void AgentInstance::PrintSessions(std::string &aOutput) const
+{
+    static const char *const kStateNames[] = {"handshaking", "ready", "close", "end", "error", "expired"};
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        const BorderAgent &                    borderAgent = *mNetworks[i].mBorderAgent;
+        std::vector<Dtls::Server::SessionInfo> infos(borderAgent.GetDtlsSessions(NULL, 0));
+
+        // Sessions are not created between the two calls, which both run on the mainloop.
+        infos.resize(borderAgent.GetDtlsSessions(infos.empty() ? NULL : &infos[0], infos.size()));
+
+        for (size_t j = 0; j < infos.size(); ++j)
+        {
+            const Dtls::Server::SessionInfo &info = infos[j];
+            char                             address[INET6_ADDRSTRLEN];
+
+            inet_ntop(AF_INET6, info.mPeerAddress, address, sizeof(address));
+            AdminServer::Print(aOutput,
+                               "network=%u peer=[%s]:%u state=%s%s age_ms=%u idle_ms=%u rx=%llu tx=%llu "
+                               "handshake_cpu_us=%llu record_cpu_us=%llu handler_cpu_us=%llu\n",
+                               i, address, info.mPeerPort, kStateNames[info.mState], info.mOffloaded ? "+worker" : "",
+                               info.mAge, info.mIdleTime, static_cast<unsigned long long>(info.mRxBytes),
+                               static_cast<unsigned long long>(info.mTxBytes),
+                               static_cast<unsigned long long>(info.mHandshakeCpuTime),
+                               static_cast<unsigned long long>(info.mRecordCpuTime),
+                               static_cast<unsigned long long>(info.mHandlerCpuTime));
+        }
+    }
+}
+
+otbrError AgentInstance::HandleAdminPeers(void *aContext, const char *aArgs, std::string &aOutput)
+{
+    (void)aArgs;
+
+    static_cast<const AgentInstance *>(aContext)->PrintPeers(aOutput);
+
+    return OTBR_ERROR_NONE;
+}
+
+void AgentInstance::PrintPeers(std::string &aOutput) const
+{
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        const BorderAgent &                 borderAgent = *mNetworks[i].mBorderAgent;
+        std::vector<Dtls::Server::PeerInfo> infos(borderAgent.GetDtlsPeers(NULL, 0));
+
+        infos.resize(borderAgent.GetDtlsPeers(infos.empty() ? NULL : &infos[0], infos.size()));
+
+        for (size_t j = 0; j < infos.size(); ++j)
+        {
+            const Dtls::Server::PeerInfo &info = infos[j];
+            char                          address[INET6_ADDRSTRLEN];
+
+            inet_ntop(AF_INET6, info.mPeerAddress, address, sizeof(address));
+            AdminServer::Print(aOutput,
+                               "network=%u peer=%s sessions=%u handshake_cpu_us=%llu record_cpu_us=%llu "
+                               "handler_cpu_us=%llu\n",
+                               i, address, info.mSessions, static_cast<unsigned long long>(info.mHandshakeCpuTime),
+                               static_cast<unsigned long long>(info.mRecordCpuTime),
+                               static_cast<unsigned long long>(info.mHandlerCpuTime));
+        }
+    }
+}
+
+otbrError AgentInstance::HandleAdminCoap(void *aContext, const char *aArgs, std::string &aOutput)
+{
+    (void)aArgs;
+
+    static_cast<const AgentInstance *>(aContext)->PrintCoap(aOutput);
+
+    return OTBR_ERROR_NONE;
+}
+
+void AgentInstance::PrintCoap(std::string &aOutput) const
+{
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        const Network &network = mNetworks[i];
+
+        AdminServer::Print(aOutput,
+                           "network=%u tmf=%u commissioner=%u petitions=%u keep_alives=%u dataset_observers=%u "
+                           "tx_queue=%u pool_misses=%u\n",
+                           i, network.mCoap->GetTransactionCount(NULL),
+                           network.mBorderAgent->GetCommissionerTransactionCount(),
+                           network.mBorderAgent->GetPendingPetitions(), network.mBorderAgent->GetPendingKeepAlives(),
+                           network.mBorderAgent->GetDatasetObserverCount(), network.mTxQueue.GetCount(),
+                           network.mCoap->GetMessagePoolMisses());
+    }
+}
+
+otbrError AgentInstance::HandleAdminPools(void *aContext, const char *aArgs, std::string &aOutput)
+{
+    (void)aContext;
+    (void)aArgs;
+
+    AdminServer::PrintMetrics(aOutput, "memory.");
+    AdminServer::PrintMetrics(aOutput, "coap.message");
+
+    return OTBR_ERROR_NONE;
+}
+
+otbrError AgentInstance::HandleAdminDbus(void *aContext, const char *aArgs, std::string &aOutput)
+{
+    (void)aContext;
+    (void)aArgs;
+
+    // The in-flight gauge is the depth of the queue of TMF messages sent to wpantund and not yet acknowledged.
+    AdminServer::PrintMetrics(aOutput, "ncp.tmf_dbus");
+
+    return OTBR_ERROR_NONE;
+}
+
+otbrError AgentInstance::HandleAdminMdns(void *aContext, const char *aArgs, std::string &aOutput)
+{
+    (void)aArgs;
+
+    static_cast<const AgentInstance *>(aContext)->PrintMdns(aOutput);
+
+    return OTBR_ERROR_NONE;
+}
+
+void AgentInstance::PrintMdns(std::string &aOutput) const
+{
+    AdminServer::Print(aOutput, "publisher=%s\n", mPublisher->IsStarted() ? "started" : "stopped");
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        const BorderAgent &borderAgent = *mNetworks[i].mBorderAgent;
+
+        AdminServer::Print(aOutput,
+                           "network=%u name=\"%s\" port=%u published=%d pending=%d txt_bytes=%u name_conflicts=%u\n", i,
+                           borderAgent.GetNetworkName(), borderAgent.GetPort(), borderAgent.IsServicePublished(),
+                           borderAgent.IsPublishPending(), borderAgent.GetTxtRecord().GetLength(),
+                           borderAgent.GetNameConflicts());
+    }
+}
+
+otbrError AgentInstance::HandleAdminLoop(void *aContext, const char *aArgs, std::string &aOutput)
+{
+    (void)aArgs;
+
+    static_cast<const AgentInstance *>(aContext)->PrintLoop(aOutput);
+
+    return OTBR_ERROR_NONE;
+}
+
+void AgentInstance::PrintLoop(std::string &aOutput) const
+{
+    unsigned int count   = mLoopCount < kLoopHistorySize ? mLoopCount : static_cast<unsigned int>(kLoopHistorySize);
+    uint32_t     slowest = 0;
+    uint64_t     sum     = 0;
+
+    // The recent iterations, before the histograms since the start.
+    for (unsigned int i = mLoopCount - count; i != mLoopCount; ++i)
+    {
+        const LoopTiming &timing = mLoopHistory[i % kLoopHistorySize];
+        uint32_t          total  = 0;
+
+        for (int j = 0; j < kNumComponents; ++j)
+        {
+            total += timing.mTimes[j];
+        }
+
+        sum += total;
+        slowest = total > slowest ? total : slowest;
+    }
+
+    AdminServer::Print(aOutput, "iterations=%u recent=%u recent_mean_us=%llu recent_max_us=%u stall_threshold_us=%u\n",
+                       mLoopCount, count, static_cast<unsigned long long>(count > 0 ? sum / count : 0), slowest,
+                       mStallThreshold);
+    AdminServer::Print(aOutput, "load_level=%d load_smoothed_us=%u load_threshold_us=%u\n", mLoadShedder.GetLevel(),
+                       mLoadShedder.GetLatency(), mLoadShedder.GetThreshold());
+
+    if (count > 0)
+    {
+        const Reactor::HandlerTime &handler = mLoopHistory[(mLoopCount - 1) % kLoopHistorySize].mSlowestHandler;
+
+        AdminServer::Print(aOutput, "last_slowest_handler=%s fd=%d us=%u\n",
+                           handler.mName != NULL ? handler.mName : "none", handler.mFd, handler.mTime);
+    }
+
+    AdminServer::PrintMetrics(aOutput, "agent.loop");
+}
+
+otbrError AgentInstance::HandleAdminRelay(void *aContext, const char *aArgs, std::string &aOutput)
+{
+    (void)aArgs;
+
+    static_cast<const AgentInstance *>(aContext)->PrintRelay(aOutput);
+
+    return OTBR_ERROR_NONE;
+}
+
+void AgentInstance::PrintRelay(std::string &aOutput) const
+{
+    // The wait of received messages is spent in the mesh and the joiner, of transmitted ones in the commissioner.
+    static const char *const kDirectionNames[] = {"rx", "tx"};
+    static const char *const kWaitNames[]      = {"mesh", "commissioner"};
+
+    uint64_t now = GetMonotonicNowUs();
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        RelayFlowTable::Flow flows[RelayFlowTable::kMaxFlows];
+        unsigned int         count = mNetworks[i].mBorderAgent->GetRelayFlows(flows, RelayFlowTable::kMaxFlows);
+
+        for (unsigned int j = 0; j < count; ++j)
+        {
+            const RelayFlowTable::Flow &flow = flows[j];
+            char                        iid[RelayFlowTable::kJoinerIidSize * 2 + 1];
+
+            Utils::Bytes2Hex(flow.mJoinerIid, sizeof(flow.mJoinerIid), iid);
+
+            for (int k = 0; k < RelayFlowTable::kNumDirections; ++k)
+            {
+                const RelayFlowTable::Stats &stats = flow.mStats[k];
+
+                unsigned long long gap     = stats.mPackets > 1 ? stats.mGapTotal / (stats.mPackets - 1) : 0;
+                unsigned long long forward = stats.mPackets > 0 ? stats.mForwardTotal / stats.mPackets : 0;
+                unsigned long long wait    = stats.mTurnarounds > 0 ? stats.mTurnaroundTotal / stats.mTurnarounds : 0;
+                unsigned long long idle    = stats.mPackets > 0 ? (now - stats.mLastTime) / 1000 : 0;
+
+                AdminServer::Print(aOutput,
+                                   "network=%u joiner=%s locator=0x%04x dir=%s age_ms=%llu idle_ms=%llu packets=%u "
+                                   "bytes=%llu gap_mean_us=%llu gap_max_us=%u forward_mean_us=%llu forward_max_us=%u "
+                                   "%s_wait_mean_us=%llu %s_wait_max_us=%u\n",
+                                   i, iid, flow.mLocator, kDirectionNames[k],
+                                   static_cast<unsigned long long>((now - flow.mFirstTime) / 1000), idle,
+                                   stats.mPackets, static_cast<unsigned long long>(stats.mBytes), gap, stats.mGapMax,
+                                   forward, stats.mForwardMax, kWaitNames[k], wait, kWaitNames[k],
+                                   stats.mTurnaroundMax);
+            }
+        }
+    }
+
+    AdminServer::PrintMetrics(aOutput, "border_agent.relay");
+}
+
+otbrError AgentInstance::HandleAdminNetworkData(void *aContext, const char *aArgs, std::string &aOutput)
+{
+    const AgentInstance &agentInstance = *static_cast<const AgentInstance *>(aContext);
+
+    (void)aArgs;
+
+    for (uint8_t i = 0; i < agentInstance.mNetworkCount; ++i)
+    {
+        AdminServer::Print(aOutput, "network=%u interface=%s ", i, agentInstance.mNetworks[i].mIfName);
+        aOutput += agentInstance.mNetworks[i].mNetworkData->GetText();
+    }
+
+    return OTBR_ERROR_NONE;
+}
+
+otbrError AgentInstance::HandleWebNetworkData(void *aContext, const char *aQuery, std::string &aOutput)
+{
+    const Network *network = static_cast<const AgentInstance *>(aContext)->FindNetwork(aQuery);
+
+    if (network != NULL)
+    {
+        AdminServer::Print(aOutput, "{\"error\":%d,\"result\":", kWebStatusOk);
+        aOutput += network->mNetworkData->GetJson();
+        aOutput += "}";
+    }
+    else
+    {
+        AdminServer::Print(aOutput, "{\"error\":%d,\"result\":\"failed\"}", kWebStatusGetPropertyFailed);
+    }
+
+    return OTBR_ERROR_NONE;
+}
+
+const AgentInstance::Network *AgentInstance::FindNetwork(const char *aQuery) const
+{
+    const Network *network = (mNetworkCount > 0 ? &mNetworks[0] : NULL);
+    std::string    ifName;
+
+    if (WebApiServer::GetParameter(aQuery, "interface", ifName))
+    {
+        network = NULL;
+
+        for (uint8_t i = 0; i < mNetworkCount && network == NULL; ++i)
+        {
+            if (ifName == mNetworks[i].mIfName)
+            {
+                network = &mNetworks[i];
+            }
+        }
+    }
+
+    return network;
+}
+
+otbrError AgentInstance::HandleWebProperties(void *aContext, const char *aQuery, std::string &aOutput)
+{
+    static_cast<const AgentInstance *>(aContext)->PrintProperties(aQuery, aOutput);
+
+    return OTBR_ERROR_NONE;
+}
+
+// The document has the format of `GET /get_properties` of otbr-web, with the properties the NCP controller caches.
+void AgentInstance::PrintProperties(const char *aQuery, std::string &aOutput) const
+{
+    const Network *network = FindNetwork(aQuery);
+    bool           valid   = false;
+    const char *   networkName;
+    const uint8_t *extPanId;
+    bool           associated;
+
+    VerifyOrExit(network != NULL);
+    valid = true;
+
+    // Like otbr-web, a controller not knowing the state yet is reported as wpantund down.
+    if (network->mNcp->GetThreadState(associated) != OTBR_ERROR_NONE)
+    {
+        AdminServer::Print(aOutput,
+                           "{\"error\":%d,\"result\":{\"wpantund\":\"down\",\"WPAN service\":\"uninitialized\","
+                           "\"mDNS service\":\"down\"}}",
+                           kWebStatusOk);
+        ExitNow();
+    }
+
+    if (!associated)
+    {
+        AdminServer::Print(aOutput,
+                           "{\"error\":%d,\"result\":{\"WPAN service\":\"offline\",\"mDNS service\":\"down\"}}",
+                           kWebStatusOk);
+        ExitNow();
+    }
+
+    networkName = network->mNcp->GetNetworkName();
+    extPanId    = network->mNcp->GetExtPanId();
+    VerifyOrExit(networkName != NULL && extPanId != NULL, valid = false);
+
+    AdminServer::Print(aOutput, "{\"error\":%d,\"result\":{\"NCP:State\":\"associated\",\"Network:Name\":",
+                       kWebStatusOk);
+    WebApiServer::AppendString(aOutput, networkName);
+    AdminServer::Print(aOutput, ",\"Network:XPANID\":\"0x%02X%02X%02X%02X%02X%02X%02X%02X\"", extPanId[0],
+                       extPanId[1], extPanId[2], extPanId[3], extPanId[4], extPanId[5], extPanId[6], extPanId[7]);
+    aOutput += ",\"Config:TUN:InterfaceName\":";
+    WebApiServer::AppendString(aOutput, network->mIfName);
+    AdminServer::Print(aOutput, ",\"mDNS service\":\"%s\"}}",
+                       network->mBorderAgent->IsServicePublished() ? "up" : "down");
+
+exit:
+    if (!valid)
+    {
+        AdminServer::Print(aOutput, "{\"error\":%d,\"result\":\"failed\"}", kWebStatusGetPropertyFailed);
+    }
+}
+
 void AgentInstance::UpdateFdSet(fd_set & aReadFdSet,
                                 fd_set & aWriteFdSet,
                                 fd_set & aErrorFdSet,
                                 int &    aMaxFd,
                                 timeval &aTimeout)
 {
-    mNcp->UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd);
-    mBorderAgent.UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd, aTimeout);
+    mTimerWheel.UpdateTimeout(aTimeout);
+    mReactor.UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd);
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        mNetworks[i].mNcp->UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd);
+        mNetworks[i].mBorderAgent->UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd, aTimeout);
+    }
+
+    if (mPublisher->IsStarted())
+    {
+        mPublisher->UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd, aTimeout);
+    }
 }
 
 void AgentInstance::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
 {
-    mNcp->Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
-    mBorderAgent.Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
+    LoopClock::Start(GetMonotonicNowUs());
+    mReactor.Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        mNetworks[i].mNcp->Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
+        FlushCoap(mNetworks[i]);
+        mNetworks[i].mBorderAgent->Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
+    }
+
+    if (mPublisher->IsStarted())
+    {
+        mPublisher->Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
+    }
+
+    mTimerWheel.Process();
+    LoopClock::Stop();
 }
 
-void AgentInstance::FeedCoap(void *aContext, int aEvent, va_list aArguments)
+void AgentInstance::HandleMdnsState(void *aContext, Mdns::State aState)
 {
-    assert(aEvent == Ncp::kEventTmfProxyStream);
+    AgentInstance *agentInstance = static_cast<AgentInstance *>(aContext);
+
+    for (uint8_t i = 0; i < agentInstance->mNetworkCount; ++i)
+    {
+        agentInstance->mNetworks[i].mBorderAgent->HandleMdnsState(aState);
+    }
+}
 
+void AgentInstance::HandleMdnsConflict(void *aContext, uint16_t aPort, const char *aType)
+{
     AgentInstance *agentInstance = static_cast<AgentInstance *>(aContext);
-    const uint8_t *buffer        = va_arg(aArguments, const uint8_t *);
-    uint16_t       length        = static_cast<uint16_t>(va_arg(aArguments, unsigned int));
-    uint16_t       locator       = static_cast<uint16_t>(va_arg(aArguments, unsigned int));
-    uint16_t       port          = static_cast<uint16_t>(va_arg(aArguments, unsigned int));
-    Ip6Address     addr(locator);
 
-    agentInstance->mCoap->Input(buffer, length, addr.m8, port);
+    // Only the border agent of the port renames its service.
+    for (uint8_t i = 0; i < agentInstance->mNetworkCount; ++i)
+    {
+        agentInstance->mNetworks[i].mBorderAgent->HandleMdnsConflict(aPort, aType);
+    }
+}
+
+void AgentInstance::FeedCoap(void *aContext, const Ncp::TmfProxyStreamEvent &aEvent)
+{
+    Network &  network = *static_cast<Network *>(aContext);
+    Ip6Address addr(aEvent.mLocator);
+
+    PacketTrace::Record(PacketTrace::kPointThreadIn, addr.m8, aEvent.mPort, aEvent.mBuffer, aEvent.mLength);
+    network.mCoap->Input(aEvent.mBuffer, aEvent.mLength, addr.m8, aEvent.mPort);
 }
 
 ssize_t AgentInstance::SendCoap(const uint8_t *aBuffer,
@@ -106,30 +892,135 @@ ssize_t AgentInstance::SendCoap(const uint8_t *aBuffer,
                                 uint16_t       aPort,
                                 void *         aContext)
 {
-    return static_cast<AgentInstance *>(aContext)->SendCoap(aBuffer, aLength, aIp6, aPort);
+    Network &         network  = *static_cast<Network *>(aContext);
+    const Ip6Address *addr     = reinterpret_cast<const Ip6Address *>(aIp6);
+    uint16_t          rloc     = addr->ToLocator();
+    Priority          priority = Coap::GetPriority(aBuffer, aLength);
+    ssize_t           ret      = -1;
+
+    PacketTrace::Record(PacketTrace::kPointThreadOut, aIp6, aPort, aBuffer, aLength);
+
+    // Messages wait behind the queued ones, which are sent by priority once the NCP has room.
+    if (!network.mTxQueue.IsEmpty())
+    {
+        VerifyOrExit(QueueCoap(network, priority, aBuffer, aLength, rloc, aPort), errno = ENOBUFS);
+        ExitNow(ret = aLength);
+    }
+
+    // Other failures are left to the CoAP layer, which retransmits confirmable messages.
+    if (network.mNcp->TmfProxySend(aBuffer, aLength, rloc, aPort) != OTBR_ERROR_NONE)
+    {
+        VerifyOrExit(errno == ENOBUFS && QueueCoap(network, priority, aBuffer, aLength, rloc, aPort),
+                     errno = ENOBUFS);
+    }
+
+    ret = aLength;
+
+exit:
+    if (ret < 0)
+    {
+        uint32_t dropped;
+        uint32_t failed;
+
+        network.mNcp->GetTmfProxyCounters(dropped, failed);
+        otbrLog(OTBR_LOG_DEBUG, "Failed to send TMF message: %s, %u dropped, %u failed", strerror(errno), dropped,
+                failed);
+    }
+
+    return ret;
 }
 
-ssize_t AgentInstance::SendCoap(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort)
+bool AgentInstance::QueueCoap(Network &      aNetwork,
+                              Priority       aPriority,
+                              const uint8_t *aBuffer,
+                              uint16_t       aLength,
+                              uint16_t       aLocator,
+                              uint16_t       aPort)
 {
-    const Ip6Address *addr = reinterpret_cast<const Ip6Address *>(aIp6);
-    uint16_t          rloc = addr->ToLocator();
+    uint8_t  packet[sizeof(aLocator) + sizeof(aPort) + kMaxTxMessage];
+    uint16_t length = static_cast<uint16_t>(sizeof(aLocator) + sizeof(aPort) + aLength);
+    bool     queued = false;
 
-    mNcp->TmfProxySend(aBuffer, aLength, rloc, aPort);
-    return aLength;
+    VerifyOrExit(aLength <= kMaxTxMessage);
+
+    if (!aNetwork.mTxQueue.IsInitialized())
+    {
+        aNetwork.mTxQueue.Init(kPriorityControl, kMaxTxControl, sizeof(packet));
+        aNetwork.mTxQueue.Init(kPriorityManagement, kMaxTxManagement, sizeof(packet));
+        aNetwork.mTxQueue.Init(kPriorityBulk, kMaxTxBulk, sizeof(packet));
+        VerifyOrExit(aNetwork.mTxQueue.IsInitialized());
+    }
+
+    // The destination is kept in front of the message.
+    memcpy(packet, &aLocator, sizeof(aLocator));
+    memcpy(packet + sizeof(aLocator), &aPort, sizeof(aPort));
+    memcpy(packet + sizeof(aLocator) + sizeof(aPort), aBuffer, aLength);
+    queued = aNetwork.mTxQueue.Push(aPriority, packet, length);
+
+exit:
+    return queued;
 }
 
-AgentInstance::~AgentInstance(void)
+void AgentInstance::FlushCoap(Network &aNetwork)
 {
-    otbrError error = OTBR_ERROR_NONE;
+    const uint8_t *packet;
+    uint16_t       length;
+    uint16_t       locator;
+    uint16_t       port;
+
+    while ((packet = aNetwork.mTxQueue.GetFront(length)) != NULL)
+    {
+        memcpy(&locator, packet, sizeof(locator));
+        memcpy(&port, packet + sizeof(locator), sizeof(port));
+
+        if (aNetwork.mNcp->TmfProxySend(packet + sizeof(locator) + sizeof(port),
+                                        static_cast<uint16_t>(length - sizeof(locator) - sizeof(port)), locator,
+                                        port) != OTBR_ERROR_NONE)
+        {
+            // The message is sent again once the NCP has room, other failures are left to the CoAP layer.
+            VerifyOrExit(errno != ENOBUFS);
+            otbrLog(OTBR_LOG_DEBUG, "Failed to send queued TMF message: %s", strerror(errno));
+        }
+
+        aNetwork.mTxQueue.Pop();
+    }
 
-    Coap::Agent::Destroy(mCoap);
+exit:
+    return;
+}
 
-    if ((error = mNcp->TmfProxyStop()))
+AgentInstance::~AgentInstance(void)
+{
+    // Border agents are told while they still exist.
+    if (mPublisher->IsStarted())
     {
-        otbrLog(OTBR_LOG_ERR, "Failed to stop TMF proxy: %d!", error);
+        mPublisher->Stop();
+    }
+
+    for (uint8_t i = 0; i < mNetworkCount; ++i)
+    {
+        Network & network = mNetworks[i];
+        otbrError error   = OTBR_ERROR_NONE;
+
+        if (!network.mTxQueue.IsEmpty())
+        {
+            otbrLog(OTBR_LOG_WARNING, "TMF proxy stopped with %u messages not sent.", network.mTxQueue.GetCount());
+        }
+
+        delete network.mNetworkData;
+        delete network.mDiagnostic;
+        delete network.mBorderAgent;
+        Coap::Agent::Destroy(network.mCoap);
+
+        if ((error = network.mNcp->TmfProxyStop()))
+        {
+            otbrLog(OTBR_LOG_ERR, "Failed to stop TMF proxy: %d!", error);
+        }
+
+        Ncp::Controller::Destroy(network.mNcp);
     }
 
-    Ncp::Controller::Destroy(mNcp);
+    Mdns::Publisher::Destroy(mPublisher);
 }
 
 } // namespace BorderRouter
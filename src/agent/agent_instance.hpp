@@ -39,9 +39,21 @@
 #include <sys/select.h>
 #include <sys/types.h>
 
+#include "admin_server.hpp"
 #include "border_agent.hpp"
 #include "coap.hpp"
+#include "mdns.hpp"
+#include "metrics_server.hpp"
 #include "ncp.hpp"
+#include "network_data.hpp"
+#include "network_diagnostic.hpp"
+#include "warm_state.hpp"
+#include "web_api_server.hpp"
+#include "common/capacity.hpp"
+#include "common/load_shedder.hpp"
+#include "common/output_scheduler.hpp"
+#include "common/reactor.hpp"
+#include "common/timer.hpp"
 
 namespace ot {
 
@@ -50,17 +62,51 @@ namespace BorderRouter {
 /**
  * This class implements an instance to host services used by border router.
  *
+ * One instance serves one or more Thread networks, each through an NCP of its own. The border agents of all networks
+ * share one MDNS publisher, and the wpantund controllers one D-Bus connection, so that the connections to the daemons
+ * do not grow with the number of networks.
+ *
+ * Instances share no state, so that each may run on a thread of its own.
+ *
  */
 class AgentInstance
 {
 public:
+    enum
+    {
+        kMaxNetworks = OTBR_CAPACITY_NETWORKS, ///< Max number of Thread networks served by an instance.
+    };
+
+    enum
+    {
+        kLoopHistorySize       = 64,  ///< Number of mainloop iterations kept for DumpLoopHistory().
+        kDefaultStallThreshold = 100, ///< Default threshold in milliseconds an iteration is logged as a stall.
+        kDefaultLoadThreshold  = 50,  ///< Default smoothed iteration time in milliseconds work is shed at.
+    };
+
     /**
      * The constructor to initialize the Thread border router agent instance.
      *
-     * @param[in]   aInterfaceName  interface name string.
+     * The border agent of network @p aFirstNetwork listens on the Thread commissioning port plus @p aFirstNetwork,
+     * the others on the following ports, so that instances serving different networks do not share ports.
+     *
+     * @param[in]   aInterfaceNames         A pointer to the interface name strings of the NCPs.
+     * @param[in]   aInterfaceCount         Number of interface names, at most kMaxNetworks are used.
+     * @param[in]   aHandshakeWorkers       The number of worker threads running DTLS handshakes.
+     * @param[in]   aMaxDtlsSessions        The max number of DTLS sessions, 0 to use the default.
+     * @param[in]   aDatasetCacheTimeout    The lifetime of cached dataset responses in milliseconds, 0 to disable.
+     * @param[in]   aPublishDelay           The window in milliseconds NCP property changes are coalesced before
+     *                                      the MDNS service is updated, negative to use the default.
+     * @param[in]   aFirstNetwork           The index of the first network among the networks of the process.
      *
      */
-    AgentInstance(const char *aInterfaceName);
+    AgentInstance(const char *const *aInterfaceNames,
+                  uint8_t            aInterfaceCount,
+                  unsigned int       aHandshakeWorkers    = 0,
+                  unsigned int       aMaxDtlsSessions     = 0,
+                  uint32_t           aDatasetCacheTimeout = 0,
+                  int                aPublishDelay        = -1,
+                  uint8_t            aFirstNetwork        = 0);
 
     ~AgentInstance(void);
 
@@ -74,9 +120,185 @@ public:
      */
     otbrError Init(void);
 
+    /**
+     * This method starts serving metrics over HTTP on the loopback interface.
+     *
+     * This method must be called after Init().
+     *
+     * @param[in]   aPort   The TCP port to serve metrics on.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully started.
+     * @retval  OTBR_ERROR_ERRNO    Failed to start, error code set in errno.
+     *
+     */
+    otbrError StartMetricsServer(uint16_t aPort) { return mMetricsServer.Start(aPort); }
+
+    /**
+     * This method starts answering admin commands on a UNIX-domain socket.
+     *
+     * Besides the commands of AdminServer, `sessions` lists the DTLS sessions of commissioners, `coap` the CoAP
+     * requests in flight, `pools` the memory of pools, `dbus` the TMF messages queued to wpantund, `mdns` the
+     * commissioning services published, `loop` the mainloop latencies, and `netdata` the Network Data of each network.
+     *
+     * This method must be called after Init().
+     *
+     * @param[in]   aPath   A pointer to the null-terminated path of the socket.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully started.
+     * @retval  OTBR_ERROR_ERRNO    Failed to start, error code set in errno.
+     *
+     */
+    otbrError StartAdminServer(const char *aPath) { return mAdminServer.Start(aPath); }
+
+    /**
+     * This method starts serving the status of the otbr-web API over HTTP, so that otbr-web need not run.
+     *
+     * `GET /get_properties` answers the document of otbr-web from the properties the NCP controllers cache, without
+     * asking the NCP, and `GET /get_network_data` the Network Data snapshot. The network is selected by the
+     * `interface` parameter of the query, the first by default.
+     *
+     * This method must be called after Init().
+     *
+     * @param[in]   aPort   The TCP port to serve the API on.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully started.
+     * @retval  OTBR_ERROR_ERRNO    Failed to start, error code set in errno.
+     *
+     */
+    otbrError StartWebApiServer(uint16_t aPort) { return mWebApiServer.Start(aPort); }
+
+    /**
+     * This method sets the time an iteration of Poll() is logged as a stall at.
+     *
+     * A stall is logged with the time each component took, and the reactor handler that took the longest.
+     *
+     * @param[in]   aThreshold  The threshold in milliseconds, 0 to disable the watchdog.
+     *
+     */
+    void SetStallThreshold(uint32_t aThreshold) { mStallThreshold = aThreshold * 1000; }
+
+    /**
+     * This method sets the smoothed time of Poll() iterations at which work of all networks is shed.
+     *
+     * Once iterations take longer, or the TMF messages waiting for the NCPs fill three quarters of their queues, the
+     * border agents shed work progressively, as BorderAgent::SetLoadLevel() describes: a level more for each second
+     * the overload lasts, a level less for each second below half the threshold.
+     *
+     * @param[in]   aThreshold  The threshold in milliseconds, 0 to never shed work.
+     *
+     */
+    void SetLoadThreshold(uint32_t aThreshold);
+
+    /**
+     * This method sets the rate limits of commissioner requests of all networks.
+     *
+     * @param[in]   aLimits     A pointer to the rate limits, in the format of BorderAgent::SetRateLimits().
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully set the rate limits.
+     * @retval  OTBR_ERROR_ERRNO    Failed to parse @p aLimits, errno is set to EINVAL.
+     *
+     */
+    otbrError SetRateLimits(const char *aLimits);
+
+    /**
+     * This method sets the time DTLS sessions of all networks are kept without receiving anything.
+     *
+     * @param[in]   aHandshakeTimeout   The timeout of handshaking sessions in milliseconds, 0 to keep it.
+     * @param[in]   aIdleTimeout        The timeout of established sessions in milliseconds, 0 to keep it.
+     *
+     */
+    void SetDtlsTimeouts(uint32_t aHandshakeTimeout, uint32_t aIdleTimeout);
+
+    /**
+     * This method sets the retransmission timeouts of DTLS handshakes and the MTU of all networks.
+     *
+     * This method must be called before Init().
+     *
+     * @param[in]   aMin        The initial retransmission timeout in milliseconds, 0 to keep it.
+     * @param[in]   aMax        The max retransmission timeout in milliseconds, 0 to keep it.
+     * @param[in]   aMtu        The MTU in bytes, in the format of BorderAgent::SetDtlsMtu().
+     *
+     */
+    void SetDtlsLink(uint32_t aMin, uint32_t aMax, uint16_t aMtu);
+
+    /**
+     * This method keeps the state of each network across restarts, in a file of a directory, must be called before
+     * Init().
+     *
+     * The file of a network is named after its interface, e.g. "wpan0.state", characters other than letters, digits,
+     * '-' and '.' replaced by '_'. A network whose file cannot be opened keeps no state.
+     *
+     * @param[in]   aDirectory  A pointer to the directory, which must exist.
+     *
+     */
+    void SetStateDirectory(const char *aDirectory);
+
+    /**
+     * This method sets the interval keep-alives of commissioners of all networks are forwarded to the leader at.
+     *
+     * @param[in]   aInterval   The interval in milliseconds, in the format of BorderAgent::SetKeepAliveInterval().
+     *
+     */
+    void SetKeepAliveInterval(uint32_t aInterval);
+
+    /**
+     * This method sets the time CoAP requests received by the border agents of all networks are remembered.
+     *
+     * @param[in]   aLifetime   The lifetime in milliseconds, in the format of BorderAgent::SetDuplicateLifetime().
+     *
+     */
+    void SetDuplicateLifetime(uint32_t aLifetime);
+
+    /**
+     * This method sets the interval the network diagnostics of all networks are collected at.
+     *
+     * @param[in]   aInterval   The interval in milliseconds, in the format of NetworkDiagnostic::SetInterval().
+     *
+     */
+    void SetDiagnosticInterval(uint32_t aInterval);
+
+    /**
+     * This method returns the network diagnostic collector of a network.
+     *
+     * @param[in]   aIndex  The index of the network, less than the number of networks.
+     *
+     * @returns A reference to the network diagnostic collector.
+     *
+     */
+    NetworkDiagnostic &GetNetworkDiagnostic(uint8_t aIndex) { return *mNetworks[aIndex].mDiagnostic; }
+
+    /**
+     * This method logs the timings of the last kLoopHistorySize iterations of Poll(), oldest first.
+     *
+     * @param[in]   aLevel  The log level.
+     *
+     */
+    void DumpLoopHistory(int aLevel) const;
+
+    /**
+     * This method sets the signal mask while Poll() waits, as Reactor::SetSignalMask() describes.
+     *
+     * @param[in]   aMask   A pointer to the signal mask while waiting, NULL to keep the one of the caller.
+     *
+     */
+    void SetSignalMask(const sigset_t *aMask) { mReactor.SetSignalMask(aMask); }
+
+    /**
+     * This method waits for and processes events of one mainloop iteration.
+     *
+     * @param[in]   aTimeout    A reference to the max time to wait.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully processed.
+     * @retval  OTBR_ERROR_ERRNO    Failed to poll, error code set in errno.
+     *
+     */
+    otbrError Poll(const timeval &aTimeout);
+
     /**
      * This method updates the file descriptor sets and timeout for mainloop.
      *
+     * This method and Process() allow running the agent inside a foreign select() based mainloop.
+     *
      * @param[inout]  aReadFdSet   A reference to read file descriptors.
      * @param[inout]  aWriteFdSet  A reference to write file descriptors.
      * @param[inout]  aErrorFdSet  A reference to error file descriptors.
@@ -97,17 +319,122 @@ public:
     void Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet);
 
 private:
+    /**
+     * This struct defines a Thread network served by the instance.
+     *
+     */
+    struct Network
+    {
+        Ncp::Controller *  mNcp;         ///< The NCP controller of the network.
+        Coap::Agent *      mCoap;        ///< The TMF agent of the network.
+        BorderAgent *      mBorderAgent; ///< The border agent of the network.
+        NetworkDiagnostic *mDiagnostic;  ///< The network diagnostic collector of the network.
+        NetworkData *      mNetworkData; ///< The Network Data cache of the network.
+        OutputScheduler    mTxQueue;     ///< TMF messages waiting for room in the NCP, with their destination.
+        const char *       mIfName;      ///< The interface name of the network.
+        WarmState          mWarmState;   ///< The state of the network kept across restarts.
+    };
+
+    enum
+    {
+        kMaxTxControl    = 8,    ///< Max number of control TMF messages waiting for the NCP.
+        kMaxTxManagement = 8,    ///< Max number of management TMF messages waiting for the NCP.
+        kMaxTxBulk       = 16,   ///< Max number of relayed TMF messages waiting for the NCP.
+        kMaxTxMessage    = 1280, ///< Max size of a TMF message waiting for the NCP.
+    };
+
+    /**
+     * Status codes of the documents of the web API, those of otbr-web so that its frontend reads them unchanged.
+     *
+     */
+    enum
+    {
+        kWebStatusOk                = 0, ///< Successfully answered.
+        kWebStatusGetPropertyFailed = 6, ///< A property is not known, or the network not found.
+    };
+
+    /**
+     * Components of a mainloop iteration.
+     *
+     */
+    enum Component
+    {
+        kComponentReactor     = 0, ///< Handlers dispatched by the reactor.
+        kComponentNcp         = 1, ///< Ncp::Controller::Process().
+        kComponentBorderAgent = 2, ///< BorderAgent::Process(), including the DTLS server.
+        kComponentPublisher   = 3, ///< Mdns::Publisher::Process().
+        kComponentTimers      = 4, ///< TimerWheel::Process().
+        kNumComponents        = 5,
+    };
+
+    /**
+     * This struct defines the timings of a mainloop iteration.
+     *
+     */
+    struct LoopTiming
+    {
+        uint64_t             mWakeTime;              ///< Monotonic microseconds the iteration woke up at.
+        uint32_t             mTimes[kNumComponents]; ///< Microseconds each component took.
+        Reactor::HandlerTime mSlowestHandler;        ///< The reactor handler that took the longest.
+    };
+
+    void RecordLoopTiming(LoopTiming &aTiming);
+    void LogLoopTiming(int aLevel, const char *aWhat, const LoopTiming &aTiming) const;
+    void UpdateLoad(uint32_t aLatency);
+    void ApplyLoadLevel(LoadShedder::Level aPrevious);
+
+    static void HandleLoadTimer(void *aContext);
+
     static ssize_t SendCoap(const uint8_t *aBuffer,
                             uint16_t       aLength,
                             const uint8_t *aIp6,
                             uint16_t       aPort,
                             void *         aContext);
-    static void    FeedCoap(void *aContext, int aEvent, va_list aArguments);
-    ssize_t        SendCoap(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort);
+    static bool    QueueCoap(Network &      aNetwork,
+                             Priority       aPriority,
+                             const uint8_t *aBuffer,
+                             uint16_t       aLength,
+                             uint16_t       aLocator,
+                             uint16_t       aPort);
+    static void    FlushCoap(Network &aNetwork);
+    static void    FeedCoap(void *aContext, const Ncp::TmfProxyStreamEvent &aEvent);
+    static void    HandleMdnsState(void *aContext, Mdns::State aState);
+    static void    HandleMdnsConflict(void *aContext, uint16_t aPort, const char *aType);
+
+    static otbrError HandleAdminSessions(void *aContext, const char *aArgs, std::string &aOutput);
+    static otbrError HandleAdminPeers(void *aContext, const char *aArgs, std::string &aOutput);
+    static otbrError HandleAdminCoap(void *aContext, const char *aArgs, std::string &aOutput);
+    static otbrError HandleAdminPools(void *aContext, const char *aArgs, std::string &aOutput);
+    static otbrError HandleAdminDbus(void *aContext, const char *aArgs, std::string &aOutput);
+    static otbrError HandleAdminMdns(void *aContext, const char *aArgs, std::string &aOutput);
+    static otbrError HandleAdminLoop(void *aContext, const char *aArgs, std::string &aOutput);
+    static otbrError HandleAdminRelay(void *aContext, const char *aArgs, std::string &aOutput);
+    static otbrError HandleAdminNetworkData(void *aContext, const char *aArgs, std::string &aOutput);
+    void             PrintSessions(std::string &aOutput) const;
+    void             PrintPeers(std::string &aOutput) const;
+    void             PrintCoap(std::string &aOutput) const;
+    void             PrintMdns(std::string &aOutput) const;
+    void             PrintLoop(std::string &aOutput) const;
+    void             PrintRelay(std::string &aOutput) const;
+
+    static otbrError HandleWebProperties(void *aContext, const char *aQuery, std::string &aOutput);
+    static otbrError HandleWebNetworkData(void *aContext, const char *aQuery, std::string &aOutput);
+    const Network *  FindNetwork(const char *aQuery) const;
+    void             PrintProperties(const char *aQuery, std::string &aOutput) const;
 
-    Ncp::Controller *mNcp;
-    Coap::Agent *    mCoap;
-    BorderAgent      mBorderAgent;
+    Reactor          mReactor;
+    TimerWheel       mTimerWheel;
+    Mdns::Publisher *mPublisher;
+    Network          mNetworks[kMaxNetworks];
+    uint8_t          mNetworkCount;
+    MetricsServer    mMetricsServer;
+    AdminServer      mAdminServer;
+    WebApiServer     mWebApiServer;
+    uint32_t         mStallThreshold; ///< Microseconds an iteration is logged as a stall at, 0 to disable.
+    LoadShedder      mLoadShedder;
+    Timer            mLoadTimer; ///< Wakes the mainloop while shedding, so that the level falls once idle.
+    LoopTiming       mLoopHistory[kLoopHistorySize];
+    unsigned int     mLoopCount;
 };
 
 } // namespace BorderRouter
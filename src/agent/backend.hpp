@@ -0,0 +1,134 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions of the backends of the border agent selected at compile time.
+ *
+ * The CoAP and DTLS interfaces have a single backend in a build, the one their Create() returns. With
+ * OTBR_ENABLE_STATIC_BACKENDS, see --enable-static-backends of configure, the hot paths call the methods of these
+ * backends without virtual dispatch, so that they may be inlined. Otherwise the interfaces are called as usual.
+ */
+
+#ifndef BACKEND_HPP_
+#define BACKEND_HPP_
+
+#include "coap.hpp"
+#include "dtls.hpp"
+
+#ifndef OTBR_ENABLE_STATIC_BACKENDS
+#define OTBR_ENABLE_STATIC_BACKENDS 0
+#endif
+
+#if OTBR_ENABLE_STATIC_BACKENDS
+#if OTBR_ENABLE_NATIVE_COAP
+#include "coap_native.hpp"
+#else
+#include "coap_libcoap.hpp"
+#endif
+#include "dtls_mbedtls.hpp"
+#endif
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Coap {
+
+#if OTBR_ENABLE_STATIC_BACKENDS && OTBR_ENABLE_NATIVE_COAP
+typedef AgentNative   AgentBackend;   ///< The CoAP agent returned by Agent::Create().
+typedef MessageNative MessageBackend; ///< The CoAP messages of AgentBackend.
+#elif OTBR_ENABLE_STATIC_BACKENDS
+typedef AgentLibcoap   AgentBackend;   ///< The CoAP agent returned by Agent::Create().
+typedef MessageLibcoap MessageBackend; ///< The CoAP messages of AgentBackend.
+#else
+typedef Agent   AgentBackend;   ///< The CoAP agent returned by Agent::Create().
+typedef Message MessageBackend; ///< The CoAP messages of AgentBackend.
+#endif
+
+} // namespace Coap
+
+namespace Dtls {
+
+#if OTBR_ENABLE_STATIC_BACKENDS
+typedef MbedtlsServer  ServerBackend;  ///< The DTLS server returned by Server::Create().
+typedef MbedtlsSession SessionBackend; ///< The DTLS sessions of ServerBackend.
+#else
+typedef Server  ServerBackend;  ///< The DTLS server returned by Server::Create().
+typedef Session SessionBackend; ///< The DTLS sessions of ServerBackend.
+#endif
+
+} // namespace Dtls
+
+/**
+ * This function converts a reference to an interface to a reference to its backend.
+ *
+ * @param[in]  aObject  A reference to the interface, which must be an instance of @p Backend.
+ *
+ * @returns A reference to the backend.
+ *
+ */
+template <typename Backend, typename Interface> inline Backend &BackendCast(Interface &aObject)
+{
+    return static_cast<Backend &>(aObject);
+}
+
+/**
+ * This function converts a reference to a const interface to a reference to its const backend.
+ *
+ * @param[in]  aObject  A reference to the interface, which must be an instance of @p Backend.
+ *
+ * @returns A reference to the backend.
+ *
+ */
+template <typename Backend, typename Interface> inline const Backend &BackendCast(const Interface &aObject)
+{
+    return static_cast<const Backend &>(aObject);
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+/**
+ * This names a method of an object to call, through its backend without virtual dispatch when the backends are
+ * selected at compile time.
+ *
+ * @param[in]  aBackend  The type of the backend, e.g. Coap::MessageBackend.
+ * @param[in]  aObject   A reference to the object, an instance of @p aBackend.
+ * @param[in]  aMethod   The name of the method.
+ *
+ */
+#if OTBR_ENABLE_STATIC_BACKENDS
+#define OTBR_BACKEND_CALL(aBackend, aObject, aMethod) \
+    ot::BorderRouter::BackendCast<aBackend>(aObject).aBackend::aMethod
+#else
+#define OTBR_BACKEND_CALL(aBackend, aObject, aMethod) (aObject).aMethod
+#endif
+
+#endif // BACKEND_HPP_
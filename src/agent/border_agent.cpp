@@ -31,20 +31,29 @@
  *   The file implements the Thread border agent.
  */
 
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_BORDER_AGENT
+
 #include "border_agent.hpp"
 
+#include <algorithm>
+
 #include <assert.h>
+#include <errno.h>
 #include <netinet/in.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "backend.hpp"
 #include "border_agent.hpp"
 #include "dtls.hpp"
 #include "ncp.hpp"
+#include "packet_trace.hpp"
 #include "uris.hpp"
 #include "common/code_utils.hpp"
 #include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
 #include "common/tlv.hpp"
 #include "common/types.hpp"
 #include "utils/hex.hpp"
@@ -54,6 +63,21 @@ namespace ot {
 namespace BorderRouter {
 
 const char kBorderAgentServiceType[] = "_meshcop._udp";
+const char kThreadVersion[]          = "1.1.1";
+
+/**
+ * Fields of the state bitmap of the MeshCoP service, as defined by the Thread specification.
+ *
+ */
+enum
+{
+    kStateConnectionModePskc  = 1 << 0, ///< DTLS sessions are established with the PSKc.
+    kStateThreadIfInitialized = 1 << 3, ///< The Thread interface is initialized but not active.
+    kStateThreadIfActive      = 2 << 3, ///< The Thread interface is initialized and active.
+    kStateAvailabilityHigh    = 1 << 5, ///< The border agent is always available.
+    kStateThreadRoleOffset    = 9,      ///< Offset of the Thread role, numbered as Ncp::ThreadRole.
+    kStateThreadRoleMask      = 3 << 9, ///< Mask of the Thread role.
+};
 
 /**
  * Locators
@@ -71,8 +95,7 @@ enum
  */
 enum
 {
-    kCoapUdpPort        = 61631, ///< Thread management UDP port.
-    kBorderAgentUdpPort = 49191, ///< Thread commissioning port.
+    kCoapUdpPort = 61631, ///< Thread management UDP port.
 };
 
 /**
@@ -81,104 +104,816 @@ enum
  */
 enum
 {
-    kJoinerRouterLocator = 20, ///< meshcop Joiner Router Locator TLV
+    kCommissionerSessionId = 11, ///< meshcop Commissioner Session ID TLV
+    kState                 = 16, ///< meshcop State TLV
+    kJoinerIid             = 19, ///< meshcop Joiner IID TLV
+    kJoinerRouterLocator   = 20, ///< meshcop Joiner Router Locator TLV
 };
 
-void BorderAgent::ForwardCommissionerResponse(const Coap::Message &aMessage)
+/**
+ * State TLV values
+ *
+ */
+enum
 {
-    uint8_t        tokenLength = 0;
-    const uint8_t *token       = aMessage.GetToken(tokenLength);
-    uint16_t       length      = 0;
-    const uint8_t *payload     = NULL;
+    kStateAccept = 1,    ///< Accept
+    kStateReject = 0xff, ///< Reject
+};
 
-    Coap::Code     code    = aMessage.GetCode();
-    Coap::Message *message = mCoaps->NewMessage(Coap::kTypeNonConfirmable, code, token, tokenLength);
+/**
+ * Limits of per-packet logs
+ *
+ */
+enum
+{
+    kLogBurst    = 10,   ///< Max number of logs of a packet site every interval.
+    kLogInterval = 1000, ///< Interval of per-packet logs in milliseconds.
+};
+
+static Metrics::Histogram sLeaderRoundTrip("border_agent.leader_rtt_us");
+static Metrics::Histogram sRelayTransmitTime("border_agent.relay_tx_us");
+static Metrics::Histogram sRelayReceiveTime("border_agent.relay_rx_us");
+static Metrics::Counter   sInvalidSession("border_agent.invalid_session");
+static Metrics::Counter   sLocalKeepAlive("border_agent.local_keep_alive");
+static Metrics::Counter   sLeaderTimeout("border_agent.leader_timeout");
+static Metrics::Counter   sEnergyReports("border_agent.energy_reports");
+static Metrics::Counter   sPanIdConflicts("border_agent.panid_conflicts");
+static Metrics::Counter   sNameConflicts("border_agent.name_conflicts");
+static Metrics::Counter   sDatasetNotifications("border_agent.dataset_notifications");
+static Metrics::Counter   sShedPetitions("border_agent.shed_petitions");
+static Metrics::Counter   sShedRelay("border_agent.shed_relay");
+
+// Requests rejected by each rate limit, in the order of the limits.
+static Metrics::Counter sRateLimitedSession("border_agent.rate_limited_session");
+static Metrics::Counter sRateLimitedActiveGet("border_agent.rate_limited_active_get");
+static Metrics::Counter sRateLimitedActiveSet("border_agent.rate_limited_active_set");
+static Metrics::Counter sRateLimitedPendingGet("border_agent.rate_limited_pending_get");
+static Metrics::Counter sRateLimitedPendingSet("border_agent.rate_limited_pending_set");
+static Metrics::Counter sRateLimitedPetition("border_agent.rate_limited_petition");
+static Metrics::Counter sRateLimitedKeepAlive("border_agent.rate_limited_keep_alive");
+static Metrics::Counter sRateLimitedCommissionerSet("border_agent.rate_limited_commissioner_set");
+static Metrics::Counter sRateLimitedRelayTransmit("border_agent.rate_limited_relay_tx");
+static Metrics::Counter sRateLimitedEnergyScan("border_agent.rate_limited_energy_scan");
+static Metrics::Counter sRateLimitedPanIdQuery("border_agent.rate_limited_panid_query");
+
+static Metrics::Counter *const sRateLimited[] = {&sRateLimitedSession,       &sRateLimitedActiveGet,
+                                                  &sRateLimitedActiveSet,     &sRateLimitedPendingGet,
+                                                  &sRateLimitedPendingSet,    &sRateLimitedPetition,
+                                                  &sRateLimitedKeepAlive,     &sRateLimitedCommissionerSet,
+                                                  &sRateLimitedRelayTransmit, &sRateLimitedEnergyScan,
+                                                  &sRateLimitedPanIdQuery};
+
+const char kRateLimitSessionKey[] = "session";
 
-    otbrLog(OTBR_LOG_INFO, "Forwarding CommissionerResponse ...");
+/**
+ * This function copies the block-wise transfer options of a forwarded message.
+ *
+ * Blocks are forwarded one exchange at a time as the peers drive the transfer, so a large dataset is never
+ * reassembled here.
+ *
+ */
+static void CopyBlockOptions(const Coap::Message &aFrom, Coap::Message &aTo)
+{
+    // In ascending order of option numbers.
+    static const Coap::Option kBlockOptions[] = {Coap::kOptionBlock2, Coap::kOptionBlock1, Coap::kOptionSize2,
+                                                 Coap::kOptionSize1};
 
-    payload = aMessage.GetPayload(length);
-    message->SetPayload(payload, length);
+    for (size_t i = 0; i < sizeof(kBlockOptions) / sizeof(kBlockOptions[0]); ++i)
+    {
+        uint32_t value;
 
-    mCoaps->Send(*message, NULL, 0, NULL, NULL);
-    mCoaps->FreeMessage(message);
+        if (aFrom.GetUintOption(kBlockOptions[i], value))
+        {
+            aTo.AddUintOption(kBlockOptions[i], value);
+        }
+    }
 }
 
-void BorderAgent::ForwardCommissionerRequest(const Coap::Resource &aResource,
-                                             const Coap::Message & aMessage,
-                                             const uint8_t *       aIp6,
-                                             uint16_t              aPort)
+void BorderAgent::ForwardCommissionerResponse(Commissioner &       aCommissioner,
+                                              const Coap::Message &aMessage,
+                                              const uint8_t *      aToken,
+                                              uint8_t              aTokenLength)
 {
-    uint8_t        tokenLength = 0;
-    const uint8_t *token       = aMessage.GetToken(tokenLength);
-    const char *   path        = aResource.mPath;
+    uint16_t       length  = 0;
+    const uint8_t *payload = NULL;
 
-    Coap::Message *message = mCoap->NewMessage(Coap::kTypeConfirmable, Coap::kCodePost, token, tokenLength);
-    Ip6Address     addr(kAloc16Leader);
+    // The commissioner left while its request was in flight.
+    VerifyOrExit(aCommissioner.mSession != NULL);
+
+    if (aCommissioner.mRequestTime != 0 && aCommissioner.mRequestTokenLength == aTokenLength &&
+        memcmp(aCommissioner.mRequestToken, aToken, aTokenLength) == 0)
+    {
+        sLeaderRoundTrip.Record(GetMonotonicNowUs() - aCommissioner.mRequestTime);
+        aCommissioner.mRequestTime = 0;
+    }
+
+    {
+        Coap::ScopedMessage message(*mCoaps, Coap::kTypeNonConfirmable,
+                                    OTBR_BACKEND_CALL(Coap::MessageBackend, aMessage, GetCode)(), aToken, aTokenLength);
+
+        otbrLog(OTBR_LOG_INFO, "Forwarding CommissionerResponse ...");
+
+        AddObserveOption(aCommissioner, aToken, aTokenLength, *message);
+        CopyBlockOptions(aMessage, *message);
+        payload = OTBR_BACKEND_CALL(Coap::MessageBackend, aMessage, GetPayload)(length);
+
+        OTBR_BACKEND_CALL(Coap::AgentBackend, *mCoaps, SendPayload)(*message, payload, length, aCommissioner.mIp6,
+                                                                    aCommissioner.mPort);
+    }
+
+exit:
+    return;
+}
+
+void BorderAgent::ForwardPetitionResponse(Commissioner &       aCommissioner,
+                                          const Coap::Message &aMessage,
+                                          const uint8_t *      aToken,
+                                          uint8_t              aTokenLength)
+{
     uint16_t       length  = 0;
     const uint8_t *payload = aMessage.GetPayload(length);
+    TlvIndex       index;
+    const Tlv *    state;
+    const Tlv *    sessionId;
 
-    otbrLog(OTBR_LOG_INFO, "Forwarding request %s...", path);
+    index.Build(payload, length);
+    state     = index.Get(kState);
+    sessionId = index.Get(kCommissionerSessionId);
 
-    if (!strcmp(OT_URI_PATH_COMMISSIONER_PETITION, path))
+    if (state != NULL)
     {
-        path = OT_URI_PATH_LEADER_PETITION;
+        // Relayed joiner traffic goes to the commissioner the leader accepted last.
+        if (state->GetLength() == sizeof(uint8_t) && state->GetValueUInt8() == kStateAccept &&
+            aCommissioner.mSession != NULL)
+        {
+            mActiveCommissioner       = &aCommissioner;
+            aCommissioner.mAcceptTime = LoopClock::GetNow();
+
+            if (sessionId != NULL && sessionId->GetLength() == sizeof(uint16_t))
+            {
+                aCommissioner.mSessionId = sessionId->GetValueUInt16();
+            }
+        }
+        else
+        {
+            aCommissioner.mAcceptTime = 0;
+
+            if (mActiveCommissioner == &aCommissioner)
+            {
+                mActiveCommissioner = NULL;
+            }
+        }
     }
-    else if (!strcmp(OT_URI_PATH_COMMISSIONER_KEEP_ALIVE, path))
+
+    ForwardCommissionerResponse(aCommissioner, aMessage, aToken, aTokenLength);
+}
+
+void BorderAgent::SetDatasetCacheTimeout(uint32_t aTimeout)
+{
+    mDatasetCacheTimeout = aTimeout;
+    InvalidateDatasetCache();
+}
+
+void BorderAgent::InvalidateDatasetCache(void)
+{
+    for (size_t i = 0; i < sizeof(mDatasetCache) / sizeof(mDatasetCache[0]); ++i)
     {
-        path = OT_URI_PATH_LEADER_KEEP_ALIVE;
+        DatasetCacheEntry &entry = mDatasetCache[i];
+
+        // Requests waiting for a query in flight still get its response, which is not cached.
+        if (entry.mInFlight)
+        {
+            entry.mStale = true;
+        }
+        else
+        {
+            entry.mResource = NULL;
+        }
     }
+}
 
-    message->SetPath(path);
+bool BorderAgent::QueryDatasetCache(const ForwardResource &aResource,
+                                    Commissioner &         aCommissioner,
+                                    const Coap::Message &  aMessage,
+                                    DatasetCacheEntry *&   aEntry)
+{
+    uint8_t            tokenLength = 0;
+    const uint8_t *    token       = aMessage.GetToken(tokenLength);
+    uint16_t           length      = 0;
+    const uint8_t *    payload     = aMessage.GetPayload(length);
+    uint64_t           now         = LoopClock::GetNow();
+    DatasetCacheEntry *entry       = NULL;
+    DatasetCacheEntry *unused      = NULL;
+    bool               handled     = false;
+    uint32_t           block;
+
+    aEntry = NULL;
+
+    // Block-wise queries are left to the peers.
+    VerifyOrExit(mDatasetCacheTimeout > 0 && length <= kMaxDatasetQuery && tokenLength <= kMaxTokenLength &&
+                 !aMessage.GetUintOption(Coap::kOptionBlock2, block));
+
+    for (size_t i = 0; i < sizeof(mDatasetCache) / sizeof(mDatasetCache[0]); ++i)
+    {
+        DatasetCacheEntry &candidate = mDatasetCache[i];
 
-    message->SetPayload(payload, length);
+        // A query without a response by its deadline is given up, a late response only goes to its requester.
+        if (candidate.mResource != NULL && candidate.mDeadline <= now)
+        {
+            candidate.mResource = NULL;
+            candidate.mInFlight = false;
+        }
 
-    otbrDump(OTBR_LOG_DEBUG, "    Payload:", payload, length);
+        if (candidate.mResource == NULL)
+        {
+            if (unused == NULL)
+            {
+                unused = &candidate;
+            }
+        }
+        else if (candidate.mResource == &aResource && !candidate.mStale && candidate.mQueryLength == length &&
+                 memcmp(candidate.mQuery, payload, length) == 0)
+        {
+            entry = &candidate;
+        }
+    }
 
-    mCoap->Send(*message, addr.m8, kCoapUdpPort, BorderAgent::ForwardCommissionerResponse, this);
-    mCoap->FreeMessage(message);
+    if (entry == NULL)
+    {
+        // Without a free entry the query is forwarded on its own.
+        VerifyOrExit(unused != NULL);
+
+        entry                            = unused;
+        entry->mResource                 = &aResource;
+        entry->mQueryLength              = length;
+        entry->mDeadline                 = now + kDatasetQueryTimeout;
+        entry->mInFlight                 = true;
+        entry->mStale                    = false;
+        entry->mWaiterCount              = 1;
+        entry->mWaiters[0].mCommissioner = &aCommissioner;
+        entry->mWaiters[0].mTokenLength  = tokenLength;
+        memcpy(entry->mQuery, payload, length);
+        memcpy(entry->mWaiters[0].mToken, token, tokenLength);
+
+        aEntry = entry;
+    }
+    else if (entry->mInFlight)
+    {
+        DatasetWaiter *waiter = NULL;
 
-    (void)aIp6;
-    (void)aPort;
+        VerifyOrExit(entry->mWaiterCount < kDatasetCacheWaiters);
+
+        waiter                = &entry->mWaiters[entry->mWaiterCount++];
+        waiter->mCommissioner = &aCommissioner;
+        waiter->mTokenLength  = tokenLength;
+        memcpy(waiter->mToken, token, tokenLength);
+
+        otbrLog(OTBR_LOG_DEBUG, "Request %s waits for the one in flight", aResource.mPath);
+        handled = true;
+    }
+    else
+    {
+        Coap::ScopedMessage message(*mCoaps, Coap::kTypeNonConfirmable, entry->mCode, token, tokenLength);
+
+        otbrLog(OTBR_LOG_DEBUG, "Request %s answered from cache", aResource.mPath);
+
+        AddObserveOption(aCommissioner, token, tokenLength, *message);
+        message->SetPayload(entry->mResponse, entry->mResponseLength);
+        mCoaps->Send(*message, aCommissioner.mIp6, aCommissioner.mPort, NULL, NULL);
+        handled = true;
+    }
+
+exit:
+    return handled;
 }
 
-void BorderAgent::HandleRelayReceive(const Coap::Message &aMessage, const uint8_t *aIp6, uint16_t aPort)
+void BorderAgent::HandleDatasetResponse(DatasetCacheEntry &aEntry, const Coap::Message &aMessage)
 {
     uint8_t        tokenLength = 0;
     const uint8_t *token       = aMessage.GetToken(tokenLength);
     uint16_t       length      = 0;
     const uint8_t *payload     = aMessage.GetPayload(length);
+    uint32_t       block;
+
+    // The entry was given up and may since be reused by another query, its requesters are not waiting any more.
+    if (aEntry.mResource == NULL || !aEntry.mInFlight || aEntry.mWaiters[0].mTokenLength != tokenLength ||
+        memcmp(aEntry.mWaiters[0].mToken, token, tokenLength) != 0)
+    {
+        otbrLog(OTBR_LOG_DEBUG, "Dropping late dataset response");
+        ExitNow();
+    }
+
+    for (uint8_t i = 0; i < aEntry.mWaiterCount; ++i)
+    {
+        const DatasetWaiter &waiter = aEntry.mWaiters[i];
+
+        ForwardCommissionerResponse(*waiter.mCommissioner, aMessage, waiter.mToken, waiter.mTokenLength);
+    }
+
+    aEntry.mInFlight = false;
+
+    if (!aEntry.mStale && aMessage.GetCode() == Coap::kCodeChanged && length <= kMaxDatasetResponse &&
+        !aMessage.GetUintOption(Coap::kOptionBlock2, block))
+    {
+        aEntry.mCode           = aMessage.GetCode();
+        aEntry.mResponseLength = length;
+        aEntry.mDeadline       = LoopClock::GetNow() + mDatasetCacheTimeout;
+        memcpy(aEntry.mResponse, payload, length);
+    }
+    else
+    {
+        aEntry.mResource = NULL;
+    }
+
+exit:
+    return;
+}
+
+void BorderAgent::UpdateDatasetObserver(const ForwardResource &aResource,
+                                        Commissioner &         aCommissioner,
+                                        const Coap::Message &  aMessage)
+{
+    uint8_t          tokenLength = 0;
+    const uint8_t *  token       = aMessage.GetToken(tokenLength);
+    uint16_t         length      = 0;
+    const uint8_t *  payload     = aMessage.GetPayload(length);
+    DatasetObserver *observer    = FindDatasetObserver(aCommissioner, token, tokenLength);
+    uint32_t         observe;
+    uint32_t         block;
+
+    // Any other request with the token of an observation ends it, a registration starts it again.
+    if (observer != NULL)
+    {
+        RemoveDatasetObserver(*observer);
+        observer = NULL;
+    }
+
+    VerifyOrExit(aMessage.GetUintOption(Coap::kOptionObserve, observe) && observe == kObserveRegister);
+
+    // Queries that cannot be repeated are answered once, as if the Observe option were not supported.
+    VerifyOrExit(tokenLength <= kMaxTokenLength && length <= kMaxDatasetQuery &&
+                 !aMessage.GetUintOption(Coap::kOptionBlock2, block));
+
+    for (size_t i = 0; i < kMaxDatasetObservers; ++i)
+    {
+        if (mDatasetObservers[i].mResource == NULL)
+        {
+            observer = &mDatasetObservers[i];
+            break;
+        }
+    }
+
+    VerifyOrExit(observer != NULL, otbrLog(OTBR_LOG_WARNING, "Too many observers, %s answered once", aResource.mPath));
+
+    observer->mResource     = &aResource;
+    observer->mCommissioner = &aCommissioner;
+    observer->mTokenLength  = tokenLength;
+    observer->mQueryLength  = length;
+    observer->mSequence     = 0;
+    memcpy(observer->mToken, token, tokenLength);
+    memcpy(observer->mQuery, payload, length);
+    mDatasetObserverCount++;
+
+    otbrLog(OTBR_LOG_INFO, "Commissioner observes %s", aResource.mPath);
+
+exit:
+    return;
+}
 
-    Coap::Message *message = mCoaps->NewMessage(Coap::kTypeNonConfirmable, Coap::kCodePost, token, tokenLength);
-    otbrLog(OTBR_LOG_INFO, "Handle Relay receive ...");
+BorderAgent::DatasetObserver *BorderAgent::FindDatasetObserver(const Commissioner &aCommissioner,
+                                                               const uint8_t *     aToken,
+                                                               uint8_t             aTokenLength)
+{
+    DatasetObserver *observer = NULL;
+
+    VerifyOrExit(mDatasetObserverCount > 0);
+
+    for (size_t i = 0; i < kMaxDatasetObservers; ++i)
+    {
+        DatasetObserver &candidate = mDatasetObservers[i];
+
+        if (candidate.mResource != NULL && candidate.mCommissioner == &aCommissioner &&
+            candidate.mTokenLength == aTokenLength && memcmp(candidate.mToken, aToken, aTokenLength) == 0)
+        {
+            observer = &candidate;
+            break;
+        }
+    }
 
-    message->SetPath(OT_URI_PATH_RELAY_RX);
-    message->SetPayload(payload, length);
+exit:
+    return observer;
+}
 
-    mCoaps->Send(*message, NULL, 0, NULL, NULL);
-    mCoaps->FreeMessage(message);
+void BorderAgent::RemoveDatasetObserver(DatasetObserver &aObserver)
+{
+    otbrLog(OTBR_LOG_INFO, "Commissioner stops observing %s", aObserver.mResource->mPath);
+
+    aObserver.mResource = NULL;
+    mDatasetObserverCount--;
+}
+
+void BorderAgent::AddObserveOption(const Commissioner &aCommissioner,
+                                   const uint8_t *     aToken,
+                                   uint8_t             aTokenLength,
+                                   Coap::Message &     aMessage)
+{
+    DatasetObserver *observer = FindDatasetObserver(aCommissioner, aToken, aTokenLength);
+
+    VerifyOrExit(observer != NULL);
+
+    // A response without the Observe option ends the observation at the commissioner too.
+    if (aMessage.GetCode() != Coap::kCodeChanged)
+    {
+        RemoveDatasetObserver(*observer);
+        ExitNow();
+    }
+
+    observer->mSequence = (observer->mSequence + 1) & kMaxObserveValue;
+    aMessage.AddUintOption(Coap::kOptionObserve, observer->mSequence);
+
+exit:
+    return;
+}
+
+void BorderAgent::HandleDatasetChange(void)
+{
+    InvalidateDatasetCache();
+
+    // Changes arrive in bursts, e.g. the NCP reporting each property, observers are notified once they settled.
+    if (mDatasetObserverCount > 0 && !mObserveTimer.IsRunning())
+    {
+        mTimerWheel->Start(mObserveTimer, kObserveDelay);
+    }
+}
+
+void BorderAgent::NotifyDatasetObservers(void)
+{
+    // Observers are notified once the Thread network is up again.
+    VerifyOrExit(mThreadStarted);
+
+    for (size_t i = 0; i < kMaxDatasetObservers; ++i)
+    {
+        DatasetObserver &observer = mDatasetObservers[i];
+
+        if (observer.mResource == NULL)
+        {
+            continue;
+        }
+
+        {
+            // Identical queries of observers share one leader request through the dataset cache.
+            Coap::ScopedMessage query(*mCoaps, Coap::kTypeConfirmable, Coap::kCodePost, observer.mToken,
+                                      observer.mTokenLength);
+
+            query->SetPayload(observer.mQuery, observer.mQueryLength);
+            sDatasetNotifications.Add();
+            ForwardToLeader(*observer.mResource, *observer.mCommissioner, *query);
+        }
+    }
+
+exit:
+    return;
+}
+
+void BorderAgent::HandleDatasetChanged(const Coap::Message &aMessage, const uint8_t *aIp6, uint16_t aPort)
+{
+    otbrLog(OTBR_LOG_INFO, "Handle dataset changed ...");
+
+    HandleDatasetChange();
+    ForwardToCommissioner(aMessage);
 
     (void)aIp6;
     (void)aPort;
 }
 
-void BorderAgent::HandleRelayTransmit(const Coap::Message &aMessage, const uint8_t *aIp6, uint16_t aPort)
+void BorderAgent::HandleEnergyReport(const Coap::Message &aMessage, const uint8_t *aIp6, uint16_t aPort)
 {
     uint16_t       length  = 0;
-    const uint8_t *payload = aMessage.GetPayload(length);
-    uint16_t       rloc    = kInvalidLocator;
+    const uint8_t *payload = OTBR_BACKEND_CALL(Coap::MessageBackend, aMessage, GetPayload)(length);
 
-    otbrDump(OTBR_LOG_DEBUG, "Relay transmit:", payload, length);
+    sEnergyReports.Add();
+
+    if (!mChannelSurvey.AddEnergyReport(payload, length))
+    {
+        otbrLogRateLimited(OTBR_LOG_WARNING, kLogBurst, kLogInterval, "Invalid energy report!");
+    }
+
+    ForwardToCommissioner(aMessage);
+
+    (void)aIp6;
+    (void)aPort;
+}
+
+void BorderAgent::HandlePanIdConflict(const Coap::Message &aMessage, const uint8_t *aIp6, uint16_t aPort)
+{
+    uint16_t       length  = 0;
+    const uint8_t *payload = OTBR_BACKEND_CALL(Coap::MessageBackend, aMessage, GetPayload)(length);
+    Ip6Address     reporter;
+
+    memcpy(reporter.m8, aIp6, sizeof(reporter.m8));
+    sPanIdConflicts.Add();
+
+    if (!mChannelSurvey.AddPanIdConflict(payload, length, reporter.ToLocator()))
+    {
+        otbrLogRateLimited(OTBR_LOG_WARNING, kLogBurst, kLogInterval, "Invalid PAN ID conflict report!");
+    }
+
+    ForwardToCommissioner(aMessage);
+
+    (void)aPort;
+}
+
+void BorderAgent::ForwardToCommissioner(const Coap::Message &aMessage)
+{
+    VerifyOrExit(mActiveCommissioner != NULL, otbrLog(OTBR_LOG_WARNING, "No active commissioner!"));
+    mCoaps->Forward(aMessage, mActiveCommissioner->mIp6, mActiveCommissioner->mPort);
+
+exit:
+    return;
+}
+
+void BorderAgent::ForwardCommissionerRequest(const ForwardResource &aResource,
+                                             const Coap::Message &  aMessage,
+                                             Coap::Message &        aResponse,
+                                             const uint8_t *        aIp6,
+                                             uint16_t               aPort)
+{
+    Commissioner *commissioner = FindCommissioner(aIp6, aPort);
 
-    for (const Tlv *tlv = reinterpret_cast<const Tlv *>(payload); tlv < reinterpret_cast<const Tlv *>(payload + length);
-         tlv            = tlv->GetNext())
+    VerifyOrExit(commissioner != NULL, otbrLog(OTBR_LOG_WARNING, "Request %s from unknown peer!", aResource.mPath));
+
+    // Rejected before anything is allocated for the leader.
+    VerifyOrExit(AdmitRequest(*commissioner, aResource, aMessage, aResponse));
+    VerifyOrExit(AdmitUnderLoad(*commissioner, aResource, aMessage, aResponse));
+    VerifyOrExit(ValidateSession(*commissioner, aResource, aMessage, aResponse));
+    VerifyOrExit(!AnswerKeepAlive(*commissioner, aResource, aMessage, aResponse));
+
+    if (&aResource == &mActiveGet || &aResource == &mPendingGet)
+    {
+        UpdateDatasetObserver(aResource, *commissioner, aMessage);
+    }
+
+    ForwardToLeader(aResource, *commissioner, aMessage);
+
+exit:
+    return;
+}
+
+void BorderAgent::ForwardToLeader(const ForwardResource &aResource,
+                                  Commissioner &         aCommissioner,
+                                  const Coap::Message &  aMessage)
+{
+    uint8_t            tokenLength = 0;
+    const uint8_t *    token       = OTBR_BACKEND_CALL(Coap::MessageBackend, aMessage, GetToken)(tokenLength);
+    DatasetCacheEntry *entry       = NULL;
+
+    Coap::ScopedMessage message(*mCoap, Coap::kTypeConfirmable, Coap::kCodePost, token, tokenLength);
+    Ip6Address          addr(kAloc16Leader);
+    uint16_t            length  = 0;
+    const uint8_t *     payload = OTBR_BACKEND_CALL(Coap::MessageBackend, aMessage, GetPayload)(length);
+
+    if (&aResource == &mActiveGet || &aResource == &mPendingGet)
+    {
+        VerifyOrExit(!QueryDatasetCache(aResource, aCommissioner, aMessage, entry));
+    }
+    else if (&aResource == &mActiveSet || &aResource == &mPendingSet)
+    {
+        InvalidateDatasetCache();
+    }
+
+    otbrLogRateLimited(OTBR_LOG_INFO, kLogBurst, kLogInterval, "Forwarding request %s...", aResource.mPath);
+
+    OTBR_BACKEND_CALL(Coap::MessageBackend, *message, SetPathEncoded)(aResource.mLeaderPath);
+    CopyBlockOptions(aMessage, *message);
+
+    OTBR_BACKEND_CALL(Coap::MessageBackend, *message, SetPayload)(payload, length);
+
+    otbrDump(OTBR_LOG_DEBUG, "    Payload:", payload, length);
+
+    // Only the last request of a commissioner is timed, commissioners rarely have more than one in flight.
+    if (tokenLength <= kMaxTokenLength)
+    {
+        aCommissioner.mRequestTime        = GetMonotonicNowUs();
+        aCommissioner.mRequestTokenLength = tokenLength;
+        memcpy(aCommissioner.mRequestToken, token, tokenLength);
+    }
+
+    if (entry != NULL)
+    {
+        if (OTBR_BACKEND_CALL(Coap::AgentBackend, *mCoap, Send)(*message, addr.m8, kCoapUdpPort,
+                                                                BorderAgent::HandleDatasetResponse,
+                                                                entry) != OTBR_ERROR_NONE)
+        {
+            entry->mResource = NULL;
+            entry->mInFlight = false;
+        }
+    }
+    else
     {
-        if (tlv->GetType() == kJoinerRouterLocator)
+        PendingForward *pending = NewPendingForward(aResource, aCommissioner, token, tokenLength);
+
+        // Answered as the leader is unreachable, so that the commissioner does not wait for it.
+        if (pending == NULL ||
+            OTBR_BACKEND_CALL(Coap::AgentBackend, *mCoap, Send)(*message, addr.m8, kCoapUdpPort, HandleForwardResponse,
+                                                                pending) != OTBR_ERROR_NONE)
         {
-            rloc = tlv->GetValueUInt16();
+            otbrLogRateLimited(OTBR_LOG_WARNING, kLogBurst, kLogInterval, "Failed to forward request %s",
+                               aResource.mPath);
+            RespondCommissioner(aCommissioner, Coap::kCodeServiceUnavailable, token, tokenLength);
+
+            if (pending != NULL)
+            {
+                pending->mResource = NULL;
+            }
+        }
+    }
+
+    otbrLog(OTBR_LOG_DEBUG, "In flight to leader: %u petitions, %u keep-alives", GetPendingPetitions(),
+            GetPendingKeepAlives());
+
+exit:
+    return;
+}
+
+BorderAgent::PendingForward *BorderAgent::NewPendingForward(const ForwardResource &aResource,
+                                                            Commissioner &         aCommissioner,
+                                                            const uint8_t *        aToken,
+                                                            uint8_t                aTokenLength)
+{
+    PendingForward *pending = NULL;
+
+    VerifyOrExit(aTokenLength <= kMaxTokenLength);
+
+    for (size_t i = 0; i < kMaxPendingForwards; ++i)
+    {
+        if (mPendingForwards[i].mResource == NULL)
+        {
+            pending = &mPendingForwards[i];
             break;
         }
     }
 
+    VerifyOrExit(pending != NULL);
+
+    pending->mResource     = &aResource;
+    pending->mCommissioner = &aCommissioner;
+    pending->mTokenLength  = aTokenLength;
+    pending->mDeadline     = LoopClock::GetNow() + kForwardTimeout;
+    memcpy(pending->mToken, aToken, aTokenLength);
+
+    if (!mForwardTimer.IsRunning())
+    {
+        mTimerWheel->Start(mForwardTimer, kForwardTimeout);
+    }
+
+exit:
+    return pending;
+}
+
+void BorderAgent::HandleForwardResponse(PendingForward &aPending, const Coap::Message &aMessage)
+{
+    uint8_t                tokenLength  = 0;
+    const uint8_t *        token        = aMessage.GetToken(tokenLength);
+    const ForwardResource *resource     = aPending.mResource;
+    Commissioner *         commissioner = aPending.mCommissioner;
+
+    // The request was answered with 5.04, and the entry may since be reused by another one.
+    VerifyOrExit(resource != NULL && aPending.mTokenLength == tokenLength &&
+                     memcmp(aPending.mToken, token, tokenLength) == 0,
+                 otbrLog(OTBR_LOG_DEBUG, "Dropping late leader response"));
+
+    aPending.mResource = NULL;
+    VerifyOrExit(commissioner != NULL);
+
+    (this->*resource->mResponseHandler)(*commissioner, aMessage, token, tokenLength);
+
+exit:
+    return;
+}
+
+void BorderAgent::HandleForwardTimer(void)
+{
+    uint64_t now = LoopClock::GetNow();
+
+    for (size_t i = 0; i < kMaxPendingForwards; ++i)
+    {
+        PendingForward &pending = mPendingForwards[i];
+
+        if (pending.mResource == NULL || pending.mDeadline > now)
+        {
+            continue;
+        }
+
+        sLeaderTimeout.Add();
+        otbrLog(OTBR_LOG_WARNING, "Request %s timed out at the leader", pending.mResource->mPath);
+        pending.mResource = NULL;
+
+        if (pending.mCommissioner != NULL)
+        {
+            RespondCommissioner(*pending.mCommissioner, Coap::kCodeGatewayTimeout, pending.mToken,
+                                pending.mTokenLength);
+        }
+    }
+
+    UpdateForwardTimer();
+}
+
+void BorderAgent::UpdateForwardTimer(void)
+{
+    uint64_t deadline = 0;
+
+    for (size_t i = 0; i < kMaxPendingForwards; ++i)
+    {
+        const PendingForward &pending = mPendingForwards[i];
+
+        if (pending.mResource != NULL && (deadline == 0 || pending.mDeadline < deadline))
+        {
+            deadline = pending.mDeadline;
+        }
+    }
+
+    if (deadline != 0)
+    {
+        mTimerWheel->StartAt(mForwardTimer, deadline);
+    }
+}
+
+void BorderAgent::RespondCommissioner(const Commissioner &aCommissioner,
+                                      Coap::Code          aCode,
+                                      const uint8_t *     aToken,
+                                      uint8_t             aTokenLength)
+{
+    Coap::ScopedMessage message(*mCoaps, Coap::kTypeNonConfirmable, aCode, aToken, aTokenLength);
+
+    VerifyOrExit(aCommissioner.mSession != NULL);
+    AddObserveOption(aCommissioner, aToken, aTokenLength, *message);
+    mCoaps->Send(*message, aCommissioner.mIp6, aCommissioner.mPort, NULL, NULL);
+
+exit:
+    return;
+}
+
+unsigned int BorderAgent::GetPendingPetitions(void) const
+{
+    return mCoap->GetTransactionCount(OT_URI_PATH_LEADER_PETITION);
+}
+
+unsigned int BorderAgent::GetPendingKeepAlives(void) const
+{
+    return mCoap->GetTransactionCount(OT_URI_PATH_LEADER_KEEP_ALIVE);
+}
+
+void BorderAgent::HandleRelayReceive(const Coap::Message &aMessage, const uint8_t *aIp6, uint16_t aPort)
+{
+    otbrLogRateLimited(OTBR_LOG_INFO, kLogBurst, kLogInterval, "Handle Relay receive ...");
+
+    VerifyOrExit(mActiveCommissioner != NULL, otbrLog(OTBR_LOG_WARNING, "No active commissioner!"));
+    VerifyOrExit(mLoadLevel < LoadShedder::kLevelDropRelay, sShedRelay.Add());
+
+    // The relayed message keeps its path, token and payload, so it is forwarded without being rebuilt.
+    {
+        uint64_t start = GetMonotonicNowUs();
+        uint32_t elapsed;
+
+        OTBR_BACKEND_CALL(Coap::AgentBackend, *mCoaps, Forward)(aMessage, mActiveCommissioner->mIp6,
+                                                                mActiveCommissioner->mPort);
+        elapsed = static_cast<uint32_t>(GetMonotonicNowUs() - start);
+        sRelayReceiveTime.Record(elapsed);
+        RecordRelayFlow(RelayFlowTable::kDirectionReceive, aMessage, start, elapsed);
+    }
+
+exit:
+    (void)aIp6;
+    (void)aPort;
+}
+
+void BorderAgent::HandleRelayTransmit(const Coap::Message &aMessage,
+                                      Coap::Message &      aResponse,
+                                      const uint8_t *      aIp6,
+                                      uint16_t             aPort)
+{
+    uint64_t       start        = GetMonotonicNowUs();
+    uint16_t       length       = 0;
+    const uint8_t *payload      = OTBR_BACKEND_CALL(Coap::MessageBackend, aMessage, GetPayload)(length);
+    uint16_t       rloc         = kInvalidLocator;
+    Commissioner * commissioner = FindCommissioner(aIp6, aPort);
+
+    VerifyOrExit(commissioner == NULL ||
+                 AdmitRequest(*commissioner, mCommissionerRelayTransmitHandler, aMessage, aResponse));
+    VerifyOrExit(mLoadLevel < LoadShedder::kLevelDropRelay, sShedRelay.Add());
+
+    otbrDump(OTBR_LOG_DEBUG, "Relay transmit:", payload, length);
+
+    {
+        TlvReader  reader(payload, length);
+        const Tlv *locator = reader.Find(kJoinerRouterLocator);
+
+        if (locator != NULL && locator->GetLength() == sizeof(uint16_t))
+        {
+            rloc = locator->GetValueUInt16();
+        }
+    }
+
     if (rloc == kInvalidLocator)
     {
         otbrLog(OTBR_LOG_ERR, "Joiner Router Locator not found!");
@@ -186,42 +921,396 @@ void BorderAgent::HandleRelayTransmit(const Coap::Message &aMessage, const uint8
     }
 
     {
-        Ip6Address     addr(rloc);
-        uint8_t        tokenLength = 0;
-        const uint8_t *token       = aMessage.GetToken(tokenLength);
-        Coap::Message *message     = mCoap->NewMessage(Coap::kTypeNonConfirmable, Coap::kCodePost, token, tokenLength);
+        Ip6Address addr(rloc);
+
+        uint32_t   elapsed;
+
+        OTBR_BACKEND_CALL(Coap::AgentBackend, *mCoap, Forward)(aMessage, addr.m8, kCoapUdpPort);
+        elapsed = static_cast<uint32_t>(GetMonotonicNowUs() - start);
+        sRelayTransmitTime.Record(elapsed);
+        RecordRelayFlow(RelayFlowTable::kDirectionTransmit, aMessage, start, elapsed);
+    }
+
+exit:
+    return;
+}
+
+void BorderAgent::RecordRelayFlow(RelayFlowTable::Direction aDirection,
+                                  const Coap::Message &     aMessage,
+                                  uint64_t                  aArrival,
+                                  uint32_t                  aForwardTime)
+{
+    static const uint8_t kTypes[] = {kJoinerIid, kJoinerRouterLocator};
+
+    uint16_t       length  = 0;
+    const uint8_t *payload = OTBR_BACKEND_CALL(Coap::MessageBackend, aMessage, GetPayload)(length);
+    TlvReader      reader(payload, length);
+    const Tlv *    tlvs[sizeof(kTypes)];
+
+    reader.Index(kTypes, tlvs, sizeof(kTypes));
+
+    // Messages without the TLVs identifying the joiner are relayed, but not accounted.
+    VerifyOrExit(tlvs[0] != NULL && tlvs[0]->GetLength() == RelayFlowTable::kJoinerIidSize);
+    VerifyOrExit(tlvs[1] != NULL && tlvs[1]->GetLength() == sizeof(uint16_t));
+
+    mRelayFlows.Record(aDirection, static_cast<const uint8_t *>(tlvs[0]->GetValue()), tlvs[1]->GetValueUInt16(),
+                       length, aArrival, aForwardTime);
+
+exit:
+    return;
+}
+
+const Coap::Resource *BorderAgent::GetRateLimitResource(unsigned int aIndex) const
+{
+    // In the order of sRateLimited, the session limit has no resource.
+    const Coap::Resource *const resources[kRateLimitCount] = {NULL,
+                                                              &mActiveGet,
+                                                              &mActiveSet,
+                                                              &mPendingGet,
+                                                              &mPendingSet,
+                                                              &mCommissionerPetitionHandler,
+                                                              &mCommissionerKeepAliveHandler,
+                                                              &mCommissionerSetHandler,
+                                                              &mCommissionerRelayTransmitHandler,
+                                                              &mEnergyScan,
+                                                              &mPanIdQuery};
+
+    return aIndex < kRateLimitCount ? resources[aIndex] : NULL;
+}
+
+otbrError BorderAgent::SetRateLimits(const char *aLimits)
+{
+    otbrError   error = OTBR_ERROR_NONE;
+    RateLimit   limits[kRateLimitCount];
+    const char *cur = aLimits;
+
+    memcpy(limits, mRateLimits, sizeof(limits));
+
+    while (*cur != '\0')
+    {
+        const char *  separator = strchr(cur, '=');
+        size_t        keyLength = (separator != NULL) ? static_cast<size_t>(separator - cur) : 0;
+        unsigned int  index     = kRateLimitCount;
+        char *        end;
+        unsigned long rate;
+        unsigned long burst = 0;
+
+        VerifyOrExit(keyLength > 0, errno = EINVAL, error = OTBR_ERROR_ERRNO);
+
+        for (unsigned int i = 0; i < kRateLimitCount; ++i)
+        {
+            const char *key = (i == kRateLimitSession) ? kRateLimitSessionKey : GetRateLimitResource(i)->mPath;
+
+            if (strlen(key) == keyLength && strncmp(key, cur, keyLength) == 0)
+            {
+                index = i;
+                break;
+            }
+        }
+
+        VerifyOrExit(index < kRateLimitCount, errno = EINVAL, error = OTBR_ERROR_ERRNO);
+
+        rate = strtoul(separator + 1, &end, 10);
+        VerifyOrExit(end != separator + 1 && rate <= UINT32_MAX, errno = EINVAL, error = OTBR_ERROR_ERRNO);
+
+        if (*end == '/')
+        {
+            cur   = end + 1;
+            burst = strtoul(cur, &end, 10);
+            VerifyOrExit(end != cur && burst <= UINT32_MAX, errno = EINVAL, error = OTBR_ERROR_ERRNO);
+        }
+
+        VerifyOrExit(*end == ',' || *end == '\0', errno = EINVAL, error = OTBR_ERROR_ERRNO);
+
+        limits[index].mRate  = static_cast<uint32_t>(rate);
+        limits[index].mBurst = static_cast<uint32_t>(burst);
+
+        cur = (*end == ',') ? end + 1 : end;
+    }
+
+    memcpy(mRateLimits, limits, sizeof(mRateLimits));
+
+exit:
+    return error;
+}
+
+bool BorderAgent::AdmitRequest(Commissioner &        aCommissioner,
+                               const Coap::Resource &aResource,
+                               const Coap::Message & aMessage,
+                               Coap::Message &       aResponse)
+{
+    uint64_t     now      = LoopClock::GetNow();
+    unsigned int rejected = kRateLimitCount;
+
+    if (!aCommissioner.mBuckets[kRateLimitSession].Consume(now))
+    {
+        rejected = kRateLimitSession;
+        ExitNow();
+    }
+
+    for (unsigned int i = kRateLimitSession + 1; i < kRateLimitCount; ++i)
+    {
+        if (GetRateLimitResource(i) == &aResource)
+        {
+            if (!aCommissioner.mBuckets[i].Consume(now))
+            {
+                rejected = i;
+            }
+
+            break;
+        }
+    }
+
+exit:
+    if (rejected != kRateLimitCount)
+    {
+        sRateLimited[rejected]->Add();
+        otbrLogRateLimited(OTBR_LOG_WARNING, kLogBurst, kLogInterval, "Request %s rejected by rate limit %s",
+                           aResource.mPath, rejected == kRateLimitSession ? kRateLimitSessionKey : aResource.mPath);
+
+        // Non-confirmable requests, e.g. relayed joiner messages, are dropped silently.
+        if (aMessage.GetType() == Coap::kTypeConfirmable)
+        {
+            aResponse.SetCode(Coap::kCodeServiceUnavailable);
+        }
+    }
+
+    return rejected == kRateLimitCount;
+}
+
+bool BorderAgent::AdmitUnderLoad(const Commissioner &  aCommissioner,
+                                 const Coap::Resource &aResource,
+                                 const Coap::Message & aMessage,
+                                 Coap::Message &       aResponse) const
+{
+    bool admitted = true;
+
+    // The active commissioner keeps its session, new ones are told when to petition again.
+    VerifyOrExit(mLoadLevel >= LoadShedder::kLevelRejectPetitions);
+    VerifyOrExit(&aResource == &mCommissionerPetitionHandler && &aCommissioner != mActiveCommissioner);
+
+    admitted = false;
+    sShedPetitions.Add();
+    otbrLogRateLimited(OTBR_LOG_WARNING, kLogBurst, kLogInterval, "Petition rejected under load level %d",
+                       mLoadLevel);
+
+    if (aMessage.GetType() == Coap::kTypeConfirmable)
+    {
+        aResponse.SetCode(Coap::kCodeServiceUnavailable);
+        aResponse.AddUintOption(Coap::kOptionMaxAge, kShedRetryDelay);
+    }
+
+exit:
+    return admitted;
+}
+
+void BorderAgent::SetLoadLevel(LoadShedder::Level aLevel)
+{
+    mLoadLevel = aLevel;
+    mDtlsServer->SetHandshakesDeferred(aLevel >= LoadShedder::kLevelDeferHandshakes);
+}
+
+bool BorderAgent::ValidateSession(const Commissioner &  aCommissioner,
+                                  const Coap::Resource &aResource,
+                                  const Coap::Message & aMessage,
+                                  Coap::Message &       aResponse) const
+{
+    bool           valid   = true;
+    uint16_t       length  = 0;
+    const uint8_t *payload = aMessage.GetPayload(length);
+    TlvIndex       index;
+    const Tlv *    sessionId;
+
+    // Only the session requests are checked, the leader checks the others.
+    VerifyOrExit(&aResource == &mCommissionerKeepAliveHandler || &aResource == &mCommissionerSetHandler);
+    VerifyOrExit(aCommissioner.mSessionId != 0);
+
+    index.Build(payload, length);
+    sessionId = index.Get(kCommissionerSessionId);
+
+    VerifyOrExit(sessionId != NULL && sessionId->GetLength() == sizeof(uint16_t) &&
+                 sessionId->GetValueUInt16() != aCommissioner.mSessionId);
+
+    valid = false;
+    sInvalidSession.Add();
+    otbrLogRateLimited(OTBR_LOG_WARNING, kLogBurst, kLogInterval, "Request %s rejected, session id %u is not %u",
+                       aResource.mPath, sessionId->GetValueUInt16(), aCommissioner.mSessionId);
+
+    // Answered as the leader would, so that the commissioner petitions again.
+    if (aMessage.GetType() == Coap::kTypeConfirmable)
+    {
+        uint8_t   response[sizeof(Tlv) + sizeof(uint8_t)];
+        TlvWriter writer(response, sizeof(response));
 
-        message->SetPath(OT_URI_PATH_RELAY_TX);
-        message->SetPayload(payload, length);
-        mCoap->Send(*message, addr.m8, kCoapUdpPort, NULL, NULL);
-        mCoap->FreeMessage(message);
+        writer.AppendUInt8(kState, kStateReject);
+        aResponse.SetCode(Coap::kCodeChanged);
+        aResponse.SetPayload(response, writer.GetLength());
     }
 
 exit:
+    return valid;
+}
 
-    (void)aIp6;
-    (void)aPort;
+bool BorderAgent::AnswerKeepAlive(const Commissioner &  aCommissioner,
+                                  const Coap::Resource &aResource,
+                                  const Coap::Message & aMessage,
+                                  Coap::Message &       aResponse) const
+{
+    bool           answered = false;
+    uint16_t       length   = 0;
+    const uint8_t *payload  = aMessage.GetPayload(length);
+    TlvIndex       index;
+    const Tlv *    state;
+    const Tlv *    sessionId;
+
+    VerifyOrExit(&aResource == &mCommissionerKeepAliveHandler && mKeepAliveInterval > 0);
+    VerifyOrExit(mActiveCommissioner == &aCommissioner && aCommissioner.mAcceptTime != 0 &&
+                 LoopClock::GetNow() - aCommissioner.mAcceptTime < mKeepAliveInterval);
+    VerifyOrExit(aMessage.GetType() == Coap::kTypeConfirmable);
+
+    index.Build(payload, length);
+    state     = index.Get(kState);
+    sessionId = index.Get(kCommissionerSessionId);
+
+    VerifyOrExit(state != NULL && state->GetLength() == sizeof(uint8_t) && state->GetValueUInt8() == kStateAccept);
+    VerifyOrExit(sessionId != NULL && sessionId->GetLength() == sizeof(uint16_t) &&
+                 sessionId->GetValueUInt16() == aCommissioner.mSessionId);
+
+    // Answered as the leader did last, which still considers the session active.
+    {
+        uint8_t   response[sizeof(Tlv) + sizeof(uint8_t)];
+        TlvWriter writer(response, sizeof(response));
 
-    return;
+        writer.AppendUInt8(kState, kStateAccept);
+        aResponse.SetCode(Coap::kCodeChanged);
+        aResponse.SetPayload(response, writer.GetLength());
+    }
+
+    answered = true;
+    sLocalKeepAlive.Add();
+
+exit:
+    return answered;
 }
 
-BorderAgent::BorderAgent(Ncp::Controller *aNcp, Coap::Agent *aCoap)
-    : mActiveGet(OT_URI_PATH_ACTIVE_GET, ForwardCommissionerRequest, this)
-    , mActiveSet(OT_URI_PATH_ACTIVE_SET, ForwardCommissionerRequest, this)
-    , mPendingGet(OT_URI_PATH_PENDING_GET, ForwardCommissionerRequest, this)
-    , mPendingSet(OT_URI_PATH_PENDING_SET, ForwardCommissionerRequest, this)
-    , mCommissionerPetitionHandler(OT_URI_PATH_COMMISSIONER_PETITION, ForwardCommissionerRequest, this)
-    , mCommissionerKeepAliveHandler(OT_URI_PATH_COMMISSIONER_KEEP_ALIVE, ForwardCommissionerRequest, this)
-    , mCommissionerSetHandler(OT_URI_PATH_COMMISSIONER_SET, ForwardCommissionerRequest, this)
+BorderAgent::BorderAgent(Ncp::Controller *aNcp,
+                         Coap::Agent *    aCoap,
+                         Reactor *        aReactor,
+                         TimerWheel *     aTimerWheel,
+                         Mdns::Publisher *aPublisher,
+                         uint16_t         aPort)
+    : mActiveGet(OT_URI_PATH_ACTIVE_GET,
+                 OT_URI_PATH_ACTIVE_GET,
+                 &BorderAgent::ForwardCommissionerResponse,
+                 ForwardCommissionerRequest,
+                 this)
+    , mActiveSet(OT_URI_PATH_ACTIVE_SET,
+                 OT_URI_PATH_ACTIVE_SET,
+                 &BorderAgent::ForwardCommissionerResponse,
+                 ForwardCommissionerRequest,
+                 this)
+    , mPendingGet(OT_URI_PATH_PENDING_GET,
+                  OT_URI_PATH_PENDING_GET,
+                  &BorderAgent::ForwardCommissionerResponse,
+                  ForwardCommissionerRequest,
+                  this)
+    , mPendingSet(OT_URI_PATH_PENDING_SET,
+                  OT_URI_PATH_PENDING_SET,
+                  &BorderAgent::ForwardCommissionerResponse,
+                  ForwardCommissionerRequest,
+                  this)
+    , mCommissionerPetitionHandler(OT_URI_PATH_COMMISSIONER_PETITION,
+                                   OT_URI_PATH_LEADER_PETITION,
+                                   &BorderAgent::ForwardPetitionResponse,
+                                   ForwardCommissionerRequest,
+                                   this)
+    , mCommissionerKeepAliveHandler(OT_URI_PATH_COMMISSIONER_KEEP_ALIVE,
+                                    OT_URI_PATH_LEADER_KEEP_ALIVE,
+                                    &BorderAgent::ForwardPetitionResponse,
+                                    ForwardCommissionerRequest,
+                                    this)
+    , mCommissionerSetHandler(OT_URI_PATH_COMMISSIONER_SET,
+                              OT_URI_PATH_COMMISSIONER_SET,
+                              &BorderAgent::ForwardCommissionerResponse,
+                              ForwardCommissionerRequest,
+                              this)
     , mCommissionerRelayTransmitHandler(OT_URI_PATH_RELAY_TX, HandleRelayTransmit, this)
+    , mEnergyScan(OT_URI_PATH_ENERGY_SCAN,
+                  OT_URI_PATH_ENERGY_SCAN,
+                  &BorderAgent::ForwardCommissionerResponse,
+                  ForwardCommissionerRequest,
+                  this)
+    , mPanIdQuery(OT_URI_PATH_PANID_QUERY,
+                  OT_URI_PATH_PANID_QUERY,
+                  &BorderAgent::ForwardCommissionerResponse,
+                  ForwardCommissionerRequest,
+                  this)
     , mCommissionerRelayReceiveHandler(OT_URI_PATH_RELAY_RX, BorderAgent::HandleRelayReceive, this)
+    , mDatasetChangedHandler(OT_URI_PATH_DATASET_CHANGED, BorderAgent::HandleDatasetChanged, this)
+    , mEnergyReportHandler(OT_URI_PATH_ENERGY_REPORT, BorderAgent::HandleEnergyReport, this)
+    , mPanIdConflictHandler(OT_URI_PATH_PANID_CONFLICT, BorderAgent::HandlePanIdConflict, this)
+    , mDatasetObserverCount(0)
+    , mDatasetCacheTimeout(0)
+    , mKeepAliveInterval(0)
+    , mLoadLevel(LoadShedder::kLevelNormal)
     , mCoap(aCoap)
-    , mDtlsServer(Dtls::Server::Create(kBorderAgentUdpPort, HandleDtlsSessionState, this))
-    , mCoaps(Coap::Agent::Create(SendCoaps, this))
-    , mPublisher(Mdns::Publisher::Create(AF_UNSPEC, NULL, NULL, HandleMdnsState, this))
+    , mDtlsServer(Dtls::Server::Create(aPort != 0 ? aPort : static_cast<uint16_t>(kDefaultPort),
+                                       HandleDtlsSessionState, this, aReactor, aTimerWheel))
+    , mCoaps(Coap::Agent::Create(SendCoaps, this, aTimerWheel, aCoap))
+    , mPublisher(aPublisher != NULL
+                     ? aPublisher
+                     : Mdns::Publisher::Create(AF_UNSPEC, NULL, NULL, HandleMdnsState, this, aReactor, aTimerWheel))
+    , mOwnsPublisher(aPublisher == NULL)
+    , mMdnsInterface(0)
+    , mPort(aPort != 0 ? aPort : static_cast<uint16_t>(kDefaultPort))
     , mNcp(aNcp)
+    , mWarmState(NULL)
     , mThreadStarted(false)
+    , mThreadRole(Ncp::kThreadRoleDetached)
+    , mHasPSKc(false)
+    , mHasEui64(false)
+    , mNameConflicts(0)
+    , mActiveCommissioner(NULL)
+    , mTimerWheel(aTimerWheel != NULL ? aTimerWheel : &mLocalTimerWheel)
+    , mPublishTimer(HandlePublishTimer, this)
+    , mPublishDeadline(0)
+    , mPublishDelay(kPublishDelay)
+    , mForwardTimer(HandleForwardTimer, this)
+    , mObserveTimer(HandleObserveTimer, this)
 {
+    for (size_t i = 0; i < sizeof(mDatasetCache) / sizeof(mDatasetCache[0]); ++i)
+    {
+        mDatasetCache[i].mBorderAgent = this;
+        mDatasetCache[i].mResource    = NULL;
+        mDatasetCache[i].mInFlight    = false;
+    }
+
+    for (size_t i = 0; i < kMaxDatasetObservers; ++i)
+    {
+        mDatasetObservers[i].mResource = NULL;
+    }
+
+    for (size_t i = 0; i < kMaxPendingForwards; ++i)
+    {
+        mPendingForwards[i].mBorderAgent = this;
+        mPendingForwards[i].mResource    = NULL;
+    }
+
+    // Responses are encrypted straight from the header and the payload of the leader's response.
+    mCoaps->SetVectorSender(SendCoapsVector);
+
+    memset(mRateLimits, 0, sizeof(mRateLimits));
+
+    // A shared publisher reports conflicts to its owner, which forwards them to the border agents.
+    if (mOwnsPublisher)
+    {
+        mPublisher->SetConflictHandler(HandleMdnsConflict, this);
+    }
+
+    // Entries keep the order first set, the network name and extended PAN ID follow once the NCP reports them.
+    mTxt.SetEntry("rv", "1");
+    mTxt.SetEntry("tv", kThreadVersion);
+    UpdateStateBitmap();
 }
 
 otbrError BorderAgent::Start(void)
@@ -237,27 +1326,51 @@ otbrError BorderAgent::Start(void)
     SuccessOrExit(error = mCoaps->AddResource(mCommissionerKeepAliveHandler));
     SuccessOrExit(error = mCoaps->AddResource(mCommissionerSetHandler));
     SuccessOrExit(error = mCoaps->AddResource(mCommissionerRelayTransmitHandler));
+    SuccessOrExit(error = mCoaps->AddResource(mEnergyScan));
+    SuccessOrExit(error = mCoaps->AddResource(mPanIdQuery));
 
     SuccessOrExit(error = mCoap->AddResource(mCommissionerRelayReceiveHandler));
+    SuccessOrExit(error = mCoap->AddResource(mDatasetChangedHandler));
+    SuccessOrExit(error = mCoap->AddResource(mEnergyReportHandler));
+    SuccessOrExit(error = mCoap->AddResource(mPanIdConflictHandler));
 
     mNetworkName[sizeof(mNetworkName) - 1] = '\0';
 
-    mNcp->On(Ncp::kEventExtPanId, HandleExtPanId, this);
-    mNcp->On(Ncp::kEventThreadState, HandleThreadState, this);
-    mNcp->On(Ncp::kEventNetworkName, HandleNetworkName, this);
-    mNcp->On(Ncp::kEventPSKc, HandlePSKcChanged, this);
+    mNcp->On(HandleExtPanId, this);
+    mNcp->On(HandleThreadState, this);
+    mNcp->On(HandleNetworkName, this);
+    mNcp->On(HandlePSKcChanged, this);
 
-    mNcp->RequestEvent(Ncp::kEventPSKc);
-    mNcp->RequestEvent(Ncp::kEventNetworkName);
-    mNcp->RequestEvent(Ncp::kEventExtPanId);
-    mNcp->RequestEvent(Ncp::kEventThreadState);
+    // Before the properties are requested, so that the NCP reports replace the restored state.
+    RestoreWarmState();
+    mNcp->RequestEvents();
 
     {
         const uint8_t *eui64 = mNcp->GetEui64();
+
+        // wpantund may not answer yet after a restart.
+        if (eui64 == NULL && mWarmState != NULL && mWarmState->GetRestored() != NULL &&
+            mWarmState->GetRestored()->mHasEui64)
+        {
+            otbrLog(OTBR_LOG_WARNING, "NCP EUI-64 unavailable, using the one restored");
+            eui64 = mWarmState->GetRestored()->mEui64;
+        }
+
         VerifyOrExit(eui64 != NULL, error = OTBR_ERROR_ERRNO);
         mDtlsServer->SetSeed(eui64, kSizeEui64);
+        memcpy(mEui64, eui64, sizeof(mEui64));
+        mHasEui64 = true;
+
+        if (mWarmState != NULL)
+        {
+            mWarmState->SetEui64(eui64);
+        }
     }
 
+    mDtlsServer->SetSharedSocket(true);
+#if OTBR_ENABLE_DTLS_FILTER
+    mDtlsServer->SetRecordFilter(true);
+#endif
     SuccessOrExit(error = mDtlsServer->Start());
 
 exit:
@@ -273,6 +1386,127 @@ BorderAgent::~BorderAgent(void)
 {
     Dtls::Server::Destroy(mDtlsServer);
     Coap::Agent::Destroy(mCoaps);
+
+    if (mOwnsPublisher)
+    {
+        Mdns::Publisher::Destroy(mPublisher);
+    }
+
+    for (size_t i = 0; i < mCommissioners.size(); ++i)
+    {
+        delete mCommissioners[i];
+    }
+
+    for (size_t i = 0; i < mFreeCommissioners.size(); ++i)
+    {
+        delete mFreeCommissioners[i];
+    }
+}
+
+BorderAgent::Commissioner *BorderAgent::NewCommissioner(Dtls::Session &aSession)
+{
+    Commissioner *commissioner = NULL;
+
+    if (!mFreeCommissioners.empty() &&
+        mFreeCommissioners.front()->mReleaseTime + kCommissionerReuseDelay <= LoopClock::GetNow())
+    {
+        commissioner = mFreeCommissioners.front();
+        mFreeCommissioners.pop_front();
+    }
+    else
+    {
+        commissioner               = new Commissioner;
+        commissioner->mBorderAgent = this;
+    }
+
+    commissioner->mSession     = &aSession;
+    commissioner->mRequestTime = 0;
+    commissioner->mSessionId   = 0;
+    commissioner->mAcceptTime  = 0;
+
+    for (unsigned int i = 0; i < kRateLimitCount; ++i)
+    {
+        commissioner->mBuckets[i].Init(mRateLimits[i].mRate, mRateLimits[i].mBurst, LoopClock::GetNow());
+    }
+
+    aSession.GetPeerAddress(commissioner->mIp6, commissioner->mPort);
+    mCommissioners.push_back(commissioner);
+
+    return commissioner;
+}
+
+void BorderAgent::ReleaseCommissioner(Commissioner &aCommissioner)
+{
+    for (std::vector<Commissioner *>::iterator it = mCommissioners.begin(); it != mCommissioners.end(); ++it)
+    {
+        if (*it == &aCommissioner)
+        {
+            mCommissioners.erase(it);
+            break;
+        }
+    }
+
+    if (mActiveCommissioner == &aCommissioner)
+    {
+        mActiveCommissioner = NULL;
+    }
+
+    // Responses of its requests still in flight are dropped.
+    for (size_t i = 0; i < kMaxPendingForwards; ++i)
+    {
+        if (mPendingForwards[i].mCommissioner == &aCommissioner)
+        {
+            mPendingForwards[i].mCommissioner = NULL;
+        }
+    }
+
+    for (size_t i = 0; i < kMaxDatasetObservers; ++i)
+    {
+        if (mDatasetObservers[i].mResource != NULL && mDatasetObservers[i].mCommissioner == &aCommissioner)
+        {
+            RemoveDatasetObserver(mDatasetObservers[i]);
+        }
+    }
+
+    aCommissioner.mSession     = NULL;
+    aCommissioner.mReleaseTime = LoopClock::GetNow();
+    mFreeCommissioners.push_back(&aCommissioner);
+}
+
+BorderAgent::Commissioner *BorderAgent::FindCommissioner(const Dtls::Session &aSession) const
+{
+    Commissioner *commissioner = NULL;
+
+    for (size_t i = 0; i < mCommissioners.size(); ++i)
+    {
+        if (mCommissioners[i]->mSession == &aSession)
+        {
+            commissioner = mCommissioners[i];
+            break;
+        }
+    }
+
+    return commissioner;
+}
+
+BorderAgent::Commissioner *BorderAgent::FindCommissioner(const uint8_t *aIp6, uint16_t aPort) const
+{
+    Commissioner *commissioner = NULL;
+
+    VerifyOrExit(aIp6 != NULL);
+
+    for (size_t i = 0; i < mCommissioners.size(); ++i)
+    {
+        if (mCommissioners[i]->mPort == aPort &&
+            memcmp(mCommissioners[i]->mIp6, aIp6, sizeof(mCommissioners[i]->mIp6)) == 0)
+        {
+            commissioner = mCommissioners[i];
+            break;
+        }
+    }
+
+exit:
+    return commissioner;
 }
 
 void BorderAgent::HandleMdnsState(Mdns::State aState)
@@ -280,7 +1514,11 @@ void BorderAgent::HandleMdnsState(Mdns::State aState)
     switch (aState)
     {
     case Mdns::kStateReady:
-        PublishService();
+        // A shared publisher becomes ready for all border agents, whether publishing or not.
+        if (mThreadStarted && mNetworkName[0] != '\0')
+        {
+            PublishService();
+        }
         break;
     default:
         otbrLog(OTBR_LOG_WARNING, "Mdns service not available!");
@@ -288,21 +1526,49 @@ void BorderAgent::HandleMdnsState(Mdns::State aState)
     }
 }
 
+void BorderAgent::HandleMdnsConflict(uint16_t aPort, const char *aType)
+{
+    VerifyOrExit(aPort == mPort && !strcmp(aType, kBorderAgentServiceType));
+    sNameConflicts.Add();
+
+    // Without the EUI-64, or once both suffixes conflicted, the publisher picks a name of its own.
+    VerifyOrExit(mHasEui64 && mNameConflicts < kMaxNameConflicts && mThreadStarted && mNetworkName[0] != '\0');
+
+    ++mNameConflicts;
+
+    if (mWarmState != NULL)
+    {
+        mWarmState->SetNameConflicts(mNameConflicts);
+    }
+
+    PublishService();
+
+exit:
+    return;
+}
+
 void BorderAgent::HandleDtlsSessionState(Dtls::Session &aSession, Dtls::Session::State aState)
 {
     switch (aState)
     {
     case Dtls::Session::kStateReady:
-        aSession.SetDataHandler(FeedCoaps, this);
-        mDtlsSession = &aSession;
+        aSession.SetDataHandler(FeedCoaps, NewCommissioner(aSession));
         break;
 
     case Dtls::Session::kStateEnd:
     case Dtls::Session::kStateError:
     case Dtls::Session::kStateExpired:
-        mDtlsSession = NULL;
+    {
+        Commissioner *commissioner = FindCommissioner(aSession);
+
+        if (commissioner != NULL)
+        {
+            ReleaseCommissioner(*commissioner);
+        }
+
         otbrLog(OTBR_LOG_WARNING, "DTLS session ended.");
         break;
+    }
 
     default:
         break;
@@ -315,17 +1581,61 @@ ssize_t BorderAgent::SendCoaps(const uint8_t *aBuffer,
                                uint16_t       aPort,
                                void *         aContext)
 {
-    // TODO verify the ip and port
-    (void)aIp6;
-    (void)aPort;
-    return static_cast<BorderAgent *>(aContext)->mDtlsSession->Write(aBuffer, aLength);
+    BorderAgent * borderAgent  = static_cast<BorderAgent *>(aContext);
+    Commissioner *commissioner = borderAgent->FindCommissioner(aIp6, aPort);
+    ssize_t       ret          = -1;
+
+    PacketTrace::Record(PacketTrace::kPointCommissionerOut, aIp6, aPort, aBuffer, aLength);
+    VerifyOrExit(commissioner != NULL, errno = ENOTCONN);
+
+    // The message is dropped when the session is backlogged, leaving it to the CoAP layer to report. Relayed joiner
+    // traffic queues behind petitions and keep-alives, so that a burst of it does not time the commissioner out.
+    ret = OTBR_BACKEND_CALL(Dtls::SessionBackend, *commissioner->mSession, Write)(aBuffer, aLength,
+                                                                                  Coap::GetPriority(aBuffer, aLength));
+
+exit:
+    if (ret < 0)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to send CoAP message over DTLS: %s!", strerror(errno));
+    }
+
+    return ret;
+}
+
+ssize_t BorderAgent::SendCoapsVector(const struct iovec *aVector,
+                                     int                 aCount,
+                                     const uint8_t *     aIp6,
+                                     uint16_t            aPort,
+                                     void *              aContext)
+{
+    BorderAgent *  borderAgent  = static_cast<BorderAgent *>(aContext);
+    Commissioner * commissioner = borderAgent->FindCommissioner(aIp6, aPort);
+    const uint8_t *header       = static_cast<const uint8_t *>(aVector[0].iov_base);
+    ssize_t        ret          = -1;
+
+    PacketTrace::Record(PacketTrace::kPointCommissionerOut, aIp6, aPort, aVector, aCount);
+    VerifyOrExit(commissioner != NULL, errno = ENOTCONN);
+
+    // The first part holds the header and options, which is all the priority depends on.
+    ret = OTBR_BACKEND_CALL(Dtls::SessionBackend, *commissioner->mSession, WriteVector)(
+        aVector, aCount, Coap::GetPriority(header, static_cast<uint16_t>(aVector[0].iov_len)));
+
+exit:
+    if (ret < 0)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to send CoAP message over DTLS: %s!", strerror(errno));
+    }
+
+    return ret;
 }
 
 void BorderAgent::FeedCoaps(const uint8_t *aBuffer, uint16_t aLength, void *aContext)
 {
-    BorderAgent *borderAgent = static_cast<BorderAgent *>(aContext);
+    Commissioner &commissioner = *static_cast<Commissioner *>(aContext);
+    Coap::Agent & coaps        = *commissioner.mBorderAgent->mCoaps;
 
-    borderAgent->mCoaps->Input(aBuffer, aLength, NULL, 0);
+    PacketTrace::Record(PacketTrace::kPointCommissionerIn, commissioner.mIp6, commissioner.mPort, aBuffer, aLength);
+    OTBR_BACKEND_CALL(Coap::AgentBackend, coaps, Input)(aBuffer, aLength, commissioner.mIp6, commissioner.mPort);
 }
 
 void BorderAgent::UpdateFdSet(fd_set & aReadFdSet,
@@ -334,8 +1644,13 @@ void BorderAgent::UpdateFdSet(fd_set & aReadFdSet,
                               int &    aMaxFd,
                               timeval &aTimeout)
 {
+    if (mTimerWheel == &mLocalTimerWheel)
+    {
+        mLocalTimerWheel.UpdateTimeout(aTimeout);
+    }
+
     mDtlsServer->UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd, aTimeout);
-    if (mPublisher->IsStarted())
+    if (mOwnsPublisher && mPublisher->IsStarted())
     {
         mPublisher->UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd, aTimeout);
     }
@@ -344,28 +1659,110 @@ void BorderAgent::UpdateFdSet(fd_set & aReadFdSet,
 void BorderAgent::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
 {
     mDtlsServer->Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
-    if (mPublisher->IsStarted())
+    if (mOwnsPublisher && mPublisher->IsStarted())
     {
         mPublisher->Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
     }
+
+    if (mTimerWheel == &mLocalTimerWheel)
+    {
+        mLocalTimerWheel.Process();
+    }
+}
+
+void BorderAgent::HandlePSKcChanged(void *aContext, const Ncp::PSKcEvent &aEvent)
+{
+    static_cast<BorderAgent *>(aContext)->SetPSKc(aEvent.mPSKc);
+}
+
+void BorderAgent::SetPSKc(const uint8_t *aPSKc)
+{
+    mDtlsServer->SetPSK(aPSKc, kSizePSKc);
+    HandleDatasetChange();
+
+    if (mWarmState != NULL)
+    {
+        mWarmState->SetPSKc(aPSKc);
+    }
+
+    if (!mHasPSKc)
+    {
+        mHasPSKc = true;
+        UpdateStateBitmap();
+        HandleThreadChange();
+    }
+}
+
+void BorderAgent::RestoreWarmState(void)
+{
+    const WarmState::Snapshot *snapshot;
+
+    VerifyOrExit(mWarmState != NULL && (snapshot = mWarmState->GetRestored()) != NULL);
+
+    if (snapshot->mNetworkName[0] != '\0')
+    {
+        SetNetworkName(snapshot->mNetworkName);
+    }
+
+    if (snapshot->mHasExtPanId)
+    {
+        SetExtPanId(snapshot->mExtPanId);
+    }
+
+    if (snapshot->mHasPSKc)
+    {
+        SetPSKc(snapshot->mPSKc);
+    }
+
+    if (snapshot->mHasEui64)
+    {
+        memcpy(mEui64, snapshot->mEui64, sizeof(mEui64));
+        mHasEui64 = true;
+    }
+
+    // The name the service settled on is probed first, instead of going through the conflicts again.
+    mNameConflicts = snapshot->mNameConflicts;
+    mWarmState->SetNameConflicts(mNameConflicts);
+
+    SetThreadStarted(snapshot->mThreadStarted, static_cast<Ncp::ThreadRole>(snapshot->mThreadRole));
+    otbrLog(OTBR_LOG_INFO, "Restored network %s, Thread %s", mNetworkName, mThreadStarted ? "started" : "stopped");
+
+    // The restored state is published at once, the NCP reports following it are coalesced as usual.
+    mTimerWheel->Stop(mPublishTimer);
+    UpdatePublisher();
+
+exit:
+    return;
 }
 
-void BorderAgent::HandlePSKcChanged(void *aContext, int aEvent, va_list aArguments)
+void BorderAgent::GetServiceName(char *aName, size_t aSize) const
 {
-    assert(aEvent == Ncp::kEventPSKc);
+    const uint8_t *eui64 = mEui64;
 
-    const uint8_t *pskc = va_arg(aArguments, const uint8_t *);
-    static_cast<BorderAgent *>(aContext)->mDtlsServer->SetPSK(pskc, kSizePSKc);
+    if (!mHasEui64 || mNameConflicts == 0)
+    {
+        snprintf(aName, aSize, "%s", mNetworkName);
+    }
+    else if (mNameConflicts == 1)
+    {
+        snprintf(aName, aSize, "%s #%02X%02X", mNetworkName, eui64[6], eui64[7]);
+    }
+    else
+    {
+        snprintf(aName, aSize, "%s #%02X%02X%02X%02X%02X%02X%02X%02X", mNetworkName, eui64[0], eui64[1], eui64[2],
+                 eui64[3], eui64[4], eui64[5], eui64[6], eui64[7]);
+    }
 }
 
 void BorderAgent::PublishService(void)
 {
+    char name[sizeof(mNetworkName) + sizeof(" #") + kSizeEui64 * 2];
+
     assert(mNetworkName[0] != '\0');
 
-    char xpanid[sizeof(mExtPanId) * 2 + 1];
-    Utils::Bytes2Hex(mExtPanId, sizeof(mExtPanId), xpanid);
-    mPublisher->PublishService(kBorderAgentUdpPort, mNetworkName, kBorderAgentServiceType, "nn", mNetworkName, "xp",
-                               xpanid, NULL);
+    // The text record is encoded as properties change, the publisher skips it when unchanged.
+    GetServiceName(name, sizeof(name));
+    mPublisher->PublishService(mMdnsInterface, mPort, name, kBorderAgentServiceType, mTxt);
 }
 
 void BorderAgent::StartPublishService(void)
@@ -386,13 +1783,44 @@ void BorderAgent::StopPublishService(void)
 {
     otbrLog(OTBR_LOG_INFO, "Stop publishing service");
 
-    if (mPublisher->IsStarted())
+    if (!mPublisher->IsStarted())
+    {
+        ExitNow();
+    }
+
+    if (mOwnsPublisher)
     {
         mPublisher->Stop();
     }
+    else
+    {
+        // Other border agents keep their services published.
+        mPublisher->UnpublishService(mMdnsInterface, mPort, kBorderAgentServiceType);
+    }
+
+exit:
+    return;
 }
 
 void BorderAgent::HandleThreadChange(void)
+{
+    uint64_t now = LoopClock::GetNow();
+
+    VerifyOrExit(mPublishDelay > 0, UpdatePublisher());
+
+    if (!mPublishTimer.IsRunning())
+    {
+        mPublishDeadline = now + static_cast<uint64_t>(kMaxPublishDelayFactor) * mPublishDelay;
+    }
+
+    // Restarted by every change of a burst, so the MDNS service is only updated for the settled state.
+    mTimerWheel->StartAt(mPublishTimer, std::min(now + mPublishDelay, mPublishDeadline));
+
+exit:
+    return;
+}
+
+void BorderAgent::UpdatePublisher(void)
 {
     otbrLog(OTBR_LOG_INFO, "Handle Thread change");
 
@@ -406,48 +1834,115 @@ void BorderAgent::HandleThreadChange(void)
     }
 }
 
-void BorderAgent::SetThreadStarted(bool aStarted)
+void BorderAgent::SetThreadStarted(bool aStarted, Ncp::ThreadRole aRole)
 {
+    bool restarted = aStarted && !mThreadStarted;
+
     mThreadStarted = aStarted;
+    mThreadRole    = aRole;
+    UpdateStateBitmap();
+
+    if (mWarmState != NULL)
+    {
+        mWarmState->SetThreadState(aStarted, static_cast<uint8_t>(aRole));
+    }
+
+    // Observers may have missed dataset changes while the Thread network was down.
+    if (restarted)
+    {
+        HandleDatasetChange();
+    }
+    else
+    {
+        InvalidateDatasetCache();
+    }
+
     HandleThreadChange();
 }
 
+void BorderAgent::UpdateStateBitmap(void)
+{
+    uint32_t bitmap = kStateAvailabilityHigh;
+    uint8_t  value[sizeof(bitmap)];
+
+    if (mHasPSKc)
+    {
+        bitmap |= kStateConnectionModePskc;
+    }
+
+    bitmap |= mThreadStarted ? kStateThreadIfActive : kStateThreadIfInitialized;
+
+    // An unknown role is left as detached.
+    if (mThreadStarted && mThreadRole != Ncp::kThreadRoleUnknown)
+    {
+        bitmap |= (static_cast<uint32_t>(mThreadRole) << kStateThreadRoleOffset) & kStateThreadRoleMask;
+    }
+
+    value[0] = static_cast<uint8_t>(bitmap >> 24);
+    value[1] = static_cast<uint8_t>(bitmap >> 16);
+    value[2] = static_cast<uint8_t>(bitmap >> 8);
+    value[3] = static_cast<uint8_t>(bitmap & 0xff);
+
+    // The publisher skips the update when the encoded record is unchanged.
+    mTxt.SetEntry("sb", value, sizeof(value));
+}
+
 void BorderAgent::SetNetworkName(const char *aNetworkName)
 {
+    // Conflicts of the previous name say nothing about the new one.
+    if (strncmp(mNetworkName, aNetworkName, sizeof(mNetworkName) - 1) != 0)
+    {
+        mNameConflicts = 0;
+
+        if (mWarmState != NULL)
+        {
+            mWarmState->SetNameConflicts(0);
+        }
+    }
+
     strncpy(mNetworkName, aNetworkName, sizeof(mNetworkName) - 1);
-    // have to restart publisher to publish new service name.
-    mPublisher->Stop();
+    mTxt.SetEntry("nn", mNetworkName);
+
+    if (mWarmState != NULL)
+    {
+        mWarmState->SetNetworkName(mNetworkName);
+    }
+
+    HandleDatasetChange();
+    // the publisher renames the published service in place.
     HandleThreadChange();
 }
 
 void BorderAgent::SetExtPanId(const uint8_t *aExtPanId)
 {
+    char xpanid[sizeof(mExtPanId) * 2 + 1];
+
     memcpy(mExtPanId, aExtPanId, sizeof(mExtPanId));
+    Utils::Bytes2Hex(mExtPanId, sizeof(mExtPanId), xpanid);
+    mTxt.SetEntry("xp", xpanid);
+
+    if (mWarmState != NULL)
+    {
+        mWarmState->SetExtPanId(mExtPanId);
+    }
+
+    HandleDatasetChange();
     HandleThreadChange();
 }
 
-void BorderAgent::HandleThreadState(void *aContext, int aEvent, va_list aArguments)
+void BorderAgent::HandleThreadState(void *aContext, const Ncp::ThreadStateEvent &aEvent)
 {
-    assert(aEvent == Ncp::kEventThreadState);
-
-    int started = va_arg(aArguments, int);
-    static_cast<BorderAgent *>(aContext)->SetThreadStarted(started);
+    static_cast<BorderAgent *>(aContext)->SetThreadStarted(aEvent.mAssociated, aEvent.mRole);
 }
 
-void BorderAgent::HandleNetworkName(void *aContext, int aEvent, va_list aArguments)
+void BorderAgent::HandleNetworkName(void *aContext, const Ncp::NetworkNameEvent &aEvent)
 {
-    assert(aEvent == Ncp::kEventNetworkName);
-
-    const char *networkName = va_arg(aArguments, const char *);
-    static_cast<BorderAgent *>(aContext)->SetNetworkName(networkName);
+    static_cast<BorderAgent *>(aContext)->SetNetworkName(aEvent.mNetworkName);
 }
 
-void BorderAgent::HandleExtPanId(void *aContext, int aEvent, va_list aArguments)
+void BorderAgent::HandleExtPanId(void *aContext, const Ncp::ExtPanIdEvent &aEvent)
 {
-    assert(aEvent == Ncp::kEventExtPanId);
-
-    const uint8_t *xpanid = va_arg(aArguments, const uint8_t *);
-    static_cast<BorderAgent *>(aContext)->SetExtPanId(xpanid);
+    static_cast<BorderAgent *>(aContext)->SetExtPanId(aEvent.mExtPanId);
 }
 
 } // namespace BorderRouter
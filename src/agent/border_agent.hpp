@@ -34,12 +34,22 @@
 #ifndef BORDER_AGENT_HPP_
 #define BORDER_AGENT_HPP_
 
+#include <deque>
+#include <vector>
+
 #include <stdint.h>
 
+#include "channel_survey.hpp"
 #include "coap.hpp"
 #include "dtls.hpp"
 #include "mdns.hpp"
 #include "ncp.hpp"
+#include "relay_flows.hpp"
+#include "warm_state.hpp"
+#include "common/capacity.hpp"
+#include "common/load_shedder.hpp"
+#include "common/timer.hpp"
+#include "common/token_bucket.hpp"
 
 namespace ot {
 
@@ -61,14 +71,32 @@ namespace BorderRouter {
 class BorderAgent
 {
 public:
+    enum
+    {
+        kDefaultPort    = 49191, ///< The Thread commissioning port.
+        kShedRetryDelay = 5,     ///< Max-Age in seconds of petitions rejected under load.
+    };
+
     /**
      * The constructor to initialize the Thread border agent.
      *
      * @param[in]   aNcp            A pointer to the NCP controller.
-     * @param[in]   aCoap           A pointer to the TMF agent.
+     * @param[in]   aCoap           A pointer to the TMF agent, whose messages and transactions the commissioner
+     *                              agent shares.
+     * @param[in]   aReactor        A pointer to the reactor, NULL to use the fd_set interface.
+     * @param[in]   aTimerWheel     A pointer to the timer wheel, NULL to use the fd_set interface.
+     * @param[in]   aPublisher      A pointer to a MDNS publisher shared with other border agents, NULL to create one
+     *                              of this border agent. The owner of a shared publisher polls it and passes its state
+     *                              changes to HandleMdnsState().
+     * @param[in]   aPort           The UDP port of the commissioning service, 0 to use kDefaultPort.
      *
      */
-    BorderAgent(Ncp::Controller *aNcp, Coap::Agent *aCoap);
+    BorderAgent(Ncp::Controller *aNcp,
+                Coap::Agent *    aCoap,
+                Reactor *        aReactor    = NULL,
+                TimerWheel *     aTimerWheel = NULL,
+                Mdns::Publisher *aPublisher  = NULL,
+                uint16_t         aPort       = 0);
 
     ~BorderAgent(void);
 
@@ -82,6 +110,324 @@ public:
      */
     otbrError Start(void);
 
+    /**
+     * This method sets the number of worker threads running DTLS handshakes, must be called before Start().
+     *
+     * @param[in]   aCount      The number of worker threads, 0 to run handshakes on the mainloop.
+     *
+     */
+    void SetHandshakeWorkers(unsigned int aCount) { mDtlsServer->SetHandshakeWorkers(aCount); }
+
+    /**
+     * This method sets the max number of DTLS sessions, must be called before Start().
+     *
+     * @param[in]   aCount      The max number of sessions, must be greater than 0.
+     *
+     */
+    void SetMaxDtlsSessions(unsigned int aCount) { mDtlsServer->SetMaxSessions(aCount); }
+
+    /**
+     * This method sets the time DTLS sessions are kept without receiving anything.
+     *
+     * @param[in]   aHandshakeTimeout   The timeout of handshaking sessions in milliseconds, 0 to keep it.
+     * @param[in]   aIdleTimeout        The timeout of established sessions in milliseconds, 0 to keep it.
+     *
+     */
+    void SetDtlsTimeouts(uint32_t aHandshakeTimeout, uint32_t aIdleTimeout)
+    {
+        mDtlsServer->SetSessionTimeouts(aHandshakeTimeout, aIdleTimeout);
+    }
+
+    /**
+     * This method sets the retransmission timeouts of DTLS handshakes, must be called before Start().
+     *
+     * @param[in]   aMin        The initial timeout in milliseconds, 0 to keep it.
+     * @param[in]   aMax        The max timeout in milliseconds, 0 to keep it.
+     *
+     */
+    void SetDtlsRetransmissionTimeouts(uint32_t aMin, uint32_t aMax)
+    {
+        mDtlsServer->SetRetransmissionTimeouts(aMin, aMax);
+    }
+
+    /**
+     * This method sets the MTU of the path to commissioners, must be called before Start().
+     *
+     * @param[in]   aMtu        The MTU in bytes, 0 to never group DTLS records into a datagram.
+     *
+     */
+    void SetDtlsMtu(uint16_t aMtu) { mDtlsServer->SetMtu(aMtu); }
+
+    /**
+     * This method sets the level of load shedding.
+     *
+     * From LoadShedder::kLevelDeferHandshakes, new DTLS peers only get a HelloVerifyRequest. From
+     * LoadShedder::kLevelRejectPetitions, petitions of commissioners other than the active one are answered 5.03
+     * Service Unavailable with a Max-Age of kShedRetryDelay. At LoadShedder::kLevelDropRelay, relayed joiner traffic
+     * is dropped. Keep-alives and the other requests of established commissioners are always served.
+     *
+     * @param[in]   aLevel      The level of load shedding.
+     *
+     */
+    void SetLoadLevel(LoadShedder::Level aLevel);
+
+    /**
+     * This method returns the level of load shedding.
+     *
+     * @returns The level of load shedding.
+     *
+     */
+    LoadShedder::Level GetLoadLevel(void) const { return mLoadLevel; }
+
+    /**
+     * This method sets the lifetime of cached MGMT_ACTIVE_GET and MGMT_PENDING_GET responses.
+     *
+     * With the cache, identical dataset queries of commissioners are answered from the last leader response for
+     * this long, and those arriving while one is in flight to the leader wait for its response instead of being
+     * forwarded again. The cache is dropped once the leader reports a dataset change, or the NCP reports a
+     * property change.
+     *
+     * @param[in]   aTimeout    The lifetime of cached responses in milliseconds, 0 to disable the cache.
+     *
+     */
+    void SetDatasetCacheTimeout(uint32_t aTimeout);
+
+    /**
+     * This method sets the interval keep-alives of commissioners are forwarded to the leader at.
+     *
+     * Keep-alives of the session the leader accepted last are answered by the border agent for this long after the
+     * leader accepted it, and forwarded to refresh it afterwards, so the interval must be shorter than the
+     * commissioner timeout of the leader. Keep-alives resigning the session are always forwarded.
+     *
+     * @param[in]   aInterval   The interval in milliseconds, 0 to forward every keep-alive.
+     *
+     */
+    void SetKeepAliveInterval(uint32_t aInterval) { mKeepAliveInterval = aInterval; }
+
+    /**
+     * This method sets the time CoAP requests of commissioners and of the leader are remembered.
+     *
+     * A request retransmitted over a lossy link within this time is neither handled nor forwarded again, its
+     * acknowledgment is sent again instead.
+     *
+     * @param[in]   aLifetime   The lifetime in milliseconds, 0 to handle every request received.
+     *
+     */
+    void SetDuplicateLifetime(uint32_t aLifetime)
+    {
+        mCoap->SetDuplicateLifetime(aLifetime);
+        mCoaps->SetDuplicateLifetime(aLifetime);
+    }
+
+    /**
+     * This method sets the window in which NCP property changes are coalesced before the MDNS service is updated.
+     *
+     * Changes arriving in bursts, e.g. when the NCP restarts, are published once they settled, so that there is
+     * only one update of the MDNS service per burst. The service is updated at the latest
+     * kMaxPublishDelayFactor windows after the first change of a burst.
+     *
+     * @param[in]   aDelay      The window in milliseconds, 0 to update the service at once.
+     *
+     */
+    void SetPublishDelay(uint32_t aDelay) { mPublishDelay = aDelay; }
+
+    /**
+     * This method sets the state kept across restarts, must be called before Start().
+     *
+     * Start() restores the state, so that the commissioning service is published and commissioners are accepted
+     * before the NCP answers, the properties the NCP reports then replace it.
+     *
+     * @param[in]   aState      A pointer to the state, which must outlive the border agent, NULL to keep none.
+     *
+     */
+    void SetWarmState(WarmState *aState) { mWarmState = aState; }
+
+    /**
+     * This method sets the network interface the commissioning service is published on.
+     *
+     * @param[in]   aInterfaceIndex     The index of the network interface, 0 for all interfaces.
+     *
+     */
+    void SetMdnsInterface(unsigned int aInterfaceIndex) { mMdnsInterface = aInterfaceIndex; }
+
+    /**
+     * This method sets the rate limits of commissioner requests.
+     *
+     * @p aLimits is a comma separated list of `KEY=RATE[/BURST]`, where KEY is either `session`, limiting all
+     * requests of a DTLS session, or the Uri Path of a commissioner resource, e.g. `c/tx`, limiting requests of a
+     * DTLS session to that resource. RATE is the number of requests per second, 0 for no limit, and BURST the max
+     * number of requests in a burst, RATE by default. Requests over a limit are rejected before being forwarded,
+     * confirmable ones with 5.03 Service Unavailable. Sessions established before keep their previous limits.
+     *
+     * @param[in]   aLimits     A pointer to the rate limits.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully set the rate limits.
+     * @retval  OTBR_ERROR_ERRNO    Failed to parse @p aLimits, errno is set to EINVAL and no limit is changed.
+     *
+     */
+    otbrError SetRateLimits(const char *aLimits);
+
+    /**
+     * This method handles state changes of the MDNS publisher.
+     *
+     * @param[in]   aState      The new state of the MDNS publisher.
+     *
+     */
+    void HandleMdnsState(Mdns::State aState);
+
+    /**
+     * This method handles a conflict of the name of a service published by the MDNS publisher.
+     *
+     * The commissioning service is renamed with a suffix of the EUI-64 of the NCP, the last two bytes then all of
+     * them, so that border routers of the same network name settle on unique names in one probe round. The number of
+     * conflicts is kept across restarts by the warm state.
+     *
+     * @param[in]   aPort       The port number of the service.
+     * @param[in]   aType       The type of the service.
+     *
+     */
+    void HandleMdnsConflict(uint16_t aPort, const char *aType);
+
+    /**
+     * This method returns the number of alternative names the commissioning service went through.
+     *
+     * @returns The number of name conflicts since the network name was set.
+     *
+     */
+    uint8_t GetNameConflicts(void) const { return mNameConflicts; }
+
+    /**
+     * This method returns the number of commissioner petitions forwarded to the leader and waiting for responses.
+     *
+     * @returns Number of leader petitions in flight.
+     *
+     */
+    unsigned int GetPendingPetitions(void) const;
+
+    /**
+     * This method returns the number of commissioner keep-alives forwarded to the leader and waiting for responses.
+     *
+     * @returns Number of leader keep-alives in flight.
+     *
+     */
+    unsigned int GetPendingKeepAlives(void) const;
+
+    /**
+     * This method returns the number of commissioners observing the active or pending dataset.
+     *
+     * MGMT_ACTIVE_GET and MGMT_PENDING_GET requests with the Observe option 0 register their token, as of RFC 7641.
+     * Once the leader reports a dataset change, or the NCP reports a property change, the query of each observer is
+     * forwarded to the leader again and its response notified with the same token, instead of commissioners polling
+     * the leader. Observations end with the DTLS session, the Observe option 1, or an error response of the leader.
+     *
+     * @returns Number of dataset observers.
+     *
+     */
+    unsigned int GetDatasetObserverCount(void) const { return mDatasetObserverCount; }
+
+    /**
+     * This method returns the state of the DTLS sessions of commissioners.
+     *
+     * @param[out]  aInfos      A pointer to an array to receive the state of the sessions.
+     * @param[in]   aMaxInfos   The number of entries of @p aInfos.
+     *
+     * @returns The number of sessions in use, which may be more than @p aMaxInfos.
+     *
+     */
+    unsigned int GetDtlsSessions(Dtls::Server::SessionInfo *aInfos, unsigned int aMaxInfos) const
+    {
+        return mDtlsServer->GetSessions(aInfos, aMaxInfos);
+    }
+
+    /**
+     * This method returns the CPU time of the DTLS sessions of each commissioner address.
+     *
+     * @param[out]  aInfos      A pointer to an array to receive the peers.
+     * @param[in]   aMaxInfos   The number of entries of @p aInfos.
+     *
+     * @returns The number of peers, which may be more than @p aMaxInfos.
+     *
+     */
+    unsigned int GetDtlsPeers(Dtls::Server::PeerInfo *aInfos, unsigned int aMaxInfos) const
+    {
+        return mDtlsServer->GetPeers(aInfos, aMaxInfos);
+    }
+
+    /**
+     * This method returns the statistics of the messages relayed between joiners and the commissioner.
+     *
+     * @param[out]  aFlows      A pointer to an array to receive the flows, the most recently used first.
+     * @param[in]   aMaxFlows   The number of entries of @p aFlows.
+     *
+     * @returns The number of flows copied.
+     *
+     */
+    unsigned int GetRelayFlows(RelayFlowTable::Flow *aFlows, unsigned int aMaxFlows) const
+    {
+        return mRelayFlows.GetFlows(aFlows, aMaxFlows);
+    }
+
+    /**
+     * This method returns the number of confirmable requests to commissioners waiting for their responses.
+     *
+     * @returns Number of requests in flight to commissioners.
+     *
+     */
+    unsigned int GetCommissionerTransactionCount(void) const { return mCoaps->GetTransactionCount(NULL); }
+
+    /**
+     * This method indicates whether the commissioning service is expected to be published by MDNS.
+     *
+     * The service is published while the Thread network is started with a network name, once the publisher is
+     * started.
+     *
+     * @returns Whether the commissioning service is expected to be published.
+     *
+     */
+    bool IsServicePublished(void) const { return mThreadStarted && mNetworkName[0] != '\0' && mPublisher->IsStarted(); }
+
+    /**
+     * This method indicates whether an update of the commissioning service waits for NCP property changes to settle.
+     *
+     * @returns Whether an update of the MDNS service is pending.
+     *
+     */
+    bool IsPublishPending(void) const { return mPublishTimer.IsRunning(); }
+
+    /**
+     * This method returns the instance name of the commissioning service, the Thread network name.
+     *
+     * @returns A pointer to the null-terminated network name, empty if not known yet.
+     *
+     */
+    const char *GetNetworkName(void) const { return mNetworkName; }
+
+    /**
+     * This method returns the UDP port of the commissioning service.
+     *
+     * @returns The UDP port.
+     *
+     */
+    uint16_t GetPort(void) const { return mPort; }
+
+    /**
+     * This method returns the text record of the commissioning service.
+     *
+     * @returns A reference to the text record.
+     *
+     */
+    const Mdns::TxtRecord &GetTxtRecord(void) const { return mTxt; }
+
+    /**
+     * This method returns the energy scan and PAN ID conflict reports received for commissioners.
+     *
+     * Reports are aggregated whether or not a commissioner is active, and forwarded to the active one.
+     *
+     * @returns A reference to the survey of the channels.
+     *
+     */
+    const ChannelSurvey &GetChannelSurvey(void) const { return mChannelSurvey; }
+
     /**
      * This method updates the fd_set and timeout for mainloop.
      *
@@ -105,12 +451,183 @@ public:
     void Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet);
 
 private:
+    enum
+    {
+        kDatasetCacheEntries = OTBR_CAPACITY_DATASET_CACHE,     ///< Number of cached dataset queries.
+        kMaxDatasetObservers = OTBR_CAPACITY_DATASET_OBSERVERS, ///< Max number of observed dataset queries.
+        kMaxPendingForwards  = OTBR_CAPACITY_PENDING_FORWARDS,  ///< Max number of commissioner requests to the leader.
+    };
+
+    enum
+    {
+        kDatasetCacheWaiters = 4,    ///< Max number of commissioner requests waiting for one leader response.
+        kMaxDatasetQuery     = 64,   ///< Max length of a cached query payload.
+        kMaxDatasetResponse  = 512,  ///< Max length of a cached response payload.
+        kMaxTokenLength      = 8,    ///< Max length of a CoAP token.
+        kDatasetQueryTimeout = 5000, ///< Time in milliseconds to wait for the leader before forwarding again.
+    };
+
+    enum
+    {
+        kForwardTimeout     = 15000, ///< Time in milliseconds to wait for the leader before answering 5.04.
+    };
+
+    enum
+    {
+        kObserveRegister   = 0,        ///< Observe option value registering an observer.
+        kObserveDeregister = 1,        ///< Observe option value deregistering an observer.
+        kMaxObserveValue   = 0xffffff, ///< Max value of the Observe option, notifications wrap around it.
+        kObserveDelay      = 200,      ///< Time in milliseconds dataset changes are coalesced before notifying.
+    };
+
+    enum
+    {
+        kCommissionerReuseDelay = 247000, ///< Time in milliseconds before a released commissioner is reused.
+        kPublishDelay           = 200,    ///< Default time in milliseconds NCP property changes are coalesced.
+        kMaxPublishDelayFactor  = 5,      ///< Max number of windows a burst of changes defers the MDNS update.
+        kMaxNameConflicts       = 2,      ///< Number of alternative names, the publisher picks names beyond.
+    };
+
+    enum
+    {
+        kRateLimitSession = 0,  ///< Index of the limit of all requests of a session.
+        kRateLimitCount   = 11, ///< Number of rate limits, the session one and one per commissioner resource.
+    };
+
+    /**
+     * This struct defines a rate limit of commissioner requests.
+     *
+     */
+    struct RateLimit
+    {
+        uint32_t mRate;  ///< Requests per second, 0 for no limit.
+        uint32_t mBurst; ///< Max requests in a burst, 0 to use the rate.
+    };
+
+    /**
+     * This struct defines a commissioner connected to the border agent.
+     *
+     * Commissioners are the contexts of requests forwarded to the leader. A released one is not reused within the
+     * CoAP exchange lifetime, so that late leader responses are never routed to another commissioner.
+     *
+     */
+    struct Commissioner
+    {
+        BorderAgent *  mBorderAgent;                   ///< The border agent owning this commissioner.
+        Dtls::Session *mSession;                       ///< The DTLS session, NULL once released.
+        uint8_t        mIp6[16];                       ///< The IPv6 address of the commissioner.
+        uint16_t       mPort;                          ///< The UDP port of the commissioner.
+        uint64_t       mReleaseTime;                   ///< When the DTLS session ended.
+        uint64_t       mRequestTime;                   ///< When the last request was forwarded, 0 once answered.
+        uint8_t        mRequestToken[kMaxTokenLength]; ///< Token of the last request forwarded to the leader.
+        uint8_t        mRequestTokenLength;            ///< Token length of the last request forwarded to the leader.
+        uint16_t       mSessionId;                     ///< The session id granted by the leader, 0 if none.
+        uint64_t       mAcceptTime;                    ///< When the leader last accepted the session, 0 if not.
+        TokenBucket    mBuckets[kRateLimitCount];      ///< Rate limits of the requests of this commissioner.
+    };
+
+    /**
+     * This member function pointer is called with the leader response to a request in flight, along with the
+     * commissioner and token kept by its entry, so that handlers need no context of their own.
+     *
+     */
+    typedef void (BorderAgent::*ForwardResponseHandler)(Commissioner &       aCommissioner,
+                                                        const Coap::Message &aMessage,
+                                                        const uint8_t *      aToken,
+                                                        uint8_t              aTokenLength);
+
+    /**
+     * This struct defines a commissioner resource forwarded to the leader.
+     *
+     */
+    struct ForwardResource : public Coap::Resource
+    {
+        Coap::EncodedPath      mLeaderPath;      ///< The Uri Path the request is forwarded to.
+        ForwardResponseHandler mResponseHandler; ///< The method to be called when the leader responds.
+
+        ForwardResource(const char *           aPath,
+                        const char *           aLeaderPath,
+                        ForwardResponseHandler aResponseHandler,
+                        Coap::RequestHandler   aHandler,
+                        void *                 aContext)
+            : Coap::Resource(aPath, aHandler, aContext)
+            , mLeaderPath(aLeaderPath)
+            , mResponseHandler(aResponseHandler)
+        {
+        }
+    };
+
+    /**
+     * This struct defines a commissioner request waiting for a leader response.
+     *
+     */
+    struct DatasetWaiter
+    {
+        Commissioner *mCommissioner;           ///< The commissioner of the request.
+        uint8_t       mToken[kMaxTokenLength]; ///< Token of the request.
+        uint8_t       mTokenLength;            ///< Token length of the request.
+    };
+
+    /**
+     * This struct defines a dataset query of commissioners and the cached leader response.
+     *
+     */
+    struct DatasetCacheEntry
+    {
+        BorderAgent *          mBorderAgent;                   ///< The border agent owning this entry.
+        const ForwardResource *mResource;                      ///< The resource queried, NULL if unused.
+        uint8_t                mQuery[kMaxDatasetQuery];       ///< The query payload.
+        uint16_t               mQueryLength;                   ///< Length of the query payload.
+        uint64_t               mDeadline;                      ///< When the response expires or the query is given up.
+        bool                   mInFlight;                      ///< Whether the query is in flight to the leader.
+        bool                   mStale;                         ///< Whether the dataset changed since the query.
+        uint8_t                mWaiterCount;                   ///< Number of requests waiting for the response.
+        DatasetWaiter          mWaiters[kDatasetCacheWaiters]; ///< Requests waiting for the response.
+        Coap::Code             mCode;                          ///< Code of the cached response.
+        uint8_t                mResponse[kMaxDatasetResponse]; ///< Payload of the cached response.
+        uint16_t               mResponseLength;                ///< Length of the cached response.
+    };
+
+    /**
+     * This struct defines a commissioner observing a dataset query.
+     *
+     */
+    struct DatasetObserver
+    {
+        const ForwardResource *mResource;                ///< The resource observed, NULL if unused.
+        Commissioner *         mCommissioner;            ///< The commissioner observing.
+        uint8_t                mToken[kMaxTokenLength];  ///< Token of the registration and the notifications.
+        uint8_t                mTokenLength;             ///< Token length of the registration.
+        uint8_t                mQuery[kMaxDatasetQuery]; ///< The query payload.
+        uint16_t               mQueryLength;             ///< Length of the query payload.
+        uint32_t               mSequence;                ///< Observe option value of the last notification.
+    };
+
+    /**
+     * This struct defines a commissioner request in flight to the leader.
+     *
+     */
+    struct PendingForward
+    {
+        BorderAgent *          mBorderAgent;            ///< The border agent owning this entry.
+        const ForwardResource *mResource;               ///< The resource requested, NULL if unused.
+        Commissioner *         mCommissioner;           ///< The commissioner of the request, NULL once released.
+        uint8_t                mToken[kMaxTokenLength]; ///< Token of the request.
+        uint8_t                mTokenLength;            ///< Token length of the request.
+        uint64_t               mDeadline;               ///< When the request is answered with 5.04.
+    };
+
     static void    FeedCoaps(const uint8_t *aBuffer, uint16_t aLength, void *aContext);
     static ssize_t SendCoaps(const uint8_t *aBuffer,
                              uint16_t       aLength,
                              const uint8_t *aIp6,
                              uint16_t       aPort,
                              void *         aContext);
+    static ssize_t SendCoapsVector(const struct iovec *aVector,
+                                   int                 aCount,
+                                   const uint8_t *     aIp6,
+                                   uint16_t            aPort,
+                                   void *              aContext);
 
     static void HandleDtlsSessionState(Dtls::Session &aSession, Dtls::Session::State aState, void *aContext)
     {
@@ -139,10 +656,16 @@ private:
                                     void *                aContext)
     {
         (void)aResource;
-        (void)aResponse;
-        static_cast<BorderAgent *>(aContext)->HandleRelayTransmit(aMessage, aIp6, aPort);
+        static_cast<BorderAgent *>(aContext)->HandleRelayTransmit(aMessage, aResponse, aIp6, aPort);
     }
-    void HandleRelayTransmit(const Coap::Message &aMessage, const uint8_t *aIp6, uint16_t aPort);
+    void HandleRelayTransmit(const Coap::Message &aMessage,
+                             Coap::Message &      aResponse,
+                             const uint8_t *      aIp6,
+                             uint16_t             aPort);
+    void RecordRelayFlow(RelayFlowTable::Direction aDirection,
+                         const Coap::Message &     aMessage,
+                         uint64_t                  aArrival,
+                         uint32_t                  aForwardTime);
 
     static void ForwardCommissionerRequest(const Coap::Resource &aResource,
                                            const Coap::Message & aMessage,
@@ -151,65 +674,234 @@ private:
                                            uint16_t              aPort,
                                            void *                aContext)
     {
-        (void)aIp6;
+        static_cast<BorderAgent *>(aContext)->ForwardCommissionerRequest(
+            static_cast<const ForwardResource &>(aResource), aMessage, aResponse, aIp6, aPort);
+    }
+    void ForwardCommissionerRequest(const ForwardResource &aResource,
+                                    const Coap::Message &  aMessage,
+                                    Coap::Message &        aResponse,
+                                    const uint8_t *        aIp6,
+                                    uint16_t               aPort);
+    void ForwardToLeader(const ForwardResource &aResource, Commissioner &aCommissioner, const Coap::Message &aMessage);
+
+    const Coap::Resource *GetRateLimitResource(unsigned int aIndex) const;
+    bool                  AdmitRequest(Commissioner &        aCommissioner,
+                                       const Coap::Resource &aResource,
+                                       const Coap::Message & aMessage,
+                                       Coap::Message &       aResponse);
+    bool                  AdmitUnderLoad(const Commissioner &  aCommissioner,
+                                         const Coap::Resource &aResource,
+                                         const Coap::Message & aMessage,
+                                         Coap::Message &       aResponse) const;
+    bool                  ValidateSession(const Commissioner & aCommissioner,
+                                          const Coap::Resource &aResource,
+                                          const Coap::Message & aMessage,
+                                          Coap::Message &       aResponse) const;
+    bool                  AnswerKeepAlive(const Commissioner &  aCommissioner,
+                                          const Coap::Resource &aResource,
+                                          const Coap::Message & aMessage,
+                                          Coap::Message &       aResponse) const;
+
+    void ForwardCommissionerResponse(Commissioner &       aCommissioner,
+                                     const Coap::Message &aMessage,
+                                     const uint8_t *      aToken,
+                                     uint8_t              aTokenLength);
+    void ForwardPetitionResponse(Commissioner &       aCommissioner,
+                                 const Coap::Message &aMessage,
+                                 const uint8_t *      aToken,
+                                 uint8_t              aTokenLength);
+
+    static void HandleDatasetResponse(const Coap::Message &aMessage, void *aContext)
+    {
+        DatasetCacheEntry &entry = *static_cast<DatasetCacheEntry *>(aContext);
+
+        entry.mBorderAgent->HandleDatasetResponse(entry, aMessage);
+    }
+    void HandleDatasetResponse(DatasetCacheEntry &aEntry, const Coap::Message &aMessage);
+
+    static void HandleForwardResponse(const Coap::Message &aMessage, void *aContext)
+    {
+        PendingForward &pending = *static_cast<PendingForward *>(aContext);
+
+        pending.mBorderAgent->HandleForwardResponse(pending, aMessage);
+    }
+    void            HandleForwardResponse(PendingForward &aPending, const Coap::Message &aMessage);
+    PendingForward *NewPendingForward(const ForwardResource &aResource,
+                                      Commissioner &         aCommissioner,
+                                      const uint8_t *        aToken,
+                                      uint8_t                aTokenLength);
+    static void     HandleForwardTimer(void *aContext) { static_cast<BorderAgent *>(aContext)->HandleForwardTimer(); }
+    void            HandleForwardTimer(void);
+    void            UpdateForwardTimer(void);
+    void            RespondCommissioner(const Commissioner &aCommissioner,
+                                        Coap::Code          aCode,
+                                        const uint8_t *     aToken,
+                                        uint8_t             aTokenLength);
+
+    static void HandleDatasetChanged(const Coap::Resource &aResource,
+                                     const Coap::Message & aMessage,
+                                     Coap::Message &       aResponse,
+                                     const uint8_t *       aIp6,
+                                     uint16_t              aPort,
+                                     void *                aContext)
+    {
+        (void)aResource;
+        (void)aResponse;
+        static_cast<BorderAgent *>(aContext)->HandleDatasetChanged(aMessage, aIp6, aPort);
+    }
+    void HandleDatasetChanged(const Coap::Message &aMessage, const uint8_t *aIp6, uint16_t aPort);
+
+    static void HandleEnergyReport(const Coap::Resource &aResource,
+                                   const Coap::Message & aMessage,
+                                   Coap::Message &       aResponse,
+                                   const uint8_t *       aIp6,
+                                   uint16_t              aPort,
+                                   void *                aContext)
+    {
+        (void)aResource;
         (void)aResponse;
-        static_cast<BorderAgent *>(aContext)->ForwardCommissionerRequest(aResource, aMessage, aIp6, aPort);
+        static_cast<BorderAgent *>(aContext)->HandleEnergyReport(aMessage, aIp6, aPort);
     }
-    void ForwardCommissionerRequest(const Coap::Resource &aResource,
+    void HandleEnergyReport(const Coap::Message &aMessage, const uint8_t *aIp6, uint16_t aPort);
+
+    static void HandlePanIdConflict(const Coap::Resource &aResource,
                                     const Coap::Message & aMessage,
+                                    Coap::Message &       aResponse,
                                     const uint8_t *       aIp6,
-                                    uint16_t              aPort);
+                                    uint16_t              aPort,
+                                    void *                aContext)
+    {
+        (void)aResource;
+        (void)aResponse;
+        static_cast<BorderAgent *>(aContext)->HandlePanIdConflict(aMessage, aIp6, aPort);
+    }
+    void HandlePanIdConflict(const Coap::Message &aMessage, const uint8_t *aIp6, uint16_t aPort);
+
+    void ForwardToCommissioner(const Coap::Message &aMessage);
 
-    static void ForwardCommissionerResponse(const Coap::Message &aMessage, void *aContext)
+    bool QueryDatasetCache(const ForwardResource &aResource,
+                           Commissioner &         aCommissioner,
+                           const Coap::Message &  aMessage,
+                           DatasetCacheEntry *&   aEntry);
+    void InvalidateDatasetCache(void);
+
+    void             UpdateDatasetObserver(const ForwardResource &aResource,
+                                           Commissioner &         aCommissioner,
+                                           const Coap::Message &  aMessage);
+    DatasetObserver *FindDatasetObserver(const Commissioner &aCommissioner,
+                                         const uint8_t *     aToken,
+                                         uint8_t             aTokenLength);
+    void             RemoveDatasetObserver(DatasetObserver &aObserver);
+    void             AddObserveOption(const Commissioner &aCommissioner,
+                                      const uint8_t *     aToken,
+                                      uint8_t             aTokenLength,
+                                      Coap::Message &     aMessage);
+    void             HandleDatasetChange(void);
+    void             NotifyDatasetObservers(void);
+
+    static void HandleObserveTimer(void *aContext)
     {
-        static_cast<BorderAgent *>(aContext)->ForwardCommissionerResponse(aMessage);
+        static_cast<BorderAgent *>(aContext)->NotifyDatasetObservers();
     }
-    void ForwardCommissionerResponse(const Coap::Message &aMessage);
+
+    Commissioner *NewCommissioner(Dtls::Session &aSession);
+    void          ReleaseCommissioner(Commissioner &aCommissioner);
+    Commissioner *FindCommissioner(const Dtls::Session &aSession) const;
+    Commissioner *FindCommissioner(const uint8_t *aIp6, uint16_t aPort) const;
 
     static void HandleMdnsState(void *aContext, Mdns::State aState)
     {
         static_cast<BorderAgent *>(aContext)->HandleMdnsState(aState);
     }
-    void HandleMdnsState(Mdns::State aState);
 
+    static void HandleMdnsConflict(void *aContext, uint16_t aPort, const char *aType)
+    {
+        static_cast<BorderAgent *>(aContext)->HandleMdnsConflict(aPort, aType);
+    }
+
+    void GetServiceName(char *aName, size_t aSize) const;
     void PublishService(void);
     void StartPublishService(void);
     void StopPublishService(void);
     void HandleThreadChange(void);
+    void UpdatePublisher(void);
+
+    static void HandlePublishTimer(void *aContext) { static_cast<BorderAgent *>(aContext)->UpdatePublisher(); }
 
     void SetNetworkName(const char *aNetworkName);
     void SetExtPanId(const uint8_t *aExtPanId);
-    void SetThreadStarted(bool aStarted);
+    void SetPSKc(const uint8_t *aPSKc);
+    void SetThreadStarted(bool aStarted, Ncp::ThreadRole aRole);
+    void RestoreWarmState(void);
+    void UpdateStateBitmap(void);
 
-    static void HandlePSKcChanged(void *aContext, int aEvent, va_list aArguments);
-    static void HandleThreadState(void *aContext, int aEvent, va_list aArguments);
-    static void HandleNetworkName(void *aContext, int aEvent, va_list aArguments);
-    static void HandleExtPanId(void *aContext, int aEvent, va_list aArguments);
+    static void HandlePSKcChanged(void *aContext, const Ncp::PSKcEvent &aEvent);
+    static void HandleThreadState(void *aContext, const Ncp::ThreadStateEvent &aEvent);
+    static void HandleNetworkName(void *aContext, const Ncp::NetworkNameEvent &aEvent);
+    static void HandleExtPanId(void *aContext, const Ncp::ExtPanIdEvent &aEvent);
 
-    Coap::Resource mActiveGet;
-    Coap::Resource mActiveSet;
-    Coap::Resource mPendingGet;
-    Coap::Resource mPendingSet;
+    ForwardResource mActiveGet;
+    ForwardResource mActiveSet;
+    ForwardResource mPendingGet;
+    ForwardResource mPendingSet;
 
     // Border agent resources for external commissioner.
-    Coap::Resource mCommissionerPetitionHandler;
-    Coap::Resource mCommissionerKeepAliveHandler;
-    Coap::Resource mCommissionerSetHandler;
-    Coap::Resource mCommissionerRelayTransmitHandler;
+    ForwardResource mCommissionerPetitionHandler;
+    ForwardResource mCommissionerKeepAliveHandler;
+    ForwardResource mCommissionerSetHandler;
+    Coap::Resource  mCommissionerRelayTransmitHandler;
+    ForwardResource mEnergyScan;
+    ForwardResource mPanIdQuery;
 
     // Border agent resources for Thread network.
     Coap::Resource mCommissionerRelayReceiveHandler;
+    Coap::Resource mDatasetChangedHandler;
+    Coap::Resource mEnergyReportHandler;
+    Coap::Resource mPanIdConflictHandler;
+    ChannelSurvey  mChannelSurvey;
+
+    DatasetCacheEntry mDatasetCache[kDatasetCacheEntries];
+    DatasetObserver   mDatasetObservers[kMaxDatasetObservers];
+    unsigned int      mDatasetObserverCount;
+    PendingForward    mPendingForwards[kMaxPendingForwards];
+    uint32_t          mDatasetCacheTimeout;
+    uint32_t          mKeepAliveInterval;
+
+    RateLimit          mRateLimits[kRateLimitCount]; ///< Rate limits of commissioners established from now on.
+    LoadShedder::Level mLoadLevel;                   ///< The level of load shedding.
+    RelayFlowTable     mRelayFlows;                  ///< The statistics of the relayed messages of each joiner.
 
     Coap::Agent *    mCoap;
     Dtls::Server *   mDtlsServer;
-    Dtls::Session *  mDtlsSession;
     Coap::Agent *    mCoaps;
     Mdns::Publisher *mPublisher;
+    bool             mOwnsPublisher; ///< Whether the publisher is created by and only used by this border agent.
+    unsigned int     mMdnsInterface;
+    uint16_t         mPort;
     Ncp::Controller *mNcp;
+    WarmState *      mWarmState; ///< The state kept across restarts, NULL if none.
+
+    uint8_t         mExtPanId[kSizeExtPanId];
+    char            mNetworkName[kSizeNetworkName + 1];
+    bool            mThreadStarted;
+    Ncp::ThreadRole mThreadRole;
+    bool            mHasPSKc;            ///< Whether commissioners can establish DTLS sessions.
+    Mdns::TxtRecord mTxt;                ///< The text record of the commissioning service.
+    uint8_t         mEui64[kSizeEui64];  ///< The EUI-64 of the NCP, valid if mHasEui64.
+    bool            mHasEui64;           ///< Whether the EUI-64 is known.
+    uint8_t         mNameConflicts;      ///< Number of alternative names of the commissioning service.
+
+    std::vector<Commissioner *> mCommissioners;      ///< Commissioners with DTLS sessions.
+    std::deque<Commissioner *>  mFreeCommissioners;  ///< Released commissioners, in the order released.
+    Commissioner *              mActiveCommissioner; ///< The commissioner accepted by the leader.
 
-    uint8_t mExtPanId[kSizeExtPanId];
-    char    mNetworkName[kSizeNetworkName + 1];
-    bool    mThreadStarted;
+    TimerWheel  mLocalTimerWheel;
+    TimerWheel *mTimerWheel;
+    Timer       mPublishTimer;    ///< Fires once NCP property changes settled.
+    uint64_t    mPublishDeadline; ///< The latest time to update the MDNS service for the current burst.
+    uint32_t    mPublishDelay;
+    Timer       mForwardTimer; ///< Fires once the earliest request in flight to the leader times out.
+    Timer       mObserveTimer; ///< Fires once dataset changes settled, to notify the dataset observers.
 };
 
 /**
@@ -0,0 +1,226 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   The file implements the aggregation of energy scan and PAN ID conflict reports.
+ */
+
+#include "channel_survey.hpp"
+
+#include <string.h>
+
+#include "common/code_utils.hpp"
+#include "common/time.hpp"
+#include "common/tlv.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+enum
+{
+    kChannelPage0 = 0, ///< The channel page of the 2.4 GHz band.
+};
+
+/**
+ * This function reads the channels of page 0 from a Channel Mask TLV.
+ *
+ * @returns true if @p aTlv is a well formed Channel Mask TLV, false otherwise.
+ *
+ */
+static bool ReadChannelMask(const Tlv *aTlv, uint32_t &aMask)
+{
+    bool           ret = false;
+    const uint8_t *cur = NULL;
+    const uint8_t *end = NULL;
+
+    VerifyOrExit(aTlv != NULL);
+
+    cur   = static_cast<const uint8_t *>(aTlv->GetValue());
+    end   = cur + aTlv->GetLength();
+    aMask = 0;
+
+    // Each entry is the channel page and the length of its mask, followed by the mask, channel 0 first.
+    while (cur < end)
+    {
+        uint8_t page;
+        uint8_t length;
+
+        VerifyOrExit(end - cur >= 2);
+        page   = cur[0];
+        length = cur[1];
+        cur += 2;
+        VerifyOrExit(end - cur >= length);
+
+        for (uint8_t channel = 0; page == kChannelPage0 && channel < 32 && channel / 8 < length; ++channel)
+        {
+            if (cur[channel / 8] & (0x80 >> (channel % 8)))
+            {
+                aMask |= static_cast<uint32_t>(1) << channel;
+            }
+        }
+
+        cur += length;
+    }
+
+    ret = true;
+
+exit:
+    return ret;
+}
+
+void ChannelSurvey::Clear(void)
+{
+    memset(mEnergy, 0, sizeof(mEnergy));
+    memset(mConflicts, 0, sizeof(mConflicts));
+    mConflictCount = 0;
+}
+
+bool ChannelSurvey::AddEnergyReport(const uint8_t *aPayload, uint16_t aLength)
+{
+    TlvReader     reader(aPayload, aLength);
+    const uint8_t types[] = {Meshcop::kChannelMask, Meshcop::kEnergyList};
+    const Tlv *   tlvs[sizeof(types)];
+    uint8_t       channels[32];
+    uint8_t       channelCount = 0;
+    uint32_t      mask         = 0;
+    const int8_t *energies     = NULL;
+    uint16_t      energyCount  = 0;
+    bool          ret          = false;
+
+    reader.Index(types, tlvs, sizeof(types));
+    VerifyOrExit(ReadChannelMask(tlvs[0], mask) && tlvs[1] != NULL);
+
+    for (uint8_t channel = 0; channel < 32; ++channel)
+    {
+        if (mask & (static_cast<uint32_t>(1) << channel))
+        {
+            channels[channelCount++] = channel;
+        }
+    }
+
+    // The list has a measurement per channel of the mask, repeated for each scan of the report.
+    energies    = static_cast<const int8_t *>(tlvs[1]->GetValue());
+    energyCount = tlvs[1]->GetLength();
+    VerifyOrExit(channelCount != 0 && energyCount % channelCount == 0);
+
+    for (uint16_t i = 0; i < energyCount; ++i)
+    {
+        uint8_t        channel = channels[i % channelCount];
+        int8_t         energy  = energies[i];
+        int            bucket  = 0;
+        ChannelEnergy *stats;
+
+        if (channel < kChannelMin || channel > kChannelMax)
+        {
+            continue;
+        }
+
+        stats = &mEnergy[channel - kChannelMin];
+
+        if (energy >= kBucketFloor)
+        {
+            bucket = (energy - kBucketFloor) / kBucketWidth + 1;
+            bucket = (bucket < kEnergyBuckets ? bucket : kEnergyBuckets - 1);
+        }
+
+        if (stats->mSamples == 0 || energy > stats->mMax)
+        {
+            stats->mMax = energy;
+        }
+
+        stats->mLast = energy;
+        stats->mSamples++;
+        stats->mBuckets[bucket]++;
+    }
+
+    ret = true;
+
+exit:
+    return ret;
+}
+
+bool ChannelSurvey::AddPanIdConflict(const uint8_t *aPayload, uint16_t aLength, uint16_t aReporter)
+{
+    TlvReader      reader(aPayload, aLength);
+    const uint8_t  types[] = {Meshcop::kPanId, Meshcop::kChannelMask};
+    const Tlv *    tlvs[sizeof(types)];
+    uint32_t       mask     = 0;
+    PanIdConflict *conflict = NULL;
+    uint16_t       panId;
+    bool           ret = false;
+
+    reader.Index(types, tlvs, sizeof(types));
+    VerifyOrExit(tlvs[0] != NULL && tlvs[0]->GetLength() == sizeof(uint16_t) && ReadChannelMask(tlvs[1], mask));
+
+    panId = tlvs[0]->GetValueUInt16();
+
+    for (uint8_t i = 0; i < mConflictCount; ++i)
+    {
+        if (mConflicts[i].mPanId == panId)
+        {
+            conflict = &mConflicts[i];
+            break;
+        }
+    }
+
+    if (conflict == NULL && mConflictCount < kMaxConflicts)
+    {
+        conflict = &mConflicts[mConflictCount++];
+        memset(conflict, 0, sizeof(*conflict));
+    }
+    else if (conflict == NULL)
+    {
+        conflict = &mConflicts[0];
+
+        for (uint8_t i = 1; i < mConflictCount; ++i)
+        {
+            if (mConflicts[i].mLastReport < conflict->mLastReport)
+            {
+                conflict = &mConflicts[i];
+            }
+        }
+
+        memset(conflict, 0, sizeof(*conflict));
+    }
+
+    conflict->mPanId = panId;
+    conflict->mChannelMask |= mask;
+    conflict->mReporter   = aReporter;
+    conflict->mLastReport = GetMonotonicNow();
+    conflict->mReports++;
+    ret = true;
+
+exit:
+    return ret;
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,171 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the aggregation of energy scan and PAN ID conflict reports.
+ */
+
+#ifndef CHANNEL_SURVEY_HPP_
+#define CHANNEL_SURVEY_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class aggregates the energy reports and PAN ID conflicts Thread devices send to commissioners.
+ *
+ * The energy measured on each channel is kept as a histogram, the PAN ID conflicts as a set of PAN IDs with the
+ * channels they were seen on, so that the survey of a network outlives the commissioner which asked for it.
+ *
+ */
+class ChannelSurvey
+{
+public:
+    enum
+    {
+        kChannelMin    = 11,   ///< The first channel of page 0 in the 2.4 GHz band.
+        kChannelMax    = 26,   ///< The last channel of page 0 in the 2.4 GHz band.
+        kEnergyBuckets = 8,    ///< Number of buckets of an energy histogram.
+        kBucketWidth   = 10,   ///< Width of a bucket in dBm.
+        kBucketFloor   = -100, ///< Lower bound in dBm of the second bucket, the first takes all lower energies.
+        kMaxConflicts  = 16,   ///< Max number of PAN IDs in conflict kept.
+    };
+
+    /**
+     * This struct defines the energy measured on a channel.
+     *
+     */
+    struct ChannelEnergy
+    {
+        uint32_t mSamples;                 ///< Number of measurements.
+        int8_t   mMax;                     ///< The highest energy in dBm, only valid with measurements.
+        int8_t   mLast;                    ///< The energy in dBm of the last measurement.
+        uint32_t mBuckets[kEnergyBuckets]; ///< Bucket i > 0 counts the kBucketWidth dBm from kBucketFloor +
+                                           ///< (i - 1) * kBucketWidth, the last one all higher energies.
+    };
+
+    /**
+     * This struct defines a PAN ID in conflict with the network.
+     *
+     */
+    struct PanIdConflict
+    {
+        uint16_t mPanId;       ///< The PAN ID in conflict.
+        uint32_t mChannelMask; ///< Bit i is set if the PAN ID was seen on channel i.
+        uint16_t mReporter;    ///< The RLOC16 of the last device to report the conflict.
+        uint32_t mReports;     ///< Number of reports of the conflict.
+        uint64_t mLastReport;  ///< Monotonic time in milliseconds of the last report.
+    };
+
+    /**
+     * The constructor to initialize an empty survey.
+     *
+     */
+    ChannelSurvey(void) { Clear(); }
+
+    /**
+     * This method adds the measurements of an energy report.
+     *
+     * @param[in]   aPayload    A pointer to the TLVs of the MGMT_ED_REPORT.ans.
+     * @param[in]   aLength     The length of @p aPayload.
+     *
+     * @retval  true    Successfully added the measurements.
+     * @retval  false   The report has no channel mask or energy list, or they do not match.
+     *
+     */
+    bool AddEnergyReport(const uint8_t *aPayload, uint16_t aLength);
+
+    /**
+     * This method adds a PAN ID conflict report.
+     *
+     * The least recently reported PAN ID is replaced once kMaxConflicts are kept.
+     *
+     * @param[in]   aPayload    A pointer to the TLVs of the MGMT_PANID_CONFLICT.ans.
+     * @param[in]   aLength     The length of @p aPayload.
+     * @param[in]   aReporter   The RLOC16 of the device reporting it.
+     *
+     * @retval  true    Successfully added the conflict.
+     * @retval  false   The report has no PAN ID or channel mask.
+     *
+     */
+    bool AddPanIdConflict(const uint8_t *aPayload, uint16_t aLength, uint16_t aReporter);
+
+    /**
+     * This method returns the energy measured on a channel.
+     *
+     * @param[in]   aChannel    The channel, from kChannelMin to kChannelMax.
+     *
+     * @returns A pointer to the energy of @p aChannel, NULL if not a channel of the survey.
+     *
+     */
+    const ChannelEnergy *GetEnergy(uint8_t aChannel) const
+    {
+        return (aChannel >= kChannelMin && aChannel <= kChannelMax) ? &mEnergy[aChannel - kChannelMin] : NULL;
+    }
+
+    /**
+     * This method returns the PAN IDs in conflict.
+     *
+     * @param[out]  aCount  A reference to receive the number of PAN IDs in conflict.
+     *
+     * @returns A pointer to the PAN IDs in conflict.
+     *
+     */
+    const PanIdConflict *GetConflicts(uint8_t &aCount) const
+    {
+        aCount = mConflictCount;
+        return mConflicts;
+    }
+
+    /**
+     * This method drops all measurements and conflicts.
+     *
+     */
+    void Clear(void);
+
+private:
+    enum
+    {
+        kChannelCount = kChannelMax - kChannelMin + 1,
+    };
+
+    ChannelEnergy mEnergy[kChannelCount];
+    PanIdConflict mConflicts[kMaxConflicts];
+    uint8_t       mConflictCount;
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // CHANNEL_SURVEY_HPP_
@@ -0,0 +1,243 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the CoAP definitions shared by the CoAP engines.
+ */
+
+#include "coap.hpp"
+
+#include <errno.h>
+#include <string.h>
+
+#include "common/code_utils.hpp"
+
+#include "uris.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Coap {
+
+enum
+{
+    kOptionExtended8     = 13,   ///< Option nibble of a 1-byte extension.
+    kOptionExtended8Max  = 268,  ///< Largest value encoded with a 1-byte extension.
+    kOptionHeaderMaxSize = 2,    ///< Max bytes of the header of a Uri-Path option encoded here.
+    kHeaderSize          = 4,    ///< Bytes of the fixed header of a message.
+    kTokenLengthMask     = 0x0f, ///< Token length bits of the first byte of a message.
+    kTokenMaxLength      = 8,    ///< Max bytes of the token of a message.
+    kPayloadMarker       = 0xff, ///< Byte between the options and the payload of a message.
+};
+
+EncodedPath::EncodedPath(const char *aPath)
+    : mPath(aPath)
+    , mLength(0)
+{
+    uint16_t delta  = kOptionUriPath;
+    size_t   length = 0;
+
+    while (*aPath != '\0')
+    {
+        const char *end = strchr(aPath, '/');
+
+        if (end == NULL)
+        {
+            end = aPath + strlen(aPath);
+        }
+
+        if (end > aPath)
+        {
+            size_t segment = static_cast<size_t>(end - aPath);
+
+            // The delta of Uri-Path options is below kOptionExtended8, only the length may need an extension.
+            VerifyOrExit(segment <= kOptionExtended8Max && length + kOptionHeaderMaxSize + segment <= kMaxLength,
+                         length = 0);
+
+            if (segment < kOptionExtended8)
+            {
+                mOptions[length++] = static_cast<uint8_t>((delta << 4) | segment);
+            }
+            else
+            {
+                mOptions[length++] = static_cast<uint8_t>((delta << 4) | kOptionExtended8);
+                mOptions[length++] = static_cast<uint8_t>(segment - kOptionExtended8);
+            }
+
+            memcpy(mOptions + length, aPath, segment);
+            length += segment;
+            delta = 0;
+        }
+
+        aPath = (*end == '/') ? end + 1 : end;
+    }
+
+exit:
+    mLength = static_cast<uint8_t>(length);
+}
+
+/**
+ * This function returns whether the options of a message start with a Uri Path, and have no other segment.
+ *
+ */
+static bool StartsWithPath(const uint8_t *aOptions, uint16_t aLength, const EncodedPath &aPath)
+{
+    uint8_t        length;
+    const uint8_t *path = aPath.GetOptions(length);
+
+    return length > 0 && aLength >= length && memcmp(aOptions, path, length) == 0 &&
+           (aLength == length || aOptions[length] == kPayloadMarker || (aOptions[length] >> 4) != 0);
+}
+
+Priority GetPriority(const uint8_t *aBuffer, uint16_t aLength)
+{
+    static const EncodedPath kControlPaths[] = {
+        EncodedPath(OT_URI_PATH_LEADER_PETITION),       EncodedPath(OT_URI_PATH_LEADER_KEEP_ALIVE),
+        EncodedPath(OT_URI_PATH_COMMISSIONER_PETITION), EncodedPath(OT_URI_PATH_COMMISSIONER_KEEP_ALIVE),
+    };
+    static const EncodedPath kBulkPaths[] = {
+        EncodedPath(OT_URI_PATH_RELAY_RX),
+        EncodedPath(OT_URI_PATH_RELAY_TX),
+    };
+
+    Priority       priority = kPriorityManagement;
+    uint8_t        tokenLength;
+    uint8_t        code;
+    const uint8_t *options;
+    uint16_t       length;
+
+    VerifyOrExit(aLength >= kHeaderSize);
+    tokenLength = aBuffer[0] & kTokenLengthMask;
+    code        = aBuffer[1];
+    VerifyOrExit(tokenLength <= kTokenMaxLength && aLength >= kHeaderSize + tokenLength);
+    VerifyOrExit(code != kCodeEmpty && code < kCodeCodeMin, priority = kPriorityControl);
+
+    options = aBuffer + kHeaderSize + tokenLength;
+    length  = static_cast<uint16_t>(aLength - kHeaderSize - tokenLength);
+
+    for (size_t i = 0; i < sizeof(kControlPaths) / sizeof(kControlPaths[0]); ++i)
+    {
+        VerifyOrExit(!StartsWithPath(options, length, kControlPaths[i]), priority = kPriorityControl);
+    }
+
+    for (size_t i = 0; i < sizeof(kBulkPaths) / sizeof(kBulkPaths[0]); ++i)
+    {
+        VerifyOrExit(!StartsWithPath(options, length, kBulkPaths[i]), priority = kPriorityBulk);
+    }
+
+exit:
+    return priority;
+}
+
+Future::Future(void)
+    : mState(kStateIdle)
+    , mDeadline(0)
+    , mCode(kCodeEmpty)
+    , mTokenLength(0)
+    , mPayloadLength(0)
+{
+}
+
+otbrError Future::Send(Agent &aAgent, Message &aMessage, uint32_t aTimeout, const uint8_t *aIp6, uint16_t aPort)
+{
+    otbrError      ret = OTBR_ERROR_ERRNO;
+    uint8_t        length;
+    const uint8_t *token = aMessage.GetToken(length);
+
+    Reset();
+    VerifyOrExit(length <= kMaxTokenLength, errno = EINVAL);
+
+    memcpy(mToken, token, length);
+    mTokenLength = length;
+    mDeadline    = GetMonotonicNow() + aTimeout;
+    mState       = kStatePending;
+
+    SuccessOrExit(ret = aAgent.Send(aMessage, aIp6, aPort, HandleResponse, this));
+
+exit:
+    if (ret != OTBR_ERROR_NONE)
+    {
+        mState = kStateError;
+    }
+
+    return ret;
+}
+
+Future::State Future::Poll(uint64_t aNow)
+{
+    if (mState == kStatePending && aNow >= mDeadline)
+    {
+        mState = kStateTimeout;
+    }
+
+    return mState;
+}
+
+void Future::Reset(void)
+{
+    mState         = kStateIdle;
+    mCode          = kCodeEmpty;
+    mTokenLength   = 0;
+    mPayloadLength = 0;
+}
+
+void Future::HandleResponse(const Message &aMessage, void *aContext)
+{
+    static_cast<Future *>(aContext)->HandleResponse(aMessage);
+}
+
+void Future::HandleResponse(const Message &aMessage)
+{
+    uint8_t        length;
+    const uint8_t *token = aMessage.GetToken(length);
+    const uint8_t *payload;
+    uint16_t       payloadLength;
+
+    // The response of a request this future no longer waits for.
+    VerifyOrExit(mState == kStatePending && length == mTokenLength && memcmp(token, mToken, length) == 0);
+
+    payload        = aMessage.GetPayload(payloadLength);
+    mPayloadLength = payloadLength < kMaxPayloadLength ? payloadLength : static_cast<uint16_t>(kMaxPayloadLength);
+    if (mPayloadLength > 0)
+    {
+        memcpy(mPayload, payload, mPayloadLength);
+    }
+    mCode  = aMessage.GetCode();
+    mState = kStateReady;
+
+exit:
+    return;
+}
+
+} // namespace Coap
+
+} // namespace BorderRouter
+
+} // namespace ot
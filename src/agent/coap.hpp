@@ -37,6 +37,10 @@
 #include <stdint.h>
 #include <unistd.h>
 
+#include <sys/uio.h>
+
+#include "common/output_scheduler.hpp"
+#include "common/timer.hpp"
 #include "common/types.hpp"
 
 namespace ot {
@@ -83,8 +87,91 @@ enum Code
     kCodeValid   = 0x43, ///< Valid
     kCodeChanged = 0x44, ///< Changed
     kCodeContent = 0x45, ///< Content
+
+    kCodeServiceUnavailable = 0xa3, ///< 5.03 Service Unavailable
+    kCodeGatewayTimeout     = 0xa4, ///< 5.04 Gateway Timeout
+};
+
+/**
+ * CoAP Option numbers.
+ *
+ */
+enum Option
+{
+    kOptionObserve = 6,  ///< Observe, RFC 7641
+    kOptionUriPath = 11, ///< Uri-Path
+    kOptionMaxAge  = 14, ///< Max-Age
+    kOptionBlock2  = 23, ///< Block2, RFC 7959
+    kOptionBlock1  = 27, ///< Block1, RFC 7959
+    kOptionSize2   = 28, ///< Size2, RFC 7959
+    kOptionSize1   = 60, ///< Size1, RFC 7959
+};
+
+/**
+ * This class represents a Uri Path encoded once as the CoAP options starting a message, so that it is set on
+ * messages without being parsed again.
+ *
+ */
+class EncodedPath
+{
+public:
+    enum
+    {
+        kMaxLength = 32, ///< Max bytes of the encoded options.
+    };
+
+    /**
+     * The constructor encodes a Uri Path.
+     *
+     * A path whose options exceed kMaxLength is not encoded, and is parsed by the message it is set on.
+     *
+     * @param[in]   aPath       A pointer to the null-terminated string of Uri Path, which must stay valid.
+     *
+     */
+    explicit EncodedPath(const char *aPath);
+
+    /**
+     * This method returns the Uri Path.
+     *
+     * @returns A pointer to the null-terminated string of Uri Path.
+     *
+     */
+    const char *GetPath(void) const { return mPath; }
+
+    /**
+     * This method returns the encoded options.
+     *
+     * @param[out]  aLength     Number of bytes of the options, 0 if the path is not encoded.
+     *
+     * @returns A pointer to the options, encoded with no option before them.
+     *
+     */
+    const uint8_t *GetOptions(uint8_t &aLength) const
+    {
+        aLength = mLength;
+        return mOptions;
+    }
+
+private:
+    const char *mPath;
+    uint8_t     mOptions[kMaxLength];
+    uint8_t     mLength;
 };
 
+/**
+ * This function returns the output priority of an encoded CoAP message.
+ *
+ * Relayed joiner traffic is bulk. Petitions, keep-alives, empty messages and responses, which commissioners and the
+ * leader wait for, are control. Other requests are management.
+ *
+ * @param[in]   aBuffer     A pointer to the encoded message.
+ * @param[in]   aLength     Number of bytes of @p aBuffer.
+ *
+ * @returns The priority, kPriorityManagement if the message cannot be parsed.
+ *
+ */
+Priority GetPriority(const uint8_t *aBuffer, uint16_t aLength);
+
 /**
  * This interface defines CoAP message functionality.
  *
@@ -153,6 +240,40 @@ public:
      */
     virtual void SetPath(const char *aPath) = 0;
 
+    /**
+     * This method sets the CoAP Uri Path of this message from its encoded options.
+     *
+     * The options are copied as they are when the message has no option yet, otherwise the path is set as by
+     * SetPath().
+     *
+     * @param[in]   aPath       A reference to the encoded Uri Path.
+     *
+     */
+    virtual void SetPathEncoded(const EncodedPath &aPath) = 0;
+
+    /**
+     * This method returns the value of an unsigned integer option of this message.
+     *
+     * @param[in]   aOption     The option number.
+     * @param[out]  aValue      The option value.
+     *
+     * @retval  true    The option is present.
+     * @retval  false   The option is absent.
+     *
+     */
+    virtual bool GetUintOption(Option aOption, uint32_t &aValue) const = 0;
+
+    /**
+     * This method appends an unsigned integer option to this message.
+     *
+     * Options must be appended in ascending order of their numbers, the Uri Path included, and before the payload.
+     *
+     * @param[in]   aOption     The option number.
+     * @param[in]   aValue      The option value.
+     *
+     */
+    virtual void AddUintOption(Option aOption, uint32_t aValue) = 0;
+
     /**
      * This method returns the payload of this message.
      *
@@ -254,9 +375,39 @@ public:
     typedef ssize_t (
         *NetworkSender)(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort, void *aContext);
 
+    /**
+     * This function poiner is called when the agent sends a message gathered from parts.
+     *
+     * @param[in]   aVector     A pointer to the parts of the message, in order.
+     * @param[in]   aCount      Number of parts in @p aVector.
+     * @param[in]   aIp6        A pointer to the destination Ipv6 address.
+     * @param[in]   aPort       Destination UDP port.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     * @returns number of bytes successfully sended, a negative value indicates failure.
+     *
+     */
+    typedef ssize_t (*VectorSender)(const struct iovec *aVector,
+                                    int                 aCount,
+                                    const uint8_t *     aIp6,
+                                    uint16_t            aPort,
+                                    void *              aContext);
+
+    /**
+     * This method sets the function sending messages gathered from parts, with the context of the network sender.
+     *
+     * Without it, or if the engine encodes messages contiguously, SendPayload() copies the payload into the message.
+     *
+     * @param[in]   aVectorSender   A pointer to the function, NULL to only send contiguous messages.
+     *
+     */
+    virtual void SetVectorSender(VectorSender aVectorSender) = 0;
+
     /**
      * This method processes this CoAP message in @p aBuffer, which can be a request or response.
      *
+     * The message is parsed from @p aBuffer directly, which only needs to stay valid during this call.
+     *
      * @param[in]   aBuffer     A pointer to decrypted data.
      * @param[in]   aLength     Number of bytes of @p aBuffer.
      * @param[in]   aIp6        A pointer to the source Ipv6 address of this request.
@@ -286,6 +437,46 @@ public:
      */
     virtual void FreeMessage(Message *aMessage) = 0;
 
+    /**
+     * This method returns the number of messages allocated on the heap because the message pool was exhausted.
+     *
+     * @returns Number of messages created outside the pool.
+     *
+     */
+    virtual uint32_t GetMessagePoolMisses(void) const = 0;
+
+    /**
+     * This method sets the max number of confirmable messages in flight.
+     *
+     * Confirmable messages sent beyond this limit fail with ENOBUFS until a response is received or a transaction
+     * expires.
+     *
+     * @param[in]   aCount      The max number of confirmable messages in flight.
+     *
+     */
+    virtual void SetMaxTransactions(unsigned int aCount) = 0;
+
+    /**
+     * This method returns the number of confirmable requests to @p aPath waiting for their responses.
+     *
+     * @param[in]   aPath       A pointer to to the null-terminated string of Uri Path, NULL for all paths.
+     *
+     * @returns Number of requests in flight to @p aPath.
+     *
+     */
+    virtual unsigned int GetTransactionCount(const char *aPath) const = 0;
+
+    /**
+     * This method sets the time requests received are remembered, to detect their retransmissions.
+     *
+     * A retransmitted request is not handled again, the acknowledgment or response sent to the first one is sent
+     * again instead.
+     *
+     * @param[in]   aLifetime   The lifetime in milliseconds, 0 to handle every request received.
+     *
+     */
+    virtual void SetDuplicateLifetime(uint32_t aLifetime) = 0;
+
     /**
      * This method registers a CoAP resource.
      *
@@ -319,7 +510,7 @@ public:
      *
      * @retval      OTBR_ERROR_NONE     Successfully sent the message.
      * @retval      OTBR_ERROR_ERRNO    Failed to send the message.
-     *                                  - EMSGSIZE No space for response handler.
+     *                                  - ENOBUFS Too many confirmable messages in flight.
      *
      */
     virtual otbrError Send(Message &       aMessage,
@@ -328,15 +519,61 @@ public:
                            ResponseHandler aHandler,
                            void *          aContext) = 0;
 
+    /**
+     * This method forwards a received CoAP message as a non-confirmable one.
+     *
+     * The token, options and payload of @p aMessage are sent as they are, only the type and message id in its
+     * header are rewritten with this agent's. @p aMessage may come from another agent and is left unchanged.
+     *
+     * @param[in]   aMessage    A reference to the message to forward.
+     * @param[in]   aIp6        A pointer to the destination Ipv6 address.
+     * @param[in]   aPort       Destination UDP port.
+     *
+     * @retval      OTBR_ERROR_NONE     Successfully forwarded the message.
+     * @retval      OTBR_ERROR_ERRNO    Failed to forward the message.
+     *
+     */
+    virtual otbrError Forward(const Message &aMessage, const uint8_t *aIp6, uint16_t aPort) = 0;
+
+    /**
+     * This method sends a message with a payload, as Send() without a response handler does.
+     *
+     * A non-confirmable message is sent as its encoded header and options followed by @p aPayload through the vector
+     * sender if any, so the payload is never copied into the message. Otherwise it is set as the payload first.
+     *
+     * @param[in]   aMessage    A reference to the message to send, without a payload.
+     * @param[in]   aPayload    A pointer to the payload, which only needs to stay valid during this call.
+     * @param[in]   aLength     Number of bytes of @p aPayload.
+     * @param[in]   aIp6        A pointer to the destination Ipv6 address.
+     * @param[in]   aPort       Destination UDP port.
+     *
+     * @retval      OTBR_ERROR_NONE     Successfully sent the message.
+     * @retval      OTBR_ERROR_ERRNO    Failed to send the message.
+     *                                  - EMSGSIZE The payload does not fit in the message.
+     *
+     */
+    virtual otbrError SendPayload(Message &      aMessage,
+                                  const uint8_t *aPayload,
+                                  uint16_t       aLength,
+                                  const uint8_t *aIp6,
+                                  uint16_t       aPort) = 0;
+
     /**
      * This method creates a CoAP agent.
      *
      * @param[in]   aNetworkSender  A pointer to the function that actually sends the data.
      * @param[in]   aContext        A pointer to application-specific context.
+     * @param[in]   aTimerWheel     A pointer to the timer wheel to schedule retransmissions with, NULL to disable
+     *                              retransmissions of confirmable messages.
+     * @param[in]   aShared         A pointer to an agent of the same thread, whose messages, transactions and message
+     *                              ids the new agent shares if the engine supports it, NULL to share nothing.
      *
      * @returns The pointer to CoAP agent.
      */
-    static Agent *Create(NetworkSender aNetworkSender, void *aContext = NULL);
+    static Agent *Create(NetworkSender aNetworkSender,
+                         void *        aContext    = NULL,
+                         TimerWheel *  aTimerWheel = NULL,
+                         Agent *       aShared     = NULL);
 
     /**
      * This method destroys a CoAP agent.
@@ -349,6 +586,182 @@ public:
     virtual ~Agent(void) {}
 };
 
+/**
+ * This class implements a CoAP message owned by the scope declaring it.
+ *
+ * The message is taken from the agent's message pool when constructed and returned to it when destroyed, so no
+ * FreeMessage() call is needed on any path.
+ *
+ */
+class ScopedMessage
+{
+public:
+    /**
+     * The constructor to create a CoAP message with the given arguments.
+     *
+     * @param[in]   aAgent          A reference to the CoAP agent creating the message.
+     * @param[in]   aType           The CoAP type.
+     * @param[in]   aCode           The CoAP code.
+     * @param[in]   aToken          The CoAP token.
+     * @param[in]   aTokenLength    Number of bytes in @p aToken.
+     *
+     */
+    ScopedMessage(Agent &aAgent, Type aType, Code aCode, const uint8_t *aToken, uint8_t aTokenLength)
+        : mAgent(aAgent)
+        , mMessage(aAgent.NewMessage(aType, aCode, aToken, aTokenLength))
+    {
+    }
+
+    ~ScopedMessage(void)
+    {
+        if (mMessage != NULL)
+        {
+            mAgent.FreeMessage(mMessage);
+        }
+    }
+
+    /**
+     * This method returns the owned message.
+     *
+     * @returns A pointer to the message, NULL if failed to create it.
+     *
+     */
+    Message *Get(void) const { return mMessage; }
+
+    Message *operator->(void) const { return mMessage; }
+    Message &operator*(void) const { return *mMessage; }
+
+private:
+    ScopedMessage(const ScopedMessage &);
+    ScopedMessage &operator=(const ScopedMessage &);
+
+    Agent &  mAgent;
+    Message *mMessage;
+};
+
+/**
+ * This class implements the future response of a confirmable request.
+ *
+ * Instead of a response handler, the sender polls the future, so that many requests in flight are driven by a
+ * single loop, each with its own deadline. The response is copied into the future and the future ignores responses
+ * whose token is not the one of its latest request, so it may be sent again once it is no longer pending. The future
+ * must outlive the agent's transaction of its request.
+ *
+ */
+class Future
+{
+public:
+    /**
+     * State of a future.
+     *
+     */
+    enum State
+    {
+        kStateIdle    = 0, ///< No request was sent.
+        kStatePending = 1, ///< The request was sent, waiting for its response.
+        kStateReady   = 2, ///< The response was received.
+        kStateTimeout = 3, ///< No response was received before the deadline.
+        kStateError   = 4, ///< The request failed to be sent.
+    };
+
+    enum
+    {
+        kMaxTokenLength   = 8,    ///< Max bytes of a CoAP token.
+        kMaxPayloadLength = 1280, ///< Max bytes of a response payload kept, longer ones are truncated.
+    };
+
+    /**
+     * The constructor to initialize an idle future.
+     *
+     */
+    Future(void);
+
+    /**
+     * This method sends a confirmable request and makes this future wait for its response.
+     *
+     * @param[in]   aAgent      A reference to the CoAP agent sending the request.
+     * @param[in]   aMessage    A reference to the confirmable request, with the token identifying its response.
+     * @param[in]   aTimeout    The time to wait for the response in milliseconds.
+     * @param[in]   aIp6        A pointer to the destination Ipv6 address.
+     * @param[in]   aPort       Destination UDP port.
+     *
+     * @retval      OTBR_ERROR_NONE     Successfully sent the request, the future is pending.
+     * @retval      OTBR_ERROR_ERRNO    Failed to send the request, the future is in error.
+     *
+     */
+    otbrError Send(Agent &        aAgent,
+                   Message &      aMessage,
+                   uint32_t       aTimeout,
+                   const uint8_t *aIp6  = NULL,
+                   uint16_t       aPort = 0);
+
+    /**
+     * This method expires a pending future whose deadline has passed.
+     *
+     * @param[in]   aNow        The current monotonic time in milliseconds.
+     *
+     * @returns The state of this future.
+     *
+     */
+    State Poll(uint64_t aNow);
+
+    /**
+     * This method returns the state of this future.
+     *
+     * @returns The state of this future.
+     *
+     */
+    State GetState(void) const { return mState; }
+
+    /**
+     * This method returns when a pending future expires.
+     *
+     * @returns The monotonic time in milliseconds of the deadline.
+     *
+     */
+    uint64_t GetDeadline(void) const { return mDeadline; }
+
+    /**
+     * This method returns the code of the response.
+     *
+     * @returns The code of the response, kCodeEmpty unless ready.
+     *
+     */
+    Code GetCode(void) const { return mCode; }
+
+    /**
+     * This method returns the payload of the response.
+     *
+     * @param[out]  aLength     A reference to receive the length of the payload.
+     *
+     * @returns A pointer to the payload, valid until the future is sent again or reset.
+     *
+     */
+    const uint8_t *GetPayload(uint16_t &aLength) const
+    {
+        aLength = mPayloadLength;
+        return mPayload;
+    }
+
+    /**
+     * This method makes this future idle, a response to its request still in flight is ignored.
+     *
+     */
+    void Reset(void);
+
+private:
+    static void HandleResponse(const Message &aMessage, void *aContext);
+    void        HandleResponse(const Message &aMessage);
+
+    State    mState;
+    uint64_t mDeadline;
+    Code     mCode;
+    uint8_t  mToken[kMaxTokenLength];
+    uint8_t  mTokenLength;
+    uint16_t mPayloadLength;
+    uint8_t  mPayload[kMaxPayloadLength];
+};
+
 /**
  * @}
  */
@@ -0,0 +1,192 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the detection of retransmitted CoAP requests.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_COAP
+
+#include "coap_dedup.hpp"
+
+#include <string.h>
+
+#include "coap.hpp"
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Coap {
+
+static Metrics::Counter sDuplicates("coap.duplicates");
+static Metrics::Counter sDuplicatesReplayed("coap.duplicates_replayed");
+
+// Messages without a peer address are remembered as from the unspecified address.
+static const uint8_t kUnspecifiedAddress[16] = {0};
+
+DuplicateCache::DuplicateCache(void)
+    : mLifetime(kDefaultLifetime)
+{
+    memset(mEntries, 0, sizeof(mEntries));
+}
+
+void DuplicateCache::SetLifetime(uint32_t aLifetime)
+{
+    mLifetime = aLifetime;
+
+    if (mLifetime == 0)
+    {
+        memset(mEntries, 0, sizeof(mEntries));
+    }
+}
+
+DuplicateCache::Entry *DuplicateCache::Find(const uint8_t *aIp6, uint16_t aPort, uint16_t aMessageId)
+{
+    Entry *entry = NULL;
+
+    if (aIp6 == NULL)
+    {
+        aIp6 = kUnspecifiedAddress;
+    }
+
+    for (size_t i = 0; i < kMaxEntries; ++i)
+    {
+        Entry &candidate = mEntries[i];
+
+        if (candidate.mExpiration != 0 && candidate.mMessageId == aMessageId && candidate.mPeerPort == aPort &&
+            memcmp(candidate.mPeerAddress, aIp6, sizeof(candidate.mPeerAddress)) == 0)
+        {
+            entry = &candidate;
+            break;
+        }
+    }
+
+    return entry;
+}
+
+bool DuplicateCache::Check(const uint8_t * aBuffer,
+                           uint16_t        aLength,
+                           const uint8_t * aIp6,
+                           uint16_t        aPort,
+                           uint64_t        aNow,
+                           const uint8_t *&aResponse,
+                           uint16_t &      aResponseLength)
+{
+    bool     duplicate = false;
+    Entry *  entry;
+    uint16_t messageId;
+    uint8_t  type;
+
+    aResponse       = NULL;
+    aResponseLength = 0;
+
+    VerifyOrExit(mLifetime != 0 && aLength >= kHeaderSize && aBuffer[1] != kCodeEmpty && aBuffer[1] < kCodeRequest);
+
+    type      = (aBuffer[0] >> 4) & 0x03;
+    messageId = static_cast<uint16_t>((aBuffer[2] << 8) | aBuffer[3]);
+    VerifyOrExit(type == kTypeConfirmable || type == kTypeNonConfirmable);
+
+    entry = Find(aIp6, aPort, messageId);
+
+    if (entry != NULL && entry->mExpiration > aNow && entry->mResponseLength != kTooLarge)
+    {
+        otbrLog(OTBR_LOG_DEBUG, "CoAP request %u retransmitted", messageId);
+        sDuplicates.Add();
+
+        if (entry->mResponseLength != 0)
+        {
+            sDuplicatesReplayed.Add();
+            aResponse       = entry->mResponse;
+            aResponseLength = entry->mResponseLength;
+        }
+
+        ExitNow(duplicate = true);
+    }
+
+    if (entry == NULL)
+    {
+        entry = &mEntries[0];
+
+        // An unused or expired entry, or else the one expiring first.
+        for (size_t i = 1; i < kMaxEntries && entry->mExpiration > aNow; ++i)
+        {
+            if (mEntries[i].mExpiration < entry->mExpiration)
+            {
+                entry = &mEntries[i];
+            }
+        }
+    }
+
+    memcpy(entry->mPeerAddress, aIp6 != NULL ? aIp6 : kUnspecifiedAddress, sizeof(entry->mPeerAddress));
+    entry->mPeerPort       = aPort;
+    entry->mMessageId      = messageId;
+    entry->mExpiration     = aNow + mLifetime;
+    entry->mResponseLength = 0;
+
+exit:
+    return duplicate;
+}
+
+void DuplicateCache::Record(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort)
+{
+    Entry * entry;
+    uint8_t type;
+
+    VerifyOrExit(mLifetime != 0 && aLength >= kHeaderSize);
+
+    // Only acknowledgments and resets carry the message id of the request.
+    type = (aBuffer[0] >> 4) & 0x03;
+    VerifyOrExit(type == kTypeAcknowledgment || type == kTypeReset);
+
+    entry = Find(aIp6, aPort, static_cast<uint16_t>((aBuffer[2] << 8) | aBuffer[3]));
+    VerifyOrExit(entry != NULL);
+
+    if (aLength <= kMaxResponseSize)
+    {
+        memcpy(entry->mResponse, aBuffer, aLength);
+        entry->mResponseLength = aLength;
+    }
+    else
+    {
+        entry->mResponseLength = kTooLarge;
+    }
+
+exit:
+    return;
+}
+
+} // namespace Coap
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,161 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of the detection of retransmitted CoAP requests.
+ */
+
+#ifndef COAP_DEDUP_HPP_
+#define COAP_DEDUP_HPP_
+
+#include <stdint.h>
+
+#include "common/capacity.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Coap {
+
+/**
+ * @addtogroup border-router-coap
+ *
+ * @{
+ */
+
+/**
+ * This class remembers the CoAP requests received from each peer and the responses sent to them, as RFC 7252
+ * section 4.5 describes.
+ *
+ * Requests are identified by the address, port and message id of their peer. A retransmission received within the
+ * lifetime of the first request is not handled again, the acknowledgment or piggybacked response sent to the first
+ * one is sent again instead, or nothing if it was not acknowledged, e.g. a non-confirmable request whose response
+ * comes separately.
+ *
+ * Requests are kept in a fixed table, the oldest one is forgotten when it is full.
+ *
+ */
+class DuplicateCache
+{
+public:
+    enum
+    {
+        kDefaultLifetime = 247000, ///< Default lifetime of requests in milliseconds, EXCHANGE_LIFETIME.
+        kMaxResponseSize = 256,    ///< Max bytes of a response kept, requests with longer ones are handled again.
+    };
+
+    /**
+     * The constructor to initialize an empty cache.
+     *
+     */
+    DuplicateCache(void);
+
+    /**
+     * This method sets the time requests are remembered.
+     *
+     * @param[in]   aLifetime       The lifetime in milliseconds, 0 to disable the detection.
+     *
+     */
+    void SetLifetime(uint32_t aLifetime);
+
+    /**
+     * This method checks whether a received message is the retransmission of a request, or else remembers it.
+     *
+     * @param[in]   aBuffer         A pointer to the encoded message.
+     * @param[in]   aLength         Number of bytes of @p aBuffer.
+     * @param[in]   aIp6            A pointer to the source Ipv6 address of the message.
+     * @param[in]   aPort           Source UDP port of the message.
+     * @param[in]   aNow            The current monotonic time in milliseconds.
+     * @param[out]  aResponse       A pointer to the response to send again, NULL if none.
+     * @param[out]  aResponseLength Number of bytes of @p aResponse.
+     *
+     * @retval  true    The message is a retransmission, it must not be handled.
+     * @retval  false   The message is not a retransmission of a remembered request.
+     *
+     */
+    bool Check(const uint8_t * aBuffer,
+               uint16_t        aLength,
+               const uint8_t * aIp6,
+               uint16_t        aPort,
+               uint64_t        aNow,
+               const uint8_t *&aResponse,
+               uint16_t &      aResponseLength);
+
+    /**
+     * This method remembers a message sent, if it acknowledges a remembered request.
+     *
+     * @param[in]   aBuffer         A pointer to the encoded message.
+     * @param[in]   aLength         Number of bytes of @p aBuffer.
+     * @param[in]   aIp6            A pointer to the destination Ipv6 address of the message.
+     * @param[in]   aPort           Destination UDP port of the message.
+     *
+     */
+    void Record(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort);
+
+private:
+    enum
+    {
+        kMaxEntries  = OTBR_CAPACITY_COAP_DUPLICATES, ///< Number of requests remembered.
+        kHeaderSize  = 4,                             ///< Bytes of the fixed CoAP header.
+        kTooLarge    = 0xffff,                        ///< Length of a response not kept.
+        kCodeRequest = 0x20,                          ///< Codes of requests are below, the empty code excluded.
+    };
+
+    /**
+     * This struct represents a request remembered.
+     *
+     */
+    struct Entry
+    {
+        uint64_t mExpiration;                 ///< Monotonic milliseconds the request is forgotten at, 0 if unused.
+        uint8_t  mPeerAddress[16];            ///< The Ipv6 address of the peer.
+        uint16_t mPeerPort;                   ///< The UDP port of the peer.
+        uint16_t mMessageId;                  ///< The message id of the request.
+        uint16_t mResponseLength;             ///< Bytes of the response, 0 if none, kTooLarge if not kept.
+        uint8_t  mResponse[kMaxResponseSize]; ///< The acknowledgment or piggybacked response.
+    };
+
+    Entry *Find(const uint8_t *aIp6, uint16_t aPort, uint16_t aMessageId);
+
+    Entry    mEntries[kMaxEntries];
+    uint32_t mLifetime;
+};
+
+/**
+ * @}
+ */
+
+} // namespace Coap
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // COAP_DEDUP_HPP_
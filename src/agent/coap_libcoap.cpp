@@ -31,13 +31,21 @@
  *   The file implements the CoAP service.
  */
 
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_COAP
+
 #include "coap_libcoap.hpp"
 
+#include <assert.h>
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "common/code_utils.hpp"
 #include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/probes.hpp"
+#include "common/time.hpp"
+#include "common/timeline.hpp"
 #include "common/types.hpp"
 
 namespace ot {
@@ -46,6 +54,13 @@ namespace BorderRouter {
 
 namespace Coap {
 
+static Metrics::Gauge   sMessagesInUse("coap.messages");
+static Metrics::Counter sMessagePoolMisses("coap.message_pool_misses");
+static Metrics::Memory  sMessageMemory("memory.coap_messages");
+
+// A message keeps a PDU of the max size, a PDU taken by libcoap is replaced once the message is reused.
+static const size_t kMessageSize = sizeof(MessageLibcoap) + sizeof(coap_pdu_t) + COAP_MAX_PDU_SIZE;
+
 static void CoapAddressInit(coap_address_t &aAddress, const uint8_t *aIp6, uint16_t aPort)
 {
     coap_address_init(&aAddress);
@@ -60,8 +75,22 @@ exit:
 }
 
 MessageLibcoap::MessageLibcoap(Type aType, Code aCode, uint16_t aMessageId, const uint8_t *aToken, uint8_t aTokenLength)
+    : mPdu(NULL)
 {
-    mPdu          = coap_new_pdu();
+    Init(aType, aCode, aMessageId, aToken, aTokenLength);
+}
+
+void MessageLibcoap::Init(Type aType, Code aCode, uint16_t aMessageId, const uint8_t *aToken, uint8_t aTokenLength)
+{
+    if (mPdu == NULL)
+    {
+        mPdu = coap_new_pdu();
+    }
+    else
+    {
+        coap_pdu_clear(mPdu, mPdu->max_size);
+    }
+
     mPdu->hdr->id = aMessageId;
     SetType(aType);
     SetCode(aCode);
@@ -129,6 +158,46 @@ void MessageLibcoap::SetPath(const char *aPath)
     }
 }
 
+void MessageLibcoap::SetPathEncoded(const EncodedPath &aPath)
+{
+    uint8_t        length;
+    const uint8_t *options = aPath.GetOptions(length);
+
+    // The options are encoded as the first ones of a message, as coap_add_option() would append them.
+    if (length == 0 || mPdu->max_delta != 0 || mPdu->data != NULL || mPdu->length + length > mPdu->max_size)
+    {
+        SetPath(aPath.GetPath());
+        ExitNow();
+    }
+
+    memcpy(reinterpret_cast<uint8_t *>(mPdu->hdr) + mPdu->length, options, length);
+    mPdu->length    = static_cast<unsigned short>(mPdu->length + length);
+    mPdu->max_delta = COAP_OPTION_URI_PATH;
+
+exit:
+    return;
+}
+
+bool MessageLibcoap::GetUintOption(Option aOption, uint32_t &aValue) const
+{
+    coap_opt_iterator_t iterator;
+    coap_opt_t *        option = coap_check_option(mPdu, aOption, &iterator);
+
+    if (option != NULL)
+    {
+        aValue = coap_decode_var_bytes(COAP_OPT_VALUE(option), COAP_OPT_LENGTH(option));
+    }
+
+    return option != NULL;
+}
+
+void MessageLibcoap::AddUintOption(Option aOption, uint32_t aValue)
+{
+    unsigned char value[sizeof(aValue)];
+
+    coap_add_option(mPdu, aOption, coap_encode_var_bytes(value, aValue), value);
+}
+
 void MessageLibcoap::SetPayload(const uint8_t *aPayload, uint16_t aLength)
 {
     coap_add_data(mPdu, aLength, aPayload);
@@ -146,14 +215,45 @@ const uint8_t *MessageLibcoap::GetPayload(uint16_t &aLength) const
 
 Message *AgentLibcoap::NewMessage(Type aType, Code aCode, const uint8_t *aToken, uint8_t aTokenLength)
 {
-    uint16_t messageId = coap_new_message_id(&mCoap);
+    uint16_t        messageId = coap_new_message_id(&mCoap);
+    MessageLibcoap *message;
+
+    if (mFreeMessages.empty())
+    {
+        mMessagePoolMisses++;
+        sMessagePoolMisses.Add();
+        message = new MessageLibcoap(aType, aCode, messageId, aToken, aTokenLength);
+        sMessageMemory.Allocate(kMessageSize);
+    }
+    else
+    {
+        message = mFreeMessages.back();
+        mFreeMessages.pop_back();
+        message->Init(aType, aCode, messageId, aToken, aTokenLength);
+    }
 
-    return new MessageLibcoap(aType, aCode, messageId, aToken, aTokenLength);
+    sMessagesInUse.Add();
+
+    return message;
 }
 
 void AgentLibcoap::FreeMessage(Message *aMessage)
 {
-    delete static_cast<Message *>(aMessage);
+    MessageLibcoap *message = static_cast<MessageLibcoap *>(aMessage);
+
+    sMessagesInUse.Subtract();
+
+    // The pdu is kept for the next message unless libcoap took it.
+    if (mFreeMessages.size() < kMessagePoolSize)
+    {
+        mFreeMessages.push_back(message);
+    }
+    else
+    {
+        message->Free();
+        delete message;
+        sMessageMemory.Free(kMessageSize);
+    }
 }
 
 otbrError AgentLibcoap::Send(Message &       aMessage,
@@ -174,37 +274,68 @@ otbrError AgentLibcoap::Send(Message &       aMessage,
 
     if (pdu->hdr->type == COAP_MESSAGE_CON)
     {
-        MessageMeta meta = {aHandler, aContext};
+        Transaction *transaction = NewTransaction(*pdu, remote);
+
+        VerifyOrExit(transaction != NULL, errno = ENOBUFS);
 
-        // There is no official way to provide handler for each message,
-        // we have to embed the handler into its payload.
-        VerifyOrExit(pdu->length + sizeof(meta) < pdu->max_size, errno = EMSGSIZE);
+        transaction->mHandler = aHandler;
+        transaction->mContext = aContext;
 
         tid = coap_send_confirmed(&mCoap, mCoap.endpoint, &remote, pdu);
-        memcpy(pdu->hdr + pdu->length, &meta, sizeof(meta));
+
+        if (tid == COAP_INVALID_TID)
+        {
+            FreeTransaction(*transaction);
+            ExitNow();
+        }
+
+        // libcoap owns the pdu until it is acknowledged or times out.
+        message.Detach();
+        ScheduleRetransmission();
     }
     else
     {
         tid = coap_send(&mCoap, mCoap.endpoint, &remote, pdu);
     }
 
-    if (tid == COAP_INVALID_TID || pdu->hdr->type != COAP_MESSAGE_CON)
-    {
-        message.Free();
-    }
-
     ret = OTBR_ERROR_NONE;
 
 exit:
     if (ret != OTBR_ERROR_NONE)
     {
-        otbrLog(OTBR_LOG_ERR, "CoAP no memory for callback!");
-        message.Free();
+        otbrLog(OTBR_LOG_ERR, "CoAP failed to send: %s", strerror(errno));
     }
 
     return ret;
 }
 
+otbrError AgentLibcoap::Forward(const Message &aMessage, const uint8_t *aIp6, uint16_t aPort)
+{
+    otbrError   ret  = OTBR_ERROR_ERRNO;
+    coap_pdu_t *pdu  = static_cast<const MessageLibcoap &>(aMessage).GetPdu();
+    uint8_t     type = pdu->hdr->type;
+    uint16_t    id   = pdu->hdr->id;
+
+    coap_address_t remote;
+
+    CoapAddressInit(remote, aIp6, aPort);
+
+    // Only the header is rewritten, the encoded options and payload are sent as they are.
+    pdu->hdr->type = COAP_MESSAGE_NON;
+    pdu->hdr->id   = coap_new_message_id(&mCoap);
+
+    VerifyOrExit(coap_send(&mCoap, mCoap.endpoint, &remote, pdu) != COAP_INVALID_TID);
+
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    // The received message may still be acknowledged by its own agent.
+    pdu->hdr->type = type;
+    pdu->hdr->id   = id;
+
+    return ret;
+}
+
 void AgentLibcoap::HandleRequest(coap_context_t *        aCoap,
                                  struct coap_resource_t *aResource,
                                  const coap_endpoint_t * aEndPoint,
@@ -228,10 +359,12 @@ void AgentLibcoap::HandleRequest(struct coap_resource_t *aResource,
                                  const uint8_t *         aAddress,
                                  uint16_t                aPort)
 {
-    VerifyOrExit(mResources.count(aResource), otbrLog(OTBR_LOG_WARNING, "CoAP received unexpected request!"));
+    const Resource *const *found = mResources.Find(aResource);
+
+    VerifyOrExit(found != NULL, otbrLog(OTBR_LOG_WARNING, "CoAP received unexpected request!"));
 
     {
-        const Resource &resource = *mResources[aResource];
+        const Resource &resource = **found;
         MessageLibcoap  req(aRequest);
         MessageLibcoap  res(aResponse);
 
@@ -240,7 +373,10 @@ void AgentLibcoap::HandleRequest(struct coap_resource_t *aResource,
         // Set code to kCoapEmpty to use separate response if no response set by handler.
         // Handler should later respond an Non-ACK response.
         res.SetCode(kCodeEmpty);
+        OTBR_PROBE3(coap_request, resource.mPath, static_cast<int>(req.GetType()), aPort);
+        Timeline::Begin(resource.mPath);
         resource.mHandler(resource, req, res, aAddress, aPort, resource.mContext);
+        Timeline::End(resource.mPath);
     }
 
 exit:
@@ -249,13 +385,45 @@ exit:
 
 void AgentLibcoap::Input(const void *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort)
 {
-    mPacket.length    = aLength;
-    mPacket.interface = mCoap.endpoint;
-    mPacket.dst       = mCoap.endpoint->addr;
-    // memset(mPacket.dst.addr.sin6.sin6_addr.s6_addr, 0, sizeof(mPacket.dst.addr.sin6.sin6_addr));
-    CoapAddressInit(mPacket.src, aIp6, aPort);
-    memcpy(mPacket.payload, aBuffer, aLength);
-    coap_handle_message(&mCoap, &mPacket);
+    unsigned char *message        = static_cast<unsigned char *>(const_cast<void *>(aBuffer));
+    coap_queue_t * node           = NULL;
+    const uint8_t *response       = NULL;
+    uint16_t       responseLength = 0;
+
+    // Same as coap_handle_message(), but the PDU is parsed from the caller's buffer instead of a coap_packet_t.
+    VerifyOrExit(aLength >= sizeof(coap_hdr_t) && (message[0] >> 6) == COAP_DEFAULT_VERSION,
+                 otbrLog(OTBR_LOG_WARNING, "Discarded invalid CoAP message."));
+
+    // libcoap handles every request it dispatches, retransmissions are answered before.
+    if (mDuplicates.Check(message, aLength, aIp6, aPort, GetMonotonicNow(), response, responseLength))
+    {
+        if (response != NULL)
+        {
+            mNetworkSender(response, responseLength, aIp6, aPort, mContext);
+        }
+
+        ExitNow();
+    }
+    VerifyOrExit((node = coap_new_node()) != NULL);
+    VerifyOrExit((node->pdu = coap_pdu_init(0, 0, 0, aLength)) != NULL);
+    VerifyOrExit(coap_pdu_parse(message, aLength, node->pdu), otbrLog(OTBR_LOG_WARNING, "Discarded malformed PDU."));
+
+    coap_ticks(&node->t);
+    node->local_if         = *mCoap.endpoint;
+    node->local_if.flags   = 0;
+    node->local_if.ifindex = 0;
+    CoapAddressInit(node->remote, aIp6, aPort);
+    coap_transaction_id(&node->remote, node->pdu, &node->id);
+
+    // The node is freed by coap_dispatch().
+    coap_dispatch(&mCoap, node);
+    node = NULL;
+
+exit:
+    if (node != NULL)
+    {
+        coap_delete_node(node);
+    }
 }
 
 void AgentLibcoap::HandleResponse(coap_context_t *       aCoap,
@@ -265,35 +433,216 @@ void AgentLibcoap::HandleResponse(coap_context_t *       aCoap,
                                   coap_pdu_t *           aReceived,
                                   const coap_tid_t       aId)
 {
-    MessageMeta meta;
+    AgentLibcoap *agent = reinterpret_cast<AgentLibcoap *>(CONTAINING_RECORD(aCoap, AgentLibcoap, mCoap));
+
+    // The sent pdu is not provided for separate responses, so the request is looked up by the received token.
+    agent->HandleResponse(*aRemote, aReceived);
+
+    (void)aLocalInterface;
+    (void)aSent;
+    (void)aId;
+}
+
+void AgentLibcoap::HandleResponse(const coap_address_t &aRemote, coap_pdu_t *aReceived)
+{
+    Transaction *   transaction = FindTransaction(*aReceived, aRemote);
+    ResponseHandler handler;
+    void *          context;
+
+    VerifyOrExit(transaction != NULL, otbrLog(OTBR_LOG_ERR, "request not found!"));
 
-    VerifyOrExit(aSent != NULL, otbrLog(OTBR_LOG_ERR, "request not found!"));
+    handler = transaction->mHandler;
+    context = transaction->mContext;
 
-    memcpy(&meta, aSent->hdr + aSent->length, sizeof(meta));
+    // The transaction is freed first so that the handler is able to send new requests.
+    FreeTransaction(*transaction);
 
-    if (meta.mHandler)
+    if (handler)
     {
         MessageLibcoap message(aReceived);
-        meta.mHandler(message, meta.mContext);
+        handler(message, context);
     }
 
 exit:
-    (void)aCoap;
-    (void)aLocalInterface;
-    (void)aRemote;
-    (void)aId;
-
     return;
 }
 
+static void GetUriPath(coap_pdu_t *aPdu, char *aPath, size_t aSize)
+{
+    coap_opt_iterator_t iterator;
+    coap_opt_filter_t   filter;
+    coap_opt_t *        option;
+    size_t              length = 0;
+
+    coap_option_filter_clear(filter);
+    coap_option_setb(filter, COAP_OPTION_URI_PATH);
+    coap_option_iterator_init(aPdu, &iterator, filter);
+
+    while ((option = coap_option_next(&iterator)) != NULL)
+    {
+        size_t size = COAP_OPT_LENGTH(option);
+
+        VerifyOrExit(length + (length ? 1 : 0) + size < aSize);
+
+        if (length)
+        {
+            aPath[length++] = '/';
+        }
+
+        memcpy(aPath + length, COAP_OPT_VALUE(option), size);
+        length += size;
+    }
+
+exit:
+    aPath[length] = '\0';
+}
+
+AgentLibcoap::Transaction::Transaction(AgentLibcoap &aAgent)
+    : mAgent(aAgent)
+    , mNext(NULL)
+    , mTimer(AgentLibcoap::HandleTransactionTimer, this)
+    , mHandler(NULL)
+    , mContext(NULL)
+    , mPeerPort(0)
+    , mTokenLength(0)
+{
+    memset(mPeerAddress, 0, sizeof(mPeerAddress));
+    mPath[0] = '\0';
+}
+
+size_t AgentLibcoap::HashTransaction(const uint8_t *aToken, uint8_t aTokenLength, const coap_address_t &aRemote)
+{
+    // FNV-1a
+    const uint8_t *address = aRemote.addr.sin6.sin6_addr.s6_addr;
+    uint32_t       hash    = 2166136261u;
+
+    for (uint8_t i = 0; i < aTokenLength; ++i)
+    {
+        hash = (hash ^ aToken[i]) * 16777619u;
+    }
+
+    for (size_t i = 0; i < sizeof(aRemote.addr.sin6.sin6_addr); ++i)
+    {
+        hash = (hash ^ address[i]) * 16777619u;
+    }
+
+    hash = (hash ^ aRemote.addr.sin6.sin6_port) * 16777619u;
+
+    return hash & (kTransactionBuckets - 1);
+}
+
+AgentLibcoap::Transaction *AgentLibcoap::NewTransaction(const coap_pdu_t &aPdu, const coap_address_t &aRemote)
+{
+    Transaction *transaction = mFreeTransactions;
+    size_t       bucket;
+
+    if (transaction != NULL)
+    {
+        mFreeTransactions = transaction->mNext;
+    }
+    else
+    {
+        VerifyOrExit(mTransactionCount < mMaxTransactions);
+        transaction = new Transaction(*this);
+        mTransactionCount++;
+    }
+
+    bucket             = HashTransaction(aPdu.hdr->token, aPdu.hdr->token_length, aRemote);
+    transaction->mNext = mBuckets[bucket];
+    mBuckets[bucket]   = transaction;
+
+    memcpy(transaction->mPeerAddress, aRemote.addr.sin6.sin6_addr.s6_addr, sizeof(transaction->mPeerAddress));
+    transaction->mPeerPort    = aRemote.addr.sin6.sin6_port;
+    transaction->mTokenLength = aPdu.hdr->token_length;
+    memcpy(transaction->mToken, aPdu.hdr->token, aPdu.hdr->token_length);
+    GetUriPath(const_cast<coap_pdu_t *>(&aPdu), transaction->mPath, sizeof(transaction->mPath));
+
+    // libcoap gives up retransmitting silently, so the transaction expires on its own.
+    if (mTimerWheel != NULL)
+    {
+        mTimerWheel->Start(transaction->mTimer, kExchangeLifetime);
+    }
+
+exit:
+    return transaction;
+}
+
+AgentLibcoap::Transaction *AgentLibcoap::FindTransaction(const coap_pdu_t &aPdu, const coap_address_t &aRemote)
+{
+    Transaction *transaction = mBuckets[HashTransaction(aPdu.hdr->token, aPdu.hdr->token_length, aRemote)];
+
+    for (; transaction != NULL; transaction = transaction->mNext)
+    {
+        if (transaction->mTokenLength == aPdu.hdr->token_length &&
+            !memcmp(transaction->mToken, aPdu.hdr->token, aPdu.hdr->token_length) &&
+            transaction->mPeerPort == aRemote.addr.sin6.sin6_port &&
+            !memcmp(transaction->mPeerAddress, aRemote.addr.sin6.sin6_addr.s6_addr, sizeof(transaction->mPeerAddress)))
+        {
+            break;
+        }
+    }
+
+    return transaction;
+}
+
+void AgentLibcoap::FreeTransaction(Transaction &aTransaction)
+{
+    coap_address_t remote;
+    Transaction ** link;
+
+    CoapAddressInit(remote, aTransaction.mPeerAddress, ntohs(aTransaction.mPeerPort));
+    link = &mBuckets[HashTransaction(aTransaction.mToken, aTransaction.mTokenLength, remote)];
+
+    if (mTimerWheel != NULL)
+    {
+        mTimerWheel->Stop(aTransaction.mTimer);
+    }
+
+    while (*link != &aTransaction)
+    {
+        assert(*link != NULL);
+        link = &(*link)->mNext;
+    }
+
+    *link              = aTransaction.mNext;
+    aTransaction.mNext = mFreeTransactions;
+    mFreeTransactions  = &aTransaction;
+}
+
+void AgentLibcoap::HandleTransactionTimer(void *aContext)
+{
+    Transaction &transaction = *static_cast<Transaction *>(aContext);
+
+    otbrLog(OTBR_LOG_WARNING, "CoAP request to %s timed out!", transaction.mPath);
+    transaction.mAgent.FreeTransaction(transaction);
+}
+
+unsigned int AgentLibcoap::GetTransactionCount(const char *aPath) const
+{
+    unsigned int count = 0;
+
+    for (size_t i = 0; i < kTransactionBuckets; ++i)
+    {
+        for (const Transaction *transaction = mBuckets[i]; transaction != NULL; transaction = transaction->mNext)
+        {
+            if (aPath == NULL || !strcmp(transaction->mPath, aPath))
+            {
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
 otbrError AgentLibcoap::AddResource(const Resource &aResource)
 {
     otbrError        ret      = OTBR_ERROR_ERRNO;
     coap_resource_t *resource = NULL;
 
-    for (Resources::iterator it = mResources.begin(); it != mResources.end(); ++it)
+    for (Resources::Iterator it = mResources.Begin(); it != mResources.End(); ++it)
     {
-        if (it->second == &aResource)
+        if (it->mValue == &aResource)
         {
             otbrLog(OTBR_LOG_ERR, "CoAP resource already added!");
             ExitNow(errno = EEXIST);
@@ -304,8 +653,8 @@ otbrError AgentLibcoap::AddResource(const Resource &aResource)
     resource = coap_resource_init(reinterpret_cast<const unsigned char *>(aResource.mPath), strlen(aResource.mPath), 0);
     coap_register_handler(resource, COAP_REQUEST_POST, AgentLibcoap::HandleRequest);
     coap_add_resource(&mCoap, resource);
-    mResources[resource] = &aResource;
-    ret                  = OTBR_ERROR_NONE;
+    VerifyOrExit(mResources.Set(resource, &aResource), coap_delete_resource(&mCoap, resource->key), errno = ENOMEM);
+    ret = OTBR_ERROR_NONE;
 
 exit:
     return ret;
@@ -315,12 +664,14 @@ otbrError AgentLibcoap::RemoveResource(const Resource &aResource)
 {
     otbrError ret = OTBR_ERROR_ERRNO;
 
-    for (Resources::iterator it = mResources.begin(); it != mResources.end(); ++it)
+    for (Resources::Iterator it = mResources.Begin(); it != mResources.End(); ++it)
     {
-        if (it->second == &aResource)
+        if (it->mValue == &aResource)
         {
-            coap_delete_resource(&mCoap, it->first->key);
-            mResources.erase(it);
+            coap_resource_t *resource = it->mKey;
+
+            mResources.Erase(resource);
+            coap_delete_resource(&mCoap, resource->key);
             ret = OTBR_ERROR_NONE;
             break;
         }
@@ -334,7 +685,9 @@ otbrError AgentLibcoap::RemoveResource(const Resource &aResource)
     return ret;
 }
 
-AgentLibcoap::AgentLibcoap(NetworkSender aNetworkSender, void *aContext)
+AgentLibcoap::AgentLibcoap(NetworkSender aNetworkSender, void *aContext, TimerWheel *aTimerWheel)
+    : mTimerWheel(aTimerWheel)
+    , mRetransmissionTimer(HandleRetransmissionTimer, this)
 {
     mContext       = aContext;
     mNetworkSender = aNetworkSender;
@@ -352,6 +705,50 @@ AgentLibcoap::AgentLibcoap(NetworkSender aNetworkSender, void *aContext)
     mCoap.network_send         = AgentLibcoap::NetworkSend;
 
     coap_register_response_handler(&mCoap, AgentLibcoap::HandleResponse);
+
+    mMessagePoolMisses = 0;
+    mFreeMessages.reserve(kMessagePoolSize);
+
+    memset(mBuckets, 0, sizeof(mBuckets));
+    mFreeTransactions = NULL;
+    mTransactionCount = 0;
+    mMaxTransactions  = kDefaultMaxTransactions;
+
+    for (size_t i = 0; i < kMessagePoolSize; ++i)
+    {
+        mFreeMessages.push_back(new MessageLibcoap(coap_new_pdu()));
+        sMessageMemory.Allocate(kMessageSize);
+    }
+}
+
+AgentLibcoap::~AgentLibcoap(void)
+{
+    // Requests still retransmitted by libcoap.
+    coap_delete_all(mCoap.sendqueue);
+    mCoap.sendqueue = NULL;
+
+    for (size_t i = 0; i < kTransactionBuckets; ++i)
+    {
+        while (mBuckets[i] != NULL)
+        {
+            FreeTransaction(*mBuckets[i]);
+        }
+    }
+
+    while (mFreeTransactions != NULL)
+    {
+        Transaction *transaction = mFreeTransactions;
+
+        mFreeTransactions = transaction->mNext;
+        delete transaction;
+    }
+
+    for (size_t i = 0; i < mFreeMessages.size(); ++i)
+    {
+        mFreeMessages[i]->Free();
+        delete mFreeMessages[i];
+        sMessageMemory.Free(kMessageSize);
+    }
 }
 
 ssize_t AgentLibcoap::NetworkSend(coap_context_t *       aCoap,
@@ -362,22 +759,73 @@ ssize_t AgentLibcoap::NetworkSend(coap_context_t *       aCoap,
 {
     (void)aLocalInterface;
 
-    AgentLibcoap *agent = static_cast<AgentLibcoap *>(CONTAINING_RECORD(aCoap, AgentLibcoap, mCoap));
+    AgentLibcoap * agent = static_cast<AgentLibcoap *>(CONTAINING_RECORD(aCoap, AgentLibcoap, mCoap));
+    const uint8_t *ip6   = reinterpret_cast<const uint8_t *>(&aDestination->addr.sin6.sin6_addr);
+    uint16_t       port  = ntohs(aDestination->addr.sin6.sin6_port);
+
+    agent->mDuplicates.Record(aBuffer, static_cast<uint16_t>(aLength), ip6, port);
 
-    return agent->mNetworkSender(aBuffer, static_cast<uint16_t>(aLength),
-                                 reinterpret_cast<const uint8_t *>(&aDestination->addr.sin6.sin6_addr),
-                                 ntohs(aDestination->addr.sin6.sin6_port), agent->mContext);
+    return agent->mNetworkSender(aBuffer, static_cast<uint16_t>(aLength), ip6, port, agent->mContext);
+}
+
+void AgentLibcoap::HandleRetransmissionTimer(void *aContext)
+{
+    static_cast<AgentLibcoap *>(aContext)->ProcessRetransmissions();
 }
 
-Agent *Agent::Create(NetworkSender aNetworkSender, void *aContext)
+void AgentLibcoap::ProcessRetransmissions(void)
 {
-    return new AgentLibcoap(aNetworkSender, aContext);
+    coap_queue_t *next;
+    coap_tick_t   now;
+
+    coap_ticks(&now);
+
+    // Times of the send queue are relative to its base time.
+    while ((next = coap_peek_next(&mCoap)) != NULL && next->t <= now - mCoap.sendqueue_basetime)
+    {
+        coap_retransmit(&mCoap, coap_pop_next(&mCoap));
+    }
+
+    ScheduleRetransmission();
+}
+
+void AgentLibcoap::ScheduleRetransmission(void)
+{
+    coap_queue_t *next = coap_peek_next(&mCoap);
+    coap_tick_t   now;
+    coap_tick_t   fireTime;
+
+    VerifyOrExit(mTimerWheel != NULL);
+
+    if (next == NULL)
+    {
+        mTimerWheel->Stop(mRetransmissionTimer);
+        ExitNow();
+    }
+
+    coap_ticks(&now);
+    fireTime = mCoap.sendqueue_basetime + next->t;
+    mTimerWheel->Start(mRetransmissionTimer,
+                       fireTime > now ? static_cast<uint64_t>(fireTime - now) * 1000 / COAP_TICKS_PER_SECOND : 0);
+
+exit:
+    return;
+}
+
+#if !OTBR_ENABLE_NATIVE_COAP
+Agent *Agent::Create(NetworkSender aNetworkSender, void *aContext, TimerWheel *aTimerWheel, Agent *aShared)
+{
+    // libcoap keeps its own PDUs and transactions in each context.
+    (void)aShared;
+
+    return new AgentLibcoap(aNetworkSender, aContext, aTimerWheel);
 }
 
 void Agent::Destroy(Agent *aAgent)
 {
     delete static_cast<AgentLibcoap *>(aAgent);
 }
+#endif // !OTBR_ENABLE_NATIVE_COAP
 
 } // namespace Coap
 
@@ -29,10 +29,13 @@
 #ifndef COAP_LIBCOAP_HPP_
 #define COAP_LIBCOAP_HPP_
 
-#include <map>
+#include <vector>
 
 #include "coap.hpp"
+#include "coap_dedup.hpp"
 #include "libcoap.h"
+#include "common/capacity.hpp"
+#include "common/flat_map.hpp"
 
 namespace ot {
 
@@ -68,6 +71,18 @@ public:
      */
     MessageLibcoap(Type aType, Code aCode, uint16_t aMessageId, const uint8_t *aToken, uint8_t aTokenLength);
 
+    /**
+     * This method initializes the message as a new one, reusing its libcoap pdu if it still has one.
+     *
+     * @param[in]   aType           The CoAP type.
+     * @param[in]   aCode           The CoAP code.
+     * @param[in]   aMessageId      The CoAP message id.
+     * @param[in]   aToken          The CoAP token.
+     * @param[in]   aTokenLength    Number of bytes in @p aToken.
+     *
+     */
+    void Init(Type aType, Code aCode, uint16_t aMessageId, const uint8_t *aToken, uint8_t aTokenLength);
+
     /**
      * The constructor to wrap an libcoap pdu.
      *
@@ -140,6 +155,35 @@ public:
      */
     void SetPath(const char *aPath);
 
+    /**
+     * This method sets the CoAP Uri Path of this message from its encoded options.
+     *
+     * @param[in]   aPath           A reference to the encoded Uri Path.
+     *
+     */
+    void SetPathEncoded(const EncodedPath &aPath);
+
+    /**
+     * This method returns the value of an unsigned integer option of this message.
+     *
+     * @param[in]   aOption         The option number.
+     * @param[out]  aValue          The option value.
+     *
+     * @retval  true    The option is present.
+     * @retval  false   The option is absent.
+     *
+     */
+    bool GetUintOption(Option aOption, uint32_t &aValue) const;
+
+    /**
+     * This method appends an unsigned integer option to this message.
+     *
+     * @param[in]   aOption         The option number.
+     * @param[in]   aValue          The option value.
+     *
+     */
+    void AddUintOption(Option aOption, uint32_t aValue);
+
     /**
      * This method returns the payload of this message.
      *
@@ -164,7 +208,7 @@ public:
      *
      * @returns A pointer to the underlying libcoap PDU.
      */
-    coap_pdu_t *GetPdu(void) { return mPdu; }
+    coap_pdu_t *GetPdu(void) const { return mPdu; }
 
     /**
      * This method frees the wrapped libcoap pdu.
@@ -174,6 +218,12 @@ public:
      */
     void Free(void);
 
+    /**
+     * This method detaches the wrapped libcoap pdu once libcoap takes its ownership.
+     *
+     */
+    void Detach(void) { mPdu = NULL; }
+
 private:
     enum
     {
@@ -194,9 +244,13 @@ public:
      *
      * @param[in]   aNetworkSender      A pointer to the function that actually sends the data.
      * @param[in]   aContext            A pointer to application-specific context.
+     * @param[in]   aTimerWheel         A pointer to the timer wheel to schedule retransmissions with, NULL to
+     *                                  disable retransmissions.
      *
      */
-    AgentLibcoap(NetworkSender aNetworkSender, void *aContext);
+    AgentLibcoap(NetworkSender aNetworkSender, void *aContext, TimerWheel *aTimerWheel);
+
+    ~AgentLibcoap(void);
 
     /**
      * This method processes this CoAP message in @p aBuffer, which can be a request or response.
@@ -220,11 +274,50 @@ public:
      *
      * @retval      OTBR_ERROR_NONE     Successfully sent the message.
      * @retval      OTBR_ERROR_ERRNO    Failed to send the message.
-     *                                  - EMSGSIZE No space for response handler.
+     *                                  - ENOBUFS Too many confirmable messages in flight.
      *
      */
     otbrError Send(Message &aMessage, const uint8_t *aIp6, uint16_t aPort, ResponseHandler aHandler, void *aContext);
 
+    /**
+     * This method forwards a received CoAP message as a non-confirmable one.
+     *
+     * @param[in]   aMessage    A reference to the message to forward.
+     * @param[in]   aIp6        A pointer to the destination Ipv6 address.
+     * @param[in]   aPort       Destination UDP port.
+     *
+     * @retval      OTBR_ERROR_NONE     Successfully forwarded the message.
+     * @retval      OTBR_ERROR_ERRNO    Failed to forward the message.
+     *
+     */
+    otbrError Forward(const Message &aMessage, const uint8_t *aIp6, uint16_t aPort);
+
+    /**
+     * This method sends a message with a payload, which libcoap always copies into its PDU.
+     *
+     * @param[in]   aMessage    A reference to the message to send, without a payload.
+     * @param[in]   aPayload    A pointer to the payload.
+     * @param[in]   aLength     Number of bytes of @p aPayload.
+     * @param[in]   aIp6        A pointer to the destination Ipv6 address.
+     * @param[in]   aPort       Destination UDP port.
+     *
+     * @retval      OTBR_ERROR_NONE     Successfully sent the message.
+     * @retval      OTBR_ERROR_ERRNO    Failed to send the message.
+     *
+     */
+    otbrError SendPayload(Message &      aMessage,
+                          const uint8_t *aPayload,
+                          uint16_t       aLength,
+                          const uint8_t *aIp6,
+                          uint16_t       aPort)
+    {
+        aMessage.SetPayload(aPayload, aLength);
+        return Send(aMessage, aIp6, aPort, NULL, NULL);
+    }
+
+    // libcoap encodes its PDUs contiguously, they are never sent gathered.
+    void SetVectorSender(VectorSender) {}
+
     /**
      * This method creates a CoAP message with the given arguments.
      *
@@ -246,6 +339,40 @@ public:
      */
     virtual void FreeMessage(Message *aMessage);
 
+    /**
+     * This method returns the number of messages allocated on the heap because the message pool was exhausted.
+     *
+     * @returns Number of messages created outside the pool.
+     *
+     */
+    uint32_t GetMessagePoolMisses(void) const { return mMessagePoolMisses; }
+
+    /**
+     * This method sets the max number of confirmable messages in flight.
+     *
+     * @param[in]   aCount          The max number of confirmable messages in flight.
+     *
+     */
+    void SetMaxTransactions(unsigned int aCount) { mMaxTransactions = aCount; }
+
+    /**
+     * This method sets the time requests received are remembered, to detect their retransmissions.
+     *
+     * @param[in]   aLifetime       The lifetime in milliseconds, 0 to handle every request received.
+     *
+     */
+    void SetDuplicateLifetime(uint32_t aLifetime) { mDuplicates.SetLifetime(aLifetime); }
+
+    /**
+     * This method returns the number of confirmable requests to @p aPath waiting for their responses.
+     *
+     * @param[in]   aPath           A pointer to to the null-terminated string of Uri Path.
+     *
+     * @returns Number of requests in flight to @p aPath.
+     *
+     */
+    unsigned int GetTransactionCount(const char *aPath) const;
+
     /**
      * This method registers a CoAP resource.
      *
@@ -269,14 +396,51 @@ public:
     otbrError RemoveResource(const Resource &aResource);
 
 private:
-    typedef std::map<struct coap_resource_t *, const Resource *> Resources;
+    enum
+    {
+        kMessagePoolSize        = OTBR_CAPACITY_COAP_MESSAGE_POOL, ///< Number of messages kept with pdus for reuse.
+        kDefaultMaxTransactions = OTBR_CAPACITY_COAP_TRANSACTIONS, ///< Default max number of messages in flight.
+    };
 
-    struct MessageMeta
+    enum
     {
-        ResponseHandler mHandler;
-        void *          mContext;
+        kTransactionBuckets = 16,     ///< Number of buckets indexing transactions, must be a power of 2.
+        kMaxPathLength      = 32,     ///< Max length of the Uri Path kept for a transaction.
+        kExchangeLifetime   = 247000, ///< EXCHANGE_LIFETIME in milliseconds.
     };
 
+    typedef FlatMap<struct coap_resource_t *, const Resource *> Resources;
+
+    /**
+     * This struct represents a confirmable request waiting for its response.
+     *
+     * libcoap retransmits the request until it is acknowledged, the transaction only keeps what is needed to
+     * dispatch the response, which may come separately.
+     *
+     */
+    struct Transaction
+    {
+        explicit Transaction(AgentLibcoap &aAgent);
+
+        AgentLibcoap &  mAgent;                ///< The agent owning this transaction.
+        Transaction *   mNext;                 ///< The next transaction in the same bucket or the free list.
+        Timer           mTimer;                ///< The expiration timer.
+        ResponseHandler mHandler;              ///< The function to be called when the response is received.
+        void *          mContext;              ///< A pointer to application-specific context of @p mHandler.
+        uint8_t         mPeerAddress[16];      ///< The Ipv6 address of the peer.
+        uint16_t        mPeerPort;             ///< The UDP port of the peer.
+        uint8_t         mToken[8];             ///< The token of the request.
+        uint8_t         mTokenLength;          ///< Number of bytes in @p mToken.
+        char            mPath[kMaxPathLength]; ///< The Uri Path of the request.
+    };
+
+    Transaction * NewTransaction(const coap_pdu_t &aPdu, const coap_address_t &aRemote);
+    Transaction * FindTransaction(const coap_pdu_t &aPdu, const coap_address_t &aRemote);
+    void          FreeTransaction(Transaction &aTransaction);
+    static size_t HashTransaction(const uint8_t *aToken, uint8_t aTokenLength, const coap_address_t &aRemote);
+    static void   HandleTransactionTimer(void *aContext);
+    void          HandleResponse(const coap_address_t &aRemote, coap_pdu_t *aReceived);
+
     static void HandleRequest(coap_context_t *        aCoap,
                               struct coap_resource_t *aResource,
                               const coap_endpoint_t * aEndPoint,
@@ -304,11 +468,26 @@ private:
                                unsigned char *        aBuffer,
                                size_t                 aLength);
 
+    static void HandleRetransmissionTimer(void *aContext);
+    void        ProcessRetransmissions(void);
+    void        ScheduleRetransmission(void);
+
     Resources      mResources;
     NetworkSender  mNetworkSender;
     void *         mContext;
     coap_context_t mCoap;
-    coap_packet_t  mPacket;
+    TimerWheel *   mTimerWheel;
+    Timer          mRetransmissionTimer;
+
+    std::vector<MessageLibcoap *> mFreeMessages;      ///< Messages ready for reuse, most with their pdus.
+    uint32_t                      mMessagePoolMisses; ///< Number of messages created outside the pool.
+
+    Transaction *mBuckets[kTransactionBuckets]; ///< Transactions in flight by peer and token.
+    Transaction *mFreeTransactions;             ///< Transactions ready for reuse.
+    unsigned int mTransactionCount;             ///< Number of transactions allocated.
+    unsigned int mMaxTransactions;              ///< Max number of transactions.
+
+    DuplicateCache mDuplicates; ///< Requests received and their acknowledgments.
 };
 
 /**
@@ -0,0 +1,1201 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   The file implements the native CoAP service.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_COAP
+
+#include "coap_native.hpp"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/probes.hpp"
+#include "common/timeline.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Coap {
+
+static Metrics::Gauge   sMessagesInUse("coap.messages");
+static Metrics::Counter sMessagePoolMisses("coap.message_pool_misses");
+static Metrics::Memory  sMessageMemory("memory.coap_messages");
+static Metrics::Memory  sCoreMemory("memory.coap_cores");
+
+static Metrics::Counter   sRetransmissions("coap.retransmissions");
+static Metrics::Counter   sNstartLimited("coap.nstart_limited");
+static Metrics::Histogram sStrongRoundTrip("coap.rtt_ms");
+static Metrics::Histogram sWeakRoundTrip("coap.weak_rtt_ms");
+
+MessageNative::MessageNative(void)
+{
+    Init(kTypeConfirmable, kCodeEmpty, 0, NULL, 0);
+}
+
+void MessageNative::Init(Type aType, Code aCode, uint16_t aMessageId, const uint8_t *aToken, uint8_t aTokenLength)
+{
+    mBuffer     = mStorage;
+    mBuffer[0]  = kVersion1;
+    mLength     = kHeaderSize;
+    mOptionsEnd = kHeaderSize;
+    mLastOption = 0;
+
+    SetType(aType);
+    SetCode(aCode);
+    SetMessageId(aMessageId);
+    SetToken(aToken, aTokenLength);
+}
+
+void MessageNative::Copy(const MessageNative &aMessage)
+{
+    memcpy(mStorage, aMessage.mBuffer, aMessage.mLength);
+    mBuffer     = mStorage;
+    mLength     = aMessage.mLength;
+    mOptionsEnd = aMessage.mOptionsEnd;
+    mLastOption = aMessage.mLastOption;
+}
+
+otbrError MessageNative::Parse(const uint8_t *aBuffer, uint16_t aLength)
+{
+    otbrError      error       = OTBR_ERROR_ERRNO;
+    const uint8_t *end         = aBuffer + aLength;
+    const uint8_t *cursor      = NULL;
+    uint16_t       number      = 0;
+    uint8_t        tokenLength = 0;
+
+    VerifyOrExit(aLength >= kHeaderSize && (aBuffer[0] & 0xc0) == kVersion1, errno = EBADMSG);
+
+    tokenLength = aBuffer[0] & 0x0f;
+    VerifyOrExit(tokenLength <= kMaxTokenLength && aLength >= kHeaderSize + tokenLength, errno = EBADMSG);
+
+    cursor = aBuffer + kHeaderSize + tokenLength;
+
+    while (cursor < end && *cursor != kPayloadMarker)
+    {
+        const uint8_t *value;
+        uint16_t       length;
+
+        VerifyOrExit(ReadOption(cursor, end, number, value, length), errno = EBADMSG);
+    }
+
+    // The payload marker must not be followed by an empty payload.
+    VerifyOrExit(cursor == end || cursor + 1 < end, errno = EBADMSG);
+
+    mBuffer     = const_cast<uint8_t *>(aBuffer);
+    mLength     = aLength;
+    mOptionsEnd = static_cast<uint16_t>(cursor - aBuffer);
+    mLastOption = number;
+    error       = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+void MessageNative::SetToken(const uint8_t *aToken, uint8_t aLength)
+{
+    uint8_t tokenLength = mBuffer[0] & 0x0f;
+    int     shift       = aLength - tokenLength;
+
+    assert(mBuffer == mStorage);
+    VerifyOrExit(aLength <= kMaxTokenLength && mLength + shift <= kMaxMessageSize);
+
+    // Options and payload, if any, follow the token.
+    memmove(mBuffer + kHeaderSize + aLength, mBuffer + kHeaderSize + tokenLength,
+            mLength - kHeaderSize - tokenLength);
+
+    if (aLength)
+    {
+        memcpy(mBuffer + kHeaderSize, aToken, aLength);
+    }
+
+    mBuffer[0]  = static_cast<uint8_t>((mBuffer[0] & 0xf0) | aLength);
+    mLength     = static_cast<uint16_t>(mLength + shift);
+    mOptionsEnd = static_cast<uint16_t>(mOptionsEnd + shift);
+
+exit:
+    return;
+}
+
+void MessageNative::SetPath(const char *aPath)
+{
+    while (*aPath != '\0')
+    {
+        const char *end = strchr(aPath, '/');
+
+        if (end == NULL)
+        {
+            end = aPath + strlen(aPath);
+        }
+
+        if (end > aPath)
+        {
+            AppendOption(kOptionUriPath, reinterpret_cast<const uint8_t *>(aPath), static_cast<uint16_t>(end - aPath));
+        }
+
+        aPath = (*end == '/') ? end + 1 : end;
+    }
+}
+
+void MessageNative::SetPathEncoded(const EncodedPath &aPath)
+{
+    uint8_t        length;
+    const uint8_t *options = aPath.GetOptions(length);
+
+    assert(mBuffer == mStorage);
+
+    // The options are encoded as the first ones of a message.
+    if (length == 0 || mLastOption != 0 || mOptionsEnd != mLength || mLength + length > kMaxMessageSize)
+    {
+        SetPath(aPath.GetPath());
+        ExitNow();
+    }
+
+    memcpy(mBuffer + mLength, options, length);
+    mLength     = static_cast<uint16_t>(mLength + length);
+    mOptionsEnd = mLength;
+    mLastOption = kOptionUriPath;
+
+exit:
+    return;
+}
+
+bool MessageNative::MatchPath(const char *aPath) const
+{
+    uint8_t        tokenLength = mBuffer[0] & 0x0f;
+    const uint8_t *cursor      = mBuffer + kHeaderSize + tokenLength;
+    const uint8_t *end         = mBuffer + mOptionsEnd;
+    uint16_t       number      = 0;
+    bool           match       = false;
+
+    while (*aPath == '/')
+    {
+        ++aPath;
+    }
+
+    while (cursor < end)
+    {
+        const uint8_t *value;
+        uint16_t       length;
+
+        ReadOption(cursor, end, number, value, length);
+
+        if (number < kOptionUriPath)
+        {
+            continue;
+        }
+        else if (number > kOptionUriPath)
+        {
+            break;
+        }
+
+        VerifyOrExit(strcspn(aPath, "/") == length && memcmp(aPath, value, length) == 0);
+
+        aPath += length;
+
+        if (*aPath == '/')
+        {
+            ++aPath;
+        }
+    }
+
+    match = (*aPath == '\0');
+
+exit:
+    return match;
+}
+
+bool MessageNative::GetUintOption(Option aOption, uint32_t &aValue) const
+{
+    uint8_t        tokenLength = mBuffer[0] & 0x0f;
+    const uint8_t *cursor      = mBuffer + kHeaderSize + tokenLength;
+    const uint8_t *end         = mBuffer + mOptionsEnd;
+    uint16_t       number      = 0;
+    bool           found       = false;
+
+    while (cursor < end && number <= aOption)
+    {
+        const uint8_t *value  = NULL;
+        uint16_t       length = 0;
+
+        ReadOption(cursor, end, number, value, length);
+
+        if (number == aOption && length <= sizeof(aValue))
+        {
+            aValue = 0;
+
+            for (uint16_t i = 0; i < length; ++i)
+            {
+                aValue = (aValue << 8) | value[i];
+            }
+
+            found = true;
+            break;
+        }
+    }
+
+    return found;
+}
+
+void MessageNative::AddUintOption(Option aOption, uint32_t aValue)
+{
+    uint8_t  value[sizeof(aValue)];
+    uint16_t length = 0;
+
+    // Unsigned options are encoded in the fewest bytes, zero in none.
+    for (uint32_t remaining = aValue; remaining != 0; remaining >>= 8)
+    {
+        length++;
+    }
+
+    for (uint16_t i = 0; i < length; ++i)
+    {
+        value[i] = static_cast<uint8_t>(aValue >> (8 * (length - 1 - i)));
+    }
+
+    AppendOption(aOption, value, length);
+}
+
+void MessageNative::SetPayload(const uint8_t *aPayload, uint16_t aLength)
+{
+    assert(mBuffer == mStorage);
+    VerifyOrExit(aLength > 0 && mOptionsEnd + 1 + aLength <= kMaxMessageSize);
+
+    mBuffer[mOptionsEnd] = kPayloadMarker;
+    memcpy(mBuffer + mOptionsEnd + 1, aPayload, aLength);
+    mLength = static_cast<uint16_t>(mOptionsEnd + 1 + aLength);
+
+exit:
+    return;
+}
+
+int MessageNative::GetVector(const uint8_t *aPayload, uint16_t aLength, struct iovec *aVector) const
+{
+    static const uint8_t sMarker = kPayloadMarker;
+    int                  count   = 0;
+
+    VerifyOrExit(mOptionsEnd == mLength && mLength + 1 + aLength <= kMaxMessageSize);
+
+    aVector[count].iov_base  = const_cast<uint8_t *>(mBuffer);
+    aVector[count++].iov_len = mLength;
+
+    if (aLength > 0)
+    {
+        aVector[count].iov_base  = const_cast<uint8_t *>(&sMarker);
+        aVector[count++].iov_len = sizeof(sMarker);
+        aVector[count].iov_base  = const_cast<uint8_t *>(aPayload);
+        aVector[count++].iov_len = aLength;
+    }
+
+exit:
+    return count;
+}
+
+bool MessageNative::ReadOptionField(const uint8_t *&aCursor, const uint8_t *aEnd, uint16_t &aValue)
+{
+    bool ret = false;
+
+    if (aValue == kOptionExtended8)
+    {
+        VerifyOrExit(aEnd - aCursor >= 1);
+        aValue = static_cast<uint16_t>(kOptionExtended8 + aCursor[0]);
+        aCursor += 1;
+    }
+    else if (aValue == kOptionExtended16)
+    {
+        VerifyOrExit(aEnd - aCursor >= 2);
+        aValue = static_cast<uint16_t>(kOptionExtended16Base + ((aCursor[0] << 8) | aCursor[1]));
+        aCursor += 2;
+    }
+    else
+    {
+        VerifyOrExit(aValue != kOptionExtendedMax);
+    }
+
+    ret = true;
+
+exit:
+    return ret;
+}
+
+bool MessageNative::ReadOption(const uint8_t *&aCursor,
+                               const uint8_t * aEnd,
+                               uint16_t &      aNumber,
+                               const uint8_t *&aValue,
+                               uint16_t &      aLength)
+{
+    bool     ret   = false;
+    uint16_t delta = *aCursor >> 4;
+
+    aLength = *aCursor & 0x0f;
+    ++aCursor;
+
+    VerifyOrExit(ReadOptionField(aCursor, aEnd, delta) && ReadOptionField(aCursor, aEnd, aLength));
+    VerifyOrExit(aEnd - aCursor >= aLength);
+
+    aNumber = static_cast<uint16_t>(aNumber + delta);
+    aValue  = aCursor;
+    aCursor += aLength;
+    ret = true;
+
+exit:
+    return ret;
+}
+
+uint8_t MessageNative::WriteOptionField(uint8_t *aCursor, uint8_t &aLength, uint16_t aValue)
+{
+    uint8_t nibble;
+
+    if (aValue < kOptionExtended8)
+    {
+        nibble = static_cast<uint8_t>(aValue);
+    }
+    else if (aValue < kOptionExtended16Base)
+    {
+        nibble             = kOptionExtended8;
+        aCursor[aLength++] = static_cast<uint8_t>(aValue - kOptionExtended8);
+    }
+    else
+    {
+        nibble             = kOptionExtended16;
+        aValue             = static_cast<uint16_t>(aValue - kOptionExtended16Base);
+        aCursor[aLength++] = static_cast<uint8_t>(aValue >> 8);
+        aCursor[aLength++] = static_cast<uint8_t>(aValue);
+    }
+
+    return nibble;
+}
+
+void MessageNative::AppendOption(uint16_t aNumber, const uint8_t *aValue, uint16_t aLength)
+{
+    uint8_t header[5];
+    uint8_t headerLength = 1;
+    uint8_t delta;
+
+    assert(mBuffer == mStorage);
+
+    // Options are only appended in order and before the payload.
+    VerifyOrExit(aNumber >= mLastOption && mOptionsEnd == mLength);
+
+    delta     = WriteOptionField(header, headerLength, static_cast<uint16_t>(aNumber - mLastOption));
+    header[0] = static_cast<uint8_t>((delta << 4) | WriteOptionField(header, headerLength, aLength));
+
+    VerifyOrExit(mLength + headerLength + aLength <= kMaxMessageSize);
+
+    memcpy(mBuffer + mLength, header, headerLength);
+    memcpy(mBuffer + mLength + headerLength, aValue, aLength);
+    mLength     = static_cast<uint16_t>(mLength + headerLength + aLength);
+    mOptionsEnd = mLength;
+    mLastOption = aNumber;
+
+exit:
+    return;
+}
+
+AgentNative::Transaction::Transaction(void)
+    : mAgent(NULL)
+    , mNext(NULL)
+    , mTimer(AgentNative::HandleTransactionTimer, this)
+    , mHandler(NULL)
+    , mContext(NULL)
+    , mPeerPort(0)
+    , mDestination(NULL)
+    , mSendTime(0)
+    , mTimeout(0)
+    , mBackoff(0)
+    , mRetransmissions(0)
+    , mAcknowledged(false)
+{
+    memset(mPeerAddress, 0, sizeof(mPeerAddress));
+}
+
+AgentNative::Core::Core(void)
+    : mAgents(0)
+    , mMessageId(0)
+    , mFreeTransactions(NULL)
+    , mMessagePoolMisses(0)
+{
+    memset(mBuckets, 0, sizeof(mBuckets));
+
+    for (size_t i = 0; i < kMaxTransactions; ++i)
+    {
+        mTransactions[i].mNext = mFreeTransactions;
+        mFreeTransactions      = &mTransactions[i];
+    }
+
+    mFreeMessages.reserve(kMessagePoolSize);
+
+    for (size_t i = 0; i < kMessagePoolSize; ++i)
+    {
+        mFreeMessages.push_back(new MessageNative());
+        sMessageMemory.Allocate(sizeof(MessageNative));
+    }
+
+    sCoreMemory.Allocate(sizeof(Core));
+}
+
+AgentNative::Core::~Core(void)
+{
+    for (size_t i = 0; i < mFreeMessages.size(); ++i)
+    {
+        delete mFreeMessages[i];
+        sMessageMemory.Free(sizeof(MessageNative));
+    }
+
+    sCoreMemory.Free(sizeof(Core));
+}
+
+AgentNative::AgentNative(NetworkSender aNetworkSender, void *aContext, TimerWheel *aTimerWheel, AgentNative *aShared)
+    : mNetworkSender(aNetworkSender)
+    , mVectorSender(NULL)
+    , mContext(aContext)
+    , mTimerWheel(aTimerWheel)
+    , mRandom(static_cast<uint32_t>(time(NULL)) ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(this)))
+    , mCore(aShared != NULL ? aShared->mCore : new Core())
+    , mTransactionCount(0)
+    , mMaxTransactions(kMaxTransactions)
+    , mNstart(kDefaultNstart)
+{
+    if (mRandom == 0)
+    {
+        mRandom = 1;
+    }
+
+    if (mCore->mAgents++ == 0)
+    {
+        mCore->mMessageId = static_cast<uint16_t>(NewRandom());
+    }
+
+    memset(mDestinations, 0, sizeof(mDestinations));
+}
+
+AgentNative::~AgentNative(void)
+{
+    // The transactions of this agent go back to the core, without their handlers being called.
+    for (size_t i = 0; i < kMaxTransactions; ++i)
+    {
+        Transaction &transaction = mCore->mTransactions[i];
+
+        if (transaction.mAgent == this && transaction.mDestination != NULL)
+        {
+            FreeTransaction(transaction);
+        }
+    }
+
+    if (--mCore->mAgents == 0)
+    {
+        delete mCore;
+    }
+}
+
+uint32_t AgentNative::NewRandom(void)
+{
+    // xorshift32, only used to spread retransmissions and initial message ids.
+    mRandom ^= mRandom << 13;
+    mRandom ^= mRandom >> 17;
+    mRandom ^= mRandom << 5;
+
+    return mRandom;
+}
+
+Message *AgentNative::NewMessage(Type aType, Code aCode, const uint8_t *aToken, uint8_t aTokenLength)
+{
+    MessageNative *message;
+
+    if (mCore->mFreeMessages.empty())
+    {
+        mCore->mMessagePoolMisses++;
+        sMessagePoolMisses.Add();
+        message = new MessageNative();
+        sMessageMemory.Allocate(sizeof(MessageNative));
+    }
+    else
+    {
+        message = mCore->mFreeMessages.back();
+        mCore->mFreeMessages.pop_back();
+    }
+
+    message->Init(aType, aCode, NewMessageId(), aToken, aTokenLength);
+
+    sMessagesInUse.Add();
+
+    return message;
+}
+
+void AgentNative::FreeMessage(Message *aMessage)
+{
+    MessageNative *message = static_cast<MessageNative *>(aMessage);
+
+    sMessagesInUse.Subtract();
+
+    if (mCore->mFreeMessages.size() < kMessagePoolSize)
+    {
+        mCore->mFreeMessages.push_back(message);
+    }
+    else
+    {
+        delete message;
+        sMessageMemory.Free(sizeof(MessageNative));
+    }
+}
+
+size_t AgentNative::HashTransaction(const uint8_t *aToken, uint8_t aTokenLength)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+
+    for (uint8_t i = 0; i < aTokenLength; ++i)
+    {
+        hash = (hash ^ aToken[i]) * 16777619u;
+    }
+
+    return hash & (kTransactionBuckets - 1);
+}
+
+AgentNative::Transaction *AgentNative::NewTransaction(const MessageNative &aMessage,
+                                                      const uint8_t *      aIp6,
+                                                      uint16_t             aPort)
+{
+    Transaction *  transaction = mCore->mFreeTransactions;
+    uint8_t        tokenLength = 0;
+    const uint8_t *token       = aMessage.GetToken(tokenLength);
+    size_t         bucket      = HashTransaction(token, tokenLength);
+    uint64_t       now         = GetMonotonicNow();
+    Destination *  destination;
+    uint32_t       timeout;
+
+    VerifyOrExit(transaction != NULL && mTransactionCount < mMaxTransactions, transaction = NULL);
+    destination = GetDestination(aIp6, now);
+    VerifyOrExit(destination->mInFlight < mNstart, transaction = NULL, sNstartLimited.Add());
+
+    mTransactionCount++;
+    mCore->mFreeTransactions = transaction->mNext;
+    transaction->mAgent      = this;
+    transaction->mNext       = mCore->mBuckets[bucket];
+    mCore->mBuckets[bucket]  = transaction;
+
+    transaction->mMessage.Copy(aMessage);
+    transaction->mMessageId       = aMessage.GetMessageId();
+    transaction->mPeerPort        = aPort;
+    transaction->mRetransmissions = 0;
+    transaction->mAcknowledged    = false;
+    transaction->mDestination     = destination;
+    transaction->mSendTime        = now;
+    destination->mInFlight++;
+
+    // Short timeouts back off faster, so that a sudden longer path is not flooded, long ones slower.
+    timeout               = destination->mTimeout;
+    transaction->mTimeout = timeout + NewRandom() % (timeout * (kAckRandomFactor - 1000) / 1000 + 1);
+    transaction->mBackoff = timeout < kShortTimeout ? 3000 : (timeout > kLongTimeout ? 1500 : 2000);
+
+    if (aIp6 != NULL)
+    {
+        memcpy(transaction->mPeerAddress, aIp6, sizeof(transaction->mPeerAddress));
+    }
+    else
+    {
+        memset(transaction->mPeerAddress, 0, sizeof(transaction->mPeerAddress));
+    }
+
+exit:
+    return transaction;
+}
+
+AgentNative::Transaction *AgentNative::FindTransaction(const MessageNative &aMessage)
+{
+    Transaction *  transaction = NULL;
+    uint8_t        tokenLength = 0;
+    const uint8_t *token       = aMessage.GetToken(tokenLength);
+    bool           byId = aMessage.GetType() == kTypeAcknowledgment || aMessage.GetType() == kTypeReset;
+
+    if (byId && aMessage.GetCode() == kCodeEmpty)
+    {
+        // Empty acknowledgments and resets carry no token, so they are matched by message id.
+        for (size_t i = 0; i < kTransactionBuckets && transaction == NULL; ++i)
+        {
+            for (transaction = mCore->mBuckets[i]; transaction != NULL; transaction = transaction->mNext)
+            {
+                if (transaction->mAgent == this && transaction->mMessageId == aMessage.GetMessageId())
+                {
+                    break;
+                }
+            }
+        }
+
+        ExitNow();
+    }
+
+    // Requests to an anycast locator are answered from a unicast address, so responses are matched by token only.
+    for (transaction = mCore->mBuckets[HashTransaction(token, tokenLength)]; transaction != NULL;
+         transaction = transaction->mNext)
+    {
+        uint8_t        length;
+        const uint8_t *sent = transaction->mMessage.GetToken(length);
+
+        if (transaction->mAgent == this && length == tokenLength && !memcmp(sent, token, length) &&
+            (!byId || transaction->mMessageId == aMessage.GetMessageId()))
+        {
+            break;
+        }
+    }
+
+exit:
+    return transaction;
+}
+
+void AgentNative::FreeTransaction(Transaction &aTransaction)
+{
+    uint8_t        tokenLength = 0;
+    const uint8_t *token       = aTransaction.mMessage.GetToken(tokenLength);
+    Transaction ** link        = &mCore->mBuckets[HashTransaction(token, tokenLength)];
+
+    if (mTimerWheel != NULL)
+    {
+        mTimerWheel->Stop(aTransaction.mTimer);
+    }
+
+    while (*link != &aTransaction)
+    {
+        assert(*link != NULL);
+        link = &(*link)->mNext;
+    }
+
+    *link                    = aTransaction.mNext;
+    aTransaction.mNext       = mCore->mFreeTransactions;
+    mCore->mFreeTransactions = &aTransaction;
+    mTransactionCount--;
+
+    aTransaction.mDestination->mInFlight--;
+    aTransaction.mDestination = NULL;
+}
+
+AgentNative::Destination *AgentNative::GetDestination(const uint8_t *aIp6, uint64_t aNow)
+{
+    static const uint8_t kUnspecified[sizeof(mDestinations[0].mAddress)] = {0};
+
+    const uint8_t *address     = aIp6 != NULL ? aIp6 : kUnspecified;
+    Destination *  destination = NULL;
+    Destination *  unused      = NULL;
+
+    for (size_t i = 0; i < kMaxTransactions; ++i)
+    {
+        Destination &entry = mDestinations[i];
+
+        if (entry.mValid && !memcmp(entry.mAddress, address, sizeof(entry.mAddress)))
+        {
+            destination = &entry;
+            break;
+        }
+
+        // The least recently updated entry without transactions is replaced, there is always one.
+        if (entry.mInFlight == 0 &&
+            (unused == NULL || (unused->mValid && (!entry.mValid || entry.mUpdateTime < unused->mUpdateTime))))
+        {
+            unused = &entry;
+        }
+    }
+
+    if (destination == NULL)
+    {
+        assert(unused != NULL);
+        destination = unused;
+        memset(destination, 0, sizeof(*destination));
+        memcpy(destination->mAddress, address, sizeof(destination->mAddress));
+        destination->mUpdateTime = aNow;
+        destination->mTimeout    = kAckTimeout;
+        destination->mValid      = true;
+    }
+
+    AgeDestination(*destination, aNow);
+
+    return destination;
+}
+
+uint32_t AgentNative::GetRetransmissionTimeout(const uint8_t *aIp6)
+{
+    return GetDestination(aIp6, GetMonotonicNow())->mTimeout;
+}
+
+void AgentNative::AgeDestination(Destination &aDestination, uint64_t aNow)
+{
+    uint64_t idle = aNow - aDestination.mUpdateTime;
+
+    // Estimations not updated for a while move back towards the initial timeout.
+    if (aDestination.mTimeout < kShortTimeout && idle > 16 * static_cast<uint64_t>(aDestination.mTimeout))
+    {
+        aDestination.mTimeout *= 2;
+        aDestination.mUpdateTime = aNow;
+    }
+    else if (aDestination.mTimeout > kLongTimeout && idle > 4 * static_cast<uint64_t>(aDestination.mTimeout))
+    {
+        aDestination.mTimeout    = (kAckTimeout + aDestination.mTimeout) / 2;
+        aDestination.mUpdateTime = aNow;
+    }
+}
+
+void AgentNative::UpdateEstimation(uint32_t &aSrtt, uint32_t &aVar, uint32_t aRtt)
+{
+    if (aSrtt == 0)
+    {
+        aSrtt = aRtt;
+        aVar  = aRtt / 2;
+    }
+    else
+    {
+        aVar  = (3 * aVar + (aSrtt > aRtt ? aSrtt - aRtt : aRtt - aSrtt)) / 4;
+        aSrtt = (7 * aSrtt + aRtt) / 8;
+    }
+}
+
+void AgentNative::UpdateDestination(Destination &aDestination, const Transaction &aTransaction, uint64_t aNow)
+{
+    uint64_t elapsed = aNow - aTransaction.mSendTime;
+    uint32_t rtt     = kMaxTimeout;
+    uint32_t timeout = aDestination.mTimeout;
+
+    if (elapsed < kMaxTimeout)
+    {
+        rtt = elapsed > 0 ? static_cast<uint32_t>(elapsed) : 1;
+    }
+
+    if (aTransaction.mRetransmissions == 0)
+    {
+        UpdateEstimation(aDestination.mStrongSrtt, aDestination.mStrongVar, rtt);
+        timeout = (aDestination.mStrongSrtt + 4 * aDestination.mStrongVar + timeout) / 2;
+        sStrongRoundTrip.Record(rtt);
+    }
+    else if (aTransaction.mRetransmissions <= kMaxWeakRetransmit)
+    {
+        // The response may be to any transmission, so it is measured from the first one and weighs less.
+        UpdateEstimation(aDestination.mWeakSrtt, aDestination.mWeakVar, rtt);
+        timeout = (aDestination.mWeakSrtt + aDestination.mWeakVar + 3 * timeout) / 4;
+        sWeakRoundTrip.Record(rtt);
+    }
+    else
+    {
+        ExitNow();
+    }
+
+    if (timeout < kMinTimeout)
+    {
+        timeout = kMinTimeout;
+    }
+    else if (timeout > kMaxTimeout)
+    {
+        timeout = kMaxTimeout;
+    }
+
+    aDestination.mTimeout    = timeout;
+    aDestination.mUpdateTime = aNow;
+    otbrLog(OTBR_LOG_DEBUG, "CoAP round trip time %u ms, retransmission timeout %u ms", rtt, aDestination.mTimeout);
+
+exit:
+    return;
+}
+
+void AgentNative::SetMaxTransactions(unsigned int aCount)
+{
+    mMaxTransactions = aCount < kMaxTransactions ? aCount : static_cast<unsigned int>(kMaxTransactions);
+}
+
+unsigned int AgentNative::GetTransactionCount(const char *aPath) const
+{
+    unsigned int count = 0;
+
+    for (size_t i = 0; i < kTransactionBuckets; ++i)
+    {
+        for (const Transaction *transaction = mCore->mBuckets[i]; transaction != NULL;
+             transaction = transaction->mNext)
+        {
+            if (transaction->mAgent == this && (aPath == NULL || transaction->mMessage.MatchPath(aPath)))
+            {
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+void AgentNative::HandleTransactionTimer(void *aContext)
+{
+    Transaction *transaction = static_cast<Transaction *>(aContext);
+
+    transaction->mAgent->HandleTransactionTimer(*transaction);
+}
+
+void AgentNative::HandleTransactionTimer(Transaction &aTransaction)
+{
+    if (aTransaction.mAcknowledged)
+    {
+        otbrLog(OTBR_LOG_WARNING, "CoAP separate response not received!");
+        FreeTransaction(aTransaction);
+    }
+    else if (aTransaction.mRetransmissions < kMaxRetransmit)
+    {
+        uint64_t timeout = static_cast<uint64_t>(aTransaction.mTimeout) * aTransaction.mBackoff / 1000;
+
+        aTransaction.mRetransmissions++;
+        aTransaction.mTimeout = kMaxTimeout;
+
+        if (timeout < kMaxTimeout)
+        {
+            aTransaction.mTimeout = static_cast<uint32_t>(timeout);
+        }
+        sRetransmissions.Add();
+        SendRaw(aTransaction.mMessage, aTransaction.mPeerAddress, aTransaction.mPeerPort);
+        mTimerWheel->Start(aTransaction.mTimer, aTransaction.mTimeout);
+    }
+    else
+    {
+        otbrLog(OTBR_LOG_WARNING, "CoAP request timed out!");
+        FreeTransaction(aTransaction);
+    }
+}
+
+ssize_t AgentNative::SendRaw(const MessageNative &aMessage, const uint8_t *aIp6, uint16_t aPort)
+{
+    mDuplicates.Record(aMessage.GetBuffer(), aMessage.GetLength(), aIp6, aPort);
+
+    return mNetworkSender(aMessage.GetBuffer(), aMessage.GetLength(), aIp6, aPort, mContext);
+}
+
+void AgentNative::SendEmpty(Type aType, uint16_t aMessageId, const uint8_t *aIp6, uint16_t aPort)
+{
+    MessageNative message;
+
+    message.Init(aType, kCodeEmpty, aMessageId, NULL, 0);
+    SendRaw(message, aIp6, aPort);
+}
+
+otbrError AgentNative::Send(Message &       aMessage,
+                            const uint8_t * aIp6,
+                            uint16_t        aPort,
+                            ResponseHandler aHandler,
+                            void *          aContext)
+{
+    otbrError      ret     = OTBR_ERROR_ERRNO;
+    MessageNative &message = static_cast<MessageNative &>(aMessage);
+
+    if (message.GetType() == kTypeConfirmable)
+    {
+        Transaction *transaction = NewTransaction(message, aIp6, aPort);
+
+        VerifyOrExit(transaction != NULL, errno = ENOBUFS);
+
+        transaction->mHandler = aHandler;
+        transaction->mContext = aContext;
+
+        if (mTimerWheel != NULL)
+        {
+            mTimerWheel->Start(transaction->mTimer, transaction->mTimeout);
+        }
+
+        // A failed transmission is retried as a retransmission.
+        SendRaw(message, aIp6, aPort);
+    }
+    else
+    {
+        VerifyOrExit(SendRaw(message, aIp6, aPort) >= 0);
+    }
+
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    if (ret != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "CoAP failed to send: %s", strerror(errno));
+    }
+
+    return ret;
+}
+
+otbrError AgentNative::Forward(const Message &aMessage, const uint8_t *aIp6, uint16_t aPort)
+{
+    otbrError      ret     = OTBR_ERROR_ERRNO;
+    MessageNative &message = const_cast<MessageNative &>(static_cast<const MessageNative &>(aMessage));
+    Type           type    = message.GetType();
+    uint16_t       id      = message.GetMessageId();
+
+    // Only the header is rewritten, the encoded options and payload are sent as they are.
+    message.SetType(kTypeNonConfirmable);
+    message.SetMessageId(NewMessageId());
+
+    VerifyOrExit(SendRaw(message, aIp6, aPort) >= 0);
+
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    // The received message may still be acknowledged by its own agent.
+    message.SetType(type);
+    message.SetMessageId(id);
+
+    return ret;
+}
+
+otbrError AgentNative::SendPayload(Message &      aMessage,
+                                   const uint8_t *aPayload,
+                                   uint16_t       aLength,
+                                   const uint8_t *aIp6,
+                                   uint16_t       aPort)
+{
+    otbrError      ret      = OTBR_ERROR_ERRNO;
+    MessageNative &message  = static_cast<MessageNative &>(aMessage);
+    bool           gathered = mVectorSender != NULL && message.GetType() == kTypeNonConfirmable;
+    struct iovec   vector[3];
+    int            count;
+
+    // Confirmable messages are kept for retransmission and acknowledgements for duplicates, with their payload.
+    if (!gathered)
+    {
+        message.SetPayload(aPayload, aLength);
+        ExitNow(ret = Send(message, aIp6, aPort, NULL, NULL));
+    }
+
+    count = message.GetVector(aPayload, aLength, vector);
+    VerifyOrExit(count > 0, errno = EMSGSIZE);
+    VerifyOrExit(mVectorSender(vector, count, aIp6, aPort, mContext) >= 0);
+
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    // Send() logs its own failures.
+    if (ret != OTBR_ERROR_NONE && gathered)
+    {
+        otbrLog(OTBR_LOG_ERR, "CoAP failed to send: %s", strerror(errno));
+    }
+
+    return ret;
+}
+
+void AgentNative::Input(const void *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort)
+{
+    MessageNative  message;
+    const uint8_t *response       = NULL;
+    uint16_t       responseLength = 0;
+
+    VerifyOrExit(message.Parse(static_cast<const uint8_t *>(aBuffer), aLength) == OTBR_ERROR_NONE,
+                 otbrLog(OTBR_LOG_WARNING, "Discarded malformed CoAP message."));
+
+    if (mDuplicates.Check(message.GetBuffer(), message.GetLength(), aIp6, aPort, GetMonotonicNow(), response,
+                          responseLength))
+    {
+        if (response != NULL)
+        {
+            mNetworkSender(response, responseLength, aIp6, aPort, mContext);
+        }
+
+        ExitNow();
+    }
+
+    if (message.GetCode() == kCodeEmpty && message.GetType() == kTypeConfirmable)
+    {
+        // CoAP ping.
+        SendEmpty(kTypeReset, message.GetMessageId(), aIp6, aPort);
+    }
+    else if (message.GetCode() != kCodeEmpty && message.GetCode() < kCodeCodeMin)
+    {
+        HandleRequest(message, aIp6, aPort);
+    }
+    else
+    {
+        HandleResponse(message, aIp6, aPort);
+    }
+
+exit:
+    return;
+}
+
+void AgentNative::HandleRequest(const MessageNative &aRequest, const uint8_t *aIp6, uint16_t aPort)
+{
+    const Resource *resource    = NULL;
+    uint8_t         tokenLength = 0;
+    const uint8_t * token       = aRequest.GetToken(tokenLength);
+    MessageNative   response;
+
+    for (const Resource *const *it = mResources.Begin(); it != mResources.End(); ++it)
+    {
+        if (aRequest.MatchPath((*it)->mPath))
+        {
+            resource = *it;
+            break;
+        }
+    }
+
+    if (aRequest.GetType() == kTypeConfirmable)
+    {
+        response.Init(kTypeAcknowledgment, kCodeEmpty, aRequest.GetMessageId(), token, tokenLength);
+    }
+    else
+    {
+        response.Init(kTypeNonConfirmable, kCodeEmpty, NewMessageId(), token, tokenLength);
+    }
+
+    if (resource != NULL)
+    {
+        // Code is left kCodeEmpty to use separate response if no response set by handler.
+        OTBR_PROBE3(coap_request, resource->mPath, static_cast<int>(aRequest.GetType()), aPort);
+        Timeline::Begin(resource->mPath);
+        resource->mHandler(*resource, aRequest, response, aIp6, aPort, resource->mContext);
+        Timeline::End(resource->mPath);
+    }
+    else
+    {
+        otbrLog(OTBR_LOG_WARNING, "CoAP received unexpected request!");
+        response.SetCode(static_cast<Code>(kCodeNotFound));
+    }
+
+    if (response.GetCode() != kCodeEmpty)
+    {
+        SendRaw(response, aIp6, aPort);
+    }
+    else if (response.GetType() == kTypeAcknowledgment)
+    {
+        SendEmpty(kTypeAcknowledgment, aRequest.GetMessageId(), aIp6, aPort);
+    }
+}
+
+void AgentNative::HandleResponse(const MessageNative &aResponse, const uint8_t *aIp6, uint16_t aPort)
+{
+    Transaction *transaction = NULL;
+
+    if (aResponse.GetType() == kTypeConfirmable)
+    {
+        // Separate response.
+        SendEmpty(kTypeAcknowledgment, aResponse.GetMessageId(), aIp6, aPort);
+    }
+
+    VerifyOrExit((transaction = FindTransaction(aResponse)) != NULL, otbrLog(OTBR_LOG_DEBUG, "request not found!"));
+
+    // The first acknowledgment or response measures the round trip time.
+    if (aResponse.GetType() != kTypeReset && !transaction->mAcknowledged)
+    {
+        UpdateDestination(*transaction->mDestination, *transaction, GetMonotonicNow());
+    }
+
+    if (aResponse.GetType() == kTypeReset)
+    {
+        FreeTransaction(*transaction);
+    }
+    else if (aResponse.GetCode() == kCodeEmpty)
+    {
+        // Acknowledged, the response will come separately.
+        transaction->mAcknowledged = true;
+
+        if (mTimerWheel != NULL)
+        {
+            mTimerWheel->Start(transaction->mTimer, kExchangeLifetime);
+        }
+    }
+    else
+    {
+        ResponseHandler handler = transaction->mHandler;
+        void *          context = transaction->mContext;
+
+        // The transaction is freed first so that the handler is able to send new requests.
+        FreeTransaction(*transaction);
+
+        if (handler != NULL)
+        {
+            handler(aResponse, context);
+        }
+    }
+
+exit:
+    return;
+}
+
+otbrError AgentNative::AddResource(const Resource &aResource)
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+
+    for (const Resource **it = mResources.Begin(); it != mResources.End(); ++it)
+    {
+        if (*it == &aResource)
+        {
+            otbrLog(OTBR_LOG_ERR, "CoAP resource already added!");
+            ExitNow(errno = EEXIST);
+        }
+    }
+
+    VerifyOrExit(mResources.PushBack(&aResource), errno = ENOMEM);
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    return ret;
+}
+
+otbrError AgentNative::RemoveResource(const Resource &aResource)
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+
+    for (const Resource **it = mResources.Begin(); it != mResources.End(); ++it)
+    {
+        if (*it == &aResource)
+        {
+            mResources.Erase(it);
+            ret = OTBR_ERROR_NONE;
+            break;
+        }
+    }
+
+    if (ret)
+    {
+        errno = ENOENT;
+    }
+
+    return ret;
+}
+
+#if OTBR_ENABLE_NATIVE_COAP
+Agent *Agent::Create(NetworkSender aNetworkSender, void *aContext, TimerWheel *aTimerWheel, Agent *aShared)
+{
+    return new AgentNative(aNetworkSender, aContext, aTimerWheel, static_cast<AgentNative *>(aShared));
+}
+
+void Agent::Destroy(Agent *aAgent)
+{
+    delete static_cast<AgentNative *>(aAgent);
+}
+#endif // OTBR_ENABLE_NATIVE_COAP
+
+} // namespace Coap
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,646 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the native CoAP service.
+ */
+
+#ifndef COAP_NATIVE_HPP_
+#define COAP_NATIVE_HPP_
+
+#include <vector>
+
+#include "coap.hpp"
+#include "coap_dedup.hpp"
+#include "common/capacity.hpp"
+#include "common/small_vector.hpp"
+#include "common/timer.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Coap {
+
+/**
+ * @addtogroup border-router-coap
+ *
+ * @brief
+ *   This module includes definition for the native CoAP service.
+ *
+ * @{
+ */
+
+/**
+ * This class implements CoAP message functionality on a flat buffer.
+ *
+ * A message is kept encoded in its buffer, so it is sent as it is and parsed without copying. Options must be set
+ * before the payload.
+ *
+ */
+class MessageNative : public Message
+{
+public:
+    enum
+    {
+        kMaxMessageSize = 1280, ///< Max bytes of an encoded CoAP message.
+    };
+
+    /**
+     * The constructor to initialize an empty CoAP message.
+     *
+     */
+    MessageNative(void);
+
+    /**
+     * This method initializes this message with the given arguments.
+     *
+     * @param[in]   aType           The CoAP type.
+     * @param[in]   aCode           The CoAP code.
+     * @param[in]   aMessageId      The CoAP message id.
+     * @param[in]   aToken          The CoAP token.
+     * @param[in]   aTokenLength    Number of bytes in @p aToken.
+     *
+     */
+    void Init(Type aType, Code aCode, uint16_t aMessageId, const uint8_t *aToken, uint8_t aTokenLength);
+
+    /**
+     * This method parses an encoded CoAP message without copying it.
+     *
+     * The message refers to @p aBuffer afterwards, which must stay valid while the message is used.
+     *
+     * @param[in]   aBuffer         A pointer to the encoded message.
+     * @param[in]   aLength         Number of bytes of @p aBuffer.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully parsed the message.
+     * @retval  OTBR_ERROR_ERRNO    Failed to parse the message, errno is set to EBADMSG.
+     *
+     */
+    otbrError Parse(const uint8_t *aBuffer, uint16_t aLength);
+
+    /**
+     * This method returns the CoAP code of this message.
+     *
+     * @returns the CoAP code of the message.
+     *
+     */
+    Code GetCode(void) const { return static_cast<Code>(mBuffer[1]); }
+
+    /**
+     * This method sets the CoAP code of this message.
+     *
+     * @param[in]   aCode   The CoAP code.
+     *
+     */
+    void SetCode(Code aCode) { mBuffer[1] = static_cast<uint8_t>(aCode); }
+
+    /**
+     * This method returns the CoAP type of this message.
+     *
+     * @returns The CoAP type of the message.
+     *
+     */
+    Type GetType(void) const { return static_cast<Type>((mBuffer[0] >> 4) & 0x03); }
+
+    /**
+     * This method sets the CoAP type of this message.
+     *
+     * @param[in]   aType   The CoAP type.
+     *
+     */
+    void SetType(Type aType) { mBuffer[0] = static_cast<uint8_t>((mBuffer[0] & 0xcf) | (aType << 4)); }
+
+    /**
+     * This method returns the CoAP message id of this message.
+     *
+     * @returns The CoAP message id.
+     *
+     */
+    uint16_t GetMessageId(void) const { return static_cast<uint16_t>((mBuffer[2] << 8) | mBuffer[3]); }
+
+    /**
+     * This method sets the CoAP message id of this message.
+     *
+     * @param[in]   aMessageId      The CoAP message id.
+     *
+     */
+    void SetMessageId(uint16_t aMessageId)
+    {
+        mBuffer[2] = static_cast<uint8_t>(aMessageId >> 8);
+        mBuffer[3] = static_cast<uint8_t>(aMessageId);
+    }
+
+    /**
+     * This method returns the token of this message.
+     *
+     * @param[out]    aLength       Number of bytes of the token.
+     *
+     * @returns A pointer to the token.
+     *
+     */
+    const uint8_t *GetToken(uint8_t &aLength) const
+    {
+        aLength = mBuffer[0] & 0x0f;
+        return mBuffer + kHeaderSize;
+    }
+
+    /**
+     * This method sets the token of this message.
+     *
+     * @param[in]   aToken          A pointer to the token.
+     * @param[in]   aLength         Number of bytes of the token.
+     *
+     */
+    void SetToken(const uint8_t *aToken, uint8_t aLength);
+
+    /**
+     * This method sets the CoAP Uri Path of this message.
+     *
+     * @param[in]   aPath           A pointer to to the null-terminated string of Uri Path.
+     *
+     */
+    void SetPath(const char *aPath);
+
+    /**
+     * This method sets the CoAP Uri Path of this message from its encoded options.
+     *
+     * @param[in]   aPath           A reference to the encoded Uri Path.
+     *
+     */
+    void SetPathEncoded(const EncodedPath &aPath);
+
+    /**
+     * This method returns the value of an unsigned integer option of this message.
+     *
+     * @param[in]   aOption         The option number.
+     * @param[out]  aValue          The option value.
+     *
+     * @retval  true    The option is present.
+     * @retval  false   The option is absent.
+     *
+     */
+    bool GetUintOption(Option aOption, uint32_t &aValue) const;
+
+    /**
+     * This method appends an unsigned integer option to this message.
+     *
+     * @param[in]   aOption         The option number.
+     * @param[in]   aValue          The option value.
+     *
+     */
+    void AddUintOption(Option aOption, uint32_t aValue);
+
+    /**
+     * This method tells whether the Uri Path of this message is @p aPath.
+     *
+     * @param[in]   aPath           A pointer to to the null-terminated string of Uri Path.
+     *
+     * @returns Whether the Uri Path matches.
+     *
+     */
+    bool MatchPath(const char *aPath) const;
+
+    /**
+     * This method returns the payload of this message.
+     *
+     * @param[out]  aLength         Number of bytes of the payload.
+     *
+     * @returns A pointer to the payload buffer, NULL if there is no payload.
+     */
+    const uint8_t *GetPayload(uint16_t &aLength) const
+    {
+        bool hasPayload = mOptionsEnd < mLength;
+
+        aLength = hasPayload ? static_cast<uint16_t>(mLength - mOptionsEnd - 1) : 0;
+        return hasPayload ? mBuffer + mOptionsEnd + 1 : NULL;
+    }
+
+    /**
+     * This method sets the payload of this message.
+     *
+     * @param[in]   aPayload        A pointer to the payload.
+     * @param[in]   aLength         Number of bytes of the payload.
+     *
+     */
+    void SetPayload(const uint8_t *aPayload, uint16_t aLength);
+
+    /**
+     * This method returns the encoded message.
+     *
+     * @returns A pointer to the encoded message.
+     *
+     */
+    const uint8_t *GetBuffer(void) const { return mBuffer; }
+
+    /**
+     * This method returns the length of the encoded message.
+     *
+     * @returns Number of bytes of the encoded message.
+     *
+     */
+    uint16_t GetLength(void) const { return mLength; }
+
+    /**
+     * This method copies an encoded message into the own storage of this message.
+     *
+     * @param[in]   aMessage        A reference to the message to copy.
+     *
+     */
+    void Copy(const MessageNative &aMessage);
+
+    /**
+     * This method describes the encoded message followed by a payload that is not copied into it.
+     *
+     * @param[in]   aPayload        A pointer to the payload.
+     * @param[in]   aLength         Number of bytes of @p aPayload.
+     * @param[out]  aVector         A pointer to at least 3 parts to receive the message.
+     *
+     * @returns Number of parts in @p aVector, 0 if the message has a payload already or it would not fit.
+     *
+     */
+    int GetVector(const uint8_t *aPayload, uint16_t aLength, struct iovec *aVector) const;
+
+private:
+    enum
+    {
+        kHeaderSize           = 4,    ///< Bytes of the fixed header.
+        kVersion1             = 0x40, ///< Version 1 in the first byte.
+        kMaxTokenLength       = 8,    ///< Max bytes of a CoAP token.
+        kPayloadMarker        = 0xff, ///< Marker preceding the payload.
+        kOptionExtended8      = 13,   ///< Option nibble of a 1-byte extension.
+        kOptionExtended16     = 14,   ///< Option nibble of a 2-byte extension.
+        kOptionExtendedMax    = 15,   ///< Reserved option nibble.
+        kOptionExtended16Base = 269,  ///< Smallest value encoded with a 2-byte extension.
+    };
+
+    MessageNative(const MessageNative &);
+    MessageNative &operator=(const MessageNative &);
+
+    static bool    ReadOption(const uint8_t *&aCursor,
+                              const uint8_t * aEnd,
+                              uint16_t &      aNumber,
+                              const uint8_t *&aValue,
+                              uint16_t &      aLength);
+    static bool    ReadOptionField(const uint8_t *&aCursor, const uint8_t *aEnd, uint16_t &aValue);
+    static uint8_t WriteOptionField(uint8_t *aCursor, uint8_t &aLength, uint16_t aValue);
+    void           AppendOption(uint16_t aNumber, const uint8_t *aValue, uint16_t aLength);
+
+    uint8_t *mBuffer;                   ///< The encoded message, either the own storage or the parsed buffer.
+    uint16_t mLength;                   ///< Bytes of the encoded message.
+    uint16_t mOptionsEnd;               ///< Offset where the options end, which is the payload marker if any.
+    uint16_t mLastOption;               ///< Number of the last option written.
+    uint8_t  mStorage[kMaxMessageSize]; ///< The own storage of the encoded message.
+};
+
+/**
+ * This class implements CoAP agent without third-party CoAP stack.
+ *
+ * Messages, transactions and their retransmission timers all come from fixed pools, so nothing is allocated when
+ * sending or receiving. Transactions are indexed by their token.
+ *
+ * The pools, the transaction index and the message ids form a core that the agents of a network share, so that the
+ * TMF and the commissioner transports hold a single set of messages and transactions, and a message taken from one
+ * may be sent or freed by the other. Each agent keeps its resources, limits, destinations and duplicates.
+ *
+ * Retransmission timeouts are estimated per destination from the measured round trip times, as CoCoA does, so that
+ * requests to a leader many hops away are not retransmitted before their responses could arrive.
+ *
+ */
+class AgentNative : public Agent
+{
+public:
+    /**
+     * The constructor to initialize a CoAP agent.
+     *
+     * @param[in]   aNetworkSender      A pointer to the function that actually sends the data.
+     * @param[in]   aContext            A pointer to application-specific context.
+     * @param[in]   aTimerWheel         A pointer to the timer wheel to schedule retransmissions with, NULL to
+     *                                  disable retransmissions.
+     * @param[in]   aShared             A pointer to an agent of the same thread to share the core of, NULL for a
+     *                                  core of its own.
+     *
+     */
+    AgentNative(NetworkSender aNetworkSender, void *aContext, TimerWheel *aTimerWheel, AgentNative *aShared = NULL);
+
+    ~AgentNative(void);
+
+    /**
+     * This method processes this CoAP message in @p aBuffer, which can be a request or response.
+     *
+     * @param[in]   aBuffer         A pointer to decrypted data.
+     * @param[in]   aLength         Number of bytes of @p aBuffer.
+     * @param[in]   aIp6            A pointer to the source Ipv6 address of this request.
+     * @param[in]   aPort           Source UDP port of this request.
+     *
+     */
+    void Input(const void *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort);
+
+    /**
+     * This method sends the CoAP message, which can be a request or response.
+     *
+     * @param[in]   aMessage    A reference to the message to send.
+     * @param[in]   aIp6        A pointer to the source Ipv6 address of this request.
+     * @param[in]   aPort       Source UDP port of this request.
+     * @param[in]   aHandler    A function poiner to be called when response is received if the message is a request.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     * @retval      OTBR_ERROR_NONE     Successfully sent the message.
+     * @retval      OTBR_ERROR_ERRNO    Failed to send the message.
+     *                                  - ENOBUFS No free transaction for a confirmable message.
+     *
+     */
+    otbrError Send(Message &aMessage, const uint8_t *aIp6, uint16_t aPort, ResponseHandler aHandler, void *aContext);
+
+    /**
+     * This method forwards a received CoAP message as a non-confirmable one.
+     *
+     * @param[in]   aMessage    A reference to the message to forward.
+     * @param[in]   aIp6        A pointer to the destination Ipv6 address.
+     * @param[in]   aPort       Destination UDP port.
+     *
+     * @retval      OTBR_ERROR_NONE     Successfully forwarded the message.
+     * @retval      OTBR_ERROR_ERRNO    Failed to forward the message.
+     *
+     */
+    otbrError Forward(const Message &aMessage, const uint8_t *aIp6, uint16_t aPort);
+
+    /**
+     * This method sends a message with a payload, gathered from parts by the vector sender if non-confirmable.
+     *
+     * @param[in]   aMessage    A reference to the message to send, without a payload.
+     * @param[in]   aPayload    A pointer to the payload.
+     * @param[in]   aLength     Number of bytes of @p aPayload.
+     * @param[in]   aIp6        A pointer to the destination Ipv6 address.
+     * @param[in]   aPort       Destination UDP port.
+     *
+     * @retval      OTBR_ERROR_NONE     Successfully sent the message.
+     * @retval      OTBR_ERROR_ERRNO    Failed to send the message.
+     *
+     */
+    otbrError SendPayload(Message &      aMessage,
+                          const uint8_t *aPayload,
+                          uint16_t       aLength,
+                          const uint8_t *aIp6,
+                          uint16_t       aPort);
+
+    void SetVectorSender(VectorSender aVectorSender) { mVectorSender = aVectorSender; }
+
+    /**
+     * This method creates a CoAP message with the given arguments.
+     *
+     * @param[in]   aType           The CoAP type.
+     * @param[in]   aCode           The CoAP code.
+     * @param[in]   aToken          The CoAP token.
+     * @param[in]   aTokenLength    Number of bytes in @p aToken.
+     *
+     * @returns The pointer to the newly created CoAP message.
+     *
+     */
+    Message *NewMessage(Type aType, Code aCode, const uint8_t *aToken, uint8_t aTokenLength);
+
+    /**
+     * This method frees a CoAP message.
+     *
+     * @param[in]   aMessage        A pointer to the message to free.
+     *
+     */
+    void FreeMessage(Message *aMessage);
+
+    /**
+     * This method returns the number of messages allocated on the heap because the message pool was exhausted.
+     *
+     * @returns Number of messages created outside the pool, shared by the agents sharing it.
+     *
+     */
+    uint32_t GetMessagePoolMisses(void) const { return mCore->mMessagePoolMisses; }
+
+    /**
+     * This method sets the max number of confirmable messages in flight.
+     *
+     * @param[in]   aCount          The max number of confirmable messages in flight, at most 16.
+     *
+     */
+    void SetMaxTransactions(unsigned int aCount);
+
+    /**
+     * This method returns the number of confirmable requests to @p aPath waiting for their responses.
+     *
+     * @param[in]   aPath           A pointer to to the null-terminated string of Uri Path.
+     *
+     * @returns Number of requests in flight to @p aPath.
+     *
+     */
+    unsigned int GetTransactionCount(const char *aPath) const;
+
+    /**
+     * This method sets the max number of confirmable messages in flight to a destination, i.e. NSTART.
+     *
+     * Confirmable messages sent beyond this limit fail with ENOBUFS until a response is received or a transaction
+     * expires.
+     *
+     * @param[in]   aCount          The max number of confirmable messages in flight to a destination, at least 1.
+     *
+     */
+    void SetNstart(unsigned int aCount) { mNstart = aCount; }
+
+    /**
+     * This method sets the time requests received are remembered, to detect their retransmissions.
+     *
+     * @param[in]   aLifetime       The lifetime in milliseconds, 0 to handle every request received.
+     *
+     */
+    void SetDuplicateLifetime(uint32_t aLifetime) { mDuplicates.SetLifetime(aLifetime); }
+
+    /**
+     * This method returns the retransmission timeout currently estimated for a destination.
+     *
+     * @param[in]   aIp6            A pointer to the Ipv6 address of the destination, NULL for the default one.
+     *
+     * @returns The retransmission timeout in milliseconds, before being dithered or backed off.
+     *
+     */
+    uint32_t GetRetransmissionTimeout(const uint8_t *aIp6);
+
+    /**
+     * This method registers a CoAP resource.
+     *
+     * @param[in]   aResource       A reference to the resource.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully added the resource.
+     * @retval  OTBR_ERROR_ERRNO    Failed to added the resource.
+     *
+     */
+    otbrError AddResource(const Resource &aResource);
+
+    /**
+     * This method Deregisters a CoAP resource.
+     *
+     * @param[in]   aResource       A reference to the resource.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully added the resource.
+     * @retval  OTBR_ERROR_ERRNO    Failed to added the resource.
+     *
+     */
+    otbrError RemoveResource(const Resource &aResource);
+
+private:
+    enum
+    {
+        kMessagePoolSize = OTBR_CAPACITY_COAP_MESSAGE_POOL, ///< Number of messages kept for reuse.
+        kMaxTransactions = OTBR_CAPACITY_COAP_TRANSACTIONS, ///< Max number of confirmable messages in flight.
+    };
+
+    enum
+    {
+        kTransactionBuckets = 16,     ///< Number of buckets indexing transactions, must be a power of 2.
+        kAckTimeout         = 2000,   ///< ACK_TIMEOUT in milliseconds, the initial timeout of a destination.
+        kAckRandomFactor    = 1500,   ///< ACK_RANDOM_FACTOR scaled by 1000.
+        kMaxRetransmit      = 4,      ///< MAX_RETRANSMIT.
+        kMaxWeakRetransmit  = 2,      ///< Max retransmissions of a request whose round trip time is measured.
+        kMinTimeout         = 100,    ///< Min retransmission timeout in milliseconds.
+        kMaxTimeout         = 60000,  ///< Max retransmission timeout in milliseconds.
+        kShortTimeout       = 1000,   ///< Timeouts below are backed off faster, and raised when not updated.
+        kLongTimeout        = 3000,   ///< Timeouts above are backed off slower, and lowered when not updated.
+        kDefaultNstart      = 4,      ///< Default max number of confirmable messages in flight to a destination.
+        kExchangeLifetime   = 247000, ///< EXCHANGE_LIFETIME in milliseconds.
+        kCodeNotFound       = 0x84,   ///< 4.04 Not Found.
+        kInlineResources    = 16,     ///< Number of resources kept without allocation.
+    };
+
+    /**
+     * This struct represents the round trip time estimation of a destination.
+     *
+     * Round trip times of requests never retransmitted are strong samples, those of requests retransmitted are weak
+     * ones, since the response may be to any transmission. Each kind is smoothed as RFC 6298 does, and the overall
+     * timeout follows strong samples more closely than weak ones.
+     *
+     */
+    struct Destination
+    {
+        uint8_t  mAddress[16]; ///< The Ipv6 address of the destination.
+        uint64_t mUpdateTime;  ///< Monotonic milliseconds the timeout was last updated or aged at.
+        uint32_t mTimeout;     ///< The overall retransmission timeout in milliseconds.
+        uint32_t mStrongSrtt;  ///< Smoothed strong round trip time in milliseconds, 0 before the first sample.
+        uint32_t mStrongVar;   ///< Strong round trip time variation in milliseconds.
+        uint32_t mWeakSrtt;    ///< Smoothed weak round trip time in milliseconds, 0 before the first sample.
+        uint32_t mWeakVar;     ///< Weak round trip time variation in milliseconds.
+        uint8_t  mInFlight;    ///< Number of transactions in flight to the destination.
+        bool     mValid;       ///< Whether this entry is used.
+    };
+
+    typedef SmallVector<const Resource *, kInlineResources> Resources;
+
+    /**
+     * This struct represents a confirmable request waiting for its response.
+     *
+     */
+    struct Transaction
+    {
+        Transaction(void);
+
+        AgentNative *   mAgent;           ///< The agent owning this transaction.
+        Transaction *   mNext;            ///< The next transaction in the same bucket or the free list.
+        Timer           mTimer;           ///< The retransmission or expiration timer.
+        ResponseHandler mHandler;         ///< The function to be called when the response is received.
+        void *          mContext;         ///< A pointer to application-specific context of @p mHandler.
+        uint8_t         mPeerAddress[16]; ///< The Ipv6 address of the peer.
+        uint16_t        mPeerPort;        ///< The UDP port of the peer.
+        uint16_t        mMessageId;       ///< The message id of the request.
+        Destination *   mDestination;     ///< The destination, whose estimation is updated by the response.
+        uint64_t        mSendTime;        ///< Monotonic milliseconds the request was first sent at.
+        uint32_t        mTimeout;         ///< The current retransmission timeout in milliseconds.
+        uint16_t        mBackoff;         ///< Factor of the timeout at each retransmission, scaled by 1000.
+        uint8_t         mRetransmissions; ///< Number of retransmissions so far.
+        bool            mAcknowledged;    ///< Whether an empty acknowledgment was received.
+        MessageNative   mMessage;         ///< A copy of the request for retransmission.
+    };
+
+    /**
+     * This struct represents what the agents sharing it allocate from.
+     *
+     */
+    struct Core
+    {
+        Core(void);
+        ~Core(void);
+
+        unsigned int                 mAgents;                         ///< Number of agents sharing this core.
+        uint16_t                     mMessageId;                      ///< The next message id of every agent.
+        Transaction                  mTransactions[kMaxTransactions]; ///< Storage of all transactions.
+        Transaction *                mBuckets[kTransactionBuckets];   ///< Transactions in flight by token and agent.
+        Transaction *                mFreeTransactions;               ///< Transactions ready for use.
+        std::vector<MessageNative *> mFreeMessages;                   ///< Messages ready for reuse.
+        uint32_t                     mMessagePoolMisses;              ///< Number of messages created outside the pool.
+    };
+
+    Transaction * NewTransaction(const MessageNative &aMessage, const uint8_t *aIp6, uint16_t aPort);
+    Transaction * FindTransaction(const MessageNative &aResponse);
+    void          FreeTransaction(Transaction &aTransaction);
+    static size_t HashTransaction(const uint8_t *aToken, uint8_t aTokenLength);
+    static void   HandleTransactionTimer(void *aContext);
+    void          HandleTransactionTimer(Transaction &aTransaction);
+
+    Destination *GetDestination(const uint8_t *aIp6, uint64_t aNow);
+    static void  AgeDestination(Destination &aDestination, uint64_t aNow);
+    static void  UpdateDestination(Destination &aDestination, const Transaction &aTransaction, uint64_t aNow);
+    static void  UpdateEstimation(uint32_t &aSrtt, uint32_t &aVar, uint32_t aRtt);
+
+    void     HandleRequest(const MessageNative &aRequest, const uint8_t *aIp6, uint16_t aPort);
+    void     HandleResponse(const MessageNative &aResponse, const uint8_t *aIp6, uint16_t aPort);
+    void     SendEmpty(Type aType, uint16_t aMessageId, const uint8_t *aIp6, uint16_t aPort);
+    ssize_t  SendRaw(const MessageNative &aMessage, const uint8_t *aIp6, uint16_t aPort);
+    uint16_t NewMessageId(void) { return mCore->mMessageId++; }
+    uint32_t NewRandom(void);
+
+    NetworkSender mNetworkSender;
+    VectorSender  mVectorSender;
+    void *        mContext;
+    TimerWheel *  mTimerWheel;
+    uint32_t      mRandom;
+    Core *        mCore;
+
+    Resources      mResources;                      ///< Registered resources.
+    unsigned int   mTransactionCount;               ///< Number of transactions of this agent in flight.
+    unsigned int   mMaxTransactions;                ///< Max number of transactions in flight.
+    unsigned int   mNstart;                         ///< Max number of transactions to a destination.
+    Destination    mDestinations[kMaxTransactions]; ///< Estimations, one free for each transaction.
+    DuplicateCache mDuplicates;                     ///< Requests received and their acknowledgments.
+};
+
+/**
+ * @}
+ */
+
+} // namespace Coap
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // COAP_NATIVE_HPP_
@@ -0,0 +1,291 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the batched datagram I/O of the agent.
+ */
+
+#include "datagram_io.hpp"
+
+#include <errno.h>
+#include <string.h>
+
+#include "otbr-config.h"
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+static Metrics::Counter sCoalesced("datagram.coalesced");
+
+void DatagramIo::Datagram::Prepare(void)
+{
+    memset(&mHeader, 0, sizeof(mHeader));
+    mIov.iov_base          = mPayload;
+    mIov.iov_len           = sizeof(mPayload);
+    mHeader.msg_name       = &mPeer;
+    mHeader.msg_namelen    = sizeof(mPeer);
+    mHeader.msg_iov        = &mIov;
+    mHeader.msg_iovlen     = 1;
+    mHeader.msg_control    = mControl.mBuffer;
+    mHeader.msg_controllen = sizeof(mControl.mBuffer);
+}
+
+bool DatagramIo::Datagram::GetLocalAddress(sockaddr_in6 &aLocal, uint16_t aPort) const
+{
+    bool found = false;
+
+    // CMSG_NXTHDR() takes a non-const header.
+    struct msghdr *header = const_cast<struct msghdr *>(&mHeader);
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(header); cmsg != NULL; cmsg = CMSG_NXTHDR(header, cmsg))
+    {
+        if (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_PKTINFO)
+        {
+            const struct in6_pktinfo *pktinfo = reinterpret_cast<const struct in6_pktinfo *>(CMSG_DATA(cmsg));
+
+            memset(&aLocal, 0, sizeof(aLocal));
+            aLocal.sin6_family   = AF_INET6;
+            aLocal.sin6_port     = htons(aPort);
+            aLocal.sin6_addr     = pktinfo->ipi6_addr;
+            aLocal.sin6_scope_id = pktinfo->ipi6_ifindex;
+            found                = true;
+            break;
+        }
+    }
+
+    return found;
+}
+
+DatagramIo::DatagramIo(void)
+    : mFd(-1)
+    , mTxCount(0)
+    , mMaxCoalescedLength(0)
+{
+}
+
+void DatagramIo::SetFd(int aFd)
+{
+    mFd      = aFd;
+    mTxCount = 0;
+}
+
+int DatagramIo::Receive(void)
+{
+    int count = -1;
+
+    VerifyOrExit(mFd >= 0, errno = EBADF);
+
+    for (int i = 0; i < kMaxBatchSize; ++i)
+    {
+        mRxDatagrams[i].Prepare();
+    }
+
+#if HAVE_RECVMMSG
+    {
+        struct mmsghdr msgs[kMaxBatchSize];
+
+        for (int i = 0; i < kMaxBatchSize; ++i)
+        {
+            msgs[i].msg_hdr = mRxDatagrams[i].mHeader;
+            msgs[i].msg_len = 0;
+        }
+
+        count = recvmmsg(mFd, msgs, kMaxBatchSize, MSG_DONTWAIT, NULL);
+
+        for (int i = 0; i < count; ++i)
+        {
+            mRxDatagrams[i].mHeader = msgs[i].msg_hdr;
+            mRxDatagrams[i].mLength = static_cast<uint16_t>(msgs[i].msg_len);
+        }
+    }
+#else
+    for (count = 0; count < kMaxBatchSize; ++count)
+    {
+        ssize_t length = recvmsg(mFd, &mRxDatagrams[count].mHeader, MSG_DONTWAIT);
+
+        if (length < 0)
+        {
+            count = (count == 0 ? -1 : count);
+            break;
+        }
+
+        mRxDatagrams[count].mLength = static_cast<uint16_t>(length);
+    }
+#endif
+
+exit:
+    return count;
+}
+
+otbrError DatagramIo::Send(const uint8_t *     aBuffer,
+                           uint16_t            aLength,
+                           const sockaddr_in6 &aPeer,
+                           const sockaddr_in6 &aLocal)
+{
+    otbrError       error = OTBR_ERROR_ERRNO;
+    Datagram *      datagram;
+    struct cmsghdr *cmsg;
+
+    VerifyOrExit(mFd >= 0, errno = EBADF);
+    VerifyOrExit(aLength <= kMaxSizeOfDatagram, errno = EMSGSIZE);
+    VerifyOrExit(!Coalesce(aBuffer, aLength, aPeer, aLocal), error = OTBR_ERROR_NONE);
+
+    if (mTxCount == kMaxBatchSize)
+    {
+        Flush();
+    }
+
+    datagram = &mTxDatagrams[mTxCount];
+    datagram->Prepare();
+    memcpy(datagram->mPayload, aBuffer, aLength);
+    memset(datagram->mControl.mBuffer, 0, sizeof(datagram->mControl.mBuffer));
+    datagram->mLength      = aLength;
+    datagram->mIov.iov_len = aLength;
+    datagram->mPeer        = aPeer;
+
+    // Send from the given address on the given interface.
+    cmsg             = CMSG_FIRSTHDR(&datagram->mHeader);
+    cmsg->cmsg_level = IPPROTO_IPV6;
+    cmsg->cmsg_type  = IPV6_PKTINFO;
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(struct in6_pktinfo));
+    {
+        struct in6_pktinfo *pktinfo = reinterpret_cast<struct in6_pktinfo *>(CMSG_DATA(cmsg));
+
+        pktinfo->ipi6_addr    = aLocal.sin6_addr;
+        pktinfo->ipi6_ifindex = aLocal.sin6_scope_id;
+    }
+
+    ++mTxCount;
+    error = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+bool DatagramIo::Coalesce(const uint8_t *     aBuffer,
+                          uint16_t            aLength,
+                          const sockaddr_in6 &aPeer,
+                          const sockaddr_in6 &aLocal)
+{
+    bool coalesced = false;
+
+    VerifyOrExit(mMaxCoalescedLength > 0);
+
+    // Only the last datagram to the peer is appended to, so that the payloads to a peer stay in order.
+    for (int i = mTxCount - 1; i >= 0; --i)
+    {
+        Datagram &                datagram = mTxDatagrams[i];
+        const struct in6_pktinfo *pktinfo =
+            reinterpret_cast<const struct in6_pktinfo *>(CMSG_DATA(CMSG_FIRSTHDR(&datagram.mHeader)));
+
+        if (datagram.mPeer.sin6_port != aPeer.sin6_port ||
+            memcmp(&datagram.mPeer.sin6_addr, &aPeer.sin6_addr, sizeof(aPeer.sin6_addr)) != 0)
+        {
+            continue;
+        }
+
+        VerifyOrExit(datagram.mLength + aLength <= mMaxCoalescedLength);
+        VerifyOrExit(pktinfo->ipi6_ifindex == aLocal.sin6_scope_id &&
+                     memcmp(&pktinfo->ipi6_addr, &aLocal.sin6_addr, sizeof(aLocal.sin6_addr)) == 0);
+
+        memcpy(datagram.mPayload + datagram.mLength, aBuffer, aLength);
+        datagram.mLength      = static_cast<uint16_t>(datagram.mLength + aLength);
+        datagram.mIov.iov_len = datagram.mLength;
+        coalesced             = true;
+        sCoalesced.Add();
+        break;
+    }
+
+exit:
+    return coalesced;
+}
+
+int DatagramIo::Flush(void)
+{
+    int sent  = 0;
+    int index = 0;
+
+    VerifyOrExit(mTxCount > 0);
+
+#if HAVE_SENDMMSG
+    {
+        struct mmsghdr msgs[kMaxBatchSize];
+
+        for (int i = 0; i < mTxCount; ++i)
+        {
+            msgs[i].msg_hdr = mTxDatagrams[i].mHeader;
+            msgs[i].msg_len = 0;
+        }
+
+        while (index < mTxCount)
+        {
+            int count = sendmmsg(mFd, msgs + index, static_cast<unsigned int>(mTxCount - index), MSG_DONTWAIT);
+
+            if (count < 0)
+            {
+                // The datagram failing to send ends the call, skip it and go on with the rest.
+                otbrLog(OTBR_LOG_WARNING, "Dropped datagram: %s.", strerror(errno));
+                VerifyOrExit(errno != EAGAIN && errno != EWOULDBLOCK);
+                ++index;
+            }
+            else
+            {
+                sent += count;
+                index += count;
+            }
+        }
+    }
+#else
+    for (; index < mTxCount; ++index)
+    {
+        if (sendmsg(mFd, &mTxDatagrams[index].mHeader, MSG_DONTWAIT) < 0)
+        {
+            otbrLog(OTBR_LOG_WARNING, "Dropped datagram: %s.", strerror(errno));
+            VerifyOrExit(errno != EAGAIN && errno != EWOULDBLOCK);
+        }
+        else
+        {
+            ++sent;
+        }
+    }
+#endif
+
+exit:
+    mTxCount = 0;
+    return sent;
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
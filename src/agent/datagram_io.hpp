@@ -0,0 +1,229 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the batched datagram I/O of the agent.
+ */
+
+#ifndef DATAGRAM_IO_HPP_
+#define DATAGRAM_IO_HPP_
+
+#include <netinet/in.h>
+#include <stddef.h>
+#include <sys/socket.h>
+
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class implements batched I/O of datagrams on a UDP socket.
+ *
+ * Ready datagrams are gathered with one recvmmsg() call, and datagrams to send are queued and flushed with one
+ * sendmmsg() call. Systems without these calls fall back to recvmsg() and sendmsg() per datagram.
+ *
+ */
+class DatagramIo
+{
+public:
+    enum
+    {
+        kMaxBatchSize      = 16,   ///< Max number of datagrams received or sent at once.
+        kMaxSizeOfDatagram = 1500, ///< Max size of a datagram in bytes.
+    };
+
+    /**
+     * This class represents a datagram with its addresses.
+     *
+     */
+    class Datagram
+    {
+        friend class DatagramIo;
+
+    public:
+        /**
+         * This method returns the payload of this datagram.
+         *
+         * @returns A pointer to the payload.
+         *
+         */
+        const uint8_t *GetPayload(void) const { return mPayload; }
+
+        /**
+         * This method returns the length of the payload.
+         *
+         * @returns Number of bytes of the payload.
+         *
+         */
+        uint16_t GetLength(void) const { return mLength; }
+
+        /**
+         * This method returns the address of the peer.
+         *
+         * @returns A reference to the source address of a received datagram, or the destination of a sent one.
+         *
+         */
+        const sockaddr_in6 &GetPeerAddress(void) const { return mPeer; }
+
+        /**
+         * This method returns whether the payload or control data of a received datagram was truncated.
+         *
+         * @retval  true    The datagram was truncated.
+         * @retval  false   The datagram was received completely.
+         *
+         */
+        bool IsTruncated(void) const { return (mHeader.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0; }
+
+        /**
+         * This method gets the local address of a received datagram from its IPV6_PKTINFO.
+         *
+         * @param[out]  aLocal      A reference to the local address, whose scope id is the receiving interface.
+         * @param[in]   aPort       The local port in host byte order.
+         *
+         * @retval  true    Found the local address.
+         * @retval  false   IPV6_PKTINFO is not present.
+         *
+         */
+        bool GetLocalAddress(sockaddr_in6 &aLocal, uint16_t aPort) const;
+
+    private:
+        void Prepare(void);
+
+        struct msghdr mHeader; ///< The message header passed to the socket.
+        struct iovec  mIov;    ///< The I/O vector referring to mPayload.
+        sockaddr_in6  mPeer;   ///< The peer address of the datagram.
+        union
+        {
+            size_t  mAlign;                                          ///< Aligns the control buffer.
+            uint8_t mBuffer[CMSG_SPACE(sizeof(struct in6_pktinfo))]; ///< The control message buffer.
+        } mControl;
+        uint16_t mLength;                      ///< Number of bytes of mPayload.
+        uint8_t  mPayload[kMaxSizeOfDatagram]; ///< The datagram payload.
+    };
+
+    /**
+     * The constructor to initialize the datagram I/O without a socket.
+     *
+     */
+    DatagramIo(void);
+
+    /**
+     * This method sets the socket, discarding datagrams queued for the previous one.
+     *
+     * @param[in]   aFd     The UDP socket, -1 to detach.
+     *
+     */
+    void SetFd(int aFd);
+
+    /**
+     * This method sets the max length of datagrams packing several payloads.
+     *
+     * A payload queued to the same peer from the same address as a datagram still queued is appended to it while the
+     * datagram stays within @p aLength, making fewer packets and syscalls. This is only suitable for payloads
+     * delimiting themselves, such as DTLS records.
+     *
+     * @param[in]   aLength     The max length of datagrams packing payloads, at most kMaxSizeOfDatagram, 0 to send
+     *                          each payload in a datagram of its own.
+     *
+     */
+    void SetMaxCoalescedLength(uint16_t aLength)
+    {
+        mMaxCoalescedLength = aLength < kMaxSizeOfDatagram ? aLength : static_cast<uint16_t>(kMaxSizeOfDatagram);
+    }
+
+    /**
+     * This method receives the ready datagrams without blocking.
+     *
+     * @returns Number of datagrams received, -1 on failure with errno set.
+     *
+     */
+    int Receive(void);
+
+    /**
+     * This method returns a datagram of the last batch received.
+     *
+     * @param[in]   aIndex  The index of the datagram, less than the return value of Receive().
+     *
+     * @returns A reference to the datagram.
+     *
+     */
+    const Datagram &GetReceived(int aIndex) const { return mRxDatagrams[aIndex]; }
+
+    /**
+     * This method queues a datagram to send, flushing the queue first if full.
+     *
+     * The payload may be appended to a datagram already queued, as SetMaxCoalescedLength() describes.
+     *
+     * @param[in]   aBuffer     A pointer to the payload.
+     * @param[in]   aLength     Number of bytes of @p aBuffer.
+     * @param[in]   aPeer       A reference to the destination address.
+     * @param[in]   aLocal      A reference to the source address, whose scope id is the sending interface.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully queued.
+     * @retval  OTBR_ERROR_ERRNO    Failed for the datagram is too long or there is no socket.
+     *
+     */
+    otbrError Send(const uint8_t *aBuffer, uint16_t aLength, const sockaddr_in6 &aPeer, const sockaddr_in6 &aLocal);
+
+    /**
+     * This method sends all queued datagrams without blocking.
+     *
+     * Datagrams the socket fails to accept are dropped, leaving recovery to the upper layer as plain UDP does.
+     *
+     * @returns Number of datagrams sent.
+     *
+     */
+    int Flush(void);
+
+    /**
+     * This method returns whether any datagram is queued to send.
+     *
+     * @retval  true    There are datagrams queued.
+     * @retval  false   The queue is empty.
+     *
+     */
+    bool HasPending(void) const { return mTxCount > 0; }
+
+private:
+    bool Coalesce(const uint8_t *aBuffer, uint16_t aLength, const sockaddr_in6 &aPeer, const sockaddr_in6 &aLocal);
+
+    int      mFd;
+    int      mTxCount;
+    uint16_t mMaxCoalescedLength;
+    Datagram mRxDatagrams[kMaxBatchSize];
+    Datagram mTxDatagrams[kMaxBatchSize];
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // DATAGRAM_IO_HPP_
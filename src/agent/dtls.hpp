@@ -35,7 +35,11 @@
 #define DTLS_HPP_
 
 #include <sys/select.h>
+#include <sys/uio.h>
 
+#include "common/output_scheduler.hpp"
+#include "common/reactor.hpp"
+#include "common/timer.hpp"
 #include "common/types.hpp"
 
 namespace ot {
@@ -53,6 +57,7 @@ namespace Dtls {
  * @{
  */
 
+class Client;
 class Server;
 class Session;
 
@@ -112,11 +117,32 @@ public:
      *
      * @param[in]   aBuffer         A pointer to plain data.
      * @param[in]   aLength         Number of bytes of @p aBuffer.
+     * @param[in]   aPriority       The priority of the data, as OutputScheduler serves them.
      *
-     * @returns number of bytes successfully sended, a negative value indicates failure.
+     * This method never blocks. Messages the socket is not ready for are queued and written once it becomes
+     * writable, ahead of queued ones of lower priority, up to a small bound per priority and session.
+     *
+     * @returns number of bytes successfully sent or queued, a negative value indicates failure and errno is set to
+     *          EAGAIN if the output queue of the priority is full.
      *
      */
-    virtual ssize_t Write(const uint8_t *aBuffer, uint16_t aLength) = 0;
+    virtual ssize_t Write(const uint8_t *aBuffer, uint16_t aLength, Priority aPriority = kPriorityControl) = 0;
+
+    /**
+     * This method sends data gathered from parts through the session, as a single record.
+     *
+     * The parts are encrypted straight into the record whenever the socket is ready, instead of being assembled into
+     * a buffer first. Otherwise the message is written as Write() does.
+     *
+     * @param[in]   aVector         A pointer to the parts of plain data.
+     * @param[in]   aCount          Number of parts in @p aVector.
+     * @param[in]   aPriority       The priority of the data, as OutputScheduler serves them.
+     *
+     * @returns number of bytes successfully sent or queued, a negative value indicates failure and errno is set to
+     *          EAGAIN if the output queue of the priority is full, EMSGSIZE if the data do not fit in a record.
+     *
+     */
+    virtual ssize_t WriteVector(const struct iovec *aVector, int aCount, Priority aPriority = kPriorityControl) = 0;
 
     /**
      * This method returns the exported KEK of this session.
@@ -126,6 +152,15 @@ public:
      */
     virtual const uint8_t *GetKek(void) = 0;
 
+    /**
+     * This method returns the address of the peer of this session.
+     *
+     * @param[out]  aIp6            A pointer to a buffer of 16 bytes to receive the IPv6 address.
+     * @param[out]  aPort           A reference to receive the UDP port.
+     *
+     */
+    virtual void GetPeerAddress(uint8_t *aIp6, uint16_t &aPort) const = 0;
+
     /**
      * This method closes the DTLS session.
      *
@@ -158,10 +193,18 @@ public:
      * @param[in]   aPort               The listening port of this DTLS server.
      * @param[in]   aStateHandler       A pointer to a function to be called when session state changed.
      * @param[in]   aContext            A pointer to application-specific context.
+     * @param[in]   aReactor            A pointer to the reactor to register sockets with, NULL to use
+     *                                  UpdateFdSet() and Process() only.
+     * @param[in]   aTimerWheel         A pointer to the timer wheel to schedule session timers with, NULL to
+     *                                  have them scheduled by UpdateFdSet() and Process().
      *
      * @returns pointer to the created the DTLS server.
      */
-    static Server *Create(uint16_t aPort, StateHandler aStateHandler, void *aContext);
+    static Server *Create(uint16_t     aPort,
+                          StateHandler aStateHandler,
+                          void *       aContext,
+                          Reactor *    aReactor    = NULL,
+                          TimerWheel * aTimerWheel = NULL);
 
     /**
      * This method destroy a DTLS server.
@@ -195,6 +238,183 @@ public:
      */
     virtual otbrError SetSeed(const uint8_t *aSeed, uint16_t aLength) = 0;
 
+    /**
+     * This method sets whether all sessions share the listening socket.
+     *
+     * By default, each session connects a socket of its own once it replies to the peer. With the shared socket,
+     * datagrams are routed to sessions by their source address and replies are sent from the listening socket.
+     * This method must be called before Start().
+     *
+     * @param[in]   aEnabled            Whether to share the listening socket.
+     *
+     */
+    virtual void SetSharedSocket(bool aEnabled) = 0;
+
+    /**
+     * This method sets whether the listening socket drops datagrams not starting with a DTLS record header.
+     *
+     * The filter runs in the kernel, so that junk traffic never wakes the service. Datagrams shorter than a record
+     * header, or of a content type or version other than DTLS 1.0 and 1.2 records carry, are dropped.
+     * This method must be called before Start().
+     *
+     * @param[in]   aEnabled            Whether to filter the datagrams of the listening socket.
+     *
+     */
+    virtual void SetRecordFilter(bool aEnabled) = 0;
+
+    /**
+     * This method sets the number of worker threads running DTLS handshakes.
+     *
+     * With workers, the handshake crypto of sessions sharing the listening socket runs off the mainloop, and only
+     * their I/O and state transitions run on it. Without the shared socket handshakes stay on the mainloop.
+     * This method must be called before Start().
+     *
+     * @param[in]   aCount              The number of worker threads, 0 to run handshakes on the mainloop.
+     *
+     */
+    virtual void SetHandshakeWorkers(unsigned int aCount) = 0;
+
+    /**
+     * This method sets the max number of sessions.
+     *
+     * Sessions are allocated on demand up to this limit and recycled once released, so this is also the high-water
+     * mark of session memory. New peers are dropped while the limit is reached. This method must be called before
+     * Start().
+     *
+     * @param[in]   aCount              The max number of sessions, must be greater than 0.
+     *
+     */
+    virtual void SetMaxSessions(unsigned int aCount) = 0;
+
+    /**
+     * This method sets whether handshakes of new peers are deferred, e.g. while the agent is overloaded.
+     *
+     * New peers are then answered with a HelloVerifyRequest, even with a valid cookie, so that nothing is allocated
+     * for them. They retransmit their ClientHello with the new cookie and are accepted once handshakes are no longer
+     * deferred. Established and handshaking sessions are not affected.
+     *
+     * @param[in]   aDeferred           Whether to defer handshakes of new peers.
+     *
+     */
+    virtual void SetHandshakesDeferred(bool aDeferred) = 0;
+
+    /**
+     * This method sets the time sessions are kept without receiving anything.
+     *
+     * Once the max number of sessions is reached, the least recently active session idle for a while is evicted for
+     * a new peer. New timeouts apply from the next datagram received by each session.
+     *
+     * @param[in]   aHandshakeTimeout   The timeout of handshaking sessions in milliseconds, 0 to keep it.
+     * @param[in]   aIdleTimeout        The timeout of established sessions in milliseconds, 0 to keep it.
+     *
+     */
+    virtual void SetSessionTimeouts(uint32_t aHandshakeTimeout, uint32_t aIdleTimeout) = 0;
+
+    /**
+     * This method sets the size and timeout of the session cache.
+     *
+     * Peers offering a cached session resume it with an abbreviated handshake instead of a full EC-JPAKE one.
+     * Cached sessions are dropped once the PSK changes. This method must be called before Start().
+     *
+     * @param[in]   aMaxEntries         The max number of cached sessions, 0 to disable resumption.
+     * @param[in]   aTimeout            The lifetime of cached sessions in seconds, 0 for no timeout.
+     *
+     */
+    virtual void SetSessionCache(unsigned int aMaxEntries, uint32_t aTimeout) = 0;
+
+    /**
+     * This method sets the retransmission timeouts of handshakes.
+     *
+     * The timeout starts at @p aMin and doubles on each retransmission of a flight, the handshake fails once it
+     * exceeds @p aMax. Lossy links complete handshakes sooner with a lower @p aMin. This method must be called before
+     * Start().
+     *
+     * @param[in]   aMin                The initial timeout in milliseconds, 0 to keep it.
+     * @param[in]   aMax                The max timeout in milliseconds, 0 to keep it.
+     *
+     */
+    virtual void SetRetransmissionTimeouts(uint32_t aMin, uint32_t aMax) = 0;
+
+    /**
+     * This method sets the MTU of the path to peers.
+     *
+     * Records to a peer queued at once, such as the messages of a handshake flight, are grouped into datagrams
+     * fitting the MTU. Records larger than the MTU are still sent in a datagram of their own, and counted by the
+     * dtls.oversized_datagrams metric, as mbedtls does not fragment handshake messages. This method must be called
+     * before Start().
+     *
+     * @param[in]   aMtu                The MTU in bytes, including the IPv6 and UDP headers, 0 to never group
+     *                                  records.
+     *
+     */
+    virtual void SetMtu(uint16_t aMtu) = 0;
+
+    /**
+     * This method returns the counters of the session cache.
+     *
+     * @param[out]  aHits               The number of sessions resumed.
+     * @param[out]  aMisses             The number of sessions offered by peers but not found.
+     *
+     */
+    virtual void GetSessionCacheCounters(uint32_t &aHits, uint32_t &aMisses) = 0;
+
+    /**
+     * This struct represents the state of a session, as reported by GetSessions().
+     *
+     */
+    struct SessionInfo
+    {
+        uint8_t        mPeerAddress[16];  ///< The IPv6 address of the peer.
+        uint16_t       mPeerPort;         ///< The UDP port of the peer.
+        Session::State mState;            ///< The state of the session.
+        bool           mOffloaded;        ///< Whether the handshake is running on a worker.
+        uint32_t       mAge;              ///< Milliseconds since the session started.
+        uint32_t       mIdleTime;         ///< Milliseconds since the session last received a datagram.
+        uint64_t       mRxBytes;          ///< Bytes of application data received.
+        uint64_t       mTxBytes;          ///< Bytes of application data sent or queued.
+        uint64_t       mHandshakeCpuTime; ///< Microseconds of CPU time spent handshaking, on the mainloop or workers.
+        uint64_t       mRecordCpuTime;    ///< Microseconds of CPU time spent reading and writing records.
+        uint64_t       mHandlerCpuTime;   ///< Microseconds of CPU time spent in the data handler, such as CoAP.
+    };
+
+    /**
+     * This method returns the state of the sessions in use.
+     *
+     * @param[out]  aInfos              A pointer to an array to receive the state of the sessions.
+     * @param[in]   aMaxInfos           The number of entries of @p aInfos.
+     *
+     * @returns The number of sessions in use, which may be more than @p aMaxInfos.
+     *
+     */
+    virtual unsigned int GetSessions(SessionInfo *aInfos, unsigned int aMaxInfos) const = 0;
+
+    /**
+     * This struct represents the CPU time of the sessions of a peer, as reported by GetPeers().
+     *
+     */
+    struct PeerInfo
+    {
+        uint8_t  mPeerAddress[16];  ///< The IPv6 address of the peer.
+        uint32_t mSessions;         ///< Number of sessions of the peer, released or in use.
+        uint64_t mHandshakeCpuTime; ///< Microseconds of CPU time spent handshaking.
+        uint64_t mRecordCpuTime;    ///< Microseconds of CPU time spent reading and writing records.
+        uint64_t mHandlerCpuTime;   ///< Microseconds of CPU time spent in the data handler.
+    };
+
+    /**
+     * This method returns the CPU time of the sessions of each peer, whatever its port.
+     *
+     * Released sessions are accounted to a table of limited size, the peer with the least CPU time is replaced by a
+     * new one once full, so that peers consuming the most are kept.
+     *
+     * @param[out]  aInfos              A pointer to an array to receive the peers.
+     * @param[in]   aMaxInfos           The number of entries of @p aInfos.
+     *
+     * @returns The number of peers, which may be more than @p aMaxInfos.
+     *
+     */
+    virtual unsigned int GetPeers(PeerInfo *aInfos, unsigned int aMaxInfos) const = 0;
+
     /**
      * This method starts the DTLS service.
      *
@@ -209,6 +429,8 @@ public:
      * This method updates the fd_set and timeout for mainloop. @p aTimeout should
      * only be updated if the DTLS service has pending process in less than its current value.
      *
+     * When a reactor is used, only @p aTimeout is updated.
+     *
      * @param[inout]    aReadFdSet      A reference to fd_set for polling read.
      * @param[inout]    aWriteFdSet     A reference to fd_set for polling write.
      * @param[inout]    aErrorFdSet     A reference to fd_set for polling error.
@@ -235,6 +457,159 @@ public:
     virtual ~Server(void) {}
 };
 
+/**
+ * This interface defines DTLS client functionality.
+ *
+ * A client connects one session to a DTLS server without ever blocking: the handshake and the records received are
+ * processed as its socket becomes readable, and handshake retransmissions are scheduled by UpdateFdSet(), so that a
+ * single thread drives many clients.
+ *
+ */
+class Client
+{
+public:
+    /**
+     * This function pointer is called when the state of the client changed.
+     *
+     * @param[in]   aClient             The DTLS client whose state changed.
+     * @param[in]   aState              The new state.
+     * @param[in]   aContext            A pointer to application-specific context.
+     *
+     */
+    typedef void (*StateHandler)(Client &aClient, Session::State aState, void *aContext);
+
+    /**
+     * This method creates a DTLS client.
+     *
+     * @param[in]   aStateHandler       A pointer to a function to be called when the client state changed.
+     * @param[in]   aContext            A pointer to application-specific context.
+     *
+     * @returns pointer to the created DTLS client.
+     */
+    static Client *Create(StateHandler aStateHandler, void *aContext);
+
+    /**
+     * This method destroys a DTLS client, without notifying the peer.
+     *
+     * @param[in]   aClient             A pointer to the DTLS client to be destroyed.
+     *
+     */
+    static void Destroy(Client *aClient);
+
+    /**
+     * This method updates the PSK of TLS_ECJPAKE_WITH_AES_128_CCM_8 used by this client.
+     *
+     * This method must be called before Connect().
+     *
+     * @param[in]   aPSK                A pointer to the PSK buffer.
+     * @param[in]   aLength             The length of the PSK.
+     *
+     * @retval      OTBR_ERROR_NONE     Successfully set PSK.
+     * @retval      OTBR_ERROR_ERRNO    Failed for the given PSK is too long.
+     *
+     */
+    virtual otbrError SetPSK(const uint8_t *aPSK, uint8_t aLength) = 0;
+
+    /**
+     * This method sets the retransmission timeouts of the handshake.
+     *
+     * The timeout starts at @p aMin and doubles on each retransmission, the handshake fails once it exceeds
+     * @p aMax. This method must be called before Connect().
+     *
+     * @param[in]   aMin                The initial timeout in milliseconds.
+     * @param[in]   aMax                The max timeout in milliseconds.
+     *
+     */
+    virtual void SetHandshakeTimeouts(uint32_t aMin, uint32_t aMax) = 0;
+
+    /**
+     * This method sets the data handler for this client.
+     *
+     * @param[in]   aDataHandler        A pointer to the function to be called when decrypted data ready.
+     * @param[in]   aContext            A pointer to application-specific context.
+     *
+     */
+    virtual void SetDataHandler(Session::DataHandler aDataHandler, void *aContext) = 0;
+
+    /**
+     * This method connects to a DTLS server and starts the handshake.
+     *
+     * The state handler is called with kStateReady once the handshake completes, or kStateError if it fails.
+     *
+     * @param[in]   aHost               A pointer to the host name or address of the server.
+     * @param[in]   aPort               A pointer to the UDP port of the server.
+     *
+     * @retval      OTBR_ERROR_NONE     Successfully started the handshake.
+     * @retval      OTBR_ERROR_ERRNO    Failed to connect for system error.
+     * @retval      OTBR_ERROR_DTLS     Failed to start the handshake for DTLS error.
+     *
+     */
+    virtual otbrError Connect(const char *aHost, const char *aPort) = 0;
+
+    /**
+     * This method sends data through the session of this client.
+     *
+     * @param[in]   aBuffer             A pointer to plain data.
+     * @param[in]   aLength             Number of bytes of @p aBuffer.
+     *
+     * @returns number of bytes successfully sent, a negative value indicates failure and errno is set to EAGAIN if
+     *          the socket is not ready.
+     *
+     */
+    virtual ssize_t Write(const uint8_t *aBuffer, uint16_t aLength) = 0;
+
+    /**
+     * This method returns the exported KEK of this client.
+     *
+     * @returns A pointer to the KEK data, valid once ready.
+     *
+     */
+    virtual const uint8_t *GetKek(void) const = 0;
+
+    /**
+     * This method returns the state of this client.
+     *
+     * @returns The state of the session of this client.
+     *
+     */
+    virtual Session::State GetState(void) const = 0;
+
+    /**
+     * This method notifies the peer and closes the session of this client, the state handler is not called.
+     *
+     */
+    virtual void Close(void) = 0;
+
+    /**
+     * This method updates the fd_set and timeout for mainloop. @p aTimeout should
+     * only be updated if the client has pending process in less than its current value.
+     *
+     * @param[inout]    aReadFdSet      A reference to fd_set for polling read.
+     * @param[inout]    aWriteFdSet     A reference to fd_set for polling write.
+     * @param[inout]    aErrorFdSet     A reference to fd_set for polling error.
+     * @param[inout]    aMaxFd          A reference to the current max fd in @p aReadFdSet and @p aWriteFdSet.
+     * @param[inout]    aTimeout        A reference to the timeout.
+     *
+     */
+    virtual void UpdateFdSet(fd_set & aReadFdSet,
+                             fd_set & aWriteFdSet,
+                             fd_set & aErrorFdSet,
+                             int &    aMaxFd,
+                             timeval &aTimeout) = 0;
+
+    /**
+     * This method performs the DTLS processing.
+     *
+     * @param[in]   aReadFdSet          A reference to fd_set ready for reading.
+     * @param[in]   aWriteFdSet         A reference to fd_set ready for writing.
+     * @param[in]   aErrorFdSet         A reference to fd_set with error occurred.
+     *
+     */
+    virtual void Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet) = 0;
+
+    virtual ~Client(void) {}
+};
+
 /**
  * @}
  */
@@ -30,18 +30,27 @@
  * This file implements the DTLS service.
  */
 
-#include "dtls_mbedtls.hpp"
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_DTLS
 
-#include <algorithm>
+#include "dtls_mbedtls.hpp"
 
 #include <assert.h>
 #include <errno.h>
+#include <linux/filter.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include "otbr-config.h"
+
+#include <mbedtls/entropy.h>
+#include <mbedtls/ssl_internal.h>
+
 #include "common/code_utils.hpp"
 #include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/probes.hpp"
 #include "common/time.hpp"
+#include "common/timeline.hpp"
 #include "common/types.hpp"
 
 namespace ot {
@@ -50,6 +59,143 @@ namespace BorderRouter {
 
 namespace Dtls {
 
+enum
+{
+    kLogSampleRate = 64, ///< One of this many per-datagram logs is written.
+};
+
+static Metrics::Histogram sHandshakeTime("dtls.handshake_us");
+static Metrics::Counter   sHandshakeFailures("dtls.handshake_failures");
+static Metrics::Histogram sHandshakeFailedTime("dtls.handshake_failed_us");
+static Metrics::Histogram sHandshakeRetransmissions("dtls.handshake_retransmissions");
+static Metrics::Histogram sHandshakeCpuTime("dtls.handshake_cpu_us");
+static Metrics::Counter   sRecordCpuTime("dtls.record_cpu_us");
+static Metrics::Counter   sHandlerCpuTime("dtls.handler_cpu_us");
+static Metrics::Counter   sOversizedDatagrams("dtls.oversized_datagrams");
+static Metrics::Gauge     sSessionsInUse("dtls.sessions");
+static Metrics::Memory    sSessionMemory("memory.dtls_sessions");
+static Metrics::Counter   sHandshakeTimeouts("dtls.evicted_handshake_timeout");
+static Metrics::Counter   sIdleTimeouts("dtls.evicted_idle_timeout");
+static Metrics::Counter   sIdleEvictions("dtls.evicted_lru");
+static Metrics::Counter   sDeferredHandshakes("dtls.deferred_handshakes");
+static Metrics::Counter   sGatheredRecords("dtls.gathered_records");
+
+// The mbedtls round one hook is process wide, so the pool is too.
+static EcjpakePool sEcjpakePool;
+
+/**
+ * Random generation, shared by all servers of the process.
+ *
+ * A single entropy source seeds a DRBG per thread, so that servers on several threads and handshakes on workers
+ * generate random numbers without contention. The entropy source is only locked to seed and reseed them.
+ *
+ */
+static pthread_once_t          sRandomOnce  = PTHREAD_ONCE_INIT;
+static pthread_key_t           sRandomKey;
+static bool                    sRandomReady = false;
+static pthread_mutex_t         sEntropyLock = PTHREAD_MUTEX_INITIALIZER;
+static mbedtls_entropy_context sEntropy;
+
+static void FreeThreadRandom(void *aDrbg)
+{
+    mbedtls_ctr_drbg_context *drbg = static_cast<mbedtls_ctr_drbg_context *>(aDrbg);
+
+    mbedtls_ctr_drbg_free(drbg);
+    delete drbg;
+}
+
+static void InitRandom(void)
+{
+    mbedtls_entropy_init(&sEntropy);
+    sRandomReady = (pthread_key_create(&sRandomKey, FreeThreadRandom) == 0);
+}
+
+static int GetEntropy(void *aContext, unsigned char *aBuffer, size_t aLength)
+{
+    int rval;
+
+    pthread_mutex_lock(&sEntropyLock);
+    rval = mbedtls_entropy_func(&sEntropy, aBuffer, aLength);
+    pthread_mutex_unlock(&sEntropyLock);
+
+    (void)aContext;
+
+    return rval;
+}
+
+static mbedtls_ctr_drbg_context *GetThreadRandom(void)
+{
+    mbedtls_ctr_drbg_context *drbg = NULL;
+    pthread_t                 self = pthread_self();
+
+    pthread_once(&sRandomOnce, InitRandom);
+    VerifyOrExit(sRandomReady);
+    VerifyOrExit((drbg = static_cast<mbedtls_ctr_drbg_context *>(pthread_getspecific(sRandomKey))) == NULL);
+
+    drbg = new mbedtls_ctr_drbg_context;
+    mbedtls_ctr_drbg_init(drbg);
+
+    // Personalized with the thread, the DRBG reseeds itself from the shared entropy source.
+    if (mbedtls_ctr_drbg_seed(drbg, GetEntropy, NULL, reinterpret_cast<const unsigned char *>(&self), sizeof(self)) ||
+        pthread_setspecific(sRandomKey, drbg))
+    {
+        FreeThreadRandom(drbg);
+        drbg = NULL;
+    }
+
+exit:
+    return drbg;
+}
+
+// Setting up the SSL context allocates the input and the output records.
+static const size_t kSslBuffersSize = 2 * MBEDTLS_SSL_BUFFER_LEN;
+
+/**
+ * This function returns the max fragment length code fitting the record buffers, see --with-dtls-record-size.
+ *
+ * Clients request it from the peer, so that no record exceeds the buffers. Servers only bound the records they send
+ * with it, as DTLS 1.2 servers cannot request it.
+ *
+ */
+static unsigned char GetMaxFragmentCode(void)
+{
+    unsigned char code = MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+
+    // The codes from 512 to 4096 stand for 2^9 to 2^12 bytes.
+    if (MBEDTLS_SSL_MAX_CONTENT_LEN < 16384)
+    {
+        code = MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+
+        while (code > MBEDTLS_SSL_MAX_FRAG_LEN_512 && (256U << code) > MBEDTLS_SSL_MAX_CONTENT_LEN)
+        {
+            --code;
+        }
+    }
+
+    return code;
+}
+
+// The session running mbedtls_ssl_handshake() on this thread, for exporting keys.
+static __thread MbedtlsSession *sHandshakingSession = NULL;
+
+static uint32_t ReadUint24(const uint8_t *aBuffer)
+{
+    return (static_cast<uint32_t>(aBuffer[0]) << 16) | (static_cast<uint32_t>(aBuffer[1]) << 8) | aBuffer[2];
+}
+
+static void WriteUint24(uint8_t *aBuffer, uint32_t aValue)
+{
+    aBuffer[0] = static_cast<uint8_t>(aValue >> 16);
+    aBuffer[1] = static_cast<uint8_t>(aValue >> 8);
+    aBuffer[2] = static_cast<uint8_t>(aValue);
+}
+
+static void WriteUint16(uint8_t *aBuffer, uint16_t aValue)
+{
+    aBuffer[0] = static_cast<uint8_t>(aValue >> 8);
+    aBuffer[1] = static_cast<uint8_t>(aValue);
+}
+
 static void MbedtlsDebug(void *aContext, int aLevel, const char *aFile, int aLine, const char *aMessage)
 {
     // Debug levels of mbedtls from mbedtls documentation.
@@ -77,6 +223,10 @@ static void MbedtlsDebug(void *aContext, int aLevel, const char *aFile, int aLin
         aLevel = OTBR_LOG_DEBUG;
         break;
     }
+
+    // The threshold may lag behind a change of the log level until the next datagram.
+    VerifyOrExit(otbrLogEnabled(aLevel));
+
     char buf[100];
     /* mbed inserts a EOL
      * And so does the otbrLog()
@@ -102,12 +252,60 @@ static void MbedtlsDebug(void *aContext, int aLevel, const char *aFile, int aLin
     }
 
     otbrLog(aLevel, "%s:%04d: %s", aFile, aLine, buf);
+
+exit:
     (void)aContext;
 }
 
-Server *Server::Create(uint16_t aPort, StateHandler aStateHandler, void *aContext)
+// The log level the mbedtls debug threshold was last set for, -1 if never.
+static int sDebugLogLevel = -1;
+
+/**
+ * This function sets the mbedtls debug threshold to the current log level, so that mbedtls does not format debug
+ * messages which would be discarded.
+ *
+ */
+static void UpdateDebugThreshold(void)
+{
+    int level     = otbrLogGetModuleLevel(OTBR_LOG_MODULE);
+    int threshold = 0;
+
+    VerifyOrExit(level != __atomic_load_n(&sDebugLogLevel, __ATOMIC_RELAXED));
+    __atomic_store_n(&sDebugLogLevel, level, __ATOMIC_RELAXED);
+
+    level = level < OTBR_LOG_LEVEL_MAX ? level : OTBR_LOG_LEVEL_MAX;
+
+    // The reverse of the mapping of MbedtlsDebug().
+    if (level >= OTBR_LOG_DEBUG)
+    {
+        threshold = 4;
+    }
+    else if (level >= OTBR_LOG_INFO)
+    {
+        threshold = 3;
+    }
+    else if (level >= OTBR_LOG_WARNING)
+    {
+        threshold = 2;
+    }
+    else if (level >= OTBR_LOG_ERR)
+    {
+        threshold = 1;
+    }
+
+    mbedtls_debug_set_threshold(threshold);
+
+exit:
+    return;
+}
+
+Server *Server::Create(uint16_t     aPort,
+                       StateHandler aStateHandler,
+                       void *       aContext,
+                       Reactor *    aReactor,
+                       TimerWheel * aTimerWheel)
 {
-    return new MbedtlsServer(aPort, aStateHandler, aContext);
+    return new MbedtlsServer(aPort, aStateHandler, aContext, aReactor, aTimerWheel);
 }
 
 void Server::Destroy(Server *aServer)
@@ -123,37 +321,79 @@ otbrError MbedtlsServer::Start(void)
 
     mbedtls_ssl_config_init(&mConf);
     mbedtls_ssl_cookie_init(&mCookie);
-#if defined(MBEDTLS_SSL_CACHE_C)
-    mbedtls_ssl_cache_init(&mCache);
-#endif
-    mbedtls_entropy_init(&mEntropy);
-    mbedtls_ctr_drbg_init(&mCtrDrbg);
 
-    // Allow all debug message here and filter in MbedtlsDebug().
-    mbedtls_debug_set_threshold(4);
+    UpdateDebugThreshold();
 
-    SuccessOrExit(error = mbedtls_ctr_drbg_seed(&mCtrDrbg, mbedtls_entropy_func, &mEntropy, mSeed, mSeedLength));
+    {
+        mbedtls_ctr_drbg_context *drbg = GetThreadRandom();
+
+        VerifyOrExit(drbg != NULL, error = MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED);
+
+        // The seed, e.g. the EUI-64, is mixed into the random generator of this thread.
+        mbedtls_ctr_drbg_update(drbg, mSeed, mSeedLength);
+    }
 
     SuccessOrExit(error = mbedtls_ssl_config_defaults(&mConf, MBEDTLS_SSL_IS_SERVER, MBEDTLS_SSL_TRANSPORT_DATAGRAM,
                                                       MBEDTLS_SSL_PRESET_DEFAULT));
 
-    mbedtls_ssl_conf_rng(&mConf, mbedtls_ctr_drbg_random, &mCtrDrbg);
+    mbedtls_ssl_conf_rng(&mConf, HandleRandom, this);
     mbedtls_ssl_conf_min_version(&mConf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
     mbedtls_ssl_conf_max_version(&mConf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
     mbedtls_ssl_conf_dbg(&mConf, MbedtlsDebug, this);
     mbedtls_ssl_conf_ciphersuites(&mConf, ciphersuites);
     mbedtls_ssl_conf_read_timeout(&mConf, 0);
+    mbedtls_ssl_conf_handshake_timeout(&mConf, mRetransmissionTimeoutMin, mRetransmissionTimeoutMax);
+    mbedtls_ssl_conf_export_keys_cb(&mConf, MbedtlsSession::ExportKeys, NULL);
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    SuccessOrExit(error = mbedtls_ssl_conf_max_frag_len(&mConf, GetMaxFragmentCode()));
+#endif
 
 #if defined(MBEDTLS_SSL_CACHE_C)
-    mbedtls_ssl_conf_session_cache(&mConf, &mCache, mbedtls_ssl_cache_get, mbedtls_ssl_cache_set);
+    if (mCacheEntries > 0)
+    {
+        mbedtls_ssl_cache_set_max_entries(&mCache, static_cast<int>(mCacheEntries));
+        mbedtls_ssl_cache_set_timeout(&mCache, static_cast<int>(mCacheTimeout));
+        mbedtls_ssl_conf_session_cache(&mConf, this, HandleCacheGet, HandleCacheSet);
+    }
+#else
+    if (mCacheEntries > 0)
+    {
+        otbrLog(OTBR_LOG_INFO, "DTLS session cache is not supported, resumption disabled.");
+    }
 #endif
 
-    SuccessOrExit(error = mbedtls_ssl_cookie_setup(&mCookie, mbedtls_ctr_drbg_random, &mCtrDrbg));
+    // Released sessions are kept up to the session limit, so that releasing them never allocates.
+    mFreeSessions.reserve(mMaxSessions);
+    mPeers.reserve(kMaxPeers);
+
+    SuccessOrExit(error = mbedtls_ssl_cookie_setup(&mCookie, HandleRandom, this));
 
-    mbedtls_ssl_conf_dtls_cookies(&mConf, mbedtls_ssl_cookie_write, mbedtls_ssl_cookie_check, &mCookie);
+    mbedtls_ssl_conf_dtls_cookies(&mConf, HandleCookieWrite, HandleCookieCheck, this);
 
     SuccessOrExit(ret = Bind());
 
+    if (mHandshakeWorkers > 0 && !mSharedSocket)
+    {
+        otbrLog(OTBR_LOG_WARNING, "DTLS handshake workers require the shared socket, handshaking on mainloop.");
+    }
+    else if (mHandshakeWorkers > 0)
+    {
+        SuccessOrExit(ret = mWorkerPool.Start(mHandshakeWorkers));
+
+        if (mReactor != NULL)
+        {
+            SuccessOrExit(ret = mReactor->Add(mWorkerWatch, mWorkerPool.GetFd(), Reactor::kEventReadable,
+                                              HandleWorkerPool, this, "dtls-workers"));
+        }
+    }
+
+    if (sEcjpakePool.Init(OTBR_CAPACITY_ECJPAKE_KEYS) == OTBR_ERROR_NONE)
+    {
+        sEcjpakePool.Install();
+    }
+
+    SchedulePrecompute();
+
 exit:
 
     if (error != 0)
@@ -165,6 +405,41 @@ exit:
     return ret;
 }
 
+/**
+ * UDP socket filters see datagrams from their UDP header on, so the DTLS record header starts past it. Only datagrams
+ * holding at least a record header, of a content type from change cipher spec to application data and of the
+ * DTLS 1.0 or 1.2 version, are accepted whole.
+ *
+ */
+int MbedtlsServer::AttachRecordFilter(int aFd)
+{
+    enum
+    {
+        kUdpHeaderSize = 8,
+        kFilterAccept  = 0xffffffff,
+        kFilterDrop    = 0,
+    };
+
+    static struct sock_filter sCode[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_LEN, 0),
+        BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, kUdpHeaderSize + kRecordHeaderSize, 0, 6),
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, kUdpHeaderSize),
+        BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, kContentTypeChangeCipherSpec, 0, 4),
+        BPF_JUMP(BPF_JMP | BPF_JGT | BPF_K, kContentTypeApplicationData, 3, 0),
+        BPF_STMT(BPF_LD | BPF_H | BPF_ABS, kUdpHeaderSize + 1),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, kDtlsVersion12, 2, 0),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, kDtlsVersion10, 1, 0),
+        BPF_STMT(BPF_RET | BPF_K, kFilterDrop),
+        BPF_STMT(BPF_RET | BPF_K, kFilterAccept),
+    };
+    struct sock_fprog program;
+
+    program.len    = sizeof(sCode) / sizeof(sCode[0]);
+    program.filter = sCode;
+
+    return setsockopt(aFd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program));
+}
+
 otbrError MbedtlsServer::Bind(void)
 {
     otbrError           ret = OTBR_ERROR_ERRNO;
@@ -182,6 +457,23 @@ otbrError MbedtlsServer::Bind(void)
     SuccessOrExit(setsockopt(mSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)));
     SuccessOrExit(bind(mSocket, reinterpret_cast<struct sockaddr *>(&sin6), sizeof(sin6)));
 
+    // Without the filter, junk datagrams are dropped in user space as before.
+    if (mRecordFilter && AttachRecordFilter(mSocket) != 0)
+    {
+        otbrLog(OTBR_LOG_WARNING, "DTLS failed to attach socket filter: %s", strerror(errno));
+    }
+
+    if (mReactor != NULL)
+    {
+        SuccessOrExit(mReactor->Add(mWatch, mSocket, Reactor::kEventReadable, HandleReactor, this, "dtls-server"));
+    }
+
+    mIo.SetFd(mSocket);
+
+    // Records to a peer queued in the same mainloop iteration, such as relayed messages or a handshake flight, share
+    // datagrams fitting the MTU.
+    mIo.SetMaxCoalescedLength(mMtu > kIp6UdpHeaderSize ? static_cast<uint16_t>(mMtu - kIp6UdpHeaderSize) : 0);
+
     otbrLog(OTBR_LOG_INFO, "DTLS bound to port %u.", mPort);
     ret = OTBR_ERROR_NONE;
 
@@ -198,6 +490,11 @@ void MbedtlsSession::SetState(State aState)
 {
     mState = aState;
     mServer.HandleSessionState(*this, aState);
+
+    if (!IsAlive())
+    {
+        mServer.ScheduleRelease();
+    }
 }
 
 void MbedtlsSession::SetDataHandler(DataHandler aDataHandler, void *aContext)
@@ -206,29 +503,193 @@ void MbedtlsSession::SetDataHandler(DataHandler aDataHandler, void *aContext)
     mDataHandler = aDataHandler;
 }
 
-ssize_t MbedtlsSession::Write(const uint8_t *aBuffer, uint16_t aLength)
+void MbedtlsSession::GetPeerAddress(uint8_t *aIp6, uint16_t &aPort) const
 {
-    int ret;
+    memcpy(aIp6, &mRemoteSock.sin6_addr, sizeof(mRemoteSock.sin6_addr));
+    aPort = ntohs(mRemoteSock.sin6_port);
+}
 
-    do
+ssize_t MbedtlsSession::Write(const uint8_t *aBuffer, uint16_t aLength, Priority aPriority)
+{
+    int      ret;
+    uint16_t length;
+    uint64_t cpuTime;
+
+    // Records are only written once ready, never while handshaking on a worker.
+    VerifyOrExit(!mOffloaded, ret = -1, errno = EAGAIN);
+
+    // Messages of a priority are written in order, so new ones wait behind the queued ones.
+    if (!mTxQueue.IsEmpty())
+    {
+        VerifyOrExit(mTxQueue.Push(aPriority, aBuffer, aLength), ret = -1, errno = EAGAIN);
+        mTxBytes += aLength;
+        ExitNow(ret = aLength);
+    }
+
+    cpuTime = GetThreadCpuTimeUs();
+    ret     = mbedtls_ssl_write(&mSsl, aBuffer, aLength);
+    AddRecordCpuTime(cpuTime);
+
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+        // mbedtls keeps the record and must be called again with the same message, so it is kept at the front.
+        VerifyOrExit(InitTxQueue() && mTxQueue.Push(aPriority, aBuffer, aLength), ret = -1, errno = ENOMEM);
+        mTxQueue.GetFront(length);
+        WatchWritable(true);
+        ret = aLength;
+    }
+    else if (ret < 0)
+    {
+        otbrLog(OTBR_LOG_ERR, "DTLS write error: -0x%04x!", -ret);
+        SetState(kStateError);
+        errno = EIO;
+        ExitNow();
+    }
+
+    mTxBytes += static_cast<uint64_t>(ret);
+
+exit:
+    return ret;
+}
+
+// mbedtls_ssl_write() may renegotiate or split records, these are then only written by it.
+#if defined(MBEDTLS_SSL_RENEGOTIATION) || defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
+static const bool kGatherRecords = false;
+#else
+static const bool kGatherRecords = true;
+#endif
+
+// Copies the parts one after another into aBuffer, which holds at least their total length.
+static void Gather(const struct iovec *aVector, int aCount, uint8_t *aBuffer)
+{
+    for (int i = 0; i < aCount; ++i)
+    {
+        memcpy(aBuffer, aVector[i].iov_base, aVector[i].iov_len);
+        aBuffer += aVector[i].iov_len;
+    }
+}
+
+ssize_t MbedtlsSession::WriteVector(const struct iovec *aVector, int aCount, Priority aPriority)
+{
+    int      ret;
+    size_t   length = 0;
+    uint16_t front;
+    uint64_t cpuTime;
+    uint8_t  buffer[kMaxSizeOfRecord];
+
+    for (int i = 0; i < aCount; ++i)
+    {
+        length += aVector[i].iov_len;
+    }
+
+    VerifyOrExit(length <= kMaxSizeOfRecord && length <= mbedtls_ssl_get_max_frag_len(&mSsl), ret = -1,
+                 errno = EMSGSIZE);
+
+    // Only an idle session ready for application data takes the parts straight into its record, mbedtls_ssl_write()
+    // otherwise handshakes or flushes the pending record first.
+    if (!kGatherRecords || mOffloaded || !mTxQueue.IsEmpty() || mSsl.state != MBEDTLS_SSL_HANDSHAKE_OVER ||
+        mSsl.out_left != 0)
     {
-        ret = mbedtls_ssl_write(&mSsl, aBuffer, aLength);
-    } while (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+        Gather(aVector, aCount, buffer);
+        ExitNow(ret = Write(buffer, static_cast<uint16_t>(length), aPriority));
+    }
+
+    // What mbedtls_ssl_write() does, but the parts are gathered in the record instead of the message.
+    cpuTime = GetThreadCpuTimeUs();
+    Gather(aVector, aCount, mSsl.out_msg);
+    mSsl.out_msglen  = length;
+    mSsl.out_msgtype = MBEDTLS_SSL_MSG_APPLICATION_DATA;
+    ret              = mbedtls_ssl_write_record(&mSsl);
+    AddRecordCpuTime(cpuTime);
 
-    if (ret < 0)
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
     {
+        // The record is kept by mbedtls, which only flushes it when FlushWrites() writes the front again.
+        Gather(aVector, aCount, buffer);
+        VerifyOrExit(InitTxQueue() && mTxQueue.Push(aPriority, buffer, static_cast<uint16_t>(length)), ret = -1,
+                     errno = ENOMEM);
+        mTxQueue.GetFront(front);
+        WatchWritable(true);
+    }
+    else if (ret != 0)
+    {
+        otbrLog(OTBR_LOG_ERR, "DTLS write error: -0x%04x!", -ret);
         SetState(kStateError);
+        errno = EIO;
+        ExitNow(ret = -1);
     }
 
+    sGatheredRecords.Add();
+    mTxBytes += length;
+    ret = static_cast<int>(length);
+
+exit:
     return ret;
 }
 
+void MbedtlsSession::FlushWrites(void)
+{
+    int            ret = 0;
+    const uint8_t *message;
+    uint16_t       length;
+
+    while ((message = mTxQueue.GetFront(length)) != NULL)
+    {
+        ret = mbedtls_ssl_write(&mSsl, message, length);
+        VerifyOrExit(ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE);
+        VerifyOrExit(ret >= 0, mTxQueue.Clear());
+
+        mTxQueue.Pop();
+    }
+
+exit:
+    if (mTxQueue.IsEmpty())
+    {
+        WatchWritable(false);
+    }
+
+    if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+        otbrLog(OTBR_LOG_ERR, "DTLS write error: -0x%04x!", -ret);
+        SetState(kStateError);
+    }
+}
+
+void MbedtlsSession::WatchWritable(bool aEnabled)
+{
+    VerifyOrExit(mWatch.mFd >= 0);
+
+    if (mServer.mReactor->Modify(mWatch, Reactor::kEventReadable | (aEnabled ? Reactor::kEventWritable : 0)))
+    {
+        otbrLog(OTBR_LOG_WARNING, "DTLS session [%d] failed to watch writable: %s", mWatch.mFd, strerror(errno));
+    }
+
+exit:
+    return;
+}
+
 void MbedtlsSession::Close(void)
 {
+    int ret;
+
     VerifyOrExit(mState != kStateError && mState != kStateEnd);
+    VerifyOrExit(!mOffloaded, mCloseRequested = true);
+
+    if (!mTxQueue.IsEmpty())
+    {
+        otbrLog(OTBR_LOG_WARNING, "DTLS session closed with %u messages not sent.", mTxQueue.GetCount());
+        mTxQueue.Clear();
+        WatchWritable(false);
+    }
+
+    // The alert is best effort, the session never waits for the socket.
+    ret = mbedtls_ssl_close_notify(&mSsl);
+
+    if (ret != 0)
+    {
+        otbrLog(OTBR_LOG_WARNING, "DTLS failed to send close notify: -0x%04x.", -ret);
+    }
 
-    while (mbedtls_ssl_close_notify(&mSsl) == MBEDTLS_ERR_SSL_WANT_WRITE)
-        ;
     SetState(kStateEnd);
 
 exit:
@@ -236,20 +697,96 @@ exit:
 }
 
 MbedtlsSession::~MbedtlsSession(void)
+{
+    Release();
+    mbedtls_ssl_free(&mSsl);
+
+    if (mSslSetup)
+    {
+        sSessionMemory.Free(kSslBuffersSize);
+    }
+
+    sSessionMemory.Free(sizeof(*this) + mTxQueue.GetSize() + mInbox.GetSize() + mOutbox.GetSize());
+}
+
+bool MbedtlsSession::InitRing(PacketRing &aRing, uint16_t aCapacity)
+{
+    // Slots are allocated once, and kept while the session is recycled.
+    if (!aRing.IsInitialized() && aRing.Init(aCapacity, kMaxSizeOfPacket))
+    {
+        sSessionMemory.Allocate(aRing.GetSize());
+    }
+
+    return aRing.IsInitialized();
+}
+
+bool MbedtlsSession::InitTxQueue(void)
+{
+    size_t size = mTxQueue.GetSize();
+
+    if (!mTxQueue.IsInitialized())
+    {
+        mTxQueue.Init(kPriorityControl, kMaxTxControl, kMaxSizeOfPacket);
+        mTxQueue.Init(kPriorityManagement, kMaxTxManagement, kMaxSizeOfPacket);
+        mTxQueue.Init(kPriorityBulk, kMaxTxBulk, kMaxSizeOfPacket);
+        sSessionMemory.Allocate(mTxQueue.GetSize() - size);
+    }
+
+    return mTxQueue.IsInitialized();
+}
+
+void MbedtlsSession::Release(void)
 {
     Close();
+
+    if (mWatch.mFd >= 0)
+    {
+        mServer.mReactor->Remove(mWatch);
+    }
+
     // In case session socket is not actually created.
     if (mNet.fd != mServer.mSocket)
     {
         mbedtls_net_free(&mNet);
     }
-    mbedtls_ssl_free(&mSsl);
-    otbrLog(OTBR_LOG_INFO, "DTLS session destroyed: %d.", mState);
+
+    mNet.fd = -1;
+    mServer.mTimerWheel->Stop(mExpirationTimer);
+    mServer.mTimerWheel->Stop(mRetransmissionTimer);
+    mTxQueue.Clear();
+    mInbox.Clear();
+    mOutbox.Clear();
+    mJobInput = false;
+    otbrLog(OTBR_LOG_INFO, "DTLS session released: %d.", mState);
+}
+
+void MbedtlsSession::HandleReactor(void *aContext, int aFd, unsigned int aEvents)
+{
+    MbedtlsSession *session = static_cast<MbedtlsSession *>(aContext);
+
+    if (aEvents & Reactor::kEventWritable)
+    {
+        session->FlushWrites();
+    }
+
+    if (aEvents & (Reactor::kEventReadable | Reactor::kEventError))
+    {
+        otbrLogSampled(OTBR_LOG_INFO, kLogSampleRate, "DTLS session [%d] become readable.", aFd);
+        session->Process();
+    }
+}
+
+void MbedtlsSession::UpdateExpirationTimer(void)
+{
+    mServer.mTimerWheel->Start(mExpirationTimer,
+                               mState == kStateReady ? mServer.mIdleTimeout : mServer.mHandshakeTimeout);
 }
 
 void MbedtlsSession::Process(void)
 {
-    mExpiration = GetNow() + kSessionTimeout;
+    UpdateDebugThreshold();
+    mLastActivity = LoopClock::GetNow();
+    UpdateExpirationTimer();
 
     switch (mState)
     {
@@ -264,28 +801,166 @@ void MbedtlsSession::Process(void)
     default:
         break;
     }
+
+    if (!IsAlive())
+    {
+        mServer.ScheduleRelease();
+    }
 }
 
-int MbedtlsSession::Read(void)
+void MbedtlsSession::Input(const uint8_t *aBuffer, uint16_t aLength)
 {
-    uint8_t buffer[kMaxSizeOfPacket];
-    int     ret = 0;
-
-    do
+    if (mOffloaded || (mState == kStateHandshaking && mServer.IsOffloading()))
     {
-        ret = mbedtls_ssl_read(&mSsl, buffer, sizeof(buffer));
-
-        if (ret > 0)
+        // The worker reads datagrams in the order received, the buffer is not valid after this call. Dropped
+        // datagrams are retransmitted by the peer.
+        if (!InitRing(mInbox, kMaxInbox) || !mInbox.Push(aBuffer, aLength))
         {
-            mDataHandler(buffer, (uint16_t)ret, mContext);
+            otbrLog(OTBR_LOG_WARNING, "DTLS datagram dropped while handshaking.");
         }
-    } while (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
 
-    if (ret <= 0)
-    {
-        switch (ret)
-        {
-        // 0 for EOF
+        Process();
+        ExitNow();
+    }
+
+    mPendingData   = aBuffer;
+    mPendingLength = aLength;
+
+    Process();
+
+    // The datagram is dropped if not consumed by mbedtls.
+    mPendingData   = NULL;
+    mPendingLength = 0;
+
+exit:
+    return;
+}
+
+void MbedtlsSession::HandleExpirationTimer(void *aContext)
+{
+    MbedtlsSession *session = static_cast<MbedtlsSession *>(aContext);
+
+    // The session is expired once the worker returns.
+    VerifyOrExit(!session->mOffloaded, session->mExpired = true);
+
+    session->mServer.ExpireSession(*session);
+
+exit:
+    return;
+}
+
+void MbedtlsSession::HandleRetransmissionTimer(void *aContext)
+{
+    MbedtlsSession *session = static_cast<MbedtlsSession *>(aContext);
+
+    // Only handshake flights are retransmitted, records are read when the socket is readable.
+    VerifyOrExit(session->mState == kStateHandshaking);
+
+    session->mRetransmissions++;
+    session->Handshake();
+
+    if (!session->IsAlive())
+    {
+        session->mServer.ScheduleRelease();
+    }
+
+exit:
+    return;
+}
+
+void MbedtlsSession::SetDelay(void *aContext, uint32_t aIntermediate, uint32_t aFinal)
+{
+    MbedtlsSession *session = static_cast<MbedtlsSession *>(aContext);
+    uint64_t        now     = LoopClock::GetNow();
+
+    session->mDelayCancelled   = (aFinal == 0);
+    session->mIntermediateTime = now + aIntermediate;
+    session->mFinalTime        = now + aFinal;
+
+    // The timer wheel is only used on the mainloop thread.
+    if (session->mOffloaded)
+    {
+        session->mDelayUpdated = true;
+    }
+    else
+    {
+        session->UpdateRetransmissionTimer();
+    }
+}
+
+void MbedtlsSession::UpdateRetransmissionTimer(void)
+{
+    if (mDelayCancelled)
+    {
+        mServer.mTimerWheel->Stop(mRetransmissionTimer);
+    }
+    else
+    {
+        mServer.mTimerWheel->StartAt(mRetransmissionTimer, mFinalTime);
+    }
+}
+
+int MbedtlsSession::GetDelay(void *aContext)
+{
+    const MbedtlsSession *session = static_cast<const MbedtlsSession *>(aContext);
+    uint64_t              now     = LoopClock::GetNow();
+    int                   rval;
+
+    // Return values are defined by mbedtls_ssl_get_timer_t.
+    if (session->mDelayCancelled)
+    {
+        rval = -1;
+    }
+    else if (now >= session->mFinalTime)
+    {
+        rval = 2;
+    }
+    else if (now >= session->mIntermediateTime)
+    {
+        rval = 1;
+    }
+    else
+    {
+        rval = 0;
+    }
+
+    return rval;
+}
+
+int MbedtlsSession::Read(void)
+{
+    uint8_t  buffer[kMaxSizeOfRecord];
+    int      ret = 0;
+    uint64_t cpuTime;
+
+    // Read until no more record is available.
+    do
+    {
+        cpuTime = GetThreadCpuTimeUs();
+        ret     = mbedtls_ssl_read(&mSsl, buffer, sizeof(buffer));
+        cpuTime = AddRecordCpuTime(cpuTime);
+
+        if (ret > 0)
+        {
+            mRxBytes += static_cast<uint64_t>(ret);
+            mDataHandler(buffer, (uint16_t)ret, mContext);
+
+            // The handler, such as the CoAP agent, is accounted apart from the decryption.
+            cpuTime = GetThreadCpuTimeUs() - cpuTime;
+            mHandlerCpuTime += cpuTime;
+            sHandlerCpuTime.Add(cpuTime);
+        }
+    } while (ret > 0);
+
+    if (ret <= 0)
+    {
+        switch (ret)
+        {
+        case MBEDTLS_ERR_SSL_WANT_READ:
+        case MBEDTLS_ERR_SSL_WANT_WRITE:
+            break;
+
+        // 0 for EOF
         case 0:
             // fall through
             ;
@@ -321,45 +996,101 @@ int MbedtlsSession::ExportKeys(void *               aContext,
                                size_t               aKeyLength,
                                size_t               aIvLength)
 {
+    MbedtlsSession *       session = sHandshakingSession;
+    int                    ret     = 0;
     mbedtls_sha256_context sha256;
 
+    // The callback of the shared configuration has no session context, keys never go to another session.
+    assert(session != NULL);
+    VerifyOrExit(session != NULL, ret = MBEDTLS_ERR_SSL_INTERNAL_ERROR);
+
     mbedtls_sha256_init(&sha256);
     mbedtls_sha256_starts(&sha256, 0);
     mbedtls_sha256_update(&sha256, aKeyBlock, 2 * static_cast<uint16_t>(aMacLength + aKeyLength + aIvLength));
-    mbedtls_sha256_finish(&sha256, static_cast<MbedtlsSession *>(aContext)->mKek);
+    mbedtls_sha256_finish(&sha256, session->mKek);
+    mbedtls_sha256_free(&sha256);
 
+exit:
+    (void)aContext;
     (void)aMasterSecret;
-    return 0;
+    return ret;
 }
 
-MbedtlsSession::MbedtlsSession(MbedtlsServer &            aServer,
-                               const mbedtls_net_context &aNet,
-                               const struct sockaddr_in6 &aRemoteSock,
-                               const sockaddr_in6 &       aLocalSock)
-    : mNet(aNet)
-    , mRemoteSock(aRemoteSock)
-    , mLocalSock(aLocalSock)
+MbedtlsSession::MbedtlsSession(MbedtlsServer &aServer)
+    : mDataHandler(NULL)
+    , mContext(NULL)
+    , mState(kStateEnd)
     , mServer(aServer)
+    , mNextInTable(NULL)
+    , mPendingData(NULL)
+    , mPendingLength(0)
+    , mExpirationTimer(HandleExpirationTimer, this)
+    , mRetransmissionTimer(HandleRetransmissionTimer, this)
+    , mIntermediateTime(0)
+    , mFinalTime(0)
+    , mHandshakeStart(0)
+    , mLastActivity(0)
+    , mRxBytes(0)
+    , mTxBytes(0)
+    , mHandshakeCpuTime(0)
+    , mRecordCpuTime(0)
+    , mHandlerCpuTime(0)
+    , mRetransmissions(0)
+    , mDelayCancelled(true)
+    , mHandshakeJob(HandleHandshakeWork, HandleHandshakeDone, this)
+    , mJobInput(false)
+    , mHandshakeResult(0)
+    , mJobCpuTime(0)
+    , mOffloaded(false)
+    , mDelayUpdated(false)
+    , mCloseRequested(false)
+    , mExpired(false)
+    , mSslSetup(false)
 {
+    mNet.fd = -1;
+    mbedtls_ssl_init(&mSsl);
+    sSessionMemory.Allocate(sizeof(*this));
 }
 
-otbrError MbedtlsSession::Init(void)
+otbrError MbedtlsSession::Init(const mbedtls_net_context &aNet,
+                               const sockaddr_in6 &       aRemoteSock,
+                               const sockaddr_in6 &       aLocalSock)
 {
     otbrError error = OTBR_ERROR_NONE;
     int       rval  = 0;
 
-    mbedtls_ssl_init(&mSsl);
-    SuccessOrExit(rval = mbedtls_ssl_setup(&mSsl, &mServer.mConf));
+    mNet              = aNet;
+    mRemoteSock       = aRemoteSock;
+    mLocalSock        = aLocalSock;
+    mDataHandler      = NULL;
+    mContext          = NULL;
+    mDelayCancelled   = true;
+    mCloseRequested   = false;
+    mExpired          = false;
+    mLastActivity     = LoopClock::GetNow();
+    mRxBytes          = 0;
+    mTxBytes          = 0;
+    mHandshakeCpuTime = 0;
+    mRecordCpuTime    = 0;
+    mHandlerCpuTime   = 0;
+    mRetransmissions  = 0;
+
+    // The ssl context is only set up once, and reset when the session is reused.
+    if (!mSslSetup)
+    {
+        SuccessOrExit(rval = mbedtls_ssl_setup(&mSsl, &mServer.mConf));
 
-    mbedtls_ssl_set_timer_cb(&mSsl, &mTimer, mbedtls_timing_set_delay, mbedtls_timing_get_delay);
+        mbedtls_ssl_set_timer_cb(&mSsl, this, SetDelay, GetDelay);
+        mbedtls_ssl_set_bio(&mSsl, this, SendMbedtls, ReadMbedtls, NULL);
+        mSslSetup = true;
+        sSessionMemory.Allocate(kSslBuffersSize);
+    }
 
-    SuccessOrExit(rval = mbedtls_ssl_session_reset(&mSsl));
-    SuccessOrExit(rval = mbedtls_ssl_set_hs_ecjpake_password(&mSsl, mServer.mPSK, mServer.mPSKLength));
-    SuccessOrExit(rval = mbedtls_ssl_set_client_transport_id(
-                      &mSsl, reinterpret_cast<const unsigned char *>(&mRemoteSock), sizeof(mRemoteSock)));
-    mbedtls_ssl_set_bio(&mSsl, this, SendMbedtls, ReadMbedtls, NULL);
+    SuccessOrExit(rval = Reset());
 
-    mState = kStateHandshaking;
+    mState          = kStateHandshaking;
+    mHandshakeStart = GetMonotonicNowUs();
+    OTBR_PROBE1(dtls_handshake_start, this);
 
 exit:
     if (rval)
@@ -371,12 +1102,77 @@ exit:
     return error;
 }
 
+int MbedtlsSession::Reset(void)
+{
+    int rval;
+
+    SuccessOrExit(rval = mbedtls_ssl_session_reset(&mSsl));
+    SuccessOrExit(rval = mbedtls_ssl_set_hs_ecjpake_password(&mSsl, mServer.mPSK, mServer.mPSKLength));
+    SuccessOrExit(rval = mbedtls_ssl_set_client_transport_id(
+                      &mSsl, reinterpret_cast<const unsigned char *>(&mRemoteSock), sizeof(mRemoteSock)));
+
+exit:
+    return rval;
+}
+
 int MbedtlsSession::ReadMbedtls(unsigned char *aBuffer, size_t aLength)
 {
-    return mbedtls_net_recv(&mNet, aBuffer, aLength);
+    int ret;
+
+    if (mPendingData != NULL)
+    {
+        VerifyOrExit(aLength >= mPendingLength, ret = MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL);
+
+        memcpy(aBuffer, mPendingData, mPendingLength);
+        ret            = mPendingLength;
+        mPendingData   = NULL;
+        mPendingLength = 0;
+    }
+    else if (mNet.fd >= 0 && mNet.fd != mServer.mSocket)
+    {
+        ret = mbedtls_net_recv(&mNet, aBuffer, aLength);
+    }
+    else
+    {
+        // Datagrams on the server socket are read by the server.
+        ret = MBEDTLS_ERR_SSL_WANT_READ;
+    }
+
+exit:
+    return ret;
 }
 
 int MbedtlsSession::SendMbedtls(const unsigned char *aBuffer, size_t aLength)
+{
+    int ret = 0;
+
+    // Records of a handshake running on a worker are sent once it returns.
+    if (mOffloaded)
+    {
+        // Dropped records are sent again with the retransmission of the flight.
+        if (aLength > kMaxSizeOfPacket || !mOutbox.Push(aBuffer, static_cast<uint16_t>(aLength)))
+        {
+            otbrLog(OTBR_LOG_WARNING, "DTLS record dropped by the handshake worker.");
+        }
+
+        ExitNow(ret = static_cast<int>(aLength));
+    }
+
+    // Sessions sharing the server socket are never connected.
+    VerifyOrExit(!mServer.mSharedSocket, ret = mServer.SendTo(aBuffer, aLength, mRemoteSock, mLocalSock));
+
+    if (mNet.fd == mServer.mSocket)
+    {
+        SuccessOrExit(ret = Connect());
+    }
+
+    ret = mbedtls_net_send(&mNet, aBuffer, aLength);
+
+exit:
+    return ret;
+}
+
+int MbedtlsSession::Connect(void)
 {
     int  opt = 1;
     int &fd  = mNet.fd;
@@ -387,8 +1183,9 @@ int MbedtlsSession::SendMbedtls(const unsigned char *aBuffer, size_t aLength)
     SuccessOrExit(ret = bind(fd, reinterpret_cast<const struct sockaddr *>(&mLocalSock), sizeof(mLocalSock)));
     SuccessOrExit(ret = connect(fd, reinterpret_cast<const struct sockaddr *>(&mRemoteSock), sizeof(mRemoteSock)));
     SuccessOrExit(ret = mbedtls_net_set_nonblock(&mNet));
-    mbedtls_ssl_set_bio(&mSsl, &mNet, mbedtls_net_send, mbedtls_net_recv, NULL);
-    VerifyOrExit((ret = mbedtls_net_send(&mNet, aBuffer, aLength)) != -1);
+    VerifyOrExit(mServer.mReactor == NULL || mServer.mReactor->Add(mWatch, fd, Reactor::kEventReadable, HandleReactor,
+                                                                   this, "dtls-session") == OTBR_ERROR_NONE,
+                 ret = -1);
 
 exit:
     return ret;
@@ -400,210 +1197,1050 @@ int MbedtlsSession::Handshake(void)
 
     VerifyOrExit(mState == kStateHandshaking, otbrLog(OTBR_LOG_ERR, "Invalid DTLS session state!"));
 
+    if (mServer.IsOffloading())
+    {
+        SubmitHandshake();
+        ExitNow(ret = MBEDTLS_ERR_SSL_WANT_READ);
+    }
+
     otbrLog(OTBR_LOG_INFO, "DTLS handshaking...");
 
-    SuccessOrExit(ret = mbedtls_ssl_handshake(&mSsl));
+    ret = RunHandshake(mHandshakeCpuTime);
+    HandleHandshakeResult(ret);
 
-    otbrLog(OTBR_LOG_INFO, "DTLS session ready.");
+exit:
+    return ret;
+}
 
-    SetState(kStateReady);
+int MbedtlsSession::RunHandshake(uint64_t &aCpuTime)
+{
+    int      ret;
+    uint64_t cpuTime = GetThreadCpuTimeUs();
 
-exit:
+    // The configuration is shared by all sessions, keys are exported to the one handshaking on this thread.
+    Timeline::Begin("dtls.handshake_step");
+    sHandshakingSession = this;
+    ret                 = mbedtls_ssl_handshake(&mSsl);
+    sHandshakingSession = NULL;
+    Timeline::End("dtls.handshake_step");
 
-    if (ret)
-    {
-        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
-        {
-            otbrLog(OTBR_LOG_INFO, "DTLS handshake pending: -0x%04x.", -ret);
-        }
-        else
-        {
-            otbrLog(OTBR_LOG_ERR, "DTLS handshake failed: -0x%04x!", -ret);
-            if (ret != MBEDTLS_ERR_SSL_HELLO_VERIFY_REQUIRED)
-            {
-                mbedtls_ssl_send_alert_message(&mSsl, MBEDTLS_SSL_ALERT_LEVEL_FATAL,
-                                               MBEDTLS_SSL_ALERT_MSG_HANDSHAKE_FAILURE);
-            }
-            mState = kStateError;
-        }
-    }
+    // Measured on the thread running the step, workers report it once done.
+    aCpuTime += GetThreadCpuTimeUs() - cpuTime;
 
     return ret;
 }
 
-void MbedtlsServer::UpdateFdSet(fd_set & aReadFdSet,
-                                fd_set & aWriteFdSet,
-                                fd_set & aErrorFdSet,
-                                int &    aMaxFd,
-                                timeval &aTimeout)
+uint64_t MbedtlsSession::AddRecordCpuTime(uint64_t aStart)
 {
-    unsigned long now     = GetNow();
-    unsigned long timeout = GetTimestamp(aTimeout);
+    uint64_t now = GetThreadCpuTimeUs();
 
-    for (SessionSet::iterator it = mSessions.begin(); it != mSessions.end();)
-    {
-        MbedtlsSession *session = *it;
+    mRecordCpuTime += now - aStart;
+    sRecordCpuTime.Add(now - aStart);
 
-        if (session->GetExpiration() <= now)
+    return now;
+}
+
+void MbedtlsSession::HandleHandshakeResult(int aResult)
+{
+    if (aResult == 0)
+    {
+        uint64_t elapsed = GetMonotonicNowUs() - mHandshakeStart;
+
+        otbrLog(OTBR_LOG_INFO, "DTLS session ready.");
+        OTBR_PROBE3(dtls_handshake_done, this, aResult, elapsed);
+        Timeline::Complete("dtls.handshake", mHandshakeStart, elapsed);
+        sHandshakeTime.Record(elapsed);
+        sHandshakeRetransmissions.Record(mRetransmissions);
+        sHandshakeCpuTime.Record(mHandshakeCpuTime);
+        mServer.mTimerWheel->Start(mExpirationTimer, mServer.mIdleTimeout);
+        SetState(kStateReady);
+    }
+    else if (aResult == MBEDTLS_ERR_SSL_WANT_READ || aResult == MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+        otbrLog(OTBR_LOG_INFO, "DTLS handshake pending: -0x%04x.", -aResult);
+    }
+    else if (aResult == MBEDTLS_ERR_SSL_HELLO_VERIFY_REQUIRED && Reset() == 0)
+    {
+        // Keep the session for the ClientHello with cookie from the same peer.
+        otbrLog(OTBR_LOG_INFO, "DTLS hello verification requested.");
+    }
+    else
+    {
+        uint64_t elapsed = GetMonotonicNowUs() - mHandshakeStart;
+
+        otbrLog(OTBR_LOG_ERR, "DTLS handshake failed: -0x%04x!", -aResult);
+        OTBR_PROBE3(dtls_handshake_done, this, aResult, elapsed);
+        Timeline::Complete("dtls.handshake_failed", mHandshakeStart, elapsed);
+        sHandshakeFailures.Add();
+        sHandshakeFailedTime.Record(elapsed);
+        if (aResult != MBEDTLS_ERR_SSL_HELLO_VERIFY_REQUIRED)
         {
-            otbrLog(OTBR_LOG_INFO, "DTLS session timeout!");
-            HandleSessionState(*session, Session::kStateExpired);
-            delete session;
-            it = mSessions.erase(it);
+            mbedtls_ssl_send_alert_message(&mSsl, MBEDTLS_SSL_ALERT_LEVEL_FATAL,
+                                           MBEDTLS_SSL_ALERT_MSG_HANDSHAKE_FAILURE);
         }
-        else if (session->GetState() == Session::kStateReady || session->GetState() == Session::kStateHandshaking)
-        {
-            int fd = session->GetFd();
-
-            otbrLog(OTBR_LOG_INFO, "DTLS session[%d] alive.", fd);
-            FD_SET(fd, &aReadFdSet);
+        mState = kStateError;
+    }
+}
 
-            if (aMaxFd < fd)
-            {
-                aMaxFd = fd;
-            }
+void MbedtlsSession::SubmitHandshake(void)
+{
+    VerifyOrExit(!mOffloaded);
 
-            if (static_cast<long>(session->GetExpiration() - (now + timeout)) < 0)
-            {
-                timeout = static_cast<unsigned long>(session->GetExpiration() - now);
-            }
+    // The worker reads the first datagram in place, it is popped once the worker returns.
+    mPendingLength = 0;
+    mPendingData   = mInbox.GetFront(mPendingLength);
+    mJobInput      = (mPendingData != NULL);
+    mJobCpuTime    = 0;
+    mOffloaded     = true;
 
-            // TODO error set
-            ++it;
-        }
-        else
-        {
-            delete session;
-            it = mSessions.erase(it);
-        }
+    if (!InitRing(mOutbox, kMaxOutbox) || mServer.mWorkerPool.Submit(mHandshakeJob) != OTBR_ERROR_NONE)
+    {
+        int result;
+
+        // Handshake on the mainloop when the pool is stopping.
+        mOffloaded     = false;
+        result         = RunHandshake(mHandshakeCpuTime);
+        mPendingData   = NULL;
+        mPendingLength = 0;
+        PopJobInput();
+        HandleHandshakeResult(result);
     }
 
-    if (mSocket >= 0)
-    {
-        FD_SET(mSocket, &aReadFdSet);
+exit:
+    return;
+}
 
-        if (aMaxFd < mSocket)
-        {
-            aMaxFd = mSocket;
-        }
-    }
+void MbedtlsSession::HandleHandshakeWork(void *aContext)
+{
+    MbedtlsSession *session = static_cast<MbedtlsSession *>(aContext);
 
-    aTimeout.tv_sec  = timeout / 1000;
-    aTimeout.tv_usec = (timeout % 1000) * 1000;
+    session->mHandshakeResult = session->RunHandshake(session->mJobCpuTime);
+    session->mPendingData     = NULL;
+    session->mPendingLength   = 0;
+}
 
-    (void)aWriteFdSet;
-    (void)aErrorFdSet;
+void MbedtlsSession::HandleHandshakeDone(void *aContext)
+{
+    static_cast<MbedtlsSession *>(aContext)->HandleHandshakeDone();
 }
 
-void MbedtlsServer::HandleSessionState(Session &aSession, Session::State aState)
+void MbedtlsSession::PopJobInput(void)
 {
-    otbrLog(OTBR_LOG_INFO, "DTLS session state changed to %d.", aState);
-    if (mStateHandler)
+    if (mJobInput)
     {
-        mStateHandler(aSession, aState, mContext);
+        mJobInput = false;
+        mInbox.Pop();
     }
 }
 
-void MbedtlsServer::ProcessServer(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
+void MbedtlsSession::HandleHandshakeDone(void)
 {
-    uint8_t       packet[kMaxSizeOfPacket];
-    uint8_t       control[kMaxSizeOfControl];
-    otbrError     error = OTBR_ERROR_ERRNO; // Assume error
-    sockaddr_in6  src;
-    sockaddr_in6  dst;
-    struct msghdr msghdr;
-    struct iovec  iov[1];
-
-    /* Connection is not alive yet, or is shut down */
-    VerifyOrExit(mSocket >= 0, error = OTBR_ERROR_NONE);
+    const uint8_t *record;
+    uint16_t       length = 0;
 
-    /* If this is not set, then some other handle became rd/wr able, it is not an error */
-    VerifyOrExit(FD_ISSET(mSocket, &aReadFdSet), error = OTBR_ERROR_NONE);
+    mOffloaded = false;
+    mHandshakeCpuTime += mJobCpuTime;
+    PopJobInput();
 
-    otbrLog(OTBR_LOG_INFO, "Trying to accept connection...");
-    memset(&src, 0, sizeof(src));
-    memset(&dst, 0, sizeof(dst));
-    memset(&msghdr, 0, sizeof(msghdr));
-    msghdr.msg_name    = &src;
-    msghdr.msg_namelen = sizeof(src);
-    memset(&iov, 0, sizeof(iov));
-    iov[0].iov_base       = packet;
-    iov[0].iov_len        = kMaxSizeOfPacket;
-    msghdr.msg_iov        = iov;
-    msghdr.msg_iovlen     = 1;
-    msghdr.msg_control    = control;
-    msghdr.msg_controllen = sizeof(control);
-
-    VerifyOrExit(recvmsg(mSocket, &msghdr, MSG_PEEK) > 0);
-
-    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msghdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&msghdr, cmsg))
-    {
-        if (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_PKTINFO)
-        {
-            const struct in6_pktinfo *pktinfo = reinterpret_cast<const struct in6_pktinfo *>(CMSG_DATA(cmsg));
-            memcpy(dst.sin6_addr.s6_addr, pktinfo->ipi6_addr.s6_addr, sizeof(dst.sin6_addr));
-            dst.sin6_family = AF_INET6;
-            dst.sin6_port   = ntohs(mPort);
-            break;
-        }
+    if (mDelayUpdated)
+    {
+        mDelayUpdated = false;
+        UpdateRetransmissionTimer();
     }
 
-    VerifyOrExit(memcmp(dst.sin6_addr.s6_addr, in6addr_any.s6_addr, sizeof(dst.sin6_addr)) != 0, errno = EDESTADDRREQ);
-
-    // TODO Should check if this client has an existing session.
+    while ((record = mOutbox.GetFront(length)) != NULL)
     {
-        mbedtls_net_context net = {mSocket};
-
-        MbedtlsSession *session = new MbedtlsSession(*this, net, src, dst);
-
-        VerifyOrExit(session->Init() == OTBR_ERROR_NONE, delete session);
+        SendMbedtls(record, length);
+        mOutbox.Pop();
+    }
 
-        mSessions.push_back(session);
-        mbedtls_ssl_conf_export_keys_cb(&mConf, MbedtlsSession::ExportKeys, session);
-        session->Process();
+    if (mExpired)
+    {
+        mServer.ExpireSession(*this);
+        ExitNow();
     }
 
-    error = OTBR_ERROR_NONE;
+    HandleHandshakeResult(mHandshakeResult);
 
-exit:
-    if (error)
+    if (mCloseRequested)
     {
-        otbrLog(OTBR_LOG_ERR, "DTLS failed to initiate new session: %s.", otbrErrorString(error));
-        otbrLog(OTBR_LOG_INFO, "Trying to create new server socket...");
-        close(mSocket);
-        mSocket = -1;
+        mCloseRequested = false;
+        Close();
+    }
 
-        if (Bind())
+    // Datagrams received while the worker was running.
+    while (!mOffloaded && !mInbox.IsEmpty() && IsAlive())
+    {
+        if (mState == kStateHandshaking)
         {
-            otbrLog(OTBR_LOG_ERR, "Unable create new server socket! Die now!");
-            abort();
+            SubmitHandshake();
+        }
+        else
+        {
+            uint8_t datagram[kMaxSizeOfPacket];
+
+            record = mInbox.GetFront(length);
+            memcpy(datagram, record, length);
+            mInbox.Pop();
+            Input(datagram, length);
         }
     }
 
-    (void)aWriteFdSet;
-    (void)aErrorFdSet;
+    if (!IsAlive())
+    {
+        mInbox.Clear();
+        mServer.ScheduleRelease();
+    }
+
+exit:
+    return;
 }
 
-void MbedtlsServer::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
+SessionTable::SessionTable(void)
+    : mBuckets(kInitialBuckets, NULL)
+    , mSize(0)
+{
+}
+
+size_t SessionTable::Hash(const sockaddr_in6 &aSockAddr)
 {
-    for (SessionSet::iterator it = mSessions.begin(); it != mSessions.end(); ++it)
+    // FNV-1a over the address and port.
+    uint32_t       hash = 2166136261U;
+    const uint8_t *port = reinterpret_cast<const uint8_t *>(&aSockAddr.sin6_port);
+
+    for (size_t i = 0; i < sizeof(aSockAddr.sin6_addr.s6_addr); ++i)
     {
-        MbedtlsSession *session = *it;
-        int             fd      = session->GetFd();
+        hash = (hash ^ aSockAddr.sin6_addr.s6_addr[i]) * 16777619U;
+    }
 
-        if (FD_ISSET(fd, &aReadFdSet))
-        {
-            otbrLog(OTBR_LOG_INFO, "DTLS session [%d] become readable.", fd);
-            session->Process();
-        }
+    for (size_t i = 0; i < sizeof(aSockAddr.sin6_port); ++i)
+    {
+        hash = (hash ^ port[i]) * 16777619U;
     }
 
-    ProcessServer(aReadFdSet, aWriteFdSet, aErrorFdSet);
+    return hash;
+}
 
-    (void)aErrorFdSet;
+bool SessionTable::Equals(const sockaddr_in6 &aFirst, const sockaddr_in6 &aSecond)
+{
+    return aFirst.sin6_port == aSecond.sin6_port && aFirst.sin6_scope_id == aSecond.sin6_scope_id &&
+           memcmp(&aFirst.sin6_addr, &aSecond.sin6_addr, sizeof(aFirst.sin6_addr)) == 0;
 }
 
-otbrError MbedtlsServer::SetPSK(const uint8_t *aPSK, uint8_t aLength)
+void SessionTable::Add(MbedtlsSession &aSession)
+{
+    size_t bucket;
+
+    assert(Find(aSession.mRemoteSock) == NULL);
+
+    if (mSize >= mBuckets.size())
+    {
+        Grow();
+    }
+
+    bucket                = GetBucket(aSession.mRemoteSock);
+    aSession.mNextInTable = mBuckets[bucket];
+    mBuckets[bucket]      = &aSession;
+    ++mSize;
+}
+
+void SessionTable::Remove(MbedtlsSession &aSession)
+{
+    MbedtlsSession **link = &mBuckets[GetBucket(aSession.mRemoteSock)];
+
+    while (*link != &aSession)
+    {
+        assert(*link != NULL);
+        link = &(*link)->mNextInTable;
+    }
+
+    *link                 = aSession.mNextInTable;
+    aSession.mNextInTable = NULL;
+    --mSize;
+}
+
+MbedtlsSession *SessionTable::Find(const sockaddr_in6 &aSockAddr) const
+{
+    MbedtlsSession *session = mBuckets[GetBucket(aSockAddr)];
+
+    while (session != NULL && !Equals(session->mRemoteSock, aSockAddr))
+    {
+        session = session->mNextInTable;
+    }
+
+    return session;
+}
+
+MbedtlsSession *SessionTable::GetNext(const MbedtlsSession &aSession) const
+{
+    return aSession.mNextInTable != NULL ? aSession.mNextInTable : GetNext(GetBucket(aSession.mRemoteSock) + 1);
+}
+
+MbedtlsSession *SessionTable::GetNext(size_t aBucket) const
+{
+    MbedtlsSession *session = NULL;
+
+    for (; aBucket < mBuckets.size() && session == NULL; ++aBucket)
+    {
+        session = mBuckets[aBucket];
+    }
+
+    return session;
+}
+
+void SessionTable::Grow(void)
+{
+    std::vector<MbedtlsSession *> buckets(mBuckets.size() * 2, NULL);
+
+    mBuckets.swap(buckets);
+
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        while (buckets[i] != NULL)
+        {
+            MbedtlsSession *session = buckets[i];
+            size_t          bucket  = GetBucket(session->mRemoteSock);
+
+            buckets[i]            = session->mNextInTable;
+            session->mNextInTable = mBuckets[bucket];
+            mBuckets[bucket]      = session;
+        }
+    }
+}
+
+void MbedtlsServer::UpdateFdSet(fd_set & aReadFdSet,
+                                fd_set & aWriteFdSet,
+                                fd_set & aErrorFdSet,
+                                int &    aMaxFd,
+                                timeval &aTimeout)
+{
+    if (mTimerWheel == &mLocalTimerWheel)
+    {
+        mLocalTimerWheel.UpdateTimeout(aTimeout);
+    }
+
+    // Sockets are registered with the reactor directly.
+    VerifyOrExit(mReactor == NULL);
+
+    for (MbedtlsSession *session = mSessions.GetFirst(); session != NULL; session = mSessions.GetNext(*session))
+    {
+        int fd = session->GetFd();
+
+        if (session->IsAlive() && fd >= 0 && fd != mSocket)
+        {
+            FD_SET(fd, &aReadFdSet);
+
+            if (session->HasPendingWrites())
+            {
+                FD_SET(fd, &aWriteFdSet);
+            }
+
+            if (aMaxFd < fd)
+            {
+                aMaxFd = fd;
+            }
+
+            // TODO error set
+        }
+    }
+
+    if (mSocket >= 0)
+    {
+        FD_SET(mSocket, &aReadFdSet);
+
+        if (aMaxFd < mSocket)
+        {
+            aMaxFd = mSocket;
+        }
+    }
+
+    if (mWorkerPool.GetFd() >= 0)
+    {
+        FD_SET(mWorkerPool.GetFd(), &aReadFdSet);
+
+        if (aMaxFd < mWorkerPool.GetFd())
+        {
+            aMaxFd = mWorkerPool.GetFd();
+        }
+    }
+
+exit:
+    (void)aErrorFdSet;
+}
+
+void MbedtlsServer::HandleSessionState(Session &aSession, Session::State aState)
+{
+    otbrLog(OTBR_LOG_INFO, "DTLS session state changed to %d.", aState);
+    if (mStateHandler)
+    {
+        mStateHandler(aSession, aState, mContext);
+    }
+}
+
+void MbedtlsServer::ExpireSession(MbedtlsSession &aSession)
+{
+    if (aSession.mState == Session::kStateReady)
+    {
+        otbrLog(OTBR_LOG_INFO, "DTLS session idle timeout!");
+        sIdleTimeouts.Add();
+    }
+    else
+    {
+        otbrLog(OTBR_LOG_INFO, "DTLS session handshake timeout!");
+        sHandshakeTimeouts.Add();
+    }
+
+    RemoveSession(aSession);
+}
+
+bool MbedtlsServer::EvictSession(void)
+{
+    uint64_t        now    = LoopClock::GetNow();
+    MbedtlsSession *oldest = NULL;
+
+    // Sessions running on a worker are busy, and are not evicted.
+    for (MbedtlsSession *session = mSessions.GetFirst(); session != NULL; session = mSessions.GetNext(*session))
+    {
+        if (session->IsAlive() && !session->mOffloaded && now - session->mLastActivity >= kMinEvictionIdleTime &&
+            (oldest == NULL || session->mLastActivity < oldest->mLastActivity))
+        {
+            oldest = session;
+        }
+    }
+
+    VerifyOrExit(oldest != NULL);
+
+    otbrLog(OTBR_LOG_INFO, "DTLS session evicted, idle for %llu ms.",
+            static_cast<unsigned long long>(now - oldest->mLastActivity));
+    sIdleEvictions.Add();
+    RemoveSession(*oldest);
+
+exit:
+    return oldest != NULL;
+}
+
+void MbedtlsServer::RemoveSession(MbedtlsSession &aSession)
+{
+    HandleSessionState(aSession, Session::kStateExpired);
+    mSessions.Remove(aSession);
+    FreeSession(aSession);
+}
+
+void MbedtlsServer::HandleReleaseTimer(void *aContext)
+{
+    static_cast<MbedtlsServer *>(aContext)->ReleaseSessions();
+}
+
+void MbedtlsServer::ReleaseSessions(void)
+{
+    for (MbedtlsSession *session = mSessions.GetFirst(); session != NULL;)
+    {
+        MbedtlsSession *next = mSessions.GetNext(*session);
+
+        if (!session->IsAlive())
+        {
+            mSessions.Remove(*session);
+            FreeSession(*session);
+        }
+
+        session = next;
+    }
+}
+
+void MbedtlsServer::HandleReactor(void *aContext, int aFd, unsigned int aEvents)
+{
+    static_cast<MbedtlsServer *>(aContext)->ProcessServer();
+    (void)aFd;
+    (void)aEvents;
+}
+
+void MbedtlsServer::ProcessServer(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
+{
+    /* If this is not set, then some other handle became rd/wr able, it is not an error */
+    if (mSocket >= 0 && FD_ISSET(mSocket, &aReadFdSet))
+    {
+        ProcessServer();
+    }
+
+    (void)aWriteFdSet;
+    (void)aErrorFdSet;
+}
+
+void MbedtlsServer::ProcessServer(void)
+{
+    otbrError error = OTBR_ERROR_NONE;
+    int       count;
+
+    /* Connection is not alive yet, or is shut down */
+    VerifyOrExit(mSocket >= 0);
+
+    UpdateDebugThreshold();
+    otbrLog(OTBR_LOG_INFO, "Trying to accept connection...");
+
+    count = mIo.Receive();
+    VerifyOrExit(count >= 0 || errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR, error = OTBR_ERROR_ERRNO);
+
+    for (int i = 0; i < count; ++i)
+    {
+        HandleDatagram(mIo.GetReceived(i));
+    }
+
+exit:
+    if (error)
+    {
+        otbrLog(OTBR_LOG_ERR, "DTLS failed to receive on server socket: %s.", otbrErrorString(error));
+        otbrLog(OTBR_LOG_INFO, "Trying to create new server socket...");
+
+        if (mWatch.mFd >= 0)
+        {
+            mReactor->Remove(mWatch);
+        }
+
+        close(mSocket);
+        mSocket = -1;
+        mIo.SetFd(-1);
+
+        if (Bind())
+        {
+            otbrLog(OTBR_LOG_ERR, "Unable create new server socket! Die now!");
+            abort();
+        }
+    }
+}
+
+void MbedtlsServer::HandleDatagram(const DatagramIo::Datagram &aDatagram)
+{
+    otbrError       error = OTBR_ERROR_ERRNO;
+    MbedtlsSession *session;
+
+    VerifyOrExit(!aDatagram.IsTruncated(), errno = EMSGSIZE);
+
+    session = mSessions.Find(aDatagram.GetPeerAddress());
+
+    // A session closed but not yet released is replaced by the new one from the same peer.
+    if (session != NULL && !session->IsAlive())
+    {
+        mSessions.Remove(*session);
+        FreeSession(*session);
+        session = NULL;
+    }
+
+    if (session == NULL)
+    {
+        SuccessOrExit(error = Accept(aDatagram, session));
+
+        // The peer is still proving its address with a cookie.
+        VerifyOrExit(session != NULL);
+    }
+    else if (!mSharedSocket)
+    {
+        // Retransmitted ClientHello or records sent before the session socket was connected.
+        otbrLogSampled(OTBR_LOG_INFO, kLogSampleRate, "DTLS datagram for existing session [%d].", session->GetFd());
+    }
+
+    // mbedtls consumes the datagram from memory, it is never read from the socket again.
+    session->Input(aDatagram.GetPayload(), aDatagram.GetLength());
+
+    error = OTBR_ERROR_NONE;
+
+exit:
+    if (error)
+    {
+        otbrLog(OTBR_LOG_WARNING, "DTLS dropped datagram on server socket: %s.", otbrErrorString(error));
+    }
+}
+
+otbrError MbedtlsServer::Accept(const DatagramIo::Datagram &aDatagram, MbedtlsSession *&aSession)
+{
+    otbrError           error = OTBR_ERROR_ERRNO;
+    mbedtls_net_context net   = {mSharedSocket ? -1 : mSocket};
+    sockaddr_in6        local;
+
+    aSession = NULL;
+
+    // The control data is only parsed to set up new sessions.
+    VerifyOrExit(aDatagram.GetLocalAddress(local, mPort), errno = EDESTADDRREQ);
+    VerifyOrExit(memcmp(local.sin6_addr.s6_addr, in6addr_any.s6_addr, sizeof(local.sin6_addr)) != 0,
+                 errno = EDESTADDRREQ);
+
+    // Nothing is allocated for a peer until it returns a valid cookie.
+    VerifyOrExit(VerifyClientHello(aDatagram, local), error = OTBR_ERROR_NONE);
+
+    VerifyOrExit((aSession = AllocateSession()) != NULL, errno = ENOBUFS);
+
+    if ((error = aSession->Init(net, aDatagram.GetPeerAddress(), local)) != OTBR_ERROR_NONE)
+    {
+        FreeSession(*aSession);
+        aSession = NULL;
+        ExitNow();
+    }
+
+    mSessions.Add(*aSession);
+    OTBR_PROBE2(dtls_session_create, aSession, ntohs(aDatagram.GetPeerAddress().sin6_port));
+
+    // The handshake takes a key as it writes its ServerHello, one is computed in its place.
+    SchedulePrecompute();
+
+exit:
+    return error;
+}
+
+MbedtlsSession *MbedtlsServer::AllocateSession(void)
+{
+    MbedtlsSession *session = NULL;
+
+    if (!mFreeSessions.empty())
+    {
+        session = mFreeSessions.back();
+        mFreeSessions.pop_back();
+    }
+    else if (mSessionCount < mMaxSessions)
+    {
+        session = new MbedtlsSession(*this);
+        ++mSessionCount;
+    }
+    else
+    {
+        // Sessions closed but not yet released, or else the oldest idle one, make room for the new peer.
+        ReleaseSessions();
+
+        if (mFreeSessions.empty() && !EvictSession())
+        {
+            otbrLog(OTBR_LOG_WARNING, "DTLS session limit %u reached.", mMaxSessions);
+        }
+        else
+        {
+            session = mFreeSessions.back();
+            mFreeSessions.pop_back();
+        }
+    }
+
+    if (session != NULL)
+    {
+        sSessionsInUse.Add();
+    }
+
+    return session;
+}
+
+void MbedtlsServer::FreeSession(MbedtlsSession &aSession)
+{
+    OTBR_PROBE1(dtls_session_destroy, &aSession);
+    AccountPeer(aSession);
+    aSession.Release();
+    mFreeSessions.push_back(&aSession);
+    sSessionsInUse.Subtract();
+}
+
+void MbedtlsServer::AccountPeer(const MbedtlsSession &aSession)
+{
+    // Once full, the peer with the least CPU time makes room unless the new one used even less.
+    if (mPeers.size() == kMaxPeers && FindPeer(mPeers, aSession) == NULL)
+    {
+        size_t least = 0;
+
+        for (size_t i = 1; i < mPeers.size(); ++i)
+        {
+            least = GetCpuTime(mPeers[i]) < GetCpuTime(mPeers[least]) ? i : least;
+        }
+
+        VerifyOrExit(aSession.mHandshakeCpuTime + aSession.mRecordCpuTime + aSession.mHandlerCpuTime >
+                     GetCpuTime(mPeers[least]));
+
+        mPeers[least] = mPeers.back();
+        mPeers.pop_back();
+    }
+
+    AddPeerTime(mPeers, aSession);
+
+exit:
+    return;
+}
+
+Server::PeerInfo *MbedtlsServer::FindPeer(std::vector<PeerInfo> &aPeers, const MbedtlsSession &aSession)
+{
+    PeerInfo *peer = NULL;
+
+    for (size_t i = 0; i < aPeers.size() && peer == NULL; ++i)
+    {
+        if (memcmp(aPeers[i].mPeerAddress, &aSession.mRemoteSock.sin6_addr, sizeof(aPeers[i].mPeerAddress)) == 0)
+        {
+            peer = &aPeers[i];
+        }
+    }
+
+    return peer;
+}
+
+void MbedtlsServer::AddPeerTime(std::vector<PeerInfo> &aPeers, const MbedtlsSession &aSession)
+{
+    PeerInfo *peer = FindPeer(aPeers, aSession);
+
+    if (peer == NULL)
+    {
+        aPeers.push_back(PeerInfo());
+        peer = &aPeers.back();
+        memcpy(peer->mPeerAddress, &aSession.mRemoteSock.sin6_addr, sizeof(peer->mPeerAddress));
+        peer->mSessions         = 0;
+        peer->mHandshakeCpuTime = 0;
+        peer->mRecordCpuTime    = 0;
+        peer->mHandlerCpuTime   = 0;
+    }
+
+    peer->mSessions++;
+    peer->mHandshakeCpuTime += aSession.mHandshakeCpuTime;
+    peer->mRecordCpuTime += aSession.mRecordCpuTime;
+    peer->mHandlerCpuTime += aSession.mHandlerCpuTime;
+}
+
+bool MbedtlsServer::VerifyClientHello(const DatagramIo::Datagram &aDatagram, const sockaddr_in6 &aLocalSock)
+{
+    const uint8_t *      record    = aDatagram.GetPayload();
+    const uint8_t *      handshake = record + kRecordHeaderSize;
+    const uint8_t *      body      = handshake + kHandshakeHeaderSize;
+    const unsigned char *info      = reinterpret_cast<const unsigned char *>(&aDatagram.GetPeerAddress());
+    uint32_t             length;
+    uint32_t             offset;
+    uint8_t              cookieLength;
+    bool                 verified = false;
+
+    // Only an unfragmented ClientHello of epoch 0 may start a session.
+    VerifyOrExit(aDatagram.GetLength() >= kRecordHeaderSize + kHandshakeHeaderSize);
+    VerifyOrExit(record[0] == kContentTypeHandshake && record[3] == 0 && record[4] == 0);
+    VerifyOrExit(handshake[0] == kHandshakeClientHello);
+
+    length = ReadUint24(handshake + 1);
+    VerifyOrExit(ReadUint24(handshake + 6) == 0 && ReadUint24(handshake + 9) == length);
+    VerifyOrExit(kRecordHeaderSize + kHandshakeHeaderSize + length <= aDatagram.GetLength());
+
+    // Skip client_version, random and session_id.
+    offset = 2 + 32;
+    VerifyOrExit(offset < length);
+    offset += 1 + body[offset];
+    VerifyOrExit(offset < length);
+    cookieLength = body[offset++];
+    VerifyOrExit(offset + cookieLength <= length);
+
+    verified = (cookieLength > 0 &&
+                HandleCookieCheck(this, body + offset, cookieLength, info, sizeof(aDatagram.GetPeerAddress())) == 0);
+
+    // The peer proved its address, it is asked again with a new cookie until handshakes are no longer deferred.
+    if (verified && mHandshakesDeferred)
+    {
+        sDeferredHandshakes.Add();
+        verified = false;
+    }
+
+    if (!verified)
+    {
+        SendHelloVerifyRequest(record, aDatagram.GetPeerAddress(), aLocalSock);
+    }
+
+exit:
+    return verified;
+}
+
+void MbedtlsServer::SendHelloVerifyRequest(const uint8_t *     aClientHello,
+                                           const sockaddr_in6 &aRemoteSock,
+                                           const sockaddr_in6 &aLocalSock)
+{
+    uint8_t              packet[kRecordHeaderSize + kHandshakeHeaderSize + 3 + kMaxSizeOfCookie];
+    uint8_t *            handshake = packet + kRecordHeaderSize;
+    uint8_t *            body      = handshake + kHandshakeHeaderSize;
+    unsigned char *      cookie    = body + 3;
+    const unsigned char *info      = reinterpret_cast<const unsigned char *>(&aRemoteSock);
+    uint32_t             length;
+
+    SuccessOrExit(HandleCookieWrite(this, &cookie, packet + sizeof(packet), info, sizeof(aRemoteSock)));
+    length = static_cast<uint32_t>(cookie - body);
+
+    // The record sequence number and message_seq of the ClientHello are echoed back as RFC 6347 suggests.
+    packet[0] = kContentTypeHandshake;
+    packet[1] = kDtlsVersionMajor;
+    packet[2] = kDtlsVersionMinor;
+    memcpy(packet + 3, aClientHello + 3, 8);
+    WriteUint16(packet + 11, static_cast<uint16_t>(kHandshakeHeaderSize + length));
+
+    handshake[0] = kHandshakeHelloVerifyRequest;
+    WriteUint24(handshake + 1, length);
+    memcpy(handshake + 4, aClientHello + kRecordHeaderSize + 4, 2);
+    WriteUint24(handshake + 6, 0);
+    WriteUint24(handshake + 9, length);
+
+    body[0] = kDtlsVersionMajor;
+    body[1] = kDtlsVersionMinor;
+    body[2] = static_cast<uint8_t>(length - 3);
+
+    otbrLog(OTBR_LOG_INFO, "DTLS hello verification requested.");
+    SendTo(packet, kRecordHeaderSize + kHandshakeHeaderSize + length, aRemoteSock, aLocalSock);
+
+exit:
+    return;
+}
+
+int MbedtlsServer::SendTo(const unsigned char *aBuffer,
+                          size_t               aLength,
+                          const sockaddr_in6 & aRemoteSock,
+                          const sockaddr_in6 & aLocalSock)
+{
+    int ret = static_cast<int>(aLength);
+
+    VerifyOrExit(aLength <= DatagramIo::kMaxSizeOfDatagram &&
+                     mIo.Send(aBuffer, static_cast<uint16_t>(aLength), aRemoteSock, aLocalSock) == OTBR_ERROR_NONE,
+                 ret = MBEDTLS_ERR_NET_SEND_FAILED);
+
+    // mbedtls does not fragment handshake messages, such records rely on IP fragmentation.
+    if (mMtu != 0 && aLength + kIp6UdpHeaderSize > mMtu)
+    {
+        sOversizedDatagrams.Add();
+    }
+
+    // Queued datagrams are sent once per mainloop iteration.
+    if (!mFlushTimer.IsRunning())
+    {
+        mTimerWheel->Start(mFlushTimer, 0);
+    }
+
+exit:
+    return ret;
+}
+
+void MbedtlsServer::HandleFlushTimer(void *aContext)
+{
+    static_cast<MbedtlsServer *>(aContext)->mIo.Flush();
+}
+
+void MbedtlsServer::HandleWorkerPool(void *aContext, int aFd, unsigned int aEvents)
+{
+    static_cast<MbedtlsServer *>(aContext)->mWorkerPool.Process();
+    (void)aFd;
+    (void)aEvents;
+}
+
+void MbedtlsServer::SchedulePrecompute(void)
+{
+    VerifyOrExit(!sEcjpakePool.IsFull());
+
+    if (IsOffloading())
+    {
+        VerifyOrExit(!mPrecomputeJob.IsPending());
+        mWorkerPool.Submit(mPrecomputeJob);
+    }
+    else if (!mPrecomputeTimer.IsRunning())
+    {
+        // Each key blocks the mainloop while computed, they are spread so that datagrams are processed in between.
+        mTimerWheel->Start(mPrecomputeTimer, kPrecomputeInterval);
+    }
+
+exit:
+    return;
+}
+
+void MbedtlsServer::HandlePrecomputeTimer(void *aContext)
+{
+    MbedtlsServer *server = static_cast<MbedtlsServer *>(aContext);
+
+    if (sEcjpakePool.Precompute(HandleRandom, server))
+    {
+        server->SchedulePrecompute();
+    }
+}
+
+void MbedtlsServer::HandlePrecomputeWork(void *aContext)
+{
+    MbedtlsServer *server = static_cast<MbedtlsServer *>(aContext);
+
+    // HandleRandom() uses the random generator of the calling thread, i.e. of this worker.
+    server->mPrecomputed = sEcjpakePool.Precompute(HandleRandom, server);
+}
+
+void MbedtlsServer::HandlePrecomputeDone(void *aContext)
+{
+    MbedtlsServer *server = static_cast<MbedtlsServer *>(aContext);
+
+    // Jobs completed while the workers stop are not submitted again.
+    if (server->mPrecomputed && server->mWorkerPool.IsRunning())
+    {
+        server->SchedulePrecompute();
+    }
+}
+
+int MbedtlsServer::HandleRandom(void *aContext, unsigned char *aBuffer, size_t aLength)
+{
+    mbedtls_ctr_drbg_context *drbg = GetThreadRandom();
+
+    (void)aContext;
+
+    return drbg != NULL ? mbedtls_ctr_drbg_random(drbg, aBuffer, aLength) : MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+}
+
+int MbedtlsServer::HandleCookieWrite(void *               aContext,
+                                     unsigned char **     aCookie,
+                                     unsigned char *      aEnd,
+                                     const unsigned char *aInfo,
+                                     size_t               aInfoLength)
+{
+    MbedtlsServer *server = static_cast<MbedtlsServer *>(aContext);
+    int            rval;
+
+    pthread_mutex_lock(&server->mLock);
+    rval = mbedtls_ssl_cookie_write(&server->mCookie, aCookie, aEnd, aInfo, aInfoLength);
+    pthread_mutex_unlock(&server->mLock);
+
+    return rval;
+}
+
+int MbedtlsServer::HandleCookieCheck(void *               aContext,
+                                     const unsigned char *aCookie,
+                                     size_t               aCookieLength,
+                                     const unsigned char *aInfo,
+                                     size_t               aInfoLength)
+{
+    MbedtlsServer *server = static_cast<MbedtlsServer *>(aContext);
+    int            rval;
+
+    pthread_mutex_lock(&server->mLock);
+    rval = mbedtls_ssl_cookie_check(&server->mCookie, aCookie, aCookieLength, aInfo, aInfoLength);
+    pthread_mutex_unlock(&server->mLock);
+
+    return rval;
+}
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+int MbedtlsServer::HandleCacheGet(void *aContext, mbedtls_ssl_session *aSession)
+{
+    MbedtlsServer *server = static_cast<MbedtlsServer *>(aContext);
+    int            rval;
+
+    pthread_mutex_lock(&server->mLock);
+    rval = mbedtls_ssl_cache_get(&server->mCache, aSession);
+
+    if (rval == 0)
+    {
+        server->mCacheHits++;
+    }
+    else
+    {
+        server->mCacheMisses++;
+    }
+
+    pthread_mutex_unlock(&server->mLock);
+
+    return rval;
+}
+
+int MbedtlsServer::HandleCacheSet(void *aContext, const mbedtls_ssl_session *aSession)
+{
+    MbedtlsServer *server = static_cast<MbedtlsServer *>(aContext);
+    int            rval;
+
+    pthread_mutex_lock(&server->mLock);
+    rval = mbedtls_ssl_cache_set(&server->mCache, aSession);
+    pthread_mutex_unlock(&server->mLock);
+
+    return rval;
+}
+#endif // MBEDTLS_SSL_CACHE_C
+
+void MbedtlsServer::SetSessionCache(unsigned int aMaxEntries, uint32_t aTimeout)
+{
+    mCacheEntries = aMaxEntries;
+    mCacheTimeout = aTimeout;
+}
+
+void MbedtlsServer::GetSessionCacheCounters(uint32_t &aHits, uint32_t &aMisses)
+{
+    pthread_mutex_lock(&mLock);
+    aHits   = mCacheHits;
+    aMisses = mCacheMisses;
+    pthread_mutex_unlock(&mLock);
+}
+
+unsigned int MbedtlsServer::GetSessions(SessionInfo *aInfos, unsigned int aMaxInfos) const
+{
+    uint64_t     now   = LoopClock::GetNow();
+    uint64_t     nowUs = GetMonotonicNowUs();
+    unsigned int count = 0;
+
+    for (MbedtlsSession *session = mSessions.GetFirst(); session != NULL; session = mSessions.GetNext(*session))
+    {
+        if (count < aMaxInfos)
+        {
+            SessionInfo &info = aInfos[count];
+
+            session->GetPeerAddress(info.mPeerAddress, info.mPeerPort);
+            info.mState            = session->mState;
+            info.mOffloaded        = session->mOffloaded;
+            info.mAge              = static_cast<uint32_t>((nowUs - session->mHandshakeStart) / 1000);
+            info.mIdleTime         = static_cast<uint32_t>(now - session->mLastActivity);
+            info.mRxBytes          = session->mRxBytes;
+            info.mTxBytes          = session->mTxBytes;
+            info.mHandshakeCpuTime = session->mHandshakeCpuTime;
+            info.mRecordCpuTime    = session->mRecordCpuTime;
+            info.mHandlerCpuTime   = session->mHandlerCpuTime;
+        }
+
+        ++count;
+    }
+
+    return count;
+}
+
+unsigned int MbedtlsServer::GetPeers(PeerInfo *aInfos, unsigned int aMaxInfos) const
+{
+    std::vector<PeerInfo> peers(mPeers);
+
+    for (MbedtlsSession *session = mSessions.GetFirst(); session != NULL; session = mSessions.GetNext(*session))
+    {
+        AddPeerTime(peers, *session);
+    }
+
+    for (unsigned int i = 0; i < aMaxInfos && i < peers.size(); ++i)
+    {
+        aInfos[i] = peers[i];
+    }
+
+    return static_cast<unsigned int>(peers.size());
+}
+
+void MbedtlsServer::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
+{
+    if (mTimerWheel == &mLocalTimerWheel)
+    {
+        mLocalTimerWheel.Process();
+    }
+
+    // Sockets are dispatched by the reactor directly.
+    VerifyOrExit(mReactor == NULL);
+
+    for (MbedtlsSession *session = mSessions.GetFirst(); session != NULL; session = mSessions.GetNext(*session))
+    {
+        int fd = session->GetFd();
+
+        if (fd >= 0 && fd != mSocket && session->HasPendingWrites() && FD_ISSET(fd, &aWriteFdSet))
+        {
+            session->FlushWrites();
+        }
+
+        if (fd >= 0 && fd != mSocket && FD_ISSET(fd, &aReadFdSet))
+        {
+            otbrLogSampled(OTBR_LOG_INFO, kLogSampleRate, "DTLS session [%d] become readable.", fd);
+            session->Process();
+        }
+    }
+
+    if (mWorkerPool.GetFd() >= 0 && FD_ISSET(mWorkerPool.GetFd(), &aReadFdSet))
+    {
+        mWorkerPool.Process();
+    }
+
+    ProcessServer(aReadFdSet, aWriteFdSet, aErrorFdSet);
+
+exit:
+    return;
+}
+
+otbrError MbedtlsServer::SetPSK(const uint8_t *aPSK, uint8_t aLength)
 {
     assert(aPSK && aLength > 0);
 
@@ -613,6 +2250,19 @@ otbrError MbedtlsServer::SetPSK(const uint8_t *aPSK, uint8_t aLength)
 
     VerifyOrExit(aLength <= sizeof(mPSK), errno = EINVAL);
 
+#if defined(MBEDTLS_SSL_CACHE_C)
+    // Sessions established with the previous PSK must not be resumed.
+    if (aLength != mPSKLength || memcmp(mPSK, aPSK, aLength))
+    {
+        pthread_mutex_lock(&mLock);
+        mbedtls_ssl_cache_free(&mCache);
+        mbedtls_ssl_cache_init(&mCache);
+        mbedtls_ssl_cache_set_max_entries(&mCache, static_cast<int>(mCacheEntries));
+        mbedtls_ssl_cache_set_timeout(&mCache, static_cast<int>(mCacheTimeout));
+        pthread_mutex_unlock(&mLock);
+    }
+#endif
+
     memcpy(mPSK, aPSK, aLength);
     mPSKLength = aLength;
     ret        = OTBR_ERROR_NONE;
@@ -623,13 +2273,31 @@ exit:
 
 MbedtlsServer::~MbedtlsServer(void)
 {
-    SessionSet::iterator it = mSessions.begin();
+    // Handshakes running on workers are completed before sessions are destroyed.
+    if (mWorkerWatch.mFd >= 0)
+    {
+        mReactor->Remove(mWorkerWatch);
+    }
+
+    mWorkerPool.Stop();
 
-    while (it != mSessions.end())
+    for (MbedtlsSession *session = mSessions.GetFirst(); session != NULL; session = mSessions.GetFirst())
     {
-        MbedtlsSession *session = *it;
+        mSessions.Remove(*session);
         delete session;
-        it = mSessions.erase(it);
+        sSessionsInUse.Subtract();
+    }
+
+    for (size_t i = 0; i < mFreeSessions.size(); ++i)
+    {
+        delete mFreeSessions[i];
+    }
+
+    mIo.Flush();
+
+    if (mWatch.mFd >= 0)
+    {
+        mReactor->Remove(mWatch);
     }
 
     close(mSocket);
@@ -638,8 +2306,7 @@ MbedtlsServer::~MbedtlsServer(void)
 #if defined(MBEDTLS_SSL_CACHE_C)
     mbedtls_ssl_cache_free(&mCache);
 #endif
-    mbedtls_ctr_drbg_free(&mCtrDrbg);
-    mbedtls_entropy_free(&mEntropy);
+    pthread_mutex_destroy(&mLock);
 }
 
 otbrError MbedtlsServer::SetSeed(const uint8_t *aSeed, uint16_t aLength)
@@ -660,6 +2327,350 @@ exit:
     return ret;
 }
 
+Client *Client::Create(StateHandler aStateHandler, void *aContext)
+{
+    return new MbedtlsClient(aStateHandler, aContext);
+}
+
+void Client::Destroy(Client *aClient)
+{
+    delete static_cast<MbedtlsClient *>(aClient);
+}
+
+MbedtlsClient::MbedtlsClient(StateHandler aStateHandler, void *aContext)
+    : mStateHandler(aStateHandler)
+    , mContext(aContext)
+    , mDataHandler(NULL)
+    , mDataContext(NULL)
+    , mState(Session::kStateEnd)
+    , mConnected(false)
+    , mIntermediateTime(0)
+    , mFinalTime(0)
+    , mDelayCancelled(true)
+    , mHandshakeTimeoutMin(kHandshakeTimeoutMin)
+    , mHandshakeTimeoutMax(kHandshakeTimeoutMax)
+    , mPSKLength(0)
+{
+    memset(mKek, 0, sizeof(mKek));
+    mbedtls_net_init(&mNet);
+    mbedtls_ssl_config_init(&mConf);
+    mbedtls_ssl_init(&mSsl);
+}
+
+MbedtlsClient::~MbedtlsClient(void)
+{
+    mbedtls_ssl_free(&mSsl);
+    mbedtls_ssl_config_free(&mConf);
+    mbedtls_net_free(&mNet);
+}
+
+otbrError MbedtlsClient::SetPSK(const uint8_t *aPSK, uint8_t aLength)
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+
+    VerifyOrExit(aLength <= sizeof(mPSK), errno = EINVAL);
+
+    memcpy(mPSK, aPSK, aLength);
+    mPSKLength = aLength;
+    ret        = OTBR_ERROR_NONE;
+
+exit:
+    return ret;
+}
+
+void MbedtlsClient::SetHandshakeTimeouts(uint32_t aMin, uint32_t aMax)
+{
+    mHandshakeTimeoutMin = aMin;
+    mHandshakeTimeoutMax = aMax;
+}
+
+void MbedtlsClient::SetDataHandler(Session::DataHandler aDataHandler, void *aContext)
+{
+    mDataHandler = aDataHandler;
+    mDataContext = aContext;
+}
+
+otbrError MbedtlsClient::Connect(const char *aHost, const char *aPort)
+{
+    static const int ciphersuites[] = {MBEDTLS_TLS_ECJPAKE_WITH_AES_128_CCM_8, 0};
+    otbrError        ret            = OTBR_ERROR_DTLS;
+    int              error;
+
+    VerifyOrExit(!mConnected, ret = OTBR_ERROR_ERRNO; errno = EISCONN);
+
+    UpdateDebugThreshold();
+
+    // Connecting a UDP socket does not wait for the peer, only the name resolution may block.
+    VerifyOrExit(mbedtls_net_connect(&mNet, aHost, aPort, MBEDTLS_NET_PROTO_UDP) == 0 &&
+                     mbedtls_net_set_nonblock(&mNet) == 0,
+                 ret = OTBR_ERROR_ERRNO);
+
+    SuccessOrExit(error = mbedtls_ssl_config_defaults(&mConf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_DATAGRAM,
+                                                      MBEDTLS_SSL_PRESET_DEFAULT));
+
+    mbedtls_ssl_conf_rng(&mConf, HandleRandom, this);
+    mbedtls_ssl_conf_min_version(&mConf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
+    mbedtls_ssl_conf_max_version(&mConf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
+    mbedtls_ssl_conf_authmode(&mConf, MBEDTLS_SSL_VERIFY_NONE);
+    mbedtls_ssl_conf_dbg(&mConf, MbedtlsDebug, this);
+    mbedtls_ssl_conf_ciphersuites(&mConf, ciphersuites);
+    mbedtls_ssl_conf_read_timeout(&mConf, 0);
+    mbedtls_ssl_conf_handshake_timeout(&mConf, mHandshakeTimeoutMin, mHandshakeTimeoutMax);
+
+    // Unlike the server, each client has its own configuration to receive its keys.
+    mbedtls_ssl_conf_export_keys_cb(&mConf, ExportKeys, this);
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    SuccessOrExit(error = mbedtls_ssl_conf_max_frag_len(&mConf, GetMaxFragmentCode()));
+#endif
+
+    SuccessOrExit(error = mbedtls_ssl_setup(&mSsl, &mConf));
+    mConnected = true;
+
+    SuccessOrExit(error = mbedtls_ssl_set_hs_ecjpake_password(&mSsl, mPSK, mPSKLength));
+    mbedtls_ssl_set_bio(&mSsl, &mNet, mbedtls_net_send, mbedtls_net_recv, NULL);
+    mbedtls_ssl_set_timer_cb(&mSsl, this, SetDelay, GetDelay);
+
+    mState = Session::kStateHandshaking;
+    ret    = OTBR_ERROR_NONE;
+
+    // Sends the ClientHello, the handshake continues from Process().
+    Handshake();
+
+exit:
+    if (ret == OTBR_ERROR_DTLS)
+    {
+        otbrLog(OTBR_LOG_ERR, "DTLS client failed to start: -0x%04x!", -error);
+    }
+
+    return ret;
+}
+
+ssize_t MbedtlsClient::Write(const uint8_t *aBuffer, uint16_t aLength)
+{
+    int ret;
+
+    VerifyOrExit(mState == Session::kStateReady, ret = -1; errno = ENOTCONN);
+
+    ret = mbedtls_ssl_write(&mSsl, aBuffer, aLength);
+
+    if (ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == MBEDTLS_ERR_SSL_WANT_READ)
+    {
+        errno = EAGAIN;
+        ret   = -1;
+    }
+
+exit:
+    return ret;
+}
+
+void MbedtlsClient::Close(void)
+{
+    int ret;
+
+    VerifyOrExit(mState == Session::kStateHandshaking || mState == Session::kStateReady);
+
+    // The alert is best effort, the client never waits for the socket.
+    ret = mbedtls_ssl_close_notify(&mSsl);
+
+    if (ret != 0)
+    {
+        otbrLog(OTBR_LOG_WARNING, "DTLS failed to send close notify: -0x%04x.", -ret);
+    }
+
+    mState = Session::kStateEnd;
+
+exit:
+    return;
+}
+
+void MbedtlsClient::UpdateFdSet(fd_set & aReadFdSet,
+                                fd_set & aWriteFdSet,
+                                fd_set & aErrorFdSet,
+                                int &    aMaxFd,
+                                timeval &aTimeout)
+{
+    VerifyOrExit(mState == Session::kStateHandshaking || mState == Session::kStateReady);
+
+    FD_SET(mNet.fd, &aReadFdSet);
+
+    if (aMaxFd < mNet.fd)
+    {
+        aMaxFd = mNet.fd;
+    }
+
+    if (mState == Session::kStateHandshaking && !mDelayCancelled)
+    {
+        uint64_t now     = LoopClock::GetNow();
+        uint64_t timeout = mFinalTime > now ? mFinalTime - now : 0;
+
+        if (static_cast<uint64_t>(aTimeout.tv_sec) * 1000 + static_cast<uint64_t>(aTimeout.tv_usec) / 1000 > timeout)
+        {
+            aTimeout.tv_sec  = static_cast<time_t>(timeout / 1000);
+            aTimeout.tv_usec = static_cast<suseconds_t>((timeout % 1000) * 1000);
+        }
+    }
+
+exit:
+    (void)aWriteFdSet;
+    (void)aErrorFdSet;
+}
+
+void MbedtlsClient::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
+{
+    bool readable;
+
+    VerifyOrExit(mState == Session::kStateHandshaking || mState == Session::kStateReady);
+
+    readable = FD_ISSET(mNet.fd, &aReadFdSet);
+
+    if (mState == Session::kStateHandshaking)
+    {
+        // A handshake flight is retransmitted once its timer expires.
+        if (readable || (!mDelayCancelled && LoopClock::GetNow() >= mFinalTime))
+        {
+            Handshake();
+        }
+    }
+    else if (readable)
+    {
+        Read();
+    }
+
+exit:
+    (void)aWriteFdSet;
+    (void)aErrorFdSet;
+}
+
+void MbedtlsClient::Handshake(void)
+{
+    int ret = mbedtls_ssl_handshake(&mSsl);
+
+    if (ret == 0)
+    {
+        otbrLog(OTBR_LOG_INFO, "DTLS client ready.");
+        SetState(Session::kStateReady);
+    }
+    else if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+        otbrLog(OTBR_LOG_DEBUG, "DTLS client handshake pending: -0x%04x.", -ret);
+    }
+    else
+    {
+        otbrLog(OTBR_LOG_ERR, "DTLS client handshake failed: -0x%04x!", -ret);
+        SetState(Session::kStateError);
+    }
+}
+
+void MbedtlsClient::Read(void)
+{
+    uint8_t buffer[kMaxSizeOfRecord];
+    int     ret;
+
+    // Records are read until the socket would block, or the session ends from a handler.
+    while (mState == Session::kStateReady)
+    {
+        ret = mbedtls_ssl_read(&mSsl, buffer, sizeof(buffer));
+
+        if (ret > 0)
+        {
+            if (mDataHandler != NULL)
+            {
+                mDataHandler(buffer, static_cast<uint16_t>(ret), mDataContext);
+            }
+        }
+        else if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == 0)
+        {
+            break;
+        }
+        else if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY)
+        {
+            otbrLog(OTBR_LOG_INFO, "DTLS client closed by peer.");
+            SetState(Session::kStateClose);
+        }
+        else
+        {
+            otbrLog(OTBR_LOG_ERR, "DTLS client read failed: -0x%04x!", -ret);
+            SetState(Session::kStateError);
+        }
+    }
+}
+
+void MbedtlsClient::SetState(Session::State aState)
+{
+    mState = aState;
+
+    if (mStateHandler != NULL)
+    {
+        mStateHandler(*this, aState, mContext);
+    }
+}
+
+int MbedtlsClient::HandleRandom(void *aContext, unsigned char *aBuffer, size_t aLength)
+{
+    mbedtls_ctr_drbg_context *drbg = GetThreadRandom();
+
+    (void)aContext;
+
+    return drbg != NULL ? mbedtls_ctr_drbg_random(drbg, aBuffer, aLength) : MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+}
+
+int MbedtlsClient::ExportKeys(void *               aContext,
+                              const unsigned char *aMasterSecret,
+                              const unsigned char *aKeyBlock,
+                              size_t               aMacLength,
+                              size_t               aKeyLength,
+                              size_t               aIvLength)
+{
+    MbedtlsClient *        client = static_cast<MbedtlsClient *>(aContext);
+    mbedtls_sha256_context sha256;
+
+    mbedtls_sha256_init(&sha256);
+    mbedtls_sha256_starts(&sha256, 0);
+    mbedtls_sha256_update(&sha256, aKeyBlock, 2 * static_cast<uint16_t>(aMacLength + aKeyLength + aIvLength));
+    mbedtls_sha256_finish(&sha256, client->mKek);
+    mbedtls_sha256_free(&sha256);
+
+    (void)aMasterSecret;
+    return 0;
+}
+
+void MbedtlsClient::SetDelay(void *aContext, uint32_t aIntermediate, uint32_t aFinal)
+{
+    MbedtlsClient *client = static_cast<MbedtlsClient *>(aContext);
+    uint64_t       now    = LoopClock::GetNow();
+
+    client->mDelayCancelled   = (aFinal == 0);
+    client->mIntermediateTime = now + aIntermediate;
+    client->mFinalTime        = now + aFinal;
+}
+
+int MbedtlsClient::GetDelay(void *aContext)
+{
+    const MbedtlsClient *client = static_cast<const MbedtlsClient *>(aContext);
+    uint64_t             now    = LoopClock::GetNow();
+    int                  rval;
+
+    // Return values are defined by mbedtls_ssl_get_timer_t.
+    if (client->mDelayCancelled)
+    {
+        rval = -1;
+    }
+    else if (now >= client->mFinalTime)
+    {
+        rval = 2;
+    }
+    else if (now >= client->mIntermediateTime)
+    {
+        rval = 1;
+    }
+    else
+    {
+        rval = 0;
+    }
+
+    return rval;
+}
+
 } // namespace Dtls
 
 } // namespace BorderRouter
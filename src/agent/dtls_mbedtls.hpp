@@ -37,6 +37,7 @@
 #include <vector>
 
 #include <netinet/in.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -56,12 +57,10 @@ extern "C" {
 #include <mbedtls/ctr_drbg.h>
 #include <mbedtls/debug.h>
 #include <mbedtls/ecjpake.h>
-#include <mbedtls/entropy.h>
 #include <mbedtls/error.h>
 #include <mbedtls/net_sockets.h>
 #include <mbedtls/ssl.h>
 #include <mbedtls/ssl_cookie.h>
-#include <mbedtls/timing.h>
 
 #if defined(MBEDTLS_SSL_CACHE_C)
 #include <mbedtls/ssl_cache.h>
@@ -69,8 +68,14 @@ extern "C" {
 
 } // extern "C"
 
+#include "datagram_io.hpp"
 #include "dtls.hpp"
+#include "ecjpake_pool.hpp"
+#include "common/capacity.hpp"
+#include "common/output_scheduler.hpp"
+#include "common/packet_ring.hpp"
 #include "common/types.hpp"
+#include "common/worker_pool.hpp"
 
 namespace ot {
 
@@ -88,11 +93,14 @@ namespace Dtls {
  */
 
 class MbedtlsServer;
+class SessionTable;
 
 enum
 {
     kMaxSizeOfPacket  = 1500, ///< Max size of packet in bytes.
     kMaxSizeOfControl = 1500, ///< Max size of control message in bytes.
+    kMaxSizeOfRecord  = MBEDTLS_SSL_MAX_CONTENT_LEN < kMaxSizeOfPacket ? MBEDTLS_SSL_MAX_CONTENT_LEN
+                                                                       : kMaxSizeOfPacket, ///< Max size of read data.
 };
 
 /**
@@ -102,35 +110,60 @@ enum
 class MbedtlsSession : public Session
 {
     friend class MbedtlsServer;
+    friend class SessionTable;
 
 public:
     /**
-     * The constructor to initialize a DTLS session.
+     * The constructor to initialize a released DTLS session.
      *
      * @param[in]   aServer     A reference to the DTLS server.
+     *
+     */
+    explicit MbedtlsSession(MbedtlsServer &aServer);
+
+    ~MbedtlsSession(void);
+
+    /**
+     * This method initialize the session for a new peer.
+     *
+     * The ssl context is set up by the first initialization and reset by later ones.
+     *
      * @param[in]   aNet        A reference to the mbedtls_net_context.
      * @param[in]   aRemoteSock A reference to the remote sockaddr of this session.
      * @param[in]   aLocalSock  A reference to the local sockaddr of this session.
      *
+     * @retval  OTBR_ERROR_NONE     Initialized successfully.
+     * @retval  OTBR_ERROR_DTLS     Failed to initialize.
+     *
      */
-    MbedtlsSession(MbedtlsServer &            aServer,
-                   const mbedtls_net_context &aNet,
+    otbrError Init(const mbedtls_net_context &aNet,
                    const struct sockaddr_in6 &aRemoteSock,
                    const struct sockaddr_in6 &aLocalSock);
 
-    ~MbedtlsSession(void);
+    /**
+     * This method closes the session and releases its socket and timers, keeping the ssl context for reuse.
+     *
+     */
+    void Release(void);
+
+    ssize_t Write(const uint8_t *aBuffer, uint16_t aLength, Priority aPriority = kPriorityControl);
+    ssize_t WriteVector(const struct iovec *aVector, int aCount, Priority aPriority = kPriorityControl);
+    void    SetDataHandler(DataHandler aDataHandler, void *aContext);
 
     /**
-     * This method initialize the session.
+     * This method returns whether any message is queued until the session socket becomes writable.
      *
-     * @retval  OTBR_ERROR_NONE     Initialized successfully.
-     * @retval  OTBR_ERROR_DTLS     Failed to initialize.
+     * @retval  true    There are messages queued.
+     * @retval  false   The output queue is empty.
      *
      */
-    otbrError Init(void);
+    bool HasPendingWrites(void) const { return !mTxQueue.IsEmpty(); }
 
-    ssize_t Write(const uint8_t *aBuffer, uint16_t aLength);
-    void    SetDataHandler(DataHandler aDataHandler, void *aContext);
+    /**
+     * This method writes the queued messages when the session socket is writable.
+     *
+     */
+    void FlushWrites(void);
 
     /**
      * This method returns the current state of this session.
@@ -149,25 +182,38 @@ public:
     int GetFd(void) const { return mNet.fd; }
 
     /**
-     * This method returns the expiration of this session.
+     * This method returns the exported KEK of this session.
      *
-     * @returns Expiration in miniseconds.
+     * @returns A pointer to the KEK data.
+     */
+    const uint8_t *GetKek(void) { return mKek; }
+
+    void GetPeerAddress(uint8_t *aIp6, uint16_t &aPort) const;
+
+    /**
+     * This method performs the session processing when the session socket is readable.
      *
      */
-    uint64_t GetExpiration() const { return mExpiration; }
+    void Process(void);
 
     /**
-     * This method returns the exported KEK of this session.
+     * This method performs the session processing of a datagram received on the server socket.
+     *
+     * @param[in]   aBuffer     A pointer to the datagram, which must stay valid during this call.
+     * @param[in]   aLength     Number of bytes of @p aBuffer.
      *
-     * @returns A pointer to the KEK data.
      */
-    const uint8_t *GetKek(void) { return mKek; }
+    void Input(const uint8_t *aBuffer, uint16_t aLength);
 
     /**
-     * This method performs the session processing.
+     * This method is called by the reactor when the session socket is ready.
+     *
+     * @param[in]   aContext    A pointer to the session.
+     * @param[in]   aFd         The session socket.
+     * @param[in]   aEvents     The events happened.
      *
      */
-    void Process(void);
+    static void HandleReactor(void *aContext, int aFd, unsigned int aEvents);
 
     /**
      * This method closes the DTLS session.
@@ -178,8 +224,12 @@ public:
 private:
     enum
     {
-        kSessionTimeout = 60000, ///< Default DTLS session timeout in miniseconds.
-        kKekSize        = 32,    ///< Size of KEK.
+        kKekSize         = 32, ///< Size of KEK.
+        kMaxTxControl    = 4,  ///< Max number of control messages queued for the session socket.
+        kMaxTxManagement = 4,  ///< Max number of management messages queued for the session socket.
+        kMaxTxBulk       = 8,  ///< Max number of relayed messages queued for the session socket.
+        kMaxInbox        = 8,  ///< Max number of datagrams received while handshaking on a worker.
+        kMaxOutbox       = 16, ///< Max number of datagrams sent by a handshake on a worker.
     };
 
     static int ExportKeys(void *               aContext,
@@ -188,10 +238,27 @@ private:
                           size_t               aMacLength,
                           size_t               aKeyLength,
                           size_t               aIvLength);
-    int        Handshake(void);
-    int        Read(void);
-    void       SetState(State aState);
-    static int SendMbedtls(void *aContext, const unsigned char *aBuffer, size_t aLength)
+    int         Handshake(void);
+    int         RunHandshake(uint64_t &aCpuTime);
+    uint64_t    AddRecordCpuTime(uint64_t aStart);
+    void        HandleHandshakeResult(int aResult);
+    void        SubmitHandshake(void);
+    static void HandleHandshakeWork(void *aContext);
+    static void HandleHandshakeDone(void *aContext);
+    void        HandleHandshakeDone(void);
+    void        PopJobInput(void);
+    static bool InitRing(PacketRing &aRing, uint16_t aCapacity);
+    bool        InitTxQueue(void);
+    void        UpdateRetransmissionTimer(void);
+    void        UpdateExpirationTimer(void);
+    int         Read(void);
+    void        SetState(State aState);
+    bool        IsAlive(void) const { return mState == kStateHandshaking || mState == kStateReady; }
+    static void HandleExpirationTimer(void *aContext);
+    static void HandleRetransmissionTimer(void *aContext);
+    static void SetDelay(void *aContext, uint32_t aIntermediate, uint32_t aFinal);
+    static int  GetDelay(void *aContext);
+    static int  SendMbedtls(void *aContext, const unsigned char *aBuffer, size_t aLength)
     {
         return static_cast<MbedtlsSession *>(aContext)->SendMbedtls(aBuffer, aLength);
     }
@@ -202,19 +269,124 @@ private:
         return static_cast<MbedtlsSession *>(aContext)->ReadMbedtls(aBuffer, aLength);
     }
     int ReadMbedtls(unsigned char *aBuffer, size_t aLength);
+    int  Connect(void);
+    int  Reset(void);
+    void WatchWritable(bool aEnabled);
+
+    mbedtls_net_context mNet;
+    mbedtls_ssl_context mSsl;
+
+    DataHandler     mDataHandler;
+    void *          mContext;
+    State           mState;
+    sockaddr_in6    mRemoteSock;
+    sockaddr_in6    mLocalSock;
+    MbedtlsServer & mServer;
+    MbedtlsSession *mNextInTable;      ///< The next session in the same bucket of the session table.
+    const uint8_t * mPendingData;      ///< The datagram received on the server socket not yet read by mbedtls.
+    uint16_t        mPendingLength;    ///< Number of bytes of mPendingData.
+    uint8_t         mKek[kKekSize];
+    Reactor::Watch  mWatch;
+    Timer           mExpirationTimer;
+    Timer           mRetransmissionTimer;
+    uint64_t        mIntermediateTime; ///< Intermediate time of the mbedtls retransmission delay.
+    uint64_t        mFinalTime;        ///< Final time of the mbedtls retransmission delay.
+    uint64_t        mHandshakeStart;   ///< When the session started handshaking, in microseconds.
+    uint64_t        mLastActivity;     ///< When the session last received a datagram, in milliseconds.
+    uint64_t        mRxBytes;          ///< Bytes of application data received.
+    uint64_t        mTxBytes;          ///< Bytes of application data sent or queued.
+    uint64_t        mHandshakeCpuTime; ///< CPU time of the handshake in microseconds, on the mainloop or workers.
+    uint64_t        mRecordCpuTime;    ///< CPU time of reading and writing records in microseconds.
+    uint64_t        mHandlerCpuTime;   ///< CPU time of the data handler in microseconds.
+    uint32_t        mRetransmissions;  ///< Number of flights retransmitted by the current handshake.
+    bool            mDelayCancelled;
+
+    OutputScheduler mTxQueue; ///< Messages to write once writable, the front is kept by mbedtls.
+
+    WorkerPool::Job mHandshakeJob;
+    PacketRing      mInbox;           ///< Datagrams received while handshaking on a worker, the first may be read.
+    PacketRing      mOutbox;          ///< Datagrams sent while handshaking on a worker.
+    bool            mJobInput;        ///< Whether the handshake on a worker reads the first datagram of mInbox.
+    int             mHandshakeResult; ///< The result of the handshake on a worker.
+    uint64_t        mJobCpuTime;      ///< CPU time of the handshake on a worker in microseconds.
+    bool            mOffloaded;       ///< Whether the handshake is running on a worker.
+    bool            mDelayUpdated;    ///< Whether the delay was set while running on a worker.
+    bool            mCloseRequested;  ///< Whether closed while running on a worker.
+    bool            mExpired;         ///< Whether expired while running on a worker.
+    bool            mSslSetup;        ///< Whether mSsl is set up with the configuration.
+};
 
-    mbedtls_net_context          mNet;
-    mbedtls_timing_delay_context mTimer;
-    mbedtls_ssl_context          mSsl;
+/**
+ * This class implements a hash table of DTLS sessions keyed by the remote socket address.
+ *
+ */
+class SessionTable
+{
+public:
+    /**
+     * The constructor to initialize an empty session table.
+     *
+     */
+    SessionTable(void);
 
-    DataHandler    mDataHandler;
-    void *         mContext;
-    State          mState;
-    sockaddr_in6   mRemoteSock;
-    sockaddr_in6   mLocalSock;
-    MbedtlsServer &mServer;
-    unsigned long  mExpiration;
-    uint8_t        mKek[kKekSize];
+    /**
+     * This method adds a session to the table.
+     *
+     * @param[in]   aSession    A reference to the session, whose remote address is not in the table.
+     *
+     */
+    void Add(MbedtlsSession &aSession);
+
+    /**
+     * This method removes a session from the table.
+     *
+     * @param[in]   aSession    A reference to the session in the table.
+     *
+     */
+    void Remove(MbedtlsSession &aSession);
+
+    /**
+     * This method finds the session of a remote socket address.
+     *
+     * @param[in]   aSockAddr   A reference to the remote socket address.
+     *
+     * @returns A pointer to the session, NULL if not found.
+     *
+     */
+    MbedtlsSession *Find(const sockaddr_in6 &aSockAddr) const;
+
+    /**
+     * This method returns the first session in the table.
+     *
+     * @returns A pointer to the first session, NULL if the table is empty.
+     *
+     */
+    MbedtlsSession *GetFirst(void) const { return GetNext(0); }
+
+    /**
+     * This method returns the session following the given one.
+     *
+     * @param[in]   aSession    A reference to a session in the table.
+     *
+     * @returns A pointer to the next session, NULL if @p aSession is the last one.
+     *
+     */
+    MbedtlsSession *GetNext(const MbedtlsSession &aSession) const;
+
+private:
+    enum
+    {
+        kInitialBuckets = 16, ///< Initial number of buckets, must be power of 2.
+    };
+
+    static size_t   Hash(const sockaddr_in6 &aSockAddr);
+    static bool     Equals(const sockaddr_in6 &aFirst, const sockaddr_in6 &aSecond);
+    size_t          GetBucket(const sockaddr_in6 &aSockAddr) const { return Hash(aSockAddr) & (mBuckets.size() - 1); }
+    MbedtlsSession *GetNext(size_t aBucket) const;
+    void            Grow(void);
+
+    std::vector<MbedtlsSession *> mBuckets;
+    size_t                        mSize;
 };
 
 /**
@@ -232,14 +404,48 @@ public:
      * @param[in]   aPort               The listening port of this DTLS server.
      * @param[in]   aStateHandler       A pointer to the function to be called when an session's state changed.
      * @param[in]   aContext            A pointer to application-specific context.
+     * @param[in]   aReactor            A pointer to the reactor, NULL to use the fd_set interface.
+     * @param[in]   aTimerWheel         A pointer to the timer wheel, NULL to use a private one processed by
+     *                                  UpdateFdSet() and Process().
      *
      */
-    MbedtlsServer(uint16_t aPort, StateHandler aStateHandler, void *aContext)
+    MbedtlsServer(uint16_t     aPort,
+                  StateHandler aStateHandler,
+                  void *       aContext,
+                  Reactor *    aReactor,
+                  TimerWheel * aTimerWheel)
         : mSocket(-1)
         , mPort(aPort)
         , mStateHandler(aStateHandler)
         , mContext(aContext)
+        , mReactor(aReactor)
+        , mTimerWheel(aTimerWheel != NULL ? aTimerWheel : &mLocalTimerWheel)
+        , mReleaseTimer(HandleReleaseTimer, this)
+        , mFlushTimer(HandleFlushTimer, this)
+        , mPrecomputeTimer(HandlePrecomputeTimer, this)
+        , mSharedSocket(false)
+        , mRecordFilter(false)
+        , mHandshakesDeferred(false)
+        , mHandshakeWorkers(0)
+        , mMaxSessions(kDefaultMaxSessions)
+        , mSessionCount(0)
+        , mHandshakeTimeout(kDefaultSessionTimeout)
+        , mIdleTimeout(kDefaultSessionTimeout)
+        , mRetransmissionTimeoutMin(MBEDTLS_SSL_DTLS_TIMEOUT_DFL_MIN)
+        , mRetransmissionTimeoutMax(MBEDTLS_SSL_DTLS_TIMEOUT_DFL_MAX)
+        , mMtu(kDefaultMtu)
+        , mPrecomputeJob(HandlePrecomputeWork, HandlePrecomputeDone, this)
+        , mPrecomputed(false)
+        , mCacheEntries(kDefaultCacheEntries)
+        , mCacheTimeout(kDefaultCacheTimeout)
+        , mCacheHits(0)
+        , mCacheMisses(0)
+        , mPSKLength(0)
     {
+        pthread_mutex_init(&mLock, NULL);
+#if defined(MBEDTLS_SSL_CACHE_C)
+        mbedtls_ssl_cache_init(&mCache);
+#endif
     }
 
     ~MbedtlsServer(void);
@@ -254,6 +460,121 @@ public:
      */
     virtual otbrError Start(void);
 
+    /**
+     * This method sets whether all sessions share the listening socket.
+     *
+     * @param[in]   aEnabled            Whether to share the listening socket.
+     *
+     */
+    void SetSharedSocket(bool aEnabled) { mSharedSocket = aEnabled; }
+
+    /**
+     * This method sets whether the listening socket drops datagrams not starting with a DTLS record header.
+     *
+     * @param[in]   aEnabled            Whether to filter the datagrams of the listening socket.
+     *
+     */
+    void SetRecordFilter(bool aEnabled) { mRecordFilter = aEnabled; }
+
+    /**
+     * This method sets the number of worker threads running DTLS handshakes.
+     *
+     * @param[in]   aCount              The number of worker threads, 0 to run handshakes on the mainloop.
+     *
+     */
+    void SetHandshakeWorkers(unsigned int aCount) { mHandshakeWorkers = aCount; }
+
+    /**
+     * This method sets the max number of sessions, which bounds the sessions ever allocated.
+     *
+     * @param[in]   aCount              The max number of sessions, must be greater than 0.
+     *
+     */
+    void SetMaxSessions(unsigned int aCount) { mMaxSessions = aCount; }
+
+    /**
+     * This method sets whether handshakes of new peers are deferred.
+     *
+     * @param[in]   aDeferred           Whether to answer new peers with a HelloVerifyRequest only.
+     *
+     */
+    void SetHandshakesDeferred(bool aDeferred) { mHandshakesDeferred = aDeferred; }
+
+    /**
+     * This method sets the time sessions are kept without receiving anything.
+     *
+     * @param[in]   aHandshakeTimeout   The timeout of handshaking sessions in milliseconds, 0 to keep it.
+     * @param[in]   aIdleTimeout        The timeout of established sessions in milliseconds, 0 to keep it.
+     *
+     */
+    void SetSessionTimeouts(uint32_t aHandshakeTimeout, uint32_t aIdleTimeout)
+    {
+        mHandshakeTimeout = aHandshakeTimeout != 0 ? aHandshakeTimeout : mHandshakeTimeout;
+        mIdleTimeout      = aIdleTimeout != 0 ? aIdleTimeout : mIdleTimeout;
+    }
+
+    /**
+     * This method sets the size and timeout of the session cache.
+     *
+     * @param[in]   aMaxEntries         The max number of cached sessions, 0 to disable resumption.
+     * @param[in]   aTimeout            The lifetime of cached sessions in seconds, 0 for no timeout.
+     *
+     */
+    void SetSessionCache(unsigned int aMaxEntries, uint32_t aTimeout);
+
+    /**
+     * This method sets the retransmission timeouts of handshakes.
+     *
+     * @param[in]   aMin                The initial timeout in milliseconds, 0 to keep it.
+     * @param[in]   aMax                The max timeout in milliseconds, 0 to keep it.
+     *
+     */
+    void SetRetransmissionTimeouts(uint32_t aMin, uint32_t aMax)
+    {
+        mRetransmissionTimeoutMin = aMin != 0 ? aMin : mRetransmissionTimeoutMin;
+        mRetransmissionTimeoutMax = aMax != 0 ? aMax : mRetransmissionTimeoutMax;
+    }
+
+    /**
+     * This method sets the MTU of the path to peers.
+     *
+     * @param[in]   aMtu                The MTU in bytes, including the IPv6 and UDP headers, 0 to never group
+     *                                  records.
+     *
+     */
+    void SetMtu(uint16_t aMtu) { mMtu = aMtu; }
+
+    /**
+     * This method returns the counters of the session cache.
+     *
+     * @param[out]  aHits               The number of sessions resumed.
+     * @param[out]  aMisses             The number of sessions offered by peers but not found.
+     *
+     */
+    void GetSessionCacheCounters(uint32_t &aHits, uint32_t &aMisses);
+
+    /**
+     * This method returns the state of the sessions in use.
+     *
+     * @param[out]  aInfos              A pointer to an array to receive the state of the sessions.
+     * @param[in]   aMaxInfos           The number of entries of @p aInfos.
+     *
+     * @returns The number of sessions in use, which may be more than @p aMaxInfos.
+     *
+     */
+    unsigned int GetSessions(SessionInfo *aInfos, unsigned int aMaxInfos) const;
+
+    /**
+     * This method returns the CPU time of the sessions of each peer, released or in use.
+     *
+     * @param[out]  aInfos              A pointer to an array to receive the peers.
+     * @param[in]   aMaxInfos           The number of entries of @p aInfos.
+     *
+     * @returns The number of peers, which may be more than @p aMaxInfos.
+     *
+     */
+    unsigned int GetPeers(PeerInfo *aInfos, unsigned int aMaxInfos) const;
+
     /**
      * This method updates the fd_set and timeout for mainloop. @p aTimeout should
      * only be updated if the DTLS service has pending process in less than its current value.
@@ -302,35 +623,234 @@ public:
     otbrError SetSeed(const uint8_t *aSeed, uint16_t aLength);
 
 private:
-    typedef std::vector<MbedtlsSession *> SessionSet;
     enum
     {
-        kMaxSizeOfPSK = 32, ///< Max size of PSK in bytes.
+        kDefaultMaxSessions  = OTBR_CAPACITY_DTLS_SESSIONS,      ///< Default max number of sessions.
+        kDefaultCacheEntries = OTBR_CAPACITY_DTLS_CACHE_ENTRIES, ///< Default max number of cached sessions.
+    };
+
+    enum
+    {
+        kMaxSizeOfPSK        = 32,   ///< Max size of PSK in bytes.
+        kMaxSizeOfCookie     = 255,  ///< Max size of HelloVerifyRequest cookie in bytes.
+        kDefaultCacheTimeout = 3600, ///< Default lifetime of cached sessions in seconds.
+        kDefaultMtu          = 1280, ///< Default MTU, the IPv6 minimum MTU.
+        kIp6UdpHeaderSize    = 48,   ///< Size of the IPv6 and UDP headers of datagrams.
+    };
+
+    enum
+    {
+        kDefaultSessionTimeout = 60000, ///< Default session timeout in milliseconds.
+        kMinEvictionIdleTime   = 5000,  ///< Time in milliseconds a session is idle before it may be evicted.
+        kPrecomputeInterval    = 10,    ///< Time in milliseconds between EC-JPAKE keys computed on the mainloop.
     };
 
-    void      HandleSessionState(Session &aSession, Session::State aState);
-    void      ProcessServer(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet);
-    otbrError Bind(void);
+    enum
+    {
+        kMaxPeers = 16, ///< Max number of peers the CPU time of released sessions is accounted to.
+    };
 
-    SessionSet   mSessions;
-    int          mSocket;
-    uint16_t     mPort;
-    StateHandler mStateHandler;
-    void *       mContext;
-    uint8_t      mSeed[MBEDTLS_CTR_DRBG_MAX_SEED_INPUT];
-    uint16_t     mSeedLength;
-    uint8_t      mPSK[kMaxSizeOfPSK];
-    uint8_t      mPSKLength;
+    /**
+     * DTLS wire format used by the stateless cookie exchange and the socket filter, see RFC 6347.
+     *
+     */
+    enum
+    {
+        kRecordHeaderSize            = 13,     ///< Size of DTLS record header.
+        kHandshakeHeaderSize         = 12,     ///< Size of DTLS handshake message header.
+        kContentTypeChangeCipherSpec = 20,     ///< Content type of change cipher spec records, the lowest.
+        kContentTypeHandshake        = 22,     ///< Content type of handshake records.
+        kContentTypeApplicationData  = 23,     ///< Content type of application data records, the highest.
+        kHandshakeClientHello        = 1,      ///< Handshake type of ClientHello.
+        kHandshakeHelloVerifyRequest = 3,      ///< Handshake type of HelloVerifyRequest.
+        kDtlsVersionMajor            = 0xfe,   ///< Major version of DTLS 1.0, used by HelloVerifyRequest.
+        kDtlsVersionMinor            = 0xff,   ///< Minor version of DTLS 1.0, used by HelloVerifyRequest.
+        kDtlsVersion10               = 0xfeff, ///< Record version of DTLS 1.0.
+        kDtlsVersion12               = 0xfefd, ///< Record version of DTLS 1.2.
+    };
 
+    static int AttachRecordFilter(int aFd);
+
+    static void HandleReactor(void *aContext, int aFd, unsigned int aEvents);
+    static void HandleReleaseTimer(void *aContext);
+    static void HandleFlushTimer(void *aContext);
+    static void HandleWorkerPool(void *aContext, int aFd, unsigned int aEvents);
+    static void HandlePrecomputeTimer(void *aContext);
+    static void HandlePrecomputeWork(void *aContext);
+    static void HandlePrecomputeDone(void *aContext);
+    static int  HandleRandom(void *aContext, unsigned char *aBuffer, size_t aLength);
+    static int  HandleCookieWrite(void *               aContext,
+                                  unsigned char **     aCookie,
+                                  unsigned char *      aEnd,
+                                  const unsigned char *aInfo,
+                                  size_t               aInfoLength);
+    static int  HandleCookieCheck(void *               aContext,
+                                  const unsigned char *aCookie,
+                                  size_t               aCookieLength,
+                                  const unsigned char *aInfo,
+                                  size_t               aInfoLength);
+#if defined(MBEDTLS_SSL_CACHE_C)
+    static int HandleCacheGet(void *aContext, mbedtls_ssl_session *aSession);
+    static int HandleCacheSet(void *aContext, const mbedtls_ssl_session *aSession);
+#endif
+    bool        IsOffloading(void) const { return mSharedSocket && mWorkerPool.IsRunning(); }
+    void        HandleSessionState(Session &aSession, Session::State aState);
+    void        ExpireSession(MbedtlsSession &aSession);
+    bool        EvictSession(void);
+    void        RemoveSession(MbedtlsSession &aSession);
+    void        ReleaseSessions(void);
+    void        ScheduleRelease(void) { mTimerWheel->Start(mReleaseTimer, 0); }
+    void        SchedulePrecompute(void);
+    void        ProcessServer(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet);
+    void        ProcessServer(void);
+    void        HandleDatagram(const DatagramIo::Datagram &aDatagram);
+    otbrError        Accept(const DatagramIo::Datagram &aDatagram, MbedtlsSession *&aSession);
+    MbedtlsSession * AllocateSession(void);
+    void             FreeSession(MbedtlsSession &aSession);
+    void             AccountPeer(const MbedtlsSession &aSession);
+    static PeerInfo *FindPeer(std::vector<PeerInfo> &aPeers, const MbedtlsSession &aSession);
+    static void      AddPeerTime(std::vector<PeerInfo> &aPeers, const MbedtlsSession &aSession);
+    static uint64_t  GetCpuTime(const PeerInfo &aPeer)
+    {
+        return aPeer.mHandshakeCpuTime + aPeer.mRecordCpuTime + aPeer.mHandlerCpuTime;
+    }
+    bool        VerifyClientHello(const DatagramIo::Datagram &aDatagram, const sockaddr_in6 &aLocalSock);
+    void        SendHelloVerifyRequest(const uint8_t *     aClientHello,
+                                       const sockaddr_in6 &aRemoteSock,
+                                       const sockaddr_in6 &aLocalSock);
+    int         SendTo(const unsigned char *aBuffer,
+                       size_t               aLength,
+                       const sockaddr_in6 & aRemoteSock,
+                       const sockaddr_in6 & aLocalSock);
+    otbrError   Bind(void);
+
+    SessionTable   mSessions;
+    int            mSocket;
+    uint16_t       mPort;
+    StateHandler   mStateHandler;
+    void *         mContext;
+    Reactor *      mReactor;
+    Reactor::Watch mWatch;
+    TimerWheel     mLocalTimerWheel;
+    TimerWheel *   mTimerWheel;
+    Timer          mReleaseTimer;
+    Timer          mFlushTimer;
+    Timer          mPrecomputeTimer; ///< Computes EC-JPAKE keys on the mainloop without workers.
+    bool           mSharedSocket;
+    bool           mRecordFilter;       ///< Whether a socket filter drops datagrams other than DTLS records.
+    bool           mHandshakesDeferred; ///< Whether new peers only get a HelloVerifyRequest.
+    DatagramIo     mIo;
+    unsigned int   mHandshakeWorkers;
+    WorkerPool     mWorkerPool;
+    Reactor::Watch mWorkerWatch;
+    unsigned int   mMaxSessions;
+    unsigned int   mSessionCount; ///< Number of sessions allocated, in use or free.
+    uint32_t       mHandshakeTimeout;
+    uint32_t       mIdleTimeout;
+    uint32_t       mRetransmissionTimeoutMin;
+    uint32_t       mRetransmissionTimeoutMax;
+    uint16_t       mMtu;
+
+    WorkerPool::Job mPrecomputeJob; ///< Computes EC-JPAKE keys on a worker.
+    bool            mPrecomputed;   ///< Whether the job on a worker computed a key.
+
+    std::vector<MbedtlsSession *> mFreeSessions; ///< Released sessions ready for reuse.
+    std::vector<PeerInfo>         mPeers;        ///< CPU time of released sessions of each peer.
+
+    unsigned int mCacheEntries;
+    uint32_t     mCacheTimeout;
+    uint32_t     mCacheHits;   ///< Protected by mLock.
+    uint32_t     mCacheMisses; ///< Protected by mLock.
+
+    uint8_t        mSeed[MBEDTLS_CTR_DRBG_MAX_SEED_INPUT];
+    uint16_t       mSeedLength;
+    uint8_t        mPSK[kMaxSizeOfPSK];
+    uint8_t        mPSKLength;
+
+    pthread_mutex_t          mLock; ///< Protects the contexts shared by handshakes running on workers.
     mbedtls_ssl_cookie_ctx   mCookie;
-    mbedtls_entropy_context  mEntropy;
-    mbedtls_ctr_drbg_context mCtrDrbg;
-    mbedtls_ssl_config       mConf;
+    mbedtls_ssl_config       mConf; ///< Shared by all sessions, not written after Start().
 #if defined(MBEDTLS_SSL_CACHE_C)
     mbedtls_ssl_cache_context mCache;
 #endif
 };
 
+/**
+ * This class implements DTLS client functionality based on mbedTLS.
+ *
+ */
+class MbedtlsClient : public Client
+{
+public:
+    /**
+     * The constructor to initialize a DTLS client.
+     *
+     * @param[in]   aStateHandler       A pointer to the function to be called when the client state changed.
+     * @param[in]   aContext            A pointer to application-specific context.
+     *
+     */
+    MbedtlsClient(StateHandler aStateHandler, void *aContext);
+
+    ~MbedtlsClient(void);
+
+    virtual otbrError      SetPSK(const uint8_t *aPSK, uint8_t aLength);
+    virtual void           SetHandshakeTimeouts(uint32_t aMin, uint32_t aMax);
+    virtual void           SetDataHandler(Session::DataHandler aDataHandler, void *aContext);
+    virtual otbrError      Connect(const char *aHost, const char *aPort);
+    virtual ssize_t        Write(const uint8_t *aBuffer, uint16_t aLength);
+    virtual const uint8_t *GetKek(void) const { return mKek; }
+    virtual Session::State GetState(void) const { return mState; }
+    virtual void           Close(void);
+    virtual void           UpdateFdSet(fd_set & aReadFdSet,
+                                       fd_set & aWriteFdSet,
+                                       fd_set & aErrorFdSet,
+                                       int &    aMaxFd,
+                                       timeval &aTimeout);
+    virtual void           Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet);
+
+private:
+    enum
+    {
+        kMaxSizeOfPSK        = 32,    ///< Max size of PSK in bytes.
+        kSizeOfKek           = 32,    ///< Size of the KEK in bytes.
+        kHandshakeTimeoutMin = 1000,  ///< Default initial handshake retransmission timeout in milliseconds.
+        kHandshakeTimeoutMax = 60000, ///< Default max handshake retransmission timeout in milliseconds.
+    };
+
+    static int  HandleRandom(void *aContext, unsigned char *aBuffer, size_t aLength);
+    static int  ExportKeys(void *               aContext,
+                           const unsigned char *aMasterSecret,
+                           const unsigned char *aKeyBlock,
+                           size_t               aMacLength,
+                           size_t               aKeyLength,
+                           size_t               aIvLength);
+    static void SetDelay(void *aContext, uint32_t aIntermediate, uint32_t aFinal);
+    static int  GetDelay(void *aContext);
+
+    void Handshake(void);
+    void Read(void);
+    void SetState(Session::State aState);
+
+    StateHandler         mStateHandler;
+    void *               mContext;
+    Session::DataHandler mDataHandler;
+    void *               mDataContext;
+    Session::State       mState;
+    bool                 mConnected; ///< Whether the SSL context is set up, with the handshake started.
+    uint64_t             mIntermediateTime;
+    uint64_t             mFinalTime;
+    bool                 mDelayCancelled;
+    uint32_t             mHandshakeTimeoutMin;
+    uint32_t             mHandshakeTimeoutMax;
+    uint8_t              mKek[kSizeOfKek];
+    uint8_t              mPSK[kMaxSizeOfPSK];
+    uint8_t              mPSKLength;
+
+    mbedtls_net_context mNet;
+    mbedtls_ssl_config  mConf;
+    mbedtls_ssl_context mSsl;
+};
+
 /**
  * @}
  */
@@ -0,0 +1,259 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements a pool of EC-JPAKE ephemeral keys computed ahead of DTLS handshakes.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_DTLS
+
+#include "ecjpake_pool.hpp"
+
+#include <string.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Dtls {
+
+static Metrics::Counter sKeysTaken("dtls.ecjpake_precomputed");
+static Metrics::Counter sKeysMissed("dtls.ecjpake_generated");
+
+EcjpakePool::EcjpakePool(void)
+    : mKeys(NULL)
+    , mCapacity(0)
+{
+    pthread_mutex_init(&mLock, NULL);
+}
+
+EcjpakePool::~EcjpakePool(void)
+{
+    Uninstall();
+    Free();
+    pthread_mutex_destroy(&mLock);
+}
+
+void EcjpakePool::Free(void)
+{
+    for (unsigned int i = 0; i < mCapacity; ++i)
+    {
+        mbedtls_ecjpake_free(&mKeys[i].mContext);
+    }
+
+    delete[] mKeys;
+    mKeys     = NULL;
+    mCapacity = 0;
+    mReady.clear();
+    mSpare.clear();
+}
+
+otbrError EcjpakePool::Init(unsigned int aCapacity)
+{
+    // The secret is only used by the second round, the keys of the first round do not depend on it.
+    static const unsigned char kSecret[] = {0};
+    otbrError                  error     = OTBR_ERROR_NONE;
+
+    pthread_mutex_lock(&mLock);
+    VerifyOrExit(mKeys == NULL && aCapacity > 0);
+
+    mKeys     = new Key[aCapacity];
+    mCapacity = aCapacity;
+    mReady.reserve(aCapacity);
+    mSpare.reserve(aCapacity);
+
+    for (unsigned int i = 0; i < aCapacity; ++i)
+    {
+        mbedtls_ecjpake_init(&mKeys[i].mContext);
+    }
+
+    for (unsigned int i = 0; i < aCapacity; ++i)
+    {
+        if (mbedtls_ecjpake_setup(&mKeys[i].mContext, MBEDTLS_ECJPAKE_SERVER, MBEDTLS_MD_SHA256,
+                                  MBEDTLS_ECP_DP_SECP256R1, kSecret, sizeof(kSecret)) != 0)
+        {
+            Free();
+            ExitNow(error = OTBR_ERROR_DTLS);
+        }
+
+        mSpare.push_back(&mKeys[i]);
+    }
+
+exit:
+    pthread_mutex_unlock(&mLock);
+    return error;
+}
+
+void EcjpakePool::Install(void)
+{
+    mbedtls_ecjpake_set_round_one_hook(HandleRoundOne, this);
+}
+
+void EcjpakePool::Uninstall(void)
+{
+    mbedtls_ecjpake_set_round_one_hook(NULL, NULL);
+}
+
+bool EcjpakePool::Precompute(RandomHandler aRandom, void *aContext)
+{
+    Key *key = NULL;
+    bool ok  = false;
+
+    pthread_mutex_lock(&mLock);
+
+    if (!mSpare.empty())
+    {
+        key = mSpare.back();
+        mSpare.pop_back();
+    }
+
+    pthread_mutex_unlock(&mLock);
+    VerifyOrExit(key != NULL);
+
+    // The contexts of the pool are told apart by the hook, so that they generate their keys.
+    ok = (mbedtls_ecjpake_write_round_one(&key->mContext, key->mMessage, sizeof(key->mMessage), &key->mLength,
+                                          aRandom, aContext) == 0);
+
+    if (!ok)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to precompute EC-JPAKE keys.");
+    }
+
+    pthread_mutex_lock(&mLock);
+    (ok ? mReady : mSpare).push_back(key);
+    pthread_mutex_unlock(&mLock);
+
+exit:
+    return ok;
+}
+
+bool EcjpakePool::IsFull(void) const
+{
+    bool full;
+
+    pthread_mutex_lock(&mLock);
+    full = mSpare.empty();
+    pthread_mutex_unlock(&mLock);
+
+    return full;
+}
+
+unsigned int EcjpakePool::GetCount(void) const
+{
+    unsigned int count;
+
+    pthread_mutex_lock(&mLock);
+    count = static_cast<unsigned int>(mReady.size());
+    pthread_mutex_unlock(&mLock);
+
+    return count;
+}
+
+bool EcjpakePool::IsOwnContext(const mbedtls_ecjpake_context *aContext) const
+{
+    for (unsigned int i = 0; i < mCapacity; ++i)
+    {
+        if (aContext == &mKeys[i].mContext)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int EcjpakePool::Take(mbedtls_ecjpake_context &aContext, unsigned char *aBuffer, size_t aLength, size_t &aWritten)
+{
+    Key *key = NULL;
+    int  ret = MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE;
+
+    // Only keys of the same role, curve, hash and point format make the same message.
+    VerifyOrExit(aContext.role == MBEDTLS_ECJPAKE_SERVER && aContext.grp.id == MBEDTLS_ECP_DP_SECP256R1 &&
+                 aContext.md_info == mbedtls_md_info_from_type(MBEDTLS_MD_SHA256) &&
+                 aContext.point_format == MBEDTLS_ECP_PF_UNCOMPRESSED);
+
+    pthread_mutex_lock(&mLock);
+
+    if (!mReady.empty() && mReady.back()->mLength <= aLength)
+    {
+        key = mReady.back();
+        mReady.pop_back();
+    }
+
+    pthread_mutex_unlock(&mLock);
+
+    if (key == NULL)
+    {
+        sKeysMissed.Add();
+        ExitNow();
+    }
+
+    // Swapping leaves the previous values of the context to the key, which are overwritten when it is computed again.
+    mbedtls_mpi_swap(&aContext.xm1, &key->mContext.xm1);
+    mbedtls_mpi_swap(&aContext.xm2, &key->mContext.xm2);
+    mbedtls_mpi_swap(&aContext.Xm1.X, &key->mContext.Xm1.X);
+    mbedtls_mpi_swap(&aContext.Xm1.Y, &key->mContext.Xm1.Y);
+    mbedtls_mpi_swap(&aContext.Xm1.Z, &key->mContext.Xm1.Z);
+    mbedtls_mpi_swap(&aContext.Xm2.X, &key->mContext.Xm2.X);
+    mbedtls_mpi_swap(&aContext.Xm2.Y, &key->mContext.Xm2.Y);
+    mbedtls_mpi_swap(&aContext.Xm2.Z, &key->mContext.Xm2.Z);
+    memcpy(aBuffer, key->mMessage, key->mLength);
+    aWritten = key->mLength;
+    ret      = 0;
+    sKeysTaken.Add();
+
+    pthread_mutex_lock(&mLock);
+    mSpare.push_back(key);
+    pthread_mutex_unlock(&mLock);
+
+exit:
+    return ret;
+}
+
+int EcjpakePool::HandleRoundOne(void *                   aPool,
+                                mbedtls_ecjpake_context *aContext,
+                                unsigned char *          aBuffer,
+                                size_t                   aLength,
+                                size_t *                 aWritten)
+{
+    EcjpakePool *pool = static_cast<EcjpakePool *>(aPool);
+
+    return pool->IsOwnContext(aContext) ? MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE
+                                        : pool->Take(*aContext, aBuffer, aLength, *aWritten);
+}
+
+} // namespace Dtls
+
+} // namespace BorderRouter
+
+} // namespace ot
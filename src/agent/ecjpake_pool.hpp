@@ -0,0 +1,196 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of a pool of EC-JPAKE ephemeral keys computed ahead of DTLS handshakes.
+ */
+
+#ifndef ECJPAKE_POOL_HPP_
+#define ECJPAKE_POOL_HPP_
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+extern "C" {
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include <mbedtls/ecjpake.h>
+
+} // extern "C"
+
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Dtls {
+
+/**
+ * This class implements a bounded pool of EC-JPAKE first round messages of the server, with their ephemeral keys.
+ *
+ * The first round of EC-JPAKE generates two key pairs and their zero-knowledge proofs, i.e. four P-256 scalar
+ * multiplications, and does not depend on the PSKc or the peer. Keys are computed ahead of time, e.g. on idle workers,
+ * and taken by the handshakes as they write their ServerHello. Each key is used once, a handshake finding the pool
+ * empty generates its keys as usual.
+ *
+ * All methods may be called from any thread.
+ *
+ */
+class EcjpakePool
+{
+public:
+    /**
+     * This function pointer generates random bytes, as the random generators of mbedtls.
+     *
+     */
+    typedef int (*RandomHandler)(void *aContext, unsigned char *aBuffer, size_t aLength);
+
+    /**
+     * The constructor initializes a pool without key.
+     *
+     */
+    EcjpakePool(void);
+
+    /**
+     * The destructor uninstalls the pool and frees its keys.
+     *
+     */
+    ~EcjpakePool(void);
+
+    /**
+     * This method allocates the keys of the pool, none of which is computed yet.
+     *
+     * The capacity is only set once, later calls do nothing.
+     *
+     * @param[in]  aCapacity  The max number of keys computed ahead, 0 to not compute any.
+     *
+     * @retval OTBR_ERROR_NONE  Successfully allocated the keys.
+     * @retval OTBR_ERROR_DTLS  Failed to set up the EC-JPAKE contexts.
+     *
+     */
+    otbrError Init(unsigned int aCapacity);
+
+    /**
+     * This method makes mbedtls take the first round messages of servers from this pool.
+     *
+     */
+    void Install(void);
+
+    /**
+     * This method makes mbedtls generate all first round messages.
+     *
+     */
+    void Uninstall(void);
+
+    /**
+     * This method computes a key, if the pool is not full.
+     *
+     * @param[in]  aRandom   The random generator.
+     * @param[in]  aContext  A pointer to the context of the random generator.
+     *
+     * @returns Whether a key was computed, false if the pool is full or the computation failed.
+     *
+     */
+    bool Precompute(RandomHandler aRandom, void *aContext);
+
+    /**
+     * This method returns whether the pool has all the keys it may hold.
+     *
+     * @returns Whether the pool is full.
+     *
+     */
+    bool IsFull(void) const;
+
+    /**
+     * This method returns the number of keys ready.
+     *
+     * @returns The number of keys.
+     *
+     */
+    unsigned int GetCount(void) const;
+
+    /**
+     * This method takes a key for the first round of a server.
+     *
+     * @param[inout]  aContext  A reference to the EC-JPAKE context, whose ephemeral keys are set.
+     * @param[out]    aBuffer   A pointer to receive the first round message.
+     * @param[in]     aLength   The size of @p aBuffer.
+     * @param[out]    aWritten  A reference to receive the length of the message.
+     *
+     * @retval 0                                    Successfully took a key.
+     * @retval MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE  No key is ready, or the context is not of a P-256 and SHA-256
+     *                                              server with uncompressed points, the keys are to be generated.
+     *
+     */
+    int Take(mbedtls_ecjpake_context &aContext, unsigned char *aBuffer, size_t aLength, size_t &aWritten);
+
+private:
+    enum
+    {
+        kMaxMessageSize = 512, ///< Max size of a first round message, of two points and proofs.
+    };
+
+    struct Key
+    {
+        mbedtls_ecjpake_context mContext;
+        unsigned char           mMessage[kMaxMessageSize];
+        size_t                  mLength;
+    };
+
+    static int HandleRoundOne(void *                   aPool,
+                              mbedtls_ecjpake_context *aContext,
+                              unsigned char *          aBuffer,
+                              size_t                   aLength,
+                              size_t *                 aWritten);
+    bool       IsOwnContext(const mbedtls_ecjpake_context *aContext) const;
+    void       Free(void);
+
+    Key *                   mKeys;
+    unsigned int            mCapacity;
+    std::vector<Key *>      mReady; ///< Keys computed, taken last in first out.
+    std::vector<Key *>      mSpare; ///< Keys taken or not computed yet.
+    mutable pthread_mutex_t mLock;  ///< Guards the ready and spare keys, computed and taken outside of it.
+};
+
+} // namespace Dtls
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // ECJPAKE_POOL_HPP_
@@ -0,0 +1,223 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the HDLC-lite framing of Spinel.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_NCP
+
+#include "hdlc.hpp"
+
+#include <errno.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Hdlc {
+
+enum
+{
+    kFlagSequence   = 0x7e,   ///< Delimits frames.
+    kEscapeSequence = 0x7d,   ///< Escapes the next byte.
+    kFlagXOn        = 0x11,   ///< Software flow control, escaped.
+    kFlagXOff       = 0x13,   ///< Software flow control, escaped.
+    kFlagSpecial    = 0xf8,   ///< Reserved, escaped.
+    kEscapeXor      = 0x20,   ///< Applied to escaped bytes.
+    kInitFcs        = 0xffff, ///< Initial value of the frame check sequence.
+    kGoodFcs        = 0xf0b8, ///< Residue of a frame with a valid frame check sequence.
+    kSizeFcs        = 2,      ///< Size of the frame check sequence.
+};
+
+/**
+ * This function updates the frame check sequence, the CRC-16/CCITT of RFC 1662, with one byte.
+ *
+ */
+static uint16_t UpdateFcs(uint16_t aFcs, uint8_t aByte)
+{
+    uint8_t x = static_cast<uint8_t>(aFcs ^ aByte);
+
+    x = static_cast<uint8_t>(x ^ (x << 4));
+
+    return static_cast<uint16_t>((aFcs >> 8) ^ (x << 8) ^ (x << 3) ^ (x >> 4));
+}
+
+static bool NeedsEscape(uint8_t aByte)
+{
+    return aByte == kFlagSequence || aByte == kEscapeSequence || aByte == kFlagXOn || aByte == kFlagXOff ||
+           aByte == kFlagSpecial;
+}
+
+static bool Put(uint8_t aByte, uint8_t *aBuffer, uint16_t aSize, uint16_t &aLength)
+{
+    bool ok = false;
+
+    if (NeedsEscape(aByte))
+    {
+        VerifyOrExit(aLength + 2 <= aSize);
+        aBuffer[aLength++] = kEscapeSequence;
+        aByte ^= kEscapeXor;
+    }
+
+    VerifyOrExit(aLength + 1 <= aSize);
+    aBuffer[aLength++] = aByte;
+    ok                 = true;
+
+exit:
+    return ok;
+}
+
+otbrError Encode(const uint8_t *aFrame, uint16_t aLength, uint8_t *aBuffer, uint16_t &aSize)
+{
+    otbrError ret    = OTBR_ERROR_ERRNO;
+    uint16_t  fcs    = kInitFcs;
+    uint16_t  length = 0;
+
+    VerifyOrExit(aSize > 0, errno = ENOBUFS);
+    aBuffer[length++] = kFlagSequence;
+
+    for (uint16_t i = 0; i < aLength; ++i)
+    {
+        fcs = UpdateFcs(fcs, aFrame[i]);
+        VerifyOrExit(Put(aFrame[i], aBuffer, aSize, length), errno = ENOBUFS);
+    }
+
+    // The frame check sequence is sent complemented, least significant byte first.
+    fcs ^= 0xffff;
+    VerifyOrExit(Put(static_cast<uint8_t>(fcs & 0xff), aBuffer, aSize, length), errno = ENOBUFS);
+    VerifyOrExit(Put(static_cast<uint8_t>(fcs >> 8), aBuffer, aSize, length), errno = ENOBUFS);
+
+    VerifyOrExit(length < aSize, errno = ENOBUFS);
+    aBuffer[length++] = kFlagSequence;
+
+    aSize = length;
+    ret   = OTBR_ERROR_NONE;
+
+exit:
+    return ret;
+}
+
+Decoder::Decoder(FrameHandler aFrameHandler, void *aContext)
+    : mFrameHandler(aFrameHandler)
+    , mContext(aContext)
+    , mState(kStateNoSync)
+    , mFcs(kInitFcs)
+    , mLength(0)
+    , mErrors(0)
+{
+}
+
+void Decoder::Reset(void)
+{
+    mState  = kStateNoSync;
+    mFcs    = kInitFcs;
+    mLength = 0;
+}
+
+void Decoder::HandleFrame(void)
+{
+    // Back-to-back flags delimit no frame.
+    if (mLength == 0)
+    {
+        ExitNow();
+    }
+
+    if (mLength < kSizeFcs || mFcs != kGoodFcs)
+    {
+        ++mErrors;
+        otbrLog(OTBR_LOG_DEBUG, "HDLC dropped a frame of %u bytes with FCS %04x", mLength, mFcs);
+        ExitNow();
+    }
+
+    mFrameHandler(mFrame, static_cast<uint16_t>(mLength - kSizeFcs), mContext);
+
+exit:
+    mFcs    = kInitFcs;
+    mLength = 0;
+}
+
+void Decoder::Decode(const uint8_t *aData, uint16_t aLength)
+{
+    for (uint16_t i = 0; i < aLength; ++i)
+    {
+        uint8_t byte = aData[i];
+
+        if (byte == kFlagSequence)
+        {
+            if (mState != kStateNoSync)
+            {
+                HandleFrame();
+            }
+
+            mState = kStateSync;
+            continue;
+        }
+
+        switch (mState)
+        {
+        case kStateNoSync:
+            continue;
+
+        case kStateEscape:
+            byte ^= kEscapeXor;
+            mState = kStateSync;
+            break;
+
+        case kStateSync:
+            if (byte == kEscapeSequence)
+            {
+                mState = kStateEscape;
+                continue;
+            }
+            break;
+        }
+
+        if (mLength == sizeof(mFrame))
+        {
+            // Drop the rest of the frame until the next flag.
+            ++mErrors;
+            otbrLog(OTBR_LOG_DEBUG, "HDLC dropped a frame too long");
+            Reset();
+            continue;
+        }
+
+        mFcs              = UpdateFcs(mFcs, byte);
+        mFrame[mLength++] = byte;
+    }
+}
+
+} // namespace Hdlc
+
+} // namespace BorderRouter
+
+} // namespace ot
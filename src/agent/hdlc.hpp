@@ -0,0 +1,144 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the HDLC-lite framing of Spinel.
+ */
+
+#ifndef HDLC_HPP_
+#define HDLC_HPP_
+
+#include <stdint.h>
+
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Hdlc {
+
+/**
+ * This function encodes a frame with its frame check sequence into HDLC-lite.
+ *
+ * The encoded frame is delimited by flag bytes on both ends.
+ *
+ * @param[in]       aFrame      A pointer to the frame to encode.
+ * @param[in]       aLength     Number of bytes of @p aFrame.
+ * @param[out]      aBuffer     A pointer to the buffer to receive the encoded frame.
+ * @param[inout]    aSize       The size of @p aBuffer on input, the number of bytes encoded on output.
+ *
+ * @retval  OTBR_ERROR_NONE     Successfully encoded the frame.
+ * @retval  OTBR_ERROR_ERRNO    Failed for @p aBuffer is too small, errno is set to ENOBUFS.
+ *
+ */
+otbrError Encode(const uint8_t *aFrame, uint16_t aLength, uint8_t *aBuffer, uint16_t &aSize);
+
+/**
+ * This class implements a streaming HDLC-lite decoder.
+ *
+ */
+class Decoder
+{
+public:
+    enum
+    {
+        kMaxFrameSize = 2048, ///< Max size of a decoded frame, including the frame check sequence.
+    };
+
+    /**
+     * This function pointer is called when a frame is decoded.
+     *
+     * @param[in]   aFrame          A pointer to the frame, without the frame check sequence.
+     * @param[in]   aLength         Number of bytes of @p aFrame.
+     * @param[in]   aContext        A pointer to application-specific context.
+     *
+     */
+    typedef void (*FrameHandler)(const uint8_t *aFrame, uint16_t aLength, void *aContext);
+
+    /**
+     * The constructor to initialize a decoder.
+     *
+     * @param[in]   aFrameHandler   A pointer to the function to be called when a frame is decoded.
+     * @param[in]   aContext        A pointer to application-specific context.
+     *
+     */
+    Decoder(FrameHandler aFrameHandler, void *aContext);
+
+    /**
+     * This method decodes a chunk of the byte stream.
+     *
+     * Frames may span chunks. Frames too long or failing the frame check sequence are dropped.
+     *
+     * @param[in]   aData           A pointer to the bytes.
+     * @param[in]   aLength         Number of bytes of @p aData.
+     *
+     */
+    void Decode(const uint8_t *aData, uint16_t aLength);
+
+    /**
+     * This method discards the frame being decoded.
+     *
+     */
+    void Reset(void);
+
+    /**
+     * This method returns the number of frames dropped.
+     *
+     * @returns The number of frames dropped for being too long or failing the frame check sequence.
+     *
+     */
+    uint32_t GetErrorCount(void) const { return mErrors; }
+
+private:
+    enum State
+    {
+        kStateNoSync, ///< Waiting for a flag byte.
+        kStateSync,   ///< Receiving a frame.
+        kStateEscape, ///< Received an escape byte.
+    };
+
+    void HandleFrame(void);
+
+    FrameHandler mFrameHandler;
+    void *       mContext;
+    State        mState;
+    uint16_t     mFcs;
+    uint16_t     mLength;
+    uint32_t     mErrors;
+    uint8_t      mFrame[kMaxFrameSize];
+};
+
+} // namespace Hdlc
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // HDLC_HPP_
@@ -29,57 +29,579 @@
 #include "otbr-config.h"
 
 #include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
 #include "agent_instance.hpp"
+#include "packet_trace.hpp"
+#include "scheduling.hpp"
+#include "common/capacity.hpp"
 #include "common/code_utils.hpp"
 #include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/timeline.hpp"
 #include "common/types.hpp"
+#include "utils/cpu_features.hpp"
 
 static const char kSyslogIdent[]          = "otbr-agent";
 static const char kDefaultInterfaceName[] = "wpan0";
 
-// Default poll timeout.
-static const struct timeval kPollTimeout = {10, 0};
+// Log file written by a background thread.
+static const size_t kLogBufferSize  = OTBR_CAPACITY_LOG_BUFFER;
+static const size_t kLogMaxFileSize = 8 * 1024 * 1024;
 
-int Mainloop(const char *aInterfaceName)
+// MTU of the path to commissioners, the IPv6 minimum MTU.
+static const uint16_t kDefaultDtlsMtu = 1280;
+
+// Poll timeout of the mainloop. Timers and signals wake it up when due, the timeout only bounds the wait.
+static const struct timeval kPollTimeout = {3600, 0};
+
+// Poll timeout of the other threads, which bounds the time they take to stop.
+static const struct timeval kThreadPollTimeout = {1, 0};
+
+// Set by SIGUSR1 to log all metrics from the mainloop.
+static volatile sig_atomic_t sDumpMetrics = 0;
+
+// Set by SIGUSR2 to save the packet trace and the timeline from the mainloop.
+static volatile sig_atomic_t sSaveTrace = 0;
+
+static void HandleDumpMetrics(int aSignal)
 {
-    int rval = EXIT_FAILURE;
+    (void)aSignal;
+    sDumpMetrics = 1;
+}
 
-    ot::BorderRouter::AgentInstance instance(aInterfaceName);
-    SuccessOrExit(instance.Init());
+// Set by SIGHUP to reload the configuration file from the mainloop.
+static volatile sig_atomic_t sReloadConfig = 0;
 
-    otbrLog(OTBR_LOG_INFO, "Border router agent started.");
+static void HandleSaveTrace(int aSignal)
+{
+    (void)aSignal;
+    sSaveTrace = 1;
+}
+
+static void HandleReloadConfig(int aSignal)
+{
+    (void)aSignal;
+    sReloadConfig = 1;
+}
+
+// Set by SIGTERM and SIGINT to stop the mainloop, so that the agent exits through its destructors and atexit handlers.
+static volatile sig_atomic_t sTerminate = 0;
+
+static void HandleTerminate(int aSignal)
+{
+    (void)aSignal;
+    sTerminate = 1;
+}
+
+// The signals setting the flags above, which are only delivered to the mainloop while it waits.
+static sigset_t sMainloopSignals;
+
+// The signal mask of the mainloop while waiting.
+static sigset_t sWaitSignalMask;
 
-    while (true)
+/**
+ * This function blocks the signals handled by the mainloop for the calling thread and the threads it creates later.
+ *
+ */
+static void BlockMainloopSignals(void)
+{
+    sigemptyset(&sMainloopSignals);
+    sigaddset(&sMainloopSignals, SIGUSR1);
+    sigaddset(&sMainloopSignals, SIGUSR2);
+    sigaddset(&sMainloopSignals, SIGHUP);
+    sigaddset(&sMainloopSignals, SIGTERM);
+    sigaddset(&sMainloopSignals, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &sMainloopSignals, &sWaitSignalMask);
+}
+
+/**
+ * This structure represents the settings of the configuration file, which are applied in place when it is reloaded.
+ *
+ * The file has a KEY=VALUE setting per line, empty lines and lines starting with '#' are ignored:
+ *   debug-level=LEVEL
+ *   rate-limits=KEY=RATE[/BURST][,...]
+ *   stall-threshold=MS
+ *   load-threshold=MS
+ *   handshake-timeout=MS
+ *   idle-timeout=MS
+ *   keep-alive-interval=MS
+ *   diagnostic-interval=MS
+ *   coap-duplicate-lifetime=MS
+ *   dbus-max-received=BYTES
+ *   dbus-max-outgoing=BYTES
+ *
+ */
+struct Config
+{
+    enum
     {
-        fd_set         readFdSet;
-        fd_set         writeFdSet;
-        fd_set         errorFdSet;
-        int            maxFd   = -1;
-        struct timeval timeout = kPollTimeout;
+        kMaxLine = 256,
+    };
+
+    int  mLogLevel;             ///< The log level, -1 if not set.
+    int  mStallThreshold;       ///< The stall threshold in milliseconds, -1 if not set.
+    int  mLoadThreshold;        ///< The load shedding threshold in milliseconds, -1 if not set.
+    int  mHandshakeTimeout;     ///< The timeout of handshaking DTLS sessions in milliseconds, 0 if not set.
+    int  mIdleTimeout;          ///< The timeout of established DTLS sessions in milliseconds, 0 if not set.
+    int  mKeepAliveInterval;    ///< The interval keep-alives are forwarded at in milliseconds, -1 if not set.
+    int  mDiagnosticInterval;   ///< The interval diagnostics are collected at in milliseconds, -1 if not set.
+    int  mDuplicateLifetime;    ///< The time CoAP requests are remembered in milliseconds, -1 if not set.
+    char mRateLimits[kMaxLine]; ///< The rate limits, empty if not set. Limits not listed are kept.
+    int  mBusMaxReceived;       ///< The max bytes received from wpantund and not yet dispatched, 0 if not set.
+    int  mBusMaxOutgoing;       ///< The max bytes queued to be written to wpantund, 0 if not set.
+};
+
+// The configuration, guarded by sConfigLock, and the number of times it was loaded.
+static Config          sConfig;
+static pthread_mutex_t sConfigLock       = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int    sConfigGeneration = 0;
+
+static otbrError LoadConfig(const char *aFile)
+{
+    otbrError error = OTBR_ERROR_ERRNO;
+    FILE *    file  = fopen(aFile, "r");
+    Config    config;
+    char      line[Config::kMaxLine];
+
+    VerifyOrExit(file != NULL);
+
+    config.mLogLevel           = -1;
+    config.mStallThreshold     = -1;
+    config.mLoadThreshold      = -1;
+    config.mHandshakeTimeout   = 0;
+    config.mIdleTimeout        = 0;
+    config.mKeepAliveInterval  = -1;
+    config.mDiagnosticInterval = -1;
+    config.mDuplicateLifetime  = -1;
+    config.mRateLimits[0]      = '\0';
+    config.mBusMaxReceived     = 0;
+    config.mBusMaxOutgoing     = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        size_t length = strlen(line);
+        char * value;
+
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r' || line[length - 1] == ' '))
+        {
+            line[--length] = '\0';
+        }
 
-        FD_ZERO(&readFdSet);
-        FD_ZERO(&writeFdSet);
-        FD_ZERO(&errorFdSet);
+        if (length == 0 || line[0] == '#')
+        {
+            continue;
+        }
 
-        instance.UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
-        rval = select(maxFd + 1, &readFdSet, &writeFdSet, &errorFdSet, &timeout);
+        value = strchr(line, '=');
+        VerifyOrExit(value != NULL, errno = EINVAL, otbrLog(OTBR_LOG_ERR, "Invalid setting: %s", line));
+        *value++ = '\0';
 
-        if ((rval < 0) && (errno != EINTR))
+        if (!strcmp(line, "debug-level"))
+        {
+            config.mLogLevel = atoi(value);
+        }
+        else if (!strcmp(line, "stall-threshold"))
+        {
+            config.mStallThreshold = atoi(value);
+        }
+        else if (!strcmp(line, "load-threshold"))
+        {
+            config.mLoadThreshold = atoi(value);
+        }
+        else if (!strcmp(line, "handshake-timeout"))
+        {
+            config.mHandshakeTimeout = atoi(value);
+            VerifyOrExit(config.mHandshakeTimeout > 0, errno = EINVAL);
+        }
+        else if (!strcmp(line, "idle-timeout"))
+        {
+            config.mIdleTimeout = atoi(value);
+            VerifyOrExit(config.mIdleTimeout > 0, errno = EINVAL);
+        }
+        else if (!strcmp(line, "keep-alive-interval"))
+        {
+            config.mKeepAliveInterval = atoi(value);
+        }
+        else if (!strcmp(line, "diagnostic-interval"))
+        {
+            config.mDiagnosticInterval = atoi(value);
+        }
+        else if (!strcmp(line, "coap-duplicate-lifetime"))
+        {
+            config.mDuplicateLifetime = atoi(value);
+        }
+        else if (!strcmp(line, "rate-limits"))
+        {
+            strcpy(config.mRateLimits, value);
+        }
+        else if (!strcmp(line, "dbus-max-received"))
+        {
+            config.mBusMaxReceived = atoi(value);
+            VerifyOrExit(config.mBusMaxReceived > 0, errno = EINVAL);
+        }
+        else if (!strcmp(line, "dbus-max-outgoing"))
+        {
+            config.mBusMaxOutgoing = atoi(value);
+            VerifyOrExit(config.mBusMaxOutgoing > 0, errno = EINVAL);
+        }
+        else
+        {
+            otbrLog(OTBR_LOG_ERR, "Unknown setting: %s", line);
+            ExitNow(errno = EINVAL);
+        }
+    }
+
+    VerifyOrExit(!ferror(file));
+
+    pthread_mutex_lock(&sConfigLock);
+    sConfig = config;
+    pthread_mutex_unlock(&sConfigLock);
+    __atomic_add_fetch(&sConfigGeneration, 1, __ATOMIC_RELEASE);
+
+    if (config.mLogLevel >= 0)
+    {
+        otbrLogSetLevel(config.mLogLevel);
+    }
+
+    // The connections to wpantund are shared by the instances, their limits apply at once.
+    ot::BorderRouter::Ncp::Controller::SetBusLimits(static_cast<uint32_t>(config.mBusMaxReceived),
+                                                    static_cast<uint32_t>(config.mBusMaxOutgoing));
+
+    error = OTBR_ERROR_NONE;
+
+exit:
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+
+    return error;
+}
+
+// Applies the configuration to an instance from its own thread, if it changed since @p aGeneration.
+static otbrError ApplyConfig(ot::BorderRouter::AgentInstance &aInstance, unsigned int &aGeneration)
+{
+    otbrError    error      = OTBR_ERROR_NONE;
+    unsigned int generation = __atomic_load_n(&sConfigGeneration, __ATOMIC_ACQUIRE);
+
+    VerifyOrExit(generation != aGeneration);
+    aGeneration = generation;
+
+    pthread_mutex_lock(&sConfigLock);
+
+    // Established sessions are kept, the rate limits apply to the commissioners established from now on.
+    if (sConfig.mRateLimits[0] != '\0' && (error = aInstance.SetRateLimits(sConfig.mRateLimits)) != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "Invalid rate limits: %s", sConfig.mRateLimits);
+    }
+
+    if (sConfig.mStallThreshold >= 0)
+    {
+        aInstance.SetStallThreshold(static_cast<uint32_t>(sConfig.mStallThreshold));
+    }
+
+    if (sConfig.mLoadThreshold >= 0)
+    {
+        aInstance.SetLoadThreshold(static_cast<uint32_t>(sConfig.mLoadThreshold));
+    }
+
+    // Sessions keep their timers until they receive the next datagram.
+    aInstance.SetDtlsTimeouts(static_cast<uint32_t>(sConfig.mHandshakeTimeout),
+                              static_cast<uint32_t>(sConfig.mIdleTimeout));
+
+    if (sConfig.mKeepAliveInterval >= 0)
+    {
+        aInstance.SetKeepAliveInterval(static_cast<uint32_t>(sConfig.mKeepAliveInterval));
+    }
+
+    if (sConfig.mDiagnosticInterval >= 0)
+    {
+        aInstance.SetDiagnosticInterval(static_cast<uint32_t>(sConfig.mDiagnosticInterval));
+    }
+
+    if (sConfig.mDuplicateLifetime >= 0)
+    {
+        aInstance.SetDuplicateLifetime(static_cast<uint32_t>(sConfig.mDuplicateLifetime));
+    }
+
+    pthread_mutex_unlock(&sConfigLock);
+
+exit:
+    return error;
+}
+
+// Set when the mainloop exits to stop the other threads.
+static bool sStopping = false;
+
+// An agent instance running on a thread other than the main thread.
+struct AgentThread
+{
+    ot::BorderRouter::AgentInstance *             mInstance;
+    pthread_t                                     mThread;
+    sem_t                                         mInitDone; ///< Posted once mInitError is set.
+    otbrError                                     mInitError;
+    unsigned int                                  mConfigGeneration; ///< The generation of the configuration applied.
+    const ot::BorderRouter::Scheduling::Priority *mPriority;   ///< The priority of the reactor, NULL for the default.
+    bool                                          mLockMemory; ///< Whether the stack is faulted in to be locked.
+};
+
+static void *RunInstance(void *aThread)
+{
+    AgentThread &thread = *static_cast<AgentThread *>(aThread);
+
+    // Before the mainloop locks the memory, once all instances are initialized.
+    if (thread.mLockMemory)
+    {
+        ot::BorderRouter::Scheduling::PrefaultStack();
+    }
+
+    // Instances initialize concurrently, so that the blocking D-Bus and NCP requests of one do not delay the others.
+    thread.mInitError = thread.mInstance->Init();
+    sem_post(&thread.mInitDone);
+    VerifyOrExit(thread.mInitError == OTBR_ERROR_NONE);
+
+    if (thread.mPriority != NULL &&
+        ot::BorderRouter::Scheduling::SetPriority(*thread.mPriority) != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to set the priority of agent thread: %s", strerror(errno));
+    }
+
+    while (!__atomic_load_n(&sStopping, __ATOMIC_ACQUIRE))
+    {
+        if (thread.mInstance->Poll(kThreadPollTimeout) != OTBR_ERROR_NONE)
+        {
+            break;
+        }
+
+        ApplyConfig(*thread.mInstance, thread.mConfigGeneration);
+    }
+
+exit:
+    return NULL;
+}
+
+int Mainloop(const char *const *                          aInterfaceNames,
+             uint8_t                                      aInterfaceCount,
+             unsigned int                                 aThreads,
+             unsigned int                                 aHandshakeWorkers,
+             unsigned int                                 aMaxDtlsSessions,
+             uint32_t                                     aDatasetCacheTimeout,
+             int                                          aPublishDelay,
+             uint16_t                                     aMetricsPort,
+             uint16_t                                     aWebPort,
+             const char *                                 aAdminSocket,
+             const char *                                 aStateDirectory,
+             uint32_t                                     aRetransmissionMin,
+             uint32_t                                     aRetransmissionMax,
+             uint16_t                                     aDtlsMtu,
+             const ot::BorderRouter::Scheduling::Priority *aPriority,
+             bool                                         aLockMemory,
+             int                                          aStallThreshold,
+             const char *                                 aRateLimits,
+             const char *                                 aConfigFile,
+             const char *                                 aTraceFile,
+             const char *                                 aTimelineFile)
+{
+    int                              rval = EXIT_FAILURE;
+    ot::BorderRouter::AgentInstance *instances[ot::BorderRouter::AgentInstance::kMaxNetworks];
+    AgentThread                      threads[ot::BorderRouter::AgentInstance::kMaxNetworks];
+    uint8_t                          instanceCount = 0;
+    uint8_t                          threadCount   = 0;
+    uint8_t                          count;
+    unsigned int                     configGeneration = 0;
+    otbrError                        error;
+
+    // Each instance serves a contiguous share of the networks on a thread of its own.
+    count = static_cast<uint8_t>(aThreads == 0 || aThreads > aInterfaceCount ? aInterfaceCount : aThreads);
+
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        uint8_t first = static_cast<uint8_t>(aInterfaceCount * i / count);
+        uint8_t last  = static_cast<uint8_t>(aInterfaceCount * (i + 1) / count);
+
+        instances[instanceCount++] = new ot::BorderRouter::AgentInstance(
+            aInterfaceNames + first, static_cast<uint8_t>(last - first), aHandshakeWorkers, aMaxDtlsSessions,
+            aDatasetCacheTimeout, aPublishDelay, first);
+
+        if (aRateLimits != NULL && instances[i]->SetRateLimits(aRateLimits) != OTBR_ERROR_NONE)
+        {
+            otbrLog(OTBR_LOG_ERR, "Invalid rate limits: %s", aRateLimits);
+            ExitNow();
+        }
+
+        instances[i]->SetDtlsLink(aRetransmissionMin, aRetransmissionMax, aDtlsMtu);
+
+        if (aStateDirectory != NULL)
+        {
+            instances[i]->SetStateDirectory(aStateDirectory);
+        }
+
+        if (aStallThreshold >= 0)
+        {
+            instances[i]->SetStallThreshold(static_cast<uint32_t>(aStallThreshold));
+        }
+
+        // The configuration file takes precedence over the options.
+        configGeneration = 0;
+        SuccessOrExit(ApplyConfig(*instances[i], configGeneration));
+    }
+
+    for (uint8_t i = 1; i < instanceCount; ++i)
+    {
+        AgentThread &thread = threads[threadCount];
+
+        thread.mInstance         = instances[i];
+        thread.mConfigGeneration = configGeneration;
+        thread.mPriority         = aPriority;
+        thread.mLockMemory       = aLockMemory;
+        VerifyOrExit(sem_init(&thread.mInitDone, 0, 0) == 0);
+        errno = pthread_create(&thread.mThread, NULL, RunInstance, &thread);
+
+        if (errno != 0)
+        {
+            otbrLog(OTBR_LOG_ERR, "Failed to start agent thread: %s", strerror(errno));
+            sem_destroy(&thread.mInitDone);
+            ExitNow();
+        }
+
+        ++threadCount;
+    }
+
+    // The threads of the other instances keep the signals blocked, until the mainloop runs they have their default
+    // action.
+    pthread_sigmask(SIG_SETMASK, &sWaitSignalMask, NULL);
+    error = instances[0]->Init();
+
+    for (uint8_t i = 0; i < threadCount; ++i)
+    {
+        while (sem_wait(&threads[i].mInitDone) != 0)
+            ;
+
+        if (error == OTBR_ERROR_NONE)
+        {
+            error = threads[i].mInitError;
+        }
+    }
+
+    SuccessOrExit(error);
+
+    // The pools of all instances are allocated by now, the buffers allocated later come from the locked heap.
+    if (aLockMemory && ot::BorderRouter::Scheduling::LockMemory() != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to lock memory: %s", strerror(errno));
+    }
+
+    if (aPriority != NULL && ot::BorderRouter::Scheduling::SetPriority(*aPriority) != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to set the priority of the mainloop: %s", strerror(errno));
+    }
+
+    if (aMetricsPort != 0 && instances[0]->StartMetricsServer(aMetricsPort) != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to serve metrics: %s", strerror(errno));
+    }
+
+    // Only the networks of the first instance are served, as for metrics.
+    if (aWebPort != 0 && instances[0]->StartWebApiServer(aWebPort) != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to serve the web API: %s", strerror(errno));
+    }
+
+    if (aAdminSocket != NULL && instances[0]->StartAdminServer(aAdminSocket) != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to serve admin commands on %s: %s", aAdminSocket, strerror(errno));
+    }
+
+    otbrLog(OTBR_LOG_INFO, "Border router agent started.");
+
+    pthread_sigmask(SIG_BLOCK, &sMainloopSignals, NULL);
+    instances[0]->SetSignalMask(&sWaitSignalMask);
+
+    signal(SIGUSR1, HandleDumpMetrics);
+    signal(SIGUSR2, HandleSaveTrace);
+    signal(SIGHUP, aConfigFile != NULL ? HandleReloadConfig : SIG_IGN);
+    signal(SIGTERM, HandleTerminate);
+    signal(SIGINT, HandleTerminate);
+
+    while (!sTerminate)
+    {
+        if (instances[0]->Poll(kPollTimeout) != OTBR_ERROR_NONE)
         {
             rval = OTBR_ERROR_ERRNO;
-            otbrLog(OTBR_LOG_ERR, "select() failed", strerror(errno));
             break;
         }
 
-        instance.Process(readFdSet, writeFdSet, errorFdSet);
+        if (sDumpMetrics)
+        {
+            sDumpMetrics = 0;
+            ot::BorderRouter::Metrics::Dump(OTBR_LOG_NOTICE);
+            instances[0]->DumpLoopHistory(OTBR_LOG_NOTICE);
+        }
+
+        if (sSaveTrace)
+        {
+            sSaveTrace = 0;
+
+            if (aTraceFile == NULL && aTimelineFile == NULL)
+            {
+                otbrLog(OTBR_LOG_WARNING, "Packet trace is not enabled");
+            }
+            else if (aTraceFile != NULL && ot::BorderRouter::PacketTrace::Save(aTraceFile) != OTBR_ERROR_NONE)
+            {
+                otbrLog(OTBR_LOG_WARNING, "Failed to save packet trace: %s", strerror(errno));
+            }
+
+            if (aTimelineFile != NULL && ot::BorderRouter::Timeline::Save(aTimelineFile) != OTBR_ERROR_NONE)
+            {
+                otbrLog(OTBR_LOG_WARNING, "Failed to save timeline: %s", strerror(errno));
+            }
+        }
+
+        // The other threads apply a reloaded configuration after their next poll.
+        if (sReloadConfig)
+        {
+            sReloadConfig = 0;
+
+            if (LoadConfig(aConfigFile) != OTBR_ERROR_NONE)
+            {
+                otbrLog(OTBR_LOG_WARNING, "Failed to reload %s: %s", aConfigFile, strerror(errno));
+            }
+            else
+            {
+                otbrLog(OTBR_LOG_INFO, "Reloaded %s", aConfigFile);
+            }
+        }
+
+        ApplyConfig(*instances[0], configGeneration);
+    }
+
+    if (sTerminate)
+    {
+        otbrLog(OTBR_LOG_INFO, "Border router agent stopped.");
+        rval = EXIT_SUCCESS;
     }
 
 exit:
+    __atomic_store_n(&sStopping, true, __ATOMIC_RELEASE);
+
+    for (uint8_t i = 0; i < threadCount; ++i)
+    {
+        pthread_join(threads[i].mThread, NULL);
+        sem_destroy(&threads[i].mInitDone);
+    }
+
+    for (uint8_t i = 0; i < instanceCount; ++i)
+    {
+        delete instances[i];
+    }
+
     return rval;
 }
 
@@ -90,21 +612,142 @@ void PrintVersion(void)
 
 int main(int argc, char *argv[])
 {
-    const char *interfaceName = kDefaultInterfaceName;
-    int         logLevel      = OTBR_LOG_INFO;
-    int         opt;
-    int         ret = 0;
+    const char * interfaceNames[ot::BorderRouter::AgentInstance::kMaxNetworks];
+    uint8_t      interfaceCount      = 0;
+    int          logLevel            = OTBR_LOG_INFO;
+    bool         logRing             = false;
+    const char * logFile             = NULL;
+    unsigned int threads             = 1;
+    unsigned int handshakeWorkers    = 0;
+    unsigned int maxDtlsSessions     = 0;
+    uint32_t     datasetCacheTimeout = 0;
+    int          publishDelay        = -1;
+    uint16_t     metricsPort         = 0;
+    uint16_t     webPort             = 0;
+    const char * adminSocket         = NULL;
+    const char * cpus                = NULL;
+    const char * stateDirectory      = NULL;
+    bool         lockMemory          = false;
+    bool         dispatchThread      = false;
+    bool         hasPriority         = false;
+    uint32_t     retransmissionMin   = 0;
+    uint32_t     retransmissionMax   = 0;
+    uint16_t     dtlsMtu             = kDefaultDtlsMtu;
+    int          stallThreshold      = -1;
+    const char * rateLimits          = NULL;
+    const char * configFile          = NULL;
+    const char * traceFile           = NULL;
+    const char * timelineFile        = NULL;
+    int          opt;
+    int          ret = 0;
 
-    while ((opt = getopt(argc, argv, "d:I:v")) != -1)
+    ot::BorderRouter::Scheduling::Priority priority;
+
+    while ((opt = getopt(argc, argv, "a:A:bc:C:d:De:H:I:lL:m:M:p:P:r:s:S:t:T:U:vw:W:")) != -1)
     {
         switch (opt)
         {
+        case 'a':
+            cpus = optarg;
+            break;
+
+        case 'A':
+            adminSocket = optarg;
+            break;
+
+        case 'b':
+            logRing = true;
+            break;
+
+        case 'c':
+            datasetCacheTimeout = static_cast<uint32_t>(atoi(optarg));
+            break;
+
+        case 'C':
+            configFile = optarg;
+            break;
+
         case 'd':
             logLevel = atoi(optarg);
             break;
 
+        case 'D':
+            dispatchThread = true;
+            break;
+
+        case 'e':
+            timelineFile = optarg;
+            break;
+
+        case 'H':
+            // The retransmission timeout starts at MIN_MS and doubles up to MAX_MS.
+            retransmissionMin = static_cast<uint32_t>(atoi(optarg));
+            retransmissionMax = strchr(optarg, '/') != NULL ? static_cast<uint32_t>(atoi(strchr(optarg, '/') + 1)) : 0;
+            break;
+
         case 'I':
-            interfaceName = optarg;
+            // Each NCP interface is served as a Thread network of its own.
+            if (interfaceCount == ot::BorderRouter::AgentInstance::kMaxNetworks)
+            {
+                fprintf(stderr, "At most %d interfaces are supported\n", ot::BorderRouter::AgentInstance::kMaxNetworks);
+                ExitNow(ret = -1);
+            }
+
+            interfaceNames[interfaceCount++] = optarg;
+            break;
+
+        case 'l':
+            lockMemory = true;
+            break;
+
+        case 'L':
+            logFile = optarg;
+            break;
+
+        case 'm':
+            maxDtlsSessions = static_cast<unsigned int>(atoi(optarg));
+            break;
+
+        case 'M':
+            metricsPort = static_cast<uint16_t>(atoi(optarg));
+            break;
+
+        case 'p':
+            publishDelay = atoi(optarg);
+            break;
+
+        case 'P':
+            if (ot::BorderRouter::Scheduling::ParsePriority(optarg, priority) != OTBR_ERROR_NONE)
+            {
+                fprintf(stderr, "Invalid priority: %s\n", optarg);
+                ExitNow(ret = -1);
+            }
+
+            hasPriority = true;
+            break;
+
+        case 'r':
+            rateLimits = optarg;
+            break;
+
+        case 's':
+            stallThreshold = atoi(optarg);
+            break;
+
+        case 'S':
+            stateDirectory = optarg;
+            break;
+
+        case 't':
+            threads = static_cast<unsigned int>(atoi(optarg));
+            break;
+
+        case 'T':
+            traceFile = optarg;
+            break;
+
+        case 'U':
+            dtlsMtu = static_cast<uint16_t>(atoi(optarg));
             break;
 
         case 'v':
@@ -112,17 +755,103 @@ int main(int argc, char *argv[])
             ExitNow();
             break;
 
+        case 'w':
+            handshakeWorkers = static_cast<unsigned int>(atoi(optarg));
+            break;
+
+        case 'W':
+            webPort = static_cast<uint16_t>(atoi(optarg));
+            break;
+
         default:
-            fprintf(stderr, "Usage: %s [-I interfaceName] [-d DEBUG_LEVEL] [-v]\n", argv[0]);
+            fprintf(stderr,
+                    "Usage: %s [-I interfaceName|spinel+hdlc+uart://DEVICE|sim://[latency=MS][,loss=PERCENT][,routers=N]]"
+                    "... [-a CPU[-CPU][,...]] [-A ADMIN_SOCKET] [-b] [-c DATASET_CACHE_MS] [-C CONFIG_FILE] "
+                    "[-d DEBUG_LEVEL] [-D] [-e TIMELINE_FILE] [-H MIN_MS[/MAX_MS]] [-l] [-L LOG_FILE] "
+                    "[-m MAX_DTLS_SESSIONS] [-M METRICS_PORT] [-p PUBLISH_DELAY_MS] [-P fifo=PRIORITY|nice=NICE] "
+                    "[-r KEY=RATE[/BURST][,...]] [-s STALL_THRESHOLD_MS] [-S STATE_DIR] "
+                    "[-t THREADS] [-T TRACE_FILE] [-U MTU] [-v] [-w HANDSHAKE_WORKERS] [-W WEB_PORT]\n",
+                    argv[0]);
             ExitNow(ret = -1);
             break;
         }
     }
 
+    if (interfaceCount == 0)
+    {
+        interfaceNames[interfaceCount++] = kDefaultInterfaceName;
+    }
+
+    // Before any thread is created, so that the signals of the mainloop are not delivered to other threads.
+    BlockMainloopSignals();
     otbrLogInit(kSyslogIdent, logLevel);
-    otbrLog(OTBR_LOG_INFO, "Starting border router agent on %s...", interfaceName);
 
-    ret = Mainloop(interfaceName);
+    // Before the log threads are created, so that they run on the CPUs of the agent as well.
+    if (cpus != NULL && ot::BorderRouter::Scheduling::SetAffinity(cpus) != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to set CPU affinity %s: %s", cpus, strerror(errno));
+    }
+
+    if (logFile != NULL)
+    {
+        otbrLogSetFilename(logFile);
+
+        if (otbrLogStartFileWriter(kLogBufferSize, kLogMaxFileSize) != OTBR_ERROR_NONE)
+        {
+            otbrLog(OTBR_LOG_WARNING, "Failed to start log file writer: %s", strerror(errno));
+        }
+    }
+
+    // Logs are formatted off the mainloop by a background thread.
+    if (logRing && otbrLogRingStart(true) != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to start log thread: %s", strerror(errno));
+    }
+
+    // Frames are recorded to a ring from now on, and written to the trace file on SIGUSR2.
+    if (traceFile != NULL && ot::BorderRouter::PacketTrace::Start() != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to start packet trace: %s", strerror(errno));
+        traceFile = NULL;
+    }
+
+    // Spans of agent activity are recorded from now on, and written to the timeline file on SIGUSR2.
+    if (timelineFile != NULL && ot::BorderRouter::Timeline::Start() != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to start timeline: %s", strerror(errno));
+        timelineFile = NULL;
+    }
+
+    // D-Bus traffic with wpantund is then read and dispatched without delaying the mainloop.
+    ot::BorderRouter::Ncp::Controller::SetDispatchThread(dispatchThread);
+
+    // The settings of the configuration file can be changed without restarting, by sending SIGHUP.
+    if (configFile != NULL && LoadConfig(configFile) != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to load %s: %s", configFile, strerror(errno));
+        ret = -1;
+    }
+    else
+    {
+        char features[64];
+
+        // The kernels of hex, CRC16 and PSKc computations are bound to these features.
+        otbrLog(OTBR_LOG_INFO, "CPU features: %s",
+                ot::Utils::CpuFeatures::Format(ot::Utils::CpuFeatures::Get(), features, sizeof(features)));
+
+        for (uint8_t i = 0; i < interfaceCount; ++i)
+        {
+            otbrLog(OTBR_LOG_INFO, "Starting border router agent on %s...", interfaceNames[i]);
+        }
+
+        ret = Mainloop(interfaceNames, interfaceCount, threads, handshakeWorkers, maxDtlsSessions,
+                       datasetCacheTimeout, publishDelay, metricsPort, webPort, adminSocket, stateDirectory,
+                       retransmissionMin, retransmissionMax, dtlsMtu, hasPriority ? &priority : NULL, lockMemory,
+                       stallThreshold, rateLimits, configFile, traceFile, timelineFile);
+    }
+
+    ot::BorderRouter::PacketTrace::Stop();
+    ot::BorderRouter::Timeline::Stop();
 
     otbrLogDeinit();
 
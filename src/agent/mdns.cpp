@@ -0,0 +1,152 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the text record of MDNS services.
+ */
+
+#include "mdns.hpp"
+
+#include <errno.h>
+#include <string.h>
+
+#include "common/code_utils.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Mdns {
+
+uint16_t TxtRecord::FindEntry(const char *aKey) const
+{
+    size_t   keyLength = strlen(aKey);
+    uint16_t offset    = 0;
+
+    while (offset < mLength)
+    {
+        uint8_t length = mData[offset];
+
+        if (length > keyLength && mData[offset + 1 + keyLength] == '=' &&
+            memcmp(&mData[offset + 1], aKey, keyLength) == 0)
+        {
+            break;
+        }
+
+        offset = static_cast<uint16_t>(offset + 1 + length);
+    }
+
+    return offset;
+}
+
+otbrError TxtRecord::SetEntry(const char *aKey, const uint8_t *aValue, uint8_t aValueLength)
+{
+    otbrError error     = OTBR_ERROR_NONE;
+    size_t    keyLength = strlen(aKey);
+    uint16_t  offset    = FindEntry(aKey);
+    uint16_t  oldLength = 0;
+    size_t    entryLength;
+
+    VerifyOrExit(keyLength > 0 && strchr(aKey, '=') == NULL, error = OTBR_ERROR_ERRNO, errno = EINVAL);
+
+    entryLength = keyLength + 1 + aValueLength;
+
+    if (offset < mLength)
+    {
+        oldLength = static_cast<uint16_t>(1 + mData[offset]);
+    }
+
+    VerifyOrExit(entryLength <= UINT8_MAX && mLength - oldLength + 1 + entryLength <= sizeof(mData),
+                 error = OTBR_ERROR_ERRNO, errno = EMSGSIZE);
+
+    // Entries following the one replaced are moved to make room for the new value.
+    memmove(&mData[offset + 1 + entryLength], &mData[offset + oldLength], mLength - offset - oldLength);
+    mData[offset] = static_cast<uint8_t>(entryLength);
+    memcpy(&mData[offset + 1], aKey, keyLength);
+    mData[offset + 1 + keyLength] = '=';
+    memcpy(&mData[offset + 2 + keyLength], aValue, aValueLength);
+    mLength = static_cast<uint16_t>(mLength - oldLength + 1 + entryLength);
+
+exit:
+    return error;
+}
+
+otbrError TxtRecord::SetEntry(const char *aKey, const char *aValue)
+{
+    otbrError error  = OTBR_ERROR_ERRNO;
+    size_t    length = strlen(aValue);
+
+    VerifyOrExit(length <= UINT8_MAX, errno = EMSGSIZE);
+    error = SetEntry(aKey, reinterpret_cast<const uint8_t *>(aValue), static_cast<uint8_t>(length));
+
+exit:
+    return error;
+}
+
+otbrError TxtRecord::RemoveEntry(const char *aKey)
+{
+    otbrError error  = OTBR_ERROR_NONE;
+    uint16_t  offset = FindEntry(aKey);
+    uint16_t  length;
+
+    VerifyOrExit(offset < mLength, error = OTBR_ERROR_ERRNO, errno = ENOENT);
+
+    length = static_cast<uint16_t>(1 + mData[offset]);
+    memmove(&mData[offset], &mData[offset + length], mLength - offset - length);
+    mLength = static_cast<uint16_t>(mLength - length);
+
+exit:
+    return error;
+}
+
+const uint8_t *TxtRecord::GetEntry(const char *aKey, uint8_t &aValueLength) const
+{
+    const uint8_t *value     = NULL;
+    size_t         keyLength = strlen(aKey);
+    uint16_t       offset    = FindEntry(aKey);
+
+    VerifyOrExit(offset < mLength);
+
+    value        = &mData[offset + 1 + keyLength + 1];
+    aValueLength = static_cast<uint8_t>(mData[offset] - keyLength - 1);
+
+exit:
+    return value;
+}
+
+bool TxtRecord::operator==(const TxtRecord &aOther) const
+{
+    return mLength == aOther.mLength && memcmp(mData, aOther.mData, mLength) == 0;
+}
+
+} // namespace Mdns
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -34,6 +34,8 @@
 #ifndef MDNS_HPP_
 #define MDNS_HPP_
 
+#include "common/reactor.hpp"
+#include "common/timer.hpp"
 #include "common/types.hpp"
 
 namespace ot {
@@ -61,6 +63,19 @@ enum State
  */
 typedef void (*StateHandler)(void *aContext, State aState);
 
+/**
+ * This function pointer is called when the name of a service conflicts with the one of another host.
+ *
+ * The handler may publish the service again with another name, which is probed instead. Otherwise the publisher
+ * picks an alternative name of its own.
+ *
+ * @param[in]   aContext        A pointer to application-specific context.
+ * @param[in]   aPort           The port number of the service.
+ * @param[in]   aType           The type of the service.
+ *
+ */
+typedef void (*ConflictHandler)(void *aContext, uint16_t aPort, const char *aType);
+
 /**
  * @addtogroup border-router-mdns
  *
@@ -70,6 +85,125 @@ typedef void (*StateHandler)(void *aContext, State aState);
  * @{
  */
 
+/**
+ * This class implements a text record of a service, encoded as the RDATA of a DNS TXT record.
+ *
+ * Entries are kept encoded, in the order they were first set, so that publishers can compare and send the record
+ * as is. Values are binary-safe.
+ *
+ */
+class TxtRecord
+{
+public:
+    enum
+    {
+        kMaxSize = 255, ///< Max size of an encoded text record.
+    };
+
+    /**
+     * The constructor to initialize an empty text record.
+     *
+     */
+    TxtRecord(void)
+        : mLength(0)
+    {
+    }
+
+    /**
+     * This method sets the value of an entry, adding the entry if not present.
+     *
+     * An entry already present keeps its position in the record.
+     *
+     * @param[in]   aKey            The key of the entry, a non-empty null-terminated string without '='.
+     * @param[in]   aValue          A pointer to the value.
+     * @param[in]   aValueLength    Number of bytes of @p aValue.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully set the entry.
+     * @retval  OTBR_ERROR_ERRNO    Failed for an invalid key, errno is set to EINVAL, or the entry does not fit,
+     *                              errno is set to EMSGSIZE.
+     *
+     */
+    otbrError SetEntry(const char *aKey, const uint8_t *aValue, uint8_t aValueLength);
+
+    /**
+     * This method sets the string value of an entry, adding the entry if not present.
+     *
+     * @param[in]   aKey            The key of the entry, a non-empty null-terminated string without '='.
+     * @param[in]   aValue          The null-terminated value.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully set the entry.
+     * @retval  OTBR_ERROR_ERRNO    Failed for an invalid key or the entry does not fit, errno is set.
+     *
+     */
+    otbrError SetEntry(const char *aKey, const char *aValue);
+
+    /**
+     * This method removes an entry.
+     *
+     * @param[in]   aKey            The key of the entry.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully removed the entry.
+     * @retval  OTBR_ERROR_ERRNO    No such entry, errno is set to ENOENT.
+     *
+     */
+    otbrError RemoveEntry(const char *aKey);
+
+    /**
+     * This method returns the value of an entry.
+     *
+     * @param[in]   aKey            The key of the entry.
+     * @param[out]  aValueLength    Number of bytes of the value.
+     *
+     * @returns A pointer to the value, NULL if no such entry.
+     *
+     */
+    const uint8_t *GetEntry(const char *aKey, uint8_t &aValueLength) const;
+
+    /**
+     * This method removes all entries.
+     *
+     */
+    void Clear(void) { mLength = 0; }
+
+    /**
+     * This method returns the encoded text record.
+     *
+     * @returns A pointer to the encoded text record.
+     *
+     */
+    const uint8_t *GetData(void) const { return mData; }
+
+    /**
+     * This method returns the length of the encoded text record.
+     *
+     * @returns Number of bytes of the encoded text record, 0 if there is no entry.
+     *
+     */
+    uint16_t GetLength(void) const { return mLength; }
+
+    /**
+     * This method indicates whether two text records have the same entries in the same order.
+     *
+     * @param[in]   aOther          A reference to the other text record.
+     *
+     */
+    bool operator==(const TxtRecord &aOther) const;
+
+    /**
+     * This method indicates whether two text records differ.
+     *
+     * @param[in]   aOther          A reference to the other text record.
+     *
+     */
+    bool operator!=(const TxtRecord &aOther) const { return !(*this == aOther); }
+
+private:
+    uint16_t FindEntry(const char *aKey) const;
+
+    uint8_t  mData[kMaxSize];
+    uint16_t mLength;
+};
+
 /**
  * This interface defines the functionality of MDNS service.
  *
@@ -104,17 +238,38 @@ public:
     /**
      * This method publishes or updates a service.
      *
+     * A service already published with the same interface, type and port is updated in place: a new text record is
+     * applied without re-probing, and a new name only re-announces this publisher's own records. Changes of several
+     * services made in one mainloop iteration are committed together.
+     *
+     * @param[in]   aInterfaceIndex     The index of the network interface to publish on, 0 for all interfaces.
+     * @param[in]   aPort               The port number of this service.
      * @param[in]   aName               The name of this service.
      * @param[in]   aType               The type of this service.
-     * @param[in]   aPort               The port number of this service.
-     * @param[in]   ...                 Pointers to null-terminated string of key and value for text record.
-     *                                  The last argument must be NULL.
+     * @param[in]   aTxt                A reference to the text record of this service.
      *
      * @retval  OTBR_ERROR_NONE     Successfully published or updated the service.
      * @retval  OTBR_ERROR_ERRNO    Failed to publish or update the service.
      *
      */
-    virtual otbrError PublishService(uint16_t aPort, const char *aName, const char *aType, ...) = 0;
+    virtual otbrError PublishService(unsigned int     aInterfaceIndex,
+                                     uint16_t         aPort,
+                                     const char *     aName,
+                                     const char *     aType,
+                                     const TxtRecord &aTxt) = 0;
+
+    /**
+     * This method withdraws a service, leaving other services of this publisher published.
+     *
+     * @param[in]   aInterfaceIndex     The index of the network interface the service is published on.
+     * @param[in]   aPort               The port number of this service.
+     * @param[in]   aType               The type of this service.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully withdrawn the service.
+     * @retval  OTBR_ERROR_ERRNO    No such service, errno is set to ENOENT.
+     *
+     */
+    virtual otbrError UnpublishService(unsigned int aInterfaceIndex, uint16_t aPort, const char *aType) = 0;
 
     /**
      * This method performs the MDNS processing.
@@ -143,6 +298,19 @@ public:
                              int &    aMaxFd,
                              timeval &aTimeout) = 0;
 
+    /**
+     * This method sets the function to be called when the name of a service conflicts.
+     *
+     * @param[in]   aHandler            The function to be called, NULL to always pick alternative names.
+     * @param[in]   aContext            A pointer to application-specific context.
+     *
+     */
+    void SetConflictHandler(ConflictHandler aHandler, void *aContext)
+    {
+        mConflictHandler = aHandler;
+        mConflictContext = aContext;
+    }
+
     virtual ~Publisher(void) {}
 
     /**
@@ -153,6 +321,10 @@ public:
      * @param[in]   aDomain             The domain to register in.
      * @param[in]   aHandler            The function to be called when this service state changed.
      * @param[in]   aContext            A pointer to application-specific context.
+     * @param[in]   aReactor            A pointer to the reactor to register file descriptors with, NULL to use
+     *                                  UpdateFdSet() and Process() only.
+     * @param[in]   aTimerWheel         A pointer to the timer wheel to schedule avahi timeouts with, NULL to have
+     *                                  them scheduled by UpdateFdSet() and Process().
      *
      * @returns A pointer to the newly created MDNS publisher.
      *
@@ -161,7 +333,9 @@ public:
                              const char * aHost,
                              const char * aDomain,
                              StateHandler aHandler,
-                             void *       aContext);
+                             void *       aContext,
+                             Reactor *    aReactor    = NULL,
+                             TimerWheel * aTimerWheel = NULL);
 
     /**
      * This function destroies the MDNS publisher.
@@ -170,6 +344,37 @@ public:
      *
      */
     static void Destroy(Publisher *aPublisher);
+
+protected:
+    Publisher(void)
+        : mConflictHandler(NULL)
+        , mConflictContext(NULL)
+    {
+    }
+
+    /**
+     * This method reports the conflict of a service name to the conflict handler.
+     *
+     * @param[in]   aPort           The port number of the service.
+     * @param[in]   aType           The type of the service.
+     *
+     * @retval  true    The handler was called.
+     * @retval  false   No handler is set.
+     *
+     */
+    bool ReportConflict(uint16_t aPort, const char *aType)
+    {
+        if (mConflictHandler != NULL)
+        {
+            mConflictHandler(mConflictContext, aPort, aType);
+        }
+
+        return mConflictHandler != NULL;
+    }
+
+private:
+    ConflictHandler mConflictHandler;
+    void *          mConflictContext;
 };
 
 /**
@@ -31,6 +31,8 @@
  *   This file implements MDNS service based on avahi.
  */
 
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_MDNS
+
 #include "mdns_avahi.hpp"
 
 #include <avahi-common/alternative.h>
@@ -45,33 +47,67 @@
 
 #include "common/code_utils.hpp"
 #include "common/logging.hpp"
-#include "common/time.hpp"
+#include "common/metrics.hpp"
+#include "common/probes.hpp"
+#include "common/timeline.hpp"
 
-AvahiTimeout::AvahiTimeout(const struct timeval *aTimeout,
-                           AvahiTimeoutCallback  aCallback,
-                           void *                aContext,
-                           void *                aPoller)
-    : mCallback(aCallback)
-    , mContext(aContext)
-    , mPoller(aPoller)
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Mdns {
+
+static Metrics::Memory sTxtListMemory("memory.mdns_txt");
+
+/**
+ * This function returns the memory allocated for a text record list.
+ *
+ */
+static size_t GetTxtListSize(const AvahiStringList *aTxtList)
 {
-    if (aTimeout)
-    {
-        mTimeout = ot::BorderRouter::GetNow() + ot::BorderRouter::GetTimestamp(*aTimeout);
-    }
-    else
+    size_t size = 0;
+
+    // Each string is allocated along with its list node.
+    for (const AvahiStringList *node = aTxtList; node != NULL; node = node->next)
     {
-        mTimeout = 0;
+        size += sizeof(AvahiStringList) + node->size;
     }
+
+    return size;
 }
 
-namespace ot {
+/**
+ * This function frees the text record list of a published service.
+ *
+ */
+static void FreeTxtList(AvahiStringList *aTxtList)
+{
+    sTxtListMemory.Free(GetTxtListSize(aTxtList));
+    avahi_string_list_free(aTxtList);
+}
 
-namespace BorderRouter {
+static unsigned int ToReactorEvents(AvahiWatchEvent aEvents)
+{
+    unsigned int events = 0;
 
-namespace Mdns {
+    if (AVAHI_WATCH_IN & aEvents)
+    {
+        events |= ot::BorderRouter::Reactor::kEventReadable;
+    }
+
+    if (AVAHI_WATCH_OUT & aEvents)
+    {
+        events |= ot::BorderRouter::Reactor::kEventWritable;
+    }
 
-Poller::Poller(void)
+    return events;
+}
+
+Poller::Poller(Reactor *aReactor, TimerWheel *aTimerWheel)
+    : mWatches(NULL)
+    , mNextWatch(NULL)
+    , mReactor(aReactor)
+    , mTimerWheel(aTimerWheel != NULL ? aTimerWheel : &mLocalTimerWheel)
 {
     mAvahiPoller.userdata         = this;
     mAvahiPoller.watch_new        = WatchNew;
@@ -97,14 +133,59 @@ AvahiWatch *Poller::WatchNew(int aFd, AvahiWatchEvent aEvent, AvahiWatchCallback
 {
     assert(aEvent && aCallback && aFd >= 0);
 
-    mWatches.push_back(new AvahiWatch(aFd, aEvent, aCallback, aContext, this));
+    AvahiWatch *watch = new AvahiWatch(aFd, aEvent, aCallback, aContext, this);
+
+    if (mReactor != NULL &&
+        mReactor->Add(watch->mWatch, aFd, ToReactorEvents(aEvent), HandleWatch, watch, "avahi") != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to watch avahi fd %d: %s!", aFd, strerror(errno));
+    }
+
+    watch->mNext = mWatches;
+    watch->mPrev = &mWatches;
 
-    return mWatches.back();
+    if (mWatches != NULL)
+    {
+        mWatches->mPrev = &watch->mNext;
+    }
+
+    mWatches = watch;
+
+    return watch;
 }
 
 void Poller::WatchUpdate(AvahiWatch *aWatch, AvahiWatchEvent aEvent)
 {
     aWatch->mEvents = aEvent;
+
+    if (aWatch->mWatch.mFd >= 0)
+    {
+        static_cast<Poller *>(aWatch->mPoller)->mReactor->Modify(aWatch->mWatch, ToReactorEvents(aEvent));
+    }
+}
+
+void Poller::HandleWatch(void *aContext, int aFd, unsigned int aEvents)
+{
+    AvahiWatch *watch = static_cast<AvahiWatch *>(aContext);
+
+    watch->mHappened = 0;
+
+    if (aEvents & Reactor::kEventReadable)
+    {
+        watch->mHappened |= AVAHI_WATCH_IN;
+    }
+
+    if (aEvents & Reactor::kEventWritable)
+    {
+        watch->mHappened |= AVAHI_WATCH_OUT;
+    }
+
+    if (aEvents & Reactor::kEventError)
+    {
+        watch->mHappened |= AVAHI_WATCH_ERR;
+    }
+
+    watch->mCallback(watch, aFd, static_cast<AvahiWatchEvent>(watch->mHappened), watch->mContext);
 }
 
 AvahiWatchEvent Poller::WatchGetEvents(AvahiWatch *aWatch)
@@ -119,15 +200,24 @@ void Poller::WatchFree(AvahiWatch *aWatch)
 
 void Poller::WatchFree(AvahiWatch &aWatch)
 {
-    for (Watches::iterator it = mWatches.begin(); it != mWatches.end(); ++it)
+    if (aWatch.mWatch.mFd >= 0)
     {
-        if (*it == &aWatch)
-        {
-            mWatches.erase(it);
-            delete &aWatch;
-            break;
-        }
+        mReactor->Remove(aWatch.mWatch);
     }
+
+    if (mNextWatch == &aWatch)
+    {
+        mNextWatch = aWatch.mNext;
+    }
+
+    *aWatch.mPrev = aWatch.mNext;
+
+    if (aWatch.mNext != NULL)
+    {
+        aWatch.mNext->mPrev = aWatch.mPrev;
+    }
+
+    delete &aWatch;
 }
 
 AvahiTimeout *Poller::TimeoutNew(const AvahiPoll *     aPoller,
@@ -141,46 +231,45 @@ AvahiTimeout *Poller::TimeoutNew(const AvahiPoll *     aPoller,
 
 AvahiTimeout *Poller::TimeoutNew(const struct timeval *aTimeout, AvahiTimeoutCallback aCallback, void *aContext)
 {
-    mTimers.push_back(new AvahiTimeout(aTimeout, aCallback, aContext, this));
-    return mTimers.back();
+    AvahiTimeout *timeout = new AvahiTimeout(aCallback, aContext, this);
+
+    TimeoutUpdate(*timeout, aTimeout);
+
+    return timeout;
 }
 
 void Poller::TimeoutUpdate(AvahiTimeout *aTimer, const struct timeval *aTimeout)
+{
+    static_cast<Poller *>(aTimer->mPoller)->TimeoutUpdate(*aTimer, aTimeout);
+}
+
+void Poller::TimeoutUpdate(AvahiTimeout &aTimer, const struct timeval *aTimeout)
 {
     if (aTimeout == NULL)
     {
-        aTimer->mTimeout = 0;
+        mTimerWheel->Stop(aTimer.mTimer);
     }
     else
     {
-        aTimer->mTimeout = ot::BorderRouter::GetNow() + ot::BorderRouter::GetTimestamp(*aTimeout);
+        // Avahi timeouts are absolute wall clock time.
+        AvahiUsec age = avahi_age(aTimeout);
+
+        mTimerWheel->Start(aTimer.mTimer, age < 0 ? static_cast<uint64_t>(-age + 999) / 1000 : 0);
     }
 }
 
 void Poller::TimeoutFree(AvahiTimeout *aTimer)
 {
-    static_cast<Poller *>(aTimer->mPoller)->TimeoutFree(*aTimer);
-}
-
-void Poller::TimeoutFree(AvahiTimeout &aTimer)
-{
-    for (Timers::iterator it = mTimers.begin(); it != mTimers.end(); ++it)
-    {
-        if (*it == &aTimer)
-        {
-            mTimers.erase(it);
-            delete &aTimer;
-            break;
-        }
-    }
+    delete aTimer;
 }
 
 void Poller::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd, timeval &aTimeout)
 {
-    for (Watches::iterator it = mWatches.begin(); it != mWatches.end(); ++it)
+    // Watches are registered with the reactor directly.
+    for (AvahiWatch *watch = mWatches; mReactor == NULL && watch != NULL; watch = watch->mNext)
     {
-        int             fd     = (*it)->mFd;
-        AvahiWatchEvent events = (*it)->mEvents;
+        int             fd     = watch->mFd;
+        AvahiWatchEvent events = watch->mEvents;
 
         if (AVAHI_WATCH_IN & events)
         {
@@ -207,102 +296,53 @@ void Poller::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aError
             aMaxFd = fd;
         }
 
-        (*it)->mHappened = 0;
+        watch->mHappened = 0;
     }
 
-    unsigned long now = GetNow();
-
-    for (Timers::iterator it = mTimers.begin(); it != mTimers.end(); ++it)
+    if (mTimerWheel == &mLocalTimerWheel)
     {
-        unsigned long timeout = (*it)->mTimeout;
-
-        if (timeout == 0)
-        {
-            continue;
-        }
-
-        if (static_cast<long>(timeout - now) <= 0)
-        {
-            aTimeout.tv_usec = 0;
-            aTimeout.tv_sec  = 0;
-            break;
-        }
-        else
-        {
-            int sec;
-            int usec;
-
-            timeout -= now;
-            sec  = timeout / 1000;
-            usec = (timeout % 1000) * 1000;
-
-            if (sec < aTimeout.tv_sec)
-            {
-                aTimeout.tv_sec = sec;
-            }
-            else if (sec == aTimeout.tv_sec)
-            {
-                if (usec < aTimeout.tv_usec)
-                {
-                    aTimeout.tv_usec = usec;
-                }
-            }
-        }
+        mLocalTimerWheel.UpdateTimeout(aTimeout);
     }
 }
 
 void Poller::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
 {
-    unsigned long now = GetNow();
-
-    for (Watches::iterator it = mWatches.begin(); it != mWatches.end(); ++it)
+    // Callbacks may free any watch, mNextWatch is advanced by WatchFree() if needed.
+    for (AvahiWatch *watch = (mReactor == NULL ? mWatches : NULL); watch != NULL; watch = mNextWatch)
     {
-        int             fd     = (*it)->mFd;
-        AvahiWatchEvent events = (*it)->mEvents;
+        int             fd     = watch->mFd;
+        AvahiWatchEvent events = watch->mEvents;
 
-        (*it)->mHappened = 0;
+        mNextWatch       = watch->mNext;
+        watch->mHappened = 0;
 
         if ((AVAHI_WATCH_IN & events) && FD_ISSET(fd, &aReadFdSet))
         {
-            (*it)->mHappened |= AVAHI_WATCH_IN;
+            watch->mHappened |= AVAHI_WATCH_IN;
         }
 
         if ((AVAHI_WATCH_OUT & events) && FD_ISSET(fd, &aWriteFdSet))
         {
-            (*it)->mHappened |= AVAHI_WATCH_OUT;
+            watch->mHappened |= AVAHI_WATCH_OUT;
         }
 
         if ((AVAHI_WATCH_ERR & events) && FD_ISSET(fd, &aErrorFdSet))
         {
-            (*it)->mHappened |= AVAHI_WATCH_ERR;
+            watch->mHappened |= AVAHI_WATCH_ERR;
         }
 
         // TODO hup events
-        if ((*it)->mHappened)
+        if (watch->mHappened)
         {
-            (*it)->mCallback(*it, (*it)->mFd, static_cast<AvahiWatchEvent>((*it)->mHappened), (*it)->mContext);
+            watch->mCallback(watch, watch->mFd, static_cast<AvahiWatchEvent>(watch->mHappened), watch->mContext);
         }
     }
 
-    std::vector<AvahiTimeout *> expired;
+    mNextWatch = NULL;
 
-    for (Timers::iterator it = mTimers.begin(); it != mTimers.end(); ++it)
+    if (mTimerWheel == &mLocalTimerWheel)
     {
-        if ((*it)->mTimeout == 0)
-        {
-            continue;
-        }
-
-        if (static_cast<long>((*it)->mTimeout - now) <= 0)
-        {
-            expired.push_back(*it);
-        }
-    }
-
-    for (std::vector<AvahiTimeout *>::iterator it = expired.begin(); it != expired.end(); ++it)
-    {
-        AvahiTimeout *avahiTimeout = *it;
-        avahiTimeout->mCallback(avahiTimeout, avahiTimeout->mContext);
+        mLocalTimerWheel.Process();
     }
 }
 
@@ -310,9 +350,13 @@ PublisherAvahi::PublisherAvahi(int          aProtocol,
                                const char * aHost,
                                const char * aDomain,
                                StateHandler aHandler,
-                               void *       aContext)
+                               void *       aContext,
+                               Reactor *    aReactor,
+                               TimerWheel * aTimerWheel)
     : mClient(NULL)
     , mGroup(NULL)
+    , mPoller(aReactor, aTimerWheel)
+    , mCommitTimer(HandleCommitTimer, this)
     , mProtocol(aProtocol == AF_INET6 ? AVAHI_PROTO_INET6
                                       : aProtocol == AF_INET ? AVAHI_PROTO_INET : AVAHI_PROTO_UNSPEC)
     , mHost(NULL)
@@ -334,6 +378,8 @@ PublisherAvahi::PublisherAvahi(int          aProtocol,
 
 PublisherAvahi::~PublisherAvahi(void)
 {
+    ClearServices();
+
     if (mHost)
     {
         free(mHost);
@@ -366,9 +412,77 @@ bool PublisherAvahi::IsStarted(void) const
     return mClient != NULL;
 }
 
-void PublisherAvahi::Stop(void)
+void PublisherAvahi::ClearServices(void)
 {
+    for (Services::iterator it = mServices.begin(); it != mServices.end(); ++it)
+    {
+        FreeTxtList(it->mTxtList);
+    }
+
     mServices.clear();
+}
+
+int PublisherAvahi::CommitServices(void)
+{
+    int error = 0;
+
+    // Only this group re-probes, the client and host records are kept established.
+    SuccessOrExit(error = avahi_entry_group_reset(mGroup));
+
+    for (Services::iterator it = mServices.begin(); it != mServices.end(); ++it)
+    {
+        SuccessOrExit(error = avahi_entry_group_add_service_strlst(mGroup, it->mInterface, mProtocol,
+                                                                   static_cast<AvahiPublishFlags>(0), it->mName,
+                                                                   it->mType, mDomain, mHost, it->mPort, it->mTxtList));
+    }
+
+    error = avahi_entry_group_commit(mGroup);
+
+exit:
+    return error;
+}
+
+void PublisherAvahi::ScheduleCommit(void)
+{
+    if (!mCommitTimer.IsRunning())
+    {
+        mPoller.GetTimerWheel().Start(mCommitTimer, 0);
+    }
+}
+
+void PublisherAvahi::HandleCommitTimer(void *aContext)
+{
+    PublisherAvahi *publisher = static_cast<PublisherAvahi *>(aContext);
+    Timeline::Span  span("mdns.commit");
+    int             error     = publisher->CommitServices();
+
+    if (error)
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to commit services for avahi error: %s!", avahi_strerror(error));
+    }
+}
+
+PublisherAvahi::Services::iterator PublisherAvahi::FindService(AvahiIfIndex aInterface,
+                                                               uint16_t     aPort,
+                                                               const char * aType)
+{
+    Services::iterator it;
+
+    for (it = mServices.begin(); it != mServices.end(); ++it)
+    {
+        if (it->mInterface == aInterface && it->mPort == aPort && !strncmp(it->mType, aType, sizeof(it->mType)))
+        {
+            break;
+        }
+    }
+
+    return it;
+}
+
+void PublisherAvahi::Stop(void)
+{
+    ClearServices();
+    mPoller.GetTimerWheel().Stop(mCommitTimer);
 
     if (mGroup)
     {
@@ -416,7 +530,8 @@ void PublisherAvahi::HandleGroupState(AvahiEntryGroup *aGroup, AvahiEntryGroupSt
         break;
 
     case AVAHI_ENTRY_GROUP_COLLISION:
-        otbrLog(OTBR_LOG_ERR, "Name collision!");
+        otbrLog(OTBR_LOG_WARNING, "Name collision!");
+        HandleCollision();
         break;
 
     case AVAHI_ENTRY_GROUP_FAILURE:
@@ -436,6 +551,34 @@ void PublisherAvahi::HandleGroupState(AvahiEntryGroup *aGroup, AvahiEntryGroupSt
     }
 }
 
+void PublisherAvahi::HandleCollision(void)
+{
+    // avahi does not tell which service collided, each service of the group is renamed and probed again.
+    for (size_t i = 0; i < mServices.size(); ++i)
+    {
+        char name[kMaxSizeOfServiceName];
+
+        strncpy(name, mServices[i].mName, sizeof(name));
+
+        // The handler renames the service in place, the commit is then scheduled.
+        if (!ReportConflict(mServices[i].mPort, mServices[i].mType) || !strncmp(mServices[i].mName, name, sizeof(name)))
+        {
+            char *alternative = avahi_alternative_service_name(name);
+
+            VerifyOrExit(alternative != NULL);
+            otbrLog(OTBR_LOG_INFO, "MDNS renaming service %s to %s...", name, alternative);
+            strncpy(mServices[i].mName, alternative, sizeof(mServices[i].mName) - 1);
+            mServices[i].mName[sizeof(mServices[i].mName) - 1] = '\0';
+            avahi_free(alternative);
+        }
+    }
+
+    ScheduleCommit();
+
+exit:
+    return;
+}
+
 void PublisherAvahi::CreateGroup(AvahiClient *aClient)
 {
     VerifyOrExit(mGroup == NULL);
@@ -461,7 +604,9 @@ void PublisherAvahi::HandleClientState(AvahiClient *aClient, AvahiClientState aS
         mState = kStateReady;
         CreateGroup(aClient);
         mStateHandler(mContext, mState);
-        avahi_entry_group_commit(mGroup);
+        // Services published by the state handler, or kept from before the host name changed, all in one commit.
+        mPoller.GetTimerWheel().Stop(mCommitTimer);
+        HandleCommitTimer(this);
         break;
 
     case AVAHI_CLIENT_FAILURE:
@@ -483,6 +628,8 @@ void PublisherAvahi::HandleClientState(AvahiClient *aClient, AvahiClientState aS
          * might be caused by a host name change. We need to wait
          * for our own records to register until the host name is
          * properly esatblished. */
+        mPoller.GetTimerWheel().Stop(mCommitTimer);
+
         if (mGroup)
         {
             avahi_entry_group_reset(mGroup);
@@ -513,71 +660,80 @@ void PublisherAvahi::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet
     mPoller.Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
 }
 
-otbrError PublisherAvahi::PublishService(uint16_t aPort, const char *aName, const char *aType, ...)
+otbrError PublisherAvahi::PublishService(unsigned int     aInterfaceIndex,
+                                         uint16_t         aPort,
+                                         const char *     aName,
+                                         const char *     aType,
+                                         const TxtRecord &aTxt)
 {
-    otbrError ret   = OTBR_ERROR_ERRNO;
-    int       error = 0;
-    // aligned with AvahiStringList
-    AvahiStringList  buffer[kMaxSizeOfTxtRecord / sizeof(AvahiStringList)];
-    AvahiStringList *last = NULL;
-    AvahiStringList *curr = buffer;
-    va_list          args;
-    size_t           used = 0;
-
-    va_start(args, aType);
+    otbrError          ret       = OTBR_ERROR_ERRNO;
+    int                error     = 0;
+    AvahiStringList *  txtList   = NULL;
+    AvahiIfIndex       interface = aInterfaceIndex == 0 ? AVAHI_IF_UNSPEC : static_cast<AvahiIfIndex>(aInterfaceIndex);
+    Services::iterator it;
 
     VerifyOrExit(mState == kStateReady, errno = EAGAIN);
+    OTBR_PROBE3(mdns_publish, aName, aType, aPort);
 
-    for (const char *name = va_arg(args, const char *); name; name = va_arg(args, const char *))
-    {
-        int         rval;
-        const char *value  = va_arg(args, const char *);
-        size_t      needed = sizeof(AvahiStringList) + strlen(name) + strlen(value);
-
-        VerifyOrExit(used + needed < sizeof(buffer), errno = EMSGSIZE);
-        curr->next = last;
-        last       = curr;
-        rval       = sprintf(reinterpret_cast<char *>(curr->text), "%s=%s", name, value);
-        assert(rval > 0);
-        curr->size = static_cast<size_t>(rval);
-        {
-            const uint8_t *next = curr->text + curr->size;
-            curr                = OTBR_ALIGNED(next, AvahiStringList *);
-        }
-        used = static_cast<size_t>(reinterpret_cast<uint8_t *>(curr) - reinterpret_cast<uint8_t *>(buffer));
-    }
+    it = FindService(interface, aPort, aType);
 
-    for (Services::iterator it = mServices.begin(); it != mServices.end(); ++it)
+    if (it != mServices.end() && !strncmp(it->mName, aName, sizeof(it->mName)) && it->mTxt == aTxt)
     {
-        if (!strncmp(it->mName, aName, sizeof(it->mName)) && !strncmp(it->mType, aType, sizeof(it->mType)) &&
-            it->mPort == aPort)
-        {
-            otbrLog(OTBR_LOG_INFO, "MDNS updating service %s...", aName);
-            error = avahi_entry_group_update_service_txt_strlst(
-                mGroup, AVAHI_IF_UNSPEC, mProtocol, static_cast<AvahiPublishFlags>(0), aName, aType, mDomain, last);
-            SuccessOrExit(error);
-            ret = OTBR_ERROR_NONE;
-            ExitNow();
-        }
+        otbrLog(OTBR_LOG_DEBUG, "MDNS service %s unchanged", aName);
+        ExitNow(ret = OTBR_ERROR_NONE);
     }
 
-    otbrLog(OTBR_LOG_INFO, "MDNS creating service %s...", aName);
-    error = avahi_entry_group_add_service_strlst(mGroup, AVAHI_IF_UNSPEC, mProtocol, static_cast<AvahiPublishFlags>(0),
-                                                 aName, aType, mDomain, mHost, aPort, last);
-    SuccessOrExit(error);
+    // Only parsed when the text record changed.
+    SuccessOrExit(error = avahi_string_list_parse(aTxt.GetData(), aTxt.GetLength(), &txtList));
 
+    if (it == mServices.end())
     {
         Service service;
+
+        otbrLog(OTBR_LOG_INFO, "MDNS creating service %s...", aName);
         strncpy(service.mName, aName, sizeof(service.mName));
         strncpy(service.mType, aType, sizeof(service.mType));
-        service.mPort = aPort;
+        service.mPort      = aPort;
+        service.mInterface = interface;
+        service.mTxt       = aTxt;
+        service.mTxtList   = txtList;
         mServices.push_back(service);
+        // Entries cannot be added to a committed group.
+        ScheduleCommit();
     }
+    else if (strncmp(it->mName, aName, sizeof(it->mName)))
+    {
+        otbrLog(OTBR_LOG_INFO, "MDNS renaming service %s to %s...", it->mName, aName);
+        strncpy(it->mName, aName, sizeof(it->mName));
+        FreeTxtList(it->mTxtList);
+        it->mTxt     = aTxt;
+        it->mTxtList = txtList;
+        ScheduleCommit();
+    }
+    else
+    {
+        otbrLog(OTBR_LOG_INFO, "MDNS updating service %s...", aName);
 
-    ret = OTBR_ERROR_NONE;
+        // A pending commit re-adds the service with the new text record anyway.
+        if (!mCommitTimer.IsRunning())
+        {
+            error = avahi_entry_group_update_service_txt_strlst(mGroup, interface, mProtocol,
+                                                               static_cast<AvahiPublishFlags>(0), aName, aType,
+                                                               mDomain, txtList);
+            SuccessOrExit(error);
+        }
+
+        FreeTxtList(it->mTxtList);
+        it->mTxt     = aTxt;
+        it->mTxtList = txtList;
+    }
+
+    sTxtListMemory.Allocate(GetTxtListSize(txtList));
+    txtList = NULL;
+    ret     = OTBR_ERROR_NONE;
 
 exit:
-    va_end(args);
+    avahi_string_list_free(txtList);
 
     if (error)
     {
@@ -593,15 +749,46 @@ exit:
     return ret;
 }
 
-Publisher *Publisher::Create(int aFamily, const char *aHost, const char *aDomain, StateHandler aHandler, void *aContext)
+otbrError PublisherAvahi::UnpublishService(unsigned int aInterfaceIndex, uint16_t aPort, const char *aType)
+{
+    otbrError          ret       = OTBR_ERROR_ERRNO;
+    AvahiIfIndex       interface = aInterfaceIndex == 0 ? AVAHI_IF_UNSPEC : static_cast<AvahiIfIndex>(aInterfaceIndex);
+    Services::iterator it        = FindService(interface, aPort, aType);
+
+    VerifyOrExit(it != mServices.end(), errno = ENOENT);
+
+    otbrLog(OTBR_LOG_INFO, "MDNS removing service %s...", it->mName);
+    FreeTxtList(it->mTxtList);
+    mServices.erase(it);
+
+    if (mState == kStateReady)
+    {
+        ScheduleCommit();
+    }
+
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    return ret;
+}
+
+#if !OTBR_ENABLE_NATIVE_MDNS
+Publisher *Publisher::Create(int          aFamily,
+                             const char * aHost,
+                             const char * aDomain,
+                             StateHandler aHandler,
+                             void *       aContext,
+                             Reactor *    aReactor,
+                             TimerWheel * aTimerWheel)
 {
-    return new PublisherAvahi(aFamily, aHost, aDomain, aHandler, aContext);
+    return new PublisherAvahi(aFamily, aHost, aDomain, aHandler, aContext, aReactor, aTimerWheel);
 }
 
 void Publisher::Destroy(Publisher *aPublisher)
 {
     delete static_cast<PublisherAvahi *>(aPublisher);
 }
+#endif // !OTBR_ENABLE_NATIVE_MDNS
 
 } // namespace Mdns
 
@@ -65,6 +65,10 @@ struct AvahiWatch
     AvahiWatchCallback mCallback; ///< The function to be called when interested events happened on mFd.
     void *             mContext;  ///< A pointer to application-specific context.
     void *             mPoller;   ///< The poller created this watch.
+    AvahiWatch *       mNext;     ///< The next watch of the poller.
+    AvahiWatch **      mPrev;     ///< The link pointing to this watch.
+
+    ot::BorderRouter::Reactor::Watch mWatch; ///< The reactor registration of this watch.
 
     /**
      * The constructor to initialize an Avahi watch.
@@ -82,6 +86,8 @@ struct AvahiWatch
         , mCallback(aCallback)
         , mContext(aContext)
         , mPoller(aPoller)
+        , mNext(NULL)
+        , mPrev(NULL)
     {
     }
 };
@@ -92,21 +98,39 @@ struct AvahiWatch
  */
 struct AvahiTimeout
 {
-    unsigned long        mTimeout;  ///< Absolute time when this timer timeout.
-    AvahiTimeoutCallback mCallback; ///< The function to be called when timeout.
-    void *               mContext;  ///< The pointer to application-specific context.
-    void *               mPoller;   ///< The poller created this timer.
+    ot::BorderRouter::Timer mTimer;    ///< The timer scheduled on the timer wheel of the poller.
+    AvahiTimeoutCallback    mCallback; ///< The function to be called when timeout.
+    void *                  mContext;  ///< The pointer to application-specific context.
+    void *                  mPoller;   ///< The poller created this timer.
 
     /**
      * The constructor to initialize an AvahiTimeout.
      *
-     * @param[in]   aTimeout    A pointer to the time after which the callback should be called.
      * @param[in]   aCallback   The function to be called after timeout.
      * @param[in]   aContext    A pointer to application-specific context.
      * @param[in]   aPoller     The Poller this timeout belongs to.
      *
      */
-    AvahiTimeout(const struct timeval *aTimeout, AvahiTimeoutCallback aCallback, void *aContext, void *aPoller);
+    AvahiTimeout(AvahiTimeoutCallback aCallback, void *aContext, void *aPoller)
+        : mTimer(HandleTimer, this)
+        , mCallback(aCallback)
+        , mContext(aContext)
+        , mPoller(aPoller)
+    {
+    }
+
+    /**
+     * This method is called by the timer wheel when the timeout fires.
+     *
+     * @param[in]   aContext    A pointer to the AvahiTimeout.
+     *
+     */
+    static void HandleTimer(void *aContext)
+    {
+        AvahiTimeout *timeout = static_cast<AvahiTimeout *>(aContext);
+
+        timeout->mCallback(timeout, timeout->mContext);
+    }
 };
 
 namespace ot {
@@ -125,8 +149,12 @@ public:
     /**
      * The constructor to initialize a Poller.
      *
+     * @param[in]   aReactor    A pointer to the reactor to register watches with, NULL to use the fd_set interface.
+     * @param[in]   aTimerWheel A pointer to the timer wheel to schedule timeouts with, NULL to use a private one
+     *                          processed by UpdateFdSet() and Process().
+     *
      */
-    Poller(void);
+    Poller(Reactor *aReactor, TimerWheel *aTimerWheel);
 
     /**
      * This method updates the fd_set and timeout for mainloop.
@@ -158,10 +186,15 @@ public:
      */
     const AvahiPoll *GetAvahiPoll(void) const { return &mAvahiPoller; }
 
-private:
-    typedef std::vector<AvahiWatch *>   Watches;
-    typedef std::vector<AvahiTimeout *> Timers;
+    /**
+     * This method returns the timer wheel timeouts are scheduled with.
+     *
+     * @returns A reference to the timer wheel.
+     *
+     */
+    TimerWheel &GetTimerWheel(void) { return *mTimerWheel; }
 
+private:
     static AvahiWatch *    WatchNew(const struct AvahiPoll *aPoller,
                                     int                     aFd,
                                     AvahiWatchEvent         aEvent,
@@ -172,18 +205,22 @@ private:
     static AvahiWatchEvent WatchGetEvents(AvahiWatch *aWatch);
     static void            WatchFree(AvahiWatch *aWatch);
     void                   WatchFree(AvahiWatch &aWatch);
+    static void            HandleWatch(void *aContext, int aFd, unsigned int aEvents);
     static AvahiTimeout *  TimeoutNew(const AvahiPoll *     aPoller,
                                       const struct timeval *aTimeout,
                                       AvahiTimeoutCallback  aCallback,
                                       void *                aContext);
     AvahiTimeout *         TimeoutNew(const struct timeval *aTimeout, AvahiTimeoutCallback aCallback, void *aContext);
     static void            TimeoutUpdate(AvahiTimeout *aTimer, const struct timeval *aTimeout);
+    void                   TimeoutUpdate(AvahiTimeout &aTimer, const struct timeval *aTimeout);
     static void            TimeoutFree(AvahiTimeout *aTimer);
-    void                   TimeoutFree(AvahiTimeout &aTimer);
 
-    Watches   mWatches;
-    Timers    mTimers;
-    AvahiPoll mAvahiPoller;
+    AvahiWatch * mWatches;   ///< Watches are linked in place, so that freeing one is O(1).
+    AvahiWatch * mNextWatch; ///< The next watch to be processed by Process().
+    AvahiPoll    mAvahiPoller;
+    Reactor *    mReactor;
+    TimerWheel   mLocalTimerWheel;
+    TimerWheel * mTimerWheel;
 };
 
 /**
@@ -202,28 +239,56 @@ public:
      * @param[in]   aDomain             The domain of the host. NULL to use default.
      * @param[in]   aHandler            The function to be called when state changes.
      * @param[in]   aContext            A pointer to application-specific context.
+     * @param[in]   aReactor            A pointer to the reactor, NULL to use the fd_set interface.
+     * @param[in]   aTimerWheel         A pointer to the timer wheel, NULL to use the fd_set interface.
      *
      */
-    PublisherAvahi(int aProtocol, const char *aHost, const char *aDomain, StateHandler aHandler, void *aContext);
+    PublisherAvahi(int          aProtocol,
+                   const char * aHost,
+                   const char * aDomain,
+                   StateHandler aHandler,
+                   void *       aContext,
+                   Reactor *    aReactor,
+                   TimerWheel * aTimerWheel);
 
     ~PublisherAvahi(void);
 
     /**
      * This method publishes or updates a service.
      *
-     * @note only text record can be updated.
+     * All services share one entry group. A service already published with the same interface, type and port is
+     * updated in place. A new text record is applied with avahi_entry_group_update_service_txt_strlst(), while new
+     * names and new services reset and re-commit the entry group once the current mainloop iteration is done, so
+     * that changes of several services are committed together and the avahi client and host records stay alive.
      *
+     * @param[in]   aInterfaceIndex     The index of the network interface to publish on, 0 for all interfaces.
+     * @param[in]   aPort               The port number of this service.
      * @param[in]   aName               The name of this service.
      * @param[in]   aType               The type of this service.
-     * @param[in]   aPort               The port number of this service.
-     * @param[in]   ...                 Pointers to null-terminated string of key and value for text record.
-     *                                  The last argument must be NULL.
+     * @param[in]   aTxt                A reference to the text record of this service.
      *
      * @retval  OTBR_ERROR_NONE     Successfully published or updated the service.
      * @retval  OTBR_ERROR_ERRNO    Failed to publish or update the service.
      *
      */
-    otbrError PublishService(uint16_t aPort, const char *aName, const char *aType, ...);
+    otbrError PublishService(unsigned int     aInterfaceIndex,
+                             uint16_t         aPort,
+                             const char *     aName,
+                             const char *     aType,
+                             const TxtRecord &aTxt);
+
+    /**
+     * This method withdraws a service, the entry group is re-committed with the remaining services.
+     *
+     * @param[in]   aInterfaceIndex     The index of the network interface the service is published on.
+     * @param[in]   aPort               The port number of this service.
+     * @param[in]   aType               The type of this service.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully withdrawn the service.
+     * @retval  OTBR_ERROR_ERRNO    No such service, errno is set to ENOENT.
+     *
+     */
+    otbrError UnpublishService(unsigned int aInterfaceIndex, uint16_t aPort, const char *aType);
 
     /**
      * This method starts the MDNS service.
@@ -274,7 +339,6 @@ public:
 private:
     enum
     {
-        kMaxSizeOfTxtRecord   = 128,
         kMaxSizeOfServiceName = AVAHI_LABEL_MAX,
         kMaxSizeOfHost        = AVAHI_LABEL_MAX,
         kMaxSizeOfDomain      = AVAHI_LABEL_MAX,
@@ -283,9 +347,12 @@ private:
 
     struct Service
     {
-        char     mName[kMaxSizeOfServiceName];
-        char     mType[kMaxSizeOfServiceType];
-        uint16_t mPort;
+        char             mName[kMaxSizeOfServiceName];
+        char             mType[kMaxSizeOfServiceType];
+        uint16_t         mPort;
+        AvahiIfIndex     mInterface; ///< The interface published on, AVAHI_IF_UNSPEC for all interfaces.
+        TxtRecord        mTxt;       ///< The text record, compared with updates.
+        AvahiStringList *mTxtList;   ///< The text record parsed for avahi, owned by the publisher.
     };
 
     typedef std::vector<Service> Services;
@@ -293,14 +360,21 @@ private:
     static void HandleClientState(AvahiClient *aClient, AvahiClientState aState, void *aContext);
     void        HandleClientState(AvahiClient *aClient, AvahiClientState aState);
 
-    void        CreateGroup(AvahiClient *aClient);
-    static void HandleGroupState(AvahiEntryGroup *aGroup, AvahiEntryGroupState aState, void *aContext);
-    void        HandleGroupState(AvahiEntryGroup *aGroup, AvahiEntryGroupState aState);
+    void               CreateGroup(AvahiClient *aClient);
+    int                CommitServices(void);
+    void               ClearServices(void);
+    Services::iterator FindService(AvahiIfIndex aInterface, uint16_t aPort, const char *aType);
+    void               ScheduleCommit(void);
+    static void        HandleCommitTimer(void *aContext);
+    static void        HandleGroupState(AvahiEntryGroup *aGroup, AvahiEntryGroupState aState, void *aContext);
+    void               HandleGroupState(AvahiEntryGroup *aGroup, AvahiEntryGroupState aState);
+    void               HandleCollision(void);
 
     Services         mServices;
     AvahiClient *    mClient;
     AvahiEntryGroup *mGroup;
     Poller           mPoller;
+    Timer            mCommitTimer; ///< Commits the changes of services made in one mainloop iteration.
     int              mProtocol;
     char *           mHost;
     char *           mDomain;
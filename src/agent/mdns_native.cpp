@@ -0,0 +1,1534 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the built-in MDNS responder.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_MDNS
+
+#include "mdns_native.hpp"
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/probes.hpp"
+#include "common/time.hpp"
+#include "common/timeline.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Mdns {
+
+namespace {
+
+enum
+{
+    kTypeA    = 1,
+    kTypePtr  = 12,
+    kTypeTxt  = 16,
+    kTypeAaaa = 28,
+    kTypeSrv  = 33,
+    kTypeAny  = 255,
+};
+
+enum
+{
+    kClassIn              = 1,
+    kClassMask            = 0x7fff,
+    kClassCacheFlush      = 0x8000, ///< The cache-flush bit of records.
+    kClassUnicastResponse = 0x8000, ///< The unicast-response bit of questions.
+};
+
+enum
+{
+    kHeaderSize        = 12,
+    kFlagResponse      = 0x8000,
+    kFlagAuthoritative = 0x0400,
+    kOpcodeMask        = 0x7800,
+    kMaxPointerHops    = 16,  ///< Max number of compression pointers followed in a name.
+    kMaxConflicts      = 15,  ///< Number of conflicts after which probing is rate limited.
+    kConflictDelay     = 5000,
+};
+
+enum ResponseType
+{
+    kResponseCached,  ///< Multicast response with all records.
+    kResponseGoodbye, ///< Multicast response with service records of zero TTL.
+    kResponseLegacy,  ///< Unicast response to a legacy resolver.
+};
+
+const uint8_t kIp4MappedPrefix[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+
+uint16_t ReadUint16(const uint8_t *aBuffer)
+{
+    return static_cast<uint16_t>((aBuffer[0] << 8) | aBuffer[1]);
+}
+
+uint32_t ReadUint32(const uint8_t *aBuffer)
+{
+    return (static_cast<uint32_t>(ReadUint16(aBuffer)) << 16) | ReadUint16(aBuffer + 2);
+}
+
+/**
+ * This class implements a bounded writer of DNS messages.
+ *
+ */
+class Writer
+{
+public:
+    Writer(uint8_t *aBuffer, uint16_t aSize)
+        : mBuffer(aBuffer)
+        , mSize(aSize)
+        , mLength(0)
+    {
+    }
+
+    void Append(const void *aData, uint16_t aLength)
+    {
+        if (mLength + aLength <= mSize)
+        {
+            memcpy(mBuffer + mLength, aData, aLength);
+        }
+
+        mLength += aLength;
+    }
+
+    void AppendUint16(uint16_t aValue)
+    {
+        uint8_t value[] = {static_cast<uint8_t>(aValue >> 8), static_cast<uint8_t>(aValue)};
+
+        Append(value, sizeof(value));
+    }
+
+    void AppendUint32(uint32_t aValue)
+    {
+        AppendUint16(static_cast<uint16_t>(aValue >> 16));
+        AppendUint16(static_cast<uint16_t>(aValue));
+    }
+
+    void AppendHeader(uint16_t aId,
+                      uint16_t aFlags,
+                      uint16_t aQuestions,
+                      uint16_t aAnswers,
+                      uint16_t aAuthorities,
+                      uint16_t aAdditionals)
+    {
+        AppendUint16(aId);
+        AppendUint16(aFlags);
+        AppendUint16(aQuestions);
+        AppendUint16(aAnswers);
+        AppendUint16(aAuthorities);
+        AppendUint16(aAdditionals);
+    }
+
+    /**
+     * This method appends the fixed part of a resource record, the data length is set by EndRecord().
+     *
+     * @returns The offset of the data length.
+     *
+     */
+    uint32_t BeginRecord(const uint8_t *aName, uint16_t aNameLength, uint16_t aType, uint16_t aClass, uint32_t aTtl)
+    {
+        Append(aName, aNameLength);
+        AppendUint16(aType);
+        AppendUint16(aClass);
+        AppendUint32(aTtl);
+        AppendUint16(0);
+
+        return mLength - sizeof(uint16_t);
+    }
+
+    void EndRecord(uint32_t aOffset)
+    {
+        if (mLength <= mSize)
+        {
+            uint32_t length = mLength - aOffset - sizeof(uint16_t);
+
+            mBuffer[aOffset]     = static_cast<uint8_t>(length >> 8);
+            mBuffer[aOffset + 1] = static_cast<uint8_t>(length);
+        }
+    }
+
+    /**
+     * This method returns the length written.
+     *
+     * @returns The length written, 0 if the buffer overflowed.
+     *
+     */
+    uint16_t GetLength(void) const { return mLength <= mSize ? static_cast<uint16_t>(mLength) : 0; }
+
+private:
+    uint8_t *mBuffer;
+    uint16_t mSize;
+    uint32_t mLength;
+};
+
+/**
+ * This function appends labels to an encoded name, without the terminating root label.
+ *
+ * @param[in]       aLabels     The labels, separated by dots unless @p aSingle.
+ * @param[in]       aSingle     Whether @p aLabels is one label, which may contain dots.
+ * @param[inout]    aName       A pointer to the encoded name.
+ * @param[inout]    aLength     The length of @p aName.
+ *
+ */
+otbrError AppendLabels(const char *aLabels, bool aSingle, uint8_t *aName, uint16_t &aLength)
+{
+    otbrError error = OTBR_ERROR_NONE;
+
+    while (*aLabels != '\0')
+    {
+        size_t length = aSingle ? strlen(aLabels) : strcspn(aLabels, ".");
+
+        VerifyOrExit(length <= Responder::kMaxSizeOfLabel && aLength + length + 2 <= Responder::kMaxSizeOfName,
+                     error = OTBR_ERROR_ERRNO, errno = EMSGSIZE);
+
+        if (length > 0)
+        {
+            aName[aLength++] = static_cast<uint8_t>(length);
+            memcpy(aName + aLength, aLabels, length);
+            aLength += static_cast<uint16_t>(length);
+        }
+
+        aLabels += length;
+
+        if (*aLabels == '.')
+        {
+            ++aLabels;
+        }
+    }
+
+exit:
+    return error;
+}
+
+/**
+ * This function reads a name of a DNS message into its uncompressed encoding.
+ *
+ * @param[in]       aMessage    A pointer to the message.
+ * @param[in]       aLength     Number of bytes of @p aMessage.
+ * @param[inout]    aOffset     The offset of the name, set to the offset following it on success.
+ * @param[out]      aName       A pointer to a buffer of kMaxSizeOfName bytes to receive the name.
+ * @param[out]      aNameLength The length of the name.
+ *
+ */
+otbrError ReadName(const uint8_t *aMessage, uint16_t aLength, uint16_t &aOffset, uint8_t *aName, uint16_t &aNameLength)
+{
+    otbrError    error  = OTBR_ERROR_ERRNO;
+    uint16_t     offset = aOffset;
+    uint16_t     length = 0;
+    bool         jumped = false;
+    unsigned int hops   = 0;
+
+    while (offset < aLength)
+    {
+        uint8_t label = aMessage[offset];
+
+        if ((label & 0xc0) == 0xc0)
+        {
+            VerifyOrExit(offset + 1 < aLength && ++hops <= kMaxPointerHops);
+
+            if (!jumped)
+            {
+                aOffset = static_cast<uint16_t>(offset + 2);
+                jumped  = true;
+            }
+
+            offset = static_cast<uint16_t>(((label & 0x3f) << 8) | aMessage[offset + 1]);
+            continue;
+        }
+
+        VerifyOrExit((label & 0xc0) == 0 && offset + 1 + label <= aLength &&
+                     length + 1 + label <= Responder::kMaxSizeOfName);
+        memcpy(aName + length, aMessage + offset, label + 1U);
+        length = static_cast<uint16_t>(length + 1 + label);
+        offset = static_cast<uint16_t>(offset + 1 + label);
+
+        if (label == 0)
+        {
+            if (!jumped)
+            {
+                aOffset = offset;
+            }
+
+            aNameLength = length;
+            ExitNow(error = OTBR_ERROR_NONE);
+        }
+    }
+
+exit:
+    if (error != OTBR_ERROR_NONE)
+    {
+        errno = EBADMSG;
+    }
+
+    return error;
+}
+
+bool NameEquals(const uint8_t *aName1, uint16_t aLength1, const uint8_t *aName2, uint16_t aLength2)
+{
+    bool equal = (aLength1 == aLength2);
+
+    // Label lengths are below 64, so they are never folded.
+    for (uint16_t i = 0; equal && i < aLength1; ++i)
+    {
+        equal = (tolower(aName1[i]) == tolower(aName2[i]));
+    }
+
+    return equal;
+}
+
+} // namespace
+
+Responder::Responder(SendHandler aSendHandler, void *aContext)
+    : mSendHandler(aSendHandler)
+    , mConflictHandler(NULL)
+    , mContext(aContext)
+    , mHostNameLength(0)
+    , mDomainNameLength(0)
+    , mAddressCount(0)
+{
+    memset(mServices, 0, sizeof(mServices));
+}
+
+otbrError Responder::SetHostName(const char *aHost, const char *aDomain)
+{
+    otbrError error = OTBR_ERROR_NONE;
+
+    mDomainNameLength = 0;
+    SuccessOrExit(error = AppendLabels(aDomain != NULL ? aDomain : "local", false, mDomainName, mDomainNameLength));
+    mDomainName[mDomainNameLength++] = 0;
+
+    mHostNameLength = 0;
+    SuccessOrExit(error = AppendLabels(aHost, true, mHostName, mHostNameLength));
+    VerifyOrExit(mHostNameLength + mDomainNameLength <= kMaxSizeOfName, error = OTBR_ERROR_ERRNO, errno = EMSGSIZE);
+    memcpy(mHostName + mHostNameLength, mDomainName, mDomainNameLength);
+    mHostNameLength += mDomainNameLength;
+
+    for (size_t i = 0; i < kMaxServices; ++i)
+    {
+        if (mServices[i].mState != kServiceFree)
+        {
+            Build(mServices[i]);
+        }
+    }
+
+exit:
+    return error;
+}
+
+void Responder::SetAddresses(const uint8_t (*aAddresses)[16], uint8_t aCount)
+{
+    if (aCount > kMaxAddresses)
+    {
+        aCount = kMaxAddresses;
+    }
+
+    VerifyOrExit(aCount != mAddressCount || memcmp(mAddresses, aAddresses, aCount * sizeof(mAddresses[0])));
+
+    memcpy(mAddresses, aAddresses, aCount * sizeof(mAddresses[0]));
+    mAddressCount = aCount;
+
+    for (size_t i = 0; i < kMaxServices; ++i)
+    {
+        if (mServices[i].mState != kServiceFree)
+        {
+            Build(mServices[i]);
+        }
+    }
+
+exit:
+    return;
+}
+
+Responder::Service *Responder::FindService(const char *aType, uint16_t aPort)
+{
+    Service *service = NULL;
+
+    for (size_t i = 0; i < kMaxServices; ++i)
+    {
+        if (mServices[i].mState != kServiceFree && mServices[i].mPort == aPort &&
+            !strncmp(mServices[i].mType, aType, sizeof(mServices[i].mType)))
+        {
+            ExitNow(service = &mServices[i]);
+        }
+    }
+
+exit:
+    return service;
+}
+
+const char *Responder::GetServiceName(const char *aType, uint16_t aPort) const
+{
+    const Service *service = const_cast<Responder *>(this)->FindService(aType, aPort);
+
+    return service != NULL ? service->mName : NULL;
+}
+
+bool Responder::IsServiceEstablished(const char *aType, uint16_t aPort) const
+{
+    const Service *service = const_cast<Responder *>(this)->FindService(aType, aPort);
+
+    return service != NULL && service->mState == kServiceEstablished;
+}
+
+otbrError Responder::UpdateNames(Service &aService)
+{
+    otbrError error = OTBR_ERROR_NONE;
+
+    if (aService.mConflicts == 0)
+    {
+        strcpy(aService.mName, aService.mBaseName);
+    }
+    else
+    {
+        char suffix[8];
+        int  baseLength;
+
+        snprintf(suffix, sizeof(suffix), " (%u)", aService.mConflicts + 1U);
+        baseLength = static_cast<int>(kMaxSizeOfLabel - strlen(suffix));
+        snprintf(aService.mName, sizeof(aService.mName), "%.*s%s", baseLength, aService.mBaseName, suffix);
+    }
+
+    aService.mTypeNameLength = 0;
+    SuccessOrExit(error = AppendLabels(aService.mType, false, aService.mTypeName, aService.mTypeNameLength));
+    VerifyOrExit(aService.mTypeNameLength + mDomainNameLength <= kMaxSizeOfName, error = OTBR_ERROR_ERRNO,
+                 errno = EMSGSIZE);
+    memcpy(aService.mTypeName + aService.mTypeNameLength, mDomainName, mDomainNameLength);
+    aService.mTypeNameLength += mDomainNameLength;
+
+    aService.mInstanceNameLength = 0;
+    SuccessOrExit(error = AppendLabels(aService.mName, true, aService.mInstanceName, aService.mInstanceNameLength));
+    VerifyOrExit(aService.mInstanceNameLength + aService.mTypeNameLength <= kMaxSizeOfName, error = OTBR_ERROR_ERRNO,
+                 errno = EMSGSIZE);
+    memcpy(aService.mInstanceName + aService.mInstanceNameLength, aService.mTypeName, aService.mTypeNameLength);
+    aService.mInstanceNameLength += aService.mTypeNameLength;
+
+exit:
+    return error;
+}
+
+void Responder::Build(Service &aService)
+{
+    aService.mResponseLength = BuildResponse(aService, kResponseCached, 0, NULL, 0, 0, aService.mResponse,
+                                             sizeof(aService.mResponse));
+
+    if (aService.mResponseLength == 0)
+    {
+        otbrLog(OTBR_LOG_WARNING, "MDNS response of %s is too large!", aService.mName);
+    }
+}
+
+uint16_t Responder::BuildResponse(const Service &aService,
+                                  int            aType,
+                                  uint16_t       aId,
+                                  const uint8_t *aQuestions,
+                                  uint16_t       aQuestionsLength,
+                                  uint16_t       aQuestionCount,
+                                  uint8_t *      aBuffer,
+                                  uint16_t       aSize) const
+{
+    Writer   writer(aBuffer, aSize);
+    uint32_t ttlHost   = kTtlHost;
+    uint32_t ttlOther  = kTtlOther;
+    uint16_t flush     = kClassCacheFlush;
+    uint8_t  addresses = mAddressCount;
+    uint32_t offset;
+
+    if (aType == kResponseGoodbye)
+    {
+        ttlHost   = 0;
+        ttlOther  = 0;
+        addresses = 0;
+    }
+    else if (aType == kResponseLegacy)
+    {
+        ttlHost  = kTtlLegacyUnicast;
+        ttlOther = kTtlLegacyUnicast;
+        flush    = 0;
+    }
+
+    writer.AppendHeader(aId, kFlagResponse | kFlagAuthoritative, aQuestionCount, 3, 0, addresses);
+
+    // Questions follow the header in both messages, so their compression pointers stay valid.
+    writer.Append(aQuestions, aQuestionsLength);
+
+    offset = writer.BeginRecord(aService.mTypeName, aService.mTypeNameLength, kTypePtr, kClassIn, ttlOther);
+    writer.Append(aService.mInstanceName, aService.mInstanceNameLength);
+    writer.EndRecord(offset);
+
+    offset = writer.BeginRecord(aService.mInstanceName, aService.mInstanceNameLength, kTypeSrv, kClassIn | flush,
+                                ttlHost);
+    writer.AppendUint16(0); // priority
+    writer.AppendUint16(0); // weight
+    writer.AppendUint16(aService.mPort);
+    writer.Append(mHostName, mHostNameLength);
+    writer.EndRecord(offset);
+
+    offset = writer.BeginRecord(aService.mInstanceName, aService.mInstanceNameLength, kTypeTxt, kClassIn | flush,
+                                ttlOther);
+    writer.Append(aService.mTxt, aService.mTxtLength);
+    writer.EndRecord(offset);
+
+    for (uint8_t i = 0; i < addresses; ++i)
+    {
+        bool ip4 = !memcmp(mAddresses[i], kIp4MappedPrefix, sizeof(kIp4MappedPrefix));
+
+        offset = writer.BeginRecord(mHostName, mHostNameLength, ip4 ? kTypeA : kTypeAaaa, kClassIn | flush, ttlHost);
+        writer.Append(ip4 ? mAddresses[i] + sizeof(kIp4MappedPrefix) : mAddresses[i], ip4 ? 4 : 16);
+        writer.EndRecord(offset);
+    }
+
+    return writer.GetLength();
+}
+
+uint16_t Responder::BuildProbe(const Service &aService, uint8_t *aBuffer, uint16_t aSize) const
+{
+    Writer   writer(aBuffer, aSize);
+    uint32_t offset;
+
+    writer.AppendHeader(0, 0, 1, 0, 2, 0);
+
+    writer.Append(aService.mInstanceName, aService.mInstanceNameLength);
+    writer.AppendUint16(kTypeAny);
+    writer.AppendUint16(kClassIn | kClassUnicastResponse);
+
+    // The proposed records, for simultaneous probes to be told apart.
+    offset = writer.BeginRecord(aService.mInstanceName, aService.mInstanceNameLength, kTypeSrv, kClassIn, kTtlHost);
+    writer.AppendUint16(0);
+    writer.AppendUint16(0);
+    writer.AppendUint16(aService.mPort);
+    writer.Append(mHostName, mHostNameLength);
+    writer.EndRecord(offset);
+
+    offset = writer.BeginRecord(aService.mInstanceName, aService.mInstanceNameLength, kTypeTxt, kClassIn, kTtlOther);
+    writer.Append(aService.mTxt, aService.mTxtLength);
+    writer.EndRecord(offset);
+
+    return writer.GetLength();
+}
+
+void Responder::SendGoodbye(const Service &aService)
+{
+    uint8_t  buffer[kMaxSizeOfResponse];
+    uint16_t length = BuildResponse(aService, kResponseGoodbye, 0, NULL, 0, 0, buffer, sizeof(buffer));
+
+    if (length > 0)
+    {
+        mSendHandler(buffer, length, false, mContext);
+    }
+}
+
+otbrError Responder::Publish(const char *   aName,
+                             const char *   aType,
+                             uint16_t       aPort,
+                             const uint8_t *aTxt,
+                             uint16_t       aTxtLength,
+                             uint64_t       aNow)
+{
+    // An empty text record is a single empty string.
+    const uint8_t kEmptyTxt[] = {0};
+    otbrError     error       = OTBR_ERROR_NONE;
+    Service *     service     = FindService(aType, aPort);
+
+    if (aTxtLength == 0)
+    {
+        aTxt       = kEmptyTxt;
+        aTxtLength = sizeof(kEmptyTxt);
+    }
+
+    VerifyOrExit(aTxtLength <= kMaxSizeOfTxtRecord && strlen(aType) < kMaxSizeOfServiceType,
+                 error = OTBR_ERROR_ERRNO, errno = EMSGSIZE);
+
+    if (service != NULL && !strncmp(service->mBaseName, aName, kMaxSizeOfLabel))
+    {
+        VerifyOrExit(service->mTxtLength != aTxtLength || memcmp(service->mTxt, aTxt, aTxtLength));
+
+        otbrLog(OTBR_LOG_INFO, "MDNS updating service %s...", service->mName);
+        memcpy(service->mTxt, aTxt, aTxtLength);
+        service->mTxtLength = aTxtLength;
+        Build(*service);
+
+        // A probing service announces the new records once probed.
+        if (service->mState != kServiceProbing)
+        {
+            service->mState     = kServiceAnnouncing;
+            service->mRemaining = kAnnounceCount;
+            service->mNextTime  = aNow;
+        }
+
+        ExitNow();
+    }
+
+    if (service != NULL)
+    {
+        otbrLog(OTBR_LOG_INFO, "MDNS renaming service %s to %s...", service->mName, aName);
+
+        if (service->mState != kServiceProbing)
+        {
+            SendGoodbye(*service);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < kMaxServices && service == NULL; ++i)
+        {
+            if (mServices[i].mState == kServiceFree)
+            {
+                service = &mServices[i];
+            }
+        }
+
+        VerifyOrExit(service != NULL, error = OTBR_ERROR_ERRNO, errno = ENOMEM);
+        otbrLog(OTBR_LOG_INFO, "MDNS creating service %s...", aName);
+
+        strcpy(service->mType, aType);
+        service->mPort          = aPort;
+        service->mLastMulticast = 0;
+    }
+
+    strncpy(service->mBaseName, aName, kMaxSizeOfLabel);
+    service->mBaseName[kMaxSizeOfLabel] = '\0';
+    memcpy(service->mTxt, aTxt, aTxtLength);
+    service->mTxtLength = aTxtLength;
+    service->mConflicts = 0;
+
+    if ((error = UpdateNames(*service)) != OTBR_ERROR_NONE)
+    {
+        service->mState = kServiceFree;
+        ExitNow();
+    }
+
+    Build(*service);
+    service->mState     = kServiceProbing;
+    service->mRemaining = kProbeCount;
+    service->mNextTime  = aNow;
+
+exit:
+    return error;
+}
+
+otbrError Responder::Unpublish(const char *aType, uint16_t aPort)
+{
+    otbrError error   = OTBR_ERROR_NONE;
+    Service * service = FindService(aType, aPort);
+
+    VerifyOrExit(service != NULL, error = OTBR_ERROR_ERRNO, errno = ENOENT);
+
+    otbrLog(OTBR_LOG_INFO, "MDNS removing service %s...", service->mName);
+
+    if (service->mState == kServiceAnnouncing || service->mState == kServiceEstablished)
+    {
+        SendGoodbye(*service);
+    }
+
+    service->mState = kServiceFree;
+
+exit:
+    return error;
+}
+
+void Responder::Clear(void)
+{
+    for (size_t i = 0; i < kMaxServices; ++i)
+    {
+        if (mServices[i].mState == kServiceAnnouncing || mServices[i].mState == kServiceEstablished)
+        {
+            SendGoodbye(mServices[i]);
+        }
+
+        mServices[i].mState = kServiceFree;
+    }
+}
+
+void Responder::Process(uint64_t aNow)
+{
+    Timeline::Span span("mdns.announce");
+
+    for (size_t i = 0; i < kMaxServices; ++i)
+    {
+        Service &service = mServices[i];
+
+        if ((service.mState != kServiceProbing && service.mState != kServiceAnnouncing) || service.mNextTime > aNow)
+        {
+            continue;
+        }
+
+        if (service.mState == kServiceProbing)
+        {
+            if (service.mRemaining > 0)
+            {
+                uint8_t  buffer[kMaxSizeOfResponse];
+                uint16_t length = BuildProbe(service, buffer, sizeof(buffer));
+
+                if (length > 0)
+                {
+                    mSendHandler(buffer, length, false, mContext);
+                }
+
+                service.mRemaining--;
+                service.mNextTime = aNow + kProbeInterval;
+                continue;
+            }
+
+            otbrLog(OTBR_LOG_INFO, "MDNS service %s probed.", service.mName);
+            service.mState     = kServiceAnnouncing;
+            service.mRemaining = kAnnounceCount;
+        }
+
+        if (service.mResponseLength > 0)
+        {
+            mSendHandler(service.mResponse, service.mResponseLength, false, mContext);
+        }
+
+        service.mLastMulticast = aNow;
+
+        if (--service.mRemaining == 0)
+        {
+            service.mState = kServiceEstablished;
+        }
+        else
+        {
+            service.mNextTime = aNow + kAnnounceInterval;
+        }
+    }
+}
+
+bool Responder::GetNextTime(uint64_t &aTime) const
+{
+    bool found = false;
+
+    for (size_t i = 0; i < kMaxServices; ++i)
+    {
+        const Service &service = mServices[i];
+
+        if ((service.mState == kServiceProbing || service.mState == kServiceAnnouncing) &&
+            (!found || service.mNextTime < aTime))
+        {
+            aTime = service.mNextTime;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+void Responder::HandlePacket(const uint8_t *aBuffer, uint16_t aLength, bool aLegacyUnicast, uint64_t aNow)
+{
+    uint16_t flags;
+
+    VerifyOrExit(aLength >= kHeaderSize);
+
+    flags = ReadUint16(aBuffer + 2);
+    VerifyOrExit((flags & kOpcodeMask) == 0);
+
+    if (flags & kFlagResponse)
+    {
+        // Responses from other ports are not part of MDNS.
+        VerifyOrExit(!aLegacyUnicast);
+        HandleResponse(aBuffer, aLength, aNow);
+    }
+    else
+    {
+        HandleQuery(aBuffer, aLength, aLegacyUnicast, aNow);
+    }
+
+exit:
+    return;
+}
+
+void Responder::HandleQuery(const uint8_t *aBuffer, uint16_t aLength, bool aLegacyUnicast, uint64_t aNow)
+{
+    uint16_t     id              = ReadUint16(aBuffer);
+    uint16_t     questionCount   = ReadUint16(aBuffer + 4);
+    uint16_t     answerCount     = ReadUint16(aBuffer + 6);
+    uint16_t     offset          = kHeaderSize;
+    uint16_t     questionsLength = 0;
+    unsigned int matched         = 0;
+    uint8_t      name[kMaxSizeOfName];
+    uint16_t     nameLength;
+
+    for (uint16_t i = 0; i < questionCount; ++i)
+    {
+        uint16_t type;
+
+        VerifyOrExit(ReadName(aBuffer, aLength, offset, name, nameLength) == OTBR_ERROR_NONE &&
+                         offset + 4 <= aLength,
+                     matched = 0);
+        type = ReadUint16(aBuffer + offset);
+        offset += 4;
+
+        for (size_t j = 0; j < kMaxServices; ++j)
+        {
+            const Service &service = mServices[j];
+
+            if (service.mState != kServiceAnnouncing && service.mState != kServiceEstablished)
+            {
+                continue;
+            }
+
+            if ((NameEquals(name, nameLength, service.mTypeName, service.mTypeNameLength) &&
+                 (type == kTypePtr || type == kTypeAny)) ||
+                (NameEquals(name, nameLength, service.mInstanceName, service.mInstanceNameLength) &&
+                 (type == kTypeSrv || type == kTypeTxt || type == kTypeAny)) ||
+                (NameEquals(name, nameLength, mHostName, mHostNameLength) &&
+                 (type == kTypeA || type == kTypeAaaa || type == kTypeAny)))
+            {
+                matched |= 1U << j;
+            }
+        }
+    }
+
+    questionsLength = static_cast<uint16_t>(offset - kHeaderSize);
+
+    // Known answers, a PTR record the querier already holds with at least half of its TTL suppresses the response.
+    for (uint16_t i = 0; matched && i < answerCount && !aLegacyUnicast; ++i)
+    {
+        uint16_t type;
+        uint32_t ttl;
+        uint16_t length;
+        uint16_t rdata;
+        uint8_t  target[kMaxSizeOfName];
+        uint16_t targetLength;
+
+        SuccessOrExit(ReadName(aBuffer, aLength, offset, name, nameLength));
+        VerifyOrExit(offset + 10 <= aLength);
+        type   = ReadUint16(aBuffer + offset);
+        ttl    = ReadUint32(aBuffer + offset + 4);
+        length = ReadUint16(aBuffer + offset + 8);
+        offset += 10;
+        VerifyOrExit(offset + length <= aLength);
+        rdata = offset;
+        offset += length;
+
+        if (type != kTypePtr || ttl < kTtlOther / 2 || ReadName(aBuffer, aLength, rdata, target, targetLength))
+        {
+            continue;
+        }
+
+        for (size_t j = 0; j < kMaxServices; ++j)
+        {
+            const Service &service = mServices[j];
+
+            if ((matched & (1U << j)) &&
+                NameEquals(name, nameLength, service.mTypeName, service.mTypeNameLength) &&
+                NameEquals(target, targetLength, service.mInstanceName, service.mInstanceNameLength))
+            {
+                matched &= ~(1U << j);
+            }
+        }
+    }
+
+exit:
+    for (size_t j = 0; j < kMaxServices; ++j)
+    {
+        Service &service = mServices[j];
+
+        if (!(matched & (1U << j)))
+        {
+            continue;
+        }
+
+        if (aLegacyUnicast)
+        {
+            uint8_t  buffer[kMaxSizeOfResponse * 2];
+            uint16_t length = 0;
+
+            // Legacy resolvers need the query ID and questions repeated.
+            length = BuildResponse(service, kResponseLegacy, id, aBuffer + kHeaderSize, questionsLength,
+                                   questionCount, buffer, sizeof(buffer));
+
+            if (length > 0)
+            {
+                mSendHandler(buffer, length, true, mContext);
+            }
+        }
+        else if (service.mResponseLength > 0 && aNow >= service.mLastMulticast + kMinMulticastInterval)
+        {
+            mSendHandler(service.mResponse, service.mResponseLength, false, mContext);
+            service.mLastMulticast = aNow;
+        }
+    }
+}
+
+void Responder::HandleResponse(const uint8_t *aBuffer, uint16_t aLength, uint64_t aNow)
+{
+    unsigned int count  = 0;
+    uint16_t     offset = kHeaderSize;
+    uint8_t      name[kMaxSizeOfName];
+    uint16_t     nameLength;
+
+    for (uint16_t i = 0; i < ReadUint16(aBuffer + 4); ++i)
+    {
+        SuccessOrExit(ReadName(aBuffer, aLength, offset, name, nameLength));
+        VerifyOrExit(offset + 4 <= aLength);
+        offset += 4;
+    }
+
+    // Answers, authorities and additionals are all checked.
+    count = static_cast<unsigned int>(ReadUint16(aBuffer + 6)) + ReadUint16(aBuffer + 8) + ReadUint16(aBuffer + 10);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        uint16_t type;
+        uint32_t ttl;
+        uint16_t length;
+        uint16_t rdata;
+
+        SuccessOrExit(ReadName(aBuffer, aLength, offset, name, nameLength));
+        VerifyOrExit(offset + 10 <= aLength);
+        type   = ReadUint16(aBuffer + offset);
+        ttl    = ReadUint32(aBuffer + offset + 4);
+        length = ReadUint16(aBuffer + offset + 8);
+        offset += 10;
+        VerifyOrExit(offset + length <= aLength);
+        rdata = offset;
+        offset += length;
+
+        if ((type != kTypeSrv && type != kTypeTxt) || ttl == 0)
+        {
+            continue;
+        }
+
+        for (size_t j = 0; j < kMaxServices; ++j)
+        {
+            Service &service  = mServices[j];
+            bool     conflict = false;
+
+            if (service.mState == kServiceFree ||
+                !NameEquals(name, nameLength, service.mInstanceName, service.mInstanceNameLength))
+            {
+                continue;
+            }
+
+            if (type == kTypeTxt)
+            {
+                conflict = (length != service.mTxtLength || memcmp(aBuffer + rdata, service.mTxt, length));
+            }
+            else
+            {
+                uint8_t  target[kMaxSizeOfName];
+                uint16_t targetLength;
+                uint16_t targetOffset = static_cast<uint16_t>(rdata + 6);
+
+                // Our own records, also looped back by multicast, are identical.
+                conflict = (length < 6 || ReadUint16(aBuffer + rdata + 4) != service.mPort ||
+                            ReadName(aBuffer, aLength, targetOffset, target, targetLength) != OTBR_ERROR_NONE ||
+                            !NameEquals(target, targetLength, mHostName, mHostNameLength));
+            }
+
+            if (conflict)
+            {
+                HandleConflict(service, aNow);
+            }
+        }
+    }
+
+exit:
+    return;
+}
+
+void Responder::HandleConflict(Service &aService, uint64_t aNow)
+{
+    otbrLog(OTBR_LOG_WARNING, "MDNS service %s conflicts with another host!", aService.mName);
+
+    if (mConflictHandler != NULL)
+    {
+        char baseName[kMaxSizeOfLabel + 1];
+
+        strcpy(baseName, aService.mBaseName);
+        mConflictHandler(aService.mType, aService.mPort, mContext);
+
+        // Published again with another name, which is probed instead, or withdrawn.
+        VerifyOrExit(aService.mState != kServiceFree && !strcmp(aService.mBaseName, baseName));
+    }
+
+    if (aService.mConflicts < UINT8_MAX - 1)
+    {
+        aService.mConflicts++;
+    }
+
+    if (UpdateNames(aService) != OTBR_ERROR_NONE)
+    {
+        aService.mState = kServiceFree;
+        ExitNow();
+    }
+
+    Build(aService);
+    aService.mState     = kServiceProbing;
+    aService.mRemaining = kProbeCount;
+    aService.mNextTime  = aNow + (aService.mConflicts > kMaxConflicts ? kConflictDelay : 0);
+
+exit:
+    return;
+}
+
+PublisherNative::PublisherNative(int          aProtocol,
+                                 const char * aHost,
+                                 const char * aDomain,
+                                 StateHandler aHandler,
+                                 void *       aContext,
+                                 Reactor *    aReactor,
+                                 TimerWheel * aTimerWheel)
+    : mResponder(HandleSend, this)
+    , mProtocol(aProtocol)
+    , mInterfaceCount(0)
+    , mSourceLength(0)
+    , mSourceFd(-1)
+    , mReactor(aReactor)
+    , mTimerWheel(aTimerWheel != NULL ? aTimerWheel : &mLocalTimerWheel)
+    , mTimer(HandleTimer, this)
+    , mDomain(aDomain != NULL ? strdup(aDomain) : NULL)
+    , mState(kStateIdle)
+    , mStateHandler(aHandler)
+    , mContext(aContext)
+{
+    for (size_t i = 0; i < kSockets; ++i)
+    {
+        mSockets[i] = -1;
+    }
+
+    mResponder.SetConflictHandler(HandleConflict);
+
+    mHost[0] = '\0';
+
+    if (aHost != NULL)
+    {
+        strncpy(mHost, aHost, sizeof(mHost) - 1);
+    }
+    else if (gethostname(mHost, sizeof(mHost) - 1) == 0)
+    {
+        // Only the first label of the system host name.
+        mHost[strcspn(mHost, ".")] = '\0';
+    }
+
+    mHost[sizeof(mHost) - 1] = '\0';
+}
+
+PublisherNative::~PublisherNative(void)
+{
+    Stop();
+    free(mDomain);
+}
+
+otbrError PublisherNative::Start(void)
+{
+    otbrError ret    = OTBR_ERROR_NONE;
+    bool      opened = false;
+
+    VerifyOrExit(!IsStarted());
+    VerifyOrExit(mHost[0] != '\0' && mResponder.SetHostName(mHost, mDomain) == OTBR_ERROR_NONE,
+                 ret = OTBR_ERROR_MDNS);
+
+    UpdateAddresses();
+
+    if (mProtocol != AF_INET)
+    {
+        opened = (OpenSocket(kSocketIp6) == OTBR_ERROR_NONE);
+    }
+
+    if (mProtocol != AF_INET6)
+    {
+        opened = (OpenSocket(kSocketIp4) == OTBR_ERROR_NONE) || opened;
+    }
+
+    VerifyOrExit(opened, ret = OTBR_ERROR_MDNS);
+
+    otbrLog(OTBR_LOG_INFO, "MDNS responder started as %s.", mHost);
+    mState = kStateReady;
+    mStateHandler(mContext, mState);
+
+exit:
+    if (ret != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to start MDNS responder!");
+        Stop();
+    }
+
+    return ret;
+}
+
+bool PublisherNative::IsStarted(void) const
+{
+    return mSockets[kSocketIp6] >= 0 || mSockets[kSocketIp4] >= 0;
+}
+
+void PublisherNative::Stop(void)
+{
+    bool started = IsStarted();
+
+    mResponder.Clear();
+    mTimerWheel->Stop(mTimer);
+
+    for (size_t i = 0; i < kSockets; ++i)
+    {
+        if (mSockets[i] < 0)
+        {
+            continue;
+        }
+
+        if (mReactor != NULL)
+        {
+            mReactor->Remove(mWatches[i]);
+        }
+
+        close(mSockets[i]);
+        mSockets[i] = -1;
+    }
+
+    if (started)
+    {
+        mState = kStateIdle;
+        mStateHandler(mContext, mState);
+    }
+}
+
+otbrError PublisherNative::OpenSocket(unsigned int aIndex)
+{
+    otbrError ret  = OTBR_ERROR_ERRNO;
+    bool      ip6  = (aIndex == kSocketIp6);
+    int       fd   = socket(ip6 ? AF_INET6 : AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+    int       one  = 1;
+    int       hops = 255;
+
+    VerifyOrExit(fd >= 0);
+    VerifyOrExit(setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0);
+#ifdef SO_REUSEPORT
+    // Shared with other responders on this host, such as avahi-daemon.
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+#endif
+
+    if (ip6)
+    {
+        sockaddr_in6 addr;
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sin6_family = AF_INET6;
+        addr.sin6_port   = htons(kMdnsPort);
+        addr.sin6_addr   = in6addr_any;
+
+        VerifyOrExit(setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &one, sizeof(one)) == 0);
+        VerifyOrExit(setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &hops, sizeof(hops)) == 0);
+        VerifyOrExit(setsockopt(fd, IPPROTO_IPV6, IPV6_UNICAST_HOPS, &hops, sizeof(hops)) == 0);
+        VerifyOrExit(bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+
+        for (uint8_t i = 0; i < mInterfaceCount; ++i)
+        {
+            ipv6_mreq mreq;
+
+            memset(&mreq, 0, sizeof(mreq));
+            inet_pton(AF_INET6, "ff02::fb", &mreq.ipv6mr_multiaddr);
+            mreq.ipv6mr_interface = mInterfaces[i];
+
+            if (setsockopt(fd, IPPROTO_IPV6, IPV6_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0)
+            {
+                otbrLog(OTBR_LOG_WARNING, "Failed to join MDNS group on interface %u: %s", mInterfaces[i],
+                        strerror(errno));
+            }
+        }
+    }
+    else
+    {
+        sockaddr_in   addr;
+        unsigned char ttl = 255;
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons(kMdnsPort);
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+        VerifyOrExit(setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) == 0);
+        VerifyOrExit(setsockopt(fd, IPPROTO_IP, IP_TTL, &hops, sizeof(hops)) == 0);
+        VerifyOrExit(bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+
+        for (uint8_t i = 0; i < mInterfaceCount; ++i)
+        {
+            ip_mreqn mreq;
+
+            memset(&mreq, 0, sizeof(mreq));
+            inet_pton(AF_INET, "224.0.0.251", &mreq.imr_multiaddr);
+            mreq.imr_ifindex = static_cast<int>(mInterfaces[i]);
+
+            if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0)
+            {
+                otbrLog(OTBR_LOG_WARNING, "Failed to join MDNS group on interface %u: %s", mInterfaces[i],
+                        strerror(errno));
+            }
+        }
+    }
+
+    if (mReactor != NULL)
+    {
+        SuccessOrExit(mReactor->Add(mWatches[aIndex], fd, Reactor::kEventReadable, HandleReadable, this, "mdns"));
+    }
+
+    mSockets[aIndex] = fd;
+    ret              = OTBR_ERROR_NONE;
+
+exit:
+    if (ret != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to open MDNS %s socket: %s", ip6 ? "IPv6" : "IPv4", strerror(errno));
+
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+
+    return ret;
+}
+
+void PublisherNative::UpdateAddresses(void)
+{
+    uint8_t  addresses[Responder::kMaxAddresses][16];
+    uint8_t  count = 0;
+    ifaddrs *list  = NULL;
+
+    VerifyOrExit(getifaddrs(&list) == 0, otbrLog(OTBR_LOG_ERR, "Failed to get addresses: %s", strerror(errno)));
+
+    mInterfaceCount = 0;
+
+    for (const ifaddrs *ifa = list; ifa != NULL; ifa = ifa->ifa_next)
+    {
+        unsigned int index;
+        bool         found = false;
+
+        if (ifa->ifa_addr == NULL || !(ifa->ifa_flags & IFF_UP) || (ifa->ifa_flags & IFF_LOOPBACK) ||
+            !(ifa->ifa_flags & IFF_MULTICAST))
+        {
+            continue;
+        }
+
+        if (ifa->ifa_addr->sa_family == AF_INET6 && mProtocol != AF_INET && count < Responder::kMaxAddresses)
+        {
+            memcpy(addresses[count++], &reinterpret_cast<const sockaddr_in6 *>(ifa->ifa_addr)->sin6_addr, 16);
+        }
+        else if (ifa->ifa_addr->sa_family == AF_INET && mProtocol != AF_INET6 && count < Responder::kMaxAddresses)
+        {
+            memcpy(addresses[count], kIp4MappedPrefix, sizeof(kIp4MappedPrefix));
+            memcpy(addresses[count++] + sizeof(kIp4MappedPrefix),
+                   &reinterpret_cast<const sockaddr_in *>(ifa->ifa_addr)->sin_addr, 4);
+        }
+        else
+        {
+            continue;
+        }
+
+        index = if_nametoindex(ifa->ifa_name);
+
+        for (uint8_t i = 0; i < mInterfaceCount && !found; ++i)
+        {
+            found = (mInterfaces[i] == index);
+        }
+
+        if (!found && index != 0 && mInterfaceCount < kMaxInterfaces)
+        {
+            mInterfaces[mInterfaceCount++] = index;
+        }
+    }
+
+    freeifaddrs(list);
+    mResponder.SetAddresses(addresses, count);
+
+exit:
+    return;
+}
+
+void PublisherNative::Receive(int aFd)
+{
+    while (true)
+    {
+        ssize_t  rval;
+        uint16_t port;
+
+        mSourceLength = sizeof(mSource);
+        rval = recvfrom(aFd, mBuffer, sizeof(mBuffer), 0, reinterpret_cast<sockaddr *>(&mSource), &mSourceLength);
+
+        if (rval < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                otbrLog(OTBR_LOG_WARNING, "Failed to receive MDNS packet: %s", strerror(errno));
+            }
+
+            break;
+        }
+
+        port = (mSource.ss_family == AF_INET6) ? reinterpret_cast<const sockaddr_in6 &>(mSource).sin6_port
+                                                : reinterpret_cast<const sockaddr_in &>(mSource).sin_port;
+        mSourceFd = aFd;
+        mResponder.HandlePacket(mBuffer, static_cast<uint16_t>(rval), ntohs(port) != kMdnsPort, GetMonotonicNow());
+    }
+
+    mSourceFd = -1;
+    ScheduleTimer();
+}
+
+void PublisherNative::HandleSend(const uint8_t *aBuffer, uint16_t aLength, bool aUnicast)
+{
+    if (aUnicast)
+    {
+        VerifyOrExit(mSourceFd >= 0);
+
+        if (sendto(mSourceFd, aBuffer, aLength, 0, reinterpret_cast<const sockaddr *>(&mSource), mSourceLength) < 0)
+        {
+            otbrLog(OTBR_LOG_WARNING, "Failed to send MDNS response: %s", strerror(errno));
+        }
+
+        ExitNow();
+    }
+
+    for (unsigned int i = 0; i < kSockets; ++i)
+    {
+        sockaddr_storage group;
+        socklen_t        length;
+
+        if (mSockets[i] < 0)
+        {
+            continue;
+        }
+
+        memset(&group, 0, sizeof(group));
+
+        if (i == kSocketIp6)
+        {
+            sockaddr_in6 &addr = reinterpret_cast<sockaddr_in6 &>(group);
+
+            addr.sin6_family = AF_INET6;
+            addr.sin6_port   = htons(kMdnsPort);
+            inet_pton(AF_INET6, "ff02::fb", &addr.sin6_addr);
+            length = sizeof(addr);
+        }
+        else
+        {
+            sockaddr_in &addr = reinterpret_cast<sockaddr_in &>(group);
+
+            addr.sin_family = AF_INET;
+            addr.sin_port   = htons(kMdnsPort);
+            inet_pton(AF_INET, "224.0.0.251", &addr.sin_addr);
+            length = sizeof(addr);
+        }
+
+        // MDNS is link local, so the packet is sent on each interface joined.
+        for (uint8_t j = 0; j == 0 || j < mInterfaceCount; ++j)
+        {
+            if (mInterfaceCount > 0)
+            {
+                int rval;
+
+                if (i == kSocketIp6)
+                {
+                    int index = static_cast<int>(mInterfaces[j]);
+
+                    rval = setsockopt(mSockets[i], IPPROTO_IPV6, IPV6_MULTICAST_IF, &index, sizeof(index));
+                }
+                else
+                {
+                    ip_mreqn mreq;
+
+                    memset(&mreq, 0, sizeof(mreq));
+                    mreq.imr_ifindex = static_cast<int>(mInterfaces[j]);
+                    rval             = setsockopt(mSockets[i], IPPROTO_IP, IP_MULTICAST_IF, &mreq, sizeof(mreq));
+                }
+
+                if (rval != 0)
+                {
+                    continue;
+                }
+            }
+
+            if (sendto(mSockets[i], aBuffer, aLength, 0, reinterpret_cast<const sockaddr *>(&group), length) < 0)
+            {
+                otbrLog(OTBR_LOG_DEBUG, "Failed to send MDNS packet: %s", strerror(errno));
+            }
+        }
+    }
+
+exit:
+    return;
+}
+
+void PublisherNative::ScheduleTimer(void)
+{
+    uint64_t time = 0;
+
+    if (mResponder.GetNextTime(time))
+    {
+        mTimerWheel->StartAt(mTimer, time);
+    }
+    else
+    {
+        mTimerWheel->Stop(mTimer);
+    }
+}
+
+void PublisherNative::HandleTimer(void *aContext)
+{
+    PublisherNative *publisher = static_cast<PublisherNative *>(aContext);
+
+    publisher->mResponder.Process(GetMonotonicNow());
+    publisher->ScheduleTimer();
+}
+
+otbrError PublisherNative::PublishService(unsigned int     aInterfaceIndex,
+                                          uint16_t         aPort,
+                                          const char *     aName,
+                                          const char *     aType,
+                                          const TxtRecord &aTxt)
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+
+    VerifyOrExit(mState == kStateReady, errno = EAGAIN);
+    VerifyOrExit(aInterfaceIndex == 0 || IsInterfaceJoined(aInterfaceIndex), errno = ENODEV);
+    OTBR_PROBE3(mdns_publish, aName, aType, aPort);
+
+    // Addresses may have changed since the responder started.
+    UpdateAddresses();
+    SuccessOrExit(ret = mResponder.Publish(aName, aType, aPort, aTxt.GetData(), aTxt.GetLength(), GetMonotonicNow()));
+    ScheduleTimer();
+
+exit:
+    if (ret != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to publish service: %s!", strerror(errno));
+    }
+
+    return ret;
+}
+
+otbrError PublisherNative::UnpublishService(unsigned int aInterfaceIndex, uint16_t aPort, const char *aType)
+{
+    (void)aInterfaceIndex;
+
+    return mResponder.Unpublish(aType, aPort);
+}
+
+bool PublisherNative::IsInterfaceJoined(unsigned int aInterfaceIndex) const
+{
+    bool joined = false;
+
+    for (uint8_t i = 0; i < mInterfaceCount && !joined; ++i)
+    {
+        joined = (mInterfaces[i] == aInterfaceIndex);
+    }
+
+    return joined;
+}
+
+void PublisherNative::UpdateFdSet(fd_set & aReadFdSet,
+                                  fd_set & aWriteFdSet,
+                                  fd_set & aErrorFdSet,
+                                  int &    aMaxFd,
+                                  timeval &aTimeout)
+{
+    (void)aWriteFdSet;
+    (void)aErrorFdSet;
+
+    if (mTimerWheel == &mLocalTimerWheel)
+    {
+        mLocalTimerWheel.UpdateTimeout(aTimeout);
+    }
+
+    // Sockets are registered with the reactor directly.
+    VerifyOrExit(mReactor == NULL);
+
+    for (size_t i = 0; i < kSockets; ++i)
+    {
+        if (mSockets[i] >= 0)
+        {
+            FD_SET(mSockets[i], &aReadFdSet);
+
+            if (aMaxFd < mSockets[i])
+            {
+                aMaxFd = mSockets[i];
+            }
+        }
+    }
+
+exit:
+    return;
+}
+
+void PublisherNative::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
+{
+    (void)aWriteFdSet;
+    (void)aErrorFdSet;
+
+    for (size_t i = 0; mReactor == NULL && i < kSockets; ++i)
+    {
+        if (mSockets[i] >= 0 && FD_ISSET(mSockets[i], &aReadFdSet))
+        {
+            Receive(mSockets[i]);
+        }
+    }
+
+    if (mTimerWheel == &mLocalTimerWheel)
+    {
+        mLocalTimerWheel.Process();
+    }
+}
+
+#if OTBR_ENABLE_NATIVE_MDNS
+Publisher *Publisher::Create(int          aFamily,
+                             const char * aHost,
+                             const char * aDomain,
+                             StateHandler aHandler,
+                             void *       aContext,
+                             Reactor *    aReactor,
+                             TimerWheel * aTimerWheel)
+{
+    return new PublisherNative(aFamily, aHost, aDomain, aHandler, aContext, aReactor, aTimerWheel);
+}
+
+void Publisher::Destroy(Publisher *aPublisher)
+{
+    delete static_cast<PublisherNative *>(aPublisher);
+}
+#endif // OTBR_ENABLE_NATIVE_MDNS
+
+} // namespace Mdns
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,497 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the built-in MDNS responder.
+ */
+
+#ifndef MDNS_NATIVE_HPP_
+#define MDNS_NATIVE_HPP_
+
+#include <stdint.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#include "mdns.hpp"
+#include "common/reactor.hpp"
+#include "common/timer.hpp"
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Mdns {
+
+/**
+ * @addtogroup border-router-mdns
+ *
+ * @brief
+ *   This module includes definition for the built-in MDNS responder.
+ *
+ * @{
+ */
+
+/**
+ * This class implements the records and the protocol logic of a MDNS responder, without any I/O.
+ *
+ * The responder probes and announces its services, answers queries from cached pre-encoded responses, honours
+ * known answers in queries and renames services that conflict with records of other hosts.
+ *
+ */
+class Responder
+{
+public:
+    enum
+    {
+        kMaxServices          = 4,    ///< Max number of services published by a responder.
+        kMaxAddresses         = 8,    ///< Max number of host addresses.
+        kMaxSizeOfName        = 256,  ///< Max size of an encoded domain name.
+        kMaxSizeOfLabel       = 63,   ///< Max size of a label.
+        kMaxSizeOfTxtRecord   = 256,  ///< Max size of a text record.
+        kMaxSizeOfServiceType = 64,   ///< Max size of a service type.
+        kMaxSizeOfResponse    = 1024, ///< Max size of a response.
+        kMaxSizeOfPacket      = 9000, ///< Max size of a MDNS packet.
+    };
+
+    enum
+    {
+        kProbeInterval        = 250,  ///< Time in milliseconds between probes.
+        kAnnounceInterval     = 1000, ///< Time in milliseconds between announcements.
+        kMinMulticastInterval = 1000, ///< Min time in milliseconds between multicast responses of a service.
+        kProbeCount           = 3,    ///< Number of probes before a service is announced.
+        kAnnounceCount        = 2,    ///< Number of announcements of a service.
+        kTtlHost              = 120,  ///< TTL in seconds of records related to the host name.
+        kTtlOther             = 4500, ///< TTL in seconds of other records.
+        kTtlLegacyUnicast     = 10,   ///< TTL in seconds of records in responses to legacy unicast queries.
+    };
+
+    /**
+     * This function pointer is called to send a packet.
+     *
+     * @param[in]   aBuffer         A pointer to the packet.
+     * @param[in]   aLength         Number of bytes of @p aBuffer.
+     * @param[in]   aUnicast        Whether to send to the source of the query being handled, instead of the MDNS
+     *                              multicast group.
+     * @param[in]   aContext        A pointer to application-specific context.
+     *
+     */
+    typedef void (*SendHandler)(const uint8_t *aBuffer, uint16_t aLength, bool aUnicast, void *aContext);
+
+    /**
+     * This function pointer is called when the name of a service conflicts with the one of another host.
+     *
+     * The handler may publish the service again with another name, otherwise a number is appended to the name.
+     *
+     * @param[in]   aType           The type of the service.
+     * @param[in]   aPort           The port number of the service.
+     * @param[in]   aContext        A pointer to application-specific context.
+     *
+     */
+    typedef void (*ConflictHandler)(const char *aType, uint16_t aPort, void *aContext);
+
+    /**
+     * The constructor to initialize a responder.
+     *
+     * @param[in]   aSendHandler    A pointer to the function to be called to send packets.
+     * @param[in]   aContext        A pointer to application-specific context.
+     *
+     */
+    Responder(SendHandler aSendHandler, void *aContext);
+
+    /**
+     * This method sets the function to be called on name conflicts, with the context of the responder.
+     *
+     * @param[in]   aConflictHandler    A pointer to the function, NULL to append numbers to the names.
+     *
+     */
+    void SetConflictHandler(ConflictHandler aConflictHandler) { mConflictHandler = aConflictHandler; }
+
+    /**
+     * This method sets the host name of the responder.
+     *
+     * @param[in]   aHost           The host name, a single label.
+     * @param[in]   aDomain         The domain, NULL to use "local".
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully set the host name.
+     * @retval  OTBR_ERROR_ERRNO    Failed for the names are too long, errno is set to EMSGSIZE.
+     *
+     */
+    otbrError SetHostName(const char *aHost, const char *aDomain);
+
+    /**
+     * This method sets the addresses of the host.
+     *
+     * Cached responses are rebuilt if the addresses changed.
+     *
+     * @param[in]   aAddresses      A pointer to the addresses, each IPv4 address is mapped to IPv6.
+     * @param[in]   aCount          Number of addresses, at most kMaxAddresses are used.
+     *
+     */
+    void SetAddresses(const uint8_t (*aAddresses)[16], uint8_t aCount);
+
+    /**
+     * This method publishes or updates a service.
+     *
+     * A service already published with the same type and port is updated in place. A new text record is announced
+     * at once, and a new name sends goodbyes for the old records and probes the new name.
+     *
+     * @param[in]   aName           The name of this service.
+     * @param[in]   aType           The type of this service.
+     * @param[in]   aPort           The port number of this service.
+     * @param[in]   aTxt            A pointer to the encoded text record.
+     * @param[in]   aTxtLength      Number of bytes of @p aTxt.
+     * @param[in]   aNow            The current monotonic time in milliseconds.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully published or updated the service.
+     * @retval  OTBR_ERROR_ERRNO    Failed for names are too long, or too many services, errno is set.
+     *
+     */
+    otbrError Publish(const char *   aName,
+                      const char *   aType,
+                      uint16_t       aPort,
+                      const uint8_t *aTxt,
+                      uint16_t       aTxtLength,
+                      uint64_t       aNow);
+
+    /**
+     * This method sends goodbyes for a service if announced and removes it.
+     *
+     * @param[in]   aType           The type of the service.
+     * @param[in]   aPort           The port number of the service.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully removed the service.
+     * @retval  OTBR_ERROR_ERRNO    No such service, errno is set to ENOENT.
+     *
+     */
+    otbrError Unpublish(const char *aType, uint16_t aPort);
+
+    /**
+     * This method sends goodbyes for all announced services and removes all services.
+     *
+     */
+    void Clear(void);
+
+    /**
+     * This method handles a received MDNS packet.
+     *
+     * @param[in]   aBuffer         A pointer to the packet.
+     * @param[in]   aLength         Number of bytes of @p aBuffer.
+     * @param[in]   aLegacyUnicast  Whether the packet is from a legacy resolver, i.e. not from the MDNS port.
+     * @param[in]   aNow            The current monotonic time in milliseconds.
+     *
+     */
+    void HandlePacket(const uint8_t *aBuffer, uint16_t aLength, bool aLegacyUnicast, uint64_t aNow);
+
+    /**
+     * This method sends the probes and announcements due by now.
+     *
+     * @param[in]   aNow            The current monotonic time in milliseconds.
+     *
+     */
+    void Process(uint64_t aNow);
+
+    /**
+     * This method returns the next time Process() needs to be called.
+     *
+     * @param[out]  aTime           The monotonic time in milliseconds.
+     *
+     * @retval  true    @p aTime is set.
+     * @retval  false   No probe or announcement is pending.
+     *
+     */
+    bool GetNextTime(uint64_t &aTime) const;
+
+    /**
+     * This method returns the instance name of a service, which differs from the published name after conflicts.
+     *
+     * @param[in]   aType           The type of the service.
+     * @param[in]   aPort           The port number of the service.
+     *
+     * @returns The instance name, NULL if no such service.
+     *
+     */
+    const char *GetServiceName(const char *aType, uint16_t aPort) const;
+
+    /**
+     * This method indicates whether a service is probed and announced.
+     *
+     * @param[in]   aType           The type of the service.
+     * @param[in]   aPort           The port number of the service.
+     *
+     * @retval  true    The service has been announced and answers queries.
+     * @retval  false   No such service, or it is still being probed.
+     *
+     */
+    bool IsServiceEstablished(const char *aType, uint16_t aPort) const;
+
+private:
+    enum ServiceState
+    {
+        kServiceFree,        ///< The service entry is unused.
+        kServiceProbing,     ///< The service name is being probed.
+        kServiceAnnouncing,  ///< The service is being announced.
+        kServiceEstablished, ///< The service answers queries.
+    };
+
+    struct Service
+    {
+        char         mBaseName[kMaxSizeOfLabel + 1]; ///< The published name.
+        char         mName[kMaxSizeOfLabel + 1];     ///< The instance name, renamed on conflicts.
+        char         mType[kMaxSizeOfServiceType];   ///< The service type.
+        uint16_t     mPort;                          ///< The port number.
+        uint8_t      mTxt[kMaxSizeOfTxtRecord];      ///< The encoded text record.
+        uint16_t     mTxtLength;                     ///< Length of the text record.
+        uint8_t      mInstanceName[kMaxSizeOfName];  ///< The encoded instance name.
+        uint16_t     mInstanceNameLength;            ///< Length of the encoded instance name.
+        uint8_t      mTypeName[kMaxSizeOfName];      ///< The encoded service type name.
+        uint16_t     mTypeNameLength;                ///< Length of the encoded service type name.
+        uint8_t      mResponse[kMaxSizeOfResponse];  ///< The cached response carrying all records.
+        uint16_t     mResponseLength;                ///< Length of the cached response.
+        ServiceState mState;                         ///< The state of this service.
+        uint8_t      mRemaining;                     ///< Number of probes or announcements to send.
+        uint8_t      mConflicts;                     ///< Number of name conflicts.
+        uint64_t     mNextTime;                      ///< When the next probe or announcement is due.
+        uint64_t     mLastMulticast;                 ///< When the last multicast response was sent.
+    };
+
+    Service *FindService(const char *aType, uint16_t aPort);
+    otbrError UpdateNames(Service &aService);
+    void      Build(Service &aService);
+    uint16_t  BuildResponse(const Service &aService,
+                            int            aType,
+                            uint16_t       aId,
+                            const uint8_t *aQuestions,
+                            uint16_t       aQuestionsLength,
+                            uint16_t       aQuestionCount,
+                            uint8_t *      aBuffer,
+                            uint16_t       aSize) const;
+    uint16_t  BuildProbe(const Service &aService, uint8_t *aBuffer, uint16_t aSize) const;
+    void      HandleQuery(const uint8_t *aBuffer, uint16_t aLength, bool aLegacyUnicast, uint64_t aNow);
+    void      HandleResponse(const uint8_t *aBuffer, uint16_t aLength, uint64_t aNow);
+    void      HandleConflict(Service &aService, uint64_t aNow);
+    void      SendGoodbye(const Service &aService);
+
+    SendHandler     mSendHandler;
+    ConflictHandler mConflictHandler;
+    void *          mContext;
+    uint8_t         mHostName[kMaxSizeOfName];
+    uint16_t        mHostNameLength;
+    uint8_t         mDomainName[kMaxSizeOfName];
+    uint16_t    mDomainNameLength;
+    uint8_t     mAddresses[kMaxAddresses][16];
+    uint8_t     mAddressCount;
+    Service     mServices[kMaxServices];
+};
+
+/**
+ * This class implements MDNS service with the built-in responder, on multicast sockets of its own.
+ *
+ */
+class PublisherNative : public Publisher
+{
+public:
+    /**
+     * The constructor to initialize a Publisher.
+     *
+     * @param[in]   aProtocol           The protocol used for publishing. IPv4, IPv6 or both.
+     * @param[in]   aHost               The name of host residing the services to be published.
+     *                                  NULL to use the system host name.
+     * @param[in]   aDomain             The domain of the host. NULL to use "local".
+     * @param[in]   aHandler            The function to be called when state changes.
+     * @param[in]   aContext            A pointer to application-specific context.
+     * @param[in]   aReactor            A pointer to the reactor, NULL to use the fd_set interface.
+     * @param[in]   aTimerWheel         A pointer to the timer wheel, NULL to use the fd_set interface.
+     *
+     */
+    PublisherNative(int          aProtocol,
+                    const char * aHost,
+                    const char * aDomain,
+                    StateHandler aHandler,
+                    void *       aContext,
+                    Reactor *    aReactor,
+                    TimerWheel * aTimerWheel);
+
+    ~PublisherNative(void);
+
+    /**
+     * This method publishes or updates a service.
+     *
+     * A service already published with the same type and port is updated in place. A new text record is announced
+     * at once, and a new name sends goodbyes for the old records and probes the new name. Services are answered on
+     * all interfaces joined, so a service published on one interface is answered on the others too.
+     *
+     * @param[in]   aInterfaceIndex     The index of the network interface to publish on, 0 for all interfaces.
+     * @param[in]   aPort               The port number of this service.
+     * @param[in]   aName               The name of this service.
+     * @param[in]   aType               The type of this service.
+     * @param[in]   aTxt                A reference to the text record of this service.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully published or updated the service.
+     * @retval  OTBR_ERROR_ERRNO    Failed to publish or update the service, errno is set to ENODEV if the
+     *                              interface has not joined the MDNS group.
+     *
+     */
+    otbrError PublishService(unsigned int     aInterfaceIndex,
+                             uint16_t         aPort,
+                             const char *     aName,
+                             const char *     aType,
+                             const TxtRecord &aTxt);
+
+    /**
+     * This method withdraws a service, sending goodbyes for its records.
+     *
+     * @param[in]   aInterfaceIndex     The index of the network interface the service is published on.
+     * @param[in]   aPort               The port number of this service.
+     * @param[in]   aType               The type of this service.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully withdrawn the service.
+     * @retval  OTBR_ERROR_ERRNO    No such service, errno is set to ENOENT.
+     *
+     */
+    otbrError UnpublishService(unsigned int aInterfaceIndex, uint16_t aPort, const char *aType);
+
+    /**
+     * This method starts the MDNS service.
+     *
+     * @retval OTBR_ERROR_NONE  Successfully started MDNS service;
+     * @retval OTBR_ERROR_MDNS  Failed to start MDNS service.
+     *
+     */
+    otbrError Start(void);
+
+    /**
+     * This method checks if publisher has been started.
+     *
+     * @retval true     Already started.
+     * @retval false    Not started.
+     *
+     */
+    bool IsStarted(void) const;
+
+    /**
+     * This method stops the MDNS service.
+     *
+     */
+    void Stop(void);
+
+    /**
+     * This method performs the MDNS processing.
+     *
+     * @param[in]   aReadFdSet          A reference to read file descriptors.
+     * @param[in]   aWriteFdSet         A reference to write file descriptors.
+     * @param[in]   aErrorFdSet         A reference to error file descriptors.
+     *
+     */
+    void Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet);
+
+    /**
+     * This method updates the fd_set and timeout for mainloop.
+     *
+     * @param[inout]    aReadFdSet      A reference to fd_set for polling read.
+     * @param[inout]    aWriteFdSet     A reference to fd_set for polling write.
+     * @param[inout]    aErrorFdSet     A reference to fd_set for polling error.
+     * @param[inout]    aMaxFd          A reference to the max file descriptor.
+     * @param[inout]    aTimeout        A reference to the timeout.
+     *
+     */
+    void UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd, timeval &aTimeout);
+
+private:
+    enum
+    {
+        kMdnsPort      = 5353, ///< The MDNS UDP port.
+        kMaxInterfaces = 8,    ///< Max number of interfaces joined to the MDNS group.
+        kMaxSizeOfHost = 64,   ///< Max size of the host name.
+    };
+
+    enum
+    {
+        kSocketIp6 = 0, ///< Index of the IPv6 socket.
+        kSocketIp4 = 1, ///< Index of the IPv4 socket.
+        kSockets   = 2, ///< Number of sockets.
+    };
+
+    otbrError OpenSocket(unsigned int aIndex);
+    void      UpdateAddresses(void);
+    bool      IsInterfaceJoined(unsigned int aInterfaceIndex) const;
+    void      Receive(int aFd);
+    void      ScheduleTimer(void);
+
+    static void HandleSend(const uint8_t *aBuffer, uint16_t aLength, bool aUnicast, void *aContext)
+    {
+        static_cast<PublisherNative *>(aContext)->HandleSend(aBuffer, aLength, aUnicast);
+    }
+    void HandleSend(const uint8_t *aBuffer, uint16_t aLength, bool aUnicast);
+
+    static void HandleConflict(const char *aType, uint16_t aPort, void *aContext)
+    {
+        static_cast<PublisherNative *>(aContext)->ReportConflict(aPort, aType);
+    }
+
+    static void HandleReadable(void *aContext, int aFd, unsigned int aEvents)
+    {
+        (void)aEvents;
+        static_cast<PublisherNative *>(aContext)->Receive(aFd);
+    }
+
+    static void HandleTimer(void *aContext);
+
+    Responder        mResponder;
+    int              mProtocol;
+    int              mSockets[kSockets];
+    Reactor::Watch   mWatches[kSockets];
+    unsigned int     mInterfaces[kMaxInterfaces];
+    uint8_t          mInterfaceCount;
+    sockaddr_storage mSource;
+    socklen_t        mSourceLength;
+    int              mSourceFd;
+    Reactor *        mReactor;
+    TimerWheel       mLocalTimerWheel;
+    TimerWheel *     mTimerWheel;
+    Timer            mTimer;
+    char             mHost[kMaxSizeOfHost];
+    char *           mDomain;
+    State            mState;
+    StateHandler     mStateHandler;
+    void *           mContext;
+    uint8_t          mBuffer[Responder::kMaxSizeOfPacket];
+};
+
+/**
+ * @}
+ */
+
+} // namespace Mdns
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // MDNS_NATIVE_HPP_
@@ -0,0 +1,304 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the HTTP endpoint exporting metrics.
+ */
+
+#include "metrics_server.hpp"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
+#include "common/timeline.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+MetricsServer::MetricsServer(Reactor &aReactor)
+    : mReactor(aReactor)
+    , mFd(-1)
+{
+    for (int i = 0; i < kMaxConnections; ++i)
+    {
+        mConnections[i].mServer = this;
+        mConnections[i].mFd     = -1;
+    }
+}
+
+MetricsServer::~MetricsServer(void)
+{
+    Stop();
+}
+
+otbrError MetricsServer::Start(uint16_t aPort)
+{
+    otbrError   error = OTBR_ERROR_ERRNO;
+    int         one   = 1;
+    sockaddr_in sin;
+
+    VerifyOrExit((mFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) >= 0);
+    VerifyOrExit(setsockopt(mFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0);
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family      = AF_INET;
+    sin.sin_port        = htons(aPort);
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    VerifyOrExit(bind(mFd, reinterpret_cast<sockaddr *>(&sin), sizeof(sin)) == 0);
+    VerifyOrExit(listen(mFd, kMaxConnections) == 0);
+    SuccessOrExit(mReactor.Add(mWatch, mFd, Reactor::kEventReadable, HandleAccept, this, "metrics"));
+
+    otbrLog(OTBR_LOG_INFO, "Metrics served on 127.0.0.1:%u", aPort);
+    error = OTBR_ERROR_NONE;
+
+exit:
+    if (error != OTBR_ERROR_NONE && mFd >= 0)
+    {
+        close(mFd);
+        mFd = -1;
+    }
+
+    return error;
+}
+
+void MetricsServer::Stop(void)
+{
+    for (int i = 0; i < kMaxConnections; ++i)
+    {
+        if (mConnections[i].mFd >= 0)
+        {
+            Close(mConnections[i]);
+        }
+    }
+
+    VerifyOrExit(mFd >= 0);
+
+    mReactor.Remove(mWatch);
+    close(mFd);
+    mFd = -1;
+
+exit:
+    return;
+}
+
+void MetricsServer::HandleAccept(void *aContext, int aFd, unsigned int aEvents)
+{
+    (void)aFd;
+    (void)aEvents;
+
+    static_cast<MetricsServer *>(aContext)->HandleAccept();
+}
+
+void MetricsServer::HandleAccept(void)
+{
+    uint64_t    now        = GetMonotonicNow();
+    Connection *connection = NULL;
+    int         fd;
+
+    VerifyOrExit((fd = accept4(mFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0);
+
+    // Connections left unanswered are evicted to make room, so that idle clients cannot lock the endpoint.
+    for (int i = 0; i < kMaxConnections && connection == NULL; ++i)
+    {
+        if (mConnections[i].mFd < 0)
+        {
+            connection = &mConnections[i];
+        }
+        else if (now - mConnections[i].mAcceptTime >= kIdleTimeout)
+        {
+            Close(mConnections[i]);
+            connection = &mConnections[i];
+        }
+    }
+
+    VerifyOrExit(connection != NULL, close(fd), otbrLog(OTBR_LOG_WARNING, "Too many metrics connections"));
+
+    if (mReactor.Add(connection->mWatch, fd, Reactor::kEventReadable, HandleConnection, connection, "metrics") !=
+        OTBR_ERROR_NONE)
+    {
+        close(fd);
+        ExitNow();
+    }
+
+    connection->mFd            = fd;
+    connection->mAcceptTime    = now;
+    connection->mRequestLength = 0;
+    connection->mSent          = 0;
+    connection->mResponse.clear();
+
+exit:
+    return;
+}
+
+void MetricsServer::HandleConnection(void *aContext, int aFd, unsigned int aEvents)
+{
+    Connection &connection = *static_cast<Connection *>(aContext);
+
+    (void)aFd;
+
+    connection.mServer->HandleConnection(connection, aEvents);
+}
+
+void MetricsServer::HandleConnection(Connection &aConnection, unsigned int aEvents)
+{
+    ssize_t rval;
+
+    VerifyOrExit(!(aEvents & Reactor::kEventError), Close(aConnection));
+
+    if (!aConnection.mResponse.empty())
+    {
+        if (Send(aConnection))
+        {
+            Close(aConnection);
+        }
+
+        ExitNow();
+    }
+
+    // Leave room for the terminating null character.
+    rval = recv(aConnection.mFd, aConnection.mRequest + aConnection.mRequestLength,
+                sizeof(aConnection.mRequest) - aConnection.mRequestLength - 1, 0);
+
+    if (rval < 0 && (errno == EAGAIN || errno == EINTR))
+    {
+        ExitNow();
+    }
+
+    VerifyOrExit(rval > 0, Close(aConnection));
+
+    aConnection.mRequestLength += static_cast<size_t>(rval);
+    aConnection.mRequest[aConnection.mRequestLength] = '\0';
+
+    if (strstr(aConnection.mRequest, "\r\n\r\n") != NULL || strstr(aConnection.mRequest, "\n\n") != NULL)
+    {
+        HandleRequest(aConnection);
+    }
+    else if (aConnection.mRequestLength + 1 == sizeof(aConnection.mRequest))
+    {
+        otbrLog(OTBR_LOG_WARNING, "Metrics request too large");
+        Close(aConnection);
+    }
+
+exit:
+    return;
+}
+
+// Whether the request line is for @p aPath, with or without a query.
+static bool IsPath(const char *aRequest, const char *aPath, size_t aLength)
+{
+    return strncmp(aRequest, aPath, aLength) == 0 && (aRequest[aLength] == ' ' || aRequest[aLength] == '?');
+}
+
+void MetricsServer::HandleRequest(Connection &aConnection)
+{
+    static const char kPath[]         = "GET /metrics";
+    static const char kTimelinePath[] = "GET /timeline";
+    const char *      status          = "200 OK";
+    const char *      type            = Metrics::kExportContentType;
+    std::string       body;
+    char              header[160];
+
+    if (IsPath(aConnection.mRequest, kPath, sizeof(kPath) - 1))
+    {
+        Metrics::Export(body);
+    }
+    else if (IsPath(aConnection.mRequest, kTimelinePath, sizeof(kTimelinePath) - 1))
+    {
+        type = Timeline::kExportContentType;
+        Timeline::Export(body);
+    }
+    else
+    {
+        status = "404 Not Found";
+        type   = "text/plain";
+        body   = "Not Found\n";
+    }
+
+    snprintf(header, sizeof(header),
+             "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %lu\r\nConnection: close\r\n\r\n", status, type,
+             static_cast<unsigned long>(body.size()));
+
+    aConnection.mResponse = header;
+    aConnection.mResponse += body;
+
+    if (Send(aConnection))
+    {
+        Close(aConnection);
+    }
+    else
+    {
+        mReactor.Modify(aConnection.mWatch, Reactor::kEventWritable);
+    }
+}
+
+bool MetricsServer::Send(Connection &aConnection)
+{
+    bool done = false;
+
+    while (aConnection.mSent < aConnection.mResponse.size())
+    {
+        ssize_t rval = send(aConnection.mFd, aConnection.mResponse.data() + aConnection.mSent,
+                            aConnection.mResponse.size() - aConnection.mSent, MSG_NOSIGNAL);
+
+        if (rval < 0)
+        {
+            VerifyOrExit(errno == EAGAIN || errno == EINTR, done = true);
+            ExitNow();
+        }
+
+        aConnection.mSent += static_cast<size_t>(rval);
+    }
+
+    done = true;
+
+exit:
+    return done;
+}
+
+void MetricsServer::Close(Connection &aConnection)
+{
+    mReactor.Remove(aConnection.mWatch);
+    close(aConnection.mFd);
+    aConnection.mFd = -1;
+    aConnection.mResponse.clear();
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,125 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the HTTP endpoint exporting metrics.
+ */
+
+#ifndef METRICS_SERVER_HPP_
+#define METRICS_SERVER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "common/reactor.hpp"
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class implements a minimal HTTP server answering `GET /metrics` with all metrics in the Prometheus text
+ * exposition format, and `GET /timeline` with the timeline of agent activity as a Chrome trace.
+ *
+ * The server only listens on the loopback interface, and serves a few connections at a time from the reactor. Each
+ * connection is closed once its single request is answered.
+ *
+ */
+class MetricsServer
+{
+public:
+    /**
+     * The constructor to initialize the metrics server.
+     *
+     * @param[in]   aReactor    A reference to the reactor to register sockets with.
+     *
+     */
+    explicit MetricsServer(Reactor &aReactor);
+
+    ~MetricsServer(void);
+
+    /**
+     * This method starts listening.
+     *
+     * @param[in]   aPort   The TCP port to listen on 127.0.0.1.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully started.
+     * @retval  OTBR_ERROR_ERRNO    Failed to start, error code set in errno.
+     *
+     */
+    otbrError Start(uint16_t aPort);
+
+    /**
+     * This method closes the listening socket and all connections.
+     *
+     */
+    void Stop(void);
+
+private:
+    enum
+    {
+        kMaxConnections = 4,    ///< Max number of connections served at a time.
+        kMaxRequestSize = 1024, ///< Max size of the request head.
+        kIdleTimeout    = 5000, ///< Milliseconds a connection may stay unanswered before it is evicted.
+    };
+
+    struct Connection
+    {
+        MetricsServer *mServer;
+        Reactor::Watch mWatch;
+        int            mFd;
+        uint64_t       mAcceptTime;
+        char           mRequest[kMaxRequestSize];
+        size_t         mRequestLength;
+        std::string    mResponse;
+        size_t         mSent;
+    };
+
+    static void HandleAccept(void *aContext, int aFd, unsigned int aEvents);
+    void        HandleAccept(void);
+    static void HandleConnection(void *aContext, int aFd, unsigned int aEvents);
+    void        HandleConnection(Connection &aConnection, unsigned int aEvents);
+    void        HandleRequest(Connection &aConnection);
+    bool        Send(Connection &aConnection);
+    void        Close(Connection &aConnection);
+
+    Reactor &      mReactor;
+    Reactor::Watch mWatch;
+    int            mFd;
+    Connection     mConnections[kMaxConnections];
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // METRICS_SERVER_HPP_
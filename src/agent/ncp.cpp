@@ -0,0 +1,99 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the creation of NCP controllers.
+ */
+
+#include "ncp.hpp"
+
+#include <string.h>
+
+#include "ncp_sim.hpp"
+#include "ncp_spinel.hpp"
+#include "ncp_wpantund.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Ncp {
+
+/**
+ * Interface names with this prefix are the serial device of an NCP to talk Spinel with directly.
+ *
+ */
+static const char kSpinelUrlPrefix[] = "spinel+hdlc+uart://";
+
+/**
+ * Interface names with this prefix are a simulated NCP, followed by the parameters of the simulation.
+ *
+ */
+static const char kSimUrlPrefix[] = "sim://";
+
+Controller *Controller::Create(const char *aInterfaceName, Reactor *aReactor, TimerWheel *aTimerWheel)
+{
+    Controller *controller = NULL;
+
+    if (strncmp(aInterfaceName, kSpinelUrlPrefix, sizeof(kSpinelUrlPrefix) - 1) == 0)
+    {
+        controller = new ControllerSpinel(aInterfaceName + sizeof(kSpinelUrlPrefix) - 1, aReactor);
+    }
+    else if (strncmp(aInterfaceName, kSimUrlPrefix, sizeof(kSimUrlPrefix) - 1) == 0)
+    {
+        controller = new ControllerSim(aInterfaceName + sizeof(kSimUrlPrefix) - 1, aReactor);
+    }
+    else
+    {
+        controller = new ControllerWpantund(aInterfaceName, aReactor, aTimerWheel);
+    }
+
+    return controller;
+}
+
+void Controller::SetDispatchThread(bool aEnabled)
+{
+    ControllerWpantund::SetDispatchThread(aEnabled);
+}
+
+void Controller::SetBusLimits(uint32_t aMaxReceived, uint32_t aMaxOutgoing)
+{
+    ControllerWpantund::SetBusLimits(aMaxReceived, aMaxOutgoing);
+}
+
+void Controller::Destroy(Controller *aController)
+{
+    delete aController;
+}
+
+} // namespace Ncp
+
+} // namespace BorderRouter
+
+} // namespace ot
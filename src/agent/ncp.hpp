@@ -35,6 +35,8 @@
 #define NCP_HPP_
 
 #include "common/event_emitter.hpp"
+#include "common/reactor.hpp"
+#include "common/timer.hpp"
 #include "common/types.hpp"
 
 namespace ot {
@@ -62,9 +64,112 @@ enum
     kEventNetworkName,    ///< Network name arrived.
     kEventPSKc,           ///< PSKc arrived.
     kEventThreadState,    ///< Thread State.
+    kEventNetworkData,    ///< Thread Network Data arrived.
     kEventTmfProxyStream, ///< TMF proxy stream arrived.
 };
 
+/**
+ * This struct is the payload of kEventExtPanId.
+ *
+ */
+struct ExtPanIdEvent
+{
+    enum
+    {
+        kEvent = kEventExtPanId,
+    };
+
+    const uint8_t *mExtPanId; ///< The extended PAN ID of kSizeExtPanId bytes in network endian.
+};
+
+/**
+ * This struct is the payload of kEventNetworkName.
+ *
+ */
+struct NetworkNameEvent
+{
+    enum
+    {
+        kEvent = kEventNetworkName,
+    };
+
+    const char *mNetworkName; ///< The null-terminated network name.
+};
+
+/**
+ * This struct is the payload of kEventPSKc.
+ *
+ */
+struct PSKcEvent
+{
+    enum
+    {
+        kEvent = kEventPSKc,
+    };
+
+    const uint8_t *mPSKc; ///< The PSKc of kSizePSKc bytes.
+};
+
+/**
+ * Thread roles, numbered as in the state bitmap of the MeshCoP service.
+ *
+ */
+enum ThreadRole
+{
+    kThreadRoleDetached = 0, ///< Detached or disabled.
+    kThreadRoleChild    = 1, ///< Child.
+    kThreadRoleRouter   = 2, ///< Router.
+    kThreadRoleLeader   = 3, ///< Leader.
+    kThreadRoleUnknown  = 4, ///< Associated, in a role the NCP does not report.
+};
+
+/**
+ * This struct is the payload of kEventThreadState.
+ *
+ */
+struct ThreadStateEvent
+{
+    enum
+    {
+        kEvent = kEventThreadState,
+    };
+
+    bool       mAssociated; ///< Whether the NCP is associated to the Thread network.
+    ThreadRole mRole;       ///< The Thread role of the NCP.
+};
+
+/**
+ * This struct is the payload of kEventNetworkData.
+ *
+ */
+struct NetworkDataEvent
+{
+    enum
+    {
+        kEvent = kEventNetworkData,
+    };
+
+    const uint8_t *mData;   ///< The TLVs of the Thread Network Data, only valid while the event is handled.
+    uint16_t       mLength; ///< Number of bytes of mData, at most kSizeNetworkData.
+};
+
+/**
+ * This struct is the payload of kEventTmfProxyStream.
+ *
+ */
+struct TmfProxyStreamEvent
+{
+    enum
+    {
+        kEvent = kEventTmfProxyStream,
+    };
+
+    const uint8_t *mBuffer;  ///< The TMF packet.
+    uint16_t       mLength;  ///< Number of bytes of mBuffer.
+    uint16_t       mLocator; ///< The RLOC16 of the peer.
+    uint16_t       mPort;    ///< The UDP port of the peer.
+};
+
 /**
  * This interface defines NCP Controller functionality.
  *
@@ -102,15 +207,29 @@ public:
     /**
      * This method sends a packet through TMF proxy service.
      *
+     * Packets are pipelined to the NCP up to a bounded number not yet acknowledged, beyond which they are dropped.
+     *
      * @retval  OTBR_ERROR_NONE         Successfully sent the packet.
-     * @retval  OTBR_ERROR_ERRNO        Failed to send the packet.
+     * @retval  OTBR_ERROR_ERRNO        Failed to send the packet, errno is set to ENOBUFS if too many packets are
+     *                                  not yet acknowledged by the NCP.
      *
      */
     virtual otbrError TmfProxySend(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort) = 0;
 
+    /**
+     * This method returns the counters of the TMF proxy service.
+     *
+     * @param[out]  aDropped    The number of packets dropped for too many not yet acknowledged.
+     * @param[out]  aFailed     The number of packets rejected by the NCP.
+     *
+     */
+    virtual void GetTmfProxyCounters(uint32_t &aDropped, uint32_t &aFailed) const = 0;
+
     /**
      * This method updates the fd_set to poll.
      *
+     * Nothing is added when a reactor is used.
+     *
      * @param[inout]    aReadFdSet      A reference to fd_set for polling read.
      * @param[inout]    aWriteFdSet     A reference to fd_set for polling read.
      * @param[inout]    aErrorFdSet     A reference to fd_set for polling error.
@@ -150,13 +269,97 @@ public:
      */
     virtual otbrError RequestEvent(int aEvent) = 0;
 
+    /**
+     * This method requests the events of all the cached properties at once.
+     *
+     * The requests are pipelined and this method does not wait for the replies. Each event is emitted once its
+     * reply arrives, and the cache is kept up to date by property changes afterwards.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully sent all the requests.
+     * @retval  OTBR_ERROR_ERRNO        Failed to send some of the requests.
+     *
+     */
+    virtual otbrError RequestEvents(void) = 0;
+
+    /**
+     * This method returns the cached PSKc.
+     *
+     * @returns A pointer to the PSKc of kSizePSKc bytes.
+     *
+     * @retval  NULL    The PSKc is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual const uint8_t *GetPSKc(void) const = 0;
+
+    /**
+     * This method returns the cached network name.
+     *
+     * @returns A pointer to the null-terminated network name.
+     *
+     * @retval  NULL    The network name is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual const char *GetNetworkName(void) const = 0;
+
+    /**
+     * This method returns the cached extended PAN ID.
+     *
+     * @returns A pointer to the extended PAN ID of kSizeExtPanId bytes in network endian.
+     *
+     * @retval  NULL    The extended PAN ID is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual const uint8_t *GetExtPanId(void) const = 0;
+
+    /**
+     * This method returns the cached Thread state.
+     *
+     * @param[out]  aAssociated     Whether the NCP is associated to the Thread network.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully returned the Thread state.
+     * @retval  OTBR_ERROR_ERRNO        The Thread state is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual otbrError GetThreadState(bool &aAssociated) const = 0;
+
     /**
      * This method creates a NCP Controller.
      *
+     * The NCP is accessed through wpantund, unless @p aInterfaceName is the serial device of the NCP in the form of
+     * spinel+hdlc+uart://DEVICE, in which case Spinel is talked directly, or sim://PARAMETERS, in which case the NCP
+     * and its Thread network are simulated in process as ControllerSim describes.
+     *
      * @param[in]   aInterfaceName  A string of the NCP interface.
+     * @param[in]   aReactor        A pointer to the reactor to register file descriptors with, NULL to use
+     *                              UpdateFdSet() and Process() only.
+     * @param[in]   aTimerWheel     A pointer to the timer wheel to schedule timeouts with, NULL if the NCP
+     *                              interface is not given timeouts.
+     *
+     */
+    static Controller *Create(const char *aInterfaceName, Reactor *aReactor = NULL, TimerWheel *aTimerWheel = NULL);
+
+    /**
+     * This method sets whether the bus connections to wpantund are read, written and dispatched by a thread of their
+     * own, instead of the reactor.
+     *
+     * This method must be called before any controller is initialized.
+     *
+     * @param[in]   aEnabled    Whether to dispatch on a thread of its own.
+     *
+     */
+    static void SetDispatchThread(bool aEnabled);
+
+    /**
+     * This method sets the limits of the bus connections to wpantund, open or opened later.
+     *
+     * Once @p aMaxReceived bytes of messages are received and not yet dispatched, a connection stops reading until
+     * they are, and TMF proxy packets that would queue more than @p aMaxOutgoing bytes to be written are dropped.
+     *
+     * @param[in]   aMaxReceived    Max bytes of messages received and not yet dispatched, 0 to keep it.
+     * @param[in]   aMaxOutgoing    Max bytes of messages queued to be written, 0 to keep it.
      *
      */
-    static Controller *Create(const char *aInterfaceName);
+    static void SetBusLimits(uint32_t aMaxReceived, uint32_t aMaxOutgoing);
 
     /**
      * This method destroys a NCP Controller.
@@ -0,0 +1,775 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the simulated NCP service.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_NCP
+
+#include "ncp_sim.hpp"
+
+#include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "uris.hpp"
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/time.hpp"
+#include "common/tlv.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Ncp {
+
+enum
+{
+    kStateAccept        = 1,    ///< Accept state of the State TLV.
+    kStateReject        = 0xff, ///< Reject state of the State TLV.
+    kMaxCommissionerId  = 64,   ///< Max length of the Commissioner ID TLV.
+    kRouterIdShift      = 10,   ///< Position of the router id in a RLOC16.
+    kChildEntryLength   = 3,    ///< Length of an entry of the Child Table TLV.
+    kRouterMaskLength   = 8,    ///< Length of the router id mask of the Route64 TLV.
+    kLinkRouteData      = 0xf1, ///< Route data of a neighbor, link quality 3 in and out and route cost 1.
+};
+
+const uint8_t ControllerSim::kEui64[kSizeEui64]       = {0x18, 0xb4, 0x30, 0x00, 0x00, 0x00, 0x00, 0x01};
+const uint8_t ControllerSim::kPSKc[kSizePSKc]         = {0xb7, 0x83, 0x81, 0x27, 0x89, 0x91, 0x1e, 0xb4,
+                                                 0xea, 0x76, 0x59, 0x6c, 0x9c, 0xed, 0x2a, 0x69};
+const uint8_t ControllerSim::kExtPanId[kSizeExtPanId] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
+const char    ControllerSim::kNetworkName[]           = "OpenThread";
+
+// The on-mesh prefix and the default route of the leader, and a service it serves.
+const uint8_t ControllerSim::kNetworkData[] = {
+    0x03, 0x14, 0x00, 0x40, 0xfd, 0x00, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00, 0x05, 0x04, 0x00, 0x00, 0x33, 0x00,
+    0x07, 0x02, 0x11, 0x40, 0x03, 0x07, 0x00, 0x00, 0x01, 0x03, 0x00, 0x00, 0x00, 0x0b, 0x07, 0x80, 0x01, 0x5c,
+    0x0d, 0x02, 0x00, 0x00,
+};
+
+// Relayed joiner messages are looped back to the border agent with this path.
+static const Coap::EncodedPath sRelayReceivePath(OT_URI_PATH_RELAY_RX);
+
+// Diagnostic queries are answered from the router queried with this path.
+static const Coap::EncodedPath sDiagnosticAnswerPath(OT_URI_PATH_DIAGNOSTIC_GET_ANSWER);
+
+/**
+ * This function returns the TLV of @p aType in the payload of @p aMessage.
+ *
+ * @returns A pointer to the TLV, NULL if not found.
+ *
+ */
+static const Tlv *FindTlv(const Coap::Message &aMessage, uint8_t aType)
+{
+    uint16_t       length  = 0;
+    const uint8_t *payload = aMessage.GetPayload(length);
+    TlvReader      reader(payload, length);
+
+    return reader.Find(aType);
+}
+
+ControllerSim::ControllerSim(const char *aParameters, Reactor *aReactor)
+    : mParameters(aParameters)
+    , mReactor(aReactor)
+    , mTimerFd(-1)
+    , mLeader(Coap::Agent::Create(Receive, this))
+    , mLeaderPetition(OT_URI_PATH_LEADER_PETITION, HandleLeaderPetition, this)
+    , mLeaderKeepAlive(OT_URI_PATH_LEADER_KEEP_ALIVE, HandleLeaderKeepAlive, this)
+    , mCommissionerSet(OT_URI_PATH_COMMISSIONER_SET, HandleManagementSet, this)
+    , mActiveSet(OT_URI_PATH_ACTIVE_SET, HandleManagementSet, this)
+    , mPendingSet(OT_URI_PATH_PENDING_SET, HandleManagementSet, this)
+    , mActiveGet(OT_URI_PATH_ACTIVE_GET, HandleManagementGet, this)
+    , mPendingGet(OT_URI_PATH_PENDING_GET, HandleManagementGet, this)
+    , mRelayTransmit(OT_URI_PATH_RELAY_TX, HandleRelayTransmit, this)
+    , mDiagnosticGet(OT_URI_PATH_DIAGNOSTIC_GET_REQUEST, HandleDiagnosticGet, this)
+    , mDiagnosticQuery(OT_URI_PATH_DIAGNOSTIC_GET_QUERY, HandleDiagnosticQuery, this)
+    , mLatency(0)
+    , mLoss(0)
+    , mLossSeed(1)
+    , mRouters(kDefaultRouters)
+    , mTmfProxyEnabled(false)
+    , mTmfProxyDropped(0)
+    , mTmfProxyLost(0)
+    , mPendingHead(0)
+    , mPendingCount(0)
+    , mCommissionerSessionId(0)
+    , mLastCommissionerSessionId(0)
+    , mCommissionerKeepAlive(0)
+{
+    mLeader->AddResource(mLeaderPetition);
+    mLeader->AddResource(mLeaderKeepAlive);
+    mLeader->AddResource(mCommissionerSet);
+    mLeader->AddResource(mActiveSet);
+    mLeader->AddResource(mPendingSet);
+    mLeader->AddResource(mActiveGet);
+    mLeader->AddResource(mPendingGet);
+    mLeader->AddResource(mRelayTransmit);
+    mLeader->AddResource(mDiagnosticGet);
+    mLeader->AddResource(mDiagnosticQuery);
+}
+
+ControllerSim::~ControllerSim(void)
+{
+    if (mTimerFd >= 0)
+    {
+        if (mReactor != NULL && mWatch.mFd >= 0)
+        {
+            mReactor->Remove(mWatch);
+        }
+
+        close(mTimerFd);
+        mTimerFd = -1;
+    }
+
+    Coap::Agent::Destroy(mLeader);
+}
+
+otbrError ControllerSim::ParseParameters(void)
+{
+    otbrError   ret = OTBR_ERROR_ERRNO;
+    const char *p   = mParameters;
+
+    while (*p != '\0')
+    {
+        const char *   value = strchr(p, '=');
+        char *         end   = NULL;
+        unsigned long  number;
+        unsigned int * field = NULL;
+        size_t         nameLength;
+
+        VerifyOrExit(value != NULL, errno = EINVAL);
+        nameLength = static_cast<size_t>(value - p);
+
+        if (nameLength == sizeof("latency") - 1 && strncmp(p, "latency", nameLength) == 0)
+        {
+            field = &mLatency;
+        }
+        else if (nameLength == sizeof("loss") - 1 && strncmp(p, "loss", nameLength) == 0)
+        {
+            field = &mLoss;
+        }
+        else if (nameLength == sizeof("seed") - 1 && strncmp(p, "seed", nameLength) == 0)
+        {
+            field = &mLossSeed;
+        }
+        else if (nameLength == sizeof("routers") - 1 && strncmp(p, "routers", nameLength) == 0)
+        {
+            field = &mRouters;
+        }
+        else
+        {
+            ExitNow(errno = EINVAL);
+        }
+
+        errno  = 0;
+        number = strtoul(value + 1, &end, 0);
+        VerifyOrExit(errno == 0 && end != value + 1 && (*end == ',' || *end == '\0'), errno = EINVAL);
+        VerifyOrExit(number <= (field == &mLoss ? 100UL : static_cast<unsigned long>(UINT_MAX)), errno = EINVAL);
+        VerifyOrExit(field != &mRouters || (number >= 1 && number <= kMaxRouters), errno = EINVAL);
+        *field = static_cast<unsigned int>(number);
+
+        p = (*end == ',' ? end + 1 : end);
+    }
+
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    if (ret != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "Invalid simulation parameters: %s", mParameters);
+    }
+
+    return ret;
+}
+
+otbrError ControllerSim::Init(void)
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+
+    SuccessOrExit(ParseParameters());
+    VerifyOrExit((mTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) >= 0);
+
+    if (mReactor != NULL)
+    {
+        SuccessOrExit(mReactor->Add(mWatch, mTimerFd, Reactor::kEventReadable, HandleReactor, this, "ncp-sim"));
+    }
+
+    otbrLog(OTBR_LOG_INFO, "Simulated NCP with latency %ums, loss %u%% and %u routers", mLatency, mLoss, mRouters);
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    return ret;
+}
+
+otbrError ControllerSim::TmfProxyStart(void)
+{
+    mTmfProxyEnabled = true;
+
+    return OTBR_ERROR_NONE;
+}
+
+otbrError ControllerSim::TmfProxyStop(void)
+{
+    mTmfProxyEnabled = false;
+    mPendingCount    = 0;
+    UpdateTimer();
+
+    return OTBR_ERROR_NONE;
+}
+
+otbrError ControllerSim::TmfProxySend(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort)
+{
+    otbrError  ret = OTBR_ERROR_ERRNO;
+    Ip6Address addr(aLocator);
+
+    VerifyOrExit(mTmfProxyEnabled, errno = ENOTCONN);
+    VerifyOrExit(mPendingCount < kMaxPending, ++mTmfProxyDropped, errno = ENOBUFS);
+
+    // The leader answers from the destination of the packet, which is where its responses are received from.
+    mLeader->Input(aBuffer, aLength, addr.m8, aPort);
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    return ret;
+}
+
+ssize_t ControllerSim::Receive(const uint8_t *aBuffer,
+                               uint16_t       aLength,
+                               const uint8_t *aIp6,
+                               uint16_t       aPort,
+                               void *         aContext)
+{
+    static_cast<ControllerSim *>(aContext)->Receive(aBuffer, aLength,
+                                                    static_cast<uint16_t>(aIp6[14] << 8 | aIp6[15]), aPort);
+
+    return aLength;
+}
+
+void ControllerSim::Receive(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort)
+{
+    Packet *packet = NULL;
+
+    VerifyOrExit(mTmfProxyEnabled);
+    VerifyOrExit(mPendingCount < kMaxPending && aLength <= kMaxPacket, ++mTmfProxyDropped);
+
+    // Losses are drawn from a seeded generator, so runs with the same parameters lose the same packets.
+    VerifyOrExit(mLoss == 0 || static_cast<unsigned int>(rand_r(&mLossSeed) % 100) >= mLoss, ++mTmfProxyLost);
+
+    packet           = &mPending[(mPendingHead + mPendingCount) % kMaxPending];
+    packet->mDueTime = GetMonotonicNowUs() + static_cast<uint64_t>(mLatency) * 1000;
+    packet->mLength  = aLength;
+    packet->mLocator = aLocator;
+    packet->mPort    = aPort;
+    memcpy(packet->mBuffer, aBuffer, aLength);
+
+    // The latency is fixed, so packets become due in the order they are received.
+    if (++mPendingCount == 1)
+    {
+        UpdateTimer();
+    }
+
+exit:
+    return;
+}
+
+void ControllerSim::UpdateTimer(void)
+{
+    struct itimerspec spec;
+    uint64_t          now = GetMonotonicNowUs();
+
+    VerifyOrExit(mTimerFd >= 0);
+    memset(&spec, 0, sizeof(spec));
+
+    if (mPendingCount > 0)
+    {
+        uint64_t due = mPending[mPendingHead].mDueTime;
+
+        // A zero value disarms the timer, so packets already due fire after a microsecond.
+        due                     = (due > now ? due - now : 1);
+        spec.it_value.tv_sec    = static_cast<time_t>(due / 1000000);
+        spec.it_value.tv_nsec   = static_cast<long>(due % 1000000) * 1000;
+    }
+
+    if (timerfd_settime(mTimerFd, 0, &spec, NULL) != 0)
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to set the simulation timer: %s", strerror(errno));
+    }
+
+exit:
+    return;
+}
+
+void ControllerSim::Deliver(void)
+{
+    uint64_t now = GetMonotonicNowUs();
+    uint64_t expirations;
+
+    // Drains the expiration count, whether or not the timer expired.
+    while (read(mTimerFd, &expirations, sizeof(expirations)) > 0)
+    {
+    }
+
+    while (mPendingCount > 0 && mPending[mPendingHead].mDueTime <= now)
+    {
+        Packet packet;
+
+        // Handlers may send packets queued behind this one, so it is delivered from a copy.
+        memcpy(&packet, &mPending[mPendingHead], offsetof(Packet, mBuffer) + mPending[mPendingHead].mLength);
+        mPendingHead = (mPendingHead + 1) % kMaxPending;
+        --mPendingCount;
+
+        TmfProxyStreamEvent event = {packet.mBuffer, packet.mLength, packet.mLocator, packet.mPort};
+        EmitPayload(event);
+    }
+
+    UpdateTimer();
+}
+
+void ControllerSim::HandleReactor(void *aContext, int aFd, unsigned int aEvents)
+{
+    static_cast<ControllerSim *>(aContext)->Deliver();
+
+    (void)aFd;
+    (void)aEvents;
+}
+
+void ControllerSim::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd)
+{
+    VerifyOrExit(mReactor == NULL && mTimerFd >= 0);
+
+    FD_SET(mTimerFd, &aReadFdSet);
+
+    if (mTimerFd > aMaxFd)
+    {
+        aMaxFd = mTimerFd;
+    }
+
+exit:
+    (void)aWriteFdSet;
+    (void)aErrorFdSet;
+}
+
+void ControllerSim::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
+{
+    VerifyOrExit(mReactor == NULL && mTimerFd >= 0);
+
+    if (FD_ISSET(mTimerFd, &aReadFdSet))
+    {
+        Deliver();
+    }
+
+exit:
+    (void)aWriteFdSet;
+    (void)aErrorFdSet;
+}
+
+otbrError ControllerSim::RequestEvent(int aEvent)
+{
+    otbrError ret = OTBR_ERROR_NONE;
+
+    switch (aEvent)
+    {
+    case kEventExtPanId:
+    {
+        ExtPanIdEvent event = {kExtPanId};
+        EmitPayload(event);
+        break;
+    }
+
+    case kEventNetworkName:
+    {
+        NetworkNameEvent event = {kNetworkName};
+        EmitPayload(event);
+        break;
+    }
+
+    case kEventPSKc:
+    {
+        PSKcEvent event = {kPSKc};
+        EmitPayload(event);
+        break;
+    }
+
+    case kEventThreadState:
+    {
+        ThreadStateEvent event = {true, kThreadRoleRouter};
+        EmitPayload(event);
+        break;
+    }
+
+    case kEventNetworkData:
+    {
+        NetworkDataEvent event = {kNetworkData, sizeof(kNetworkData)};
+        EmitPayload(event);
+        break;
+    }
+
+    default:
+        otbrLog(OTBR_LOG_WARNING, "Unknown event %d", aEvent);
+        errno = EINVAL;
+        ret   = OTBR_ERROR_ERRNO;
+        break;
+    }
+
+    return ret;
+}
+
+otbrError ControllerSim::RequestEvents(void)
+{
+    RequestEvent(kEventExtPanId);
+    RequestEvent(kEventNetworkName);
+    RequestEvent(kEventPSKc);
+    RequestEvent(kEventThreadState);
+    RequestEvent(kEventNetworkData);
+
+    return OTBR_ERROR_NONE;
+}
+
+bool ControllerSim::IsSessionActive(uint16_t aSessionId) const
+{
+    return mCommissionerSessionId != 0 && mCommissionerSessionId == aSessionId &&
+           GetMonotonicNow() - mCommissionerKeepAlive < kCommissionerTimeout;
+}
+
+void ControllerSim::HandleLeaderPetition(const Coap::Resource &aResource,
+                                         const Coap::Message & aRequest,
+                                         Coap::Message &       aResponse,
+                                         const uint8_t *       aIp6,
+                                         uint16_t              aPort,
+                                         void *                aContext)
+{
+    static_cast<ControllerSim *>(aContext)->HandleLeaderPetition(aRequest, aResponse);
+
+    (void)aResource;
+    (void)aIp6;
+    (void)aPort;
+}
+
+void ControllerSim::HandleLeaderPetition(const Coap::Message &aRequest, Coap::Message &aResponse)
+{
+    uint8_t    payload[(sizeof(Tlv) + sizeof(uint16_t)) * 2 + sizeof(Tlv) + kMaxCommissionerId];
+    TlvWriter  writer(payload, sizeof(payload));
+    const Tlv *commissioner = FindTlv(aRequest, Meshcop::kCommissionerId);
+    bool       accepted     = !IsSessionActive(mCommissionerSessionId);
+
+    writer.AppendUInt8(Meshcop::kState, static_cast<uint8_t>(accepted ? kStateAccept : kStateReject));
+
+    if (commissioner != NULL && commissioner->GetLength() <= kMaxCommissionerId)
+    {
+        writer.Append(*commissioner);
+    }
+
+    if (accepted)
+    {
+        // Session ids wrap around skipping 0, which stands for no active commissioner.
+        if (++mLastCommissionerSessionId == 0)
+        {
+            ++mLastCommissionerSessionId;
+        }
+
+        mCommissionerSessionId = mLastCommissionerSessionId;
+        mCommissionerKeepAlive = GetMonotonicNow();
+
+        writer.AppendUInt16(Meshcop::kCommissionerSessionId, mCommissionerSessionId);
+    }
+
+    otbrLog(OTBR_LOG_INFO, "Simulated leader %s petition", accepted ? "accepted" : "rejected");
+    aResponse.SetCode(Coap::kCodeChanged);
+    aResponse.SetPayload(payload, writer.GetLength());
+}
+
+void ControllerSim::HandleLeaderKeepAlive(const Coap::Resource &aResource,
+                                          const Coap::Message & aRequest,
+                                          Coap::Message &       aResponse,
+                                          const uint8_t *       aIp6,
+                                          uint16_t              aPort,
+                                          void *                aContext)
+{
+    static_cast<ControllerSim *>(aContext)->HandleLeaderKeepAlive(aRequest, aResponse);
+
+    (void)aResource;
+    (void)aIp6;
+    (void)aPort;
+}
+
+void ControllerSim::HandleLeaderKeepAlive(const Coap::Message &aRequest, Coap::Message &aResponse)
+{
+    uint8_t    state[sizeof(Tlv) + sizeof(uint8_t)];
+    Tlv *      tlv        = reinterpret_cast<Tlv *>(state);
+    const Tlv *stateTlv   = FindTlv(aRequest, Meshcop::kState);
+    const Tlv *sessionTlv = FindTlv(aRequest, Meshcop::kCommissionerSessionId);
+    bool       accepted   = (sessionTlv != NULL && sessionTlv->GetLength() == sizeof(uint16_t) &&
+                     IsSessionActive(sessionTlv->GetValueUInt16()));
+
+    if (accepted && stateTlv != NULL && stateTlv->GetLength() == sizeof(uint8_t) &&
+        stateTlv->GetValueUInt8() != kStateAccept)
+    {
+        // The commissioner resigns.
+        mCommissionerSessionId = 0;
+    }
+    else if (accepted)
+    {
+        mCommissionerKeepAlive = GetMonotonicNow();
+    }
+
+    tlv->SetType(Meshcop::kState);
+    tlv->SetValue(static_cast<uint8_t>(accepted ? kStateAccept : kStateReject));
+    aResponse.SetCode(Coap::kCodeChanged);
+    aResponse.SetPayload(state, sizeof(state));
+}
+
+void ControllerSim::HandleManagementSet(const Coap::Resource &aResource,
+                                        const Coap::Message & aRequest,
+                                        Coap::Message &       aResponse,
+                                        const uint8_t *       aIp6,
+                                        uint16_t              aPort,
+                                        void *                aContext)
+{
+    static_cast<ControllerSim *>(aContext)->HandleManagementSet(aRequest, aResponse);
+
+    (void)aResource;
+    (void)aIp6;
+    (void)aPort;
+}
+
+void ControllerSim::HandleManagementSet(const Coap::Message &aRequest, Coap::Message &aResponse)
+{
+    uint8_t    state[sizeof(Tlv) + sizeof(uint8_t)];
+    Tlv *      tlv        = reinterpret_cast<Tlv *>(state);
+    const Tlv *sessionTlv = FindTlv(aRequest, Meshcop::kCommissionerSessionId);
+
+    // Data sets are not kept, only the session of the commissioner setting them is checked.
+    tlv->SetType(Meshcop::kState);
+    tlv->SetValue(static_cast<uint8_t>(sessionTlv != NULL && sessionTlv->GetLength() == sizeof(uint16_t) &&
+                                               IsSessionActive(sessionTlv->GetValueUInt16())
+                                           ? kStateAccept
+                                           : kStateReject));
+    aResponse.SetCode(Coap::kCodeChanged);
+    aResponse.SetPayload(state, sizeof(state));
+}
+
+void ControllerSim::HandleManagementGet(const Coap::Resource &aResource,
+                                        const Coap::Message & aRequest,
+                                        Coap::Message &       aResponse,
+                                        const uint8_t *       aIp6,
+                                        uint16_t              aPort,
+                                        void *                aContext)
+{
+    // Data sets are not kept, so they are always empty.
+    aResponse.SetCode(Coap::kCodeChanged);
+
+    (void)aResource;
+    (void)aRequest;
+    (void)aIp6;
+    (void)aPort;
+    (void)aContext;
+}
+
+void ControllerSim::HandleRelayTransmit(const Coap::Resource &aResource,
+                                        const Coap::Message & aRequest,
+                                        Coap::Message &       aResponse,
+                                        const uint8_t *       aIp6,
+                                        uint16_t              aPort,
+                                        void *                aContext)
+{
+    static_cast<ControllerSim *>(aContext)->HandleRelayTransmit(aRequest, aIp6, aPort);
+
+    (void)aResource;
+    (void)aResponse;
+}
+
+void ControllerSim::HandleRelayTransmit(const Coap::Message &aRequest, const uint8_t *aIp6, uint16_t aPort)
+{
+    uint8_t        token[8];
+    uint8_t        tokenLength = 0;
+    const uint8_t *requestToken = aRequest.GetToken(tokenLength);
+    uint16_t       length       = 0;
+    const uint8_t *payload      = aRequest.GetPayload(length);
+    TlvReader      reader(payload, length);
+    uint8_t        relayed[kMaxPacket];
+    TlvWriter      writer(relayed, sizeof(relayed));
+
+    // The joiner router echoes the joiner back, keeping all TLVs but the KEK meant for it.
+    for (const Tlv *tlv = reader.GetNext(); tlv != NULL; tlv = reader.GetNext())
+    {
+        if (tlv->GetType() != Meshcop::kJoinerRouterKek)
+        {
+            writer.Append(*tlv);
+        }
+    }
+
+    tokenLength = (tokenLength < sizeof(token) ? tokenLength : sizeof(token));
+    memcpy(token, requestToken, tokenLength);
+
+    {
+        Coap::ScopedMessage message(*mLeader, Coap::kTypeNonConfirmable, Coap::kCodePost, token, tokenLength);
+
+        VerifyOrExit(message.Get() != NULL, otbrLog(OTBR_LOG_ERR, "Failed to create relay receive message"));
+        message->SetPathEncoded(sRelayReceivePath);
+        message->SetPayload(relayed, writer.GetLength());
+        mLeader->Send(*message, aIp6, aPort, NULL, NULL);
+    }
+
+exit:
+    return;
+}
+
+void ControllerSim::HandleDiagnosticGet(const Coap::Resource &aResource,
+                                        const Coap::Message & aRequest,
+                                        Coap::Message &       aResponse,
+                                        const uint8_t *       aIp6,
+                                        uint16_t              aPort,
+                                        void *                aContext)
+{
+    static_cast<ControllerSim *>(aContext)->HandleDiagnosticGet(aRequest, aResponse);
+
+    (void)aResource;
+    (void)aIp6;
+    (void)aPort;
+}
+
+void ControllerSim::HandleDiagnosticGet(const Coap::Message &aRequest, Coap::Message &aResponse)
+{
+    uint8_t payload[kMaxPacket];
+
+    // The leader is router 0.
+    aResponse.SetCode(Coap::kCodeChanged);
+    aResponse.SetPayload(payload, WriteDiagnostic(aRequest, 0, payload, sizeof(payload)));
+}
+
+void ControllerSim::HandleDiagnosticQuery(const Coap::Resource &aResource,
+                                          const Coap::Message & aRequest,
+                                          Coap::Message &       aResponse,
+                                          const uint8_t *       aIp6,
+                                          uint16_t              aPort,
+                                          void *                aContext)
+{
+    static_cast<ControllerSim *>(aContext)->HandleDiagnosticQuery(aRequest, aIp6, aPort);
+
+    (void)aResource;
+    (void)aResponse;
+}
+
+void ControllerSim::HandleDiagnosticQuery(const Coap::Message &aRequest, const uint8_t *aIp6, uint16_t aPort)
+{
+    uint16_t locator  = static_cast<uint16_t>(aIp6[14] << 8 | aIp6[15]);
+    uint8_t  routerId = static_cast<uint8_t>(locator >> kRouterIdShift);
+    uint8_t  payload[kMaxPacket];
+    uint16_t length;
+
+    // Only the RLOC16 of routers are answered, children are not simulated.
+    VerifyOrExit((locator & ((1 << kRouterIdShift) - 1)) == 0 && routerId < mRouters);
+
+    length = WriteDiagnostic(aRequest, routerId, payload, sizeof(payload));
+
+    {
+        Coap::ScopedMessage message(*mLeader, Coap::kTypeNonConfirmable, Coap::kCodePost, NULL, 0);
+
+        VerifyOrExit(message.Get() != NULL, otbrLog(OTBR_LOG_ERR, "Failed to create diagnostic answer message"));
+        message->SetPathEncoded(sDiagnosticAnswerPath);
+        message->SetPayload(payload, length);
+        mLeader->Send(*message, aIp6, aPort, NULL, NULL);
+    }
+
+exit:
+    return;
+}
+
+uint16_t ControllerSim::WriteDiagnostic(const Coap::Message &aRequest,
+                                        uint8_t              aRouterId,
+                                        uint8_t *            aBuffer,
+                                        uint16_t             aLength)
+{
+    const Tlv *    typeList = FindTlv(aRequest, Diagnostic::kTypeList);
+    const uint8_t *types    = (typeList != NULL ? static_cast<const uint8_t *>(typeList->GetValue()) : NULL);
+    TlvWriter      writer(aBuffer, aLength);
+
+    for (uint16_t i = 0; typeList != NULL && i < typeList->GetLength(); ++i)
+    {
+        switch (types[i])
+        {
+        case Diagnostic::kExtMacAddress:
+        {
+            uint8_t extAddress[kSizeEui64];
+
+            memcpy(extAddress, kEui64, sizeof(extAddress));
+            extAddress[sizeof(extAddress) - 1] = aRouterId;
+            writer.Append(Diagnostic::kExtMacAddress, extAddress, sizeof(extAddress));
+            break;
+        }
+
+        case Diagnostic::kAddress16:
+            writer.AppendUInt16(Diagnostic::kAddress16, static_cast<uint16_t>(aRouterId << kRouterIdShift));
+            break;
+
+        case Diagnostic::kRoute64:
+        {
+            uint8_t route[sizeof(uint8_t) + kRouterMaskLength + kMaxRouters];
+
+            // Router ids are allocated from 0, every router is a neighbor of the others.
+            memset(route, 0, sizeof(route));
+
+            for (unsigned int id = 0; id < mRouters; ++id)
+            {
+                route[1 + id / 8] |= static_cast<uint8_t>(0x80 >> (id % 8));
+                route[1 + kRouterMaskLength + id] = (id == aRouterId ? 0 : kLinkRouteData);
+            }
+
+            writer.Append(Diagnostic::kRoute64, route, static_cast<uint16_t>(1 + kRouterMaskLength + mRouters));
+            break;
+        }
+
+        case Diagnostic::kChildTable:
+        {
+            uint8_t children[kChildEntryLength * kMaxRouters];
+
+            memset(children, 0, sizeof(children));
+            writer.Append(Diagnostic::kChildTable, children, static_cast<uint16_t>(kChildEntryLength * aRouterId));
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    return writer.GetLength();
+}
+
+} // namespace Ncp
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,347 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for the simulated NCP service.
+ */
+
+#ifndef NCP_SIM_HPP_
+#define NCP_SIM_HPP_
+
+#include <stdint.h>
+#include <sys/select.h>
+
+#include "coap.hpp"
+#include "ncp.hpp"
+#include "common/reactor.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Ncp {
+
+/**
+ * This class simulates an NCP attached to a Thread network in process, to run the agent without wpantund or
+ * hardware.
+ *
+ * TMF packets sent are handled by a simulated leader, which accepts one commissioner at a time and answers leader
+ * petitions, keep-alives and commissioner data sets, while relayed joiner messages are looped back as received. The
+ * configured number of routers, all neighbors of each other, answer network diagnostics, router id i with i children.
+ * Every packet received is delivered after the configured latency, unless it is lost at the configured rate. The
+ * network is named "OpenThread" with extended PAN ID 0001020304050607, and its PSKc is that of passphrase "123456".
+ * Its network data has the on-mesh prefix fd00:db8::/64 and a default route of the leader, and a service of it.
+ *
+ */
+class ControllerSim : public Controller
+{
+public:
+    /**
+     * The contructor to initialize a Ncp Controller.
+     *
+     * @param[in]   aParameters     The comma separated parameters of the simulation, `latency=MS` for the latency of
+     *                              received packets, `loss=PERCENT` for their loss rate, `seed=NUMBER` for the
+     *                              seed of losses and `routers=NUMBER` for the number of routers, 3 by default.
+     * @param[in]   aReactor        A pointer to the reactor, NULL to use the fd_set interface.
+     *
+     */
+    ControllerSim(const char *aParameters, Reactor *aReactor);
+    ~ControllerSim(void);
+
+    /**
+     * This method initalize the NCP controller.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully initialized NCP controller.
+     * @retval  OTBR_ERROR_ERRNO    Failed for invalid parameters or to create the timer.
+     *
+     */
+    virtual otbrError Init(void);
+
+    /**
+     * This method request the Ncp to start the TMF proxy service.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully started TMF proxy.
+     *
+     */
+    virtual otbrError TmfProxyStart(void);
+
+    /**
+     * This method request the Ncp to stop the TMF proxy service.
+     *
+     * Packets not yet delivered are dropped.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully stopped TMF proxy.
+     *
+     */
+    virtual otbrError TmfProxyStop(void);
+
+    /**
+     * This method sends a packet through TMF proxy service.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully sent the packet.
+     * @retval  OTBR_ERROR_ERRNO        Failed to send the packet, errno is set to ENOBUFS if too many received
+     *                                  packets are not yet delivered.
+     *
+     */
+    virtual otbrError TmfProxySend(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort);
+
+    /**
+     * This method returns the counters of the TMF proxy service.
+     *
+     * @param[out]  aDropped    The number of packets dropped for too many received packets not yet delivered.
+     * @param[out]  aFailed     The number of received packets lost at the configured rate.
+     *
+     */
+    virtual void GetTmfProxyCounters(uint32_t &aDropped, uint32_t &aFailed) const
+    {
+        aDropped = mTmfProxyDropped;
+        aFailed  = mTmfProxyLost;
+    }
+
+    /**
+     * This method updates the fd_set to poll.
+     *
+     * Nothing is added when a reactor is used.
+     *
+     * @param[inout]    aReadFdSet      A reference to fd_set for polling read.
+     * @param[inout]    aWriteFdSet     A reference to fd_set for polling read.
+     * @param[inout]    aErrorFdSet     A reference to fd_set for polling error.
+     * @param[inout]    aMaxFd          A reference to the current max fd.
+     *
+     */
+    virtual void UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd);
+
+    /**
+     * This method delivers the received packets that are due.
+     *
+     * @param[in]   aReadFdSet          A reference to fd_set ready for reading.
+     * @param[in]   aWriteFdSet         A reference to fd_set ready for writing.
+     * @param[in]   aErrorFdSet         A reference to fd_set with error occurred.
+     *
+     */
+    virtual void Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet);
+
+    /**
+     * This method retrieves the Eui64.
+     *
+     * @returns The hardware address.
+     *
+     */
+    virtual const uint8_t *GetEui64(void) { return kEui64; }
+
+    /**
+     * This method request the event.
+     *
+     * The event is emitted before this method returns.
+     *
+     * @param[in]   aEvent              The event id to request.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully requested the event.
+     * @retval  OTBR_ERROR_ERRNO        Failed to request the event.
+     *
+     */
+    virtual otbrError RequestEvent(int aEvent);
+
+    /**
+     * This method requests the events of all the cached properties at once.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully requested all the events.
+     *
+     */
+    virtual otbrError RequestEvents(void);
+
+    /**
+     * This method returns the cached PSKc.
+     *
+     */
+    virtual const uint8_t *GetPSKc(void) const { return kPSKc; }
+
+    /**
+     * This method returns the cached network name.
+     *
+     */
+    virtual const char *GetNetworkName(void) const { return kNetworkName; }
+
+    /**
+     * This method returns the cached extended PAN ID.
+     *
+     */
+    virtual const uint8_t *GetExtPanId(void) const { return kExtPanId; }
+
+    /**
+     * This method returns the cached Thread state, which is always associated.
+     *
+     * @param[out]  aAssociated     Whether the NCP is associated to the Thread network.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully returned the Thread state.
+     *
+     */
+    virtual otbrError GetThreadState(bool &aAssociated) const
+    {
+        aAssociated = true;
+        return OTBR_ERROR_NONE;
+    }
+
+private:
+    enum
+    {
+        kMaxPending          = 64,    ///< Max number of received packets not yet delivered.
+        kMaxPacket           = 1280,  ///< Max size of a TMF packet.
+        kCommissionerTimeout = 50000, ///< Time in milliseconds the leader keeps a commissioner without keep-alive.
+    };
+
+    /**
+     * This structure is a received packet waiting for its delivery.
+     *
+     */
+    enum
+    {
+        kDefaultRouters = 3,  ///< Default number of routers.
+        kMaxRouters     = 63, ///< Max number of routers of a Thread network.
+    };
+
+    struct Packet
+    {
+        uint64_t mDueTime; ///< Time in microseconds the packet is delivered at.
+        uint16_t mLength;  ///< Number of bytes in mBuffer.
+        uint16_t mLocator; ///< The RLOC16 of the peer.
+        uint16_t mPort;    ///< The UDP port of the peer.
+        uint8_t  mBuffer[kMaxPacket];
+    };
+
+    static const uint8_t kEui64[kSizeEui64];
+    static const uint8_t kPSKc[kSizePSKc];
+    static const uint8_t kExtPanId[kSizeExtPanId];
+    static const char    kNetworkName[];
+    static const uint8_t kNetworkData[];
+
+    otbrError ParseParameters(void);
+
+    static ssize_t Receive(const uint8_t *aBuffer,
+                           uint16_t       aLength,
+                           const uint8_t *aIp6,
+                           uint16_t       aPort,
+                           void *         aContext);
+    void           Receive(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort);
+    void           Deliver(void);
+    void           UpdateTimer(void);
+
+    static void HandleReactor(void *aContext, int aFd, unsigned int aEvents);
+
+    static void HandleLeaderPetition(const Coap::Resource &aResource,
+                                     const Coap::Message & aRequest,
+                                     Coap::Message &       aResponse,
+                                     const uint8_t *       aIp6,
+                                     uint16_t              aPort,
+                                     void *                aContext);
+    void        HandleLeaderPetition(const Coap::Message &aRequest, Coap::Message &aResponse);
+    static void HandleLeaderKeepAlive(const Coap::Resource &aResource,
+                                      const Coap::Message & aRequest,
+                                      Coap::Message &       aResponse,
+                                      const uint8_t *       aIp6,
+                                      uint16_t              aPort,
+                                      void *                aContext);
+    void        HandleLeaderKeepAlive(const Coap::Message &aRequest, Coap::Message &aResponse);
+    static void HandleManagementSet(const Coap::Resource &aResource,
+                                    const Coap::Message & aRequest,
+                                    Coap::Message &       aResponse,
+                                    const uint8_t *       aIp6,
+                                    uint16_t              aPort,
+                                    void *                aContext);
+    void        HandleManagementSet(const Coap::Message &aRequest, Coap::Message &aResponse);
+    static void HandleManagementGet(const Coap::Resource &aResource,
+                                    const Coap::Message & aRequest,
+                                    Coap::Message &       aResponse,
+                                    const uint8_t *       aIp6,
+                                    uint16_t              aPort,
+                                    void *                aContext);
+    static void HandleRelayTransmit(const Coap::Resource &aResource,
+                                    const Coap::Message & aRequest,
+                                    Coap::Message &       aResponse,
+                                    const uint8_t *       aIp6,
+                                    uint16_t              aPort,
+                                    void *                aContext);
+    void        HandleRelayTransmit(const Coap::Message &aRequest, const uint8_t *aIp6, uint16_t aPort);
+    static void HandleDiagnosticGet(const Coap::Resource &aResource,
+                                    const Coap::Message & aRequest,
+                                    Coap::Message &       aResponse,
+                                    const uint8_t *       aIp6,
+                                    uint16_t              aPort,
+                                    void *                aContext);
+    void        HandleDiagnosticGet(const Coap::Message &aRequest, Coap::Message &aResponse);
+    static void HandleDiagnosticQuery(const Coap::Resource &aResource,
+                                      const Coap::Message & aRequest,
+                                      Coap::Message &       aResponse,
+                                      const uint8_t *       aIp6,
+                                      uint16_t              aPort,
+                                      void *                aContext);
+    void        HandleDiagnosticQuery(const Coap::Message &aRequest, const uint8_t *aIp6, uint16_t aPort);
+    uint16_t    WriteDiagnostic(const Coap::Message &aRequest, uint8_t aRouterId, uint8_t *aBuffer, uint16_t aLength);
+
+    bool IsSessionActive(uint16_t aSessionId) const;
+
+    const char *   mParameters;
+    Reactor *      mReactor;
+    Reactor::Watch mWatch;
+    int            mTimerFd;
+    Coap::Agent *  mLeader;
+    Coap::Resource mLeaderPetition;
+    Coap::Resource mLeaderKeepAlive;
+    Coap::Resource mCommissionerSet;
+    Coap::Resource mActiveSet;
+    Coap::Resource mPendingSet;
+    Coap::Resource mActiveGet;
+    Coap::Resource mPendingGet;
+    Coap::Resource mRelayTransmit;
+    Coap::Resource mDiagnosticGet;
+    Coap::Resource mDiagnosticQuery;
+
+    unsigned int mLatency;  ///< Latency of received packets in milliseconds.
+    unsigned int mLoss;     ///< Percentage of received packets lost.
+    unsigned int mLossSeed; ///< Seed of the losses.
+    unsigned int mRouters;  ///< Number of routers, with router ids from 0, the leader being router 0.
+
+    bool     mTmfProxyEnabled;          ///< Whether the TMF proxy is started.
+    uint32_t mTmfProxyDropped;          ///< Packets dropped for too many not yet delivered.
+    uint32_t mTmfProxyLost;             ///< Packets lost at the configured rate.
+    Packet   mPending[kMaxPending];     ///< Ring of received packets not yet delivered.
+    unsigned mPendingHead;              ///< Index of the oldest packet in mPending.
+    unsigned mPendingCount;             ///< Number of packets in mPending.
+    uint16_t mCommissionerSessionId;    ///< Session id of the active commissioner, 0 if none.
+    uint16_t mLastCommissionerSessionId; ///< The last commissioner session id assigned.
+    uint64_t mCommissionerKeepAlive;    ///< Time in milliseconds the active commissioner was last kept alive.
+};
+
+} // namespace Ncp
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // NCP_SIM_HPP_
@@ -0,0 +1,790 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements NCP service talking Spinel directly.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_NCP
+
+#include "ncp_spinel.hpp"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+extern "C" {
+#include "spinel.h"
+}
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/probes.hpp"
+#include "common/time.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Ncp {
+
+/**
+ * This struct maps a Spinel property to the event raised when it changes.
+ *
+ */
+struct SpinelPropertyEvent
+{
+    int          mEvent;    ///< The event.
+    unsigned int mProperty; ///< The Spinel property.
+};
+
+static const SpinelPropertyEvent kSpinelPropertyEvents[] = {
+    {kEventExtPanId, SPINEL_PROP_NET_XPANID},
+    {kEventNetworkName, SPINEL_PROP_NET_NETWORK_NAME},
+    {kEventPSKc, SPINEL_PROP_NET_PSKC},
+    {kEventThreadState, SPINEL_PROP_NET_ROLE},
+    {kEventNetworkData, SPINEL_PROP_THREAD_NETWORK_DATA},
+};
+
+/**
+ * This function encodes an unsigned integer in the packed format of Spinel.
+ *
+ * @returns Number of bytes encoded.
+ *
+ */
+static uint16_t EncodePackedUint(unsigned int aValue, uint8_t *aBuffer)
+{
+    uint16_t length = 0;
+
+    while (aValue >= 0x80)
+    {
+        aBuffer[length++] = static_cast<uint8_t>((aValue & 0x7f) | 0x80);
+        aValue >>= 7;
+    }
+
+    aBuffer[length++] = static_cast<uint8_t>(aValue);
+
+    return length;
+}
+
+/**
+ * This function decodes an unsigned integer in the packed format of Spinel.
+ *
+ * @returns Number of bytes decoded, 0 if the encoding is truncated or too long.
+ *
+ */
+static uint16_t DecodePackedUint(const uint8_t *aBuffer, uint16_t aLength, unsigned int &aValue)
+{
+    uint16_t length = 0;
+
+    aValue = 0;
+
+    // No value of Spinel takes more than 4 bytes.
+    while (length < aLength && length < 4)
+    {
+        uint8_t byte = aBuffer[length];
+
+        aValue |= static_cast<unsigned int>(byte & 0x7f) << (7 * length);
+        ++length;
+
+        if ((byte & 0x80) == 0)
+        {
+            ExitNow();
+        }
+    }
+
+    length = 0;
+
+exit:
+    return length;
+}
+
+static uint16_t ReadUint16(const uint8_t *aBuffer)
+{
+    // Integers of Spinel are little endian.
+    return static_cast<uint16_t>(aBuffer[0] | (aBuffer[1] << 8));
+}
+
+static void WriteUint16(uint16_t aValue, uint8_t *aBuffer)
+{
+    aBuffer[0] = static_cast<uint8_t>(aValue & 0xff);
+    aBuffer[1] = static_cast<uint8_t>(aValue >> 8);
+}
+
+ControllerSpinel::ControllerSpinel(const char *aDevice, Reactor *aReactor)
+    : mDevice(aDevice)
+    , mFd(-1)
+    , mReactor(aReactor)
+    , mDecoder(HandleFrame, this)
+    , mTid(0)
+    , mWaitingTid(0)
+    , mWaitingStatus(SPINEL_STATUS_OK)
+    , mTxLength(0)
+    , mReading(false)
+    , mHasEui64(false)
+    , mTmfProxyEnabled(false)
+    , mTmfProxyDropped(0)
+    , mTmfProxyFailed(0)
+    , mThreadAssociated(false)
+    , mThreadRole(kThreadRoleDetached)
+    , mCachedEvents(0)
+{
+    mNetworkName[0] = '\0';
+}
+
+ControllerSpinel::~ControllerSpinel(void)
+{
+    if (mFd >= 0)
+    {
+        if (mReactor != NULL && mWatch.mFd >= 0)
+        {
+            mReactor->Remove(mWatch);
+        }
+
+        close(mFd);
+        mFd = -1;
+    }
+}
+
+otbrError ControllerSpinel::Init(void)
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+
+    VerifyOrExit((mFd = open(mDevice, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC)) >= 0);
+
+    // Pseudo terminals of SPI adapters and simulated NCPs need no line settings.
+    if (isatty(mFd))
+    {
+        struct termios tios;
+
+        VerifyOrExit(tcgetattr(mFd, &tios) == 0);
+        cfmakeraw(&tios);
+        tios.c_cflag |= (CLOCAL | CREAD);
+        VerifyOrExit(cfsetspeed(&tios, B115200) == 0);
+        VerifyOrExit(tcsetattr(mFd, TCSANOW, &tios) == 0);
+        tcflush(mFd, TCIOFLUSH);
+    }
+
+    if (mReactor != NULL)
+    {
+        SuccessOrExit(mReactor->Add(mWatch, mFd, Reactor::kEventReadable, HandleReactor, this, "spinel"));
+    }
+
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    if (ret != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "NCP failed to open %s: %s!", mDevice, strerror(errno));
+
+        if (mFd >= 0)
+        {
+            close(mFd);
+            mFd = -1;
+        }
+    }
+
+    return ret;
+}
+
+uint8_t ControllerSpinel::NextTid(void)
+{
+    // Transaction id 0 is for frames no response is waited for.
+    mTid = SPINEL_GET_NEXT_TID(mTid);
+
+    return mTid;
+}
+
+otbrError ControllerSpinel::SendCommand(unsigned int   aCommand,
+                                        unsigned int   aProperty,
+                                        const uint8_t *aValue,
+                                        uint16_t       aLength,
+                                        uint8_t        aTid)
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+    uint8_t   frame[kMaxSpinelFrame];
+    uint16_t  length = 0;
+    uint16_t  size   = static_cast<uint16_t>(sizeof(mTxBuffer) - mTxLength);
+
+    VerifyOrExit(mFd >= 0, errno = ENOTCONN);
+    VerifyOrExit(aLength <= sizeof(frame) - 8, errno = EMSGSIZE);
+
+    frame[length++] = SPINEL_HEADER_FLAG | SPINEL_HEADER_IID_0 | aTid;
+    length += EncodePackedUint(aCommand, frame + length);
+    length += EncodePackedUint(aProperty, frame + length);
+    if (aLength > 0)
+    {
+        memcpy(frame + length, aValue, aLength);
+        length += aLength;
+    }
+
+    SuccessOrExit(ret = Hdlc::Encode(frame, length, mTxBuffer + mTxLength, size));
+    mTxLength += size;
+
+    Flush();
+
+exit:
+    return ret;
+}
+
+void ControllerSpinel::Flush(void)
+{
+    uint16_t written = 0;
+
+    while (written < mTxLength)
+    {
+        ssize_t rval = write(mFd, mTxBuffer + written, mTxLength - written);
+
+        if (rval <= 0)
+        {
+            if (rval < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                otbrLog(OTBR_LOG_ERR, "NCP failed to write: %s!", strerror(errno));
+                written = mTxLength;
+            }
+
+            break;
+        }
+
+        written += static_cast<uint16_t>(rval);
+    }
+
+    memmove(mTxBuffer, mTxBuffer + written, mTxLength - written);
+    mTxLength -= written;
+
+    UpdateWatch();
+}
+
+void ControllerSpinel::UpdateWatch(void)
+{
+    unsigned int events = Reactor::kEventReadable;
+
+    VerifyOrExit(mReactor != NULL && mWatch.mFd >= 0);
+
+    // The serial port is only polled for writing while encoded frames are pending.
+    if (mTxLength > 0)
+    {
+        events |= Reactor::kEventWritable;
+    }
+
+    if (mWatch.mEvents != events)
+    {
+        mReactor->Modify(mWatch, events);
+    }
+
+exit:
+    return;
+}
+
+void ControllerSpinel::Read(void)
+{
+    uint8_t buffer[kRxChunkSize];
+    ssize_t rval;
+
+    mReading = true;
+
+    while ((rval = read(mFd, buffer, sizeof(buffer))) > 0)
+    {
+        mDecoder.Decode(buffer, static_cast<uint16_t>(rval));
+    }
+
+    mReading = false;
+
+    if (rval == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+    {
+        otbrLog(OTBR_LOG_ERR, "NCP failed to read: %s!", rval == 0 ? "end of file" : strerror(errno));
+    }
+}
+
+void ControllerSpinel::HandleReactor(void *aContext, int aFd, unsigned int aEvents)
+{
+    ControllerSpinel *controller = static_cast<ControllerSpinel *>(aContext);
+
+    if (aEvents & (Reactor::kEventReadable | Reactor::kEventError))
+    {
+        controller->Read();
+    }
+
+    if (aEvents & Reactor::kEventWritable)
+    {
+        controller->Flush();
+    }
+
+    (void)aFd;
+}
+
+void ControllerSpinel::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd)
+{
+    VerifyOrExit(mReactor == NULL && mFd >= 0);
+
+    FD_SET(mFd, &aReadFdSet);
+    FD_SET(mFd, &aErrorFdSet);
+
+    if (mTxLength > 0)
+    {
+        FD_SET(mFd, &aWriteFdSet);
+    }
+
+    if (mFd > aMaxFd)
+    {
+        aMaxFd = mFd;
+    }
+
+exit:
+    return;
+}
+
+void ControllerSpinel::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
+{
+    VerifyOrExit(mReactor == NULL && mFd >= 0);
+
+    if (FD_ISSET(mFd, &aReadFdSet) || FD_ISSET(mFd, &aErrorFdSet))
+    {
+        Read();
+    }
+
+    if (FD_ISSET(mFd, &aWriteFdSet))
+    {
+        Flush();
+    }
+
+exit:
+    return;
+}
+
+otbrError ControllerSpinel::WaitForResponse(uint8_t aTid)
+{
+    otbrError ret      = OTBR_ERROR_ERRNO;
+    uint64_t  deadline = GetMonotonicNow() + kResponseTimeout;
+
+    mWaitingTid = aTid;
+
+    // Other frames arriving meanwhile are handled as usual.
+    while (mWaitingTid != 0)
+    {
+        uint64_t      now = GetMonotonicNow();
+        struct pollfd pfd;
+
+        VerifyOrExit(now < deadline, errno = ETIMEDOUT);
+
+        pfd.fd      = mFd;
+        pfd.events  = POLLIN | (mTxLength > 0 ? POLLOUT : 0);
+        pfd.revents = 0;
+
+        if (poll(&pfd, 1, static_cast<int>(deadline - now)) < 0)
+        {
+            VerifyOrExit(errno == EINTR);
+            continue;
+        }
+
+        if (pfd.revents & POLLOUT)
+        {
+            Flush();
+        }
+
+        if (pfd.revents & (POLLIN | POLLERR | POLLHUP))
+        {
+            Read();
+        }
+    }
+
+    VerifyOrExit(mWaitingStatus == SPINEL_STATUS_OK, errno = EREMOTEIO);
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    if (ret != OTBR_ERROR_NONE)
+    {
+        mWaitingTid = 0;
+    }
+
+    return ret;
+}
+
+otbrError ControllerSpinel::Request(unsigned int   aCommand,
+                                    unsigned int   aProperty,
+                                    const uint8_t *aValue,
+                                    uint16_t       aLength)
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+    uint8_t   tid = NextTid();
+
+    // Frames are decoded in place, waiting from within a frame handler would overwrite the frame being handled.
+    VerifyOrExit(mWaitingTid == 0 && !mReading, errno = EBUSY);
+    SuccessOrExit(ret = SendCommand(aCommand, aProperty, aValue, aLength, tid));
+    ret = WaitForResponse(tid);
+
+exit:
+    if (ret != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "NCP failed to access property %u: %s", aProperty, strerror(errno));
+    }
+
+    return ret;
+}
+
+void ControllerSpinel::HandleFrame(const uint8_t *aFrame, uint16_t aLength, void *aContext)
+{
+    static_cast<ControllerSpinel *>(aContext)->HandleFrame(aFrame, aLength);
+}
+
+void ControllerSpinel::HandleFrame(const uint8_t *aFrame, uint16_t aLength)
+{
+    unsigned int command  = 0;
+    unsigned int property = 0;
+    uint16_t     offset   = 1;
+    uint16_t     length   = 0;
+    uint8_t      tid      = 0;
+    bool         waited   = false;
+
+    VerifyOrExit(aLength > 0 && (aFrame[0] & SPINEL_HEADER_FLAG) && SPINEL_HEADER_GET_IID(aFrame[0]) == 0);
+    tid = SPINEL_HEADER_GET_TID(aFrame[0]);
+
+    VerifyOrExit((length = DecodePackedUint(aFrame + offset, aLength - offset, command)) > 0);
+    offset += length;
+    VerifyOrExit((length = DecodePackedUint(aFrame + offset, aLength - offset, property)) > 0);
+    offset += length;
+
+    VerifyOrExit(command == SPINEL_CMD_PROP_VALUE_IS,
+                 otbrLog(OTBR_LOG_DEBUG, "NCP command %u of property %u ignored", command, property));
+
+    if (tid != 0 && tid == mWaitingTid)
+    {
+        waited         = true;
+        mWaitingTid    = 0;
+        mWaitingStatus = SPINEL_STATUS_OK;
+    }
+
+    if (property == SPINEL_PROP_LAST_STATUS)
+    {
+        unsigned int status = SPINEL_STATUS_OK;
+
+        VerifyOrExit(DecodePackedUint(aFrame + offset, aLength - offset, status) > 0);
+
+        if (waited)
+        {
+            mWaitingStatus = status;
+        }
+        else if (tid == 0)
+        {
+            HandleLastStatus(status);
+        }
+        else if (status != SPINEL_STATUS_OK)
+        {
+            otbrLog(OTBR_LOG_WARNING, "NCP status %u of transaction %u", status, tid);
+        }
+    }
+    else
+    {
+        HandleValueIs(property, aFrame + offset, aLength - offset);
+    }
+
+exit:
+    return;
+}
+
+void ControllerSpinel::HandleLastStatus(unsigned int aStatus)
+{
+    if (aStatus >= SPINEL_STATUS_RESET__BEGIN && aStatus <= SPINEL_STATUS_RESET__END)
+    {
+        otbrLog(OTBR_LOG_WARNING, "NCP reset for %u.", aStatus);
+
+        // The properties may have changed and the TMF proxy is disabled by the reset.
+        mCachedEvents = 0;
+        RequestEvents();
+
+        if (mTmfProxyEnabled)
+        {
+            uint8_t enabled = 1;
+            SendCommand(SPINEL_CMD_PROP_VALUE_SET, SPINEL_PROP_THREAD_TMF_PROXY_ENABLED, &enabled, sizeof(enabled),
+                        NextTid());
+        }
+    }
+    else if (aStatus != SPINEL_STATUS_OK)
+    {
+        // Only TMF proxy packets are sent without waiting for the status.
+        ++mTmfProxyFailed;
+        otbrLog(OTBR_LOG_DEBUG, "NCP status %u", aStatus);
+    }
+}
+
+void ControllerSpinel::HandleValueIs(unsigned int aProperty, const uint8_t *aValue, uint16_t aLength)
+{
+    switch (aProperty)
+    {
+    case SPINEL_PROP_THREAD_TMF_PROXY_STREAM:
+    {
+        uint16_t length = 0;
+
+        // The packet with its length, the locator and the port.
+        VerifyOrExit(aLength >= sizeof(uint16_t));
+        length = ReadUint16(aValue);
+        VerifyOrExit(aLength >= sizeof(uint16_t) + length + sizeof(uint16_t) * 2);
+
+        TmfProxyStreamEvent event = {aValue + sizeof(uint16_t), length, ReadUint16(aValue + sizeof(uint16_t) + length),
+                                     ReadUint16(aValue + sizeof(uint16_t) * 2 + length)};
+        OTBR_PROBE3(ncp_tmf_receive, event.mLength, event.mLocator, event.mPort);
+        EmitPayload(event);
+        break;
+    }
+
+    case SPINEL_PROP_HWADDR:
+        VerifyOrExit(aLength >= sizeof(mEui64));
+        memcpy(mEui64, aValue, sizeof(mEui64));
+        mHasEui64 = true;
+        break;
+
+    case SPINEL_PROP_NET_ROLE:
+        VerifyOrExit(aLength >= 1);
+        mThreadAssociated = (aValue[0] != SPINEL_NET_ROLE_DETACHED);
+        mThreadRole       = kThreadRoleUnknown;
+        mCachedEvents |= (1U << kEventThreadState);
+
+        // Spinel roles are numbered as ThreadRole.
+        if (aValue[0] <= SPINEL_NET_ROLE_LEADER)
+        {
+            mThreadRole = static_cast<ThreadRole>(aValue[0]);
+        }
+
+        otbrLog(OTBR_LOG_INFO, "role %u", aValue[0]);
+        {
+            ThreadStateEvent event = {mThreadAssociated, mThreadRole};
+            EmitPayload(event);
+        }
+        break;
+
+    case SPINEL_PROP_NET_NETWORK_NAME:
+    {
+        // The name is null-terminated UTF-8.
+        uint16_t length = static_cast<uint16_t>(strnlen(reinterpret_cast<const char *>(aValue), aLength));
+
+        VerifyOrExit(length < aLength && length <= kSizeNetworkName);
+        memcpy(mNetworkName, aValue, length + 1);
+        mCachedEvents |= (1U << kEventNetworkName);
+
+        otbrLog(OTBR_LOG_INFO, "network name %s...", mNetworkName);
+        NetworkNameEvent event = {mNetworkName};
+        EmitPayload(event);
+        break;
+    }
+
+    case SPINEL_PROP_NET_XPANID:
+        VerifyOrExit(aLength >= sizeof(mExtPanId));
+        memcpy(mExtPanId, aValue, sizeof(mExtPanId));
+        mCachedEvents |= (1U << kEventExtPanId);
+
+        {
+            ExtPanIdEvent event = {mExtPanId};
+            EmitPayload(event);
+        }
+        break;
+
+    case SPINEL_PROP_NET_PSKC:
+        VerifyOrExit(aLength >= sizeof(mPSKc));
+        memcpy(mPSKc, aValue, sizeof(mPSKc));
+        mCachedEvents |= (1U << kEventPSKc);
+
+        {
+            PSKcEvent event = {mPSKc};
+            EmitPayload(event);
+        }
+        break;
+
+    case SPINEL_PROP_THREAD_NETWORK_DATA:
+        // The TLVs are the rest of the frame, emitted in place.
+        VerifyOrExit(aLength <= kSizeNetworkData);
+
+        {
+            NetworkDataEvent event = {aValue, aLength};
+            EmitPayload(event);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+exit:
+    return;
+}
+
+otbrError ControllerSpinel::TmfProxyStart(void)
+{
+    uint8_t   enabled = 1;
+    otbrError ret =
+        Request(SPINEL_CMD_PROP_VALUE_SET, SPINEL_PROP_THREAD_TMF_PROXY_ENABLED, &enabled, sizeof(enabled));
+
+    if (ret == OTBR_ERROR_NONE)
+    {
+        mTmfProxyEnabled = true;
+    }
+
+    return ret;
+}
+
+otbrError ControllerSpinel::TmfProxyStop(void)
+{
+    uint8_t enabled = 0;
+
+    mTmfProxyEnabled = false;
+
+    return mFd < 0 ? OTBR_ERROR_NONE
+                   : Request(SPINEL_CMD_PROP_VALUE_SET, SPINEL_PROP_THREAD_TMF_PROXY_ENABLED, &enabled,
+                             sizeof(enabled));
+}
+
+otbrError ControllerSpinel::TmfProxySend(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort)
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+    uint8_t   value[kMaxSpinelFrame];
+    uint16_t  length = 0;
+
+    VerifyOrExit(aLength <= sizeof(value) - sizeof(uint16_t) * 3 - 8, errno = EMSGSIZE);
+    OTBR_PROBE3(ncp_tmf_send, aLength, aLocator, aPort);
+
+    WriteUint16(aLength, value);
+    length += sizeof(uint16_t);
+    memcpy(value + length, aBuffer, aLength);
+    length += aLength;
+    WriteUint16(aLocator, value + length);
+    length += sizeof(uint16_t);
+    WriteUint16(aPort, value + length);
+    length += sizeof(uint16_t);
+
+    // No response is waited for, failures are reported by the status of transaction id 0.
+    ret = SendCommand(SPINEL_CMD_PROP_VALUE_SET, SPINEL_PROP_THREAD_TMF_PROXY_STREAM, value, length, 0);
+
+exit:
+    if (ret != OTBR_ERROR_NONE && errno == ENOBUFS)
+    {
+        ++mTmfProxyDropped;
+    }
+
+    return ret;
+}
+
+const uint8_t *ControllerSpinel::GetEui64(void)
+{
+    const uint8_t *ret = NULL;
+
+    if (!mHasEui64)
+    {
+        SuccessOrExit(Request(SPINEL_CMD_PROP_VALUE_GET, SPINEL_PROP_HWADDR, NULL, 0));
+        VerifyOrExit(mHasEui64, errno = ENOENT);
+    }
+
+    ret = mEui64;
+
+exit:
+    return ret;
+}
+
+otbrError ControllerSpinel::RequestEvent(int aEvent)
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+
+    for (size_t i = 0; i < sizeof(kSpinelPropertyEvents) / sizeof(kSpinelPropertyEvents[0]); ++i)
+    {
+        if (kSpinelPropertyEvents[i].mEvent == aEvent)
+        {
+            ExitNow(ret = Request(SPINEL_CMD_PROP_VALUE_GET, kSpinelPropertyEvents[i].mProperty, NULL, 0));
+        }
+    }
+
+    otbrLog(OTBR_LOG_WARNING, "Unknown event %d", aEvent);
+    errno = EINVAL;
+
+exit:
+    return ret;
+}
+
+otbrError ControllerSpinel::RequestEvents(void)
+{
+    otbrError ret = OTBR_ERROR_NONE;
+
+    // All requests are sent before any response is handled, responses arrive as value updates.
+    for (size_t i = 0; i < sizeof(kSpinelPropertyEvents) / sizeof(kSpinelPropertyEvents[0]); ++i)
+    {
+        if (SendCommand(SPINEL_CMD_PROP_VALUE_GET, kSpinelPropertyEvents[i].mProperty, NULL, 0, NextTid()) !=
+            OTBR_ERROR_NONE)
+        {
+            ret = OTBR_ERROR_ERRNO;
+        }
+    }
+
+    return ret;
+}
+
+bool ControllerSpinel::IsCached(int aEvent) const
+{
+    bool cached = (mCachedEvents & (1U << aEvent)) != 0;
+
+    if (!cached)
+    {
+        errno = ENOENT;
+    }
+
+    return cached;
+}
+
+const uint8_t *ControllerSpinel::GetPSKc(void) const
+{
+    return IsCached(kEventPSKc) ? mPSKc : NULL;
+}
+
+const char *ControllerSpinel::GetNetworkName(void) const
+{
+    return IsCached(kEventNetworkName) ? mNetworkName : NULL;
+}
+
+const uint8_t *ControllerSpinel::GetExtPanId(void) const
+{
+    return IsCached(kEventExtPanId) ? mExtPanId : NULL;
+}
+
+otbrError ControllerSpinel::GetThreadState(bool &aAssociated) const
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+
+    VerifyOrExit(IsCached(kEventThreadState));
+    aAssociated = mThreadAssociated;
+    ret         = OTBR_ERROR_NONE;
+
+exit:
+    return ret;
+}
+
+} // namespace Ncp
+
+} // namespace BorderRouter
+
+} // namespace ot
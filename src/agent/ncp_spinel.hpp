@@ -0,0 +1,269 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for NCP service talking Spinel directly.
+ */
+
+#ifndef NCP_SPINEL_HPP_
+#define NCP_SPINEL_HPP_
+
+#include <stdint.h>
+#include <sys/select.h>
+
+#include "hdlc.hpp"
+#include "ncp.hpp"
+#include "common/reactor.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Ncp {
+
+/**
+ * This class provides NCP service by talking Spinel in HDLC-lite frames over the serial port of the NCP.
+ *
+ * No wpantund is needed, and TMF packets are exchanged with the NCP without any IPC hop.
+ *
+ */
+class ControllerSpinel : public Controller
+{
+public:
+    /**
+     * The contructor to initialize a Ncp Controller.
+     *
+     * @param[in]   aDevice         The path of the serial device of the NCP.
+     * @param[in]   aReactor        A pointer to the reactor, NULL to use the fd_set interface.
+     *
+     */
+    ControllerSpinel(const char *aDevice, Reactor *aReactor);
+    ~ControllerSpinel(void);
+
+    /**
+     * This method initalize the NCP controller.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully initialized NCP controller.
+     * @retval  OTBR_ERROR_ERRNO    Failed to open the serial device.
+     *
+     */
+    virtual otbrError Init(void);
+
+    /**
+     * This method request the Ncp to start the TMF proxy service.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully started TMF proxy.
+     * @retval  OTBR_ERROR_ERRNO        Failed to start, error info in errno.
+     *
+     */
+    virtual otbrError TmfProxyStart(void);
+
+    /**
+     * This method request the Ncp to stop the TMF proxy service.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully stopped TMF proxy.
+     * @retval  OTBR_ERROR_ERRNO        Failed to stop, error info in errno.
+     *
+     */
+    virtual otbrError TmfProxyStop(void);
+
+    /**
+     * This method sends a packet through TMF proxy service.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully sent the packet.
+     * @retval  OTBR_ERROR_ERRNO        Failed to send the packet, errno is set to ENOBUFS if the serial port is
+     *                                  congested.
+     *
+     */
+    virtual otbrError TmfProxySend(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort);
+
+    /**
+     * This method returns the counters of the TMF proxy service.
+     *
+     * @param[out]  aDropped    The number of packets dropped for the serial port is congested.
+     * @param[out]  aFailed     The number of packets rejected by the NCP.
+     *
+     */
+    virtual void GetTmfProxyCounters(uint32_t &aDropped, uint32_t &aFailed) const
+    {
+        aDropped = mTmfProxyDropped;
+        aFailed  = mTmfProxyFailed;
+    }
+
+    /**
+     * This method updates the fd_set to poll.
+     *
+     * Nothing is added when a reactor is used.
+     *
+     * @param[inout]    aReadFdSet      A reference to fd_set for polling read.
+     * @param[inout]    aWriteFdSet     A reference to fd_set for polling read.
+     * @param[inout]    aErrorFdSet     A reference to fd_set for polling error.
+     * @param[inout]    aMaxFd          A reference to the current max fd.
+     *
+     */
+    virtual void UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd);
+
+    /**
+     * This method performs the Spinel processing.
+     *
+     * @param[in]   aReadFdSet          A reference to fd_set ready for reading.
+     * @param[in]   aWriteFdSet         A reference to fd_set ready for writing.
+     * @param[in]   aErrorFdSet         A reference to fd_set with error occurred.
+     *
+     */
+    virtual void Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet);
+
+    /**
+     * This method retrieves the Eui64.
+     *
+     * @returns The hardware address.
+     *
+     * @retval  NULL    Failed to get EUI64, error code set in errno.
+     *
+     */
+    virtual const uint8_t *GetEui64(void);
+
+    /**
+     * This method request the event.
+     *
+     * @param[in]   aEvent              The event id to request.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully requested the event.
+     * @retval  OTBR_ERROR_ERRNO        Failed to request the event.
+     *
+     */
+    virtual otbrError RequestEvent(int aEvent);
+
+    /**
+     * This method requests the events of all the cached properties at once.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully sent all the requests.
+     * @retval  OTBR_ERROR_ERRNO        Failed to send some of the requests.
+     *
+     */
+    virtual otbrError RequestEvents(void);
+
+    /**
+     * This method returns the cached PSKc.
+     *
+     * @retval  NULL    The PSKc is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual const uint8_t *GetPSKc(void) const;
+
+    /**
+     * This method returns the cached network name.
+     *
+     * @retval  NULL    The network name is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual const char *GetNetworkName(void) const;
+
+    /**
+     * This method returns the cached extended PAN ID.
+     *
+     * @retval  NULL    The extended PAN ID is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual const uint8_t *GetExtPanId(void) const;
+
+    /**
+     * This method returns the cached Thread state.
+     *
+     * @param[out]  aAssociated     Whether the NCP is associated to the Thread network.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully returned the Thread state.
+     * @retval  OTBR_ERROR_ERRNO        The Thread state is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual otbrError GetThreadState(bool &aAssociated) const;
+
+private:
+    enum
+    {
+        kMaxSpinelFrame  = 1300, ///< Max size of a Spinel frame, a TMF proxy packet with its headers.
+        kTxBufferSize    = 4096, ///< Size of the buffer of encoded frames not yet written to the serial port.
+        kRxChunkSize     = 512,  ///< Number of bytes read from the serial port at once.
+        kResponseTimeout = 2000, ///< Time in milliseconds to wait for the NCP to respond.
+        kNumCachedEvents = 5,    ///< Number of events of cached properties, those below kEventTmfProxyStream.
+    };
+
+    static void HandleFrame(const uint8_t *aFrame, uint16_t aLength, void *aContext);
+    void        HandleFrame(const uint8_t *aFrame, uint16_t aLength);
+    void        HandleValueIs(unsigned int aProperty, const uint8_t *aValue, uint16_t aLength);
+    void        HandleLastStatus(unsigned int aStatus);
+
+    otbrError SendCommand(unsigned int   aCommand,
+                          unsigned int   aProperty,
+                          const uint8_t *aValue,
+                          uint16_t       aLength,
+                          uint8_t        aTid);
+    otbrError Request(unsigned int aCommand, unsigned int aProperty, const uint8_t *aValue, uint16_t aLength);
+    otbrError WaitForResponse(uint8_t aTid);
+    uint8_t   NextTid(void);
+
+    static void HandleReactor(void *aContext, int aFd, unsigned int aEvents);
+    void        Read(void);
+    void        Flush(void);
+    void        UpdateWatch(void);
+    bool        IsCached(int aEvent) const;
+
+    const char *   mDevice;
+    int            mFd;
+    Reactor *      mReactor;
+    Reactor::Watch mWatch;
+    Hdlc::Decoder  mDecoder;
+
+    uint8_t      mTid;                     ///< The last transaction id used.
+    uint8_t      mWaitingTid;              ///< The transaction id being waited for, 0 if none.
+    unsigned int mWaitingStatus;           ///< The status of the transaction waited for.
+    uint16_t     mTxLength;                ///< Number of bytes in mTxBuffer.
+    uint8_t      mTxBuffer[kTxBufferSize]; ///< Encoded frames not yet written.
+    bool         mReading;                 ///< Whether frames are being decoded.
+
+    uint8_t      mEui64[kSizeEui64];                 ///< The hardware address.
+    bool         mHasEui64;                          ///< Whether the hardware address is known.
+    bool         mTmfProxyEnabled;                   ///< Whether the TMF proxy is started.
+    uint32_t     mTmfProxyDropped;                   ///< Packets dropped for the serial port is congested.
+    uint32_t     mTmfProxyFailed;                    ///< Packets rejected by the NCP.
+    uint8_t      mPSKc[kSizePSKc];                   ///< The cached PSKc.
+    char         mNetworkName[kSizeNetworkName + 1]; ///< The cached network name.
+    uint8_t      mExtPanId[kSizeExtPanId];           ///< The cached extended PAN ID.
+    bool         mThreadAssociated;                  ///< The cached Thread state.
+    ThreadRole   mThreadRole;                        ///< The cached Thread role.
+    unsigned int mCachedEvents;                      ///< Bit mask of the events whose property is cached.
+};
+
+} // namespace Ncp
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // NCP_SPINEL_HPP_
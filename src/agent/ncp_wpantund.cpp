@@ -26,24 +26,32 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include "ncp_wpantund.hpp"
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_NCP
 
-#include <vector>
+#include "ncp_wpantund.hpp"
 
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 extern "C" {
 #include "spinel.h"
+#include "wpan-dbus-v0.h"
 #include "wpan-dbus-v1.h"
 #include "wpanctl-utils.h"
 }
 
+#include "common/bus_libdbus.hpp"
 #include "common/code_utils.hpp"
 #include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/probes.hpp"
+#include "common/timeline.hpp"
 
 namespace ot {
 
@@ -52,13 +60,59 @@ namespace BorderRouter {
 namespace Ncp {
 
 /**
- * This string is used to filter the property changed signal from wpantund.
+ * This string is used to filter the property changed signal from wpantund, the path of the interface and the
+ * property key are appended.
+ */
+const char kDBusMatchPropChanged[] = "type='signal',interface='" WPANTUND_DBUS_APIv1_INTERFACE "',"
+                                     "member='" WPANTUND_IF_SIGNAL_PROP_CHANGED "'";
+
+/**
+ * This string is used to filter the owner changes of the bus name of wpantund.
  */
-const char *kDBusMatchPropChanged = "type='signal',interface='" WPANTUND_DBUS_APIv1_INTERFACE "',"
-                                    "member='" WPANTUND_IF_SIGNAL_PROP_CHANGED "'";
+const char kDBusMatchNameOwnerChanged[] = "type='signal',sender='" DBUS_SERVICE_DBUS "',interface='" DBUS_INTERFACE_DBUS
+                                          "',member='NameOwnerChanged',arg0='" WPAN_TUNNEL_DBUS_NAME "'";
+
+enum
+{
+    kLogSampleRate = 64, ///< One of this many per-packet logs is written.
+};
+
+static Metrics::Counter sTmfProxySends("ncp.tmf_dbus_sends");
+static Metrics::Counter sTmfProxyDrops("ncp.tmf_dbus_drops");
+static Metrics::Counter sTmfProxyOutgoingDrops("ncp.tmf_dbus_outgoing_drops");
+static Metrics::Counter sTmfProxyReceivedDrops("ncp.tmf_dbus_received_drops");
+static Metrics::Gauge   sTmfProxyInFlight("ncp.tmf_dbus_in_flight");
+static Metrics::Memory  sTmfProxyMemory("memory.ncp_dbus");
+static Metrics::Counter sBusThreadDrops("ncp.dbus_thread_drops");
+
+ControllerWpantund::Bus *ControllerWpantund::sBuses          = NULL;
+pthread_mutex_t          ControllerWpantund::sBusesLock      = PTHREAD_MUTEX_INITIALIZER;
+bool                     ControllerWpantund::sDispatchThread = false;
+uint32_t                 ControllerWpantund::sBusMaxReceived = ControllerWpantund::kDefaultMaxReceived;
+uint32_t                 ControllerWpantund::sBusMaxOutgoing = ControllerWpantund::kDefaultMaxOutgoing;
+
+// Not bound to a controller, so that replies arriving after it is gone are still handled.
+ControllerWpantund::ReplyContext ControllerWpantund::sTmfProxyEnableReply = {NULL, kReplyTmfProxyEnable, kEventNone,
+                                                                             NULL, NULL};
 
 #define OTBR_AGENT_DBUS_NAME_PREFIX "otbr.agent"
 
+/**
+ * This struct maps a wpantund property to the event raised when it changes.
+ *
+ */
+struct PropertyEvent
+{
+    const char *mKey;   ///< The property key.
+    int         mEvent; ///< The event.
+};
+
+static const PropertyEvent kPropertyEvents[] = {
+    {kWPANTUNDProperty_TmfProxyStream, kEventTmfProxyStream}, {kWPANTUNDProperty_NCPState, kEventThreadState},
+    {kWPANTUNDProperty_NetworkName, kEventNetworkName},       {kWPANTUNDProperty_NetworkXPANID, kEventExtPanId},
+    {kWPANTUNDProperty_NetworkPSKc, kEventPSKc},             {kWPANTUNDProperty_ThreadNetworkData, kEventNetworkData},
+};
+
 static void HandleDBusError(DBusError &aError)
 {
     otbrLog(OTBR_LOG_ERR, "NCP DBus error %s: %s!", aError.name, aError.message);
@@ -69,37 +123,76 @@ DBusHandlerResult ControllerWpantund::HandlePropertyChangedSignal(DBusConnection
                                                                   DBusMessage *   aMessage,
                                                                   void *          aContext)
 {
+    ControllerWpantund &controller = *static_cast<ControllerWpantund *>(aContext);
+
     (void)aConnection;
-    return static_cast<ControllerWpantund *>(aContext)->HandlePropertyChangedSignal(*aMessage);
+    return controller.mBus->mThreaded ? controller.PostPropertyChangedSignal(*aMessage)
+                                      : controller.HandlePropertyChangedSignal(*aMessage);
 }
 
-DBusHandlerResult ControllerWpantund::HandlePropertyChangedSignal(DBusMessage &aMessage)
+DBusHandlerResult ControllerWpantund::PostPropertyChangedSignal(DBusMessage &aMessage)
 {
     DBusHandlerResult result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
-    DBusMessageIter   iter;
-    const char *      key    = NULL;
-    const char *      sender = dbus_message_get_sender(&aMessage);
     const char *      path   = dbus_message_get_path(&aMessage);
 
-    if (sender && path && strcmp(sender, mInterfaceDBusName) && strstr(path, mInterfaceName))
+    // Called by the dispatch thread, the message is read by the reactor.
+    VerifyOrExit(IsNameOwnerChanged(aMessage) || (path != NULL && !strcmp(path, mInterfaceDBusPath)));
+
+    // Signals are dropped while the reactor is behind, so that the replies it waits for are not.
+    if (mBusEvents.GetCount() < kBusQueueSize - kBusQueueReserved)
     {
-        // DBus name of the interface has changed, possibly caused by wpantund restarted,
-        // We have to restart the border agent proxy.
+        PostBusEvent(dbus_message_ref(&aMessage), NULL);
+    }
+    else
+    {
+        sBusThreadDrops.Add();
+    }
+
+    if (dbus_message_is_signal(&aMessage, WPANTUND_DBUS_APIv1_INTERFACE, WPANTUND_IF_SIGNAL_PROP_CHANGED))
+    {
+        result = DBUS_HANDLER_RESULT_HANDLED;
+    }
+
+exit:
+    return result;
+}
+
+DBusHandlerResult ControllerWpantund::HandlePropertyChangedSignal(DBusMessage &aMessage)
+{
+    DBusHandlerResult                result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    BorderRouter::Bus::LibdbusReader reader;
+    const char *                     key    = NULL;
+    const char *                     sender = dbus_message_get_sender(&aMessage);
+    const char *                     path   = dbus_message_get_path(&aMessage);
+
+    // The filters of all interfaces see the messages of the shared connection, and all of them are told of the
+    // owner changes of wpantund.
+    VerifyOrExit(!IsNameOwnerChanged(aMessage), HandleNameOwnerChanged(aMessage));
+    VerifyOrExit(path != NULL && !strcmp(path, mInterfaceDBusPath));
+
+    if (sender && strcmp(sender, mInterfaceDBusName) && !mReconnecting)
+    {
+        // DBus name of the interface has changed, possibly caused by wpantund restarted before the owner change
+        // was watched, the border agent proxy has to be restarted.
         otbrLog(OTBR_LOG_WARNING, "NCP DBus name changed.");
 
-        TmfProxyStart();
+        mReconnectDelay = kReconnectMinDelay;
+        Reconnect();
     }
 
     VerifyOrExit(dbus_message_is_signal(&aMessage, WPANTUND_DBUS_APIv1_INTERFACE, WPANTUND_IF_SIGNAL_PROP_CHANGED),
                  result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED);
 
-    VerifyOrExit(dbus_message_iter_init(&aMessage, &iter));
-    dbus_message_iter_get_basic(&iter, &key);
-    VerifyOrExit(key != NULL, result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED);
-    dbus_message_iter_next(&iter);
+    VerifyOrExit(reader.Init(aMessage));
+    VerifyOrExit(reader.ReadBasic(BorderRouter::Bus::kTypeString, &key) && key != NULL);
+
+    // The TMF stream changes for every packet relayed.
+    if (strcmp(key, kWPANTUNDProperty_TmfProxyStream))
+    {
+        otbrLog(OTBR_LOG_INFO, "NCP property %s changed.", key);
+    }
 
-    otbrLog(OTBR_LOG_INFO, "NCP property %s changed.", key);
-    SuccessOrExit(OTBR_ERROR_NONE == ParseEvent(key, &iter));
+    SuccessOrExit(OTBR_ERROR_NONE == ParseEvent(FindEvent(key), reader));
 
     result = DBUS_HANDLER_RESULT_HANDLED;
 
@@ -107,24 +200,244 @@ exit:
     return result;
 }
 
-otbrError ControllerWpantund::ParseEvent(const char *aKey, DBusMessageIter *aIter)
+bool ControllerWpantund::IsNameOwnerChanged(DBusMessage &aMessage)
+{
+    return dbus_message_is_signal(&aMessage, DBUS_INTERFACE_DBUS, "NameOwnerChanged");
+}
+
+void ControllerWpantund::HandleNameOwnerChanged(DBusMessage &aMessage)
+{
+    const char *name     = NULL;
+    const char *oldOwner = NULL;
+    const char *newOwner = NULL;
+
+    VerifyOrExit(dbus_message_get_args(&aMessage, NULL, DBUS_TYPE_STRING, &name, DBUS_TYPE_STRING, &oldOwner,
+                                       DBUS_TYPE_STRING, &newOwner, DBUS_TYPE_INVALID));
+    VerifyOrExit(!strcmp(name, WPAN_TUNNEL_DBUS_NAME));
+
+    if (newOwner[0] == '\0')
+    {
+        otbrLog(OTBR_LOG_WARNING, "NCP wpantund left the bus.");
+
+        // TMF proxy packets are dropped until wpantund is back, rather than sent to calls bound to fail.
+        mInterfaceDBusName[0] = '\0';
+
+        if (mTmfProxyTemplate != NULL)
+        {
+            dbus_message_unref(mTmfProxyTemplate);
+            mTmfProxyTemplate = NULL;
+        }
+
+        // A lookup in flight fails, and is not retried until wpantund is back.
+        if (mReconnectTimer.IsRunning())
+        {
+            mTimerWheel->Stop(mReconnectTimer);
+            mReconnecting = false;
+        }
+    }
+    else
+    {
+        otbrLog(OTBR_LOG_WARNING, "NCP wpantund is back as %s.", newOwner);
+
+        if (mReconnectTimer.IsRunning())
+        {
+            mTimerWheel->Stop(mReconnectTimer);
+        }
+
+        // A lookup still in flight was sent to the previous owner.
+        mReconnectDelay = kReconnectMinDelay;
+        Reconnect();
+    }
+
+exit:
+    return;
+}
+
+void ControllerWpantund::Reconnect(void)
+{
+    DBusMessage *message = dbus_message_new_method_call(WPAN_TUNNEL_DBUS_NAME, WPAN_TUNNEL_DBUS_PATH,
+                                                        WPAN_TUNNEL_DBUS_INTERFACE, WPAN_TUNNEL_CMD_GET_INTERFACES);
+
+    mReconnecting = true;
+    VerifyOrExit(message != NULL, ScheduleReconnect());
+
+    // wpantund is waited for, not started by the bus daemon.
+    dbus_message_set_auto_start(message, FALSE);
+
+    if (SendWithReply(*message, mInterfacesReply) != OTBR_ERROR_NONE)
+    {
+        ScheduleReconnect();
+    }
+
+exit:
+    if (message != NULL)
+    {
+        dbus_message_unref(message);
+    }
+}
+
+void ControllerWpantund::ScheduleReconnect(void)
+{
+    // Without timers, the next signal of wpantund looks the interface up again.
+    VerifyOrExit(mTimerWheel != NULL, mReconnecting = false);
+
+    otbrLog(OTBR_LOG_INFO, "NCP looking up %s again in %u ms.", mInterfaceName, mReconnectDelay);
+    mTimerWheel->Start(mReconnectTimer, mReconnectDelay);
+    mReconnectDelay *= 2;
+
+    if (mReconnectDelay > kReconnectMaxDelay)
+    {
+        mReconnectDelay = kReconnectMaxDelay;
+    }
+
+exit:
+    return;
+}
+
+void ControllerWpantund::HandleReconnectTimer(void *aContext)
+{
+    static_cast<ControllerWpantund *>(aContext)->Reconnect();
+}
+
+void ControllerWpantund::HandleInterfaces(DBusMessage *aReply)
+{
+    BorderRouter::Bus::LibdbusReader reader;
+    const char *                     interfaceName = NULL;
+    const char *                     dbusName      = NULL;
+    const char *                     error         = aReply ? dbus_message_get_error_name(aReply) : NULL;
+
+    if (aReply != NULL && error == NULL && reader.Init(*aReply) && reader.Enter())
+    {
+        // Each interface is an array of its name and the bus name of its wpantund.
+        while (reader.GetType() == BorderRouter::Bus::kTypeArray && reader.Enter())
+        {
+            if (reader.ReadBasic(BorderRouter::Bus::kTypeString, &interfaceName) &&
+                reader.ReadBasic(BorderRouter::Bus::kTypeString, &dbusName) && !strcmp(interfaceName, mInterfaceName))
+            {
+                break;
+            }
+
+            dbusName = NULL;
+            reader.Leave();
+        }
+    }
+
+    if (dbusName != NULL)
+    {
+        if (mReconnectTimer.IsRunning())
+        {
+            mTimerWheel->Stop(mReconnectTimer);
+        }
+
+        mReconnecting   = false;
+        mReconnectDelay = kReconnectMinDelay;
+
+        // Lookups sent to successive owners may all succeed.
+        VerifyOrExit(strcmp(dbusName, mInterfaceDBusName) || mTmfProxyTemplate == NULL);
+        strncpy(mInterfaceDBusName, dbusName, DBUS_MAXIMUM_NAME_LENGTH);
+        otbrLog(OTBR_LOG_INFO, "NCP found %s at %s, restarting TMF proxy.", mInterfaceName, mInterfaceDBusName);
+
+        SuccessOrExit(TmfProxyPrepare());
+        TmfProxyEnable(TRUE);
+
+        // The properties may have changed while wpantund was away.
+        mCachedEvents = 0;
+        RequestEvents();
+    }
+    else if (!mReconnecting || mReconnectTimer.IsRunning())
+    {
+        // Failures of lookups sent to previous owners.
+        ExitNow();
+    }
+    else if (error != NULL &&
+             (!strcmp(error, DBUS_ERROR_SERVICE_UNKNOWN) || !strcmp(error, DBUS_ERROR_NAME_HAS_NO_OWNER)))
+    {
+        // The owner change tells when wpantund is back.
+        otbrLog(OTBR_LOG_WARNING, "NCP wpantund is not on the bus.");
+        mReconnecting = false;
+    }
+    else
+    {
+        // wpantund may be up before it registers the interface.
+        otbrLog(OTBR_LOG_WARNING, "NCP failed to find %s.", mInterfaceName);
+        ScheduleReconnect();
+    }
+
+exit:
+    return;
+}
+
+uint32_t ControllerWpantund::HashKey(const char *aKey)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+
+    for (; *aKey != '\0'; ++aKey)
+    {
+        hash = (hash ^ static_cast<uint8_t>(*aKey)) * 16777619u;
+    }
+
+    return hash;
+}
+
+void ControllerWpantund::InitPropertyTable(void)
+{
+    memset(mPropertyTable, 0, sizeof(mPropertyTable));
+
+    for (size_t i = 0; i < sizeof(kPropertyEvents) / sizeof(kPropertyEvents[0]); ++i)
+    {
+        uint32_t hash   = HashKey(kPropertyEvents[i].mKey);
+        size_t   bucket = hash & (kPropertyBuckets - 1);
+
+        // Linear probing, the table is sparse enough for probes to be rare.
+        while (mPropertyTable[bucket].mKey != NULL)
+        {
+            bucket = (bucket + 1) & (kPropertyBuckets - 1);
+        }
+
+        mPropertyTable[bucket].mKey   = kPropertyEvents[i].mKey;
+        mPropertyTable[bucket].mHash  = hash;
+        mPropertyTable[bucket].mEvent = kPropertyEvents[i].mEvent;
+    }
+}
+
+int ControllerWpantund::FindEvent(const char *aKey) const
+{
+    uint32_t hash   = HashKey(aKey);
+    size_t   bucket = hash & (kPropertyBuckets - 1);
+    int      event  = kEventNone;
+
+    for (; mPropertyTable[bucket].mKey != NULL; bucket = (bucket + 1) & (kPropertyBuckets - 1))
+    {
+        if (mPropertyTable[bucket].mHash == hash && !strcmp(mPropertyTable[bucket].mKey, aKey))
+        {
+            event = mPropertyTable[bucket].mEvent;
+            break;
+        }
+    }
+
+    return event;
+}
+
+otbrError ControllerWpantund::ParseEvent(int aEvent, BorderRouter::Bus::Reader &aReader)
 {
     otbrError ret = OTBR_ERROR_NONE;
 
-    if (!strcmp(aKey, kWPANTUNDProperty_TmfProxyStream))
+    switch (aEvent)
+    {
+    case kEventTmfProxyStream:
     {
         const uint8_t *buf     = NULL;
+        size_t         length  = 0;
         uint16_t       locator = 0;
         uint16_t       port    = 0;
         uint16_t       len     = 0;
-        {
-            DBusMessageIter sub_iter;
-            int             nelements = 0;
 
-            dbus_message_iter_recurse(aIter, &sub_iter);
-            dbus_message_iter_get_fixed_array(&sub_iter, &buf, &nelements);
-            len = static_cast<uint16_t>(nelements);
-        }
+        // The packet is read in place, and only copied once queued.
+        VerifyOrExit(aReader.ReadBytes(buf, length), ret = OTBR_ERROR_DBUS);
+        VerifyOrExit(length >= kSizeTmfProxyTrailer && length - kSizeTmfProxyTrailer <= kMaxTmfProxyPacket,
+                     ret = OTBR_ERROR_DBUS);
+        len = static_cast<uint16_t>(length);
 
         // both port and locator are encoded in network endian.
         port = buf[--len];
@@ -132,32 +445,63 @@ otbrError ControllerWpantund::ParseEvent(const char *aKey, DBusMessageIter *aIte
         locator = buf[--len];
         locator |= buf[--len] << 8;
 
-        EventEmitter::Emit(kEventTmfProxyStream, buf, len, locator, port);
+        // Packets are copied out of the message, which is freed once dispatched. The oldest packet is the most
+        // likely to be retransmitted already, so it makes room for the new one.
+        if (mTmfProxyQueueCount == kTmfProxyQueueSize)
+        {
+            otbrLogSampled(OTBR_LOG_WARNING, kLogSampleRate, "TMF proxy queue full, oldest packet dropped");
+            mTmfProxyQueueHead = (mTmfProxyQueueHead + 1) % kTmfProxyQueueSize;
+            --mTmfProxyQueueCount;
+            sTmfProxyReceivedDrops.Add();
+        }
+
+        {
+            TmfProxyPacket &packet = mTmfProxyQueue[(mTmfProxyQueueHead + mTmfProxyQueueCount) % kTmfProxyQueueSize];
+
+            memcpy(packet.mBuffer, buf, len);
+            packet.mLength  = len;
+            packet.mLocator = locator;
+            packet.mPort    = port;
+            ++mTmfProxyQueueCount;
+        }
+        break;
     }
-    else if (!strcmp(aKey, kWPANTUNDProperty_NCPState))
+
+    case kEventThreadState:
     {
         const char *state = NULL;
-        dbus_message_iter_get_basic(aIter, &state);
+
+        VerifyOrExit(aReader.ReadBasic(BorderRouter::Bus::kTypeString, &state), ret = OTBR_ERROR_DBUS);
 
         otbrLog(OTBR_LOG_INFO, "state %s", state);
 
-        EventEmitter::Emit(kEventThreadState, 0 == strcmp(state, "associated"));
+        mThreadAssociated = (0 == strcmp(state, "associated"));
+        mCachedEvents |= (1U << kEventThreadState);
+        mPendingEvents |= (1U << kEventThreadState);
+        break;
     }
-    else if (!strcmp(aKey, kWPANTUNDProperty_NetworkName))
+
+    case kEventNetworkName:
     {
         const char *networkName = NULL;
-        dbus_message_iter_get_basic(aIter, &networkName);
+
+        VerifyOrExit(aReader.ReadBasic(BorderRouter::Bus::kTypeString, &networkName), ret = OTBR_ERROR_DBUS);
 
         otbrLog(OTBR_LOG_INFO, "network name %s...", networkName);
-        EventEmitter::Emit(kEventNetworkName, networkName);
+
+        strncpy(mNetworkName, networkName, sizeof(mNetworkName) - 1);
+        mNetworkName[sizeof(mNetworkName) - 1] = '\0';
+        mCachedEvents |= (1U << kEventNetworkName);
+        mPendingEvents |= (1U << kEventNetworkName);
+        break;
     }
-    else if (!strcmp(aKey, kWPANTUNDProperty_NetworkXPANID))
+
+    case kEventExtPanId:
     {
         uint64_t xpanid = 0;
 
-        if (DBUS_TYPE_UINT64 == dbus_message_iter_get_arg_type(aIter))
+        if (aReader.ReadBasic(BorderRouter::Bus::kTypeUint64, &xpanid))
         {
-            dbus_message_iter_get_basic(aIter, &xpanid);
 #if __BYTE_ORDER == __LITTLE_ENDIAN
             // convert to network endian
             for (uint8_t *p = reinterpret_cast<uint8_t *>(&xpanid), *q = p + sizeof(xpanid) - 1; p < q; ++p, --q)
@@ -168,32 +512,52 @@ otbrError ControllerWpantund::ParseEvent(const char *aKey, DBusMessageIter *aIte
             }
 #endif
         }
-        else if (DBUS_TYPE_ARRAY == dbus_message_iter_get_arg_type(aIter))
+        else
         {
-            const uint8_t * bytes = NULL;
-            int             count = 0;
-            DBusMessageIter subIter;
+            const uint8_t *bytes = NULL;
+            size_t         count = 0;
 
-            dbus_message_iter_recurse(aIter, &subIter);
-            dbus_message_iter_get_fixed_array(&subIter, &bytes, &count);
-            VerifyOrExit(count == kSizeExtPanId, ret = OTBR_ERROR_DBUS);
+            VerifyOrExit(aReader.ReadBytes(bytes, count) && count == kSizeExtPanId, ret = OTBR_ERROR_DBUS);
             memcpy(&xpanid, bytes, sizeof(xpanid));
         }
 
         otbrLog(OTBR_LOG_INFO, "xpanid %llu...", xpanid);
-        EventEmitter::Emit(kEventExtPanId, reinterpret_cast<uint8_t *>(&xpanid));
+
+        memcpy(mExtPanId, &xpanid, sizeof(mExtPanId));
+        mCachedEvents |= (1U << kEventExtPanId);
+        mPendingEvents |= (1U << kEventExtPanId);
+        break;
+    }
+
+    case kEventPSKc:
+    {
+        const uint8_t *pskc  = NULL;
+        size_t         count = 0;
+
+        VerifyOrExit(aReader.ReadBytes(pskc, count) && count == kSizePSKc, ret = OTBR_ERROR_DBUS);
+
+        memcpy(mPSKc, pskc, sizeof(mPSKc));
+        mCachedEvents |= (1U << kEventPSKc);
+        mPendingEvents |= (1U << kEventPSKc);
+        break;
     }
-    else if (!strcmp(aKey, kWPANTUNDProperty_NetworkPSKc))
+
+    case kEventNetworkData:
     {
-        const uint8_t * pskc  = NULL;
-        int             count = 0;
-        DBusMessageIter subIter;
+        const uint8_t *data  = NULL;
+        size_t         count = 0;
 
-        dbus_message_iter_recurse(aIter, &subIter);
-        dbus_message_iter_get_fixed_array(&subIter, &pskc, &count);
-        VerifyOrExit(count == kSizePSKc, ret = OTBR_ERROR_DBUS);
+        VerifyOrExit(aReader.ReadBytes(data, count) && count <= sizeof(mNetworkData), ret = OTBR_ERROR_DBUS);
+
+        memcpy(mNetworkData, data, count);
+        mNetworkDataLength = static_cast<uint16_t>(count);
+        mCachedEvents |= (1U << kEventNetworkData);
+        mPendingEvents |= (1U << kEventNetworkData);
+        break;
+    }
 
-        EventEmitter::Emit(kEventPSKc, pskc);
+    default:
+        break;
     }
 
 exit:
@@ -202,41 +566,991 @@ exit:
 
 dbus_bool_t ControllerWpantund::AddDBusWatch(struct DBusWatch *aWatch, void *aContext)
 {
-    static_cast<ControllerWpantund *>(aContext)->mWatches[aWatch] = true;
-    return TRUE;
+    Bus *       bus = static_cast<Bus *>(aContext);
+    dbus_bool_t ret = FALSE;
+
+    VerifyOrExit(bus->mWatches.Set(aWatch, dbus_watch_get_enabled(aWatch) ? true : false));
+
+    if (bus->mReactor != NULL)
+    {
+        dbus_watch_set_data(aWatch, new Reactor::Watch(), FreeDBusWatch);
+        UpdateDBusWatch(*bus->mReactor, *aWatch);
+    }
+
+    ret = TRUE;
+
+exit:
+    return ret;
 }
 
 void ControllerWpantund::RemoveDBusWatch(struct DBusWatch *aWatch, void *aContext)
 {
-    static_cast<ControllerWpantund *>(aContext)->mWatches.erase(aWatch);
+    Bus *           bus   = static_cast<Bus *>(aContext);
+    Reactor::Watch *watch = static_cast<Reactor::Watch *>(dbus_watch_get_data(aWatch));
+
+    if (watch != NULL && watch->mFd >= 0)
+    {
+        bus->mReactor->Remove(*watch);
+    }
+
+    bus->mWatches.Erase(aWatch);
 }
 
 void ControllerWpantund::ToggleDBusWatch(struct DBusWatch *aWatch, void *aContext)
 {
-    static_cast<ControllerWpantund *>(aContext)->mWatches[aWatch] = (dbus_watch_get_enabled(aWatch) ? true : false);
+    Bus *bus = static_cast<Bus *>(aContext);
+
+    if (bus->mReactor != NULL)
+    {
+        UpdateDBusWatch(*bus->mReactor, *aWatch);
+    }
+
+    bus->mWatches.Set(aWatch, dbus_watch_get_enabled(aWatch) ? true : false);
+}
+
+void ControllerWpantund::UpdateDBusWatch(Reactor &aReactor, DBusWatch &aWatch)
+{
+    Reactor::Watch &watch  = *static_cast<Reactor::Watch *>(dbus_watch_get_data(&aWatch));
+    unsigned int    flags  = dbus_watch_get_flags(&aWatch);
+    unsigned int    events = 0;
+    int             fd     = dbus_watch_get_unix_fd(&aWatch);
+
+    if (flags & DBUS_WATCH_READABLE)
+    {
+        events |= Reactor::kEventReadable;
+    }
+
+    // libdbus only enables the writable watch when there are messages to send.
+    if (flags & DBUS_WATCH_WRITABLE)
+    {
+        events |= Reactor::kEventWritable;
+    }
+
+    if (!dbus_watch_get_enabled(&aWatch) || fd < 0)
+    {
+        if (watch.mFd >= 0)
+        {
+            aReactor.Remove(watch);
+        }
+    }
+    else if (watch.mFd >= 0)
+    {
+        aReactor.Modify(watch, events);
+    }
+    else if (aReactor.Add(watch, fd, events, HandleDBusWatch, &aWatch, "dbus") != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "NCP failed to watch DBus fd %d: %s!", fd, strerror(errno));
+    }
 }
 
-otbrError ControllerWpantund::TmfProxyEnable(dbus_bool_t aEnable)
+void ControllerWpantund::HandleDBusWatch(void *aContext, int aFd, unsigned int aEvents)
 {
-    otbrError    ret     = OTBR_ERROR_ERRNO;
-    DBusMessage *message = NULL;
-    const char * key     = kWPANTUNDProperty_TmfProxyEnabled;
+    DBusWatch *  watch = static_cast<DBusWatch *>(aContext);
+    unsigned int flags = 0;
 
-    message = dbus_message_new_method_call(mInterfaceDBusName, mInterfaceDBusPath, WPANTUND_DBUS_APIv1_INTERFACE,
-                                           WPANTUND_IF_CMD_PROP_SET);
+    if (aEvents & Reactor::kEventReadable)
+    {
+        flags |= DBUS_WATCH_READABLE;
+    }
 
-    VerifyOrExit(message != NULL, errno = ENOMEM);
+    if (aEvents & Reactor::kEventWritable)
+    {
+        flags |= DBUS_WATCH_WRITABLE;
+    }
 
-    VerifyOrExit(
-        dbus_message_append_args(message, DBUS_TYPE_STRING, &key, DBUS_TYPE_BOOLEAN, &aEnable, DBUS_TYPE_INVALID),
-        errno = EINVAL);
+    if (aEvents & Reactor::kEventError)
+    {
+        flags |= DBUS_WATCH_ERROR;
+    }
+
+    dbus_watch_handle(watch, flags);
+    (void)aFd;
+}
+
+void ControllerWpantund::FreeDBusWatch(void *aWatch)
+{
+    delete static_cast<Reactor::Watch *>(aWatch);
+}
+
+dbus_bool_t ControllerWpantund::AddDBusTimeout(DBusTimeout *aTimeout, void *aContext)
+{
+    dbus_timeout_set_data(aTimeout, new BusTimeout(*aTimeout, *static_cast<Bus *>(aContext)), FreeDBusTimeout);
+    ToggleDBusTimeout(aTimeout, aContext);
+
+    return TRUE;
+}
+
+void ControllerWpantund::RemoveDBusTimeout(DBusTimeout *aTimeout, void *aContext)
+{
+    BusTimeout *timeout = static_cast<BusTimeout *>(dbus_timeout_get_data(aTimeout));
+
+    if (timeout != NULL && timeout->mTimer.IsRunning())
+    {
+        timeout->mBus.mTimerWheel->Stop(timeout->mTimer);
+    }
+
+    (void)aContext;
+}
+
+void ControllerWpantund::ToggleDBusTimeout(DBusTimeout *aTimeout, void *aContext)
+{
+    BusTimeout &timeout = *static_cast<BusTimeout *>(dbus_timeout_get_data(aTimeout));
+
+    if (timeout.mTimer.IsRunning())
+    {
+        timeout.mBus.mTimerWheel->Stop(timeout.mTimer);
+    }
 
-    VerifyOrExit(dbus_connection_send(mDBus, message, NULL), errno = ENOMEM);
+    if (dbus_timeout_get_enabled(aTimeout))
+    {
+        timeout.mBus.mTimerWheel->Start(timeout.mTimer, static_cast<uint64_t>(dbus_timeout_get_interval(aTimeout)));
+    }
+
+    (void)aContext;
+}
+
+void ControllerWpantund::HandleDBusTimeout(void *aContext)
+{
+    BusTimeout &timeout  = *static_cast<BusTimeout *>(aContext);
+    uint64_t    interval = static_cast<uint64_t>(dbus_timeout_get_interval(&timeout.mTimeout));
+
+    // DBus timeouts repeat until removed. The timer is restarted first, as handling a timeout, e.g. of a pending call,
+    // may remove and free it.
+    timeout.mBus.mTimerWheel->Start(timeout.mTimer, interval);
+    dbus_timeout_handle(&timeout.mTimeout);
+}
+
+void ControllerWpantund::FreeDBusTimeout(void *aTimeout)
+{
+    delete static_cast<BusTimeout *>(aTimeout);
+}
+
+void ControllerWpantund::HandleDispatchStatus(DBusConnection *aConnection, DBusDispatchStatus aStatus, void *aContext)
+{
+    Bus &bus = *static_cast<Bus *>(aContext);
+
+    // The connection may not be used here. Messages queued outside Process(), e.g. the error replies of timed out
+    // calls, are dispatched by the next Process(), which the timer makes run without waiting.
+    if (aStatus == DBUS_DISPATCH_DATA_REMAINS && !bus.mDispatchTimer.IsRunning())
+    {
+        bus.mTimerWheel->Start(bus.mDispatchTimer, 0);
+    }
+
+    (void)aConnection;
+}
+
+void ControllerWpantund::HandleDispatchTimer(void *aContext)
+{
+    (void)aContext;
+}
+
+otbrError ControllerWpantund::TmfProxyEnable(dbus_bool_t aEnable)
+{
+    otbrError    ret     = OTBR_ERROR_ERRNO;
+    DBusMessage *message = NULL;
+    const char * key     = kWPANTUNDProperty_TmfProxyEnabled;
+
+    message = dbus_message_new_method_call(mInterfaceDBusName, mInterfaceDBusPath, WPANTUND_DBUS_APIv1_INTERFACE,
+                                           WPANTUND_IF_CMD_PROP_SET);
+
+    VerifyOrExit(message != NULL, errno = ENOMEM);
+
+    VerifyOrExit(
+        dbus_message_append_args(message, DBUS_TYPE_STRING, &key, DBUS_TYPE_BOOLEAN, &aEnable, DBUS_TYPE_INVALID),
+        errno = EINVAL);
+
+    ret = SendWithReply(*message, sTmfProxyEnableReply);
+
+exit:
+    if (message != NULL)
+    {
+        dbus_message_unref(message);
+    }
+
+    return ret;
+}
+
+ControllerWpantund::ControllerWpantund(const char *aInterfaceName, Reactor *aReactor, TimerWheel *aTimerWheel)
+    : mBus(NULL)
+    , mDBus(NULL)
+    , mReactor(aReactor)
+    , mTimerWheel(aTimerWheel)
+    , mReconnectTimer(HandleReconnectTimer, this)
+    , mReconnectDelay(kReconnectMinDelay)
+    , mReconnecting(false)
+    , mMatched(false)
+    , mTmfProxyTemplate(NULL)
+    , mTmfProxyInFlight(0)
+    , mTmfProxyInFlightBytes(0)
+    , mTmfProxyDropped(0)
+    , mTmfProxyFailed(0)
+    , mThreadAssociated(false)
+    , mNetworkDataLength(0)
+    , mCachedEvents(0)
+    , mPendingEvents(0)
+    , mEmitting(false)
+    , mTmfProxyQueueHead(0)
+    , mTmfProxyQueueCount(0)
+    , mTmfProxyOutgoingCount(0)
+{
+    mBusPipe[0]           = -1;
+    mBusPipe[1]           = -1;
+    mInterfaceDBusName[0] = '\0';
+    mNetworkName[0]       = '\0';
+    strncpy(mInterfaceName, aInterfaceName, sizeof(mInterfaceName));
+
+    // Populate the path according to source code of wpanctl, better to export a function.
+    snprintf(mInterfaceDBusPath, sizeof(mInterfaceDBusPath), "%s/%s", WPANTUND_DBUS_PATH, mInterfaceName);
+    InitPropertyTable();
+
+    for (int i = 0; i < kNumCachedEvents; ++i)
+    {
+        mPropertyRequests[i].mController = this;
+        mPropertyRequests[i].mType       = kReplyPropGet;
+        mPropertyRequests[i].mEvent      = i;
+        mPropertyRequests[i].mDone       = NULL;
+        mPropertyRequests[i].mReply      = NULL;
+    }
+
+    mTmfProxyReply.mController = this;
+    mTmfProxyReply.mType       = kReplyTmfProxy;
+    mTmfProxyReply.mEvent      = kEventNone;
+    mTmfProxyReply.mDone       = NULL;
+    mTmfProxyReply.mReply      = NULL;
+
+    mInterfacesReply.mController = this;
+    mInterfacesReply.mType       = kReplyInterfaces;
+    mInterfacesReply.mEvent      = kEventNone;
+    mInterfacesReply.mDone       = NULL;
+    mInterfacesReply.mReply      = NULL;
+}
+
+ControllerWpantund::Bus *ControllerWpantund::AcquireBus(Reactor *aReactor, TimerWheel *aTimerWheel, DBusError &aError)
+{
+    Bus *bus;
+
+    pthread_mutex_lock(&sBusesLock);
+
+    for (bus = sBuses; bus != NULL && bus->mReactor != aReactor; bus = bus->mNext)
+        ;
+
+    VerifyOrExit(bus == NULL);
+
+    // Connections of different reactors are used by different threads.
+    VerifyOrExit(dbus_threads_init_default());
+
+    // The first controller of a reactor provides the timer wheel of the connection, unless it is dispatched by a
+    // thread of its own, which then runs the timeouts.
+    bus            = new Bus(aReactor, aTimerWheel);
+    bus->mThreaded = sDispatchThread;
+    bus->mDBus     = dbus_bus_get_private(DBUS_BUS_STARTER, &aError);
+    if (!bus->mDBus)
+    {
+        dbus_error_free(&aError);
+        bus->mDBus = dbus_bus_get_private(DBUS_BUS_SYSTEM, &aError);
+    }
+
+    if (bus->mThreaded)
+    {
+        bus->mTimerWheel = new TimerWheel();
+    }
+
+    // The dispatch thread polls the connection itself.
+    if (bus->mDBus == NULL ||
+        (!bus->mThreaded &&
+         !dbus_connection_set_watch_functions(bus->mDBus, AddDBusWatch, RemoveDBusWatch, ToggleDBusWatch, bus, NULL)) ||
+        (bus->mTimerWheel != NULL && !dbus_connection_set_timeout_functions(bus->mDBus, AddDBusTimeout,
+                                                                            RemoveDBusTimeout, ToggleDBusTimeout, bus,
+                                                                            NULL)) ||
+        (bus->mThreaded && !StartBusThread(*bus)))
+    {
+        if (bus->mDBus != NULL)
+        {
+            dbus_connection_close(bus->mDBus);
+            dbus_connection_unref(bus->mDBus);
+        }
+
+        if (bus->mThreaded)
+        {
+            delete bus->mTimerWheel;
+        }
+
+        delete bus;
+        ExitNow(bus = NULL);
+    }
+
+    if (aTimerWheel != NULL && !bus->mThreaded)
+    {
+        dbus_connection_set_dispatch_status_function(bus->mDBus, HandleDispatchStatus, bus, NULL);
+    }
+
+    // libdbus stops reading once the messages not yet dispatched reach the limit, rather than growing its buffers.
+    dbus_connection_set_max_received_size(bus->mDBus, static_cast<long>(sBusMaxReceived));
+    dbus_connection_set_max_message_size(bus->mDBus, kBusMaxMessageSize);
+
+    bus->mNext = sBuses;
+    sBuses     = bus;
+
+exit:
+    if (bus != NULL)
+    {
+        ++bus->mUsers;
+    }
+
+    pthread_mutex_unlock(&sBusesLock);
+
+    return bus;
+}
+
+void ControllerWpantund::SetBusLimits(uint32_t aMaxReceived, uint32_t aMaxOutgoing)
+{
+    pthread_mutex_lock(&sBusesLock);
+
+    if (aMaxReceived != 0)
+    {
+        sBusMaxReceived = aMaxReceived;
+
+        for (Bus *bus = sBuses; bus != NULL; bus = bus->mNext)
+        {
+            dbus_connection_set_max_received_size(bus->mDBus, static_cast<long>(aMaxReceived));
+        }
+    }
+
+    if (aMaxOutgoing != 0)
+    {
+        __atomic_store_n(&sBusMaxOutgoing, aMaxOutgoing, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&sBusesLock);
+}
+
+void ControllerWpantund::ReleaseBus(Bus &aBus)
+{
+    pthread_mutex_lock(&sBusesLock);
+
+    assert(aBus.mUsers > 0);
+
+    if (--aBus.mUsers == 0)
+    {
+        Bus **prev = &sBuses;
+
+        while (*prev != &aBus)
+        {
+            prev = &(*prev)->mNext;
+        }
+
+        *prev = aBus.mNext;
+
+        if (aBus.mThreaded)
+        {
+            // The thread sends the requests left before it stops.
+            ssize_t rval;
+
+            __atomic_store_n(&aBus.mStopping, true, __ATOMIC_RELEASE);
+            rval = write(aBus.mWakePipe[1], "", 1);
+            (void)rval;
+            pthread_join(aBus.mThread, NULL);
+        }
+
+        // Unregisters the watches from the reactor and the timeouts from the timer wheel.
+        dbus_connection_set_watch_functions(aBus.mDBus, NULL, NULL, NULL, NULL, NULL);
+        dbus_connection_set_timeout_functions(aBus.mDBus, NULL, NULL, NULL, NULL, NULL);
+        dbus_connection_set_dispatch_status_function(aBus.mDBus, NULL, NULL, NULL);
+        dbus_connection_set_wakeup_main_function(aBus.mDBus, NULL, NULL, NULL);
+        dbus_connection_close(aBus.mDBus);
+        dbus_connection_unref(aBus.mDBus);
+
+        if (aBus.mThreaded)
+        {
+            delete aBus.mTimerWheel;
+            close(aBus.mWakePipe[0]);
+            close(aBus.mWakePipe[1]);
+        }
+
+        delete &aBus;
+    }
+
+    pthread_mutex_unlock(&sBusesLock);
+}
+
+bool ControllerWpantund::StartBusThread(Bus &aBus)
+{
+    bool started = false;
+
+    VerifyOrExit(aBus.mRequests.Init(kBusQueueSize, sizeof(BusRequest)));
+    SuccessOrExit(pipe(aBus.mWakePipe));
+    SuccessOrExit(fcntl(aBus.mWakePipe[0], F_SETFL, fcntl(aBus.mWakePipe[0], F_GETFL) | O_NONBLOCK));
+    SuccessOrExit(fcntl(aBus.mWakePipe[1], F_SETFL, fcntl(aBus.mWakePipe[1], F_GETFL) | O_NONBLOCK));
+
+    // Messages queued without the thread, e.g. by dbus_bus_add_match(), wake it to be written.
+    dbus_connection_set_wakeup_main_function(aBus.mDBus, WakeBus, &aBus, NULL);
+    SuccessOrExit(errno = pthread_create(&aBus.mThread, NULL, RunBusThread, &aBus));
+    started = true;
+
+exit:
+    if (!started)
+    {
+        otbrLog(OTBR_LOG_ERR, "NCP failed to start DBus thread: %s!", strerror(errno));
+        dbus_connection_set_wakeup_main_function(aBus.mDBus, NULL, NULL, NULL);
+
+        for (int i = 0; i < 2; ++i)
+        {
+            if (aBus.mWakePipe[i] >= 0)
+            {
+                close(aBus.mWakePipe[i]);
+                aBus.mWakePipe[i] = -1;
+            }
+        }
+    }
+
+    return started;
+}
+
+void *ControllerWpantund::RunBusThread(void *aBus)
+{
+    Bus &bus = *static_cast<Bus *>(aBus);
+    int  fd  = -1;
+
+    dbus_connection_get_unix_fd(bus.mDBus, &fd);
+
+    while (!__atomic_load_n(&bus.mStopping, __ATOMIC_ACQUIRE))
+    {
+        struct pollfd fds[2];
+        int           timeout = kBusPollTimeout;
+        uint64_t      next;
+
+        if (bus.mTimerWheel->GetNextTime(next))
+        {
+            uint64_t now = GetMonotonicNow();
+
+            timeout = next <= now ? 0 : next - now < kBusPollTimeout ? static_cast<int>(next - now) : kBusPollTimeout;
+        }
+
+        fds[0].fd     = bus.mWakePipe[0];
+        fds[0].events = POLLIN;
+        fds[1].fd     = fd;
+        fds[1].events = POLLIN | (dbus_connection_has_messages_to_send(bus.mDBus) ? POLLOUT : 0);
+
+        // Pairs with WakeBus(), either the requests pushed are seen here, or the thread is seen about to wait.
+        __atomic_store_n(&bus.mSleeping, true, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if (!bus.mRequests.IsEmpty())
+        {
+            timeout = 0;
+        }
+
+        if (poll(fds, 2, timeout) > 0 && (fds[0].revents & POLLIN))
+        {
+            char buffer[64];
+
+            while (read(bus.mWakePipe[0], buffer, sizeof(buffer)) > 0)
+                ;
+        }
+
+        __atomic_store_n(&bus.mSleeping, false, __ATOMIC_SEQ_CST);
+
+        bus.mTimerWheel->Process();
+        SendBusRequests(bus);
+
+        // Filters and pending call notifications hand the messages to the reactors.
+        dbus_connection_read_write(bus.mDBus, 0);
+
+        while (DBUS_DISPATCH_DATA_REMAINS == dbus_connection_dispatch(bus.mDBus))
+            ;
+    }
+
+    SendBusRequests(bus);
+    dbus_connection_flush(bus.mDBus);
+
+    return NULL;
+}
+
+void ControllerWpantund::SendBusRequests(Bus &aBus)
+{
+    const uint8_t *data   = NULL;
+    uint16_t       length = 0;
+
+    while ((data = aBus.mRequests.GetFront(length)) != NULL)
+    {
+        BusRequest       request;
+        DBusPendingCall *pending = NULL;
+
+        memcpy(&request, data, sizeof(request));
+        aBus.mRequests.Pop();
+
+        if (request.mMessage == NULL)
+        {
+            DeliverReply(*request.mContext, NULL);
+            continue;
+        }
+
+        if (!dbus_connection_send_with_reply(aBus.mDBus, request.mMessage, &pending, request.mTimeout) ||
+            pending == NULL || !dbus_pending_call_set_notify(pending, HandlePendingReply, request.mContext, NULL))
+        {
+            if (pending != NULL)
+            {
+                dbus_pending_call_cancel(pending);
+                dbus_pending_call_unref(pending);
+            }
+
+            // The sender was already told the call is made, it gets no reply instead.
+            DeliverReply(*request.mContext, NULL);
+        }
+
+        dbus_message_unref(request.mMessage);
+    }
+}
+
+void ControllerWpantund::WakeBus(void *aBus)
+{
+    Bus &bus = *static_cast<Bus *>(aBus);
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (__atomic_exchange_n(&bus.mSleeping, false, __ATOMIC_SEQ_CST))
+    {
+        // A full pipe already wakes the thread.
+        ssize_t rval = write(bus.mWakePipe[1], "", 1);
+        (void)rval;
+    }
+}
+
+otbrError ControllerWpantund::PushBusRequest(DBusMessage *aMessage, ReplyContext &aContext, int aTimeout)
+{
+    otbrError  ret     = OTBR_ERROR_ERRNO;
+    BusRequest request = {aMessage, &aContext, aTimeout};
+
+    // The reference is taken first, the thread releases it once sent.
+    if (aMessage != NULL)
+    {
+        dbus_message_ref(aMessage);
+    }
+
+    if (!mBus->mRequests.Push(reinterpret_cast<const uint8_t *>(&request), sizeof(request)))
+    {
+        if (aMessage != NULL)
+        {
+            dbus_message_unref(aMessage);
+        }
+
+        ExitNow(errno = ENOBUFS);
+    }
+
+    WakeBus(mBus);
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    return ret;
+}
+
+void ControllerWpantund::SyncBus(void)
+{
+    sem_t        done;
+    ReplyContext context = {this, kReplyBlocking, kEventNone, &done, NULL};
+
+    // Requests are sent between dispatching, so the filters are not running once the context is posted.
+    VerifyOrExit(sem_init(&done, 0, 0) == 0);
+
+    if (PushBusRequest(NULL, context, 0) == OTBR_ERROR_NONE)
+    {
+        while (sem_wait(&done) != 0)
+            ;
+    }
+
+    sem_destroy(&done);
+
+exit:
+    return;
+}
+
+bool ControllerWpantund::PostBusEvent(DBusMessage *aMessage, ReplyContext *aContext)
+{
+    BusEvent event  = {aMessage, aContext};
+    bool     posted = mBusEvents.Push(reinterpret_cast<const uint8_t *>(&event), sizeof(event));
+
+    if (posted)
+    {
+        // A full pipe already notifies the reactor.
+        ssize_t rval = write(mBusPipe[1], "", 1);
+        (void)rval;
+    }
+    else
+    {
+        otbrLog(OTBR_LOG_WARNING, "NCP DBus queue full");
+        sBusThreadDrops.Add();
+
+        if (aMessage != NULL)
+        {
+            dbus_message_unref(aMessage);
+        }
+    }
+
+    return posted;
+}
+
+void ControllerWpantund::HandleBusEvents(void *aContext, int aFd, unsigned int aEvents)
+{
+    char buffer[64];
+
+    // Drained before the ring, so that events posted later notify again.
+    while (read(aFd, buffer, sizeof(buffer)) > 0)
+        ;
+
+    static_cast<ControllerWpantund *>(aContext)->ProcessBusEvents();
+    (void)aEvents;
+}
+
+void ControllerWpantund::ProcessBusEvents(void)
+{
+    Timeline::Span span("ncp.dbus_dispatch");
+
+    do
+    {
+        const uint8_t *data   = NULL;
+        uint16_t       length = 0;
+
+        // Each signal queues at most one packet, handling stops while the queue is full.
+        while (mTmfProxyQueueCount < kTmfProxyQueueSize && (data = mBusEvents.GetFront(length)) != NULL)
+        {
+            BusEvent event;
+
+            memcpy(&event, data, sizeof(event));
+            mBusEvents.Pop();
+
+            if (event.mContext == NULL)
+            {
+                HandlePropertyChangedSignal(*event.mMessage);
+            }
+            else
+            {
+                HandleReply(*event.mContext, event.mMessage);
+            }
+
+            if (event.mMessage != NULL)
+            {
+                dbus_message_unref(event.mMessage);
+            }
+        }
+
+        EmitEvents();
+    } while (!mBusEvents.IsEmpty());
+}
+
+void ControllerWpantund::CloseBusEvents(void)
+{
+    const uint8_t *data   = NULL;
+    uint16_t       length = 0;
+
+    if (mBusWatch.mFd >= 0)
+    {
+        mReactor->Remove(mBusWatch);
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+        if (mBusPipe[i] >= 0)
+        {
+            close(mBusPipe[i]);
+            mBusPipe[i] = -1;
+        }
+    }
+
+    while ((data = mBusEvents.GetFront(length)) != NULL)
+    {
+        BusEvent event;
+
+        memcpy(&event, data, sizeof(event));
+        mBusEvents.Pop();
+
+        if (event.mMessage != NULL)
+        {
+            dbus_message_unref(event.mMessage);
+        }
+    }
+}
+
+uint32_t ControllerWpantund::RequestName(const char *aName, DBusError &aError)
+{
+    uint32_t     result  = 0;
+    uint32_t     flags   = DBUS_NAME_FLAG_DO_NOT_QUEUE;
+    DBusMessage *message = NULL;
+    DBusMessage *reply   = NULL;
+
+    // Not dbus_bus_request_name(), which reads the connection itself.
+    VerifyOrExit((message = dbus_message_new_method_call(DBUS_SERVICE_DBUS, DBUS_PATH_DBUS, DBUS_INTERFACE_DBUS,
+                                                         "RequestName")) != NULL);
+    VerifyOrExit(
+        dbus_message_append_args(message, DBUS_TYPE_STRING, &aName, DBUS_TYPE_UINT32, &flags, DBUS_TYPE_INVALID));
+    VerifyOrExit((reply = SendWithReplyAndBlock(*message, -1, aError)) != NULL);
+    dbus_message_get_args(reply, &aError, DBUS_TYPE_UINT32, &result, DBUS_TYPE_INVALID);
+
+exit:
+    if (reply != NULL)
+    {
+        dbus_message_unref(reply);
+    }
+
+    if (message != NULL)
+    {
+        dbus_message_unref(message);
+    }
+
+    return result;
+}
+
+otbrError ControllerWpantund::Init(void)
+{
+    otbrError ret = OTBR_ERROR_DBUS;
+    DBusError error;
+    char      dbusName[DBUS_MAXIMUM_NAME_LENGTH];
+
+    dbus_error_init(&error);
+    mBus = AcquireBus(mReactor, mTimerWheel, error);
+    VerifyOrExit(mBus != NULL);
+    mDBus = mBus->mDBus;
+
+    if (mBus->mThreaded)
+    {
+        VerifyOrExit(mBusEvents.Init(kBusQueueSize, sizeof(BusEvent)) && pipe(mBusPipe) == 0);
+        VerifyOrExit(fcntl(mBusPipe[0], F_SETFL, fcntl(mBusPipe[0], F_GETFL) | O_NONBLOCK) == 0);
+        VerifyOrExit(fcntl(mBusPipe[1], F_SETFL, fcntl(mBusPipe[1], F_GETFL) | O_NONBLOCK) == 0);
+        VerifyOrExit(mReactor == NULL || mReactor->Add(mBusWatch, mBusPipe[0], Reactor::kEventReadable,
+                                                       HandleBusEvents, this, "dbus") == OTBR_ERROR_NONE);
+    }
+
+    sprintf(dbusName, "%s.%s", OTBR_AGENT_DBUS_NAME_PREFIX, mInterfaceName);
+    otbrLog(OTBR_LOG_INFO, "NCP requesting DBus name %s...", dbusName);
+    VerifyOrExit(RequestName(dbusName, error) == DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER);
+
+    // The connection outlives the controller, so rules added by a previous call are not added twice.
+    if (mMatched)
+    {
+        UpdateMatches(false);
+    }
+
+    mMatched = true;
+    VerifyOrExit(UpdateMatches(true));
+
+    VerifyOrExit(dbus_connection_add_filter(mDBus, HandlePropertyChangedSignal, this, NULL));
+
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    if (dbus_error_is_set(&error))
+    {
+        HandleDBusError(error);
+    }
+
+    if (ret)
+    {
+        if (mBus)
+        {
+            if (mMatched)
+            {
+                UpdateMatches(false);
+                mMatched = false;
+            }
+
+            ReleaseBus(*mBus);
+            mBus  = NULL;
+            mDBus = NULL;
+        }
+
+        CloseBusEvents();
+        otbrLog(OTBR_LOG_ERR, "NCP failed to initialize!");
+    }
+
+    return ret;
+}
+
+bool ControllerWpantund::UpdateMatches(bool aAdd)
+{
+    bool rval = false;
+    char match[DBUS_MAXIMUM_MATCH_RULE_LENGTH];
+
+    // One rule per property, so that the bus daemon only routes changes of the properties handled here, and only
+    // for this interface. Rules are sent without waiting for replies, the bus daemon applies them in order before
+    // the requests sent after them are answered. They are formatted the same way each time, so a removal stops where
+    // an addition failed.
+    for (size_t i = 0; i < sizeof(kPropertyEvents) / sizeof(kPropertyEvents[0]); ++i)
+    {
+        VerifyOrExit(snprintf(match, sizeof(match), "%s,path='%s',arg0='%s'", kDBusMatchPropChanged,
+                              mInterfaceDBusPath, kPropertyEvents[i].mKey) < static_cast<int>(sizeof(match)));
+
+        if (aAdd)
+        {
+            dbus_bus_add_match(mDBus, match, NULL);
+        }
+        else
+        {
+            dbus_bus_remove_match(mDBus, match, NULL);
+        }
+    }
+
+    if (aAdd)
+    {
+        dbus_bus_add_match(mDBus, kDBusMatchNameOwnerChanged, NULL);
+    }
+    else
+    {
+        dbus_bus_remove_match(mDBus, kDBusMatchNameOwnerChanged, NULL);
+    }
+
+    rval = true;
+
+exit:
+    return rval;
+}
+
+ControllerWpantund::~ControllerWpantund(void)
+{
+    TmfProxyStop();
+
+    if (mTmfProxyTemplate != NULL)
+    {
+        dbus_message_unref(mTmfProxyTemplate);
+        mTmfProxyTemplate = NULL;
+    }
+
+    if (mBus)
+    {
+        // The connection is shared with the controllers of other interfaces, which keep dispatching it.
+        dbus_connection_remove_filter(mDBus, HandlePropertyChangedSignal, this);
+
+        if (mMatched)
+        {
+            UpdateMatches(false);
+            mMatched = false;
+        }
+
+        if (mBus->mThreaded)
+        {
+            SyncBus();
+        }
+
+        ReleaseBus(*mBus);
+        mBus  = NULL;
+        mDBus = NULL;
+    }
+
+    CloseBusEvents();
+}
+
+otbrError ControllerWpantund::TmfProxyStart(void)
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+
+    VerifyOrExit(lookup_dbus_name_from_interface(mInterfaceDBusName, mInterfaceName) == 0,
+                 otbrLog(OTBR_LOG_ERR, "NCP failed to find the interface!"), errno = ENODEV);
+
+    SuccessOrExit(ret = TmfProxyPrepare());
+    ret = TmfProxyEnable(TRUE);
+
+exit:
+
+    return ret;
+}
+
+otbrError ControllerWpantund::TmfProxyPrepare(void)
+{
+    otbrError    ret     = OTBR_ERROR_ERRNO;
+    DBusMessage *message = NULL;
+    const char * key     = kWPANTUNDProperty_TmfProxyStream;
+
+    message = dbus_message_new_method_call(mInterfaceDBusName, mInterfaceDBusPath, WPANTUND_DBUS_APIv1_INTERFACE,
+                                           WPANTUND_IF_CMD_PROP_SET);
+
+    VerifyOrExit(message != NULL, errno = ENOMEM);
+
+    VerifyOrExit(dbus_message_append_args(message, DBUS_TYPE_STRING, &key, DBUS_TYPE_INVALID), errno = ENOMEM);
+
+    if (mTmfProxyTemplate != NULL)
+    {
+        dbus_message_unref(mTmfProxyTemplate);
+    }
+
+    mTmfProxyTemplate = message;
+    message           = NULL;
+    ret               = OTBR_ERROR_NONE;
+
+exit:
+    if (message != NULL)
+    {
+        dbus_message_unref(message);
+    }
+
+    return ret;
+}
+
+otbrError ControllerWpantund::TmfProxySend(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort)
+{
+    otbrError       ret     = OTBR_ERROR_ERRNO;
+    DBusMessage *   message = NULL;
+    DBusMessageIter iter;
+    DBusMessageIter array;
+    bool            opened = false;
+    uint8_t         trailer[kSizeTmfProxyTrailer];
+    const uint8_t * value;
+
+    VerifyOrExit(mTmfProxyTemplate != NULL, errno = ENOTCONN);
+    VerifyOrExit(aLength <= kMaxTmfProxyPacket, errno = EMSGSIZE);
+    OTBR_PROBE3(ncp_tmf_send, aLength, aLocator, aPort);
+
+    // Packets beyond the window are dropped rather than queued without bound in libdbus.
+    VerifyOrExit(mTmfProxyInFlight < kMaxTmfProxyInFlight, ++mTmfProxyDropped, sTmfProxyDrops.Add(), errno = ENOBUFS);
+    VerifyOrExit(static_cast<unsigned long>(dbus_connection_get_outgoing_size(mDBus)) + aLength <=
+                     __atomic_load_n(&sBusMaxOutgoing, __ATOMIC_RELAXED),
+                 ++mTmfProxyDropped, sTmfProxyOutgoingDrops.Add(), errno = ENOBUFS);
+
+    trailer[0] = (aLocator >> 8);
+    trailer[1] = (aLocator & 0xff);
+    trailer[2] = (aPort >> 8);
+    trailer[3] = (aPort & 0xff);
+
+    // The copy keeps the header and the property key, leaving only the packet to marshal.
+    message = dbus_message_copy(mTmfProxyTemplate);
+
+    VerifyOrExit(message != NULL, errno = ENOMEM);
+
+    // The packet and the trailer are marshalled into one array, so that the packet is copied only into the message.
+    dbus_message_iter_init_append(message, &iter);
+    VerifyOrExit(opened = dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE_AS_STRING, &array),
+                 errno = ENOMEM);
+    value = aBuffer;
+    VerifyOrExit(dbus_message_iter_append_fixed_array(&array, DBUS_TYPE_BYTE, &value, aLength), errno = ENOMEM);
+    value = trailer;
+    VerifyOrExit(dbus_message_iter_append_fixed_array(&array, DBUS_TYPE_BYTE, &value, sizeof(trailer)),
+                 errno = ENOMEM);
+    opened = false;
+    VerifyOrExit(dbus_message_iter_close_container(&iter, &array), errno = ENOMEM);
+
+    if (mEmitting)
+    {
+        // Packets sent in response to the received ones are handed to libdbus together, once all are handled.
+        assert(mTmfProxyOutgoingCount < kMaxTmfProxyInFlight);
+        mTmfProxyOutgoing[mTmfProxyOutgoingCount++] = message;
+        message                                     = NULL;
+        ret                                         = OTBR_ERROR_NONE;
+    }
+    else
+    {
+        SuccessOrExit(ret = SendWithReply(*message, mTmfProxyReply));
+    }
 
-    ret = OTBR_ERROR_NONE;
+    ++mTmfProxyInFlight;
+    mTmfProxyInFlightBytes += aLength + kSizeTmfProxyTrailer;
+    sTmfProxyInFlight.Add();
+    sTmfProxyMemory.Allocate(aLength + kSizeTmfProxyTrailer);
+    sTmfProxySends.Add();
 
 exit:
-    if (message != NULL)
+    if (opened)
+    {
+        dbus_message_iter_abandon_container(&iter, &array);
+    }
+
+    if (message)
     {
         dbus_message_unref(message);
     }
@@ -244,128 +1558,197 @@ exit:
     return ret;
 }
 
-ControllerWpantund::ControllerWpantund(const char *aInterfaceName)
-    : mDBus(NULL)
+otbrError ControllerWpantund::SendWithReply(DBusMessage &aMessage, ReplyContext &aContext, int aTimeout)
 {
-    mInterfaceDBusName[0] = '\0';
-    strncpy(mInterfaceName, aInterfaceName, sizeof(mInterfaceName));
-}
+    otbrError        ret     = OTBR_ERROR_ERRNO;
+    DBusPendingCall *pending = NULL;
 
-otbrError ControllerWpantund::Init(void)
-{
-    otbrError ret = OTBR_ERROR_DBUS;
-    DBusError error;
-    char      dbusName[DBUS_MAXIMUM_NAME_LENGTH];
+    VerifyOrExit(!mBus->mThreaded, ret = PushBusRequest(&aMessage, aContext, aTimeout));
+    VerifyOrExit(dbus_connection_send_with_reply(mDBus, &aMessage, &pending, aTimeout) && pending != NULL,
+                 errno = ENOMEM);
 
-    dbus_error_init(&error);
-    mDBus = dbus_bus_get(DBUS_BUS_STARTER, &error);
-    if (!mDBus)
+    // The pending call is released by the notify function.
+    VerifyOrExit(dbus_pending_call_set_notify(pending, HandlePendingReply, &aContext, NULL), errno = ENOMEM);
+    pending = NULL;
+
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    if (pending != NULL)
     {
-        dbus_error_free(&error);
-        mDBus = dbus_bus_get(DBUS_BUS_SYSTEM, &error);
+        dbus_pending_call_cancel(pending);
+        dbus_pending_call_unref(pending);
     }
-    VerifyOrExit(mDBus != NULL);
 
-    VerifyOrExit(dbus_bus_register(mDBus, &error));
+    return ret;
+}
 
-    sprintf(dbusName, "%s.%s", OTBR_AGENT_DBUS_NAME_PREFIX, mInterfaceName);
-    otbrLog(OTBR_LOG_INFO, "NCP requesting DBus name %s...", dbusName);
-    VerifyOrExit(dbus_bus_request_name(mDBus, dbusName, DBUS_NAME_FLAG_DO_NOT_QUEUE, &error) ==
-                 DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER);
+DBusMessage *ControllerWpantund::SendWithReplyAndBlock(DBusMessage &aMessage, int aTimeout, DBusError &aError)
+{
+    DBusMessage *reply = NULL;
+    sem_t        done;
+    ReplyContext context = {this, kReplyBlocking, kEventNone, &done, NULL};
 
-    VerifyOrExit(
-        dbus_connection_set_watch_functions(mDBus, AddDBusWatch, RemoveDBusWatch, ToggleDBusWatch, this, NULL));
+    VerifyOrExit(mBus->mThreaded,
+                 reply = dbus_connection_send_with_reply_and_block(mDBus, &aMessage, aTimeout, &aError));
 
-    dbus_bus_add_match(mDBus, kDBusMatchPropChanged, &error);
-    VerifyOrExit(!dbus_error_is_set(&error));
+    // Only the dispatch thread reads the connection, it wakes the caller with the reply.
+    VerifyOrExit(sem_init(&done, 0, 0) == 0, dbus_set_error_const(&aError, DBUS_ERROR_FAILED, "No semaphore"));
 
-    VerifyOrExit(dbus_connection_add_filter(mDBus, HandlePropertyChangedSignal, this, NULL));
+    if (PushBusRequest(&aMessage, context, aTimeout) == OTBR_ERROR_NONE)
+    {
+        while (sem_wait(&done) != 0)
+            ;
 
-    ret = OTBR_ERROR_NONE;
+        reply = context.mReply;
+    }
 
-exit:
-    if (dbus_error_is_set(&error))
+    sem_destroy(&done);
+
+    if (reply == NULL)
     {
-        HandleDBusError(error);
+        dbus_set_error_const(&aError, DBUS_ERROR_FAILED, "Failed to send the request");
     }
-
-    if (ret)
+    else if (dbus_set_error_from_message(&aError, reply))
     {
-        if (mDBus)
-        {
-            dbus_connection_unref(mDBus);
-            mDBus = NULL;
-        }
-        otbrLog(OTBR_LOG_ERR, "NCP failed to initialize!");
+        dbus_message_unref(reply);
+        reply = NULL;
     }
 
-    return ret;
+exit:
+    return reply;
 }
 
-ControllerWpantund::~ControllerWpantund(void)
+bool ControllerWpantund::CheckReply(DBusMessage *aReply)
 {
-    TmfProxyStop();
+    bool      ok = false;
+    DBusError error;
+
+    dbus_error_init(&error);
 
-    if (mDBus)
+    VerifyOrExit(aReply != NULL);
+
+    if (dbus_set_error_from_message(&error, aReply))
     {
-        dbus_connection_unref(mDBus);
-        mDBus = NULL;
+        HandleDBusError(error);
+        ExitNow();
     }
+
+    ok = true;
+
+exit:
+    return ok;
 }
 
-otbrError ControllerWpantund::TmfProxyStart(void)
+void ControllerWpantund::HandlePendingReply(DBusPendingCall *aPending, void *aContext)
 {
-    otbrError ret = OTBR_ERROR_ERRNO;
+    DBusMessage *reply = dbus_pending_call_steal_reply(aPending);
 
-    VerifyOrExit(lookup_dbus_name_from_interface(mInterfaceDBusName, mInterfaceName) == 0,
-                 otbrLog(OTBR_LOG_ERR, "NCP failed to find the interface!"), errno = ENODEV);
-
-    // Populate the path according to source code of wpanctl, better to export a function.
-    snprintf(mInterfaceDBusPath, sizeof(mInterfaceDBusPath), "%s/%s", WPANTUND_DBUS_PATH, mInterfaceName);
+    dbus_pending_call_unref(aPending);
+    DeliverReply(*static_cast<ReplyContext *>(aContext), reply);
+}
 
-    ret = TmfProxyEnable(TRUE);
+void ControllerWpantund::DeliverReply(ReplyContext &aContext, DBusMessage *aReply)
+{
+    if (aContext.mType == kReplyBlocking)
+    {
+        aContext.mReply = aReply;
+        sem_post(aContext.mDone);
+    }
+    else if (aContext.mType == kReplyTmfProxyEnable)
+    {
+        if (!CheckReply(aReply))
+        {
+            otbrLog(OTBR_LOG_ERR, "NCP failed to update TMF proxy!");
+        }
 
-exit:
+        if (aReply != NULL)
+        {
+            dbus_message_unref(aReply);
+        }
+    }
+    else if (aContext.mController->mBus->mThreaded)
+    {
+        // Called by the dispatch thread, the reply is handled by the reactor.
+        aContext.mController->PostBusEvent(aReply, &aContext);
+    }
+    else
+    {
+        aContext.mController->HandleReply(aContext, aReply);
 
-    return ret;
+        if (aReply != NULL)
+        {
+            dbus_message_unref(aReply);
+        }
+    }
 }
 
-otbrError ControllerWpantund::TmfProxySend(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort)
+void ControllerWpantund::HandleReply(ReplyContext &aContext, DBusMessage *aReply)
 {
-    otbrError    ret     = OTBR_ERROR_ERRNO;
-    DBusMessage *message = NULL;
-
-    std::vector<uint8_t> data(aLength + sizeof(aLocator) + sizeof(aPort));
-    const uint8_t *      value = data.data();
-    const char *         key   = kWPANTUNDProperty_TmfProxyStream;
+    int32_t                          status = 0;
+    BorderRouter::Bus::LibdbusReader reader;
 
-    memcpy(data.data(), aBuffer, aLength);
-    data[aLength]     = (aLocator >> 8);
-    data[aLength + 1] = (aLocator & 0xff);
-    data[aLength + 2] = (aPort >> 8);
-    data[aLength + 3] = (aPort & 0xff);
+    switch (aContext.mType)
+    {
+    case kReplyTmfProxy:
+        ReleaseTmfProxyInFlight();
 
-    message = dbus_message_new_method_call(mInterfaceDBusName, mInterfaceDBusPath, WPANTUND_DBUS_APIv1_INTERFACE,
-                                           WPANTUND_IF_CMD_PROP_SET);
+        if (!CheckReply(aReply))
+        {
+            ++mTmfProxyFailed;
+        }
+        break;
 
-    VerifyOrExit(message != NULL, errno = ENOMEM);
+    case kReplyPropGet:
+        VerifyOrExit(CheckReply(aReply));
+        VerifyOrExit(reader.Init(*aReply) && reader.ReadBasic(BorderRouter::Bus::kTypeInt32, &status));
+        VerifyOrExit(status == SPINEL_STATUS_OK, otbrLog(OTBR_LOG_WARNING, "NCP property status %d", status));
 
-    VerifyOrExit(dbus_message_append_args(message, DBUS_TYPE_STRING, &key, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &value,
-                                          data.size(), DBUS_TYPE_INVALID),
-                 errno = EINVAL);
+        ParseEvent(aContext.mEvent, reader);
+        break;
 
-    VerifyOrExit(dbus_connection_send(mDBus, message, NULL), errno = ENOMEM);
+    case kReplyInterfaces:
+        HandleInterfaces(aReply);
+        break;
 
-    ret = OTBR_ERROR_NONE;
+    default:
+        break;
+    }
 
 exit:
+    return;
+}
 
-    if (message)
+void ControllerWpantund::FlushTmfProxy(void)
+{
+    for (uint8_t i = 0; i < mTmfProxyOutgoingCount; ++i)
     {
-        dbus_message_unref(message);
+        if (SendWithReply(*mTmfProxyOutgoing[i], mTmfProxyReply) != OTBR_ERROR_NONE)
+        {
+            // The sender was already told the packet is sent, it is counted as rejected instead.
+            ReleaseTmfProxyInFlight();
+            ++mTmfProxyFailed;
+        }
+
+        dbus_message_unref(mTmfProxyOutgoing[i]);
     }
 
-    return ret;
+    mTmfProxyOutgoingCount = 0;
+}
+
+void ControllerWpantund::ReleaseTmfProxyInFlight(void)
+{
+    size_t size;
+
+    assert(mTmfProxyInFlight > 0);
+
+    // Replies do not tell which packet they acknowledge, so the packets in flight are released by their mean size,
+    // which releases all their bytes with the last reply.
+    size = mTmfProxyInFlightBytes / mTmfProxyInFlight;
+    mTmfProxyInFlightBytes -= size;
+    --mTmfProxyInFlight;
+    sTmfProxyInFlight.Subtract();
+    sTmfProxyMemory.Free(size);
 }
 
 otbrError ControllerWpantund::TmfProxyStop(void)
@@ -375,14 +1758,15 @@ otbrError ControllerWpantund::TmfProxyStop(void)
 
 void ControllerWpantund::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd)
 {
-    for (WatchMap::iterator it = mWatches.begin(); it != mWatches.end(); ++it)
+    // Watches are registered with the reactor directly.
+    for (WatchMap::Iterator it = mBus->mWatches.Begin(); mReactor == NULL && it != mBus->mWatches.End(); ++it)
     {
-        if (!it->second)
+        if (!it->mValue)
         {
             continue;
         }
 
-        DBusWatch *  watch = it->first;
+        DBusWatch *  watch = it->mKey;
         unsigned int flags = dbus_watch_get_flags(watch);
         int          fd    = dbus_watch_get_unix_fd(watch);
 
@@ -408,18 +1792,28 @@ void ControllerWpantund::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd
             aMaxFd = fd;
         }
     }
+
+    if (mBus->mThreaded && mReactor == NULL)
+    {
+        FD_SET(mBusPipe[0], &aReadFdSet);
+
+        if (mBusPipe[0] > aMaxFd)
+        {
+            aMaxFd = mBusPipe[0];
+        }
+    }
 }
 
 void ControllerWpantund::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
 {
-    for (WatchMap::iterator it = mWatches.begin(); it != mWatches.end(); ++it)
+    for (WatchMap::Iterator it = mBus->mWatches.Begin(); mReactor == NULL && it != mBus->mWatches.End(); ++it)
     {
-        if (!it->second)
+        if (!it->mValue)
         {
             continue;
         }
 
-        DBusWatch *  watch = it->first;
+        DBusWatch *  watch = it->mKey;
         unsigned int flags = dbus_watch_get_flags(watch);
         int          fd    = dbus_watch_get_unix_fd(watch);
 
@@ -446,9 +1840,115 @@ void ControllerWpantund::Process(const fd_set &aReadFdSet, const fd_set &aWriteF
         dbus_watch_handle(watch, flags);
     }
 
-    while (DBUS_DISPATCH_DATA_REMAINS == dbus_connection_get_dispatch_status(mDBus) &&
-           dbus_connection_read_write_dispatch(mDBus, 0))
-        ;
+    if (mBus->mThreaded)
+    {
+        // The events are otherwise handled as the reactor sees the pipe.
+        if (mReactor == NULL && FD_ISSET(mBusPipe[0], &aReadFdSet))
+        {
+            HandleBusEvents(this, mBusPipe[0], Reactor::kEventReadable);
+        }
+    }
+    else
+    {
+        DispatchBus();
+    }
+}
+
+void ControllerWpantund::DispatchBus(void)
+{
+    // Each message queues at most one packet, dispatching stops while the queue is full.
+    Timeline::Span span("ncp.dbus_dispatch");
+
+    do
+    {
+        while (mTmfProxyQueueCount < kTmfProxyQueueSize &&
+               DBUS_DISPATCH_DATA_REMAINS == dbus_connection_get_dispatch_status(mDBus) &&
+               dbus_connection_read_write_dispatch(mDBus, 0))
+            ;
+
+        EmitEvents();
+    } while (DBUS_DISPATCH_DATA_REMAINS == dbus_connection_get_dispatch_status(mDBus));
+}
+
+void ControllerWpantund::EmitEvents(void)
+{
+    // Handlers requesting events get them emitted by the outer call.
+    VerifyOrExit(!mEmitting);
+    mEmitting = true;
+
+    while (mPendingEvents != 0)
+    {
+        int event = 0;
+
+        while ((mPendingEvents & (1U << event)) == 0)
+        {
+            ++event;
+        }
+
+        mPendingEvents &= ~(1U << event);
+
+        switch (event)
+        {
+        case kEventExtPanId:
+        {
+            ExtPanIdEvent payload = {mExtPanId};
+            EmitPayload(payload);
+            break;
+        }
+
+        case kEventNetworkName:
+        {
+            NetworkNameEvent payload = {mNetworkName};
+            EmitPayload(payload);
+            break;
+        }
+
+        case kEventPSKc:
+        {
+            PSKcEvent payload = {mPSKc};
+            EmitPayload(payload);
+            break;
+        }
+
+        case kEventThreadState:
+        {
+            // The NCP state tells whether associated, not in which role.
+            ThreadStateEvent payload = {mThreadAssociated,
+                                        mThreadAssociated ? kThreadRoleUnknown : kThreadRoleDetached};
+            EmitPayload(payload);
+            break;
+        }
+
+        case kEventNetworkData:
+        {
+            NetworkDataEvent payload = {mNetworkData, mNetworkDataLength};
+            EmitPayload(payload);
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    // All the packets queued by one dispatching round are fed at once.
+    while (mTmfProxyQueueCount > 0)
+    {
+        const TmfProxyPacket &packet  = mTmfProxyQueue[mTmfProxyQueueHead];
+        TmfProxyStreamEvent   payload = {packet.mBuffer, packet.mLength, packet.mLocator, packet.mPort};
+
+        OTBR_PROBE3(ncp_tmf_receive, packet.mLength, packet.mLocator, packet.mPort);
+        EmitPayload(payload);
+
+        mTmfProxyQueueHead = (mTmfProxyQueueHead + 1) % kTmfProxyQueueSize;
+        --mTmfProxyQueueCount;
+    }
+
+    FlushTmfProxy();
+    mEmitting = false;
+
+exit:
+    return;
 }
 
 DBusMessage *ControllerWpantund::RequestProperty(const char *aKey)
@@ -466,7 +1966,7 @@ DBusMessage *ControllerWpantund::RequestProperty(const char *aKey)
 
     VerifyOrExit(dbus_message_append_args(message, DBUS_TYPE_STRING, &aKey, DBUS_TYPE_INVALID), errno = EINVAL);
 
-    reply = dbus_connection_send_with_reply_and_block(mDBus, message, timeout, &error);
+    reply = SendWithReplyAndBlock(*message, timeout, error);
 
 exit:
 
@@ -486,55 +1986,41 @@ exit:
 
 otbrError ControllerWpantund::RequestEvent(int aEvent)
 {
-    otbrError       ret     = OTBR_ERROR_ERRNO;
-    DBusMessage *   message = NULL;
-    DBusMessage *   reply   = NULL;
-    DBusMessageIter iter;
-    const char *    key     = NULL;
-    const int       timeout = DEFAULT_TIMEOUT_IN_SECONDS * 1000;
-    DBusError       error;
-
-    switch (aEvent)
+    otbrError                        ret     = OTBR_ERROR_ERRNO;
+    DBusMessage *                    message = NULL;
+    DBusMessage *                    reply   = NULL;
+    BorderRouter::Bus::LibdbusReader reader;
+    const char *                     key     = NULL;
+    const int                        timeout = DEFAULT_TIMEOUT_IN_SECONDS * 1000;
+    DBusError                        error;
+
+    // The TMF stream is not a property to read.
+    for (size_t i = 0; aEvent != kEventTmfProxyStream && i < sizeof(kPropertyEvents) / sizeof(kPropertyEvents[0]); ++i)
     {
-    case kEventExtPanId:
-        key = kWPANTUNDProperty_NetworkXPANID;
-        break;
-    case kEventThreadState:
-        key = kWPANTUNDProperty_NCPState;
-        break;
-    case kEventNetworkName:
-        key = kWPANTUNDProperty_NetworkName;
-        break;
-    case kEventPSKc:
-        key = kWPANTUNDProperty_NetworkPSKc;
-        break;
-    default:
-        otbrLog(OTBR_LOG_WARNING, "Unknown event %d", aEvent);
-        break;
+        if (kPropertyEvents[i].mEvent == aEvent)
+        {
+            key = kPropertyEvents[i].mKey;
+            break;
+        }
     }
 
-    VerifyOrExit(key != NULL, errno = EINVAL);
+    VerifyOrExit(key != NULL, otbrLog(OTBR_LOG_WARNING, "Unknown event %d", aEvent), errno = EINVAL);
     otbrLog(OTBR_LOG_DEBUG, "Requesting %s...", key);
-    VerifyOrExit((message = dbus_message_new_method_call(mInterfaceDBusName, mInterfaceDBusPath,
-                                                         WPANTUND_DBUS_APIv1_INTERFACE, WPANTUND_IF_CMD_PROP_GET)) !=
-                     NULL,
-                 errno = ENOMEM);
-
-    VerifyOrExit(dbus_message_append_args(message, DBUS_TYPE_STRING, &key, DBUS_TYPE_INVALID), errno = EINVAL);
+    VerifyOrExit((message = NewPropGet(key)) != NULL);
 
     dbus_error_init(&error);
-    reply = dbus_connection_send_with_reply_and_block(mDBus, message, timeout, &error);
+    reply = SendWithReplyAndBlock(*message, timeout, error);
     VerifyOrExit(reply != NULL, HandleDBusError(error), ret = OTBR_ERROR_DBUS);
-    VerifyOrExit(dbus_message_iter_init(reply, &iter), errno = ENOENT);
+    VerifyOrExit(reader.Init(*reply), errno = ENOENT);
 
     {
-        uint32_t status = 0;
-        dbus_message_iter_get_basic(&iter, &status);
-        VerifyOrExit(status == SPINEL_STATUS_OK, errno = EREMOTEIO);
+        int32_t status = 0;
+        VerifyOrExit(reader.ReadBasic(BorderRouter::Bus::kTypeInt32, &status) && status == SPINEL_STATUS_OK,
+                     errno = EREMOTEIO);
     }
 
-    dbus_message_iter_next(&iter);
-    ret = ParseEvent(key, &iter);
+    SuccessOrExit(ret = ParseEvent(aEvent, reader));
+    EmitEvents();
 
 exit:
 
@@ -555,6 +2041,96 @@ exit:
     return ret;
 }
 
+otbrError ControllerWpantund::RequestEvents(void)
+{
+    otbrError ret = OTBR_ERROR_NONE;
+
+    // All requests are sent before any reply is handled, fetching all the properties takes one round trip.
+    for (size_t i = 0; i < sizeof(kPropertyEvents) / sizeof(kPropertyEvents[0]); ++i)
+    {
+        int          event   = kPropertyEvents[i].mEvent;
+        DBusMessage *message = NULL;
+
+        if (event >= kNumCachedEvents)
+        {
+            continue;
+        }
+
+        if ((message = NewPropGet(kPropertyEvents[i].mKey)) == NULL ||
+            SendWithReply(*message, mPropertyRequests[event]) != OTBR_ERROR_NONE)
+        {
+            otbrLog(OTBR_LOG_WARNING, "Error requesting %s:%s", kPropertyEvents[i].mKey, strerror(errno));
+            ret = OTBR_ERROR_ERRNO;
+        }
+
+        if (message != NULL)
+        {
+            dbus_message_unref(message);
+        }
+    }
+
+    return ret;
+}
+
+DBusMessage *ControllerWpantund::NewPropGet(const char *aKey)
+{
+    DBusMessage *message = NULL;
+
+    VerifyOrExit((message = dbus_message_new_method_call(mInterfaceDBusName, mInterfaceDBusPath,
+                                                         WPANTUND_DBUS_APIv1_INTERFACE, WPANTUND_IF_CMD_PROP_GET)) !=
+                     NULL,
+                 errno = ENOMEM);
+
+    if (!dbus_message_append_args(message, DBUS_TYPE_STRING, &aKey, DBUS_TYPE_INVALID))
+    {
+        dbus_message_unref(message);
+        message = NULL;
+        errno   = EINVAL;
+    }
+
+exit:
+    return message;
+}
+
+bool ControllerWpantund::IsCached(int aEvent) const
+{
+    bool cached = (mCachedEvents & (1U << aEvent)) != 0;
+
+    if (!cached)
+    {
+        errno = ENOENT;
+    }
+
+    return cached;
+}
+
+const uint8_t *ControllerWpantund::GetPSKc(void) const
+{
+    return IsCached(kEventPSKc) ? mPSKc : NULL;
+}
+
+const char *ControllerWpantund::GetNetworkName(void) const
+{
+    return IsCached(kEventNetworkName) ? mNetworkName : NULL;
+}
+
+const uint8_t *ControllerWpantund::GetExtPanId(void) const
+{
+    return IsCached(kEventExtPanId) ? mExtPanId : NULL;
+}
+
+otbrError ControllerWpantund::GetThreadState(bool &aAssociated) const
+{
+    otbrError ret = OTBR_ERROR_ERRNO;
+
+    VerifyOrExit(IsCached(kEventThreadState));
+    aAssociated = mThreadAssociated;
+    ret         = OTBR_ERROR_NONE;
+
+exit:
+    return ret;
+}
+
 otbrError ControllerWpantund::GetProperty(const char *aKey, uint8_t *aBuffer, size_t &aSize)
 {
     otbrError    ret   = OTBR_ERROR_ERRNO;
@@ -610,16 +2186,6 @@ exit:
     return ret;
 }
 
-Controller *Controller::Create(const char *aInterfaceName)
-{
-    return new ControllerWpantund(aInterfaceName);
-}
-
-void Controller::Destroy(Controller *aController)
-{
-    delete static_cast<ControllerWpantund *>(aController);
-}
-
 } // namespace Ncp
 
 } // namespace BorderRouter
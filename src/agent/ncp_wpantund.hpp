@@ -34,15 +34,18 @@
 #ifndef NCP_WPANTUND_HPP_
 #define NCP_WPANTUND_HPP_
 
-#include <map>
-
 #include <arpa/inet.h>
 #include <dbus/dbus.h>
 #include <net/if.h>
+#include <pthread.h>
+#include <semaphore.h>
 #include <stdint.h>
 #include <sys/select.h>
 
 #include "ncp.hpp"
+#include "common/bus.hpp"
+#include "common/flat_map.hpp"
+#include "common/packet_ring.hpp"
 
 namespace ot {
 
@@ -53,6 +56,15 @@ namespace Ncp {
 /**
  * This class provides NCP service based on wpantund.
  *
+ * The controllers of a reactor share a bus connection, each filtering the signals of its interface.
+ *
+ * With the dispatch thread, the connection is read, written and dispatched by a thread of its own instead of the
+ * reactor. Signals and replies are then handed to the reactor through a ring, and requests to the thread through
+ * another, so that bus traffic does not delay the rest of the mainloop.
+ *
+ * When wpantund leaves the bus, TMF proxy packets are dropped until it is back. Its interface is then looked up
+ * without blocking, retried with backoff until wpantund registers it, and the TMF proxy is enabled again.
+ *
  */
 class ControllerWpantund : public Controller
 {
@@ -61,9 +73,12 @@ public:
      * The contructor to initialize a Ncp Controller.
      *
      * @param[in]   aInterfaceName  A string of the NCP interface.
+     * @param[in]   aReactor        A pointer to the reactor, NULL to use the fd_set interface.
+     * @param[in]   aTimerWheel     A pointer to the timer wheel running the DBus timeouts, NULL to leave pending
+     *                              calls without timeout.
      *
      */
-    ControllerWpantund(const char *aInterfaceName);
+    ControllerWpantund(const char *aInterfaceName, Reactor *aReactor, TimerWheel *aTimerWheel = NULL);
     ~ControllerWpantund(void);
 
     /*
@@ -102,6 +117,19 @@ public:
      */
     virtual otbrError TmfProxySend(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort);
 
+    /**
+     * This method returns the counters of the TMF proxy service.
+     *
+     * @param[out]  aDropped    The number of packets dropped for too many not yet acknowledged.
+     * @param[out]  aFailed     The number of packets rejected by the NCP.
+     *
+     */
+    virtual void GetTmfProxyCounters(uint32_t &aDropped, uint32_t &aFailed) const
+    {
+        aDropped = mTmfProxyDropped;
+        aFailed  = mTmfProxyFailed;
+    }
+
     /**
      * This method updates the fd_set to poll.
      *
@@ -144,34 +172,346 @@ public:
      */
     virtual otbrError RequestEvent(int aEvent);
 
+    /**
+     * This method requests the events of all the cached properties at once.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully sent all the requests.
+     * @retval  OTBR_ERROR_ERRNO        Failed to send some of the requests.
+     *
+     */
+    virtual otbrError RequestEvents(void);
+
+    /**
+     * This method returns the cached PSKc.
+     *
+     * @retval  NULL    The PSKc is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual const uint8_t *GetPSKc(void) const;
+
+    /**
+     * This method returns the cached network name.
+     *
+     * @retval  NULL    The network name is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual const char *GetNetworkName(void) const;
+
+    /**
+     * This method returns the cached extended PAN ID.
+     *
+     * @retval  NULL    The extended PAN ID is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual const uint8_t *GetExtPanId(void) const;
+
+    /**
+     * This method returns the cached Thread state.
+     *
+     * @param[out]  aAssociated     Whether the NCP is associated to the Thread network.
+     *
+     * @retval  OTBR_ERROR_NONE         Successfully returned the Thread state.
+     * @retval  OTBR_ERROR_ERRNO        The Thread state is not known yet, errno is set to ENOENT.
+     *
+     */
+    virtual otbrError GetThreadState(bool &aAssociated) const;
+
+    /**
+     * This method sets whether the bus connections are dispatched by a thread of their own.
+     *
+     * This method must be called before any controller is initialized.
+     *
+     * @param[in]   aEnabled    Whether to dispatch on a thread of its own.
+     *
+     */
+    static void SetDispatchThread(bool aEnabled) { sDispatchThread = aEnabled; }
+
+    /**
+     * This method sets the limits of the bus connections, open or opened later.
+     *
+     * @param[in]   aMaxReceived    Max bytes of messages received and not yet dispatched, 0 to keep it.
+     * @param[in]   aMaxOutgoing    Max bytes of messages queued to be written, 0 to keep it.
+     *
+     */
+    static void SetBusLimits(uint32_t aMaxReceived, uint32_t aMaxOutgoing);
+
 private:
+    enum
+    {
+        kSizeTmfProxyTrailer  = 4,    ///< Size of the locator and port appended to TMF proxy packets.
+        kMaxTmfProxyPacket    = 1280, ///< Max size of a TMF proxy packet.
+        kMaxTmfProxyInFlight  = 32,   ///< Max number of TMF proxy packets not yet acknowledged by wpantund.
+        kTmfProxyReplyTimeout = 5000, ///< Time in milliseconds to wait for wpantund to acknowledge a packet.
+        kTmfProxyQueueSize    = 16,   ///< Max number of received TMF proxy packets queued for emitting.
+        kPropertyBuckets      = 16,   ///< Number of buckets of the property table, a power of 2.
+        kEventNone            = -1,   ///< No event for the property.
+        kNumCachedEvents      = 5,    ///< Number of events of cached properties, those below kEventTmfProxyStream.
+        kBusQueueSize         = 128,  ///< Max number of messages queued between the dispatch thread and the reactor.
+        kBusQueueReserved     = 64,   ///< Number of queued messages reserved for replies, signals are dropped beyond.
+        kBusPollTimeout       = 1000, ///< Max time in milliseconds the dispatch thread waits before checking for stop.
+        kReconnectMinDelay    = 100,  ///< Time in milliseconds before looking up the interface again at first.
+        kReconnectMaxDelay    = 5000, ///< Max time in milliseconds before looking up the interface again.
+    };
+
+    enum
+    {
+        kBusMaxMessageSize  = 65536,  ///< Max size of a message received, the connection is closed beyond.
+        kDefaultMaxReceived = 262144, ///< Default max bytes of messages received and not yet dispatched.
+        kDefaultMaxOutgoing = 65536,  ///< Default max bytes of messages queued to be written.
+    };
+
+    /**
+     * Types of replies.
+     *
+     */
+    enum
+    {
+        kReplyTmfProxy,       ///< The acknowledgement of a TMF proxy packet.
+        kReplyTmfProxyEnable, ///< The reply to enabling or disabling the TMF proxy.
+        kReplyPropGet,        ///< The reply to a property request.
+        kReplyInterfaces,     ///< The reply to the lookup of the interfaces of wpantund.
+        kReplyBlocking,       ///< The reply a caller is blocked waiting for.
+    };
+
+    /**
+     * This struct is the context of a pending call.
+     *
+     */
+    struct ReplyContext
+    {
+        ControllerWpantund *mController; ///< The controller, NULL for kReplyTmfProxyEnable.
+        int                 mType;       ///< The type of the reply.
+        int                 mEvent;      ///< The event of the requested property, for kReplyPropGet.
+        sem_t *             mDone;       ///< Posted once mReply is set, for kReplyBlocking.
+        DBusMessage *       mReply;      ///< The reply, for kReplyBlocking.
+    };
+
+    /**
+     * This struct is a message handed from the dispatch thread to the reactor.
+     *
+     */
+    struct BusEvent
+    {
+        DBusMessage * mMessage; ///< The message, NULL if the call failed.
+        ReplyContext *mContext; ///< The context of the reply, NULL for a signal.
+    };
+
+    /**
+     * This struct is a call handed from the reactor to the dispatch thread.
+     *
+     */
+    struct BusRequest
+    {
+        DBusMessage * mMessage; ///< The message, NULL to only post the context once earlier requests are sent.
+        ReplyContext *mContext; ///< The context of the reply.
+        int           mTimeout; ///< The timeout of the reply in milliseconds.
+    };
+
+    /**
+     * This struct defines an entry of the property table.
+     *
+     */
+    struct PropertyEntry
+    {
+        const char *mKey;   ///< The property key, NULL if the entry is unused.
+        uint32_t    mHash;  ///< The hash of the key.
+        int         mEvent; ///< The event raised when the property changes.
+    };
+
+    /**
+     * This struct is a received TMF proxy packet queued for emitting.
+     *
+     */
+    struct TmfProxyPacket
+    {
+        uint16_t mLength;                     ///< Number of bytes of mBuffer.
+        uint16_t mLocator;                    ///< The RLOC16 of the peer.
+        uint16_t mPort;                       ///< The UDP port of the peer.
+        uint8_t  mBuffer[kMaxTmfProxyPacket]; ///< The packet.
+    };
+
     /**
      * This map is used to track DBusWatch-es.
      *
      */
-    typedef std::map<DBusWatch *, bool> WatchMap;
+    typedef FlatMap<DBusWatch *, bool> WatchMap;
 
     static DBusHandlerResult HandlePropertyChangedSignal(DBusConnection *aConnection,
                                                          DBusMessage *   aMessage,
                                                          void *          aContext);
     DBusHandlerResult        HandlePropertyChangedSignal(DBusMessage &aMessage);
+    DBusHandlerResult        PostPropertyChangedSignal(DBusMessage &aMessage);
+    static bool              IsNameOwnerChanged(DBusMessage &aMessage);
+    void                     HandleNameOwnerChanged(DBusMessage &aMessage);
 
     DBusMessage *RequestProperty(const char *aKey);
     otbrError    GetProperty(const char *aKey, uint8_t *aBuffer, size_t &aSize);
-    otbrError    ParseEvent(const char *aKey, DBusMessageIter *aIter);
+    otbrError    ParseEvent(int aEvent, BorderRouter::Bus::Reader &aReader);
+    void         DispatchBus(void);
+    void         EmitEvents(void);
+    void         FlushTmfProxy(void);
 
-    otbrError TmfProxyEnable(dbus_bool_t aEnable);
+    static uint32_t HashKey(const char *aKey);
+    void            InitPropertyTable(void);
+    int             FindEvent(const char *aKey) const;
+
+    DBusMessage *NewPropGet(const char *aKey);
+    bool         IsCached(int aEvent) const;
+    uint32_t     RequestName(const char *aName, DBusError &aError);
+    bool         UpdateMatches(bool aAdd);
+
+    otbrError    TmfProxyEnable(dbus_bool_t aEnable);
+    otbrError    TmfProxyPrepare(void);
+    otbrError    SendWithReply(DBusMessage &aMessage, ReplyContext &aContext, int aTimeout = kTmfProxyReplyTimeout);
+    DBusMessage *SendWithReplyAndBlock(DBusMessage &aMessage, int aTimeout, DBusError &aError);
+    static bool  CheckReply(DBusMessage *aReply);
+    static void  HandlePendingReply(DBusPendingCall *aPending, void *aContext);
+    static void  DeliverReply(ReplyContext &aContext, DBusMessage *aReply);
+    void         HandleReply(ReplyContext &aContext, DBusMessage *aReply);
+    void         ReleaseTmfProxyInFlight(void);
+
+    void        Reconnect(void);
+    void        ScheduleReconnect(void);
+    void        HandleInterfaces(DBusMessage *aReply);
+    static void HandleReconnectTimer(void *aContext);
+
+    otbrError   PushBusRequest(DBusMessage *aMessage, ReplyContext &aContext, int aTimeout);
+    void        SyncBus(void);
+    bool        PostBusEvent(DBusMessage *aMessage, ReplyContext *aContext);
+    static void HandleBusEvents(void *aContext, int aFd, unsigned int aEvents);
+    void        ProcessBusEvents(void);
+    void        CloseBusEvents(void);
 
     static dbus_bool_t AddDBusWatch(struct DBusWatch *aWatch, void *aContext);
     static void        RemoveDBusWatch(struct DBusWatch *aWatch, void *aContext);
     static void        ToggleDBusWatch(struct DBusWatch *aWatch, void *aContext);
+    static void        HandleDBusWatch(void *aContext, int aFd, unsigned int aEvents);
+    static void        FreeDBusWatch(void *aWatch);
+    static void        UpdateDBusWatch(Reactor &aReactor, DBusWatch &aWatch);
+
+    static dbus_bool_t AddDBusTimeout(DBusTimeout *aTimeout, void *aContext);
+    static void        RemoveDBusTimeout(DBusTimeout *aTimeout, void *aContext);
+    static void        ToggleDBusTimeout(DBusTimeout *aTimeout, void *aContext);
+    static void        HandleDBusTimeout(void *aContext);
+    static void        FreeDBusTimeout(void *aTimeout);
+    static void        HandleDispatchStatus(DBusConnection *aConnection, DBusDispatchStatus aStatus, void *aContext);
+    static void        HandleDispatchTimer(void *aContext);
+
+    /**
+     * This struct is a bus connection shared by the controllers of a reactor.
+     *
+     * Each reactor has a private connection, so that a connection is only used by the thread running its reactor,
+     * or by the dispatch thread of the connection.
+     *
+     */
+    struct Bus
+    {
+        Bus(Reactor *aReactor, TimerWheel *aTimerWheel)
+            : mReactor(aReactor)
+            , mTimerWheel(aTimerWheel)
+            , mDBus(NULL)
+            , mUsers(0)
+            , mDispatchTimer(HandleDispatchTimer, this)
+            , mNext(NULL)
+            , mThreaded(false)
+            , mStopping(false)
+            , mSleeping(false)
+        {
+            mWakePipe[0] = -1;
+            mWakePipe[1] = -1;
+        }
+
+        Reactor *       mReactor;       ///< The reactor the watches are registered with, NULL for UpdateFdSet().
+        TimerWheel *    mTimerWheel;    ///< The timer wheel running the timeouts, NULL if there are none.
+        DBusConnection *mDBus;          ///< The bus connection.
+        unsigned int    mUsers;         ///< Number of controllers using the connection.
+        WatchMap        mWatches;       ///< The watches of the connection.
+        Timer           mDispatchTimer; ///< Wakes the mainloop when messages are waiting to be dispatched.
+        Bus *           mNext;          ///< The next bus connection.
+
+        bool       mThreaded;    ///< Whether the connection is dispatched by mThread, which owns mTimerWheel.
+        bool       mStopping;    ///< Whether mThread is asked to stop.
+        bool       mSleeping;    ///< Whether mThread is about to wait, and needs waking for new requests.
+        pthread_t  mThread;      ///< The dispatch thread.
+        int        mWakePipe[2]; ///< Wakes mThread.
+        PacketRing mRequests;    ///< The BusRequest-s to mThread.
+    };
+
+    /**
+     * This struct is the timer running a DBus timeout.
+     *
+     */
+    struct BusTimeout
+    {
+        BusTimeout(DBusTimeout &aTimeout, Bus &aBus)
+            : mTimer(HandleDBusTimeout, this)
+            , mTimeout(aTimeout)
+            , mBus(aBus)
+        {
+        }
+
+        Timer        mTimer;   ///< The timer.
+        DBusTimeout &mTimeout; ///< The DBus timeout.
+        Bus &        mBus;     ///< The bus connection of the timeout.
+    };
+
+    static Bus * AcquireBus(Reactor *aReactor, TimerWheel *aTimerWheel, DBusError &aError);
+    static void  ReleaseBus(Bus &aBus);
+    static bool  StartBusThread(Bus &aBus);
+    static void *RunBusThread(void *aBus);
+    static void  SendBusRequests(Bus &aBus);
+    static void  WakeBus(void *aBus);
+
+    static Bus *           sBuses;
+    static pthread_mutex_t sBusesLock;
+    static bool            sDispatchThread;
+    static uint32_t        sBusMaxReceived; ///< Protected by sBusesLock.
+    static uint32_t        sBusMaxOutgoing;
+    static ReplyContext    sTmfProxyEnableReply;
 
     char            mInterfaceDBusName[DBUS_MAXIMUM_NAME_LENGTH + 1];
     char            mInterfaceDBusPath[DBUS_MAXIMUM_NAME_LENGTH + 1];
     uint8_t         mEui64[kSizeEui64];
     char            mInterfaceName[IFNAMSIZ];
+    Bus *           mBus;
     DBusConnection *mDBus;
-    WatchMap        mWatches;
+    Reactor *       mReactor;
+    TimerWheel *    mTimerWheel;
+    PropertyEntry   mPropertyTable[kPropertyBuckets];
+    ReplyContext    mPropertyRequests[kNumCachedEvents];
+    ReplyContext    mTmfProxyReply;
+    ReplyContext    mInterfacesReply;
+    Timer           mReconnectTimer; ///< Looks up the interface again.
+    uint32_t        mReconnectDelay; ///< Time in milliseconds before the next lookup, doubled for each one failed.
+    bool            mReconnecting;   ///< Whether a lookup is in flight or scheduled.
+    bool            mMatched;        ///< Whether the match rules of the signals handled here were added to the bus.
+
+    DBusMessage *mTmfProxyTemplate;      ///< The header of TMF proxy writes.
+    unsigned int mTmfProxyInFlight;      ///< Packets not yet acknowledged.
+    size_t       mTmfProxyInFlightBytes; ///< Bytes of mTmfProxyInFlight packets.
+    uint32_t     mTmfProxyDropped;       ///< Packets dropped for the window or the bytes queued to be written.
+    uint32_t     mTmfProxyFailed;        ///< Packets rejected by wpantund.
+
+    uint8_t      mPSKc[kSizePSKc];                   ///< The cached PSKc.
+    char         mNetworkName[kSizeNetworkName + 1]; ///< The cached network name.
+    uint8_t      mExtPanId[kSizeExtPanId];           ///< The cached extended PAN ID.
+    bool         mThreadAssociated;                  ///< The cached Thread state.
+    uint8_t      mNetworkData[kSizeNetworkData];     ///< The cached Thread Network Data.
+    uint16_t     mNetworkDataLength;                 ///< Number of bytes of mNetworkData.
+    unsigned int mCachedEvents;                      ///< Bit mask of the events whose property is cached.
+
+    unsigned int   mPendingEvents;                     ///< Bit mask of the property events to emit.
+    bool           mEmitting;                          ///< Whether events are being emitted.
+    uint8_t        mTmfProxyQueueHead;                 ///< Index of the first queued packet.
+    uint8_t        mTmfProxyQueueCount;                ///< Number of queued packets.
+    TmfProxyPacket mTmfProxyQueue[kTmfProxyQueueSize]; ///< Received packets to emit.
+
+    uint8_t      mTmfProxyOutgoingCount;                   ///< Number of packets waiting to be sent.
+    DBusMessage *mTmfProxyOutgoing[kMaxTmfProxyInFlight]; ///< Packets sent while emitting, sent once emitted.
+
+    PacketRing     mBusEvents;   ///< The BusEvent-s from the dispatch thread.
+    int            mBusPipe[2];  ///< Notifies the reactor of mBusEvents.
+    Reactor::Watch mBusWatch;    ///< The watch of mBusPipe.
 };
 
 } // namespace Ncp
@@ -0,0 +1,552 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the cache of the Thread Network Data.
+ */
+
+#include "network_data.hpp"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/tlv.hpp"
+#include "utils/hex.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+static Metrics::Counter sUpdates("network_data.updates");
+static Metrics::Counter sMalformed("network_data.malformed");
+
+enum
+{
+    kPrefixHeaderLength   = 2,      ///< Length of the domain id and prefix length of the Prefix TLV.
+    kBorderRouterLength   = 4,      ///< Length of an entry of the Border Router TLV.
+    kRouteLength          = 3,      ///< Length of an entry of the Has Route TLV.
+    kContextLength        = 2,      ///< Length of the 6LoWPAN Context TLV.
+    kContextIdMask        = 0x0f,   ///< Mask of the context id in the 6LoWPAN Context TLV.
+    kServerHeaderLength   = 2,      ///< Length of the RLOC16 of the Server TLV.
+    kServiceThreadFlag    = 0x80,   ///< The service is of the Thread enterprise number.
+    kServiceIdMask        = 0x0f,   ///< Mask of the service id in the Service TLV.
+    kThreadEnterprise     = 44970,  ///< The IANA enterprise number of the Thread Group.
+    kPreferenceOffset     = 14,     ///< Position of the preference in the flags of an entry.
+    kPreferenceMask       = 0xc000, ///< Mask of the preference in the flags of an entry.
+    kNumBorderRouterFlags = 8,      ///< Number of flags of border router entries.
+    kStableFlag           = 0x01,   ///< The stable bit of the type of a TLV.
+    kMaxPrefixLength      = 128,    ///< Max length of a prefix in bits.
+};
+
+static const struct
+{
+    uint16_t    mFlag;
+    const char *mName;
+} kBorderRouterFlags[kNumBorderRouterFlags] = {
+    {NetworkData::kFlagPreferred, "preferred"}, {NetworkData::kFlagSlaac, "slaac"},
+    {NetworkData::kFlagDhcp, "dhcp"},           {NetworkData::kFlagConfigure, "configure"},
+    {NetworkData::kFlagDefault, "default"},     {NetworkData::kFlagOnMesh, "on-mesh"},
+    {NetworkData::kFlagNdDns, "nd-dns"},        {NetworkData::kFlagDomain, "domain"},
+};
+
+static void Append(std::string &aOutput, const char *aFormat, ...) __attribute__((format(printf, 2, 3)));
+
+static void Append(std::string &aOutput, const char *aFormat, ...)
+{
+    char    buffer[128];
+    va_list args;
+    int     length;
+
+    va_start(args, aFormat);
+    length = vsnprintf(buffer, sizeof(buffer), aFormat, args);
+    va_end(args);
+
+    if (length > 0)
+    {
+        aOutput.append(buffer, static_cast<size_t>(length) < sizeof(buffer) ? static_cast<size_t>(length)
+                                                                             : sizeof(buffer) - 1);
+    }
+}
+
+// The two bits of the preference are signed, the reserved value is read as medium as RFC 4191 requires.
+static int8_t DecodePreference(uint16_t aFlags)
+{
+    static const int8_t kPreferences[] = {0, 1, 0, -1};
+
+    return kPreferences[(aFlags & kPreferenceMask) >> kPreferenceOffset];
+}
+
+static uint16_t ReadUint16(const uint8_t *aBuffer)
+{
+    return static_cast<uint16_t>(aBuffer[0] << 8 | aBuffer[1]);
+}
+
+static void FormatPrefix(const NetworkData::Prefix &aPrefix, char *aBuffer, size_t aSize)
+{
+    uint8_t address[sizeof(in6_addr)] = {0};
+    char    text[INET6_ADDRSTRLEN];
+
+    memcpy(address, aPrefix.mPrefix, (aPrefix.mLength + 7) / 8);
+    inet_ntop(AF_INET6, address, text, sizeof(text));
+    snprintf(aBuffer, aSize, "%s/%u", text, aPrefix.mLength);
+}
+
+NetworkData::NetworkData(Ncp::Controller &aNcp)
+    : mNcp(aNcp)
+    , mLength(0)
+    , mVersion(0)
+    , mPrefixCount(0)
+    , mBorderRouterCount(0)
+    , mRouteCount(0)
+    , mServiceCount(0)
+    , mServerCount(0)
+{
+    Render();
+}
+
+NetworkData::~NetworkData(void)
+{
+    Stop();
+}
+
+void NetworkData::Start(void)
+{
+    mNcp.On(HandleNetworkData, this);
+}
+
+void NetworkData::Stop(void)
+{
+    mNcp.Off(HandleNetworkData, this);
+}
+
+void NetworkData::HandleNetworkData(void *aContext, const Ncp::NetworkDataEvent &aEvent)
+{
+    static_cast<NetworkData *>(aContext)->Update(aEvent.mData, aEvent.mLength);
+}
+
+otbrError NetworkData::Update(const uint8_t *aData, uint16_t aLength)
+{
+    otbrError  error = OTBR_ERROR_NONE;
+    bool       valid = true;
+    const Tlv *tlv;
+
+    VerifyOrExit(aLength <= sizeof(mData), error = OTBR_ERROR_ERRNO, errno = EINVAL);
+
+    // The NCP reports the Network Data again on each property request, most often unchanged.
+    VerifyOrExit(mVersion == 0 || aLength != mLength || memcmp(aData, mData, aLength) != 0);
+
+    memcpy(mData, aData, aLength);
+    mLength            = aLength;
+    mPrefixCount       = 0;
+    mBorderRouterCount = 0;
+    mRouteCount        = 0;
+    mServiceCount      = 0;
+    mServerCount       = 0;
+
+    {
+        TlvReader reader(mData, mLength);
+
+        while (valid && (tlv = reader.GetNext()) != NULL)
+        {
+            const uint8_t *value  = static_cast<const uint8_t *>(tlv->GetValue());
+            bool           stable = (tlv->GetType() & kStableFlag) != 0;
+
+            switch (tlv->GetType() >> 1)
+            {
+            case kTypePrefix:
+                valid = ParsePrefix(value, tlv->GetLength(), stable);
+                break;
+
+            case kTypeService:
+                valid = ParseService(value, tlv->GetLength(), stable);
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        valid = valid && !reader.IsMalformed();
+    }
+
+    ++mVersion;
+    sUpdates.Add();
+    Render();
+
+    if (!valid)
+    {
+        sMalformed.Add();
+        otbrLog(OTBR_LOG_WARNING, "Malformed network data of %u bytes", aLength);
+        errno = EINVAL;
+        error = OTBR_ERROR_ERRNO;
+    }
+
+exit:
+    return error;
+}
+
+bool NetworkData::ParsePrefix(const uint8_t *aValue, uint16_t aLength, bool aStable)
+{
+    bool       valid  = false;
+    Prefix &   prefix = mPrefixes[mPrefixCount];
+    uint16_t   size;
+    const Tlv *tlv;
+
+    VerifyOrExit(aLength >= kPrefixHeaderLength && aValue[1] <= kMaxPrefixLength);
+    size = static_cast<uint16_t>(kPrefixHeaderLength + (aValue[1] + 7) / 8);
+    VerifyOrExit(aLength >= size);
+
+    prefix.mDomainId          = aValue[0];
+    prefix.mLength            = aValue[1];
+    prefix.mPrefix            = aValue + kPrefixHeaderLength;
+    prefix.mContextId         = -1;
+    prefix.mStable            = aStable;
+    prefix.mFirstBorderRouter = mBorderRouterCount;
+    prefix.mBorderRouterCount = 0;
+    prefix.mFirstRoute        = mRouteCount;
+    prefix.mRouteCount        = 0;
+
+    // A malformed prefix is kept with the entries read before the error, as the TLVs before it.
+    ++mPrefixCount;
+
+    {
+        TlvReader reader(aValue + size, static_cast<uint16_t>(aLength - size));
+
+        while ((tlv = reader.GetNext()) != NULL)
+        {
+            const uint8_t *value  = static_cast<const uint8_t *>(tlv->GetValue());
+            uint16_t       length = tlv->GetLength();
+            bool           stable = (tlv->GetType() & kStableFlag) != 0;
+
+            switch (tlv->GetType() >> 1)
+            {
+            case kTypeBorderRouter:
+                // The tables are sized for the entries of the largest Network Data, they cannot overflow.
+                for (; length >= kBorderRouterLength; length -= kBorderRouterLength, value += kBorderRouterLength)
+                {
+                    Entry &  entry = mBorderRouters[mBorderRouterCount++];
+                    uint16_t flags = ReadUint16(value + sizeof(uint16_t));
+
+                    entry.mRloc16     = ReadUint16(value);
+                    entry.mFlags      = static_cast<uint16_t>(flags & ~kPreferenceMask);
+                    entry.mPreference = DecodePreference(flags);
+                    entry.mStable     = stable;
+                    ++prefix.mBorderRouterCount;
+                }
+
+                VerifyOrExit(length == 0);
+                break;
+
+            case kTypeHasRoute:
+                for (; length >= kRouteLength; length -= kRouteLength, value += kRouteLength)
+                {
+                    Entry &  entry = mRoutes[mRouteCount++];
+                    uint16_t flags = static_cast<uint16_t>(value[sizeof(uint16_t)] << 8);
+
+                    entry.mRloc16     = ReadUint16(value);
+                    entry.mFlags      = static_cast<uint16_t>((flags & ~kPreferenceMask) >> 8);
+                    entry.mPreference = DecodePreference(flags);
+                    entry.mStable     = stable;
+                    ++prefix.mRouteCount;
+                }
+
+                VerifyOrExit(length == 0);
+                break;
+
+            case kTypeContext:
+                VerifyOrExit(length >= kContextLength);
+                prefix.mContextId = static_cast<int8_t>(value[0] & kContextIdMask);
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        VerifyOrExit(!reader.IsMalformed());
+    }
+
+    valid = true;
+
+exit:
+    return valid;
+}
+
+bool NetworkData::ParseService(const uint8_t *aValue, uint16_t aLength, bool aStable)
+{
+    bool       valid   = false;
+    Service &  service = mServices[mServiceCount];
+    uint16_t   offset  = 1;
+    const Tlv *tlv;
+
+    VerifyOrExit(aLength >= 1);
+
+    service.mServiceId   = aValue[0] & kServiceIdMask;
+    service.mEnterprise  = kThreadEnterprise;
+    service.mStable      = aStable;
+    service.mData        = NULL;
+    service.mDataLength  = 0;
+    service.mFirstServer = mServerCount;
+    service.mServerCount = 0;
+
+    if ((aValue[0] & kServiceThreadFlag) == 0)
+    {
+        VerifyOrExit(aLength >= offset + sizeof(uint32_t));
+        service.mEnterprise =
+            static_cast<uint32_t>(ReadUint16(aValue + offset)) << 16 | ReadUint16(aValue + offset + sizeof(uint16_t));
+        offset += sizeof(uint32_t);
+    }
+
+    VerifyOrExit(aLength > offset && aLength - offset - 1 >= aValue[offset]);
+    service.mDataLength = aValue[offset++];
+    service.mData       = aValue + offset;
+    offset += service.mDataLength;
+
+    ++mServiceCount;
+
+    {
+        TlvReader reader(aValue + offset, static_cast<uint16_t>(aLength - offset));
+
+        while ((tlv = reader.GetNext()) != NULL)
+        {
+            const uint8_t *value = static_cast<const uint8_t *>(tlv->GetValue());
+
+            if ((tlv->GetType() >> 1) != kTypeServer)
+            {
+                continue;
+            }
+
+            VerifyOrExit(tlv->GetLength() >= kServerHeaderLength);
+
+            {
+                Server &server = mServers[mServerCount++];
+
+                server.mRloc16     = ReadUint16(value);
+                server.mData       = value + kServerHeaderLength;
+                server.mDataLength = static_cast<uint8_t>(tlv->GetLength() - kServerHeaderLength);
+                server.mStable     = (tlv->GetType() & kStableFlag) != 0;
+                ++service.mServerCount;
+            }
+        }
+
+        VerifyOrExit(!reader.IsMalformed());
+    }
+
+    valid = true;
+
+exit:
+    return valid;
+}
+
+const NetworkData::Prefix *NetworkData::FindPrefix(const uint8_t *aPrefix, uint8_t aLength) const
+{
+    const Prefix *prefix = NULL;
+
+    for (uint8_t i = 0; i < mPrefixCount; ++i)
+    {
+        if (mPrefixes[i].mLength == aLength && memcmp(mPrefixes[i].mPrefix, aPrefix, (aLength + 7) / 8) == 0)
+        {
+            ExitNow(prefix = &mPrefixes[i]);
+        }
+    }
+
+exit:
+    return prefix;
+}
+
+void NetworkData::Render(void)
+{
+    RenderText();
+    RenderJson();
+}
+
+void NetworkData::RenderText(void)
+{
+    char text[INET6_ADDRSTRLEN + sizeof("/128")];
+    char hex[kSizeNetworkData * 2 + 1];
+
+    mText.clear();
+    Append(mText, "version=%u bytes=%u prefixes=%u services=%u\n", mVersion, mLength, mPrefixCount, mServiceCount);
+
+    for (uint8_t i = 0; i < mPrefixCount; ++i)
+    {
+        const Prefix &prefix = mPrefixes[i];
+
+        FormatPrefix(prefix, text, sizeof(text));
+        Append(mText, "prefix=%s domain=%u context=%d stable=%d\n", text, prefix.mDomainId, prefix.mContextId,
+               prefix.mStable);
+
+        for (uint8_t j = prefix.mFirstBorderRouter; j < prefix.mFirstBorderRouter + prefix.mBorderRouterCount; ++j)
+        {
+            const Entry &entry     = mBorderRouters[j];
+            const char * separator = "";
+
+            Append(mText, "  border_router rloc16=0x%04x preference=%d stable=%d flags=", entry.mRloc16,
+                   entry.mPreference, entry.mStable);
+
+            for (int k = 0; k < kNumBorderRouterFlags; ++k)
+            {
+                if (entry.mFlags & kBorderRouterFlags[k].mFlag)
+                {
+                    Append(mText, "%s%s", separator, kBorderRouterFlags[k].mName);
+                    separator = ",";
+                }
+            }
+
+            mText += '\n';
+        }
+
+        for (uint8_t j = prefix.mFirstRoute; j < prefix.mFirstRoute + prefix.mRouteCount; ++j)
+        {
+            const Entry &entry = mRoutes[j];
+
+            Append(mText, "  route rloc16=0x%04x preference=%d stable=%d nat64=%d\n", entry.mRloc16,
+                   entry.mPreference, entry.mStable, (entry.mFlags & kFlagRouteNat64) != 0);
+        }
+    }
+
+    for (uint8_t i = 0; i < mServiceCount; ++i)
+    {
+        const Service &service = mServices[i];
+
+        Utils::Bytes2Hex(service.mData, service.mDataLength, hex);
+        Append(mText, "service enterprise=%u id=%u stable=%d data=", service.mEnterprise, service.mServiceId,
+               service.mStable);
+        mText += hex;
+        mText += '\n';
+
+        for (uint8_t j = service.mFirstServer; j < service.mFirstServer + service.mServerCount; ++j)
+        {
+            const Server &server = mServers[j];
+
+            Utils::Bytes2Hex(server.mData, server.mDataLength, hex);
+            Append(mText, "  server rloc16=0x%04x stable=%d data=", server.mRloc16, server.mStable);
+            mText += hex;
+            mText += '\n';
+        }
+    }
+}
+
+void NetworkData::RenderJson(void)
+{
+    static const char *const kBooleans[] = {"false", "true"};
+    char                     text[INET6_ADDRSTRLEN + sizeof("/128")];
+    char                     hex[kSizeNetworkData * 2 + 1];
+
+    mJson.clear();
+    Append(mJson, "{\"version\":%u,\"prefixes\":[", mVersion);
+
+    for (uint8_t i = 0; i < mPrefixCount; ++i)
+    {
+        const Prefix &prefix = mPrefixes[i];
+
+        FormatPrefix(prefix, text, sizeof(text));
+        Append(mJson, "%s{\"prefix\":\"%s\",\"domainId\":%u,\"stable\":%s,", i > 0 ? "," : "", text, prefix.mDomainId,
+               kBooleans[prefix.mStable]);
+
+        if (prefix.mContextId >= 0)
+        {
+            Append(mJson, "\"contextId\":%d,", prefix.mContextId);
+        }
+
+        mJson += "\"borderRouters\":[";
+
+        for (uint8_t j = prefix.mFirstBorderRouter; j < prefix.mFirstBorderRouter + prefix.mBorderRouterCount; ++j)
+        {
+            const Entry &entry     = mBorderRouters[j];
+            const char * separator = "";
+
+            Append(mJson, "%s{\"rloc16\":\"0x%04x\",\"preference\":%d,\"stable\":%s,\"flags\":[",
+                   j > prefix.mFirstBorderRouter ? "," : "", entry.mRloc16, entry.mPreference,
+                   kBooleans[entry.mStable]);
+
+            for (int k = 0; k < kNumBorderRouterFlags; ++k)
+            {
+                if (entry.mFlags & kBorderRouterFlags[k].mFlag)
+                {
+                    Append(mJson, "%s\"%s\"", separator, kBorderRouterFlags[k].mName);
+                    separator = ",";
+                }
+            }
+
+            mJson += "]}";
+        }
+
+        mJson += "],\"routes\":[";
+
+        for (uint8_t j = prefix.mFirstRoute; j < prefix.mFirstRoute + prefix.mRouteCount; ++j)
+        {
+            const Entry &entry = mRoutes[j];
+
+            Append(mJson, "%s{\"rloc16\":\"0x%04x\",\"preference\":%d,\"stable\":%s,\"nat64\":%s}",
+                   j > prefix.mFirstRoute ? "," : "", entry.mRloc16, entry.mPreference, kBooleans[entry.mStable],
+                   kBooleans[(entry.mFlags & kFlagRouteNat64) != 0]);
+        }
+
+        mJson += "]}";
+    }
+
+    mJson += "],\"services\":[";
+
+    for (uint8_t i = 0; i < mServiceCount; ++i)
+    {
+        const Service &service = mServices[i];
+
+        Utils::Bytes2Hex(service.mData, service.mDataLength, hex);
+        Append(mJson, "%s{\"enterpriseNumber\":%u,\"serviceId\":%u,\"stable\":%s,\"data\":\"", i > 0 ? "," : "",
+               service.mEnterprise, service.mServiceId, kBooleans[service.mStable]);
+        mJson += hex;
+        mJson += "\",\"servers\":[";
+
+        for (uint8_t j = service.mFirstServer; j < service.mFirstServer + service.mServerCount; ++j)
+        {
+            const Server &server = mServers[j];
+
+            Utils::Bytes2Hex(server.mData, server.mDataLength, hex);
+            Append(mJson, "%s{\"rloc16\":\"0x%04x\",\"stable\":%s,\"data\":\"", j > service.mFirstServer ? "," : "",
+                   server.mRloc16, kBooleans[server.mStable]);
+            mJson += hex;
+            mJson += "\"}";
+        }
+
+        mJson += "]}";
+    }
+
+    mJson += "]}";
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
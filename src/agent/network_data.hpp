@@ -0,0 +1,322 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the cache of the Thread Network Data.
+ */
+
+#ifndef NETWORK_DATA_HPP_
+#define NETWORK_DATA_HPP_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "ncp.hpp"
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class caches the Thread Network Data of a network, as indexed prefixes, routes and services.
+ *
+ * The TLVs are copied once for each change reported by the NCP, and read in place into flat tables, so that the
+ * entries point into the copy and lookups need neither parsing nor allocation. Data identical to the cached one is
+ * not parsed again. The tables are sized for the largest Network Data, so that no entry is ever dropped.
+ *
+ * The text and JSON snapshots are rendered once for each change, so that serving them costs a copy.
+ *
+ */
+class NetworkData
+{
+public:
+    enum
+    {
+        kMaxPrefixes      = kSizeNetworkData / 4, ///< Max number of prefixes, each TLV of at least 4 bytes.
+        kMaxBorderRouters = kSizeNetworkData / 4, ///< Max number of border router entries, of 4 bytes each.
+        kMaxRoutes        = kSizeNetworkData / 3, ///< Max number of external route entries, of 3 bytes each.
+        kMaxServices      = kSizeNetworkData / 4, ///< Max number of services, each TLV of at least 4 bytes.
+        kMaxServers       = kSizeNetworkData / 4, ///< Max number of servers, each TLV of at least 4 bytes.
+    };
+
+    /**
+     * Flags of border router entries, as encoded in the Border Router TLV.
+     *
+     */
+    enum
+    {
+        kFlagPreferred  = 1 << 13, ///< Addresses from the prefix are preferred.
+        kFlagSlaac      = 1 << 12, ///< Addresses are configured by SLAAC.
+        kFlagDhcp       = 1 << 11, ///< Addresses are configured by DHCPv6.
+        kFlagConfigure  = 1 << 10, ///< Other configuration is available by DHCPv6.
+        kFlagDefault    = 1 << 9,  ///< The border router is a default route.
+        kFlagOnMesh     = 1 << 8,  ///< The prefix is on-mesh.
+        kFlagNdDns      = 1 << 7,  ///< The border router offers DNS by ND.
+        kFlagDomain     = 1 << 6,  ///< The prefix is a domain prefix.
+        kFlagRouteNat64 = 1 << 5,  ///< Route entries only: the route is a NAT64 prefix.
+    };
+
+    /**
+     * This struct defines a border router or external route entry of a prefix.
+     *
+     */
+    struct Entry
+    {
+        uint16_t mRloc16;     ///< The RLOC16 of the border router.
+        uint16_t mFlags;      ///< The flags of the entry, without its preference.
+        int8_t   mPreference; ///< The preference, -1 for low, 0 for medium and 1 for high.
+        bool     mStable;     ///< Whether the entry is stable.
+    };
+
+    /**
+     * This struct defines a prefix, with its border router and external route entries.
+     *
+     */
+    struct Prefix
+    {
+        const uint8_t *mPrefix;            ///< The significant bytes of the prefix.
+        uint8_t        mLength;            ///< The length of the prefix in bits.
+        uint8_t        mDomainId;          ///< The domain id.
+        int8_t         mContextId;         ///< The 6LoWPAN context id, -1 if none.
+        bool           mStable;            ///< Whether the prefix is stable.
+        uint8_t        mFirstBorderRouter; ///< Index of the first border router entry of the prefix.
+        uint8_t        mBorderRouterCount; ///< Number of border router entries of the prefix.
+        uint8_t        mFirstRoute;        ///< Index of the first external route entry of the prefix.
+        uint8_t        mRouteCount;        ///< Number of external route entries of the prefix.
+    };
+
+    /**
+     * This struct defines a server of a service.
+     *
+     */
+    struct Server
+    {
+        const uint8_t *mData;       ///< The server data.
+        uint8_t        mDataLength; ///< Number of bytes of mData.
+        uint16_t       mRloc16;     ///< The RLOC16 of the server.
+        bool           mStable;     ///< Whether the server is stable.
+    };
+
+    /**
+     * This struct defines a service, with its servers.
+     *
+     */
+    struct Service
+    {
+        const uint8_t *mData;        ///< The service data.
+        uint8_t        mDataLength;  ///< Number of bytes of mData.
+        uint8_t        mServiceId;   ///< The service id.
+        uint32_t       mEnterprise;  ///< The IANA enterprise number.
+        bool           mStable;      ///< Whether the service is stable.
+        uint8_t        mFirstServer; ///< Index of the first server of the service.
+        uint8_t        mServerCount; ///< Number of servers of the service.
+    };
+
+    /**
+     * The constructor to initialize an empty cache.
+     *
+     * @param[in]   aNcp    A reference to the NCP controller reporting the Network Data.
+     *
+     */
+    explicit NetworkData(Ncp::Controller &aNcp);
+
+    ~NetworkData(void);
+
+    /**
+     * This method subscribes to the changes of the Network Data.
+     *
+     * The Network Data is requested with the other properties by Ncp::Controller::RequestEvents().
+     *
+     */
+    void Start(void);
+
+    /**
+     * This method unsubscribes from the changes of the Network Data, the cache is kept.
+     *
+     */
+    void Stop(void);
+
+    /**
+     * This method replaces the cached Network Data.
+     *
+     * @param[in]   aData       A pointer to the TLVs of the Network Data.
+     * @param[in]   aLength     Number of bytes of @p aData.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully cached the Network Data.
+     * @retval  OTBR_ERROR_ERRNO    The Network Data is larger than kSizeNetworkData or malformed, errno is set to
+     *                              EINVAL. The entries before the malformed TLV are cached.
+     *
+     */
+    otbrError Update(const uint8_t *aData, uint16_t aLength);
+
+    /**
+     * This method returns the number of changes of the cache, 0 if the Network Data was never reported.
+     *
+     * @returns The number of changes.
+     *
+     */
+    uint32_t GetVersion(void) const { return mVersion; }
+
+    /**
+     * This method returns the number of prefixes.
+     *
+     * @returns The number of prefixes.
+     *
+     */
+    uint8_t GetPrefixCount(void) const { return mPrefixCount; }
+
+    /**
+     * This method returns a prefix.
+     *
+     * @param[in]   aIndex  The index of the prefix, less than GetPrefixCount().
+     *
+     * @returns A reference to the prefix, valid until the next change.
+     *
+     */
+    const Prefix &GetPrefix(uint8_t aIndex) const { return mPrefixes[aIndex]; }
+
+    /**
+     * This method finds a prefix.
+     *
+     * @param[in]   aPrefix     A pointer to the significant bytes of the prefix.
+     * @param[in]   aLength     The length of the prefix in bits.
+     *
+     * @returns A pointer to the prefix, NULL if not found.
+     *
+     */
+    const Prefix *FindPrefix(const uint8_t *aPrefix, uint8_t aLength) const;
+
+    /**
+     * This method returns a border router entry.
+     *
+     * @param[in]   aIndex  The index of the entry, between Prefix::mFirstBorderRouter and its count.
+     *
+     * @returns A reference to the entry, valid until the next change.
+     *
+     */
+    const Entry &GetBorderRouter(uint8_t aIndex) const { return mBorderRouters[aIndex]; }
+
+    /**
+     * This method returns an external route entry.
+     *
+     * @param[in]   aIndex  The index of the entry, between Prefix::mFirstRoute and its count.
+     *
+     * @returns A reference to the entry, valid until the next change.
+     *
+     */
+    const Entry &GetRoute(uint8_t aIndex) const { return mRoutes[aIndex]; }
+
+    /**
+     * This method returns the number of services.
+     *
+     * @returns The number of services.
+     *
+     */
+    uint8_t GetServiceCount(void) const { return mServiceCount; }
+
+    /**
+     * This method returns a service.
+     *
+     * @param[in]   aIndex  The index of the service, less than GetServiceCount().
+     *
+     * @returns A reference to the service, valid until the next change.
+     *
+     */
+    const Service &GetService(uint8_t aIndex) const { return mServices[aIndex]; }
+
+    /**
+     * This method returns a server.
+     *
+     * @param[in]   aIndex  The index of the server, between Service::mFirstServer and its count.
+     *
+     * @returns A reference to the server, valid until the next change.
+     *
+     */
+    const Server &GetServer(uint8_t aIndex) const { return mServers[aIndex]; }
+
+    /**
+     * This method returns the snapshot for the admin socket, a line for each prefix, entry, service and server.
+     *
+     * @returns A reference to the text.
+     *
+     */
+    const std::string &GetText(void) const { return mText; }
+
+    /**
+     * This method returns the snapshot as a JSON object with the arrays `prefixes` and `services`.
+     *
+     * @returns A reference to the JSON document.
+     *
+     */
+    const std::string &GetJson(void) const { return mJson; }
+
+private:
+    enum
+    {
+        kTypeHasRoute     = 0, ///< Has Route TLV.
+        kTypePrefix       = 1, ///< Prefix TLV.
+        kTypeBorderRouter = 2, ///< Border Router TLV.
+        kTypeContext      = 3, ///< 6LoWPAN Context TLV.
+        kTypeService      = 5, ///< Service TLV.
+        kTypeServer       = 6, ///< Server TLV.
+    };
+
+    static void HandleNetworkData(void *aContext, const Ncp::NetworkDataEvent &aEvent);
+
+    bool ParsePrefix(const uint8_t *aValue, uint16_t aLength, bool aStable);
+    bool ParseService(const uint8_t *aValue, uint16_t aLength, bool aStable);
+    void Render(void);
+    void RenderText(void);
+    void RenderJson(void);
+
+    Ncp::Controller &mNcp;
+    uint8_t          mData[kSizeNetworkData];
+    uint16_t         mLength;
+    uint32_t         mVersion;
+    Prefix           mPrefixes[kMaxPrefixes];
+    uint8_t          mPrefixCount;
+    Entry            mBorderRouters[kMaxBorderRouters];
+    uint8_t          mBorderRouterCount;
+    Entry            mRoutes[kMaxRoutes];
+    uint8_t          mRouteCount;
+    Service          mServices[kMaxServices];
+    uint8_t          mServiceCount;
+    Server           mServers[kMaxServers];
+    uint8_t          mServerCount;
+    std::string      mText;
+    std::string      mJson;
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // NETWORK_DATA_HPP_
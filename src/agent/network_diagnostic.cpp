@@ -0,0 +1,470 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   The file implements the network diagnostic collector.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_BORDER_AGENT
+
+#include "network_diagnostic.hpp"
+
+#include <errno.h>
+#include <string.h>
+
+#include "uris.hpp"
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
+#include "common/tlv.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+enum
+{
+    kAloc16Leader     = 0xfc00, ///< leader anycast locator.
+    kCoapUdpPort      = 61631,  ///< Thread management UDP port.
+    kChildEntryLength = 3,      ///< Length of an entry of the Child Table TLV.
+    kRouterMaskLength = 8,      ///< Length of the router id mask of the Route64 TLV.
+    kLinkQualityMask  = 0xf0,   ///< Link quality in and out of a route data entry of the Route64 TLV.
+};
+
+static Metrics::Gauge     sRouters("diagnostic.routers");
+static Metrics::Gauge     sChildren("diagnostic.children");
+static Metrics::Counter   sRounds("diagnostic.rounds");
+static Metrics::Counter   sFailedRounds("diagnostic.failed_rounds");
+static Metrics::Counter   sMissingAnswers("diagnostic.missing_answers");
+static Metrics::Histogram sRoundTime("diagnostic.round_ms");
+
+// The route table is asked to the leader along with its own diagnostics, so it is not queried again.
+static const uint8_t kQueryTypes[] = {Diagnostic::kExtMacAddress, Diagnostic::kAddress16, Diagnostic::kRoute64,
+                                      Diagnostic::kChildTable};
+
+/**
+ * This function reads the router ids allocated and the neighbors with a link from a Route64 TLV.
+ *
+ * @returns true if @p aTlv is a well formed Route64 TLV, false otherwise.
+ *
+ */
+static bool ReadRouteTable(const Tlv *aTlv, uint64_t &aRouters, uint64_t &aNeighbors)
+{
+    bool           ret   = false;
+    const uint8_t *value = NULL;
+    const uint8_t *data  = NULL;
+    uint16_t       count = 0;
+
+    VerifyOrExit(aTlv != NULL && aTlv->GetLength() >= sizeof(uint8_t) + kRouterMaskLength);
+
+    // The sequence number is followed by the router id mask, then one route data byte per router id allocated.
+    value = static_cast<const uint8_t *>(aTlv->GetValue());
+    data  = value + sizeof(uint8_t) + kRouterMaskLength;
+
+    for (uint8_t id = 0; id < NetworkDiagnostic::kMaxRouters; ++id)
+    {
+        count += (value[1 + id / 8] >> (7 - id % 8)) & 1;
+    }
+
+    VerifyOrExit(aTlv->GetLength() >= sizeof(uint8_t) + kRouterMaskLength + count);
+
+    aRouters   = 0;
+    aNeighbors = 0;
+
+    for (uint8_t id = 0; id < NetworkDiagnostic::kMaxRouters; ++id)
+    {
+        if ((value[1 + id / 8] >> (7 - id % 8)) & 1)
+        {
+            aRouters |= static_cast<uint64_t>(1) << id;
+
+            // Link qualities in and out are 0 for routers out of reach and for the router itself.
+            if (*data++ & kLinkQualityMask)
+            {
+                aNeighbors |= static_cast<uint64_t>(1) << id;
+            }
+        }
+    }
+
+    ret = true;
+
+exit:
+    return ret;
+}
+
+NetworkDiagnostic::NetworkDiagnostic(Coap::Agent &aCoap, TimerWheel &aTimerWheel)
+    : mCoap(aCoap)
+    , mTimerWheel(aTimerWheel)
+    , mAnswer(OT_URI_PATH_DIAGNOSTIC_GET_ANSWER, HandleAnswer, this)
+    , mStarted(false)
+    , mState(kStateIdle)
+    , mInterval(0)
+    , mAnswerTimeout(kAnswerTimeout)
+    , mNextToken(static_cast<uint32_t>(GetMonotonicNowUs()))
+    , mNextQuery(0)
+    , mRoundStart(0)
+    , mQueryTimer(HandleQueryTimer, this)
+    , mDeadlineTimer(HandleDeadlineTimer, this)
+    , mIntervalTimer(HandleIntervalTimer, this)
+{
+    memset(mLeaderToken, 0, sizeof(mLeaderToken));
+    memset(&mRound, 0, sizeof(mRound));
+    memset(&mTopology, 0, sizeof(mTopology));
+}
+
+NetworkDiagnostic::~NetworkDiagnostic(void)
+{
+    Stop();
+
+    sRouters.Subtract(mTopology.mRouterCount);
+    sChildren.Subtract(mTopology.mChildCount);
+}
+
+void NetworkDiagnostic::Start(void)
+{
+    VerifyOrExit(!mStarted);
+
+    mCoap.AddResource(mAnswer);
+    mStarted = true;
+
+    if (mInterval != 0)
+    {
+        mTimerWheel.Start(mIntervalTimer, mInterval);
+    }
+
+exit:
+    return;
+}
+
+void NetworkDiagnostic::Stop(void)
+{
+    VerifyOrExit(mStarted);
+
+    mCoap.RemoveResource(mAnswer);
+    mStarted = false;
+    Finish();
+
+exit:
+    return;
+}
+
+void NetworkDiagnostic::SetInterval(uint32_t aInterval)
+{
+    mInterval = aInterval;
+
+    if (mState == kStateIdle)
+    {
+        mTimerWheel.Stop(mIntervalTimer);
+
+        if (mStarted && mInterval != 0)
+        {
+            mTimerWheel.Start(mIntervalTimer, mInterval);
+        }
+    }
+}
+
+void NetworkDiagnostic::NewToken(uint8_t *aToken)
+{
+    uint32_t token = mNextToken++;
+
+    aToken[0] = static_cast<uint8_t>(token >> 24);
+    aToken[1] = static_cast<uint8_t>(token >> 16);
+    aToken[2] = static_cast<uint8_t>(token >> 8);
+    aToken[3] = static_cast<uint8_t>(token);
+}
+
+bool NetworkDiagnostic::SetRequest(Coap::Message &aMessage, const char *aPath)
+{
+    uint8_t   payload[sizeof(Tlv) + sizeof(kQueryTypes)];
+    TlvWriter writer(payload, sizeof(payload));
+    bool      ret = false;
+
+    VerifyOrExit(writer.Append(Diagnostic::kTypeList, kQueryTypes, sizeof(kQueryTypes)));
+
+    aMessage.SetPath(aPath);
+    aMessage.SetPayload(payload, writer.GetLength());
+    ret = true;
+
+exit:
+    return ret;
+}
+
+otbrError NetworkDiagnostic::Collect(void)
+{
+    otbrError  ret = OTBR_ERROR_ERRNO;
+    Ip6Address leader(kAloc16Leader);
+
+    VerifyOrExit(mStarted, errno = ENOTCONN);
+    VerifyOrExit(mState == kStateIdle, errno = EBUSY);
+
+    NewToken(mLeaderToken);
+
+    {
+        Coap::ScopedMessage message(mCoap, Coap::kTypeConfirmable, Coap::kCodePost, mLeaderToken,
+                                    sizeof(mLeaderToken));
+
+        VerifyOrExit(message.Get() != NULL, errno = ENOMEM);
+        VerifyOrExit(SetRequest(*message, OT_URI_PATH_DIAGNOSTIC_GET_REQUEST), errno = ENOBUFS);
+        SuccessOrExit(mCoap.Send(*message, leader.m8, kCoapUdpPort, HandleLeaderResponse, this));
+    }
+
+    mTimerWheel.Stop(mIntervalTimer);
+    memset(&mRound, 0, sizeof(mRound));
+    mState      = kStateLeader;
+    mRoundStart = GetMonotonicNow();
+    mTimerWheel.Start(mDeadlineTimer, mAnswerTimeout);
+    ret = OTBR_ERROR_NONE;
+
+exit:
+    return ret;
+}
+
+void NetworkDiagnostic::HandleIntervalTimer(void)
+{
+    if (Collect() != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to start network diagnostic: %s", strerror(errno));
+        mTimerWheel.Start(mIntervalTimer, mInterval);
+    }
+}
+
+void NetworkDiagnostic::HandleLeaderResponse(const Coap::Message &aMessage)
+{
+    uint8_t        tokenLength = 0;
+    const uint8_t *token       = aMessage.GetToken(tokenLength);
+    uint16_t       length      = 0;
+    const uint8_t *payload     = aMessage.GetPayload(length);
+    TlvReader      reader(payload, length);
+    const uint8_t  types[]     = {Diagnostic::kAddress16, Diagnostic::kRoute64};
+    const Tlv *    tlvs[sizeof(types)];
+    uint64_t       routers   = 0;
+    uint64_t       neighbors = 0;
+
+    // Responses of rounds given up are ignored.
+    VerifyOrExit(mState == kStateLeader && tokenLength == sizeof(mLeaderToken) &&
+                 memcmp(token, mLeaderToken, sizeof(mLeaderToken)) == 0);
+
+    VerifyOrExit(aMessage.GetCode() == Coap::kCodeChanged,
+                 otbrLog(OTBR_LOG_WARNING, "Leader rejected network diagnostic: %d", aMessage.GetCode()), Fail());
+    reader.Index(types, tlvs, sizeof(types));
+    VerifyOrExit(tlvs[0] != NULL && tlvs[0]->GetLength() == sizeof(uint16_t) &&
+                     ReadRouteTable(tlvs[1], routers, neighbors),
+                 otbrLog(OTBR_LOG_WARNING, "Leader answered network diagnostic without route table"), Fail());
+
+    mRound.mLeaderRloc16 = tlvs[0]->GetValueUInt16();
+
+    for (uint8_t id = 0; id < kMaxRouters; ++id)
+    {
+        if (routers & (static_cast<uint64_t>(1) << id))
+        {
+            mRound.mRouters[mRound.mRouterCount++].mRloc16 = static_cast<uint16_t>(id << kRouterIdShift);
+        }
+    }
+
+    RecordAnswer(payload, length, mRound.mLeaderRloc16);
+
+    mState     = kStateQuerying;
+    mNextQuery = 0;
+    SendQueries();
+
+exit:
+    return;
+}
+
+void NetworkDiagnostic::SendQueries(void)
+{
+    unsigned int sent = 0;
+
+    VerifyOrExit(mState == kStateQuerying);
+
+    // Queries are sent in bursts, so that a large network does not overflow the window of the TMF proxy.
+    for (; mNextQuery < mRound.mRouterCount && sent < kQueryBurst; ++mNextQuery)
+    {
+        if (!mRound.mRouters[mNextQuery].mAnswered)
+        {
+            SendQuery(mRound.mRouters[mNextQuery].mRloc16);
+            ++sent;
+        }
+    }
+
+    if (mNextQuery < mRound.mRouterCount)
+    {
+        mTimerWheel.Start(mQueryTimer, kQueryInterval);
+    }
+    else if (mRound.mAnswerCount == mRound.mRouterCount)
+    {
+        Complete();
+    }
+
+exit:
+    return;
+}
+
+void NetworkDiagnostic::SendQuery(uint16_t aRloc16)
+{
+    uint8_t    token[kTokenLength];
+    Ip6Address addr(aRloc16);
+
+    NewToken(token);
+
+    {
+        Coap::ScopedMessage message(mCoap, Coap::kTypeNonConfirmable, Coap::kCodePost, token, sizeof(token));
+
+        VerifyOrExit(message.Get() != NULL, otbrLog(OTBR_LOG_ERR, "Failed to create network diagnostic query"));
+        VerifyOrExit(SetRequest(*message, OT_URI_PATH_DIAGNOSTIC_GET_QUERY));
+
+        // Routers not reached are accounted as missing answers once the round completes.
+        mCoap.Send(*message, addr.m8, kCoapUdpPort, NULL, NULL);
+    }
+
+exit:
+    return;
+}
+
+void NetworkDiagnostic::HandleAnswer(const Coap::Message &aMessage, Coap::Message &aResponse, const uint8_t *aIp6)
+{
+    uint16_t       length  = 0;
+    const uint8_t *payload = aMessage.GetPayload(length);
+    Ip6Address     source;
+
+    if (aMessage.GetType() == Coap::kTypeConfirmable)
+    {
+        aResponse.SetCode(Coap::kCodeChanged);
+    }
+
+    VerifyOrExit(mState == kStateQuerying);
+
+    memcpy(source.m8, aIp6, sizeof(source.m8));
+    RecordAnswer(payload, length, source.ToLocator());
+
+    if (mRound.mAnswerCount == mRound.mRouterCount)
+    {
+        Complete();
+    }
+
+exit:
+    return;
+}
+
+void NetworkDiagnostic::RecordAnswer(const uint8_t *aPayload, uint16_t aLength, uint16_t aLocator)
+{
+    TlvReader     reader(aPayload, aLength);
+    const uint8_t types[] = {Diagnostic::kExtMacAddress, Diagnostic::kAddress16, Diagnostic::kRoute64,
+                             Diagnostic::kChildTable};
+    const Tlv *   tlvs[sizeof(types)];
+    Router *      router  = NULL;
+    uint64_t      routers = 0;
+
+    reader.Index(types, tlvs, sizeof(types));
+
+    // The answer is sent from the RLOC16 of the router, unless it names itself.
+    if (tlvs[1] != NULL && tlvs[1]->GetLength() == sizeof(uint16_t))
+    {
+        aLocator = tlvs[1]->GetValueUInt16();
+    }
+
+    for (uint8_t i = 0; i < mRound.mRouterCount; ++i)
+    {
+        if (mRound.mRouters[i].mRloc16 == aLocator)
+        {
+            router = &mRound.mRouters[i];
+            break;
+        }
+    }
+
+    VerifyOrExit(router != NULL && !router->mAnswered,
+                 otbrLog(OTBR_LOG_DEBUG, "Ignored network diagnostic answer of %04x", aLocator));
+
+    if (tlvs[0] != NULL && tlvs[0]->GetLength() == sizeof(router->mExtAddress))
+    {
+        memcpy(router->mExtAddress, tlvs[0]->GetValue(), sizeof(router->mExtAddress));
+    }
+
+    if (!ReadRouteTable(tlvs[2], routers, router->mNeighbors))
+    {
+        router->mNeighbors = 0;
+    }
+
+    router->mChildCount = (tlvs[3] != NULL ? tlvs[3]->GetLength() / kChildEntryLength : 0);
+    router->mAnswered   = true;
+    mRound.mAnswerCount++;
+    mRound.mChildCount = static_cast<uint16_t>(mRound.mChildCount + router->mChildCount);
+
+exit:
+    return;
+}
+
+void NetworkDiagnostic::Complete(void)
+{
+    uint64_t now = GetMonotonicNow();
+
+    VerifyOrExit(mState != kStateIdle);
+    VerifyOrExit(mState == kStateQuerying, otbrLog(OTBR_LOG_WARNING, "Leader did not answer network diagnostic"),
+                 Fail());
+
+    sRouters.Add(static_cast<int64_t>(mRound.mRouterCount) - mTopology.mRouterCount);
+    sChildren.Add(static_cast<int64_t>(mRound.mChildCount) - mTopology.mChildCount);
+    sMissingAnswers.Add(mRound.mRouterCount - mRound.mAnswerCount);
+    sRoundTime.Record(now - mRoundStart);
+    sRounds.Add();
+
+    memcpy(&mTopology, &mRound, sizeof(mTopology));
+    mTopology.mUpdateTime = now;
+
+    otbrLog(OTBR_LOG_INFO, "Network diagnostic: %u routers, %u answered, %u children in %ums", mTopology.mRouterCount,
+            mTopology.mAnswerCount, mTopology.mChildCount, static_cast<unsigned int>(now - mRoundStart));
+
+    Finish();
+
+exit:
+    return;
+}
+
+void NetworkDiagnostic::Fail(void)
+{
+    sFailedRounds.Add();
+    Finish();
+}
+
+void NetworkDiagnostic::Finish(void)
+{
+    mTimerWheel.Stop(mQueryTimer);
+    mTimerWheel.Stop(mDeadlineTimer);
+    mTimerWheel.Stop(mIntervalTimer);
+    mState = kStateIdle;
+
+    if (mStarted && mInterval != 0)
+    {
+        mTimerWheel.Start(mIntervalTimer, mInterval);
+    }
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,235 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the network diagnostic collector.
+ */
+
+#ifndef NETWORK_DIAGNOSTIC_HPP_
+#define NETWORK_DIAGNOSTIC_HPP_
+
+#include <stdint.h>
+
+#include "coap.hpp"
+#include "common/timer.hpp"
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class collects the network diagnostics of all routers of the Thread network.
+ *
+ * A round first asks the leader for its route table, then queries every router listed in it, a few at a time so that
+ * the queries fit the window of the TMF proxy, and gathers the answers as they arrive. A round completes once every
+ * router answered or the answer timeout expired, the topology of the last completed round is kept as a snapshot.
+ *
+ */
+class NetworkDiagnostic
+{
+public:
+    enum
+    {
+        kMaxRouters = 63, ///< Max number of routers of a Thread network.
+    };
+
+    /**
+     * This struct defines a router of the topology.
+     *
+     */
+    struct Router
+    {
+        uint16_t mRloc16;                      ///< The RLOC16 of the router.
+        uint8_t  mExtAddress[kSizeExtAddress]; ///< The extended MAC address, only valid if answered.
+        uint64_t mNeighbors;                   ///< Bit i is set if router id i is a neighbor with a link.
+        uint16_t mChildCount;                  ///< Number of children, only valid if answered.
+        bool     mAnswered;                    ///< Whether the router answered the query.
+    };
+
+    /**
+     * This struct defines the topology of the network.
+     *
+     */
+    struct Topology
+    {
+        uint64_t mUpdateTime;           ///< Monotonic time in milliseconds the round completed, 0 if never.
+        uint16_t mLeaderRloc16;         ///< The RLOC16 of the leader.
+        uint8_t  mRouterCount;          ///< Number of routers in the route table of the leader.
+        uint8_t  mAnswerCount;          ///< Number of routers which answered.
+        uint16_t mChildCount;           ///< Number of children of the routers which answered.
+        Router   mRouters[kMaxRouters]; ///< The routers, in the order of their router ids.
+    };
+
+    /**
+     * The constructor to initialize the network diagnostic collector.
+     *
+     * @param[in]   aCoap           A reference to the TMF agent.
+     * @param[in]   aTimerWheel     A reference to the timer wheel.
+     *
+     */
+    NetworkDiagnostic(Coap::Agent &aCoap, TimerWheel &aTimerWheel);
+
+    ~NetworkDiagnostic(void);
+
+    /**
+     * This method starts receiving diagnostic answers, and collecting periodically if an interval is set.
+     *
+     */
+    void Start(void);
+
+    /**
+     * This method stops receiving diagnostic answers, the round in progress is dropped.
+     *
+     */
+    void Stop(void);
+
+    /**
+     * This method sets the interval of collecting the topology.
+     *
+     * @param[in]   aInterval   The time in milliseconds from the end of a round to the next, 0 to only collect when
+     *                          Collect() is called.
+     *
+     */
+    void SetInterval(uint32_t aInterval);
+
+    /**
+     * This method sets the time to wait for the answers of a round.
+     *
+     * @param[in]   aTimeout    The time in milliseconds from the start of a round, 0 to use the default.
+     *
+     */
+    void SetAnswerTimeout(uint32_t aTimeout)
+    {
+        mAnswerTimeout = (aTimeout != 0 ? aTimeout : static_cast<uint32_t>(kAnswerTimeout));
+    }
+
+    /**
+     * This method starts a round of collecting the topology.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully started the round.
+     * @retval  OTBR_ERROR_ERRNO    Failed to start the round, errno is EBUSY if a round is in progress, ENOTCONN if
+     *                              not started.
+     *
+     */
+    otbrError Collect(void);
+
+    /**
+     * This method indicates whether a round is in progress.
+     *
+     * @retval  true    A round is in progress.
+     * @retval  false   No round is in progress.
+     *
+     */
+    bool IsCollecting(void) const { return mState != kStateIdle; }
+
+    /**
+     * This method returns the topology of the last completed round.
+     *
+     * @returns A reference to the topology, without routers if no round completed.
+     *
+     */
+    const Topology &GetTopology(void) const { return mTopology; }
+
+private:
+    enum
+    {
+        kQueryBurst      = 8,    ///< Max number of queries sent at once.
+        kQueryInterval   = 20,   ///< Time in milliseconds between bursts of queries.
+        kAnswerTimeout   = 5000, ///< Default time in milliseconds to wait for the answers of a round.
+        kTokenLength     = 4,    ///< Length of the tokens of the requests.
+        kRouterIdShift   = 10,   ///< Position of the router id in a RLOC16.
+    };
+
+    enum State
+    {
+        kStateIdle,     ///< No round in progress.
+        kStateLeader,   ///< Waiting for the route table of the leader.
+        kStateQuerying, ///< Querying routers and gathering their answers.
+    };
+
+    static void HandleLeaderResponse(const Coap::Message &aMessage, void *aContext)
+    {
+        static_cast<NetworkDiagnostic *>(aContext)->HandleLeaderResponse(aMessage);
+    }
+    void HandleLeaderResponse(const Coap::Message &aMessage);
+
+    static void HandleAnswer(const Coap::Resource &aResource,
+                             const Coap::Message & aMessage,
+                             Coap::Message &       aResponse,
+                             const uint8_t *       aIp6,
+                             uint16_t              aPort,
+                             void *                aContext)
+    {
+        (void)aResource;
+        (void)aPort;
+        static_cast<NetworkDiagnostic *>(aContext)->HandleAnswer(aMessage, aResponse, aIp6);
+    }
+    void HandleAnswer(const Coap::Message &aMessage, Coap::Message &aResponse, const uint8_t *aIp6);
+
+    static void HandleQueryTimer(void *aContext) { static_cast<NetworkDiagnostic *>(aContext)->SendQueries(); }
+    static void HandleDeadlineTimer(void *aContext) { static_cast<NetworkDiagnostic *>(aContext)->Complete(); }
+    static void HandleIntervalTimer(void *aContext)
+    {
+        static_cast<NetworkDiagnostic *>(aContext)->HandleIntervalTimer();
+    }
+    void HandleIntervalTimer(void);
+
+    void NewToken(uint8_t *aToken);
+    bool SetRequest(Coap::Message &aMessage, const char *aPath);
+    void SendQueries(void);
+    void SendQuery(uint16_t aRloc16);
+    void RecordAnswer(const uint8_t *aPayload, uint16_t aLength, uint16_t aLocator);
+    void Complete(void);
+    void Fail(void);
+    void Finish(void);
+
+    Coap::Agent &  mCoap;
+    TimerWheel &   mTimerWheel;
+    Coap::Resource mAnswer;
+    bool           mStarted;
+    State          mState;
+    uint32_t       mInterval;
+    uint32_t       mAnswerTimeout;
+    uint32_t       mNextToken;
+    uint8_t        mLeaderToken[kTokenLength]; ///< Token of the route table request of the round.
+    uint8_t        mNextQuery;                 ///< Index of the next router to query in mRound.
+    uint64_t       mRoundStart;                ///< Monotonic time in milliseconds the round started.
+    Topology       mRound;                     ///< The topology gathered by the round in progress.
+    Topology       mTopology;                  ///< The topology of the last completed round.
+    Timer          mQueryTimer;                ///< Fires once the next burst of queries is due.
+    Timer          mDeadlineTimer;             ///< Fires once the answer timeout of the round expired.
+    Timer          mIntervalTimer;             ///< Fires once the next round is due.
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // NETWORK_DIAGNOSTIC_HPP_
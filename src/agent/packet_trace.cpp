@@ -0,0 +1,392 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements tracing CoAP frames of the TMF proxy and commissioner paths.
+ */
+
+#include "packet_trace.hpp"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/time.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace PacketTrace {
+
+enum
+{
+    kBlockSectionHeader  = 0x0a0d0d0a,
+    kBlockInterface      = 0x00000001,
+    kBlockEnhancedPacket = 0x00000006,
+    kByteOrderMagic      = 0x1a2b3c4d,
+};
+
+// Bodies of pcapng blocks, which are written in host byte order as told by the byte order magic.
+struct SectionHeader
+{
+    uint32_t mByteOrderMagic;
+    uint16_t mMajorVersion;
+    uint16_t mMinorVersion;
+    uint64_t mSectionLength;
+};
+
+struct InterfaceDescription
+{
+    uint16_t mLinkType;
+    uint16_t mReserved;
+    uint32_t mSnapLength;
+};
+
+struct EnhancedPacket
+{
+    uint32_t mInterfaceId;
+    uint32_t mTimestampHigh;
+    uint32_t mTimestampLow;
+    uint32_t mCapturedLength;
+    uint32_t mOriginalLength;
+};
+
+struct RingFrame
+{
+    uint64_t mTime; ///< Monotonic microseconds the frame was recorded at.
+    uint32_t mLength;
+    uint32_t mCaptured;
+    uint8_t  mData[kHeaderSize + kSnapLength];
+};
+
+static RingFrame *sFrames    = NULL;
+static size_t     sSize      = 0;
+static size_t     sNextFrame = 0; ///< Number of frames recorded since started.
+
+otbrError Start(size_t aSize)
+{
+    otbrError error = OTBR_ERROR_ERRNO;
+    RingFrame *frames;
+
+    VerifyOrExit(aSize > 0, errno = EINVAL);
+    VerifyOrExit((frames = static_cast<RingFrame *>(malloc(aSize * sizeof(RingFrame)))) != NULL, errno = ENOMEM);
+
+    Stop();
+    sFrames    = frames;
+    sSize      = aSize;
+    sNextFrame = 0;
+    error      = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+void Stop(void)
+{
+    free(sFrames);
+    sFrames = NULL;
+    sSize   = 0;
+}
+
+// Takes the next frame of the ring and writes its pseudo header, the caller copies the captured bytes.
+static RingFrame *NewFrame(Point aPoint, const uint8_t *aIp6, uint16_t aPort, uint16_t aLength, uint16_t aCaptured)
+{
+    // Agent threads record concurrently, each into a frame of its own.
+    RingFrame *frame = &sFrames[__atomic_fetch_add(&sNextFrame, 1, __ATOMIC_RELAXED) % sSize];
+
+    frame->mTime     = GetMonotonicNowUs();
+    frame->mLength   = kHeaderSize + aLength;
+    frame->mCaptured = kHeaderSize + aCaptured;
+    frame->mData[0]  = static_cast<uint8_t>(aPoint);
+    frame->mData[1]  = 0;
+    frame->mData[2]  = static_cast<uint8_t>(aPort >> 8);
+    frame->mData[3]  = static_cast<uint8_t>(aPort & 0xff);
+    memcpy(&frame->mData[4], aIp6, 16);
+
+    return frame;
+}
+
+void Record(Point aPoint, const uint8_t *aIp6, uint16_t aPort, const uint8_t *aBuffer, uint16_t aLength)
+{
+    uint16_t captured = aLength < kSnapLength ? aLength : static_cast<uint16_t>(kSnapLength);
+
+    VerifyOrExit(sFrames != NULL);
+    memcpy(&NewFrame(aPoint, aIp6, aPort, aLength, captured)->mData[kHeaderSize], aBuffer, captured);
+
+exit:
+    return;
+}
+
+void Record(Point aPoint, const uint8_t *aIp6, uint16_t aPort, const struct iovec *aVector, int aCount)
+{
+    uint16_t   length   = 0;
+    uint16_t   captured = 0;
+    RingFrame *frame;
+
+    VerifyOrExit(sFrames != NULL);
+
+    for (int i = 0; i < aCount; ++i)
+    {
+        length = static_cast<uint16_t>(length + aVector[i].iov_len);
+    }
+
+    frame = NewFrame(aPoint, aIp6, aPort, length, length < kSnapLength ? length : static_cast<uint16_t>(kSnapLength));
+
+    for (int i = 0; i < aCount && captured < kSnapLength; ++i)
+    {
+        uint16_t part = static_cast<uint16_t>(aVector[i].iov_len);
+
+        part = part < kSnapLength - captured ? part : static_cast<uint16_t>(kSnapLength - captured);
+        memcpy(&frame->mData[kHeaderSize + captured], aVector[i].iov_base, part);
+        captured = static_cast<uint16_t>(captured + part);
+    }
+
+exit:
+    return;
+}
+
+// Writes a block of @p aBody followed by @p aData padded to 32 bits.
+static bool WriteBlock(FILE *      aFile,
+                       uint32_t    aType,
+                       const void *aBody,
+                       size_t      aBodyLength,
+                       const void *aData,
+                       size_t      aDataLength)
+{
+    static const uint8_t kPadding[3] = {0, 0, 0};
+    size_t               padding     = (4 - aDataLength % 4) % 4;
+    uint32_t             length      = static_cast<uint32_t>(12 + aBodyLength + aDataLength + padding);
+
+    return fwrite(&aType, sizeof(aType), 1, aFile) == 1 && fwrite(&length, sizeof(length), 1, aFile) == 1 &&
+           fwrite(aBody, aBodyLength, 1, aFile) == 1 &&
+           (aDataLength == 0 || fwrite(aData, aDataLength, 1, aFile) == 1) &&
+           (padding == 0 || fwrite(kPadding, padding, 1, aFile) == 1) &&
+           fwrite(&length, sizeof(length), 1, aFile) == 1;
+}
+
+otbrError Save(const char *aFilename)
+{
+    otbrError            error = OTBR_ERROR_ERRNO;
+    FILE *               file  = NULL;
+    size_t               next  = __atomic_load_n(&sNextFrame, __ATOMIC_RELAXED);
+    size_t               count = next < sSize ? next : sSize;
+    SectionHeader        section;
+    InterfaceDescription interface;
+    uint64_t             offset;
+    timeval              now;
+
+    VerifyOrExit(sFrames != NULL, errno = EINVAL);
+    VerifyOrExit((file = fopen(aFilename, "wb")) != NULL);
+
+    section.mByteOrderMagic = kByteOrderMagic;
+    section.mMajorVersion   = 1;
+    section.mMinorVersion   = 0;
+    section.mSectionLength  = ~static_cast<uint64_t>(0);
+    interface.mLinkType     = kLinkType;
+    interface.mReserved     = 0;
+    interface.mSnapLength   = kHeaderSize + kSnapLength;
+
+    VerifyOrExit(WriteBlock(file, kBlockSectionHeader, &section, sizeof(section), NULL, 0) &&
+                     WriteBlock(file, kBlockInterface, &interface, sizeof(interface), NULL, 0),
+                 errno = EIO);
+
+    // Timestamps are recorded on the monotonic clock, and converted to wall clock time in microseconds.
+    gettimeofday(&now, NULL);
+    offset = static_cast<uint64_t>(now.tv_sec) * 1000000 + static_cast<uint64_t>(now.tv_usec) - GetMonotonicNowUs();
+
+    for (size_t i = next - count; i != next; ++i)
+    {
+        const RingFrame &frame = sFrames[i % sSize];
+        uint64_t         time  = frame.mTime + offset;
+        EnhancedPacket   packet;
+
+        packet.mInterfaceId    = 0;
+        packet.mTimestampHigh  = static_cast<uint32_t>(time >> 32);
+        packet.mTimestampLow   = static_cast<uint32_t>(time & 0xffffffff);
+        packet.mCapturedLength = frame.mCaptured;
+        packet.mOriginalLength = frame.mLength;
+
+        VerifyOrExit(WriteBlock(file, kBlockEnhancedPacket, &packet, sizeof(packet), frame.mData, frame.mCaptured),
+                     errno = EIO);
+    }
+
+    VerifyOrExit(fflush(file) == 0);
+    otbrLog(OTBR_LOG_INFO, "Saved %u traced frames to %s", static_cast<unsigned int>(count), aFilename);
+    error = OTBR_ERROR_NONE;
+
+exit:
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+
+    return error;
+}
+
+Reader::Reader(void)
+    : mData(NULL)
+    , mSize(0)
+    , mFirst(0)
+    , mOffset(0)
+{
+}
+
+Reader::~Reader(void)
+{
+    Close();
+}
+
+otbrError Reader::Open(const char *aFilename)
+{
+    otbrError            error = OTBR_ERROR_ERRNO;
+    int                  fd    = -1;
+    struct stat          st;
+    void *               data;
+    uint32_t             block[2];
+    SectionHeader        section;
+    InterfaceDescription interface;
+
+    Close();
+
+    VerifyOrExit((fd = open(aFilename, O_RDONLY)) >= 0);
+    VerifyOrExit(fstat(fd, &st) == 0);
+    VerifyOrExit(st.st_size >= static_cast<off_t>(2 * 12 + sizeof(section) + sizeof(interface)), errno = EINVAL);
+    VerifyOrExit((data = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0)) != MAP_FAILED);
+
+    mData = static_cast<const uint8_t *>(data);
+    mSize = static_cast<size_t>(st.st_size);
+
+    // The section header, then the interface description, as written by Save().
+    memcpy(block, mData, sizeof(block));
+    memcpy(&section, mData + sizeof(block), sizeof(section));
+    VerifyOrExit(block[0] == kBlockSectionHeader && section.mByteOrderMagic == kByteOrderMagic && block[1] % 4 == 0 &&
+                     block[1] >= 12 + sizeof(section) && block[1] <= mSize - 12 - sizeof(interface),
+                 errno = EINVAL);
+    mFirst = block[1];
+
+    memcpy(block, mData + mFirst, sizeof(block));
+    memcpy(&interface, mData + mFirst + sizeof(block), sizeof(interface));
+    VerifyOrExit(block[0] == kBlockInterface && interface.mLinkType == kLinkType && block[1] % 4 == 0 &&
+                     block[1] >= 12 + sizeof(interface) && block[1] <= mSize - mFirst,
+                 errno = EINVAL);
+    mFirst += block[1];
+    mOffset = mFirst;
+    error   = OTBR_ERROR_NONE;
+
+exit:
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    if (error != OTBR_ERROR_NONE)
+    {
+        int saved = errno;
+
+        Close();
+        errno = saved;
+    }
+
+    return error;
+}
+
+void Reader::Close(void)
+{
+    if (mData != NULL)
+    {
+        munmap(const_cast<uint8_t *>(mData), mSize);
+    }
+
+    mData   = NULL;
+    mSize   = 0;
+    mFirst  = 0;
+    mOffset = 0;
+}
+
+bool Reader::Next(Frame &aFrame)
+{
+    bool found = false;
+
+    while (!found && mSize - mOffset >= 12)
+    {
+        const uint8_t *block = mData + mOffset;
+        uint32_t       header[2];
+        EnhancedPacket packet;
+
+        memcpy(header, block, sizeof(header));
+        VerifyOrExit(header[1] >= 12 && header[1] % 4 == 0 && header[1] <= mSize - mOffset);
+        mOffset += header[1];
+
+        if (header[0] != kBlockEnhancedPacket)
+        {
+            continue;
+        }
+
+        VerifyOrExit(header[1] >= 12 + sizeof(packet));
+        memcpy(&packet, block + 8, sizeof(packet));
+        VerifyOrExit(packet.mCapturedLength >= kHeaderSize && packet.mCapturedLength <= packet.mOriginalLength &&
+                     packet.mCapturedLength <= header[1] - 12 - sizeof(packet) &&
+                     packet.mOriginalLength <= kHeaderSize + 0xffff);
+
+        block += 8 + sizeof(packet);
+
+        aFrame.mTime           = static_cast<uint64_t>(packet.mTimestampHigh) << 32 | packet.mTimestampLow;
+        aFrame.mPoint          = static_cast<Point>(block[0]);
+        aFrame.mPort           = static_cast<uint16_t>(block[2] << 8 | block[3]);
+        aFrame.mIp6            = &block[4];
+        aFrame.mMessage        = &block[kHeaderSize];
+        aFrame.mLength         = static_cast<uint16_t>(packet.mCapturedLength - kHeaderSize);
+        aFrame.mOriginalLength = static_cast<uint16_t>(packet.mOriginalLength - kHeaderSize);
+        found                  = true;
+    }
+
+exit:
+    if (!found)
+    {
+        // A malformed block ends the trace.
+        mOffset = mSize;
+    }
+
+    return found;
+}
+
+} // namespace PacketTrace
+
+} // namespace BorderRouter
+
+} // namespace ot
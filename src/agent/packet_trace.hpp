@@ -0,0 +1,224 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for tracing CoAP frames of the TMF proxy and commissioner paths.
+ */
+
+#ifndef PACKET_TRACE_HPP_
+#define PACKET_TRACE_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sys/uio.h>
+
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace PacketTrace {
+
+/**
+ * @addtogroup border-router-packet-trace
+ *
+ * @brief
+ *   This module records plaintext CoAP frames to a ring, which is written to a pcapng file on demand.
+ *
+ * Frames use the link type LINKTYPE_USER0 (147). Each frame starts with a pseudo header of kHeaderSize bytes: the
+ * trace point, a reserved byte, the UDP port of the peer in network order and the IPv6 address of the peer, followed
+ * by the CoAP message. In Wireshark, map DLT User 0 to header size 20 and payload protocol "coap".
+ *
+ * Frames are only recorded once the trace is started, otherwise recording costs a branch. Frames may be recorded from
+ * any agent thread, starting, stopping and saving must be done from the mainloop. A frame recorded while the trace is
+ * saved may be saved partially written.
+ *
+ * @{
+ */
+
+enum
+{
+    kLinkType    = 147,  ///< LINKTYPE_USER0.
+    kHeaderSize  = 20,   ///< Size of the pseudo header of a frame.
+    kSnapLength  = 512,  ///< Max bytes of a CoAP message recorded.
+    kDefaultSize = 1024, ///< Default number of frames kept in the ring.
+};
+
+/**
+ * Trace points.
+ *
+ */
+enum Point
+{
+    kPointThreadIn        = 0, ///< A TMF message received from the Thread network, AgentInstance::FeedCoap().
+    kPointThreadOut       = 1, ///< A TMF message sent to the Thread network, AgentInstance::SendCoap().
+    kPointCommissionerIn  = 2, ///< A CoAP message received from a commissioner, BorderAgent::FeedCoaps().
+    kPointCommissionerOut = 3, ///< A CoAP message sent to a commissioner, BorderAgent::SendCoaps().
+};
+
+/**
+ * This function starts recording frames, dropping the frames previously recorded.
+ *
+ * @param[in]   aSize   The number of frames kept, older frames are overwritten.
+ *
+ * @retval  OTBR_ERROR_NONE     Successfully started.
+ * @retval  OTBR_ERROR_ERRNO    Failed to allocate the ring, error code set in errno.
+ *
+ */
+otbrError Start(size_t aSize = kDefaultSize);
+
+/**
+ * This function stops recording frames and frees the ring.
+ *
+ */
+void Stop(void);
+
+/**
+ * This function records a frame if the trace is started.
+ *
+ * @param[in]   aPoint      The trace point.
+ * @param[in]   aIp6        A pointer to the IPv6 address of the peer.
+ * @param[in]   aPort       The UDP port of the peer.
+ * @param[in]   aBuffer     A pointer to the CoAP message.
+ * @param[in]   aLength     Number of bytes of @p aBuffer, only the first kSnapLength bytes are recorded.
+ *
+ */
+void Record(Point aPoint, const uint8_t *aIp6, uint16_t aPort, const uint8_t *aBuffer, uint16_t aLength);
+
+/**
+ * This function records a frame gathered from parts if the trace is started.
+ *
+ * @param[in]   aPoint      The trace point.
+ * @param[in]   aIp6        A pointer to the IPv6 address of the peer.
+ * @param[in]   aPort       The UDP port of the peer.
+ * @param[in]   aVector     A pointer to the parts of the CoAP message.
+ * @param[in]   aCount      Number of parts in @p aVector.
+ *
+ */
+void Record(Point aPoint, const uint8_t *aIp6, uint16_t aPort, const struct iovec *aVector, int aCount);
+
+/**
+ * This function writes the frames in the ring to a pcapng file, oldest first.
+ *
+ * Frames stay in the ring, so a later save includes them again unless they were overwritten.
+ *
+ * @param[in]   aFilename   The name of the file, which is replaced.
+ *
+ * @retval  OTBR_ERROR_NONE     Successfully written.
+ * @retval  OTBR_ERROR_ERRNO    Failed to write the file, error code set in errno.
+ *
+ */
+otbrError Save(const char *aFilename);
+
+/**
+ * This structure represents a frame read from a trace.
+ *
+ */
+struct Frame
+{
+    uint64_t       mTime;           ///< Wall clock microseconds the frame was recorded at.
+    Point          mPoint;          ///< The trace point.
+    uint16_t       mPort;           ///< The UDP port of the peer.
+    const uint8_t *mIp6;            ///< The IPv6 address of the peer.
+    const uint8_t *mMessage;        ///< The CoAP message.
+    uint16_t       mLength;         ///< Number of bytes of mMessage recorded.
+    uint16_t       mOriginalLength; ///< Number of bytes of the CoAP message, more than mLength if truncated.
+};
+
+/**
+ * This class reads the frames of a trace written by Save().
+ *
+ * The file is memory-mapped, so frames are read in place and stay valid until the reader is closed. Blocks other
+ * than enhanced packets are skipped, the trace must be in host byte order.
+ *
+ */
+class Reader
+{
+public:
+    Reader(void);
+    ~Reader(void);
+
+    /**
+     * This method opens a trace, closing the one previously opened.
+     *
+     * @param[in]   aFilename   The name of the file.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully opened.
+     * @retval  OTBR_ERROR_ERRNO    Failed to map the file, error code set in errno, EINVAL if it is not a trace of
+     *                              this link type and byte order.
+     *
+     */
+    otbrError Open(const char *aFilename);
+
+    /**
+     * This method closes the trace, invalidating the frames read.
+     *
+     */
+    void Close(void);
+
+    /**
+     * This method reads the next frame.
+     *
+     * @param[out]  aFrame      A reference to the frame read.
+     *
+     * @retval  true    Successfully read a frame.
+     * @retval  false   No more frames, or the rest of the trace is malformed.
+     *
+     */
+    bool Next(Frame &aFrame);
+
+    /**
+     * This method restarts reading at the first frame.
+     *
+     */
+    void Rewind(void) { mOffset = mFirst; }
+
+private:
+    Reader(const Reader &);
+    Reader &operator=(const Reader &);
+
+    const uint8_t *mData;
+    size_t         mSize;
+    size_t         mFirst;  ///< Offset of the first block after the interface description.
+    size_t         mOffset; ///< Offset of the next block.
+};
+
+/**
+ * @}
+ */
+
+} // namespace PacketTrace
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // PACKET_TRACE_HPP_
@@ -0,0 +1,182 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the statistics of the relayed messages of each joiner.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_BORDER_AGENT
+
+#include "relay_flows.hpp"
+
+#include <string.h>
+
+#include "common/code_utils.hpp"
+#include "common/metrics.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+static Metrics::Counter   sFlowsEvicted("border_agent.relay_flows_evicted");
+static Metrics::Histogram sMeshTurnaround("border_agent.relay_mesh_turnaround_us");
+static Metrics::Histogram sCommissionerTurnaround("border_agent.relay_commissioner_turnaround_us");
+
+static uint32_t Elapsed(uint64_t aFrom, uint64_t aTo)
+{
+    uint64_t elapsed = aTo > aFrom ? aTo - aFrom : 0;
+
+    return elapsed > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(elapsed);
+}
+
+RelayFlowTable::RelayFlowTable(void)
+{
+    Clear();
+}
+
+void RelayFlowTable::Clear(void)
+{
+    memset(mFlows, 0, sizeof(mFlows));
+}
+
+RelayFlowTable::Flow *RelayFlowTable::Find(const uint8_t *aJoinerIid, uint16_t aLocator, uint64_t aArrival)
+{
+    Flow *flow = NULL;
+    Flow *lru  = &mFlows[0];
+
+    for (Flow *cur = &mFlows[0]; cur != &mFlows[kMaxFlows]; ++cur)
+    {
+        if (cur->mLastTime == 0)
+        {
+            lru = cur;
+            continue;
+        }
+
+        if (cur->mLocator == aLocator && memcmp(cur->mJoinerIid, aJoinerIid, sizeof(cur->mJoinerIid)) == 0)
+        {
+            ExitNow(flow = cur);
+        }
+
+        if (lru->mLastTime != 0 && cur->mLastTime < lru->mLastTime)
+        {
+            lru = cur;
+        }
+    }
+
+    if (lru->mLastTime != 0)
+    {
+        sFlowsEvicted.Add();
+    }
+
+    flow = lru;
+    memset(flow, 0, sizeof(*flow));
+    memcpy(flow->mJoinerIid, aJoinerIid, sizeof(flow->mJoinerIid));
+    flow->mLocator   = aLocator;
+    flow->mFirstTime = aArrival;
+
+exit:
+    return flow;
+}
+
+void RelayFlowTable::Record(Direction      aDirection,
+                            const uint8_t *aJoinerIid,
+                            uint16_t       aLocator,
+                            uint16_t       aLength,
+                            uint64_t       aArrival,
+                            uint32_t       aForwardTime)
+{
+    Flow * flow  = Find(aJoinerIid, aLocator, aArrival);
+    Stats &stats = flow->mStats[aDirection];
+
+    // A message following one of the other direction answers it, so the time since tells where the exchange waited.
+    if (flow->mLastTime != 0 && flow->mLastDirection != aDirection)
+    {
+        uint32_t turnaround = Elapsed(flow->mLastTime, aArrival);
+
+        stats.mTurnarounds++;
+        stats.mTurnaroundTotal += turnaround;
+        stats.mTurnaroundMax = turnaround > stats.mTurnaroundMax ? turnaround : stats.mTurnaroundMax;
+        (aDirection == kDirectionReceive ? sMeshTurnaround : sCommissionerTurnaround).Record(turnaround);
+    }
+
+    if (stats.mLastTime != 0)
+    {
+        uint32_t gap = Elapsed(stats.mLastTime, aArrival);
+
+        stats.mGapTotal += gap;
+        stats.mGapMax = gap > stats.mGapMax ? gap : stats.mGapMax;
+    }
+
+    stats.mPackets++;
+    stats.mBytes += aLength;
+    stats.mLastTime = aArrival;
+    stats.mForwardTotal += aForwardTime;
+    stats.mForwardMax = aForwardTime > stats.mForwardMax ? aForwardTime : stats.mForwardMax;
+
+    // The arrival time is never 0, which would mark the flow unused.
+    flow->mLastTime      = aArrival != 0 ? aArrival : 1;
+    flow->mLastDirection = aDirection;
+}
+
+unsigned int RelayFlowTable::GetFlows(Flow *aFlows, unsigned int aMaxFlows) const
+{
+    unsigned int count = 0;
+
+    for (const Flow *flow = &mFlows[0]; flow != &mFlows[kMaxFlows]; ++flow)
+    {
+        unsigned int i;
+
+        if (flow->mLastTime == 0)
+        {
+            continue;
+        }
+
+        // Insertion sort, keeping the most recently used flows which fit.
+        i = count < aMaxFlows ? count++ : aMaxFlows;
+
+        for (; i > 0 && aFlows[i - 1].mLastTime < flow->mLastTime; --i)
+        {
+            if (i < aMaxFlows)
+            {
+                aFlows[i] = aFlows[i - 1];
+            }
+        }
+
+        if (i < aMaxFlows)
+        {
+            aFlows[i] = *flow;
+        }
+    }
+
+    return count;
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
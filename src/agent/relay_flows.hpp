@@ -0,0 +1,169 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of the statistics of the relayed messages of each joiner.
+ */
+
+#ifndef RELAY_FLOWS_HPP_
+#define RELAY_FLOWS_HPP_
+
+#include <stdint.h>
+
+#include "common/capacity.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * @addtogroup border-router-border-agent
+ *
+ * @{
+ */
+
+/**
+ * This class keeps the statistics of the messages relayed between joiners and the commissioner.
+ *
+ * Flows are identified by the joiner IID and the locator of its joiner router, as carried by the TLVs of RLY_RX.ntf
+ * and RLY_TX.ntf. Besides packets and bytes, each direction records the gaps between its messages, the time the agent
+ * took to forward them, and the time since the last message of the other direction. The latter tells the time spent in
+ * the mesh and the joiner, for messages from the joiner, and in the commissioner, for messages to it.
+ *
+ * Flows are kept in a fixed table, the least recently used one is forgotten when it is full.
+ *
+ */
+class RelayFlowTable
+{
+public:
+    enum
+    {
+        kMaxFlows      = OTBR_CAPACITY_RELAY_FLOWS, ///< Number of flows kept.
+        kJoinerIidSize = 8,                         ///< Bytes of a joiner IID.
+    };
+
+    /**
+     * This enumeration represents the direction of a relayed message.
+     *
+     */
+    enum Direction
+    {
+        kDirectionReceive  = 0, ///< From the joiner to the commissioner, RLY_RX.ntf.
+        kDirectionTransmit = 1, ///< From the commissioner to the joiner, RLY_TX.ntf.
+        kNumDirections     = 2,
+    };
+
+    /**
+     * This struct represents the statistics of the messages of a flow in one direction.
+     *
+     */
+    struct Stats
+    {
+        uint32_t mPackets;         ///< Number of messages.
+        uint64_t mBytes;           ///< Bytes of the payloads of the messages.
+        uint64_t mLastTime;        ///< Monotonic microseconds the last message arrived at, 0 if none.
+        uint64_t mGapTotal;        ///< Sum of the microseconds between consecutive messages.
+        uint32_t mGapMax;          ///< Longest microseconds between consecutive messages.
+        uint64_t mForwardTotal;    ///< Sum of the microseconds taken to forward the messages.
+        uint32_t mForwardMax;      ///< Longest microseconds taken to forward a message.
+        uint32_t mTurnarounds;     ///< Number of messages following one of the other direction.
+        uint64_t mTurnaroundTotal; ///< Sum of the microseconds since the message of the other direction.
+        uint32_t mTurnaroundMax;   ///< Longest microseconds since the message of the other direction.
+    };
+
+    /**
+     * This struct represents a flow.
+     *
+     */
+    struct Flow
+    {
+        uint8_t   mJoinerIid[kJoinerIidSize]; ///< The IID of the joiner.
+        uint16_t  mLocator;                   ///< The locator of the joiner router.
+        uint64_t  mFirstTime;                 ///< Monotonic microseconds the first message arrived at.
+        uint64_t  mLastTime;                  ///< Monotonic microseconds the last message arrived at, 0 if unused.
+        Direction mLastDirection;             ///< The direction of the last message.
+        Stats     mStats[kNumDirections];     ///< The statistics of each direction.
+    };
+
+    /**
+     * The constructor to initialize an empty table.
+     *
+     */
+    RelayFlowTable(void);
+
+    /**
+     * This method records a relayed message.
+     *
+     * @param[in]   aDirection      The direction of the message.
+     * @param[in]   aJoinerIid      A pointer to the joiner IID, of kJoinerIidSize bytes.
+     * @param[in]   aLocator        The locator of the joiner router.
+     * @param[in]   aLength         Bytes of the payload of the message.
+     * @param[in]   aArrival        Monotonic microseconds the message arrived at.
+     * @param[in]   aForwardTime    Microseconds taken to forward the message.
+     *
+     */
+    void Record(Direction      aDirection,
+                const uint8_t *aJoinerIid,
+                uint16_t       aLocator,
+                uint16_t       aLength,
+                uint64_t       aArrival,
+                uint32_t       aForwardTime);
+
+    /**
+     * This method returns the flows, the most recently used first.
+     *
+     * @param[out]  aFlows      A pointer to an array to receive the flows.
+     * @param[in]   aMaxFlows   The number of entries of @p aFlows.
+     *
+     * @returns The number of flows copied.
+     *
+     */
+    unsigned int GetFlows(Flow *aFlows, unsigned int aMaxFlows) const;
+
+    /**
+     * This method forgets all flows.
+     *
+     */
+    void Clear(void);
+
+private:
+    Flow *Find(const uint8_t *aJoinerIid, uint16_t aLocator, uint64_t aArrival);
+
+    Flow mFlows[kMaxFlows];
+};
+
+/**
+ * @}
+ */
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // RELAY_FLOWS_HPP_
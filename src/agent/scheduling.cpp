@@ -0,0 +1,226 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the CPU affinity, scheduling and memory locking of the agent threads.
+ */
+
+#include "scheduling.hpp"
+
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Scheduling {
+
+enum
+{
+    kPrefaultStackSize = 64 * 1024, ///< Bytes of stack faulted in, more than the mainloop uses.
+};
+
+static bool ParseNumber(const char *&aString, long aMin, long aMax, long &aValue)
+{
+    char *end;
+    bool  parsed = false;
+
+    errno  = 0;
+    aValue = strtol(aString, &end, 10);
+    VerifyOrExit(end != aString && errno == 0 && aValue >= aMin && aValue <= aMax);
+    aString = end;
+    parsed  = true;
+
+exit:
+    return parsed;
+}
+
+otbrError ParseCpus(const char *aCpus, cpu_set_t &aSet)
+{
+    otbrError   error = OTBR_ERROR_ERRNO;
+    const char *cur   = aCpus;
+
+    CPU_ZERO(&aSet);
+
+    for (;;)
+    {
+        long first;
+        long last;
+
+        VerifyOrExit(ParseNumber(cur, 0, CPU_SETSIZE - 1, first), errno = EINVAL);
+        last = first;
+
+        if (*cur == '-')
+        {
+            ++cur;
+            VerifyOrExit(ParseNumber(cur, first, CPU_SETSIZE - 1, last), errno = EINVAL);
+        }
+
+        for (long cpu = first; cpu <= last; ++cpu)
+        {
+            CPU_SET(static_cast<int>(cpu), &aSet);
+        }
+
+        if (*cur == '\0')
+        {
+            break;
+        }
+
+        VerifyOrExit(*cur == ',', errno = EINVAL);
+        ++cur;
+    }
+
+    error = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+otbrError ParsePriority(const char *aPriority, Priority &aParsed)
+{
+    otbrError   error = OTBR_ERROR_ERRNO;
+    const char *value = strchr(aPriority, '=');
+    long        number;
+
+    VerifyOrExit(value != NULL, errno = EINVAL);
+    ++value;
+
+    if (strncmp(aPriority, "fifo=", sizeof("fifo=") - 1) == 0)
+    {
+        aParsed.mPolicy = SCHED_FIFO;
+        VerifyOrExit(ParseNumber(value, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO), number),
+                     errno = EINVAL);
+    }
+    else if (strncmp(aPriority, "nice=", sizeof("nice=") - 1) == 0)
+    {
+        aParsed.mPolicy = SCHED_OTHER;
+        VerifyOrExit(ParseNumber(value, -20, 19, number), errno = EINVAL);
+    }
+    else
+    {
+        ExitNow(errno = EINVAL);
+    }
+
+    VerifyOrExit(*value == '\0', errno = EINVAL);
+    aParsed.mValue = static_cast<int>(number);
+    error          = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+otbrError SetAffinity(const char *aCpus)
+{
+    otbrError error = OTBR_ERROR_ERRNO;
+    cpu_set_t set;
+
+    SuccessOrExit(error = ParseCpus(aCpus, set));
+    error = OTBR_ERROR_ERRNO;
+    VerifyOrExit(sched_setaffinity(0, sizeof(set), &set) == 0);
+    otbrLog(OTBR_LOG_INFO, "Agent threads run on CPUs %s", aCpus);
+    error = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+otbrError SetPriority(const Priority &aPriority)
+{
+    otbrError error = OTBR_ERROR_ERRNO;
+
+    if (aPriority.mPolicy == SCHED_FIFO)
+    {
+        struct sched_param param;
+
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = aPriority.mValue;
+        errno                = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        VerifyOrExit(errno == 0);
+    }
+    else
+    {
+        // The nice value of a thread is set by its thread ID on Linux.
+        VerifyOrExit(setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), aPriority.mValue) == 0);
+    }
+
+    error = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+otbrError LockMemory(void)
+{
+    otbrError error = OTBR_ERROR_ERRNO;
+
+    // Freed memory stays in the heap, allocations are never served by a new mapping faulted in at first use.
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    VerifyOrExit(mlockall(MCL_CURRENT) == 0);
+#ifdef MCL_ONFAULT
+    VerifyOrExit(mlockall(MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT) == 0);
+#else
+    VerifyOrExit(mlockall(MCL_CURRENT | MCL_FUTURE) == 0);
+#endif
+
+    PrefaultStack();
+    error = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+void PrefaultStack(void)
+{
+    volatile uint8_t stack[kPrefaultStackSize];
+    const size_t     pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    for (size_t i = 0; i < sizeof(stack); i += pageSize)
+    {
+        stack[i] = 0;
+    }
+}
+
+} // namespace Scheduling
+
+} // namespace BorderRouter
+
+} // namespace ot
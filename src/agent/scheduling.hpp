@@ -0,0 +1,145 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the CPU affinity, scheduling and memory locking of the agent threads.
+ */
+
+#ifndef SCHEDULING_HPP_
+#define SCHEDULING_HPP_
+
+#include <sched.h>
+
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Scheduling {
+
+/**
+ * @addtogroup border-router-scheduling
+ *
+ * @brief
+ *   This module gives the agent predictable scheduling on gateways shared with other daemons.
+ *
+ * The CPU affinity is set on the main thread before any other thread is created, so that all agent threads inherit
+ * it. The priority only applies to the threads running a reactor, worker threads are created with the default
+ * policy so that handshake computations never starve the system.
+ *
+ * @{
+ */
+
+/**
+ * This structure represents the priority of a reactor thread.
+ *
+ */
+struct Priority
+{
+    int mPolicy; ///< SCHED_FIFO, or SCHED_OTHER with a nice value.
+    int mValue;  ///< The real-time priority with SCHED_FIFO, the nice value otherwise.
+};
+
+/**
+ * This function parses a list of CPUs, e.g. "0,2-3".
+ *
+ * @param[in]   aCpus   A pointer to the list of CPUs.
+ * @param[out]  aSet    A reference to the set of CPUs parsed.
+ *
+ * @retval  OTBR_ERROR_NONE     Successfully parsed.
+ * @retval  OTBR_ERROR_ERRNO    The list is malformed or empty, errno set to EINVAL.
+ *
+ */
+otbrError ParseCpus(const char *aCpus, cpu_set_t &aSet);
+
+/**
+ * This function parses a priority, "fifo=PRIORITY" or "nice=NICE", e.g. "fifo=10" or "nice=-5".
+ *
+ * @param[in]   aPriority   A pointer to the priority.
+ * @param[out]  aParsed     A reference to the priority parsed.
+ *
+ * @retval  OTBR_ERROR_NONE     Successfully parsed.
+ * @retval  OTBR_ERROR_ERRNO    The priority is malformed or out of range, errno set to EINVAL.
+ *
+ */
+otbrError ParsePriority(const char *aPriority, Priority &aParsed);
+
+/**
+ * This function sets the CPU affinity of the calling thread, inherited by the threads it creates later.
+ *
+ * @param[in]   aCpus   A pointer to the list of CPUs, as parsed by ParseCpus().
+ *
+ * @retval  OTBR_ERROR_NONE     Successfully set.
+ * @retval  OTBR_ERROR_ERRNO    Failed to set, error code set in errno.
+ *
+ */
+otbrError SetAffinity(const char *aCpus);
+
+/**
+ * This function sets the priority of the calling thread.
+ *
+ * @param[in]   aPriority   The priority.
+ *
+ * @retval  OTBR_ERROR_NONE     Successfully set.
+ * @retval  OTBR_ERROR_ERRNO    Failed to set, e.g. EPERM without CAP_SYS_NICE, error code set in errno.
+ *
+ */
+otbrError SetPriority(const Priority &aPriority);
+
+/**
+ * This function locks the memory of the process, so that the agent never waits for a page fault.
+ *
+ * The memory currently mapped, e.g. the pools allocated by the agent instances, is faulted in and locked. Memory
+ * mapped later, e.g. the stacks of the threads created later, is locked as it is touched, so that they do not lock
+ * their whole stack. Freed heap memory is kept by the allocator instead of being returned to the system.
+ *
+ * @retval  OTBR_ERROR_NONE     Successfully locked.
+ * @retval  OTBR_ERROR_ERRNO    Failed to lock, e.g. ENOMEM beyond RLIMIT_MEMLOCK, error code set in errno.
+ *
+ */
+otbrError LockMemory(void);
+
+/**
+ * This function faults in the stack of the calling thread, which must be locked by LockMemory().
+ *
+ */
+void PrefaultStack(void);
+
+/**
+ * @}
+ */
+
+} // namespace Scheduling
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // SCHEDULING_HPP_
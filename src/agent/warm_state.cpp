@@ -0,0 +1,235 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the state of a border agent kept across restarts.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_BORDER_AGENT
+
+#include "warm_state.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+WarmState::WarmState(void)
+    : mFile(NULL)
+    , mRestored(false)
+{
+    memset(&mSnapshot, 0, sizeof(mSnapshot));
+    memset(&mRestoredSnapshot, 0, sizeof(mRestoredSnapshot));
+}
+
+WarmState::~WarmState(void)
+{
+    Close();
+}
+
+otbrError WarmState::Open(const char *aFilename, const char *aIfName)
+{
+    otbrError   error = OTBR_ERROR_ERRNO;
+    int         fd    = -1;
+    struct stat st;
+    void *      mapping;
+
+    Close();
+
+    VerifyOrExit((fd = open(aFilename, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR)) != -1);
+    VerifyOrExit(fstat(fd, &st) == 0);
+
+    if (st.st_size != static_cast<off_t>(sizeof(File)))
+    {
+        VerifyOrExit(ftruncate(fd, sizeof(File)) == 0);
+    }
+
+    mapping = mmap(NULL, sizeof(File), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    VerifyOrExit(mapping != MAP_FAILED);
+    mFile = static_cast<File *>(mapping);
+
+    mRestored = mFile->mMagic == kMagic && mFile->mVersion == kVersion && mFile->mSize == sizeof(File) &&
+                (mFile->mSequence & 1) == 0 && strncmp(mFile->mIfName, aIfName, sizeof(mFile->mIfName) - 1) == 0 &&
+                mFile->mChecksum == Checksum(*mFile);
+
+    if (mRestored)
+    {
+        mSnapshot         = mFile->mSnapshot;
+        mRestoredSnapshot = mFile->mSnapshot;
+
+        mSnapshot.mNetworkName[sizeof(mSnapshot.mNetworkName) - 1]                 = '\0';
+        mRestoredSnapshot.mNetworkName[sizeof(mRestoredSnapshot.mNetworkName) - 1] = '\0';
+        otbrLog(OTBR_LOG_INFO, "Restored state of %s from %s", aIfName, aFilename);
+    }
+    else
+    {
+        memset(mFile, 0, sizeof(File));
+        memset(&mSnapshot, 0, sizeof(mSnapshot));
+        mFile->mMagic   = kMagic;
+        mFile->mVersion = kVersion;
+        mFile->mSize    = sizeof(File);
+        strncpy(mFile->mIfName, aIfName, sizeof(mFile->mIfName) - 1);
+        Commit();
+    }
+
+    error = OTBR_ERROR_NONE;
+
+exit:
+    if (fd != -1)
+    {
+        close(fd);
+    }
+
+    if (error != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "Failed to open state file %s: %s", aFilename, strerror(errno));
+    }
+
+    return error;
+}
+
+void WarmState::Close(void)
+{
+    if (mFile != NULL)
+    {
+        munmap(mFile, sizeof(File));
+        mFile = NULL;
+    }
+
+    mRestored = false;
+}
+
+uint32_t WarmState::Checksum(const File &aFile)
+{
+    // FNV-1a
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(aFile.mIfName);
+    const uint8_t *end   = reinterpret_cast<const uint8_t *>(&aFile.mSnapshot + 1);
+    uint32_t       hash  = 2166136261u;
+
+    for (; bytes < end; ++bytes)
+    {
+        hash = (hash ^ *bytes) * 16777619u;
+    }
+
+    return hash;
+}
+
+void WarmState::Commit(void)
+{
+    uint32_t sequence;
+
+    VerifyOrExit(mFile != NULL);
+
+    // Only a crash of the agent, not of the system, must be survived, so the mapping is never synced to disk.
+    sequence = mFile->mSequence | 1;
+    __atomic_store_n(&mFile->mSequence, sequence, __ATOMIC_RELEASE);
+    mFile->mSnapshot = mSnapshot;
+    mFile->mChecksum = Checksum(*mFile);
+    __atomic_store_n(&mFile->mSequence, sequence + 1, __ATOMIC_RELEASE);
+
+exit:
+    return;
+}
+
+void WarmState::SetNetworkName(const char *aNetworkName)
+{
+    VerifyOrExit(strncmp(mSnapshot.mNetworkName, aNetworkName, sizeof(mSnapshot.mNetworkName) - 1) != 0);
+    strncpy(mSnapshot.mNetworkName, aNetworkName, sizeof(mSnapshot.mNetworkName) - 1);
+    Commit();
+
+exit:
+    return;
+}
+
+void WarmState::SetExtPanId(const uint8_t *aExtPanId)
+{
+    VerifyOrExit(!mSnapshot.mHasExtPanId || memcmp(mSnapshot.mExtPanId, aExtPanId, sizeof(mSnapshot.mExtPanId)) != 0);
+    memcpy(mSnapshot.mExtPanId, aExtPanId, sizeof(mSnapshot.mExtPanId));
+    mSnapshot.mHasExtPanId = true;
+    Commit();
+
+exit:
+    return;
+}
+
+void WarmState::SetPSKc(const uint8_t *aPSKc)
+{
+    VerifyOrExit(!mSnapshot.mHasPSKc || memcmp(mSnapshot.mPSKc, aPSKc, sizeof(mSnapshot.mPSKc)) != 0);
+    memcpy(mSnapshot.mPSKc, aPSKc, sizeof(mSnapshot.mPSKc));
+    mSnapshot.mHasPSKc = true;
+    Commit();
+
+exit:
+    return;
+}
+
+void WarmState::SetEui64(const uint8_t *aEui64)
+{
+    VerifyOrExit(!mSnapshot.mHasEui64 || memcmp(mSnapshot.mEui64, aEui64, sizeof(mSnapshot.mEui64)) != 0);
+    memcpy(mSnapshot.mEui64, aEui64, sizeof(mSnapshot.mEui64));
+    mSnapshot.mHasEui64 = true;
+    Commit();
+
+exit:
+    return;
+}
+
+void WarmState::SetThreadState(bool aStarted, uint8_t aRole)
+{
+    VerifyOrExit(mSnapshot.mThreadStarted != aStarted || mSnapshot.mThreadRole != aRole);
+    mSnapshot.mThreadStarted = aStarted;
+    mSnapshot.mThreadRole    = aRole;
+    Commit();
+
+exit:
+    return;
+}
+
+void WarmState::SetNameConflicts(uint8_t aNameConflicts)
+{
+    VerifyOrExit(mSnapshot.mNameConflicts != aNameConflicts);
+    mSnapshot.mNameConflicts = aNameConflicts;
+    Commit();
+
+exit:
+    return;
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,216 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the state of a border agent kept across restarts.
+ */
+
+#ifndef WARM_STATE_HPP_
+#define WARM_STATE_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class keeps the last known state of a Thread network in a memory-mapped file, so that a restarted agent
+ * publishes its commissioning service and accepts commissioners at once, before wpantund answers.
+ *
+ * Each change is written to the mapping, which the kernel keeps when the agent exits or crashes, without a system call.
+ * A change is framed by a sequence number odd while it is written, and checked by a checksum, so that a snapshot
+ * partially written is never restored. The file holds the PSKc of the network, it is only readable by its owner.
+ *
+ */
+class WarmState
+{
+public:
+    enum
+    {
+        kMaxInterfaceName = 64, ///< Max bytes of the interface name checked, longer names are compared truncated.
+    };
+
+    /**
+     * This structure represents the state of the network.
+     *
+     */
+    struct Snapshot
+    {
+        char    mNetworkName[kSizeNetworkName + 1]; ///< The network name, empty if unknown.
+        uint8_t mExtPanId[kSizeExtPanId];           ///< The extended PAN ID, valid if mHasExtPanId.
+        uint8_t mPSKc[kSizePSKc];                   ///< The PSKc, valid if mHasPSKc.
+        uint8_t mEui64[kSizeEui64];                 ///< The EUI-64 of the NCP, valid if mHasEui64.
+        uint8_t mHasExtPanId;                       ///< Whether the extended PAN ID is known.
+        uint8_t mHasPSKc;                           ///< Whether the PSKc is known.
+        uint8_t mHasEui64;                          ///< Whether the EUI-64 is known.
+        uint8_t mThreadStarted;                     ///< Whether the Thread interface was active.
+        uint8_t mThreadRole;                        ///< The Ncp::ThreadRole of the NCP.
+        uint8_t mNameConflicts;                     ///< Number of alternative names of the commissioning service.
+    };
+
+    /**
+     * The constructor initializes a state without file.
+     *
+     */
+    WarmState(void);
+
+    /**
+     * The destructor closes the file.
+     *
+     */
+    ~WarmState(void);
+
+    /**
+     * This method opens the file of the state, created if missing.
+     *
+     * A snapshot of another interface, or of another version of the agent, is dropped.
+     *
+     * @param[in]   aFilename   A pointer to the name of the file.
+     * @param[in]   aIfName     A pointer to the name of the interface of the network.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully opened.
+     * @retval  OTBR_ERROR_ERRNO    Failed to open or map the file, error code set in errno.
+     *
+     */
+    otbrError Open(const char *aFilename, const char *aIfName);
+
+    /**
+     * This method closes the file, the state is kept in it.
+     *
+     */
+    void Close(void);
+
+    /**
+     * This method returns whether the file is opened.
+     *
+     * @returns Whether the file is opened.
+     *
+     */
+    bool IsOpen(void) const { return mFile != NULL; }
+
+    /**
+     * This method returns the snapshot restored when the file was opened.
+     *
+     * @returns A pointer to the snapshot, NULL if none was restored.
+     *
+     */
+    const Snapshot *GetRestored(void) const { return mRestored ? &mRestoredSnapshot : NULL; }
+
+    /**
+     * This method stores the network name.
+     *
+     * @param[in]   aNetworkName    A pointer to the network name.
+     *
+     */
+    void SetNetworkName(const char *aNetworkName);
+
+    /**
+     * This method stores the extended PAN ID.
+     *
+     * @param[in]   aExtPanId   A pointer to the extended PAN ID, of kSizeExtPanId bytes.
+     *
+     */
+    void SetExtPanId(const uint8_t *aExtPanId);
+
+    /**
+     * This method stores the PSKc.
+     *
+     * @param[in]   aPSKc   A pointer to the PSKc, of kSizePSKc bytes.
+     *
+     */
+    void SetPSKc(const uint8_t *aPSKc);
+
+    /**
+     * This method stores the EUI-64 of the NCP.
+     *
+     * @param[in]   aEui64  A pointer to the EUI-64, of kSizeEui64 bytes.
+     *
+     */
+    void SetEui64(const uint8_t *aEui64);
+
+    /**
+     * This method stores the state of the Thread interface.
+     *
+     * @param[in]   aStarted    Whether the Thread interface is active.
+     * @param[in]   aRole       The Ncp::ThreadRole of the NCP.
+     *
+     */
+    void SetThreadState(bool aStarted, uint8_t aRole);
+
+    /**
+     * This method stores the number of alternative names the commissioning service went through.
+     *
+     * @param[in]   aNameConflicts  The number of name conflicts.
+     *
+     */
+    void SetNameConflicts(uint8_t aNameConflicts);
+
+private:
+    WarmState(const WarmState &);
+    WarmState &operator=(const WarmState &);
+
+    enum
+    {
+        kMagic   = 0x4f545753, ///< "OTWS".
+        kVersion = 2,          ///< Version of the layout of the file.
+    };
+
+    /**
+     * This structure represents the layout of the file.
+     *
+     */
+    struct File
+    {
+        uint32_t mMagic;
+        uint16_t mVersion;
+        uint16_t mSize;     ///< Size of the structure, checked along with the version.
+        uint32_t mSequence; ///< Odd while the snapshot is written.
+        uint32_t mChecksum; ///< FNV-1a of the interface name and the snapshot.
+        char     mIfName[kMaxInterfaceName];
+        Snapshot mSnapshot;
+    };
+
+    static uint32_t Checksum(const File &aFile);
+    void            Commit(void);
+
+    File *   mFile;
+    Snapshot mSnapshot; ///< The current state, written to the file by Commit().
+    Snapshot mRestoredSnapshot;
+    bool     mRestored;
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // WARM_STATE_HPP_
@@ -0,0 +1,392 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the HTTP endpoint serving the otbr-web API from the agent.
+ */
+
+#include "web_api_server.hpp"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+static Metrics::Counter sRequests("web_api.requests");
+static Metrics::Counter sRejected("web_api.connections_rejected");
+
+WebApiServer::WebApiServer(Reactor &aReactor)
+    : mReactor(aReactor)
+    , mFd(-1)
+    , mRouteCount(0)
+{
+    for (int i = 0; i < kMaxConnections; ++i)
+    {
+        mConnections[i].mServer = this;
+        mConnections[i].mFd     = -1;
+    }
+}
+
+WebApiServer::~WebApiServer(void)
+{
+    Stop();
+}
+
+otbrError WebApiServer::AddRoute(const char *aPath, RequestHandler aHandler, void *aContext)
+{
+    otbrError error = OTBR_ERROR_NONE;
+
+    VerifyOrExit(mRouteCount < kMaxRoutes, error = OTBR_ERROR_ERRNO, errno = ENOMEM);
+
+    mRoutes[mRouteCount].mPath    = aPath;
+    mRoutes[mRouteCount].mHandler = aHandler;
+    mRoutes[mRouteCount].mContext = aContext;
+    ++mRouteCount;
+
+exit:
+    return error;
+}
+
+otbrError WebApiServer::Start(uint16_t aPort)
+{
+    otbrError   error = OTBR_ERROR_ERRNO;
+    int         one   = 1;
+    sockaddr_in sin;
+
+    VerifyOrExit((mFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) >= 0);
+    VerifyOrExit(setsockopt(mFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0);
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family      = AF_INET;
+    sin.sin_port        = htons(aPort);
+    sin.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    VerifyOrExit(bind(mFd, reinterpret_cast<sockaddr *>(&sin), sizeof(sin)) == 0);
+    VerifyOrExit(listen(mFd, kMaxConnections) == 0);
+    SuccessOrExit(mReactor.Add(mWatch, mFd, Reactor::kEventReadable, HandleAccept, this, "web-api"));
+
+    otbrLog(OTBR_LOG_INFO, "Web API served on port %u", aPort);
+    error = OTBR_ERROR_NONE;
+
+exit:
+    if (error != OTBR_ERROR_NONE && mFd >= 0)
+    {
+        close(mFd);
+        mFd = -1;
+    }
+
+    return error;
+}
+
+void WebApiServer::Stop(void)
+{
+    for (int i = 0; i < kMaxConnections; ++i)
+    {
+        if (mConnections[i].mFd >= 0)
+        {
+            Close(mConnections[i]);
+        }
+    }
+
+    VerifyOrExit(mFd >= 0);
+
+    mReactor.Remove(mWatch);
+    close(mFd);
+    mFd = -1;
+
+exit:
+    return;
+}
+
+void WebApiServer::AppendString(std::string &aOutput, const char *aString)
+{
+    aOutput += '"';
+
+    for (const char *c = aString; *c != '\0'; ++c)
+    {
+        unsigned char ch = static_cast<unsigned char>(*c);
+
+        if (ch == '"' || ch == '\\')
+        {
+            aOutput += '\\';
+            aOutput += *c;
+        }
+        else if (ch < 0x20)
+        {
+            char escaped[8];
+
+            snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+            aOutput += escaped;
+        }
+        else
+        {
+            aOutput += *c;
+        }
+    }
+
+    aOutput += '"';
+}
+
+bool WebApiServer::GetParameter(const char *aQuery, const char *aName, std::string &aValue)
+{
+    size_t      length = strlen(aName);
+    const char *param  = aQuery;
+
+    while (*param != '\0')
+    {
+        const char *end = strchr(param, '&');
+
+        if (end == NULL)
+        {
+            end = param + strlen(param);
+        }
+
+        if (strncmp(param, aName, length) == 0 && param[length] == '=')
+        {
+            aValue.assign(param + length + 1, end);
+            return true;
+        }
+
+        param = (*end == '&' ? end + 1 : end);
+    }
+
+    return false;
+}
+
+void WebApiServer::HandleAccept(void *aContext, int aFd, unsigned int aEvents)
+{
+    (void)aFd;
+    (void)aEvents;
+
+    static_cast<WebApiServer *>(aContext)->HandleAccept();
+}
+
+void WebApiServer::HandleAccept(void)
+{
+    uint64_t    now        = GetMonotonicNow();
+    Connection *connection = NULL;
+    int         fd;
+
+    VerifyOrExit((fd = accept4(mFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0);
+
+    // Connections left unanswered are evicted to make room, so that idle clients cannot lock the endpoint.
+    for (int i = 0; i < kMaxConnections && connection == NULL; ++i)
+    {
+        if (mConnections[i].mFd < 0)
+        {
+            connection = &mConnections[i];
+        }
+        else if (now - mConnections[i].mAcceptTime >= kIdleTimeout)
+        {
+            Close(mConnections[i]);
+            connection = &mConnections[i];
+        }
+    }
+
+    VerifyOrExit(connection != NULL, close(fd), sRejected.Add());
+
+    if (mReactor.Add(connection->mWatch, fd, Reactor::kEventReadable, HandleConnection, connection, "web-api") !=
+        OTBR_ERROR_NONE)
+    {
+        close(fd);
+        ExitNow();
+    }
+
+    connection->mFd            = fd;
+    connection->mAcceptTime    = now;
+    connection->mRequestLength = 0;
+    connection->mSent          = 0;
+    connection->mResponse.clear();
+
+exit:
+    return;
+}
+
+void WebApiServer::HandleConnection(void *aContext, int aFd, unsigned int aEvents)
+{
+    Connection &connection = *static_cast<Connection *>(aContext);
+
+    (void)aFd;
+
+    connection.mServer->HandleConnection(connection, aEvents);
+}
+
+void WebApiServer::HandleConnection(Connection &aConnection, unsigned int aEvents)
+{
+    ssize_t rval;
+
+    VerifyOrExit(!(aEvents & Reactor::kEventError), Close(aConnection));
+
+    if (!aConnection.mResponse.empty())
+    {
+        if (Send(aConnection))
+        {
+            Close(aConnection);
+        }
+
+        ExitNow();
+    }
+
+    // Leave room for the terminating null character.
+    rval = recv(aConnection.mFd, aConnection.mRequest + aConnection.mRequestLength,
+                sizeof(aConnection.mRequest) - aConnection.mRequestLength - 1, 0);
+
+    if (rval < 0 && (errno == EAGAIN || errno == EINTR))
+    {
+        ExitNow();
+    }
+
+    VerifyOrExit(rval > 0, Close(aConnection));
+
+    aConnection.mRequestLength += static_cast<size_t>(rval);
+    aConnection.mRequest[aConnection.mRequestLength] = '\0';
+
+    if (strstr(aConnection.mRequest, "\r\n\r\n") != NULL || strstr(aConnection.mRequest, "\n\n") != NULL)
+    {
+        HandleRequest(aConnection);
+    }
+    else if (aConnection.mRequestLength + 1 == sizeof(aConnection.mRequest))
+    {
+        otbrLog(OTBR_LOG_WARNING, "Web API request too large");
+        Close(aConnection);
+    }
+
+exit:
+    return;
+}
+
+void WebApiServer::HandleRequest(Connection &aConnection)
+{
+    static const char kMethod[] = "GET ";
+    const char *      status    = "404 Not Found";
+    const char *      type      = "text/plain";
+    std::string       body      = "Not Found\n";
+    char *            target    = aConnection.mRequest + sizeof(kMethod) - 1;
+    char *            query;
+    char              header[160];
+
+    sRequests.Add();
+
+    if (strncmp(aConnection.mRequest, kMethod, sizeof(kMethod) - 1) != 0)
+    {
+        status = "405 Method Not Allowed";
+        body   = "Method Not Allowed\n";
+        ExitNow();
+    }
+
+    // The request is not used after the route is found, the target and query are split in place.
+    target[strcspn(target, " \r\n")] = '\0';
+
+    if ((query = strchr(target, '?')) != NULL)
+    {
+        *query++ = '\0';
+    }
+    else
+    {
+        query = target + strlen(target);
+    }
+
+    for (unsigned int i = 0; i < mRouteCount; ++i)
+    {
+        const Route &route = mRoutes[i];
+
+        if (strcmp(target, route.mPath) == 0)
+        {
+            body.clear();
+            type   = "application/json";
+            status = (route.mHandler(route.mContext, query, body) == OTBR_ERROR_NONE ? "200 OK"
+                                                                                      : "500 Internal Server Error");
+            break;
+        }
+    }
+
+exit:
+    snprintf(header, sizeof(header),
+             "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %lu\r\nConnection: close\r\n\r\n", status, type,
+             static_cast<unsigned long>(body.size()));
+
+    aConnection.mResponse = header;
+    aConnection.mResponse += body;
+
+    if (Send(aConnection))
+    {
+        Close(aConnection);
+    }
+    else
+    {
+        mReactor.Modify(aConnection.mWatch, Reactor::kEventWritable);
+    }
+}
+
+bool WebApiServer::Send(Connection &aConnection)
+{
+    bool done = false;
+
+    while (aConnection.mSent < aConnection.mResponse.size())
+    {
+        ssize_t rval = send(aConnection.mFd, aConnection.mResponse.data() + aConnection.mSent,
+                            aConnection.mResponse.size() - aConnection.mSent, MSG_NOSIGNAL);
+
+        if (rval < 0)
+        {
+            VerifyOrExit(errno == EAGAIN || errno == EINTR, done = true);
+            ExitNow();
+        }
+
+        aConnection.mSent += static_cast<size_t>(rval);
+    }
+
+    done = true;
+
+exit:
+    return done;
+}
+
+void WebApiServer::Close(Connection &aConnection)
+{
+    mReactor.Remove(aConnection.mWatch);
+    close(aConnection.mFd);
+    aConnection.mFd = -1;
+    aConnection.mResponse.clear();
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
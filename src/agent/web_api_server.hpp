@@ -0,0 +1,182 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the HTTP endpoint serving the otbr-web API from the agent.
+ */
+
+#ifndef WEB_API_SERVER_HPP_
+#define WEB_API_SERVER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "common/reactor.hpp"
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class implements a minimal HTTP server answering `GET` requests of the otbr-web API with JSON documents, so
+ * that the API can be served by the agent instead of a separate otbr-web process.
+ *
+ * Each path is answered by a route added by AddRoute(). The server listens on all interfaces, and serves a few
+ * connections at a time from the reactor. Each connection is closed once its single request is answered.
+ *
+ */
+class WebApiServer
+{
+public:
+    /**
+     * This function pointer is called to answer a request.
+     *
+     * @param[in]   aContext    A pointer to application-specific context.
+     * @param[in]   aQuery      A pointer to the null-terminated query of the request, without '?', empty if none.
+     * @param[out]  aOutput     A reference to the string to append the JSON document of the response to.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully answered.
+     * @retval  OTBR_ERROR_ERRNO    Failed to answer, the output is sent with status 500.
+     *
+     */
+    typedef otbrError (*RequestHandler)(void *aContext, const char *aQuery, std::string &aOutput);
+
+    /**
+     * The constructor to initialize the web API server.
+     *
+     * @param[in]   aReactor    A reference to the reactor to register sockets with.
+     *
+     */
+    explicit WebApiServer(Reactor &aReactor);
+
+    ~WebApiServer(void);
+
+    /**
+     * This method adds a route.
+     *
+     * @param[in]   aPath       A pointer to the null-terminated path, e.g. "/get_properties", which must stay valid.
+     * @param[in]   aHandler    A pointer to the function answering requests of the path.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully added the route.
+     * @retval  OTBR_ERROR_ERRNO    Too many routes, errno is set to ENOMEM.
+     *
+     */
+    otbrError AddRoute(const char *aPath, RequestHandler aHandler, void *aContext);
+
+    /**
+     * This method starts listening.
+     *
+     * @param[in]   aPort   The TCP port to listen on all interfaces.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully started.
+     * @retval  OTBR_ERROR_ERRNO    Failed to start, error code set in errno.
+     *
+     */
+    otbrError Start(uint16_t aPort);
+
+    /**
+     * This method closes the listening socket and all connections.
+     *
+     */
+    void Stop(void);
+
+    /**
+     * This function appends a string to a JSON document, quoted and escaped.
+     *
+     * @param[out]  aOutput     A reference to the JSON document.
+     * @param[in]   aString     A pointer to the null-terminated string.
+     *
+     */
+    static void AppendString(std::string &aOutput, const char *aString);
+
+    /**
+     * This function gets the value of a parameter of a query.
+     *
+     * @param[in]   aQuery      A pointer to the null-terminated query, as passed to RequestHandler.
+     * @param[in]   aName       A pointer to the null-terminated name of the parameter.
+     * @param[out]  aValue      A reference to the string to receive the value, which is not percent-decoded.
+     *
+     * @returns Whether the query has the parameter.
+     *
+     */
+    static bool GetParameter(const char *aQuery, const char *aName, std::string &aValue);
+
+private:
+    enum
+    {
+        kMaxConnections = 8,    ///< Max number of connections served at a time.
+        kMaxRoutes      = 8,    ///< Max number of routes added.
+        kMaxRequestSize = 1024, ///< Max size of the request head.
+        kIdleTimeout    = 5000, ///< Milliseconds a connection may stay unanswered before it is evicted.
+    };
+
+    struct Route
+    {
+        const char *   mPath;
+        RequestHandler mHandler;
+        void *         mContext;
+    };
+
+    struct Connection
+    {
+        WebApiServer * mServer;
+        Reactor::Watch mWatch;
+        int            mFd;
+        uint64_t       mAcceptTime;
+        char           mRequest[kMaxRequestSize];
+        size_t         mRequestLength;
+        std::string    mResponse;
+        size_t         mSent;
+    };
+
+    static void HandleAccept(void *aContext, int aFd, unsigned int aEvents);
+    void        HandleAccept(void);
+    static void HandleConnection(void *aContext, int aFd, unsigned int aEvents);
+    void        HandleConnection(Connection &aConnection, unsigned int aEvents);
+    void        HandleRequest(Connection &aConnection);
+    bool        Send(Connection &aConnection);
+    void        Close(Connection &aConnection);
+
+    Reactor &      mReactor;
+    Reactor::Watch mWatch;
+    int            mFd;
+    Route          mRoutes[kMaxRoutes];
+    unsigned int   mRouteCount;
+    Connection     mConnections[kMaxConnections];
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // WEB_API_SERVER_HPP_
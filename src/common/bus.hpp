@@ -0,0 +1,269 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the D-Bus transport shared by the agent and the web service.
+ */
+
+#ifndef BUS_HPP_
+#define BUS_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Bus {
+
+/**
+ * D-Bus types, as coded in signatures by every D-Bus implementation.
+ *
+ */
+enum
+{
+    kTypeInvalid   = 0,   ///< Past the last value.
+    kTypeByte      = 'y', ///< uint8_t
+    kTypeBoolean   = 'b', ///< Read and written as an int.
+    kTypeInt16     = 'n', ///< int16_t
+    kTypeUint16    = 'q', ///< uint16_t
+    kTypeInt32     = 'i', ///< int32_t
+    kTypeUint32    = 'u', ///< uint32_t
+    kTypeInt64     = 'x', ///< int64_t
+    kTypeUint64    = 't', ///< uint64_t
+    kTypeString    = 's', ///< Read and written as a const char *.
+    kTypeArray     = 'a', ///< Written as the bytes of a byte array.
+    kTypeVariant   = 'v', ///< A container of a single value of any type.
+    kTypeStruct    = 'r', ///< A container of values.
+    kTypeDictEntry = 'e', ///< A container of a key and its value, in an array.
+};
+
+/**
+ * This class reads the arguments of a message in order.
+ *
+ * Values are read without being copied, strings and byte arrays point into the message, and remain valid until the
+ * message is released.
+ *
+ */
+class Reader
+{
+public:
+    /**
+     * This method returns the type of the value to read.
+     *
+     * @returns The type of the value, kTypeInvalid past the last value of the message or container.
+     *
+     */
+    virtual int GetType(void) = 0;
+
+    /**
+     * This method returns the type of the elements of the array to read.
+     *
+     * @returns The type of the elements, kTypeInvalid if the value to read is not an array.
+     *
+     */
+    virtual int GetElementType(void) = 0;
+
+    /**
+     * This method reads a basic value and moves past it.
+     *
+     * @param[in]   aType       The type of the value.
+     * @param[out]  aValue      A pointer to receive the value, of the size of @p aType.
+     *
+     * @returns Whether the value was of @p aType and read.
+     *
+     */
+    virtual bool ReadBasic(int aType, void *aValue) = 0;
+
+    /**
+     * This method reads a byte array and moves past it.
+     *
+     * @param[out]  aBytes      A reference to receive the pointer to the bytes in the message.
+     * @param[out]  aLength     A reference to receive the number of bytes.
+     *
+     * @returns Whether the value was a byte array and read.
+     *
+     */
+    virtual bool ReadBytes(const uint8_t *&aBytes, size_t &aLength) = 0;
+
+    /**
+     * This method enters the container to read, so that its values are read next.
+     *
+     * @returns Whether the value was a container and entered.
+     *
+     */
+    virtual bool Enter(void) = 0;
+
+    /**
+     * This method leaves the container entered last and moves past it, its values left are skipped.
+     *
+     * @returns Whether a container was left.
+     *
+     */
+    virtual bool Leave(void) = 0;
+
+    /**
+     * This method moves past the value to read, containers included.
+     *
+     * @returns Whether there was a value to skip.
+     *
+     */
+    virtual bool Skip(void) = 0;
+
+protected:
+    virtual ~Reader(void) {}
+};
+
+/**
+ * This structure represents the method called.
+ *
+ */
+struct Method
+{
+    const char *mDestination; ///< The bus name of the service.
+    const char *mPath;        ///< The object path.
+    const char *mInterface;   ///< The interface of the method.
+    const char *mMember;      ///< The name of the method.
+};
+
+/**
+ * This structure represents an argument of a method call.
+ *
+ */
+struct Argument
+{
+    int         mType;   ///< The type of the argument, kTypeArray for a byte array.
+    const void *mValue;  ///< A pointer to the value, the string itself or the bytes of a byte array.
+    size_t      mLength; ///< The number of bytes of a byte array.
+};
+
+/**
+ * This class implements the connection to the system bus.
+ *
+ * Calls are pipelined, several may be sent before the replies are waited for, and the reply of a call is read until
+ * the call is released.
+ *
+ */
+class Connection
+{
+public:
+    enum
+    {
+        kMaxCalls = 128, ///< Max number of calls waiting for their replies or released.
+    };
+
+    /**
+     * This method sends a method call.
+     *
+     * @param[in]   aMethod     A reference to the method.
+     * @param[in]   aArguments  A pointer to the arguments.
+     * @param[in]   aCount      The number of arguments.
+     * @param[in]   aTimeout    The time in milliseconds to wait for the reply.
+     * @param[out]  aCall       A reference to receive the call, to wait for and release.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully sent the call.
+     * @retval  OTBR_ERROR_ERRNO    Too many calls in flight, or failed to create the message.
+     * @retval  OTBR_ERROR_DBUS     Failed to send the call.
+     *
+     */
+    virtual otbrError Send(const Method &  aMethod,
+                           const Argument *aArguments,
+                           size_t          aCount,
+                           int             aTimeout,
+                           unsigned int &  aCall) = 0;
+
+    /**
+     * This method waits for the reply of a call.
+     *
+     * @param[in]   aCall       The call sent.
+     *
+     * @returns A pointer to the reader of the reply, valid until the call is released, NULL if the call failed.
+     *
+     */
+    virtual Reader *Wait(unsigned int aCall) = 0;
+
+    /**
+     * This method releases a call, and its reply.
+     *
+     * @param[in]   aCall       The call sent.
+     *
+     */
+    virtual void Release(unsigned int aCall) = 0;
+
+    /**
+     * This method returns whether the connection is still up.
+     *
+     * @returns Whether the connection is up.
+     *
+     */
+    virtual bool IsConnected(void) const = 0;
+
+    /**
+     * This method sends a method call and waits for its reply.
+     *
+     * @param[in]   aMethod     A reference to the method.
+     * @param[in]   aArguments  A pointer to the arguments.
+     * @param[in]   aCount      The number of arguments.
+     * @param[in]   aTimeout    The time in milliseconds to wait for the reply.
+     * @param[out]  aCall       A reference to receive the call, to release once the reply is read.
+     *
+     * @returns A pointer to the reader of the reply, NULL if the call failed, in which case it is already released.
+     *
+     */
+    Reader *Call(const Method &aMethod, const Argument *aArguments, size_t aCount, int aTimeout, unsigned int &aCall);
+
+    /**
+     * This method connects to the system bus, with the D-Bus implementation configured.
+     *
+     * @returns A pointer to the connection, NULL on failure.
+     *
+     */
+    static Connection *Create(void);
+
+    /**
+     * This method closes a connection.
+     *
+     * @param[in]   aConnection     A pointer to the connection to be destroyed.
+     *
+     */
+    static void Destroy(Connection *aConnection);
+
+    virtual ~Connection(void) {}
+};
+
+} // namespace Bus
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // BUS_HPP_
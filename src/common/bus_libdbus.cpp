@@ -0,0 +1,375 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the D-Bus transport on the reference libdbus.
+ */
+
+#include "common/bus_libdbus.hpp"
+
+#include <errno.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Bus {
+
+int LibdbusReader::GetType(void)
+{
+    return dbus_message_iter_get_arg_type(&mIters[mDepth]);
+}
+
+int LibdbusReader::GetElementType(void)
+{
+    return GetType() == DBUS_TYPE_ARRAY ? dbus_message_iter_get_element_type(&mIters[mDepth]) : kTypeInvalid;
+}
+
+bool LibdbusReader::ReadBasic(int aType, void *aValue)
+{
+    bool read = false;
+
+    VerifyOrExit(GetType() == aType && dbus_type_is_basic(aType));
+    dbus_message_iter_get_basic(&mIters[mDepth], aValue);
+    dbus_message_iter_next(&mIters[mDepth]);
+    read = true;
+
+exit:
+    return read;
+}
+
+bool LibdbusReader::ReadBytes(const uint8_t *&aBytes, size_t &aLength)
+{
+    bool            read  = false;
+    int             count = 0;
+    DBusMessageIter bytesIter;
+
+    VerifyOrExit(GetElementType() == DBUS_TYPE_BYTE);
+    dbus_message_iter_recurse(&mIters[mDepth], &bytesIter);
+    dbus_message_iter_get_fixed_array(&bytesIter, &aBytes, &count);
+    dbus_message_iter_next(&mIters[mDepth]);
+    aLength = static_cast<size_t>(count);
+    read    = true;
+
+exit:
+    return read;
+}
+
+bool LibdbusReader::Enter(void)
+{
+    bool entered = false;
+
+    VerifyOrExit(dbus_type_is_container(GetType()) && mDepth + 1 < kMaxDepth);
+    dbus_message_iter_recurse(&mIters[mDepth], &mIters[mDepth + 1]);
+    ++mDepth;
+    entered = true;
+
+exit:
+    return entered;
+}
+
+bool LibdbusReader::Leave(void)
+{
+    bool left = false;
+
+    VerifyOrExit(mDepth > 0);
+    --mDepth;
+    dbus_message_iter_next(&mIters[mDepth]);
+    left = true;
+
+exit:
+    return left;
+}
+
+bool LibdbusReader::Skip(void)
+{
+    bool skipped = false;
+
+    VerifyOrExit(GetType() != DBUS_TYPE_INVALID);
+    dbus_message_iter_next(&mIters[mDepth]);
+    skipped = true;
+
+exit:
+    return skipped;
+}
+
+LibdbusConnection::LibdbusConnection(void)
+    : mConnection(NULL)
+    , mTemplate(NULL)
+{
+    for (size_t i = 0; i < kMaxCalls; ++i)
+    {
+        mCalls[i].mPending = NULL;
+        mCalls[i].mReply   = NULL;
+        mCalls[i].mUsed    = false;
+    }
+}
+
+LibdbusConnection::~LibdbusConnection(void)
+{
+    for (unsigned int i = 0; i < kMaxCalls; ++i)
+    {
+        if (mCalls[i].mUsed)
+        {
+            if (mCalls[i].mPending != NULL)
+            {
+                dbus_pending_call_cancel(mCalls[i].mPending);
+            }
+
+            Release(i);
+        }
+    }
+
+    if (mTemplate != NULL)
+    {
+        dbus_message_unref(mTemplate);
+    }
+
+    if (mConnection != NULL)
+    {
+        dbus_connection_close(mConnection);
+        dbus_connection_unref(mConnection);
+    }
+}
+
+otbrError LibdbusConnection::Init(void)
+{
+    otbrError error = OTBR_ERROR_NONE;
+    DBusError dbusError;
+
+    dbus_error_init(&dbusError);
+    mConnection = dbus_bus_get_private(DBUS_BUS_SYSTEM, &dbusError);
+    VerifyOrExit(mConnection != NULL, error = OTBR_ERROR_DBUS);
+    dbus_connection_set_exit_on_disconnect(mConnection, false);
+
+exit:
+    if (dbus_error_is_set(&dbusError))
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to connect to the bus: %s", dbusError.message);
+        dbus_error_free(&dbusError);
+    }
+
+    return error;
+}
+
+static bool IsSameString(const char *aString, const char *aOther)
+{
+    return aString != NULL && aOther != NULL && !strcmp(aString, aOther);
+}
+
+DBusMessage *LibdbusConnection::NewMessage(const Method &aMethod)
+{
+    DBusMessage *message = NULL;
+
+    if (mTemplate == NULL || !IsSameString(dbus_message_get_member(mTemplate), aMethod.mMember) ||
+        !IsSameString(dbus_message_get_interface(mTemplate), aMethod.mInterface) ||
+        !IsSameString(dbus_message_get_path(mTemplate), aMethod.mPath) ||
+        !IsSameString(dbus_message_get_destination(mTemplate), aMethod.mDestination))
+    {
+        if (mTemplate != NULL)
+        {
+            dbus_message_unref(mTemplate);
+        }
+
+        mTemplate = dbus_message_new_method_call(aMethod.mDestination, aMethod.mPath, aMethod.mInterface,
+                                                 aMethod.mMember);
+        VerifyOrExit(mTemplate != NULL, errno = ENOMEM);
+    }
+
+    VerifyOrExit((message = dbus_message_copy(mTemplate)) != NULL, errno = ENOMEM);
+
+exit:
+    return message;
+}
+
+otbrError LibdbusConnection::Send(const Method &  aMethod,
+                                  const Argument *aArguments,
+                                  size_t          aCount,
+                                  int             aTimeout,
+                                  unsigned int &  aCall)
+{
+    otbrError       error   = OTBR_ERROR_ERRNO;
+    DBusMessage *   message = NULL;
+    unsigned int    call    = 0;
+    DBusMessageIter iter;
+
+    VerifyOrExit(mConnection != NULL, error = OTBR_ERROR_DBUS);
+
+    while (call < kMaxCalls && mCalls[call].mUsed)
+    {
+        ++call;
+    }
+
+    VerifyOrExit(call < kMaxCalls, errno = EBUSY);
+    VerifyOrExit((message = NewMessage(aMethod)) != NULL);
+    dbus_message_iter_init_append(message, &iter);
+
+    for (size_t i = 0; i < aCount; ++i)
+    {
+        const Argument &argument = aArguments[i];
+
+        if (argument.mType == kTypeArray)
+        {
+            DBusMessageIter bytesIter;
+            const uint8_t * bytes = static_cast<const uint8_t *>(argument.mValue);
+
+            VerifyOrExit(dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE_AS_STRING,
+                                                          &bytesIter),
+                         errno = ENOMEM);
+
+            if (!dbus_message_iter_append_fixed_array(&bytesIter, DBUS_TYPE_BYTE, &bytes,
+                                                      static_cast<int>(argument.mLength)))
+            {
+                dbus_message_iter_abandon_container(&iter, &bytesIter);
+                ExitNow(errno = ENOMEM);
+            }
+
+            VerifyOrExit(dbus_message_iter_close_container(&iter, &bytesIter), errno = ENOMEM);
+        }
+        else if (argument.mType == kTypeString)
+        {
+            const char *string = static_cast<const char *>(argument.mValue);
+
+            VerifyOrExit(dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &string), errno = ENOMEM);
+        }
+        else
+        {
+            VerifyOrExit(dbus_message_iter_append_basic(&iter, argument.mType, argument.mValue), errno = ENOMEM);
+        }
+    }
+
+    VerifyOrExit(dbus_connection_send_with_reply(mConnection, message, &mCalls[call].mPending, aTimeout) &&
+                     mCalls[call].mPending != NULL,
+                 error = OTBR_ERROR_DBUS);
+
+    mCalls[call].mUsed = true;
+    aCall              = call;
+    error              = OTBR_ERROR_NONE;
+
+exit:
+    if (message != NULL)
+    {
+        dbus_message_unref(message);
+    }
+
+    return error;
+}
+
+Reader *LibdbusConnection::Wait(unsigned int aCall)
+{
+    Reader *     reader = NULL;
+    PendingCall &call   = mCalls[aCall < kMaxCalls ? aCall : 0];
+    DBusError    error;
+
+    dbus_error_init(&error);
+    VerifyOrExit(aCall < kMaxCalls && call.mUsed);
+
+    if (call.mPending != NULL)
+    {
+        // Calls sent since the last wait are written out together.
+        dbus_connection_flush(mConnection);
+        dbus_pending_call_block(call.mPending);
+        call.mReply = dbus_pending_call_steal_reply(call.mPending);
+        dbus_pending_call_unref(call.mPending);
+        call.mPending = NULL;
+    }
+
+    VerifyOrExit(call.mReply != NULL);
+
+    if (dbus_set_error_from_message(&error, call.mReply))
+    {
+        otbrLog(OTBR_LOG_WARNING, "Bus call failed: %s: %s", error.name, error.message);
+        dbus_error_free(&error);
+        ExitNow();
+    }
+
+    call.mReader.Init(*call.mReply);
+    reader = &call.mReader;
+
+exit:
+    return reader;
+}
+
+void LibdbusConnection::Release(unsigned int aCall)
+{
+    PendingCall &call = mCalls[aCall < kMaxCalls ? aCall : 0];
+
+    VerifyOrExit(aCall < kMaxCalls);
+
+    if (call.mPending != NULL)
+    {
+        dbus_pending_call_unref(call.mPending);
+        call.mPending = NULL;
+    }
+
+    if (call.mReply != NULL)
+    {
+        dbus_message_unref(call.mReply);
+        call.mReply = NULL;
+    }
+
+    call.mUsed = false;
+
+exit:
+    return;
+}
+
+bool LibdbusConnection::IsConnected(void) const
+{
+    return mConnection != NULL && dbus_connection_get_is_connected(mConnection);
+}
+
+#if !OTBR_ENABLE_SDBUS
+Connection *Connection::Create(void)
+{
+    LibdbusConnection *connection = new LibdbusConnection();
+
+    if (connection->Init() != OTBR_ERROR_NONE)
+    {
+        delete connection;
+        connection = NULL;
+    }
+
+    return connection;
+}
+
+void Connection::Destroy(Connection *aConnection)
+{
+    delete static_cast<LibdbusConnection *>(aConnection);
+}
+#endif // !OTBR_ENABLE_SDBUS
+
+} // namespace Bus
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,168 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the D-Bus transport on the reference libdbus.
+ */
+
+#ifndef BUS_LIBDBUS_HPP_
+#define BUS_LIBDBUS_HPP_
+
+#include <string.h>
+
+#include <dbus/dbus.h>
+
+#include "common/bus.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Bus {
+
+/**
+ * This class implements the reader of a libdbus message.
+ *
+ */
+class LibdbusReader : public Reader
+{
+public:
+    /**
+     * This constructor initializes the reader, with no value to read.
+     *
+     */
+    LibdbusReader(void)
+        : mDepth(0)
+    {
+        memset(&mIters[0], 0, sizeof(mIters[0]));
+    }
+
+    /**
+     * This constructor initializes the reader at an iterator, so that reading moves a copy of it.
+     *
+     * @param[in]   aIter   A reference to the iterator at the first value to read.
+     *
+     */
+    explicit LibdbusReader(const DBusMessageIter &aIter)
+        : mDepth(0)
+    {
+        mIters[0] = aIter;
+    }
+
+    /**
+     * This method starts reading the arguments of a message.
+     *
+     * @param[in]   aMessage    A reference to the message.
+     *
+     * @returns Whether the message has any arguments.
+     *
+     */
+    bool Init(DBusMessage &aMessage)
+    {
+        mDepth = 0;
+        return dbus_message_iter_init(&aMessage, &mIters[0]);
+    }
+
+    virtual int  GetType(void);
+    virtual int  GetElementType(void);
+    virtual bool ReadBasic(int aType, void *aValue);
+    virtual bool ReadBytes(const uint8_t *&aBytes, size_t &aLength);
+    virtual bool Enter(void);
+    virtual bool Leave(void);
+    virtual bool Skip(void);
+
+private:
+    enum
+    {
+        kMaxDepth = 8, ///< Max number of containers entered at once.
+    };
+
+    DBusMessageIter mIters[kMaxDepth];
+    unsigned int    mDepth;
+};
+
+/**
+ * This class implements the connection to the system bus on libdbus.
+ *
+ * The message of the last method called is kept, and copied for the next calls of the same method, so that its
+ * header is not validated and built again.
+ *
+ */
+class LibdbusConnection : public Connection
+{
+public:
+    /**
+     * This constructor initializes the connection, not connected yet.
+     *
+     */
+    LibdbusConnection(void);
+
+    virtual ~LibdbusConnection(void);
+
+    /**
+     * This method connects to the system bus.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully connected.
+     * @retval  OTBR_ERROR_DBUS     Failed to connect.
+     *
+     */
+    otbrError Init(void);
+
+    virtual otbrError Send(const Method &  aMethod,
+                           const Argument *aArguments,
+                           size_t          aCount,
+                           int             aTimeout,
+                           unsigned int &  aCall);
+    virtual Reader *  Wait(unsigned int aCall);
+    virtual void      Release(unsigned int aCall);
+    virtual bool      IsConnected(void) const;
+
+private:
+    struct PendingCall
+    {
+        DBusPendingCall *mPending;
+        DBusMessage *    mReply;
+        LibdbusReader    mReader;
+        bool             mUsed;
+    };
+
+    DBusMessage *NewMessage(const Method &aMethod);
+
+    DBusConnection *mConnection;
+    DBusMessage *   mTemplate; ///< The message of the last method called, without arguments.
+    PendingCall     mCalls[kMaxCalls];
+};
+
+} // namespace Bus
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // BUS_LIBDBUS_HPP_
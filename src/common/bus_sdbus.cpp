@@ -0,0 +1,304 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the D-Bus transport on sd-bus of systemd.
+ */
+
+#include "common/bus_sdbus.hpp"
+
+#if OTBR_ENABLE_SDBUS
+
+#include <errno.h>
+#include <string.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Bus {
+
+int SdbusReader::GetType(void)
+{
+    char        type     = 0;
+    const char *contents = NULL;
+
+    if (sd_bus_message_peek_type(mMessage, &type, &contents) <= 0)
+    {
+        type = kTypeInvalid;
+    }
+
+    return type;
+}
+
+int SdbusReader::GetElementType(void)
+{
+    char        type     = 0;
+    const char *contents = NULL;
+    int         element  = kTypeInvalid;
+
+    if (sd_bus_message_peek_type(mMessage, &type, &contents) > 0 && type == kTypeArray && contents != NULL)
+    {
+        element = contents[0];
+    }
+
+    return element;
+}
+
+bool SdbusReader::ReadBasic(int aType, void *aValue)
+{
+    return sd_bus_message_read_basic(mMessage, static_cast<char>(aType), aValue) > 0;
+}
+
+bool SdbusReader::ReadBytes(const uint8_t *&aBytes, size_t &aLength)
+{
+    const void *bytes = NULL;
+    bool        read  = false;
+
+    // The bytes are read in place, without being copied out of the message.
+    VerifyOrExit(sd_bus_message_read_array(mMessage, kTypeByte, &bytes, &aLength) > 0);
+    aBytes = static_cast<const uint8_t *>(bytes);
+    read   = true;
+
+exit:
+    return read;
+}
+
+bool SdbusReader::Enter(void)
+{
+    char        type     = 0;
+    const char *contents = NULL;
+
+    return sd_bus_message_peek_type(mMessage, &type, &contents) > 0 &&
+           sd_bus_message_enter_container(mMessage, type, contents) > 0;
+}
+
+bool SdbusReader::Leave(void)
+{
+    // Containers other than arrays are only left once fully read.
+    while (sd_bus_message_skip(mMessage, NULL) > 0)
+    {
+    }
+
+    return sd_bus_message_exit_container(mMessage) >= 0;
+}
+
+bool SdbusReader::Skip(void)
+{
+    return sd_bus_message_skip(mMessage, NULL) > 0;
+}
+
+SdbusConnection::SdbusConnection(void)
+    : mBus(NULL)
+{
+    for (size_t i = 0; i < kMaxCalls; ++i)
+    {
+        mCalls[i].mSlot  = NULL;
+        mCalls[i].mReply = NULL;
+        mCalls[i].mUsed  = false;
+    }
+}
+
+SdbusConnection::~SdbusConnection(void)
+{
+    for (unsigned int i = 0; i < kMaxCalls; ++i)
+    {
+        if (mCalls[i].mUsed)
+        {
+            Release(i);
+        }
+    }
+
+    if (mBus != NULL)
+    {
+        sd_bus_flush_close_unref(mBus);
+    }
+}
+
+otbrError SdbusConnection::Init(void)
+{
+    otbrError error = OTBR_ERROR_NONE;
+    int       rval  = sd_bus_open_system(&mBus);
+
+    VerifyOrExit(rval >= 0, error = OTBR_ERROR_DBUS,
+                 otbrLog(OTBR_LOG_ERR, "Failed to connect to the bus: %s", strerror(-rval)));
+
+exit:
+    return error;
+}
+
+int SdbusConnection::HandleReply(sd_bus_message *aReply, void *aContext, sd_bus_error *aError)
+{
+    PendingCall &call = *static_cast<PendingCall *>(aContext);
+
+    (void)aError;
+    call.mReply = sd_bus_message_ref(aReply);
+
+    return 0;
+}
+
+otbrError SdbusConnection::Send(const Method &  aMethod,
+                                const Argument *aArguments,
+                                size_t          aCount,
+                                int             aTimeout,
+                                unsigned int &  aCall)
+{
+    otbrError       error   = OTBR_ERROR_ERRNO;
+    sd_bus_message *message = NULL;
+    unsigned int    call    = 0;
+    int             rval;
+
+    VerifyOrExit(mBus != NULL, error = OTBR_ERROR_DBUS);
+
+    while (call < kMaxCalls && mCalls[call].mUsed)
+    {
+        ++call;
+    }
+
+    VerifyOrExit(call < kMaxCalls, errno = EBUSY);
+    VerifyOrExit((rval = sd_bus_message_new_method_call(mBus, &message, aMethod.mDestination, aMethod.mPath,
+                                                        aMethod.mInterface, aMethod.mMember)) >= 0,
+                 errno = -rval);
+
+    for (size_t i = 0; i < aCount; ++i)
+    {
+        const Argument &argument = aArguments[i];
+
+        if (argument.mType == kTypeArray)
+        {
+            rval = sd_bus_message_append_array(message, kTypeByte, argument.mValue, argument.mLength);
+        }
+        else
+        {
+            rval = sd_bus_message_append_basic(message, static_cast<char>(argument.mType), argument.mValue);
+        }
+
+        VerifyOrExit(rval >= 0, errno = -rval);
+    }
+
+    rval = sd_bus_call_async(mBus, &mCalls[call].mSlot, message, HandleReply, &mCalls[call],
+                             static_cast<uint64_t>(aTimeout) * 1000);
+    VerifyOrExit(rval >= 0, error = OTBR_ERROR_DBUS, otbrLog(OTBR_LOG_WARNING, "Bus call failed: %s", strerror(-rval)));
+
+    mCalls[call].mUsed = true;
+    aCall              = call;
+    error              = OTBR_ERROR_NONE;
+
+exit:
+    if (message != NULL)
+    {
+        sd_bus_message_unref(message);
+    }
+
+    return error;
+}
+
+Reader *SdbusConnection::Wait(unsigned int aCall)
+{
+    Reader *     reader = NULL;
+    PendingCall &call   = mCalls[aCall < kMaxCalls ? aCall : 0];
+
+    VerifyOrExit(aCall < kMaxCalls && call.mUsed);
+
+    // Replies of other calls are dispatched on the way, timeouts are replied with errors by sd-bus.
+    while (call.mReply == NULL)
+    {
+        int rval = sd_bus_process(mBus, NULL);
+
+        if (rval == 0)
+        {
+            rval = sd_bus_wait(mBus, static_cast<uint64_t>(-1));
+        }
+
+        VerifyOrExit(rval >= 0, otbrLog(OTBR_LOG_WARNING, "Bus connection failed: %s", strerror(-rval)));
+    }
+
+    if (sd_bus_message_is_method_error(call.mReply, NULL))
+    {
+        const sd_bus_error *error = sd_bus_message_get_error(call.mReply);
+
+        otbrLog(OTBR_LOG_WARNING, "Bus call failed: %s: %s", error->name, error->message);
+        ExitNow();
+    }
+
+    call.mReader.Init(*call.mReply);
+    reader = &call.mReader;
+
+exit:
+    return reader;
+}
+
+void SdbusConnection::Release(unsigned int aCall)
+{
+    PendingCall &call = mCalls[aCall < kMaxCalls ? aCall : 0];
+
+    VerifyOrExit(aCall < kMaxCalls);
+
+    // Unreferencing the slot of a pending call cancels it.
+    call.mSlot  = sd_bus_slot_unref(call.mSlot);
+    call.mReply = sd_bus_message_unref(call.mReply);
+    call.mUsed  = false;
+
+exit:
+    return;
+}
+
+bool SdbusConnection::IsConnected(void) const
+{
+    return mBus != NULL && sd_bus_is_open(mBus) > 0;
+}
+
+Connection *Connection::Create(void)
+{
+    SdbusConnection *connection = new SdbusConnection();
+
+    if (connection->Init() != OTBR_ERROR_NONE)
+    {
+        delete connection;
+        connection = NULL;
+    }
+
+    return connection;
+}
+
+void Connection::Destroy(Connection *aConnection)
+{
+    delete static_cast<SdbusConnection *>(aConnection);
+}
+
+} // namespace Bus
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // OTBR_ENABLE_SDBUS
@@ -0,0 +1,147 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the D-Bus transport on sd-bus of systemd.
+ */
+
+#ifndef BUS_SDBUS_HPP_
+#define BUS_SDBUS_HPP_
+
+#if OTBR_ENABLE_SDBUS
+
+#include <systemd/sd-bus.h>
+
+#include "common/bus.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Bus {
+
+/**
+ * This class implements the reader of an sd-bus message.
+ *
+ */
+class SdbusReader : public Reader
+{
+public:
+    /**
+     * This constructor initializes the reader, with no message to read.
+     *
+     */
+    SdbusReader(void)
+        : mMessage(NULL)
+    {
+    }
+
+    /**
+     * This method starts reading the arguments of a message.
+     *
+     * @param[in]   aMessage    A reference to the message, whose read position is rewound.
+     *
+     */
+    void Init(sd_bus_message &aMessage)
+    {
+        mMessage = &aMessage;
+        sd_bus_message_rewind(mMessage, true);
+    }
+
+    virtual int  GetType(void);
+    virtual int  GetElementType(void);
+    virtual bool ReadBasic(int aType, void *aValue);
+    virtual bool ReadBytes(const uint8_t *&aBytes, size_t &aLength);
+    virtual bool Enter(void);
+    virtual bool Leave(void);
+    virtual bool Skip(void);
+
+private:
+    sd_bus_message *mMessage;
+};
+
+/**
+ * This class implements the connection to the system bus on sd-bus.
+ *
+ * Replies are dispatched to their calls as they are waited for, the connection is only used by the thread calling.
+ *
+ */
+class SdbusConnection : public Connection
+{
+public:
+    /**
+     * This constructor initializes the connection, not connected yet.
+     *
+     */
+    SdbusConnection(void);
+
+    virtual ~SdbusConnection(void);
+
+    /**
+     * This method connects to the system bus.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully connected.
+     * @retval  OTBR_ERROR_DBUS     Failed to connect.
+     *
+     */
+    otbrError Init(void);
+
+    virtual otbrError Send(const Method &  aMethod,
+                           const Argument *aArguments,
+                           size_t          aCount,
+                           int             aTimeout,
+                           unsigned int &  aCall);
+    virtual Reader *  Wait(unsigned int aCall);
+    virtual void      Release(unsigned int aCall);
+    virtual bool      IsConnected(void) const;
+
+private:
+    struct PendingCall
+    {
+        sd_bus_slot *   mSlot;
+        sd_bus_message *mReply;
+        SdbusReader     mReader;
+        bool            mUsed;
+    };
+
+    static int HandleReply(sd_bus_message *aReply, void *aContext, sd_bus_error *aError);
+
+    sd_bus *    mBus;
+    PendingCall mCalls[kMaxCalls];
+};
+
+} // namespace Bus
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // OTBR_ENABLE_SDBUS
+
+#endif // BUS_SDBUS_HPP_
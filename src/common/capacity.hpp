@@ -0,0 +1,250 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes the capacity of the pools and tables of the border router.
+ *
+ * The capacity is selected at compile time by OTBR_CAPACITY_PROFILE, see --with-capacity of configure. Each
+ * OTBR_CAPACITY_* value may also be defined on its own to override the profile.
+ */
+
+#ifndef CAPACITY_HPP_
+#define CAPACITY_HPP_
+
+#include "code_utils.hpp"
+
+#define OTBR_CAPACITY_PROFILE_TINY 0     ///< Single network on a constrained device.
+#define OTBR_CAPACITY_PROFILE_STANDARD 1 ///< The default capacity.
+#define OTBR_CAPACITY_PROFILE_GATEWAY 2  ///< Many commissioners and clients on a gateway.
+
+#ifndef OTBR_CAPACITY_PROFILE
+#define OTBR_CAPACITY_PROFILE OTBR_CAPACITY_PROFILE_STANDARD
+#endif
+
+#if OTBR_CAPACITY_PROFILE == OTBR_CAPACITY_PROFILE_TINY
+#define OTBR_CAPACITY_DEFAULT_NETWORKS 1
+#define OTBR_CAPACITY_DEFAULT_DTLS_SESSIONS 4
+#define OTBR_CAPACITY_DEFAULT_DTLS_CACHE_ENTRIES 4
+#define OTBR_CAPACITY_DEFAULT_ECJPAKE_KEYS 2
+#define OTBR_CAPACITY_DEFAULT_COAP_TRANSACTIONS 8
+#define OTBR_CAPACITY_DEFAULT_COAP_MESSAGE_POOL 2
+#define OTBR_CAPACITY_DEFAULT_COAP_DUPLICATES 8
+#define OTBR_CAPACITY_DEFAULT_PENDING_FORWARDS 4
+#define OTBR_CAPACITY_DEFAULT_RELAY_FLOWS 4
+#define OTBR_CAPACITY_DEFAULT_DATASET_CACHE 1
+#define OTBR_CAPACITY_DEFAULT_DATASET_OBSERVERS 2
+#define OTBR_CAPACITY_DEFAULT_LOG_BUFFER (4 * 1024)
+#define OTBR_CAPACITY_DEFAULT_LOG_LINE 256
+#define OTBR_CAPACITY_DEFAULT_SCANNED_NETWORKS 32
+#define OTBR_CAPACITY_DEFAULT_STATUS_SUBSCRIBERS 4
+#define OTBR_CAPACITY_DEFAULT_WEB_CONNECTIONS 8
+#elif OTBR_CAPACITY_PROFILE == OTBR_CAPACITY_PROFILE_STANDARD
+#define OTBR_CAPACITY_DEFAULT_NETWORKS 4
+#define OTBR_CAPACITY_DEFAULT_DTLS_SESSIONS 16
+#define OTBR_CAPACITY_DEFAULT_DTLS_CACHE_ENTRIES 16
+#define OTBR_CAPACITY_DEFAULT_ECJPAKE_KEYS 8
+#define OTBR_CAPACITY_DEFAULT_COAP_TRANSACTIONS 16
+#define OTBR_CAPACITY_DEFAULT_COAP_MESSAGE_POOL 8
+#define OTBR_CAPACITY_DEFAULT_COAP_DUPLICATES 32
+#define OTBR_CAPACITY_DEFAULT_PENDING_FORWARDS 16
+#define OTBR_CAPACITY_DEFAULT_RELAY_FLOWS 16
+#define OTBR_CAPACITY_DEFAULT_DATASET_CACHE 4
+#define OTBR_CAPACITY_DEFAULT_DATASET_OBSERVERS 16
+#define OTBR_CAPACITY_DEFAULT_LOG_BUFFER (64 * 1024)
+#define OTBR_CAPACITY_DEFAULT_LOG_LINE 1024
+#define OTBR_CAPACITY_DEFAULT_SCANNED_NETWORKS 250
+#define OTBR_CAPACITY_DEFAULT_STATUS_SUBSCRIBERS 32
+#define OTBR_CAPACITY_DEFAULT_WEB_CONNECTIONS 64
+#elif OTBR_CAPACITY_PROFILE == OTBR_CAPACITY_PROFILE_GATEWAY
+#define OTBR_CAPACITY_DEFAULT_NETWORKS 8
+#define OTBR_CAPACITY_DEFAULT_DTLS_SESSIONS 64
+#define OTBR_CAPACITY_DEFAULT_DTLS_CACHE_ENTRIES 64
+#define OTBR_CAPACITY_DEFAULT_ECJPAKE_KEYS 32
+#define OTBR_CAPACITY_DEFAULT_COAP_TRANSACTIONS 64
+#define OTBR_CAPACITY_DEFAULT_COAP_MESSAGE_POOL 32
+#define OTBR_CAPACITY_DEFAULT_COAP_DUPLICATES 128
+#define OTBR_CAPACITY_DEFAULT_PENDING_FORWARDS 64
+#define OTBR_CAPACITY_DEFAULT_RELAY_FLOWS 64
+#define OTBR_CAPACITY_DEFAULT_DATASET_CACHE 8
+#define OTBR_CAPACITY_DEFAULT_DATASET_OBSERVERS 64
+#define OTBR_CAPACITY_DEFAULT_LOG_BUFFER (256 * 1024)
+#define OTBR_CAPACITY_DEFAULT_LOG_LINE 1024
+#define OTBR_CAPACITY_DEFAULT_SCANNED_NETWORKS 250
+#define OTBR_CAPACITY_DEFAULT_STATUS_SUBSCRIBERS 128
+#define OTBR_CAPACITY_DEFAULT_WEB_CONNECTIONS 256
+#else
+#error "unknown OTBR_CAPACITY_PROFILE"
+#endif
+
+/**
+ * Max number of Thread networks served by an agent instance.
+ *
+ */
+#ifndef OTBR_CAPACITY_NETWORKS
+#define OTBR_CAPACITY_NETWORKS OTBR_CAPACITY_DEFAULT_NETWORKS
+#endif
+
+/**
+ * Default max number of DTLS sessions of a border agent.
+ *
+ */
+#ifndef OTBR_CAPACITY_DTLS_SESSIONS
+#define OTBR_CAPACITY_DTLS_SESSIONS OTBR_CAPACITY_DEFAULT_DTLS_SESSIONS
+#endif
+
+/**
+ * Default max number of cached DTLS sessions of a border agent.
+ *
+ */
+#ifndef OTBR_CAPACITY_DTLS_CACHE_ENTRIES
+#define OTBR_CAPACITY_DTLS_CACHE_ENTRIES OTBR_CAPACITY_DEFAULT_DTLS_CACHE_ENTRIES
+#endif
+
+/**
+ * Number of EC-JPAKE ephemeral keys precomputed for the DTLS handshakes of the border agents, 0 to compute them as
+ * handshakes start.
+ *
+ */
+#ifndef OTBR_CAPACITY_ECJPAKE_KEYS
+#define OTBR_CAPACITY_ECJPAKE_KEYS OTBR_CAPACITY_DEFAULT_ECJPAKE_KEYS
+#endif
+
+/**
+ * Max number of confirmable CoAP messages in flight, of the native CoAP engine.
+ *
+ */
+#ifndef OTBR_CAPACITY_COAP_TRANSACTIONS
+#define OTBR_CAPACITY_COAP_TRANSACTIONS OTBR_CAPACITY_DEFAULT_COAP_TRANSACTIONS
+#endif
+
+/**
+ * Number of CoAP messages preallocated and kept for reuse.
+ *
+ */
+#ifndef OTBR_CAPACITY_COAP_MESSAGE_POOL
+#define OTBR_CAPACITY_COAP_MESSAGE_POOL OTBR_CAPACITY_DEFAULT_COAP_MESSAGE_POOL
+#endif
+
+/**
+ * Number of CoAP requests remembered by an agent to detect their retransmissions.
+ *
+ */
+#ifndef OTBR_CAPACITY_COAP_DUPLICATES
+#define OTBR_CAPACITY_COAP_DUPLICATES OTBR_CAPACITY_DEFAULT_COAP_DUPLICATES
+#endif
+
+/**
+ * Max number of commissioner requests in flight to the leader.
+ *
+ */
+#ifndef OTBR_CAPACITY_PENDING_FORWARDS
+#define OTBR_CAPACITY_PENDING_FORWARDS OTBR_CAPACITY_DEFAULT_PENDING_FORWARDS
+#endif
+
+/**
+ * Number of joiners whose relayed messages are accounted by a border agent.
+ *
+ */
+#ifndef OTBR_CAPACITY_RELAY_FLOWS
+#define OTBR_CAPACITY_RELAY_FLOWS OTBR_CAPACITY_DEFAULT_RELAY_FLOWS
+#endif
+
+/**
+ * Number of cached dataset queries of a border agent.
+ *
+ */
+#ifndef OTBR_CAPACITY_DATASET_CACHE
+#define OTBR_CAPACITY_DATASET_CACHE OTBR_CAPACITY_DEFAULT_DATASET_CACHE
+#endif
+
+/**
+ * Max number of commissioners observing the datasets of a border agent.
+ *
+ */
+#ifndef OTBR_CAPACITY_DATASET_OBSERVERS
+#define OTBR_CAPACITY_DATASET_OBSERVERS OTBR_CAPACITY_DEFAULT_DATASET_OBSERVERS
+#endif
+
+/**
+ * Size in bytes of the buffer of the log file writer.
+ *
+ */
+#ifndef OTBR_CAPACITY_LOG_BUFFER
+#define OTBR_CAPACITY_LOG_BUFFER OTBR_CAPACITY_DEFAULT_LOG_BUFFER
+#endif
+
+/**
+ * Max length in bytes of a line of the private log file.
+ *
+ */
+#ifndef OTBR_CAPACITY_LOG_LINE
+#define OTBR_CAPACITY_LOG_LINE OTBR_CAPACITY_DEFAULT_LOG_LINE
+#endif
+
+/**
+ * Max number of networks kept from a scan.
+ *
+ */
+#ifndef OTBR_CAPACITY_SCANNED_NETWORKS
+#define OTBR_CAPACITY_SCANNED_NETWORKS OTBR_CAPACITY_DEFAULT_SCANNED_NETWORKS
+#endif
+
+/**
+ * Max number of clients of the status event stream of the web server.
+ *
+ */
+#ifndef OTBR_CAPACITY_STATUS_SUBSCRIBERS
+#define OTBR_CAPACITY_STATUS_SUBSCRIBERS OTBR_CAPACITY_DEFAULT_STATUS_SUBSCRIBERS
+#endif
+
+/**
+ * Default max number of connections of the web server, the status event streams included.
+ *
+ */
+#ifndef OTBR_CAPACITY_WEB_CONNECTIONS
+#define OTBR_CAPACITY_WEB_CONNECTIONS OTBR_CAPACITY_DEFAULT_WEB_CONNECTIONS
+#endif
+
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_NETWORKS >= 1 && OTBR_CAPACITY_NETWORKS <= 255, CapacityNetworks);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_DTLS_SESSIONS >= 1, CapacityDtlsSessions);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_ECJPAKE_KEYS >= 0, CapacityEcjpakeKeys);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_COAP_TRANSACTIONS >= 1, CapacityCoapTransactions);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_COAP_MESSAGE_POOL <= OTBR_CAPACITY_COAP_TRANSACTIONS, CapacityCoapMessagePool);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_COAP_DUPLICATES >= 1, CapacityCoapDuplicates);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_PENDING_FORWARDS >= 1, CapacityPendingForwards);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_RELAY_FLOWS >= 1, CapacityRelayFlows);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_DATASET_CACHE >= 1, CapacityDatasetCache);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_DATASET_OBSERVERS >= 1, CapacityDatasetObservers);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_LOG_BUFFER >= 1024, CapacityLogBuffer);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_LOG_LINE >= 128, CapacityLogLine);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_SCANNED_NETWORKS >= 1, CapacityScannedNetworks);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_STATUS_SUBSCRIBERS >= 1, CapacityStatusSubscribers);
+OTBR_STATIC_ASSERT(OTBR_CAPACITY_WEB_CONNECTIONS > OTBR_CAPACITY_STATUS_SUBSCRIBERS, CapacityWebConnections);
+
+#endif // CAPACITY_HPP_
@@ -104,4 +104,13 @@
         goto exit;   \
     } while (false)
 
+/**
+ *  This fails the compilation if the specified constant condition is false.
+ *
+ *  @param[in]  aCondition  A constant Boolean expression to be evaluated at compile time.
+ *  @param[in]  aName       A name unique in the scope, reported by the compiler when the condition is false.
+ *
+ */
+#define OTBR_STATIC_ASSERT(aCondition, aName) typedef char otbrStaticAssert##aName[(aCondition) ? 1 : -1]
+
 #endif // CODE_UTILS_HPP_
@@ -29,41 +29,54 @@
 #include "event_emitter.hpp"
 
 #include <assert.h>
+#include <string.h>
 
 namespace ot {
 
 namespace BorderRouter {
 
-void EventEmitter::On(int aEvent, Callback aCallback, void *aContext)
+EventEmitter::EventEmitter(void)
 {
-    assert(aCallback);
+    memset(mCounts, 0, sizeof(mCounts));
+}
 
-    Handlers &handlers = mEvents[aEvent];
+void EventEmitter::Add(int aEvent, Callback aCallback, TypedCallback aTypedCallback, Invoker aInvoker, void *aContext)
+{
+    assert(aCallback || aTypedCallback);
+    assert(aEvent >= 0 && aEvent < kMaxEvents);
+    assert(mCounts[aEvent] < kMaxHandlers);
 
-    handlers.push_back(Handler(aCallback, aContext));
+    if (aEvent >= 0 && aEvent < kMaxEvents && mCounts[aEvent] < kMaxHandlers)
+    {
+        Handler &handler = mHandlers[aEvent][mCounts[aEvent]++];
+
+        handler.mCallback      = aCallback;
+        handler.mTypedCallback = aTypedCallback;
+        handler.mInvoker       = aInvoker;
+        handler.mContext       = aContext;
+    }
 }
 
-void EventEmitter::Off(int aEvent, Callback aCallback, void *aContext)
+void EventEmitter::Remove(int aEvent, Callback aCallback, TypedCallback aTypedCallback, void *aContext)
 {
-    assert(aCallback);
+    assert(aCallback || aTypedCallback);
 
-    if (!mEvents.count(aEvent))
+    if (aEvent < 0 || aEvent >= kMaxEvents)
     {
         return;
     }
 
-    Handler   handler  = Handler(aCallback, aContext);
-    Handlers &handlers = mEvents[aEvent];
+    Handler *handlers = mHandlers[aEvent];
+    uint8_t &count    = mCounts[aEvent];
 
-    for (Handlers::iterator it = handlers.begin(); it != handlers.end(); ++it)
+    for (uint8_t i = 0; i < count; ++i)
     {
-        if (*it == handler)
+        if (handlers[i].mCallback == aCallback && handlers[i].mTypedCallback == aTypedCallback &&
+            handlers[i].mContext == aContext)
         {
-            handlers.erase(it);
-            if (handlers.empty())
-            {
-                mEvents.erase(aEvent);
-            }
+            // Keep the calling sequence of the remaining handlers.
+            memmove(&handlers[i], &handlers[i + 1], (count - i - 1) * sizeof(Handler));
+            --count;
             break;
         }
     }
@@ -71,28 +84,45 @@ void EventEmitter::Off(int aEvent, Callback aCallback, void *aContext)
 
 void EventEmitter::Emit(int aEvent, ...)
 {
-    if (!mEvents.count(aEvent))
+    if (aEvent < 0 || aEvent >= kMaxEvents)
     {
         return;
     }
 
-    va_list args;
-    va_start(args, aEvent);
-    Handlers &handlers = mEvents[aEvent];
+    const Handler *handlers = mHandlers[aEvent];
+    va_list        args;
 
-    assert(!handlers.empty());
+    va_start(args, aEvent);
 
-    for (Handlers::iterator it = handlers.begin(); it != handlers.end(); ++it)
+    for (uint8_t i = 0; i < mCounts[aEvent]; ++i)
     {
-        va_list tmpArgs;
-        va_copy(tmpArgs, args);
-        it->first(it->second, aEvent, tmpArgs);
-        va_end(tmpArgs);
+        if (handlers[i].mCallback != NULL)
+        {
+            va_list tmpArgs;
+            va_copy(tmpArgs, args);
+            handlers[i].mCallback(handlers[i].mContext, aEvent, tmpArgs);
+            va_end(tmpArgs);
+        }
     }
 
     va_end(args);
 }
 
+void EventEmitter::EmitTyped(int aEvent, const void *aPayload)
+{
+    assert(aEvent >= 0 && aEvent < kMaxEvents);
+
+    const Handler *handlers = mHandlers[aEvent];
+
+    for (uint8_t i = 0; i < mCounts[aEvent]; ++i)
+    {
+        if (handlers[i].mInvoker != NULL)
+        {
+            handlers[i].mInvoker(handlers[i].mTypedCallback, handlers[i].mContext, aPayload);
+        }
+    }
+}
+
 } // namespace BorderRouter
 
 } // namespace ot
@@ -29,10 +29,9 @@
 #ifndef EVENT_EMITTER_HPP_
 #define EVENT_EMITTER_HPP_
 
-#include <list>
-#include <map>
-
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 
 namespace ot {
 
@@ -41,6 +40,12 @@ namespace BorderRouter {
 /**
  * This class implements the basic functionality of an event emitter.
  *
+ * Handlers are kept in fixed-size arrays indexed by the event id, so neither registering nor emitting allocates.
+ *
+ * Besides the variadic interface, events may be emitted as typed payloads. A payload is a struct defining the
+ * event id it is emitted for as the enumerator kEvent. Handlers of payloads are only called by EmitPayload(), and
+ * handlers of variadic arguments only by Emit().
+ *
  */
 class EventEmitter
 {
@@ -55,6 +60,18 @@ class EventEmitter
     typedef void (*Callback)(void *aContext, int aEvent, va_list aArguments);
 
 public:
+    enum
+    {
+        kMaxEvents   = 8, ///< Event ids must be less than this value.
+        kMaxHandlers = 4, ///< Max number of handlers of an event.
+    };
+
+    /**
+     * The constructor to initialize an event emitter without handlers.
+     *
+     */
+    EventEmitter(void);
+
     /**
      * This method register an event handler for @p aEvent.
      *
@@ -63,7 +80,7 @@ public:
      * @param[in]   aContext    A pointer to application-specific context.
      *
      */
-    void On(int aEvent, Callback aCallback, void *aContext);
+    void On(int aEvent, Callback aCallback, void *aContext) { Add(aEvent, aCallback, NULL, NULL, aContext); }
 
     /**
      * This method deregister an event handler for @p aEvent.
@@ -73,7 +90,7 @@ public:
      * @param[in]   aContext    A pointer to application-specific context.
      *
      */
-    void Off(int aEvent, Callback aCallback, void *aContext);
+    void Off(int aEvent, Callback aCallback, void *aContext) { Remove(aEvent, aCallback, NULL, aContext); }
 
     /**
      * This method emits an event.
@@ -83,11 +100,62 @@ public:
      */
     void Emit(int aEvent, ...);
 
+    /**
+     * This method registers a handler of the payload type @p Payload.
+     *
+     * @param[in]   aCallback   The function poiner to be called with the payload.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    template <typename Payload> void On(void (*aCallback)(void *aContext, const Payload &aPayload), void *aContext)
+    {
+        Add(Payload::kEvent, NULL, reinterpret_cast<TypedCallback>(aCallback), Invoke<Payload>, aContext);
+    }
+
+    /**
+     * This method deregisters a handler of the payload type @p Payload.
+     *
+     * @param[in]   aCallback   The function poiner to be called with the payload.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    template <typename Payload> void Off(void (*aCallback)(void *aContext, const Payload &aPayload), void *aContext)
+    {
+        Remove(Payload::kEvent, NULL, reinterpret_cast<TypedCallback>(aCallback), aContext);
+    }
+
+    /**
+     * This method emits a typed payload.
+     *
+     * @param[in]   aPayload    A reference to the payload.
+     *
+     */
+    template <typename Payload> void EmitPayload(const Payload &aPayload) { EmitTyped(Payload::kEvent, &aPayload); }
+
 private:
-    typedef std::pair<Callback, void *> Handler;
-    typedef std::list<Handler>          Handlers;
-    typedef std::map<int, Handlers>     Events;
-    Events                              mEvents;
+    typedef void (*TypedCallback)(void);
+    typedef void (*Invoker)(TypedCallback aCallback, void *aContext, const void *aPayload);
+
+    struct Handler
+    {
+        Callback      mCallback;      ///< The variadic callback, NULL for a typed handler.
+        TypedCallback mTypedCallback; ///< The typed callback, NULL for a variadic handler.
+        Invoker       mInvoker;       ///< Calls mTypedCallback with the payload of its type.
+        void *        mContext;       ///< A pointer to application-specific context.
+    };
+
+    template <typename Payload> static void Invoke(TypedCallback aCallback, void *aContext, const void *aPayload)
+    {
+        reinterpret_cast<void (*)(void *, const Payload &)>(aCallback)(aContext,
+                                                                      *static_cast<const Payload *>(aPayload));
+    }
+
+    void Add(int aEvent, Callback aCallback, TypedCallback aTypedCallback, Invoker aInvoker, void *aContext);
+    void Remove(int aEvent, Callback aCallback, TypedCallback aTypedCallback, void *aContext);
+    void EmitTyped(int aEvent, const void *aPayload);
+
+    Handler mHandlers[kMaxEvents][kMaxHandlers];
+    uint8_t mCounts[kMaxEvents];
 };
 
 } // namespace BorderRouter
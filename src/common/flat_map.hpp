@@ -0,0 +1,338 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of an open-addressing hash map of small keys and values.
+ */
+
+#ifndef FLAT_MAP_HPP_
+#define FLAT_MAP_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This template hashes an integer key.
+ *
+ */
+template <typename Key> struct FlatMapHash
+{
+    static uint32_t Get(Key aKey) { return Mix(static_cast<uint64_t>(aKey)); }
+
+    static uint32_t Mix(uint64_t aValue)
+    {
+        aValue ^= aValue >> 33;
+        aValue *= 0xff51afd7ed558ccdULL;
+        aValue ^= aValue >> 33;
+        return static_cast<uint32_t>(aValue);
+    }
+};
+
+/**
+ * This template hashes a pointer key by its address.
+ *
+ */
+template <typename Key> struct FlatMapHash<Key *>
+{
+    static uint32_t Get(const Key *aKey) { return FlatMapHash<uintptr_t>::Mix(reinterpret_cast<uintptr_t>(aKey)); }
+};
+
+/**
+ * This class implements a hash map with linear probing, of keys and values copied by assignment, like pointers.
+ *
+ * Entries are kept in a single array, so that a lookup reads consecutive entries instead of following tree nodes.
+ * Entries move when the map grows or an entry is erased, iterators and pointers to values are only valid until then.
+ *
+ */
+template <typename Key, typename Value> class FlatMap
+{
+public:
+    /**
+     * This structure represents an entry of the map.
+     *
+     */
+    struct Entry
+    {
+        Key   mKey;   ///< The key.
+        Value mValue; ///< The value.
+    };
+
+    /**
+     * This class iterates the entries of a map, in no particular order.
+     *
+     */
+    class Iterator
+    {
+    public:
+        Entry &operator*(void) const { return mMap->mEntries[mIndex]; }
+        Entry *operator->(void) const { return &mMap->mEntries[mIndex]; }
+        bool   operator==(const Iterator &aOther) const { return mIndex == aOther.mIndex; }
+        bool   operator!=(const Iterator &aOther) const { return mIndex != aOther.mIndex; }
+
+        Iterator &operator++(void)
+        {
+            mIndex = mMap->Next(mIndex + 1);
+            return *this;
+        }
+
+    private:
+        friend class FlatMap;
+
+        Iterator(const FlatMap *aMap, size_t aIndex)
+            : mMap(aMap)
+            , mIndex(aIndex)
+        {
+        }
+
+        const FlatMap *mMap;
+        size_t         mIndex;
+    };
+
+    /**
+     * The constructor initializes an empty map, which allocates on the first insertion.
+     *
+     */
+    FlatMap(void)
+        : mEntries(NULL)
+        , mUsed(NULL)
+        , mCapacity(0)
+        , mSize(0)
+    {
+    }
+
+    /**
+     * The destructor frees the entries.
+     *
+     */
+    ~FlatMap(void)
+    {
+        free(mEntries);
+        free(mUsed);
+    }
+
+    /**
+     * This method returns the number of entries.
+     *
+     */
+    size_t GetSize(void) const { return mSize; }
+
+    /**
+     * This method finds the value of a key.
+     *
+     * @param[in]  aKey  The key.
+     *
+     * @returns A pointer to the value, NULL if the key is not in the map.
+     *
+     */
+    Value *Find(const Key &aKey) const
+    {
+        Value *value = NULL;
+
+        if (mSize != 0)
+        {
+            for (size_t i = GetHome(aKey); mUsed[i]; i = (i + 1) & (mCapacity - 1))
+            {
+                if (mEntries[i].mKey == aKey)
+                {
+                    value = &mEntries[i].mValue;
+                    break;
+                }
+            }
+        }
+
+        return value;
+    }
+
+    /**
+     * This method sets the value of a key, inserting it if not in the map.
+     *
+     * @param[in]  aKey    The key.
+     * @param[in]  aValue  The value.
+     *
+     * @retval true   Successfully set the value.
+     * @retval false  Failed to allocate the entries, the map is unchanged.
+     *
+     */
+    bool Set(const Key &aKey, const Value &aValue)
+    {
+        Value *value = Find(aKey);
+        bool   ok    = true;
+
+        if (value != NULL)
+        {
+            *value = aValue;
+        }
+        else if ((mSize + 1) * 4 <= mCapacity * 3 || (ok = Grow()))
+        {
+            Insert(aKey, aValue);
+        }
+
+        return ok;
+    }
+
+    /**
+     * This method erases a key.
+     *
+     * The entries following it in its probe sequence are shifted back, so that erasing leaves no tombstones.
+     *
+     * @param[in]  aKey  The key.
+     *
+     * @retval true   Successfully erased the key.
+     * @retval false  The key is not in the map.
+     *
+     */
+    bool Erase(const Key &aKey)
+    {
+        Value *value = Find(aKey);
+
+        if (value != NULL)
+        {
+            const size_t mask = mCapacity - 1;
+            size_t       hole = static_cast<size_t>(reinterpret_cast<Entry *>(value) - mEntries);
+
+            for (size_t i = (hole + 1) & mask; mUsed[i]; i = (i + 1) & mask)
+            {
+                // An entry moves into the hole unless its home lies cyclically in (hole, i].
+                if (((i - GetHome(mEntries[i].mKey)) & mask) >= ((i - hole) & mask))
+                {
+                    mEntries[hole] = mEntries[i];
+                    hole           = i;
+                }
+            }
+
+            mUsed[hole] = false;
+            mSize--;
+        }
+
+        return value != NULL;
+    }
+
+    /**
+     * This method erases all entries, keeping the allocation.
+     *
+     */
+    void Clear(void)
+    {
+        for (size_t i = 0; i < mCapacity; i++)
+        {
+            mUsed[i] = false;
+        }
+
+        mSize = 0;
+    }
+
+    Iterator Begin(void) const { return Iterator(this, Next(0)); }
+    Iterator End(void) const { return Iterator(this, mCapacity); }
+
+private:
+    enum
+    {
+        kMinCapacity = 8, ///< Number of entries first allocated, a power of 2.
+    };
+
+    FlatMap(const FlatMap &);
+    FlatMap &operator=(const FlatMap &);
+
+    size_t GetHome(const Key &aKey) const { return FlatMapHash<Key>::Get(aKey) & (mCapacity - 1); }
+
+    size_t Next(size_t aIndex) const
+    {
+        while (aIndex < mCapacity && !mUsed[aIndex])
+        {
+            aIndex++;
+        }
+
+        return aIndex;
+    }
+
+    void Insert(const Key &aKey, const Value &aValue)
+    {
+        size_t i = GetHome(aKey);
+
+        while (mUsed[i])
+        {
+            i = (i + 1) & (mCapacity - 1);
+        }
+
+        mEntries[i].mKey   = aKey;
+        mEntries[i].mValue = aValue;
+        mUsed[i]           = true;
+        mSize++;
+    }
+
+    bool Grow(void)
+    {
+        size_t capacity   = mCapacity == 0 ? static_cast<size_t>(kMinCapacity) : mCapacity * 2;
+        Entry *entries    = static_cast<Entry *>(malloc(capacity * sizeof(Entry)));
+        bool * used       = static_cast<bool *>(calloc(capacity, sizeof(bool)));
+        Entry *oldEntries = mEntries;
+        bool * oldUsed    = mUsed;
+        size_t oldSize    = mCapacity;
+        bool   ok         = (entries != NULL && used != NULL);
+
+        if (ok)
+        {
+            mEntries  = entries;
+            mUsed     = used;
+            mCapacity = capacity;
+            mSize     = 0;
+
+            for (size_t i = 0; i < oldSize; i++)
+            {
+                if (oldUsed[i])
+                {
+                    Insert(oldEntries[i].mKey, oldEntries[i].mValue);
+                }
+            }
+
+            entries = oldEntries;
+            used    = oldUsed;
+        }
+
+        free(entries);
+        free(used);
+        return ok;
+    }
+
+    Entry *mEntries;  ///< The entries, mCapacity of them.
+    bool * mUsed;     ///< Whether each entry is used.
+    size_t mCapacity; ///< Number of entries allocated, 0 or a power of 2.
+    size_t mSize;     ///< Number of entries used.
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // FLAT_MAP_HPP_
@@ -0,0 +1,221 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of a load shedder driven by the mainloop latency.
+ */
+
+#ifndef LOAD_SHEDDER_HPP_
+#define LOAD_SHEDDER_HPP_
+
+#include <stdint.h>
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class implements a load shedder.
+ *
+ * The time each mainloop iteration takes is smoothed, an iteration delaying the events of the next one. Once it
+ * exceeds a threshold, or queues are three quarters full, the level rises at once, and by one more for each hold
+ * time the overload lasts. The level falls by one for each hold time below half the threshold with queues at most a
+ * quarter full, so that it does not flap around the threshold.
+ *
+ */
+class LoadShedder
+{
+public:
+    /**
+     * Levels of load shedding, each also sheds the work of the lower ones.
+     *
+     */
+    enum Level
+    {
+        kLevelNormal          = 0, ///< Nothing is shed.
+        kLevelDeferHandshakes = 1, ///< New DTLS peers only get a HelloVerifyRequest.
+        kLevelRejectPetitions = 2, ///< New commissioner petitions are answered 5.03 Service Unavailable.
+        kLevelDropRelay       = 3, ///< Relayed joiner traffic is dropped.
+    };
+
+    enum
+    {
+        kDefaultHoldTime = 1000, ///< Default time in milliseconds a level is kept at least.
+    };
+
+    /**
+     * The constructor initializes a shedder never shedding anything.
+     *
+     */
+    LoadShedder(void)
+        : mThreshold(0)
+        , mHoldTime(kDefaultHoldTime)
+        , mScaledLatency(0)
+        , mLevel(kLevelNormal)
+        , mLastChange(0)
+        , mUnderloaded(false)
+        , mUnderloadStart(0)
+    {
+    }
+
+    /**
+     * This method sets the threshold of the smoothed iteration time.
+     *
+     * @param[in]   aThreshold  The threshold in microseconds, 0 to never shed anything.
+     *
+     */
+    void SetThreshold(uint32_t aThreshold)
+    {
+        mThreshold = aThreshold;
+
+        if (aThreshold == 0)
+        {
+            mLevel = kLevelNormal;
+        }
+    }
+
+    /**
+     * This method returns the threshold of the smoothed iteration time.
+     *
+     * @returns The threshold in microseconds, 0 if nothing is shed.
+     *
+     */
+    uint32_t GetThreshold(void) const { return mThreshold; }
+
+    /**
+     * This method sets the time a level is kept at least.
+     *
+     * @param[in]   aHoldTime   The hold time in milliseconds.
+     *
+     */
+    void SetHoldTime(uint32_t aHoldTime) { mHoldTime = aHoldTime; }
+
+    /**
+     * This method returns the time a level is kept at least.
+     *
+     * @returns The hold time in milliseconds.
+     *
+     */
+    uint32_t GetHoldTime(void) const { return mHoldTime; }
+
+    /**
+     * This method accounts an iteration and updates the level.
+     *
+     * @param[in]   aLatency    The time the iteration took in microseconds.
+     * @param[in]   aQueued     The number of entries in the queues watched.
+     * @param[in]   aCapacity   The capacity of the queues watched, 0 if none.
+     * @param[in]   aNow        The current time in milliseconds, must not go backwards.
+     *
+     * @returns The level of load shedding.
+     *
+     */
+    Level Update(uint32_t aLatency, uint32_t aQueued, uint32_t aCapacity, uint64_t aNow)
+    {
+        uint64_t latency;
+        bool     overloaded;
+
+        // Exponentially weighted with 1/8 of each iteration, kept times 8.
+        mScaledLatency = mScaledLatency - mScaledLatency / kSmoothing + aLatency;
+        latency        = mScaledLatency / kSmoothing;
+
+        if (mThreshold == 0)
+        {
+            return kLevelNormal;
+        }
+
+        overloaded = latency >= mThreshold || (aCapacity != 0 && aQueued * 4 >= aCapacity * 3);
+
+        if (overloaded)
+        {
+            mUnderloaded = false;
+
+            if (mLevel < kLevelDropRelay && (mLevel == kLevelNormal || aNow - mLastChange >= mHoldTime))
+            {
+                mLevel      = static_cast<Level>(mLevel + 1);
+                mLastChange = aNow;
+            }
+        }
+        else if (latency < mThreshold / 2 && aQueued * 4 <= aCapacity)
+        {
+            if (!mUnderloaded)
+            {
+                mUnderloaded    = true;
+                mUnderloadStart = aNow;
+            }
+
+            if (mLevel > kLevelNormal && aNow - mUnderloadStart >= mHoldTime && aNow - mLastChange >= mHoldTime)
+            {
+                mLevel      = static_cast<Level>(mLevel - 1);
+                mLastChange = aNow;
+            }
+        }
+        else
+        {
+            mUnderloaded = false;
+        }
+
+        return mLevel;
+    }
+
+    /**
+     * This method returns the level of load shedding.
+     *
+     * @returns The level of load shedding.
+     *
+     */
+    Level GetLevel(void) const { return mLevel; }
+
+    /**
+     * This method returns the smoothed iteration time.
+     *
+     * @returns The smoothed iteration time in microseconds.
+     *
+     */
+    uint32_t GetLatency(void) const { return static_cast<uint32_t>(mScaledLatency / kSmoothing); }
+
+private:
+    enum
+    {
+        kSmoothing = 8, ///< Inverse of the weight of each iteration.
+    };
+
+    uint32_t mThreshold;      ///< Smoothed iteration time shedding starts at, in microseconds.
+    uint32_t mHoldTime;       ///< Time a level is kept at least, in milliseconds.
+    uint64_t mScaledLatency;  ///< Smoothed iteration time times kSmoothing, in microseconds.
+    Level    mLevel;          ///< The level of load shedding.
+    uint64_t mLastChange;     ///< When the level last changed, in milliseconds.
+    bool     mUnderloaded;    ///< Whether the load has stayed low since mUnderloadStart.
+    uint64_t mUnderloadStart; ///< When the load became low, in milliseconds.
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // LOAD_SHEDDER_HPP_
@@ -28,29 +28,80 @@
 
 #include "logging.hpp"
 
+#include "otbr-config.h"
+
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
+#include <pthread.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <syslog.h>
+#include <unistd.h>
 
+#include "capacity.hpp"
 #include "time.hpp"
 
 static int        sLevel      = LOG_INFO;
 static const char kHexChars[] = "0123456789abcdef";
 
+/* the two hex digits of each byte value, so that dumps are encoded a byte at a time */
+#define LOG_HEX_ROW(aHigh)                                                                                         \
+    aHigh "0" aHigh "1" aHigh "2" aHigh "3" aHigh "4" aHigh "5" aHigh "6" aHigh "7" aHigh "8" aHigh "9" aHigh "a" \
+        aHigh "b" aHigh "c" aHigh "d" aHigh "e" aHigh "f"
+static const char kHexPairs[] = LOG_HEX_ROW("0") LOG_HEX_ROW("1") LOG_HEX_ROW("2") LOG_HEX_ROW("3") LOG_HEX_ROW("4")
+    LOG_HEX_ROW("5") LOG_HEX_ROW("6") LOG_HEX_ROW("7") LOG_HEX_ROW("8") LOG_HEX_ROW("9") LOG_HEX_ROW("a")
+        LOG_HEX_ROW("b") LOG_HEX_ROW("c") LOG_HEX_ROW("d") LOG_HEX_ROW("e") LOG_HEX_ROW("f");
+#undef LOG_HEX_ROW
+
+int otbrLogModuleLevels[OTBR_LOG_MODULE_COUNT] = {LOG_INFO, LOG_INFO, LOG_INFO, LOG_INFO, LOG_INFO, LOG_INFO, LOG_INFO};
+
+/* levels set by otbrLogSetModuleLevel(), -1 if following sLevel, and the most verbose of all modules */
+static int sModuleLevels[OTBR_LOG_MODULE_COUNT] = {-1, -1, -1, -1, -1, -1, -1};
+static int sMaxLevel                            = LOG_INFO;
+
+static const char *const kModuleNames[OTBR_LOG_MODULE_COUNT] = {"default", "border-agent", "coap", "dtls",
+                                                                 "mdns",    "ncp",          "web"};
+
 static unsigned long sMsecsStart;
 static bool          sLogCol0 = true; /* we start at col0 */
 static FILE *        sLogFp;
+static char          sLogFilename[PATH_MAX];
 static bool          sSyslogEnabled = true;
 static bool          sSyslogOpened  = false;
 
+/*
+ * The file writer.
+ *
+ * Lines are appended to sFileBuffer under sFileLock, and the writer thread swaps it with sFileSpare to write it out,
+ * so the log file is never written from logging threads.
+ */
+static bool            sFileWriter = false;
+static pthread_mutex_t sFileLock   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  sFileReady  = PTHREAD_COND_INITIALIZER; /* data appended or stopping */
+static pthread_cond_t  sFileDone   = PTHREAD_COND_INITIALIZER; /* all data written */
+static pthread_t       sFileThread;
+static char *          sFileBuffer;
+static char *          sFileSpare;
+static size_t          sFileBufferSize;
+static size_t          sFileLength;
+static unsigned long   sFileDropped;
+static bool            sFileWriting;
+static bool            sFileStopping;
+static size_t          sFileSize;
+static size_t          sFileMaxSize;
+
 #define LOGFLAG_syslog 1
 #define LOGFLAG_file 2
+#define LOGFLAG_batch 4 /* syslog records are queued, to be sent at once by SyslogFlush() */
 
 /** Set/Clear syslog enable flag */
 void otbrLogEnableSyslog(bool b)
@@ -61,11 +112,18 @@ void otbrLogEnableSyslog(bool b)
 /** Enable logging to a specific file */
 void otbrLogSetFilename(const char *filename)
 {
+    otbrLogStopFileWriter();
+
     if (sLogFp)
     {
         fclose(sLogFp);
         sLogFp = NULL;
     }
+    if (filename == NULL)
+    {
+        sLogFilename[0] = '\0';
+        return;
+    }
     sLogFp = fopen(filename, "w");
     if (sLogFp == NULL)
     {
@@ -73,6 +131,7 @@ void otbrLogSetFilename(const char *filename)
         perror(filename);
         exit(EXIT_FAILURE);
     }
+    snprintf(sLogFilename, sizeof(sLogFilename), "%s", filename);
 }
 
 /** Get the current debug log level */
@@ -81,11 +140,73 @@ int otbrLogGetLevel(void)
     return sLevel;
 }
 
+static pthread_mutex_t sLevelLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* recompute the level of each module, called with sLevelLock held */
+static void UpdateModuleLevels(void)
+{
+    int maxLevel = sLevel;
+
+    for (int i = 0; i < OTBR_LOG_MODULE_COUNT; i++)
+    {
+        int level = sModuleLevels[i] >= 0 ? sModuleLevels[i] : sLevel;
+
+        __atomic_store_n(&otbrLogModuleLevels[i], level, __ATOMIC_RELAXED);
+        maxLevel = level > maxLevel ? level : maxLevel;
+    }
+
+    __atomic_store_n(&sMaxLevel, maxLevel, __ATOMIC_RELAXED);
+}
+
 /** Set the debug log level */
 void otbrLogSetLevel(int aLevel)
 {
     assert(aLevel >= LOG_EMERG && aLevel <= LOG_DEBUG);
+    pthread_mutex_lock(&sLevelLock);
     sLevel = aLevel;
+    UpdateModuleLevels();
+    pthread_mutex_unlock(&sLevelLock);
+}
+
+void otbrLogSetModuleLevel(int aModule, int aLevel)
+{
+    assert(aModule >= 0 && aModule < OTBR_LOG_MODULE_COUNT);
+    assert(aLevel >= -1 && aLevel <= LOG_DEBUG);
+    pthread_mutex_lock(&sLevelLock);
+    __atomic_store_n(&sModuleLevels[aModule], aLevel, __ATOMIC_RELAXED);
+    UpdateModuleLevels();
+    pthread_mutex_unlock(&sLevelLock);
+}
+
+int otbrLogGetModuleLevel(int aModule)
+{
+    assert(aModule >= 0 && aModule < OTBR_LOG_MODULE_COUNT);
+    return __atomic_load_n(&otbrLogModuleLevels[aModule], __ATOMIC_RELAXED);
+}
+
+bool otbrLogIsModuleLevelSet(int aModule)
+{
+    assert(aModule >= 0 && aModule < OTBR_LOG_MODULE_COUNT);
+    return __atomic_load_n(&sModuleLevels[aModule], __ATOMIC_RELAXED) >= 0;
+}
+
+const char *otbrLogGetModuleName(int aModule)
+{
+    assert(aModule >= 0 && aModule < OTBR_LOG_MODULE_COUNT);
+    return kModuleNames[aModule];
+}
+
+int otbrLogFindModule(const char *aName)
+{
+    for (int i = 0; i < OTBR_LOG_MODULE_COUNT; i++)
+    {
+        if (strcmp(kModuleNames[i], aName) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
 }
 
 /** Determine if we should not or not log, and if so where to */
@@ -97,15 +218,21 @@ static int LogCheck(int aLevel)
 
     r = 0;
 
-    if (sSyslogOpened && sSyslogEnabled && (aLevel <= sLevel))
+    /* the level of the module was checked at the call site, the
+     * most verbose level only filters calls bypassing the check.
+     * The separate file is written at the same levels, so that it
+     * can trace one module without formatting the logs of others.
+     */
+    if (aLevel > __atomic_load_n(&sMaxLevel, __ATOMIC_RELAXED))
+    {
+        return 0;
+    }
+
+    if (sSyslogOpened && sSyslogEnabled)
     {
         r = r | LOGFLAG_syslog;
     }
 
-    /* if someone has turned on the seperate file the most likely
-     * situation is they are debugging a problem, or need a extra
-     * information. In this case, we do not test the log level.
-     */
     if (sLogFp != NULL)
     {
         r = r | LOGFLAG_file;
@@ -116,43 +243,98 @@ static int LogCheck(int aLevel)
 /** return the time, in milliseconds since application start */
 static unsigned long GetMsecsNow(void)
 {
-    unsigned long now = ot::BorderRouter::GetNow();
+    unsigned long now = static_cast<unsigned long>(ot::BorderRouter::GetMonotonicNow());
 
     now -= sMsecsStart;
     return now;
 }
 
-/** Write this string to the private log file, inserting the timestamp at column 0 */
-static void LogString(const char *cp)
+/** Write to the private log file, or append to the buffer of the file writer */
+static void LogWrite(const char *aData, size_t aLength)
+{
+    if (sFileWriter)
+    {
+        memcpy(sFileBuffer + sFileLength, aData, aLength);
+        sFileLength += aLength;
+    }
+    else
+    {
+        fwrite(aData, 1, aLength, sLogFp);
+    }
+}
+
+/** Write this string to the private log file, inserting the timestamp aTime at column 0 */
+static void LogStringAt(const char *cp, unsigned long aTime)
 {
-    int ch;
+    char   stamp[32];
+    size_t stampLength;
+
+    stampLength = static_cast<size_t>(snprintf(stamp, sizeof(stamp), "%4lu.%03lu | ", (aTime / 1000), (aTime % 1000)));
+
+    pthread_mutex_lock(&sFileLock);
+
+    if (sFileWriter)
+    {
+        size_t length = strlen(cp);
+
+        /* the string and a timestamp for each of its lines must fit, otherwise it is dropped as a whole */
+        for (const char *newline = strchr(cp, '\n'); newline != NULL; newline = strchr(newline + 1, '\n'))
+        {
+            length += stampLength;
+        }
+
+        if (length + stampLength > sFileBufferSize - sFileLength)
+        {
+            sFileDropped++;
+            pthread_mutex_unlock(&sFileLock);
+            return;
+        }
+
+        if (sFileLength == 0)
+        {
+            pthread_cond_signal(&sFileReady);
+        }
+    }
 
-    while ((ch = *cp++) != 0)
+    while (*cp != 0)
     {
+        size_t length = strcspn(cp, "\n");
+
         if (sLogCol0)
         {
             sLogCol0 = false;
-            unsigned long n;
-            n = GetMsecsNow();
-            fprintf(sLogFp, "%4lu.%03lu | ", (n / 1000), (n % 1000));
+            LogWrite(stamp, stampLength);
         }
-        if (ch == '\n')
+
+        LogWrite(cp, length);
+        cp += length;
+
+        if (*cp == '\n')
         {
             sLogCol0 = true;
-        }
-        fputc(ch, sLogFp);
-        if (ch == '\n')
-        {
+            LogWrite("\n", 1);
             /* force flush (in case something crashes) */
-            fflush(sLogFp);
+            if (!sFileWriter)
+            {
+                fflush(sLogFp);
+            }
+            cp++;
         }
     }
+
+    pthread_mutex_unlock(&sFileLock);
+}
+
+/** Write this string to the private log file, inserting the timestamp at column 0 */
+static void LogString(const char *cp)
+{
+    LogStringAt(cp, GetMsecsNow());
 }
 
 /** Print to the private log file */
 static void LogVprintf(const char *fmt, va_list ap)
 {
-    char buf[1024];
+    char buf[OTBR_CAPACITY_LOG_LINE];
 
     /* if not enabled ... leave */
     if (sLogFp == NULL)
@@ -164,6 +346,33 @@ static void LogVprintf(const char *fmt, va_list ap)
     LogString(buf);
 }
 
+/** Print a line to the private log file, logs do not end with a NEWLINE so one is added here */
+static void LogVprintLine(const char *fmt, va_list ap)
+{
+    char buf[OTBR_CAPACITY_LOG_LINE];
+    int  length;
+
+    if (sLogFp == NULL)
+    {
+        return;
+    }
+    length = vsnprintf(buf, sizeof(buf) - 1, fmt, ap);
+
+    if (length < 0)
+    {
+        length = 0;
+    }
+    else if (static_cast<size_t>(length) > sizeof(buf) - 2)
+    {
+        length = sizeof(buf) - 2;
+    }
+
+    buf[length]     = '\n';
+    buf[length + 1] = 0;
+
+    LogString(buf);
+}
+
 /** Print to the private log file */
 static void LogPrintf(const char *fmt, ...)
 {
@@ -174,118 +383,1432 @@ static void LogPrintf(const char *fmt, ...)
     va_end(ap);
 }
 
-/** Initialize logging */
-void otbrLogInit(const char *aIdent, int aLevel)
+/*
+ * The syslog sink.
+ *
+ * Records are sent to a datagram socket connected to the syslog socket, after a "<pri>ident[pid]: " header formatted
+ * once for each level, instead of through vsyslog(), which takes the lock of libc and formats the header and a
+ * timestamp for each record. The syslog daemon timestamps records on reception. Records of the ring drain are queued
+ * and sent in batches. Without the socket, records go through syslog().
+ */
+enum
 {
-    assert(aIdent);
-    assert(aLevel >= LOG_EMERG && aLevel <= LOG_DEBUG);
+    kSyslogMaxHeader = 64,                                        /* max length of the header of a record */
+    kSyslogMaxRecord = kSyslogMaxHeader + OTBR_CAPACITY_LOG_LINE, /* max length of a record, messages are truncated */
+    kSyslogBatchSize = 16,                                        /* max number of records sent at once */
+};
 
-    sMsecsStart = ot::BorderRouter::GetNow();
+static const char *sSyslogPath = "/dev/log";
+static int         sSyslogFd   = -1;
+static char        sSyslogHeaders[LOG_DEBUG + 1][kSyslogMaxHeader];
+static size_t      sSyslogHeaderLengths[LOG_DEBUG + 1];
+static size_t      sSyslogPriorityLengths[LOG_DEBUG + 1]; /* length of "<pri>", skipped when echoed to stderr */
 
-    /* only open the syslog once... */
-    if (!sSyslogOpened)
-    {
-        sSyslogOpened = true;
-        openlog(aIdent, LOG_CONS | LOG_PID | LOG_PERROR, LOG_USER);
-    }
-    sLevel = aLevel;
+/* the records queued by the ring drain, under sRingLock */
+static char   sSyslogBatch[kSyslogBatchSize][kSyslogMaxRecord];
+static size_t sSyslogBatchLengths[kSyslogBatchSize];
+static int    sSyslogBatchLevels[kSyslogBatchSize];
+static size_t sSyslogBatchCount;
+
+void otbrLogSetSyslogPath(const char *aPath)
+{
+    sSyslogPath = aPath;
 }
 
-/** log to the syslog or log file */
-void otbrLog(int aLevel, const char *aFormat, ...)
+/** Connect the syslog socket, returning whether it is connected */
+static bool SyslogConnect(void)
 {
-    va_list ap;
+    struct sockaddr_un address;
 
-    va_start(ap, aFormat);
-    otbrLogv(aLevel, aFormat, ap);
-    va_end(ap);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, sSyslogPath, sizeof(address.sun_path) - 1);
+
+    return connect(sSyslogFd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) == 0;
 }
 
-/** log to the syslog or log file */
-void otbrLogv(int aLevel, const char *aFormat, va_list ap)
+/** Open the syslog socket and format the headers of records, returning whether it is opened */
+static bool SyslogOpen(const char *aIdent)
 {
-    int r;
+    sSyslogFd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
 
-    assert(aFormat);
+    if (sSyslogFd < 0)
+    {
+        return false;
+    }
 
-    r = LogCheck(aLevel);
+    if (!SyslogConnect())
+    {
+        close(sSyslogFd);
+        sSyslogFd = -1;
+        return false;
+    }
 
-    if (r & LOGFLAG_file)
+    for (int level = LOG_EMERG; level <= LOG_DEBUG; level++)
     {
-        va_list cpy;
-        va_copy(cpy, ap);
-        LogVprintf(aFormat, cpy);
-        va_end(cpy);
+        int length = snprintf(sSyslogHeaders[level], kSyslogMaxHeader, "<%d>", LOG_USER | level);
 
-        /* logs do not end with a NEWLINE, we add one here */
-        LogString("\n");
+        sSyslogPriorityLengths[level] = static_cast<size_t>(length);
+        length += snprintf(sSyslogHeaders[level] + length, kSyslogMaxHeader - static_cast<size_t>(length), "%s[%d]: ",
+                           aIdent, static_cast<int>(getpid()));
+        sSyslogHeaderLengths[level] =
+            static_cast<size_t>(length) < kSyslogMaxHeader ? static_cast<size_t>(length) : kSyslogMaxHeader - 1;
     }
 
-    if (r & LOGFLAG_syslog)
+    return true;
+}
+
+static void SyslogClose(void)
+{
+    if (sSyslogFd >= 0)
     {
-        vsyslog(aLevel, aFormat, ap);
+        close(sSyslogFd);
+        sSyslogFd = -1;
     }
 }
 
-/** Hex dump data to the log */
-void otbrDump(int aLevel, const char *aPrefix, const void *aMemory, size_t aSize)
+/** Echo records to stderr as LOG_PERROR does, without their priority, in one write */
+static void SyslogEcho(const int *aLevels, char *const *aRecords, const size_t *aLengths, size_t aCount)
 {
-    assert(aPrefix && (aMemory || aSize == 0));
-    const uint8_t *pEnd;
-    const uint8_t *p8;
-    int            r;
-    int            addr;
+    struct iovec iov[2 * kSyslogBatchSize];
+    size_t       count = 0;
 
-    r = LogCheck(aLevel);
-    if (r == 0)
+    for (size_t i = 0; i < aCount; i++)
     {
-        return;
+        size_t skipped = sSyslogPriorityLengths[aLevels[i]];
+
+        iov[count].iov_base  = aRecords[i] + skipped;
+        iov[count++].iov_len = aLengths[i] - skipped;
+        iov[count].iov_base  = const_cast<char *>("\n");
+        iov[count++].iov_len = 1;
     }
 
-    /* break hex dumps into 16byte lines
-     * In the form ADDR: XX XX XX XX ...
-     */
+    if (writev(STDERR_FILENO, iov, static_cast<int>(count)) < 0)
+    {
+        /* nowhere left to report it */
+    }
+}
+
+/** Send one record, reconnecting once if the syslog daemon was restarted */
+static void SyslogSend(int aLevel, char *aRecord, size_t aLength)
+{
+    if (send(sSyslogFd, aRecord, aLength, MSG_NOSIGNAL) < 0 && (errno == ECONNREFUSED || errno == ENOTCONN) &&
+        SyslogConnect())
+    {
+        send(sSyslogFd, aRecord, aLength, MSG_NOSIGNAL);
+    }
+
+    SyslogEcho(&aLevel, &aRecord, &aLength, 1);
+}
+
+/** Format the header of a record followed by its message into aRecord, returning the length of the record */
+static size_t SyslogFormat(char *aRecord, int aLevel, const char *aMessage, size_t aLength)
+{
+    size_t headerLength = sSyslogHeaderLengths[aLevel];
+
+    if (aLength > kSyslogMaxRecord - headerLength)
+    {
+        aLength = kSyslogMaxRecord - headerLength;
+    }
+
+    memcpy(aRecord, sSyslogHeaders[aLevel], headerLength);
+    memcpy(aRecord + headerLength, aMessage, aLength);
 
-    // we pre-increment... so subtract
-    addr = -16;
+    return headerLength + aLength;
+}
+
+/** Send the records queued by the ring drain */
+static void SyslogFlush(void)
+{
+    char * records[kSyslogBatchSize];
+    size_t sent = 0;
+
+    for (size_t i = 0; i < sSyslogBatchCount; i++)
+    {
+        records[i] = sSyslogBatch[i];
+    }
 
-    while (aSize > 0)
+#if HAVE_SENDMMSG
     {
-        size_t this_size;
-        char   hex[16 * 3 + 1];
+        struct mmsghdr messages[kSyslogBatchSize];
+        struct iovec   iov[kSyslogBatchSize];
+
+        memset(messages, 0, sizeof(messages));
+
+        for (size_t i = 0; i < sSyslogBatchCount; i++)
+        {
+            iov[i].iov_base                = records[i];
+            iov[i].iov_len                 = sSyslogBatchLengths[i];
+            messages[i].msg_hdr.msg_iov    = &iov[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        while (sent < sSyslogBatchCount)
+        {
+            int count = sendmmsg(sSyslogFd, messages + sent, static_cast<unsigned int>(sSyslogBatchCount - sent),
+                                 MSG_NOSIGNAL);
 
-        addr = addr + 16;
-        p8   = (const uint8_t *)(aMemory) + addr;
+            /* the record failing to send is retried alone, reconnecting if needed */
+            if (count <= 0)
+            {
+                break;
+            }
 
-        /* truncate line to max 16 bytes */
-        this_size = aSize;
-        if (this_size > 16)
+            sent += static_cast<size_t>(count);
+        }
+    }
+#endif
+
+    for (size_t i = sent; i < sSyslogBatchCount; i++)
+    {
+        if (send(sSyslogFd, records[i], sSyslogBatchLengths[i], MSG_NOSIGNAL) < 0 &&
+            (errno == ECONNREFUSED || errno == ENOTCONN) && SyslogConnect())
         {
-            this_size = 16;
+            send(sSyslogFd, records[i], sSyslogBatchLengths[i], MSG_NOSIGNAL);
         }
-        aSize = aSize - this_size;
+    }
+
+    SyslogEcho(sSyslogBatchLevels, records, sSyslogBatchLengths, sSyslogBatchCount);
+    sSyslogBatchCount = 0;
+}
+
+/** Log a message to syslog, queuing it if aFlags has LOGFLAG_batch */
+static void SyslogWrite(int aFlags, int aLevel, const char *aMessage, size_t aLength)
+{
+    if (sSyslogFd < 0)
+    {
+        syslog(aLevel, "%.*s", static_cast<int>(aLength), aMessage);
+    }
+    else if (aFlags & LOGFLAG_batch)
+    {
+        char *record = sSyslogBatch[sSyslogBatchCount];
 
-        char *ch = hex - 1;
+        sSyslogBatchLevels[sSyslogBatchCount]  = aLevel;
+        sSyslogBatchLengths[sSyslogBatchCount] = SyslogFormat(record, aLevel, aMessage, aLength);
 
-        for (pEnd = p8 + this_size; p8 < pEnd; p8++)
+        if (++sSyslogBatchCount == kSyslogBatchSize)
         {
-            *++ch = kHexChars[(*p8) >> 4];
-            *++ch = kHexChars[(*p8) & 0x0f];
-            *++ch = ' ';
+            SyslogFlush();
         }
-        *ch = 0;
+    }
+    else
+    {
+        char record[kSyslogMaxRecord];
+
+        SyslogSend(aLevel, record, SyslogFormat(record, aLevel, aMessage, aLength));
+    }
+}
+
+/** Format and log a message to syslog */
+static void SyslogVprintf(int aLevel, const char *aFormat, va_list ap)
+{
+    char   record[kSyslogMaxRecord];
+    size_t headerLength = sSyslogHeaderLengths[aLevel];
+    int    length;
+
+    if (sSyslogFd < 0)
+    {
+        vsyslog(aLevel, aFormat, ap);
+        return;
+    }
+
+    memcpy(record, sSyslogHeaders[aLevel], headerLength);
+    length = vsnprintf(record + headerLength, kSyslogMaxRecord - headerLength, aFormat, ap);
+
+    if (length < 0)
+    {
+        length = 0;
+    }
+    else if (static_cast<size_t>(length) >= kSyslogMaxRecord - headerLength)
+    {
+        length = static_cast<int>(kSyslogMaxRecord - headerLength - 1);
+    }
+
+    SyslogSend(aLevel, record, headerLength + static_cast<size_t>(length));
+}
+
+/*
+ * The log ring.
+ *
+ * Producers claim a slot by advancing sRingHead, fill it, then publish it by setting its sequence, so recording
+ * never blocks and is safe from any thread. The drain formats published records in order, under sRingLock.
+ */
+enum
+{
+    kRingSlots         = 256, /* number of records, a power of 2 */
+    kRingMaxArgs       = 8,   /* max number of arguments of a record */
+    kRingDataSize      = 192, /* size of string arguments or dumped memory of a record */
+    kRingMaxSpec       = 32,  /* max length of a conversion specification */
+    kRingDrainInterval = 10,  /* milliseconds between drains of the background thread */
+    kRingMaxDumpSlots  = 16,  /* max number of slots of a memory dump record */
+};
+
+enum
+{
+    kDumpMaxPrefix  = 64,   /* max length of the prefix of dump lines */
+    kDumpBufferSize = 4096, /* size of the buffer dump lines are formatted in before being written */
+};
+
+enum LogArgType
+{
+    kArgInt,
+    kArgLong,
+    kArgLongLong,
+    kArgSize,
+    kArgIntMax,
+    kArgPtrDiff,
+    kArgDouble,
+    kArgPointer,
+    kArgString,
+};
+
+union LogValue
+{
+    long long   mInt;     /* integers, and offsets of strings in mData */
+    double      mDouble;  /* floating point numbers */
+    const void *mPointer; /* pointers */
+};
+
+struct LogRecord
+{
+    unsigned long mSequence; /* ring position this slot is free for, or position + 1 once published */
+    const char *  mFormat;   /* the format string, NULL for memory dumps */
+    unsigned long mTime;     /* milliseconds since logging initialized */
+    int           mLevel;
+    uint8_t       mArgCount;
+    uint8_t       mArgTypes[kRingMaxArgs];
+    LogValue      mArgs[kRingMaxArgs]; /* raw arguments, address, size and number of slots of memory dumps */
+    uint16_t      mDataLength;
+    char          mData[kRingDataSize]; /* copied strings, or the prefix and memory of dumps, continued by next slots */
+};
+
+/* a conversion specification of a format string */
+struct LogSpec
+{
+    LogArgType mType;          /* type of the converted argument */
+    uint8_t    mStars;         /* number of '*' width and precision arguments */
+    bool       mStarPrecision; /* whether the precision is given by an argument */
+    int        mPrecision;     /* the literal precision, -1 if none */
+    bool       mValid;         /* whether the specification can be recorded */
+};
+
+static LogRecord       sRing[kRingSlots];
+static bool            sRingEnabled = false;
+static unsigned long   sRingHead;
+static unsigned long   sRingTail;
+static unsigned long   sRingDropped;
+static pthread_mutex_t sRingLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t       sRingThread;
+static bool            sRingThreadStarted = false;
+static bool            sRingStopping      = false;
+
+/** Encode one hex dump line of up to 16 bytes into aLine, returning its length without the NEWLINE */
+static size_t DumpLine(char *aLine, const char *aPrefix, size_t aPrefixLength, size_t aAddr, const uint8_t *aMemory,
+                       size_t aSize)
+{
+    char * ch     = aLine + aPrefixLength;
+    size_t digits = 4;
+
+    memcpy(aLine, aPrefix, aPrefixLength);
+    *ch++ = ':';
+    *ch++ = ' ';
+
+    while (digits < sizeof(aAddr) * 2 && (aAddr >> (digits * 4)) != 0)
+    {
+        digits++;
+    }
+
+    while (digits > 0)
+    {
+        digits--;
+        *ch++ = kHexChars[(aAddr >> (digits * 4)) & 0x0f];
+    }
+
+    *ch++ = ':';
+
+    for (size_t i = 0; i < aSize; i++)
+    {
+        *ch++ = ' ';
+        *ch++ = kHexPairs[aMemory[i] * 2];
+        *ch++ = kHexPairs[aMemory[i] * 2 + 1];
+    }
+
+    return static_cast<size_t>(ch - aLine);
+}
+
+/** Write hex dump lines of memory logged at address aAddr
+ *
+ * The lines are encoded into a buffer, which is written to the file at once, instead of formatting each line.
+ */
+static void DumpLines(int r, int aLevel, const char *aPrefix, int aAddr, const uint8_t *aMemory, size_t aSize,
+                      unsigned long aTime)
+{
+    char   buffer[kDumpBufferSize];
+    size_t prefixLength = strnlen(aPrefix, kDumpMaxPrefix);
+    size_t lineSize     = prefixLength + sizeof(": ffffffffffffffff:") + 16 * 3 + 1;
+    size_t length       = 0;
+
+    /* break hex dumps into 16byte lines
+     * In the form ADDR: XX XX XX XX ...
+     */
+    for (size_t offset = 0; offset < aSize; offset += 16)
+    {
+        size_t lineLength;
+
+        lineLength = DumpLine(buffer + length, aPrefix, prefixLength, static_cast<size_t>(aAddr) + offset,
+                              aMemory + offset, aSize - offset < 16 ? aSize - offset : 16);
 
         if (r & LOGFLAG_syslog)
         {
-            syslog(aLevel, "%s: %04x: %s", aPrefix, addr, hex);
+            SyslogWrite(r, aLevel, buffer + length, lineLength);
         }
-        if (r & LOGFLAG_file)
+
+        length += lineLength;
+        buffer[length++] = '\n';
+
+        if ((r & LOGFLAG_file) && (length + lineSize >= sizeof(buffer) || offset + 16 >= aSize))
         {
-            LogPrintf("%s: %04x: %s\n", aPrefix, addr, hex);
+            buffer[length] = 0;
+            LogStringAt(buffer, aTime);
+            length = 0;
+        }
+        else if (!(r & LOGFLAG_file))
+        {
+            length = 0;
         }
     }
 }
 
+/** Scan the conversion specification following a '%', returning the end of it */
+static const char *ScanSpec(const char *aSpec, LogSpec &aResult)
+{
+    const char *cp = aSpec + strspn(aSpec, "-+ #0");
+
+    aResult.mType          = kArgInt;
+    aResult.mStars         = 0;
+    aResult.mStarPrecision = false;
+    aResult.mPrecision     = -1;
+    aResult.mValid         = true;
+
+    if (*cp == '*')
+    {
+        aResult.mStars++;
+        cp++;
+    }
+    else
+    {
+        cp += strspn(cp, "0123456789");
+    }
+
+    if (*cp == '.')
+    {
+        cp++;
+
+        if (*cp == '*')
+        {
+            aResult.mStars++;
+            aResult.mStarPrecision = true;
+            cp++;
+        }
+        else
+        {
+            aResult.mPrecision = atoi(cp);
+            cp += strspn(cp, "0123456789");
+        }
+    }
+
+    switch (*cp)
+    {
+    case 'h':
+        cp += (cp[1] == 'h') ? 2 : 1;
+        break;
+    case 'l':
+        aResult.mType = (cp[1] == 'l') ? kArgLongLong : kArgLong;
+        cp += (cp[1] == 'l') ? 2 : 1;
+        break;
+    case 'z':
+        aResult.mType = kArgSize;
+        cp++;
+        break;
+    case 'j':
+        aResult.mType = kArgIntMax;
+        cp++;
+        break;
+    case 't':
+        aResult.mType = kArgPtrDiff;
+        cp++;
+        break;
+    case 'L':
+    case 'q':
+        aResult.mValid = false;
+        cp++;
+        break;
+    default:
+        break;
+    }
+
+    switch (*cp)
+    {
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        break;
+    case 'c':
+        aResult.mValid = aResult.mValid && aResult.mType == kArgInt;
+        break;
+    case 'a':
+    case 'A':
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+        aResult.mValid = aResult.mValid && (aResult.mType == kArgInt || aResult.mType == kArgLong);
+        aResult.mType  = kArgDouble;
+        break;
+    case 'p':
+        aResult.mValid = aResult.mValid && aResult.mType == kArgInt;
+        aResult.mType  = kArgPointer;
+        break;
+    case 's':
+        aResult.mValid = aResult.mValid && aResult.mType == kArgInt;
+        aResult.mType  = kArgString;
+        break;
+    default:
+        /* %n and unknown conversions */
+        aResult.mValid = false;
+        break;
+    }
+
+    if (*cp != 0)
+    {
+        cp++;
+    }
+
+    return cp;
+}
+
+/** Copy the raw arguments of a format string to the record, false if they cannot be recorded */
+static bool RingRecordArgs(LogRecord &aRecord, const char *aFormat, va_list aArgs)
+{
+    bool ok = true;
+
+    aRecord.mArgCount   = 0;
+    aRecord.mDataLength = 0;
+
+    for (const char *cp = strchr(aFormat, '%'); ok && cp != NULL; cp = strchr(cp, '%'))
+    {
+        LogSpec spec;
+        int     precision;
+
+        if (cp[1] == '%')
+        {
+            cp += 2;
+            continue;
+        }
+
+        cp = ScanSpec(cp + 1, spec);
+        ok = spec.mValid && aRecord.mArgCount + spec.mStars + 1 <= kRingMaxArgs;
+
+        if (!ok)
+        {
+            break;
+        }
+
+        precision = spec.mPrecision;
+
+        for (uint8_t i = 0; i < spec.mStars; i++)
+        {
+            int star = va_arg(aArgs, int);
+
+            if (spec.mStarPrecision && i + 1 == spec.mStars)
+            {
+                precision = star;
+            }
+
+            aRecord.mArgTypes[aRecord.mArgCount]    = kArgInt;
+            aRecord.mArgs[aRecord.mArgCount++].mInt = star;
+        }
+
+        LogValue &value = aRecord.mArgs[aRecord.mArgCount];
+
+        aRecord.mArgTypes[aRecord.mArgCount++] = static_cast<uint8_t>(spec.mType);
+
+        switch (spec.mType)
+        {
+        case kArgInt:
+            value.mInt = va_arg(aArgs, int);
+            break;
+        case kArgLong:
+            value.mInt = va_arg(aArgs, long);
+            break;
+        case kArgLongLong:
+            value.mInt = va_arg(aArgs, long long);
+            break;
+        case kArgSize:
+            value.mInt = static_cast<long long>(va_arg(aArgs, size_t));
+            break;
+        case kArgIntMax:
+            value.mInt = va_arg(aArgs, intmax_t);
+            break;
+        case kArgPtrDiff:
+            value.mInt = va_arg(aArgs, ptrdiff_t);
+            break;
+        case kArgDouble:
+            value.mDouble = va_arg(aArgs, double);
+            break;
+        case kArgPointer:
+            value.mPointer = va_arg(aArgs, const void *);
+            break;
+        case kArgString:
+        {
+            const char *string = va_arg(aArgs, const char *);
+            size_t      room   = sizeof(aRecord.mData) - aRecord.mDataLength;
+            size_t      length;
+
+            ok = (room > 0);
+
+            if (!ok)
+            {
+                break;
+            }
+
+            if (string == NULL)
+            {
+                string = "(null)";
+            }
+
+            /* strings too long are truncated, and never read beyond the precision */
+            if (precision >= 0 && static_cast<size_t>(precision) < room - 1)
+            {
+                room = static_cast<size_t>(precision) + 1;
+            }
+
+            length = strnlen(string, room - 1);
+            memcpy(aRecord.mData + aRecord.mDataLength, string, length);
+            value.mInt = aRecord.mDataLength;
+            aRecord.mDataLength += length;
+            aRecord.mData[aRecord.mDataLength++] = 0;
+            break;
+        }
+        }
+    }
+
+    return ok;
+}
+
+/** Claim a free slot of the ring, NULL if full */
+static LogRecord *RingClaim(unsigned long &aPosition)
+{
+    LogRecord *   record = NULL;
+    unsigned long head   = __atomic_load_n(&sRingHead, __ATOMIC_RELAXED);
+
+    for (;;)
+    {
+        LogRecord &   slot     = sRing[head & (kRingSlots - 1)];
+        unsigned long sequence = __atomic_load_n(&slot.mSequence, __ATOMIC_ACQUIRE);
+        long          diff     = static_cast<long>(sequence - head);
+
+        if (diff == 0)
+        {
+            /* head is reloaded if another producer claimed the slot first */
+            if (__atomic_compare_exchange_n(&sRingHead, &head, head + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                record    = &slot;
+                aPosition = head;
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* the slot is not drained yet, the ring is full */
+            __atomic_fetch_add(&sRingDropped, 1, __ATOMIC_RELAXED);
+            break;
+        }
+        else
+        {
+            head = __atomic_load_n(&sRingHead, __ATOMIC_RELAXED);
+        }
+    }
+
+    return record;
+}
+
+/** Publish a filled slot to the drain */
+static void RingPublish(LogRecord &aRecord, unsigned long aPosition)
+{
+    __atomic_store_n(&aRecord.mSequence, aPosition + 1, __ATOMIC_RELEASE);
+}
+
+/** Record a log to the ring */
+static void RingRecordLog(int aLevel, const char *aFormat, va_list ap)
+{
+    unsigned long position;
+    LogRecord *   record = RingClaim(position);
+    va_list       cpy;
+
+    if (record == NULL)
+    {
+        return;
+    }
+
+    record->mFormat = aFormat;
+    record->mTime   = GetMsecsNow();
+    record->mLevel  = aLevel;
+
+    va_copy(cpy, ap);
+
+    if (!RingRecordArgs(*record, aFormat, cpy))
+    {
+        /* formatted at once if the arguments cannot be recorded */
+        vsnprintf(record->mData, sizeof(record->mData), aFormat, ap);
+        record->mFormat       = "%s";
+        record->mArgCount     = 1;
+        record->mArgTypes[0]  = kArgString;
+        record->mArgs[0].mInt = 0;
+    }
+
+    va_end(cpy);
+
+    RingPublish(*record, position);
+}
+
+/** Claim aCount consecutive free slots of the ring, NULL if full */
+static LogRecord *RingClaimRun(unsigned long &aPosition, size_t aCount)
+{
+    unsigned long head = __atomic_load_n(&sRingHead, __ATOMIC_RELAXED);
+
+    for (;;)
+    {
+        size_t free = 0;
+
+        /* slots past the head are only claimed by moving the head past them */
+        while (free < aCount && __atomic_load_n(&sRing[(head + free) & (kRingSlots - 1)].mSequence,
+                                                __ATOMIC_ACQUIRE) == head + free)
+        {
+            free++;
+        }
+
+        if (free < aCount)
+        {
+            unsigned long current = __atomic_load_n(&sRingHead, __ATOMIC_RELAXED);
+
+            if (current == head)
+            {
+                /* a slot is not drained yet, the ring is full */
+                __atomic_fetch_add(&sRingDropped, 1, __ATOMIC_RELAXED);
+                return NULL;
+            }
+
+            head = current;
+        }
+        else if (__atomic_compare_exchange_n(&sRingHead, &head, head + aCount, true, __ATOMIC_RELAXED,
+                                             __ATOMIC_RELAXED))
+        {
+            aPosition = head;
+            return &sRing[head & (kRingSlots - 1)];
+        }
+    }
+}
+
+/** Record a memory dump to the ring, in one record of consecutive slots for dumps of up to kRingMaxDumpSlots */
+static void RingRecordDump(int aLevel, const char *aPrefix, const uint8_t *aMemory, size_t aSize)
+{
+    size_t prefixLength = strnlen(aPrefix, kDumpMaxPrefix);
+    size_t first        = (kRingDataSize - prefixLength - 1) / 16 * 16;
+    size_t maxSize      = first + (kRingMaxDumpSlots - 1) * kRingDataSize / 16 * 16;
+
+    for (size_t offset = 0; offset < aSize; offset += maxSize)
+    {
+        unsigned long position;
+        size_t        length = (aSize - offset < maxSize) ? aSize - offset : maxSize;
+        size_t        slots  = 1 + (length > first ? (length - first + kRingDataSize - 1) / kRingDataSize : 0);
+        LogRecord *   record = RingClaimRun(position, slots);
+        size_t        copied;
+
+        if (record == NULL)
+        {
+            break;
+        }
+
+        record->mFormat       = NULL;
+        record->mTime         = GetMsecsNow();
+        record->mLevel        = aLevel;
+        record->mArgs[0].mInt = static_cast<long long>(offset);
+        record->mArgs[1].mInt = static_cast<long long>(length);
+        record->mArgs[2].mInt = static_cast<long long>(slots);
+        memcpy(record->mData, aPrefix, prefixLength);
+        record->mData[prefixLength] = 0;
+        copied                      = length < first ? length : first;
+        memcpy(record->mData + prefixLength + 1, aMemory + offset, copied);
+
+        /* the continuation slots are published first, so the drain finds them once the first one is published */
+        for (size_t i = 1; i < slots; i++)
+        {
+            LogRecord &slot = sRing[(position + i) & (kRingSlots - 1)];
+            size_t     size = (length - copied < kRingDataSize) ? length - copied : static_cast<size_t>(kRingDataSize);
+
+            memcpy(slot.mData, aMemory + offset + copied, size);
+            copied += size;
+            RingPublish(slot, position + i);
+        }
+
+        RingPublish(*record, position);
+    }
+}
+
+/** Format one recorded argument with its conversion specification */
+static int RingFormatArg(char *          aBuffer,
+                         size_t          aSize,
+                         const char *    aSpec,
+                         const int *     aStars,
+                         uint8_t         aStarCount,
+                         uint8_t         aType,
+                         const LogValue &aValue,
+                         const char *    aData)
+{
+#define LOG_FORMAT_ARG(aArg)                                                                 \
+    (aStarCount == 0 ? snprintf(aBuffer, aSize, aSpec, aArg)                                 \
+                     : aStarCount == 1 ? snprintf(aBuffer, aSize, aSpec, aStars[0], aArg)    \
+                                       : snprintf(aBuffer, aSize, aSpec, aStars[0], aStars[1], aArg))
+
+    int rval = 0;
+
+    switch (aType)
+    {
+    case kArgInt:
+        rval = LOG_FORMAT_ARG(static_cast<int>(aValue.mInt));
+        break;
+    case kArgLong:
+        rval = LOG_FORMAT_ARG(static_cast<long>(aValue.mInt));
+        break;
+    case kArgLongLong:
+        rval = LOG_FORMAT_ARG(aValue.mInt);
+        break;
+    case kArgSize:
+        rval = LOG_FORMAT_ARG(static_cast<size_t>(aValue.mInt));
+        break;
+    case kArgIntMax:
+        rval = LOG_FORMAT_ARG(static_cast<intmax_t>(aValue.mInt));
+        break;
+    case kArgPtrDiff:
+        rval = LOG_FORMAT_ARG(static_cast<ptrdiff_t>(aValue.mInt));
+        break;
+    case kArgDouble:
+        rval = LOG_FORMAT_ARG(aValue.mDouble);
+        break;
+    case kArgPointer:
+        rval = LOG_FORMAT_ARG(aValue.mPointer);
+        break;
+    case kArgString:
+        rval = LOG_FORMAT_ARG(aData + aValue.mInt);
+        break;
+    default:
+        break;
+    }
+
+#undef LOG_FORMAT_ARG
+
+    return rval;
+}
+
+/** Format a recorded log */
+static void RingFormat(const LogRecord &aRecord, char *aBuffer, size_t aSize)
+{
+    const char *cp     = aRecord.mFormat;
+    size_t      length = 0;
+    uint8_t     arg    = 0;
+
+    while (*cp != 0 && length + 1 < aSize)
+    {
+        const char *next    = strchr(cp, '%');
+        size_t      literal = (next != NULL) ? static_cast<size_t>(next - cp) : strlen(cp);
+        LogSpec     spec;
+        char        format[kRingMaxSpec];
+        int         stars[2] = {0, 0};
+        const char *end;
+        int         rval;
+
+        if (literal > aSize - length - 1)
+        {
+            literal = aSize - length - 1;
+        }
+
+        memcpy(aBuffer + length, cp, literal);
+        length += literal;
+        cp += literal;
+
+        if (*cp != '%' || length + 1 >= aSize)
+        {
+            break;
+        }
+
+        if (cp[1] == '%')
+        {
+            aBuffer[length++] = '%';
+            cp += 2;
+            continue;
+        }
+
+        end = ScanSpec(cp + 1, spec);
+
+        /* recorded specifications are valid */
+        if (static_cast<size_t>(end - cp) >= sizeof(format) || arg + spec.mStars + 1 > aRecord.mArgCount)
+        {
+            break;
+        }
+
+        memcpy(format, cp, static_cast<size_t>(end - cp));
+        format[end - cp] = 0;
+
+        for (uint8_t i = 0; i < spec.mStars; i++)
+        {
+            stars[i] = static_cast<int>(aRecord.mArgs[arg++].mInt);
+        }
+
+        rval = RingFormatArg(aBuffer + length, aSize - length, format, stars, spec.mStars, aRecord.mArgTypes[arg],
+                             aRecord.mArgs[arg], aRecord.mData);
+        arg++;
+
+        if (rval > 0)
+        {
+            length += (static_cast<size_t>(rval) < aSize - length) ? static_cast<size_t>(rval) : aSize - length - 1;
+        }
+
+        cp = end;
+    }
+
+    aBuffer[length] = 0;
+}
+
+/** Write a recorded log or memory dump at ring position aPosition, returning the number of its slots */
+static size_t RingEmit(const LogRecord &aRecord, unsigned long aPosition)
+{
+    int    r     = LogCheck(aRecord.mLevel) | LOGFLAG_batch;
+    size_t slots = aRecord.mFormat == NULL ? static_cast<size_t>(aRecord.mArgs[2].mInt) : 1;
+
+    if (r == LOGFLAG_batch)
+    {
+        return slots;
+    }
+
+    if (aRecord.mFormat == NULL)
+    {
+        uint8_t        memory[kRingMaxDumpSlots * kRingDataSize];
+        size_t         prefixLength = strlen(aRecord.mData);
+        size_t         length       = static_cast<size_t>(aRecord.mArgs[1].mInt);
+        size_t         first        = (kRingDataSize - prefixLength - 1) / 16 * 16;
+        const uint8_t *data         = reinterpret_cast<const uint8_t *>(aRecord.mData + prefixLength + 1);
+
+        /* the memory continued by the next slots is gathered to be encoded at once */
+        if (slots > 1)
+        {
+            memcpy(memory, data, first);
+
+            for (size_t i = 1, copied = first; i < slots; i++)
+            {
+                size_t size = (length - copied < kRingDataSize) ? length - copied : static_cast<size_t>(kRingDataSize);
+
+                memcpy(memory + copied, sRing[(aPosition + i) & (kRingSlots - 1)].mData, size);
+                copied += size;
+            }
+
+            data = memory;
+        }
+
+        DumpLines(r, aRecord.mLevel, aRecord.mData, static_cast<int>(aRecord.mArgs[0].mInt), data, length,
+                  aRecord.mTime);
+    }
+    else
+    {
+        char   buf[1024];
+        size_t length;
+
+        /* room is left for the NEWLINE of the file */
+        RingFormat(aRecord, buf, sizeof(buf) - 1);
+
+        if (r & LOGFLAG_syslog)
+        {
+            SyslogWrite(r, aRecord.mLevel, buf, strlen(buf));
+        }
+
+        if (r & LOGFLAG_file)
+        {
+            length          = strlen(buf);
+            buf[length]     = '\n';
+            buf[length + 1] = 0;
+            LogStringAt(buf, aRecord.mTime);
+        }
+    }
+
+    return slots;
+}
+
+/** Write all published records of the ring, in order */
+static void RingDrain(void)
+{
+    unsigned long dropped;
+
+    pthread_mutex_lock(&sRingLock);
+
+    for (;;)
+    {
+        LogRecord &record = sRing[sRingTail & (kRingSlots - 1)];
+
+        if (__atomic_load_n(&record.mSequence, __ATOMIC_ACQUIRE) != sRingTail + 1)
+        {
+            break;
+        }
+
+        for (size_t slots = RingEmit(record, sRingTail); slots > 0; slots--)
+        {
+            __atomic_store_n(&sRing[sRingTail & (kRingSlots - 1)].mSequence, sRingTail + kRingSlots, __ATOMIC_RELEASE);
+            sRingTail++;
+        }
+    }
+
+    dropped = __atomic_exchange_n(&sRingDropped, 0, __ATOMIC_RELAXED);
+
+    if (dropped > 0)
+    {
+        int r = LogCheck(LOG_WARNING);
+
+        if (r & LOGFLAG_file)
+        {
+            LogPrintf("%lu log records dropped\n", dropped);
+        }
+
+        if (r & LOGFLAG_syslog)
+        {
+            char   message[64];
+            size_t length = static_cast<size_t>(snprintf(message, sizeof(message), "%lu log records dropped", dropped));
+
+            SyslogWrite(r | LOGFLAG_batch, LOG_WARNING, message, length);
+        }
+    }
+
+    if (sSyslogBatchCount > 0)
+    {
+        SyslogFlush();
+    }
+
+    pthread_mutex_unlock(&sRingLock);
+}
+
+static void *RingThread(void *aContext)
+{
+    const timespec delay = {0, kRingDrainInterval * 1000000L};
+
+    (void)aContext;
+
+    while (!__atomic_load_n(&sRingStopping, __ATOMIC_ACQUIRE))
+    {
+        RingDrain();
+        nanosleep(&delay, NULL);
+    }
+
+    return NULL;
+}
+
+otbrError otbrLogRingStart(bool aBackground)
+{
+    otbrError error = OTBR_ERROR_NONE;
+
+    if (sRingEnabled)
+    {
+        return error;
+    }
+
+    for (unsigned long i = 0; i < kRingSlots; i++)
+    {
+        sRing[i].mSequence = i;
+    }
+
+    sRingHead     = 0;
+    sRingTail     = 0;
+    sRingDropped  = 0;
+    sRingStopping = false;
+    __atomic_store_n(&sRingEnabled, true, __ATOMIC_RELEASE);
+
+    if (aBackground)
+    {
+        int rval = pthread_create(&sRingThread, NULL, RingThread, NULL);
+
+        if (rval != 0)
+        {
+            __atomic_store_n(&sRingEnabled, false, __ATOMIC_RELEASE);
+            errno = rval;
+            error = OTBR_ERROR_ERRNO;
+        }
+        else
+        {
+            sRingThreadStarted = true;
+        }
+    }
+
+    return error;
+}
+
+void otbrLogRingStop(void)
+{
+    if (!sRingEnabled)
+    {
+        return;
+    }
+
+    __atomic_store_n(&sRingEnabled, false, __ATOMIC_RELEASE);
+
+    if (sRingThreadStarted)
+    {
+        __atomic_store_n(&sRingStopping, true, __ATOMIC_RELEASE);
+        pthread_join(sRingThread, NULL);
+        sRingThreadStarted = false;
+    }
+
+    RingDrain();
+}
+
+/** Rename the log file with suffix ".1" and start a new one */
+static void FileRotate(void)
+{
+    char rotated[PATH_MAX + 2];
+
+    snprintf(rotated, sizeof(rotated), "%s.1", sLogFilename);
+
+    if (rename(sLogFilename, rotated) != 0 || freopen(sLogFilename, "w", sLogFp) == NULL)
+    {
+        /* keep writing to the current file */
+        perror(sLogFilename);
+        clearerr(sLogFp);
+    }
+
+    sFileSize = 0;
+}
+
+static void *FileThread(void *aContext)
+{
+    (void)aContext;
+
+    pthread_mutex_lock(&sFileLock);
+
+    for (;;)
+    {
+        char *        data;
+        size_t        length;
+        unsigned long dropped;
+
+        while (sFileLength == 0 && sFileDropped == 0 && !sFileStopping)
+        {
+            pthread_cond_wait(&sFileReady, &sFileLock);
+        }
+
+        if (sFileLength == 0 && sFileDropped == 0)
+        {
+            break;
+        }
+
+        data         = sFileBuffer;
+        length       = sFileLength;
+        dropped      = sFileDropped;
+        sFileBuffer  = sFileSpare;
+        sFileSpare   = data;
+        sFileLength  = 0;
+        sFileDropped = 0;
+        sFileWriting = true;
+
+        pthread_mutex_unlock(&sFileLock);
+
+        if (dropped > 0)
+        {
+            sFileSize += static_cast<size_t>(fprintf(sLogFp, "%lu log writes dropped\n", dropped));
+        }
+
+        sFileSize += fwrite(data, 1, length, sLogFp);
+        fflush(sLogFp);
+
+        if (sFileMaxSize != 0 && sFileSize >= sFileMaxSize)
+        {
+            FileRotate();
+        }
+
+        pthread_mutex_lock(&sFileLock);
+        sFileWriting = false;
+        pthread_cond_broadcast(&sFileDone);
+    }
+
+    pthread_mutex_unlock(&sFileLock);
+
+    return NULL;
+}
+
+/** Wait until the file writer wrote everything appended so far */
+static void FileFlush(void)
+{
+    pthread_mutex_lock(&sFileLock);
+
+    if (sFileWriter)
+    {
+        pthread_cond_signal(&sFileReady);
+
+        while (sFileLength > 0 || sFileDropped > 0 || sFileWriting)
+        {
+            pthread_cond_wait(&sFileDone, &sFileLock);
+        }
+    }
+
+    pthread_mutex_unlock(&sFileLock);
+}
+
+otbrError otbrLogStartFileWriter(size_t aBufferSize, size_t aMaxFileSize)
+{
+    otbrError error = OTBR_ERROR_NONE;
+    int       rval;
+
+    if (sLogFp == NULL || sFileWriter)
+    {
+        errno = EINVAL;
+        return OTBR_ERROR_ERRNO;
+    }
+
+    sFileBuffer = static_cast<char *>(malloc(aBufferSize));
+    sFileSpare  = static_cast<char *>(malloc(aBufferSize));
+
+    if (sFileBuffer == NULL || sFileSpare == NULL)
+    {
+        errno = ENOMEM;
+        error = OTBR_ERROR_ERRNO;
+        goto exit;
+    }
+
+    fflush(sLogFp);
+
+    sFileBufferSize = aBufferSize;
+    sFileLength     = 0;
+    sFileDropped    = 0;
+    sFileWriting    = false;
+    sFileStopping   = false;
+    sFileSize       = static_cast<size_t>(ftell(sLogFp));
+    sFileMaxSize    = aMaxFileSize;
+
+    rval = pthread_create(&sFileThread, NULL, FileThread, NULL);
+
+    if (rval != 0)
+    {
+        errno = rval;
+        error = OTBR_ERROR_ERRNO;
+        goto exit;
+    }
+
+    pthread_mutex_lock(&sFileLock);
+    sFileWriter = true;
+    pthread_mutex_unlock(&sFileLock);
+
+exit:
+    if (error != OTBR_ERROR_NONE)
+    {
+        free(sFileBuffer);
+        free(sFileSpare);
+        sFileBuffer = NULL;
+        sFileSpare  = NULL;
+    }
+
+    return error;
+}
+
+void otbrLogStopFileWriter(void)
+{
+    if (!sFileWriter)
+    {
+        return;
+    }
+
+    /* recorded logs go to the file writer before it stops */
+    otbrLogFlush();
+
+    pthread_mutex_lock(&sFileLock);
+    sFileStopping = true;
+    pthread_cond_signal(&sFileReady);
+    pthread_mutex_unlock(&sFileLock);
+
+    pthread_join(sFileThread, NULL);
+
+    /* anything appended since the writer exited is written here */
+    pthread_mutex_lock(&sFileLock);
+    fwrite(sFileBuffer, 1, sFileLength, sLogFp);
+    fflush(sLogFp);
+    sFileWriter = false;
+    pthread_mutex_unlock(&sFileLock);
+
+    free(sFileBuffer);
+    free(sFileSpare);
+    sFileBuffer = NULL;
+    sFileSpare  = NULL;
+}
+
+void otbrLogFlush(void)
+{
+    if (__atomic_load_n(&sRingEnabled, __ATOMIC_ACQUIRE))
+    {
+        RingDrain();
+    }
+
+    FileFlush();
+}
+
+/** Initialize logging */
+void otbrLogInit(const char *aIdent, int aLevel)
+{
+    assert(aIdent);
+    assert(aLevel >= LOG_EMERG && aLevel <= LOG_DEBUG);
+
+    sMsecsStart = static_cast<unsigned long>(ot::BorderRouter::GetMonotonicNow());
+
+    /* only open the syslog once... */
+    if (!sSyslogOpened)
+    {
+        sSyslogOpened = true;
+
+        if (!SyslogOpen(aIdent))
+        {
+            openlog(aIdent, LOG_CONS | LOG_PID | LOG_PERROR, LOG_USER);
+        }
+    }
+    otbrLogSetLevel(aLevel);
+}
+
+/** log to the syslog or log file */
+void(otbrLog)(int aLevel, const char *aFormat, ...)
+{
+    va_list ap;
+
+    va_start(ap, aFormat);
+    otbrLogv(aLevel, aFormat, ap);
+    va_end(ap);
+}
+
+/** log to the syslog or log file */
+void otbrLogv(int aLevel, const char *aFormat, va_list ap)
+{
+    int r;
+
+    assert(aFormat);
+
+    r = LogCheck(aLevel);
+
+    if (r != 0 && __atomic_load_n(&sRingEnabled, __ATOMIC_ACQUIRE))
+    {
+        RingRecordLog(aLevel, aFormat, ap);
+        goto exit;
+    }
+
+    if (r & LOGFLAG_file)
+    {
+        va_list cpy;
+        va_copy(cpy, ap);
+        LogVprintLine(aFormat, cpy);
+        va_end(cpy);
+    }
+
+    if (r & LOGFLAG_syslog)
+    {
+        SyslogVprintf(aLevel, aFormat, ap);
+    }
+
+exit:
+    /* nothing logged before a fatal error is left in memory */
+    if (r != 0 && aLevel <= OTBR_LOG_CRIT)
+    {
+        otbrLogFlush();
+    }
+}
+
+void(otbrLogRateLimited)(otbrLogLimit &aLimit,
+                         unsigned int  aBurst,
+                         unsigned int  aInterval,
+                         int           aLevel,
+                         const char *  aFormat,
+                         ...)
+{
+    unsigned long now;
+    va_list       ap;
+
+    if (LogCheck(aLevel) == 0)
+    {
+        return;
+    }
+
+    now = GetMsecsNow();
+
+    if (now - aLimit.mWindowStart >= aInterval)
+    {
+        if (aLimit.mSuppressed > 0)
+        {
+            (otbrLog)(aLevel, "%lu logs like \"%s\" suppressed", aLimit.mSuppressed, aFormat);
+            aLimit.mSuppressed = 0;
+        }
+
+        aLimit.mWindowStart = now;
+        aLimit.mCount       = 0;
+    }
+
+    if (aLimit.mCount >= aBurst)
+    {
+        aLimit.mSuppressed++;
+        return;
+    }
+
+    aLimit.mCount++;
+
+    va_start(ap, aFormat);
+    otbrLogv(aLevel, aFormat, ap);
+    va_end(ap);
+}
+
+void(otbrLogSampled)(otbrLogLimit &aLimit, unsigned int aRate, int aLevel, const char *aFormat, ...)
+{
+    va_list ap;
+
+    if (LogCheck(aLevel) == 0)
+    {
+        return;
+    }
+
+    if (aLimit.mCount++ % aRate != 0)
+    {
+        aLimit.mSuppressed++;
+        return;
+    }
+
+    va_start(ap, aFormat);
+    otbrLogv(aLevel, aFormat, ap);
+    va_end(ap);
+}
+
+/** Hex dump data to the log */
+void(otbrDump)(int aLevel, const char *aPrefix, const void *aMemory, size_t aSize)
+{
+    assert(aPrefix && (aMemory || aSize == 0));
+    int r;
+
+    r = LogCheck(aLevel);
+    if (r == 0)
+    {
+        return;
+    }
+
+    if (__atomic_load_n(&sRingEnabled, __ATOMIC_ACQUIRE))
+    {
+        RingRecordDump(aLevel, aPrefix, static_cast<const uint8_t *>(aMemory), aSize);
+        return;
+    }
+
+    DumpLines(r, aLevel, aPrefix, 0, static_cast<const uint8_t *>(aMemory), aSize, GetMsecsNow());
+}
+
 const char *otbrErrorString(otbrError aError)
 {
     const char *error = NULL;
@@ -321,6 +1844,9 @@ const char *otbrErrorString(otbrError aError)
 
 void otbrLogDeinit(void)
 {
+    otbrLogRingStop();
+    otbrLogStopFileWriter();
     sSyslogOpened = false;
+    SyslogClose();
     closelog();
 }
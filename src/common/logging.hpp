@@ -49,9 +49,50 @@ enum
     OTBR_LOG_DEBUG,   /* debug-level messages */
 };
 
+/**
+ * The most verbose log level compiled in. otbrLog() and otbrDump() calls at a more verbose level compile to nothing,
+ * their arguments are not evaluated.
+ *
+ */
+#ifndef OTBR_LOG_LEVEL_MAX
+#define OTBR_LOG_LEVEL_MAX OTBR_LOG_DEBUG
+#endif
+
+/**
+ * Modules with a log level of their own.
+ *
+ */
+enum
+{
+    OTBR_LOG_MODULE_DEFAULT,      /* code not in a module below */
+    OTBR_LOG_MODULE_BORDER_AGENT, /* border agent and agent instances */
+    OTBR_LOG_MODULE_COAP,         /* CoAP agents */
+    OTBR_LOG_MODULE_DTLS,         /* DTLS service, including the debug messages of mbedtls */
+    OTBR_LOG_MODULE_MDNS,         /* mDNS publishers */
+    OTBR_LOG_MODULE_NCP,          /* NCP controllers */
+    OTBR_LOG_MODULE_WEB,          /* web service */
+    OTBR_LOG_MODULE_COUNT,
+};
+
+/**
+ * The module of the logs of a source file. Files of a module define it before including any header.
+ *
+ */
+#ifndef OTBR_LOG_MODULE
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_DEFAULT
+#endif
+
+/**
+ * The log level of each module, indexed by module. Only written by otbrLogSetLevel() and otbrLogSetModuleLevel().
+ *
+ */
+extern int otbrLogModuleLevels[OTBR_LOG_MODULE_COUNT];
+
 /**
  * Change the log level
  *
+ * Modules without a level of their own follow it.
+ *
  * @param[in]   alevel  new log level
  */
 
@@ -62,6 +103,55 @@ void otbrLogSetLevel(int aLevel);
  */
 int otbrLogGetLevel(void);
 
+/**
+ * This function sets the log level of a module, so that one module can log verbosely without the others.
+ *
+ * @param[in]   aModule     The module.
+ * @param[in]   aLevel      The log level of the module, -1 to follow the level of otbrLogSetLevel().
+ *
+ */
+void otbrLogSetModuleLevel(int aModule, int aLevel);
+
+/**
+ * This function returns the log level of a module.
+ *
+ * @param[in]   aModule     The module.
+ *
+ * @returns The log level the module logs at.
+ *
+ */
+int otbrLogGetModuleLevel(int aModule);
+
+/**
+ * This function returns whether a module has a log level of its own.
+ *
+ * @param[in]   aModule     The module.
+ *
+ * @returns Whether the level of the module was set by otbrLogSetModuleLevel().
+ *
+ */
+bool otbrLogIsModuleLevelSet(int aModule);
+
+/**
+ * This function returns the name of a module, e.g. "dtls".
+ *
+ * @param[in]   aModule     The module.
+ *
+ * @returns A pointer to the name of the module.
+ *
+ */
+const char *otbrLogGetModuleName(int aModule);
+
+/**
+ * This function finds a module by name.
+ *
+ * @param[in]   aName       A pointer to the name of the module.
+ *
+ * @returns The module, -1 if no module has this name.
+ *
+ */
+int otbrLogFindModule(const char *aName);
+
 /**
  * Control log to syslog
  *
@@ -70,11 +160,22 @@ int otbrLogGetLevel(void);
  */
 void otbrLogEnableSyslog(bool aEnabled);
 
+/**
+ * This function sets the socket syslog records are sent to.
+ *
+ * Records are sent to the socket directly, after a header formatted once by otbrLogInit(), and only go through
+ * syslog() of libc if the socket cannot be connected. This function must be called before otbrLogInit().
+ *
+ * @param[in] aPath  A pointer to the path of the socket, "/dev/log" by default, which must stay valid.
+ *
+ */
+void otbrLogSetSyslogPath(const char *aPath);
+
 /**
  * This function causes logs to be written to a specific file
  * Note: Logs are still written to the syslog.
  *
- * @param[in] afilename filename to use for private logfile.
+ * @param[in] afilename filename to use for private logfile, NULL to stop writing it.
  */
 void otbrLogSetFilename(const char *aFilename);
 
@@ -116,6 +217,137 @@ void otbrLogv(int aLevel, const char *aFormat, va_list);
  */
 void otbrDump(int aLevel, const char *aPrefix, const void *aMemory, size_t aSize);
 
+/*
+ * The level is checked before the call, so that calls above OTBR_LOG_LEVEL_MAX are optimized out, and calls above the
+ * level of the module cost one load, without evaluating their arguments. Both are expressions, to be usable as actions
+ * of VerifyOrExit().
+ */
+#define otbrLogEnabled(aLevel)      \
+    ((aLevel) <= OTBR_LOG_LEVEL_MAX && \
+     (aLevel) <= __atomic_load_n(&otbrLogModuleLevels[OTBR_LOG_MODULE], __ATOMIC_RELAXED))
+#define otbrLog(aLevel, ...) (otbrLogEnabled(aLevel) ? (otbrLog)((aLevel), __VA_ARGS__) : (void)0)
+#define otbrDump(aLevel, aPrefix, aMemory, aSize) \
+    (otbrLogEnabled(aLevel) ? (otbrDump)((aLevel), (aPrefix), (aMemory), (aSize)) : (void)0)
+
+/**
+ * This structure keeps the state of a rate-limited or sampled log site.
+ *
+ */
+struct otbrLogLimit
+{
+    unsigned long mWindowStart; ///< Milliseconds the current window started at.
+    unsigned int  mCount;       ///< Number of logs written in the current window, or calls since the last sample.
+    unsigned long mSuppressed;  ///< Number of logs suppressed since the last summary.
+};
+
+/**
+ * This function logs at level @p aLevel, at most @p aBurst times every @p aInterval milliseconds.
+ *
+ * Once a window with suppressed logs ends, the next log of the site is preceded by the number of logs suppressed.
+ *
+ * @param[inout]    aLimit      A reference to the state of the log site.
+ * @param[in]       aBurst      Max number of logs written in a window.
+ * @param[in]       aInterval   Length of a window in milliseconds.
+ * @param[in]       aLevel      Log level of the logger.
+ * @param[in]       aFormat     Format string as in printf.
+ *
+ */
+void otbrLogRateLimited(otbrLogLimit &aLimit,
+                        unsigned int  aBurst,
+                        unsigned int  aInterval,
+                        int           aLevel,
+                        const char *  aFormat,
+                        ...);
+
+/**
+ * This function logs at level @p aLevel, one of every @p aRate calls.
+ *
+ * The first call is written. As the rate is fixed, no summary of the suppressed logs is written.
+ *
+ * @param[inout]    aLimit      A reference to the state of the log site.
+ * @param[in]       aRate       Number of calls per log written.
+ * @param[in]       aLevel      Log level of the logger.
+ * @param[in]       aFormat     Format string as in printf.
+ *
+ */
+void otbrLogSampled(otbrLogLimit &aLimit, unsigned int aRate, int aLevel, const char *aFormat, ...);
+
+/*
+ * These keep the state of each call site in a static variable, so a site must only be reached from one thread.
+ */
+#define otbrLogRateLimited(aLevel, aBurst, aInterval, ...)                                 \
+    do                                                                                     \
+    {                                                                                      \
+        static otbrLogLimit sLogLimit;                                                     \
+                                                                                           \
+        if (otbrLogEnabled(aLevel))                                                        \
+        {                                                                                  \
+            (otbrLogRateLimited)(sLogLimit, (aBurst), (aInterval), (aLevel), __VA_ARGS__); \
+        }                                                                                  \
+    } while (false)
+
+#define otbrLogSampled(aLevel, aRate, ...)                               \
+    do                                                                   \
+    {                                                                    \
+        static otbrLogLimit sLogLimit;                                   \
+                                                                         \
+        if (otbrLogEnabled(aLevel))                                      \
+        {                                                                \
+            (otbrLogSampled)(sLogLimit, (aRate), (aLevel), __VA_ARGS__); \
+        }                                                                \
+    } while (false)
+
+/**
+ * This function starts recording logs to the log ring.
+ *
+ * While the ring is started, otbrLog() and otbrDump() only copy the format string pointer, the raw arguments,
+ * strings and dumped memory to a lock-free ring, and formatting is deferred to the drain. Format strings must
+ * therefore outlive the ring, which string literals do. Logs the ring has no room for are dropped and counted.
+ *
+ * @param[in]   aBackground     Whether to drain the ring from a background thread, otherwise it is only drained by
+ *                              otbrLogFlush() and otbrLogRingStop().
+ *
+ * @retval      OTBR_ERROR_NONE     Successfully started the ring.
+ * @retval      OTBR_ERROR_ERRNO    Failed to start the background thread, logs are not recorded.
+ *
+ */
+otbrError otbrLogRingStart(bool aBackground);
+
+/**
+ * This function drains the log ring and stops recording to it.
+ *
+ */
+void otbrLogRingStop(void);
+
+/**
+ * This function writes all logs recorded in the log ring, and waits until the file writer wrote them.
+ *
+ */
+void otbrLogFlush(void);
+
+/**
+ * This function starts writing the log file from a background thread.
+ *
+ * Logging threads only append lines to a memory buffer, which the background thread writes out. Lines the buffer has
+ * no room for are dropped and counted in the file. Logs at OTBR_LOG_CRIT or more severe, and otbrLogFlush(), wait
+ * until the buffer is written. This function must be called after otbrLogSetFilename().
+ *
+ * @param[in]   aBufferSize     Size of the buffer in bytes, twice of which is allocated.
+ * @param[in]   aMaxFileSize    Size in bytes a log file is rotated at, 0 for no rotation. The rotated file keeps the
+ *                              name with suffix ".1", replacing the previous one.
+ *
+ * @retval      OTBR_ERROR_NONE     Successfully started the writer.
+ * @retval      OTBR_ERROR_ERRNO    Failed to start the writer, the file is still written directly.
+ *
+ */
+otbrError otbrLogStartFileWriter(size_t aBufferSize, size_t aMaxFileSize);
+
+/**
+ * This function writes out the buffer of the file writer and stops it.
+ *
+ */
+void otbrLogStopFileWriter(void);
+
 /**
  * This function converts error code to string.
  *
@@ -0,0 +1,414 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the metrics registry.
+ */
+
+#include "common/metrics.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common/logging.hpp"
+#include "common/time.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Metrics {
+
+static Metric *     sFirst        = NULL;
+static unsigned int sNextShard    = 0;
+static __thread int sShard        = -1;
+static uint64_t     sLastDumpTime = 0;
+
+const char kExportContentType[] = "text/plain; version=0.0.4";
+
+Metric::Metric(const char *aName, Type aType)
+    : mName(aName)
+    , mType(aType)
+    , mNext(__atomic_load_n(&sFirst, __ATOMIC_RELAXED))
+{
+    // Metrics may be constructed concurrently once threads are running.
+    while (!__atomic_compare_exchange_n(&sFirst, &mNext, this, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+const Metric *Metric::GetFirst(void)
+{
+    return __atomic_load_n(&sFirst, __ATOMIC_ACQUIRE);
+}
+
+unsigned int Metric::GetShard(void)
+{
+    // Threads are spread over the shards in the order they first record.
+    if (sShard < 0)
+    {
+        sShard = static_cast<int>(__atomic_fetch_add(&sNextShard, 1, __ATOMIC_RELAXED) % kShards);
+    }
+
+    return static_cast<unsigned int>(sShard);
+}
+
+Counter::Counter(const char *aName)
+    : Metric(aName, kTypeCounter)
+    , mDumpedValue(0)
+{
+    memset(mShards, 0, sizeof(mShards));
+}
+
+uint64_t Counter::GetValue(void) const
+{
+    uint64_t value = 0;
+
+    for (unsigned int i = 0; i < kShards; ++i)
+    {
+        value += __atomic_load_n(&mShards[i].mValue, __ATOMIC_RELAXED);
+    }
+
+    return value;
+}
+
+Gauge::Gauge(const char *aName)
+    : Metric(aName, kTypeGauge)
+{
+    memset(mShards, 0, sizeof(mShards));
+}
+
+int64_t Gauge::GetValue(void) const
+{
+    int64_t value = 0;
+
+    for (unsigned int i = 0; i < kShards; ++i)
+    {
+        value += __atomic_load_n(&mShards[i].mValue, __ATOMIC_RELAXED);
+    }
+
+    return value;
+}
+
+Memory::Memory(const char *aName)
+    : Metric(aName, kTypeMemory)
+    , mBytes(0)
+    , mPeak(0)
+    , mBlocks(0)
+{
+}
+
+void Memory::Allocate(size_t aSize)
+{
+    uint64_t bytes = __atomic_add_fetch(&mBytes, static_cast<uint64_t>(aSize), __ATOMIC_RELAXED);
+    uint64_t peak  = __atomic_load_n(&mPeak, __ATOMIC_RELAXED);
+
+    __atomic_add_fetch(&mBlocks, 1, __ATOMIC_RELAXED);
+
+    while (bytes > peak && !__atomic_compare_exchange_n(&mPeak, &peak, bytes, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+void Memory::Free(size_t aSize)
+{
+    __atomic_sub_fetch(&mBytes, static_cast<uint64_t>(aSize), __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&mBlocks, 1, __ATOMIC_RELAXED);
+}
+
+Histogram::Histogram(const char *aName)
+    : Metric(aName, kTypeHistogram)
+{
+    memset(mShards, 0, sizeof(mShards));
+}
+
+unsigned int Histogram::GetBucket(uint64_t aValue)
+{
+    unsigned int bucket;
+
+    if (aValue < kSubBuckets)
+    {
+        bucket = static_cast<unsigned int>(aValue);
+    }
+    else if (aValue >> kMaxBits)
+    {
+        bucket = kBuckets - 1;
+    }
+    else
+    {
+        // The highest bit selects the power of two, the next kSubBucketBits bits the bucket within it.
+        unsigned int magnitude = 63 - static_cast<unsigned int>(__builtin_clzll(aValue));
+
+        bucket = (magnitude - kSubBucketBits + 1) * kSubBuckets +
+                 static_cast<unsigned int>((aValue >> (magnitude - kSubBucketBits)) & (kSubBuckets - 1));
+    }
+
+    return bucket;
+}
+
+uint64_t Histogram::GetBucketLowest(unsigned int aBucket)
+{
+    uint64_t lowest;
+
+    if (aBucket < kSubBuckets)
+    {
+        lowest = aBucket;
+    }
+    else
+    {
+        unsigned int magnitude = aBucket / kSubBuckets + kSubBucketBits - 1;
+
+        lowest = static_cast<uint64_t>(kSubBuckets + aBucket % kSubBuckets) << (magnitude - kSubBucketBits);
+    }
+
+    return lowest;
+}
+
+void Histogram::Record(uint64_t aValue)
+{
+    Shard &shard = mShards[GetShard()];
+
+    __atomic_fetch_add(&shard.mCounts[GetBucket(aValue)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&shard.mSum, aValue, __ATOMIC_RELAXED);
+}
+
+uint64_t Histogram::GetCount(void) const
+{
+    uint64_t count = 0;
+
+    for (unsigned int i = 0; i < kShards; ++i)
+    {
+        for (unsigned int bucket = 0; bucket < kBuckets; ++bucket)
+        {
+            count += __atomic_load_n(&mShards[i].mCounts[bucket], __ATOMIC_RELAXED);
+        }
+    }
+
+    return count;
+}
+
+uint64_t Histogram::GetSum(void) const
+{
+    uint64_t sum = 0;
+
+    for (unsigned int i = 0; i < kShards; ++i)
+    {
+        sum += __atomic_load_n(&mShards[i].mSum, __ATOMIC_RELAXED);
+    }
+
+    return sum;
+}
+
+uint64_t Histogram::GetBucketCount(unsigned int aBucket) const
+{
+    uint64_t count = 0;
+
+    for (unsigned int i = 0; i < kShards; ++i)
+    {
+        count += __atomic_load_n(&mShards[i].mCounts[aBucket], __ATOMIC_RELAXED);
+    }
+
+    return count;
+}
+
+uint64_t Histogram::GetPercentile(unsigned int aPercent) const
+{
+    uint64_t     count  = GetCount();
+    uint64_t     rank   = (count * aPercent + 99) / 100;
+    uint64_t     seen   = 0;
+    uint64_t     value  = 0;
+    unsigned int bucket = 0;
+
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    for (; count > 0 && bucket < kBuckets; ++bucket)
+    {
+        seen += GetBucketCount(bucket);
+
+        if (seen >= rank)
+        {
+            value = (bucket + 1 < kBuckets) ? GetBucketLowest(bucket + 1) - 1 : GetBucketLowest(bucket);
+            break;
+        }
+    }
+
+    return value;
+}
+
+void Dump(int aLevel)
+{
+    uint64_t now     = GetMonotonicNow();
+    uint64_t elapsed = now - sLastDumpTime;
+
+    for (const Metric *metric = Metric::GetFirst(); metric != NULL; metric = metric->GetNext())
+    {
+        if (metric->GetType() == Metric::kTypeCounter)
+        {
+            const Counter &counter = *static_cast<const Counter *>(metric);
+            uint64_t       value   = counter.GetValue();
+            uint64_t       rate    = (elapsed > 0) ? (value - counter.mDumpedValue) * 1000 / elapsed : 0;
+
+            otbrLog(aLevel, "metric %s: %llu (%llu/s)", metric->GetName(), static_cast<unsigned long long>(value),
+                    static_cast<unsigned long long>(rate));
+            counter.mDumpedValue = value;
+        }
+        else if (metric->GetType() == Metric::kTypeGauge)
+        {
+            otbrLog(aLevel, "metric %s: %lld", metric->GetName(),
+                    static_cast<long long>(static_cast<const Gauge *>(metric)->GetValue()));
+        }
+        else if (metric->GetType() == Metric::kTypeMemory)
+        {
+            const Memory &memory = *static_cast<const Memory *>(metric);
+
+            otbrLog(aLevel, "metric %s: %llu bytes in %llu blocks, peak %llu bytes", metric->GetName(),
+                    static_cast<unsigned long long>(memory.GetValue()),
+                    static_cast<unsigned long long>(memory.GetBlocks()),
+                    static_cast<unsigned long long>(memory.GetPeak()));
+        }
+        else
+        {
+            const Histogram &histogram = *static_cast<const Histogram *>(metric);
+            uint64_t         count     = histogram.GetCount();
+
+            otbrLog(aLevel, "metric %s: count %llu, mean %llu, p50 %llu, p90 %llu, p99 %llu, max %llu",
+                    metric->GetName(), static_cast<unsigned long long>(count),
+                    static_cast<unsigned long long>(count > 0 ? histogram.GetSum() / count : 0),
+                    static_cast<unsigned long long>(histogram.GetPercentile(50)),
+                    static_cast<unsigned long long>(histogram.GetPercentile(90)),
+                    static_cast<unsigned long long>(histogram.GetPercentile(99)),
+                    static_cast<unsigned long long>(histogram.GetPercentile(100)));
+        }
+    }
+
+    sLastDumpTime = now;
+}
+
+static void ExportName(std::string &aOutput, const char *aName)
+{
+    aOutput += "otbr_";
+
+    for (const char *c = aName; *c != '\0'; ++c)
+    {
+        aOutput += (*c == '.' || *c == '-') ? '_' : *c;
+    }
+}
+
+static void ExportLine(std::string &aOutput, const char *aName, const char *aSuffix, const char *aValue)
+{
+    ExportName(aOutput, aName);
+    aOutput += aSuffix;
+    aOutput += ' ';
+    aOutput += aValue;
+    aOutput += '\n';
+}
+
+void Export(std::string &aOutput)
+{
+    char value[64];
+
+    for (const Metric *metric = Metric::GetFirst(); metric != NULL; metric = metric->GetNext())
+    {
+        aOutput += "# TYPE ";
+        ExportName(aOutput, metric->GetName());
+
+        if (metric->GetType() == Metric::kTypeCounter)
+        {
+            aOutput += " counter\n";
+            snprintf(value, sizeof(value), "%llu",
+                     static_cast<unsigned long long>(static_cast<const Counter *>(metric)->GetValue()));
+            ExportLine(aOutput, metric->GetName(), "_total", value);
+        }
+        else if (metric->GetType() == Metric::kTypeGauge)
+        {
+            aOutput += " gauge\n";
+            snprintf(value, sizeof(value), "%lld",
+                     static_cast<long long>(static_cast<const Gauge *>(metric)->GetValue()));
+            ExportLine(aOutput, metric->GetName(), "", value);
+        }
+        else if (metric->GetType() == Metric::kTypeMemory)
+        {
+            const Memory &memory = *static_cast<const Memory *>(metric);
+
+            aOutput += "_bytes gauge\n";
+            snprintf(value, sizeof(value), "%llu", static_cast<unsigned long long>(memory.GetValue()));
+            ExportLine(aOutput, metric->GetName(), "_bytes", value);
+            aOutput += "# TYPE ";
+            ExportName(aOutput, metric->GetName());
+            aOutput += "_peak_bytes gauge\n";
+            snprintf(value, sizeof(value), "%llu", static_cast<unsigned long long>(memory.GetPeak()));
+            ExportLine(aOutput, metric->GetName(), "_peak_bytes", value);
+        }
+        else
+        {
+            const Histogram &histogram = *static_cast<const Histogram *>(metric);
+            uint64_t         count     = 0;
+            unsigned int     bucket    = 0;
+            char             suffix[48];
+
+            aOutput += " histogram\n";
+
+            // Buckets up to each power of two are exact, as a power of two is the lowest value of a bucket.
+            for (unsigned int bits = 0; bits < Histogram::kMaxBits; ++bits)
+            {
+                unsigned int end = Histogram::GetBucket(static_cast<uint64_t>(1) << bits);
+
+                for (; bucket < end; ++bucket)
+                {
+                    count += histogram.GetBucketCount(bucket);
+                }
+
+                snprintf(suffix, sizeof(suffix), "_bucket{le=\"%llu\"}",
+                         static_cast<unsigned long long>((static_cast<uint64_t>(1) << bits) - 1));
+                snprintf(value, sizeof(value), "%llu", static_cast<unsigned long long>(count));
+                ExportLine(aOutput, metric->GetName(), suffix, value);
+            }
+
+            for (; bucket < Histogram::kBuckets; ++bucket)
+            {
+                count += histogram.GetBucketCount(bucket);
+            }
+
+            snprintf(value, sizeof(value), "%llu", static_cast<unsigned long long>(count));
+            ExportLine(aOutput, metric->GetName(), "_bucket{le=\"+Inf\"}", value);
+            ExportLine(aOutput, metric->GetName(), "_count", value);
+            snprintf(value, sizeof(value), "%llu", static_cast<unsigned long long>(histogram.GetSum()));
+            ExportLine(aOutput, metric->GetName(), "_sum", value);
+        }
+    }
+}
+
+} // namespace Metrics
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,437 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the metrics registry.
+ */
+
+#ifndef METRICS_HPP_
+#define METRICS_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Metrics {
+
+/**
+ * @addtogroup border-router-metrics
+ *
+ * @brief
+ *   This module includes definition for counters and latency histograms of the agent.
+ *
+ * Metrics are defined as static objects, which register themselves on construction and are never unregistered.
+ * Recording is lock-free and may be done from any thread: each thread records to one of a few shards with relaxed
+ * atomics, and readers sum the shards.
+ *
+ * @{
+ */
+
+enum
+{
+    kShards = 4, ///< Number of shards of a metric.
+};
+
+/**
+ * This class is the base of metrics in the registry.
+ *
+ */
+class Metric
+{
+public:
+    /**
+     * Type of a metric.
+     *
+     */
+    enum Type
+    {
+        kTypeCounter   = 0, ///< A monotonic counter.
+        kTypeHistogram = 1, ///< A histogram of values.
+        kTypeGauge     = 2, ///< A value going up and down.
+        kTypeMemory    = 3, ///< The memory used by a subsystem.
+    };
+
+    /**
+     * This method returns the name of this metric.
+     *
+     * @returns The name of this metric.
+     *
+     */
+    const char *GetName(void) const { return mName; }
+
+    /**
+     * This method returns the type of this metric.
+     *
+     * @returns The type of this metric.
+     *
+     */
+    Type GetType(void) const { return mType; }
+
+    /**
+     * This method returns the metric registered before this one.
+     *
+     * @returns A pointer to the next metric, NULL if this is the last one.
+     *
+     */
+    const Metric *GetNext(void) const { return mNext; }
+
+    /**
+     * This function returns the metric registered last.
+     *
+     * @returns A pointer to the first metric, NULL if none is registered.
+     *
+     */
+    static const Metric *GetFirst(void);
+
+protected:
+    /**
+     * The constructor registers the metric.
+     *
+     * @param[in]   aName   The name of the metric, which must outlive it.
+     * @param[in]   aType   The type of the metric.
+     *
+     */
+    Metric(const char *aName, Type aType);
+
+    /**
+     * This function returns the shard the calling thread records to.
+     *
+     * @returns The index of the shard.
+     *
+     */
+    static unsigned int GetShard(void);
+
+private:
+    const char *mName;
+    Type        mType;
+    Metric *    mNext;
+};
+
+/**
+ * This class implements a monotonic counter.
+ *
+ */
+class Counter : public Metric
+{
+public:
+    /**
+     * The constructor registers the counter.
+     *
+     * @param[in]   aName   The name of the counter, which must outlive it.
+     *
+     */
+    explicit Counter(const char *aName);
+
+    /**
+     * This method adds to the counter.
+     *
+     * @param[in]   aValue  The value to add.
+     *
+     */
+    void Add(uint64_t aValue = 1) { __atomic_fetch_add(&mShards[GetShard()].mValue, aValue, __ATOMIC_RELAXED); }
+
+    /**
+     * This method returns the value of the counter.
+     *
+     * @returns The sum of all values added.
+     *
+     */
+    uint64_t GetValue(void) const;
+
+private:
+    friend void Dump(int aLevel);
+
+    struct Shard
+    {
+        uint64_t mValue;
+        uint8_t  mPadding[64 - sizeof(uint64_t)]; ///< Keeps shards on cache lines of their own.
+    };
+
+    Shard            mShards[kShards];
+    mutable uint64_t mDumpedValue; ///< The value at the last Dump().
+};
+
+/**
+ * This class implements a gauge, such as the number of objects in use.
+ *
+ */
+class Gauge : public Metric
+{
+public:
+    /**
+     * The constructor registers the gauge.
+     *
+     * @param[in]   aName   The name of the gauge, which must outlive it.
+     *
+     */
+    explicit Gauge(const char *aName);
+
+    /**
+     * This method adds to the gauge.
+     *
+     * @param[in]   aDelta  The value to add, negative to subtract.
+     *
+     */
+    void Add(int64_t aDelta = 1) { __atomic_fetch_add(&mShards[GetShard()].mValue, aDelta, __ATOMIC_RELAXED); }
+
+    /**
+     * This method subtracts from the gauge.
+     *
+     * @param[in]   aDelta  The value to subtract.
+     *
+     */
+    void Subtract(int64_t aDelta = 1) { Add(-aDelta); }
+
+    /**
+     * This method returns the value of the gauge.
+     *
+     * @returns The sum of all values added.
+     *
+     */
+    int64_t GetValue(void) const;
+
+private:
+    struct Shard
+    {
+        int64_t mValue;
+        uint8_t mPadding[64 - sizeof(int64_t)]; ///< Keeps shards on cache lines of their own.
+    };
+
+    Shard mShards[kShards];
+};
+
+/**
+ * This class implements a histogram of values, such as latencies in microseconds.
+ *
+ * Values are counted in log-linear buckets: each power of two is split in 16 buckets, so a bucket is within 6.25% of
+ * the values it counts whatever their magnitude. Values of 2^40 or more are counted in the last bucket.
+ *
+ */
+class Histogram : public Metric
+{
+public:
+    enum
+    {
+        kSubBucketBits = 4,                                             ///< Log2 of the buckets per power of two.
+        kSubBuckets    = 1 << kSubBucketBits,                           ///< Buckets per power of two.
+        kMaxBits       = 40,                                            ///< Values are counted up to 2^kMaxBits.
+        kBuckets       = (kMaxBits - kSubBucketBits + 1) * kSubBuckets, ///< Number of buckets.
+    };
+
+    /**
+     * The constructor registers the histogram.
+     *
+     * @param[in]   aName   The name of the histogram, which must outlive it.
+     *
+     */
+    explicit Histogram(const char *aName);
+
+    /**
+     * This method counts a value.
+     *
+     * @param[in]   aValue  The value to count.
+     *
+     */
+    void Record(uint64_t aValue);
+
+    /**
+     * This method returns the number of values counted.
+     *
+     * @returns The number of values counted.
+     *
+     */
+    uint64_t GetCount(void) const;
+
+    /**
+     * This method returns the sum of values counted.
+     *
+     * @returns The sum of values counted.
+     *
+     */
+    uint64_t GetSum(void) const;
+
+    /**
+     * This method returns the number of values counted in a bucket.
+     *
+     * @param[in]   aBucket     The index of the bucket.
+     *
+     * @returns The number of values counted in the bucket.
+     *
+     */
+    uint64_t GetBucketCount(unsigned int aBucket) const;
+
+    /**
+     * This method returns a percentile of values counted.
+     *
+     * @param[in]   aPercent    The percentile, from 0 to 100.
+     *
+     * @returns The highest value of the bucket the percentile falls in, 0 if nothing was counted.
+     *
+     */
+    uint64_t GetPercentile(unsigned int aPercent) const;
+
+    /**
+     * This function returns the bucket a value is counted in.
+     *
+     * @param[in]   aValue  The value.
+     *
+     * @returns The index of the bucket.
+     *
+     */
+    static unsigned int GetBucket(uint64_t aValue);
+
+    /**
+     * This function returns the lowest value counted in a bucket.
+     *
+     * @param[in]   aBucket     The index of the bucket.
+     *
+     * @returns The lowest value of the bucket.
+     *
+     */
+    static uint64_t GetBucketLowest(unsigned int aBucket);
+
+private:
+    struct Shard
+    {
+        uint64_t mCounts[kBuckets];
+        uint64_t mSum;
+    };
+
+    Shard mShards[kShards];
+};
+
+/**
+ * This class accounts the memory used by a subsystem, such as its sessions or buffers.
+ *
+ * Allocations are tagged by the subsystem owning them, which reports both when they are made and when they are freed.
+ * Unlike other metrics, the value is not sharded so that its high-water mark is exact, which is fine as allocations
+ * are much rarer than other records.
+ *
+ */
+class Memory : public Metric
+{
+public:
+    /**
+     * The constructor registers the memory account.
+     *
+     * @param[in]   aName   The name of the memory account, which must outlive it.
+     *
+     */
+    explicit Memory(const char *aName);
+
+    /**
+     * This method accounts an allocation.
+     *
+     * @param[in]   aSize   The size of the allocation in bytes.
+     *
+     */
+    void Allocate(size_t aSize);
+
+    /**
+     * This method accounts the release of an allocation.
+     *
+     * @param[in]   aSize   The size of the allocation in bytes, as it was accounted.
+     *
+     */
+    void Free(size_t aSize);
+
+    /**
+     * This method returns the memory in use.
+     *
+     * @returns Number of bytes allocated and not yet freed.
+     *
+     */
+    uint64_t GetValue(void) const { return __atomic_load_n(&mBytes, __ATOMIC_RELAXED); }
+
+    /**
+     * This method returns the high-water mark of the memory in use.
+     *
+     * @returns The highest number of bytes in use at once.
+     *
+     */
+    uint64_t GetPeak(void) const { return __atomic_load_n(&mPeak, __ATOMIC_RELAXED); }
+
+    /**
+     * This method returns the number of allocations in use.
+     *
+     * @returns Number of allocations not yet freed.
+     *
+     */
+    uint64_t GetBlocks(void) const { return __atomic_load_n(&mBlocks, __ATOMIC_RELAXED); }
+
+private:
+    uint64_t mBytes;
+    uint64_t mPeak;
+    uint64_t mBlocks;
+};
+
+/**
+ * This function logs the value of all metrics, one line each.
+ *
+ * Counters are logged along with their rate since the previous call. This function is not thread-safe.
+ *
+ * @param[in]   aLevel  The log level.
+ *
+ */
+void Dump(int aLevel);
+
+/**
+ * This function appends the value of all metrics in the Prometheus text exposition format.
+ *
+ * Names are prefixed with "otbr_" and dots are replaced with underscores. Histograms are exported with cumulative
+ * buckets bounded by 2^n - 1, for n below Histogram::kMaxBits. Memory accounts are exported as gauges suffixed with
+ * "_bytes" and "_peak_bytes".
+ *
+ * @param[inout]    aOutput     A reference to the string to append to.
+ *
+ */
+void Export(std::string &aOutput);
+
+/**
+ * The content type of the output of Export().
+ *
+ */
+extern const char kExportContentType[];
+
+/**
+ * @}
+ */
+
+} // namespace Metrics
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // METRICS_HPP_
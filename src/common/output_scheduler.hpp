@@ -0,0 +1,323 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of an output scheduler serving priority classes of packets.
+ */
+
+#ifndef OUTPUT_SCHEDULER_HPP_
+#define OUTPUT_SCHEDULER_HPP_
+
+#include <stdint.h>
+
+#include "common/packet_ring.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * Priorities of packets queued for output.
+ *
+ */
+enum Priority
+{
+    kPriorityControl    = 0, ///< Commissioner sessions: petitions, keep-alives and responses.
+    kPriorityManagement = 1, ///< Management requests and notifications.
+    kPriorityBulk       = 2, ///< Relayed joiner traffic.
+    kPriorityCount      = 3, ///< Number of priorities.
+};
+
+/**
+ * This class implements an output queue per priority.
+ *
+ * Control packets are always sent first. The other priorities share what is left by deficit round robin, each
+ * sending up to its quantum of bytes per round, so that bulk traffic is slowed but never starved. A packet returned
+ * by GetFront() stays at the front until popped, whatever is queued meanwhile, so that it can be sent again.
+ *
+ * Unlike PacketRing, the scheduler is only used by one thread.
+ *
+ */
+class OutputScheduler
+{
+public:
+    enum
+    {
+        kDefaultQuantum = 1280, ///< Default bytes per round of the weighted priorities.
+    };
+
+    /**
+     * The constructor initializes a scheduler without slots.
+     *
+     */
+    OutputScheduler(void)
+        : mCurrent(kPriorityCount)
+        , mTurn(kPriorityManagement)
+        , mTurnStarted(false)
+    {
+        for (unsigned int i = 0; i < kPriorityCount; ++i)
+        {
+            mQuanta[i]   = kDefaultQuantum;
+            mDeficits[i] = 0;
+        }
+    }
+
+    /**
+     * This method allocates the slots of a priority, as PacketRing::Init() does.
+     *
+     * @param[in]   aPriority   The priority.
+     * @param[in]   aCapacity   The max number of packets of the priority, must be greater than 0.
+     * @param[in]   aSlotSize   The max number of bytes of a packet.
+     *
+     * @retval  true    The priority is initialized.
+     * @retval  false   Failed to allocate the slots.
+     *
+     */
+    bool Init(Priority aPriority, uint16_t aCapacity, uint16_t aSlotSize)
+    {
+        return mQueues[aPriority].Init(aCapacity, aSlotSize);
+    }
+
+    /**
+     * This method returns whether the slots of all priorities are allocated.
+     *
+     * @retval  true    The scheduler is initialized.
+     * @retval  false   The scheduler is not initialized.
+     *
+     */
+    bool IsInitialized(void) const
+    {
+        bool initialized = true;
+
+        for (unsigned int i = 0; i < kPriorityCount; ++i)
+        {
+            initialized = initialized && mQueues[i].IsInitialized();
+        }
+
+        return initialized;
+    }
+
+    /**
+     * This method returns the number of bytes allocated for the slots.
+     *
+     * @returns The number of bytes.
+     *
+     */
+    size_t GetSize(void) const
+    {
+        size_t size = 0;
+
+        for (unsigned int i = 0; i < kPriorityCount; ++i)
+        {
+            size += mQueues[i].GetSize();
+        }
+
+        return size;
+    }
+
+    /**
+     * This method sets the bytes a weighted priority sends per round.
+     *
+     * @param[in]   aPriority   The priority, other than kPriorityControl.
+     * @param[in]   aQuantum    The number of bytes, greater than 0.
+     *
+     */
+    void SetQuantum(Priority aPriority, uint16_t aQuantum) { mQuanta[aPriority] = aQuantum; }
+
+    /**
+     * This method copies a packet to the back of the queue of its priority.
+     *
+     * @param[in]   aPriority   The priority of the packet.
+     * @param[in]   aPacket     A pointer to the packet.
+     * @param[in]   aLength     The number of bytes of the packet.
+     *
+     * @retval  true    The packet is queued.
+     * @retval  false   The queue of the priority is full or not initialized, or the packet is larger than a slot.
+     *
+     */
+    bool Push(Priority aPriority, const uint8_t *aPacket, uint16_t aLength)
+    {
+        return mQueues[aPriority].Push(aPacket, aLength);
+    }
+
+    /**
+     * This method returns the packet to be sent next.
+     *
+     * @param[out]  aLength     A reference to receive the number of bytes of the packet.
+     *
+     * @returns A pointer to the packet, valid until Pop() or Clear() is called, NULL if all queues are empty.
+     *
+     */
+    const uint8_t *GetFront(uint16_t &aLength)
+    {
+        const uint8_t *packet = NULL;
+
+        if (mCurrent == kPriorityCount)
+        {
+            Schedule();
+        }
+
+        if (mCurrent != kPriorityCount)
+        {
+            packet = mQueues[mCurrent].GetFront(aLength);
+        }
+
+        return packet;
+    }
+
+    /**
+     * This method removes the packet returned by GetFront(), which must have been called.
+     *
+     */
+    void Pop(void)
+    {
+        uint16_t length;
+
+        if (mCurrent != kPriorityCount && mQueues[mCurrent].GetFront(length) != NULL)
+        {
+            mDeficits[mCurrent] = (mDeficits[mCurrent] > length) ? mDeficits[mCurrent] - length : 0;
+            mQueues[mCurrent].Pop();
+        }
+
+        mCurrent = kPriorityCount;
+    }
+
+    /**
+     * This method removes all packets.
+     *
+     */
+    void Clear(void)
+    {
+        for (unsigned int i = 0; i < kPriorityCount; ++i)
+        {
+            mQueues[i].Clear();
+            mDeficits[i] = 0;
+        }
+
+        mCurrent     = kPriorityCount;
+        mTurnStarted = false;
+    }
+
+    /**
+     * This method returns whether all queues are empty.
+     *
+     * @retval  true    No packet is queued.
+     * @retval  false   Packets are queued.
+     *
+     */
+    bool IsEmpty(void) const { return GetCount() == 0; }
+
+    /**
+     * This method returns the number of packets queued.
+     *
+     * @returns The number of packets of all priorities.
+     *
+     */
+    unsigned int GetCount(void) const
+    {
+        unsigned int count = 0;
+
+        for (unsigned int i = 0; i < kPriorityCount; ++i)
+        {
+            count += mQueues[i].GetCount();
+        }
+
+        return count;
+    }
+
+    /**
+     * This method returns the number of packets queued with a priority.
+     *
+     * @param[in]   aPriority   The priority.
+     *
+     * @returns The number of packets.
+     *
+     */
+    unsigned int GetCount(Priority aPriority) const { return mQueues[aPriority].GetCount(); }
+
+private:
+    void Schedule(void)
+    {
+        uint16_t length;
+
+        if (!mQueues[kPriorityControl].IsEmpty())
+        {
+            mCurrent = kPriorityControl;
+        }
+
+        // A turn adds the quantum of its priority once, and lasts while the deficit covers the next packet.
+        while (mCurrent == kPriorityCount && GetCount() > 0)
+        {
+            if (mQueues[mTurn].GetFront(length) == NULL)
+            {
+                mDeficits[mTurn] = 0;
+                NextTurn();
+            }
+            else
+            {
+                if (!mTurnStarted)
+                {
+                    mDeficits[mTurn] += mQuanta[mTurn];
+                    mTurnStarted = true;
+                }
+
+                if (mDeficits[mTurn] >= length)
+                {
+                    mCurrent = mTurn;
+                }
+                else
+                {
+                    NextTurn();
+                }
+            }
+        }
+    }
+
+    void NextTurn(void)
+    {
+        mTurn        = (mTurn + 1 < kPriorityCount) ? mTurn + 1 : static_cast<unsigned int>(kPriorityManagement);
+        mTurnStarted = false;
+    }
+
+    OutputScheduler(const OutputScheduler &);
+    OutputScheduler &operator=(const OutputScheduler &);
+
+    PacketRing   mQueues[kPriorityCount];
+    uint32_t     mQuanta[kPriorityCount];
+    uint32_t     mDeficits[kPriorityCount]; ///< Bytes each weighted priority may still send in its turn.
+    unsigned int mCurrent;                  ///< The priority of the packet at the front, kPriorityCount if none.
+    unsigned int mTurn;                     ///< The weighted priority whose turn it is.
+    bool         mTurnStarted;              ///< Whether the quantum of the turn was added.
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // OUTPUT_SCHEDULER_HPP_
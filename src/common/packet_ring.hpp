@@ -0,0 +1,249 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of a single-producer single-consumer ring of packets.
+ */
+
+#ifndef PACKET_RING_HPP_
+#define PACKET_RING_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class implements a bounded ring of packets passed from one thread to another.
+ *
+ * Packets are copied into slots of a fixed size allocated once by Init(), so that passing a packet takes no lock and
+ * no allocation. Push() may only be called by one producer thread, GetFront(), Pop() and Clear() by one consumer
+ * thread. The slots at the front and back always stay below the capacity, which is thus not limited to powers of two.
+ *
+ */
+class PacketRing
+{
+public:
+    /**
+     * The constructor initializes a ring without slots.
+     *
+     */
+    PacketRing(void)
+        : mSlots(NULL)
+        , mLengths(NULL)
+        , mCapacity(0)
+        , mSlotSize(0)
+        , mHead(0)
+        , mTail(0)
+        , mCount(0)
+    {
+    }
+
+    /**
+     * The destructor frees the slots.
+     *
+     */
+    ~PacketRing(void)
+    {
+        free(mSlots);
+        free(mLengths);
+    }
+
+    /**
+     * This method allocates the slots of the ring.
+     *
+     * The ring must be empty and not accessed by other threads. Calling this method on an initialized ring does
+     * nothing.
+     *
+     * @param[in]   aCapacity   The max number of packets held, must be greater than 0.
+     * @param[in]   aSlotSize   The max number of bytes of a packet.
+     *
+     * @retval  true    The ring is initialized.
+     * @retval  false   Failed to allocate the slots.
+     *
+     */
+    bool Init(uint16_t aCapacity, uint16_t aSlotSize)
+    {
+        if (mSlots == NULL)
+        {
+            mSlots   = static_cast<uint8_t *>(malloc(static_cast<size_t>(aCapacity) * aSlotSize));
+            mLengths = static_cast<uint16_t *>(malloc(aCapacity * sizeof(uint16_t)));
+
+            if (mSlots == NULL || mLengths == NULL)
+            {
+                free(mSlots);
+                free(mLengths);
+                mSlots   = NULL;
+                mLengths = NULL;
+            }
+            else
+            {
+                mCapacity = aCapacity;
+                mSlotSize = aSlotSize;
+            }
+        }
+
+        return mSlots != NULL;
+    }
+
+    /**
+     * This method returns whether the slots are allocated.
+     *
+     * @retval  true    The ring is initialized.
+     * @retval  false   The ring is not initialized.
+     *
+     */
+    bool IsInitialized(void) const { return mSlots != NULL; }
+
+    /**
+     * This method returns the number of bytes allocated for the slots.
+     *
+     * @returns The number of bytes.
+     *
+     */
+    size_t GetSize(void) const { return static_cast<size_t>(mCapacity) * (mSlotSize + sizeof(uint16_t)); }
+
+    /**
+     * This method copies a packet to the back of the ring, called by the producer.
+     *
+     * @param[in]   aPacket     A pointer to the packet.
+     * @param[in]   aLength     The number of bytes of the packet.
+     *
+     * @retval  true    The packet is queued.
+     * @retval  false   The ring is full or not initialized, or the packet is larger than a slot.
+     *
+     */
+    bool Push(const uint8_t *aPacket, uint16_t aLength)
+    {
+        bool rval = false;
+
+        if (aLength <= mSlotSize && __atomic_load_n(&mCount, __ATOMIC_ACQUIRE) < mCapacity)
+        {
+            memcpy(&mSlots[mHead * mSlotSize], aPacket, aLength);
+            mLengths[mHead] = aLength;
+            mHead           = Next(mHead, 1);
+            __atomic_add_fetch(&mCount, 1, __ATOMIC_RELEASE);
+            rval = true;
+        }
+
+        return rval;
+    }
+
+    /**
+     * This method returns the packet at the front of the ring, called by the consumer.
+     *
+     * The packet stays valid until Pop() or Clear() is called.
+     *
+     * @param[out]  aLength     A reference to receive the number of bytes of the packet.
+     *
+     * @returns A pointer to the packet, NULL if the ring is empty.
+     *
+     */
+    const uint8_t *GetFront(uint16_t &aLength) const
+    {
+        const uint8_t *packet = NULL;
+
+        if (__atomic_load_n(&mCount, __ATOMIC_ACQUIRE) != 0)
+        {
+            aLength = mLengths[mTail];
+            packet  = &mSlots[mTail * mSlotSize];
+        }
+
+        return packet;
+    }
+
+    /**
+     * This method removes the packet at the front of the ring, called by the consumer.
+     *
+     * The ring must not be empty.
+     *
+     */
+    void Pop(void)
+    {
+        mTail = Next(mTail, 1);
+        __atomic_sub_fetch(&mCount, 1, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * This method removes all packets, called by the consumer.
+     *
+     */
+    void Clear(void)
+    {
+        unsigned int count = __atomic_load_n(&mCount, __ATOMIC_ACQUIRE);
+
+        // Packets pushed meanwhile are kept.
+        mTail = Next(mTail, count);
+        __atomic_sub_fetch(&mCount, count, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * This method returns whether the ring is empty.
+     *
+     * @retval  true    The ring holds no packet.
+     * @retval  false   The ring holds packets.
+     *
+     */
+    bool IsEmpty(void) const { return GetCount() == 0; }
+
+    /**
+     * This method returns the number of packets in the ring.
+     *
+     * @returns The number of packets.
+     *
+     */
+    unsigned int GetCount(void) const { return __atomic_load_n(&mCount, __ATOMIC_ACQUIRE); }
+
+private:
+    PacketRing(const PacketRing &);
+    PacketRing &operator=(const PacketRing &);
+
+    unsigned int Next(unsigned int aSlot, unsigned int aCount) const
+    {
+        return mCapacity == 0 ? 0 : (aSlot + aCount) % mCapacity;
+    }
+
+    uint8_t *    mSlots;
+    uint16_t *   mLengths;
+    uint16_t     mCapacity;
+    uint16_t     mSlotSize;
+    unsigned int mHead;  ///< The slot of the next packet pushed, only accessed by the producer.
+    unsigned int mTail;  ///< The slot of the packet at the front, only accessed by the consumer.
+    unsigned int mCount; ///< Number of packets, added to by the producer and taken from by the consumer.
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // PACKET_RING_HPP_
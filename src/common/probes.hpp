@@ -0,0 +1,86 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the static tracepoints of the agent.
+ *
+ * The tracepoints are USDT probes of provider `otbr`, which tools like bpftrace and SystemTap attach to, e.g.
+ * `usdt:/usr/sbin/otbr-agent:otbr:dtls_handshake_done`. An unattached probe is a single nop and its arguments are
+ * only evaluated into registers, so probes stay on hot paths. Without <sys/sdt.h> at configure time probes compile
+ * to nothing.
+ *
+ * Probes of the agent:
+ * - dtls_session_create(session, port):            A DTLS session is allocated for a peer of UDP port.
+ * - dtls_session_destroy(session):                 A DTLS session is released.
+ * - dtls_handshake_start(session):                 A DTLS session starts handshaking.
+ * - dtls_handshake_done(session, result, us):      A DTLS handshake finished with the mbedtls result in us.
+ * - coap_request(path, type, port):                A CoAP request from UDP port is dispatched to the resource path.
+ * - ncp_tmf_send(length, locator, port):           A TMF packet is sent through the NCP.
+ * - ncp_tmf_receive(length, locator, port):        A TMF packet is received from the NCP.
+ * - mdns_publish(name, type, port):                An mDNS service is published.
+ */
+
+#ifndef PROBES_HPP_
+#define PROBES_HPP_
+
+#if OTBR_ENABLE_PROBES
+
+#include <sys/sdt.h>
+
+#define OTBR_PROBE1(aName, aArg1) DTRACE_PROBE1(otbr, aName, aArg1)
+#define OTBR_PROBE2(aName, aArg1, aArg2) DTRACE_PROBE2(otbr, aName, aArg1, aArg2)
+#define OTBR_PROBE3(aName, aArg1, aArg2, aArg3) DTRACE_PROBE3(otbr, aName, aArg1, aArg2, aArg3)
+
+#else // OTBR_ENABLE_PROBES
+
+/*
+ * The arguments are not evaluated, sizeof only keeps variables used by probes alone from being reported unused.
+ */
+#define OTBR_PROBE1(aName, aArg1) \
+    do                            \
+    {                             \
+        (void)sizeof(aArg1);      \
+    } while (false)
+#define OTBR_PROBE2(aName, aArg1, aArg2) \
+    do                                   \
+    {                                    \
+        (void)sizeof(aArg1);             \
+        (void)sizeof(aArg2);             \
+    } while (false)
+#define OTBR_PROBE3(aName, aArg1, aArg2, aArg3) \
+    do                                          \
+    {                                           \
+        (void)sizeof(aArg1);                    \
+        (void)sizeof(aArg2);                    \
+        (void)sizeof(aArg3);                    \
+    } while (false)
+
+#endif // OTBR_ENABLE_PROBES
+
+#endif // PROBES_HPP_
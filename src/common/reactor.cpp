@@ -0,0 +1,974 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the file descriptor reactor used by the mainloop.
+ */
+
+#include "reactor.hpp"
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "otbr-config.h"
+
+#if HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
+#if OTBR_ENABLE_IO_URING
+#include <endian.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <linux/io_uring.h>
+#endif
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/time.hpp"
+#include "common/timeline.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+#if HAVE_SYS_EPOLL_H
+static uint32_t ToEpollEvents(unsigned int aEvents)
+{
+    uint32_t events = 0;
+
+    if (aEvents & Reactor::kEventReadable)
+    {
+        events |= EPOLLIN;
+    }
+
+    if (aEvents & Reactor::kEventWritable)
+    {
+        events |= EPOLLOUT;
+    }
+
+    if (aEvents & Reactor::kEventEdge)
+    {
+        events |= EPOLLET;
+    }
+
+    // EPOLLERR and EPOLLHUP are always reported.
+    return events;
+}
+
+static unsigned int FromEpollEvents(uint32_t aEvents)
+{
+    unsigned int events = 0;
+
+    if (aEvents & EPOLLIN)
+    {
+        events |= Reactor::kEventReadable;
+    }
+
+    if (aEvents & EPOLLOUT)
+    {
+        events |= Reactor::kEventWritable;
+    }
+
+    if (aEvents & (EPOLLERR | EPOLLHUP))
+    {
+        events |= Reactor::kEventError;
+    }
+
+    return events;
+}
+#endif // HAVE_SYS_EPOLL_H
+
+#if OTBR_ENABLE_IO_URING
+/**
+ * This class implements the io_uring backend of the reactor.
+ *
+ * Each file descriptor has one poll request of the events of all its watches. Watches of level-triggered events use
+ * one-shot polls, re-armed once dispatched, which complete at once while the file descriptor is still ready. Watches
+ * of edge-triggered events use multishot polls. New, changed and re-armed polls are queued, and submitted by the
+ * next wait in the same system call.
+ *
+ */
+class Reactor::Uring
+{
+public:
+    Uring(void)
+        : mFd(-1)
+        , mRing(NULL)
+        , mRingSize(0)
+        , mSqes(NULL)
+        , mSqesSize(0)
+        , mSqMask(0)
+        , mSqEntries(0)
+        , mSqTail(0)
+        , mCqMask(0)
+        , mMultishot(true)
+    {
+    }
+
+    ~Uring(void)
+    {
+        if (mSqes != NULL)
+        {
+            munmap(mSqes, mSqesSize);
+        }
+
+        if (mRing != NULL)
+        {
+            munmap(mRing, mRingSize);
+        }
+
+        if (mFd >= 0)
+        {
+            close(mFd);
+        }
+    }
+
+    otbrError Init(void);
+    int       GetFd(void) const { return mFd; }
+    otbrError Update(int aFd, unsigned int aEvents);
+    void      Rearm(int aFd);
+    int       Submit(void) { return Enter(0, 0, NULL); }
+    int       Wait(int aTimeout, const sigset_t *aSignalMask);
+    bool      Reap(int &aFd, unsigned int &aEvents);
+
+private:
+    enum
+    {
+        kEntries = 256, ///< Number of submission queue entries.
+    };
+
+    static const uint64_t kUserDataRemove = ~0ULL; ///< The user data of poll removals, whose completions are skipped.
+
+    /**
+     * This structure represents the poll request of a file descriptor.
+     *
+     */
+    struct Poll
+    {
+        uint32_t     mGeneration; ///< Changed on each new request, so that completions of older ones are skipped.
+        unsigned int mEvents;     ///< The events of all watches of the file descriptor, 0 if none.
+        bool         mArmed;      ///< Whether the request is pending in the kernel.
+    };
+
+    static uint64_t GetUserData(int aFd, uint32_t aGeneration)
+    {
+        return (static_cast<uint64_t>(aGeneration) << 32) | static_cast<uint32_t>(aFd);
+    }
+
+    io_uring_sqe *GetSqe(void);
+    otbrError     Arm(int aFd);
+    otbrError     Disarm(int aFd);
+    int           Enter(unsigned int aMinComplete, unsigned int aFlags, const void *aArgument);
+
+    int               mFd;
+    void *            mRing; ///< The submission and completion rings, mapped together.
+    size_t            mRingSize;
+    io_uring_sqe *    mSqes;
+    size_t            mSqesSize;
+    unsigned int *    mSqHead;
+    unsigned int *    mSqTailShared;
+    unsigned int      mSqMask;
+    unsigned int      mSqEntries;
+    unsigned int      mSqTail; ///< The tail of the submission queue, published by Enter().
+    unsigned int *    mCqHead;
+    unsigned int *    mCqTail;
+    unsigned int      mCqMask;
+    io_uring_cqe *    mCqes;
+    bool              mMultishot; ///< Whether the kernel supports multishot polls.
+    std::vector<Poll> mPolls;     ///< The poll requests indexed by file descriptor.
+};
+
+otbrError Reactor::Uring::Init(void)
+{
+    otbrError       error = OTBR_ERROR_ERRNO;
+    io_uring_params params;
+    unsigned int *  array;
+
+    memset(&params, 0, sizeof(params));
+    VerifyOrExit((mFd = static_cast<int>(syscall(__NR_io_uring_setup, kEntries, &params))) >= 0);
+
+    // Waiting with a timeout and a signal mask takes IORING_FEAT_EXT_ARG, which comes after the others.
+    VerifyOrExit((params.features & IORING_FEAT_SINGLE_MMAP) && (params.features & IORING_FEAT_NODROP) &&
+                     (params.features & IORING_FEAT_EXT_ARG),
+                 errno = ENOTSUP);
+
+    mRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+
+    if (mRingSize < params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe))
+    {
+        mRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    }
+
+    mRing = mmap(NULL, mRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd, IORING_OFF_SQ_RING);
+    VerifyOrExit(mRing != MAP_FAILED, mRing = NULL);
+    mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    mSqes     = static_cast<io_uring_sqe *>(
+        mmap(NULL, mSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd, IORING_OFF_SQES));
+    VerifyOrExit(mSqes != MAP_FAILED, mSqes = NULL);
+
+    mSqHead       = reinterpret_cast<unsigned int *>(static_cast<char *>(mRing) + params.sq_off.head);
+    mSqTailShared = reinterpret_cast<unsigned int *>(static_cast<char *>(mRing) + params.sq_off.tail);
+    mSqMask       = *reinterpret_cast<unsigned int *>(static_cast<char *>(mRing) + params.sq_off.ring_mask);
+    mSqEntries    = params.sq_entries;
+    mSqTail       = *mSqTailShared;
+    mCqHead       = reinterpret_cast<unsigned int *>(static_cast<char *>(mRing) + params.cq_off.head);
+    mCqTail       = reinterpret_cast<unsigned int *>(static_cast<char *>(mRing) + params.cq_off.tail);
+    mCqMask       = *reinterpret_cast<unsigned int *>(static_cast<char *>(mRing) + params.cq_off.ring_mask);
+    mCqes         = reinterpret_cast<io_uring_cqe *>(static_cast<char *>(mRing) + params.cq_off.cqes);
+
+    // Entries are always queued in order, so the indirection array is set once.
+    array = reinterpret_cast<unsigned int *>(static_cast<char *>(mRing) + params.sq_off.array);
+
+    for (unsigned int i = 0; i < params.sq_entries; ++i)
+    {
+        array[i] = i;
+    }
+
+    error = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+int Reactor::Uring::Enter(unsigned int aMinComplete, unsigned int aFlags, const void *aArgument)
+{
+    int          rval;
+    unsigned int pending;
+
+    __atomic_store_n(mSqTailShared, mSqTail, __ATOMIC_RELEASE);
+    pending = mSqTail - __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE);
+    VerifyOrExit(pending > 0 || aMinComplete > 0, rval = 0);
+
+    rval = static_cast<int>(syscall(__NR_io_uring_enter, mFd, pending, aMinComplete, aFlags, aArgument,
+                                    aArgument == NULL ? 0 : sizeof(io_uring_getevents_arg)));
+
+    // Interrupted waits return -1 with errno set to EINTR, submissions consumed so far are skipped by the next call.
+    if (rval < 0 && errno == ETIME)
+    {
+        rval = 0;
+    }
+
+exit:
+    return rval;
+}
+
+io_uring_sqe *Reactor::Uring::GetSqe(void)
+{
+    io_uring_sqe *sqe = NULL;
+
+    // A full queue is submitted without waiting.
+    if (mSqTail - __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE) >= mSqEntries)
+    {
+        VerifyOrExit(Submit() >= 0);
+        VerifyOrExit(mSqTail - __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE) < mSqEntries, errno = EBUSY);
+    }
+
+    sqe = &mSqes[mSqTail & mSqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    mSqTail++;
+
+exit:
+    return sqe;
+}
+
+otbrError Reactor::Uring::Arm(int aFd)
+{
+    otbrError     error = OTBR_ERROR_ERRNO;
+    Poll &        poll  = mPolls[static_cast<size_t>(aFd)];
+    io_uring_sqe *sqe;
+    uint32_t      mask = POLLERR | POLLHUP;
+
+    VerifyOrExit((sqe = GetSqe()) != NULL);
+
+    if (poll.mEvents & kEventReadable)
+    {
+        mask |= POLLIN;
+    }
+
+    if (poll.mEvents & kEventWritable)
+    {
+        mask |= POLLOUT;
+    }
+
+#if __BYTE_ORDER == __BIG_ENDIAN
+    mask = (mask << 16) | (mask >> 16);
+#endif
+
+    poll.mGeneration++;
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->fd            = aFd;
+    sqe->poll32_events = mask;
+    sqe->len           = (mMultishot && (poll.mEvents & kEventEdge)) ? IORING_POLL_ADD_MULTI : 0;
+    sqe->user_data     = GetUserData(aFd, poll.mGeneration);
+    poll.mArmed        = true;
+    error              = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+otbrError Reactor::Uring::Disarm(int aFd)
+{
+    otbrError     error = OTBR_ERROR_ERRNO;
+    Poll &        poll  = mPolls[static_cast<size_t>(aFd)];
+    io_uring_sqe *sqe;
+
+    VerifyOrExit((sqe = GetSqe()) != NULL);
+
+    sqe->opcode    = IORING_OP_POLL_REMOVE;
+    sqe->fd        = -1;
+    sqe->addr      = GetUserData(aFd, poll.mGeneration);
+    sqe->user_data = kUserDataRemove;
+    poll.mGeneration++;
+    poll.mArmed = false;
+    error       = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+otbrError Reactor::Uring::Update(int aFd, unsigned int aEvents)
+{
+    otbrError error = OTBR_ERROR_NONE;
+    Poll *    poll;
+
+    if (static_cast<size_t>(aFd) >= mPolls.size())
+    {
+        Poll unused = {0, 0, false};
+
+        mPolls.resize(static_cast<size_t>(aFd) + 1, unused);
+    }
+
+    poll = &mPolls[static_cast<size_t>(aFd)];
+
+    if (poll->mArmed)
+    {
+        SuccessOrExit(error = Disarm(aFd));
+    }
+
+    poll->mEvents = aEvents;
+
+    if (aEvents != 0)
+    {
+        SuccessOrExit(error = Arm(aFd));
+    }
+    else
+    {
+        // The kernel holds the file until its poll is removed, which must not wait for the file to be reused.
+        VerifyOrExit(Submit() >= 0, error = OTBR_ERROR_ERRNO);
+    }
+
+exit:
+    return error;
+}
+
+void Reactor::Uring::Rearm(int aFd)
+{
+    Poll &poll = mPolls[static_cast<size_t>(aFd)];
+
+    if (!poll.mArmed && poll.mEvents != 0 && Arm(aFd) != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to poll fd %d: %s!", aFd, strerror(errno));
+    }
+}
+
+int Reactor::Uring::Wait(int aTimeout, const sigset_t *aSignalMask)
+{
+    io_uring_getevents_arg argument;
+    __kernel_timespec      timeout;
+    unsigned int           minComplete = 0;
+
+    memset(&argument, 0, sizeof(argument));
+    argument.sigmask    = reinterpret_cast<uintptr_t>(aSignalMask);
+    argument.sigmask_sz = (aSignalMask == NULL ? 0 : _NSIG / 8);
+
+    if (aTimeout > 0)
+    {
+        timeout.tv_sec  = aTimeout / 1000;
+        timeout.tv_nsec = (aTimeout % 1000) * 1000000L;
+        argument.ts     = reinterpret_cast<uintptr_t>(&timeout);
+    }
+
+    // Completions already posted are reaped without waiting.
+    if (aTimeout != 0 && __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE) == *mCqHead)
+    {
+        minComplete = 1;
+    }
+
+    return minComplete > 0 ? Enter(minComplete, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &argument) : Submit();
+}
+
+bool Reactor::Uring::Reap(int &aFd, unsigned int &aEvents)
+{
+    unsigned int head  = *mCqHead;
+    bool         found = false;
+
+    while (!found && head != __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE))
+    {
+        const io_uring_cqe &cqe = mCqes[head & mCqMask];
+        int                 fd  = static_cast<int>(cqe.user_data & 0xffffffff);
+        Poll *              poll;
+
+        head++;
+
+        if (cqe.user_data == kUserDataRemove || static_cast<size_t>(fd) >= mPolls.size())
+        {
+            continue;
+        }
+
+        poll = &mPolls[static_cast<size_t>(fd)];
+
+        if (cqe.user_data != GetUserData(fd, poll->mGeneration))
+        {
+            continue;
+        }
+
+        if (!(cqe.flags & IORING_CQE_F_MORE))
+        {
+            poll->mArmed = false;
+        }
+
+        if (cqe.res == -EINVAL && mMultishot && (poll->mEvents & kEventEdge))
+        {
+            // Kernels before 5.13 have no multishot polls, edge-triggered watches are re-armed as the others.
+            otbrLog(OTBR_LOG_INFO, "io_uring has no multishot polls, using one-shot polls.");
+            mMultishot = false;
+            Rearm(fd);
+            continue;
+        }
+
+        aFd     = fd;
+        aEvents = 0;
+        found   = true;
+
+        if (cqe.res < 0 || (cqe.res & (POLLERR | POLLHUP | POLLNVAL)))
+        {
+            aEvents |= kEventError;
+        }
+
+        if (cqe.res > 0 && (cqe.res & POLLIN))
+        {
+            aEvents |= kEventReadable;
+        }
+
+        if (cqe.res > 0 && (cqe.res & POLLOUT))
+        {
+            aEvents |= kEventWritable;
+        }
+    }
+
+    __atomic_store_n(mCqHead, head, __ATOMIC_RELEASE);
+
+    return found;
+}
+#endif // OTBR_ENABLE_IO_URING
+
+Reactor::Reactor(void)
+    : mBackend(kBackendSelect)
+    , mEpollFd(-1)
+    , mUring(NULL)
+    , mRound(0)
+    , mWakeTime(0)
+    , mSignalMask(NULL)
+{
+    mSlowestHandler.mName = NULL;
+    mSlowestHandler.mFd   = -1;
+    mSlowestHandler.mTime = 0;
+}
+
+Reactor::~Reactor(void)
+{
+#if OTBR_ENABLE_IO_URING
+    delete mUring;
+#endif
+
+    if (mEpollFd >= 0)
+    {
+        close(mEpollFd);
+    }
+}
+
+otbrError Reactor::Init(void)
+{
+    return Init(kBackendUring);
+}
+
+otbrError Reactor::Init(Backend aBackend)
+{
+    otbrError error = OTBR_ERROR_NONE;
+
+#if OTBR_ENABLE_IO_URING
+    if (aBackend == kBackendUring)
+    {
+        mUring = new Uring();
+
+        if (mUring->Init() == OTBR_ERROR_NONE)
+        {
+            ExitNow(mBackend = kBackendUring);
+        }
+
+        otbrLog(OTBR_LOG_INFO, "io_uring is not available, using epoll: %s.", strerror(errno));
+        delete mUring;
+        mUring = NULL;
+    }
+#endif
+
+#if HAVE_SYS_EPOLL_H
+    if (aBackend != kBackendSelect)
+    {
+        VerifyOrExit((mEpollFd = epoll_create1(EPOLL_CLOEXEC)) >= 0, error = OTBR_ERROR_ERRNO);
+        ExitNow(mBackend = kBackendEpoll);
+    }
+#endif
+
+    mBackend = kBackendSelect;
+    (void)aBackend;
+    ExitNow();
+
+exit:
+    if (error != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to initialize reactor: %s!", strerror(errno));
+    }
+
+    return error;
+}
+
+unsigned int Reactor::GetEvents(int aFd) const
+{
+    unsigned int events = 0;
+
+    for (const Watch *watch = mWatches[aFd]; watch != NULL; watch = watch->mNext)
+    {
+        events |= watch->mEvents;
+    }
+
+    return events;
+}
+
+otbrError Reactor::Update(int aFd, unsigned int aOldEvents)
+{
+    otbrError    error      = OTBR_ERROR_NONE;
+    unsigned int events     = GetEvents(aFd);
+    bool         registered = (mWatches[aFd] != NULL);
+
+    // File descriptors whose watches have no events stay registered, errors are still reported to them.
+    VerifyOrExit(registered != mRegistered[aFd] || (registered && events != aOldEvents));
+
+#if OTBR_ENABLE_IO_URING
+    if (mBackend == kBackendUring)
+    {
+        // Errors are reported to any watch, as with epoll.
+        ExitNow(error = mUring->Update(aFd, registered ? (events | kEventError) : 0));
+    }
+#endif
+
+#if HAVE_SYS_EPOLL_H
+    if (mBackend == kBackendEpoll)
+    {
+        struct epoll_event event;
+        int                op;
+
+        if (!registered)
+        {
+            op = EPOLL_CTL_DEL;
+        }
+        else if (!mRegistered[aFd])
+        {
+            op = EPOLL_CTL_ADD;
+        }
+        else
+        {
+            op = EPOLL_CTL_MOD;
+        }
+
+        memset(&event, 0, sizeof(event));
+        event.events  = ToEpollEvents(events);
+        event.data.fd = aFd;
+
+        VerifyOrExit(epoll_ctl(mEpollFd, op, aFd, &event) == 0, error = OTBR_ERROR_ERRNO);
+    }
+#endif
+
+exit:
+    if (error == OTBR_ERROR_NONE)
+    {
+        mRegistered[aFd] = registered;
+    }
+
+    return error;
+}
+
+otbrError Reactor::Add(Watch &       aWatch,
+                       int          aFd,
+                       unsigned int aEvents,
+                       Handler      aHandler,
+                       void *       aContext,
+                       const char * aName)
+{
+    otbrError    error = OTBR_ERROR_ERRNO;
+    unsigned int oldEvents;
+
+    VerifyOrExit(aFd >= 0 && aHandler != NULL && aWatch.mFd == -1, errno = EINVAL);
+
+    if (static_cast<size_t>(aFd) >= mWatches.size())
+    {
+        mWatches.resize(static_cast<size_t>(aFd) + 1, NULL);
+        mRegistered.resize(static_cast<size_t>(aFd) + 1, false);
+    }
+
+    oldEvents = (mWatches[aFd] == NULL ? 0 : GetEvents(aFd));
+
+    aWatch.mFd      = aFd;
+    aWatch.mEvents  = aEvents;
+    aWatch.mHandler = aHandler;
+    aWatch.mContext = aContext;
+    aWatch.mName    = aName;
+    aWatch.mRound   = mRound;
+    aWatch.mNext    = mWatches[aFd];
+    mWatches[aFd]   = &aWatch;
+
+    if ((error = Update(aFd, oldEvents)) != OTBR_ERROR_NONE)
+    {
+        mWatches[aFd] = aWatch.mNext;
+        aWatch.mFd    = -1;
+        aWatch.mNext  = NULL;
+    }
+
+exit:
+    return error;
+}
+
+otbrError Reactor::Modify(Watch &aWatch, unsigned int aEvents)
+{
+    otbrError    error = OTBR_ERROR_ERRNO;
+    unsigned int oldEvents;
+
+    VerifyOrExit(aWatch.mFd >= 0, errno = ENOENT);
+    VerifyOrExit(aWatch.mEvents != aEvents, error = OTBR_ERROR_NONE);
+
+    oldEvents      = GetEvents(aWatch.mFd);
+    aWatch.mEvents = aEvents;
+    error          = Update(aWatch.mFd, oldEvents);
+
+exit:
+    return error;
+}
+
+otbrError Reactor::Remove(Watch &aWatch)
+{
+    otbrError    error = OTBR_ERROR_ERRNO;
+    int          fd    = aWatch.mFd;
+    unsigned int oldEvents;
+
+    VerifyOrExit(fd >= 0, errno = ENOENT);
+
+    oldEvents = GetEvents(fd);
+
+    for (Watch **link = &mWatches[fd]; *link != NULL; link = &(*link)->mNext)
+    {
+        if (*link == &aWatch)
+        {
+            *link = aWatch.mNext;
+            break;
+        }
+    }
+
+    aWatch.mFd   = -1;
+    aWatch.mNext = NULL;
+    error        = Update(fd, oldEvents);
+
+exit:
+    return error;
+}
+
+void Reactor::Dispatch(int aFd, unsigned int aEvents)
+{
+    VerifyOrExit(static_cast<size_t>(aFd) < mWatches.size());
+
+    if (++mRound == 0)
+    {
+        ++mRound;
+    }
+
+    // Handlers may add or remove watches, so restart from the head after each call. Each watch is
+    // called at most once per round.
+    for (Watch *watch = mWatches[aFd]; watch != NULL;)
+    {
+        unsigned int events = aEvents & (watch->mEvents | kEventError);
+        const char * name   = watch->mName;
+        uint64_t     start;
+        uint32_t     time;
+
+        if (watch->mRound == mRound || events == 0)
+        {
+            watch = watch->mNext;
+            continue;
+        }
+
+        start         = GetMonotonicNowUs();
+        watch->mRound = mRound;
+        Timeline::Begin(name);
+        watch->mHandler(watch->mContext, aFd, events);
+        Timeline::End(name);
+
+        // The watch may be gone, so its name was read before the call.
+        time = static_cast<uint32_t>(GetMonotonicNowUs() - start);
+
+        if (time > mSlowestHandler.mTime || mSlowestHandler.mName == NULL)
+        {
+            mSlowestHandler.mName = name;
+            mSlowestHandler.mFd   = aFd;
+            mSlowestHandler.mTime = time;
+        }
+
+        watch = mWatches[aFd];
+    }
+
+exit:
+    return;
+}
+
+int Reactor::Wait(int aTimeout)
+{
+    int rval = mBackend == kBackendUring ? WaitUring(aTimeout) : WaitEpoll(aTimeout);
+
+    // The iteration ends with the dispatch, callers read the current time again.
+    LoopClock::Stop();
+
+    return rval;
+}
+
+int Reactor::WaitEpoll(int aTimeout)
+{
+    int rval = 0;
+
+#if HAVE_SYS_EPOLL_H
+    struct epoll_event events[kMaxEvents];
+
+    rval = epoll_pwait(mEpollFd, events, kMaxEvents, aTimeout, mSignalMask);
+    StartRound();
+    VerifyOrExit(rval > 0);
+
+    for (int i = 0; i < rval; ++i)
+    {
+        Dispatch(events[i].data.fd, FromEpollEvents(events[i].events));
+    }
+
+exit:
+#else
+    (void)aTimeout;
+#endif
+
+    return rval;
+}
+
+int Reactor::WaitUring(int aTimeout)
+{
+    int rval = 0;
+
+#if OTBR_ENABLE_IO_URING
+    int          fd;
+    unsigned int events;
+
+    rval = mUring->Wait(aTimeout, mSignalMask);
+    StartRound();
+    VerifyOrExit(rval >= 0);
+    rval = 0;
+
+    while (mUring->Reap(fd, events))
+    {
+        Dispatch(fd, events);
+
+        // One-shot polls are re-armed once dispatched, and submitted by the next wait.
+        mUring->Rearm(fd);
+        rval++;
+    }
+
+exit:
+#else
+    (void)aTimeout;
+#endif
+
+    return rval;
+}
+
+int Reactor::GetBackendFd(void) const
+{
+#if OTBR_ENABLE_IO_URING
+    return mBackend == kBackendUring ? mUring->GetFd() : mEpollFd;
+#else
+    return mEpollFd;
+#endif
+}
+
+void Reactor::StartRound(void)
+{
+    mWakeTime             = GetMonotonicNowUs();
+    mSlowestHandler.mName = NULL;
+    mSlowestHandler.mFd   = -1;
+    mSlowestHandler.mTime = 0;
+    LoopClock::Start(mWakeTime);
+}
+
+int Reactor::Poll(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int aMaxFd, const timeval &aTimeout)
+{
+    int      rval = 0;
+    timespec timeout;
+
+    if (aMaxFd < 0 && mBackend != kBackendSelect)
+    {
+        ExitNow(rval = Wait(static_cast<int>(GetTimestamp(aTimeout))));
+    }
+
+    timeout.tv_sec  = aTimeout.tv_sec;
+    timeout.tv_nsec = aTimeout.tv_usec * 1000;
+    UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd);
+    rval = pselect(aMaxFd + 1, &aReadFdSet, &aWriteFdSet, &aErrorFdSet, &timeout, mSignalMask);
+    StartRound();
+    VerifyOrExit(rval > 0);
+    Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
+
+exit:
+    LoopClock::Stop();
+    return rval;
+}
+
+void Reactor::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd)
+{
+    if (mBackend != kBackendSelect)
+    {
+        int fd = GetBackendFd();
+
+#if OTBR_ENABLE_IO_URING
+        // The io_uring becomes readable on completions, which only come for polls submitted.
+        if (mBackend == kBackendUring && mUring->Submit() < 0)
+        {
+            otbrLog(OTBR_LOG_ERR, "Failed to submit polls: %s!", strerror(errno));
+        }
+#endif
+
+        FD_SET(fd, &aReadFdSet);
+
+        if (aMaxFd < fd)
+        {
+            aMaxFd = fd;
+        }
+
+        ExitNow();
+    }
+
+    for (size_t fd = 0; fd < mWatches.size(); ++fd)
+    {
+        unsigned int events;
+
+        if (mWatches[fd] == NULL)
+        {
+            continue;
+        }
+
+        events = GetEvents(static_cast<int>(fd));
+
+        if (events & kEventReadable)
+        {
+            FD_SET(fd, &aReadFdSet);
+        }
+
+        if (events & kEventWritable)
+        {
+            FD_SET(fd, &aWriteFdSet);
+        }
+
+        FD_SET(fd, &aErrorFdSet);
+
+        if (aMaxFd < static_cast<int>(fd))
+        {
+            aMaxFd = static_cast<int>(fd);
+        }
+    }
+
+exit:
+    (void)aWriteFdSet;
+    (void)aErrorFdSet;
+}
+
+void Reactor::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
+{
+    if (mBackend != kBackendSelect)
+    {
+        if (FD_ISSET(GetBackendFd(), &aReadFdSet))
+        {
+            Wait(0);
+        }
+
+        ExitNow();
+    }
+
+    for (size_t fd = 0; fd < mWatches.size(); ++fd)
+    {
+        unsigned int events = 0;
+
+        if (mWatches[fd] == NULL)
+        {
+            continue;
+        }
+
+        if (FD_ISSET(fd, &aReadFdSet))
+        {
+            events |= kEventReadable;
+        }
+
+        if (FD_ISSET(fd, &aWriteFdSet))
+        {
+            events |= kEventWritable;
+        }
+
+        if (FD_ISSET(fd, &aErrorFdSet))
+        {
+            events |= kEventError;
+        }
+
+        if (events)
+        {
+            Dispatch(static_cast<int>(fd), events);
+        }
+    }
+
+exit:
+    return;
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
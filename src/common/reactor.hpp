@@ -0,0 +1,328 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the file descriptor reactor used by the mainloop.
+ */
+
+#ifndef REACTOR_HPP_
+#define REACTOR_HPP_
+
+#include <vector>
+
+#include <signal.h>
+#include <stddef.h>
+#include <sys/select.h>
+#include <sys/time.h>
+
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class implements a reactor with persistent file descriptor registration.
+ *
+ * File descriptors are registered once and only those become ready are dispatched. On Linux the
+ * reactor is backed by epoll, otherwise it falls back to select(). When built with OTBR_ENABLE_IO_URING, it is
+ * backed by io_uring polls if the kernel supports them, so that changes of the registrations are submitted together
+ * with the wait in a single system call.
+ *
+ */
+class Reactor
+{
+public:
+    /**
+     * Events of a file descriptor.
+     *
+     */
+    enum
+    {
+        kEventReadable = 1 << 0, ///< The file descriptor is readable.
+        kEventWritable = 1 << 1, ///< The file descriptor is writable.
+        kEventError    = 1 << 2, ///< Error or hang up happened on the file descriptor.
+        kEventEdge     = 1 << 3, ///< Edge-triggered notification, the handler must drain the file descriptor.
+    };
+
+    /**
+     * Backends waiting for events.
+     *
+     */
+    enum Backend
+    {
+        kBackendSelect, ///< select(), through the fd_set interface.
+        kBackendEpoll,  ///< epoll.
+        kBackendUring,  ///< io_uring polls.
+    };
+
+    /**
+     * This function pointer is called when events happened on a registered file descriptor.
+     *
+     * @param[in]   aContext    A pointer to application-specific context.
+     * @param[in]   aFd         The file descriptor.
+     * @param[in]   aEvents     The events happened.
+     *
+     */
+    typedef void (*Handler)(void *aContext, int aFd, unsigned int aEvents);
+
+    /**
+     * This structure represents the registration of a file descriptor.
+     *
+     * The storage is owned by the caller and must stay valid until removed from the reactor. More
+     * than one watch may be registered on the same file descriptor.
+     *
+     */
+    struct Watch
+    {
+        int          mFd;      ///< The file descriptor to watch.
+        unsigned int mEvents;  ///< The interested events.
+        Handler      mHandler; ///< The function to be called when interested events happened.
+        void *       mContext; ///< A pointer to application-specific context.
+        Watch *      mNext;    ///< The next watch on the same file descriptor.
+        unsigned int mRound;   ///< The last dispatching round of this watch.
+        const char * mName;    ///< The name of the handler in diagnostics.
+
+        /**
+         * The constructor to initialize a watch.
+         *
+         */
+        Watch(void)
+            : mFd(-1)
+            , mEvents(0)
+            , mHandler(NULL)
+            , mContext(NULL)
+            , mNext(NULL)
+            , mRound(0)
+            , mName(NULL)
+        {
+        }
+    };
+
+    /**
+     * This structure represents the time a handler took.
+     *
+     */
+    struct HandlerTime
+    {
+        const char *mName; ///< The name of the handler, NULL if none was called.
+        int         mFd;   ///< The file descriptor the handler was called for.
+        uint32_t    mTime; ///< The time the handler took in microseconds.
+    };
+
+    /**
+     * The constructor to initialize a reactor.
+     *
+     */
+    Reactor(void);
+
+    ~Reactor(void);
+
+    /**
+     * This method initializes the reactor with the best backend available.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully initialized.
+     * @retval  OTBR_ERROR_ERRNO    Failed to initialize, error code set in errno.
+     *
+     */
+    otbrError Init(void);
+
+    /**
+     * This method initializes the reactor with a preferred backend.
+     *
+     * A backend not built in or not supported by the kernel falls back to the next one, from io_uring to epoll and
+     * then to select().
+     *
+     * @param[in]   aBackend    The preferred backend.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully initialized.
+     * @retval  OTBR_ERROR_ERRNO    Failed to initialize, error code set in errno.
+     *
+     */
+    otbrError Init(Backend aBackend);
+
+    /**
+     * This method returns the backend the reactor waits with.
+     *
+     */
+    Backend GetBackend(void) const { return mBackend; }
+
+    /**
+     * This method registers a file descriptor.
+     *
+     * @param[out]  aWatch      A reference to the watch storage.
+     * @param[in]   aFd         The file descriptor.
+     * @param[in]   aEvents     The interested events.
+     * @param[in]   aHandler    The function to be called when interested events happened.
+     * @param[in]   aContext    A pointer to application-specific context.
+     * @param[in]   aName       The name of the handler in diagnostics, which must outlive the watch.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully registered.
+     * @retval  OTBR_ERROR_ERRNO    Failed to register, error code set in errno.
+     *
+     */
+    otbrError Add(Watch &       aWatch,
+                  int          aFd,
+                  unsigned int aEvents,
+                  Handler      aHandler,
+                  void *       aContext,
+                  const char * aName = "unnamed");
+
+    /**
+     * This method updates the interested events of a registered watch.
+     *
+     * @param[in]   aWatch      A reference to the registered watch.
+     * @param[in]   aEvents     The interested events.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully updated.
+     * @retval  OTBR_ERROR_ERRNO    Failed to update, error code set in errno.
+     *
+     */
+    otbrError Modify(Watch &aWatch, unsigned int aEvents);
+
+    /**
+     * This method deregisters a watch.
+     *
+     * This method must be called before the file descriptor is closed. It is safe to call this method
+     * from within any handler.
+     *
+     * @param[in]   aWatch      A reference to the registered watch.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully deregistered.
+     * @retval  OTBR_ERROR_ERRNO    Failed to deregister, error code set in errno.
+     *
+     */
+    otbrError Remove(Watch &aWatch);
+
+    /**
+     * This method sets the signal mask while waiting.
+     *
+     * Signals blocked by the caller and not in @p aMask are only delivered while Poll() waits, which then returns -1
+     * with errno set to EINTR. Signal handlers setting flags thus always wake the caller up to check them.
+     *
+     * @param[in]   aMask   A pointer to the signal mask while waiting, which must outlive the reactor, NULL to keep
+     *                      the signal mask of the caller.
+     *
+     */
+    void SetSignalMask(const sigset_t *aMask) { mSignalMask = aMask; }
+
+    /**
+     * This method waits for events and dispatches them to handlers.
+     *
+     * File descriptors in @p aReadFdSet, @p aWriteFdSet and @p aErrorFdSet are polled together for
+     * components still using the fd_set interface. When @p aMaxFd is negative, the reactor waits on
+     * its own backend only. On return, the fd sets contain the legacy file descriptors that are ready.
+     *
+     * Handlers read the LoopClock at the time the reactor woke up, the clock is stopped again before returning.
+     *
+     * @param[inout]    aReadFdSet      A reference to fd_set for polling read.
+     * @param[inout]    aWriteFdSet     A reference to fd_set for polling write.
+     * @param[inout]    aErrorFdSet     A reference to fd_set for polling error.
+     * @param[in]       aMaxFd          The max legacy file descriptor, or -1 if none.
+     * @param[in]       aTimeout        A reference to the timeout.
+     *
+     * @returns The number of ready file descriptors, or -1 on error with errno set.
+     *
+     */
+    int Poll(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int aMaxFd, const timeval &aTimeout);
+
+    /**
+     * This method updates the fd_set for a select() based mainloop.
+     *
+     * This is a compatibility adapter to run the reactor inside a foreign mainloop.
+     *
+     * @param[inout]    aReadFdSet      A reference to fd_set for polling read.
+     * @param[inout]    aWriteFdSet     A reference to fd_set for polling write.
+     * @param[inout]    aErrorFdSet     A reference to fd_set for polling error.
+     * @param[inout]    aMaxFd          A reference to the current max fd.
+     *
+     */
+    void UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd);
+
+    /**
+     * This method dispatches events reported by a select() based mainloop.
+     *
+     * @param[in]   aReadFdSet          A reference to fd_set ready for reading.
+     * @param[in]   aWriteFdSet         A reference to fd_set ready for writing.
+     * @param[in]   aErrorFdSet         A reference to fd_set with error occurred.
+     *
+     */
+    void Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet);
+
+    /**
+     * This method returns when the last Poll() stopped waiting.
+     *
+     * @returns The monotonic time in microseconds Poll() last returned from waiting, 0 if it never did.
+     *
+     */
+    uint64_t GetWakeTime(void) const { return mWakeTime; }
+
+    /**
+     * This method returns the handler that took the longest since the last Poll() stopped waiting.
+     *
+     * @returns A reference to the name, file descriptor and time of the slowest handler.
+     *
+     */
+    const HandlerTime &GetSlowestHandler(void) const { return mSlowestHandler; }
+
+private:
+    enum
+    {
+        kMaxEvents = 64, ///< Max number of events retrieved in one wait.
+    };
+
+    typedef std::vector<Watch *> Watches;
+
+    class Uring;
+
+    unsigned int GetEvents(int aFd) const;
+    otbrError    Update(int aFd, unsigned int aOldEvents);
+    void         Dispatch(int aFd, unsigned int aEvents);
+    int          Wait(int aTimeout);
+    int          WaitEpoll(int aTimeout);
+    int          WaitUring(int aTimeout);
+    int          GetBackendFd(void) const;
+    void         StartRound(void);
+
+    Watches           mWatches;    ///< Lists of watches indexed by file descriptor.
+    std::vector<bool> mRegistered; ///< Whether each file descriptor is registered to the backend.
+    Backend           mBackend;
+    int               mEpollFd;
+    Uring *           mUring; ///< The io_uring, NULL unless it is the backend.
+    unsigned int      mRound;
+    uint64_t          mWakeTime;
+    HandlerTime       mSlowestHandler;
+    const sigset_t *  mSignalMask; ///< The signal mask while waiting, NULL to keep the one of the caller.
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // REACTOR_HPP_
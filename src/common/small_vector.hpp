@@ -0,0 +1,166 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of a vector storing its first elements inline.
+ */
+
+#ifndef SMALL_VECTOR_HPP_
+#define SMALL_VECTOR_HPP_
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class implements a vector of elements copied as bytes, like pointers, storing up to @p kInline of them inline.
+ *
+ * A vector within its inline capacity takes no allocation, and its elements share the cache lines of its owner.
+ *
+ */
+template <typename Type, size_t kInline> class SmallVector
+{
+public:
+    /**
+     * The constructor initializes an empty vector.
+     *
+     */
+    SmallVector(void)
+        : mData(mInline)
+        , mSize(0)
+        , mCapacity(kInline)
+    {
+    }
+
+    /**
+     * The destructor frees the elements beyond the inline storage.
+     *
+     */
+    ~SmallVector(void)
+    {
+        if (mData != mInline)
+        {
+            free(mData);
+        }
+    }
+
+    Type *      Begin(void) { return mData; }
+    Type *      End(void) { return mData + mSize; }
+    const Type *Begin(void) const { return mData; }
+    const Type *End(void) const { return mData + mSize; }
+
+    /**
+     * This method returns the number of elements.
+     *
+     */
+    size_t GetSize(void) const { return mSize; }
+
+    Type &      operator[](size_t aIndex) { return mData[aIndex]; }
+    const Type &operator[](size_t aIndex) const { return mData[aIndex]; }
+
+    /**
+     * This method appends an element.
+     *
+     * @param[in]  aValue  The element.
+     *
+     * @retval true   Successfully appended the element.
+     * @retval false  Failed to allocate the elements, the vector is unchanged.
+     *
+     */
+    bool PushBack(const Type &aValue)
+    {
+        bool ok = (mSize < mCapacity || Grow());
+
+        if (ok)
+        {
+            mData[mSize++] = aValue;
+        }
+
+        return ok;
+    }
+
+    /**
+     * This method erases an element, keeping the order of the others.
+     *
+     * @param[in]  aElement  A pointer to the element.
+     *
+     */
+    void Erase(Type *aElement)
+    {
+        memmove(aElement, aElement + 1, static_cast<size_t>(End() - aElement - 1) * sizeof(Type));
+        mSize--;
+    }
+
+    /**
+     * This method erases all elements, keeping the allocation.
+     *
+     */
+    void Clear(void) { mSize = 0; }
+
+private:
+    SmallVector(const SmallVector &);
+    SmallVector &operator=(const SmallVector &);
+
+    bool Grow(void)
+    {
+        size_t capacity = mCapacity * 2;
+        Type * data     = static_cast<Type *>(malloc(capacity * sizeof(Type)));
+        bool   ok       = (data != NULL);
+
+        if (ok)
+        {
+            memcpy(data, mData, mSize * sizeof(Type));
+
+            if (mData != mInline)
+            {
+                free(mData);
+            }
+
+            mData     = data;
+            mCapacity = capacity;
+        }
+
+        return ok;
+    }
+
+    Type * mData;            ///< The elements, mInline or allocated.
+    size_t mSize;            ///< Number of elements.
+    size_t mCapacity;        ///< Number of elements mData holds.
+    Type   mInline[kInline]; ///< The inline elements.
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // SMALL_VECTOR_HPP_
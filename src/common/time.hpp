@@ -32,6 +32,7 @@
 #include <stdint.h>
 
 #include <sys/time.h>
+#include <time.h>
 
 namespace ot {
 
@@ -53,6 +54,9 @@ inline unsigned long GetTimestamp(const timeval &aTime)
 /**
  * This method returns the current timestamp in miniseconds.
  *
+ * The timestamp follows changes of the system wall clock, so it is not to be used for timeouts, see
+ * GetMonotonicNow().
+ *
  * @returns Current timestamp in miniseconds.
  *
  */
@@ -64,6 +68,166 @@ inline unsigned long GetNow(void)
     return static_cast<unsigned long>(now.tv_sec * 1000 + now.tv_usec / 1000);
 }
 
+/**
+ * This class implements a virtual monotonic clock, which tests advance by hand.
+ *
+ * While the clock is set, GetMonotonicNow() and GetMonotonicNowUs() return its time in every thread, and so does
+ * LoopClock, so expiring session, keep-alive and timer timeouts only takes advancing the clock and processing,
+ * instead of waiting for them. Waits of the mainloop still take real time, tests process without waiting for the
+ * timeouts. The clock is only set by tests, reading it otherwise costs one load.
+ *
+ */
+class VirtualClock
+{
+public:
+    /**
+     * This method sets the virtual clock.
+     *
+     * @param[in]   aNowUs  The monotonic time in microseconds, greater than 0.
+     *
+     */
+    static void Set(uint64_t aNowUs) { __atomic_store_n(&GetNowUsRef(), aNowUs, __ATOMIC_RELAXED); }
+
+    /**
+     * This method advances the virtual clock, which must be set.
+     *
+     * @param[in]   aDelayUs    The time in microseconds to advance by.
+     *
+     */
+    static void Advance(uint64_t aDelayUs) { __atomic_add_fetch(&GetNowUsRef(), aDelayUs, __ATOMIC_RELAXED); }
+
+    /**
+     * This method clears the virtual clock, the system clock is then read again.
+     *
+     */
+    static void Clear(void) { Set(0); }
+
+    /**
+     * This method returns the time of the virtual clock.
+     *
+     * @returns The time in microseconds, 0 if the clock is not set.
+     *
+     */
+    static uint64_t GetNowUs(void) { return __atomic_load_n(&GetNowUsRef(), __ATOMIC_RELAXED); }
+
+private:
+    // A static of an inline function is shared by every library, without a definition in any of them.
+    static uint64_t &GetNowUsRef(void)
+    {
+        static uint64_t sNowUs = 0;
+
+        return sNowUs;
+    }
+};
+
+/**
+ * This method returns the current monotonic timestamp in miniseconds.
+ *
+ * Unlike GetNow(), the returned value is not affected by changes of the system wall clock.
+ *
+ * @returns Current monotonic timestamp in miniseconds, of the VirtualClock while it is set.
+ *
+ */
+inline uint64_t GetMonotonicNow(void)
+{
+    timespec now;
+    uint64_t virtualNow = VirtualClock::GetNowUs();
+
+    if (virtualNow != 0)
+    {
+        return virtualNow / 1000;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000 + static_cast<uint64_t>(now.tv_nsec / 1000000);
+}
+
+/**
+ * This method returns the current monotonic timestamp in microseconds.
+ *
+ * @returns Current monotonic timestamp in microseconds, of the VirtualClock while it is set.
+ *
+ */
+inline uint64_t GetMonotonicNowUs(void)
+{
+    timespec now;
+    uint64_t virtualNow = VirtualClock::GetNowUs();
+
+    if (virtualNow != 0)
+    {
+        return virtualNow;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + static_cast<uint64_t>(now.tv_nsec / 1000);
+}
+
+/**
+ * This method returns the CPU time consumed by the calling thread in microseconds.
+ *
+ * Unlike GetMonotonicNowUs(), the time excludes waits and other threads, and the VirtualClock does not apply.
+ *
+ * @returns CPU time of the calling thread in microseconds.
+ *
+ */
+inline uint64_t GetThreadCpuTimeUs(void)
+{
+    timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + static_cast<uint64_t>(now.tv_nsec / 1000);
+}
+
+/**
+ * This class implements the monotonic clock of a mainloop iteration.
+ *
+ * The clock is sampled once as the iteration wakes up, and read by whatever the iteration processes, so that the
+ * timeouts of every session and timer are checked without reading the clock each time. Whoever starts an iteration
+ * stops it before returning, so outside of an iteration, and while the VirtualClock is set, the current time is read.
+ * Each thread has its own clock, so that instances and workers running on other threads are not affected. Latencies
+ * are measured with GetMonotonicNowUs() instead.
+ *
+ */
+class LoopClock
+{
+public:
+    /**
+     * This method starts an iteration of the calling thread.
+     *
+     * @param[in]   aNowUs  The monotonic time in microseconds the iteration woke up at, greater than 0.
+     *
+     */
+    static void Start(uint64_t aNowUs) { sNowUs = aNowUs; }
+
+    /**
+     * This method ends the iteration of the calling thread, the current time is then read again.
+     *
+     */
+    static void Stop(void) { sNowUs = 0; }
+
+    /**
+     * This method returns the monotonic time of the iteration in milliseconds.
+     *
+     * @returns The time the iteration woke up at, the current time outside of an iteration.
+     *
+     */
+    static uint64_t GetNow(void) { return GetNowUs() / 1000; }
+
+    /**
+     * This method returns the monotonic time of the iteration in microseconds.
+     *
+     * @returns The time the iteration woke up at, the current time outside of an iteration.
+     *
+     */
+    static uint64_t GetNowUs(void)
+    {
+        return sNowUs != 0 && VirtualClock::GetNowUs() == 0 ? sNowUs : GetMonotonicNowUs();
+    }
+
+private:
+    static __thread uint64_t sNowUs;
+};
+
 } // namespace BorderRouter
 
 } // namespace ot
@@ -0,0 +1,261 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the timeline of agent activity.
+ */
+
+#include "timeline.hpp"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/time.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Timeline {
+
+const char kExportContentType[] = "application/json";
+
+struct Event
+{
+    uint64_t    mTime;     ///< Monotonic microseconds the event was recorded at.
+    uint64_t    mDuration; ///< Microseconds of complete spans.
+    const char *mName;
+    char        mPhase; ///< 'B' for beginnings, 'E' for ends and 'X' for complete spans.
+};
+
+struct Ring
+{
+    Ring *       mNext;
+    long         mThreadId;
+    size_t       mCapacity; ///< Number of events allocated.
+    size_t       mSize;     ///< Number of events kept since the start.
+    unsigned int mGeneration; ///< The start the events were recorded since.
+    uint64_t     mCount;      ///< Number of events recorded since the start.
+    Event        mEvents[1];
+};
+
+static Ring *       sRings      = NULL; ///< Rings of all threads, pushed when allocated.
+static size_t       sSize       = 0;
+static unsigned int sGeneration = 0;
+static bool         sStarted    = false;
+
+// The ring of the calling thread.
+static __thread Ring *sRing = NULL;
+
+otbrError Start(size_t aSize)
+{
+    otbrError error = OTBR_ERROR_ERRNO;
+
+    VerifyOrExit(aSize > 0, errno = EINVAL);
+
+    // Each thread drops its events when it next records, as only it writes its ring.
+    sSize = aSize;
+    __atomic_add_fetch(&sGeneration, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&sStarted, true, __ATOMIC_RELEASE);
+    error = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+void Stop(void)
+{
+    __atomic_store_n(&sStarted, false, __ATOMIC_RELEASE);
+}
+
+static Ring *GetRing(void)
+{
+    Ring *       ring       = sRing;
+    unsigned int generation = __atomic_load_n(&sGeneration, __ATOMIC_ACQUIRE);
+    size_t       size       = sSize;
+
+    VerifyOrExit(ring == NULL || ring->mGeneration != generation);
+
+    // A ring too small for this start is left behind, exporting skips it as it never records again.
+    if (ring == NULL || ring->mCapacity < size)
+    {
+        VerifyOrExit((ring = static_cast<Ring *>(malloc(sizeof(Ring) + (size - 1) * sizeof(Event)))) != NULL);
+        ring->mThreadId   = syscall(SYS_gettid);
+        ring->mCapacity   = size;
+        ring->mGeneration = 0;
+        ring->mNext       = __atomic_load_n(&sRings, __ATOMIC_RELAXED);
+
+        while (!__atomic_compare_exchange_n(&sRings, &ring->mNext, ring, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+
+        sRing = ring;
+    }
+
+    ring->mSize = size;
+    __atomic_store_n(&ring->mCount, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->mGeneration, generation, __ATOMIC_RELEASE);
+
+exit:
+    return ring;
+}
+
+static void Record(char aPhase, const char *aName, uint64_t aTime, uint64_t aDuration)
+{
+    Ring *   ring;
+    Event *  event;
+    uint64_t count;
+
+    VerifyOrExit(__atomic_load_n(&sStarted, __ATOMIC_RELAXED));
+    VerifyOrExit((ring = GetRing()) != NULL);
+
+    count            = ring->mCount;
+    event            = &ring->mEvents[count % ring->mSize];
+    event->mTime     = aTime;
+    event->mDuration = aDuration;
+    event->mName     = aName;
+    event->mPhase    = aPhase;
+
+    // Exporting reads the events below the count.
+    __atomic_store_n(&ring->mCount, count + 1, __ATOMIC_RELEASE);
+
+exit:
+    return;
+}
+
+void Begin(const char *aName)
+{
+    Record('B', aName, GetMonotonicNowUs(), 0);
+}
+
+void End(const char *aName)
+{
+    Record('E', aName, GetMonotonicNowUs(), 0);
+}
+
+void Complete(const char *aName, uint64_t aStart, uint64_t aDuration)
+{
+    Record('X', aName, aStart, aDuration);
+}
+
+static void AppendName(std::string &aOutput, const char *aName)
+{
+    for (const char *c = aName; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            aOutput += '\\';
+        }
+
+        // Names are static strings, control characters are not expected and dropped.
+        if (static_cast<unsigned char>(*c) >= 0x20)
+        {
+            aOutput += *c;
+        }
+    }
+}
+
+size_t Export(std::string &aOutput)
+{
+    unsigned int generation = __atomic_load_n(&sGeneration, __ATOMIC_ACQUIRE);
+    long         pid        = static_cast<long>(getpid());
+    size_t       exported   = 0;
+    char         line[128];
+
+    aOutput += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (const Ring *ring = __atomic_load_n(&sRings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->mNext)
+    {
+        uint64_t count = __atomic_load_n(&ring->mCount, __ATOMIC_ACQUIRE);
+        uint64_t first = count > ring->mSize ? count - ring->mSize : 0;
+
+        // Threads not having recorded since the start still hold the events of a previous one.
+        if (__atomic_load_n(&ring->mGeneration, __ATOMIC_ACQUIRE) != generation)
+        {
+            continue;
+        }
+
+        for (uint64_t i = first; i != count; ++i)
+        {
+            const Event &event = ring->mEvents[i % ring->mSize];
+
+            aOutput += exported == 0 ? "\n{\"name\":\"" : ",\n{\"name\":\"";
+            AppendName(aOutput, event.mName);
+            snprintf(line, sizeof(line), "\",\"cat\":\"otbr\",\"ph\":\"%c\",\"ts\":%" PRIu64 ",\"pid\":%ld,\"tid\":%ld",
+                     event.mPhase, event.mTime, pid, ring->mThreadId);
+            aOutput += line;
+
+            if (event.mPhase == 'X')
+            {
+                snprintf(line, sizeof(line), ",\"dur\":%" PRIu64, event.mDuration);
+                aOutput += line;
+            }
+
+            aOutput += '}';
+            ++exported;
+        }
+    }
+
+    aOutput += "\n]}\n";
+
+    return exported;
+}
+
+otbrError Save(const char *aFilename)
+{
+    otbrError   error = OTBR_ERROR_ERRNO;
+    FILE *      file  = NULL;
+    std::string output;
+    size_t      count = Export(output);
+
+    VerifyOrExit((file = fopen(aFilename, "w")) != NULL);
+    VerifyOrExit(fwrite(output.data(), 1, output.size(), file) == output.size(), errno = EIO);
+    VerifyOrExit(fflush(file) == 0);
+    otbrLog(OTBR_LOG_INFO, "Saved %u timeline events to %s", static_cast<unsigned int>(count), aFilename);
+    error = OTBR_ERROR_NONE;
+
+exit:
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+
+    return error;
+}
+
+} // namespace Timeline
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,187 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the timeline of agent activity.
+ */
+
+#ifndef TIMELINE_HPP_
+#define TIMELINE_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Timeline {
+
+/**
+ * @addtogroup border-router-timeline
+ *
+ * @brief
+ *   This module records spans of agent activity, which are exported as a Chrome trace, e.g. for Perfetto.
+ *
+ * Each thread records to a ring of its own, allocated when it first records after the timeline is started, so
+ * recording never locks. Rings are never freed, a thread only allocates a new one when started with a larger size.
+ * Until the timeline is started, recording costs a branch. Event names are not copied and must be static.
+ *
+ * Starting, stopping and exporting must be done from the mainloop. An event recorded while the timeline is exported
+ * may be exported partially written.
+ *
+ * @{
+ */
+
+enum
+{
+    kDefaultSize = 8192, ///< Default number of events kept per thread.
+};
+
+/**
+ * This function starts recording events, dropping the events previously recorded.
+ *
+ * @param[in]   aSize   The number of events kept per thread, older events are overwritten.
+ *
+ * @retval  OTBR_ERROR_NONE     Successfully started.
+ * @retval  OTBR_ERROR_ERRNO    Failed to start, error code set in errno.
+ *
+ */
+otbrError Start(size_t aSize = kDefaultSize);
+
+/**
+ * This function stops recording events, the events recorded are kept until the next start.
+ *
+ */
+void Stop(void);
+
+/**
+ * This function records the beginning of a span on the calling thread.
+ *
+ * Spans of a thread must be nested, i.e. end in the reverse order of their beginnings.
+ *
+ * @param[in]   aName   The name of the span, which must outlive the timeline.
+ *
+ */
+void Begin(const char *aName);
+
+/**
+ * This function records the end of the span of the calling thread begun last.
+ *
+ * @param[in]   aName   The name of the span, which must outlive the timeline.
+ *
+ */
+void End(const char *aName);
+
+/**
+ * This function records a span already completed, e.g. one spread over several mainloop iterations.
+ *
+ * @param[in]   aName       The name of the span, which must outlive the timeline.
+ * @param[in]   aStart      The monotonic time in microseconds the span began at, see GetMonotonicNowUs().
+ * @param[in]   aDuration   The duration of the span in microseconds.
+ *
+ */
+void Complete(const char *aName, uint64_t aStart, uint64_t aDuration);
+
+/**
+ * This class records a span for the lifetime of an object.
+ *
+ */
+class Span
+{
+public:
+    /**
+     * The constructor records the beginning of the span.
+     *
+     * @param[in]   aName   The name of the span, which must outlive the timeline.
+     *
+     */
+    explicit Span(const char *aName)
+        : mName(aName)
+    {
+        Begin(aName);
+    }
+
+    /**
+     * The destructor records the end of the span.
+     *
+     */
+    ~Span(void) { End(mName); }
+
+private:
+    Span(const Span &);
+    Span &operator=(const Span &);
+
+    const char *mName;
+};
+
+/**
+ * This function appends the events of all threads in the Chrome trace event JSON format, oldest first per thread.
+ *
+ * Events stay in the rings, so a later export includes them again unless they were overwritten.
+ *
+ * @param[out]  aOutput     A reference to the string to append to.
+ *
+ * @returns The number of events exported.
+ *
+ */
+size_t Export(std::string &aOutput);
+
+/**
+ * The content type of the output of Export().
+ *
+ */
+extern const char kExportContentType[];
+
+/**
+ * This function writes the events of all threads to a file in the Chrome trace event JSON format.
+ *
+ * @param[in]   aFilename   The name of the file, which is replaced.
+ *
+ * @retval  OTBR_ERROR_NONE     Successfully written.
+ * @retval  OTBR_ERROR_ERRNO    Failed to write the file, error code set in errno.
+ *
+ */
+otbrError Save(const char *aFilename);
+
+/**
+ * @}
+ */
+
+} // namespace Timeline
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // TIMELINE_HPP_
@@ -0,0 +1,284 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the hierarchical timer wheel shared by the agent services.
+ */
+
+#include "common/timer.hpp"
+
+#include <assert.h>
+#include <string.h>
+
+#include "common/code_utils.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+__thread uint64_t LoopClock::sNowUs = 0;
+
+Timer::~Timer(void)
+{
+    if (IsRunning())
+    {
+        mWheel->Stop(*this);
+    }
+}
+
+TimerWheel::TimerWheel(uint64_t aNow)
+    : mNow(aNow)
+{
+    memset(mSlots, 0, sizeof(mSlots));
+    memset(mBitmaps, 0, sizeof(mBitmaps));
+}
+
+TimerWheel::~TimerWheel(void)
+{
+    for (unsigned int level = 0; level < kLevels; ++level)
+    {
+        for (unsigned int slot = 0; slot < kSlots; ++slot)
+        {
+            for (Timer *timer = mSlots[level][slot]; timer != NULL;)
+            {
+                Timer *next = timer->mNext;
+
+                timer->mNext  = NULL;
+                timer->mPrev  = NULL;
+                timer->mWheel = NULL;
+                timer         = next;
+            }
+        }
+    }
+}
+
+void TimerWheel::StartAt(Timer &aTimer, uint64_t aFireTime)
+{
+    if (aTimer.IsRunning())
+    {
+        aTimer.mWheel->Stop(aTimer);
+    }
+
+    aTimer.mFireTime = aFireTime;
+    aTimer.mWheel    = this;
+    Link(aTimer);
+}
+
+void TimerWheel::Stop(Timer &aTimer)
+{
+    VerifyOrExit(aTimer.IsRunning());
+    assert(aTimer.mWheel == this);
+
+    Unlink(aTimer);
+
+exit:
+    return;
+}
+
+void TimerWheel::Link(Timer &aTimer)
+{
+    // Timers already expired are fired on the next processing.
+    uint64_t     fireTime = aTimer.mFireTime > mNow ? aTimer.mFireTime : mNow;
+    unsigned int level    = 0;
+    unsigned int slot;
+
+    // Use the finest level whose current round covers the fire time, timers too far away are
+    // kept in the coarsest level and re-linked when visited.
+    while (level < kLevels - 1 && ((fireTime ^ mNow) >> ((level + 1) * kSlotBits)) != 0)
+    {
+        ++level;
+    }
+
+    slot = static_cast<unsigned int>(fireTime >> (level * kSlotBits)) & (kSlots - 1);
+
+    aTimer.mLevel = static_cast<uint8_t>(level);
+    aTimer.mSlot  = static_cast<uint8_t>(slot);
+    aTimer.mNext  = mSlots[level][slot];
+    aTimer.mPrev  = &mSlots[level][slot];
+
+    if (aTimer.mNext != NULL)
+    {
+        aTimer.mNext->mPrev = &aTimer.mNext;
+    }
+
+    mSlots[level][slot] = &aTimer;
+    mBitmaps[level] |= (1ULL << slot);
+}
+
+void TimerWheel::Unlink(Timer &aTimer)
+{
+    *aTimer.mPrev = aTimer.mNext;
+
+    if (aTimer.mNext != NULL)
+    {
+        aTimer.mNext->mPrev = aTimer.mPrev;
+    }
+
+    aTimer.mNext = NULL;
+    aTimer.mPrev = NULL;
+
+    // The timer may be in a list detached for firing, whose slot has been cleared already.
+    if (mSlots[aTimer.mLevel][aTimer.mSlot] == NULL)
+    {
+        mBitmaps[aTimer.mLevel] &= ~(1ULL << aTimer.mSlot);
+    }
+}
+
+bool TimerWheel::GetNextTime(uint64_t &aTime) const
+{
+    bool found = false;
+
+    for (unsigned int level = 0; level < kLevels; ++level)
+    {
+        unsigned int shift  = level * kSlotBits;
+        uint64_t     bitmap = mBitmaps[level];
+        uint64_t     first;
+        unsigned int index;
+        uint64_t     time;
+
+        if (bitmap == 0)
+        {
+            continue;
+        }
+
+        // The first slot of this level visited at or after mNow.
+        first = (mNow + (1ULL << shift) - 1) >> shift;
+        index = static_cast<unsigned int>(first) & (kSlots - 1);
+
+        if (index != 0)
+        {
+            bitmap = (bitmap >> index) | (bitmap << (kSlots - index));
+        }
+
+        time = (first + static_cast<unsigned int>(__builtin_ctzll(bitmap))) << shift;
+
+        if (!found || time < aTime)
+        {
+            aTime = time;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+void TimerWheel::UpdateTimeout(timeval &aTimeout) const
+{
+    uint64_t next;
+    uint64_t now;
+    uint64_t delay;
+
+    VerifyOrExit(GetNextTime(next));
+
+    now   = GetMonotonicNow();
+    delay = next > now ? next - now : 0;
+
+    if (delay < GetTimestamp(aTimeout))
+    {
+        aTimeout.tv_sec  = static_cast<time_t>(delay / 1000);
+        aTimeout.tv_usec = static_cast<suseconds_t>((delay % 1000) * 1000);
+    }
+
+exit:
+    return;
+}
+
+void TimerWheel::Process(uint64_t aNow)
+{
+    while (mNow <= aNow)
+    {
+        uint64_t next;
+
+        // Nothing happens until next, skip directly.
+        if (!GetNextTime(next) || next > aNow)
+        {
+            mNow = aNow + 1;
+            break;
+        }
+
+        mNow = next;
+
+        for (unsigned int level = kLevels - 1; level > 0; --level)
+        {
+            if ((mNow & ((1ULL << (level * kSlotBits)) - 1)) == 0)
+            {
+                Cascade(level);
+            }
+        }
+
+        Fire();
+    }
+}
+
+void TimerWheel::Cascade(unsigned int aLevel)
+{
+    unsigned int slot  = static_cast<unsigned int>(mNow >> (aLevel * kSlotBits)) & (kSlots - 1);
+    Timer *      timer = mSlots[aLevel][slot];
+
+    mSlots[aLevel][slot] = NULL;
+    mBitmaps[aLevel] &= ~(1ULL << slot);
+
+    while (timer != NULL)
+    {
+        Timer *next = timer->mNext;
+
+        Link(*timer);
+        timer = next;
+    }
+}
+
+void TimerWheel::Fire(void)
+{
+    unsigned int slot    = static_cast<unsigned int>(mNow) & (kSlots - 1);
+    Timer *      pending = mSlots[0][slot];
+
+    mSlots[0][slot] = NULL;
+    mBitmaps[0] &= ~(1ULL << slot);
+
+    if (pending != NULL)
+    {
+        pending->mPrev = &pending;
+    }
+
+    // Timers started by handlers are linked after this time.
+    ++mNow;
+
+    // Handlers may stop or restart any timer, including the pending ones.
+    while (pending != NULL)
+    {
+        Timer *timer = pending;
+
+        Unlink(*timer);
+        timer->mHandler(timer->mContext);
+    }
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,224 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the hierarchical timer wheel shared by the agent services.
+ */
+
+#ifndef TIMER_HPP_
+#define TIMER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+#include "common/time.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+class TimerWheel;
+
+/**
+ * This class represents a one-shot timer scheduled by a TimerWheel.
+ *
+ * The storage is owned by the caller. A running timer is stopped when destroyed.
+ *
+ */
+class Timer
+{
+    friend class TimerWheel;
+
+public:
+    /**
+     * This function pointer is called when the timer fires.
+     *
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    typedef void (*Handler)(void *aContext);
+
+    /**
+     * The constructor to initialize a timer.
+     *
+     * @param[in]   aHandler    The function to be called when the timer fires.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    Timer(Handler aHandler, void *aContext)
+        : mHandler(aHandler)
+        , mContext(aContext)
+        , mFireTime(0)
+        , mWheel(NULL)
+        , mNext(NULL)
+        , mPrev(NULL)
+        , mLevel(0)
+        , mSlot(0)
+    {
+    }
+
+    ~Timer(void);
+
+    /**
+     * This method indicates whether the timer is running.
+     *
+     * @retval  true    The timer is running.
+     * @retval  false   The timer is not running.
+     *
+     */
+    bool IsRunning(void) const { return mPrev != NULL; }
+
+    /**
+     * This method returns the monotonic time in miniseconds when the timer fires.
+     *
+     * @returns The fire time, only meaningful when the timer is running.
+     *
+     */
+    uint64_t GetFireTime(void) const { return mFireTime; }
+
+private:
+    Timer(const Timer &);
+    Timer &operator=(const Timer &);
+
+    Handler     mHandler;
+    void *      mContext;
+    uint64_t    mFireTime;
+    TimerWheel *mWheel;
+    Timer *     mNext;
+    Timer **    mPrev;
+    uint8_t     mLevel;
+    uint8_t     mSlot;
+};
+
+/**
+ * This class implements a hierarchical timer wheel on the monotonic clock.
+ *
+ * Starting and stopping a timer costs O(1), so does finding the next time the wheel needs to be
+ * processed, regardless of how many timers are running. The resolution is one millisecond.
+ *
+ */
+class TimerWheel
+{
+public:
+    /**
+     * The constructor to initialize a timer wheel.
+     *
+     * @param[in]   aNow    The current monotonic time in miniseconds.
+     *
+     */
+    explicit TimerWheel(uint64_t aNow = GetMonotonicNow());
+
+    ~TimerWheel(void);
+
+    /**
+     * This method starts a timer, or restarts it if already running.
+     *
+     * @param[in]   aTimer      A reference to the timer.
+     * @param[in]   aDelay      The delay in miniseconds from now.
+     *
+     */
+    void Start(Timer &aTimer, uint64_t aDelay) { StartAt(aTimer, LoopClock::GetNow() + aDelay); }
+
+    /**
+     * This method starts a timer at an absolute monotonic time, or restarts it if already running.
+     *
+     * @param[in]   aTimer      A reference to the timer.
+     * @param[in]   aFireTime   The monotonic time in miniseconds when the timer fires.
+     *
+     */
+    void StartAt(Timer &aTimer, uint64_t aFireTime);
+
+    /**
+     * This method stops a timer. Nothing happens if the timer is not running.
+     *
+     * @param[in]   aTimer      A reference to the timer.
+     *
+     */
+    void Stop(Timer &aTimer);
+
+    /**
+     * This method returns the next time the wheel needs to be processed.
+     *
+     * The returned time may be earlier than the first timer to fire, when timers have to be moved
+     * to a finer level of the wheel.
+     *
+     * @param[out]  aTime   The monotonic time in miniseconds.
+     *
+     * @retval  true    @p aTime is set.
+     * @retval  false   No timer is running.
+     *
+     */
+    bool GetNextTime(uint64_t &aTime) const;
+
+    /**
+     * This method shortens the given timeout so that the wheel is processed in time.
+     *
+     * @param[inout]    aTimeout    A reference to the timeout.
+     *
+     */
+    void UpdateTimeout(timeval &aTimeout) const;
+
+    /**
+     * This method fires all timers expired by now.
+     *
+     */
+    void Process(void) { Process(GetMonotonicNow()); }
+
+    /**
+     * This method fires all timers expired by the given time.
+     *
+     * @param[in]   aNow    The current monotonic time in miniseconds.
+     *
+     */
+    void Process(uint64_t aNow);
+
+private:
+    enum
+    {
+        kSlotBits = 6,
+        kSlots    = 1 << kSlotBits,
+        kLevels   = 4,
+    };
+
+    void Link(Timer &aTimer);
+    void Unlink(Timer &aTimer);
+    void Cascade(unsigned int aLevel);
+    void Fire(void);
+
+    Timer *  mSlots[kLevels][kSlots];
+    uint64_t mBitmaps[kLevels];
+    uint64_t mNow; ///< The next time to be processed.
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // TIMER_HPP_
@@ -34,6 +34,10 @@
 #ifndef TLV_HPP_
 #define TLV_HPP_
 
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
 namespace ot {
 
 /**
@@ -181,6 +185,357 @@ private:
     uint8_t mLength;
 };
 
+/**
+ * This class iterates the TLVs of a payload, checking each TLV against the end of the payload.
+ *
+ * The TLVs are read in place. Iteration stops at the first TLV extending past the end, which is reported as
+ * malformed.
+ *
+ */
+class TlvReader
+{
+public:
+    /**
+     * This constructor initializes the reader at the first TLV of a payload.
+     *
+     * @param[in]  aBuffer  A pointer to the payload.
+     * @param[in]  aLength  The length of the payload.
+     *
+     */
+    TlvReader(const uint8_t *aBuffer, uint16_t aLength)
+        : mCursor(aBuffer)
+        , mEnd(aBuffer + aLength)
+        , mMalformed(false)
+    {
+    }
+
+    /**
+     * This method returns the next TLV.
+     *
+     * @returns A pointer to the next TLV, NULL at the end of the payload or at a malformed TLV.
+     *
+     */
+    const Tlv *GetNext(void)
+    {
+        const Tlv *tlv    = reinterpret_cast<const Tlv *>(mCursor);
+        size_t     remain = static_cast<size_t>(mEnd - mCursor);
+        size_t     header = kHeaderLength;
+        size_t     length;
+
+        if (remain == 0 || mMalformed)
+        {
+            return NULL;
+        }
+
+        if (remain >= kHeaderLength && mCursor[1] == kLengthEscape)
+        {
+            header = kExtendedHeaderLength;
+        }
+
+        if (remain < header || remain - header < (length = tlv->GetLength()))
+        {
+            mMalformed = true;
+            return NULL;
+        }
+
+        mCursor += header + length;
+
+        return tlv;
+    }
+
+    /**
+     * This method returns the next TLV of a type.
+     *
+     * @param[in]  aType  The TLV type.
+     *
+     * @returns A pointer to the TLV, NULL if not found before the end of the payload or a malformed TLV.
+     *
+     */
+    const Tlv *Find(uint8_t aType)
+    {
+        const Tlv *tlv;
+
+        while ((tlv = GetNext()) != NULL && tlv->GetType() != aType)
+        {
+        }
+
+        return tlv;
+    }
+
+    /**
+     * This method finds the TLVs of several types in a single pass over the remaining payload.
+     *
+     * @param[in]   aTypes  A pointer to the TLV types.
+     * @param[out]  aTlvs   A pointer to receive the first TLV of each type, NULL if not found.
+     * @param[in]   aCount  The number of types.
+     *
+     * @retval true   Successfully read the payload up to its end.
+     * @retval false  The payload has a malformed TLV, the TLVs before it were indexed.
+     *
+     */
+    bool Index(const uint8_t *aTypes, const Tlv **aTlvs, size_t aCount)
+    {
+        const Tlv *tlv;
+
+        for (size_t i = 0; i < aCount; i++)
+        {
+            aTlvs[i] = NULL;
+        }
+
+        while ((tlv = GetNext()) != NULL)
+        {
+            for (size_t i = 0; i < aCount; i++)
+            {
+                if (aTlvs[i] == NULL && aTypes[i] == tlv->GetType())
+                {
+                    aTlvs[i] = tlv;
+                }
+            }
+        }
+
+        return !mMalformed;
+    }
+
+    /**
+     * This method indicates whether the iteration stopped at a malformed TLV.
+     *
+     * @retval true   A TLV extends past the end of the payload.
+     * @retval false  All TLVs read so far are well formed.
+     *
+     */
+    bool IsMalformed(void) const { return mMalformed; }
+
+private:
+    enum
+    {
+        kHeaderLength         = 2,    ///< Length of the type and length bytes.
+        kExtendedHeaderLength = 4,    ///< Length of the header with a two-bytes length.
+        kLengthEscape         = 0xff, ///< This length value indicates the actual length is of two-bytes length.
+    };
+
+    const uint8_t *mCursor;
+    const uint8_t *mEnd;
+    bool           mMalformed;
+};
+
+/**
+ * This class indexes the first TLV of each type of a payload, built in a single pass.
+ *
+ * Lookups take constant time, and the offsets let a copy of the payload be rewritten in place.
+ *
+ */
+class TlvIndex
+{
+public:
+    /**
+     * This constructor initializes an empty index.
+     *
+     */
+    TlvIndex(void)
+        : mBuffer(NULL)
+    {
+        memset(mPresent, 0, sizeof(mPresent));
+    }
+
+    /**
+     * This method indexes the TLVs of a payload, replacing the TLVs indexed before.
+     *
+     * @param[in]  aBuffer  A pointer to the payload, which must outlive the lookups.
+     * @param[in]  aLength  The length of the payload.
+     *
+     * @retval true   Successfully indexed the payload up to its end.
+     * @retval false  The payload has a malformed TLV, the TLVs before it were indexed.
+     *
+     */
+    bool Build(const uint8_t *aBuffer, uint16_t aLength)
+    {
+        TlvReader  reader(aBuffer, aLength);
+        const Tlv *tlv;
+
+        mBuffer = aBuffer;
+        memset(mPresent, 0, sizeof(mPresent));
+
+        while ((tlv = reader.GetNext()) != NULL)
+        {
+            uint8_t type = tlv->GetType();
+
+            if (!IsPresent(type))
+            {
+                mPresent[type / kBitsPerWord] |= 1U << (type % kBitsPerWord);
+                mOffsets[type] = static_cast<uint16_t>(reinterpret_cast<const uint8_t *>(tlv) - aBuffer);
+            }
+        }
+
+        return !reader.IsMalformed();
+    }
+
+    /**
+     * This method returns the first TLV of a type.
+     *
+     * @param[in]  aType  The TLV type.
+     *
+     * @returns A pointer to the TLV, NULL if the payload has no TLV of @p aType.
+     *
+     */
+    const Tlv *Get(uint8_t aType) const
+    {
+        return IsPresent(aType) ? reinterpret_cast<const Tlv *>(mBuffer + mOffsets[aType]) : NULL;
+    }
+
+    /**
+     * This method returns the offset of the first TLV of a type in the payload.
+     *
+     * @param[in]   aType    The TLV type.
+     * @param[out]  aOffset  A reference to receive the offset of the TLV.
+     *
+     * @retval true   Successfully found the TLV.
+     * @retval false  The payload has no TLV of @p aType.
+     *
+     */
+    bool GetOffset(uint8_t aType, uint16_t &aOffset) const
+    {
+        if (!IsPresent(aType))
+        {
+            return false;
+        }
+
+        aOffset = mOffsets[aType];
+
+        return true;
+    }
+
+private:
+    enum
+    {
+        kNumTypes    = 256, ///< Number of TLV types.
+        kBitsPerWord = 32,  ///< Number of presence bits per word.
+    };
+
+    bool IsPresent(uint8_t aType) const { return (mPresent[aType / kBitsPerWord] >> (aType % kBitsPerWord)) & 1; }
+
+    const uint8_t *mBuffer;
+    uint32_t       mPresent[kNumTypes / kBitsPerWord]; ///< Whether each type is indexed, so that building clears less.
+    uint16_t       mOffsets[kNumTypes];                ///< Offset of each type indexed, only valid if present.
+};
+
+/**
+ * This class builds the TLVs of a payload in place, checking each TLV against the size of the buffer.
+ *
+ * A TLV which does not fit is not written, and the payload keeps the TLVs written before it.
+ *
+ */
+class TlvWriter
+{
+public:
+    /**
+     * This constructor initializes the writer at the start of a buffer.
+     *
+     * @param[in]  aBuffer  A pointer to the buffer.
+     * @param[in]  aSize    The size of the buffer.
+     *
+     */
+    TlvWriter(uint8_t *aBuffer, uint16_t aSize)
+        : mBuffer(aBuffer)
+        , mLength(0)
+        , mSize(aSize)
+    {
+    }
+
+    /**
+     * This method appends a TLV.
+     *
+     * @param[in]  aType    The TLV type.
+     * @param[in]  aValue   A pointer to the value.
+     * @param[in]  aLength  The length of the value.
+     *
+     * @retval true   Successfully appended the TLV.
+     * @retval false  The TLV does not fit in the buffer.
+     *
+     */
+    bool Append(uint8_t aType, const void *aValue, uint16_t aLength)
+    {
+        Tlv *tlv = reinterpret_cast<Tlv *>(mBuffer + mLength);
+
+        if (!Reserve(aLength))
+        {
+            return false;
+        }
+
+        tlv->SetType(aType);
+        tlv->SetValue(aValue, aLength);
+        mLength = static_cast<uint16_t>(reinterpret_cast<uint8_t *>(tlv->GetNext()) - mBuffer);
+
+        return true;
+    }
+
+    /**
+     * This method appends a TLV of a uint8_t value.
+     *
+     * @param[in]  aType   The TLV type.
+     * @param[in]  aValue  The value.
+     *
+     * @retval true   Successfully appended the TLV.
+     * @retval false  The TLV does not fit in the buffer.
+     *
+     */
+    bool AppendUInt8(uint8_t aType, uint8_t aValue) { return Append(aType, &aValue, sizeof(aValue)); }
+
+    /**
+     * This method appends a TLV of a uint16_t value, in network byte order.
+     *
+     * @param[in]  aType   The TLV type.
+     * @param[in]  aValue  The value.
+     *
+     * @retval true   Successfully appended the TLV.
+     * @retval false  The TLV does not fit in the buffer.
+     *
+     */
+    bool AppendUInt16(uint8_t aType, uint16_t aValue)
+    {
+        uint8_t value[sizeof(aValue)] = {static_cast<uint8_t>(aValue >> 8), static_cast<uint8_t>(aValue & 0xff)};
+
+        return Append(aType, value, sizeof(value));
+    }
+
+    /**
+     * This method appends a copy of a TLV.
+     *
+     * @param[in]  aTlv  A reference to the TLV.
+     *
+     * @retval true   Successfully appended the TLV.
+     * @retval false  The TLV does not fit in the buffer.
+     *
+     */
+    bool Append(const Tlv &aTlv) { return Append(aTlv.GetType(), aTlv.GetValue(), aTlv.GetLength()); }
+
+    /**
+     * This method returns the length of the payload written.
+     *
+     * @returns The length of the TLVs appended.
+     *
+     */
+    uint16_t GetLength(void) const { return mLength; }
+
+private:
+    enum
+    {
+        kHeaderLength         = 2,    ///< Length of the type and length bytes.
+        kExtendedHeaderLength = 4,    ///< Length of the header with a two-bytes length.
+        kLengthEscape         = 0xff, ///< This length value indicates the actual length is of two-bytes length.
+    };
+
+    bool Reserve(uint16_t aLength) const
+    {
+        size_t header = aLength >= kLengthEscape ? kExtendedHeaderLength : kHeaderLength;
+
+        return static_cast<size_t>(mSize - mLength) >= header + aLength;
+    }
+
+    uint8_t *mBuffer;
+    uint16_t mLength;
+    uint16_t mSize;
+};
+
 namespace Meshcop {
 
 enum
@@ -194,10 +549,29 @@ enum
     kJoinerIid               = 19,
     kJoinerRouterLocator     = 20,
     kJoinerRouterKek         = 21,
+    kPanId                   = 1,
+    kChannelMask             = 53,
+    kEnergyList              = 57,
 };
 
 } // namespace Meshcop
 
+namespace Diagnostic {
+
+enum
+{
+    kExtMacAddress = 0,
+    kAddress16     = 1,
+    kMode          = 2,
+    kConnectivity  = 4,
+    kRoute64       = 5,
+    kLeaderData    = 6,
+    kChildTable    = 16,
+    kTypeList      = 18,
+};
+
+} // namespace Diagnostic
+
 } // namespace ot
 
 #endif // TLV_HPP_
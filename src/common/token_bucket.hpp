@@ -0,0 +1,142 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of a token bucket rate limiter.
+ */
+
+#ifndef TOKEN_BUCKET_HPP_
+#define TOKEN_BUCKET_HPP_
+
+#include <stdint.h>
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class implements a token bucket.
+ *
+ * The bucket holds up to a burst of tokens, and is refilled at a fixed rate. Tokens are kept in thousandths, so that
+ * rates below one token per millisecond are refilled without drift.
+ *
+ */
+class TokenBucket
+{
+public:
+    /**
+     * The constructor initializes an unlimited bucket.
+     *
+     */
+    TokenBucket(void)
+        : mRate(0)
+        , mBurst(0)
+        , mTokens(0)
+        , mLastTime(0)
+    {
+    }
+
+    /**
+     * This method sets the rate and burst of the bucket, and fills it up.
+     *
+     * @param[in]   aRate   The number of tokens added every second, 0 for no limit.
+     * @param[in]   aBurst  The max number of tokens held, 0 to use @p aRate.
+     * @param[in]   aNow    The current time in milliseconds.
+     *
+     */
+    void Init(uint32_t aRate, uint32_t aBurst, uint64_t aNow)
+    {
+        mRate     = aRate;
+        mBurst    = static_cast<uint64_t>(aBurst != 0 ? aBurst : aRate) * kScale;
+        mTokens   = mBurst;
+        mLastTime = aNow;
+    }
+
+    /**
+     * This method takes a token from the bucket.
+     *
+     * @param[in]   aNow    The current time in milliseconds, must not go backwards.
+     *
+     * @retval  true    A token was taken, or the bucket has no limit.
+     * @retval  false   The bucket is empty.
+     *
+     */
+    bool Consume(uint64_t aNow)
+    {
+        bool consumed = true;
+
+        if (mRate != 0)
+        {
+            // A rate per second is a rate of thousandths per millisecond.
+            mTokens += (aNow - mLastTime) * mRate;
+            mLastTime = aNow;
+
+            if (mTokens > mBurst)
+            {
+                mTokens = mBurst;
+            }
+
+            if (mTokens >= kScale)
+            {
+                mTokens -= kScale;
+            }
+            else
+            {
+                consumed = false;
+            }
+        }
+
+        return consumed;
+    }
+
+    /**
+     * This method returns whether the bucket limits the rate.
+     *
+     * @returns Whether the bucket has a rate limit.
+     *
+     */
+    bool IsLimited(void) const { return mRate != 0; }
+
+private:
+    enum
+    {
+        kScale = 1000, ///< Thousandths per token.
+    };
+
+    uint32_t mRate;     ///< Tokens per second.
+    uint64_t mBurst;    ///< Max thousandths held.
+    uint64_t mTokens;   ///< Thousandths held.
+    uint64_t mLastTime; ///< When the bucket was last refilled, in milliseconds.
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // TOKEN_BUCKET_HPP_
@@ -60,10 +60,12 @@ namespace ot {
 
 enum
 {
-    kSizePSKc        = 16, ///< Size of PSKc.
-    kSizeNetworkName = 16, ///< Max size of Network Name.
-    kSizeExtPanId    = 8,  ///< Size of Extended PAN ID.
-    kSizeEui64       = 8,  ///< Size of Eui64.
+    kSizePSKc        = 16,  ///< Size of PSKc.
+    kSizeNetworkName = 16,  ///< Max size of Network Name.
+    kSizeExtPanId    = 8,   ///< Size of Extended PAN ID.
+    kSizeEui64       = 8,   ///< Size of Eui64.
+    kSizeExtAddress  = 8,   ///< Size of Extended MAC Address.
+    kSizeNetworkData = 254, ///< Max size of Thread Network Data.
 };
 
 /**
@@ -0,0 +1,266 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the worker thread pool offloading work from the mainloop.
+ */
+
+#include "worker_pool.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+WorkerPool::WorkerPool(void)
+    : mQueueHead(NULL)
+    , mQueueTail(NULL)
+    , mDoneHead(NULL)
+    , mDoneTail(NULL)
+    , mStopping(false)
+{
+    mNotifyPipe[0] = -1;
+    mNotifyPipe[1] = -1;
+    pthread_mutex_init(&mMutex, NULL);
+    pthread_cond_init(&mCond, NULL);
+}
+
+WorkerPool::~WorkerPool(void)
+{
+    Stop();
+    pthread_cond_destroy(&mCond);
+    pthread_mutex_destroy(&mMutex);
+}
+
+otbrError WorkerPool::Start(unsigned int aCount)
+{
+    otbrError          error = OTBR_ERROR_ERRNO;
+    pthread_attr_t     attr;
+    struct sched_param param;
+    int                rval = 0;
+
+    memset(&param, 0, sizeof(param));
+
+    VerifyOrExit(!IsRunning() && aCount > 0, errno = EINVAL);
+
+    SuccessOrExit(pipe(mNotifyPipe));
+    SuccessOrExit(fcntl(mNotifyPipe[0], F_SETFL, fcntl(mNotifyPipe[0], F_GETFL) | O_NONBLOCK));
+    SuccessOrExit(fcntl(mNotifyPipe[1], F_SETFL, fcntl(mNotifyPipe[1], F_GETFL) | O_NONBLOCK));
+
+    mStopping = false;
+
+    // Workers take the default policy instead of inheriting the real-time priority a reactor thread may have.
+    VerifyOrExit((errno = pthread_attr_init(&attr)) == 0);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    for (unsigned int i = 0; i < aCount && rval == 0; ++i)
+    {
+        pthread_t thread;
+
+        if ((rval = pthread_create(&thread, &attr, Run, this)) == 0)
+        {
+            mThreads.push_back(thread);
+        }
+    }
+
+    pthread_attr_destroy(&attr);
+    VerifyOrExit(rval == 0, errno = rval);
+
+    otbrLog(OTBR_LOG_INFO, "Started %u worker threads.", aCount);
+    error = OTBR_ERROR_NONE;
+
+exit:
+    if (error)
+    {
+        otbrLog(OTBR_LOG_ERR, "Failed to start worker threads: %s!", strerror(errno));
+        Stop();
+    }
+
+    return error;
+}
+
+void WorkerPool::Stop(void)
+{
+    pthread_mutex_lock(&mMutex);
+    mStopping = true;
+    pthread_cond_broadcast(&mCond);
+    pthread_mutex_unlock(&mMutex);
+
+    for (size_t i = 0; i < mThreads.size(); ++i)
+    {
+        pthread_join(mThreads[i], NULL);
+    }
+
+    mThreads.clear();
+
+    // Workers have drained the queue, complete the jobs without waiting for the notification.
+    Process();
+
+    for (int i = 0; i < 2; ++i)
+    {
+        if (mNotifyPipe[i] >= 0)
+        {
+            close(mNotifyPipe[i]);
+            mNotifyPipe[i] = -1;
+        }
+    }
+}
+
+otbrError WorkerPool::Submit(Job &aJob)
+{
+    otbrError error = OTBR_ERROR_ERRNO;
+
+    VerifyOrExit(IsRunning() && !mStopping, errno = ESRCH);
+    VerifyOrExit(!aJob.mPending, errno = EBUSY);
+
+    aJob.mPending = true;
+    aJob.mNext    = NULL;
+
+    pthread_mutex_lock(&mMutex);
+
+    if (mQueueTail == NULL)
+    {
+        mQueueHead = &aJob;
+    }
+    else
+    {
+        mQueueTail->mNext = &aJob;
+    }
+
+    mQueueTail = &aJob;
+    pthread_cond_signal(&mCond);
+    pthread_mutex_unlock(&mMutex);
+
+    error = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+void WorkerPool::Process(void)
+{
+    Job *job;
+    char buffer[64];
+
+    if (mNotifyPipe[0] >= 0)
+    {
+        while (read(mNotifyPipe[0], buffer, sizeof(buffer)) > 0)
+        {
+        }
+    }
+
+    pthread_mutex_lock(&mMutex);
+    job       = mDoneHead;
+    mDoneHead = NULL;
+    mDoneTail = NULL;
+    pthread_mutex_unlock(&mMutex);
+
+    // Completion handlers may submit the same jobs again.
+    while (job != NULL)
+    {
+        Job *next = job->mNext;
+
+        job->mPending = false;
+        job->mNext    = NULL;
+        job->mDone(job->mContext);
+        job = next;
+    }
+}
+
+void *WorkerPool::Run(void *aContext)
+{
+    static_cast<WorkerPool *>(aContext)->Run();
+    return NULL;
+}
+
+void WorkerPool::Run(void)
+{
+    pthread_mutex_lock(&mMutex);
+
+    while (true)
+    {
+        Job *job;
+
+        while (mQueueHead == NULL && !mStopping)
+        {
+            pthread_cond_wait(&mCond, &mMutex);
+        }
+
+        // Submitted jobs are run even when stopping.
+        if ((job = mQueueHead) == NULL)
+        {
+            break;
+        }
+
+        mQueueHead = job->mNext;
+
+        if (mQueueHead == NULL)
+        {
+            mQueueTail = NULL;
+        }
+
+        pthread_mutex_unlock(&mMutex);
+        job->mWork(job->mContext);
+        pthread_mutex_lock(&mMutex);
+
+        job->mNext = NULL;
+
+        if (mDoneTail == NULL)
+        {
+            mDoneHead = job;
+        }
+        else
+        {
+            mDoneTail->mNext = job;
+        }
+
+        mDoneTail = job;
+
+        {
+            // A full pipe already notifies the mainloop.
+            ssize_t rval = write(mNotifyPipe[1], "", 1);
+            (void)rval;
+        }
+    }
+
+    pthread_mutex_unlock(&mMutex);
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,195 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the worker thread pool offloading work from the mainloop.
+ */
+
+#ifndef WORKER_POOL_HPP_
+#define WORKER_POOL_HPP_
+
+#include <vector>
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class implements a pool of worker threads running jobs submitted by the mainloop.
+ *
+ * The work of a job runs on a worker thread and its completion runs back on the mainloop thread, which is
+ * notified through a file descriptor. All methods must be called from the mainloop thread.
+ *
+ */
+class WorkerPool
+{
+public:
+    /**
+     * This function pointer is called to run the work or the completion of a job.
+     *
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    typedef void (*Handler)(void *aContext);
+
+    /**
+     * This class represents a job run by the pool.
+     *
+     * The storage is owned by the caller and must stay valid until the job is completed.
+     *
+     */
+    class Job
+    {
+        friend class WorkerPool;
+
+    public:
+        /**
+         * The constructor to initialize a job.
+         *
+         * @param[in]   aWork       The function to be called on a worker thread.
+         * @param[in]   aDone       The function to be called on the mainloop thread once @p aWork returned.
+         * @param[in]   aContext    A pointer to application-specific context.
+         *
+         */
+        Job(Handler aWork, Handler aDone, void *aContext)
+            : mWork(aWork)
+            , mDone(aDone)
+            , mContext(aContext)
+            , mNext(NULL)
+            , mPending(false)
+        {
+        }
+
+        /**
+         * This method returns whether the job is submitted but not completed yet.
+         *
+         * @retval  true    The job is pending.
+         * @retval  false   The job is not pending.
+         *
+         */
+        bool IsPending(void) const { return mPending; }
+
+    private:
+        Handler mWork;
+        Handler mDone;
+        void *  mContext;
+        Job *   mNext;
+        bool    mPending;
+    };
+
+    /**
+     * The constructor to initialize a pool without threads.
+     *
+     */
+    WorkerPool(void);
+
+    /**
+     * The destructor stops the pool.
+     *
+     */
+    ~WorkerPool(void);
+
+    /**
+     * This method starts the worker threads.
+     *
+     * @param[in]   aCount      The number of worker threads, must be greater than 0.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully started.
+     * @retval  OTBR_ERROR_ERRNO    Failed to start, error code set in errno.
+     *
+     */
+    otbrError Start(unsigned int aCount);
+
+    /**
+     * This method stops the worker threads.
+     *
+     * Jobs already submitted are run to completion, including their completion handlers.
+     *
+     */
+    void Stop(void);
+
+    /**
+     * This method returns whether the pool is started.
+     *
+     * @retval  true    The pool is running.
+     * @retval  false   The pool is not running.
+     *
+     */
+    bool IsRunning(void) const { return !mThreads.empty(); }
+
+    /**
+     * This method submits a job.
+     *
+     * @param[in]   aJob    A reference to the job, which must not be pending.
+     *
+     * @retval  OTBR_ERROR_NONE     Successfully submitted.
+     * @retval  OTBR_ERROR_ERRNO    Failed for the pool is not running.
+     *
+     */
+    otbrError Submit(Job &aJob);
+
+    /**
+     * This method returns the file descriptor readable when jobs are completed.
+     *
+     * @returns The file descriptor, or -1 if the pool is not running.
+     *
+     */
+    int GetFd(void) const { return mNotifyPipe[0]; }
+
+    /**
+     * This method runs the completion handlers of completed jobs.
+     *
+     */
+    void Process(void);
+
+private:
+    static void *Run(void *aContext);
+    void         Run(void);
+
+    pthread_mutex_t        mMutex;
+    pthread_cond_t         mCond;
+    Job *                  mQueueHead; ///< The first job waiting for a worker.
+    Job *                  mQueueTail; ///< The last job waiting for a worker.
+    Job *                  mDoneHead;  ///< The first job waiting for completion.
+    Job *                  mDoneTail;  ///< The last job waiting for completion.
+    bool                   mStopping;
+    int                    mNotifyPipe[2];
+    std::vector<pthread_t> mThreads;
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif // WORKER_POOL_HPP_
@@ -0,0 +1,196 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the detection of CPU features.
+ */
+
+#include "cpu_features.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define OTBR_CPU_X86 1
+#elif defined(__aarch64__) && defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#define OTBR_CPU_AARCH64 1
+#elif defined(__arm__) && defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#define OTBR_CPU_ARM 1
+#endif
+
+namespace ot {
+
+namespace Utils {
+
+struct FeatureName
+{
+    uint32_t    mFeature;
+    const char *mName;
+};
+
+static const FeatureName kFeatureNames[] = {
+    {CpuFeatures::kNeon, "neon"}, {CpuFeatures::kAes, "aes"},       {CpuFeatures::kClmul, "clmul"},
+    {CpuFeatures::kSse2, "sse2"}, {CpuFeatures::kSse41, "sse4.1"}, {CpuFeatures::kAvx2, "avx2"},
+};
+
+const CpuFeatures::Binding *CpuFeatures::sFirst    = NULL;
+uint32_t                    CpuFeatures::sDisabled = 0;
+
+CpuFeatures::Binding::Binding(Binder aBinder)
+    : mBinder(aBinder)
+    , mNext(CpuFeatures::sFirst)
+{
+    CpuFeatures::sFirst = this;
+    aBinder(CpuFeatures::Get());
+}
+
+uint32_t CpuFeatures::Detect(void)
+{
+    uint32_t features = 0;
+
+#if OTBR_CPU_X86
+    __builtin_cpu_init();
+
+    features |= __builtin_cpu_supports("sse2") ? kSse2 : 0;
+    features |= __builtin_cpu_supports("sse4.1") ? kSse41 : 0;
+    features |= __builtin_cpu_supports("avx2") ? kAvx2 : 0;
+    features |= __builtin_cpu_supports("aes") ? kAes : 0;
+    features |= __builtin_cpu_supports("pclmul") ? kClmul : 0;
+#elif OTBR_CPU_AARCH64
+    unsigned long hwcap = getauxval(AT_HWCAP);
+
+    features |= (hwcap & HWCAP_ASIMD) ? kNeon : 0;
+    features |= (hwcap & HWCAP_AES) ? kAes : 0;
+    features |= (hwcap & HWCAP_PMULL) ? kClmul : 0;
+#elif OTBR_CPU_ARM
+    features |= (getauxval(AT_HWCAP) & HWCAP_NEON) ? kNeon : 0;
+#ifdef AT_HWCAP2
+    features |= (getauxval(AT_HWCAP2) & HWCAP2_AES) ? kAes : 0;
+    features |= (getauxval(AT_HWCAP2) & HWCAP2_PMULL) ? kClmul : 0;
+#endif
+#endif
+
+    return features;
+}
+
+uint32_t CpuFeatures::GetDetected(void)
+{
+    // Detected by the first caller, bindings of other modules may run before the statics of this one.
+    static const uint32_t sDetected = Detect();
+
+    return sDetected;
+}
+
+uint32_t CpuFeatures::Get(void)
+{
+    return GetDetected() & ~sDisabled;
+}
+
+void CpuFeatures::Disable(uint32_t aFeatures)
+{
+    sDisabled = aFeatures;
+    Bind();
+}
+
+void CpuFeatures::Bind(void)
+{
+    uint32_t features = Get();
+
+    for (const Binding *binding = sFirst; binding != NULL; binding = binding->mNext)
+    {
+        binding->mBinder(features);
+    }
+}
+
+bool CpuFeatures::Parse(const char *aNames, uint32_t &aFeatures)
+{
+    bool known = true;
+
+    aFeatures = 0;
+
+    while (*aNames != '\0')
+    {
+        size_t length = strcspn(aNames, ",");
+        bool   found  = false;
+
+        if (length == sizeof("all") - 1 && !strncmp(aNames, "all", length))
+        {
+            aFeatures |= kAll;
+            found = true;
+        }
+
+        for (size_t i = 0; !found && i < sizeof(kFeatureNames) / sizeof(kFeatureNames[0]); ++i)
+        {
+            if (strlen(kFeatureNames[i].mName) == length && !strncmp(aNames, kFeatureNames[i].mName, length))
+            {
+                aFeatures |= kFeatureNames[i].mFeature;
+                found = true;
+            }
+        }
+
+        known = known && found;
+        aNames += length;
+        aNames += (*aNames == ',') ? 1 : 0;
+    }
+
+    return known;
+}
+
+const char *CpuFeatures::Format(uint32_t aFeatures, char *aBuffer, size_t aSize)
+{
+    size_t length = 0;
+
+    aBuffer[0] = '\0';
+
+    for (size_t i = 0; i < sizeof(kFeatureNames) / sizeof(kFeatureNames[0]); ++i)
+    {
+        if ((aFeatures & kFeatureNames[i].mFeature) && length < aSize)
+        {
+            int count = snprintf(aBuffer + length, aSize - length, "%s%s", length == 0 ? "" : ",",
+                                 kFeatureNames[i].mName);
+
+            length += count > 0 ? static_cast<size_t>(count) : 0;
+        }
+    }
+
+    if (length == 0)
+    {
+        snprintf(aBuffer, aSize, "none");
+    }
+
+    return aBuffer;
+}
+
+} // namespace Utils
+
+} // namespace ot
@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for the detection of CPU features, which select the kernels of the utilities.
+ */
+
+#ifndef CPU_FEATURES_HPP_
+#define CPU_FEATURES_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ot {
+
+namespace Utils {
+
+/**
+ * This class detects the features of the CPU once, and binds the kernels of the utilities to the best implementation.
+ *
+ * One binary runs on CPUs of different features, so vectorized kernels are not selected at compile time. Each module
+ * keeps function pointers to its kernels, and defines a static Binding, which binds them as the program starts and
+ * whenever features are disabled. Disabling features compares the kernels, for benchmarks and tests.
+ *
+ */
+class CpuFeatures
+{
+public:
+    enum Feature
+    {
+        kNeon  = 1 << 0,       ///< Advanced SIMD with ARM.
+        kAes   = 1 << 1,       ///< AES instructions, AES-NI with x86 or the cryptography extension with ARM.
+        kClmul = 1 << 2,       ///< Carry-less multiplication, PCLMULQDQ with x86 or PMULL with ARM.
+        kSse2  = 1 << 3,       ///< SSE2 with x86.
+        kSse41 = 1 << 4,       ///< SSE4.1 with x86.
+        kAvx2  = 1 << 5,       ///< AVX2 with x86, of registers saved by the operating system.
+        kAll   = (1 << 6) - 1, ///< All the features.
+    };
+
+    /**
+     * This function pointer binds the kernels of a module.
+     *
+     * @param[in]   aFeatures   The bitmask of the features enabled.
+     *
+     */
+    typedef void (*Binder)(uint32_t aFeatures);
+
+    /**
+     * This class binds the kernels of a module on construction, and again whenever features are disabled.
+     *
+     */
+    class Binding
+    {
+    public:
+        /**
+         * The constructor registers and runs a binder.
+         *
+         * @param[in]   aBinder     The function binding the kernels.
+         *
+         */
+        explicit Binding(Binder aBinder);
+
+    private:
+        friend class CpuFeatures;
+
+        Binder         mBinder;
+        const Binding *mNext;
+    };
+
+    /**
+     * This function returns the features of the CPU.
+     *
+     * @returns The bitmask of the features detected.
+     *
+     */
+    static uint32_t GetDetected(void);
+
+    /**
+     * This function returns the features the kernels are bound to.
+     *
+     * @returns The bitmask of the features detected and not disabled.
+     *
+     */
+    static uint32_t Get(void);
+
+    /**
+     * This function disables features, and binds the kernels again.
+     *
+     * Kernels are called without locks, this function must not be called while other threads run them.
+     *
+     * @param[in]   aFeatures   The bitmask of the features to disable, 0 to enable all those detected.
+     *
+     */
+    static void Disable(uint32_t aFeatures);
+
+    /**
+     * This function parses a list of feature names.
+     *
+     * @param[in]   aNames      The names separated by commas, "all" for every feature.
+     * @param[out]  aFeatures   The bitmask of the features.
+     *
+     * @returns Whether every name is known.
+     *
+     */
+    static bool Parse(const char *aNames, uint32_t &aFeatures);
+
+    /**
+     * This function formats the names of features.
+     *
+     * @param[in]   aFeatures   The bitmask of the features.
+     * @param[out]  aBuffer     A pointer to the buffer receiving the names separated by commas, "none" if empty.
+     * @param[in]   aSize       The size of the buffer.
+     *
+     * @returns A pointer to the buffer.
+     *
+     */
+    static const char *Format(uint32_t aFeatures, char *aBuffer, size_t aSize);
+
+private:
+    static uint32_t Detect(void);
+    static void     Bind(void);
+
+    static const Binding *sFirst;
+    static uint32_t       sDisabled;
+};
+
+} // namespace Utils
+
+} // namespace ot
+
+#endif // CPU_FEATURES_HPP_
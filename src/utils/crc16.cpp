@@ -33,32 +33,184 @@
 
 #include "crc16.hpp"
 
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#define OTBR_CRC16_PCLMUL 1
+#elif defined(__aarch64__) && defined(__linux__)
+#include <arm_neon.h>
+#define OTBR_CRC16_PMULL 1
+#endif
+
+#include "cpu_features.hpp"
+
 namespace ot {
 
-Crc16::Crc16(Polynomial aPolynomial)
+/**
+ * This function pointer feeds a buffer into a CRC16 computation.
+ *
+ * @returns The CRC16 value.
+ *
+ */
+typedef uint16_t (*UpdateKernel)(uint16_t       aCrc,
+                                 const uint16_t *aTable,
+                                 uint16_t       aPolynomial,
+                                 const uint8_t *aBuffer,
+                                 size_t         aLength);
+
+static uint16_t UpdateTable(uint16_t       aCrc,
+                            const uint16_t *aTable,
+                            uint16_t       aPolynomial,
+                            const uint8_t *aBuffer,
+                            size_t         aLength)
 {
-    mPolynomial = static_cast<uint16_t>(aPolynomial);
-    Init();
+    (void)aPolynomial;
+
+    for (const uint8_t *end = aBuffer + aLength; aBuffer != end; ++aBuffer)
+    {
+        aCrc = static_cast<uint16_t>(aCrc << 8) ^ aTable[static_cast<uint8_t>(aCrc >> 8) ^ *aBuffer];
+    }
+
+    return aCrc;
 }
 
-void Crc16::Update(uint8_t aByte)
-{
-    uint8_t i;
+#if OTBR_CRC16_PCLMUL || OTBR_CRC16_PMULL
 
-    mCrc = mCrc ^ static_cast<uint16_t>(aByte << 8);
-    i    = 8;
+/**
+ * This function computes the Barrett constant of a polynomial, floor(x^80 / P) without its x^64 term.
+ *
+ */
+static uint64_t ComputeBarrett(uint16_t aPolynomial)
+{
+    uint64_t quotient  = 0;
+    uint32_t remainder = 0;
 
-    do
+    // Long division of x^80, the remainder holds the 17 bits aligned with P.
+    for (int bit = 80; bit >= 0; --bit)
     {
-        if (mCrc & 0x8000)
-        {
-            mCrc = static_cast<uint16_t>(mCrc << 1) ^ mPolynomial;
-        }
-        else
+        remainder = (remainder << 1) | (bit == 80 ? 1 : 0);
+
+        if (remainder & 0x10000)
         {
-            mCrc = static_cast<uint16_t>(mCrc << 1);
+            remainder ^= 0x10000 | aPolynomial;
+
+            if (bit < 64)
+            {
+                quotient |= static_cast<uint64_t>(1) << bit;
+            }
         }
-    } while (--i);
+    }
+
+    return quotient;
+}
+
+static uint64_t sBarrettCcitt = 0;
+static uint64_t sBarrettAnsi  = 0;
+
+static inline uint64_t ReadBigEndian64(const uint8_t *aBuffer)
+{
+    uint64_t value;
+
+    memcpy(&value, aBuffer, sizeof(value));
+
+    return __builtin_bswap64(value);
+}
+
+#endif // OTBR_CRC16_PCLMUL || OTBR_CRC16_PMULL
+
+// Eight bytes D shifted into the CRC give (CRC * x^64 + D * x^16) mod P, the remainder of T * x^16 with
+// T = (CRC << 48) ^ D. With mu = floor(x^80 / P), the quotient is T ^ ((T * (mu - x^64)) >> 64), and the remainder
+// is the low 16 bits of the quotient times P, as T * x^16 has none. Each eight bytes take two multiplications.
+
+#if OTBR_CRC16_PCLMUL
+__attribute__((target("pclmul,sse2"))) static inline __m128i Multiply(uint64_t aLeft, uint64_t aRight)
+{
+    return _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<long long>(aLeft)),
+                                _mm_cvtsi64_si128(static_cast<long long>(aRight)), 0);
+}
+
+__attribute__((target("pclmul,sse2"))) static uint16_t UpdatePclmul(uint16_t       aCrc,
+                                                                    const uint16_t *aTable,
+                                                                    uint16_t       aPolynomial,
+                                                                    const uint8_t *aBuffer,
+                                                                    size_t         aLength)
+{
+    uint64_t mu = (aPolynomial == Crc16::kCcitt) ? sBarrettCcitt : sBarrettAnsi;
+
+    for (; aLength >= sizeof(uint64_t); aLength -= sizeof(uint64_t), aBuffer += sizeof(uint64_t))
+    {
+        uint64_t t = (static_cast<uint64_t>(aCrc) << 48) ^ ReadBigEndian64(aBuffer);
+        uint64_t q = t ^ static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_srli_si128(Multiply(t, mu), 8)));
+
+        aCrc = static_cast<uint16_t>(_mm_cvtsi128_si32(Multiply(q, aPolynomial)));
+    }
+
+    return UpdateTable(aCrc, aTable, aPolynomial, aBuffer, aLength);
+}
+#endif // OTBR_CRC16_PCLMUL
+
+#if OTBR_CRC16_PMULL
+__attribute__((target("+crypto"))) static inline uint64x2_t Multiply(uint64_t aLeft, uint64_t aRight)
+{
+    return vreinterpretq_u64_p128(vmull_p64(static_cast<poly64_t>(aLeft), static_cast<poly64_t>(aRight)));
+}
+
+__attribute__((target("+crypto"))) static uint16_t UpdatePmull(uint16_t       aCrc,
+                                                               const uint16_t *aTable,
+                                                               uint16_t       aPolynomial,
+                                                               const uint8_t *aBuffer,
+                                                               size_t         aLength)
+{
+    uint64_t mu = (aPolynomial == Crc16::kCcitt) ? sBarrettCcitt : sBarrettAnsi;
+
+    for (; aLength >= sizeof(uint64_t); aLength -= sizeof(uint64_t), aBuffer += sizeof(uint64_t))
+    {
+        uint64_t t = (static_cast<uint64_t>(aCrc) << 48) ^ ReadBigEndian64(aBuffer);
+        uint64_t q = t ^ vgetq_lane_u64(Multiply(t, mu), 1);
+
+        aCrc = static_cast<uint16_t>(vgetq_lane_u64(Multiply(q, aPolynomial), 0));
+    }
+
+    return UpdateTable(aCrc, aTable, aPolynomial, aBuffer, aLength);
+}
+#endif // OTBR_CRC16_PMULL
+
+static UpdateKernel sUpdate = UpdateTable;
+
+static void BindKernels(uint32_t aFeatures)
+{
+    sUpdate = UpdateTable;
+
+#if OTBR_CRC16_PCLMUL || OTBR_CRC16_PMULL
+    if (aFeatures & Utils::CpuFeatures::kClmul)
+    {
+        sBarrettCcitt = ComputeBarrett(Crc16::kCcitt);
+        sBarrettAnsi  = ComputeBarrett(Crc16::kAnsi);
+#if OTBR_CRC16_PCLMUL
+        sUpdate = UpdatePclmul;
+#else
+        sUpdate = UpdatePmull;
+#endif
+    }
+#else
+    (void)aFeatures;
+#endif
+}
+
+static const Utils::CpuFeatures::Binding sBinding(BindKernels);
+
+Crc16::Crc16(Polynomial aPolynomial)
+{
+    mTable      = (aPolynomial == kCcitt) ? Crc16Table<kCcitt>::kTable : Crc16Table<kAnsi>::kTable;
+    mPolynomial = aPolynomial;
+    Init();
+}
+
+void Crc16::Update(const uint8_t *aBuffer, size_t aLength)
+{
+    mCrc = sUpdate(mCrc, mTable, mPolynomial, aBuffer, aLength);
 }
 
 } // namespace ot
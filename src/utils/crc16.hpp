@@ -34,10 +34,68 @@
 #ifndef CRC16_HPP_
 #define CRC16_HPP_
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace ot {
 
+/**
+ * This template computes the CRC16 of a byte shifted into a zero CRC, at compile time.
+ *
+ * @tparam  kPolynomial  The polynomial value.
+ * @tparam  kCrc         The CRC16 value before the remaining shifts.
+ * @tparam  kBits        The number of remaining shifts.
+ *
+ */
+template <uint16_t kPolynomial, uint32_t kCrc, unsigned kBits> struct Crc16Shift
+{
+    enum
+    {
+        kValue = Crc16Shift<kPolynomial,
+                            ((kCrc & 0x8000) ? ((kCrc << 1) ^ kPolynomial) : (kCrc << 1)) & 0xffff,
+                            kBits - 1>::kValue,
+    };
+};
+
+template <uint16_t kPolynomial, uint32_t kCrc> struct Crc16Shift<kPolynomial, kCrc, 0>
+{
+    enum
+    {
+        kValue = kCrc,
+    };
+};
+
+/**
+ * This template provides the lookup table of a CRC16 polynomial, generated at compile time.
+ *
+ * @tparam  kPolynomial  The polynomial value.
+ *
+ */
+template <uint16_t kPolynomial> struct Crc16Table
+{
+    static const uint16_t kTable[256]; ///< The CRC16 of each byte value, shifted into a zero CRC.
+};
+
+#define OTBR_CRC16_ENTRY(aByte) static_cast<uint16_t>(Crc16Shift<kPolynomial, (aByte) << 8, 8>::kValue)
+#define OTBR_CRC16_ROW(aByte)                                                                                      \
+    OTBR_CRC16_ENTRY((aByte) + 0), OTBR_CRC16_ENTRY((aByte) + 1), OTBR_CRC16_ENTRY((aByte) + 2),                  \
+        OTBR_CRC16_ENTRY((aByte) + 3), OTBR_CRC16_ENTRY((aByte) + 4), OTBR_CRC16_ENTRY((aByte) + 5),              \
+        OTBR_CRC16_ENTRY((aByte) + 6), OTBR_CRC16_ENTRY((aByte) + 7), OTBR_CRC16_ENTRY((aByte) + 8),              \
+        OTBR_CRC16_ENTRY((aByte) + 9), OTBR_CRC16_ENTRY((aByte) + 10), OTBR_CRC16_ENTRY((aByte) + 11),            \
+        OTBR_CRC16_ENTRY((aByte) + 12), OTBR_CRC16_ENTRY((aByte) + 13), OTBR_CRC16_ENTRY((aByte) + 14),           \
+        OTBR_CRC16_ENTRY((aByte) + 15)
+
+template <uint16_t kPolynomial>
+const uint16_t Crc16Table<kPolynomial>::kTable[256] = {
+    OTBR_CRC16_ROW(0x00), OTBR_CRC16_ROW(0x10), OTBR_CRC16_ROW(0x20), OTBR_CRC16_ROW(0x30),
+    OTBR_CRC16_ROW(0x40), OTBR_CRC16_ROW(0x50), OTBR_CRC16_ROW(0x60), OTBR_CRC16_ROW(0x70),
+    OTBR_CRC16_ROW(0x80), OTBR_CRC16_ROW(0x90), OTBR_CRC16_ROW(0xa0), OTBR_CRC16_ROW(0xb0),
+    OTBR_CRC16_ROW(0xc0), OTBR_CRC16_ROW(0xd0), OTBR_CRC16_ROW(0xe0), OTBR_CRC16_ROW(0xf0),
+};
+
+#undef OTBR_CRC16_ROW
+#undef OTBR_CRC16_ENTRY
+
 /**
  * This class implements CRC16 computations.
  *
@@ -65,13 +123,27 @@ public:
      */
     void Init(void) { mCrc = 0; }
 
-    /*c*
+    /**
      * This method feeds a byte value into the CRC16 computation.
      *
      * @param[in]  aByte  The byte value.
      *
      */
-    void Update(uint8_t aByte);
+    void Update(uint8_t aByte)
+    {
+        mCrc = static_cast<uint16_t>(mCrc << 8) ^ mTable[static_cast<uint8_t>(mCrc >> 8) ^ aByte];
+    }
+
+    /**
+     * This method feeds a buffer into the CRC16 computation.
+     *
+     * Buffers are computed eight bytes at a time with carry-less multiplications, if the CPU has them.
+     *
+     * @param[in]  aBuffer  A pointer to the buffer.
+     * @param[in]  aLength  The number of bytes in the buffer.
+     *
+     */
+    void Update(const uint8_t *aBuffer, size_t aLength);
 
     /**
      * This method gets the current CRC16 value.
@@ -82,8 +154,9 @@ public:
     uint16_t Get(void) const { return mCrc; }
 
 private:
-    uint16_t mPolynomial;
-    uint16_t mCrc;
+    const uint16_t *mTable;
+    uint16_t        mPolynomial;
+    uint16_t        mCrc;
 };
 
 } // namespace ot
@@ -33,98 +33,293 @@
 
 #include "hex.hpp"
 
-#include <string>
-
-#include <stdio.h>
 #include <string.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define OTBR_HEX_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define OTBR_HEX_NEON 1
+#endif
+
+#include "cpu_features.hpp"
+
 namespace ot {
 
 namespace Utils {
 
-int Hex2Bytes(const char *aHex, uint8_t *aBytes, uint16_t aBytesLength)
+enum
 {
-    size_t      hexLength = strlen(aHex);
-    const char *hexEnd    = aHex + hexLength;
-    uint8_t *   cur       = aBytes;
-    uint8_t     numChars  = hexLength & 1;
-    uint8_t     byte      = 0;
+    kBlockBytes = 8, ///< Number of bytes converted at once by the vector kernels.
+};
 
-    if ((hexLength + 1) / 2 > aBytesLength)
-    {
-        return -1;
-    }
+static const char kHexDigits[] = "0123456789ABCDEF";
+
+/**
+ * This function returns the value of a hex digit, or -1 if the character is not a hex digit.
+ *
+ */
+static inline int HexValue(char aChar)
+{
+    uint8_t digit = static_cast<uint8_t>(aChar - '0');
+    uint8_t alpha = static_cast<uint8_t>((aChar | 0x20) - 'a');
+
+    return digit < 10 ? digit : (alpha < 6 ? alpha + 10 : -1);
+}
+
+/**
+ * This function pointer converts blocks of kBlockBytes bytes of hex digits, and stops at the first invalid digit.
+ *
+ * @returns The number of bytes converted.
+ *
+ */
+typedef size_t (*DecodeKernel)(const char *aHex, size_t aLength, uint8_t *aBytes);
+
+/**
+ * This function pointer converts blocks of kBlockBytes bytes to hex digits.
+ *
+ * @returns The number of bytes converted.
+ *
+ */
+typedef size_t (*EncodeKernel)(const uint8_t *aBytes, size_t aLength, char *aHex);
+
+static size_t DecodeBlocksScalar(const char *, size_t, uint8_t *)
+{
+    return 0;
+}
+
+static size_t EncodeBlocksScalar(const uint8_t *, size_t, char *)
+{
+    return 0;
+}
+
+#if OTBR_HEX_SSE2
 
-    while (aHex < hexEnd)
+__attribute__((target("sse2"))) static inline __m128i DecodeDigits(__m128i aChars, __m128i &aValid)
+{
+    __m128i lower = _mm_or_si128(aChars, _mm_set1_epi8(0x20));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(aChars, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(aChars, _mm_set1_epi8('9' + 1)));
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                  _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+    aValid = _mm_or_si128(digit, alpha);
+
+    return _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(aChars, _mm_set1_epi8('0'))),
+                        _mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+}
+
+__attribute__((target("sse2"))) static inline __m128i EncodeDigits(__m128i aNibbles)
+{
+    __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(aNibbles, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '9' - 1));
+
+    return _mm_add_epi8(_mm_add_epi8(aNibbles, _mm_set1_epi8('0')), letters);
+}
+
+__attribute__((target("sse2"))) static size_t DecodeBlocksSse2(const char *aHex, size_t aLength, uint8_t *aBytes)
+{
+    size_t done = 0;
+
+    for (; done + kBlockBytes <= aLength; done += kBlockBytes)
     {
-        if ('A' <= *aHex && *aHex <= 'F')
-        {
-            byte |= 10 + (*aHex - 'A');
-        }
-        else if ('a' <= *aHex && *aHex <= 'f')
+        __m128i valid;
+        __m128i values = DecodeDigits(_mm_loadu_si128(reinterpret_cast<const __m128i *>(aHex + done * 2)), valid);
+        // Each 16-bit lane holds the value of the high nibble in its low byte, and the low nibble in its high byte.
+        __m128i bytes =
+            _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0xff)), 4), _mm_srli_epi16(values, 8));
+
+        if (_mm_movemask_epi8(valid) != 0xffff)
         {
-            byte |= 10 + (*aHex - 'a');
+            break;
         }
-        else if ('0' <= *aHex && *aHex <= '9')
+
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(aBytes + done), _mm_packus_epi16(bytes, bytes));
+    }
+
+    return done;
+}
+
+__attribute__((target("sse2"))) static size_t EncodeBlocksSse2(const uint8_t *aBytes, size_t aLength, char *aHex)
+{
+    size_t done = 0;
+
+    for (; done + kBlockBytes <= aLength; done += kBlockBytes)
+    {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(aBytes + done));
+        __m128i high  = EncodeDigits(_mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0f)));
+        __m128i low   = EncodeDigits(_mm_and_si128(bytes, _mm_set1_epi8(0x0f)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(aHex + done * 2), _mm_unpacklo_epi8(high, low));
+    }
+
+    return done;
+}
+
+#endif // OTBR_HEX_SSE2
+
+#if OTBR_HEX_NEON
+
+static inline uint8x8_t DecodeDigits(uint8x8_t aChars, uint8x8_t &aValid)
+{
+    uint8x8_t digit   = vsub_u8(aChars, vdup_n_u8('0'));
+    uint8x8_t alpha   = vsub_u8(vorr_u8(aChars, vdup_n_u8(0x20)), vdup_n_u8('a'));
+    uint8x8_t isDigit = vclt_u8(digit, vdup_n_u8(10));
+    uint8x8_t isAlpha = vclt_u8(alpha, vdup_n_u8(6));
+
+    aValid = vorr_u8(isDigit, isAlpha);
+
+    return vorr_u8(vand_u8(isDigit, digit), vand_u8(isAlpha, vadd_u8(alpha, vdup_n_u8(10))));
+}
+
+static inline uint8x8_t EncodeDigits(uint8x8_t aNibbles)
+{
+    uint8x8_t letters = vand_u8(vcgt_u8(aNibbles, vdup_n_u8(9)), vdup_n_u8('A' - '9' - 1));
+
+    return vadd_u8(vadd_u8(aNibbles, vdup_n_u8('0')), letters);
+}
+
+static size_t DecodeBlocksNeon(const char *aHex, size_t aLength, uint8_t *aBytes)
+{
+    size_t done = 0;
+
+    for (; done + kBlockBytes <= aLength; done += kBlockBytes)
+    {
+        // Loads the high nibbles into val[0] and the low nibbles into val[1].
+        uint8x8x2_t chars = vld2_u8(reinterpret_cast<const uint8_t *>(aHex + done * 2));
+        uint8x8_t   validHigh;
+        uint8x8_t   validLow;
+        uint8x8_t   high = DecodeDigits(chars.val[0], validHigh);
+        uint8x8_t   low  = DecodeDigits(chars.val[1], validLow);
+
+        if (vget_lane_u64(vreinterpret_u64_u8(vand_u8(validHigh, validLow)), 0) != ~static_cast<uint64_t>(0))
         {
-            byte |= *aHex - '0';
+            break;
         }
-        else
+
+        vst1_u8(aBytes + done, vorr_u8(vshl_n_u8(high, 4), low));
+    }
+
+    return done;
+}
+
+static size_t EncodeBlocksNeon(const uint8_t *aBytes, size_t aLength, char *aHex)
+{
+    size_t done = 0;
+
+    for (; done + kBlockBytes <= aLength; done += kBlockBytes)
+    {
+        uint8x8_t   bytes = vld1_u8(aBytes + done);
+        uint8x8x2_t chars;
+
+        chars.val[0] = EncodeDigits(vshr_n_u8(bytes, 4));
+        chars.val[1] = EncodeDigits(vand_u8(bytes, vdup_n_u8(0x0f)));
+        vst2_u8(reinterpret_cast<uint8_t *>(aHex + done * 2), chars);
+    }
+
+    return done;
+}
+
+#endif // OTBR_HEX_NEON
+
+static DecodeKernel sDecodeBlocks = DecodeBlocksScalar;
+static EncodeKernel sEncodeBlocks = EncodeBlocksScalar;
+
+static void BindKernels(uint32_t aFeatures)
+{
+    sDecodeBlocks = DecodeBlocksScalar;
+    sEncodeBlocks = EncodeBlocksScalar;
+
+#if OTBR_HEX_SSE2
+    if (aFeatures & CpuFeatures::kSse2)
+    {
+        sDecodeBlocks = DecodeBlocksSse2;
+        sEncodeBlocks = EncodeBlocksSse2;
+    }
+#elif OTBR_HEX_NEON
+    // The kernel is only built where the compiler targets NEON, still ARMv7 CPUs may lack it.
+    if (aFeatures & CpuFeatures::kNeon)
+    {
+        sDecodeBlocks = DecodeBlocksNeon;
+        sEncodeBlocks = EncodeBlocksNeon;
+    }
+#else
+    (void)aFeatures;
+#endif
+}
+
+static const CpuFeatures::Binding sBinding(BindKernels);
+
+int Hex2Bytes(const char *aHex, uint8_t *aBytes, uint16_t aBytesLength)
+{
+    return Hex2Bytes(aHex, strlen(aHex), aBytes, aBytesLength);
+}
+
+int Hex2Bytes(const char *aHex, size_t aHexLength, uint8_t *aBytes, uint16_t aBytesLength)
+{
+    uint8_t *cur = aBytes;
+    size_t   length;
+
+    if ((aHexLength + 1) / 2 > aBytesLength)
+    {
+        return -1;
+    }
+
+    // An odd number of digits starts with the low nibble of the first byte.
+    if (aHexLength & 1)
+    {
+        int value = HexValue(*aHex++);
+
+        if (value < 0)
         {
             return -1;
         }
 
-        aHex++;
-        numChars++;
+        *cur++ = static_cast<uint8_t>(value);
+    }
 
-        if (numChars >= 2)
-        {
-            numChars = 0;
-            *cur++   = byte;
-            byte     = 0;
-        }
-        else
+    length = aHexLength / 2;
+
+    for (size_t i = sDecodeBlocks(aHex, length, cur); i < length; i++)
+    {
+        int high = HexValue(aHex[i * 2]);
+        int low  = HexValue(aHex[i * 2 + 1]);
+
+        if ((high | low) < 0)
         {
-            byte <<= 4;
+            return -1;
         }
+
+        cur[i] = static_cast<uint8_t>((high << 4) | low);
     }
 
-    return static_cast<int>(cur - aBytes);
+    return static_cast<int>(cur + length - aBytes);
 }
 
 size_t Bytes2Hex(const uint8_t *aBytes, const uint16_t aBytesLength, char *aHex)
 {
-    char byteHex[3];
-
-    std::string hexString;
-    uint8_t     cur[aBytesLength];
-
-    memcpy(cur, aBytes, aBytesLength);
-
-    for (int i = 0; i < aBytesLength; i++)
+    for (size_t i = sEncodeBlocks(aBytes, aBytesLength, aHex); i < aBytesLength; i++)
     {
-        sprintf(byteHex, "%02X", cur[i]);
-        hexString += byteHex;
+        aHex[i * 2]     = kHexDigits[aBytes[i] >> 4];
+        aHex[i * 2 + 1] = kHexDigits[aBytes[i] & 0x0f];
     }
-    strcpy(aHex, hexString.c_str());
-    return strlen(aHex);
+
+    aHex[aBytesLength * 2] = '\0';
+
+    return aBytesLength * 2;
 }
 
 size_t Long2Hex(const uint64_t aLong, char *aHex)
 {
-    std::string hexString;
-    char        byteHex[3];
-    uint64_t    longValue = aLong;
+    uint8_t bytes[sizeof(uint64_t)];
 
+    // The least significant byte comes first.
     for (uint8_t i = 0; i < sizeof(uint64_t); i++)
     {
-        uint8_t byte = longValue & 0xff;
-        sprintf(byteHex, "%02X", byte);
-        hexString += byteHex;
-        longValue = longValue >> 8;
+        bytes[i] = static_cast<uint8_t>(aLong >> (i * 8));
     }
-    strcpy(aHex, hexString.c_str());
-    return strlen(aHex);
+
+    return Bytes2Hex(bytes, sizeof(bytes), aHex);
 }
 
 } // namespace Utils
@@ -43,6 +43,21 @@ namespace Utils {
 
 int Hex2Bytes(const char *aHex, uint8_t *aBytes, uint16_t aBytesLength);
 
+/**
+ * This function converts hex digits of a known length to bytes.
+ *
+ * An odd number of digits starts with the low nibble of the first byte. The digits need not be null-terminated.
+ *
+ * @param[in]   aHex          A pointer to the hex digits.
+ * @param[in]   aHexLength    The number of hex digits.
+ * @param[out]  aBytes        A pointer to the buffer to receive the bytes.
+ * @param[in]   aBytesLength  The size of the buffer.
+ *
+ * @returns The number of bytes converted, -1 if a character is not a hex digit or the buffer is too small.
+ *
+ */
+int Hex2Bytes(const char *aHex, size_t aHexLength, uint8_t *aBytes, uint16_t aBytesLength);
+
 size_t Bytes2Hex(const uint8_t *aBytes, const uint16_t aBytesLength, char *aHex);
 
 size_t Long2Hex(const uint64_t aLong, char *aHex);
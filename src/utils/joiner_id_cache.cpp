@@ -0,0 +1,226 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the persistent cache of joiner IDs.
+ */
+
+#include "joiner_id_cache.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "steeringdata_builder.hpp"
+#include "common/code_utils.hpp"
+
+namespace ot {
+
+static const char kCacheMagic[8] = {'O', 'T', 'B', 'R', 'J', 'I', 'D', '1'};
+
+JoinerIdCache::JoinerIdCache(void)
+    : mHeader(NULL)
+    , mEntries(NULL)
+    , mSize(0)
+    , mFd(-1)
+    , mHits(0)
+    , mMisses(0)
+{
+}
+
+JoinerIdCache::~JoinerIdCache(void)
+{
+    Close();
+}
+
+bool JoinerIdCache::Open(const char *aPath, uint32_t aCapacity)
+{
+    bool        ret      = false;
+    uint32_t    capacity = 1;
+    struct stat st;
+    void *      data;
+    Header      header;
+
+    Close();
+
+    while (capacity < aCapacity && capacity < 0x80000000u)
+    {
+        capacity <<= 1;
+    }
+
+    VerifyOrExit((mFd = open(aPath, O_RDWR | O_CREAT | O_CLOEXEC, 0644)) >= 0);
+    VerifyOrExit(flock(mFd, LOCK_EX | LOCK_NB) == 0);
+    VerifyOrExit(fstat(mFd, &st) == 0);
+
+    // A file of another version or a truncated one is started again.
+    if (static_cast<size_t>(st.st_size) >= sizeof(header) && pread(mFd, &header, sizeof(header), 0) == sizeof(header) &&
+        !memcmp(header.mMagic, kCacheMagic, sizeof(kCacheMagic)) && header.mCapacity > 0 &&
+        (header.mCapacity & (header.mCapacity - 1)) == 0 &&
+        static_cast<size_t>(st.st_size) == sizeof(header) + header.mCapacity * sizeof(Entry))
+    {
+        capacity = header.mCapacity;
+        mSize    = static_cast<size_t>(st.st_size);
+    }
+    else
+    {
+        mSize = sizeof(header) + capacity * sizeof(Entry);
+        VerifyOrExit(ftruncate(mFd, 0) == 0 && ftruncate(mFd, static_cast<off_t>(mSize)) == 0);
+        memcpy(header.mMagic, kCacheMagic, sizeof(kCacheMagic));
+        header.mCapacity = capacity;
+        header.mCount    = 0;
+        VerifyOrExit(pwrite(mFd, &header, sizeof(header), 0) == sizeof(header));
+    }
+
+    VerifyOrExit((data = mmap(NULL, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0)) != MAP_FAILED);
+
+    mHeader  = static_cast<Header *>(data);
+    mEntries = reinterpret_cast<Entry *>(mHeader + 1);
+    mHits    = 0;
+    mMisses  = 0;
+    ret      = true;
+
+exit:
+    if (!ret && mFd >= 0)
+    {
+        int error = errno;
+
+        close(mFd);
+        mFd   = -1;
+        errno = error;
+    }
+
+    return ret;
+}
+
+void JoinerIdCache::Close(void)
+{
+    if (mHeader != NULL)
+    {
+        munmap(mHeader, mSize);
+        mHeader  = NULL;
+        mEntries = NULL;
+    }
+
+    if (mFd >= 0)
+    {
+        close(mFd);
+        mFd = -1;
+    }
+}
+
+const JoinerIdCache::Entry *JoinerIdCache::Probe(const uint8_t *aEui64) const
+{
+    // FNV-1a, then linear probing up to the first unused slot.
+    uint32_t     hash  = 2166136261u;
+    uint32_t     mask  = mHeader->mCapacity - 1;
+    const Entry *entry = NULL;
+
+    for (size_t i = 0; i < kEui64Length; i++)
+    {
+        hash = (hash ^ aEui64[i]) * 16777619u;
+    }
+
+    for (uint32_t i = 0; i < mHeader->mCapacity; i++)
+    {
+        entry = &mEntries[(hash + i) & mask];
+
+        if ((entry->mJoinerId[0] & 2) == 0 || !memcmp(entry->mEui64, aEui64, kEui64Length))
+        {
+            break;
+        }
+    }
+
+    return entry;
+}
+
+bool JoinerIdCache::Find(const uint8_t *aEui64, uint8_t *aJoinerId) const
+{
+    bool         found = false;
+    const Entry *entry;
+
+    VerifyOrExit(IsOpen());
+
+    entry = Probe(aEui64);
+    VerifyOrExit((entry->mJoinerId[0] & 2) != 0 && !memcmp(entry->mEui64, aEui64, kEui64Length));
+
+    memcpy(aJoinerId, entry->mJoinerId, kEui64Length);
+    found = true;
+
+exit:
+    return found;
+}
+
+bool JoinerIdCache::Insert(const uint8_t *aEui64, const uint8_t *aJoinerId)
+{
+    bool   inserted = false;
+    Entry *entry;
+
+    VerifyOrExit(IsOpen());
+
+    entry = const_cast<Entry *>(Probe(aEui64));
+
+    if ((entry->mJoinerId[0] & 2) == 0)
+    {
+        // Probes stay short while a quarter of the slots is unused.
+        VerifyOrExit(mHeader->mCount < mHeader->mCapacity - mHeader->mCapacity / 4);
+        mHeader->mCount++;
+    }
+
+    memcpy(entry->mEui64, aEui64, kEui64Length);
+    memcpy(entry->mJoinerId, aJoinerId, kEui64Length);
+    inserted = true;
+
+exit:
+    return inserted;
+}
+
+void JoinerIdCache::ComputeJoinerId(const uint8_t *aEui64, uint8_t *aJoinerId)
+{
+    if (Find(aEui64, aJoinerId))
+    {
+        mHits++;
+    }
+    else
+    {
+        SteeringDataBuilder::ComputeJoinerId(aEui64, aJoinerId);
+        mMisses++;
+        Insert(aEui64, aJoinerId);
+    }
+}
+
+uint32_t JoinerIdCache::GetCount(void) const
+{
+    return IsOpen() ? mHeader->mCount : 0;
+}
+
+} // namespace ot
@@ -0,0 +1,184 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for the persistent cache of joiner IDs.
+ */
+
+#ifndef JOINER_ID_CACHE_HPP_
+#define JOINER_ID_CACHE_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ot {
+
+/**
+ * This class implements a cache of the joiner IDs of EUI-64s, kept in a memory-mapped file.
+ *
+ * The file is a hash table of fixed capacity, so the joiners commissioned again skip hashing their EUI-64, even
+ * across runs. The cache is locked by one process at a time. Lookups do not modify the table, and may run on many
+ * threads as long as no entry is inserted meanwhile.
+ *
+ */
+class JoinerIdCache
+{
+public:
+    enum
+    {
+        kEui64Length     = 8,     ///< Length of an EUI-64 and of a joiner ID in bytes.
+        kDefaultCapacity = 65536, ///< Default number of slots of a new cache file.
+    };
+
+    /**
+     * This constructor initializes a closed cache.
+     *
+     */
+    JoinerIdCache(void);
+
+    /**
+     * This destructor closes the cache.
+     *
+     */
+    ~JoinerIdCache(void);
+
+    /**
+     * This method opens a cache file, creating it if it does not exist or is not a cache file.
+     *
+     * @param[in]  aPath      A pointer to the path of the file.
+     * @param[in]  aCapacity  The number of slots of a new file, rounded up to a power of 2. The capacity of an
+     *                        existing file is kept.
+     *
+     * @retval true   Successfully opened the cache.
+     * @retval false  Failed to open the cache, errno is set, e.g. EWOULDBLOCK if locked by another process.
+     *
+     */
+    bool Open(const char *aPath, uint32_t aCapacity = kDefaultCapacity);
+
+    /**
+     * This method closes the cache, the entries remain in the file.
+     *
+     */
+    void Close(void);
+
+    /**
+     * This method returns whether the cache is open.
+     *
+     * @retval true   The cache is open.
+     * @retval false  The cache is closed.
+     *
+     */
+    bool IsOpen(void) const { return mHeader != NULL; }
+
+    /**
+     * This method looks up the joiner ID of an EUI-64.
+     *
+     * @param[in]   aEui64     A pointer to the EUI-64.
+     * @param[out]  aJoinerId  A pointer to receive the joiner ID.
+     *
+     * @retval true   The joiner ID was found.
+     * @retval false  The EUI-64 is not cached, or the cache is closed.
+     *
+     */
+    bool Find(const uint8_t *aEui64, uint8_t *aJoinerId) const;
+
+    /**
+     * This method adds the joiner ID of an EUI-64.
+     *
+     * @param[in]  aEui64     A pointer to the EUI-64.
+     * @param[in]  aJoinerId  A pointer to the joiner ID.
+     *
+     * @retval true   The joiner ID is cached.
+     * @retval false  The cache is closed or too full.
+     *
+     */
+    bool Insert(const uint8_t *aEui64, const uint8_t *aJoinerId);
+
+    /**
+     * This method computes the joiner ID of an EUI-64, as SteeringDataBuilder::ComputeJoinerId() does, unless cached.
+     *
+     * A computed joiner ID is added to the cache if it is open.
+     *
+     * @param[in]   aEui64     A pointer to the EUI-64.
+     * @param[out]  aJoinerId  A pointer to receive the joiner ID.
+     *
+     */
+    void ComputeJoinerId(const uint8_t *aEui64, uint8_t *aJoinerId);
+
+    /**
+     * This method returns the number of joiner IDs cached.
+     *
+     * @returns The number of entries in the file, 0 if closed.
+     *
+     */
+    uint32_t GetCount(void) const;
+
+    /**
+     * This method returns the number of joiner IDs found by ComputeJoinerId() since the cache was opened.
+     *
+     * @returns The number of hits.
+     *
+     */
+    unsigned long GetHits(void) const { return mHits; }
+
+    /**
+     * This method returns the number of joiner IDs computed by ComputeJoinerId() since the cache was opened.
+     *
+     * @returns The number of misses.
+     *
+     */
+    unsigned long GetMisses(void) const { return mMisses; }
+
+private:
+    struct Header
+    {
+        char     mMagic[8];  ///< Identifies a cache file and its version.
+        uint32_t mCapacity;  ///< Number of slots, a power of 2.
+        uint32_t mCount;     ///< Number of slots used.
+    };
+
+    struct Entry
+    {
+        uint8_t mEui64[kEui64Length];    ///< The EUI-64.
+        uint8_t mJoinerId[kEui64Length]; ///< The joiner ID, all zeros in an unused slot.
+    };
+
+    const Entry *Probe(const uint8_t *aEui64) const;
+
+    Header *      mHeader;
+    Entry *       mEntries;
+    size_t        mSize;
+    int           mFd;
+    unsigned long mHits;
+    unsigned long mMisses;
+};
+
+} // namespace ot
+
+#endif // JOINER_ID_CACHE_HPP_
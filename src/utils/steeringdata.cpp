@@ -55,19 +55,25 @@ bool SteeringData::IsCleared(void)
 }
 
 void SteeringData::ComputeBloomFilter(const uint8_t *aExtAddress)
+{
+    uint8_t first;
+    uint8_t second;
+
+    ComputeBits(aExtAddress, first, second);
+    SetBit(first);
+    SetBit(second);
+}
+
+void SteeringData::ComputeBits(const uint8_t *aExtAddress, uint8_t &aFirst, uint8_t &aSecond)
 {
     Crc16 ccitt(Crc16::kCcitt);
     Crc16 ansi(Crc16::kAnsi);
 
-    for (size_t j = 0; j < (64 / 8); j++)
-    {
-        uint8_t byte = aExtAddress[j];
-        ccitt.Update(byte);
-        ansi.Update(byte);
-    }
+    ccitt.Update(aExtAddress, LEN_BIN_EUI64);
+    ansi.Update(aExtAddress, LEN_BIN_EUI64);
 
-    SetBit(ccitt.Get() % GetNumBits());
-    SetBit(ansi.Get() % GetNumBits());
+    aFirst  = static_cast<uint8_t>(ccitt.Get() % GetNumBits());
+    aSecond = static_cast<uint8_t>(ansi.Get() % GetNumBits());
 }
 
 bool SteeringData::ComputeBloomFilterAscii(const char *ascii_eui64)
@@ -161,6 +161,20 @@ public:
         mSteeringData[b] |= m;
     }
 
+    /**
+     * This method sets the bits of another Bloom filter of the same length.
+     *
+     * @param[in]  aOther  A reference to the other steering data.
+     *
+     */
+    void Merge(const SteeringData &aOther)
+    {
+        for (uint8_t i = 0; i < mLength; i++)
+        {
+            mSteeringData[i] |= aOther.mSteeringData[i];
+        }
+    }
+
     /**
      * Ths method indicates whether or not the SteeringData is all zeros.
      *
@@ -178,6 +192,16 @@ public:
      */
     void ComputeBloomFilter(const uint8_t *pEui64);
 
+    /**
+     * This method computes the bits of the Bloom Filter set by an extended address.
+     *
+     * @param[in]   pEui64   Extended address
+     * @param[out]  aFirst   The offset of the bit from the CCITT CRC.
+     * @param[out]  aSecond  The offset of the bit from the ANSI CRC, may be the same as @p aFirst.
+     *
+     */
+    void ComputeBits(const uint8_t *pEui64, uint8_t &aFirst, uint8_t &aSecond);
+
     /**
      * This method uses an ASCII representation of an EUI64
      * to compute the Bloom filter.
@@ -0,0 +1,294 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements building the steering data of large joiner lists.
+ */
+
+#include "steeringdata_builder.hpp"
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <mbedtls/sha256.h>
+
+#include "hex.hpp"
+#include "joiner_id_cache.hpp"
+#include "common/code_utils.hpp"
+#include "common/tlv.hpp"
+
+namespace ot {
+
+namespace {
+
+/**
+ * This structure represents the joiners of a thread, with the Bloom filter they are added to.
+ *
+ */
+struct Part
+{
+    const uint8_t *                mEntries;
+    size_t                         mCount;
+    SteeringDataBuilder::EntryType mType;
+    SteeringData                   mSteeringData;
+    const JoinerIdCache *          mCache;
+    std::vector<uint8_t>           mMisses; ///< EUI-64s not cached, each followed by its joiner ID.
+};
+
+} // namespace
+
+static void *ComputePart(void *aContext)
+{
+    Part &         part = *static_cast<Part *>(aContext);
+    const uint8_t *entry;
+    uint8_t        joinerId[SteeringDataBuilder::kEui64Length];
+
+    for (size_t i = 0; i < part.mCount; i++)
+    {
+        entry = part.mEntries + i * SteeringDataBuilder::kEui64Length;
+
+        if (part.mType == SteeringDataBuilder::kEntryEui64)
+        {
+            if (part.mCache == NULL || !part.mCache->Find(entry, joinerId))
+            {
+                SteeringDataBuilder::ComputeJoinerId(entry, joinerId);
+
+                if (part.mCache != NULL)
+                {
+                    part.mMisses.insert(part.mMisses.end(), entry, entry + SteeringDataBuilder::kEui64Length);
+                    part.mMisses.insert(part.mMisses.end(), joinerId, joinerId + sizeof(joinerId));
+                }
+            }
+
+            entry = joinerId;
+        }
+
+        part.mSteeringData.ComputeBloomFilter(entry);
+    }
+
+    return NULL;
+}
+
+SteeringDataBuilder::SteeringDataBuilder(void)
+    : mCount(0)
+    , mCache(NULL)
+{
+    mSteeringData.Init();
+}
+
+void SteeringDataBuilder::Init(uint8_t aLength)
+{
+    mSteeringData.SetLength(aLength);
+    mSteeringData.Clear();
+    mCount = 0;
+}
+
+void SteeringDataBuilder::ComputeJoinerId(const uint8_t *aEui64, uint8_t *aJoinerId)
+{
+    uint8_t hash[32];
+
+    mbedtls_sha256(aEui64, kEui64Length, hash, 0);
+    memcpy(aJoinerId, hash, kEui64Length);
+    // Set the locally administered bit.
+    aJoinerId[0] |= 2;
+}
+
+void SteeringDataBuilder::Add(const uint8_t *aEntries, size_t aCount, EntryType aType, unsigned int aThreads)
+{
+    std::vector<Part>      parts;
+    std::vector<pthread_t> threads;
+    size_t                 perPart;
+
+    if (aThreads == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        aThreads = cpus > 0 ? static_cast<unsigned int>(cpus) : 1;
+    }
+
+    if (aCount / aThreads < kParallelThreshold)
+    {
+        aThreads = static_cast<unsigned int>(aCount / kParallelThreshold);
+        aThreads = aThreads > 0 ? aThreads : 1;
+    }
+
+    parts.resize(aThreads);
+    perPart = (aCount + aThreads - 1) / aThreads;
+
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        Part & part  = parts[i];
+        size_t first = i * perPart;
+
+        part.mEntries = aEntries + first * kEui64Length;
+        part.mCount   = first < aCount ? (aCount - first < perPart ? aCount - first : perPart) : 0;
+        part.mType    = aType;
+        part.mCache   = mCache;
+        part.mSteeringData.SetLength(mSteeringData.GetLength());
+        part.mSteeringData.Clear();
+    }
+
+    // Parts of threads failed to start are computed by the calling thread, which only makes it slower.
+    for (size_t i = 1; i < parts.size(); i++)
+    {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, ComputePart, &parts[i]) == 0)
+        {
+            threads.push_back(thread);
+        }
+        else
+        {
+            ComputePart(&parts[i]);
+        }
+    }
+
+    ComputePart(&parts[0]);
+
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        const std::vector<uint8_t> &misses = parts[i].mMisses;
+
+        mSteeringData.Merge(parts[i].mSteeringData);
+
+        for (size_t j = 0; j < misses.size(); j += kEui64Length * 2)
+        {
+            mCache->Insert(&misses[j], &misses[j + kEui64Length]);
+        }
+    }
+
+    mCount += aCount;
+}
+
+bool SteeringDataBuilder::AddFile(const char *aPath, EntryType aType, unsigned int aThreads, unsigned long &aLine)
+{
+    bool                 ret  = false;
+    FILE *               file = fopen(aPath, "r");
+    std::vector<uint8_t> entries;
+    char                 line[128];
+
+    aLine = 0;
+
+    VerifyOrExit(file != NULL);
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char * begin = line;
+        size_t length;
+
+        aLine++;
+
+        while (isspace(static_cast<unsigned char>(*begin)))
+        {
+            begin++;
+        }
+
+        length = strlen(begin);
+
+        while (length > 0 && isspace(static_cast<unsigned char>(begin[length - 1])))
+        {
+            begin[--length] = '\0';
+        }
+
+        if (length == 0 || begin[0] == '#')
+        {
+            continue;
+        }
+
+        entries.resize(entries.size() + kEui64Length);
+
+        VerifyOrExit(length == kEui64Length * 2 &&
+                     Utils::Hex2Bytes(begin, &entries[entries.size() - kEui64Length], kEui64Length) == kEui64Length);
+    }
+
+    VerifyOrExit(!ferror(file), aLine = 0);
+
+    if (!entries.empty())
+    {
+        Add(&entries[0], entries.size() / kEui64Length, aType, aThreads);
+    }
+
+    ret = true;
+
+exit:
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+
+    return ret;
+}
+
+double SteeringDataBuilder::GetFalsePositiveRate(void)
+{
+    const uint8_t *data = mSteeringData.GetDataPointer();
+    unsigned int   set  = 0;
+    double         ratio;
+
+    for (uint8_t i = 0; i < mSteeringData.GetLength(); i++)
+    {
+        for (uint8_t byte = data[i]; byte != 0; byte &= byte - 1)
+        {
+            set++;
+        }
+    }
+
+    // A joiner not added is accepted when the bits of both CRCs are set.
+    ratio = static_cast<double>(set) / mSteeringData.GetNumBits();
+
+    return ratio * ratio;
+}
+
+size_t SteeringDataBuilder::WriteTlv(uint8_t *aBuffer, size_t aSize)
+{
+    Tlv *  tlv    = reinterpret_cast<Tlv *>(aBuffer);
+    size_t length = sizeof(uint8_t) * 2 + mSteeringData.GetLength();
+
+    if (aSize < length)
+    {
+        return 0;
+    }
+
+    tlv->SetType(Meshcop::kSteeringData);
+    tlv->SetValue(mSteeringData.GetDataPointer(), mSteeringData.GetLength());
+
+    return length;
+}
+
+} // namespace ot
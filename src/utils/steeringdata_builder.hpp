@@ -0,0 +1,174 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for building the steering data of large joiner lists.
+ */
+
+#ifndef STEERINGDATA_BUILDER_HPP_
+#define STEERINGDATA_BUILDER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "steeringdata.hpp"
+
+namespace ot {
+
+class JoinerIdCache;
+
+/**
+ * This class builds the steering data of many joiners at once.
+ *
+ * Lists of at least kParallelThreshold joiners are split across threads, each computing the Bloom filter of its
+ * part, which are merged at the end. With a joiner ID cache, the joiner IDs of EUI-64s cached are not hashed again,
+ * and those hashed are added to the cache once all threads are done.
+ *
+ */
+class SteeringDataBuilder
+{
+public:
+    enum
+    {
+        kEui64Length       = 8,    ///< Length of an EUI-64 and of a joiner ID in bytes.
+        kParallelThreshold = 4096, ///< Minimum number of joiners worth splitting across threads.
+    };
+
+    /**
+     * This enumeration defines the entries of a joiner list.
+     *
+     */
+    enum EntryType
+    {
+        kEntryEui64,    ///< The entries are EUI-64s, hashed into joiner IDs.
+        kEntryJoinerId, ///< The entries are joiner IDs.
+    };
+
+    /**
+     * This constructor initializes the builder with empty steering data of the default length.
+     *
+     */
+    SteeringDataBuilder(void);
+
+    /**
+     * This method clears the steering data and sets its length.
+     *
+     * @param[in]  aLength  The length of the steering data in bytes, 1 to 16.
+     *
+     */
+    void Init(uint8_t aLength);
+
+    /**
+     * This method sets the cache of joiner IDs used by Add() and AddFile().
+     *
+     * @param[in]  aCache  A pointer to the cache, NULL to hash every EUI-64.
+     *
+     */
+    void SetJoinerIdCache(JoinerIdCache *aCache) { mCache = aCache; }
+
+    /**
+     * This method computes the joiner ID of an EUI-64.
+     *
+     * @param[in]   aEui64     A pointer to the EUI-64.
+     * @param[out]  aJoinerId  A pointer to receive the joiner ID.
+     *
+     */
+    static void ComputeJoinerId(const uint8_t *aEui64, uint8_t *aJoinerId);
+
+    /**
+     * This method adds joiners to the steering data.
+     *
+     * @param[in]  aEntries  A pointer to the entries, kEui64Length bytes each.
+     * @param[in]  aCount    The number of entries.
+     * @param[in]  aType     The type of the entries.
+     * @param[in]  aThreads  The maximum number of threads, 0 for the number of online CPUs.
+     *
+     */
+    void Add(const uint8_t *aEntries, size_t aCount, EntryType aType, unsigned int aThreads);
+
+    /**
+     * This method adds the joiners of a file to the steering data.
+     *
+     * The file has one entry per line in hex, empty lines and lines starting with '#' are skipped.
+     *
+     * @param[in]   aPath     A pointer to the path of the file.
+     * @param[in]   aType     The type of the entries.
+     * @param[in]   aThreads  The maximum number of threads, 0 for the number of online CPUs.
+     * @param[out]  aLine     The number of the line not well formed, 0 if the file could not be read.
+     *
+     * @retval true   Successfully added all the joiners of the file.
+     * @retval false  Failed to read the file, no joiner was added.
+     *
+     */
+    bool AddFile(const char *aPath, EntryType aType, unsigned int aThreads, unsigned long &aLine);
+
+    /**
+     * This method returns the number of joiners added.
+     *
+     * @returns The number of joiners added since Init().
+     *
+     */
+    size_t GetCount(void) const { return mCount; }
+
+    /**
+     * This method returns the steering data.
+     *
+     * @returns A reference to the steering data.
+     *
+     */
+    SteeringData &GetSteeringData(void) { return mSteeringData; }
+
+    /**
+     * This method estimates the rate of joiners not added but accepted by the steering data.
+     *
+     * @returns The false-positive rate, from 0 to 1.
+     *
+     */
+    double GetFalsePositiveRate(void);
+
+    /**
+     * This method writes the steering data TLV.
+     *
+     * @param[out]  aBuffer  A pointer to the buffer to receive the TLV.
+     * @param[in]   aSize    The size of the buffer.
+     *
+     * @returns The length of the TLV, 0 if the buffer is too small.
+     *
+     */
+    size_t WriteTlv(uint8_t *aBuffer, size_t aSize);
+
+private:
+    SteeringData   mSteeringData;
+    size_t         mCount;
+    JoinerIdCache *mCache;
+};
+
+} // namespace ot
+
+#endif // STEERINGDATA_BUILDER_HPP_
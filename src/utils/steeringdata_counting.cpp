@@ -0,0 +1,129 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the steering data of joiner lists that change one joiner at a time.
+ */
+
+#include "steeringdata_counting.hpp"
+
+#include <string.h>
+
+#include "common/code_utils.hpp"
+#include "common/tlv.hpp"
+
+namespace ot {
+
+CountingSteeringData::CountingSteeringData(void)
+{
+    Init(kMaxLength);
+}
+
+void CountingSteeringData::Init(uint8_t aLength)
+{
+    mSteeringData.SetLength(aLength);
+    mSteeringData.Clear();
+    memset(mCounters, 0, sizeof(mCounters));
+    mCount = 0;
+}
+
+void CountingSteeringData::Add(const uint8_t *aJoinerId)
+{
+    uint8_t first;
+    uint8_t second;
+
+    mSteeringData.ComputeBits(aJoinerId, first, second);
+    Increment(first);
+    Increment(second);
+    mCount++;
+}
+
+bool CountingSteeringData::Remove(const uint8_t *aJoinerId)
+{
+    bool    removed = false;
+    uint8_t first;
+    uint8_t second;
+
+    mSteeringData.ComputeBits(aJoinerId, first, second);
+
+    // Both bits of the joiner are counted twice when they are the same one.
+    VerifyOrExit(mCount > 0 && mCounters[first] > 0 && mCounters[second] > 0);
+    VerifyOrExit(first != second || mCounters[first] > 1 || mCounters[first] == kMaxCounter);
+
+    Decrement(first);
+    Decrement(second);
+    mCount--;
+    removed = true;
+
+exit:
+    return removed;
+}
+
+void CountingSteeringData::Increment(uint8_t aBit)
+{
+    if (mCounters[aBit] == 0)
+    {
+        mSteeringData.SetBit(aBit);
+    }
+
+    if (mCounters[aBit] < kMaxCounter)
+    {
+        mCounters[aBit]++;
+    }
+}
+
+void CountingSteeringData::Decrement(uint8_t aBit)
+{
+    // A saturated counter has lost count of its joiners, so its bit stays set.
+    VerifyOrExit(mCounters[aBit] < kMaxCounter);
+
+    if (--mCounters[aBit] == 0)
+    {
+        mSteeringData.ClearBit(aBit);
+    }
+
+exit:
+    return;
+}
+
+size_t CountingSteeringData::WriteTlv(uint8_t *aBuffer, size_t aSize)
+{
+    Tlv *  tlv    = reinterpret_cast<Tlv *>(aBuffer);
+    size_t length = sizeof(uint8_t) * 2 + mSteeringData.GetLength();
+
+    VerifyOrExit(aSize >= length, length = 0);
+
+    tlv->SetType(Meshcop::kSteeringData);
+    tlv->SetValue(mSteeringData.GetDataPointer(), mSteeringData.GetLength());
+
+exit:
+    return length;
+}
+
+} // namespace ot
@@ -0,0 +1,134 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for the steering data of joiner lists that change one joiner at a time.
+ */
+
+#ifndef STEERINGDATA_COUNTING_HPP_
+#define STEERINGDATA_COUNTING_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "steeringdata.hpp"
+
+namespace ot {
+
+/**
+ * This class maintains the steering data of a joiner list with a counting Bloom filter.
+ *
+ * Each bit of the steering data has a counter of the joiners setting it, so that joiners are added and removed
+ * without computing the Bloom filter of the remaining ones again. The steering data is updated as counters become
+ * zero or non-zero, and is always ready to be sent.
+ *
+ */
+class CountingSteeringData
+{
+public:
+    enum
+    {
+        kMaxLength  = 16,     ///< Max length of the steering data in bytes.
+        kMaxCounter = 0xffff, ///< Counters reaching this value are never decremented again.
+    };
+
+    /**
+     * This constructor initializes empty steering data of the default length.
+     *
+     */
+    CountingSteeringData(void);
+
+    /**
+     * This method removes all joiners and sets the length of the steering data.
+     *
+     * @param[in]  aLength  The length of the steering data in bytes, 1 to kMaxLength.
+     *
+     */
+    void Init(uint8_t aLength);
+
+    /**
+     * This method adds a joiner.
+     *
+     * @param[in]  aJoinerId  A pointer to the joiner ID, as computed by SteeringDataBuilder::ComputeJoinerId().
+     *
+     */
+    void Add(const uint8_t *aJoinerId);
+
+    /**
+     * This method removes a joiner added before.
+     *
+     * Removing a joiner never added corrupts the counters of other joiners, unless it is detected as such.
+     *
+     * @param[in]  aJoinerId  A pointer to the joiner ID.
+     *
+     * @retval true   Successfully removed the joiner.
+     * @retval false  The joiner cannot have been added, nothing is changed.
+     *
+     */
+    bool Remove(const uint8_t *aJoinerId);
+
+    /**
+     * This method returns the number of joiners added and not removed.
+     *
+     * @returns The number of joiners.
+     *
+     */
+    size_t GetCount(void) const { return mCount; }
+
+    /**
+     * This method returns the steering data.
+     *
+     * @returns A reference to the steering data.
+     *
+     */
+    SteeringData &GetSteeringData(void) { return mSteeringData; }
+
+    /**
+     * This method writes the steering data TLV.
+     *
+     * @param[out]  aBuffer  A pointer to the buffer to receive the TLV.
+     * @param[in]   aSize    The size of the buffer.
+     *
+     * @returns The length of the TLV, 0 if the buffer is too small.
+     *
+     */
+    size_t WriteTlv(uint8_t *aBuffer, size_t aSize);
+
+private:
+    void Increment(uint8_t aBit);
+    void Decrement(uint8_t aBit);
+
+    SteeringData mSteeringData;
+    uint16_t     mCounters[kMaxLength * 8]; ///< Number of joiners setting each bit.
+    size_t       mCount;
+};
+
+} // namespace ot
+
+#endif // STEERINGDATA_COUNTING_HPP_
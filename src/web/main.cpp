@@ -36,9 +36,12 @@
 
 #define OT_HTTP_PORT 80
 
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_WEB
+
 #include "otbr-config.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -51,11 +54,48 @@
 static const char kSyslogIdent[]          = "otWeb";
 static const char kDefaultInterfaceName[] = "wpan0";
 
+enum
+{
+    kListenFdsStart = 3, ///< The first file descriptor passed by systemd, SD_LISTEN_FDS_START.
+};
+
 void PrintVersion(void)
 {
     printf("%s\n", PACKAGE_VERSION);
 }
 
+/**
+ * This function returns the listening socket passed by systemd socket activation.
+ *
+ * It follows the protocol of sd_listen_fds(3), without linking libsystemd.
+ *
+ * @returns The file descriptor of the socket, -1 if none is passed.
+ *
+ */
+static int GetListenSocket(void)
+{
+    const char *pid = getenv("LISTEN_PID");
+    const char *fds = getenv("LISTEN_FDS");
+    int         fd  = -1;
+
+    VerifyOrExit(pid != NULL && fds != NULL && atoi(pid) == getpid() && atoi(fds) >= 1);
+
+    if (atoi(fds) > 1)
+    {
+        otbrLog(OTBR_LOG_WARNING, "%s sockets passed, only the first one is used", fds);
+    }
+
+    fd = kListenFdsStart;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+exit:
+    // Not passed to child processes.
+    unsetenv("LISTEN_PID");
+    unsetenv("LISTEN_FDS");
+    unsetenv("LISTEN_FDNAMES");
+    return fd;
+}
+
 int main(int argc, char **argv)
 {
     const char *interfaceName = NULL;
@@ -63,18 +103,45 @@ int main(int argc, char **argv)
     int         logLevel      = OTBR_LOG_INFO;
     int         ret           = 0;
     int         opt;
-    uint16_t    port = OT_HTTP_PORT;
+    uint16_t    port        = OT_HTTP_PORT;
+    int         threads     = 1;
+    int         idleTimeout = 0;
+    int         listenFd;
+
+    // Negative to keep the defaults of the web server.
+    int maxConnections = -1;
+    int requestTimeout = -1;
+    int contentTimeout = -1;
+    int maxRequestSize = -1;
 
     ot::Web::WebServer *server = NULL;
 
-    while ((opt = getopt(argc, argv, "d:I:p:v")) != -1)
+    while ((opt = getopt(argc, argv, "c:d:i:I:p:r:s:t:vw:")) != -1)
     {
         switch (opt)
         {
+        case 'c':
+            maxConnections = atoi(optarg);
+            if (maxConnections < 0)
+            {
+                fprintf(stderr, "Invalid max number of connections: %s\n", optarg);
+                ExitNow(ret = -1);
+            }
+            break;
+
         case 'd':
             logLevel = atoi(optarg);
             break;
 
+        case 'i':
+            idleTimeout = atoi(optarg);
+            if (idleTimeout < 0)
+            {
+                fprintf(stderr, "Invalid idle timeout: %s\n", optarg);
+                ExitNow(ret = -1);
+            }
+            break;
+
         case 'I':
             interfaceName = optarg;
             break;
@@ -85,13 +152,52 @@ int main(int argc, char **argv)
             port = atoi(httpPort);
             break;
 
+        case 'r':
+            requestTimeout = atoi(optarg);
+            if (requestTimeout < 0)
+            {
+                fprintf(stderr, "Invalid request timeout: %s\n", optarg);
+                ExitNow(ret = -1);
+            }
+            break;
+
+        case 's':
+            maxRequestSize = atoi(optarg);
+            if (maxRequestSize <= 0)
+            {
+                fprintf(stderr, "Invalid max request size: %s\n", optarg);
+                ExitNow(ret = -1);
+            }
+            break;
+
+        case 't':
+            threads = atoi(optarg);
+            if (threads <= 0)
+            {
+                fprintf(stderr, "Invalid number of threads: %s\n", optarg);
+                ExitNow(ret = -1);
+            }
+            break;
+
         case 'v':
             PrintVersion();
             ExitNow();
             break;
 
+        case 'w':
+            contentTimeout = atoi(optarg);
+            if (contentTimeout < 0)
+            {
+                fprintf(stderr, "Invalid content timeout: %s\n", optarg);
+                ExitNow(ret = -1);
+            }
+            break;
+
         default:
-            fprintf(stderr, "Usage: %s [-d DEBUG_LEVEL] [-I interfaceName] [-p port] [-v]\n", argv[0]);
+            fprintf(stderr,
+                    "Usage: %s [-c maxConnections] [-d DEBUG_LEVEL] [-i idleTimeout] [-I interfaceName] [-p port] "
+                    "[-r requestTimeout] [-s maxRequestSize] [-t threads] [-v] [-w contentTimeout]\n",
+                    argv[0]);
             ExitNow(ret = -1);
             break;
         }
@@ -112,6 +218,37 @@ int main(int argc, char **argv)
     otbrLog(OTBR_LOG_INFO, "border router web started on %s", interfaceName);
 
     server = new ot::Web::WebServer();
+    server->SetThreadPoolSize(static_cast<size_t>(threads));
+
+    if (maxConnections >= 0)
+    {
+        server->SetMaxConnections(static_cast<size_t>(maxConnections));
+    }
+
+    if (requestTimeout >= 0)
+    {
+        server->SetRequestTimeout(static_cast<uint32_t>(requestTimeout));
+    }
+
+    if (contentTimeout >= 0)
+    {
+        server->SetContentTimeout(static_cast<uint32_t>(contentTimeout));
+    }
+
+    if (maxRequestSize > 0)
+    {
+        server->SetMaxRequestSize(static_cast<size_t>(maxRequestSize));
+    }
+
+    // Started by systemd on the first connection, the server exits when idle and is started again on the next one.
+    listenFd = GetListenSocket();
+
+    if (listenFd >= 0)
+    {
+        otbrLog(OTBR_LOG_INFO, "listening on the socket passed by systemd");
+        server->SetListenSocket(listenFd);
+        server->SetIdleTimeout(static_cast<uint32_t>(idleTimeout));
+    }
     server->StartWebServer(interfaceName, port);
 
     otbrLogDeinit();
@@ -33,12 +33,474 @@
 
 #include "pskc.hpp"
 
+#include <pthread.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <mbedtls/aes.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <wmmintrin.h>
+#define OTBR_PSKC_AESNI 1
+#elif defined(__aarch64__) && defined(__linux__)
+#include <arm_neon.h>
+#define OTBR_PSKC_ARMV8_AES 1
+#endif
+
 #include "common/code_utils.hpp"
 #include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "utils/cpu_features.hpp"
 
 namespace ot {
 namespace Psk {
 
+static BorderRouter::Metrics::Counter sCacheHits("pskc.cache_hits");
+static BorderRouter::Metrics::Counter sCacheMisses("pskc.cache_misses");
+static BorderRouter::Metrics::Counter sMultiBufferDerived("pskc.multi_buffer_derived");
+
+/**
+ * This structure is an entry of the PSKc cache, keyed by the salt and the passphrase.
+ *
+ */
+struct CacheEntry
+{
+    char     mSalt[OT_PBKDF2_SALT_MAX_LENGTH];
+    uint16_t mSaltLen;
+    char     mPassphrase[OT_PASSPHRASE_MAX_LENGTH];
+    uint16_t mPassphraseLen;
+    uint8_t  mPskc[OT_PSKC_LENGTH];
+    uint32_t mLastUsed; ///< The cache tick of the last use, 0 if the entry is free.
+};
+
+static pthread_mutex_t sCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static CacheEntry      sCache[Pskc::kCacheSize];
+static uint32_t        sCacheTick;
+
+static void Wipe(void *aBuffer, size_t aSize)
+{
+    // Writes through a volatile pointer are not optimized out as dead stores.
+    volatile uint8_t *cur = static_cast<volatile uint8_t *>(aBuffer);
+
+    while (aSize--)
+    {
+        *cur++ = 0;
+    }
+}
+
+static CacheEntry *FindEntry(const char *aSalt, uint16_t aSaltLen, const char *aPassphrase, size_t aPassphraseLen)
+{
+    CacheEntry *entry = NULL;
+
+    for (size_t i = 0; i < Pskc::kCacheSize; i++)
+    {
+        if (sCache[i].mLastUsed != 0 && sCache[i].mSaltLen == aSaltLen && sCache[i].mPassphraseLen == aPassphraseLen &&
+            memcmp(sCache[i].mSalt, aSalt, aSaltLen) == 0 &&
+            memcmp(sCache[i].mPassphrase, aPassphrase, aPassphraseLen) == 0)
+        {
+            entry = &sCache[i];
+            break;
+        }
+    }
+
+    return entry;
+}
+
+/**
+ * This class computes AES-CMAC-PRF-128 (RFC 4615) with a fixed key, as the PRF of PBKDF2.
+ *
+ * The PRF key, its AES key schedule and the CMAC subkey are derived once, instead of at each call of
+ * mbedtls_aes_cmac_prf_128(). A message of a single block, as in all but the first iteration of PBKDF2, then takes a
+ * single AES block encryption, which mbedtls runs with AES-NI when built with it and the CPU supports it.
+ *
+ */
+class CmacPrf
+{
+public:
+    enum
+    {
+        kBlockSize = 16,
+        kRounds    = 10, ///< Number of rounds of AES-128.
+    };
+
+    CmacPrf(const uint8_t *aKey, size_t aLength)
+    {
+        const mbedtls_cipher_info_t *info = mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB);
+        uint8_t                      key[kBlockSize];
+        uint8_t                      zero[kBlockSize] = {0};
+        uint8_t                      msb;
+
+        if (aLength == sizeof(key))
+        {
+            memcpy(key, aKey, sizeof(key));
+        }
+        else
+        {
+            mbedtls_cipher_cmac(info, zero, sizeof(zero) * 8, aKey, aLength, key);
+        }
+
+        mbedtls_aes_init(&mAes);
+        mbedtls_aes_setkey_enc(&mAes, key, sizeof(key) * 8);
+        mbedtls_cipher_init(&mCmac);
+        mbedtls_cipher_setup(&mCmac, info);
+        mbedtls_cipher_cmac_starts(&mCmac, key, sizeof(key) * 8);
+
+        // The subkey K1 is L = AES(K, 0) doubled in GF(2^128).
+        mbedtls_aes_crypt_ecb(&mAes, MBEDTLS_AES_ENCRYPT, zero, mSubkey);
+        msb = mSubkey[0] >> 7;
+        for (size_t i = 0; i < kBlockSize - 1; i++)
+        {
+            mSubkey[i] = static_cast<uint8_t>((mSubkey[i] << 1) | (mSubkey[i + 1] >> 7));
+        }
+        mSubkey[kBlockSize - 1] = static_cast<uint8_t>((mSubkey[kBlockSize - 1] << 1) ^ (msb ? 0x87 : 0));
+
+        Wipe(key, sizeof(key));
+    }
+
+    ~CmacPrf(void)
+    {
+        mbedtls_aes_free(&mAes);
+        mbedtls_cipher_free(&mCmac);
+        Wipe(mSubkey, sizeof(mSubkey));
+    }
+
+    /**
+     * This method computes the PRF of a message of any length.
+     *
+     */
+    void Compute(const uint8_t *aInput, size_t aLength, uint8_t *aOutput)
+    {
+        mbedtls_cipher_cmac_update(&mCmac, aInput, aLength);
+        mbedtls_cipher_cmac_finish(&mCmac, aOutput);
+        mbedtls_cipher_cmac_reset(&mCmac);
+    }
+
+    /**
+     * This method computes the PRF of a message of a single block, @p aOutput may be @p aInput.
+     *
+     */
+    void ComputeBlock(const uint8_t *aInput, uint8_t *aOutput)
+    {
+        uint8_t block[kBlockSize];
+
+        // The last block of the message is complete, it is XORed with K1 before encryption.
+        for (size_t i = 0; i < kBlockSize; i++)
+        {
+            block[i] = aInput[i] ^ mSubkey[i];
+        }
+
+        mbedtls_aes_crypt_ecb(&mAes, MBEDTLS_AES_ENCRYPT, block, aOutput);
+    }
+
+    /**
+     * This method gets the AES round keys computing the PRF of a single block, with K1 folded into the first one.
+     *
+     */
+    void GetBlockKeys(uint8_t (*aRoundKeys)[kBlockSize]) const
+    {
+        memcpy(aRoundKeys, mAes.rk, (kRounds + 1) * kBlockSize);
+
+        for (size_t i = 0; i < kBlockSize; i++)
+        {
+            aRoundKeys[0][i] ^= mSubkey[i];
+        }
+    }
+
+private:
+
+    mbedtls_aes_context      mAes;
+    mbedtls_cipher_context_t mCmac;
+    uint8_t                  mSubkey[kBlockSize];
+};
+
+/**
+ * This structure keeps the blocks of the PBKDF2 derivations run by the multi-buffer kernel, one per lane.
+ *
+ */
+struct LaneBlocks
+{
+    uint8_t mRoundKeys[Pskc::kMaxLanes][CmacPrf::kRounds + 1][CmacPrf::kBlockSize]; ///< See CmacPrf::GetBlockKeys().
+    uint8_t mState[Pskc::kMaxLanes][CmacPrf::kBlockSize];    ///< U_i, the output of the last iteration.
+    uint8_t mKeyBlock[Pskc::kMaxLanes][CmacPrf::kBlockSize]; ///< The XOR of the outputs of the iterations.
+};
+
+/**
+ * This function pointer runs PBKDF2 iterations on the lanes of the blocks, unused lanes are computed and ignored.
+ *
+ */
+typedef void (*LaneKernel)(LaneBlocks &aBlocks, size_t aLanes, uint32_t aIterations);
+
+// The kernel computes the key block of a single PRF block, which is the whole PSKc.
+OTBR_STATIC_ASSERT(OT_PSKC_LENGTH == CmacPrf::kBlockSize, PskcSingleBlock);
+
+#if OTBR_PSKC_AESNI
+__attribute__((target("sse2"))) static inline __m128i LoadBlock(const uint8_t *aBlock)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(aBlock));
+}
+
+template <size_t kLanes>
+__attribute__((target("aes,sse2"))) static void IterateAesni(LaneBlocks &aBlocks, uint32_t aIterations)
+{
+    __m128i state[kLanes];
+    __m128i keyBlock[kLanes];
+
+    for (size_t l = 0; l < kLanes; l++)
+    {
+        state[l]    = LoadBlock(aBlocks.mState[l]);
+        keyBlock[l] = LoadBlock(aBlocks.mKeyBlock[l]);
+    }
+
+    // The lanes are independent, the encryption of a lane starts while the others are in flight.
+    for (uint32_t i = 0; i < aIterations; i++)
+    {
+        for (size_t l = 0; l < kLanes; l++)
+        {
+            state[l] = _mm_xor_si128(state[l], LoadBlock(aBlocks.mRoundKeys[l][0]));
+        }
+
+        for (size_t r = 1; r < CmacPrf::kRounds; r++)
+        {
+            for (size_t l = 0; l < kLanes; l++)
+            {
+                state[l] = _mm_aesenc_si128(state[l], LoadBlock(aBlocks.mRoundKeys[l][r]));
+            }
+        }
+
+        for (size_t l = 0; l < kLanes; l++)
+        {
+            state[l]    = _mm_aesenclast_si128(state[l], LoadBlock(aBlocks.mRoundKeys[l][CmacPrf::kRounds]));
+            keyBlock[l] = _mm_xor_si128(keyBlock[l], state[l]);
+        }
+    }
+
+    for (size_t l = 0; l < kLanes; l++)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(aBlocks.mState[l]), state[l]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(aBlocks.mKeyBlock[l]), keyBlock[l]);
+    }
+}
+
+static void RunAesni(LaneBlocks &aBlocks, size_t aLanes, uint32_t aIterations)
+{
+    if (aLanes > Pskc::kMaxLanes / 2)
+    {
+        IterateAesni<Pskc::kMaxLanes>(aBlocks, aIterations);
+    }
+    else
+    {
+        IterateAesni<Pskc::kMaxLanes / 2>(aBlocks, aIterations);
+    }
+}
+#endif // OTBR_PSKC_AESNI
+
+#if OTBR_PSKC_ARMV8_AES
+template <size_t kLanes>
+__attribute__((target("+crypto"))) static void IterateArmv8(LaneBlocks &aBlocks, uint32_t aIterations)
+{
+    uint8x16_t state[kLanes];
+    uint8x16_t keyBlock[kLanes];
+
+    for (size_t l = 0; l < kLanes; l++)
+    {
+        state[l]    = vld1q_u8(aBlocks.mState[l]);
+        keyBlock[l] = vld1q_u8(aBlocks.mKeyBlock[l]);
+    }
+
+    // AESE adds the round key before substituting, so the last round key is added on its own.
+    for (uint32_t i = 0; i < aIterations; i++)
+    {
+        for (size_t r = 0; r < CmacPrf::kRounds - 1; r++)
+        {
+            for (size_t l = 0; l < kLanes; l++)
+            {
+                state[l] = vaesmcq_u8(vaeseq_u8(state[l], vld1q_u8(aBlocks.mRoundKeys[l][r])));
+            }
+        }
+
+        for (size_t l = 0; l < kLanes; l++)
+        {
+            state[l]    = vaeseq_u8(state[l], vld1q_u8(aBlocks.mRoundKeys[l][CmacPrf::kRounds - 1]));
+            state[l]    = veorq_u8(state[l], vld1q_u8(aBlocks.mRoundKeys[l][CmacPrf::kRounds]));
+            keyBlock[l] = veorq_u8(keyBlock[l], state[l]);
+        }
+    }
+
+    for (size_t l = 0; l < kLanes; l++)
+    {
+        vst1q_u8(aBlocks.mState[l], state[l]);
+        vst1q_u8(aBlocks.mKeyBlock[l], keyBlock[l]);
+    }
+}
+
+static void RunArmv8(LaneBlocks &aBlocks, size_t aLanes, uint32_t aIterations)
+{
+    if (aLanes > Pskc::kMaxLanes / 2)
+    {
+        IterateArmv8<Pskc::kMaxLanes>(aBlocks, aIterations);
+    }
+    else
+    {
+        IterateArmv8<Pskc::kMaxLanes / 2>(aBlocks, aIterations);
+    }
+}
+#endif // OTBR_PSKC_ARMV8_AES
+
+static LaneKernel sDetectedKernel = NULL;
+static LaneKernel sKernel         = NULL;
+static bool       sMultiBuffer    = true;
+
+static void BindKernels(uint32_t aFeatures)
+{
+    using Utils::CpuFeatures;
+
+    sDetectedKernel = NULL;
+
+#if OTBR_PSKC_AESNI
+    if ((aFeatures & CpuFeatures::kAes) && (aFeatures & CpuFeatures::kSse2))
+    {
+        sDetectedKernel = RunAesni;
+    }
+#elif OTBR_PSKC_ARMV8_AES
+    if (aFeatures & CpuFeatures::kAes)
+    {
+        sDetectedKernel = RunArmv8;
+    }
+#else
+    (void)aFeatures;
+#endif
+
+    sKernel = sMultiBuffer ? sDetectedKernel : NULL;
+}
+
+static const Utils::CpuFeatures::Binding sBinding(BindKernels);
+
+/**
+ * This structure keeps the state of a batch, whose items are taken by the threads in order.
+ *
+ */
+struct Batch
+{
+    Pskc::BatchItem *mItems;
+    size_t           mCount;
+    size_t           mChunk; ///< The number of items taken at once by a thread.
+    size_t           mNext;  ///< The index of the next item to compute.
+};
+
+void *Pskc::RunBatch(void *aContext)
+{
+    Batch &     batch = *static_cast<Batch *>(aContext);
+    Pskc        pskcs[kMaxLanes];
+    Pskc *      misses[kMaxLanes];
+    const char *passphrases[kMaxLanes];
+    size_t      index;
+
+    while ((index = __sync_fetch_and_add(&batch.mNext, batch.mChunk)) < batch.mCount)
+    {
+        BatchItem *items = &batch.mItems[index];
+        size_t     count = batch.mCount - index < batch.mChunk ? batch.mCount - index : batch.mChunk;
+        size_t     missCount = 0;
+
+        // The items of the chunk not cached are derived at once.
+        for (size_t i = 0; i < count; i++)
+        {
+            pskcs[i].SetSalt(items[i].mExtPanId, items[i].mNetworkName);
+
+            if (!pskcs[i].LookUp(items[i].mPassphrase, strlen(items[i].mPassphrase)))
+            {
+                misses[missCount]      = &pskcs[i];
+                passphrases[missCount] = items[i].mPassphrase;
+                missCount++;
+            }
+        }
+
+        Derive(misses, passphrases, missCount);
+
+        for (size_t i = 0; i < missCount; i++)
+        {
+            misses[i]->Store(passphrases[i], strlen(passphrases[i]));
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            memcpy(items[i].mPskc, pskcs[i].mPskc, sizeof(items[i].mPskc));
+        }
+    }
+
+    return NULL;
+}
+
+void Pskc::ComputeBatch(BatchItem *aItems, size_t aCount, unsigned int aThreads)
+{
+    Batch                  batch = {aItems, aCount, 1, 0};
+    std::vector<pthread_t> threads;
+
+    if (aThreads == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        aThreads = cpus > 0 ? static_cast<unsigned int>(cpus) : 1;
+    }
+
+    // The items are spread over the threads before they fill the lanes of the kernel.
+    if (sKernel != NULL)
+    {
+        batch.mChunk = (aCount + aThreads - 1) / aThreads;
+
+        if (batch.mChunk > kMaxLanes)
+        {
+            batch.mChunk = kMaxLanes;
+        }
+        else if (batch.mChunk == 0)
+        {
+            batch.mChunk = 1;
+        }
+    }
+
+    // The calling thread is a thread of the batch, threads failed to start only make it slower.
+    for (size_t i = 1; i < aThreads && i * batch.mChunk < aCount; i++)
+    {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, RunBatch, &batch) != 0)
+        {
+            otbrLog(OTBR_LOG_WARNING, "Failed to start a PSKc thread");
+            break;
+        }
+
+        threads.push_back(thread);
+    }
+
+    RunBatch(&batch);
+
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+bool Pskc::SetMultiBuffer(bool aEnabled)
+{
+    sMultiBuffer = aEnabled;
+    sKernel      = aEnabled ? sDetectedKernel : NULL;
+
+    return sKernel != NULL;
+}
+
+void Pskc::ClearCache(void)
+{
+    pthread_mutex_lock(&sCacheMutex);
+    Wipe(sCache, sizeof(sCache));
+    pthread_mutex_unlock(&sCacheMutex);
+}
+
+void Pskc::GetCacheCounters(uint64_t &aHits, uint64_t &aMisses)
+{
+    aHits   = sCacheHits.GetValue();
+    aMisses = sCacheMisses.GetValue();
+}
+
 void Pskc::SetSalt(const uint8_t *aExtPanId, const char *aNetworkName)
 {
     const char *saltPrefix = "Thread";
@@ -68,6 +530,128 @@ exit:
 
 const uint8_t *Pskc::ComputePskc(const uint8_t *aExtPanId, const char *aNetworkName, const char *aPassphrase)
 {
+    size_t passphraseLen = strlen(aPassphrase);
+    Pskc * self          = this;
+
+    SetSalt(aExtPanId, aNetworkName);
+
+    if (!LookUp(aPassphrase, passphraseLen))
+    {
+        // The cache is not locked while deriving, which takes long, the same PSKc may be derived twice meanwhile.
+        Derive(&self, &aPassphrase, 1);
+        Store(aPassphrase, passphraseLen);
+    }
+
+    return mPskc;
+}
+
+bool Pskc::LookUp(const char *aPassphrase, size_t aLength)
+{
+    CacheEntry *entry = NULL;
+
+    if (aLength <= OT_PASSPHRASE_MAX_LENGTH)
+    {
+        pthread_mutex_lock(&sCacheMutex);
+        entry = FindEntry(mSalt, mSaltLen, aPassphrase, aLength);
+        if (entry != NULL)
+        {
+            memcpy(mPskc, entry->mPskc, sizeof(mPskc));
+            entry->mLastUsed = ++sCacheTick;
+        }
+        pthread_mutex_unlock(&sCacheMutex);
+    }
+
+    (entry != NULL ? sCacheHits : sCacheMisses).Add();
+
+    return entry != NULL;
+}
+
+void Pskc::Store(const char *aPassphrase, size_t aLength)
+{
+    CacheEntry *entry;
+
+    VerifyOrExit(aLength <= OT_PASSPHRASE_MAX_LENGTH);
+
+    pthread_mutex_lock(&sCacheMutex);
+    entry = FindEntry(mSalt, mSaltLen, aPassphrase, aLength);
+    if (entry == NULL)
+    {
+        entry = &sCache[0];
+        for (size_t i = 1; i < kCacheSize; i++)
+        {
+            if (sCache[i].mLastUsed < entry->mLastUsed)
+            {
+                entry = &sCache[i];
+            }
+        }
+
+        Wipe(entry, sizeof(*entry));
+        memcpy(entry->mSalt, mSalt, mSaltLen);
+        entry->mSaltLen = mSaltLen;
+        memcpy(entry->mPassphrase, aPassphrase, aLength);
+        entry->mPassphraseLen = static_cast<uint16_t>(aLength);
+        memcpy(entry->mPskc, mPskc, sizeof(mPskc));
+    }
+    entry->mLastUsed = ++sCacheTick;
+    pthread_mutex_unlock(&sCacheMutex);
+
+exit:
+    return;
+}
+
+void Pskc::Derive(Pskc *const *aPskcs, const char *const *aPassphrases, size_t aCount)
+{
+    LaneBlocks blocks;
+    uint8_t    prfInput[OT_PBKDF2_SALT_MAX_LENGTH + 4];
+
+    VerifyOrExit(aCount > 0);
+
+    if (sKernel == NULL)
+    {
+        for (size_t i = 0; i < aCount; i++)
+        {
+            aPskcs[i]->Derive(aPassphrases[i], strlen(aPassphrases[i]));
+        }
+
+        ExitNow();
+    }
+
+    memset(&blocks, 0, sizeof(blocks));
+
+    // U_1 of each lane is computed with mbedtls, the single block iterations then by the kernel.
+    for (size_t i = 0; i < aCount; i++)
+    {
+        const Pskc &pskc = *aPskcs[i];
+        CmacPrf     prf(reinterpret_cast<const uint8_t *>(aPassphrases[i]), strlen(aPassphrases[i]));
+
+        memcpy(prfInput, pskc.mSalt, pskc.mSaltLen);
+        prfInput[pskc.mSaltLen + 0] = 0;
+        prfInput[pskc.mSaltLen + 1] = 0;
+        prfInput[pskc.mSaltLen + 2] = 0;
+        prfInput[pskc.mSaltLen + 3] = 1;
+        prf.Compute(prfInput, pskc.mSaltLen + 4, blocks.mState[i]);
+        memcpy(blocks.mKeyBlock[i], blocks.mState[i], sizeof(blocks.mKeyBlock[i]));
+        prf.GetBlockKeys(blocks.mRoundKeys[i]);
+    }
+
+    sKernel(blocks, aCount, OT_ITERATION_COUNTS - 1);
+
+    for (size_t i = 0; i < aCount; i++)
+    {
+        memcpy(aPskcs[i]->mPskc, blocks.mKeyBlock[i], sizeof(aPskcs[i]->mPskc));
+    }
+
+    sMultiBufferDerived.Add(aCount);
+    Wipe(&blocks, sizeof(blocks));
+    Wipe(prfInput, sizeof(prfInput));
+
+exit:
+    return;
+}
+
+void Pskc::Derive(const char *aPassphrase, size_t aLength)
+{
+    CmacPrf  prf(reinterpret_cast<const uint8_t *>(aPassphrase), aLength);
     uint32_t blockCounter = 0;
     uint16_t useLen       = 0;
     uint16_t prfBlockLen  = MBEDTLS_CIPHER_BLKSIZE_MAX;
@@ -77,8 +661,6 @@ const uint8_t *Pskc::ComputePskc(const uint8_t *aExtPanId, const char *aNetworkN
     uint16_t keyLen = OT_PSKC_LENGTH;
     uint8_t *pskc   = mPskc;
 
-    SetSalt(aExtPanId, aNetworkName);
-
     while (keyLen)
     {
         memcpy(prfInput, mSalt, mSaltLen);
@@ -89,17 +671,13 @@ const uint8_t *Pskc::ComputePskc(const uint8_t *aExtPanId, const char *aNetworkN
         prfInput[mSaltLen + 2] = (uint8_t)(blockCounter >> 8);
         prfInput[mSaltLen + 3] = (uint8_t)(blockCounter);
         // Calculate U_1
-        mbedtls_aes_cmac_prf_128(reinterpret_cast<const uint8_t *>(aPassphrase), strlen(aPassphrase), prfInput,
-                                 mSaltLen + 4, prfOutput);
+        prf.Compute(prfInput, mSaltLen + 4, prfOutput);
         memcpy(keyBlock, prfOutput, prfBlockLen);
 
         for (uint32_t i = 1; i < OT_ITERATION_COUNTS; i++)
         {
-            memcpy(prfInput, prfOutput, prfBlockLen);
-
             // Calculate U_i
-            mbedtls_aes_cmac_prf_128(reinterpret_cast<const uint8_t *>(aPassphrase), strlen(aPassphrase), prfInput,
-                                     prfBlockLen, prfOutput);
+            prf.ComputeBlock(prfOutput, prfOutput);
 
             // xor
             for (uint32_t j = 0; j < prfBlockLen; j++)
@@ -113,7 +691,10 @@ const uint8_t *Pskc::ComputePskc(const uint8_t *aExtPanId, const char *aNetworkN
         pskc += useLen;
         keyLen -= useLen;
     }
-    return mPskc;
+
+    Wipe(prfInput, sizeof(prfInput));
+    Wipe(prfOutput, sizeof(prfOutput));
+    Wipe(keyBlock, sizeof(keyBlock));
 }
 
 } // namespace Psk
@@ -54,12 +54,40 @@ enum
     kPskcStatus_InvalidArgument = 1
 };
 
+/**
+ * This class computes PSKc values.
+ *
+ * Derived values are kept in a small cache shared by all instances, so that computing the PSKc of the same network
+ * again skips the PBKDF2 iterations. Entries are wiped once evicted or cleared. The cache is only kept in the memory of
+ * the process, so that it never writes PSKc values to disk, and a new process derives them again.
+ *
+ */
 class Pskc
 {
 public:
+    enum
+    {
+        kCacheSize = 8, ///< Max number of PSKc values cached.
+        kMaxLanes  = 8, ///< Max number of PSKc values derived at once by the multi-buffer kernel.
+    };
+
+    /**
+     * This structure is an item of a batch of PSKc computations.
+     *
+     */
+    struct BatchItem
+    {
+        uint8_t     mExtPanId[OT_EXTENDED_PAN_ID_LENGTH]; ///< The extended PAN ID.
+        const char *mNetworkName;                         ///< A pointer to the network name.
+        const char *mPassphrase;                          ///< A pointer to the passphrase.
+        uint8_t     mPskc[OT_PSKC_LENGTH];                ///< The PSKc computed.
+    };
+
     /**
      * This method computes the PSKc.
      *
+     * Passphrases longer than OT_PASSPHRASE_MAX_LENGTH are not cached. This method may be called from any thread.
+     *
      * @param[in]  aExtPanId      a pointer to extended PAN ID.
      * @param[in]  aNetworkName   a pointer to network name.
      * @param[in]  aPassphrase    a pointer to passphrase.
@@ -69,8 +97,56 @@ public:
      */
     const uint8_t *ComputePskc(const uint8_t *aExtPanId, const char *aNetworkName, const char *aPassphrase);
 
+    /**
+     * This function computes the PSKc of a batch of items on several threads.
+     *
+     * The calling thread is one of the threads, and returns once all items are computed. With the multi-buffer
+     * kernel, each thread derives up to kMaxLanes items at once.
+     *
+     * @param[inout]  aItems    A pointer to the items.
+     * @param[in]     aCount    The number of items.
+     * @param[in]     aThreads  The max number of threads, 0 for the number of online CPUs.
+     *
+     */
+    static void ComputeBatch(BatchItem *aItems, size_t aCount, unsigned int aThreads);
+
+    /**
+     * This function sets whether PSKc values are derived by the multi-buffer kernel, if the CPU has one.
+     *
+     * PBKDF2 iterations are serial, each waits for the AES encryption of the previous one. The kernel interleaves the
+     * iterations of independent derivations, on AES-NI with x86 or the cryptography extension with aarch64, so that
+     * the encryptions of the lanes overlap. Otherwise, PSKc values are derived one at a time with mbedtls. The kernel
+     * is used by default, this function must not be called while PSKc values are computed.
+     *
+     * @param[in]  aEnabled  Whether to use the kernel.
+     *
+     * @returns Whether the kernel is used.
+     *
+     */
+    static bool SetMultiBuffer(bool aEnabled);
+
+    /**
+     * This function wipes and drops all cached PSKc values.
+     *
+     */
+    static void ClearCache(void);
+
+    /**
+     * This function returns the counters of the cache, which are also exported as metrics.
+     *
+     * @param[out]  aHits     The number of PSKc values found in the cache.
+     * @param[out]  aMisses   The number of PSKc values derived.
+     *
+     */
+    static void GetCacheCounters(uint64_t &aHits, uint64_t &aMisses);
+
 private:
-    void SetSalt(const uint8_t *aExtPanId, const char *aNetworkName);
+    void         SetSalt(const uint8_t *aExtPanId, const char *aNetworkName);
+    bool         LookUp(const char *aPassphrase, size_t aLength);
+    void         Store(const char *aPassphrase, size_t aLength);
+    void         Derive(const char *aPassphrase, size_t aLength);
+    static void  Derive(Pskc *const *aPskcs, const char *const *aPassphrases, size_t aCount);
+    static void *RunBatch(void *aContext);
 
     char     mSalt[OT_PBKDF2_SALT_MAX_LENGTH];
     uint16_t mSaltLen;
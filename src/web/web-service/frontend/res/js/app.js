@@ -199,6 +199,7 @@
                     prefix: $scope.thread.prefix,
                     defaultRoute: $scope.thread.defaultRoute,
                     index: index,
+                    extPanId: networkInfo.xp,
                 };
                 var httpRequest = $http({
                     method: 'POST',
@@ -0,0 +1,237 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of an exact-match router of http requests.
+ */
+
+#ifndef HTTP_ROUTER_HPP_
+#define HTTP_ROUTER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+namespace ot {
+namespace Web {
+
+/**
+ * This class routes http requests by their exact method and path, ignoring the query string.
+ *
+ * The routes are known before the server starts, so they are placed in a table by a hash seeded to have no
+ * collision. A lookup computes one hash and compares one route, instead of matching the path against each pattern.
+ * Routes are only added before the server starts, lookups are then shared by all server threads.
+ *
+ */
+template <typename Handler> class HttpRouter
+{
+public:
+    /**
+     * The constructor initializes a router without route.
+     *
+     */
+    HttpRouter(void)
+        : mSeed(0)
+        , mMask(0)
+    {
+    }
+
+    /**
+     * This method adds a route, replacing the one of the same method and path.
+     *
+     * @param[in]  aMethod   A pointer to the http method, e.g. "GET", which must stay valid.
+     * @param[in]  aPath     A pointer to the path, e.g. "/metrics", which must stay valid.
+     * @param[in]  aHandler  The handler of the requests.
+     *
+     */
+    void Add(const char *aMethod, const char *aPath, const Handler &aHandler)
+    {
+        Route route;
+
+        route.mMethod  = aMethod;
+        route.mPath    = aPath;
+        route.mHandler = aHandler;
+
+        for (size_t i = 0; i < mRoutes.size(); ++i)
+        {
+            if (strcmp(mRoutes[i].mMethod, aMethod) == 0 && strcmp(mRoutes[i].mPath, aPath) == 0)
+            {
+                mRoutes[i].mHandler = aHandler;
+                return;
+            }
+        }
+
+        mRoutes.push_back(route);
+        Build();
+    }
+
+    /**
+     * This method finds the handler of a request.
+     *
+     * @param[in]  aMethod   The http method of the request.
+     * @param[in]  aTarget   The request target, which may include a query string.
+     *
+     * @returns A pointer to the handler, NULL if no route matches.
+     *
+     */
+    const Handler *Find(const std::string &aMethod, const std::string &aTarget) const
+    {
+        size_t         pathLength = aTarget.find('?');
+        const Handler *handler    = NULL;
+        const Route *  route;
+        uint32_t       slot;
+
+        if (pathLength == std::string::npos)
+        {
+            pathLength = aTarget.size();
+        }
+
+        if (mSlots.empty())
+        {
+            return NULL;
+        }
+
+        slot = mSlots[Hash(mSeed, aMethod.data(), aMethod.size(), aTarget.data(), pathLength) & mMask];
+
+        if (slot != kSlotEmpty)
+        {
+            route = &mRoutes[slot];
+
+            if (aMethod == route->mMethod && aTarget.compare(0, pathLength, route->mPath) == 0)
+            {
+                handler = &route->mHandler;
+            }
+        }
+
+        return handler;
+    }
+
+    /**
+     * This method returns the number of slots of the table.
+     *
+     * @returns The number of slots, a power of two at least twice the number of routes.
+     *
+     */
+    size_t GetTableSize(void) const { return mSlots.size(); }
+
+private:
+    enum
+    {
+        kSlotEmpty = 0xffffffff, ///< The value of a slot without route.
+        kMaxSeeds  = 64,         ///< Number of seeds tried before the table grows.
+    };
+
+    struct Route
+    {
+        const char *mMethod;
+        const char *mPath;
+        Handler     mHandler;
+    };
+
+    static uint32_t Hash(uint32_t    aSeed,
+                         const char *aMethod,
+                         size_t      aMethodLength,
+                         const char *aPath,
+                         size_t      aPathLength)
+    {
+        uint32_t hash = 2166136261u ^ (aSeed * 0x9e3779b9u);
+
+        // FNV-1a, methods never include a null character so it separates the method from the path.
+        for (size_t i = 0; i < aMethodLength; ++i)
+        {
+            hash = (hash ^ static_cast<uint8_t>(aMethod[i])) * 16777619u;
+        }
+
+        hash *= 16777619u;
+
+        for (size_t i = 0; i < aPathLength; ++i)
+        {
+            hash = (hash ^ static_cast<uint8_t>(aPath[i])) * 16777619u;
+        }
+
+        hash ^= hash >> 15;
+        hash *= 0x2c1b3c6du;
+        hash ^= hash >> 12;
+
+        return hash;
+    }
+
+    void Build(void)
+    {
+        size_t size = 1;
+
+        while (size < 2 * mRoutes.size())
+        {
+            size <<= 1;
+        }
+
+        for (uint32_t seed = 1;; ++seed)
+        {
+            bool collided = false;
+
+            if (seed > kMaxSeeds)
+            {
+                size <<= 1;
+                seed = 1;
+            }
+
+            mSlots.assign(size, static_cast<uint32_t>(kSlotEmpty));
+            mMask = static_cast<uint32_t>(size - 1);
+            mSeed = seed;
+
+            for (size_t i = 0; i < mRoutes.size() && !collided; ++i)
+            {
+                const Route &route = mRoutes[i];
+                uint32_t &   slot =
+                    mSlots[Hash(seed, route.mMethod, strlen(route.mMethod), route.mPath, strlen(route.mPath)) & mMask];
+
+                collided = (slot != kSlotEmpty);
+                slot     = static_cast<uint32_t>(i);
+            }
+
+            if (!collided)
+            {
+                break;
+            }
+        }
+    }
+
+    std::vector<Route>    mRoutes;
+    std::vector<uint32_t> mSlots; ///< Index of the route of each slot, kSlotEmpty if none.
+    uint32_t              mSeed;
+    uint32_t              mMask;
+};
+
+} // namespace Web
+} // namespace ot
+
+#endif // HTTP_ROUTER_HPP_
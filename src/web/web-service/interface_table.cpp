@@ -0,0 +1,360 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements a table of the link state and addresses of a network interface.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_WEB
+
+#include "interface_table.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+
+namespace ot {
+namespace Web {
+
+InterfaceTable::InterfaceTable(void)
+    : mFd(-1)
+    , mSequence(0)
+    , mIfIndex(0)
+    , mValid(false)
+{
+    mIfName[0] = '\0';
+    memset(&mState, 0, sizeof(mState));
+    pthread_mutex_init(&mLock, NULL);
+}
+
+InterfaceTable::~InterfaceTable(void)
+{
+    Close();
+    pthread_mutex_destroy(&mLock);
+}
+
+otbrError InterfaceTable::Open(const char *aIfName)
+{
+    otbrError          error = OTBR_ERROR_ERRNO;
+    struct sockaddr_nl addr;
+    struct timeval     timeout = {kDumpTimeout, 0};
+
+    Close();
+    strncpy(mIfName, aIfName, sizeof(mIfName) - 1);
+    mIfName[sizeof(mIfName) - 1] = '\0';
+
+    VerifyOrExit((mFd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE)) != -1);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV6_IFADDR;
+    VerifyOrExit(bind(mFd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == 0);
+
+    // The dumps are waited for, changes are then read without blocking.
+    VerifyOrExit(setsockopt(mFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0);
+    SuccessOrExit(Dump(RTM_GETLINK, AF_UNSPEC));
+    SuccessOrExit(Dump(RTM_GETADDR, AF_INET6));
+    VerifyOrExit(fcntl(mFd, F_SETFL, fcntl(mFd, F_GETFL) | O_NONBLOCK) == 0);
+
+    pthread_mutex_lock(&mLock);
+    mValid = true;
+    pthread_mutex_unlock(&mLock);
+
+    otbrLog(OTBR_LOG_INFO, "interface %s watched, %u addresses", mIfName, mState.mAddressCount);
+    error = OTBR_ERROR_NONE;
+
+exit:
+    if (error != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_WARNING, "failed to watch interface %s: %s", aIfName, strerror(errno));
+        Close();
+    }
+
+    return error;
+}
+
+void InterfaceTable::Close(void)
+{
+    if (mFd != -1)
+    {
+        close(mFd);
+        mFd = -1;
+    }
+
+    pthread_mutex_lock(&mLock);
+    mValid   = false;
+    mIfIndex = 0;
+    memset(&mState, 0, sizeof(mState));
+    pthread_mutex_unlock(&mLock);
+}
+
+otbrError InterfaceTable::Dump(uint16_t aType, uint8_t aFamily)
+{
+    otbrError error = OTBR_ERROR_ERRNO;
+    uint8_t   buffer[kBufferSize];
+    struct
+    {
+        struct nlmsghdr mHeader;
+        struct rtgenmsg mMessage;
+    } request;
+    bool done = false;
+
+    memset(&request, 0, sizeof(request));
+    request.mHeader.nlmsg_len     = NLMSG_LENGTH(sizeof(request.mMessage));
+    request.mHeader.nlmsg_type    = aType;
+    request.mHeader.nlmsg_flags   = NLM_F_REQUEST | NLM_F_DUMP;
+    request.mHeader.nlmsg_seq     = ++mSequence;
+    request.mMessage.rtgen_family = aFamily;
+    VerifyOrExit(send(mFd, &request, request.mHeader.nlmsg_len, 0) ==
+                 static_cast<ssize_t>(request.mHeader.nlmsg_len));
+
+    // Changes received meanwhile are applied as well.
+    while (!done)
+    {
+        ssize_t received = recv(mFd, buffer, sizeof(buffer), 0);
+        int     length   = static_cast<int>(received);
+
+        VerifyOrExit(received > 0, errno = (received == 0 ? EIO : errno));
+        HandleMessages(buffer, static_cast<size_t>(received));
+
+        for (const struct nlmsghdr *header = reinterpret_cast<const struct nlmsghdr *>(buffer);
+             NLMSG_OK(header, static_cast<unsigned int>(length)); header = NLMSG_NEXT(header, length))
+        {
+            if (header->nlmsg_seq == mSequence &&
+                (header->nlmsg_type == NLMSG_DONE || header->nlmsg_type == NLMSG_ERROR))
+            {
+                VerifyOrExit(header->nlmsg_type == NLMSG_DONE, errno = EIO);
+                done = true;
+            }
+        }
+    }
+
+    error = OTBR_ERROR_NONE;
+
+exit:
+    return error;
+}
+
+bool InterfaceTable::Process(void)
+{
+    uint8_t buffer[kBufferSize];
+    bool    changed = false;
+    ssize_t length;
+
+    VerifyOrExit(mFd != -1);
+
+    while ((length = recv(mFd, buffer, sizeof(buffer), 0)) > 0)
+    {
+        changed = HandleMessages(buffer, static_cast<size_t>(length)) || changed;
+    }
+
+    // The changes lost cannot be told apart, the table is given up until reopened.
+    if (length < 0 && errno == ENOBUFS)
+    {
+        otbrLog(OTBR_LOG_WARNING, "changes of interface %s lost, addresses are read from wpantund", mIfName);
+        pthread_mutex_lock(&mLock);
+        mValid = false;
+        pthread_mutex_unlock(&mLock);
+        changed = true;
+    }
+
+exit:
+    return changed;
+}
+
+bool InterfaceTable::HandleMessages(const uint8_t *aBuffer, size_t aLength)
+{
+    bool changed = false;
+    int  length  = static_cast<int>(aLength);
+
+    for (const struct nlmsghdr *header = reinterpret_cast<const struct nlmsghdr *>(aBuffer);
+         NLMSG_OK(header, static_cast<unsigned int>(length)); header = NLMSG_NEXT(header, length))
+    {
+        const uint8_t *message       = static_cast<const uint8_t *>(NLMSG_DATA(header));
+        size_t         messageLength = header->nlmsg_len - NLMSG_LENGTH(0);
+
+        switch (header->nlmsg_type)
+        {
+        case RTM_NEWLINK:
+        case RTM_DELLINK:
+            changed = HandleLink(header->nlmsg_type, message, messageLength) || changed;
+            break;
+
+        case RTM_NEWADDR:
+        case RTM_DELADDR:
+            changed = HandleAddress(header->nlmsg_type, message, messageLength) || changed;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return changed;
+}
+
+bool InterfaceTable::HandleLink(uint16_t aType, const uint8_t *aMessage, size_t aLength)
+{
+    const struct ifinfomsg *info    = reinterpret_cast<const struct ifinfomsg *>(aMessage);
+    bool                    changed = false;
+    bool                    matched = (mIfIndex != 0 && info->ifi_index == mIfIndex);
+    int                     length;
+
+    VerifyOrExit(aLength >= sizeof(*info));
+    length = static_cast<int>(aLength - NLMSG_ALIGN(sizeof(*info)));
+
+    // The interface is found by name, as it may be created after the table is opened, or renamed.
+    for (const struct rtattr *attr = IFLA_RTA(info); RTA_OK(attr, length); attr = RTA_NEXT(attr, length))
+    {
+        if (attr->rta_type == IFLA_IFNAME)
+        {
+            const char *name       = static_cast<const char *>(RTA_DATA(attr));
+            size_t      nameLength = strnlen(name, RTA_PAYLOAD(attr));
+
+            matched = (nameLength == strlen(mIfName) && memcmp(name, mIfName, nameLength) == 0);
+        }
+    }
+
+    VerifyOrExit(matched || info->ifi_index == mIfIndex);
+
+    pthread_mutex_lock(&mLock);
+
+    if (aType == RTM_DELLINK || !matched)
+    {
+        changed  = mState.mExists;
+        mIfIndex = 0;
+        memset(&mState, 0, sizeof(mState));
+    }
+    else
+    {
+        bool up      = (info->ifi_flags & IFF_UP) != 0;
+        bool running = (info->ifi_flags & IFF_RUNNING) != 0;
+
+        changed         = !mState.mExists || mState.mUp != up || mState.mRunning != running;
+        mIfIndex        = info->ifi_index;
+        mState.mExists  = true;
+        mState.mUp      = up;
+        mState.mRunning = running;
+    }
+
+    pthread_mutex_unlock(&mLock);
+
+exit:
+    return changed;
+}
+
+bool InterfaceTable::HandleAddress(uint16_t aType, const uint8_t *aMessage, size_t aLength)
+{
+    const struct ifaddrmsg *info    = reinterpret_cast<const struct ifaddrmsg *>(aMessage);
+    const uint8_t *         address = NULL;
+    bool                    changed = false;
+    int                     length;
+    uint8_t                 index;
+
+    VerifyOrExit(aLength >= sizeof(*info));
+    VerifyOrExit(info->ifa_family == AF_INET6 && mIfIndex != 0 && static_cast<int>(info->ifa_index) == mIfIndex);
+    length = static_cast<int>(aLength - NLMSG_ALIGN(sizeof(*info)));
+
+    for (const struct rtattr *attr = IFA_RTA(info); RTA_OK(attr, length); attr = RTA_NEXT(attr, length))
+    {
+        if (attr->rta_type == IFA_ADDRESS && RTA_PAYLOAD(attr) == sizeof(mState.mAddresses[0].mAddress))
+        {
+            address = static_cast<const uint8_t *>(RTA_DATA(attr));
+        }
+    }
+
+    VerifyOrExit(address != NULL);
+
+    pthread_mutex_lock(&mLock);
+
+    for (index = 0; index < mState.mAddressCount; ++index)
+    {
+        if (memcmp(mState.mAddresses[index].mAddress, address, sizeof(mState.mAddresses[index].mAddress)) == 0)
+        {
+            break;
+        }
+    }
+
+    if (aType == RTM_DELADDR)
+    {
+        if (index < mState.mAddressCount)
+        {
+            memmove(&mState.mAddresses[index], &mState.mAddresses[index + 1],
+                    (mState.mAddressCount - index - 1) * sizeof(mState.mAddresses[0]));
+            mState.mAddressCount--;
+            changed = true;
+        }
+    }
+    else if (index < mState.mAddressCount)
+    {
+        changed                                = mState.mAddresses[index].mPrefixLength != info->ifa_prefixlen;
+        mState.mAddresses[index].mPrefixLength = info->ifa_prefixlen;
+    }
+    else if (mState.mAddressCount < kMaxAddresses)
+    {
+        memcpy(mState.mAddresses[index].mAddress, address, sizeof(mState.mAddresses[index].mAddress));
+        mState.mAddresses[index].mPrefixLength = info->ifa_prefixlen;
+        mState.mAddressCount++;
+        changed = true;
+    }
+
+    pthread_mutex_unlock(&mLock);
+
+exit:
+    return changed;
+}
+
+bool InterfaceTable::IsValid(void) const
+{
+    bool valid;
+
+    pthread_mutex_lock(&mLock);
+    valid = mValid;
+    pthread_mutex_unlock(&mLock);
+
+    return valid;
+}
+
+void InterfaceTable::GetState(State &aState) const
+{
+    pthread_mutex_lock(&mLock);
+    aState = mState;
+    pthread_mutex_unlock(&mLock);
+}
+
+} // namespace Web
+} // namespace ot
@@ -0,0 +1,187 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of a table of the link state and addresses of a network interface.
+ */
+
+#ifndef INTERFACE_TABLE_HPP_
+#define INTERFACE_TABLE_HPP_
+
+#include <net/if.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/types.hpp"
+
+namespace ot {
+namespace Web {
+
+/**
+ * This class keeps the link state and IPv6 addresses of a network interface, from a rtnetlink subscription.
+ *
+ * The table is filled by dumps of the links and addresses when opened, then kept up to date by the changes the kernel
+ * sends, so that reading it takes no request to the kernel or to wpantund. The interface may not exist yet when the
+ * table is opened, it is found by name once created.
+ *
+ */
+class InterfaceTable
+{
+public:
+    enum
+    {
+        kMaxAddresses = 16, ///< Max number of addresses kept, further ones are ignored.
+    };
+
+    /**
+     * This structure represents an IPv6 address of the interface.
+     *
+     */
+    struct Address
+    {
+        uint8_t mAddress[16];  ///< The address.
+        uint8_t mPrefixLength; ///< The length of the on-link prefix of the address.
+    };
+
+    /**
+     * This structure represents the state of the interface.
+     *
+     */
+    struct State
+    {
+        bool    mExists;                   ///< Whether the interface exists.
+        bool    mUp;                       ///< Whether the interface is administratively up.
+        bool    mRunning;                  ///< Whether the link of the interface is operational.
+        uint8_t mAddressCount;             ///< Number of addresses.
+        Address mAddresses[kMaxAddresses]; ///< The addresses, in the order they were added.
+    };
+
+    /**
+     * The constructor initializes a table of no interface.
+     *
+     */
+    InterfaceTable(void);
+
+    /**
+     * The destructor closes the table.
+     *
+     */
+    ~InterfaceTable(void);
+
+    /**
+     * This method subscribes to the changes of links and IPv6 addresses, and fills the table by dumping them.
+     *
+     * @param[in]  aIfName  A pointer to the name of the interface.
+     *
+     * @retval OTBR_ERROR_NONE   Successfully opened, the table is valid.
+     * @retval OTBR_ERROR_ERRNO  Failed to open the rtnetlink socket, or to dump the links and addresses.
+     *
+     */
+    otbrError Open(const char *aIfName);
+
+    /**
+     * This method closes the rtnetlink socket, the table is no longer valid.
+     *
+     */
+    void Close(void);
+
+    /**
+     * This method returns the rtnetlink socket, readable when Process() has changes to read.
+     *
+     * @returns The file descriptor of the socket, -1 if not opened.
+     *
+     */
+    int GetFd(void) const { return mFd; }
+
+    /**
+     * This method reads the changes received, without blocking.
+     *
+     * Changes lost for lack of socket buffer make the table invalid.
+     *
+     * @returns Whether the state of the interface changed.
+     *
+     */
+    bool Process(void);
+
+    /**
+     * This method applies rtnetlink messages to the table.
+     *
+     * @param[in]  aBuffer  A pointer to the messages.
+     * @param[in]  aLength  The length of the messages in bytes.
+     *
+     * @returns Whether the state of the interface changed.
+     *
+     */
+    bool HandleMessages(const uint8_t *aBuffer, size_t aLength);
+
+    /**
+     * This method returns whether the table reflects the interface, so that it may be used instead of wpantund.
+     *
+     * This method may be called from any thread.
+     *
+     * @returns Whether the table is valid.
+     *
+     */
+    bool IsValid(void) const;
+
+    /**
+     * This method gets the state of the interface.
+     *
+     * This method may be called from any thread.
+     *
+     * @param[out]  aState  A reference to receive the state.
+     *
+     */
+    void GetState(State &aState) const;
+
+private:
+    otbrError Dump(uint16_t aType, uint8_t aFamily);
+    bool      HandleLink(uint16_t aType, const uint8_t *aMessage, size_t aLength);
+    bool      HandleAddress(uint16_t aType, const uint8_t *aMessage, size_t aLength);
+
+    enum
+    {
+        kBufferSize  = 16384, ///< Size of the buffer receiving messages.
+        kDumpTimeout = 1,     ///< Seconds a dump is waited for.
+    };
+
+    int                     mFd;
+    uint32_t                mSequence;        ///< Sequence number of the last dump request.
+    int                     mIfIndex;         ///< Index of the interface, 0 if not found.
+    char                    mIfName[IFNAMSIZ];
+    bool                    mValid;
+    State                   mState;
+    mutable pthread_mutex_t mLock; ///< Guards the state and validity, read from other threads.
+};
+
+} // namespace Web
+} // namespace ot
+
+#endif // INTERFACE_TABLE_HPP_
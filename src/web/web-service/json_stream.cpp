@@ -0,0 +1,456 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements a streaming JSON writer and a reader of flat JSON objects.
+ */
+
+#include "json_stream.hpp"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "common/code_utils.hpp"
+
+namespace ot {
+namespace Web {
+
+void JsonWriter::Separate(void)
+{
+    if (mSeparate)
+    {
+        mOutput += ',';
+    }
+}
+
+void JsonWriter::BeginObject(void)
+{
+    Separate();
+    mOutput += '{';
+    mSeparate = false;
+}
+
+void JsonWriter::EndObject(void)
+{
+    mOutput += '}';
+    mSeparate = true;
+}
+
+void JsonWriter::BeginArray(void)
+{
+    Separate();
+    mOutput += '[';
+    mSeparate = false;
+}
+
+void JsonWriter::EndArray(void)
+{
+    mOutput += ']';
+    mSeparate = true;
+}
+
+void JsonWriter::Key(const char *aName)
+{
+    String(aName);
+    mOutput += ':';
+    mSeparate = false;
+}
+
+void JsonWriter::String(const char *aValue)
+{
+    Separate();
+    mOutput += '"';
+
+    for (const char *cur = aValue; *cur != '\0'; cur++)
+    {
+        unsigned char c = static_cast<unsigned char>(*cur);
+
+        switch (c)
+        {
+        case '"':
+            mOutput += "\\\"";
+            break;
+        case '\\':
+            mOutput += "\\\\";
+            break;
+        case '\n':
+            mOutput += "\\n";
+            break;
+        case '\r':
+            mOutput += "\\r";
+            break;
+        case '\t':
+            mOutput += "\\t";
+            break;
+        default:
+            if (c < 0x20)
+            {
+                char escaped[sizeof("\\u0000")];
+
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                mOutput += escaped;
+            }
+            else
+            {
+                mOutput += *cur;
+            }
+            break;
+        }
+    }
+
+    mOutput += '"';
+    mSeparate = true;
+}
+
+void JsonWriter::Int(long aValue)
+{
+    char value[sizeof(long) * 3 + 2];
+
+    Separate();
+    snprintf(value, sizeof(value), "%ld", aValue);
+    mOutput += value;
+    mSeparate = true;
+}
+
+void JsonWriter::Unsigned(unsigned long aValue)
+{
+    char value[sizeof(long) * 3 + 1];
+
+    Separate();
+    snprintf(value, sizeof(value), "%lu", aValue);
+    mOutput += value;
+    mSeparate = true;
+}
+
+void JsonWriter::Bool(bool aValue)
+{
+    Separate();
+    mOutput += aValue ? "true" : "false";
+    mSeparate = true;
+}
+
+void JsonWriter::Raw(const std::string &aJson)
+{
+    size_t length = aJson.find_last_not_of(" \t\r\n");
+
+    Separate();
+    mOutput.append(aJson, 0, length == std::string::npos ? 0 : length + 1);
+    mSeparate = true;
+}
+
+bool JsonReader::Parse(const char *aJson, size_t aLength, const Field *aFields, size_t aCount)
+{
+    JsonReader reader(aJson, aLength);
+    bool       ok = false;
+
+    for (size_t i = 0; i < aCount; i++)
+    {
+        switch (aFields[i].mType)
+        {
+        case kTypeString:
+            static_cast<std::string *>(aFields[i].mValue)->clear();
+            break;
+        case kTypeUnsigned:
+            *static_cast<unsigned int *>(aFields[i].mValue) = 0;
+            break;
+        case kTypeBool:
+            *static_cast<bool *>(aFields[i].mValue) = false;
+            break;
+        }
+    }
+
+    VerifyOrExit(reader.ParseObject(aFields, aCount));
+    reader.SkipSpace();
+    ok = (reader.mCur == reader.mEnd);
+
+exit:
+    return ok;
+}
+
+void JsonReader::SkipSpace(void)
+{
+    while (mCur < mEnd && (*mCur == ' ' || *mCur == '\t' || *mCur == '\n' || *mCur == '\r'))
+    {
+        mCur++;
+    }
+}
+
+bool JsonReader::Consume(char aChar)
+{
+    bool ok = false;
+
+    SkipSpace();
+    VerifyOrExit(mCur < mEnd && *mCur == aChar);
+    mCur++;
+    ok = true;
+
+exit:
+    return ok;
+}
+
+bool JsonReader::ParseObject(const Field *aFields, size_t aCount)
+{
+    bool ok = false;
+
+    VerifyOrExit(Consume('{'));
+    SkipSpace();
+
+    if (mCur < mEnd && *mCur == '}')
+    {
+        mCur++;
+        ExitNow(ok = true);
+    }
+
+    do
+    {
+        const char * name;
+        size_t       length;
+        const Field *field = NULL;
+
+        VerifyOrExit(ParseName(name, length));
+        VerifyOrExit(Consume(':'));
+        SkipSpace();
+
+        for (size_t i = 0; i < aCount; i++)
+        {
+            if (strncmp(aFields[i].mName, name, length) == 0 && aFields[i].mName[length] == '\0')
+            {
+                field = &aFields[i];
+                break;
+            }
+        }
+
+        if (field == NULL || SkipLiteral("null"))
+        {
+            VerifyOrExit(field != NULL || SkipValue());
+            continue;
+        }
+
+        switch (field->mType)
+        {
+        case kTypeString:
+            VerifyOrExit(ParseString(*static_cast<std::string *>(field->mValue)));
+            break;
+        case kTypeUnsigned:
+            VerifyOrExit(ParseUnsigned(*static_cast<unsigned int *>(field->mValue)));
+            break;
+        case kTypeBool:
+            VerifyOrExit(ParseBool(*static_cast<bool *>(field->mValue)));
+            break;
+        }
+    } while (Consume(','));
+
+    ok = Consume('}');
+
+exit:
+    return ok;
+}
+
+bool JsonReader::ParseName(const char *&aName, size_t &aLength)
+{
+    bool ok = false;
+
+    VerifyOrExit(Consume('"'));
+    aName = mCur;
+
+    // Names are compared as they are, escaped ones are left to a complete parser.
+    while (mCur < mEnd && *mCur != '"')
+    {
+        VerifyOrExit(*mCur != '\\' && static_cast<unsigned char>(*mCur) >= 0x20);
+        mCur++;
+    }
+
+    VerifyOrExit(mCur < mEnd);
+    aLength = static_cast<size_t>(mCur - aName);
+    mCur++;
+    ok = true;
+
+exit:
+    return ok;
+}
+
+bool JsonReader::ParseString(std::string &aValue)
+{
+    bool ok = false;
+
+    VerifyOrExit(mCur < mEnd && *mCur == '"');
+    mCur++;
+
+    while (mCur < mEnd && *mCur != '"')
+    {
+        const char *begin = mCur;
+
+        while (mCur < mEnd && *mCur != '"' && *mCur != '\\')
+        {
+            VerifyOrExit(static_cast<unsigned char>(*mCur) >= 0x20);
+            mCur++;
+        }
+
+        aValue.append(begin, mCur);
+
+        if (mCur < mEnd && *mCur == '\\')
+        {
+            VerifyOrExit(++mCur < mEnd);
+
+            switch (*mCur++)
+            {
+            case '"':
+                aValue += '"';
+                break;
+            case '\\':
+                aValue += '\\';
+                break;
+            case '/':
+                aValue += '/';
+                break;
+            case 'b':
+                aValue += '\b';
+                break;
+            case 'f':
+                aValue += '\f';
+                break;
+            case 'n':
+                aValue += '\n';
+                break;
+            case 'r':
+                aValue += '\r';
+                break;
+            case 't':
+                aValue += '\t';
+                break;
+            default:
+                // Unicode escapes are left to a complete parser.
+                ExitNow();
+            }
+        }
+    }
+
+    VerifyOrExit(mCur < mEnd);
+    mCur++;
+    ok = true;
+
+exit:
+    return ok;
+}
+
+bool JsonReader::ParseUnsigned(unsigned int &aValue)
+{
+    unsigned long value = 0;
+    bool          ok    = false;
+
+    VerifyOrExit(mCur < mEnd && *mCur >= '0' && *mCur <= '9');
+
+    while (mCur < mEnd && *mCur >= '0' && *mCur <= '9')
+    {
+        value = value * 10 + static_cast<unsigned long>(*mCur - '0');
+        VerifyOrExit(value <= UINT_MAX);
+        mCur++;
+    }
+
+    // Fractions and exponents are left to a complete parser.
+    VerifyOrExit(mCur == mEnd || (*mCur != '.' && *mCur != 'e' && *mCur != 'E'));
+    aValue = static_cast<unsigned int>(value);
+    ok     = true;
+
+exit:
+    return ok;
+}
+
+bool JsonReader::ParseBool(bool &aValue)
+{
+    bool ok = true;
+
+    if (SkipLiteral("true"))
+    {
+        aValue = true;
+    }
+    else if (SkipLiteral("false"))
+    {
+        aValue = false;
+    }
+    else
+    {
+        ok = false;
+    }
+
+    return ok;
+}
+
+bool JsonReader::SkipLiteral(const char *aLiteral)
+{
+    size_t length = strlen(aLiteral);
+    bool   ok     = false;
+
+    VerifyOrExit(static_cast<size_t>(mEnd - mCur) >= length && memcmp(mCur, aLiteral, length) == 0);
+    mCur += length;
+    ok = true;
+
+exit:
+    return ok;
+}
+
+bool JsonReader::SkipValue(void)
+{
+    std::string skipped;
+    bool        ok = false;
+
+    VerifyOrExit(mCur < mEnd);
+
+    if (*mCur == '"')
+    {
+        ok = ParseString(skipped);
+    }
+    else if (*mCur == '-' || (*mCur >= '0' && *mCur <= '9'))
+    {
+        if (*mCur == '-')
+        {
+            mCur++;
+        }
+
+        VerifyOrExit(mCur < mEnd && *mCur >= '0' && *mCur <= '9');
+
+        while (mCur < mEnd && *mCur != '\0' && strchr("0123456789.eE+-", *mCur) != NULL)
+        {
+            mCur++;
+        }
+
+        ok = true;
+    }
+    else
+    {
+        ok = SkipLiteral("true") || SkipLiteral("false") || SkipLiteral("null");
+    }
+
+exit:
+    return ok;
+}
+
+} // namespace Web
+} // namespace ot
@@ -0,0 +1,218 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions of a streaming JSON writer and a reader of flat JSON objects.
+ */
+
+#ifndef JSON_STREAM_HPP_
+#define JSON_STREAM_HPP_
+
+#include <stddef.h>
+
+#include <string>
+
+namespace ot {
+namespace Web {
+
+/**
+ * This class appends JSON to a string, without building a tree of values.
+ *
+ * Members and values are separated as they are written, the caller is responsible for the structure.
+ *
+ */
+class JsonWriter
+{
+public:
+    /**
+     * The constructor of the writer.
+     *
+     * @param[inout]  aOutput   A reference to the string to append to, whose capacity may be reused.
+     *
+     */
+    explicit JsonWriter(std::string &aOutput)
+        : mOutput(aOutput)
+        , mSeparate(false)
+    {
+    }
+
+    /**
+     * This method begins an object, as a value.
+     *
+     */
+    void BeginObject(void);
+
+    /**
+     * This method ends the current object.
+     *
+     */
+    void EndObject(void);
+
+    /**
+     * This method begins an array, as a value.
+     *
+     */
+    void BeginArray(void);
+
+    /**
+     * This method ends the current array.
+     *
+     */
+    void EndArray(void);
+
+    /**
+     * This method writes the name of a member, to be followed by its value.
+     *
+     * @param[in]  aName  A pointer to the member name.
+     *
+     */
+    void Key(const char *aName);
+
+    /**
+     * This method writes a string value.
+     *
+     * @param[in]  aValue  A pointer to the null-terminated string.
+     *
+     */
+    void String(const char *aValue);
+
+    /**
+     * This method writes an integer value.
+     *
+     * @param[in]  aValue  The integer.
+     *
+     */
+    void Int(long aValue);
+
+    /**
+     * This method writes an unsigned integer value.
+     *
+     * @param[in]  aValue  The unsigned integer.
+     *
+     */
+    void Unsigned(unsigned long aValue);
+
+    /**
+     * This method writes a boolean value.
+     *
+     * @param[in]  aValue  The boolean.
+     *
+     */
+    void Bool(bool aValue);
+
+    /**
+     * This method writes a value already encoded, e.g. a response written by another writer.
+     *
+     * @param[in]  aJson  A reference to the encoded value, trailing whitespace is dropped.
+     *
+     */
+    void Raw(const std::string &aJson);
+
+private:
+    void Separate(void);
+
+    std::string &mOutput;
+    bool         mSeparate; ///< Whether the next value is preceded by a comma.
+};
+
+/**
+ * This class reads the members of a flat JSON object into fields, without building a tree of values.
+ *
+ */
+class JsonReader
+{
+public:
+    /**
+     * Type of a field.
+     *
+     */
+    enum Type
+    {
+        kTypeString,   ///< A std::string, from a string.
+        kTypeUnsigned, ///< An unsigned int, from a non-negative integer.
+        kTypeBool,     ///< A bool, from true or false.
+    };
+
+    /**
+     * This structure describes a field read from an object member.
+     *
+     */
+    struct Field
+    {
+        const char *mName;  ///< The member name.
+        Type        mType;  ///< The type of @p mValue.
+        void *      mValue; ///< A pointer to the value read.
+    };
+
+    /**
+     * This function reads an object into fields.
+     *
+     * All fields are first reset to an empty string, 0 or false, which missing members and null values keep. String
+     * fields are cleared rather than reallocated. Members without a field are skipped.
+     *
+     * Only objects whose values are strings, numbers, booleans or null are read. Anything else, like escaped names,
+     * nested values, or values not matching the type of their field, fails so that the caller may fall back to a
+     * complete parser.
+     *
+     * @param[in]  aJson    A pointer to the JSON text.
+     * @param[in]  aLength  The length of @p aJson.
+     * @param[in]  aFields  A pointer to the fields.
+     * @param[in]  aCount   The number of fields.
+     *
+     * @retval true   Successfully read the object.
+     * @retval false  The object is invalid or not flat, the fields are undefined.
+     *
+     */
+    static bool Parse(const char *aJson, size_t aLength, const Field *aFields, size_t aCount);
+
+private:
+    JsonReader(const char *aJson, size_t aLength)
+        : mCur(aJson)
+        , mEnd(aJson + aLength)
+    {
+    }
+
+    bool        ParseObject(const Field *aFields, size_t aCount);
+    bool        ParseName(const char *&aName, size_t &aLength);
+    bool        ParseString(std::string &aValue);
+    bool        ParseUnsigned(unsigned int &aValue);
+    bool        ParseBool(bool &aValue);
+    bool        SkipValue(void);
+    bool        SkipLiteral(const char *aLiteral);
+    bool        Consume(char aChar);
+    void        SkipSpace(void);
+
+    const char *mCur;
+    const char *mEnd;
+};
+
+} // namespace Web
+} // namespace ot
+
+#endif // JSON_STREAM_HPP_
@@ -0,0 +1,311 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements a table of the on-mesh prefixes configured through wpantund.
+ */
+
+#include "prefix_table.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "common/code_utils.hpp"
+#include "utils/hex.hpp"
+
+namespace ot {
+namespace Web {
+
+PrefixTable::PrefixTable(void)
+    : mDesiredCount(0)
+    , mCurrentCount(0)
+    , mCurrentKnown(false)
+{
+}
+
+bool PrefixTable::ParsePrefix(const char *aText, uint8_t *aPrefix)
+{
+    char        address[INET6_ADDRSTRLEN];
+    uint8_t     bytes[16];
+    const char *slash;
+    size_t      length;
+    bool        ok = false;
+
+    VerifyOrExit(aText != NULL);
+
+    if (strchr(aText, ':') == NULL)
+    {
+        memset(aPrefix, 0, kPrefixSize);
+        ExitNow(ok = (Utils::Hex2Bytes(aText, aPrefix, kPrefixSize) > 0));
+    }
+
+    slash  = strchr(aText, '/');
+    length = (slash != NULL) ? static_cast<size_t>(slash - aText) : strlen(aText);
+    VerifyOrExit(length < sizeof(address));
+    VerifyOrExit(slash == NULL || strcmp(slash + 1, "64") == 0);
+    memcpy(address, aText, length);
+    address[length] = '\0';
+    VerifyOrExit(inet_pton(AF_INET6, address, bytes) == 1);
+    memcpy(aPrefix, bytes, kPrefixSize);
+    ok = true;
+
+exit:
+    return ok;
+}
+
+void PrefixTable::FormatPrefix(const uint8_t *aPrefix, char *aText, size_t aSize)
+{
+    uint8_t bytes[16];
+
+    memset(bytes, 0, sizeof(bytes));
+    memcpy(bytes, aPrefix, kPrefixSize);
+    inet_ntop(AF_INET6, bytes, aText, static_cast<socklen_t>(aSize));
+}
+
+int PrefixTable::Find(const Prefix *aPrefixes, size_t aCount, const uint8_t *aPrefix)
+{
+    for (size_t i = 0; i < aCount; i++)
+    {
+        if (memcmp(aPrefixes[i].mPrefix, aPrefix, kPrefixSize) == 0)
+        {
+            return static_cast<int>(i);
+        }
+    }
+
+    return -1;
+}
+
+void PrefixTable::Remove(Prefix *aPrefixes, size_t &aCount, int aIndex)
+{
+    memmove(&aPrefixes[aIndex], &aPrefixes[aIndex + 1], (aCount - aIndex - 1) * sizeof(aPrefixes[0]));
+    aCount--;
+}
+
+bool PrefixTable::SetDesired(const Prefix *aPrefixes, size_t aCount)
+{
+    bool ok = false;
+
+    VerifyOrExit(aCount <= kMaxPrefixes);
+
+    for (size_t i = 0; i < aCount; i++)
+    {
+        VerifyOrExit(Find(aPrefixes, i, aPrefixes[i].mPrefix) < 0);
+    }
+
+    memcpy(mDesired, aPrefixes, aCount * sizeof(aPrefixes[0]));
+    mDesiredCount = aCount;
+    ok            = true;
+
+exit:
+    return ok;
+}
+
+bool PrefixTable::AddDesired(const Prefix &aPrefix)
+{
+    int  index = Find(mDesired, mDesiredCount, aPrefix.mPrefix);
+    bool ok    = true;
+
+    if (index >= 0)
+    {
+        mDesired[index] = aPrefix;
+    }
+    else
+    {
+        VerifyOrExit(mDesiredCount < kMaxPrefixes, ok = false);
+        mDesired[mDesiredCount++] = aPrefix;
+    }
+
+exit:
+    return ok;
+}
+
+void PrefixTable::RemoveDesired(const uint8_t *aPrefix)
+{
+    int index = Find(mDesired, mDesiredCount, aPrefix);
+
+    if (index >= 0)
+    {
+        Remove(mDesired, mDesiredCount, index);
+    }
+}
+
+bool PrefixTable::ParseEntry(const char *aEntry, size_t aLength, Prefix &aPrefix)
+{
+    char        entry[256];
+    char *      prefix;
+    char *      field;
+    const char *defaultRoute;
+    bool        ok = false;
+
+    VerifyOrExit(aLength < sizeof(entry));
+    memcpy(entry, aEntry, aLength);
+    entry[aLength] = '\0';
+
+    // The description starts with the prefix, other fields are named, in an order depending on the wpantund version.
+    prefix = entry + strspn(entry, " ");
+    field  = prefix + strcspn(prefix, " ");
+
+    if (*field != '\0')
+    {
+        *field++ = '\0';
+    }
+
+    VerifyOrExit(ParsePrefix(prefix, aPrefix.mPrefix));
+
+    if (strstr(field, "prefix_len:") != NULL)
+    {
+        VerifyOrExit(atoi(strstr(field, "prefix_len:") + sizeof("prefix_len:") - 1) == kPrefixLength);
+    }
+
+    VerifyOrExit(strstr(field, "origin:ncp") == NULL);
+    defaultRoute          = strstr(field, "def-route:");
+    aPrefix.mDefaultRoute = (defaultRoute != NULL && defaultRoute[sizeof("def-route:") - 1] == '1');
+    ok                    = true;
+
+exit:
+    return ok;
+}
+
+bool PrefixTable::SetCurrent(const char *aValue)
+{
+    const char *cursor;
+    size_t      count = 0;
+    bool        ok    = false;
+
+    VerifyOrExit(aValue != NULL);
+    cursor = aValue + strspn(aValue, " \t\r\n");
+    VerifyOrExit(*cursor++ == '[');
+
+    while (true)
+    {
+        const char *end;
+
+        cursor += strspn(cursor, " \t\r\n,");
+
+        if (*cursor == ']')
+        {
+            break;
+        }
+
+        // The descriptions have no quote or backslash, so no entry needs unescaping.
+        VerifyOrExit(*cursor++ == '"');
+        VerifyOrExit((end = strchr(cursor, '"')) != NULL);
+
+        if (count < kMaxCurrent && ParseEntry(cursor, static_cast<size_t>(end - cursor), mCurrent[count]) &&
+            Find(mCurrent, count, mCurrent[count].mPrefix) < 0)
+        {
+            count++;
+        }
+
+        cursor = end + 1;
+    }
+
+    mCurrentCount = count;
+    ok            = true;
+
+exit:
+    mCurrentKnown = ok;
+    return ok;
+}
+
+size_t PrefixTable::Diff(Change *aChanges, const uint8_t *aOnly) const
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < mDesiredCount; i++)
+    {
+        const Prefix &desired = mDesired[i];
+        int           index   = Find(mCurrent, mCurrentCount, desired.mPrefix);
+
+        if (aOnly != NULL && memcmp(desired.mPrefix, aOnly, kPrefixSize) != 0)
+        {
+            continue;
+        }
+
+        if (!mCurrentKnown || index < 0 || mCurrent[index].mDefaultRoute != desired.mDefaultRoute)
+        {
+            aChanges[count].mPrefix  = desired;
+            aChanges[count].mRemoved = false;
+            count++;
+        }
+    }
+
+    for (size_t i = 0; i < mCurrentCount; i++)
+    {
+        const Prefix &current = mCurrent[i];
+
+        if ((aOnly == NULL || memcmp(current.mPrefix, aOnly, kPrefixSize) == 0) &&
+            Find(mDesired, mDesiredCount, current.mPrefix) < 0)
+        {
+            aChanges[count].mPrefix  = current;
+            aChanges[count].mRemoved = true;
+            count++;
+        }
+    }
+
+    // Not knowing whether wpantund has the prefix, it is removed anyway.
+    if (!mCurrentKnown && aOnly != NULL && count == 0 && Find(mDesired, mDesiredCount, aOnly) < 0)
+    {
+        memset(&aChanges[count].mPrefix, 0, sizeof(aChanges[count].mPrefix));
+        memcpy(aChanges[count].mPrefix.mPrefix, aOnly, kPrefixSize);
+        aChanges[count].mRemoved = true;
+        count++;
+    }
+
+    return count;
+}
+
+void PrefixTable::Apply(const Change *aChanges, size_t aCount)
+{
+    for (size_t i = 0; i < aCount; i++)
+    {
+        const Change &change = aChanges[i];
+        int           index  = Find(mCurrent, mCurrentCount, change.mPrefix.mPrefix);
+
+        if (change.mRemoved)
+        {
+            if (index >= 0)
+            {
+                Remove(mCurrent, mCurrentCount, index);
+            }
+        }
+        else if (index >= 0)
+        {
+            mCurrent[index] = change.mPrefix;
+        }
+        else if (mCurrentCount < kMaxCurrent)
+        {
+            mCurrent[mCurrentCount++] = change.mPrefix;
+        }
+    }
+}
+
+} // namespace Web
+} // namespace ot
@@ -0,0 +1,208 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition of a table of the on-mesh prefixes configured through wpantund.
+ */
+
+#ifndef PREFIX_TABLE_HPP_
+#define PREFIX_TABLE_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ot {
+namespace Web {
+
+/**
+ * This class keeps the on-mesh prefixes desired, and those wpantund has, to change only the prefixes that differ.
+ *
+ * Configuring a prefix wpantund already has still updates the Thread network data, so pushing the same configuration
+ * again makes all routers of the network take new network data. Diffing against the prefixes of wpantund makes such
+ * pushes cost one property get, and no change of the network data. Prefixes are /64, as configured by ConfigGateway.
+ *
+ */
+class PrefixTable
+{
+public:
+    enum
+    {
+        kMaxPrefixes  = 8,                          ///< Max number of prefixes desired.
+        kMaxCurrent   = 16,                         ///< Max number of prefixes of wpantund kept, others are ignored.
+        kMaxChanges   = kMaxPrefixes + kMaxCurrent, ///< Max number of changes of a diff.
+        kPrefixSize   = 8,                          ///< Size of a prefix in bytes.
+        kPrefixLength = 64,                         ///< Length of a prefix in bits.
+    };
+
+    /**
+     * This structure represents an on-mesh prefix.
+     *
+     */
+    struct Prefix
+    {
+        uint8_t mPrefix[kPrefixSize]; ///< The prefix.
+        bool    mDefaultRoute;        ///< Whether the border router is a default route for the prefix.
+    };
+
+    /**
+     * This structure represents a change of the prefixes of wpantund.
+     *
+     */
+    struct Change
+    {
+        Prefix mPrefix;  ///< The prefix added or removed.
+        bool   mRemoved; ///< Whether the prefix is removed, it is added or updated otherwise.
+    };
+
+    /**
+     * The constructor initializes a table without prefix.
+     *
+     */
+    PrefixTable(void);
+
+    /**
+     * This method parses a prefix, as accepted by ConfigGateway.
+     *
+     * @param[in]   aText    A pointer to the prefix, an IPv6 address, optionally with a /64 length, or 16 hex digits.
+     * @param[out]  aPrefix  A pointer to receive the kPrefixSize bytes of the prefix.
+     *
+     * @returns Whether the prefix is valid.
+     *
+     */
+    static bool ParsePrefix(const char *aText, uint8_t *aPrefix);
+
+    /**
+     * This method formats a prefix as an IPv6 address, as accepted by ConfigGateway.
+     *
+     * @param[in]   aPrefix  A pointer to the kPrefixSize bytes of the prefix.
+     * @param[out]  aText    A pointer to receive the prefix.
+     * @param[in]   aSize    The size of aText, at least INET6_ADDRSTRLEN.
+     *
+     */
+    static void FormatPrefix(const uint8_t *aPrefix, char *aText, size_t aSize);
+
+    /**
+     * This method replaces the prefixes desired.
+     *
+     * The diff of all prefixes then removes those wpantund has and are not desired, other than the prefixes of other
+     * border routers.
+     *
+     * @param[in]  aPrefixes  A pointer to the prefixes.
+     * @param[in]  aCount     The number of prefixes.
+     *
+     * @returns Whether the prefixes were set, false if there are too many or one is repeated.
+     *
+     */
+    bool SetDesired(const Prefix *aPrefixes, size_t aCount);
+
+    /**
+     * This method adds or updates a prefix desired.
+     *
+     * @param[in]  aPrefix  A reference to the prefix.
+     *
+     * @returns Whether the prefix was added, false if there are too many.
+     *
+     */
+    bool AddDesired(const Prefix &aPrefix);
+
+    /**
+     * This method removes a prefix desired, so that the diff removes it from wpantund.
+     *
+     * @param[in]  aPrefix  A pointer to the kPrefixSize bytes of the prefix.
+     *
+     */
+    void RemoveDesired(const uint8_t *aPrefix);
+
+    /**
+     * This method updates the prefixes of wpantund, from the value of its Thread:OnMeshPrefixes property.
+     *
+     * The value is a JSON array of descriptions, e.g. "fd00:1:2:3::  prefix_len:64  origin:user  stable:yes ...
+     * [on-mesh:1 def-route:1 ...]". Prefixes of other border routers, whose origin is "ncp", and prefixes of other
+     * lengths are not kept. If the value fails to parse, the prefixes are kept as last known, and the diff changes the
+     * prefixes diffed whether or not wpantund has them already.
+     *
+     * @param[in]  aValue  A pointer to the value of the property.
+     *
+     * @returns Whether the value was parsed.
+     *
+     */
+    bool SetCurrent(const char *aValue);
+
+    /**
+     * This method computes the changes making the prefixes of wpantund the ones desired.
+     *
+     * @param[out]  aChanges  A pointer to receive at most kMaxChanges changes.
+     * @param[in]   aOnly     A pointer to the only prefix diffed, NULL to diff all prefixes owned.
+     *
+     * @returns The number of changes.
+     *
+     */
+    size_t Diff(Change *aChanges, const uint8_t *aOnly = NULL) const;
+
+    /**
+     * This method updates the prefixes of wpantund after changes were applied, until they are set again.
+     *
+     * @param[in]  aChanges  A pointer to the changes.
+     * @param[in]  aCount    The number of changes.
+     *
+     */
+    void Apply(const Change *aChanges, size_t aCount);
+
+    /**
+     * This method returns the number of prefixes desired.
+     *
+     * @returns The number of prefixes.
+     *
+     */
+    size_t GetDesiredCount(void) const { return mDesiredCount; }
+
+    /**
+     * This method returns the number of prefixes of wpantund kept.
+     *
+     * @returns The number of prefixes.
+     *
+     */
+    size_t GetCurrentCount(void) const { return mCurrentCount; }
+
+private:
+    static int  Find(const Prefix *aPrefixes, size_t aCount, const uint8_t *aPrefix);
+    static bool ParseEntry(const char *aEntry, size_t aLength, Prefix &aPrefix);
+    static void Remove(Prefix *aPrefixes, size_t &aCount, int aIndex);
+
+    Prefix mDesired[kMaxPrefixes];
+    size_t mDesiredCount;
+    Prefix mCurrent[kMaxCurrent]; ///< The prefixes of wpantund, as last known.
+    size_t mCurrentCount;
+    bool   mCurrentKnown; ///< Whether the prefixes of wpantund were parsed by the last SetCurrent().
+};
+
+} // namespace Web
+} // namespace ot
+
+#endif // PREFIX_TABLE_HPP_
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions of the frontend files compiled into otbr-web.
+ */
+
+#ifndef STATIC_ASSETS_HPP_
+#define STATIC_ASSETS_HPP_
+
+#include <stddef.h>
+
+namespace ot {
+namespace Web {
+
+/**
+ * This structure represents a static file served from memory, along with its precompressed variants.
+ *
+ */
+struct StaticAsset
+{
+    const char *         mPath;         ///< The request path, e.g. "/index.html".
+    const char *         mType;         ///< The content type.
+    const char *         mCacheControl; ///< The value of the Cache-Control header.
+    const char *         mEtag;         ///< The strong entity tag, quoted.
+    const unsigned char *mContent;
+    size_t               mContentLength;
+    const unsigned char *mGzip; ///< The gzip encoded content, NULL if none.
+    size_t               mGzipLength;
+    const unsigned char *mBrotli; ///< The brotli encoded content, NULL if none.
+    size_t               mBrotliLength;
+};
+
+/**
+ * The frontend files generated by embed-assets when configured with --enable-embedded-web-assets, sorted by path in
+ * byte order.
+ *
+ */
+extern const StaticAsset kStaticAssets[];
+
+/**
+ * The number of entries of kStaticAssets.
+ *
+ */
+extern const size_t kStaticAssetCount;
+
+} // namespace Web
+} // namespace ot
+
+#endif // STATIC_ASSETS_HPP_
@@ -31,123 +31,1289 @@
  *   This file implements the web server of border router
  */
 
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_WEB
+
 #include "web_server.hpp"
 
-#define BOOST_NO_CXX11_SCOPED_ENUMS
-#include <boost/filesystem.hpp>
-#undef BOOST_NO_CXX11_SCOPED_ENUMS
+#include <errno.h>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <inttypes.h>
+#include <map>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include <boost/asio/signal_set.hpp>
+
+#define BOOST_NO_CXX11_SCOPED_ENUMS
+#include <boost/filesystem.hpp>
+#undef BOOST_NO_CXX11_SCOPED_ENUMS
+
+#include <server_http.hpp>
+
+#include "http_router.hpp"
+#include "static_assets.hpp"
+#include "common/code_utils.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
+
+#define OT_ADD_PREFIX_PATH "/add_prefix"
+#define OT_AVAILABLE_NETWORK_PATH "/available_network"
+#define OT_AVAILABLE_NETWORK_STREAM_PATH "/available_network_stream"
+#define OT_BATCH_PATH "/batch"
+#define OT_DELETE_PREFIX_PATH "/delete_prefix"
+#define OT_FORM_NETWORK_PATH "/form_network"
+#define OT_GET_NETWORK_PATH "/get_properties"
+#define OT_JOIN_NETWORK_PATH "/join_network"
+#define OT_METRICS_PATH "/metrics"
+#define OT_SET_NETWORK_PATH "/settings"
+#define OT_SET_PREFIXES_PATH "/set_prefixes"
+#define OT_STATUS_EVENTS_PATH "/status_events"
+#define OT_REQUEST_METHOD_GET "GET"
+#define OT_REQUEST_METHOD_POST "POST"
+#define OT_RESPONSE_SUCCESS_STATUS "HTTP/1.1 200 OK\r\n"
+#define OT_RESPONSE_HEADER_LENGTH "Content-Length: "
+#define OT_RESPONSE_HEADER_CSS_TYPE "\r\nContent-Type: text/css"
+#define OT_RESPONSE_HEADER_EVENT_STREAM "Content-Type: text/event-stream\r\nCache-Control: no-cache"
+#define OT_RESPONSE_HEADER_JSON_LINES "Content-Type: application/x-ndjson\r\nTransfer-Encoding: chunked"
+#define OT_RESPONSE_LAST_CHUNK "0\r\n\r\n"
+#define OT_RESPONSE_HEADER_NO_STORE "Cache-Control: no-store\r\n"
+#define OT_RESPONSE_HEADER_REVALIDATE "Cache-Control: no-cache\r\n"
+#define OT_RESPONSE_PLACEHOLD "\r\n\r\n"
+#define OT_CONTENT_TYPE_JSON "application/json; charset=utf-8"
+#define OT_CONTENT_TYPE_TEXT "text/plain; charset=utf-8"
+#define OT_RESPONSE_FAILURE_STATUS "HTTP/1.1 400 Bad Request\r\n"
+#define OT_RESPONSE_NOT_MODIFIED_STATUS "HTTP/1.1 304 Not Modified\r\n"
+#define OT_RESPONSE_NOT_FOUND_STATUS "HTTP/1.1 404 Not Found\r\n"
+#define OT_CACHE_CONTROL_HTML "no-cache"
+#define OT_CACHE_CONTROL_ASSET "public, max-age=86400"
+#define OT_FILE_CHUNK_SIZE 65536
+
+namespace ot {
+namespace Web {
+
+static BorderRouter::Metrics::Counter   sRequests("web.requests");
+static BorderRouter::Metrics::Histogram sRequestTime("web.request_us");
+static BorderRouter::Metrics::Memory    sResponseMemory("memory.web_responses");
+static BorderRouter::Metrics::Counter   sStatusSnapshots("web.status_snapshots");
+static BorderRouter::Metrics::Counter   sStatusNotModified("web.status_not_modified");
+static BorderRouter::Metrics::Counter   sStatusEvents("web.status_events");
+static BorderRouter::Metrics::Counter   sScanSnapshots("web.scan_snapshots");
+static BorderRouter::Metrics::Counter   sStaticCached("web.static_cached");
+static BorderRouter::Metrics::Counter   sStaticNotModified("web.static_not_modified");
+static BorderRouter::Metrics::Memory    sStaticMemory("memory.web_static");
+static BorderRouter::Metrics::Counter   sNotFound("web.not_found");
+static BorderRouter::Metrics::Counter   sConnectionsRejected("web.connections_rejected");
+
+typedef std::function<void(std::shared_ptr<HttpServer::Response>, std::shared_ptr<HttpServer::Request>)> HttpHandler;
+
+/**
+ * This class routes the requests of the API, which are served before the static files.
+ *
+ * The routes are not given to the server, which would match each request against the pattern of each route.
+ *
+ */
+class ApiRouter : public HttpRouter<HttpHandler>
+{
+};
+
+/**
+ * This class implements the http server, which may listen on a socket passed by systemd instead of binding its port.
+ *
+ * A server listening on a passed socket stops once it has had no connection for the idle timeout, systemd starts it
+ * again on the next connection.
+ *
+ * Connections beyond the max are answered 503 and closed, so that slow clients holding theirs until the timeouts of
+ * the server do not lead to unbounded connections.
+ *
+ */
+class ActivatedHttpServer : public HttpServer
+{
+public:
+    ActivatedHttpServer(void)
+        : mListenFd(-1)
+        , mIdleTimeout(0)
+        , mMaxConnections(0)
+        , mActivity(std::make_shared<Activity>())
+    {
+    }
+
+    /**
+     * This method sets the listening socket, -1 to bind the configured port.
+     *
+     * @param[in]  aFd  The file descriptor of the listening socket.
+     *
+     */
+    void SetListenFd(int aFd) { mListenFd = aFd; }
+
+    /**
+     * This method sets the idle timeout of a server listening on a passed socket.
+     *
+     * @param[in]  aTimeout  The idle timeout in seconds, 0 to never stop.
+     *
+     */
+    void SetIdleTimeout(uint32_t aTimeout) { mIdleTimeout = aTimeout; }
+
+    /**
+     * This method sets the max number of connections.
+     *
+     * @param[in]  aMaxConnections  The max number of connections, 0 for no limit.
+     *
+     */
+    void SetMaxConnections(size_t aMaxConnections) { mMaxConnections = aMaxConnections; }
+
+    void start(void) override;
+
+protected:
+    void accept(void) override;
+
+private:
+    /**
+     * This struct counts the connections, it is shared with their sockets which may outlive the server.
+     *
+     */
+    struct Activity
+    {
+        Activity(void)
+            : mConnections(0)
+            , mLastActive(BorderRouter::GetMonotonicNowUs())
+        {
+        }
+
+        std::atomic<size_t>   mConnections; ///< The sockets, including the one waiting for the next connection.
+        std::atomic<uint64_t> mLastActive;  ///< The time in microseconds the last connection was closed.
+    };
+
+    void WaitIdle(uint64_t aDelay);
+    void HandleIdleTimer(void);
+
+    int                                          mListenFd;
+    uint32_t                                     mIdleTimeout;
+    size_t                                       mMaxConnections;
+    std::shared_ptr<Activity>                    mActivity;
+    std::unique_ptr<boost::asio::deadline_timer> mIdleTimer;
+};
+
+void ActivatedHttpServer::start(void)
+{
+    struct sockaddr_storage address;
+    socklen_t               length = sizeof(address);
+
+    if (mListenFd < 0)
+    {
+        HttpServer::start();
+        ExitNow();
+    }
+
+    if (io_service->stopped())
+    {
+        io_service->reset();
+    }
+
+    // The socket is bound and listening already, only its protocol is needed.
+    VerifyOrExit(getsockname(mListenFd, reinterpret_cast<struct sockaddr *>(&address), &length) == 0,
+                 otbrLog(OTBR_LOG_ERR, "invalid listening socket: %s", strerror(errno)));
+    acceptor.reset(new boost::asio::ip::tcp::acceptor(
+        *io_service, address.ss_family == AF_INET6 ? boost::asio::ip::tcp::v6() : boost::asio::ip::tcp::v4(),
+        mListenFd));
+    accept();
+
+    if (mIdleTimeout != 0)
+    {
+        mIdleTimer.reset(new boost::asio::deadline_timer(*io_service));
+        WaitIdle(static_cast<uint64_t>(mIdleTimeout) * 1000000);
+    }
+
+    threads.clear();
+
+    for (size_t i = 1; i < config.thread_pool_size; i++)
+    {
+        threads.emplace_back([this]() { io_service->run(); });
+    }
+
+    io_service->run();
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+exit:
+    return;
+}
+
+void ActivatedHttpServer::accept(void)
+{
+    std::shared_ptr<Activity>        activity = mActivity;
+    std::shared_ptr<SimpleWeb::HTTP> socket(new SimpleWeb::HTTP(*io_service), [activity](SimpleWeb::HTTP *aSocket) {
+        activity->mLastActive = BorderRouter::GetMonotonicNowUs();
+        --activity->mConnections;
+        delete aSocket;
+    });
+
+    ++activity->mConnections;
+
+    // Accepts the same way as the base server, without reporting errors to on_error, which the web server never sets.
+    acceptor->async_accept(*socket, [this, socket](const boost::system::error_code &aError) {
+        if (aError != boost::asio::error::operation_aborted)
+        {
+            accept();
+        }
+
+        if (aError)
+        {
+            return;
+        }
+
+        // The count includes the socket waiting for the next connection.
+        if (mMaxConnections != 0 && mActivity->mConnections > mMaxConnections + 1)
+        {
+            static const char kServiceUnavailable[] =
+                "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+            sConnectionsRejected.Add();
+            boost::asio::async_write(*socket, boost::asio::buffer(kServiceUnavailable, sizeof(kServiceUnavailable) - 1),
+                                     [socket](const boost::system::error_code &, size_t) {});
+            return;
+        }
+
+        socket->set_option(boost::asio::ip::tcp::no_delay(true));
+        read_request_and_content(socket);
+    });
+}
+
+void ActivatedHttpServer::WaitIdle(uint64_t aDelay)
+{
+    mIdleTimer->expires_from_now(boost::posix_time::microseconds(static_cast<int64_t>(aDelay)));
+    mIdleTimer->async_wait([this](const boost::system::error_code &aError) {
+        if (!aError)
+        {
+            HandleIdleTimer();
+        }
+    });
+}
+
+void ActivatedHttpServer::HandleIdleTimer(void)
+{
+    uint64_t timeout = static_cast<uint64_t>(mIdleTimeout) * 1000000;
+    uint64_t idle    = BorderRouter::GetMonotonicNowUs() - mActivity->mLastActive;
+
+    if (mActivity->mConnections > 1)
+    {
+        WaitIdle(timeout);
+    }
+    else if (idle < timeout)
+    {
+        WaitIdle(timeout - idle);
+    }
+    else
+    {
+        otbrLog(OTBR_LOG_INFO, "Border router web stopped after %u seconds without connection.", mIdleTimeout);
+        stop();
+    }
+}
+
+/**
+ * This class keeps the static files in memory, along with their precompressed variants.
+ *
+ * The files are loaded before the server starts and only read afterwards, so they are shared by all server threads.
+ * With OTBR_ENABLE_EMBEDDED_WEB_ASSETS, the files are those compiled into the binary and nothing is loaded.
+ *
+ */
+class StaticAssetCache
+{
+public:
+    StaticAssetCache(void)
+        : mSize(0)
+    {
+    }
+
+    ~StaticAssetCache(void) { sStaticMemory.Free(mSize); }
+
+    /**
+     * This method loads the files under a directory.
+     *
+     * A file with a sibling of the same name suffixed by ".gz" or ".br" is also served with that content encoding.
+     *
+     * @param[in]  aRoot  The directory to load.
+     *
+     */
+    void Load(const boost::filesystem::path &aRoot);
+
+    /**
+     * This method responds to a request with a file in memory.
+     *
+     * @param[in]  aRequest   A reference to the http request.
+     * @param[out] aResponse  A reference to the http response.
+     *
+     * @retval true   The response is written.
+     * @retval false  The file is not in memory.
+     *
+     */
+    bool Respond(const HttpServer::Request &aRequest, HttpServer::Response &aResponse) const;
+
+private:
+    static bool                 ReadFile(const boost::filesystem::path &aPath, std::string &aContent);
+    static const char *         GetContentType(const std::string &aExtension);
+    static bool                 AcceptsEncoding(const HttpServer::Request &aRequest, const char *aEncoding);
+    static const unsigned char *GetEncoded(const std::string &aContent);
+
+    const StaticAsset *Find(std::string aPath) const;
+    const StaticAsset *FindPath(const std::string &aPath) const;
+
+    std::map<std::string, StaticAsset> mAssets;  ///< Indexed by the request path.
+    std::list<std::string>             mStorage; ///< The contents and entity tags the loaded assets refer to.
+    size_t                             mSize;
+};
+
+bool StaticAssetCache::ReadFile(const boost::filesystem::path &aPath, std::string &aContent)
+{
+    std::ifstream file(aPath.string(), std::ifstream::in | std::ios::binary);
+
+    aContent.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    return !file.bad();
+}
+
+const char *StaticAssetCache::GetContentType(const std::string &aExtension)
+{
+    static const struct
+    {
+        const char *mExtension;
+        const char *mType;
+    } kContentTypes[] = {
+        {".css", "text/css"},
+        {".html", "text/html; charset=utf-8"},
+        {".ico", "image/x-icon"},
+        {".js", "application/javascript"},
+        {".json", "application/json"},
+        {".png", "image/png"},
+        {".svg", "image/svg+xml"},
+    };
+
+    for (size_t i = 0; i < sizeof(kContentTypes) / sizeof(kContentTypes[0]); i++)
+    {
+        if (aExtension == kContentTypes[i].mExtension)
+        {
+            return kContentTypes[i].mType;
+        }
+    }
+
+    return "application/octet-stream";
+}
+
+bool StaticAssetCache::AcceptsEncoding(const HttpServer::Request &aRequest, const char *aEncoding)
+{
+    auto range = aRequest.header.equal_range("Accept-Encoding");
+
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second.find(aEncoding) != std::string::npos)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const unsigned char *StaticAssetCache::GetEncoded(const std::string &aContent)
+{
+    return aContent.empty() ? NULL : reinterpret_cast<const unsigned char *>(aContent.data());
+}
+
+void StaticAssetCache::Load(const boost::filesystem::path &aRoot)
+{
+    boost::filesystem::path root = boost::filesystem::canonical(aRoot);
+
+    for (boost::filesystem::recursive_directory_iterator it(root), end; it != end; ++it)
+    {
+        const boost::filesystem::path &path      = it->path();
+        std::string                    extension = path.extension().string();
+        std::string                    key       = path.string().substr(root.string().size());
+        std::string                    content, gzip, brotli;
+        StaticAsset                    asset;
+        uint64_t                       hash = 0xcbf29ce484222325ULL;
+        char                           etag[sizeof(hash) * 2 + 3];
+
+        // The variants are loaded along with the file they encode.
+        if (!boost::filesystem::is_regular_file(path) || extension == ".gz" || extension == ".br" ||
+            !ReadFile(path, content))
+        {
+            continue;
+        }
+
+        ReadFile(path.string() + ".gz", gzip);
+        ReadFile(path.string() + ".br", brotli);
+
+        for (size_t i = 0; i < content.size(); i++)
+        {
+            hash = (hash ^ static_cast<uint8_t>(content[i])) * 0x100000001b3ULL;
+        }
+
+        snprintf(etag, sizeof(etag), "\"%016" PRIx64 "\"", hash);
+        mSize += content.size() + gzip.size() + brotli.size();
+
+        // Strings in the list keep their place, so the asset refers to them.
+        mStorage.push_back(key);
+        asset.mPath = mStorage.back().c_str();
+        mStorage.push_back(etag);
+        asset.mEtag = mStorage.back().c_str();
+        mStorage.push_back(std::move(content));
+        asset.mContent       = reinterpret_cast<const unsigned char *>(mStorage.back().data());
+        asset.mContentLength = mStorage.back().size();
+        mStorage.push_back(std::move(gzip));
+        asset.mGzip       = GetEncoded(mStorage.back());
+        asset.mGzipLength = mStorage.back().size();
+        mStorage.push_back(std::move(brotli));
+        asset.mBrotli       = GetEncoded(mStorage.back());
+        asset.mBrotliLength = mStorage.back().size();
+        asset.mType         = GetContentType(extension);
+
+        // The pages are revalidated on each load, as the files they refer to are not versioned by name.
+        asset.mCacheControl = (extension == ".html") ? OT_CACHE_CONTROL_HTML : OT_CACHE_CONTROL_ASSET;
+
+        mAssets[key] = asset;
+    }
+
+    sStaticMemory.Allocate(mSize);
+    otbrLog(OTBR_LOG_INFO, "loaded %zu static files, %zu bytes", mAssets.size(), mSize);
+}
+
+const StaticAsset *StaticAssetCache::FindPath(const std::string &aPath) const
+{
+#if OTBR_ENABLE_EMBEDDED_WEB_ASSETS
+    const StaticAsset *end   = kStaticAssets + kStaticAssetCount;
+    const StaticAsset *asset =
+        std::lower_bound(kStaticAssets, end, aPath, [](const StaticAsset &aAsset, const std::string &aKey) {
+            return strcmp(aAsset.mPath, aKey.c_str()) < 0;
+        });
+
+    return (asset != end && aPath == asset->mPath) ? asset : NULL;
+#else
+    auto it = mAssets.find(aPath);
+
+    return (it != mAssets.end()) ? &it->second : NULL;
+#endif
+}
+
+const StaticAsset *StaticAssetCache::Find(std::string aPath) const
+{
+    const StaticAsset *asset = NULL;
+
+    aPath = aPath.substr(0, aPath.find('?'));
+
+    if (aPath.empty() || aPath[aPath.size() - 1] != '/')
+    {
+        asset = FindPath(aPath);
+        aPath += '/';
+    }
+
+    if (asset == NULL)
+    {
+        asset = FindPath(aPath + "index.html");
+    }
+
+    return asset;
+}
+
+bool StaticAssetCache::Respond(const HttpServer::Request &aRequest, HttpServer::Response &aResponse) const
+{
+    const StaticAsset *  asset = Find(aRequest.path);
+    const unsigned char *content;
+    size_t               length;
+    const char *         encoding = NULL;
+
+    VerifyOrExit(asset != NULL);
+
+    {
+        auto ifNoneMatch = aRequest.header.find("If-None-Match");
+
+        if (ifNoneMatch != aRequest.header.end() &&
+            (ifNoneMatch->second == "*" || ifNoneMatch->second.find(asset->mEtag) != std::string::npos))
+        {
+            aResponse << OT_RESPONSE_NOT_MODIFIED_STATUS << "ETag: " << asset->mEtag
+                      << "\r\nCache-Control: " << asset->mCacheControl << OT_RESPONSE_PLACEHOLD;
+            sStaticNotModified.Add();
+            ExitNow();
+        }
+    }
+
+    content = asset->mContent;
+    length  = asset->mContentLength;
+
+    if (asset->mBrotli != NULL && AcceptsEncoding(aRequest, "br"))
+    {
+        content  = asset->mBrotli;
+        length   = asset->mBrotliLength;
+        encoding = "br";
+    }
+    else if (asset->mGzip != NULL && AcceptsEncoding(aRequest, "gzip"))
+    {
+        content  = asset->mGzip;
+        length   = asset->mGzipLength;
+        encoding = "gzip";
+    }
+
+    aResponse << OT_RESPONSE_SUCCESS_STATUS << OT_RESPONSE_HEADER_LENGTH << length
+              << "\r\nContent-Type: " << asset->mType << "\r\nCache-Control: " << asset->mCacheControl
+              << "\r\nETag: " << asset->mEtag << "\r\nVary: Accept-Encoding";
+
+    if (encoding != NULL)
+    {
+        aResponse << "\r\nContent-Encoding: " << encoding;
+    }
+
+    // The whole response is written to the socket at once when the handler returns.
+    aResponse << OT_RESPONSE_PLACEHOLD;
+    aResponse.write(reinterpret_cast<const char *>(content), length);
+    sStaticCached.Add();
+
+exit:
+    return asset != NULL;
+}
+
+struct WebServer::WpanRequest
+{
+    WpanRequest(WebServer &                                  aWebServer,
+                HttpRequestCallback                          aCallback,
+                const std::shared_ptr<HttpServer::Response> &aResponse,
+                const std::string &                          aRequest)
+        : mJob(RunWpanRequest, CompleteWpanRequest, this)
+        , mPrepareJob(RunPrepareRequest, CompletePrepareRequest, this)
+        , mWebServer(aWebServer)
+        , mCallback(aCallback)
+        , mPrepare(NULL)
+        , mResponse(aResponse)
+        , mRequest(aRequest)
+        , mFailed(false)
+        , mStart(BorderRouter::GetMonotonicNowUs())
+    {
+    }
+
+    BorderRouter::WorkerPool::Job         mJob;
+    BorderRouter::WorkerPool::Job         mPrepareJob; ///< Runs the preparation, before the request is submitted.
+    WebServer &                           mWebServer;
+    HttpRequestCallback                   mCallback;
+    HttpRequestCallback                   mPrepare; ///< The preparation of the request, NULL if none.
+    std::shared_ptr<HttpServer::Response> mResponse; ///< Sent once the last reference is released.
+    std::string                           mRequest;
+    std::string                           mResult; ///< The http response content, or the error.
+    bool                                  mFailed;
+    uint64_t                              mStart;
+};
+
+struct WebServer::StreamedResponse
+{
+    StreamedResponse(const std::shared_ptr<HttpServer::Response> &aResponse)
+        : mResponse(aResponse)
+        , mSending(false)
+    {
+    }
+
+    std::shared_ptr<HttpServer::Response> mResponse; ///< Ends the response once the last reference is released.
+    std::string                           mPending;  ///< Content waiting for the write in progress.
+    bool                                  mSending;
+};
+
+struct WebServer::ScanRequest
+{
+    ScanRequest(WebServer &aWebServer, const std::shared_ptr<HttpServer::Response> &aResponse)
+        : mJob(RunScanRequest, CompleteScanRequest, this)
+        , mWebServer(aWebServer)
+        , mStream(std::make_shared<StreamedResponse>(aResponse))
+    {
+    }
+
+    BorderRouter::WorkerPool::Job     mJob;
+    WebServer &                       mWebServer;
+    std::shared_ptr<StreamedResponse> mStream;
+};
+
+static void AppendChunk(std::string &aContent, const std::string &aChunk)
+{
+    char size[sizeof(size_t) * 2 + 3];
+
+    snprintf(size, sizeof(size), "%zx\r\n", aChunk.size());
+    aContent += size + aChunk + "\r\n";
+}
+
+/**
+ * This class keeps the header block of the responses of a route, up to the content length, so that it is only
+ * formatted once.
+ *
+ */
+class ResponseHeader
+{
+public:
+    explicit ResponseHeader(const char *aContentType)
+        : mSuccess(std::string(OT_RESPONSE_SUCCESS_STATUS "Content-Type: ") + aContentType +
+                   "\r\n" OT_RESPONSE_HEADER_NO_STORE OT_RESPONSE_HEADER_LENGTH)
+        , mVersioned(std::string(OT_RESPONSE_SUCCESS_STATUS "Content-Type: ") + aContentType +
+                     "\r\n" OT_RESPONSE_HEADER_REVALIDATE "ETag: ")
+    {
+    }
+
+    /**
+     * This method writes a complete response.
+     *
+     * Connections are kept open after the response unless the client asks otherwise, as the length is always set.
+     * A response with an ETag may be stored by the client, which revalidates it with the ETag before each use.
+     *
+     * @param[out]  aResponse   A reference to the http response.
+     * @param[in]   aContent    The content of the response, or the error if @p aFailed.
+     * @param[in]   aFailed     Whether to respond with a failure.
+     * @param[in]   aEtag       A pointer to the ETag of the content, NULL if none.
+     *
+     */
+    void Write(HttpServer::Response &aResponse,
+               const std::string &   aContent,
+               bool                  aFailed,
+               const std::string *   aEtag = NULL) const
+    {
+        static const std::string kFailure(OT_RESPONSE_FAILURE_STATUS "Content-Type: " OT_CONTENT_TYPE_TEXT
+                                          "\r\n" OT_RESPONSE_HEADER_NO_STORE OT_RESPONSE_HEADER_LENGTH);
+        const std::string &header = aFailed ? kFailure : aEtag != NULL ? mVersioned : mSuccess;
+        // The JSON buffer lives until it is copied to the response stream.
+        size_t size = aContent.capacity();
+        char   length[sizeof(size_t) * 3 + sizeof(OT_RESPONSE_PLACEHOLD)];
+        int    lengthSize = snprintf(length, sizeof(length), "%zu" OT_RESPONSE_PLACEHOLD, aContent.size());
+
+        sResponseMemory.Allocate(size);
+        aResponse.write(header.data(), header.size());
+
+        if (!aFailed && aEtag != NULL)
+        {
+            aResponse << *aEtag << "\r\n" OT_RESPONSE_HEADER_LENGTH;
+        }
+
+        aResponse.write(length, lengthSize);
+        aResponse.write(aContent.data(), aContent.size());
+        sResponseMemory.Free(size);
+    }
+
+private:
+    std::string mSuccess;
+    std::string mVersioned; ///< The header of a successful response, up to its ETag.
+};
+
+static const ResponseHeader sJsonHeader(OT_CONTENT_TYPE_JSON);
+
+static void WriteResponse(HttpServer::Response &aResponse, const std::string &aContent, bool aFailed)
+{
+    sJsonHeader.Write(aResponse, aContent, aFailed);
+}
+
+static bool HasQueryFlag(const std::string &aTarget, const char *aName)
+{
+    size_t length = strlen(aName);
+    size_t cur    = aTarget.find('?');
+
+    // The flag is set by "name", "name=1" or "name=true" in the query string.
+    while (cur != std::string::npos)
+    {
+        size_t      end   = aTarget.find('&', ++cur);
+        std::string field = aTarget.substr(cur, end == std::string::npos ? std::string::npos : end - cur);
+
+        if (field.compare(0, length, aName) == 0 &&
+            (field.size() == length || field.compare(length, std::string::npos, "=1") == 0 ||
+             field.compare(length, std::string::npos, "=true") == 0))
+        {
+            return true;
+        }
+
+        cur = end;
+    }
+
+    return false;
+}
+
+static void RespondNow(const ResponseHeader &aHeader,
+                       std::string (*aCallback)(const std::string &, void *),
+                       void *                aContext,
+                       HttpServer::Response &aResponse,
+                       const std::string &   aRequest)
+{
+    uint64_t start = BorderRouter::GetMonotonicNowUs();
+
+    try
+    {
+        std::string httpResponse;
+
+        if (aCallback != NULL)
+        {
+            httpResponse = aCallback(aRequest, aContext);
+        }
+
+        aHeader.Write(aResponse, httpResponse, false);
+    } catch (std::exception &e)
+    {
+        aHeader.Write(aResponse, e.what(), true);
+    }
+
+    sRequests.Add();
+    sRequestTime.Record(BorderRouter::GetMonotonicNowUs() - start);
+}
+
+WebServer::WebServer(void)
+    : mServer(new ActivatedHttpServer())
+    , mStaticAssets(new StaticAssetCache())
+    , mRouter(new ApiRouter())
+    , mScanRefreshJob(RunScanRefresh, CompleteScanRefresh, this)
+    , mWpanWorkerFd(NULL)
+    , mPrepareWorkerFd(NULL)
+    , mInterfaceFd(NULL)
+    , mPropWatchStopping(false)
+    , mStatusWatched(false)
+{
+    mServer->SetMaxConnections(OTBR_CAPACITY_WEB_CONNECTIONS);
+    mServer->config.max_request_streambuf_size = kMaxRequestSize;
+}
+
+WebServer::~WebServer(void)
+{
+    delete mInterfaceFd;
+    delete mPrepareWorkerFd;
+    delete mWpanWorkerFd;
+    delete mRouter;
+    delete mStaticAssets;
+    delete mServer;
+}
+
+void WebServer::SetThreadPoolSize(size_t aSize)
+{
+    mServer->config.thread_pool_size = aSize;
+}
+
+void WebServer::SetListenSocket(int aFd)
+{
+    mServer->SetListenFd(aFd);
+}
+
+void WebServer::SetIdleTimeout(uint32_t aTimeout)
+{
+    mServer->SetIdleTimeout(aTimeout);
+}
+
+void WebServer::SetMaxConnections(size_t aMaxConnections)
+{
+    mServer->SetMaxConnections(aMaxConnections);
+}
+
+void WebServer::SetRequestTimeout(uint32_t aTimeout)
+{
+    mServer->config.timeout_request = aTimeout;
+}
+
+void WebServer::SetContentTimeout(uint32_t aTimeout)
+{
+    mServer->config.timeout_content = aTimeout;
+}
+
+void WebServer::SetMaxRequestSize(size_t aSize)
+{
+    mServer->config.max_request_streambuf_size = aSize;
+}
+
+void WebServer::Init()
+{
+    std::string networkName, extPanId;
+
+    if (mWpanService.GetWpanServiceStatus(networkName, extPanId) > 0)
+    {
+        return;
+    }
+}
+
+void WebServer::StartWebServer(const char *aIfName, uint16_t aPort)
+{
+    mServer->config.port = aPort;
+    mWpanService.SetInterfaceName(aIfName);
+    Init();
+    ResponseJoinNetwork();
+    ResponseFormNetwork();
+    ResponseAddOnMeshPrefix();
+    ResponseDeleteOnMeshPrefix();
+    ResponseSetOnMeshPrefixes();
+    ResponseGetStatus();
+    ResponseGetAvailableNetwork();
+    ResponseStreamAvailableNetwork();
+    ResponseMetrics();
+    ResponseStatusEvents();
+    ResponseBatch();
+    DefaultHttpResponse();
+
+#if !OTBR_ENABLE_EMBEDDED_WEB_ASSETS
+    try
+    {
+        mStaticAssets->Load(WEB_FILE_PATH);
+    } catch (const std::exception &e)
+    {
+        otbrLog(OTBR_LOG_WARNING, "static files are served from disk: %s", e.what());
+    }
+#endif
+
+    // The server runs on an io_service of its own, which also completes the requests of the WPAN worker.
+    mServer->io_service = std::make_shared<boost::asio::io_service>();
+
+    if (mWpanWorker.Start(1) == OTBR_ERROR_NONE)
+    {
+        mWpanWorkerFd = new boost::asio::posix::stream_descriptor(*mServer->io_service, mWpanWorker.GetFd());
+        WaitWorker(mWpanWorker, *mWpanWorkerFd);
+
+        // Without it, requests are prepared by the WPAN worker as they are run.
+        if (mPrepareWorker.Start(1) == OTBR_ERROR_NONE)
+        {
+            mPrepareWorkerFd =
+                new boost::asio::posix::stream_descriptor(*mServer->io_service, mPrepareWorker.GetFd());
+            WaitWorker(mPrepareWorker, *mPrepareWorkerFd);
+        }
+    }
+
+    // Without it, the addresses are requested from wpantund.
+    if (mInterfaceTable.Open(aIfName) == OTBR_ERROR_NONE)
+    {
+        mInterfaceFd = new boost::asio::posix::stream_descriptor(*mServer->io_service, mInterfaceTable.GetFd());
+        mWpanService.SetInterfaceTable(&mInterfaceTable);
+        WaitInterface();
+    }
+
+    // Changes are received on a thread of their own, and posted to the server thread to be pushed to clients.
+    if (mPropWatch.Start(aIfName, HandlePropertyChanged, this) == ot::Dbus::kWpantundStatus_Ok)
+    {
+        mStatusWatched = true;
+        mWpanService.SetStatusSnapshotEnabled(true);
+        mPropWatchThread = std::thread([this]() { WatchProperties(); });
+    }
+
+    // The server stops on SIGTERM and SIGINT, so that the web server exits through its destructors and atexit handlers.
+    boost::asio::signal_set signals(*mServer->io_service, SIGINT, SIGTERM);
+    signals.async_wait([this](const boost::system::error_code &aError, int) {
+        if (!aError)
+        {
+            otbrLog(OTBR_LOG_INFO, "Border router web stopped.");
+            mServer->stop();
+        }
+    });
+
+    std::thread ServerThread([this]() { mServer->start(); });
+    ServerThread.join();
+
+    if (mPropWatchThread.joinable())
+    {
+        mPropWatchStopping = true;
+        mPropWatchThread.join();
+    }
+
+    mPropWatch.Stop();
+
+    // The descriptor is owned by the interface table.
+    if (mInterfaceFd != NULL)
+    {
+        mInterfaceFd->release();
+    }
+
+    mWpanService.SetInterfaceTable(NULL);
+    mInterfaceTable.Close();
+
+    // The descriptors are owned by the worker pools. Prepared requests are still submitted to the WPAN worker.
+    if (mPrepareWorkerFd != NULL)
+    {
+        mPrepareWorkerFd->release();
+    }
+
+    mPrepareWorker.Stop();
+
+    if (mWpanWorkerFd != NULL)
+    {
+        mWpanWorkerFd->release();
+    }
+
+    mWpanWorker.Stop();
+}
+
+void WebServer::WaitWorker(BorderRouter::WorkerPool &aWorker, boost::asio::posix::stream_descriptor &aWorkerFd)
+{
+    aWorkerFd.async_read_some(boost::asio::null_buffers(),
+                              [this, &aWorker, &aWorkerFd](const boost::system::error_code &aError, size_t) {
+                                  if (!aError)
+                                  {
+                                      aWorker.Process();
+                                      WaitWorker(aWorker, aWorkerFd);
+                                  }
+                              });
+}
+
+void WebServer::WaitInterface(void)
+{
+    mInterfaceFd->async_read_some(boost::asio::null_buffers(), [this](const boost::system::error_code &aError, size_t) {
+        if (!aError && mInterfaceTable.Process())
+        {
+            std::string event = mWpanService.HandleInterfaceChanged();
 
-#include <server_http.hpp>
+            if (!event.empty())
+            {
+                PushStatusEvent(event);
+            }
+        }
 
-#define OT_ADD_PREFIX_PATH "^/add_prefix"
-#define OT_AVAILABLE_NETWORK_PATH "^/available_network$"
-#define OT_DELETE_PREFIX_PATH "^/delete_prefix"
-#define OT_FORM_NETWORK_PATH "^/form_network$"
-#define OT_GET_NETWORK_PATH "^/get_properties$"
-#define OT_JOIN_NETWORK_PATH "^/join_network$"
-#define OT_SET_NETWORK_PATH "^/settings$"
-#define OT_REQUEST_METHOD_GET "GET"
-#define OT_REQUEST_METHOD_POST "POST"
-#define OT_RESPONSE_SUCCESS_STATUS "HTTP/1.1 200 OK\r\n"
-#define OT_RESPONSE_HEADER_LENGTH "Content-Length: "
-#define OT_RESPONSE_HEADER_CSS_TYPE "\r\nContent-Type: text/css"
-#define OT_RESPONSE_HEADER_TYPE "Content-Type: application/json\r\n charset=utf-8"
-#define OT_RESPONSE_PLACEHOLD "\r\n\r\n"
-#define OT_RESPONSE_FAILURE_STATUS "HTTP/1.1 400 Bad Request\r\n"
-#define OT_BUFFER_SIZE 1024
+        // A table given up is no longer read, the status is requested from wpantund.
+        if (!aError && mInterfaceTable.IsValid())
+        {
+            WaitInterface();
+        }
+    });
+}
 
-namespace ot {
-namespace Web {
+void WebServer::WatchProperties(void)
+{
+    while (!mPropWatchStopping && mPropWatch.Process(kPropWatchTimeout))
+    {
+    }
 
-WebServer::WebServer(void)
-    : mServer(new HttpServer())
+    if (!mPropWatchStopping)
+    {
+        otbrLog(OTBR_LOG_WARNING, "lost the property changes of wpantund, status is no longer cached");
+    }
+
+    mWpanService.SetStatusSnapshotEnabled(false);
+    mStatusWatched = false;
+}
+
+void WebServer::HandlePropertyChanged(const char *aName, const char *aValue, void *aContext)
 {
+    static_cast<WebServer *>(aContext)->HandlePropertyChanged(aName, aValue);
 }
 
-WebServer::~WebServer(void)
+void WebServer::HandlePropertyChanged(const char *aName, const char *aValue)
 {
-    delete mServer;
+    std::string event = mWpanService.HandlePropertyChanged(aName, aValue);
+
+    if (!event.empty())
+    {
+        mServer->io_service->post([this, event]() { PushStatusEvent(event); });
+    }
 }
 
-void WebServer::Init()
+void WebServer::PushStatusEvent(const std::string &aEvent)
 {
-    std::string networkName, extPanId;
+    std::lock_guard<std::mutex> lock(mStreamMutex);
 
-    if (mWpanService.GetWpanServiceStatus(networkName, extPanId) > 0)
+    for (auto it = mStatusSubscribers.begin(); it != mStatusSubscribers.end();)
+    {
+        std::shared_ptr<StreamedResponse> subscriber = *it;
+
+        // A client not reading its stream is dropped instead of buffering for it.
+        if (subscriber->mPending.size() + aEvent.size() > kMaxStatusPending)
+        {
+            subscriber->mPending.clear();
+            it = mStatusSubscribers.erase(it);
+            continue;
+        }
+
+        subscriber->mPending += "data: " + aEvent + "\n\n";
+        SendStreamed(subscriber);
+        ++it;
+    }
+
+    sStatusEvents.Add();
+}
+
+void WebServer::SendStreamed(const std::shared_ptr<StreamedResponse> &aStream)
+{
+    // The caller holds mStreamMutex. Only one write may be in progress on a connection, the content queued meanwhile
+    // is sent once it completes.
+    if (aStream->mSending || aStream->mPending.empty())
     {
         return;
     }
+
+    *aStream->mResponse << aStream->mPending;
+    aStream->mPending.clear();
+    aStream->mSending = true;
+
+    mServer->send(aStream->mResponse, [this, aStream](const boost::system::error_code &aError) {
+        std::lock_guard<std::mutex> lock(mStreamMutex);
+
+        aStream->mSending = false;
+
+        if (aError)
+        {
+            mStatusSubscribers.remove(aStream);
+        }
+        else
+        {
+            SendStreamed(aStream);
+        }
+    });
 }
 
-void WebServer::StartWebServer(const char *aIfName, uint16_t aPort)
+void WebServer::RunScanRequest(void *aContext)
 {
-    mServer->config.port = aPort;
-    mWpanService.SetInterfaceName(aIfName);
-    Init();
-    ResponseJoinNetwork();
-    ResponseFormNetwork();
-    ResponseAddOnMeshPrefix();
-    ResponseDeleteOnMeshPrefix();
-    ResponseGetStatus();
-    ResponseGetAvailableNetwork();
-    DefaultHttpResponse();
-    std::thread ServerThread([this]() { mServer->start(); });
-    ServerThread.join();
+    ScanRequest &                     request   = *static_cast<ScanRequest *>(aContext);
+    WebServer *                       webServer = &request.mWebServer;
+    std::shared_ptr<StreamedResponse> stream    = request.mStream;
+    std::string                       result;
+
+    try
+    {
+        result = webServer->mWpanService.HandleAvailableNetworkRequest(HandleScanNetwork, &request);
+    } catch (std::exception &e)
+    {
+        result = e.what();
+    }
+
+    // Posted after the networks, so that the result ends the stream. The request may be deleted before it runs.
+    webServer->mServer->io_service->post([webServer, stream, result]() {
+        std::lock_guard<std::mutex> lock(webServer->mStreamMutex);
+
+        AppendChunk(stream->mPending, result);
+        stream->mPending += OT_RESPONSE_LAST_CHUNK;
+        webServer->SendStreamed(stream);
+    });
 }
 
-void WebServer::HandleHttpRequest(const char *aUrl, const char *aMethod, HttpRequestCallback aCallback)
+void WebServer::RunScanRefresh(void *aContext)
 {
-    mServer->resource[aUrl][aMethod] = [aCallback, this](std::shared_ptr<HttpServer::Response> response,
-                                                         std::shared_ptr<HttpServer::Request>  request) {
-        try
+    WebServer *webServer = static_cast<WebServer *>(aContext);
+
+    try
+    {
+        webServer->mWpanService.HandleAvailableNetworkRequest();
+    } catch (std::exception &e)
+    {
+        otbrLog(OTBR_LOG_WARNING, "failed to refresh networks: %s", e.what());
+    }
+}
+
+void WebServer::CompleteScanRefresh(void *aContext)
+{
+    (void)aContext;
+}
+
+void WebServer::HandleScanNetwork(const std::string &aNetwork, void *aContext)
+{
+    ScanRequest &                     request   = *static_cast<ScanRequest *>(aContext);
+    WebServer *                       webServer = &request.mWebServer;
+    std::shared_ptr<StreamedResponse> stream    = request.mStream;
+
+    webServer->mServer->io_service->post([webServer, stream, aNetwork]() {
+        std::lock_guard<std::mutex> lock(webServer->mStreamMutex);
+
+        AppendChunk(stream->mPending, aNetwork);
+        webServer->SendStreamed(stream);
+    });
+}
+
+void WebServer::CompleteScanRequest(void *aContext)
+{
+    ScanRequest *request = static_cast<ScanRequest *>(aContext);
+
+    sRequests.Add();
+
+    // The stream is ended by the last event posted by the worker.
+    delete request;
+}
+
+void WebServer::RunWpanRequest(void *aContext)
+{
+    WpanRequest &request = *static_cast<WpanRequest *>(aContext);
+
+    try
+    {
+        request.mResult = request.mCallback(request.mRequest, &request.mWebServer);
+    } catch (std::exception &e)
+    {
+        request.mResult = e.what();
+        request.mFailed = true;
+    }
+}
+
+void WebServer::RunPrepareRequest(void *aContext)
+{
+    WpanRequest &request = *static_cast<WpanRequest *>(aContext);
+
+    try
+    {
+        request.mPrepare(request.mRequest, &request.mWebServer);
+    } catch (std::exception &e)
+    {
+        // The request reports its errors once run.
+        otbrLog(OTBR_LOG_WARNING, "failed to prepare request: %s", e.what());
+    }
+}
+
+void WebServer::CompletePrepareRequest(void *aContext)
+{
+    WpanRequest *request = static_cast<WpanRequest *>(aContext);
+
+    request->mWebServer.mWpanWorker.Submit(request->mJob);
+}
+
+void WebServer::CompleteWpanRequest(void *aContext)
+{
+    WpanRequest *request = static_cast<WpanRequest *>(aContext);
+
+    WriteResponse(*request->mResponse, request->mResult, request->mFailed);
+
+    sRequests.Add();
+    sRequestTime.Record(BorderRouter::GetMonotonicNowUs() - request->mStart);
+
+    delete request;
+}
+
+void WebServer::HandleHttpRequest(const char *        aUrl,
+                                  const char *        aMethod,
+                                  HttpRequestCallback aCallback,
+                                  const char *        aContentType)
+{
+    ResponseHeader header(aContentType);
+
+    HttpHandler handler = [aCallback, header, this](std::shared_ptr<HttpServer::Response> response,
+                                                    std::shared_ptr<HttpServer::Request>  request) {
+        RespondNow(header, aCallback, this, *response, request->content.string());
+    };
+
+    mRouter->Add(aMethod, aUrl, handler);
+}
+
+void WebServer::HandleWpanRequest(const char *        aUrl,
+                                  const char *        aMethod,
+                                  HttpRequestCallback aCallback,
+                                  HttpRequestCallback aPrepare)
+{
+    HttpHandler handler = [aCallback, aPrepare, this](std::shared_ptr<HttpServer::Response> response,
+                                                      std::shared_ptr<HttpServer::Request>  request) {
+        WpanRequest *wpanRequest = NULL;
+
+        // Without the worker, the request blocks the server thread as it waits for D-Bus.
+        if (!mWpanWorker.IsRunning())
         {
-            std::string httpResponse;
-            if (aCallback != NULL)
-            {
-                httpResponse = aCallback(request->content.string(), this);
-            }
+            RespondNow(sJsonHeader, aCallback, this, *response, request->content.string());
+            return;
+        }
 
-            *response << OT_RESPONSE_SUCCESS_STATUS << OT_RESPONSE_HEADER_LENGTH << httpResponse.length()
-                      << OT_RESPONSE_PLACEHOLD << httpResponse;
-        } catch (std::exception &e)
+        wpanRequest = new WpanRequest(*this, aCallback, response, request->content.string());
+
+        // A request with a long preparation is only submitted once prepared, so that it does not hold up the
+        // requests submitted meanwhile, which may then be run before it.
+        if (aPrepare != NULL && mPrepareWorker.IsRunning())
         {
-            *response << OT_RESPONSE_FAILURE_STATUS << OT_RESPONSE_HEADER_LENGTH << strlen(e.what())
-                      << OT_RESPONSE_PLACEHOLD << e.what();
+            wpanRequest->mPrepare = aPrepare;
+            mPrepareWorker.Submit(wpanRequest->mPrepareJob);
+            return;
         }
+
+        // Requests are run one at a time in order, so the WPAN service is only used from the worker thread.
+        mWpanWorker.Submit(wpanRequest->mJob);
     };
+
+    mRouter->Add(aMethod, aUrl, handler);
 }
 
-void DefaultResourceSend(const HttpServer &                           aServer,
-                         const std::shared_ptr<HttpServer::Response> &aResponse,
-                         const std::shared_ptr<std::ifstream> &       aIfStream)
+/**
+ * This structure keeps the state of a file being sent.
+ *
+ */
+struct FileSource
+{
+    explicit FileSource(int aFd)
+        : mFd(aFd)
+        , mOffset(0)
+        , mLength(0)
+    {
+    }
+
+    ~FileSource(void) { close(mFd); }
+
+    int   mFd;
+    off_t mOffset;
+    off_t mLength;
+};
+
+static void SendFile(const HttpServer &                           aServer,
+                     const std::shared_ptr<HttpServer::Response> &aResponse,
+                     const std::shared_ptr<FileSource> &          aSource)
 {
-    static std::vector<char> buffer(OT_BUFFER_SIZE); // Safe when server is running on one thread
+    // The response is an ostream over an asio streambuf, file data is read straight into its free space, without
+    // going through a stream buffer of our own. Each chunk is written in a single async write.
+    boost::asio::streambuf &streambuf = static_cast<boost::asio::streambuf &>(*aResponse->rdbuf());
+    size_t                  size      = std::min<off_t>(aSource->mLength - aSource->mOffset, OT_FILE_CHUNK_SIZE);
+    ssize_t                 rval;
 
-    std::streamsize readLength;
+    VerifyOrExit(size > 0);
 
-    if ((readLength = aIfStream->read(&buffer[0], buffer.size()).gcount()) > 0)
-    {
-        aResponse->write(&buffer[0], readLength);
-        if (readLength == static_cast<std::streamsize>(buffer.size()))
+    rval = pread(aSource->mFd, boost::asio::buffer_cast<char *>(streambuf.prepare(size)), size, aSource->mOffset);
+    VerifyOrExit(rval > 0, otbrLog(OTBR_LOG_WARNING, "failed to read static file: %s", strerror(errno)));
+
+    streambuf.commit(static_cast<size_t>(rval));
+    aSource->mOffset += rval;
+
+    // The last chunk is written once the response is released.
+    VerifyOrExit(aSource->mOffset < aSource->mLength);
+
+    aServer.send(aResponse, [&aServer, aResponse, aSource](const boost::system::error_code &ec) {
+        if (!ec)
         {
-            aServer.send(aResponse, [&aServer, aResponse, aIfStream](const boost::system::error_code &ec) {
-                if (!ec)
-                {
-                    DefaultResourceSend(aServer, aResponse, aIfStream);
-                }
-                else
-                {
-                    std::cerr << "Connection interrupted" << std::endl;
-                }
-            });
+            SendFile(aServer, aResponse, aSource);
         }
-    }
+        else
+        {
+            std::cerr << "Connection interrupted" << std::endl;
+        }
+    });
+
+exit:
+    return;
 }
 
 void WebServer::DefaultHttpResponse(void)
 {
+    // Requests of the API are routed before the static files, POST requests only go to the API.
+    mServer->default_resource[OT_REQUEST_METHOD_POST] = [this](std::shared_ptr<HttpServer::Response> response,
+                                                               std::shared_ptr<HttpServer::Request>  request) {
+        const HttpHandler *handler = mRouter->Find(request->method, request->path);
+
+        if (handler == NULL)
+        {
+            sNotFound.Add();
+            WriteResponse(*response, "Unknown request " + request->path, true);
+            return;
+        }
+
+        (*handler)(response, request);
+    };
+
     mServer->default_resource[OT_REQUEST_METHOD_GET] = [this](std::shared_ptr<HttpServer::Response> response,
                                                               std::shared_ptr<HttpServer::Request>  request) {
+        const HttpHandler *handler = mRouter->Find(request->method, request->path);
+
+        if (handler != NULL)
+        {
+            (*handler)(response, request);
+            return;
+        }
+
+        if (mStaticAssets->Respond(*request, *response))
+        {
+            return;
+        }
+
+#if OTBR_ENABLE_EMBEDDED_WEB_ASSETS
+        // All the files are compiled in, the filesystem is never looked up.
+        {
+            std::string content = "Not found " + request->path;
+
+            sNotFound.Add();
+            *response << OT_RESPONSE_NOT_FOUND_STATUS << OT_RESPONSE_HEADER_LENGTH << content.length()
+                      << OT_RESPONSE_PLACEHOLD << content;
+        }
+#else
         try
         {
             auto webRootPath = boost::filesystem::canonical(WEB_FILE_PATH);
@@ -167,10 +1333,6 @@ void WebServer::DefaultHttpResponse(void)
                 throw std::invalid_argument("file does not exist");
             }
 
-            std::string cacheControl, etag;
-
-            auto ifs = std::make_shared<std::ifstream>();
-            ifs->open(path.string(), std::ifstream::in | std::ios::binary | std::ios::ate);
             std::string extension = boost::filesystem::extension(path.string());
             std::string style     = "";
             if (extension == ".css")
@@ -178,27 +1340,36 @@ void WebServer::DefaultHttpResponse(void)
                 style = OT_RESPONSE_HEADER_CSS_TYPE;
             }
 
-            if (*ifs)
+            int         fd = open(path.string().c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat st;
+
+            if (fd < 0)
             {
-                auto length = ifs->tellg();
-                ifs->seekg(0, std::ios::beg);
+                throw std::invalid_argument("could not read file");
+            }
 
-                *response << OT_RESPONSE_SUCCESS_STATUS << cacheControl << etag << OT_RESPONSE_HEADER_LENGTH << length
-                          << style << OT_RESPONSE_PLACEHOLD;
+            auto source = std::make_shared<FileSource>(fd);
 
-                DefaultResourceSend(*mServer, response, ifs);
-            }
-            else
+            if (fstat(fd, &st) != 0)
             {
                 throw std::invalid_argument("could not read file");
             }
 
+            source->mLength = st.st_size;
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+            *response << OT_RESPONSE_SUCCESS_STATUS << OT_RESPONSE_HEADER_LENGTH << source->mLength << style
+                      << OT_RESPONSE_PLACEHOLD;
+
+            SendFile(*mServer, response, source);
+
         } catch (const std::exception &e)
         {
             std::string content = "Could not open path " + request->path + ": " + e.what();
             *response << OT_RESPONSE_FAILURE_STATUS << OT_RESPONSE_HEADER_LENGTH << content.length()
                       << OT_RESPONSE_PLACEHOLD << content;
         }
+#endif
     };
 }
 
@@ -216,6 +1387,22 @@ std::string WebServer::HandleFormNetworkRequest(const std::string &aFormRequest,
     return webServer->HandleFormNetworkRequest(aFormRequest);
 }
 
+std::string WebServer::PrecomputeFormPskc(const std::string &aFormRequest, void *aUserData)
+{
+    WebServer *webServer = static_cast<WebServer *>(aUserData);
+
+    webServer->mWpanService.PrecomputePskc(aFormRequest);
+
+    return std::string();
+}
+
+std::string WebServer::HandleBatchRequest(const std::string &aBatchRequest, void *aUserData)
+{
+    WebServer *webServer = static_cast<WebServer *>(aUserData);
+
+    return webServer->HandleBatchRequest(aBatchRequest);
+}
+
 std::string WebServer::HandleAddPrefixRequest(const std::string &aAddPrefixRequest, void *aUserData)
 {
     WebServer *webServer = static_cast<WebServer *>(aUserData);
@@ -230,6 +1417,13 @@ std::string WebServer::HandleDeletePrefixRequest(const std::string &aDeletePrefi
     return webServer->HandleDeletePrefixRequest(aDeletePrefixRequest);
 }
 
+std::string WebServer::HandleSetPrefixesRequest(const std::string &aSetPrefixesRequest, void *aUserData)
+{
+    WebServer *webServer = static_cast<WebServer *>(aUserData);
+
+    return webServer->HandleSetPrefixesRequest(aSetPrefixesRequest);
+}
+
 std::string WebServer::HandleGetStatusRequest(const std::string &aGetStatusRequest, void *aUserData)
 {
     WebServer *webServer = static_cast<WebServer *>(aUserData);
@@ -245,34 +1439,182 @@ std::string WebServer::HandleGetAvailableNetworkResponse(const std::string &aGet
     return webServer->HandleGetAvailableNetworkResponse(aGetAvailableNetworkRequest);
 }
 
+std::string WebServer::HandleMetricsRequest(const std::string &aMetricsRequest, void *aUserData)
+{
+    std::string metrics;
+
+    (void)aMetricsRequest;
+    (void)aUserData;
+    BorderRouter::Metrics::Export(metrics);
+
+    return metrics;
+}
+
 void WebServer::ResponseJoinNetwork(void)
 {
-    HandleHttpRequest(OT_JOIN_NETWORK_PATH, OT_REQUEST_METHOD_POST, HandleJoinNetworkRequest);
+    HandleWpanRequest(OT_JOIN_NETWORK_PATH, OT_REQUEST_METHOD_POST, HandleJoinNetworkRequest);
 }
 
 void WebServer::ResponseFormNetwork(void)
 {
-    HandleHttpRequest(OT_FORM_NETWORK_PATH, OT_REQUEST_METHOD_POST, HandleFormNetworkRequest);
+    // The PSKc is derived off the WPAN worker, which takes long without AES acceleration.
+    HandleWpanRequest(OT_FORM_NETWORK_PATH, OT_REQUEST_METHOD_POST, HandleFormNetworkRequest, PrecomputeFormPskc);
 }
 
 void WebServer::ResponseAddOnMeshPrefix(void)
 {
-    HandleHttpRequest(OT_ADD_PREFIX_PATH, OT_REQUEST_METHOD_POST, HandleAddPrefixRequest);
+    HandleWpanRequest(OT_ADD_PREFIX_PATH, OT_REQUEST_METHOD_POST, HandleAddPrefixRequest);
 }
 
 void WebServer::ResponseDeleteOnMeshPrefix(void)
 {
-    HandleHttpRequest(OT_DELETE_PREFIX_PATH, OT_REQUEST_METHOD_POST, HandleDeletePrefixRequest);
+    HandleWpanRequest(OT_DELETE_PREFIX_PATH, OT_REQUEST_METHOD_POST, HandleDeletePrefixRequest);
+}
+
+void WebServer::ResponseSetOnMeshPrefixes(void)
+{
+    HandleWpanRequest(OT_SET_PREFIXES_PATH, OT_REQUEST_METHOD_POST, HandleSetPrefixesRequest);
 }
 
 void WebServer::ResponseGetStatus(void)
 {
-    HandleHttpRequest(OT_GET_NETWORK_PATH, OT_REQUEST_METHOD_GET, HandleGetStatusRequest);
+    HandleWpanRequest(OT_GET_NETWORK_PATH, OT_REQUEST_METHOD_GET, HandleGetStatusRequest);
+
+    HttpHandler fetchStatus = *mRouter->Find(OT_REQUEST_METHOD_GET, OT_GET_NETWORK_PATH);
+
+    // The snapshot is served from the server thread, only a missing one is fetched from wpantund. Clients polling it
+    // revalidate their copy by its ETag, and may ask with "?delta=1" for the changes since their version.
+    HttpHandler handler =
+        [fetchStatus, this](std::shared_ptr<HttpServer::Response> response,
+                            std::shared_ptr<HttpServer::Request>  request) {
+            auto        ifNoneMatch = request->header.find("If-None-Match");
+            bool        delta       = HasQueryFlag(request->path, "delta");
+            std::string status, etag;
+
+            if (!mWpanService.GetStatusSnapshot(ifNoneMatch != request->header.end() ? ifNoneMatch->second : "",
+                                                delta, status, etag))
+            {
+                fetchStatus(response, request);
+                return;
+            }
+
+            if (status.empty())
+            {
+                *response << OT_RESPONSE_NOT_MODIFIED_STATUS "ETag: " << etag
+                          << "\r\nCache-Control: no-cache" OT_RESPONSE_PLACEHOLD;
+                sStatusNotModified.Add();
+            }
+            else
+            {
+                sJsonHeader.Write(*response, status, false, &etag);
+            }
+
+            sRequests.Add();
+            sStatusSnapshots.Add();
+        };
+
+    mRouter->Add(OT_REQUEST_METHOD_GET, OT_GET_NETWORK_PATH, handler);
 }
 
 void WebServer::ResponseGetAvailableNetwork(void)
 {
-    HandleHttpRequest(OT_AVAILABLE_NETWORK_PATH, OT_REQUEST_METHOD_GET, HandleGetAvailableNetworkResponse);
+    HandleWpanRequest(OT_AVAILABLE_NETWORK_PATH, OT_REQUEST_METHOD_GET, HandleGetAvailableNetworkResponse);
+
+    HttpHandler scanNetworks = *mRouter->Find(OT_REQUEST_METHOD_GET, OT_AVAILABLE_NETWORK_PATH);
+
+    // Recently scanned networks are served at once, and refreshed by a scan on the worker once they get old.
+    HttpHandler handler =
+        [scanNetworks, this](std::shared_ptr<HttpServer::Response> response,
+                             std::shared_ptr<HttpServer::Request>  request) {
+            std::string networks;
+            bool        refresh;
+
+            if (!mWpanWorker.IsRunning() || !mWpanService.GetAvailableNetworkSnapshot(networks, refresh))
+            {
+                scanNetworks(response, request);
+                return;
+            }
+
+            if (refresh)
+            {
+                mWpanWorker.Submit(mScanRefreshJob);
+            }
+
+            WriteResponse(*response, networks, false);
+            sRequests.Add();
+            sScanSnapshots.Add();
+        };
+
+    mRouter->Add(OT_REQUEST_METHOD_GET, OT_AVAILABLE_NETWORK_PATH, handler);
+}
+
+void WebServer::ResponseStreamAvailableNetwork(void)
+{
+    HttpHandler handler =
+        [this](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request) {
+            ScanRequest *                     scanRequest = NULL;
+            std::shared_ptr<StreamedResponse> stream;
+
+            // Without the worker the scan would block the server thread, the networks are returned at once.
+            if (!mWpanWorker.IsRunning())
+            {
+                RespondNow(sJsonHeader, HandleGetAvailableNetworkResponse, this, *response, request->content.string());
+                return;
+            }
+
+            scanRequest      = new ScanRequest(*this, response);
+            stream           = scanRequest->mStream;
+            stream->mPending = OT_RESPONSE_SUCCESS_STATUS OT_RESPONSE_HEADER_JSON_LINES OT_RESPONSE_PLACEHOLD;
+
+            {
+                std::lock_guard<std::mutex> lock(mStreamMutex);
+
+                SendStreamed(stream);
+            }
+
+            // Each network is written as a line of JSON as its beacon is received, the last line is the scan result.
+            mWpanWorker.Submit(scanRequest->mJob);
+        };
+
+    mRouter->Add(OT_REQUEST_METHOD_GET, OT_AVAILABLE_NETWORK_STREAM_PATH, handler);
+}
+
+void WebServer::ResponseMetrics(void)
+{
+    HandleHttpRequest(OT_METRICS_PATH, OT_REQUEST_METHOD_GET, HandleMetricsRequest,
+                      BorderRouter::Metrics::kExportContentType);
+}
+
+void WebServer::ResponseBatch(void)
+{
+    // The operations run in order as one request of the WPAN worker.
+    HandleWpanRequest(OT_BATCH_PATH, OT_REQUEST_METHOD_POST, HandleBatchRequest);
+}
+
+void WebServer::ResponseStatusEvents(void)
+{
+    HttpHandler handler =
+        [this](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request>) {
+            std::shared_ptr<StreamedResponse> subscriber;
+            std::lock_guard<std::mutex>       lock(mStreamMutex);
+
+            if (!mStatusWatched || mStatusSubscribers.size() >= kMaxStatusSubscribers)
+            {
+                WriteResponse(*response, "status events unavailable", true);
+                return;
+            }
+
+            // The stream has no length, so it ends by closing the connection. Clients reconnect once the server
+            // closes it at its content timeout, and should get the status again as changes may be missed meanwhile.
+            response->close_connection_after_response = true;
+            subscriber                                = std::make_shared<StreamedResponse>(response);
+            subscriber->mPending = OT_RESPONSE_SUCCESS_STATUS OT_RESPONSE_HEADER_EVENT_STREAM OT_RESPONSE_PLACEHOLD;
+            mStatusSubscribers.push_back(subscriber);
+            SendStreamed(subscriber);
+            sRequests.Add();
+        };
+
+    mRouter->Add(OT_REQUEST_METHOD_GET, OT_STATUS_EVENTS_PATH, handler);
 }
 
 std::string WebServer::HandleJoinNetworkRequest(const std::string &aJoinRequest)
@@ -295,6 +1637,11 @@ std::string WebServer::HandleDeletePrefixRequest(const std::string &aDeletePrefi
     return mWpanService.HandleDeletePrefixRequest(aDeletePrefixRequest);
 }
 
+std::string WebServer::HandleSetPrefixesRequest(const std::string &aSetPrefixesRequest)
+{
+    return mWpanService.HandleSetPrefixesRequest(aSetPrefixesRequest);
+}
+
 std::string WebServer::HandleGetStatusRequest(const std::string &aGetStatusRequest)
 {
     (void)aGetStatusRequest;
@@ -307,5 +1654,10 @@ std::string WebServer::HandleGetAvailableNetworkResponse(const std::string &aGet
     return mWpanService.HandleAvailableNetworkRequest();
 }
 
+std::string WebServer::HandleBatchRequest(const std::string &aBatchRequest)
+{
+    return mWpanService.HandleBatchRequest(aBatchRequest);
+}
+
 } // namespace Web
 } // namespace ot
@@ -37,15 +37,25 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <net/if.h>
 #include <syslog.h>
 
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
 
+#include "interface_table.hpp"
 #include "wpan_service.hpp"
+#include "../wpan-controller/dbus_prop_watch.hpp"
+#include "common/capacity.hpp"
+#include "common/worker_pool.hpp"
 
 namespace SimpleWeb {
 template <class T> class Server;
@@ -57,6 +67,10 @@ namespace Web {
 
 typedef SimpleWeb::Server<SimpleWeb::HTTP> HttpServer;
 
+class ActivatedHttpServer;
+class ApiRouter;
+class StaticAssetCache;
+
 /**
  * This class implements the http server.
  *
@@ -79,43 +93,212 @@ public:
     /**
      * This method starts the Web Server.
      *
+     * Requests to the WPAN service run one at a time on a worker thread, and their responses are completed on the
+     * server thread, so that D-Bus calls to wpantund, e.g. scans, do not block other http requests.
+     *
+     * While the property changes of wpantund are watched, the status is served from a snapshot kept up to date by
+     * them, and the changes are pushed to the clients of the status event stream.
+     *
+     * The addresses and link state of the interface are reported from a rtnetlink subscription of its own, their
+     * changes are pushed to the clients of the status event stream as well.
+     *
+     * Static files are loaded into memory before the server starts, files added later are read from disk. With
+     * OTBR_ENABLE_EMBEDDED_WEB_ASSETS, they are only served from the copies compiled into the binary.
+     *
      * @param[in]  aIfName  The pointer to the interface name of wpantund.
      * @param[in]  aPort    The port of http server.
      *
      */
     void StartWebServer(const char *aIfName, uint16_t aPort);
 
+    /**
+     * This method sets the number of threads serving http requests.
+     *
+     * Requests to the WPAN service still run one at a time, static files and snapshots are served in parallel.
+     * This method must be called before StartWebServer().
+     *
+     * @param[in]  aSize  The number of threads, at least 1.
+     *
+     */
+    void SetThreadPoolSize(size_t aSize);
+
+    /**
+     * This method sets a socket to listen on instead of binding the port, e.g. one passed by systemd.
+     *
+     * This method must be called before StartWebServer().
+     *
+     * @param[in]  aFd  The file descriptor of a bound and listening TCP socket, -1 to bind the port.
+     *
+     */
+    void SetListenSocket(int aFd);
+
+    /**
+     * This method sets the time without connection after which a server listening on a passed socket stops.
+     *
+     * StartWebServer() then returns, the socket is left open for systemd to start the server on the next connection.
+     * This method must be called before StartWebServer().
+     *
+     * @param[in]  aTimeout  The idle timeout in seconds, 0 to never stop.
+     *
+     */
+    void SetIdleTimeout(uint32_t aTimeout);
+
+    /**
+     * This method sets the max number of connections, those beyond are answered 503 and closed.
+     *
+     * This method must be called before StartWebServer().
+     *
+     * @param[in]  aMaxConnections  The max number of connections, 0 for no limit.
+     *
+     */
+    void SetMaxConnections(size_t aMaxConnections);
+
+    /**
+     * This method sets the time to receive the header of a request, including the wait for the next one on a kept
+     * alive connection.
+     *
+     * This method must be called before StartWebServer().
+     *
+     * @param[in]  aTimeout  The timeout in seconds, 0 to never time out.
+     *
+     */
+    void SetRequestTimeout(uint32_t aTimeout);
+
+    /**
+     * This method sets the time to receive the content of a request, and to send its response.
+     *
+     * The status event streams end at this timeout, their clients reconnect. This method must be called before
+     * StartWebServer().
+     *
+     * @param[in]  aTimeout  The timeout in seconds, 0 to never time out.
+     *
+     */
+    void SetContentTimeout(uint32_t aTimeout);
+
+    /**
+     * This method sets the max size of a request, header and content.
+     *
+     * Requests with a larger content are answered 413, those with a larger header are dropped. This method must be
+     * called before StartWebServer().
+     *
+     * @param[in]  aSize  The max size in bytes.
+     *
+     */
+    void SetMaxRequestSize(size_t aSize);
+
 private:
     typedef std::string (*HttpRequestCallback)(const std::string &aRequest, void *aUserData);
     static std::string HandleJoinNetworkRequest(const std::string &aJoinRequest, void *aUserData);
     static std::string HandleFormNetworkRequest(const std::string &aFormRequest, void *aUserData);
+    static std::string PrecomputeFormPskc(const std::string &aFormRequest, void *aUserData);
     static std::string HandleAddPrefixRequest(const std::string &aAddPrefixRequest, void *aUserData);
     static std::string HandleDeletePrefixRequest(const std::string &aDeletePrefixRequest, void *aUserData);
+    static std::string HandleSetPrefixesRequest(const std::string &aSetPrefixesRequest, void *aUserData);
     static std::string HandleGetStatusRequest(const std::string &aGetStatusRequest, void *aUserData);
     static std::string HandleGetAvailableNetworkResponse(const std::string &aGetAvailableNetworkRequest,
                                                          void *             aUserData);
+    static std::string HandleMetricsRequest(const std::string &aMetricsRequest, void *aUserData);
+    static std::string HandleBatchRequest(const std::string &aBatchRequest, void *aUserData);
 
     std::string HandleJoinNetworkRequest(const std::string &aJoinRequest);
     std::string HandleFormNetworkRequest(const std::string &aFormRequest);
     std::string HandleAddPrefixRequest(const std::string &aAddPrefixRequest);
     std::string HandleDeletePrefixRequest(const std::string &aDeletePrefixRequest);
+    std::string HandleSetPrefixesRequest(const std::string &aSetPrefixesRequest);
     std::string HandleGetStatusRequest(const std::string &aGetStatusRequest);
     std::string HandleGetAvailableNetworkResponse(const std::string &aGetAvailableNetworkRequest);
+    std::string HandleBatchRequest(const std::string &aBatchRequest);
+
+    /**
+     * This struct represents an http request waiting for the WPAN service.
+     *
+     */
+    struct WpanRequest;
+
+    static void RunWpanRequest(void *aContext);
+    static void CompleteWpanRequest(void *aContext);
+    static void RunPrepareRequest(void *aContext);
+    static void CompletePrepareRequest(void *aContext);
+    void        WaitWorker(BorderRouter::WorkerPool &aWorker, boost::asio::posix::stream_descriptor &aWorkerFd);
+    void        WaitInterface(void);
+
+    /**
+     * This struct represents an http response streamed as its content becomes available.
+     *
+     */
+    struct StreamedResponse;
 
-    void HandleHttpRequest(const char *aUrl, const char *aMethod, HttpRequestCallback aCallback);
+    /**
+     * This struct represents a scan streaming the networks found to an http client.
+     *
+     */
+    struct ScanRequest;
+
+    static void RunScanRequest(void *aContext);
+    static void CompleteScanRequest(void *aContext);
+    static void HandleScanNetwork(const std::string &aNetwork, void *aContext);
+    static void RunScanRefresh(void *aContext);
+    static void CompleteScanRefresh(void *aContext);
+
+    static void HandlePropertyChanged(const char *aName, const char *aValue, void *aContext);
+    void        HandlePropertyChanged(const char *aName, const char *aValue);
+    void        WatchProperties(void);
+    void        PushStatusEvent(const std::string &aEvent);
+    void        SendStreamed(const std::shared_ptr<StreamedResponse> &aStream);
+
+    void HandleHttpRequest(const char *        aUrl,
+                           const char *        aMethod,
+                           HttpRequestCallback aCallback,
+                           const char *        aContentType);
+    void HandleWpanRequest(const char *        aUrl,
+                           const char *        aMethod,
+                           HttpRequestCallback aCallback,
+                           HttpRequestCallback aPrepare = NULL);
     void ResponseJoinNetwork(void);
     void ResponseFormNetwork(void);
     void ResponseAddOnMeshPrefix(void);
     void ResponseDeleteOnMeshPrefix(void);
+    void ResponseSetOnMeshPrefixes(void);
     void ResponseGetStatus(void);
     void ResponseGetAvailableNetwork(void);
+    void ResponseStreamAvailableNetwork(void);
+    void ResponseMetrics(void);
+    void ResponseStatusEvents(void);
+    void ResponseBatch(void);
     void DefaultHttpResponse(void);
 
     void Init(void);
 
-    char                 mIfName[IFNAMSIZ];
-    HttpServer *         mServer;
-    ot::Web::WpanService mWpanService;
+    enum
+    {
+        kMaxStatusSubscribers = OTBR_CAPACITY_STATUS_SUBSCRIBERS, ///< Max number of clients of the status event stream.
+    };
+
+    enum
+    {
+        kPropWatchTimeout     = 1000,  ///< Max time in milliseconds the property watch waits before checking for stop.
+        kMaxStatusPending     = 16384, ///< Max bytes of events waiting to be sent to a client, before it is dropped.
+        kMaxRequestSize       = 65536, ///< Default max bytes of a request, header and content.
+    };
+
+    char                                         mIfName[IFNAMSIZ];
+    ActivatedHttpServer *                        mServer;
+    StaticAssetCache *                           mStaticAssets;
+    ApiRouter *                                  mRouter; ///< Routes the requests of the API.
+    ot::Web::WpanService                         mWpanService;
+    BorderRouter::WorkerPool                     mWpanWorker;      ///< Runs WPAN service requests.
+    BorderRouter::WorkerPool::Job                mScanRefreshJob;  ///< Refreshes the scanned networks.
+    boost::asio::posix::stream_descriptor *      mWpanWorkerFd;    ///< Notifies the server of completed requests.
+    BorderRouter::WorkerPool                     mPrepareWorker;   ///< Prepares requests without the WPAN service.
+    boost::asio::posix::stream_descriptor *      mPrepareWorkerFd; ///< Notifies the server of prepared requests.
+    InterfaceTable                               mInterfaceTable; ///< The addresses and link state of the interface.
+    boost::asio::posix::stream_descriptor *      mInterfaceFd;    ///< Notifies the server of interface changes.
+    ot::Dbus::DBusPropWatch                      mPropWatch;    ///< Receives the property changes of wpantund.
+    std::thread                                  mPropWatchThread;
+    std::atomic<bool>                            mPropWatchStopping;
+    std::atomic<bool>                            mStatusWatched; ///< Whether the property changes are received.
+    std::list<std::shared_ptr<StreamedResponse>> mStatusSubscribers;
+    std::mutex                                   mStreamMutex; ///< Guards the streamed responses and subscribers.
 };
 
 } // namespace Web
@@ -31,251 +31,361 @@
  *   This file implements the wpan controller service
  */
 
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_WEB
+
 #include "wpan_service.hpp"
 
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <strings.h>
+
 #include "common/code_utils.hpp"
+#include "common/time.hpp"
+
+#include "../wpan-controller/dbus_get.hpp"
 
 namespace ot {
 namespace Web {
 
-std::string WpanService::HandleJoinNetworkRequest(const std::string &aJoinRequest)
+static const char *const kStatusProperties[] = {kWPANTUNDProperty_NCPState,
+                                                kWPANTUNDProperty_DaemonEnabled,
+                                                kWPANTUNDProperty_NCPVersion,
+                                                kWPANTUNDProperty_DaemonVersion,
+                                                kWPANTUNDProperty_ConfigNCPDriverName,
+                                                kWPANTUNDProperty_NCPHardwareAddress,
+                                                kWPANTUNDProperty_NCPChannel,
+                                                kWPANTUNDProperty_NetworkNodeType,
+                                                kWPANTUNDProperty_NetworkName,
+                                                kWPANTUNDProperty_NetworkXPANID,
+                                                kWPANTUNDProperty_NetworkPANID,
+                                                kWPANTUNDProperty_IPv6LinkLocalAddress,
+                                                kWPANTUNDProperty_IPv6MeshLocalAddress,
+                                                kWPANTUNDProperty_IPv6MeshLocalPrefix};
+
+// The status properties reported by the interface table while it is valid.
+static const char *const kInterfaceProperties[] = {kWPANTUNDProperty_IPv6LinkLocalAddress,
+                                                   kWPANTUNDProperty_IPv6MeshLocalAddress};
+
+static const char kLinkStateKey[]    = "Link state";
+static const char kIp6AddressesKey[] = "IPv6 addresses";
+
+bool WpanService::ParseRequest(const std::string &aRequest, const JsonReader::Field *aFields, size_t aCount)
 {
-    char extPanId[OT_EXTENDED_PANID_LENGTH * 2 + 1];
+    Json::Value  root;
+    Json::Reader reader;
+    bool         ok = true;
 
-    Json::Value              root;
-    Json::Reader             reader;
-    Json::FastWriter         jsonWriter;
-    std::string              response;
-    int                      index;
-    std::string              networkKey;
-    std::string              prefix;
-    bool                     defaultRoute;
-    int                      ret = ot::Dbus::kWpantundStatus_Ok;
-    ot::Dbus::WPANController wpanController;
-
-    VerifyOrExit(reader.parse(aJoinRequest.c_str(), root) == true, ret = kWpanStatus_ParseRequestFailed);
-    index        = root["index"].asUInt();
-    networkKey   = root["networkKey"].asString();
-    prefix       = root["prefix"].asString();
-    defaultRoute = root["defaultRoute"].asBool();
-
-    wpanController.SetInterfaceName(mIfName);
-    VerifyOrExit(wpanController.Leave() == ot::Dbus::kWpantundStatus_Ok, ret = ot::Dbus::kWpantundStatus_LeaveFailed);
-    VerifyOrExit(wpanController.Set(kPropertyType_Data, "NetworkKey", networkKey.c_str()) ==
-                     ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_SetFailed);
-    VerifyOrExit(wpanController.Join(mNetworks[index].mNetworkName, mNetworks[index].mChannel,
-                                     mNetworks[index].mExtPanId,
-                                     mNetworks[index].mPanId) == ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_JoinFailed);
-    VerifyOrExit(wpanController.AddGateway(prefix.c_str(), defaultRoute) == ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_SetGatewayFailed);
+    // The requests are flat objects of plain values, only others are parsed by jsoncpp.
+    VerifyOrExit(!JsonReader::Parse(aRequest.data(), aRequest.size(), aFields, aCount));
+    VerifyOrExit(reader.parse(aRequest.c_str(), root), ok = false);
+
+    for (size_t i = 0; i < aCount; i++)
+    {
+        switch (aFields[i].mType)
+        {
+        case JsonReader::kTypeString:
+            *static_cast<std::string *>(aFields[i].mValue) = root[aFields[i].mName].asString();
+            break;
+        case JsonReader::kTypeUnsigned:
+            *static_cast<unsigned int *>(aFields[i].mValue) = root[aFields[i].mName].asUInt();
+            break;
+        case JsonReader::kTypeBool:
+            *static_cast<bool *>(aFields[i].mValue) = root[aFields[i].mName].asBool();
+            break;
+        }
+    }
 
-    ot::Utils::Long2Hex(mNetworks[index].mExtPanId, extPanId);
 exit:
+    return ok;
+}
 
-    root.clear();
-    root["result"] = mResponseSuccess;
+std::string WpanService::WriteResult(int aError) const
+{
+    std::string response;
+    JsonWriter  writer(response);
 
-    root["error"] = ret;
-    if (ret != ot::Dbus::kWpantundStatus_Ok)
+    if (aError != ot::Dbus::kWpantundStatus_Ok)
     {
-        otbrLog(OTBR_LOG_ERR, "wpan service error: %d", ret);
-        root["result"] = mResponseFail;
+        otbrLog(OTBR_LOG_ERR, "wpan service error: %d", aError);
     }
-    response = jsonWriter.write(root);
+
+    writer.BeginObject();
+    writer.Key("result");
+    writer.String(aError == ot::Dbus::kWpantundStatus_Ok ? mResponseSuccess : mResponseFail);
+    writer.Key("error");
+    writer.Int(aError);
+    writer.EndObject();
+
     return response;
 }
 
+std::string WpanService::HandleJoinNetworkRequest(const std::string &aJoinRequest)
+{
+    std::lock_guard<std::mutex> lock(mRequestMutex);
+
+    const JsonReader::Field kFields[] = {
+        {"index", JsonReader::kTypeUnsigned, &mRequest.mIndex},
+        {"networkKey", JsonReader::kTypeString, &mRequest.mNetworkKey},
+        {"prefix", JsonReader::kTypeString, &mRequest.mPrefix},
+        {"defaultRoute", JsonReader::kTypeBool, &mRequest.mDefaultRoute},
+        {"extPanId", JsonReader::kTypeString, &mRequest.mExtPanId},
+    };
+    ot::Dbus::WPANController::Transaction transaction(mWpanController);
+    ot::Dbus::WpanNetworkInfo             network;
+    char                                  extPanId[OT_EXTENDED_PANID_LENGTH * 2 + 1];
+    int                                   ret = ot::Dbus::kWpantundStatus_Ok;
+
+    VerifyOrExit(ParseRequest(aJoinRequest, kFields, sizeof(kFields) / sizeof(kFields[0])),
+                 ret = kWpanStatus_ParseRequestFailed);
+    VerifyOrExit(FindScannedNetwork(mRequest.mExtPanId, mRequest.mIndex, network),
+                 ret = ot::Dbus::kWpantundStatus_NetworkNotFound);
+
+    transaction.Leave();
+    transaction.Set(kPropertyType_Data, "NetworkKey", mRequest.mNetworkKey.c_str());
+    transaction.Join(network.mNetworkName, network.mChannel, network.mExtPanId, network.mPanId);
+    transaction.AddGateway(mRequest.mPrefix.c_str(), mRequest.mDefaultRoute);
+    VerifyOrExit(transaction.Commit() == ot::Dbus::kWpantundStatus_Ok, ret = transaction.GetFailure());
+
+    ot::Utils::Long2Hex(network.mExtPanId, extPanId);
+exit:
+    return WriteResult(ret);
+}
+
 std::string WpanService::HandleFormNetworkRequest(const std::string &aFormRequest)
 {
-    Json::Value              root;
-    Json::FastWriter         jsonWriter;
-    Json::Reader             reader;
-    std::string              response;
-    ot::Psk::Pskc            psk;
-    char                     pskcStr[OT_PSKC_MAX_LENGTH * 2];
-    uint8_t                  extPanIdBytes[OT_EXTENDED_PANID_LENGTH];
-    ot::Dbus::WPANController wpanController;
-    std::string              networkKey;
-    std::string              prefix;
-    uint16_t                 channel;
-    std::string              networkName;
-    std::string              passphrase;
-    std::string              panId;
-    std::string              extPanId;
-    bool                     defaultRoute;
-    int                      ret = ot::Dbus::kWpantundStatus_Ok;
-
-    VerifyOrExit(reader.parse(aFormRequest.c_str(), root) == true, ret = kWpanStatus_ParseRequestFailed);
-    networkKey   = root["networkKey"].asString();
-    prefix       = root["prefix"].asString();
-    channel      = root["channel"].asUInt();
-    networkName  = root["networkName"].asString();
-    passphrase   = root["passphrase"].asString();
-    panId        = root["panId"].asString();
-    extPanId     = root["extPanId"].asString();
-    defaultRoute = root["defaultRoute"].asBool();
-
-    wpanController.SetInterfaceName(mIfName);
-    VerifyOrExit(wpanController.Leave() == ot::Dbus::kWpantundStatus_Ok, ret = ot::Dbus::kWpantundStatus_LeaveFailed);
-
-    VerifyOrExit(wpanController.Set(kPropertyType_Data, kWPANTUNDProperty_NetworkKey, networkKey.c_str()) ==
-                     ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_SetFailed);
-
-    VerifyOrExit(wpanController.Set(kPropertyType_String, kWPANTUNDProperty_NetworkPANID, panId.c_str()) ==
-                     ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_SetFailed);
-    VerifyOrExit(wpanController.Set(kPropertyType_Data, kWPANTUNDProperty_NetworkXPANID, extPanId.c_str()) ==
-                     ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_SetFailed);
-    ot::Utils::Hex2Bytes(extPanId.c_str(), extPanIdBytes, OT_EXTENDED_PANID_LENGTH);
-    ot::Utils::Bytes2Hex(psk.ComputePskc(extPanIdBytes, networkName.c_str(), passphrase.c_str()), OT_PSKC_MAX_LENGTH,
-                         pskcStr);
-    VerifyOrExit(wpanController.Set(kPropertyType_Data, kWPANTUNDProperty_NetworkPSKc, pskcStr) ==
-                     ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_SetFailed);
-
-    VerifyOrExit(wpanController.Form(networkName.c_str(), channel) == ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_FormFailed);
-
-    VerifyOrExit(wpanController.AddGateway(prefix.c_str(), defaultRoute) == ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_SetGatewayFailed);
+    std::lock_guard<std::mutex> lock(mRequestMutex);
+
+    const JsonReader::Field kFields[] = {
+        {"networkKey", JsonReader::kTypeString, &mRequest.mNetworkKey},
+        {"prefix", JsonReader::kTypeString, &mRequest.mPrefix},
+        {"channel", JsonReader::kTypeUnsigned, &mRequest.mChannel},
+        {"networkName", JsonReader::kTypeString, &mRequest.mNetworkName},
+        {"passphrase", JsonReader::kTypeString, &mRequest.mPassphrase},
+        {"panId", JsonReader::kTypeString, &mRequest.mPanId},
+        {"extPanId", JsonReader::kTypeString, &mRequest.mExtPanId},
+        {"defaultRoute", JsonReader::kTypeBool, &mRequest.mDefaultRoute},
+    };
+    ot::Dbus::WPANController::Transaction transaction(mWpanController);
+    ot::Psk::Pskc                         psk;
+    char                                  pskcStr[OT_PSKC_MAX_LENGTH * 2];
+    uint8_t                               extPanIdBytes[OT_EXTENDED_PANID_LENGTH];
+    uint16_t                              channel;
+    int                                   ret = ot::Dbus::kWpantundStatus_Ok;
+
+    VerifyOrExit(ParseRequest(aFormRequest, kFields, sizeof(kFields) / sizeof(kFields[0])),
+                 ret = kWpanStatus_ParseRequestFailed);
+    channel = static_cast<uint16_t>(mRequest.mChannel);
+
+    transaction.Leave();
+    transaction.Set(kPropertyType_Data, kWPANTUNDProperty_NetworkKey, mRequest.mNetworkKey.c_str());
+    transaction.Set(kPropertyType_String, kWPANTUNDProperty_NetworkPANID, mRequest.mPanId.c_str());
+    transaction.Set(kPropertyType_Data, kWPANTUNDProperty_NetworkXPANID, mRequest.mExtPanId.c_str());
+    ot::Utils::Hex2Bytes(mRequest.mExtPanId.c_str(), mRequest.mExtPanId.size(), extPanIdBytes,
+                         OT_EXTENDED_PANID_LENGTH);
+    ot::Utils::Bytes2Hex(
+        psk.ComputePskc(extPanIdBytes, mRequest.mNetworkName.c_str(), mRequest.mPassphrase.c_str()),
+        OT_PSKC_MAX_LENGTH, pskcStr);
+    transaction.Set(kPropertyType_Data, kWPANTUNDProperty_NetworkPSKc, pskcStr);
+    transaction.Form(mRequest.mNetworkName.c_str(), channel);
+    transaction.AddGateway(mRequest.mPrefix.c_str(), mRequest.mDefaultRoute);
+
+    // Nothing is sent if a step is invalid, so the current network is not left for a request bound to fail.
+    VerifyOrExit(transaction.Commit() == ot::Dbus::kWpantundStatus_Ok, ret = transaction.GetFailure());
 exit:
+    return WriteResult(ret);
+}
 
-    root.clear();
+void WpanService::PrecomputePskc(const std::string &aFormRequest) const
+{
+    std::string             networkName, passphrase, extPanId;
+    const JsonReader::Field kFields[] = {
+        {"networkName", JsonReader::kTypeString, &networkName},
+        {"passphrase", JsonReader::kTypeString, &passphrase},
+        {"extPanId", JsonReader::kTypeString, &extPanId},
+    };
+    ot::Psk::Pskc psk;
+    uint8_t       extPanIdBytes[OT_EXTENDED_PANID_LENGTH];
 
-    root["result"] = mResponseSuccess;
-    root["error"]  = ret;
-    if (ret != ot::Dbus::kWpantundStatus_Ok)
-    {
-        otbrLog(OTBR_LOG_ERR, "wpan service error: %d", ret);
-        root["result"] = mResponseFail;
-    }
-    response = jsonWriter.write(root);
-    return response;
+    // Invalid requests fail once handled.
+    VerifyOrExit(ParseRequest(aFormRequest, kFields, sizeof(kFields) / sizeof(kFields[0])));
+    ot::Utils::Hex2Bytes(extPanId.c_str(), extPanId.size(), extPanIdBytes, OT_EXTENDED_PANID_LENGTH);
+    psk.ComputePskc(extPanIdBytes, networkName.c_str(), passphrase.c_str());
+
+exit:
+    return;
 }
 
 std::string WpanService::HandleAddPrefixRequest(const std::string &aAddPrefixRequest)
 {
-    Json::Value              root;
-    Json::FastWriter         jsonWriter;
-    Json::Reader             reader;
-    std::string              response;
-    std::string              prefix;
-    bool                     defaultRoute;
-    ot::Dbus::WPANController wpanController;
-    int                      ret = ot::Dbus::kWpantundStatus_Ok;
-
-    VerifyOrExit(reader.parse(aAddPrefixRequest.c_str(), root) == true, ret = kWpanStatus_ParseRequestFailed);
-    prefix       = root["prefix"].asString();
-    defaultRoute = root["defaultRoute"].asBool();
-
-    wpanController.SetInterfaceName(mIfName);
-    VerifyOrExit(wpanController.AddGateway(prefix.c_str(), defaultRoute) == ot::Dbus::kWpantundStatus_Ok,
+    std::lock_guard<std::mutex> lock(mRequestMutex);
+
+    const JsonReader::Field kFields[] = {
+        {"prefix", JsonReader::kTypeString, &mRequest.mPrefix},
+        {"defaultRoute", JsonReader::kTypeBool, &mRequest.mDefaultRoute},
+    };
+    PrefixTable::Prefix prefix;
+    int                 ret = ot::Dbus::kWpantundStatus_Ok;
+
+    VerifyOrExit(ParseRequest(aAddPrefixRequest, kFields, sizeof(kFields) / sizeof(kFields[0])),
+                 ret = kWpanStatus_ParseRequestFailed);
+
+    VerifyOrExit(PrefixTable::ParsePrefix(mRequest.mPrefix.c_str(), prefix.mPrefix),
                  ret = ot::Dbus::kWpantundStatus_SetGatewayFailed);
+    prefix.mDefaultRoute = mRequest.mDefaultRoute;
+    VerifyOrExit(mPrefixTable.AddDesired(prefix), ret = ot::Dbus::kWpantundStatus_SetGatewayFailed);
+    ret = ApplyPrefixes(prefix.mPrefix);
 exit:
+    return WriteResult(ret);
+}
 
-    root.clear();
+std::string WpanService::HandleDeletePrefixRequest(const std::string &aDeleteRequest)
+{
+    std::lock_guard<std::mutex> lock(mRequestMutex);
 
-    root["result"] = mResponseSuccess;
-    root["error"]  = ret;
-    if (ret != ot::Dbus::kWpantundStatus_Ok)
+    const JsonReader::Field kFields[] = {
+        {"prefix", JsonReader::kTypeString, &mRequest.mPrefix},
+    };
+    uint8_t prefix[PrefixTable::kPrefixSize];
+    int     ret = ot::Dbus::kWpantundStatus_Ok;
+
+    VerifyOrExit(ParseRequest(aDeleteRequest, kFields, sizeof(kFields) / sizeof(kFields[0])),
+                 ret = kWpanStatus_ParseRequestFailed);
+    VerifyOrExit(PrefixTable::ParsePrefix(mRequest.mPrefix.c_str(), prefix),
+                 ret = ot::Dbus::kWpantundStatus_SetGatewayFailed);
+    mPrefixTable.RemoveDesired(prefix);
+    ret = ApplyPrefixes(prefix);
+exit:
+    return WriteResult(ret);
+}
+
+std::string WpanService::HandleSetPrefixesRequest(const std::string &aSetPrefixesRequest)
+{
+    std::lock_guard<std::mutex> lock(mRequestMutex);
+
+    Json::Value         root;
+    Json::Reader        reader;
+    PrefixTable::Prefix prefixes[PrefixTable::kMaxPrefixes];
+    Json::ArrayIndex    count = 0;
+    int                 ret   = ot::Dbus::kWpantundStatus_Ok;
+
+    VerifyOrExit(reader.parse(aSetPrefixesRequest, root) && root.isObject() && root["prefixes"].isArray() &&
+                     root["prefixes"].size() <= PrefixTable::kMaxPrefixes,
+                 ret = kWpanStatus_ParseRequestFailed);
+
+    for (count = 0; count < root["prefixes"].size(); count++)
     {
-        otbrLog(OTBR_LOG_ERR, "wpan service error: %d", ret);
-        root["result"] = mResponseFail;
+        const Json::Value &prefix       = root["prefixes"][count];
+        const Json::Value  text         = prefix.isObject() ? prefix["prefix"] : Json::Value();
+        const Json::Value  defaultRoute = prefix.isObject() ? prefix["defaultRoute"] : Json::Value();
+
+        VerifyOrExit(text.isString() && (defaultRoute.isNull() || defaultRoute.isBool()),
+                     ret = kWpanStatus_ParseRequestFailed);
+        VerifyOrExit(PrefixTable::ParsePrefix(text.asCString(), prefixes[count].mPrefix),
+                     ret = ot::Dbus::kWpantundStatus_SetGatewayFailed);
+        prefixes[count].mDefaultRoute = defaultRoute.isBool() && defaultRoute.asBool();
     }
-    response = jsonWriter.write(root);
-    return response;
+
+    VerifyOrExit(mPrefixTable.SetDesired(prefixes, count), ret = kWpanStatus_ParseRequestFailed);
+    ret = ApplyPrefixes(NULL);
+exit:
+    return WriteResult(ret);
 }
 
-std::string WpanService::HandleDeletePrefixRequest(const std::string &aDeleteRequest)
+int WpanService::ApplyPrefixes(const uint8_t *aOnly)
 {
-    Json::Value              root;
-    Json::FastWriter         jsonWriter;
-    Json::Reader             reader;
-    std::string              response;
-    std::string              prefix;
-    ot::Dbus::WPANController wpanController;
-    int                      ret = ot::Dbus::kWpantundStatus_Ok;
-
-    VerifyOrExit(reader.parse(aDeleteRequest.c_str(), root) == true, ret = kWpanStatus_ParseRequestFailed);
-    prefix = root["prefix"].asString();
-    wpanController.SetInterfaceName(mIfName);
-    VerifyOrExit(wpanController.RemoveGateway(prefix.c_str()) == ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_SetGatewayFailed);
-exit:
+    PrefixTable::Change changes[PrefixTable::kMaxChanges];
+    size_t              count;
+    int                 ret = ot::Dbus::kWpantundStatus_Ok;
 
-    root.clear();
-    root["result"] = mResponseSuccess;
+    // Without the prefixes of wpantund, the changes are diffed against those last known.
+    if (!mPrefixTable.SetCurrent(mWpanController.Get(kWPANTUNDProperty_ThreadOnMeshPrefixes).c_str()))
+    {
+        otbrLog(OTBR_LOG_WARNING, "on-mesh prefixes of wpantund unknown");
+    }
 
-    root["error"] = ret;
-    if (ret != ot::Dbus::kWpantundStatus_Ok)
+    count = mPrefixTable.Diff(changes, aOnly);
+    otbrLog(OTBR_LOG_INFO, "on-mesh prefixes: %zu changed", count);
+
+    // Changes are pipelined, as many as a transaction takes per round trip.
+    for (size_t begin = 0; begin < count; begin += ot::Dbus::WPANController::Transaction::kMaxSteps)
     {
-        otbrLog(OTBR_LOG_ERR, "wpan service error: %d", ret);
-        root["result"] = mResponseFail;
+        ot::Dbus::WPANController::Transaction transaction(mWpanController);
+        size_t                                end = begin + ot::Dbus::WPANController::Transaction::kMaxSteps;
+        char                                  text[INET6_ADDRSTRLEN];
+
+        if (end > count)
+        {
+            end = count;
+        }
+
+        for (size_t i = begin; i < end; i++)
+        {
+            PrefixTable::FormatPrefix(changes[i].mPrefix.mPrefix, text, sizeof(text));
+
+            if (changes[i].mRemoved)
+            {
+                transaction.RemoveGateway(text);
+            }
+            else
+            {
+                transaction.AddGateway(text, changes[i].mPrefix.mDefaultRoute);
+            }
+        }
+
+        VerifyOrExit(transaction.Commit() == ot::Dbus::kWpantundStatus_Ok,
+                     ret = ot::Dbus::kWpantundStatus_SetGatewayFailed);
+        mPrefixTable.Apply(&changes[begin], end - begin);
     }
-    response = jsonWriter.write(root);
-    return response;
+
+exit:
+    return ret;
 }
 
 std::string WpanService::HandleStatusRequest()
 {
-    Json::Value              root, networkInfo;
-    Json::FastWriter         jsonWriter;
-    ot::Dbus::WPANController wpanController;
-    std::string              response, networkName, extPanId, propertyValue;
-    int                      ret = ot::Dbus::kWpantundStatus_Ok;
+    std::lock_guard<std::mutex> lock(mRequestMutex);
+
+    Json::Value      root, networkInfo;
+    Json::FastWriter jsonWriter;
+    std::string      response, networkName, extPanId;
+    int              ret        = ot::Dbus::kWpantundStatus_Ok;
+    uint32_t         generation = GetStatusGeneration();
 
     switch (GetWpanServiceStatus(networkName, extPanId))
     {
     case kWpanStatus_OK:
-        wpanController.SetInterfaceName(mIfName);
-        propertyValue = wpanController.Get(kWPANTUNDProperty_NCPState);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_NCPState] = propertyValue;
-        propertyValue                           = wpanController.Get(kWPANTUNDProperty_DaemonEnabled);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_DaemonEnabled] = propertyValue;
-        propertyValue                                = wpanController.Get(kWPANTUNDProperty_NCPVersion);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_NCPVersion] = propertyValue;
-        propertyValue                             = wpanController.Get(kWPANTUNDProperty_DaemonVersion);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_DaemonVersion] = propertyValue;
-        propertyValue                                = wpanController.Get(kWPANTUNDProperty_ConfigNCPDriverName);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_ConfigNCPDriverName] = propertyValue;
-        propertyValue                                      = wpanController.Get(kWPANTUNDProperty_NCPHardwareAddress);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_NCPHardwareAddress] = propertyValue;
-        propertyValue                                     = wpanController.Get(kWPANTUNDProperty_NCPChannel);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_NCPChannel] = propertyValue;
-        propertyValue                             = wpanController.Get(kWPANTUNDProperty_NetworkNodeType);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_NetworkNodeType] = propertyValue;
-        propertyValue                                  = wpanController.Get(kWPANTUNDProperty_NetworkName);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_NetworkName] = propertyValue;
-        propertyValue                              = wpanController.Get(kWPANTUNDProperty_NetworkXPANID);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_NetworkXPANID] = propertyValue;
-        propertyValue                                = wpanController.Get(kWPANTUNDProperty_NetworkPANID);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_NetworkPANID] = propertyValue;
-        propertyValue                               = wpanController.Get(kWPANTUNDProperty_IPv6LinkLocalAddress);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_IPv6LinkLocalAddress] = propertyValue;
-        propertyValue = wpanController.Get(kWPANTUNDProperty_IPv6MeshLocalAddress);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_IPv6MeshLocalAddress] = propertyValue;
-        propertyValue                                       = wpanController.Get(kWPANTUNDProperty_IPv6MeshLocalPrefix);
-        VerifyOrExit(propertyValue.length() > 0, ret = kWpanStatus_GetPropertyFailed);
-        networkInfo[kWPANTUNDProperty_IPv6MeshLocalPrefix] = propertyValue;
-        networkInfo["mDNS service"]                        = mServiceUp;
+    {
+        const size_t                kMaxCount = sizeof(kStatusProperties) / sizeof(kStatusProperties[0]);
+        ot::Dbus::PropertyNameValue properties[kMaxCount];
+        size_t                      count = 0;
+
+        // The interface table has the addresses already, only the Thread properties are asked for to wpantund.
+        for (size_t i = 0; i < kMaxCount; i++)
+        {
+            if (!IsInterfaceProperty(kStatusProperties[i]))
+            {
+                strncpy(properties[count++].name, kStatusProperties[i], sizeof(properties[0].name));
+            }
+        }
+
+        // All properties are fetched in one DBus round trip instead of one per property.
+        VerifyOrExit(mWpanController.Get(properties, count) == ot::Dbus::kWpantundStatus_Ok,
+                     ret = kWpanStatus_GetPropertyFailed);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            VerifyOrExit(properties[i].value[0] != '\0', ret = kWpanStatus_GetPropertyFailed);
+            networkInfo[properties[i].name] = properties[i].value;
+        }
+
+        if (count < kMaxCount)
+        {
+            GetInterfaceInfo(networkInfo[kWPANTUNDProperty_IPv6MeshLocalPrefix].asString(), networkInfo);
+        }
+
+        networkInfo["mDNS service"] = mServiceUp;
         break;
+    }
 
     case kWpanStatus_Offline:
         networkInfo["WPAN service"] = kWPANTUNDStateOffline;
@@ -299,37 +409,454 @@ exit:
     }
     root["error"] = ret;
     response      = jsonWriter.write(root);
+
+    // A wpantund down sends no property changes, its status would never be refreshed.
+    if (ret == kWpanStatus_OK && !networkInfo.isMember("wpantund"))
+    {
+        StoreStatusSnapshot(generation, networkInfo, response);
+    }
+
+    return response;
+}
+
+bool WpanService::IsInterfaceProperty(const char *aName) const
+{
+    bool isInterface = false;
+
+    VerifyOrExit(mInterfaceTable != NULL && mInterfaceTable->IsValid());
+
+    for (size_t i = 0; i < sizeof(kInterfaceProperties) / sizeof(kInterfaceProperties[0]); i++)
+    {
+        if (strcmp(aName, kInterfaceProperties[i]) == 0)
+        {
+            isInterface = true;
+            break;
+        }
+    }
+
+exit:
+    return isInterface;
+}
+
+void WpanService::GetInterfaceInfo(const std::string &aMeshLocalPrefix, Json::Value &aNetworkInfo) const
+{
+    // The locators of the mesh-local prefix have the interface identifier 0000:00ff:fe00:xxxx.
+    static const uint8_t kLocatorIid[] = {0x00, 0x00, 0x00, 0xff, 0xfe, 0x00};
+    static const size_t  kPrefixSize   = 8;
+
+    InterfaceTable::State state;
+    struct in6_addr       prefix;
+    bool                  hasPrefix;
+    std::string           linkLocal, meshLocal, addresses;
+
+    mInterfaceTable->GetState(state);
+
+    // The prefix is reported by wpantund as e.g. "fdde:ad00:beef:0::/64".
+    hasPrefix = inet_pton(AF_INET6, aMeshLocalPrefix.substr(0, aMeshLocalPrefix.find('/')).c_str(), &prefix) == 1;
+
+    for (uint8_t i = 0; i < state.mAddressCount; i++)
+    {
+        const InterfaceTable::Address &address = state.mAddresses[i];
+        char                           text[INET6_ADDRSTRLEN];
+        bool                           isLocator;
+
+        VerifyOrExit(inet_ntop(AF_INET6, address.mAddress, text, sizeof(text)) != NULL);
+        isLocator = memcmp(&address.mAddress[kPrefixSize], kLocatorIid, sizeof(kLocatorIid)) == 0;
+
+        if (!addresses.empty())
+        {
+            addresses += ", ";
+        }
+
+        addresses += text;
+        addresses += "/" + std::to_string(address.mPrefixLength);
+
+        if (address.mAddress[0] == 0xfe && (address.mAddress[1] & 0xc0) == 0x80)
+        {
+            if (linkLocal.empty())
+            {
+                linkLocal = text;
+            }
+        }
+        else if (!isLocator && meshLocal.empty() &&
+                 (hasPrefix ? memcmp(address.mAddress, prefix.s6_addr, kPrefixSize) == 0
+                            : address.mAddress[0] == 0xfd && address.mPrefixLength == 64))
+        {
+            meshLocal = text;
+        }
+    }
+
+exit:
+    aNetworkInfo[kWPANTUNDProperty_IPv6LinkLocalAddress] = linkLocal;
+    aNetworkInfo[kWPANTUNDProperty_IPv6MeshLocalAddress] = meshLocal;
+    aNetworkInfo[kIp6AddressesKey]                       = addresses;
+    aNetworkInfo[kLinkStateKey] =
+        !state.mExists ? "absent" : !state.mUp ? mServiceDown : state.mRunning ? "running" : mServiceUp;
+}
+
+void WpanService::SetStatusSnapshotEnabled(bool aEnabled)
+{
+    std::lock_guard<std::mutex> lock(mSnapshotMutex);
+
+    mSnapshotEnabled = aEnabled;
+    mSnapshotValid   = false;
+}
+
+uint32_t WpanService::GetStatusGeneration(void)
+{
+    std::lock_guard<std::mutex> lock(mSnapshotMutex);
+
+    return mSnapshotGeneration;
+}
+
+bool WpanService::GetStatusSnapshot(const std::string &aIfNoneMatch,
+                                    bool               aDelta,
+                                    std::string &      aStatus,
+                                    std::string &      aEtag)
+{
+    std::lock_guard<std::mutex> lock(mSnapshotMutex);
+
+    char     prefix[sizeof("W/\"-") + 8];
+    size_t   found;
+    uint64_t since = 0;
+
+    aStatus.clear();
+    VerifyOrExit(mSnapshotValid);
+    aEtag = mSnapshotEtag;
+    VerifyOrExit(aIfNoneMatch != "*" && aIfNoneMatch.find(mSnapshotEtag) == std::string::npos);
+
+    // The version of the client is only known if the ETag is from this process.
+    snprintf(prefix, sizeof(prefix), "W/\"%08" PRIx32 "-", mSnapshotEpoch);
+    found = aIfNoneMatch.find(prefix);
+
+    if (aDelta && found != std::string::npos)
+    {
+        since = strtoull(aIfNoneMatch.c_str() + found + strlen(prefix), NULL, 10);
+    }
+
+    if (since != 0 && since < mSnapshotVersion && since + 1 >= mSnapshotDeltas.front().mVersion)
+    {
+        Json::Value      root, delta(Json::objectValue);
+        Json::FastWriter jsonWriter;
+
+        for (std::deque<StatusDelta>::const_iterator it = mSnapshotDeltas.begin(); it != mSnapshotDeltas.end(); ++it)
+        {
+            if (it->mVersion <= since)
+            {
+                continue;
+            }
+
+            for (Json::ValueConstIterator member = it->mPatch.begin(); member != it->mPatch.end(); ++member)
+            {
+                delta[member.name()] = *member;
+            }
+        }
+
+        root["delta"] = delta;
+        root["error"] = kWpanStatus_OK;
+        aStatus       = jsonWriter.write(root);
+    }
+    else
+    {
+        aStatus = mSnapshot;
+    }
+
+exit:
+    return mSnapshotValid;
+}
+
+void WpanService::StoreStatusSnapshot(uint32_t aGeneration, const Json::Value &aNetworkInfo, const std::string &aStatus)
+{
+    std::lock_guard<std::mutex> lock(mSnapshotMutex);
+
+    Json::Value patch;
+
+    // A property changed while the status was fetched may be missing from it.
+    VerifyOrExit(mSnapshotEnabled && aGeneration == mSnapshotGeneration);
+
+    // A status fetched again after the snapshot was dropped only makes a version if it differs.
+    for (Json::ValueConstIterator it = aNetworkInfo.begin(); it != aNetworkInfo.end(); ++it)
+    {
+        if (!mSnapshotInfo.isMember(it.name()) || mSnapshotInfo[it.name()] != *it)
+        {
+            patch[it.name()] = *it;
+        }
+    }
+
+    for (Json::ValueConstIterator it = mSnapshotInfo.begin(); it != mSnapshotInfo.end(); ++it)
+    {
+        if (!aNetworkInfo.isMember(it.name()))
+        {
+            patch[it.name()] = Json::Value(Json::nullValue);
+        }
+    }
+
+    if (!patch.empty() || mSnapshotVersion == 0)
+    {
+        AddStatusVersion(patch);
+    }
+
+    mSnapshotInfo  = aNetworkInfo;
+    mSnapshot      = aStatus;
+    mSnapshotValid = true;
+
+exit:
+    return;
+}
+
+void WpanService::UpdateStatusSnapshot(const Json::Value &aChanges)
+{
+    Json::Value      root, patch;
+    Json::FastWriter jsonWriter;
+
+    for (Json::ValueConstIterator it = aChanges.begin(); it != aChanges.end(); ++it)
+    {
+        if (mSnapshotInfo[it.name()] != *it)
+        {
+            patch[it.name()]         = *it;
+            mSnapshotInfo[it.name()] = *it;
+        }
+    }
+
+    // Properties reported again with the same value keep the version, so that clients keep their copies.
+    VerifyOrExit(!patch.empty());
+    root["result"] = mSnapshotInfo;
+    root["error"]  = kWpanStatus_OK;
+    mSnapshot      = jsonWriter.write(root);
+    AddStatusVersion(patch);
+
+exit:
+    return;
+}
+
+void WpanService::AddStatusVersion(const Json::Value &aPatch)
+{
+    char        etag[sizeof("W/\"-\"") + 8 + 20];
+    StatusDelta delta;
+
+    mSnapshotVersion++;
+    snprintf(etag, sizeof(etag), "W/\"%08" PRIx32 "-%" PRIu64 "\"", mSnapshotEpoch, mSnapshotVersion);
+    mSnapshotEtag = etag;
+
+    delta.mVersion = mSnapshotVersion;
+    delta.mPatch   = aPatch;
+    mSnapshotDeltas.push_back(delta);
+
+    if (mSnapshotDeltas.size() > kMaxStatusDeltas)
+    {
+        mSnapshotDeltas.pop_front();
+    }
+}
+
+std::string WpanService::HandlePropertyChanged(const char *aName, const char *aValue)
+{
+    Json::Value      delta;
+    Json::FastWriter jsonWriter;
+    std::string      response;
+    bool             isStatus = false;
+
+    for (size_t i = 0; i < sizeof(kStatusProperties) / sizeof(kStatusProperties[0]); i++)
+    {
+        if (strcmp(aName, kStatusProperties[i]) == 0)
+        {
+            isStatus = true;
+            break;
+        }
+    }
+
+    VerifyOrExit(isStatus && !IsInterfaceProperty(aName));
+    delta[aName] = aValue;
+
+    // The mesh-local address of the table is found by the prefix.
+    if (strcmp(aName, kWPANTUNDProperty_IPv6MeshLocalPrefix) == 0 && IsInterfaceProperty(kInterfaceProperties[0]))
+    {
+        GetInterfaceInfo(aValue, delta);
+    }
+
+    response = jsonWriter.write(delta);
+    response.erase(response.find_last_not_of('\n') + 1);
+
+    {
+        std::lock_guard<std::mutex> lock(mSnapshotMutex);
+
+        mSnapshotGeneration++;
+        VerifyOrExit(mSnapshotValid);
+
+        if (strcmp(aName, kWPANTUNDProperty_NCPState) == 0 || !mSnapshotInfo.isMember(aName))
+        {
+            mSnapshotValid = false;
+            ExitNow();
+        }
+
+        UpdateStatusSnapshot(delta);
+    }
+
+exit:
+    return response;
+}
+
+std::string WpanService::HandleInterfaceChanged(void)
+{
+    std::lock_guard<std::mutex> lock(mSnapshotMutex);
+
+    Json::Value      info, delta;
+    Json::FastWriter jsonWriter;
+    std::string      response;
+
+    mSnapshotGeneration++;
+
+    // A table given up leaves the addresses to wpantund, the status is fetched again.
+    if (mInterfaceTable == NULL || !mInterfaceTable->IsValid())
+    {
+        mSnapshotValid = false;
+        ExitNow();
+    }
+
+    GetInterfaceInfo(mSnapshotInfo.get(kWPANTUNDProperty_IPv6MeshLocalPrefix, "").asString(), info);
+
+    for (Json::ValueConstIterator it = info.begin(); it != info.end(); ++it)
+    {
+        if (!mSnapshotValid || mSnapshotInfo[it.name()] != *it)
+        {
+            delta[it.name()] = *it;
+        }
+    }
+
+    VerifyOrExit(!delta.empty());
+    response = jsonWriter.write(delta);
+    response.erase(response.find_last_not_of('\n') + 1);
+
+    if (mSnapshotValid)
+    {
+        UpdateStatusSnapshot(delta);
+    }
+
+exit:
+    return response;
+}
+
+std::string WpanService::HandleBatchRequest(const std::string &aBatchRequest)
+{
+    Json::Value      batch;
+    Json::Reader     reader;
+    Json::FastWriter jsonWriter;
+    std::string      response;
+    JsonWriter       writer(response);
+
+    // Each operation takes the request mutex itself, the batch runs on the WPAN worker so none is run between them.
+    VerifyOrExit(reader.parse(aBatchRequest, batch) && batch.isArray() && batch.size() <= kMaxBatchOperations,
+                 response = WriteResult(kWpanStatus_ParseRequestFailed));
+
+    writer.BeginObject();
+    writer.Key("result");
+    writer.BeginArray();
+
+    for (Json::ArrayIndex i = 0; i < batch.size(); i++)
+    {
+        const Json::Value &operation = batch[i];
+        const Json::Value  name      = operation.isObject() ? operation["operation"] : Json::Value();
+        const Json::Value  request   = operation.isObject() ? operation["request"] : Json::Value();
+        std::string        content   = request.isObject() ? jsonWriter.write(request) : "{}";
+
+        if (!name.isString())
+        {
+            writer.Raw(WriteResult(kWpanStatus_ParseRequestFailed));
+        }
+        else if (name.asString() == "join_network")
+        {
+            writer.Raw(HandleJoinNetworkRequest(content));
+        }
+        else if (name.asString() == "form_network")
+        {
+            writer.Raw(HandleFormNetworkRequest(content));
+        }
+        else if (name.asString() == "add_prefix")
+        {
+            writer.Raw(HandleAddPrefixRequest(content));
+        }
+        else if (name.asString() == "delete_prefix")
+        {
+            writer.Raw(HandleDeletePrefixRequest(content));
+        }
+        else if (name.asString() == "set_prefixes")
+        {
+            writer.Raw(HandleSetPrefixesRequest(content));
+        }
+        else if (name.asString() == "get_properties")
+        {
+            writer.Raw(HandleStatusRequest());
+        }
+        else if (name.asString() == "available_network")
+        {
+            writer.Raw(HandleAvailableNetworkRequest());
+        }
+        else
+        {
+            writer.Raw(WriteResult(kWpanStatus_ParseRequestFailed));
+        }
+    }
+
+    writer.EndArray();
+    writer.Key("error");
+    writer.Int(kWpanStatus_OK);
+    writer.EndObject();
+
+exit:
     return response;
 }
 
 std::string WpanService::HandleAvailableNetworkRequest()
 {
-    Json::Value              root, networks, networkInfo;
-    ot::Dbus::WPANController wpanController;
-    Json::FastWriter         jsonWriter;
-    std::string              response;
-    int                      ret = ot::Dbus::kWpantundStatus_Ok;
-
-    wpanController.SetInterfaceName(mIfName);
-    VerifyOrExit(wpanController.Scan() == ot::Dbus::kWpantundStatus_Ok, ret = ot::Dbus::kWpantundStatus_ScanFailed);
-    mNetworksCount = wpanController.GetScanNetworksInfoCount();
-    VerifyOrExit(mNetworksCount > 0, ret = ot::Dbus::kWpantundStatus_NetworkNotFound);
-    memcpy(mNetworks, wpanController.GetScanNetworksInfo(), mNetworksCount * sizeof(ot::Dbus::WpanNetworkInfo));
+    std::lock_guard<std::mutex> lock(mRequestMutex);
 
-    for (int i = 0; i < mNetworksCount; i++)
+    Json::Value      root;
+    Json::FastWriter jsonWriter;
+    std::string      response;
+    ScanContext      context = {this, NULL, NULL};
+    int              ret     = ot::Dbus::kWpantundStatus_Ok;
+
+    ret = mWpanController.Scan(HandleScanBeacon, &context);
+    VerifyOrExit(ret == ot::Dbus::kWpantundStatus_Ok || ret == ot::Dbus::kWpantundStatus_NetworkNotFound,
+                 ret = ot::Dbus::kWpantundStatus_ScanFailed);
+    ret = ot::Dbus::kWpantundStatus_Ok;
+
+exit:
+    FinishScan(ret == ot::Dbus::kWpantundStatus_Ok);
+
+    if (ret != ot::Dbus::kWpantundStatus_Ok)
     {
-        char extPanId[OT_EXTENDED_PANID_LENGTH * 2 + 1], panId[OT_PANID_LENGTH * 2 + 3],
-            hardwareAddress[OT_HARDWARE_ADDRESS_LENGTH * 2 + 1];
-        ot::Utils::Long2Hex(Thread::Encoding::BigEndian::HostSwap64(mNetworks[i].mExtPanId), extPanId);
-        ot::Utils::Bytes2Hex(mNetworks[i].mHardwareAddress, OT_HARDWARE_ADDRESS_LENGTH, hardwareAddress);
-        sprintf(panId, "0x%X", mNetworks[i].mPanId);
-        networkInfo[i]["nn"] = mNetworks[i].mNetworkName;
-        networkInfo[i]["xp"] = extPanId;
-        networkInfo[i]["pi"] = panId;
-        networkInfo[i]["ch"] = mNetworks[i].mChannel;
-        networkInfo[i]["ha"] = hardwareAddress;
+        root["result"] = mResponseFail;
+        root["error"]  = ret;
+        response       = jsonWriter.write(root);
+        otbrLog(OTBR_LOG_ERR, "Error is %d", ret);
     }
-    root["result"] = networkInfo;
+    else
+    {
+        std::lock_guard<std::mutex> networksLock(mNetworksMutex);
+
+        response = WriteScannedNetworks();
+    }
+
+    return response;
+}
+
+std::string WpanService::HandleAvailableNetworkRequest(NetworkHandler aHandler, void *aContext)
+{
+    std::lock_guard<std::mutex> lock(mRequestMutex);
+
+    Json::Value      root;
+    Json::FastWriter jsonWriter;
+    std::string      response;
+    ScanContext      context = {this, aHandler, aContext};
+    int              ret     = ot::Dbus::kWpantundStatus_Ok;
+
+    ret = mWpanController.Scan(HandleScanBeacon, &context);
+    FinishScan(ret == ot::Dbus::kWpantundStatus_Ok || ret == ot::Dbus::kWpantundStatus_NetworkNotFound);
+    VerifyOrExit(ret == ot::Dbus::kWpantundStatus_Ok || ret == ot::Dbus::kWpantundStatus_NetworkNotFound,
+                 ret = ot::Dbus::kWpantundStatus_ScanFailed);
+    VerifyOrExit(ret == ot::Dbus::kWpantundStatus_Ok);
+    root["result"] = mResponseSuccess;
+
 exit:
     if (ret != ot::Dbus::kWpantundStatus_Ok)
     {
@@ -341,14 +868,184 @@ exit:
     return response;
 }
 
+bool WpanService::GetAvailableNetworkSnapshot(std::string &aNetworks, bool &aRefresh)
+{
+    std::lock_guard<std::mutex> lock(mNetworksMutex);
+
+    uint64_t now   = ot::BorderRouter::GetMonotonicNow();
+    bool     found = false;
+
+    aRefresh = false;
+    VerifyOrExit(mLastScan != 0 && now - mLastScan < kScannedNetworkTimeout && mNetworksCount > 0);
+    found     = true;
+    aNetworks = WriteScannedNetworks();
+
+    // Only one scan is asked for at a time, the networks are served meanwhile.
+    if (!mScanRefreshPending && now - mLastScan >= kScannedNetworkRefresh)
+    {
+        mScanRefreshPending = true;
+        aRefresh            = true;
+    }
+
+exit:
+    return found;
+}
+
+void WpanService::HandleScanBeacon(const ot::Dbus::WpanNetworkInfo &aNetwork, void *aContext)
+{
+    ScanContext &    context = *static_cast<ScanContext *>(aContext);
+    Json::Value      networkInfo;
+    Json::FastWriter jsonWriter;
+
+    context.mService->StoreScannedNetwork(aNetwork);
+    VerifyOrExit(context.mHandler != NULL);
+
+    GetNetworkInfo(aNetwork, networkInfo);
+    context.mHandler(jsonWriter.write(networkInfo), context.mContext);
+
+exit:
+    return;
+}
+
+void WpanService::StoreScannedNetwork(const ot::Dbus::WpanNetworkInfo &aNetwork)
+{
+    std::lock_guard<std::mutex> lock(mNetworksMutex);
+
+    ScannedNetwork *network = NULL;
+
+    for (int i = 0; i < mNetworksCount; i++)
+    {
+        if (mNetworks[i].mInfo.mExtPanId == aNetwork.mExtPanId)
+        {
+            network = &mNetworks[i];
+            break;
+        }
+    }
+
+    if (network == NULL)
+    {
+        VerifyOrExit(mNetworksCount < OT_SCANNED_NET_BUFFER_SIZE);
+        network        = &mNetworks[mNetworksCount++];
+        network->mInfo = aNetwork;
+    }
+    else
+    {
+        int rssi = network->mInfo.mRssi;
+
+        // The beacons of a network come from any of its routers, so the RSSI is smoothed rather than replaced.
+        network->mInfo       = aNetwork;
+        network->mInfo.mRssi = static_cast<int8_t>((rssi * 3 + aNetwork.mRssi) / 4);
+    }
+
+    network->mLastSeen = ot::BorderRouter::GetMonotonicNow();
+
+exit:
+    return;
+}
+
+void WpanService::FinishScan(bool aSucceeded)
+{
+    std::lock_guard<std::mutex> lock(mNetworksMutex);
+
+    uint64_t now   = ot::BorderRouter::GetMonotonicNow();
+    int      count = 0;
+
+    mScanRefreshPending = false;
+    VerifyOrExit(aSucceeded);
+    mLastScan = now;
+
+    // The networks keep the order they were first found in, so that the indexes of earlier responses mostly hold.
+    for (int i = 0; i < mNetworksCount; i++)
+    {
+        if (now - mNetworks[i].mLastSeen < kScannedNetworkTimeout)
+        {
+            mNetworks[count++] = mNetworks[i];
+        }
+    }
+
+    mNetworksCount = count;
+
+exit:
+    return;
+}
+
+std::string WpanService::WriteScannedNetworks(void) const
+{
+    Json::Value      root, networkInfo;
+    Json::FastWriter jsonWriter;
+    int              ret = ot::Dbus::kWpantundStatus_Ok;
+
+    VerifyOrExit(mNetworksCount > 0, ret = ot::Dbus::kWpantundStatus_NetworkNotFound);
+
+    for (int i = 0; i < mNetworksCount; i++)
+    {
+        GetNetworkInfo(mNetworks[i].mInfo, networkInfo[i]);
+    }
+    root["result"] = networkInfo;
+
+exit:
+    if (ret != ot::Dbus::kWpantundStatus_Ok)
+    {
+        root["result"] = mResponseFail;
+    }
+    root["error"] = ret;
+    return jsonWriter.write(root);
+}
+
+bool WpanService::FindScannedNetwork(const std::string &        aExtPanId,
+                                     unsigned int               aIndex,
+                                     ot::Dbus::WpanNetworkInfo &aNetwork)
+{
+    std::lock_guard<std::mutex> lock(mNetworksMutex);
+
+    char extPanId[OT_EXTENDED_PANID_LENGTH * 2 + 1];
+    bool found = false;
+
+    // Clients not sending the extended PAN ID refer to the networks by their index in the last response.
+    if (aExtPanId.empty())
+    {
+        VerifyOrExit(aIndex < static_cast<unsigned int>(mNetworksCount));
+        aNetwork = mNetworks[aIndex].mInfo;
+        ExitNow(found = true);
+    }
+
+    for (int i = 0; i < mNetworksCount && !found; i++)
+    {
+        ot::Utils::Long2Hex(Thread::Encoding::BigEndian::HostSwap64(mNetworks[i].mInfo.mExtPanId), extPanId);
+
+        if (strcasecmp(extPanId, aExtPanId.c_str()) == 0)
+        {
+            aNetwork = mNetworks[i].mInfo;
+            found    = true;
+        }
+    }
+
+exit:
+    return found;
+}
+
+void WpanService::GetNetworkInfo(const ot::Dbus::WpanNetworkInfo &aNetwork, Json::Value &aNetworkInfo)
+{
+    char extPanId[OT_EXTENDED_PANID_LENGTH * 2 + 1], panId[OT_PANID_LENGTH * 2 + 3],
+        hardwareAddress[OT_HARDWARE_ADDRESS_LENGTH * 2 + 1];
+
+    ot::Utils::Long2Hex(Thread::Encoding::BigEndian::HostSwap64(aNetwork.mExtPanId), extPanId);
+    ot::Utils::Bytes2Hex(aNetwork.mHardwareAddress, OT_HARDWARE_ADDRESS_LENGTH, hardwareAddress);
+    sprintf(panId, "0x%X", aNetwork.mPanId);
+    aNetworkInfo["nn"] = aNetwork.mNetworkName;
+    aNetworkInfo["xp"] = extPanId;
+    aNetworkInfo["pi"] = panId;
+    aNetworkInfo["ch"] = aNetwork.mChannel;
+    aNetworkInfo["ha"] = hardwareAddress;
+    aNetworkInfo["rs"] = aNetwork.mRssi;
+}
+
 int WpanService::GetWpanServiceStatus(std::string &aNetworkName, std::string &aExtPanId) const
 {
-    std::string              wpantundState = "";
-    int                      status        = kWpanStatus_OK;
-    ot::Dbus::WPANController wpanController;
+    std::string wpantundState = "";
+    int         status        = kWpanStatus_OK;
 
-    wpanController.SetInterfaceName(mIfName);
-    wpantundState = wpanController.Get(kWPANTUNDProperty_NCPState);
+    wpantundState = mWpanController.Get(kWPANTUNDProperty_NCPState);
     if (wpantundState.length() == 0)
     {
         status = kWpanStatus_Down;
@@ -357,8 +1054,8 @@ int WpanService::GetWpanServiceStatus(std::string &aNetworkName, std::string &aE
 
     if (wpantundState == kWPANTUNDStateAssociated)
     {
-        aNetworkName = wpanController.Get(kWPANTUNDProperty_NetworkName);
-        aExtPanId    = wpanController.Get(kWPANTUNDProperty_NetworkXPANID);
+        aNetworkName = mWpanController.Get(kWPANTUNDProperty_NetworkName);
+        aExtPanId    = mWpanController.Get(kWPANTUNDProperty_NetworkXPANID);
         aExtPanId    = aExtPanId.substr(OT_HEX_PREFIX_LENGTH);
     }
     else if (wpantundState.find(kWPANTUNDStateOffline) != std::string::npos)
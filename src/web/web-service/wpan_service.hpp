@@ -38,9 +38,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <deque>
+#include <mutex>
+#include <random>
+
 #include <jsoncpp/json/json.h>
 #include <jsoncpp/json/writer.h>
 
+#include "interface_table.hpp"
+#include "json_stream.hpp"
+#include "prefix_table.hpp"
 #include "../pskc-generator/pskc.hpp"
 #include "../utils/encoding.hpp"
 #include "../wpan-controller/wpan_controller.hpp"
@@ -66,10 +73,13 @@ namespace Web {
 /**
  * This class provides web service to manage WPAN.
  *
+ * The request handlers may be called from any thread, they are run one at a time.
+ *
  */
 class WpanService
 {
 public:
+
     /**
      * This method handles the http request to join network.
      *
@@ -90,9 +100,22 @@ public:
      */
     std::string HandleFormNetworkRequest(const std::string &aFormRequest);
 
+    /**
+     * This method derives the PSKc of a form request ahead of the request.
+     *
+     * The PSKc is kept in the cache of Psk::Pskc, so that the request does not derive it again. This method does
+     * not use the WPAN service, and may be called from any thread.
+     *
+     * @param[in]  aFormRequest  A reference to the http request of forming network.
+     *
+     */
+    void PrecomputePskc(const std::string &aFormRequest) const;
+
     /**
      * This method handles the http request to add on-mesh prefix.
      *
+     * The prefix is added to the prefixes desired, it is configured only if wpantund does not have it already.
+     *
      * @param[in]  aAddPrefixRequest  A reference to the http request of adding on-mesh prefix.
      *
      * @returns The string to the http response of adding on-mesh prefix.
@@ -103,6 +126,8 @@ public:
     /**
      * This method handles the http request to delete on-mesh prefix http request.
      *
+     * The prefix is removed from the prefixes desired, it is removed only if wpantund has it.
+     *
      * @param[in]  aDeleteRequest  A reference to the http request of deleting on-mesh prefix.
      *
      * @returns The string to the http response of deleting on-mesh prefix.
@@ -110,6 +135,20 @@ public:
      */
     std::string HandleDeletePrefixRequest(const std::string &aDeleteRequest);
 
+    /**
+     * This method handles the http request to set all on-mesh prefixes.
+     *
+     * The request lists the prefixes desired, e.g. {"prefixes":[{"prefix":"fd00::","defaultRoute":true}]}, of at
+     * most PrefixTable::kMaxPrefixes. Only the prefixes differing from those of wpantund are added, updated or
+     * removed, so that setting the same prefixes again does not change the Thread network data.
+     *
+     * @param[in]  aSetPrefixesRequest  A reference to the http request of setting on-mesh prefixes.
+     *
+     * @returns The string to the http response of setting on-mesh prefixes.
+     *
+     */
+    std::string HandleSetPrefixesRequest(const std::string &aSetPrefixesRequest);
+
     /**
      * This method handles http request to get netowrk status.
      *
@@ -121,18 +160,90 @@ public:
     /**
      * This method handles http request to get available networks.
      *
+     * A scan is started, the networks it finds are added to the scanned networks, which are all returned. A network
+     * is listed once per extended PAN ID, with its RSSI averaged across the scans finding it, and is dropped once no
+     * scan found it for a while.
+     *
      * @returns The string to the http response of getting available networks.
      *
      */
     std::string HandleAvailableNetworkRequest(void);
 
+    /**
+     * This method handles the http request to run several requests in order.
+     *
+     * The request is an array of operations, e.g. [{"operation":"add_prefix","request":{"prefix":"fd00::",
+     * "defaultRoute":true}}], of at most kMaxBatchOperations. The operations are "join_network", "form_network",
+     * "add_prefix", "delete_prefix", "set_prefixes", "get_properties" and "available_network", named after their http
+     * request. They share the DBus connection to wpantund, an operation failed does not stop the others.
+     *
+     * @param[in]  aBatchRequest  A reference to the http request of the batch.
+     *
+     * @returns The string to the http response of the batch, whose result is the array of the responses of the
+     *          operations, in order.
+     *
+     */
+    std::string HandleBatchRequest(const std::string &aBatchRequest);
+
+    /**
+     * This method gets the http response of getting available networks from the scanned networks, without a scan.
+     *
+     * This method may be called from any thread.
+     *
+     * @param[out]  aNetworks  A reference to receive the http response of getting available networks.
+     * @param[out]  aRefresh   A reference to receive whether the networks are due for a scan, which the caller is
+     *                         expected to run with HandleAvailableNetworkRequest(). It is only set once until then.
+     *
+     * @retval true   Successfully got the networks.
+     * @retval false  No recent scan found networks, HandleAvailableNetworkRequest() must be called.
+     *
+     */
+    bool GetAvailableNetworkSnapshot(std::string &aNetworks, bool &aRefresh);
+
+    /**
+     * This function pointer is called with each network found by a scan.
+     *
+     * @param[in]  aNetwork  A reference to the JSON object of the network, in the format of the available networks.
+     * @param[in]  aContext  A pointer to application-specific context.
+     *
+     */
+    typedef void (*NetworkHandler)(const std::string &aNetwork, void *aContext);
+
+    /**
+     * This method handles http request to get available networks, reporting each network as it is found.
+     *
+     * The networks found are also added to the scanned networks.
+     *
+     * @param[in]  aHandler  A pointer to the function called with each network found.
+     * @param[in]  aContext  A pointer to application-specific context.
+     *
+     * @returns The string to the http response of the scan result, without the networks.
+     *
+     */
+    std::string HandleAvailableNetworkRequest(NetworkHandler aHandler, void *aContext);
+
     /**
      * This method sets the interface name of the wpantund.
      *
      * @param[in]  aIfName  The pointer to the interface name of wpantund.
      *
      */
-    void SetInterfaceName(const char *aIfName) { strncpy(mIfName, aIfName, sizeof(mIfName)); }
+    void SetInterfaceName(const char *aIfName)
+    {
+        strncpy(mIfName, aIfName, sizeof(mIfName));
+        mWpanController.SetInterfaceName(aIfName);
+    }
+
+    /**
+     * This method sets the table the addresses and link state of the interface are reported from.
+     *
+     * While the table is valid, the status takes them from it instead of requesting them from wpantund, and their
+     * property changes are ignored in favor of HandleInterfaceChanged().
+     *
+     * @param[in]  aTable  A pointer to the table, which must outlive the service, NULL to request them from wpantund.
+     *
+     */
+    void SetInterfaceTable(const InterfaceTable *aTable) { mInterfaceTable = aTable; }
 
     /**
      * This method gets status of wpan service.
@@ -147,9 +258,127 @@ public:
      */
     int GetWpanServiceStatus(std::string &aNetworkName, std::string &aExtPanId) const;
 
+    /**
+     * This method sets whether the status is cached as a snapshot.
+     *
+     * The snapshot is only up to date while property changes are passed to HandlePropertyChanged(), so it must only
+     * be enabled while they are watched. Disabling it drops the snapshot.
+     *
+     * @param[in]  aEnabled  Whether to cache the status.
+     *
+     */
+    void SetStatusSnapshotEnabled(bool aEnabled);
+
+    /**
+     * This method gets the http response of the last status request, kept up to date by the property changes.
+     *
+     * Each change of the snapshot makes a new version, identified by a weak ETag. A client which has the current
+     * version gets an empty response. With @p aDelta, a client which has one of the recent versions gets the members
+     * changed since, as a JSON merge patch (RFC 7396) in the "delta" member, instead of the whole status in "result".
+     *
+     * This method may be called from any thread.
+     *
+     * @param[in]   aIfNoneMatch  The ETags of the versions the client has, from its If-None-Match header.
+     * @param[in]   aDelta        Whether the client accepts the changes since the version it has.
+     * @param[out]  aStatus       A reference to receive the http response of getting status, empty if not modified.
+     * @param[out]  aEtag         A reference to receive the ETag of the current version.
+     *
+     * @retval true   Successfully got the snapshot.
+     * @retval false  No snapshot, HandleStatusRequest() must be called.
+     *
+     */
+    bool GetStatusSnapshot(const std::string &aIfNoneMatch, bool aDelta, std::string &aStatus, std::string &aEtag);
+
+    /**
+     * This method updates the status snapshot with a changed property.
+     *
+     * A change of the NCP state drops the snapshot, as the properties reported depend on it. This method may be
+     * called from any thread.
+     *
+     * @param[in]  aName   A pointer to the property name.
+     * @param[in]  aValue  A pointer to the property value.
+     *
+     * @returns The JSON object of the changed status property, empty if the property is not part of the status.
+     *
+     */
+    std::string HandlePropertyChanged(const char *aName, const char *aValue);
+
+    /**
+     * This method updates the status snapshot with the state of the interface table.
+     *
+     * This method may be called from any thread.
+     *
+     * @returns The JSON object of the changed status properties, empty if none changed.
+     *
+     */
+    std::string HandleInterfaceChanged(void);
+
 private:
-    ot::Dbus::WpanNetworkInfo mNetworks[DBUS_MAXIMUM_NAME_LENGTH];
-    int                       mNetworksCount;
+    struct ScanContext
+    {
+        WpanService *  mService;
+        NetworkHandler mHandler;
+        void *         mContext;
+    };
+
+    /**
+     * This structure represents a network found by scans.
+     *
+     */
+    struct ScannedNetwork
+    {
+        ot::Dbus::WpanNetworkInfo mInfo;     ///< The last beacon of the network, with the RSSI averaged.
+        uint64_t                  mLastSeen; ///< Monotonic time in milliseconds the network was last found.
+    };
+
+    /**
+     * This structure represents the change of a version of the status snapshot.
+     *
+     */
+    struct StatusDelta
+    {
+        uint64_t    mVersion; ///< The version made by the change.
+        Json::Value mPatch;   ///< The members changed, null for those removed.
+    };
+
+    /**
+     * This structure keeps the members of the requests, whose buffers are reused across requests.
+     *
+     */
+    struct RequestFields
+    {
+        std::string  mNetworkKey;
+        std::string  mPrefix;
+        std::string  mNetworkName;
+        std::string  mPassphrase;
+        std::string  mPanId;
+        std::string  mExtPanId;
+        unsigned int mIndex;
+        unsigned int mChannel;
+        bool         mDefaultRoute;
+    };
+
+    static bool ParseRequest(const std::string &aRequest, const JsonReader::Field *aFields, size_t aCount);
+    std::string WriteResult(int aError) const;
+
+    static void HandleScanBeacon(const ot::Dbus::WpanNetworkInfo &aNetwork, void *aContext);
+    static void GetNetworkInfo(const ot::Dbus::WpanNetworkInfo &aNetwork, Json::Value &aNetworkInfo);
+    void        StoreScannedNetwork(const ot::Dbus::WpanNetworkInfo &aNetwork);
+    void        FinishScan(bool aSucceeded);
+    std::string WriteScannedNetworks(void) const;
+    bool        FindScannedNetwork(const std::string &        aExtPanId,
+                                   unsigned int               aIndex,
+                                   ot::Dbus::WpanNetworkInfo &aNetwork);
+
+    int ApplyPrefixes(const uint8_t *aOnly);
+
+    bool     IsInterfaceProperty(const char *aName) const;
+    void     GetInterfaceInfo(const std::string &aMeshLocalPrefix, Json::Value &aNetworkInfo) const;
+    uint32_t GetStatusGeneration(void);
+    void     StoreStatusSnapshot(uint32_t aGeneration, const Json::Value &aNetworkInfo, const std::string &aStatus);
+    void     UpdateStatusSnapshot(const Json::Value &aChanges);
+    void     AddStatusVersion(const Json::Value &aPatch);
+
     char                      mIfName[IFNAMSIZ];
     std::string               mNetworkName;
     std::string               mExtPanId;
@@ -158,6 +387,45 @@ private:
     const char *              mServiceUp       = "up";
     const char *              mServiceDown     = "down";
 
+    const InterfaceTable *mInterfaceTable = NULL; ///< Reports the addresses and link state of the interface.
+
+    // Kept across requests, so that the DBus connection and name lookup are shared by them.
+    ot::Dbus::WPANController mWpanController;
+
+    std::mutex    mRequestMutex; ///< Serializes the requests, which share the scanned networks and the DBus connection.
+    RequestFields mRequest;      ///< The members of the current request.
+    PrefixTable   mPrefixTable;  ///< The on-mesh prefixes desired, and those of wpantund.
+
+    std::mutex  mSnapshotMutex;              ///< Guards the snapshot, which is read from the http server thread.
+    bool        mSnapshotEnabled    = false; ///< Whether the status is cached.
+    bool        mSnapshotValid      = false; ///< Whether the snapshot is up to date.
+    uint32_t    mSnapshotGeneration = 0;     ///< Number of status properties changed.
+    Json::Value mSnapshotInfo;               ///< The network info of the snapshot.
+    std::string mSnapshot;                   ///< The http response of the snapshot.
+
+    uint32_t                mSnapshotEpoch   = std::random_device()(); ///< Tells the versions of processes apart.
+    uint64_t                mSnapshotVersion = 0;                      ///< Number of changes of the snapshot.
+    std::string             mSnapshotEtag;                             ///< The weak ETag of the current version.
+    std::deque<StatusDelta> mSnapshotDeltas;                           ///< The recent changes, the oldest first.
+
+    std::mutex     mNetworksMutex;               ///< Guards the scanned networks, read from the http server thread.
+    ScannedNetwork mNetworks[OT_SCANNED_NET_BUFFER_SIZE];
+    int            mNetworksCount      = 0;
+    uint64_t       mLastScan           = 0;     ///< Monotonic time in milliseconds of the last scan, 0 if none.
+    bool           mScanRefreshPending = false; ///< Whether a scan was asked for by GetAvailableNetworkSnapshot().
+
+    enum
+    {
+        kMaxBatchOperations = 32, ///< Max number of operations of a batch request.
+        kMaxStatusDeltas    = 16, ///< Number of recent changes of the status snapshot kept for clients.
+    };
+
+    enum
+    {
+        kScannedNetworkTimeout = 60000, ///< Time in milliseconds a network is kept after it was last found.
+        kScannedNetworkRefresh = 15000, ///< Age in milliseconds of the last scan due for a refresh.
+    };
+
     enum
     {
         kWpanStatus_OK = 0,
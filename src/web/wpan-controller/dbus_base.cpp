@@ -32,20 +32,46 @@
  *
  */
 
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_WEB
+
 #include "common/code_utils.hpp"
 
 #include "dbus_base.hpp"
 #include "wpan_controller.hpp"
 
-#define OT_DEFAULT_TIMEOUT_IN_MILLISECONDS 60 * 1000
-
 namespace ot {
 namespace Dbus {
 
+DBusBase::DBusBase(void)
+    : mConnection(NULL)
+    , mMessage(NULL)
+    , mReply(NULL)
+    , mPending(NULL)
+    , mMethod(NULL)
+{
+    mDBusName[0]      = '\0';
+    mInterfaceName[0] = '\0';
+    mDestination[0]   = '\0';
+    mPath[0]          = '\0';
+    mIface[0]         = '\0';
+}
+
+void DBusBase::SetConnection(DBusConnection *aConnection)
+{
+    if (mConnection != NULL)
+    {
+        dbus_connection_unref(mConnection);
+    }
+
+    mConnection = (aConnection != NULL) ? dbus_connection_ref(aConnection) : NULL;
+}
+
 DBusConnection *DBusBase::GetConnection(void)
 {
     DBusError error;
 
+    VerifyOrExit(mConnection == NULL);
+
     dbus_error_init(&error);
     mConnection = dbus_bus_get(DBUS_BUS_STARTER, &error);
     if (!mConnection)
@@ -59,25 +85,34 @@ DBusConnection *DBusBase::GetConnection(void)
         otbrLog(OTBR_LOG_ERR, "connection error: %s", error.message);
         dbus_error_free(&error);
     }
+
+exit:
     return mConnection;
 }
 
-DBusMessage *DBusBase::GetMessage(void)
+DBusMessage *DBusBase::NewMessage(void) const
 {
-    int ret = kWpantundStatus_Ok;
+    int          ret     = kWpantundStatus_Ok;
+    DBusMessage *message = NULL;
 
     VerifyOrExit(strnlen(mDestination, sizeof(mDestination)) != 0, ret = kWpantundStatus_InvalidArgument);
     VerifyOrExit(mPath != NULL, ret = kWpantundStatus_InvalidArgument);
     VerifyOrExit(mIface != NULL, ret = kWpantundStatus_InvalidArgument);
     VerifyOrExit(mMethod != NULL, ret = kWpantundStatus_InvalidArgument);
-    mMessage = dbus_message_new_method_call(mDestination, mPath, mIface, mMethod);
-    VerifyOrExit(mMessage != NULL, ret = kWpantundStatus_InvalidMessage);
+    message = dbus_message_new_method_call(mDestination, mPath, mIface, mMethod);
+    VerifyOrExit(message != NULL, ret = kWpantundStatus_InvalidMessage);
 
 exit:
     if (ret != kWpantundStatus_Ok)
     {
         otbrLog(OTBR_LOG_ERR, "message is NULL");
     }
+    return message;
+}
+
+DBusMessage *DBusBase::GetMessage(void)
+{
+    mMessage = NewMessage();
     return mMessage;
 }
 
@@ -128,21 +163,56 @@ exit:
     return mPending;
 }
 
+int DBusBase::ReadStatus(DBusPendingCall *aPending)
+{
+    int          ret    = kWpantundStatus_Ok;
+    int32_t      status = 0;
+    DBusMessage *reply  = NULL;
+    DBusError    error;
+
+    dbus_error_init(&error);
+    dbus_pending_call_block(aPending);
+    reply = dbus_pending_call_steal_reply(aPending);
+    dbus_pending_call_unref(aPending);
+
+    VerifyOrExit(reply != NULL, ret = kWpantundStatus_InvalidReply);
+
+    VerifyOrExit(!dbus_set_error_from_message(&error, reply), ret = kWpantundStatus_InvalidReply);
+    VerifyOrExit(dbus_message_get_args(reply, &error, DBUS_TYPE_INT32, &status, DBUS_TYPE_INVALID),
+                 ret = kWpantundStatus_InvalidReply);
+    ret = status;
+
+exit:
+    if (dbus_error_is_set(&error))
+    {
+        otbrLog(OTBR_LOG_ERR, "reply error: %s", error.message);
+        dbus_error_free(&error);
+    }
+    if (reply != NULL)
+    {
+        dbus_message_unref(reply);
+    }
+    return ret;
+}
+
 void DBusBase::free()
 {
     if (mConnection)
     {
         dbus_connection_unref(mConnection);
+        mConnection = NULL;
     }
 
     if (mMessage)
     {
         dbus_message_unref(mMessage);
+        mMessage = NULL;
     }
 
     if (mReply)
     {
         dbus_message_unref(mReply);
+        mReply = NULL;
     }
 }
 
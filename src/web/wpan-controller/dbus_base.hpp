@@ -38,12 +38,24 @@
 
 #include "common/logging.hpp"
 
+#define OT_DEFAULT_TIMEOUT_IN_MILLISECONDS 60 * 1000
+
 namespace ot {
 namespace Dbus {
 
 class DBusBase
 {
 public:
+    DBusBase(void);
+
+    /**
+     * This method sets a connection shared with other requests, instead of getting the bus connection.
+     *
+     * @param[in]   aConnection     A pointer to the connection, a reference of which is kept until free().
+     *
+     */
+    void SetConnection(DBusConnection *aConnection);
+
     DBusConnection * GetConnection(void);
     DBusMessage *    GetMessage(void);
     DBusMessage *    GetReply(void);
@@ -52,6 +64,26 @@ public:
     char *           GetDBusName(void);
     void             free(void);
 
+    /**
+     * This method creates a method call message from the destination, path, interface and method set.
+     *
+     * Unlike GetMessage(), the message is owned by the caller, so that several calls may be in flight at once.
+     *
+     * @returns A pointer to the message, NULL on failure.
+     *
+     */
+    DBusMessage *NewMessage(void) const;
+
+    /**
+     * This method waits for the reply of a method call returning a wpantund status, and releases the pending call.
+     *
+     * @param[in]   aPending    A pointer to the pending call.
+     *
+     * @returns The status returned by wpantund, kWpantundStatus_InvalidReply if the reply is invalid.
+     *
+     */
+    static int ReadStatus(DBusPendingCall *aPending);
+
     void SetDestination(const char *aDestination);
     void SetInterface(const char *aIface);
     void SetMethod(const char *aMethod);
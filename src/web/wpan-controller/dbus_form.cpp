@@ -40,34 +40,19 @@
 namespace ot {
 namespace Dbus {
 
-int DBusForm::ProcessReply(void)
+int DBusForm::NewRequest(DBusMessage *&aMessage)
 {
-    int          ret      = 0;
-    const char * method   = "Form";
-    DBusMessage *messsage = NULL;
-    DBusMessage *reply    = NULL;
-    DBusError    error;
+    int ret = kWpantundStatus_Ok;
 
-    dbus_error_init(&error);
-    VerifyOrExit(GetConnection() != NULL, ret = kWpantundStatus_InvalidConnection);
-    SetMethod(method);
-
-    VerifyOrExit((messsage = GetMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
+    aMessage = NULL;
     VerifyOrExit(mNetworkName != NULL, ret = kWpantundStatus_InvalidArgument);
+    SetMethod("Form");
+    VerifyOrExit((aMessage = NewMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
 
-    dbus_message_append_args(messsage, DBUS_TYPE_STRING, &mNetworkName, DBUS_TYPE_INT16, &mNodeType, DBUS_TYPE_UINT32,
+    dbus_message_append_args(aMessage, DBUS_TYPE_STRING, &mNetworkName, DBUS_TYPE_INT16, &mNodeType, DBUS_TYPE_UINT32,
                              &mChannelMask, DBUS_TYPE_INVALID);
 
-    VerifyOrExit((reply = GetReply()) != NULL, ret = kWpantundStatus_InvalidReply);
-    dbus_message_get_args(reply, &error, DBUS_TYPE_INT32, &ret, DBUS_TYPE_INVALID);
-
 exit:
-    if (dbus_error_is_set(&error))
-    {
-        otbrLog(OTBR_LOG_ERR, "form error: %s", error.message);
-        dbus_error_free(&error);
-    }
-    free();
     return ret;
 }
 
@@ -58,7 +58,17 @@ public:
     void SetNodeType(uint16_t aNodeType) { mNodeType = aNodeType; }
     void SetChannelMask(uint32_t aChannelMask) { mChannelMask = 1 << aChannelMask; }
 
-    int ProcessReply(void);
+    /**
+     * This method creates the Form method call message from the network name, node type and channel set.
+     *
+     * @param[out]  aMessage    A reference to receive the message, owned by the caller. NULL on failure.
+     *
+     * @retval kWpantundStatus_Ok               Successfully created the message.
+     * @retval kWpantundStatus_InvalidMessage   Failed to create the message.
+     * @retval kWpantundStatus_InvalidArgument  The network name is not set.
+     *
+     */
+    int NewRequest(DBusMessage *&aMessage);
 
 private:
     const char *mNetworkName;
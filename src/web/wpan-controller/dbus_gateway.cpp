@@ -45,21 +45,14 @@ DBusGateway::DBusGateway(void)
 {
 }
 
-int DBusGateway::ProcessReply(void)
+int DBusGateway::NewRequest(DBusMessage *&aMessage)
 {
-    int          ret      = 0;
-    const char * method   = "ConfigGateway";
-    DBusMessage *messsage = NULL;
-    DBusMessage *reply    = NULL;
-    DBusError    error;
+    int ret = kWpantundStatus_Ok;
 
-    dbus_error_init(&error);
-    VerifyOrExit(GetConnection() != NULL, ret = kWpantundStatus_InvalidConnection);
-    SetMethod(method);
+    SetMethod("ConfigGateway");
+    VerifyOrExit((aMessage = NewMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
 
-    VerifyOrExit((messsage = GetMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
-
-    dbus_message_append_args(messsage, DBUS_TYPE_BOOLEAN, &mDefaultRoute, DBUS_TYPE_INVALID);
+    dbus_message_append_args(aMessage, DBUS_TYPE_BOOLEAN, &mDefaultRoute, DBUS_TYPE_INVALID);
 
     if (mPrefix)
     {
@@ -80,19 +73,15 @@ int DBusGateway::ProcessReply(void)
 
     mAddr = mPrefixBytes;
 
-    dbus_message_append_args(messsage, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &mAddr, 16, DBUS_TYPE_UINT32,
+    dbus_message_append_args(aMessage, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &mAddr, 16, DBUS_TYPE_UINT32,
                              &mPreferredLifetime, DBUS_TYPE_UINT32, &mValidLifetime, DBUS_TYPE_INVALID);
 
-    VerifyOrExit((reply = GetReply()) != NULL, ret = kWpantundStatus_InvalidReply);
-    dbus_message_get_args(reply, &error, DBUS_TYPE_INT32, &ret, DBUS_TYPE_INVALID);
-
 exit:
-    if (dbus_error_is_set(&error))
+    if (ret != kWpantundStatus_Ok && aMessage != NULL)
     {
-        otbrLog(OTBR_LOG_ERR, "gateway error: %s", error.message);
-        dbus_error_free(&error);
+        dbus_message_unref(aMessage);
+        aMessage = NULL;
     }
-    free();
     return ret;
 }
 
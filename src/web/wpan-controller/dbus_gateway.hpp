@@ -52,7 +52,6 @@ class DBusGateway : public DBusBase
 public:
     DBusGateway(void);
 
-    int  ProcessReply(void);
     void SetDefaultRoute(dbus_bool_t aDefaultRoute) { mDefaultRoute = aDefaultRoute; }
     void SetValidLifeTime(uint32_t aValidLifetime) { mValidLifetime = aValidLifetime; }
     void SetPreferredLifetime(uint32_t aPreferredLifetime) { mPreferredLifetime = aPreferredLifetime; }
@@ -65,6 +64,18 @@ public:
     void SetPrefixBytes(uint8_t *aPrefixBytes) { memcpy(mPrefixBytes, aPrefixBytes, sizeof(mPrefixBytes)); }
     void SetAddr(uint8_t *aAddr) { mAddr = aAddr; }
 
+    /**
+     * This method creates the ConfigGateway method call message, the prefix is either an address or hex.
+     *
+     * @param[out]  aMessage    A reference to receive the message, owned by the caller. NULL on failure.
+     *
+     * @retval kWpantundStatus_Ok               Successfully created the message.
+     * @retval kWpantundStatus_InvalidMessage   Failed to create the message.
+     * @retval kWpantundStatus_InvalidArgument  The prefix is invalid.
+     *
+     */
+    int NewRequest(DBusMessage *&aMessage);
+
 private:
     dbus_bool_t mDefaultRoute;
     uint32_t    mPreferredLifetime;
@@ -35,203 +35,386 @@
 
 #include "dbus_get.hpp"
 
+#include "utils/hex.hpp"
+#include "web-service/json_stream.hpp"
+
 namespace ot {
 namespace Dbus {
 
-static void DumpInfoFromIter(char *aOutput, DBusMessageIter *aIter, int aIndent, bool aBare)
+using ot::Web::JsonWriter;
+
+namespace Bus = ot::BorderRouter::Bus;
+
+enum
 {
-    DBusMessageIter subIter;
+    kMaxHexChunk = 0x8000, ///< Max number of bytes converted to hex at once.
+};
 
-    switch (dbus_message_iter_get_arg_type(aIter))
+/**
+ * This function formats a basic value without a JSON representation of its own, like the hex integers of wpantund.
+ *
+ */
+static void FormatBasic(Bus::Reader &aReader, char *aText, size_t aSize)
+{
+    int type = aReader.GetType();
+
+    switch (type)
+    {
+    case Bus::kTypeByte:
+    {
+        uint8_t v;
+        aReader.ReadBasic(type, &v);
+        snprintf(aText, aSize, "%02X", v);
+        break;
+    }
+    case Bus::kTypeUint16:
+    {
+        uint16_t v;
+        aReader.ReadBasic(type, &v);
+        snprintf(aText, aSize, "0x%04X", v);
+        break;
+    }
+    case Bus::kTypeInt16:
     {
-    case DBUS_TYPE_DICT_ENTRY:
-        dbus_message_iter_recurse(aIter, &subIter);
-        DumpInfoFromIter(aOutput, &subIter, aIndent + 1, true);
-        dbus_message_iter_next(&subIter);
-        DumpInfoFromIter(aOutput, &subIter, aIndent + 1, true);
+        int16_t v;
+        aReader.ReadBasic(type, &v);
+        snprintf(aText, aSize, "%d", v);
+        break;
+    }
+    case Bus::kTypeUint32:
+    {
+        uint32_t v;
+        aReader.ReadBasic(type, &v);
+        snprintf(aText, aSize, "%u", v);
         break;
-    case DBUS_TYPE_ARRAY:
-        dbus_message_iter_recurse(aIter, &subIter);
-        if (dbus_message_iter_get_arg_type(&subIter) == DBUS_TYPE_BYTE ||
-            dbus_message_iter_get_arg_type(&subIter) == DBUS_TYPE_INVALID)
+    }
+    case Bus::kTypeInt32:
+    {
+        int32_t v;
+        aReader.ReadBasic(type, &v);
+        snprintf(aText, aSize, "%d", v);
+        break;
+    }
+    case Bus::kTypeUint64:
+    {
+        uint64_t v;
+        aReader.ReadBasic(type, &v);
+        snprintf(aText, aSize, "0x%016llX", static_cast<unsigned long long>(v));
+        break;
+    }
+    case Bus::kTypeBoolean:
+    {
+        int v;
+        aReader.ReadBasic(type, &v);
+        snprintf(aText, aSize, "%s", v ? "true" : "false");
+        break;
+    }
+    default:
+        snprintf(aText, aSize, "<%c>", type);
+        aReader.Skip();
+        break;
+    }
+}
+
+static void AppendBytes(std::string &aOutput, Bus::Reader &aReader)
+{
+    const uint8_t *bytes  = NULL;
+    size_t         length = 0;
+
+    if (!aReader.ReadBytes(bytes, length))
+    {
+        aReader.Skip();
+    }
+
+    while (length > 0)
+    {
+        uint16_t chunk = static_cast<uint16_t>(length < kMaxHexChunk ? length : static_cast<size_t>(kMaxHexChunk));
+        size_t   end   = aOutput.size();
+
+        // Bytes2Hex() terminates the hex, one more char is reserved for it.
+        aOutput.resize(end + chunk * 2 + 1);
+        aOutput.resize(end + ot::Utils::Bytes2Hex(bytes, chunk, &aOutput[end]));
+        bytes += chunk;
+        length -= chunk;
+    }
+}
+
+static bool IsBytes(Bus::Reader &aReader)
+{
+    int elementType = aReader.GetElementType();
+
+    return elementType == Bus::kTypeByte || elementType == Bus::kTypeInvalid;
+}
+
+/**
+ * This function writes a value nested in a container as JSON.
+ *
+ * Byte arrays are hex strings, dict arrays are objects keyed by the text of their keys.
+ *
+ */
+static void DumpJson(JsonWriter &aWriter, Bus::Reader &aReader)
+{
+    char text[32];
+    int  type = aReader.GetType();
+
+    switch (type)
+    {
+    case Bus::kTypeDictEntry:
+        VerifyOrExit(aReader.Enter(), aReader.Skip());
+
+        if (aReader.GetType() == Bus::kTypeString)
+        {
+            const char *key;
+            aReader.ReadBasic(Bus::kTypeString, &key);
+            aWriter.Key(key);
+        }
+        else
         {
-            strcat(aOutput, "[");
-            aIndent = 0;
+            FormatBasic(aReader, text, sizeof(text));
+            aWriter.Key(text);
+        }
+
+        DumpJson(aWriter, aReader);
+        aReader.Leave();
+        break;
+    case Bus::kTypeArray:
+    {
+        bool isObject = aReader.GetElementType() == Bus::kTypeDictEntry;
+
+        if (aReader.GetElementType() == Bus::kTypeByte)
+        {
+            std::string bytes;
+
+            AppendBytes(bytes, aReader);
+            aWriter.String(bytes.c_str());
+            break;
+        }
+
+        VerifyOrExit(aReader.Enter(), aReader.Skip());
+
+        if (isObject)
+        {
+            aWriter.BeginObject();
         }
         else
         {
-            strcat(aOutput, "[");
+            aWriter.BeginArray();
         }
 
-        for (; dbus_message_iter_get_arg_type(&subIter) != DBUS_TYPE_INVALID; dbus_message_iter_next(&subIter))
+        while (aReader.GetType() != Bus::kTypeInvalid)
         {
-            DumpInfoFromIter(aOutput, &subIter, aIndent + 1,
-                             dbus_message_iter_get_arg_type(&subIter) == DBUS_TYPE_BYTE);
+            DumpJson(aWriter, aReader);
         }
-        for (int i = 0; i < aIndent; i++)
+
+        if (isObject)
         {
-            strcat(aOutput, "\t");
+            aWriter.EndObject();
         }
-        strcat(aOutput, "]");
+        else
+        {
+            aWriter.EndArray();
+        }
+
+        aReader.Leave();
         break;
-    case DBUS_TYPE_VARIANT:
-        dbus_message_iter_recurse(aIter, &subIter);
-        DumpInfoFromIter(aOutput, &subIter, aIndent, true);
+    }
+    case Bus::kTypeVariant:
+        VerifyOrExit(aReader.Enter(), aReader.Skip());
+        DumpJson(aWriter, aReader);
+        aReader.Leave();
         break;
-    case DBUS_TYPE_STRING:
+    case Bus::kTypeString:
     {
         const char *string;
-        dbus_message_iter_get_basic(aIter, &string);
-        strcat(aOutput, string);
+        aReader.ReadBasic(type, &string);
+        aWriter.String(string);
         break;
     }
-
-    case DBUS_TYPE_BYTE:
+    case Bus::kTypeByte:
     {
         uint8_t v;
-        char    temp[3];
-        dbus_message_iter_get_basic(aIter, &v);
-        snprintf(temp, 3, "%02X", v);
-        strcat(aOutput, temp);
-        break;
-    }
-    case DBUS_TYPE_UINT16:
-    {
-        uint16_t v;
-        char     temp[9];
-        dbus_message_iter_get_basic(aIter, &v);
-        snprintf(temp, 9, "0x%04X", v);
-        strcat(aOutput, temp);
+        aReader.ReadBasic(type, &v);
+        aWriter.Unsigned(v);
         break;
     }
-    case DBUS_TYPE_INT16:
+    case Bus::kTypeInt16:
     {
         int16_t v;
-        char    temp[5];
-        dbus_message_iter_get_basic(aIter, &v);
-        int vLen = floor(log10(abs(v))) + 2;
-        snprintf(temp, vLen, "%d", v);
-        strcat(aOutput, temp);
+        aReader.ReadBasic(type, &v);
+        aWriter.Int(v);
         break;
     }
-    case DBUS_TYPE_UINT32:
+    case Bus::kTypeUint32:
     {
         uint32_t v;
-        char     temp[10];
-        dbus_message_iter_get_basic(aIter, &v);
-        int vLen = floor(log10(v)) + 2;
-        snprintf(temp, vLen, "%d", v);
-        strcat(aOutput, temp);
-        break;
-    }
-    case DBUS_TYPE_BOOLEAN:
-    {
-        dbus_bool_t v;
-        char        temp[6];
-        dbus_message_iter_get_basic(aIter, &v);
-        snprintf(temp, 6, "%s", v ? "true" : "false");
-        strcat(aOutput, temp);
+        aReader.ReadBasic(type, &v);
+        aWriter.Unsigned(v);
         break;
     }
-    case DBUS_TYPE_INT32:
+    case Bus::kTypeInt32:
     {
         int32_t v;
-        char    temp[10];
-        dbus_message_iter_get_basic(aIter, &v);
-        int vLen = floor(log10(abs(v))) + 2;
-        snprintf(temp, vLen, "%d", v);
-        strcat(aOutput, temp);
+        aReader.ReadBasic(type, &v);
+        aWriter.Int(v);
         break;
     }
-    case DBUS_TYPE_UINT64:
+    case Bus::kTypeBoolean:
     {
-        uint64_t v;
-        char     temp[19];
-        dbus_message_iter_get_basic(aIter, &v);
-        snprintf(temp, 19, "0x%016llX", (unsigned long long)v);
-        strcat(aOutput, temp);
+        int v;
+        aReader.ReadBasic(type, &v);
+        aWriter.Bool(v);
         break;
     }
     default:
-        char temp[100];
-        snprintf(temp, 100, "<%s>", dbus_message_type_to_string(dbus_message_iter_get_arg_type(aIter)));
-        strcat(aOutput, temp);
+        FormatBasic(aReader, text, sizeof(text));
+        aWriter.String(text);
         break;
     }
 
-    (void)aBare;
+exit:
+    return;
 }
 
-int DBusGet::ProcessReply(void)
+/**
+ * This function appends a property value to @p aOutput.
+ *
+ * Strings and basic values are appended as their text and byte arrays as bracketed hex, as the web service reads
+ * them. Other containers, like the address and neighbor tables, are appended as JSON.
+ *
+ */
+static void DumpValue(std::string &aOutput, Bus::Reader &aReader)
 {
-    int          ret      = 0;
-    const char * method   = "PropGet";
-    DBusMessage *messsage = NULL;
-    DBusMessage *reply    = NULL;
-
-    VerifyOrExit(GetConnection() != NULL, ret = kWpantundStatus_InvalidConnection);
-    SetMethod(method);
-    VerifyOrExit((messsage = GetMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
-    dbus_message_append_args(messsage, DBUS_TYPE_STRING, &mPropertyName, DBUS_TYPE_INVALID);
-    VerifyOrExit((reply = GetReply()) != NULL, ret = kWpantundStatus_InvalidReply);
-    dbus_message_iter_init(reply, &mIter);
-    // Get return code
-    dbus_message_iter_get_basic(&mIter, &ret);
-
-    if (ret)
-    {
-        const char *error = NULL;
+    char text[32];
 
-        // Try to see if there is an error explanation we can extract
-        dbus_message_iter_next(&mIter);
-        if (dbus_message_iter_get_arg_type(&mIter) == DBUS_TYPE_STRING)
+    switch (aReader.GetType())
+    {
+    case Bus::kTypeVariant:
+        VerifyOrExit(aReader.Enter(), aReader.Skip());
+        DumpValue(aOutput, aReader);
+        aReader.Leave();
+        break;
+    case Bus::kTypeString:
+    {
+        const char *string;
+        aReader.ReadBasic(Bus::kTypeString, &string);
+        aOutput += string;
+        break;
+    }
+    case Bus::kTypeArray:
+        if (IsBytes(aReader))
         {
-            dbus_message_iter_get_basic(&mIter, &error);
+            aOutput += '[';
+            AppendBytes(aOutput, aReader);
+            aOutput += ']';
+            break;
         }
+        // fall through
+    case Bus::kTypeDictEntry:
+    {
+        JsonWriter writer(aOutput);
 
-        if (!error || error[0] == 0)
-        {
-            error = (ret < 0) ? strerror(-ret) : "Get failed";
-        }
+        DumpJson(writer, aReader);
+        break;
     }
-    else
-    {
-        dbus_message_iter_next(&mIter);
+    default:
+        FormatBasic(aReader, text, sizeof(text));
+        aOutput += text;
+        break;
     }
 
 exit:
+    return;
+}
+
+static void CopyValue(const std::string &aValue, char *aOutput)
+{
+    size_t length = aValue.size() < OT_PROPERTY_VALUE_SIZE ? aValue.size() : OT_PROPERTY_VALUE_SIZE - 1;
+
+    memcpy(aOutput, aValue.data(), length);
+    aOutput[length] = '\0';
+}
+
+void DBusGet::DumpPropertyValue(Bus::Reader &aReader, std::string &aValue)
+{
+    aValue.clear();
+    DumpValue(aValue, aReader);
+}
+
+void DBusGet::DumpPropertyValue(Bus::Reader &aReader, char *aValue)
+{
+    std::string value;
+
+    DumpPropertyValue(aReader, value);
+    CopyValue(value, aValue);
+}
+
+DBusGet::DBusGet(Bus::Connection &aBus, const Bus::Method &aMethod)
+    : mBus(aBus)
+    , mMethod(aMethod)
+    , mReader(NULL)
+    , mCall(0)
+    , mPropertyName(NULL)
+{
+}
+
+DBusGet::~DBusGet(void)
+{
+    ReleaseReply();
+}
 
-    free();
+void DBusGet::ReleaseReply(void)
+{
+    if (mReader != NULL)
+    {
+        mBus.Release(mCall);
+        mReader = NULL;
+    }
+}
+
+int DBusGet::ProcessReply(void)
+{
+    int           ret    = kWpantundStatus_Ok;
+    int32_t       status = 0;
+    Bus::Argument name   = {Bus::kTypeString, mPropertyName, 0};
+
+    ReleaseReply();
+    VerifyOrExit((mReader = mBus.Call(mMethod, &name, 1, OT_DEFAULT_TIMEOUT_IN_MILLISECONDS, mCall)) != NULL,
+                 ret = kWpantundStatus_InvalidReply);
+    VerifyOrExit(mReader->ReadBasic(Bus::kTypeInt32, &status), ret = kWpantundStatus_InvalidReply);
+
+    // The value, or an explanation of the error, follows the status.
+    ret = status;
+
+exit:
     return ret;
 }
 
 const char *DBusGet::GetPropertyValue(const char *aPropertyName)
 {
     SetPropertyName(aPropertyName);
-    memset(mPropertyValue, 0, OT_PROPERTY_VALUE_SIZE);
+    mPropertyValue.clear();
     VerifyOrExit(ProcessReply() == kWpantundStatus_Ok);
-    DumpInfoFromIter(mPropertyValue, &mIter, 0, false);
+    DumpValue(mPropertyValue, *mReader);
 exit:
-    return mPropertyValue;
+    return mPropertyValue.c_str();
 }
 
 int DBusGet::GetAllPropertyNames(void)
 {
-    DBusMessageIter listIter;
-
     int propCnt = 0;
 
     SetPropertyName("");
-    ProcessReply();
-    dbus_message_iter_recurse(&mIter, &listIter);
+    VerifyOrExit(ProcessReply() == kWpantundStatus_Ok && mReader->Enter());
 
-    for (; dbus_message_iter_get_arg_type(&listIter) == DBUS_TYPE_STRING; dbus_message_iter_next(&listIter))
+    while (propCnt < OT_LIST_MAX_LENGTH && mReader->GetType() == Bus::kTypeString)
     {
-        char *pName;
-        dbus_message_iter_get_basic(&listIter, &pName);
+        const char *pName;
+        mReader->ReadBasic(Bus::kTypeString, &pName);
         strncpy(mPropertyList[propCnt].name, pName, sizeof(mPropertyList[propCnt].name));
         propCnt++;
     }
+
+exit:
     return propCnt;
 }
 
@@ -243,6 +426,62 @@ void DBusGet::GetAllPropertyValues(int propCnt)
     }
 }
 
+int DBusGet::GetPropertyValues(PropertyNameValue *aProperties, size_t aCount)
+{
+    int          ret = kWpantundStatus_Ok;
+    unsigned int calls[OT_LIST_MAX_LENGTH];
+    size_t       sent = 0;
+
+    VerifyOrExit(aCount <= OT_LIST_MAX_LENGTH, ret = kWpantundStatus_InvalidArgument);
+
+    for (size_t i = 0; i < aCount; i++)
+    {
+        memset(aProperties[i].value, 0, sizeof(aProperties[i].value));
+    }
+
+    for (; sent < aCount; sent++)
+    {
+        Bus::Argument name = {Bus::kTypeString, aProperties[sent].name, 0};
+
+        VerifyOrExit(mBus.Send(mMethod, &name, 1, OT_DEFAULT_TIMEOUT_IN_MILLISECONDS, calls[sent]) ==
+                         OTBR_ERROR_NONE,
+                     ret = kWpantundStatus_InvalidPending);
+    }
+
+exit:
+    // Replies are read even after a failure, so that every call sent is released.
+    for (size_t i = 0; i < sent; i++)
+    {
+        int readRet = ReadPropertyValue(calls[i], aProperties[i].value);
+
+        if (ret == kWpantundStatus_Ok)
+        {
+            ret = readRet;
+        }
+    }
+
+    return ret;
+}
+
+int DBusGet::ReadPropertyValue(unsigned int aCall, char *aValue)
+{
+    int          ret    = kWpantundStatus_Ok;
+    int32_t      status = 0;
+    Bus::Reader *reader = mBus.Wait(aCall);
+    std::string  value;
+
+    VerifyOrExit(reader != NULL && reader->ReadBasic(Bus::kTypeInt32, &status), ret = kWpantundStatus_InvalidReply);
+
+    // A property wpantund failed to get is left empty, as GetPropertyValue() does.
+    VerifyOrExit(status == 0);
+    DumpValue(value, *reader);
+    CopyValue(value, aValue);
+
+exit:
+    mBus.Release(aCall);
+    return ret;
+}
+
 PropertyNameValue *DBusGet::GetPropertyList(void)
 {
     int propCnt;
@@ -38,14 +38,14 @@
 #define OT_PROPERTY_NAME_SIZE 512
 #define OT_PROPERTY_VALUE_SIZE 512
 
-#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-#include <dbus/dbus.h>
+#include <string>
 
 #include "dbus_base.hpp"
 #include "wpan_controller.hpp"
+#include "common/bus.hpp"
 
 namespace ot {
 namespace Dbus {
@@ -56,23 +56,78 @@ struct PropertyNameValue
     char value[OT_PROPERTY_VALUE_SIZE];
 };
 
-class DBusGet : public DBusBase
+class DBusGet
 {
 public:
+    /**
+     * This constructor initializes the request.
+     *
+     * @param[in]   aBus        A reference to the bus connection.
+     * @param[in]   aMethod     A reference to the PropGet method of the interface, whose strings are kept.
+     *
+     */
+    DBusGet(BorderRouter::Bus::Connection &aBus, const BorderRouter::Bus::Method &aMethod);
+
+    ~DBusGet(void);
+
     int                ProcessReply(void);
     void               SetPropertyName(const char *aPropertyName) { mPropertyName = aPropertyName; }
     const char *       GetPropertyName(void) { return mPropertyName; }
     const char *       GetPropertyValue(const char *aPropertyName);
     PropertyNameValue *GetPropertyList(void);
 
+    /**
+     * This method gets several properties in a single round trip.
+     *
+     * All requests are sent before any reply is waited for, as wpantund only gets one property per call.
+     *
+     * @param[inout]  aProperties   A pointer to the properties, whose names are read and values written. The value
+     *                              of a property failed to get is empty.
+     * @param[in]     aCount        The number of properties, at most OT_LIST_MAX_LENGTH.
+     *
+     * @retval kWpantundStatus_Ok                 Successfully got the replies.
+     * @retval kWpantundStatus_InvalidArgument    The aCount is too large.
+     * @retval kWpantundStatus_InvalidPending     A DBus call failed to be sent.
+     * @retval kWpantundStatus_InvalidReply       A DBus reply message is invalid.
+     *
+     */
+    int GetPropertyValues(PropertyNameValue *aProperties, size_t aCount);
+
+    /**
+     * This method formats a property value, as returned by GetPropertyValue().
+     *
+     * Strings and basic values are formatted as text, byte arrays as bracketed hex and other arrays, like tables, as
+     * JSON. The value is appended in a single pass, in time linear to its length.
+     *
+     * @param[in]   aReader     A reference to the reader at the value, moved past it.
+     * @param[out]  aValue      A reference to the string to receive the value.
+     *
+     */
+    static void DumpPropertyValue(BorderRouter::Bus::Reader &aReader, std::string &aValue);
+
+    /**
+     * This method formats a property value into a fixed buffer.
+     *
+     * @param[in]   aReader     A reference to the reader at the value, moved past it.
+     * @param[out]  aValue      A pointer to the buffer of OT_PROPERTY_VALUE_SIZE bytes to receive the value, which is
+     *                          truncated to fit.
+     *
+     */
+    static void DumpPropertyValue(BorderRouter::Bus::Reader &aReader, char *aValue);
+
 private:
     int  GetAllPropertyNames(void);
     void GetAllPropertyValues(int aPropCnt);
+    int  ReadPropertyValue(unsigned int aCall, char *aValue);
+    void ReleaseReply(void);
 
-    DBusMessageIter mIter;
+    BorderRouter::Bus::Connection &mBus;
+    BorderRouter::Bus::Method      mMethod;
+    BorderRouter::Bus::Reader *    mReader; ///< The reader of the last reply, at its value.
+    unsigned int                   mCall;   ///< The call of the last reply.
 
     const char *mPropertyName;
-    char        mPropertyValue[OT_PROPERTY_VALUE_SIZE];
+    std::string mPropertyValue;
 
     PropertyNameValue mPropertyList[OT_LIST_MAX_LENGTH];
 };
@@ -38,45 +38,30 @@
 namespace ot {
 namespace Dbus {
 
-int DBusJoin::ProcessReply(void)
+int DBusJoin::NewRequest(DBusMessage *&aMessage)
 {
-    int          ret      = 0;
-    const char * method   = "Join";
-    DBusMessage *messsage = NULL;
-    DBusMessage *reply    = NULL;
-    DBusError    error;
+    int ret = kWpantundStatus_Ok;
 
-    dbus_error_init(&error);
-    VerifyOrExit(GetConnection() != NULL, ret = kWpantundStatus_InvalidConnection);
-    SetMethod(method);
-
-    VerifyOrExit((messsage = GetMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
+    aMessage = NULL;
     VerifyOrExit(mNetworkName != NULL, ret = kWpantundStatus_InvalidArgument);
     VerifyOrExit(mNodeType != 0, ret = kWpantundStatus_InvalidArgument);
     VerifyOrExit(mChannel != 0, ret = kWpantundStatus_InvalidArgument);
     VerifyOrExit(mExtPanId != 0, ret = kWpantundStatus_InvalidArgument);
     VerifyOrExit(mPanId != 0, ret = kWpantundStatus_InvalidArgument);
+    SetMethod("Join");
+    VerifyOrExit((aMessage = NewMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
 
-    dbus_message_append_args(messsage, DBUS_TYPE_STRING, &mNetworkName, DBUS_TYPE_INVALID);
-
-    dbus_message_append_args(messsage, DBUS_TYPE_INT16, &mNodeType, DBUS_TYPE_INVALID);
+    dbus_message_append_args(aMessage, DBUS_TYPE_STRING, &mNetworkName, DBUS_TYPE_INVALID);
 
-    dbus_message_append_args(messsage, DBUS_TYPE_UINT64, &mExtPanId, DBUS_TYPE_INVALID);
+    dbus_message_append_args(aMessage, DBUS_TYPE_INT16, &mNodeType, DBUS_TYPE_INVALID);
 
-    dbus_message_append_args(messsage, DBUS_TYPE_UINT16, &mPanId, DBUS_TYPE_INVALID);
+    dbus_message_append_args(aMessage, DBUS_TYPE_UINT64, &mExtPanId, DBUS_TYPE_INVALID);
 
-    dbus_message_append_args(messsage, DBUS_TYPE_BYTE, &mChannel, DBUS_TYPE_INVALID);
+    dbus_message_append_args(aMessage, DBUS_TYPE_UINT16, &mPanId, DBUS_TYPE_INVALID);
 
-    VerifyOrExit((reply = GetReply()) != NULL);
-    dbus_message_get_args(reply, &error, DBUS_TYPE_INT32, &ret, DBUS_TYPE_INVALID);
+    dbus_message_append_args(aMessage, DBUS_TYPE_BYTE, &mChannel, DBUS_TYPE_INVALID);
 
 exit:
-    if (dbus_error_is_set(&error))
-    {
-        otbrLog(OTBR_LOG_ERR, "join error: %s", error.message);
-        dbus_error_free(&error);
-    }
-    free();
     return ret;
 }
 
@@ -59,7 +59,17 @@ public:
     void SetExtPanId(uint64_t aExtPanId) { mExtPanId = aExtPanId; }
     void SetPanId(uint16_t aPanId) { mPanId = aPanId; }
 
-    int ProcessReply(void);
+    /**
+     * This method creates the Join method call message from the network parameters set.
+     *
+     * @param[out]  aMessage    A reference to receive the message, owned by the caller. NULL on failure.
+     *
+     * @retval kWpantundStatus_Ok               Successfully created the message.
+     * @retval kWpantundStatus_InvalidMessage   Failed to create the message.
+     * @retval kWpantundStatus_InvalidArgument  A network parameter is not set.
+     *
+     */
+    int NewRequest(DBusMessage *&aMessage);
 
 private:
     const char *mNetworkName;
@@ -38,27 +38,14 @@
 namespace ot {
 namespace Dbus {
 
-int DBusLeave::ProcessReply(void)
+int DBusLeave::NewRequest(DBusMessage *&aMessage)
 {
-    int          ret      = 0;
-    const char * method   = "Leave";
-    DBusMessage *messsage = NULL;
-    DBusMessage *reply    = NULL;
-    DBusError    error;
+    int ret = kWpantundStatus_Ok;
+
+    SetMethod("Leave");
+    VerifyOrExit((aMessage = NewMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
 
-    dbus_error_init(&error);
-    VerifyOrExit(GetConnection() != NULL, ret = kWpantundStatus_InvalidConnection);
-    SetMethod(method);
-    VerifyOrExit((messsage = GetMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
-    VerifyOrExit((reply = GetReply()) != NULL, ret = kWpantundStatus_InvalidReply);
-    dbus_message_get_args(reply, &error, DBUS_TYPE_INT32, &ret, DBUS_TYPE_INVALID);
 exit:
-    if (dbus_error_is_set(&error))
-    {
-        otbrLog(OTBR_LOG_ERR, "leave error: %s", error.message);
-        dbus_error_free(&error);
-    }
-    free();
     return ret;
 }
 
@@ -47,7 +47,16 @@ namespace Dbus {
 class DBusLeave : public DBusBase
 {
 public:
-    int ProcessReply(void);
+    /**
+     * This method creates the Leave method call message.
+     *
+     * @param[out]  aMessage    A reference to receive the message, owned by the caller. NULL on failure.
+     *
+     * @retval kWpantundStatus_Ok               Successfully created the message.
+     * @retval kWpantundStatus_InvalidMessage   Failed to create the message.
+     *
+     */
+    int NewRequest(DBusMessage *&aMessage);
 
 private:
 };
@@ -0,0 +1,136 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements watching the property changes of wpantund.
+ */
+
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_WEB
+
+#include "common/bus_libdbus.hpp"
+#include "common/code_utils.hpp"
+
+#include "dbus_get.hpp"
+#include "dbus_prop_watch.hpp"
+
+namespace ot {
+namespace Dbus {
+
+DBusPropWatch::DBusPropWatch(void)
+    : mConnection(NULL)
+    , mHandler(NULL)
+    , mContext(NULL)
+{
+    mPath[0] = '\0';
+}
+
+DBusPropWatch::~DBusPropWatch(void)
+{
+    Stop();
+}
+
+int DBusPropWatch::Start(const char *aIfName, ChangeHandler aHandler, void *aContext)
+{
+    int       ret = kWpantundStatus_Ok;
+    char      rule[DBUS_MAXIMUM_MATCH_RULE_LENGTH];
+    DBusError error;
+
+    dbus_error_init(&error);
+    VerifyOrExit(mConnection == NULL, ret = kWpantundStatus_Failure);
+    mConnection = dbus_bus_get_private(DBUS_BUS_SYSTEM, &error);
+    VerifyOrExit(mConnection != NULL, ret = kWpantundStatus_InvalidConnection);
+    dbus_connection_set_exit_on_disconnect(mConnection, false);
+
+    snprintf(mPath, sizeof(mPath), "%s/%s", WPANTUND_DBUS_PATH, aIfName);
+    snprintf(rule, sizeof(rule), "type='signal',interface='%s',member='%s',path='%s'", WPANTUND_DBUS_APIv1_INTERFACE,
+             WPANTUND_IF_SIGNAL_PROP_CHANGED, mPath);
+    dbus_bus_add_match(mConnection, rule, &error);
+    VerifyOrExit(!dbus_error_is_set(&error), ret = kWpantundStatus_Failure);
+
+    mHandler = aHandler;
+    mContext = aContext;
+    VerifyOrExit(dbus_connection_add_filter(mConnection, HandleMessage, this, NULL), ret = kWpantundStatus_Failure);
+
+exit:
+    if (dbus_error_is_set(&error))
+    {
+        otbrLog(OTBR_LOG_ERR, "property watch error: %s", error.message);
+        dbus_error_free(&error);
+    }
+
+    if (ret != kWpantundStatus_Ok)
+    {
+        Stop();
+    }
+
+    return ret;
+}
+
+bool DBusPropWatch::Process(int aTimeout)
+{
+    return mConnection != NULL && dbus_connection_read_write_dispatch(mConnection, aTimeout);
+}
+
+void DBusPropWatch::Stop(void)
+{
+    VerifyOrExit(mConnection != NULL);
+
+    dbus_connection_remove_filter(mConnection, HandleMessage, this);
+    dbus_connection_close(mConnection);
+    dbus_connection_unref(mConnection);
+    mConnection = NULL;
+
+exit:
+    return;
+}
+
+DBusHandlerResult DBusPropWatch::HandleMessage(DBusConnection *aConnection, DBusMessage *aMessage, void *aContext)
+{
+    DBusPropWatch *                  watch  = static_cast<DBusPropWatch *>(aContext);
+    DBusHandlerResult                result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    const char *                     name   = NULL;
+    std::string                      value;
+    BorderRouter::Bus::LibdbusReader reader;
+
+    VerifyOrExit(dbus_message_is_signal(aMessage, WPANTUND_DBUS_APIv1_INTERFACE, WPANTUND_IF_SIGNAL_PROP_CHANGED));
+    VerifyOrExit(dbus_message_has_path(aMessage, watch->mPath));
+    result = DBUS_HANDLER_RESULT_HANDLED;
+
+    VerifyOrExit(reader.Init(*aMessage) && reader.ReadBasic(BorderRouter::Bus::kTypeString, &name));
+    DBusGet::DumpPropertyValue(reader, value);
+
+    watch->mHandler(name, value.c_str(), watch->mContext);
+
+exit:
+    (void)aConnection;
+    return result;
+}
+
+} // namespace Dbus
+} // namespace ot
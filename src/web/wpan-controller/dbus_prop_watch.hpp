@@ -0,0 +1,110 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements watching the property changes of wpantund.
+ */
+
+#ifndef DBUS_PROP_WATCH_HPP
+#define DBUS_PROP_WATCH_HPP
+
+#include <dbus/dbus.h>
+
+#include "wpan_controller.hpp"
+
+namespace ot {
+namespace Dbus {
+
+/**
+ * This class receives the PropChanged signals of a wpantund interface.
+ *
+ * The signals are received on a private connection, so that they are not queued on the connection shared by the
+ * requests of WPANController, and Process() may block in a thread of its own.
+ *
+ */
+class DBusPropWatch
+{
+public:
+    /**
+     * This function pointer is called with a changed property.
+     *
+     * @param[in]  aName      A pointer to the property name.
+     * @param[in]  aValue     A pointer to the property value, formatted as by WPANController::Get().
+     * @param[in]  aContext   A pointer to application-specific context.
+     *
+     */
+    typedef void (*ChangeHandler)(const char *aName, const char *aValue, void *aContext);
+
+    DBusPropWatch(void);
+
+    ~DBusPropWatch(void);
+
+    /**
+     * This method starts watching the properties of a wpantund interface.
+     *
+     * @param[in]  aIfName    A pointer to the interface name of wpantund.
+     * @param[in]  aHandler   A pointer to the function called with each changed property.
+     * @param[in]  aContext   A pointer to application-specific context.
+     *
+     * @retval kWpantundStatus_Ok                 Successfully started watching.
+     * @retval kWpantundStatus_InvalidConnection  The DBus connection is invalid.
+     * @retval kWpantundStatus_Failure            Failed to subscribe to the signals.
+     *
+     */
+    int Start(const char *aIfName, ChangeHandler aHandler, void *aContext);
+
+    /**
+     * This method waits for signals and calls the handler with the properties changed.
+     *
+     * @param[in]  aTimeout   The max time to wait in milliseconds.
+     *
+     * @retval true   The connection is still open.
+     * @retval false  The connection is closed, and no more changes will be received.
+     *
+     */
+    bool Process(int aTimeout);
+
+    /**
+     * This method stops watching and closes the connection.
+     *
+     */
+    void Stop(void);
+
+private:
+    static DBusHandlerResult HandleMessage(DBusConnection *aConnection, DBusMessage *aMessage, void *aContext);
+
+    DBusConnection *mConnection;
+    ChangeHandler   mHandler;
+    void *          mContext;
+    char            mPath[DBUS_MAXIMUM_NAME_LENGTH + 1];
+};
+
+} // namespace Dbus
+} // namespace ot
+#endif // DBUS_PROP_WATCH_HPP
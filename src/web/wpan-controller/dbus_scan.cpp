@@ -31,6 +31,8 @@
  *   This file implements "scan" Thread Network function.
  */
 
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_WEB
+
 #include "common/code_utils.hpp"
 
 #include "dbus_scan.hpp"
@@ -38,8 +40,13 @@
 namespace ot {
 namespace Dbus {
 
-int             DBusScan::mAvailableNetworksCnt = 0;
-WpanNetworkInfo DBusScan::mAvailableNetworks[OT_SCANNED_NET_BUFFER_SIZE];
+DBusScan::DBusScan(void)
+    : mChannelMask(0)
+    , mAvailableNetworksCnt(0)
+    , mBeaconHandler(NULL)
+    , mBeaconContext(NULL)
+{
+}
 
 int DBusScan::ProcessReply(void)
 {
@@ -49,9 +56,11 @@ int DBusScan::ProcessReply(void)
     DBusMessage *     reply                          = NULL;
     DBusConnection *  dbusConnection                 = NULL;
     DBusPendingCall * pending                        = NULL;
-    static const char dbusObjectManagerMatchString[] = "type='signal'";
+    static const char dbusObjectManagerMatchString[] =
+        "type='signal',interface='" WPANTUND_DBUS_APIv1_INTERFACE "',member='" WPANTUND_IF_SIGNAL_NET_SCAN_BEACON "'";
     DBusMessageIter   iter;
     DBusError         error;
+    bool              filtered = false;
 
     dbus_error_init(&error);
     VerifyOrExit((dbusConnection = GetConnection()) != NULL, ret = kWpantundStatus_InvalidConnection);
@@ -61,7 +70,7 @@ int DBusScan::ProcessReply(void)
     memset(mAvailableNetworks, 0, sizeof(mAvailableNetworks));
     mAvailableNetworksCnt = 0;
 
-    dbus_connection_add_filter(dbusConnection, &DbusBeaconHandler, NULL, NULL);
+    filtered = dbus_connection_add_filter(dbusConnection, &DbusBeaconHandler, this, NULL);
     SetMethod(method);
     VerifyOrExit((messsage = GetMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
     dbus_message_append_args(messsage, DBUS_TYPE_UINT32, &mChannelMask, DBUS_TYPE_INVALID);
@@ -84,11 +93,31 @@ exit:
         otbrLog(OTBR_LOG_ERR, "scan error: %s", error.message);
         dbus_error_free(&error);
     }
+
+    // The connection may be shared and outlive this scan, beacons of later scans must not be handled here.
+    if (filtered)
+    {
+        dbus_connection_remove_filter(dbusConnection, &DbusBeaconHandler, this);
+        dbus_bus_remove_match(dbusConnection, dbusObjectManagerMatchString, NULL);
+    }
+
+    if (reply != NULL)
+    {
+        dbus_message_unref(reply);
+    }
+
+    if (pending != NULL)
+    {
+        dbus_pending_call_unref(pending);
+    }
+
+    free();
     return ret;
 }
 
 DBusHandlerResult DBusScan::DbusBeaconHandler(DBusConnection *aConnection, DBusMessage *aMessage, void *aUserData)
 {
+    DBusScan *      scan = static_cast<DBusScan *>(aUserData);
     DBusMessageIter iter;
     WpanNetworkInfo networkInfo;
 
@@ -102,14 +131,18 @@ DBusHandlerResult DBusScan::DbusBeaconHandler(DBusConnection *aConnection, DBusM
 
     if (networkInfo.mNetworkName[0])
     {
-        if (mAvailableNetworksCnt < OT_SCANNED_NET_BUFFER_SIZE)
+        if (scan->mAvailableNetworksCnt < OT_SCANNED_NET_BUFFER_SIZE)
+        {
+            scan->mAvailableNetworks[scan->mAvailableNetworksCnt++] = networkInfo;
+        }
+
+        if (scan->mBeaconHandler != NULL)
         {
-            mAvailableNetworks[mAvailableNetworksCnt++] = networkInfo;
+            scan->mBeaconHandler(networkInfo, scan->mBeaconContext);
         }
     }
 
     (void)aConnection;
-    (void)aUserData;
 
     return DBUS_HANDLER_RESULT_HANDLED;
 }
@@ -44,22 +44,45 @@
 namespace ot {
 namespace Dbus {
 
+/**
+ * This class scans the Thread Networks.
+ *
+ * The networks found are kept by the object, so that concurrent scans do not share them.
+ *
+ */
 class DBusScan : public DBusBase
 {
 public:
+    DBusScan(void);
+
     int              ProcessReply(void);
     uint32_t         GetChannelMask(void) { return mChannelMask; }
     void             SetChannelMask(uint32_t aChannelMask) { mChannelMask = aChannelMask; }
     WpanNetworkInfo *GetNetworks(void) { return mAvailableNetworks; }
     int              GetNetworksCount(void) { return mAvailableNetworksCnt; }
 
+    /**
+     * This method sets the function called with each network as its beacon is received, while ProcessReply() runs.
+     *
+     * @param[in]  aHandler   A pointer to the function, NULL for none.
+     * @param[in]  aContext   A pointer to application-specific context.
+     *
+     */
+    void SetBeaconHandler(ScanBeaconHandler aHandler, void *aContext)
+    {
+        mBeaconHandler = aHandler;
+        mBeaconContext = aContext;
+    }
+
 private:
     static DBusHandlerResult DbusBeaconHandler(DBusConnection *aConnection, DBusMessage *aMessage, void *aUserData);
     static int               ParseNetworkInfoFromIter(WpanNetworkInfo *aNetworkInfo, DBusMessageIter *aIter);
 
-    uint32_t               mChannelMask;
-    static WpanNetworkInfo mAvailableNetworks[OT_SCANNED_NET_BUFFER_SIZE];
-    static int             mAvailableNetworksCnt;
+    uint32_t          mChannelMask;
+    WpanNetworkInfo   mAvailableNetworks[OT_SCANNED_NET_BUFFER_SIZE];
+    int               mAvailableNetworksCnt;
+    ScanBeaconHandler mBeaconHandler;
+    void *            mBeaconContext;
 };
 
 } // namespace Dbus
@@ -39,48 +39,36 @@
 namespace ot {
 namespace Dbus {
 
-int DBusSet::ProcessReply(void)
+int DBusSet::NewRequest(DBusMessage *&aMessage)
 {
-    int          ret      = 0;
-    const char * method   = "PropSet";
-    DBusMessage *messsage = NULL;
-    DBusMessage *reply    = NULL;
-    DBusError    error;
+    int ret = kWpantundStatus_Ok;
 
-    dbus_error_init(&error);
-    VerifyOrExit(GetConnection() != NULL, ret = kWpantundStatus_InvalidConnection);
-    SetMethod(method);
+    SetMethod("PropSet");
+    VerifyOrExit((aMessage = NewMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
 
-    VerifyOrExit((messsage = GetMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
-
-    dbus_message_append_args(messsage, DBUS_TYPE_STRING, &mPropertyName, DBUS_TYPE_INVALID);
+    dbus_message_append_args(aMessage, DBUS_TYPE_STRING, &mPropertyName, DBUS_TYPE_INVALID);
 
     if (mPropertyType == kPropertyType_String)
     {
-        dbus_message_append_args(messsage, DBUS_TYPE_STRING, &mPropertyValue, DBUS_TYPE_INVALID);
+        dbus_message_append_args(aMessage, DBUS_TYPE_STRING, &mPropertyValue, DBUS_TYPE_INVALID);
     }
-    else if (mPropertyType == kPropertyType_Data)
+    else
     {
         char  propertyValueBytes[OT_SET_MAX_DATA_SIZE];
-        int   length = ot::Utils::Hex2Bytes(mPropertyValue, (uint8_t *)propertyValueBytes, strlen(mPropertyValue));
+        int   length = ot::Utils::Hex2Bytes(mPropertyValue, strlen(mPropertyValue), (uint8_t *)propertyValueBytes,
+                                          sizeof(propertyValueBytes));
         char *cur    = propertyValueBytes;
-        dbus_message_append_args(messsage, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &cur, length, DBUS_TYPE_INVALID);
-    }
-    else
-    {
-        ExitNow();
-    }
 
-    VerifyOrExit((reply = GetReply()) != NULL, ret = kWpantundStatus_InvalidReply);
-    dbus_message_get_args(reply, &error, DBUS_TYPE_INT32, &ret, DBUS_TYPE_INVALID);
+        VerifyOrExit(length >= 0, ret = kWpantundStatus_InvalidArgument);
+        dbus_message_append_args(aMessage, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &cur, length, DBUS_TYPE_INVALID);
+    }
 
 exit:
-    if (dbus_error_is_set(&error))
+    if (ret != kWpantundStatus_Ok && aMessage != NULL)
     {
-        otbrLog(OTBR_LOG_ERR, "set error: %s", error.message);
-        dbus_error_free(&error);
+        dbus_message_unref(aMessage);
+        aMessage = NULL;
     }
-    free();
     return ret;
 }
 
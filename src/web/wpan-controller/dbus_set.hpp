@@ -64,7 +64,17 @@ public:
         mPropertyType = (aPropertyType == 0 ? kPropertyType_String : kPropertyType_Data);
     }
 
-    int ProcessReply(void);
+    /**
+     * This method creates the PropSet method call message, data values are converted from hex.
+     *
+     * @param[out]  aMessage    A reference to receive the message, owned by the caller. NULL on failure.
+     *
+     * @retval kWpantundStatus_Ok               Successfully created the message.
+     * @retval kWpantundStatus_InvalidMessage   Failed to create the message.
+     * @retval kWpantundStatus_InvalidArgument  The value is not valid hex.
+     *
+     */
+    int NewRequest(DBusMessage *&aMessage);
 
 private:
     const char *mPropertyName;
@@ -31,13 +31,17 @@
  *   This file provides DBus operations APIs for other modules to control the WPAN interface.
  */
 
+#define OTBR_LOG_MODULE OTBR_LOG_MODULE_WEB
+
 #include <ctype.h>
 #include <inttypes.h>
+#include <stdarg.h>
 #include <stdio.h>
 
 #include <dbus/dbus.h>
 
 #include "common/code_utils.hpp"
+#include "common/time.hpp"
 
 #include "dbus_base.hpp"
 #include "dbus_form.hpp"
@@ -53,19 +57,98 @@
 namespace ot {
 namespace Dbus {
 
-int WPANController::Scan(void)
+WPANController::WPANController(void)
+    : mConnection(NULL)
+    , mBus(NULL)
+{
+    mIfName[0]   = '\0';
+    mDBusName[0] = '\0';
+}
+
+WPANController::~WPANController(void)
+{
+    if (mConnection != NULL)
+    {
+        dbus_connection_unref(mConnection);
+    }
+
+    if (mBus != NULL)
+    {
+        BorderRouter::Bus::Connection::Destroy(mBus);
+    }
+}
+
+DBusConnection *WPANController::Connect(void) const
+{
+    if (mConnection != NULL && !dbus_connection_get_is_connected(mConnection))
+    {
+        dbus_connection_unref(mConnection);
+        mConnection = NULL;
+    }
+
+    if (mConnection == NULL)
+    {
+        DBusBase        base;
+        DBusConnection *connection = base.GetConnection();
+
+        if (connection != NULL)
+        {
+            mConnection = dbus_connection_ref(connection);
+        }
+
+        base.free();
+    }
+
+    return mConnection;
+}
+
+BorderRouter::Bus::Connection *WPANController::ConnectBus(void) const
+{
+    if (mBus != NULL && !mBus->IsConnected())
+    {
+        BorderRouter::Bus::Connection::Destroy(mBus);
+        mBus = NULL;
+    }
+
+    if (mBus == NULL)
+    {
+        mBus = BorderRouter::Bus::Connection::Create();
+    }
+
+    return mBus;
+}
+
+void WPANController::Prepare(DBusBase &aRequest) const
+{
+    aRequest.SetConnection(Connect());
+    aRequest.SetDestination(GetDBusInterfaceName());
+}
+
+int WPANController::Finish(int aRet) const
+{
+    if (aRet != kWpantundStatus_Ok)
+    {
+        // The name is looked up again by the next request, in case wpantund restarted.
+        mDBusName[0] = '\0';
+    }
+
+    return aRet;
+}
+
+int WPANController::Scan(ScanBeaconHandler aHandler, void *aContext)
 {
     int      ret = 0;
     DBusScan scannedNetwork;
     char     path[DBUS_MAXIMUM_NAME_LENGTH + 1];
 
     scannedNetwork.SetChannelMask(0);
+    scannedNetwork.SetBeaconHandler(aHandler, aContext);
     scannedNetwork.SetInterfaceName(mIfName);
     snprintf(path, sizeof(path), "%s/%s", WPANTUND_DBUS_PATH, mIfName);
     scannedNetwork.SetPath(path);
-    scannedNetwork.SetDestination(GetDBusInterfaceName());
+    Prepare(scannedNetwork);
     scannedNetwork.SetInterface(WPANTUND_DBUS_APIv1_INTERFACE);
-    VerifyOrExit((ret = scannedNetwork.ProcessReply()) == 0);
+    VerifyOrExit((ret = Finish(scannedNetwork.ProcessReply())) == 0);
 
     VerifyOrExit((mScannedNetworkCount = scannedNetwork.GetNetworksCount()) > 0, ret = kWpantundStatus_NetworkNotFound);
     memcpy(mScannedNetworks, scannedNetwork.GetNetworks(), mScannedNetworkCount * sizeof(Dbus::WpanNetworkInfo));
@@ -86,87 +169,102 @@ int WPANController::GetScanNetworksInfoCount(void) const
 const char *WPANController::GetDBusInterfaceName(void) const
 {
     DBusIfname dbusIfName;
-    char *     destination;
     int        ret = kWpantundStatus_Ok;
 
+    VerifyOrExit(mDBusName[0] == '\0');
+
+    dbusIfName.SetConnection(mConnection);
     dbusIfName.SetInterfaceName(mIfName);
     VerifyOrExit(dbusIfName.ProcessReply() == kWpantundStatus_Ok, ret = kWpantundStatus_InvalidDBusName);
-    destination = dbusIfName.GetDBusName();
+    strncpy(mDBusName, dbusIfName.GetDBusName(), DBUS_MAXIMUM_NAME_LENGTH);
+    mDBusName[DBUS_MAXIMUM_NAME_LENGTH] = '\0';
 exit:
-    return ret ? NULL : destination;
+    return (ret || mDBusName[0] == '\0') ? NULL : mDBusName;
 }
 
 int WPANController::Leave(void)
 {
-    DBusLeave leaveNetwork;
-    char      path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+    Transaction transaction(*this);
 
-    leaveNetwork.SetDestination(GetDBusInterfaceName());
-    leaveNetwork.SetInterfaceName(mIfName);
-    snprintf(path, sizeof(path), "%s/%s", WPANTUND_DBUS_PATH, mIfName);
-    leaveNetwork.SetPath(path);
-    leaveNetwork.SetInterface(WPANTUND_DBUS_APIv1_INTERFACE);
-    return leaveNetwork.ProcessReply();
+    transaction.Leave();
+    return transaction.Commit();
 }
 
 int WPANController::Form(const char *aNetworkName, uint16_t aChannel)
 {
-    DBusForm formNetwork;
-    int      ret = 0;
-    char     path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+    Transaction transaction(*this);
 
-    VerifyOrExit(aNetworkName != NULL, ret = kWpantundStatus_InvalidArgument);
-    formNetwork.SetNetworkName(aNetworkName);
-    VerifyOrExit((aChannel <= 26 && aChannel >= 11), ret = kWpantundStatus_InvalidArgument);
-    formNetwork.SetChannelMask(aChannel);
-    formNetwork.SetInterfaceName(mIfName);
-    formNetwork.SetNodeType(OT_ROUTER_ROLE);
-    snprintf(path, sizeof(path), "%s/%s", WPAN_TUNNEL_DBUS_PATH, mIfName);
-    formNetwork.SetPath(path);
-    formNetwork.SetDestination(GetDBusInterfaceName());
-    formNetwork.SetInterface(WPAN_TUNNEL_DBUS_INTERFACE);
-    ret = formNetwork.ProcessReply();
-exit:
-    return ret;
+    transaction.Form(aNetworkName, aChannel);
+    return transaction.Commit();
 }
 
 int WPANController::Join(const char *aNetworkName, uint16_t aChannel, uint64_t aExtPanId, uint16_t aPanId)
 {
-    int      ret = 0;
-    DBusJoin joinNetwork;
-    char     path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+    Transaction transaction(*this);
 
-    VerifyOrExit(aNetworkName != NULL, ret = kWpantundStatus_InvalidArgument);
-    joinNetwork.SetNetworkName(aNetworkName);
-    joinNetwork.SetNodeType(OT_ROUTER_ROLE);
-    joinNetwork.SetInterfaceName(mIfName);
-    snprintf(path, sizeof(path), "%s/%s", WPAN_TUNNEL_DBUS_PATH, mIfName);
-    joinNetwork.SetPath(path);
-    VerifyOrExit((aChannel <= 26 && aChannel >= 11), ret = kWpantundStatus_InvalidArgument);
-    joinNetwork.SetChannel(aChannel);
-    VerifyOrExit(aExtPanId != 0, ret = kWpantundStatus_InvalidArgument);
-    joinNetwork.SetExtPanId(aExtPanId);
-    VerifyOrExit(aPanId != 0xffff, ret = kWpantundStatus_InvalidArgument);
-    joinNetwork.SetPanId(aPanId);
-    joinNetwork.SetDestination(GetDBusInterfaceName());
-    joinNetwork.SetInterface(WPAN_TUNNEL_DBUS_INTERFACE);
-    ret = joinNetwork.ProcessReply();
-exit:
-    return ret;
+    transaction.Join(aNetworkName, aChannel, aExtPanId, aPanId);
+    return transaction.Commit();
 }
 
-const char *WPANController::Get(const char *aPropertyName) const
+std::string WPANController::Get(const char *aPropertyName) const
 {
-    DBusGet getProp;
-    int     ret = kWpantundStatus_Ok;
-    char    path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+    BorderRouter::Bus::Connection *bus = ConnectBus();
+    int                            ret = kWpantundStatus_Ok;
+    std::string                    value;
+    char                           path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+    BorderRouter::Bus::Method      method;
 
     VerifyOrExit(aPropertyName != NULL, ret = kWpantundStatus_InvalidArgument);
-    getProp.SetInterfaceName(mIfName);
+    VerifyOrExit(bus != NULL, ret = kWpantundStatus_InvalidConnection);
+    snprintf(path, sizeof(path), "%s/%s", WPANTUND_DBUS_PATH, mIfName);
+    Connect();
+    VerifyOrExit((method.mDestination = GetDBusInterfaceName()) != NULL, ret = kWpantundStatus_InvalidDBusName);
+    method.mPath      = path;
+    method.mInterface = WPANTUND_DBUS_APIv1_INTERFACE;
+    method.mMember    = WPANTUND_IF_CMD_PROP_GET;
+
+    {
+        DBusGet getProp(*bus, method);
+
+        value = getProp.GetPropertyValue(aPropertyName);
+    }
+
+    if (value.empty())
+    {
+        Finish(kWpantundStatus_InvalidReply);
+    }
+
+exit:
+
+    if (ret != kWpantundStatus_Ok)
+    {
+        otbrLog(OTBR_LOG_ERR, "error: %d", ret);
+    }
+
+    return value;
+}
+
+int WPANController::Get(PropertyNameValue *aProperties, size_t aCount) const
+{
+    BorderRouter::Bus::Connection *bus = ConnectBus();
+    int                            ret = kWpantundStatus_Ok;
+    char                           path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+    BorderRouter::Bus::Method      method;
+
+    VerifyOrExit(aProperties != NULL, ret = kWpantundStatus_InvalidArgument);
+    VerifyOrExit(bus != NULL, ret = kWpantundStatus_InvalidConnection);
     snprintf(path, sizeof(path), "%s/%s", WPANTUND_DBUS_PATH, mIfName);
-    getProp.SetInterface(WPANTUND_DBUS_APIv1_INTERFACE);
-    getProp.SetPath(path);
-    getProp.SetDestination(GetDBusInterfaceName());
+    Connect();
+    VerifyOrExit((method.mDestination = GetDBusInterfaceName()) != NULL, ret = kWpantundStatus_InvalidDBusName);
+    method.mPath      = path;
+    method.mInterface = WPANTUND_DBUS_APIv1_INTERFACE;
+    method.mMember    = WPANTUND_IF_CMD_PROP_GET;
+
+    {
+        DBusGet getProp(*bus, method);
+
+        ret = Finish(getProp.GetPropertyValues(aProperties, aCount));
+    }
 
 exit:
 
@@ -175,69 +273,299 @@ exit:
         otbrLog(OTBR_LOG_ERR, "error: %d", ret);
     }
 
-    return ret ? "" : getProp.GetPropertyValue(aPropertyName);
+    return ret;
 }
 
 int WPANController::Set(uint8_t aType, const char *aPropertyName, const char *aPropertyValue)
 {
-    DBusSet setProp;
-    int     ret = kWpantundStatus_Ok;
-    char    path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+    Transaction transaction(*this);
+
+    transaction.Set(aType, aPropertyName, aPropertyValue);
+    return transaction.Commit();
+}
+
+int WPANController::AddGateway(const char *aPrefix, bool aIsDefaultRoute)
+{
+    Transaction transaction(*this);
+
+    transaction.AddGateway(aPrefix, aIsDefaultRoute);
+    return transaction.Commit();
+}
+
+int WPANController::RemoveGateway(const char *aPrefix)
+{
+    Transaction transaction(*this);
+
+    transaction.RemoveGateway(aPrefix);
+    return transaction.Commit();
+}
+
+WPANController::Transaction::Transaction(WPANController &aController)
+    : mController(aController)
+    , mStepCount(0)
+    , mFailedStep(kMaxSteps)
+    , mError(kWpantundStatus_Ok)
+{
+}
+
+WPANController::Transaction::~Transaction(void)
+{
+    for (size_t i = 0; i < mStepCount; i++)
+    {
+        if (mSteps[i].mMessage != NULL)
+        {
+            dbus_message_unref(mSteps[i].mMessage);
+        }
+    }
+}
+
+void WPANController::Transaction::Prepare(DBusBase &aRequest, const char *aPath, const char *aInterface) const
+{
+    char path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+
+    // Messages are only created here, they are sent over the connection of the controller by Commit().
+    mController.Connect();
+    aRequest.SetInterfaceName(mController.mIfName);
+    snprintf(path, sizeof(path), "%s/%s", aPath, mController.mIfName);
+    aRequest.SetPath(path);
+    aRequest.SetInterface(aInterface);
+    aRequest.SetDestination(mController.GetDBusInterfaceName());
+}
+
+void WPANController::Transaction::AddStep(int          aFailure,
+                                          bool         aPipelined,
+                                          int          aStatus,
+                                          DBusMessage *aMessage,
+                                          const char * aFormat,
+                                          ...)
+{
+    Step *  step;
+    va_list args;
+
+    if (mError != kWpantundStatus_Ok || mStepCount == kMaxSteps)
+    {
+        if (aMessage != NULL)
+        {
+            dbus_message_unref(aMessage);
+        }
+
+        if (mError == kWpantundStatus_Ok)
+        {
+            otbrLog(OTBR_LOG_ERR, "too many steps in a transaction");
+            mError = kWpantundStatus_InvalidArgument;
+        }
+
+        ExitNow();
+    }
+
+    step = &mSteps[mStepCount];
+
+    va_start(args, aFormat);
+    vsnprintf(step->mName, sizeof(step->mName), aFormat, args);
+    va_end(args);
+
+    step->mStatus    = aStatus;
+    step->mFailure   = aFailure;
+    step->mPipelined = aPipelined;
+    step->mDone      = false;
+    step->mDuration  = 0;
+    step->mMessage   = aMessage;
+
+    if (aStatus != kWpantundStatus_Ok)
+    {
+        otbrLog(OTBR_LOG_ERR, "transaction step %s is invalid: %d", step->mName, aStatus);
+        mError      = aStatus;
+        mFailedStep = mStepCount;
+    }
+
+    mStepCount++;
+
+exit:
+    return;
+}
+
+void WPANController::Transaction::Leave(void)
+{
+    DBusLeave    request;
+    DBusMessage *message = NULL;
+    int          ret;
+
+    Prepare(request, WPANTUND_DBUS_PATH, WPANTUND_DBUS_APIv1_INTERFACE);
+    ret = request.NewRequest(message);
+    AddStep(kWpantundStatus_LeaveFailed, false, ret, message, "Leave");
+}
+
+void WPANController::Transaction::Form(const char *aNetworkName, uint16_t aChannel)
+{
+    DBusForm     request;
+    DBusMessage *message = NULL;
+    int          ret     = kWpantundStatus_Ok;
+
+    VerifyOrExit(aNetworkName != NULL, ret = kWpantundStatus_InvalidArgument);
+    request.SetNetworkName(aNetworkName);
+    VerifyOrExit((aChannel <= 26 && aChannel >= 11), ret = kWpantundStatus_InvalidArgument);
+    request.SetChannelMask(aChannel);
+    request.SetNodeType(OT_ROUTER_ROLE);
+    Prepare(request, WPAN_TUNNEL_DBUS_PATH, WPAN_TUNNEL_DBUS_INTERFACE);
+    ret = request.NewRequest(message);
+
+exit:
+    AddStep(kWpantundStatus_FormFailed, false, ret, message, "Form %u", aChannel);
+}
+
+void WPANController::Transaction::Join(const char *aNetworkName,
+                                       uint16_t    aChannel,
+                                       uint64_t    aExtPanId,
+                                       uint16_t    aPanId)
+{
+    DBusJoin     request;
+    DBusMessage *message = NULL;
+    int          ret     = kWpantundStatus_Ok;
+
+    VerifyOrExit(aNetworkName != NULL, ret = kWpantundStatus_InvalidArgument);
+    request.SetNetworkName(aNetworkName);
+    request.SetNodeType(OT_ROUTER_ROLE);
+    VerifyOrExit((aChannel <= 26 && aChannel >= 11), ret = kWpantundStatus_InvalidArgument);
+    request.SetChannel(aChannel);
+    VerifyOrExit(aExtPanId != 0, ret = kWpantundStatus_InvalidArgument);
+    request.SetExtPanId(aExtPanId);
+    VerifyOrExit(aPanId != 0xffff, ret = kWpantundStatus_InvalidArgument);
+    request.SetPanId(aPanId);
+    Prepare(request, WPAN_TUNNEL_DBUS_PATH, WPAN_TUNNEL_DBUS_INTERFACE);
+    ret = request.NewRequest(message);
+
+exit:
+    AddStep(kWpantundStatus_JoinFailed, false, ret, message, "Join %u", aChannel);
+}
+
+void WPANController::Transaction::Set(uint8_t aType, const char *aPropertyName, const char *aPropertyValue)
+{
+    DBusSet      request;
+    DBusMessage *message = NULL;
+    int          ret     = kWpantundStatus_Ok;
 
     VerifyOrExit((aType == kPropertyType_String || aType == kPropertyType_Data), ret = kWpantundStatus_InvalidArgument);
-    setProp.SetPropertyType(aType);
+    request.SetPropertyType(aType);
     VerifyOrExit(aPropertyName != NULL, ret = kWpantundStatus_InvalidArgument);
-    setProp.SetPropertyName(aPropertyName);
+    request.SetPropertyName(aPropertyName);
     VerifyOrExit(aPropertyValue != NULL, ret = kWpantundStatus_InvalidArgument);
-    setProp.SetPropertyValue(aPropertyValue);
-    setProp.SetDestination(GetDBusInterfaceName());
-    setProp.SetInterfaceName(mIfName);
-    snprintf(path, sizeof(path), "%s/%s", WPANTUND_DBUS_PATH, mIfName);
-    setProp.SetPath(path);
-    setProp.SetInterface(WPANTUND_DBUS_APIv1_INTERFACE);
-    ret = setProp.ProcessReply();
+    request.SetPropertyValue(aPropertyValue);
+    Prepare(request, WPANTUND_DBUS_PATH, WPANTUND_DBUS_APIv1_INTERFACE);
+    ret = request.NewRequest(message);
+
 exit:
-    return ret;
+    AddStep(kWpantundStatus_SetFailed, true, ret, message, "PropSet %s", aPropertyName != NULL ? aPropertyName : "");
 }
 
-int WPANController::AddGateway(const char *aPrefix, bool aIsDefaultRoute)
+void WPANController::Transaction::AddGateway(const char *aPrefix, bool aIsDefaultRoute)
 {
-    DBusGateway gateway;
-    int         ret = kWpantundStatus_Ok;
-    char        path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+    DBusGateway  request;
+    DBusMessage *message = NULL;
+    int          ret     = kWpantundStatus_Ok;
 
-    gateway.SetDefaultRoute(aIsDefaultRoute);
+    request.SetDefaultRoute(aIsDefaultRoute);
     VerifyOrExit(aPrefix != NULL, ret = kWpantundStatus_InvalidArgument);
-    gateway.SetPrefix(aPrefix);
-    gateway.SetDestination(GetDBusInterfaceName());
-    gateway.SetInterfaceName(mIfName);
-    snprintf(path, sizeof(path), "%s/%s", WPANTUND_DBUS_PATH, mIfName);
-    gateway.SetPath(path);
-    gateway.SetInterface(WPANTUND_DBUS_APIv1_INTERFACE);
-    ret = gateway.ProcessReply();
+    request.SetPrefix(aPrefix);
+    Prepare(request, WPANTUND_DBUS_PATH, WPANTUND_DBUS_APIv1_INTERFACE);
+    ret = request.NewRequest(message);
+
 exit:
-    return ret;
+    AddStep(kWpantundStatus_SetGatewayFailed, true, ret, message, "ConfigGateway %s", aPrefix != NULL ? aPrefix : "");
 }
 
-int WPANController::RemoveGateway(const char *aPrefix)
+void WPANController::Transaction::RemoveGateway(const char *aPrefix)
 {
-    DBusGateway gateway;
-    int         ret = kWpantundStatus_Ok;
-    char        path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+    DBusGateway  request;
+    DBusMessage *message = NULL;
+    int          ret     = kWpantundStatus_Ok;
 
-    gateway.SetDefaultRoute(true);
+    request.SetDefaultRoute(true);
     VerifyOrExit(aPrefix != NULL, ret = kWpantundStatus_InvalidArgument);
-    gateway.SetPrefix(aPrefix);
-    gateway.SetValidLifeTime(0);
-    gateway.SetPreferredLifetime(0);
-    gateway.SetDestination(GetDBusInterfaceName());
-    gateway.SetInterfaceName(mIfName);
-    snprintf(path, sizeof(path), "%s/%s", WPANTUND_DBUS_PATH, mIfName);
-    gateway.SetPath(path);
-    gateway.SetInterface(WPANTUND_DBUS_APIv1_INTERFACE);
-    ret = gateway.ProcessReply();
+    request.SetPrefix(aPrefix);
+    request.SetValidLifeTime(0);
+    request.SetPreferredLifetime(0);
+    Prepare(request, WPANTUND_DBUS_PATH, WPANTUND_DBUS_APIv1_INTERFACE);
+    ret = request.NewRequest(message);
+
 exit:
-    return ret;
+    AddStep(kWpantundStatus_SetGatewayFailed, true, ret, message, "ConfigGateway %s", aPrefix != NULL ? aPrefix : "");
+}
+
+int WPANController::Transaction::Commit(void)
+{
+    int              ret        = mError;
+    DBusConnection * connection = NULL;
+    DBusPendingCall *pending[kMaxSteps];
+    size_t           begin = 0;
+
+    SuccessOrExit(ret);
+    VerifyOrExit((connection = mController.Connect()) != NULL, ret = kWpantundStatus_InvalidConnection);
+
+    while (begin < mStepCount && ret == kWpantundStatus_Ok)
+    {
+        uint64_t start = ot::BorderRouter::GetMonotonicNowUs();
+        size_t   end   = begin + 1;
+        size_t   sent  = begin;
+
+        while (end < mStepCount && mSteps[begin].mPipelined && mSteps[end].mPipelined)
+        {
+            end++;
+        }
+
+        for (; sent < end; sent++)
+        {
+            Step &step = mSteps[sent];
+
+            pending[sent] = NULL;
+            dbus_connection_send_with_reply(connection, step.mMessage, &pending[sent],
+                                            OT_DEFAULT_TIMEOUT_IN_MILLISECONDS);
+            dbus_message_unref(step.mMessage);
+            step.mMessage = NULL;
+
+            if (pending[sent] == NULL)
+            {
+                step.mStatus = kWpantundStatus_InvalidPending;
+                break;
+            }
+        }
+
+        if (sent > begin)
+        {
+            dbus_connection_flush(connection);
+        }
+
+        // Replies are read even after a failure, so that every pending call sent is released.
+        for (size_t i = begin; i < sent; i++)
+        {
+            Step &step = mSteps[i];
+
+            step.mStatus   = DBusBase::ReadStatus(pending[i]);
+            step.mDone     = true;
+            step.mDuration = static_cast<uint32_t>(ot::BorderRouter::GetMonotonicNowUs() - start);
+            otbrLog(OTBR_LOG_INFO, "transaction step %s: %d in %" PRIu32 " us", step.mName, step.mStatus,
+                    step.mDuration);
+        }
+
+        for (size_t i = begin; i < end && ret == kWpantundStatus_Ok; i++)
+        {
+            if (mSteps[i].mStatus != kWpantundStatus_Ok)
+            {
+                ret         = mSteps[i].mStatus;
+                mFailedStep = i;
+            }
+        }
+
+        begin = end;
+    }
+
+exit:
+    mError = ret;
+    return mController.Finish(ret);
+}
+
+int WPANController::Transaction::GetFailure(void) const
+{
+    return (mFailedStep < mStepCount) ? mSteps[mFailedStep].mFailure : mError;
 }
 
 void WPANController::SetInterfaceName(const char *aIfName)
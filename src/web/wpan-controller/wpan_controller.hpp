@@ -34,7 +34,7 @@
 #ifndef WPAN_CONTROLLER_HPP
 #define WPAN_CONTROLLER_HPP
 
-#define OT_SCANNED_NET_BUFFER_SIZE 250
+#define OT_SCANNED_NET_BUFFER_SIZE OTBR_CAPACITY_SCANNED_NETWORKS
 #define OT_SET_MAX_DATA_SIZE 250
 #define OT_NETWORK_NAME_MAX_SIZE 17
 #define OT_HARDWARE_ADDRESS_SIZE 8
@@ -45,6 +45,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <string>
+
 #include <dbus/dbus.h>
 extern "C" {
 #include "wpan-dbus-v0.h"
@@ -53,10 +55,14 @@ extern "C" {
 }
 
 #include "dbus_base.hpp"
+#include "common/bus.hpp"
+#include "common/capacity.hpp"
 
 namespace ot {
 namespace Dbus {
 
+struct PropertyNameValue;
+
 enum
 {
     kWpantundStatus_Ok                = 0,
@@ -88,9 +94,29 @@ struct WpanNetworkInfo
     uint8_t     mPrefix[OT_PREFIX_SIZE];
 };
 
+/**
+ * This function pointer is called with each network found by a scan, as its beacon is received.
+ *
+ * @param[in]  aNetwork   A reference to the network found.
+ * @param[in]  aContext   A pointer to application-specific context.
+ *
+ */
+typedef void (*ScanBeaconHandler)(const WpanNetworkInfo &aNetwork, void *aContext);
+
 class WPANController
 {
 public:
+    /**
+     * The constructor initializes a controller without a connection.
+     *
+     * The DBus connection and the DBus name of the interface are looked up on the first request, and kept for the
+     * lifetime of the controller, so a long-lived controller saves both on later requests.
+     *
+     */
+    WPANController(void);
+
+    ~WPANController(void);
+
     /**
      * This method returns the pointer to the WpanNetworkInfo structure.
      *
@@ -110,7 +136,9 @@ public:
     /**
      * This method returns the pointer to the DBus interface name.
      *
-     * @returns The pointer to the DBus interface name.
+     * The name is looked up once and cached until a request to it fails, e.g. as wpantund restarted.
+     *
+     * @returns The pointer to the DBus interface name, NULL if not found.
      *
      */
     const char *GetDBusInterfaceName(void) const;
@@ -144,11 +172,14 @@ public:
     /**
      * This method scan all existing Thread Network..
      *
+     * @param[in]  aHandler   A pointer to the function called with each network as it is found, NULL for none.
+     * @param[in]  aContext   A pointer to application-specific context.
+     *
      * @retval kWpantundStatus_Ok               Successfully scanned all existing Thread Network.
      * @retval kWpantundStatus_NetworkNotFound  Existing Thread Networks are not found.
      *
      */
-    int Scan(void);
+    int Scan(ScanBeaconHandler aHandler = NULL, void *aContext = NULL);
 
     /**
      * This method joins an existing Thread Network.
@@ -172,10 +203,27 @@ public:
      *
      * @param[in]  aPropertyName     A pointer to the property name of the Thread Network.
      *
-     * @returns The pointer to the property value.
+     * @returns The property value, empty if it failed to get.
+     *
+     */
+    std::string Get(const char *aPropertyName) const;
+
+    /**
+     * This method gets several properties of the Thread Network in a single DBus round trip.
+     *
+     * @param[inout]  aProperties   A pointer to the properties, whose names are read and values written. The value
+     *                              of a property failed to get is empty.
+     * @param[in]     aCount        The number of properties.
+     *
+     * @retval kWpantundStatus_Ok                 Successfully got the replies.
+     * @retval kWpantundStatus_InvalidConnection  The DBus connection is invalid.
+     * @retval kWpantundStatus_InvalidMessage     A DBus message is invalid.
+     * @retval kWpantundStatus_InvalidPending     A DBus call failed to be sent.
+     * @retval kWpantundStatus_InvalidReply       A DBus reply message is invalid.
+     * @retval kWpantundStatus_InvalidArgument    The aProperties is NULL or aCount is too large.
      *
      */
-    const char *Get(const char *aPropertyName) const;
+    int Get(PropertyNameValue *aProperties, size_t aCount) const;
 
     /**
      * This method sets the Thread Network property.
@@ -230,10 +278,147 @@ public:
      */
     void SetInterfaceName(const char *aIfName);
 
+    /**
+     * This class implements a sequence of requests to wpantund, sent over the connection of a controller.
+     *
+     * The messages of all steps are created as steps are added, so that an invalid argument fails the transaction
+     * before anything is sent. Consecutive property sets and gateway changes are pipelined, i.e. all sent before any
+     * reply is waited for, other steps wait for the replies of the steps before them. The transaction stops at the
+     * first step that fails, later steps are not sent unless pipelined along with it.
+     *
+     */
+    class Transaction
+    {
+    public:
+        enum
+        {
+            kMaxSteps = 8, ///< Max number of steps of a transaction.
+        };
+
+        /**
+         * This structure represents a step of a transaction.
+         *
+         */
+        struct Step
+        {
+            char         mName[64];  ///< The method called and its argument, for logs.
+            int          mStatus;    ///< The status returned by wpantund, or why the step failed.
+            int          mFailure;   ///< The status reported by GetFailure() when the step fails.
+            bool         mPipelined; ///< Whether the step is sent along with the pipelined steps next to it.
+            bool         mDone;      ///< Whether the reply of the step has been received.
+            uint32_t     mDuration;  ///< Time in microseconds from sending the step to receiving its reply.
+            DBusMessage *mMessage;   ///< The message of the step, until it is sent.
+        };
+
+        /**
+         * The constructor initializes an empty transaction.
+         *
+         * @param[in]  aController  A reference to the controller whose connection and interface are used.
+         *
+         */
+        explicit Transaction(WPANController &aController);
+
+        ~Transaction(void);
+
+        /**
+         * This method adds a step leaving the current Thread Network.
+         *
+         */
+        void Leave(void);
+
+        /**
+         * This method adds a step forming a new Thread Network, see WPANController::Form().
+         *
+         */
+        void Form(const char *aNetworkName, uint16_t aChannel);
+
+        /**
+         * This method adds a step joining an existing Thread Network, see WPANController::Join().
+         *
+         */
+        void Join(const char *aNetworkName, uint16_t aChannel, uint64_t aExtPanId, uint16_t aPanId);
+
+        /**
+         * This method adds a pipelined step setting a property, see WPANController::Set().
+         *
+         */
+        void Set(uint8_t aType, const char *aPropertyName, const char *aPropertyValue);
+
+        /**
+         * This method adds a pipelined step adding a gateway, see WPANController::AddGateway().
+         *
+         */
+        void AddGateway(const char *aPrefix, bool aIsDefaultRoute);
+
+        /**
+         * This method adds a pipelined step removing a gateway, see WPANController::RemoveGateway().
+         *
+         */
+        void RemoveGateway(const char *aPrefix);
+
+        /**
+         * This method sends the steps and waits for their replies, the duration of each step is logged.
+         *
+         * A transaction is committed only once.
+         *
+         * @retval kWpantundStatus_Ok                 All steps succeeded.
+         * @retval kWpantundStatus_InvalidConnection  The DBus connection is invalid.
+         * @retval kWpantundStatus_InvalidArgument    Too many steps were added.
+         * @returns The status of the first step failed otherwise.
+         *
+         */
+        int Commit(void);
+
+        /**
+         * This method returns the failure of the transaction, e.g. kWpantundStatus_SetFailed for a failed property
+         * set, or the status returned by Commit() if no step failed.
+         *
+         * @returns The failure of the transaction.
+         *
+         */
+        int GetFailure(void) const;
+
+        /**
+         * This method returns the number of steps added.
+         *
+         * @returns The number of steps.
+         *
+         */
+        size_t GetStepCount(void) const { return mStepCount; }
+
+        /**
+         * This method returns a step added.
+         *
+         * @param[in]  aIndex  The index of the step, less than GetStepCount().
+         *
+         * @returns A reference to the step.
+         *
+         */
+        const Step &GetStep(size_t aIndex) const { return mSteps[aIndex]; }
+
+    private:
+        void Prepare(DBusBase &aRequest, const char *aPath, const char *aInterface) const;
+        void AddStep(int aFailure, bool aPipelined, int aStatus, DBusMessage *aMessage, const char *aFormat, ...);
+
+        WPANController &mController;
+        Step            mSteps[kMaxSteps];
+        size_t          mStepCount;
+        size_t          mFailedStep; ///< The index of the step failed, kMaxSteps if none.
+        int             mError;      ///< The first error, later steps are not added after it.
+    };
+
 private:
-    char            mIfName[IFNAMSIZ];
-    WpanNetworkInfo mScannedNetworks[OT_SCANNED_NET_BUFFER_SIZE];
-    int             mScannedNetworkCount = 0;
+    DBusConnection *               Connect(void) const;
+    BorderRouter::Bus::Connection *ConnectBus(void) const;
+    void                           Prepare(DBusBase &aRequest) const;
+    int                            Finish(int aRet) const;
+
+    char                                   mIfName[IFNAMSIZ];
+    WpanNetworkInfo                        mScannedNetworks[OT_SCANNED_NET_BUFFER_SIZE];
+    int                                    mScannedNetworkCount = 0;
+    mutable DBusConnection *               mConnection;                            ///< Shared by the requests.
+    mutable BorderRouter::Bus::Connection *mBus;                                   ///< Getting the properties.
+    mutable char                           mDBusName[DBUS_MAXIMUM_NAME_LENGTH + 1]; ///< The cached DBus name, or empty.
 };
 
 } // namespace Dbus
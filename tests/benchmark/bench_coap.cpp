@@ -0,0 +1,160 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes benchmarks of the configured CoAP engine.
+ */
+
+#include <string.h>
+
+#include "benchmark.hpp"
+#include "agent/coap.hpp"
+
+using namespace ot::BorderRouter;
+
+enum
+{
+    kMaxFrameSize = 256,
+};
+
+struct CoapContext
+{
+    uint8_t  mFrame[kMaxFrameSize];
+    uint16_t mLength;
+};
+
+static const uint8_t kToken[]   = {0x12, 0x34};
+static const uint8_t kPayload[] = {0x0e, 0x02, 0x00, 0x01, 0x08, 0x08, 0xde, 0xad, 0x00, 0xbe, 0xef, 0x00,
+                                   0xca, 0xfe, 0x03, 0x0a, 0x4f, 0x70, 0x65, 0x6e, 0x54, 0x68, 0x72, 0x65,
+                                   0x61, 0x64, 0x2d, 0x31, 0x07, 0x08, 0xfd, 0x00};
+static const uint8_t kPeer[16]  = {0xfd, 0x00, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xfe, 0, 0xfc, 0x00};
+
+static ssize_t CaptureFrame(const uint8_t *aBuffer,
+                            uint16_t       aLength,
+                            const uint8_t *aIp6,
+                            uint16_t       aPort,
+                            void *         aContext)
+{
+    CoapContext &context = *static_cast<CoapContext *>(aContext);
+
+    context.mLength = aLength < sizeof(context.mFrame) ? aLength : static_cast<uint16_t>(sizeof(context.mFrame));
+    memcpy(context.mFrame, aBuffer, context.mLength);
+
+    (void)aIp6;
+    (void)aPort;
+
+    return aLength;
+}
+
+static void HandleRequest(const Coap::Resource &aResource,
+                          const Coap::Message & aRequest,
+                          Coap::Message &       aResponse,
+                          const uint8_t *       aIp6,
+                          uint16_t              aPort,
+                          void *                aContext)
+{
+    uint16_t length;
+
+    Benchmark::KeepAlive(aRequest.GetPayload(length));
+    aResponse.SetCode(Coap::kCodeChanged);
+
+    (void)aResource;
+    (void)aIp6;
+    (void)aPort;
+    (void)aContext;
+}
+
+// Encodes and sends a non-confirmable request, as the border agent forwards a TMF message.
+static void SendRequest(Coap::Agent &aAgent)
+{
+    Coap::Message *message = aAgent.NewMessage(Coap::kTypeNonConfirmable, Coap::kCodePost, kToken, sizeof(kToken));
+
+    message->SetPath("c/cs");
+    message->SetPayload(kPayload, sizeof(kPayload));
+    aAgent.Send(*message, kPeer, 61631, NULL, NULL);
+    aAgent.FreeMessage(message);
+}
+
+OTBR_BENCHMARK(Coap, Encode)
+{
+    CoapContext  context;
+    Coap::Agent *agent = Coap::Agent::Create(CaptureFrame, &context);
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        SendRequest(*agent);
+    }
+
+    Coap::Agent::Destroy(agent);
+}
+
+OTBR_BENCHMARK(Coap, Decode)
+{
+    CoapContext    context;
+    Coap::Agent *  agent = Coap::Agent::Create(CaptureFrame, &context);
+    Coap::Resource resource("c/cs", HandleRequest, NULL);
+    uint8_t        frame[kMaxFrameSize];
+    uint16_t       length;
+
+    // The response of each request is encoded and sent as well.
+    agent->AddResource(resource);
+    SendRequest(*agent);
+    memcpy(frame, context.mFrame, context.mLength);
+    length = context.mLength;
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        agent->Input(frame, length, kPeer, 61631);
+    }
+
+    agent->RemoveResource(resource);
+    Coap::Agent::Destroy(agent);
+}
+
+OTBR_BENCHMARK(Coap, InputResponse)
+{
+    CoapContext  context;
+    Coap::Agent *agent = Coap::Agent::Create(CaptureFrame, &context);
+    uint8_t      frame[kMaxFrameSize];
+    uint16_t     length;
+
+    // Responses matching no request are dropped after decoding.
+    SendRequest(*agent);
+    memcpy(frame, context.mFrame, context.mLength);
+    length   = context.mLength;
+    frame[0] = (frame[0] & 0xcf) | 0x20;
+    frame[1] = Coap::kCodeChanged;
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        agent->Input(frame, length, kPeer, 61631);
+    }
+
+    Coap::Agent::Destroy(agent);
+}
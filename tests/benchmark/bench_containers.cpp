@@ -0,0 +1,167 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes benchmarks of the flat containers against the standard containers they replaced.
+ */
+
+#include <map>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "common/flat_map.hpp"
+#include "common/small_vector.hpp"
+
+using namespace ot::BorderRouter;
+
+enum
+{
+    kKeyCount = 16, ///< Number of keys, like the CoAP resources or DBus watches of the agent.
+};
+
+OTBR_BENCHMARK(Containers, StdMapFind)
+{
+    std::map<const int *, int> map;
+    int                        keys[kKeyCount];
+    int                        sum = 0;
+
+    for (int i = 0; i < kKeyCount; ++i)
+    {
+        map[&keys[i]] = i;
+    }
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        sum += map.find(&keys[i % kKeyCount])->second;
+    }
+
+    Benchmark::KeepAlive(sum);
+}
+
+OTBR_BENCHMARK(Containers, FlatMapFind)
+{
+    FlatMap<const int *, int> map;
+    int                       keys[kKeyCount];
+    int                       sum = 0;
+
+    for (int i = 0; i < kKeyCount; ++i)
+    {
+        map.Set(&keys[i], i);
+    }
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        sum += *map.Find(&keys[i % kKeyCount]);
+    }
+
+    Benchmark::KeepAlive(sum);
+}
+
+OTBR_BENCHMARK(Containers, StdMapIterate)
+{
+    std::map<const int *, bool> map;
+    int                         keys[kKeyCount];
+    int                         sum = 0;
+
+    for (int i = 0; i < kKeyCount; ++i)
+    {
+        map[&keys[i]] = (i % 2 == 0);
+    }
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        for (std::map<const int *, bool>::const_iterator it = map.begin(); it != map.end(); ++it)
+        {
+            sum += it->second;
+        }
+    }
+
+    Benchmark::KeepAlive(sum);
+}
+
+OTBR_BENCHMARK(Containers, FlatMapIterate)
+{
+    FlatMap<const int *, bool> map;
+    int                        keys[kKeyCount];
+    int                        sum = 0;
+
+    for (int i = 0; i < kKeyCount; ++i)
+    {
+        map.Set(&keys[i], i % 2 == 0);
+    }
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        for (FlatMap<const int *, bool>::Iterator it = map.Begin(); it != map.End(); ++it)
+        {
+            sum += it->mValue;
+        }
+    }
+
+    Benchmark::KeepAlive(sum);
+}
+
+OTBR_BENCHMARK(Containers, StdVectorAddRemove)
+{
+    int                 sum     = 0;
+    const int *volatile element = &sum;
+
+    // The element is read on each iteration, so that the iterations are not optimized out.
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        std::vector<const int *> vector;
+        const int *              value = element;
+
+        vector.push_back(value);
+        vector.push_back(value);
+        vector.erase(vector.begin());
+        sum += static_cast<int>(vector.size()) + *vector[0];
+    }
+
+    Benchmark::KeepAlive(sum);
+}
+
+OTBR_BENCHMARK(Containers, SmallVectorAddRemove)
+{
+    int                 sum     = 0;
+    const int *volatile element = &sum;
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        SmallVector<const int *, 4> vector;
+        const int *                 value = element;
+
+        vector.PushBack(value);
+        vector.PushBack(value);
+        vector.Erase(vector.Begin());
+        sum += static_cast<int>(vector.GetSize()) + *vector[0];
+    }
+
+    Benchmark::KeepAlive(sum);
+}
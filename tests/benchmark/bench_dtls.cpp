@@ -0,0 +1,161 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes benchmarks of the crypto of DTLS sessions.
+ *
+ *   Built with --with-mbedtls-alt, they measure the alternative implementations instead of the software ones.
+ */
+
+#include <string.h>
+
+#include <mbedtls/ccm.h>
+#include <mbedtls/ecjpake.h>
+
+#include "benchmark.hpp"
+
+using namespace ot::BorderRouter;
+
+enum
+{
+    kRecordLength    = 64,  ///< Length of a typical commissioner record in bytes.
+    kRecordTagLength = 8,   ///< Tag length of TLS_ECJPAKE_WITH_AES_128_CCM_8.
+    kRoundLength     = 512, ///< Max length of an EC-JPAKE round message.
+};
+
+static const unsigned char kKey[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                                     0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+
+static const unsigned char kNonce[] = {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b};
+
+// The sequence number, content type, version and length authenticated with the record.
+static const unsigned char kAdditional[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                            0x01, 0x17, 0xfe, 0xfd, 0x00, kRecordLength};
+
+static const unsigned char kPskc[] = {0xc3, 0xf5, 0x9f, 0xa9, 0xbc, 0xb4, 0x9c, 0xe4,
+                                      0xb5, 0x32, 0x69, 0x35, 0x69, 0x3f, 0x42, 0xde};
+
+// Benchmarks only need reproducible bytes, not unpredictable ones.
+static int GenerateRandom(void *aContext, unsigned char *aBuffer, size_t aLength)
+{
+    uint32_t &state = *static_cast<uint32_t *>(aContext);
+
+    for (size_t i = 0; i < aLength; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        aBuffer[i] = static_cast<unsigned char>(state);
+    }
+
+    return 0;
+}
+
+// Each iteration protects a record as MbedtlsSession::Write() does.
+OTBR_BENCHMARK(Dtls, RecordEncrypt)
+{
+    mbedtls_ccm_context ccm;
+    unsigned char       record[kRecordLength];
+    unsigned char       tag[kRecordTagLength];
+
+    memset(record, 0x5a, sizeof(record));
+    mbedtls_ccm_init(&ccm);
+    mbedtls_ccm_setkey(&ccm, MBEDTLS_CIPHER_ID_AES, kKey, sizeof(kKey) * 8);
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        mbedtls_ccm_encrypt_and_tag(&ccm, sizeof(record), kNonce, sizeof(kNonce), kAdditional, sizeof(kAdditional),
+                                    record, record, tag, sizeof(tag));
+        Benchmark::KeepAlive(tag);
+    }
+
+    mbedtls_ccm_free(&ccm);
+}
+
+// Each iteration verifies and decrypts a record as MbedtlsSession::Read() does.
+OTBR_BENCHMARK(Dtls, RecordDecrypt)
+{
+    mbedtls_ccm_context ccm;
+    unsigned char       plain[kRecordLength];
+    unsigned char       cipher[kRecordLength];
+    unsigned char       output[kRecordLength];
+    unsigned char       tag[kRecordTagLength];
+
+    memset(plain, 0x5a, sizeof(plain));
+    mbedtls_ccm_init(&ccm);
+    mbedtls_ccm_setkey(&ccm, MBEDTLS_CIPHER_ID_AES, kKey, sizeof(kKey) * 8);
+    mbedtls_ccm_encrypt_and_tag(&ccm, sizeof(plain), kNonce, sizeof(kNonce), kAdditional, sizeof(kAdditional), plain,
+                                cipher, tag, sizeof(tag));
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        Benchmark::KeepAlive(mbedtls_ccm_auth_decrypt(&ccm, sizeof(cipher), kNonce, sizeof(kNonce), kAdditional,
+                                                      sizeof(kAdditional), cipher, output, tag, sizeof(tag)));
+    }
+
+    mbedtls_ccm_free(&ccm);
+}
+
+// Each iteration runs the EC-JPAKE exchange of a handshake, computing both the border agent and the commissioner.
+OTBR_BENCHMARK(Dtls, EcjpakeExchange)
+{
+    uint32_t      state = 0x2545f491;
+    unsigned char buffer[kRoundLength];
+    unsigned char secret[MBEDTLS_ECP_MAX_BYTES];
+    size_t        length;
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        mbedtls_ecjpake_context server;
+        mbedtls_ecjpake_context client;
+
+        mbedtls_ecjpake_init(&server);
+        mbedtls_ecjpake_init(&client);
+        mbedtls_ecjpake_setup(&server, MBEDTLS_ECJPAKE_SERVER, MBEDTLS_MD_SHA256, MBEDTLS_ECP_DP_SECP256R1, kPskc,
+                              sizeof(kPskc));
+        mbedtls_ecjpake_setup(&client, MBEDTLS_ECJPAKE_CLIENT, MBEDTLS_MD_SHA256, MBEDTLS_ECP_DP_SECP256R1, kPskc,
+                              sizeof(kPskc));
+
+        mbedtls_ecjpake_write_round_one(&client, buffer, sizeof(buffer), &length, GenerateRandom, &state);
+        mbedtls_ecjpake_read_round_one(&server, buffer, length);
+        mbedtls_ecjpake_write_round_one(&server, buffer, sizeof(buffer), &length, GenerateRandom, &state);
+        mbedtls_ecjpake_read_round_one(&client, buffer, length);
+
+        mbedtls_ecjpake_write_round_two(&server, buffer, sizeof(buffer), &length, GenerateRandom, &state);
+        mbedtls_ecjpake_read_round_two(&client, buffer, length);
+        mbedtls_ecjpake_write_round_two(&client, buffer, sizeof(buffer), &length, GenerateRandom, &state);
+        mbedtls_ecjpake_read_round_two(&server, buffer, length);
+
+        mbedtls_ecjpake_derive_secret(&server, secret, sizeof(secret), &length, GenerateRandom, &state);
+        Benchmark::KeepAlive(secret);
+
+        mbedtls_ecjpake_free(&client);
+        mbedtls_ecjpake_free(&server);
+    }
+}
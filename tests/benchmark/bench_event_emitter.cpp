@@ -0,0 +1,115 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes benchmarks of the event emitter.
+ */
+
+#include <stdarg.h>
+
+#include "benchmark.hpp"
+#include "common/event_emitter.hpp"
+
+using namespace ot::BorderRouter;
+
+enum
+{
+    kEventBenchmark = 1,
+};
+
+struct BenchmarkPayload
+{
+    enum
+    {
+        kEvent = kEventBenchmark,
+    };
+
+    int mValue;
+};
+
+static void HandleEvent(void *aContext, int aEvent, va_list aArguments)
+{
+    *static_cast<int *>(aContext) += va_arg(aArguments, int);
+
+    (void)aEvent;
+}
+
+static void HandlePayload(void *aContext, const BenchmarkPayload &aPayload)
+{
+    *static_cast<int *>(aContext) += aPayload.mValue;
+}
+
+OTBR_BENCHMARK(EventEmitter, Emit)
+{
+    EventEmitter emitter;
+    int          sum = 0;
+
+    emitter.On(kEventBenchmark, HandleEvent, &sum);
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        emitter.Emit(kEventBenchmark, 1);
+    }
+
+    Benchmark::KeepAlive(sum);
+}
+
+OTBR_BENCHMARK(EventEmitter, EmitFourHandlers)
+{
+    EventEmitter emitter;
+    int          sums[EventEmitter::kMaxHandlers] = {0};
+
+    for (int i = 0; i < EventEmitter::kMaxHandlers; ++i)
+    {
+        emitter.On(kEventBenchmark, HandleEvent, &sums[i]);
+    }
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        emitter.Emit(kEventBenchmark, 1);
+    }
+
+    Benchmark::KeepAlive(sums);
+}
+
+OTBR_BENCHMARK(EventEmitter, EmitPayload)
+{
+    EventEmitter     emitter;
+    BenchmarkPayload payload = {1};
+    int              sum     = 0;
+
+    emitter.On(HandlePayload, &sum);
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        emitter.EmitPayload(payload);
+    }
+
+    Benchmark::KeepAlive(sum);
+}
@@ -0,0 +1,117 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes benchmarks of the logging service.
+ */
+
+#include "benchmark.hpp"
+#include "common/logging.hpp"
+
+using namespace ot::BorderRouter;
+
+/**
+ * This class sets up logging at the given level for the lifetime of a benchmark.
+ *
+ * The log file takes logs of every level, so only syslog filters logs by level.
+ *
+ */
+class LogScope
+{
+public:
+    LogScope(int aLevel, const char *aFilename)
+    {
+        otbrLogInit("otbr-benchmark", aLevel);
+        otbrLogEnableSyslog(aFilename == NULL);
+        otbrLogSetFilename(aFilename);
+    }
+
+    ~LogScope(void)
+    {
+        otbrLogSetFilename(NULL);
+        otbrLogDeinit();
+    }
+};
+
+// Logs above the level return after the level check, and are never written to syslog.
+OTBR_BENCHMARK(Logging, Filtered)
+{
+    LogScope scope(OTBR_LOG_WARNING, NULL);
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        otbrLog(OTBR_LOG_INFO, "benchmark %s %d", "filtered", static_cast<int>(i));
+    }
+}
+
+OTBR_BENCHMARK(Logging, Written)
+{
+    LogScope scope(OTBR_LOG_INFO, "/dev/null");
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        otbrLog(OTBR_LOG_INFO, "benchmark %s %d", "written", static_cast<int>(i));
+    }
+}
+
+OTBR_BENCHMARK(Logging, WrittenByFileWriter)
+{
+    LogScope scope(OTBR_LOG_INFO, "/dev/null");
+
+    otbrLogStartFileWriter(64 * 1024, 0);
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        otbrLog(OTBR_LOG_INFO, "benchmark %s %d", "file writer", static_cast<int>(i));
+    }
+}
+
+// Logs are recorded to the ring and formatted by a background thread, whose cost is not measured.
+OTBR_BENCHMARK(Logging, Ring)
+{
+    LogScope scope(OTBR_LOG_INFO, "/dev/null");
+
+    otbrLogRingStart(true);
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        otbrLog(OTBR_LOG_INFO, "benchmark %s %d", "ring", static_cast<int>(i));
+    }
+}
+
+OTBR_BENCHMARK(Logging, Dump)
+{
+    const uint8_t frame[64] = {0};
+    LogScope      scope(OTBR_LOG_DEBUG, "/dev/null");
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        otbrDump(OTBR_LOG_DEBUG, "benchmark", frame, sizeof(frame));
+    }
+}
@@ -0,0 +1,214 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes benchmarks of the TLV, hex, CRC16 and steering data utilities.
+ */
+
+#include <string.h>
+
+#include "benchmark.hpp"
+#include "common/tlv.hpp"
+#include "utils/crc16.hpp"
+#include "utils/hex.hpp"
+#include "utils/steeringdata.hpp"
+#include "utils/steeringdata_builder.hpp"
+
+using namespace ot::BorderRouter;
+
+enum
+{
+    kNumTlvs    = 8,
+    kTlvLength  = 8,
+    kEui64Size  = 8,
+    kBufferSize = 256,
+    kNumJoiners = 1024,
+    kDataSize   = 128,
+};
+
+static const uint8_t kEui64[kEui64Size] = {0x18, 0xb4, 0x30, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+OTBR_BENCHMARK(Tlv, Iterate)
+{
+    uint8_t        buffer[kBufferSize];
+    const uint8_t  value[kTlvLength] = {0};
+    ot::Tlv *      tlv               = reinterpret_cast<ot::Tlv *>(buffer);
+    const ot::Tlv *end;
+    unsigned int   sum = 0;
+
+    // A dataset sized message, as the border agent walks the TLVs of commissioner requests.
+    for (int i = 0; i < kNumTlvs; ++i)
+    {
+        tlv->SetType(static_cast<uint8_t>(i));
+        tlv->SetValue(value, sizeof(value));
+        tlv = tlv->GetNext();
+    }
+
+    end = tlv;
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        const ot::Tlv *cursor = reinterpret_cast<const ot::Tlv *>(buffer);
+
+        while (cursor < end)
+        {
+            sum += cursor->GetType() + cursor->GetLength();
+            cursor = cursor->GetNext();
+        }
+
+        Benchmark::KeepAlive(sum);
+    }
+}
+
+OTBR_BENCHMARK(Hex, Hex2Bytes)
+{
+    uint8_t bytes[kEui64Size];
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        ot::Utils::Hex2Bytes("18b4300000000001", bytes, sizeof(bytes));
+        Benchmark::KeepAlive(bytes);
+    }
+}
+
+OTBR_BENCHMARK(Hex, Bytes2Hex)
+{
+    char hex[kEui64Size * 2 + 1];
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        ot::Utils::Bytes2Hex(kEui64, sizeof(kEui64), hex);
+        Benchmark::KeepAlive(hex);
+    }
+}
+
+OTBR_BENCHMARK(Hex, Hex2BytesLength)
+{
+    static const char kHex[] = "18b4300000000001";
+    uint8_t           bytes[kEui64Size];
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        ot::Utils::Hex2Bytes(kHex, sizeof(kHex) - 1, bytes, sizeof(bytes));
+        Benchmark::KeepAlive(bytes);
+    }
+}
+
+OTBR_BENCHMARK(Hex, Hex2BytesData)
+{
+    char    hex[kDataSize * 2 + 1];
+    uint8_t bytes[kDataSize];
+
+    // A large D-Bus data property.
+    memset(hex, 'a', sizeof(hex) - 1);
+    hex[sizeof(hex) - 1] = '\0';
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        ot::Utils::Hex2Bytes(hex, sizeof(hex) - 1, bytes, sizeof(bytes));
+        Benchmark::KeepAlive(bytes);
+    }
+}
+
+OTBR_BENCHMARK(Hex, Bytes2HexData)
+{
+    uint8_t bytes[kDataSize];
+    char    hex[kDataSize * 2 + 1];
+
+    memset(bytes, 0x5a, sizeof(bytes));
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        ot::Utils::Bytes2Hex(bytes, sizeof(bytes), hex);
+        Benchmark::KeepAlive(hex);
+    }
+}
+
+OTBR_BENCHMARK(Crc16, UpdateEui64)
+{
+    ot::Crc16 crc(ot::Crc16::kCcitt);
+
+    // The hash of a joiner ID into the steering data.
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        crc.Init();
+        crc.Update(kEui64, sizeof(kEui64));
+        Benchmark::KeepAlive(crc);
+    }
+}
+
+OTBR_BENCHMARK(Crc16, UpdateData)
+{
+    uint8_t   bytes[kDataSize];
+    ot::Crc16 crc(ot::Crc16::kAnsi);
+
+    memset(bytes, 0x5a, sizeof(bytes));
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        crc.Init();
+        crc.Update(bytes, sizeof(bytes));
+        Benchmark::KeepAlive(crc);
+    }
+}
+
+OTBR_BENCHMARK(SteeringData, ComputeBloomFilter)
+{
+    ot::SteeringData steeringData;
+
+    steeringData.Init();
+
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        steeringData.Clear();
+        steeringData.ComputeBloomFilter(kEui64);
+        Benchmark::KeepAlive(steeringData);
+    }
+}
+
+OTBR_BENCHMARK(SteeringDataBuilder, AddEui64s)
+{
+    static uint8_t          entries[kNumJoiners * kEui64Size];
+    ot::SteeringDataBuilder builder;
+
+    for (size_t i = 0; i < kNumJoiners; ++i)
+    {
+        memcpy(&entries[i * kEui64Size], kEui64, kEui64Size);
+        entries[i * kEui64Size + kEui64Size - 1] = static_cast<uint8_t>(i);
+        entries[i * kEui64Size + kEui64Size - 2] = static_cast<uint8_t>(i >> 8);
+    }
+
+    // A joiner allow-list hashed on the calling thread only, the list is below the parallel threshold.
+    for (uint64_t i = 0; i < aIterations; ++i)
+    {
+        builder.Init(16);
+        builder.Add(entries, kNumJoiners, ot::SteeringDataBuilder::kEntryEui64, 1);
+        Benchmark::KeepAlive(builder);
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the micro-benchmark harness.
+ */
+
+#ifndef BENCHMARK_HPP_
+#define BENCHMARK_HPP_
+
+#include <stdint.h>
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Benchmark {
+
+/**
+ * This function pointer runs @p aIterations iterations of a benchmark.
+ *
+ * @param[in]   aIterations     The number of iterations to run.
+ *
+ */
+typedef void (*Function)(uint64_t aIterations);
+
+/**
+ * This class registers a benchmark on construction.
+ *
+ * Benchmarks are defined with OTBR_BENCHMARK(), which defines a static registration.
+ *
+ */
+class Registration
+{
+public:
+    /**
+     * The constructor registers a benchmark.
+     *
+     * @param[in]   aGroup      The group of the benchmark, which must outlive it.
+     * @param[in]   aName       The name of the benchmark within its group, which must outlive it.
+     * @param[in]   aFunction   The function running the benchmark.
+     *
+     */
+    Registration(const char *aGroup, const char *aName, Function aFunction);
+
+    const char *        mGroup;    ///< The group of the benchmark.
+    const char *        mName;     ///< The name of the benchmark within its group.
+    Function            mFunction; ///< The function running the benchmark.
+    const Registration *mNext;     ///< The benchmark registered before this one.
+
+    /**
+     * This function returns the benchmark registered last.
+     *
+     * @returns A pointer to the first benchmark, NULL if none is registered.
+     *
+     */
+    static const Registration *GetFirst(void);
+};
+
+/**
+ * This function keeps the compiler from optimizing out the computation of a value.
+ *
+ * @param[in]   aValue  A reference to the value.
+ *
+ */
+template <typename Type> inline void KeepAlive(const Type &aValue)
+{
+    __asm__ __volatile__("" : : "r"(&aValue) : "memory");
+}
+
+} // namespace Benchmark
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+/**
+ * This macro defines a benchmark, followed by the body of its function taking the number of iterations in
+ * `aIterations`.
+ *
+ */
+#define OTBR_BENCHMARK(aGroup, aName)                                                    \
+    static void Benchmark##aGroup##aName(uint64_t aIterations);                          \
+    static const ot::BorderRouter::Benchmark::Registration sRegistration##aGroup##aName( \
+        #aGroup, #aName, Benchmark##aGroup##aName);                                      \
+    static void Benchmark##aGroup##aName(uint64_t aIterations)
+
+#endif // BENCHMARK_HPP_
@@ -0,0 +1,277 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the runner of micro-benchmarks, which writes results as JSON.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "otbr-config.h"
+
+#include "benchmark.hpp"
+#include "common/code_utils.hpp"
+#include "common/time.hpp"
+#include "utils/cpu_features.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Benchmark {
+
+static const Registration *sFirst = NULL;
+
+Registration::Registration(const char *aGroup, const char *aName, Function aFunction)
+    : mGroup(aGroup)
+    , mName(aName)
+    , mFunction(aFunction)
+    , mNext(sFirst)
+{
+    sFirst = this;
+}
+
+const Registration *Registration::GetFirst(void)
+{
+    return sFirst;
+}
+
+} // namespace Benchmark
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+using ot::BorderRouter::GetMonotonicNowUs;
+using ot::BorderRouter::Benchmark::Registration;
+using ot::Utils::CpuFeatures;
+
+enum
+{
+    kDefaultMinTime     = 200, ///< Default milliseconds a repetition runs at least.
+    kDefaultRepetitions = 5,   ///< Default number of repetitions of a benchmark.
+};
+
+struct Result
+{
+    uint64_t            mIterations;
+    double              mMedian;
+    double              mMin;
+    double              mMax;
+    std::vector<double> mSamples; ///< Nanoseconds per iteration of each repetition, sorted.
+};
+
+static bool CompareRegistrations(const Registration *aLeft, const Registration *aRight)
+{
+    int order = strcmp(aLeft->mGroup, aRight->mGroup);
+
+    return order < 0 || (order == 0 && strcmp(aLeft->mName, aRight->mName) < 0);
+}
+
+static uint64_t RunIterations(const Registration &aBenchmark, uint64_t aIterations)
+{
+    uint64_t start = GetMonotonicNowUs();
+
+    aBenchmark.mFunction(aIterations);
+
+    return GetMonotonicNowUs() - start;
+}
+
+static Result Run(const Registration &aBenchmark, unsigned int aMinTime, unsigned int aRepetitions)
+{
+    uint64_t            minTime    = static_cast<uint64_t>(aMinTime) * 1000;
+    uint64_t            iterations = 1;
+    uint64_t            elapsed;
+    std::vector<double> samples;
+    Result              result;
+
+    // The iteration count is grown until a run takes a tenth of the min time, then scaled to the min time. This run
+    // also warms up caches and allocator pools.
+    while ((elapsed = RunIterations(aBenchmark, iterations)) < minTime / 10)
+    {
+        iterations *= 2;
+    }
+
+    if (elapsed < minTime)
+    {
+        iterations = iterations * minTime / (elapsed > 0 ? elapsed : 1);
+    }
+
+    for (unsigned int i = 0; i < aRepetitions; ++i)
+    {
+        samples.push_back(static_cast<double>(RunIterations(aBenchmark, iterations)) * 1000 / iterations);
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    result.mIterations = iterations;
+    result.mMedian     = samples[samples.size() / 2];
+    result.mMin        = samples.front();
+    result.mMax        = samples.back();
+    result.mSamples    = samples;
+
+    return result;
+}
+
+static void PrintUsage(const char *aProgram)
+{
+    fprintf(stderr, "Usage: %s [-d CPU_FEATURES] [-f FILTER] [-o OUTPUT_FILE] [-r REPETITIONS] [-t MIN_TIME_MS]\n",
+            aProgram);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *                      filter      = NULL;
+    const char *                      outputFile  = NULL;
+    unsigned int                      minTime     = kDefaultMinTime;
+    unsigned int                      repetitions = kDefaultRepetitions;
+    FILE *                            output      = stdout;
+    std::vector<const Registration *> benchmarks;
+    char                              host[64];
+    char                              date[32];
+    char                              features[64];
+    uint32_t                          disabled = 0;
+    time_t                            now = time(NULL);
+    int                               opt;
+    int                               ret = EXIT_SUCCESS;
+
+    while ((opt = getopt(argc, argv, "d:f:o:r:t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            // The kernels of the features disabled are compared with those bound by default.
+            VerifyOrExit(CpuFeatures::Parse(optarg, disabled), fprintf(stderr, "Unknown CPU features: %s\n", optarg),
+                         ret = EXIT_FAILURE);
+            break;
+
+        case 'f':
+            filter = optarg;
+            break;
+
+        case 'o':
+            outputFile = optarg;
+            break;
+
+        case 'r':
+            repetitions = static_cast<unsigned int>(atoi(optarg));
+            break;
+
+        case 't':
+            minTime = static_cast<unsigned int>(atoi(optarg));
+            break;
+
+        default:
+            PrintUsage(argv[0]);
+            ExitNow(ret = EXIT_FAILURE);
+        }
+    }
+
+    VerifyOrExit(repetitions > 0 && minTime > 0, PrintUsage(argv[0]), ret = EXIT_FAILURE);
+    CpuFeatures::Disable(disabled);
+    VerifyOrExit(outputFile == NULL || (output = fopen(outputFile, "w")) != NULL, perror(outputFile),
+                 ret = EXIT_FAILURE);
+
+    for (const Registration *benchmark = Registration::GetFirst(); benchmark != NULL; benchmark = benchmark->mNext)
+    {
+        benchmarks.push_back(benchmark);
+    }
+
+    // Benchmarks run in the same order whatever the link order.
+    std::sort(benchmarks.begin(), benchmarks.end(), CompareRegistrations);
+
+    if (gethostname(host, sizeof(host)) != 0)
+    {
+        strcpy(host, "unknown");
+    }
+
+    host[sizeof(host) - 1] = '\0';
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    fprintf(output, "{\n  \"context\": {\n");
+    fprintf(output, "    \"version\": \"%s\",\n", PACKAGE_VERSION);
+    fprintf(output, "    \"date\": \"%s\",\n", date);
+    fprintf(output, "    \"host\": \"%s\",\n", host);
+    fprintf(output, "    \"cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(output, "    \"cpu_features\": \"%s\",\n",
+            CpuFeatures::Format(CpuFeatures::Get(), features, sizeof(features)));
+    fprintf(output, "    \"min_time_ms\": %u,\n", minTime);
+    fprintf(output, "    \"repetitions\": %u\n", repetitions);
+    fprintf(output, "  },\n  \"benchmarks\": [");
+
+    for (size_t i = 0, count = 0; i < benchmarks.size(); ++i)
+    {
+        const Registration &benchmark = *benchmarks[i];
+        char                name[128];
+        Result              result;
+
+        snprintf(name, sizeof(name), "%s.%s", benchmark.mGroup, benchmark.mName);
+
+        if (filter != NULL && strstr(name, filter) == NULL)
+        {
+            continue;
+        }
+
+        fprintf(stderr, "Running %s...\n", name);
+        result = Run(benchmark, minTime, repetitions);
+
+        fprintf(output, "%s\n    {\"name\": \"%s\", \"iterations\": %llu, ", count++ == 0 ? "" : ",", name,
+                static_cast<unsigned long long>(result.mIterations));
+        fprintf(output, "\"ns_per_op\": %.2f, \"min_ns_per_op\": %.2f, \"max_ns_per_op\": %.2f, ", result.mMedian,
+                result.mMin, result.mMax);
+
+        // The samples let tools/bench-compare tell regressions from noise.
+        fprintf(output, "\"samples_ns_per_op\": [");
+
+        for (size_t j = 0; j < result.mSamples.size(); ++j)
+        {
+            fprintf(output, "%s%.2f", j == 0 ? "" : ", ", result.mSamples[j]);
+        }
+
+        fprintf(output, "]}");
+        fflush(output);
+    }
+
+    fprintf(output, "\n  ]\n}\n");
+
+exit:
+    if (output != NULL && output != stdout)
+    {
+        fclose(output);
+    }
+
+    return ret;
+}
@@ -77,14 +77,27 @@ int Mainloop(Mdns::Publisher &aPublisher)
     return rval;
 }
 
+// Publishes a meshcop service on all interfaces with the network name and extended PAN id as text record.
+static otbrError PublishMeshcop(uint16_t aPort, const char *aName, const char *aNetworkName, const char *aExtPanId)
+{
+    Mdns::TxtRecord txt;
+    otbrError       ret = OTBR_ERROR_NONE;
+
+    SuccessOrExit(ret = txt.SetEntry("nn", aNetworkName));
+    SuccessOrExit(ret = txt.SetEntry("xp", aExtPanId));
+    ret = context.mPublisher->PublishService(0, aPort, aName, "_meshcop._udp", txt);
+
+exit:
+    return ret;
+}
+
 void PublishSingleService(void *aContext, Mdns::State aState)
 {
     assert(aContext == &context);
 
     if (aState == Mdns::kStateReady)
     {
-        assert(OTBR_ERROR_NONE == context.mPublisher->PublishService(12345, "SingleService", "_meshcop._udp", "nn",
-                                                                     "cool", "xp", "1122334455667788", NULL));
+        assert(OTBR_ERROR_NONE == PublishMeshcop(12345, "SingleService", "cool", "1122334455667788"));
     }
 }
 
@@ -94,10 +107,8 @@ void PublishMultipleServices(void *aContext, Mdns::State aState)
 
     if (aState == Mdns::kStateReady)
     {
-        assert(OTBR_ERROR_NONE == context.mPublisher->PublishService(12345, "MultipleService1", "_meshcop._udp", "nn",
-                                                                     "cool1", "xp", "1122334455667788", NULL));
-        assert(OTBR_ERROR_NONE == context.mPublisher->PublishService(12346, "MultipleService2", "_meshcop._udp", "nn",
-                                                                     "cool2", "xp", "1122334455667788", NULL));
+        assert(OTBR_ERROR_NONE == PublishMeshcop(12345, "MultipleService1", "cool1", "1122334455667788"));
+        assert(OTBR_ERROR_NONE == PublishMeshcop(12346, "MultipleService2", "cool2", "1122334455667788"));
     }
 }
 
@@ -109,13 +120,11 @@ void PublishUpdateServices(void *aContext, Mdns::State aState)
     {
         if (!context.mUpdate)
         {
-            assert(OTBR_ERROR_NONE == context.mPublisher->PublishService(12345, "UpdateService", "_meshcop._udp", "nn",
-                                                                         "cool", "xp", "1122334455667788", NULL));
+            assert(OTBR_ERROR_NONE == PublishMeshcop(12345, "UpdateService", "cool", "1122334455667788"));
         }
         else
         {
-            assert(OTBR_ERROR_NONE == context.mPublisher->PublishService(12345, "UpdateService", "_meshcop._udp", "nn",
-                                                                         "coolcool", "xp", "8877665544332211", NULL));
+            assert(OTBR_ERROR_NONE == PublishMeshcop(12345, "UpdateService", "coolcool", "8877665544332211"));
         }
     }
 }
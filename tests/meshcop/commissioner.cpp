@@ -28,31 +28,26 @@
 
 /**
  * @file
- *   The file implements the Thread commissioner for test.
+ *   The file implements the commissioner sessions of libotbr-commissioner.
  */
 #include "commissioner.hpp"
+#include "common/time.hpp"
 
-const uint8_t kSeed[]           = "Commissioner";
-const char    kCommissionerId[] = "OpenThread";
-const int     kCipherSuites[]   = {MBEDTLS_TLS_ECJPAKE_WITH_AES_128_CCM_8, 0};
+static const struct timeval kPollTimeout = {1, 0};
 
-const struct timeval kPollTimeout = {1, 0};
+static void HandleRelayReceive(const Coap::Resource &aResource,
+                               const Coap::Message & aMessage,
+                               Coap::Message &       aResponse,
+                               const uint8_t *       aIp6,
+                               uint16_t              aPort,
+                               void *                aContext);
 
-struct Context gContext;
-
-void HandleRelayReceive(const Coap::Resource &aResource,
-                        const Coap::Message & aMessage,
-                        Coap::Message &       aResponse,
-                        const uint8_t *       aIp6,
-                        uint16_t              aPort,
-                        void *                aContext);
-
-void HandleJoinerFinalize(const Coap::Resource &aResource,
-                          const Coap::Message & aMessage,
-                          Coap::Message &       aResponse,
-                          const uint8_t *       aIp6,
-                          uint16_t              aPort,
-                          void *                aContext);
+static void HandleJoinerFinalize(const Coap::Resource &aResource,
+                                 const Coap::Message & aMessage,
+                                 Coap::Message &       aResponse,
+                                 const uint8_t *       aIp6,
+                                 uint16_t              aPort,
+                                 void *                aContext);
 
 /* from the example:
  * http://beej.us/guide/bgnet/output/html/multipage/inet_ntopman.html
@@ -78,25 +73,81 @@ static char *get_ip_str(const struct sockaddr *sa, char *s, size_t maxlen)
     return s;
 }
 
-inline uint16_t LengthOf(const void *aStart, const void *aEnd)
+/** find the joiner session of a coap port, as given to Coap::Agent::Input() by FeedCoaps() */
+static JoinerSession *FindJoinerByPort(Context &aContext, uint16_t aPort)
 {
-    return static_cast<const uint8_t *>(aEnd) - static_cast<const uint8_t *>(aStart);
+    JoinerSession *joiner = NULL;
+
+    VerifyOrExit(aPort > 0 && static_cast<int>(aPort) <= aContext.mJoinerCount);
+    joiner = &aContext.mJoiners[aPort - 1];
+
+exit:
+    return joiner;
 }
 
-void HandleJoinerFinalize(const Coap::Resource &aResource,
-                          const Coap::Message & aRequest,
-                          Coap::Message &       aResponse,
-                          const uint8_t *       aIp6,
-                          uint16_t              aPort,
-                          void *                aContext)
+/** find the joiner session of a relayed joiner IID, assigning a session on its first relay */
+static JoinerSession *FindJoinerByIid(Context &aContext, const uint8_t *aIid)
 {
-    Context &context = *static_cast<Context *>(aContext);
-    uint8_t  payload[10];
-    Tlv *    responseTlv = reinterpret_cast<Tlv *>(payload);
+    JoinerSession *joiner = NULL;
+    uint8_t        joinerId[kEui64Len];
 
-    otbrLog(OTBR_LOG_INFO, "HandleJoinerFinalize, STATE = 1\n");
+    /* the joiner uses its joiner id as extended address, its IID toggles the locally administered bit */
+    memcpy(joinerId, aIid, sizeof(joinerId));
+    joinerId[0] ^= 2;
+
+    /* the joiner of the IID first, then a session for any joiner, the commissioned ones are done with */
+    for (int pass = 0; pass < 2 && joiner == NULL; pass++)
+    {
+        for (int i = 0; i < aContext.mJoinerCount; i++)
+        {
+            JoinerSession &session = aContext.mJoiners[i];
+
+            if (session.mState == kStateDone)
+            {
+                continue;
+            }
 
-    context.mState = kStateFinalized;
+            if (pass == 0 ? (session.mRelayed ? memcmp(session.mIid, aIid, sizeof(session.mIid)) == 0
+                                              : (!session.mAnyJoiner &&
+                                                 memcmp(session.mJoinerId, joinerId, sizeof(joinerId)) == 0))
+                          : (!session.mRelayed && session.mAnyJoiner))
+            {
+                joiner = &session;
+                break;
+            }
+        }
+    }
+
+    VerifyOrExit(joiner != NULL);
+
+    if (!joiner->mRelayed)
+    {
+        memcpy(joiner->mIid, aIid, sizeof(joiner->mIid));
+        joiner->mRelayed = true;
+        otbrLog(OTBR_LOG_INFO, "joiner %s: relayed to port %d", CommissionerUtilsHexString(aIid, sizeof(joiner->mIid)),
+                joiner->mPortSession);
+    }
+
+exit:
+    return joiner;
+}
+
+static void HandleJoinerFinalize(const Coap::Resource &aResource,
+                                 const Coap::Message & aRequest,
+                                 Coap::Message &       aResponse,
+                                 const uint8_t *       aIp6,
+                                 uint16_t              aPort,
+                                 void *                aContext)
+{
+    Context &      context = *static_cast<Context *>(aContext);
+    JoinerSession *joiner  = FindJoinerByPort(context, aPort);
+    uint8_t        payload[10];
+    Tlv *          responseTlv = reinterpret_cast<Tlv *>(payload);
+
+    VerifyOrExit(joiner != NULL, otbrLog(OTBR_LOG_ERR, "HandleJoinerFinalize: no joiner on port %d", aPort));
+    otbrLog(OTBR_LOG_INFO, "HandleJoinerFinalize, port %d STATE = 1\n", joiner->mPortSession);
+
+    joiner->mState = kStateFinalized;
     responseTlv->SetType(Meshcop::kState);
     responseTlv->SetValue(static_cast<uint8_t>(1));
     responseTlv = responseTlv->GetNext();
@@ -105,64 +156,53 @@ void HandleJoinerFinalize(const Coap::Resource &aResource,
     aResponse.SetCode(Coap::kCodeChanged);
     aResponse.SetPayload(payload, LengthOf(payload, responseTlv));
 
+exit:
     (void)aResource;
     (void)aRequest;
     (void)aIp6;
-    (void)aPort;
 }
 
-void HandleRelayReceive(const Coap::Resource &aResource,
-                        const Coap::Message & aMessage,
-                        Coap::Message &       aResponse,
-                        const uint8_t *       aIp6,
-                        uint16_t              aPort,
-                        void *                aContext)
+static void HandleRelayReceive(const Coap::Resource &aResource,
+                               const Coap::Message & aMessage,
+                               Coap::Message &       aResponse,
+                               const uint8_t *       aIp6,
+                               uint16_t              aPort,
+                               void *                aContext)
 {
-    int            ret = 0;
-    int            tlvType;
-    uint16_t       length;
-    Context &      context = *static_cast<Context *>(aContext);
-    const uint8_t *payload = aMessage.GetPayload(length);
-
-    for (const Tlv *requestTlv = reinterpret_cast<const Tlv *>(payload); LengthOf(payload, requestTlv) < length;
-         requestTlv            = requestTlv->GetNext())
+    int                ret = 0;
+    int                tlvType;
+    uint16_t           length;
+    Context &          context = *static_cast<Context *>(aContext);
+    const uint8_t *    payload = aMessage.GetPayload(length);
+    TlvReader          reader(payload, length);
+    const Tlv *        encapsulationTlv = NULL;
+    const Tlv *        iidTlv           = NULL;
+    uint16_t           udpPort          = 0;
+    uint16_t           routerLocator    = 0;
+    JoinerSession *    joiner;
+    struct sockaddr_in addr;
+
+    for (const Tlv *requestTlv = reader.GetNext(); requestTlv != NULL; requestTlv = reader.GetNext())
     {
         tlvType = requestTlv->GetType();
         switch (tlvType)
         {
         case Meshcop::kJoinerDtlsEncapsulation:
-            struct sockaddr_in addr;
-            memset(&addr, 0, sizeof(addr));
-            addr.sin_family = AF_INET;
-            addr.sin_port   = htons(kPortJoinerSession);
-
-            otbrLog(OTBR_LOG_INFO, "Encapsulation: %d bytes for port: %d", requestTlv->GetLength(), kPortJoinerSession);
-            {
-                char buf[IPSTR_BUFSIZE];
-                get_ip_str((struct sockaddr *)&addr, buf, sizeof(buf));
-                otbrLog(OTBR_LOG_INFO, "DEST: %s", buf);
-            }
-            ret = sendto(context.mSocket, requestTlv->GetValue(), requestTlv->GetLength(), 0,
-                         reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr));
-            if (ret < 0)
-            {
-                otbrLog(OTBR_LOG_ERR, "relay receive, sendto() fails with %d", errno);
-            }
-            VerifyOrExit(ret != -1, ret = errno);
+            encapsulationTlv = requestTlv;
             break;
 
         case Meshcop::kJoinerUdpPort:
-            context.mJoiner.mUdpPort = requestTlv->GetValueUInt16();
-            otbrLog(OTBR_LOG_INFO, "JoinerPort: %d", context.mJoiner.mUdpPort);
+            udpPort = requestTlv->GetValueUInt16();
+            otbrLog(OTBR_LOG_INFO, "JoinerPort: %d", udpPort);
             break;
 
         case Meshcop::kJoinerIid:
-            memcpy(context.mJoiner.mIid, requestTlv->GetValue(), sizeof(context.mJoiner.mIid));
+            iidTlv = requestTlv;
             break;
 
         case Meshcop::kJoinerRouterLocator:
-            context.mJoiner.mRouterLocator = requestTlv->GetValueUInt16();
-            otbrLog(OTBR_LOG_INFO, "Router locator: %d", context.mJoiner.mRouterLocator);
+            routerLocator = requestTlv->GetValueUInt16();
+            otbrLog(OTBR_LOG_INFO, "Router locator: %d", routerLocator);
             break;
 
         default:
@@ -171,6 +211,34 @@ void HandleRelayReceive(const Coap::Resource &aResource,
         }
     }
 
+    VerifyOrExit(encapsulationTlv != NULL && iidTlv != NULL && iidTlv->GetLength() == sizeof(joiner->mIid),
+                 otbrLog(OTBR_LOG_ERR, "relay receive, incomplete RLY_RX.ntf"));
+
+    /* the relay is not for one of our joiners, e.g. other devices in range while commissioning a batch */
+    joiner = FindJoinerByIid(context, static_cast<const uint8_t *>(iidTlv->GetValue()));
+    VerifyOrExit(joiner != NULL, otbrLog(OTBR_LOG_INFO, "relay receive, skip unknown joiner"));
+
+    joiner->mUdpPort       = udpPort;
+    joiner->mRouterLocator = routerLocator;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(joiner->mPortSession);
+
+    otbrLog(OTBR_LOG_INFO, "Encapsulation: %d bytes for port: %d", encapsulationTlv->GetLength(),
+            joiner->mPortSession);
+    {
+        char buf[IPSTR_BUFSIZE];
+        get_ip_str((struct sockaddr *)&addr, buf, sizeof(buf));
+        otbrLog(OTBR_LOG_INFO, "DEST: %s", buf);
+    }
+    ret = sendto(joiner->mSocket, encapsulationTlv->GetValue(), encapsulationTlv->GetLength(), 0,
+                 reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr));
+    if (ret < 0)
+    {
+        otbrLog(OTBR_LOG_ERR, "relay receive, sendto() fails with %d", errno);
+    }
+
 exit:
 
     (void)aResource;
@@ -181,8 +249,9 @@ exit:
     return;
 }
 
-int SendRelayTransmit(Context &aContext)
+static int SendRelayTransmit(JoinerSession &aJoiner)
 {
+    Context &          context = *aJoiner.mContext;
     uint8_t            payload[kSizeMaxPacket];
     uint8_t            dtlsEncapsulation[kSizeMaxPacket];
     Tlv *              responseTlv = reinterpret_cast<Tlv *>(payload);
@@ -191,7 +260,7 @@ int SendRelayTransmit(Context &aContext)
 
     addrlen = sizeof(from_addr);
 
-    ssize_t ret = recvfrom(aContext.mSocket, dtlsEncapsulation, sizeof(dtlsEncapsulation), 0,
+    ssize_t ret = recvfrom(aJoiner.mSocket, dtlsEncapsulation, sizeof(dtlsEncapsulation), 0,
                            (struct sockaddr *)(&from_addr), &addrlen);
 
     VerifyOrExit(ret > 0);
@@ -209,36 +278,36 @@ int SendRelayTransmit(Context &aContext)
     responseTlv = responseTlv->GetNext();
 
     responseTlv->SetType(Meshcop::kJoinerUdpPort);
-    responseTlv->SetValue(aContext.mJoiner.mUdpPort);
+    responseTlv->SetValue(aJoiner.mUdpPort);
     responseTlv = responseTlv->GetNext();
 
     responseTlv->SetType(Meshcop::kJoinerIid);
-    responseTlv->SetValue(aContext.mJoiner.mIid, sizeof(aContext.mJoiner.mIid));
+    responseTlv->SetValue(aJoiner.mIid, sizeof(aJoiner.mIid));
     responseTlv = responseTlv->GetNext();
 
     responseTlv->SetType(Meshcop::kJoinerRouterLocator);
-    responseTlv->SetValue(aContext.mJoiner.mRouterLocator);
+    responseTlv->SetValue(aJoiner.mRouterLocator);
     responseTlv = responseTlv->GetNext();
 
-    if (aContext.mState == kStateFinalized)
+    if (aJoiner.mState == kStateFinalized)
     {
         otbrLog(OTBR_LOG_INFO, "realy: KEK state");
         responseTlv->SetType(Meshcop::kJoinerRouterKek);
-        responseTlv->SetValue(aContext.mKek, sizeof(aContext.mKek));
+        responseTlv->SetValue(aJoiner.mKek, sizeof(aJoiner.mKek));
         responseTlv = responseTlv->GetNext();
     }
 
     {
         Coap::Message *message;
-        uint16_t       token = ++aContext.mCoapToken;
+        uint16_t       token = ++context.mCoapToken;
 
-        message = aContext.mCoap->NewMessage(Coap::kTypeNonConfirmable, Coap::kCodePost,
-                                             reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+        message = context.mCoap->NewMessage(Coap::kTypeNonConfirmable, Coap::kCodePost,
+                                            reinterpret_cast<const uint8_t *>(&token), sizeof(token));
         message->SetPath("c/tx");
         message->SetPayload(payload, LengthOf(payload, responseTlv));
         otbrLog(OTBR_LOG_INFO, "RELAY_tx.req: send");
-        aContext.mCoap->Send(*message, NULL, 0, NULL, &aContext);
-        aContext.mCoap->FreeMessage(message);
+        context.mCoap->Send(*message, NULL, 0, NULL, &context);
+        context.mCoap->FreeMessage(message);
     }
 
 exit:
@@ -248,20 +317,22 @@ exit:
 /** Sends coap messages via one of the dtls interfaces (agent, or joiner) */
 static ssize_t SendCoap(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort, void *aContext)
 {
-    ssize_t  ret     = 0;
-    Context &context = *static_cast<Context *>(aContext);
+    ssize_t        ret     = 0;
+    Context &      context = *static_cast<Context *>(aContext);
+    JoinerSession *joiner;
 
     if (aPort == 0)
     {
         otbrLog(OTBR_LOG_INFO, "SendCoap: ssl-write-lenth: %d", aLength);
-        ret = mbedtls_ssl_write(context.mSsl, aBuffer, aLength);
+        ret = context.mClient->Write(aBuffer, aLength);
     }
     else
     {
         otbrLog(OTBR_LOG_INFO, "SendCoap: session-write-len: %d", aLength);
-        if (context.mSession)
+        joiner = FindJoinerByPort(context, aPort);
+        if (joiner != NULL && joiner->mSession)
         {
-            ret = context.mSession->Write(aBuffer, aLength);
+            ret = joiner->mSession->Write(aBuffer, aLength);
         }
         else
         {
@@ -271,71 +342,61 @@ static ssize_t SendCoap(const uint8_t *aBuffer, uint16_t aLength, const uint8_t
     }
 
     (void)aIp6;
-    (void)aPort;
 
     return ret;
 }
 
-/** callback to print debug from mbed */
-static void my_debug(void *ctx, int level, const char *file, int line, const char *str)
+/** feed data from the agent into the coap session */
+static void FeedAgent(const uint8_t *aBuffer, uint16_t aLength, void *aContext)
 {
-    ((void)level);
-    (void)(ctx);
-#if MBED_LOG_TO_STDOUT
-    fprintf((FILE *)ctx, "%s:%04d: %s", file, line, str);
-    fflush((FILE *)ctx);
-#endif
-    char buf[100];
-    strncpy(buf, str, sizeof(buf));
-
-    /* mbed inserts EOL and so does otbrLog()
-     * Thus we remove the one from MBED
-     */
-    char *cp;
-    cp = strchr(buf, '\n');
-    if (cp)
-    {
-        *cp = 0;
-    }
-    cp = strchr(buf, '\r');
-    if (cp)
+    Context &context = *static_cast<Context *>(aContext);
+
+    context.mCoap->Input(aBuffer, aLength, NULL, 0);
+}
+
+/** set the state of a session, reporting its change */
+static void CommissionerSetState(Context &aContext, int aState)
+{
+    VerifyOrExit(aContext.mState != aState);
+
+    aContext.mState = aState;
+
+    if (aContext.mStateHandler != NULL)
     {
-        *cp = 0;
+        aContext.mStateHandler(aContext, aState, aContext.mUserData);
     }
-    otbrLog(OTBR_LOG_INFO, "%s:%d: %s", file, line, buf);
+
+exit:
+    return;
 }
 
-/** dummy function for mbed */
-static int export_keys(void *               aContext,
-                       const unsigned char *aMasterSecret,
-                       const unsigned char *aKeyBlock,
-                       size_t               aMacLength,
-                       size_t               aKeyLength,
-                       size_t               aIvLength)
+/** end a session with an error, keeping the first one */
+static void CommissionerAbort(Context &aContext, int aError)
 {
-    (void)aContext;
-    (void)aMasterSecret;
-    (void)aKeyBlock;
-    (void)aMacLength;
-    (void)aKeyLength;
-    (void)aIvLength;
-    return 0;
+    if (aContext.mError == 0)
+    {
+        aContext.mError = aError;
+    }
+
+    otbrLog(OTBR_LOG_ERR, "commissioning session error: %d", aContext.mError);
+    CommissionerSetState(aContext, kStateError);
 }
 
-/** handle c/cp response */
-static void HandleCommissionerPetition(const Coap::Message &aMessage, void *aContext)
+/** handle c/cp response, returns whether the petition is accepted */
+static bool HandleCommissionerPetition(Context &aContext, const Coap::Future &aFuture)
 {
     uint16_t       length;
     int            tlvType;
     const Tlv *    tlv;
     const uint8_t *payload;
-    Context &      context = *static_cast<Context *>(aContext);
+    bool           accepted = false;
 
     otbrLog(OTBR_LOG_INFO, "COMM_PET.rsp: start");
-    payload = aMessage.GetPayload(length);
-    tlv     = reinterpret_cast<const Tlv *>(payload);
+    payload = aFuture.GetPayload(length);
 
-    while (LengthOf(payload, tlv) < length)
+    TlvReader reader(payload, length);
+
+    while ((tlv = reader.GetNext()) != NULL)
     {
         tlvType = tlv->GetType();
         switch (tlvType)
@@ -344,7 +405,7 @@ static void HandleCommissionerPetition(const Coap::Message &aMessage, void *aCon
             if (tlv->GetValueUInt8())
             {
                 otbrLog(OTBR_LOG_INFO, "COMM_PET.rsp: state=accepted");
-                context.mState = kStateAccepted;
+                accepted = true;
             }
             else
             {
@@ -353,20 +414,21 @@ static void HandleCommissionerPetition(const Coap::Message &aMessage, void *aCon
             break;
 
         case Meshcop::kCommissionerSessionId:
-            context.mCommissionerSessionId = tlv->GetValueUInt16();
-            otbrLog(OTBR_LOG_INFO, "COMM_PET.rsp: session-id=%d", context.mCommissionerSessionId);
+            aContext.mCommissionerSessionId = tlv->GetValueUInt16();
+            otbrLog(OTBR_LOG_INFO, "COMM_PET.rsp: session-id=%d", aContext.mCommissionerSessionId);
             break;
 
         default:
             otbrLog(OTBR_LOG_INFO, "COMM_PET.rsp: ignore-tilv: %d", tlvType);
             break;
         }
-        tlv = tlv->GetNext();
     }
     otbrLog(OTBR_LOG_INFO, "COMM_PET.rsp: complete");
+
+    return accepted;
 }
 
-/** Send the c/cp request to the border router agent */
+/** Send the c/cp request to the border router agent, its response is handled by CommissionerProcessResponses() */
 static int CommissionerPetition(Context &aContext)
 {
     int     ret;
@@ -387,45 +449,29 @@ static int CommissionerPetition(Context &aContext)
     message->SetPath("c/cp");
     message->SetPayload(buffer, LengthOf(buffer, tlv));
     otbrLog(OTBR_LOG_INFO, "COMM_PET.req: send");
-    aContext.mCoap->Send(*message, NULL, 0, HandleCommissionerPetition, &aContext);
+    ret = aContext.mPetitionFuture.Send(*aContext.mCoap, *message, kResponseTimeout);
     aContext.mCoap->FreeMessage(message);
 
-    do
+    if (ret != 0)
     {
-        ret = mbedtls_ssl_read(aContext.mSsl, buffer, sizeof(buffer));
-        if (ret > 0)
-        {
-            aContext.mCoap->Input(buffer, static_cast<uint16_t>(ret), NULL, 0);
-            switch (aContext.mState)
-            {
-            case kStateAccepted:
-                ret = 0;
-                break;
-            case kStateConnected:
-                ret = MBEDTLS_ERR_SSL_WANT_READ;
-                break;
-            default:
-                ret = -1;
-                break;
-            }
-        }
-    } while (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+        otbrLog(OTBR_LOG_ERR, "COMM_PET.req: send failed, errno=%d", errno);
+    }
 
-    otbrLog(OTBR_LOG_INFO, "COMM_PET.req: complete");
     return ret;
 }
 
-/** This handles the commissioner data set response, ie: response to the steering data etc */
-void HandleCommissionerSetResponse(const Coap::Message &aMessage, void *aContext)
+/** This handles the commissioner data set response, ie: response to the steering data etc, returns whether the
+ * steering data is accepted */
+static bool HandleCommissionerSetResponse(Context &aContext, const Coap::Future &aFuture)
 {
     uint16_t       length;
     int            tlvType;
     const Tlv *    tlv;
     const uint8_t *payload;
-    Context &      context = *static_cast<Context *>(aContext);
+    bool           accepted = false;
 
     otbrLog(OTBR_LOG_INFO, "COMMISSIONER_SET.rsp: start");
-    payload = (aMessage.GetPayload(length));
+    payload = (aFuture.GetPayload(length));
     tlv     = reinterpret_cast<const Tlv *>(payload);
 
     while (LengthOf(payload, tlv) < length)
@@ -436,7 +482,7 @@ void HandleCommissionerSetResponse(const Coap::Message &aMessage, void *aContext
         case Meshcop::kState:
             if (tlv->GetValueUInt8())
             {
-                context.mState = kStateReady;
+                accepted = true;
                 otbrLog(OTBR_LOG_INFO, "COMMISSIONER_SET.rsp: state=ready");
             }
             else
@@ -446,8 +492,8 @@ void HandleCommissionerSetResponse(const Coap::Message &aMessage, void *aContext
             break;
 
         case Meshcop::kCommissionerSessionId:
-            context.mCommissionerSessionId = tlv->GetValueUInt16();
-            otbrLog(OTBR_LOG_INFO, "COMMISSIONER_SET.rsp: session-id=%d", context.mCommissionerSessionId);
+            aContext.mCommissionerSessionId = tlv->GetValueUInt16();
+            otbrLog(OTBR_LOG_INFO, "COMMISSIONER_SET.rsp: session-id=%d", aContext.mCommissionerSessionId);
             break;
 
         default:
@@ -457,12 +503,14 @@ void HandleCommissionerSetResponse(const Coap::Message &aMessage, void *aContext
         tlv = tlv->GetNext();
     }
     otbrLog(OTBR_LOG_INFO, "COMMISSIONER_SET.rsp: complete");
+
+    return accepted;
 }
 
-/** Send the commissioner data (ie: Steering data, etc) to the leader/joining router */
+/** Send the commissioner data (ie: Steering data, etc) to the leader/joining router, the response is awaited by the
+ * caller */
 static int CommissionerSet(Context &aContext)
 {
-    bool     ok;
     int      ret   = 0;
     uint16_t token = ++aContext.mCoapToken;
     uint8_t  buffer[kSizeMaxPacket];
@@ -480,13 +528,7 @@ static int CommissionerSet(Context &aContext)
     otbrLog(OTBR_LOG_INFO, "COMMISSIONER_SET.req: session-id=%d", aContext.mCommissionerSessionId);
     tlv = tlv->GetNext();
 
-    ok = CommissionerComputeSteering();
-    /* Note: Steering computation will have logged the steering data */
-    if (!ok)
-    {
-        CommissionerUtilsFail("Cannot compute steering data\n");
-    }
-
+    /* the steering data is computed before the session, or updated along with the joiners */
     tlv->SetType(Meshcop::kSteeringData);
     tlv->SetValue(aContext.mJoiner.mSteeringData.GetDataPointer(), aContext.mJoiner.mSteeringData.GetLength());
     tlv = tlv->GetNext();
@@ -495,50 +537,34 @@ static int CommissionerSet(Context &aContext)
     otbrLog(OTBR_LOG_INFO, "COMMISSIONER_SET.req: coap-uri: %s", "c/cs");
     message->SetPayload(buffer, LengthOf(buffer, tlv));
     otbrLog(OTBR_LOG_INFO, "COMMISSIONER_SET.req: sent");
-    aContext.mCoap->Send(*message, NULL, 0, HandleCommissionerSetResponse, &aContext);
+    /* a COMMISSIONER_SET still waiting is superseded, its response is ignored */
+    ret = aContext.mSetFuture.Send(*aContext.mCoap, *message, kResponseTimeout);
     aContext.mCoap->FreeMessage(message);
 
-    do
+    if (ret != 0)
     {
-        ret = mbedtls_ssl_read(aContext.mSsl, buffer, sizeof(buffer));
-        if (ret > 0)
-        {
-            aContext.mCoap->Input(buffer, static_cast<uint16_t>(ret), NULL, 0);
-            switch (aContext.mState)
-            {
-            case kStateReady:
-                ret = 0;
-                break;
-
-            case kStateAccepted:
-                ret = MBEDTLS_ERR_SSL_WANT_READ;
-                break;
-
-            default:
-                break;
-            }
-        }
-    } while (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+        otbrLog(OTBR_LOG_ERR, "COMMISSIONER_SET.req: send failed, errno=%d", errno);
+    }
 
     return ret;
 }
 
-/** Handle a COMM_KA response */
-static void HandleCommissionerKeepAlive(const Coap::Message &aMessage, void *aContext)
+/** Handle a COMM_KA response, returns whether the session is kept */
+static bool HandleCommissionerKeepAlive(Context &aContext, const Coap::Future &aFuture)
 {
     uint16_t       length;
     int            tlvType;
     const Tlv *    tlv;
     const uint8_t *payload;
-    Context &      context = *static_cast<Context *>(aContext);
+    bool           accepted = true;
 
     otbrLog(OTBR_LOG_INFO, "COMM_KA.rsp: start");
 
     /* record stats */
-    gettimeofday(&(context.mCOMM_KA.mLastRxTv), NULL);
-    context.mCOMM_KA.mRxCnt += 1;
+    gettimeofday(&(aContext.mCOMM_KA.mLastRxTv), NULL);
+    aContext.mCOMM_KA.mRxCnt += 1;
 
-    payload = (aMessage.GetPayload(length));
+    payload = (aFuture.GetPayload(length));
     tlv     = reinterpret_cast<const Tlv *>(payload);
 
     while (LengthOf(payload, tlv) < length)
@@ -549,13 +575,13 @@ static void HandleCommissionerKeepAlive(const Coap::Message &aMessage, void *aCo
         case Meshcop::kState:
             if (tlv->GetValueUInt8())
             {
-                context.mState = kStateReady;
+                accepted = true;
                 otbrLog(OTBR_LOG_INFO, "COMM_KA.rsp: state=ready");
             }
             else
             {
                 otbrLog(OTBR_LOG_INFO, "COMM_KA.rsp: state=reject");
-                context.mState = kStateError;
+                accepted = false;
             }
             break;
 
@@ -566,9 +592,11 @@ static void HandleCommissionerKeepAlive(const Coap::Message &aMessage, void *aCo
         tlv = tlv->GetNext();
     }
     otbrLog(OTBR_LOG_INFO, "COMM_KA.rsp: complete");
+
+    return accepted;
 }
 
-/** Send a COMM_KA to keep the session alive */
+/** Send a COMM_KA to keep the session alive, its response is handled by CommissionerProcessResponses() */
 static int CommissionerKeepAlive(Context &aContext)
 {
     int     ret = 0;
@@ -596,83 +624,64 @@ static int CommissionerKeepAlive(Context &aContext)
     otbrLog(OTBR_LOG_INFO, "COMM_KA.req: send");
     gettimeofday(&(aContext.mCOMM_KA.mLastTxTv), NULL);
     aContext.mCOMM_KA.mTxCnt += 1;
-    aContext.mCoap->Send(*message, NULL, 0, HandleCommissionerKeepAlive, &aContext);
 
-    aContext.mCoap->FreeMessage(message);
-
-    do
+    if (aContext.mKeepAliveFuture.GetState() == Coap::Future::kStatePending)
     {
-        ret = mbedtls_ssl_read(aContext.mSsl, buffer, sizeof(buffer));
-    } while (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
-
-    if (ret > 0)
-    {
-        aContext.mCoap->Input(buffer, static_cast<uint16_t>(ret), NULL, 0);
-        if (aContext.mState == kStateAccepted)
-        {
-            ret = 0;
-        }
-        else
-        {
-            ret = -1;
-        }
+        otbrLog(OTBR_LOG_WARNING, "COMM_KA.rsp: previous not received");
     }
 
-    return ret;
-}
-
-/** This processes IO traffic during the commissioner session */
-static int CommissionerSessionProcess(Context &context)
-{
-    uint8_t buf[kSizeMaxPacket];
-    int     ret;
-
-    ret = mbedtls_ssl_read(context.mSsl, buf, sizeof(buf));
-    if (ret > 0)
-    {
-        context.mCoap->Input(buf, static_cast<uint16_t>(ret), NULL, 0);
-    }
-    else
-    {
-        otbrLog(OTBR_LOG_INFO, "CommissionerSessionProcess() ssl error -0x%04x", -ret);
-    }
+    ret = aContext.mKeepAliveFuture.Send(*aContext.mCoap, *message, kResponseTimeout);
+    aContext.mCoap->FreeMessage(message);
 
     return ret;
 }
 
-/** send data into the coap session */
+/** send data into the coap session, the port identifies the joiner for the responses */
 static void FeedCoaps(const uint8_t *aBuffer, uint16_t aLength, void *aContext)
 {
-    Context &context = *static_cast<Context *>(aContext);
+    JoinerSession &joiner  = *static_cast<JoinerSession *>(aContext);
+    Context &      context = *joiner.mContext;
 
-    context.mCoap->Input(aBuffer, aLength, NULL, 1);
+    context.mCoap->Input(aBuffer, aLength, NULL, static_cast<uint16_t>(&joiner - context.mJoiners + 1));
 }
 
 /** DTLS session has changed */
 static void HandleSessionChange(Dtls::Session &aSession, Dtls::Session::State aState, void *aContext)
 {
-    Context &context = *static_cast<Context *>(aContext);
+    JoinerSession &joiner = *static_cast<JoinerSession *>(aContext);
+
+    /* the session of a commissioned joiner may end after its slot is reused */
+    VerifyOrExit(aState == Dtls::Session::kStateReady || &aSession == joiner.mSession);
 
     switch (aState)
     {
     case Dtls::Session::kStateReady:
-        context.mState = kStateAuthenticated;
-        memcpy(context.mKek, aSession.GetKek(), sizeof(context.mKek));
+        joiner.mState = kStateAuthenticated;
+        memcpy(joiner.mKek, aSession.GetKek(), sizeof(joiner.mKek));
         aSession.SetDataHandler(FeedCoaps, aContext);
-        context.mSession = &aSession;
+        joiner.mSession = &aSession;
         break;
 
     case Dtls::Session::kStateClose:
-        context.mState = kStateDone;
+        joiner.mState = kStateDone;
+        otbrLog(OTBR_LOG_INFO, "joiner on port %d: done", joiner.mPortSession);
+
+        if (joiner.mContext->mJoinerHandler != NULL)
+        {
+            joiner.mContext->mJoinerHandler(joiner, joiner.mContext->mUserData);
+        }
         break;
 
     case Dtls::Session::kStateError:
     case Dtls::Session::kStateEnd:
-        context.mSession = NULL;
+        joiner.mSession = NULL;
         break;
     default:
         break;
     }
+
+exit:
+    return;
 }
 
 /** Determine if it is time to send a COMM_KA or not */
@@ -710,7 +719,8 @@ static bool IsEnvelopeTimeout(Context &aContext)
 
     nsecs = (int)(tv.tv_sec - aContext.mEnvelopeStartTv.tv_sec);
 
-    if (nsecs > aContext.mEnvelopeTimeout)
+    /* no envelope while joiners are added over the control socket, unless one is given after it */
+    if (aContext.mEnvelopeTimeout != 0 && nsecs > aContext.mEnvelopeTimeout)
     {
         otbrLog(OTBR_LOG_INFO, "ERROR: Envelope Timeout");
         return true;
@@ -721,304 +731,597 @@ static bool IsEnvelopeTimeout(Context &aContext)
     }
 }
 
-/** Once connected, we await here till a joiner appears... and handle requests */
-int CommissionerServe(Context &aContext)
+/** Start the dtls server of a joiner, and the socket relaying the joiner to it */
+static int JoinerSessionStart(Context &aContext, JoinerSession &aJoiner)
 {
-    fd_set readFdSet;
-    fd_set writeFdSet;
-    fd_set errorFdSet;
-    int    ret = 0;
+    int ret = 0;
 
-    otbrLog(OTBR_LOG_INFO, "CommissionerServe: start");
-    aContext.mSocket = socket(AF_INET, SOCK_DGRAM, 0);
-    VerifyOrExit(aContext.mSocket != -1, ret = errno);
-    aContext.mDtlsServer = Dtls::Server::Create(kPortJoinerSession, HandleSessionChange, &aContext);
+    aJoiner.mContext     = &aContext;
+    aJoiner.mPortSession = static_cast<uint16_t>(aContext.mPortBase + (&aJoiner - aContext.mJoiners));
+    aJoiner.mSocket      = socket(AF_INET, SOCK_DGRAM, 0);
+    VerifyOrExit(aJoiner.mSocket != -1, ret = errno);
 
-    otbrLog(OTBR_LOG_INFO, "commissioner-serve: device-pskd=%s", aContext.mJoiner.mPSKd_ascii);
-    aContext.mDtlsServer->SetPSK((const uint8_t *)aContext.mJoiner.mPSKd_ascii, strlen(aContext.mJoiner.mPSKd_ascii));
-    aContext.mDtlsServer->Start();
+    aJoiner.mDtlsServer = Dtls::Server::Create(aJoiner.mPortSession, HandleSessionChange, &aJoiner);
+    otbrLog(OTBR_LOG_INFO, "commissioner-serve: port=%d device-pskd=%s", aJoiner.mPortSession, aJoiner.mPSKd_ascii);
+    aJoiner.mDtlsServer->SetPSK((const uint8_t *)aJoiner.mPSKd_ascii, strlen(aJoiner.mPSKd_ascii));
+    SuccessOrExit(ret = aJoiner.mDtlsServer->Start());
 
-    if (aContext.mCOMM_KA.mDisabled)
+exit:
+    return ret;
+}
+
+/** Stop the dtls server of a joiner */
+static void JoinerSessionStop(JoinerSession &aJoiner)
+{
+    /* the session with the joiner might not exist.
+     * Example: If we never found the joiner..
+     */
+    if (aJoiner.mSession)
     {
-        /* log this once for 'record keeping' */
-        /* and not in the polling loop */
-        otbrLog(OTBR_LOG_INFO, "COMM_KA: disabled");
+        aJoiner.mSession->Close();
     }
+    if (aJoiner.mDtlsServer)
+    {
+        Dtls::Server::Destroy(aJoiner.mDtlsServer);
+        aJoiner.mDtlsServer = NULL;
+    }
+    if (aJoiner.mSocket != -1)
+    {
+        close(aJoiner.mSocket);
+        aJoiner.mSocket = -1;
+    }
+}
+
+/** Start the joiner sessions */
+static int JoinerSessionsStart(Context &aContext)
+{
+    int ret = 0;
 
-    while (aContext.mState != kStateDone && aContext.mState != kStateError)
+    for (int i = 0; i < aContext.mJoinerCount; i++)
     {
-        struct timeval timeout = kPollTimeout;
-        int            maxFd   = -1;
+        SuccessOrExit(ret = JoinerSessionStart(aContext, aContext.mJoiners[i]));
+    }
 
-        otbrLog(OTBR_LOG_DEBUG, "CommissionerServe: Tick..");
+exit:
+    return ret;
+}
 
-        /* determine if it is time to send a COMM_KA */
-        if (!aContext.mCOMM_KA.mDisabled)
-        {
-            CommissionerKeepAliveCheck(aContext);
-        }
+/** Steer the joiners not commissioned yet */
+static void CommissionerBuildSteering(Context &aContext)
+{
+    SteeringData steering = aContext.mJoiner.mSteeringData;
+    bool         keep     = false;
 
-        if (IsEnvelopeTimeout(aContext))
-        {
-            break;
-        }
+    steering.Clear();
 
-        /* Monitor sockets */
-        FD_ZERO(&readFdSet);
-        FD_ZERO(&writeFdSet);
-        FD_ZERO(&errorFdSet);
-        FD_SET(aContext.mNet->fd, &readFdSet);
-        if (maxFd < aContext.mNet->fd)
+    for (int i = 0; i < aContext.mJoinerCount; i++)
+    {
+        JoinerSession &joiner = aContext.mJoiners[i];
+
+        if (joiner.mState == kStateDone)
         {
-            maxFd = aContext.mNet->fd;
+            continue;
         }
-        FD_SET(aContext.mSocket, &readFdSet);
-        if (maxFd < aContext.mSocket)
+
+        if (joiner.mAnyJoiner)
         {
-            maxFd = aContext.mSocket;
+            /* the single joiner is steered by the command line, keep it */
+            keep = true;
         }
-        aContext.mDtlsServer->UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
-        ret = select(maxFd + 1, &readFdSet, &writeFdSet, &errorFdSet, &timeout);
-        if ((ret < 0) && (errno != EINTR))
+        else
         {
-            otbrLog(OTBR_LOG_ERR, "commissioner serve, select errno=%d", errno);
-            break;
+            steering.ComputeBloomFilter(joiner.mJoinerId);
         }
+    }
+
+    if (keep)
+    {
+        steering.Merge(aContext.mJoiner.mSteeringData);
+    }
+
+    aContext.mJoiner.mSteeringData = steering;
+    aContext.mJoiner.mJoinerList   = true;
+}
 
-        if (FD_ISSET(aContext.mSocket, &readFdSet))
+int CommissionerAddJoiner(Context &aContext, const uint8_t *aEui64, const char *aPSKd, JoinerSession *&aJoiner)
+{
+    int            ret    = 0;
+    JoinerSession *joiner = NULL;
+    uint8_t        joinerId[kEui64Len];
+
+    aContext.mJoiner.mIdCache.ComputeJoinerId(aEui64, joinerId);
+
+    for (int i = 0; i < aContext.mJoinerCount; i++)
+    {
+        JoinerSession &session = aContext.mJoiners[i];
+
+        if (session.mState != kStateDone)
         {
-            SendRelayTransmit(aContext);
+            VerifyOrExit(session.mAnyJoiner || memcmp(session.mJoinerId, joinerId, sizeof(joinerId)) != 0,
+                         ret = EEXIST);
         }
-
-        if (FD_ISSET(aContext.mNet->fd, &readFdSet))
+        else if (joiner == NULL)
         {
-            ret = CommissionerSessionProcess(aContext);
-            VerifyOrExit(ret > 0 || ret == MBEDTLS_ERR_SSL_TIMEOUT);
+            joiner = &session;
         }
-
-        aContext.mDtlsServer->Process(readFdSet, writeFdSet, errorFdSet);
     }
 
-    /* the session with the joiner might not exist.
-     * Example: If we never found the joiner..
-     */
-    if (aContext.mSession)
+    if (joiner != NULL)
     {
-        aContext.mSession->Close();
+        /* the dtls server of a commissioned joiner is reused, its sessions start with the new PSKd */
+        joiner->mRelayed = false;
+        joiner->mSession = NULL;
+        joiner->mState   = kStateInvalid;
+        memcpy(joiner->mEui64, aEui64, sizeof(joiner->mEui64));
+        memcpy(joiner->mJoinerId, joinerId, sizeof(joiner->mJoinerId));
+        strcpy(joiner->mPSKd_ascii, aPSKd);
+        SuccessOrExit(ret = joiner->mDtlsServer->SetPSK((const uint8_t *)aPSKd, strlen(aPSKd)));
     }
-    Dtls::Server::Destroy(aContext.mDtlsServer);
-    close(aContext.mSocket);
-    if (aContext.mState == kStateDone)
+    else
     {
-        ret = 0;
+        VerifyOrExit(aContext.mJoinerCount < kMaxJoiners, ret = ENOSPC);
+
+        joiner = &aContext.mJoiners[aContext.mJoinerCount];
+        memset(joiner, 0, sizeof(*joiner));
+        memcpy(joiner->mEui64, aEui64, sizeof(joiner->mEui64));
+        memcpy(joiner->mJoinerId, joinerId, sizeof(joiner->mJoinerId));
+        strcpy(joiner->mPSKd_ascii, aPSKd);
+        joiner->mSocket = -1;
+
+        /* joiners added before the session serves are started along with the others */
+        if (aContext.mServing)
+        {
+            ret = JoinerSessionStart(aContext, *joiner);
+            if (ret != 0)
+            {
+                JoinerSessionStop(*joiner);
+                ExitNow();
+            }
+        }
+        aContext.mJoinerCount++;
     }
-    else
+
+    otbrLog(OTBR_LOG_INFO, "joiner %s: added on port %d", CommissionerUtilsHexString(aEui64, kEui64Len),
+            joiner->mPortSession);
+
+    if (!aContext.mJoiner.mAllowAny)
     {
-        ret = -1;
+        CommissionerBuildSteering(aContext);
+
+        /* the response is handled by CommissionerProcess(), joiners are served meanwhile */
+        if (aContext.mServing)
+        {
+            SuccessOrExit(ret = CommissionerSet(aContext));
+        }
     }
 
-exit:
-    otbrLog(OTBR_LOG_INFO, "CommissionerServe: result=%d", ret);
+    aJoiner = joiner;
 
+exit:
     return ret;
 }
 
-/** this runs a commissioning session end to end */
-static int commissioning_session(Context &context)
+/** Stop the joiner sessions, returns the number of joiners commissioned */
+static int JoinerSessionsStop(Context &aContext)
 {
-    int                          ret;
-    bool                         ok;
-    mbedtls_net_context          client_fd;
-    mbedtls_entropy_context      entropy;
-    mbedtls_ctr_drbg_context     ctr_drbg;
-    mbedtls_ssl_context          ssl;
-    mbedtls_ssl_config           conf;
-    mbedtls_timing_delay_context timer;
-
-    Coap::Resource relayReceiveHandler(OT_URI_PATH_RELAY_RX, HandleRelayReceive, &context);
-    Coap::Resource joinerFinalizeHandler(OT_URI_PATH_JOINER_FINALIZE, HandleJoinerFinalize, &context);
-
-    otbrLog(OTBR_LOG_INFO, "agent-address: %s", context.mAgent.mAddress_ascii);
-    if (context.mAgent.mAddress_ascii[0] == 0)
+    int done = 0;
+
+    for (int i = 0; i < aContext.mJoinerCount; i++)
     {
-        CommissionerUtilsFail("Missing AGENT ip address\n");
+        JoinerSession &joiner = aContext.mJoiners[i];
+
+        JoinerSessionStop(joiner);
+
+        if (joiner.mState == kStateDone)
+        {
+            done++;
+        }
+        else
+        {
+            otbrLog(OTBR_LOG_ERR, "joiner %s: not commissioned, state=%d",
+                    CommissionerUtilsHexString(joiner.mEui64, sizeof(joiner.mEui64)), joiner.mState);
+        }
     }
 
-    otbrLog(OTBR_LOG_INFO, "agent-port: %s", context.mAgent.mPort_ascii);
-    if (context.mAgent.mPort_ascii[0] == 0)
+    return done;
+}
+
+/** Are all joiners commissioned? */
+static bool JoinerSessionsDone(Context &aContext)
+{
+    for (int i = 0; i < aContext.mJoinerCount; i++)
     {
-        CommissionerUtilsFail("Missing AGENT ip port\n");
+        if (aContext.mJoiners[i].mState != kStateDone)
+        {
+            return false;
+        }
     }
 
-    if (context.mJoiner.mPSKd_ascii[0] == 0)
+    return true;
+}
+
+/** Once the steering data is accepted, serve the joiners as they appear */
+static int CommissionerServe(Context &aContext)
+{
+    int ret = 0;
+
+    otbrLog(OTBR_LOG_INFO, "CommissionerServe: start, %d joiners", aContext.mJoinerCount);
+    SuccessOrExit(ret = JoinerSessionsStart(aContext));
+
+    if (aContext.mControl.mPath[0] != 0)
     {
-        CommissionerUtilsFail("Missing PSKd (joiner passphrase/password)\n");
+        SuccessOrExit(ret = CommissionerControlOpen(aContext));
     }
 
-    context.mSsl = &ssl;
-    context.mNet = &client_fd;
+    if (aContext.mCOMM_KA.mDisabled)
     {
-        int n;
-        n = otbrLogGetLevel();
-        mbedtls_debug_set_threshold(n);
+        /* log this once for 'record keeping' */
+        /* and not in the polling loop */
+        otbrLog(OTBR_LOG_INFO, "COMM_KA: disabled");
     }
 
-    mbedtls_net_init(&client_fd);
-    mbedtls_ssl_init(&ssl);
-    mbedtls_ssl_config_init(&conf);
-    mbedtls_ctr_drbg_init(&ctr_drbg);
+    aContext.mServing = true;
+
+exit:
+    return ret;
+}
+
+/** Handle the responses to the requests sent to the agent */
+static void CommissionerProcessResponses(Context &aContext)
+{
+    uint64_t now = GetMonotonicNow();
+    bool     accepted;
+    int      ret;
 
-    mbedtls_entropy_init(&entropy);
-    if ((ret = mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy, kSeed, sizeof(kSeed))) != 0)
+    switch (aContext.mPetitionFuture.Poll(now))
     {
-        CommissionerUtilsFail("mbed drgb seed fails?\n");
+    case Coap::Future::kStateReady:
+        accepted = HandleCommissionerPetition(aContext, aContext.mPetitionFuture);
+        aContext.mPetitionFuture.Reset();
+        VerifyOrExit(accepted, CommissionerAbort(aContext, -1));
+        CommissionerSetState(aContext, kStateAccepted);
+
+        /** Tell network who we want to commission */
+        ret = CommissionerSet(aContext);
+        VerifyOrExit(ret == 0, CommissionerAbort(aContext, ret));
+        break;
+
+    case Coap::Future::kStateTimeout:
+        otbrLog(OTBR_LOG_ERR, "COMM_PET.rsp: not received");
+        aContext.mPetitionFuture.Reset();
+        CommissionerAbort(aContext, -1);
+        ExitNow();
+
+    default:
+        break;
     }
 
-    otbrLog(OTBR_LOG_INFO, "connecting...");
-    if ((ret = mbedtls_net_connect(&client_fd, context.mAgent.mAddress_ascii, context.mAgent.mPort_ascii,
-                                   MBEDTLS_NET_PROTO_UDP)) != 0)
+    switch (aContext.mKeepAliveFuture.Poll(now))
     {
-        CommissionerUtilsFail("CONNECT: %s:%s failed\n", context.mAgent.mAddress_ascii, context.mAgent.mPort_ascii);
-        goto exit;
+    case Coap::Future::kStateReady:
+        accepted = HandleCommissionerKeepAlive(aContext, aContext.mKeepAliveFuture);
+        aContext.mKeepAliveFuture.Reset();
+        VerifyOrExit(accepted, CommissionerAbort(aContext, -1));
+        break;
+
+    case Coap::Future::kStateTimeout:
+        /* the next COMM_KA may still keep the session */
+        otbrLog(OTBR_LOG_WARNING, "COMM_KA.rsp: timeout");
+        aContext.mKeepAliveFuture.Reset();
+        break;
+
+    default:
+        break;
     }
 
-    if ((ret = mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_DATAGRAM,
-                                           MBEDTLS_SSL_PRESET_DEFAULT)) != 0)
+    switch (aContext.mSetFuture.Poll(now))
     {
-        CommissionerUtilsFail("Cannot configure mbed defaults\n");
-        goto exit;
+    case Coap::Future::kStateReady:
+        accepted = HandleCommissionerSetResponse(aContext, aContext.mSetFuture);
+        aContext.mSetFuture.Reset();
+        VerifyOrExit(accepted, otbrLog(OTBR_LOG_ERR, "COMMISSIONER_SET.rsp: %s",
+                                       aContext.mServing ? "steering data rejected" : "not accepted");
+                     CommissionerAbort(aContext, -1));
+        CommissionerSetState(aContext, kStateReady);
+
+        /* and wait for the joiners to appear */
+        if (!aContext.mServing)
+        {
+            ret = CommissionerServe(aContext);
+            VerifyOrExit(ret == 0, CommissionerAbort(aContext, ret));
+        }
+        break;
+
+    case Coap::Future::kStateTimeout:
+        aContext.mSetFuture.Reset();
+        VerifyOrExit(aContext.mServing, otbrLog(OTBR_LOG_ERR, "COMMISSIONER_SET.rsp: not accepted");
+                     CommissionerAbort(aContext, -1));
+
+        /* the joiners are not steered without it */
+        otbrLog(OTBR_LOG_WARNING, "COMMISSIONER_SET.rsp: timeout, resend");
+        ret = CommissionerSet(aContext);
+        VerifyOrExit(ret == 0, CommissionerAbort(aContext, ret));
+        break;
+
+    default:
+        break;
     }
 
-    mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &ctr_drbg);
-    mbedtls_ssl_conf_min_version(&conf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
-    mbedtls_ssl_conf_max_version(&conf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
-    mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_NONE);
-    mbedtls_ssl_conf_dbg(&conf, my_debug, stdout);
-    mbedtls_ssl_conf_ciphersuites(&conf, kCipherSuites);
-    mbedtls_ssl_conf_export_keys_cb(&conf, export_keys, NULL);
-    mbedtls_ssl_conf_handshake_timeout(&conf, 8000, 60000);
-
-    otbrLog(OTBR_LOG_INFO, "connecting: ssl-setup");
-    if ((ret = mbedtls_ssl_setup(&ssl, &conf)) != 0)
+exit:
+    return;
+}
+
+void CommissionerInit(Context &aContext)
+{
+    aContext.mJoiner.mSteeringData.SetLength(kSteeringDefaultLength);
+    aContext.mJoiner.mSteeringData.Clear();
+
+    /* 5minutes is a resonable period of time */
+    aContext.mEnvelopeTimeout = 5 * 60;
+
+    /* Set the COMM_KA transmit rate to every 15 seconds */
+    aContext.mCOMM_KA.mTxRate = 15;
+
+    /* load generator sessions are kept for 10 seconds */
+    aContext.mLoad.mDuration = 10;
+
+    /* traces are replayed at the recorded speed */
+    aContext.mReplay.mSpeed = 1;
+
+    aContext.mControl.mSocket = -1;
+    aContext.mPortBase        = kPortJoinerSession;
+}
+
+int CommissionerStart(Context &aContext)
+{
+    int  ret = 0;
+    bool steering;
+    bool pskc;
+
+    VerifyOrExit(aContext.mClient == NULL, ret = EALREADY);
+
+    otbrLog(OTBR_LOG_INFO, "agent-address: %s", aContext.mAgent.mAddress_ascii);
+    otbrLog(OTBR_LOG_INFO, "agent-port: %s", aContext.mAgent.mPort_ascii);
+    VerifyOrExit(aContext.mAgent.mAddress_ascii[0] != 0 && aContext.mAgent.mPort_ascii[0] != 0, ret = EINVAL;
+                 otbrLog(OTBR_LOG_ERR, "Missing AGENT ip address or port"));
+
+    if (aContext.mJoinerCount == 0 && aContext.mJoiner.mPSKd_ascii[0] != 0)
     {
-        CommissionerUtilsFail("Cannot setup ssl\n");
-        goto exit;
+        JoinerSession &joiner = aContext.mJoiners[aContext.mJoinerCount++];
+
+        /* a single joiner is served whatever its IID, the steering data may allow any device */
+        joiner.mAnyJoiner = true;
+        memcpy(joiner.mEui64, aContext.mJoiner.mEui64.bin, sizeof(joiner.mEui64));
+        strcpy(joiner.mPSKd_ascii, aContext.mJoiner.mPSKd_ascii);
     }
 
-    mbedtls_ssl_set_bio(&ssl, &client_fd, mbedtls_net_send, mbedtls_net_recv, mbedtls_net_recv_timeout);
+    if (aContext.mJoinerCount == 0)
+    {
+        VerifyOrExit(aContext.mControl.mPath[0] != 0, ret = EINVAL;
+                     otbrLog(OTBR_LOG_ERR, "Missing PSKd (joiner passphrase/password)"));
 
-    mbedtls_ssl_set_timer_cb(&ssl, &timer, mbedtls_timing_set_delay, mbedtls_timing_get_delay);
+        /* the steering data starts empty, joiners are added over the control socket */
+        aContext.mJoiner.mJoinerList = true;
+    }
 
-    ok = CommissionerComputePskc();
-    /* note: CommissionerComputePskc() will have logged details */
-    if (!ok)
+    /* the joiner sessions start once the steering data is accepted */
+    for (int i = 0; i < aContext.mJoinerCount; i++)
     {
-        CommissionerUtilsFail("Cannot compute PSKc (commissioning shared key)\n");
+        aContext.mJoiners[i].mSocket = -1;
     }
 
-    mbedtls_ssl_set_hs_ecjpake_password(&ssl, context.mAgent.mPSKc.bin, OT_PSKC_LENGTH);
+    gettimeofday(&aContext.mEnvelopeStartTv, NULL);
+
+    /*
+     * The PSKc derivation is the slowest step before the handshake, which needs it. The steering data and the dtls
+     * client, which do not, are prepared while it runs, and the PSKc joins them before the handshake.
+     */
+    CommissionerComputePskcStart(aContext);
+
+    /* Note: Steering computation will have logged the steering data */
+    steering = CommissionerComputeSteering(aContext);
+
+    aContext.mClient = Dtls::Client::Create(NULL, &aContext);
+    aContext.mClient->SetDataHandler(FeedAgent, &aContext);
+    aContext.mClient->SetHandshakeTimeouts(8000, 60000);
+
+    aContext.mCoap                  = Coap::Agent::Create(SendCoap, &aContext);
+    aContext.mRelayReceiveHandler   = new Coap::Resource(OT_URI_PATH_RELAY_RX, HandleRelayReceive, &aContext);
+    aContext.mJoinerFinalizeHandler = new Coap::Resource(OT_URI_PATH_JOINER_FINALIZE, HandleJoinerFinalize, &aContext);
+    SuccessOrExit(ret = aContext.mCoap->AddResource(*aContext.mRelayReceiveHandler));
+    SuccessOrExit(ret = aContext.mCoap->AddResource(*aContext.mJoinerFinalizeHandler));
+
+    /* note: CommissionerComputePskc() will have logged details */
+    pskc = CommissionerComputePskcJoin(aContext);
+
+    VerifyOrExit(steering, ret = EINVAL; otbrLog(OTBR_LOG_ERR, "Cannot compute steering data"));
+    VerifyOrExit(pskc, ret = EINVAL; otbrLog(OTBR_LOG_ERR, "Cannot compute PSKc (commissioning shared key)"));
+
+    SuccessOrExit(ret = aContext.mClient->SetPSK(aContext.mAgent.mPSKc.bin, OT_PSKC_LENGTH));
 
+    /* the handshake is driven by CommissionerProcess() */
+    otbrLog(OTBR_LOG_INFO, "connecting...");
+    ret = aContext.mClient->Connect(aContext.mAgent.mAddress_ascii, aContext.mAgent.mPort_ascii);
+    VerifyOrExit(ret == 0, otbrLog(OTBR_LOG_ERR, "CONNECT: %s:%s failed", aContext.mAgent.mAddress_ascii,
+                                   aContext.mAgent.mPort_ascii));
     otbrLog(OTBR_LOG_INFO, "connect: perform handshake");
-    do
-    {
-        ret = mbedtls_ssl_handshake(&ssl);
-    } while (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
 
-    if (ret != 0)
+exit:
+    if (ret != 0 && ret != EALREADY)
     {
-        otbrLog(OTBR_LOG_ERR, "Handshake fails");
-        goto exit;
+        CommissionerAbort(aContext, ret);
+        CommissionerStop(aContext);
     }
 
-    otbrLog(OTBR_LOG_INFO, "connect: CONNECTED!");
-    context.mState = kStateConnected;
-    context.mCoap  = Coap::Agent::Create(SendCoap, &context);
+    return ret;
+}
 
-    SuccessOrExit(ret = context.mCoap->AddResource(relayReceiveHandler));
-    SuccessOrExit(ret = context.mCoap->AddResource(joinerFinalizeHandler));
+void CommissionerUpdateFdSet(Context &       aContext,
+                             fd_set &        aReadFdSet,
+                             fd_set &        aWriteFdSet,
+                             fd_set &        aErrorFdSet,
+                             int &           aMaxFd,
+                             struct timeval &aTimeout)
+{
+    VerifyOrExit(aContext.mClient != NULL && !CommissionerIsFinished(aContext));
 
-    /** Send the petitioning request */
-    SuccessOrExit(ret = CommissionerPetition(context));
+    aContext.mClient->UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd, aTimeout);
 
-    /** Tell network who we want to commission */
-    SuccessOrExit(ret = CommissionerSet(context));
+    if (aContext.mServing)
+    {
+        for (int i = 0; i < aContext.mJoinerCount; i++)
+        {
+            JoinerSession &joiner = aContext.mJoiners[i];
 
-    /* and wait for that joiner to appear */
-    SuccessOrExit(ret = CommissionerServe(context));
+            FD_SET(joiner.mSocket, &aReadFdSet);
+            if (aMaxFd < joiner.mSocket)
+            {
+                aMaxFd = joiner.mSocket;
+            }
+            joiner.mDtlsServer->UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd, aTimeout);
+        }
+        CommissionerControlUpdateFdSet(aContext, aReadFdSet, aMaxFd);
+    }
 
-    /* YEA! Success!!!! */
-    otbrLog(OTBR_LOG_INFO, "Closing SSL connection");
-    do
+    /* keep-alives, envelope and response timeouts are checked on every poll */
+    if (aTimeout.tv_sec > kPollTimeout.tv_sec ||
+        (aTimeout.tv_sec == kPollTimeout.tv_sec && aTimeout.tv_usec > kPollTimeout.tv_usec))
     {
-        ret = mbedtls_ssl_close_notify(&ssl);
-    } while (ret == MBEDTLS_ERR_SSL_WANT_WRITE);
-    ret = 0;
+        aTimeout = kPollTimeout;
+    }
 
 exit:
+    return;
+}
 
-#ifdef MBEDTLS_ERROR_C
-    if (ret != 0)
+void CommissionerProcess(Context &     aContext,
+                         const fd_set &aReadFdSet,
+                         const fd_set &aWriteFdSet,
+                         const fd_set &aErrorFdSet)
+{
+    VerifyOrExit(aContext.mClient != NULL && !CommissionerIsFinished(aContext));
+
+    otbrLog(OTBR_LOG_DEBUG, "CommissionerProcess: Tick..");
+
+    if (aContext.mServing)
     {
-        char error_buf[100];
-        mbedtls_strerror(ret, error_buf, 100);
-        otbrLog(OTBR_LOG_ERR, "mbed error: %d - %s", ret, error_buf);
+        for (int i = 0; i < aContext.mJoinerCount; i++)
+        {
+            if (FD_ISSET(aContext.mJoiners[i].mSocket, &aReadFdSet))
+            {
+                SendRelayTransmit(aContext.mJoiners[i]);
+            }
+        }
     }
-#endif
 
-    mbedtls_net_free(&client_fd);
+    aContext.mClient->Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
+
+    switch (aContext.mClient->GetState())
+    {
+    case Dtls::Session::kStateHandshaking:
+        VerifyOrExit(!IsEnvelopeTimeout(aContext), CommissionerAbort(aContext, ETIMEDOUT));
+        ExitNow();
 
-    mbedtls_ssl_free(&ssl);
-    mbedtls_ssl_config_free(&conf);
-    mbedtls_ctr_drbg_free(&ctr_drbg);
-    mbedtls_entropy_free(&entropy);
+    case Dtls::Session::kStateReady:
+        break;
 
-    /* Shell can not handle large exit numbers -> 1 for errors */
-    if (ret == 0)
+    default:
+        otbrLog(OTBR_LOG_ERR, "%s, state=%d",
+                aContext.mState == kStateInvalid ? "Handshake fails" : "CommissionerServe: agent session ends",
+                aContext.mClient->GetState());
+        CommissionerAbort(aContext, -1);
+        ExitNow();
+    }
+
+    if (aContext.mState == kStateInvalid)
     {
-        return EXIT_SUCCESS;
+        int ret;
+
+        otbrLog(OTBR_LOG_INFO, "connect: CONNECTED!");
+        CommissionerSetState(aContext, kStateConnected);
+
+        /** Send the petitioning request */
+        ret = CommissionerPetition(aContext);
+        VerifyOrExit(ret == 0, CommissionerAbort(aContext, ret));
     }
-    else
+
+    CommissionerProcessResponses(aContext);
+    VerifyOrExit(!CommissionerIsFinished(aContext));
+
+    if (aContext.mServing)
     {
-        return EXIT_FAILURE;
+        for (int i = 0; i < aContext.mJoinerCount; i++)
+        {
+            aContext.mJoiners[i].mDtlsServer->Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
+        }
+
+        /* joiners added here are served from the next poll */
+        CommissionerControlProcess(aContext, aReadFdSet);
+
+        /* determine if it is time to send a COMM_KA */
+        CommissionerKeepAliveCheck(aContext);
+
+        /* with a control socket, the session is kept for more joiners until told to quit */
+        if (aContext.mControl.mQuit || (aContext.mControl.mSocket == -1 && JoinerSessionsDone(aContext)))
+        {
+            CommissionerSetState(aContext, kStateDone);
+            ExitNow();
+        }
     }
 
-    return ret;
+    VerifyOrExit(!IsEnvelopeTimeout(aContext), CommissionerAbort(aContext, ETIMEDOUT));
+
+exit:
+    return;
 }
 
-static void set_context_defaults(void)
+bool CommissionerIsFinished(const Context &aContext)
 {
-    gContext.mJoiner.mSteeringData.SetLength(kSteeringDefaultLength);
-    gContext.mJoiner.mSteeringData.Clear();
-
-    /* 5minutes is a resonable period of time */
-    gettimeofday(&(gContext.mEnvelopeStartTv), NULL);
-    gContext.mEnvelopeTimeout = 5 * 60;
-
-    /* Set the COMM_KA transmit rate to every 15 seconds */
-    gContext.mCOMM_KA.mTxRate = 15;
+    return aContext.mState == kStateDone || aContext.mState == kStateError;
 }
 
-int main(int argc, char *argv[])
+int CommissionerStop(Context &aContext)
 {
-    int ret = 0;
+    int ret = aContext.mError;
+    int done;
 
-    /* Set the initial log */
-    otbrLogInit(SYSLOG_IDENT, OTBR_LOG_ERR);
+    CommissionerControlClose(aContext);
+    done = JoinerSessionsStop(aContext);
+    otbrLog(OTBR_LOG_INFO, "CommissionerServe: %d of %d joiners commissioned", done, aContext.mJoinerCount);
+    if (done == aContext.mJoinerCount || aContext.mControl.mQuit)
+    {
+        ret = 0;
+    }
+    else if (ret == 0)
+    {
+        ret = -1;
+    }
 
-    /* set defaults that may be overridden by the cmdline params */
-    set_context_defaults();
+    if (aContext.mClient != NULL)
+    {
+        if (aContext.mClient->GetState() == Dtls::Session::kStateReady)
+        {
+            otbrLog(OTBR_LOG_INFO, "Closing SSL connection");
+            aContext.mClient->Close();
+        }
 
-    /* parse command line params */
-    commissioner_argcargv(argc, argv);
+        Dtls::Client::Destroy(aContext.mClient);
+        aContext.mClient = NULL;
+    }
 
-    if (!gContext.commission_device)
+    if (aContext.mCoap != NULL)
     {
-        fprintf(stderr, "Nothing todo? Try --help\n");
-        exit(EXIT_FAILURE);
+        Coap::Agent::Destroy(aContext.mCoap);
+        aContext.mCoap = NULL;
     }
 
-    /* be a commissioner */
-    ret = commissioning_session(gContext);
-    otbrLog(OTBR_LOG_INFO, "exit: %d\n", ret);
+    delete aContext.mRelayReceiveHandler;
+    aContext.mRelayReceiveHandler = NULL;
+    delete aContext.mJoinerFinalizeHandler;
+    aContext.mJoinerFinalizeHandler = NULL;
+
+    aContext.mServing = false;
+    otbrLog(OTBR_LOG_INFO, "CommissionerServe: result=%d", ret);
+
     return ret;
 }
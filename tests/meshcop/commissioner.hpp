@@ -29,9 +29,16 @@
 /**
  * @file
  *   This is a common header for the various commissioner source files.
+ *
+ * The commissioner sessions are implemented by libotbr-commissioner, each with a Context of its own and driven by
+ * the mainloop of its host, so that a process hosts many of them.
  */
 
+#ifndef COMMISSIONER_HPP_
+#define COMMISSIONER_HPP_
+
 #include <ctype.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -44,6 +51,8 @@
 #include <sys/types.h>
 #include <syslog.h>
 
+#include <vector>
+
 #if !defined(MBEDTLS_CONFIG_FILE)
 #include "mbedtls/config.h"
 #else
@@ -66,7 +75,9 @@
 #include "common/logging.hpp"
 #include "common/tlv.hpp"
 #include "utils/hex.hpp"
+#include "utils/joiner_id_cache.hpp"
 #include "utils/steeringdata.hpp"
+#include "utils/steeringdata_builder.hpp"
 #include "web/pskc-generator/pskc.hpp"
 
 using namespace ot;
@@ -78,8 +89,6 @@ using namespace ot::BorderRouter;
 
 #define SYSLOG_IDENT "otbr-commissioner"
 
-#include "commissioner_argcargv.hpp"
-
 /**
  * Constants
  */
@@ -109,8 +118,32 @@ enum
     /* Spec is not specific about this items max length, so we choose 64 */
     kBorderRouterPassPhraseLen = 64,
 
+    /* Max commissioner sessions of the load generator, bounded by FD_SETSIZE of select() */
+    kLoadMaxCommissioners = 256,
+
+    /* Max joiners commissioned in parallel, each has a DTLS server on its own port from kPortJoinerSession */
+    kMaxJoiners = 64,
+
+    /* Max path length of the control socket, the size of sun_path */
+    kControlPathLength = 108,
+
+    /* Max path length of a replayed trace */
+    kReplayPathLength = 256,
+
+    /* Milliseconds a request to the agent waits for its response */
+    kResponseTimeout = 10000,
+
 };
 
+/* constants shared by the commissioner sessions */
+const char kCommissionerId[] = "OpenThread";
+
+/* number of bytes from aStart to aEnd, as when building TLVs */
+inline uint16_t LengthOf(const void *aStart, const void *aEnd)
+{
+    return static_cast<const uint8_t *>(aEnd) - static_cast<const uint8_t *>(aStart);
+}
+
 /**
  * Commissioner State
  */
@@ -134,6 +167,71 @@ enum
     kJoinerDtlsEncapsulation
 };
 
+struct Context;
+struct JoinerSession;
+
+/**
+ * This function pointer is called when the state of a commissioner session changed.
+ *
+ * @param[in]  aContext   The commissioner session.
+ * @param[in]  aState     The new state, kStateDone or kStateError once the session is finished.
+ * @param[in]  aUserData  The user data given with the handler.
+ */
+typedef void (*CommissionerStateHandler)(Context &aContext, int aState, void *aUserData);
+
+/**
+ * This function pointer is called when a joiner of a commissioner session is commissioned.
+ *
+ * @param[in]  aJoiner    The joiner commissioned, its slot is reused by the next joiner added.
+ * @param[in]  aUserData  The user data given with the handler.
+ */
+typedef void (*CommissionerJoinerHandler)(JoinerSession &aJoiner, void *aUserData);
+
+/**
+ * Joiner session, one for each device commissioned in parallel.
+ */
+struct JoinerSession
+{
+    /** the commissioning context of this joiner */
+    Context *mContext;
+
+    /** the EUI64 of the device, and the joiner id hashed from it */
+    uint8_t mEui64[kEui64Len];
+    uint8_t mJoinerId[kEui64Len];
+
+    /** Set to true when any joiner is served by this session, as when commissioning a single device */
+    bool mAnyJoiner;
+
+    /** the PSKd of the device */
+    char mPSKd_ascii[kPSKdLength + 1];
+
+    /** UDP port of the joiner */
+    uint16_t mUdpPort;
+
+    /** Interface id of the joiner device, valid once mRelayed is set */
+    uint8_t mIid[8];
+    bool    mRelayed;
+
+    /** the router we are using to talk to the joiner */
+    uint16_t mRouterLocator;
+
+    /** the port of the dtls server of this joiner */
+    uint16_t mPortSession;
+
+    /** dtls server and session with the joiner */
+    Dtls::Server * mDtlsServer;
+    Dtls::Session *mSession;
+
+    /* Socket relaying the joiner to its dtls server */
+    int mSocket;
+
+    /** Kek with the joiner operation */
+    uint8_t mKek[32];
+
+    /** Joiner state */
+    int mState;
+};
+
 /**
  * Commissioner Context.
  */
@@ -145,18 +243,13 @@ struct Context
     /** coap instance to talk to agent & device */
     Coap::Agent *mCoap;
 
-    /** dtls info for talking to agent & joiner */
-    Dtls::Server *mDtlsServer;
+    /* dtls client of the session with the agent */
+    Dtls::Client *mClient;
 
-    /* the session info for agent & joiner */
-    Dtls::Session *mSession;
-
-    /* dtls context information */
-    mbedtls_ssl_context *mSsl;
-    mbedtls_net_context *mNet;
-
-    /* Socket we are using with the agent */
-    int mSocket;
+    /* responses to the requests sent to the agent, polled from the mainloop */
+    Coap::Future mPetitionFuture;
+    Coap::Future mSetFuture;
+    Coap::Future mKeepAliveFuture;
 
     /* this generates our coap tokens */
     uint16_t mCoapToken;
@@ -195,6 +288,11 @@ struct Context
             /* this class does the calculation */
             Psk::Pskc mTool;
 
+            /* the thread computing it, see CommissionerComputePskcStart() */
+            pthread_t mThread;
+            bool      mThreadStarted;
+            bool      mComputed;
+
             /** ascii & binary of PSKc, either from calculation or cmdline */
             char    ascii[(OT_PSKC_LENGTH * 2) + 1];
             uint8_t bin[OT_PSKC_LENGTH];
@@ -202,9 +300,6 @@ struct Context
 
     } mAgent;
 
-    /** Kek with the joiner operation */
-    uint8_t mKek[32];
-
     struct comm_ka
     {
         /** last time a COMM_KA message was sent */
@@ -231,6 +326,33 @@ struct Context
     /** Commissioner state */
     int mState;
 
+    /** load generation, see commissioner_load.cpp */
+    struct load
+    {
+        /** number of commissioner sessions, 0 to commission a single device */
+        int mCommissioners;
+
+        /** number of simulated joiners */
+        int mJoiners;
+
+        /** arrivals per second, 0 to arrive all at once */
+        int mCommissionerRate;
+        int mJoinerRate;
+
+        /** how long each commissioner session is kept in seconds */
+        int mDuration;
+    } mLoad;
+
+    /** trace replay, see commissioner_replay.cpp */
+    struct replay
+    {
+        /** the trace saved by otbr-agent, empty when not replaying */
+        char mTrace[kReplayPathLength];
+
+        /** times faster than recorded, 0 for as fast as possible */
+        int mSpeed;
+    } mReplay;
+
     /** All things about the joiner */
     struct joiner
     {
@@ -244,20 +366,14 @@ struct Context
         /** Set to true/false via cmdline param for test purposes. */
         bool mAllowAny;
 
+        /** Set to true when the steering data is built from a list of joiners. */
+        bool mJoinerList;
+
         /** Computed steering data based on hashmac */
         SteeringData mSteeringData;
 
-        /** UDP port of the joiner */
-        uint16_t mUdpPort;
-
-        /** Interface id of the joiner device */
-        uint8_t mIid[8];
-
-        /** the router we are using to talk to the joiner */
-        uint16_t mRouterLocator;
-
-        /** the port we are using */
-        uint16_t mPortSession;
+        /** joiner ids of the EUI64s seen before, closed unless given on the command line */
+        JoinerIdCache mIdCache;
 
         /** This is the PSKd from the command line */
         /* this is the shared string used by the device */
@@ -274,25 +390,137 @@ struct Context
          *
          */
     } mJoiner;
+
+    /** The joiners commissioned in parallel, either from a joiner batch or the single joiner above */
+    JoinerSession mJoiners[kMaxJoiners];
+    int           mJoinerCount;
+
+    /** control socket, see commissioner_control.cpp */
+    struct control
+    {
+        /** path of the unix socket, empty when the session ends with its joiners */
+        char mPath[kControlPathLength];
+
+        /** listening socket, -1 when not open */
+        int mSocket;
+
+        /** set when told to quit over the control socket */
+        bool mQuit;
+    } mControl;
+
+    /** UDP port of the dtls server of the first joiner, the sessions of a process each need a range of their own */
+    uint16_t mPortBase;
+
+    /** handlers of the session and their user data, may be NULL */
+    CommissionerStateHandler  mStateHandler;
+    CommissionerJoinerHandler mJoinerHandler;
+    void *                    mUserData;
+
+    /** coap resources served to the agent, created when the session starts */
+    Coap::Resource *mRelayReceiveHandler;
+    Coap::Resource *mJoinerFinalizeHandler;
+
+    /** set once the steering data is accepted, the joiners are served from then on */
+    bool mServing;
+
+    /** the error the session failed with, 0 if none */
+    int mError;
 };
 
-/* the single global commissioning context */
-extern struct Context gContext;
+/*
+ * libotbr-commissioner
+ *
+ * A session is started on a value-initialized Context, e.g. `new Context()`, with CommissionerInit() and the options
+ * set. It never blocks once started: the host adds its sockets to the fd sets of its mainloop, processes them, and
+ * stops it once finished. The PSKc derivation is the only costly step of the start, a host of many sessions of the
+ * same network derives it once and copies mAgent.mPSKc to each of them. The random generator of the dtls clients is
+ * shared by the sessions of a process.
+ */
+
+/** set the defaults of a session, which the options may override */
+void CommissionerInit(Context &aContext);
+
+/** start a session, prepares its joiners, steering data and PSKc, and connects to the agent, returns 0 or errno */
+int CommissionerStart(Context &aContext);
+
+/** add the sockets of a started session to the fd sets, and shorten the timeout to its next event */
+void CommissionerUpdateFdSet(Context &       aContext,
+                             fd_set &        aReadFdSet,
+                             fd_set &        aWriteFdSet,
+                             fd_set &        aErrorFdSet,
+                             int &           aMaxFd,
+                             struct timeval &aTimeout);
+
+/** process the sockets and timers of a started session, advancing it through petition, steering and its joiners */
+void CommissionerProcess(Context &     aContext,
+                         const fd_set &aReadFdSet,
+                         const fd_set &aWriteFdSet,
+                         const fd_set &aErrorFdSet);
+
+/** is the session finished, either its joiners are commissioned, it is told to quit or it failed */
+bool CommissionerIsFinished(const Context &aContext);
+
+/** stop a session and free its resources, returns 0 if all its joiners were commissioned or it was told to quit */
+int CommissionerStop(Context &aContext);
 
 /* compute the hashmac of a joiner */
-bool CommissionerComputeHashMac(void);
+bool CommissionerComputeHashMac(Context &aContext);
 
 /** Compute steering data */
-bool CommissionerComputeSteering(void);
+bool CommissionerComputeSteering(Context &aContext);
 
 /** compute pskc */
-bool CommissionerComputePskc(void);
+bool CommissionerComputePskc(Context &aContext);
+
+/** start computing pskc on a thread of its own, aContext.mAgent.mPSKc is not used until joined */
+void CommissionerComputePskcStart(Context &aContext);
+
+/** wait for the pskc computation started, returns whether it succeeded */
+bool CommissionerComputePskcJoin(Context &aContext);
+
+/* check a joiner PSKd, returns why it is bad or NULL if it is good */
+const char *CommissionerUtilsCheckPskd(const char *aPSKd);
 
 /* return a small string with this data as hex for logging purposes */
 const char *CommissionerUtilsHexString(const uint8_t *pBytes, int n);
 
-/** command line self test handler */
-void CommissionerCmdLineSelfTest(argcargv *pThis);
+/** print latency percentiles of samples in microseconds, as `NAME-ms: count=N p50=...`, sorting them */
+void CommissionerUtilsPrintLatency(const char *aName, std::vector<uint64_t> &aSamples);
 
 /** Print/log an error message and exit */
 void CommissionerUtilsFail(const char *fmt, ...);
+
+/** add a joiner to a session, reusing the slot of a commissioned joiner, the steering data is updated once serving */
+int CommissionerAddJoiner(Context &aContext, const uint8_t *aEui64, const char *aPSKd, JoinerSession *&aJoiner);
+
+/** open the control socket */
+int CommissionerControlOpen(Context &aContext);
+
+/** add the control socket to the fd set */
+void CommissionerControlUpdateFdSet(Context &aContext, fd_set &aReadFdSet, int &aMaxFd);
+
+/** accept a connection of the control socket and run its command */
+void CommissionerControlProcess(Context &aContext, const fd_set &aReadFdSet);
+
+/** close the control socket */
+void CommissionerControlClose(Context &aContext);
+
+/*
+ * otbr-commissioner
+ */
+
+class argcargv;
+
+/* the commissioning context of the command line */
+extern struct Context gContext;
+
+/** run the commissioning load generator and print its report */
+int CommissionerLoad(Context &aContext);
+
+/** replay the commissioner requests of a trace and print their latencies */
+int CommissionerReplay(Context &aContext);
+
+/** command line self test handler */
+void CommissionerCmdLineSelfTest(argcargv *pThis);
+
+#endif // COMMISSIONER_HPP_
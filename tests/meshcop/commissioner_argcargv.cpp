@@ -32,6 +32,7 @@
  */
 
 #include "commissioner.hpp"
+#include "commissioner_argcargv.hpp"
 
 using namespace ot;
 using namespace ot::Utils;
@@ -257,7 +258,7 @@ static void handle_hashmac(argcargv *pThis)
     /* once hash mac is know, we can compute the steering data
      * We assume we have the xpanid & network name.
      */
-    ok = CommissionerComputeSteering();
+    ok = CommissionerComputeSteering(gContext);
     if (!ok)
     {
         pThis->usage("Invalid HASHMAC: %s\n", gContext.mJoiner.mHashMac.ascii);
@@ -274,88 +275,148 @@ static void handle_eui64(argcargv *pThis)
     /* once we have this, we can calculate the HASHMAC
      * and the steering data.
      */
-    ok = CommissionerComputeHashMac();
-    ok = ok && CommissionerComputeSteering();
+    ok = CommissionerComputeHashMac(gContext);
+    ok = ok && CommissionerComputeSteering(gContext);
     if (!ok)
     {
         pThis->usage("Invalid EUI64: %s\n", gContext.mJoiner.mEui64.ascii);
     }
 }
 
+/** Handle a file of joiner EUI64s on the command line */
+static void handle_joiner_list(argcargv *pThis)
+{
+    const char *        filename;
+    SteeringDataBuilder builder;
+    unsigned long       line;
+
+    filename = pThis->str_param(NULL, PATH_MAX);
+
+    builder.Init(gContext.mJoiner.mSteeringData.GetLength());
+    builder.SetJoinerIdCache(&gContext.mJoiner.mIdCache);
+    if (!builder.AddFile(filename, SteeringDataBuilder::kEntryEui64, 0, line))
+    {
+        if (line == 0)
+        {
+            pThis->usage("Cannot read joiner list: %s\n", filename);
+        }
+        pThis->usage("Invalid EUI64 in joiner list: %s line %lu\n", filename, line);
+    }
+
+    gContext.mJoiner.mSteeringData = builder.GetSteeringData();
+    gContext.mJoiner.mJoinerList   = true;
+
+    otbrLog(OTBR_LOG_INFO, "joiner-list: %lu joiners, false positive rate %.6f",
+            static_cast<unsigned long>(builder.GetCount()), builder.GetFalsePositiveRate());
+}
+
+/** Handle the file caching the joiner ids of EUI64s on the command line */
+static void handle_joiner_id_cache(argcargv *pThis)
+{
+    const char *filename;
+
+    filename = pThis->str_param(NULL, PATH_MAX);
+
+    /* without the cache, joiner ids are still computed */
+    if (!gContext.mJoiner.mIdCache.Open(filename))
+    {
+        otbrLog(OTBR_LOG_WARNING, "joiner-id-cache: cannot open %s: %s", filename, strerror(errno));
+    }
+    else
+    {
+        otbrLog(OTBR_LOG_INFO, "joiner-id-cache: %u joiner ids cached", gContext.mJoiner.mIdCache.GetCount());
+    }
+}
+
 /** Handle the preshared joining credential for the joining device on the command line */
 static void handle_pskd(argcargv *pThis)
 {
     const char *whybad;
-    int         ch;
-    int         len, x;
-
-    /* assume not bad */
-    whybad = NULL;
 
     /* get the parameter */
     pThis->str_param(gContext.mJoiner.mPSKd_ascii, sizeof(gContext.mJoiner.mPSKd_ascii));
 
-    /*
-     * Problem: Should we "base32" decode this per the specification?
-     * Answer: No - because this needs to be identical to the CLI application
-     * The CLI appication does *NOT* decode preshared key
-     * thus we do not decode the base32 value here
-     * We do however enforce the data..
-     */
+    whybad = CommissionerUtilsCheckPskd(gContext.mJoiner.mPSKd_ascii);
+    if (whybad)
+    {
+        pThis->usage("Illegal PSKd: \"%s\", %s\n", gContext.mJoiner.mPSKd_ascii, whybad);
+    }
+}
 
-    /*
-     * Joining Device Credential
-     * Specification 1.1.1, Section 8.2 Table 8-1
-     * Min Length 6, Max Length 32.
-     *
-     * Digits 0-9, Upper case only Letters A-Z
-     * excluding: I,O,Q,Z
-     *
-     * Note: 26 letters - 4 illegals = 22 letters.
-     * Thus 10 digits + 22 letters = 32 symbols.
-     * Thus, "base32" encoding using the above.
-     */
-    len = strlen(gContext.mJoiner.mPSKd_ascii);
-    if ((len < 6) || (len > 32))
+/** Handle a file of joiners commissioned in parallel, an EUI64 and its PSKd per line */
+static void handle_joiner_batch(argcargv *pThis)
+{
+    const char *        filename;
+    FILE *              file;
+    char                line[128];
+    unsigned long       lineno = 0;
+    SteeringDataBuilder builder;
+
+    filename = pThis->str_param(NULL, PATH_MAX);
+
+    file = fopen(filename, "r");
+    if (file == NULL)
     {
-        whybad = "invalid length (range: 6..32)";
+        pThis->usage("Cannot read joiner batch: %s\n", filename);
     }
-    else
+
+    builder.Init(gContext.mJoiner.mSteeringData.GetLength());
+    gContext.mJoinerCount = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL)
     {
-        for (x = 0; x < len; x++)
+        char           eui64[(kEui64Len * 2) + 1];
+        char           pskd[kPSKdLength + 1];
+        char           extra;
+        const char *   whybad;
+        JoinerSession *joiner;
+        int            n;
+
+        lineno++;
+
+        n = sscanf(line, " %16s %32s %c", eui64, pskd, &extra);
+        if (n <= 0 || eui64[0] == '#')
+        {
+            /* blank line or comment */
+            continue;
+        }
+
+        if (gContext.mJoinerCount >= kMaxJoiners)
         {
-            ch = gContext.mJoiner.mPSKd_ascii[x];
-
-            switch (ch)
-            {
-            case 'Z':
-            case 'I':
-            case 'O':
-            case 'Q':
-                whybad = "Letters I, O, Q and Z are not allowed";
-                break;
-            default:
-                if (isupper(ch) || isdigit(ch))
-                {
-                    /* all is well */
-                }
-                else
-                {
-                    whybad = "contains non-uppercase or non-digit";
-                }
-                break;
-            }
-            if (whybad)
-            {
-                break;
-            }
+            pThis->usage("Too many joiners in batch: %s, max %d\n", filename, kMaxJoiners);
         }
+
+        joiner = &gContext.mJoiners[gContext.mJoinerCount];
+        if (n != 2 || Hex2Bytes(eui64, joiner->mEui64, sizeof(joiner->mEui64)) != kEui64Len)
+        {
+            pThis->usage("Invalid joiner in batch: %s line %lu, expect: EUI64 PSKd\n", filename, lineno);
+        }
+
+        whybad = CommissionerUtilsCheckPskd(pskd);
+        if (whybad)
+        {
+            pThis->usage("Illegal PSKd in batch: %s line %lu, %s\n", filename, lineno, whybad);
+        }
+
+        strcpy(joiner->mPSKd_ascii, pskd);
+        gContext.mJoiner.mIdCache.ComputeJoinerId(joiner->mEui64, joiner->mJoinerId);
+        builder.Add(joiner->mJoinerId, 1, SteeringDataBuilder::kEntryJoinerId, 0);
+        gContext.mJoinerCount++;
     }
 
-    if (whybad)
+    fclose(file);
+
+    if (gContext.mJoinerCount == 0)
     {
-        pThis->usage("Illegal PSKd: \"%s\", %s\n", gContext.mJoiner.mPSKd_ascii, whybad);
+        pThis->usage("No joiners in batch: %s\n", filename);
     }
+
+    /* the steering data covers the whole batch */
+    gContext.mJoiner.mSteeringData = builder.GetSteeringData();
+    gContext.mJoiner.mJoinerList   = true;
+
+    otbrLog(OTBR_LOG_INFO, "joiner-batch: %d joiners, false positive rate %.6f", gContext.mJoinerCount,
+            builder.GetFalsePositiveRate());
 }
 
 /** Handle a pre-computed border agent preshared key, the PSKc
@@ -399,7 +460,10 @@ static void handle_log_filename(argcargv *pThis)
 static void handle_compute_pskc(argcargv *pThis)
 {
     (void)(pThis);
-    CommissionerComputePskc();
+    if (!CommissionerComputePskc(gContext))
+    {
+        CommissionerUtilsFail("Cannot compute PSKc (commissioning shared key)\n");
+    }
     /* we print this in a way scripts can easily parse */
     fprintf(stdout, "PSKc: %s\n", gContext.mAgent.mPSKc.ascii);
     exit(EXIT_SUCCESS);
@@ -417,7 +481,10 @@ static void handle_compute_hashmac(argcargv *pThis)
 {
     (void)pThis;
 
-    CommissionerComputeHashMac();
+    if (!CommissionerComputeHashMac(gContext))
+    {
+        CommissionerUtilsFail("Cannot compute hashmac\n");
+    }
     /* print so scripts can easily parse */
     fprintf(stdout, "eiu64: %s\n", gContext.mJoiner.mEui64.ascii);
     fprintf(stdout, "hashmac: %s\n", gContext.mJoiner.mHashMac.ascii);
@@ -429,7 +496,10 @@ static void handle_compute_steering(argcargv *pThis)
 {
     (void)pThis;
 
-    CommissionerComputeSteering();
+    if (!CommissionerComputeSteering(gContext))
+    {
+        CommissionerUtilsFail("Cannot compute steering data\n");
+    }
 
     /* print so scripts can easily parse */
     fprintf(stdout, "eiu64: %s\n", gContext.mJoiner.mEui64.ascii);
@@ -469,7 +539,7 @@ static void handle_allow_all_joiners(argcargv *pThis)
     /* once we have this, we can calculate the HASHMAC
      * and the steering data.
      */
-    ok = CommissionerComputeSteering();
+    ok = CommissionerComputeSteering(gContext);
     if (!ok)
     {
         CommissionerUtilsFail("Cannot compute steering\n");
@@ -518,6 +588,70 @@ static void handle_comm_envelope_timeout(argcargv *pThis)
     gContext.mEnvelopeTimeout = n;
 }
 
+/** parse a load generator parameter in the range 0..aMax */
+static int load_param(argcargv *pThis, int aMax)
+{
+    int n;
+
+    n = pThis->num_param();
+    if ((n < 0) || (n > aMax))
+    {
+        pThis->usage("Invalid %s, range: 0 <= n <= %d, not %d\n", pThis->mARGV[pThis->mARGx - 2], aMax, n);
+    }
+    return n;
+}
+
+/** handle the number of load generator commissioners */
+static void handle_load_commissioners(argcargv *pThis)
+{
+    gContext.mLoad.mCommissioners = load_param(pThis, kLoadMaxCommissioners);
+}
+
+/** handle the number of load generator joiners */
+static void handle_load_joiners(argcargv *pThis)
+{
+    gContext.mLoad.mJoiners = load_param(pThis, 65535);
+}
+
+/** handle the arrival rate of load generator commissioners */
+static void handle_load_commissioner_rate(argcargv *pThis)
+{
+    gContext.mLoad.mCommissionerRate = load_param(pThis, 1000);
+}
+
+/** handle the arrival rate of load generator joiners */
+static void handle_load_joiner_rate(argcargv *pThis)
+{
+    gContext.mLoad.mJoinerRate = load_param(pThis, 1000);
+}
+
+/** handle how long load generator commissioners are kept */
+static void handle_load_duration(argcargv *pThis)
+{
+    gContext.mLoad.mDuration = load_param(pThis, 86400);
+}
+
+/** handle the trace replayed against the agent */
+static void handle_replay_trace(argcargv *pThis)
+{
+    pThis->str_param(gContext.mReplay.mTrace, sizeof(gContext.mReplay.mTrace));
+}
+
+/** handle the speed up of the replayed trace */
+static void handle_replay_speed(argcargv *pThis)
+{
+    gContext.mReplay.mSpeed = load_param(pThis, 1000);
+}
+
+/** handle the control socket keeping the commissioner session for more joiners */
+static void handle_control_socket(argcargv *pThis)
+{
+    pThis->str_param(gContext.mControl.mPath, sizeof(gContext.mControl.mPath));
+
+    /* the session is kept until told to quit, a later --comm-envelope-timeout still applies */
+    gContext.mEnvelopeTimeout = 0;
+}
+
 /* handle disabling syslog on command line */
 static void handle_no_syslog(argcargv *pThis)
 {
@@ -533,11 +667,16 @@ void commissioner_argcargv(int argc, char **argv)
     args.add_option("--selftest", CommissionerCmdLineSelfTest, "", "perform internal selftests");
     args.add_option("--joiner-eui64", handle_eui64, "VALUE", "joiner EUI64 value");
     args.add_option("--hashmac", handle_hashmac, "VALUE", "joiner HASHMAC value");
+    args.add_option("--joiner-id-cache", handle_joiner_id_cache, "FILENAME",
+                    "file caching the joiner ids of EUI64s, before the joiner options");
+    args.add_option("--joiner-list", handle_joiner_list, "FILENAME", "file of joiner EUI64 values, one per line");
     args.add_option("--agent-passphrase", handle_agent_passphrase, "VALUE", "Pass phrase for agent");
     args.add_option("--network-name", handle_netname, "VALUE", "UTF8 encoded network name");
     args.add_option("--xpanid", handle_xpanid, "VALUE", "xpanid in hex");
     args.add_option("--pskc-bin", handle_pskc_bin, "VALUE", "Precomputed PSKc in hex notation");
     args.add_option("--joiner-passphrase", handle_pskd, "VALUE", "PSKd for joiner");
+    args.add_option("--joiner-batch", handle_joiner_batch, "FILENAME",
+                    "file of joiners commissioned in parallel, EUI64 and PSKd per line");
     args.add_option("--steering-length", handle_steering_length, "NUMBER", "Length of steering data 1..15");
     args.add_option("--allow-all-joiners", handle_allow_all_joiners, "", "Allow any device to join");
     args.add_option("--agent-addr", handle_ip_addr, "VALUE", "ip address of border router agent");
@@ -554,6 +693,22 @@ void commissioner_argcargv(int argc, char **argv)
                     "Set the total envelope timeout for commissioning");
 
     args.add_option("--commission-device", handle_commission_device, "", "Enable device commissioning");
+    args.add_option("--control-socket", handle_control_socket, "PATH",
+                    "Keep the session and add joiners over the unix socket PATH");
+
+    args.add_option("--load-commissioners", handle_load_commissioners, "NUMBER",
+                    "Generate load with NUMBER commissioner sessions");
+    args.add_option("--load-joiners", handle_load_joiners, "NUMBER", "Relay NUMBER simulated joiners during load");
+    args.add_option("--load-commissioner-rate", handle_load_commissioner_rate, "NUMBER",
+                    "Commissioner arrivals per second, 0 for all at once");
+    args.add_option("--load-joiner-rate", handle_load_joiner_rate, "NUMBER",
+                    "Joiner arrivals per second, 0 for all at once");
+    args.add_option("--load-duration", handle_load_duration, "SECONDS", "How long load commissioners are kept");
+
+    args.add_option("--replay-trace", handle_replay_trace, "FILENAME",
+                    "Replay the commissioner requests of a trace saved by otbr-agent");
+    args.add_option("--replay-speed", handle_replay_speed, "NUMBER",
+                    "Replay NUMBER times faster than recorded, 0 for as fast as possible");
 
     args.add_option("--debug-level", handle_debug_level, "NUMBER", "Enable debug output at level VALUE (higher=more)");
     if (argc == 1)
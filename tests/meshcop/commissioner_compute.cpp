@@ -31,128 +31,163 @@
  *   The file computes various values used during commissioning.
  */
 
+#include <pthread.h>
+
 #include "commissioner.hpp"
 
 /** the hashmac is used in the steering data */
-bool CommissionerComputeHashMac(void)
+bool CommissionerComputeHashMac(Context &aContext)
 {
     /* given ascii eui64, compute hashmac */
-    mbedtls_sha256_context sha256;
-    uint8_t                hash_result[32];
-    int                    r;
+    int r;
 
     /* convert ascii EUI64 into BIN EUI64 */
-    otbrLog(OTBR_LOG_INFO, "eui64: %s", gContext.mJoiner.mEui64.ascii);
+    otbrLog(OTBR_LOG_INFO, "eui64: %s", aContext.mJoiner.mEui64.ascii);
 
     /* do we need to do this? */
-    if (gContext.mJoiner.mHashMac.ascii[0])
+    if (aContext.mJoiner.mHashMac.ascii[0])
     {
         otbrLog(OTBR_LOG_INFO, "note: hashmac already computed or provided");
     }
     else
     {
-        if (gContext.mJoiner.mEui64.ascii[0] == 0)
+        if (aContext.mJoiner.mEui64.ascii[0] == 0)
         {
-            CommissionerUtilsFail("MISSING EUI64 address\n");
+            otbrLog(OTBR_LOG_ERR, "MISSING EUI64 address");
             return false;
         }
 
-        r = Hex2Bytes(gContext.mJoiner.mEui64.ascii, gContext.mJoiner.mEui64.bin, sizeof(gContext.mJoiner.mEui64.bin));
+        r = Hex2Bytes(aContext.mJoiner.mEui64.ascii, aContext.mJoiner.mEui64.bin, sizeof(aContext.mJoiner.mEui64.bin));
         if (r != 8)
         {
-            CommissionerUtilsFail("eui64 wrong length, or non-hex data\n");
+            otbrLog(OTBR_LOG_ERR, "eui64 wrong length, or non-hex data");
             return false;
         }
-        mbedtls_sha256_init(&sha256);
-        mbedtls_sha256_starts(&sha256, 0);
-        mbedtls_sha256_update(&sha256, gContext.mJoiner.mEui64.bin, sizeof(gContext.mJoiner.mEui64.bin));
-
-        mbedtls_sha256_finish(&sha256, hash_result);
-        /* Bytes 0..7, is the new data */
-        memcpy(gContext.mJoiner.mHashMac.bin, hash_result, 8);
-        /* Set the locally admin bit, byte 0, bit 1 */
-        gContext.mJoiner.mHashMac.bin[0] |= 2;
+        /* the first 8 bytes of the SHA-256 of the EUI64, with the locally admin bit set, unless cached */
+        aContext.mJoiner.mIdCache.ComputeJoinerId(aContext.mJoiner.mEui64.bin, aContext.mJoiner.mHashMac.bin);
         /* we now have the HASHMAC value */
         /* convert to ascii */
-        Bytes2Hex(gContext.mJoiner.mHashMac.bin, 8, gContext.mJoiner.mHashMac.ascii);
+        Bytes2Hex(aContext.mJoiner.mHashMac.bin, 8, aContext.mJoiner.mHashMac.ascii);
     }
-    otbrLog(OTBR_LOG_INFO, "hash-mac: %s", gContext.mJoiner.mHashMac.ascii);
+    otbrLog(OTBR_LOG_INFO, "hash-mac: %s", aContext.mJoiner.mHashMac.ascii);
 
     /* success */
     return true;
 }
 
 /** compute preshared key for commissioner */
-bool CommissionerComputePskc(void)
+bool CommissionerComputePskc(Context &aContext)
 {
     const uint8_t *pKey;
 
     /* do we need to do this? */
-    if (gContext.mAgent.mPSKc.ascii[0])
+    if (aContext.mAgent.mPSKc.ascii[0])
     {
         otbrLog(OTBR_LOG_INFO, "note: PSKc already computed, or provided");
     }
     else
     {
-        otbrLog(OTBR_LOG_INFO, "xpanid: %s", gContext.mAgent.mXpanid.ascii);
-        if (gContext.mAgent.mXpanid.ascii[0] == 0)
+        otbrLog(OTBR_LOG_INFO, "xpanid: %s", aContext.mAgent.mXpanid.ascii);
+        if (aContext.mAgent.mXpanid.ascii[0] == 0)
         {
-            CommissionerUtilsFail("compute PSKc: Missing xpanid\n");
+            otbrLog(OTBR_LOG_ERR, "compute PSKc: Missing xpanid");
             return false;
         }
 
-        otbrLog(OTBR_LOG_INFO, "networkname: %s", gContext.mAgent.mNetworkName);
-        if (gContext.mAgent.mNetworkName[0] == 0)
+        otbrLog(OTBR_LOG_INFO, "networkname: %s", aContext.mAgent.mNetworkName);
+        if (aContext.mAgent.mNetworkName[0] == 0)
         {
-            CommissionerUtilsFail("compute PSKc: Missing networkname\n");
+            otbrLog(OTBR_LOG_ERR, "compute PSKc: Missing networkname");
             return false;
         }
 
-        otbrLog(OTBR_LOG_INFO, "passphrase: %s", gContext.mAgent.mPassPhrase);
-        if (gContext.mAgent.mPassPhrase[0] == 0)
+        otbrLog(OTBR_LOG_INFO, "passphrase: %s", aContext.mAgent.mPassPhrase);
+        if (aContext.mAgent.mPassPhrase[0] == 0)
         {
-            CommissionerUtilsFail("compute PSKc: Missing br passphrase\n");
+            otbrLog(OTBR_LOG_ERR, "compute PSKc: Missing br passphrase");
             return false;
         }
 
         otbrLog(OTBR_LOG_INFO, "note: calculating PSKc");
-        pKey = gContext.mAgent.mPSKc.mTool.ComputePskc(gContext.mAgent.mXpanid.bin, gContext.mAgent.mNetworkName,
-                                                       gContext.mAgent.mPassPhrase);
+        pKey = aContext.mAgent.mPSKc.mTool.ComputePskc(aContext.mAgent.mXpanid.bin, aContext.mAgent.mNetworkName,
+                                                       aContext.mAgent.mPassPhrase);
 
-        memcpy(gContext.mAgent.mPSKc.bin, pKey, OT_PSKC_LENGTH);
+        memcpy(aContext.mAgent.mPSKc.bin, pKey, OT_PSKC_LENGTH);
         /* convert to ascii for log purposes */
-        Bytes2Hex(gContext.mAgent.mPSKc.bin, OT_PSKC_LENGTH, gContext.mAgent.mPSKc.ascii);
+        Bytes2Hex(aContext.mAgent.mPSKc.bin, OT_PSKC_LENGTH, aContext.mAgent.mPSKc.ascii);
     }
-    otbrLog(OTBR_LOG_INFO, "pskc: %s", gContext.mAgent.mPSKc.ascii);
+    otbrLog(OTBR_LOG_INFO, "pskc: %s", aContext.mAgent.mPSKc.ascii);
     /* have a return here so this function matchs other "compute" functions */
     return true; /* success */
 }
 
+static void *CommissionerComputePskcThread(void *aContext)
+{
+    Context &context = *static_cast<Context *>(aContext);
+
+    context.mAgent.mPSKc.mComputed = CommissionerComputePskc(context);
+    return NULL;
+}
+
+/** start computing the PSKc, so that work not depending on it overlaps the derivation */
+void CommissionerComputePskcStart(Context &aContext)
+{
+    /* nothing to overlap when the PSKc is given */
+    if (aContext.mAgent.mPSKc.ascii[0] == 0 &&
+        pthread_create(&aContext.mAgent.mPSKc.mThread, NULL, CommissionerComputePskcThread, &aContext) == 0)
+    {
+        aContext.mAgent.mPSKc.mThreadStarted = true;
+    }
+    else
+    {
+        aContext.mAgent.mPSKc.mComputed = CommissionerComputePskc(aContext);
+    }
+}
+
+/** wait for the PSKc started by CommissionerComputePskcStart() */
+bool CommissionerComputePskcJoin(Context &aContext)
+{
+    if (aContext.mAgent.mPSKc.mThreadStarted)
+    {
+        pthread_join(aContext.mAgent.mPSKc.mThread, NULL);
+        aContext.mAgent.mPSKc.mThreadStarted = false;
+    }
+
+    return aContext.mAgent.mPSKc.mComputed;
+}
+
 /** compute the steering data */
-bool CommissionerComputeSteering(void)
+bool CommissionerComputeSteering(Context &aContext)
 {
     bool ok;
 
     do
     {
-        if (gContext.mJoiner.mAllowAny)
+        if (aContext.mJoiner.mAllowAny)
         {
             otbrLog(OTBR_LOG_INFO, "JOINER: Allow any ingore hashmac");
-            gContext.mJoiner.mSteeringData.Set();
+            aContext.mJoiner.mSteeringData.Set();
+            ok = true;
+            break;
+        }
+
+        if (aContext.mJoiner.mJoinerList)
+        {
+            otbrLog(OTBR_LOG_INFO, "JOINER: Steering data built from joiner list");
             ok = true;
             break;
         }
 
         /* We require a hashmac */
-        ok = CommissionerComputeHashMac();
+        ok = CommissionerComputeHashMac(aContext);
         if (!ok)
         {
             otbrLog(OTBR_LOG_INFO, "error: Cannot calculate steering data, bad hashmac");
             break;
         }
 
-        gContext.mJoiner.mSteeringData.Clear();
-        gContext.mJoiner.mSteeringData.ComputeBloomFilter(gContext.mJoiner.mHashMac.bin);
+        aContext.mJoiner.mSteeringData.Clear();
+        aContext.mJoiner.mSteeringData.ComputeBloomFilter(aContext.mJoiner.mHashMac.bin);
 
     } while (0);
 
@@ -162,9 +197,9 @@ bool CommissionerComputeSteering(void)
         int            n;
         const uint8_t *pBytes;
 
-        n = gContext.mJoiner.mSteeringData.GetLength();
+        n = aContext.mJoiner.mSteeringData.GetLength();
 
-        pBytes = gContext.mJoiner.mSteeringData.GetDataPointer();
+        pBytes = aContext.mJoiner.mSteeringData.GetDataPointer();
 
         otbrLog(OTBR_LOG_INFO, "steering-len: %d", n);
         otbrLog(OTBR_LOG_INFO, "steering-hex: %s", CommissionerUtilsHexString(pBytes, n));
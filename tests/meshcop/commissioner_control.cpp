@@ -0,0 +1,223 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   The file implements the control socket of the commissioner test app.
+ *
+ * With a control socket the commissioner session is kept open, with its keep-alives, after its joiners are
+ * commissioned, and more joiners are added over the socket, so each device only costs its joiner handshake. Each
+ * connection sends one command line and reads the reply until the socket is closed:
+ *
+ *    add EUI64 PSKd     commission one more joiner, replies "ok PORT"
+ *    status             one line for each joiner, its EUI64, port and state
+ *    quit               end the commissioner session
+ */
+
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "commissioner.hpp"
+
+enum
+{
+    /* Max length of a command line */
+    kControlLineLength = 128,
+
+    /* Seconds a connection may wait before sending its command */
+    kControlTimeout = 1,
+};
+
+/** name of a joiner state for the status command */
+static const char *ControlStateName(int aState)
+{
+    switch (aState)
+    {
+    case kStateAuthenticated:
+        return "authenticated";
+    case kStateFinalized:
+        return "finalized";
+    case kStateDone:
+        return "done";
+    default:
+        return "waiting";
+    }
+}
+
+/** run the add command, commissioning one more joiner */
+static void ControlAdd(Context &aContext, FILE *aReply, const char *aEui64, const char *aPSKd)
+{
+    uint8_t        eui64[kEui64Len];
+    const char *   whybad;
+    JoinerSession *joiner;
+    int            ret;
+
+    VerifyOrExit(aEui64 != NULL && aPSKd != NULL && strlen(aEui64) == kEui64Len * 2 &&
+                     Hex2Bytes(aEui64, eui64, sizeof(eui64)) == kEui64Len,
+                 fprintf(aReply, "error expect: add EUI64 PSKd\n"));
+
+    whybad = CommissionerUtilsCheckPskd(aPSKd);
+    VerifyOrExit(whybad == NULL, fprintf(aReply, "error PSKd %s\n", whybad));
+
+    ret = CommissionerAddJoiner(aContext, eui64, aPSKd, joiner);
+    VerifyOrExit(ret == 0, fprintf(aReply, "error %s\n", ret > 0 ? strerror(ret) : "COMMISSIONER_SET failed"));
+
+    fprintf(aReply, "ok %d\n", joiner->mPortSession);
+
+exit:
+    return;
+}
+
+/** run the status command */
+static void ControlStatus(Context &aContext, FILE *aReply)
+{
+    for (int i = 0; i < aContext.mJoinerCount; i++)
+    {
+        const JoinerSession &joiner = aContext.mJoiners[i];
+
+        fprintf(aReply, "%s %d %s\n", CommissionerUtilsHexString(joiner.mEui64, sizeof(joiner.mEui64)),
+                joiner.mPortSession, ControlStateName(joiner.mState));
+    }
+    fprintf(aReply, "ok %d\n", aContext.mJoinerCount);
+}
+
+int CommissionerControlOpen(Context &aContext)
+{
+    int                ret = 0;
+    struct sockaddr_un addr;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    VerifyOrExit(strlen(aContext.mControl.mPath) < sizeof(addr.sun_path), ret = ENAMETOOLONG);
+    strcpy(addr.sun_path, aContext.mControl.mPath);
+
+    aContext.mControl.mSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    VerifyOrExit(aContext.mControl.mSocket != -1, ret = errno);
+
+    /* a socket left by an earlier run */
+    unlink(aContext.mControl.mPath);
+
+    VerifyOrExit(bind(aContext.mControl.mSocket, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == 0,
+                 ret = errno);
+    VerifyOrExit(listen(aContext.mControl.mSocket, 4) == 0, ret = errno);
+
+    otbrLog(OTBR_LOG_INFO, "control: listening on %s", aContext.mControl.mPath);
+
+exit:
+    if (ret != 0)
+    {
+        otbrLog(OTBR_LOG_ERR, "control: cannot listen on %s: %s", aContext.mControl.mPath, strerror(ret));
+        CommissionerControlClose(aContext);
+    }
+
+    return ret;
+}
+
+void CommissionerControlUpdateFdSet(Context &aContext, fd_set &aReadFdSet, int &aMaxFd)
+{
+    VerifyOrExit(aContext.mControl.mSocket != -1);
+
+    FD_SET(aContext.mControl.mSocket, &aReadFdSet);
+    if (aMaxFd < aContext.mControl.mSocket)
+    {
+        aMaxFd = aContext.mControl.mSocket;
+    }
+
+exit:
+    return;
+}
+
+void CommissionerControlProcess(Context &aContext, const fd_set &aReadFdSet)
+{
+    struct timeval timeout = {kControlTimeout, 0};
+    char           line[kControlLineLength];
+    char *         save;
+    const char *   command;
+    FILE *         stream = NULL;
+    int            fd;
+
+    VerifyOrExit(aContext.mControl.mSocket != -1 && FD_ISSET(aContext.mControl.mSocket, &aReadFdSet));
+
+    fd = accept(aContext.mControl.mSocket, NULL, NULL);
+    VerifyOrExit(fd != -1, otbrLog(OTBR_LOG_ERR, "control: accept() fails with %d", errno));
+
+    /* the commissioner is not served while the command is read, so do not wait for long */
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    stream = fdopen(fd, "r+");
+    if (stream == NULL)
+    {
+        close(fd);
+        ExitNow();
+    }
+
+    VerifyOrExit(fgets(line, sizeof(line), stream) != NULL);
+
+    command = strtok_r(line, " \t\r\n", &save);
+    VerifyOrExit(command != NULL, fprintf(stream, "error empty command\n"));
+    otbrLog(OTBR_LOG_INFO, "control: %s", command);
+
+    if (strcmp(command, "add") == 0)
+    {
+        const char *eui64 = strtok_r(NULL, " \t\r\n", &save);
+        const char *pskd  = strtok_r(NULL, " \t\r\n", &save);
+
+        ControlAdd(aContext, stream, eui64, pskd);
+    }
+    else if (strcmp(command, "status") == 0)
+    {
+        ControlStatus(aContext, stream);
+    }
+    else if (strcmp(command, "quit") == 0)
+    {
+        aContext.mControl.mQuit = true;
+        fprintf(stream, "ok\n");
+    }
+    else
+    {
+        fprintf(stream, "error unknown command: %s\n", command);
+    }
+
+exit:
+    if (stream != NULL)
+    {
+        fclose(stream);
+    }
+}
+
+void CommissionerControlClose(Context &aContext)
+{
+    VerifyOrExit(aContext.mControl.mSocket != -1);
+
+    close(aContext.mControl.mSocket);
+    aContext.mControl.mSocket = -1;
+    unlink(aContext.mControl.mPath);
+
+exit:
+    return;
+}
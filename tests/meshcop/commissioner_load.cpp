@@ -0,0 +1,735 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   The file implements the commissioning load generator of the commissioner test app.
+ *
+ * Commissioner sessions arrive at the given rate, each doing the DTLS handshake with the border agent, petition,
+ * COMMISSIONER_SET and keep-alives until its duration ends and it resigns. Joiners arrive at the given rate once a
+ * session is ready, and each is simulated by the RLY_TX.ntf of a DTLS handshake sent over one of the ready sessions,
+ * so the relay path of the border agent is loaded without real devices.
+ */
+
+#include <math.h>
+
+#include <vector>
+
+#include "commissioner.hpp"
+#include "common/time.hpp"
+
+enum
+{
+    /* RLY_TX.ntf sent for each joiner, as the flights of its DTLS handshake */
+    kLoadRelayPerJoiner = 4,
+
+    /* Bytes of DTLS records encapsulated in each RLY_TX.ntf */
+    kLoadRelayLength = 128,
+
+    /* Milliseconds to poll sessions at, which schedules arrivals, keep-alives and timeouts */
+    kLoadPollInterval = 10,
+
+    /* Milliseconds a request waits for its response */
+    kLoadRequestTimeout = 10000,
+};
+
+/**
+ * Load session state
+ */
+enum
+{
+    kLoadStateHandshaking,
+    kLoadStatePetitioning,
+    kLoadStateSetting,
+    kLoadStateReady,
+    kLoadStateDone,
+};
+
+/**
+ * Results of a load run, latencies are in microseconds.
+ */
+struct LoadStats
+{
+    LoadStats(void)
+        : mStarted(0)
+        , mHandshakeFailures(0)
+        , mPetitionsAccepted(0)
+        , mPetitionsRejected(0)
+        , mPetitionFailures(0)
+        , mSetsRejected(0)
+        , mKeepAlivesRejected(0)
+        , mTimeouts(0)
+        , mSessionErrors(0)
+        , mCompleted(0)
+        , mJoiners(0)
+        , mJoinersDropped(0)
+        , mRelayMessages(0)
+        , mRelayBytes(0)
+        , mRelayErrors(0)
+        , mRelayReceived(0)
+        , mRelayStart(0)
+        , mRelayEnd(0)
+    {
+    }
+
+    std::vector<uint64_t> mHandshakeTimes;
+    std::vector<uint64_t> mPetitionTimes;
+    std::vector<uint64_t> mKeepAliveTimes;
+
+    int mStarted;
+    int mHandshakeFailures;
+    int mPetitionsAccepted;
+    int mPetitionsRejected;
+    int mPetitionFailures;
+    int mSetsRejected;
+    int mKeepAlivesRejected;
+    int mTimeouts;
+    int mSessionErrors;
+    int mCompleted;
+
+    int           mJoiners;
+    int           mJoinersDropped;
+    unsigned long mRelayMessages;
+    unsigned long mRelayBytes;
+    unsigned long mRelayErrors;
+    unsigned long mRelayReceived;
+    uint64_t      mRelayStart;
+    uint64_t      mRelayEnd;
+};
+
+/**
+ * Load commissioner session, which is never moved as its client and agent keep pointers to it.
+ */
+struct LoadSession
+{
+    Context *     mContext;
+    Dtls::Client *mClient;
+    Coap::Agent * mCoap;
+    LoadStats *   mStats;
+    int           mState;
+    uint16_t      mCoapToken;
+    uint16_t      mSessionId;
+
+    /* microseconds the session started, its request was sent (0 when none is waiting), it became ready and its
+     * last keep-alive was sent */
+    uint64_t mStartTime;
+    uint64_t mRequestTime;
+    uint64_t mReadyTime;
+    uint64_t mKeepAliveTime;
+};
+
+static void LoadHandleRelayReceive(const Coap::Resource &aResource,
+                                   const Coap::Message & aMessage,
+                                   Coap::Message &       aResponse,
+                                   const uint8_t *       aIp6,
+                                   uint16_t              aPort,
+                                   void *                aContext)
+{
+    static_cast<LoadStats *>(aContext)->mRelayReceived++;
+
+    (void)aResource;
+    (void)aMessage;
+    (void)aResponse;
+    (void)aIp6;
+    (void)aPort;
+}
+
+/** Sends coap messages through the DTLS session with the agent */
+static ssize_t LoadSendCoap(const uint8_t *aBuffer,
+                            uint16_t       aLength,
+                            const uint8_t *aIp6,
+                            uint16_t       aPort,
+                            void *         aContext)
+{
+    LoadSession &session = *static_cast<LoadSession *>(aContext);
+
+    (void)aIp6;
+    (void)aPort;
+
+    return session.mClient->Write(aBuffer, aLength);
+}
+
+/** returns seconds to the next arrival of a poisson process, 0 if all arrive at once */
+static double LoadNextArrival(int aRate)
+{
+    return aRate > 0 ? -log(1.0 - drand48()) / aRate : 0;
+}
+
+static void LoadClose(LoadSession &aSession)
+{
+    aSession.mClient->Close();
+    aSession.mState       = kLoadStateDone;
+    aSession.mRequestTime = 0;
+}
+
+/** Closes a session after an error, counting it against the step it failed at */
+static void LoadFail(LoadSession &aSession)
+{
+    LoadStats &stats = *aSession.mStats;
+
+    switch (aSession.mState)
+    {
+    case kLoadStateHandshaking:
+        stats.mHandshakeFailures++;
+        break;
+
+    case kLoadStatePetitioning:
+        stats.mPetitionFailures++;
+        break;
+
+    default:
+        stats.mSessionErrors++;
+        break;
+    }
+
+    LoadClose(aSession);
+}
+
+static otbrError LoadSendRequest(LoadSession &        aSession,
+                                 const char *         aPath,
+                                 const uint8_t *      aPayload,
+                                 uint16_t             aLength,
+                                 Coap::ResponseHandler aHandler)
+{
+    otbrError      ret;
+    uint16_t       token = htons(++aSession.mCoapToken);
+    Coap::Message *message;
+
+    message = aSession.mCoap->NewMessage(aHandler != NULL ? Coap::kTypeConfirmable : Coap::kTypeNonConfirmable,
+                                         Coap::kCodePost, reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+    message->SetPath(aPath);
+    message->SetPayload(aPayload, aLength);
+    ret = aSession.mCoap->Send(*message, NULL, 0, aHandler, &aSession);
+    aSession.mCoap->FreeMessage(message);
+
+    if (ret == OTBR_ERROR_NONE && aHandler != NULL)
+    {
+        aSession.mRequestTime = GetMonotonicNowUs();
+    }
+
+    return ret;
+}
+
+/** returns the value of the state TLV in a response, 0 if it has none, and updates the session id */
+static uint8_t LoadParseResponse(LoadSession &aSession, const Coap::Message &aMessage)
+{
+    uint16_t       length;
+    uint8_t        state   = 0;
+    const uint8_t *payload = aMessage.GetPayload(length);
+    const uint8_t *end     = payload + length;
+
+    for (const Tlv *tlv = reinterpret_cast<const Tlv *>(payload); reinterpret_cast<const uint8_t *>(tlv) < end;
+         tlv            = tlv->GetNext())
+    {
+        switch (tlv->GetType())
+        {
+        case Meshcop::kState:
+            state = tlv->GetValueUInt8();
+            break;
+
+        case Meshcop::kCommissionerSessionId:
+            aSession.mSessionId = tlv->GetValueUInt16();
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return state;
+}
+
+static void LoadHandleResponse(const Coap::Message &aMessage, void *aContext);
+
+static void LoadSendPetition(LoadSession &aSession)
+{
+    uint8_t buffer[kSizeMaxPacket];
+    Tlv *   tlv = reinterpret_cast<Tlv *>(buffer);
+
+    tlv->SetType(Meshcop::kCommissionerId);
+    tlv->SetValue(kCommissionerId, sizeof(kCommissionerId) - 1);
+    tlv = tlv->GetNext();
+
+    aSession.mState = kLoadStatePetitioning;
+
+    if (LoadSendRequest(aSession, "c/cp", buffer, LengthOf(buffer, tlv), LoadHandleResponse) != OTBR_ERROR_NONE)
+    {
+        LoadFail(aSession);
+    }
+}
+
+static void LoadSendSet(LoadSession &aSession)
+{
+    SteeringData &steering = aSession.mContext->mJoiner.mSteeringData;
+    uint8_t       buffer[kSizeMaxPacket];
+    Tlv *         tlv = reinterpret_cast<Tlv *>(buffer);
+
+    tlv->SetType(Meshcop::kCommissionerSessionId);
+    tlv->SetValue(aSession.mSessionId);
+    tlv = tlv->GetNext();
+
+    tlv->SetType(Meshcop::kSteeringData);
+    tlv->SetValue(steering.GetDataPointer(), steering.GetLength());
+    tlv = tlv->GetNext();
+
+    aSession.mState = kLoadStateSetting;
+
+    if (LoadSendRequest(aSession, "c/cs", buffer, LengthOf(buffer, tlv), LoadHandleResponse) != OTBR_ERROR_NONE)
+    {
+        LoadFail(aSession);
+    }
+}
+
+/** Sends a COMM_KA, whose state is accept to keep the session or reject to resign from it */
+static void LoadSendKeepAlive(LoadSession &aSession, bool aKeep)
+{
+    uint8_t buffer[kSizeMaxPacket];
+    Tlv *   tlv = reinterpret_cast<Tlv *>(buffer);
+
+    tlv->SetType(Meshcop::kState);
+    tlv->SetValue(static_cast<uint8_t>(aKeep ? 1 : 0xff));
+    tlv = tlv->GetNext();
+
+    tlv->SetType(Meshcop::kCommissionerSessionId);
+    tlv->SetValue(aSession.mSessionId);
+    tlv = tlv->GetNext();
+
+    aSession.mKeepAliveTime = GetMonotonicNowUs();
+
+    if (LoadSendRequest(aSession, "c/ca", buffer, LengthOf(buffer, tlv), aKeep ? LoadHandleResponse : NULL) !=
+        OTBR_ERROR_NONE)
+    {
+        LoadFail(aSession);
+    }
+}
+
+/** Handles the responses of COMM_PET, COMMISSIONER_SET and COMM_KA */
+static void LoadHandleResponse(const Coap::Message &aMessage, void *aContext)
+{
+    LoadSession &session = *static_cast<LoadSession *>(aContext);
+    LoadStats &  stats   = *session.mStats;
+    uint64_t     now     = GetMonotonicNowUs();
+    uint64_t     elapsed = now - session.mRequestTime;
+    bool         accepted;
+
+    VerifyOrExit(session.mRequestTime != 0 && session.mState != kLoadStateDone);
+
+    session.mRequestTime = 0;
+    accepted             = (LoadParseResponse(session, aMessage) == 1);
+
+    switch (session.mState)
+    {
+    case kLoadStatePetitioning:
+        stats.mPetitionTimes.push_back(elapsed);
+
+        if (accepted)
+        {
+            stats.mPetitionsAccepted++;
+            LoadSendSet(session);
+        }
+        else
+        {
+            otbrLog(OTBR_LOG_INFO, "load: petition rejected");
+            stats.mPetitionsRejected++;
+            LoadClose(session);
+        }
+        break;
+
+    case kLoadStateSetting:
+        if (accepted)
+        {
+            session.mState         = kLoadStateReady;
+            session.mReadyTime     = now;
+            session.mKeepAliveTime = now;
+        }
+        else
+        {
+            stats.mSetsRejected++;
+            LoadClose(session);
+        }
+        break;
+
+    case kLoadStateReady:
+        stats.mKeepAliveTimes.push_back(elapsed);
+
+        if (!accepted)
+        {
+            stats.mKeepAlivesRejected++;
+            LoadClose(session);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+exit:
+    return;
+}
+
+/** Handles the end of the handshake and of the DTLS session with the agent */
+static void LoadHandleClientState(Dtls::Client &aClient, Dtls::Session::State aState, void *aContext)
+{
+    LoadSession &session = *static_cast<LoadSession *>(aContext);
+
+    VerifyOrExit(session.mState != kLoadStateDone);
+
+    if (aState == Dtls::Session::kStateReady)
+    {
+        session.mStats->mHandshakeTimes.push_back(GetMonotonicNowUs() - session.mStartTime);
+        LoadSendPetition(session);
+    }
+    else
+    {
+        otbrLog(OTBR_LOG_INFO, "load: session ends, state=%d", aState);
+        LoadFail(session);
+    }
+
+exit:
+    (void)aClient;
+}
+
+static void LoadHandleData(const uint8_t *aBuffer, uint16_t aLength, void *aContext)
+{
+    LoadSession &session = *static_cast<LoadSession *>(aContext);
+
+    session.mCoap->Input(aBuffer, aLength, NULL, 0);
+}
+
+/** Handles request timeouts, keep-alives and the end of the session */
+static void LoadProcessTimers(LoadSession &aSession, uint64_t aNow)
+{
+    const Context &context = *aSession.mContext;
+    LoadStats &    stats   = *aSession.mStats;
+
+    if (aSession.mRequestTime != 0 && aNow - aSession.mRequestTime > kLoadRequestTimeout * 1000ULL)
+    {
+        otbrLog(OTBR_LOG_INFO, "load: request timeout");
+        stats.mTimeouts++;
+        LoadFail(aSession);
+    }
+
+    VerifyOrExit(aSession.mState == kLoadStateReady && aSession.mRequestTime == 0);
+
+    if (aNow - aSession.mReadyTime >= context.mLoad.mDuration * 1000000ULL)
+    {
+        LoadSendKeepAlive(aSession, false);
+        stats.mCompleted++;
+        LoadClose(aSession);
+    }
+    else if (!context.mCOMM_KA.mDisabled && aNow - aSession.mKeepAliveTime >= context.mCOMM_KA.mTxRate * 1000000ULL)
+    {
+        LoadSendKeepAlive(aSession, true);
+    }
+
+exit:
+    return;
+}
+
+static void LoadStart(LoadSession &aSession, Coap::Resource &aRelayReceive)
+{
+    otbrError ret;
+
+    aSession.mStartTime = GetMonotonicNowUs();
+    aSession.mState     = kLoadStateHandshaking;
+    aSession.mCoap      = Coap::Agent::Create(LoadSendCoap, &aSession);
+    aSession.mCoap->AddResource(aRelayReceive);
+    aSession.mClient = Dtls::Client::Create(LoadHandleClientState, &aSession);
+    aSession.mClient->SetDataHandler(LoadHandleData, &aSession);
+    aSession.mStats->mStarted++;
+
+    SuccessOrExit(ret = aSession.mClient->SetPSK(aSession.mContext->mAgent.mPSKc.bin, OT_PSKC_LENGTH));
+
+    /* the handshake is driven by the mainloop, its failure is reported to LoadHandleClientState() */
+    ret = aSession.mClient->Connect(aSession.mContext->mAgent.mAddress_ascii, aSession.mContext->mAgent.mPort_ascii);
+
+exit:
+    if (ret != OTBR_ERROR_NONE)
+    {
+        otbrLog(OTBR_LOG_ERR, "load: cannot start session, error=%d", ret);
+        LoadFail(aSession);
+    }
+}
+
+/** Sends the RLY_TX.ntf of one joiner over one of the ready sessions */
+static void LoadRelayJoiner(LoadSession &aSession, int aJoiner)
+{
+    LoadStats &stats = *aSession.mStats;
+    uint8_t    buffer[kSizeMaxPacket];
+    uint8_t    records[kLoadRelayLength];
+    uint8_t    iid[sizeof(aSession.mContext->mJoiners[0].mIid)];
+    uint64_t   now;
+
+    /* a DTLS 1.2 handshake record, the rest is not parsed by the agent */
+    memset(records, 0, sizeof(records));
+    records[0] = 22;
+    records[1] = 0xfe;
+    records[2] = 0xfd;
+
+    memset(iid, 0, sizeof(iid));
+    iid[6] = static_cast<uint8_t>(aJoiner >> 8);
+    iid[7] = static_cast<uint8_t>(aJoiner);
+
+    for (int i = 0; i < kLoadRelayPerJoiner && aSession.mState == kLoadStateReady; ++i)
+    {
+        Tlv *tlv = reinterpret_cast<Tlv *>(buffer);
+
+        tlv->SetType(Meshcop::kJoinerDtlsEncapsulation);
+        tlv->SetValue(records, sizeof(records));
+        tlv = tlv->GetNext();
+
+        tlv->SetType(Meshcop::kJoinerUdpPort);
+        tlv->SetValue(static_cast<uint16_t>(kPortJoinerSession));
+        tlv = tlv->GetNext();
+
+        tlv->SetType(Meshcop::kJoinerIid);
+        tlv->SetValue(iid, sizeof(iid));
+        tlv = tlv->GetNext();
+
+        tlv->SetType(Meshcop::kJoinerRouterLocator);
+        tlv->SetValue(static_cast<uint16_t>(0xfc00));
+        tlv = tlv->GetNext();
+
+        if (LoadSendRequest(aSession, "c/tx", buffer, LengthOf(buffer, tlv), NULL) == OTBR_ERROR_NONE)
+        {
+            stats.mRelayMessages++;
+            stats.mRelayBytes += sizeof(records);
+        }
+        else
+        {
+            stats.mRelayErrors++;
+        }
+    }
+
+    now = GetMonotonicNowUs();
+
+    if (stats.mRelayStart == 0)
+    {
+        stats.mRelayStart = now;
+    }
+
+    stats.mRelayEnd = now;
+    stats.mJoiners++;
+}
+
+/** we print this in a way scripts can easily parse */
+static void LoadPrintReport(LoadStats &aStats, uint64_t aElapsed)
+{
+    int    handshaken = aStats.mStarted - aStats.mHandshakeFailures;
+    int    petitions  = aStats.mPetitionsAccepted + aStats.mPetitionsRejected + aStats.mPetitionFailures;
+    double relayTime  = (aStats.mRelayEnd - aStats.mRelayStart) / 1000000.0;
+
+    fprintf(stdout, "load-duration-s: %.1f\n", aElapsed / 1000000.0);
+    fprintf(stdout, "commissioners: started=%d handshaken=%d handshake-failures=%d completed=%d\n", aStats.mStarted,
+            handshaken, aStats.mHandshakeFailures, aStats.mCompleted);
+    CommissionerUtilsPrintLatency("handshake", aStats.mHandshakeTimes);
+    fprintf(stdout, "petitions: accepted=%d rejected=%d failures=%d set-rejected=%d success-rate=%.1f%%\n",
+            aStats.mPetitionsAccepted, aStats.mPetitionsRejected, aStats.mPetitionFailures, aStats.mSetsRejected,
+            petitions > 0 ? 100.0 * aStats.mPetitionsAccepted / petitions : 0.0);
+    CommissionerUtilsPrintLatency("petition", aStats.mPetitionTimes);
+    CommissionerUtilsPrintLatency("keep-alive", aStats.mKeepAliveTimes);
+    fprintf(stdout, "sessions: timeouts=%d errors=%d keep-alive-rejected=%d\n", aStats.mTimeouts,
+            aStats.mSessionErrors, aStats.mKeepAlivesRejected);
+    fprintf(stdout, "relay: joiners=%d dropped=%d messages=%lu bytes=%lu errors=%lu received=%lu\n", aStats.mJoiners,
+            aStats.mJoinersDropped, aStats.mRelayMessages, aStats.mRelayBytes, aStats.mRelayErrors,
+            aStats.mRelayReceived);
+    fprintf(stdout, "relay-throughput: messages-per-s=%.1f bytes-per-s=%.1f\n",
+            relayTime > 0 ? aStats.mRelayMessages / relayTime : 0.0,
+            relayTime > 0 ? aStats.mRelayBytes / relayTime : 0.0);
+}
+
+/** see: commissioner.hpp, runs the commissioning load generator */
+int CommissionerLoad(Context &aContext)
+{
+    LoadStats                  stats;
+    std::vector<LoadSession *> sessions;
+    Coap::Resource             relayReceive(OT_URI_PATH_RELAY_RX, LoadHandleRelayReceive, &stats);
+    const Context::load &      params      = aContext.mLoad;
+    uint64_t                   start       = GetMonotonicNowUs();
+    uint64_t                   deadline    = start + aContext.mEnvelopeTimeout * 1000000ULL;
+    uint64_t                   nextSession = start;
+    uint64_t                   nextJoiner  = 0;
+    size_t                     nextRelay   = 0;
+    int                        active      = 0;
+
+    if (aContext.mAgent.mAddress_ascii[0] == 0 || aContext.mAgent.mPort_ascii[0] == 0)
+    {
+        CommissionerUtilsFail("Missing AGENT ip address or port\n");
+    }
+
+    /* the steering data is computed while the PSKc is derived */
+    CommissionerComputePskcStart(aContext);
+
+    if (!CommissionerComputeSteering(aContext))
+    {
+        CommissionerUtilsFail("Cannot compute steering data\n");
+    }
+
+    if (!CommissionerComputePskcJoin(aContext))
+    {
+        CommissionerUtilsFail("Cannot compute PSKc (commissioning shared key)\n");
+    }
+
+    /* arrivals are the same on every run */
+    srand48(1);
+
+    otbrLog(OTBR_LOG_INFO, "load: commissioners=%d joiners=%d", params.mCommissioners, params.mJoiners);
+
+    while (GetMonotonicNowUs() < deadline)
+    {
+        fd_set         readFdSet;
+        fd_set         writeFdSet;
+        fd_set         errorFdSet;
+        struct timeval timeout = {0, kLoadPollInterval * 1000};
+        uint64_t       now     = GetMonotonicNowUs();
+        int            maxFd   = -1;
+
+        while (static_cast<int>(sessions.size()) < params.mCommissioners && now >= nextSession)
+        {
+            LoadSession *session = new LoadSession();
+
+            session->mContext = &aContext;
+            session->mStats   = &stats;
+            sessions.push_back(session);
+            LoadStart(*session, relayReceive);
+            nextSession += static_cast<uint64_t>(LoadNextArrival(params.mCommissionerRate) * 1000000);
+        }
+
+        /* joiners arrive once a commissioner is ready to relay them */
+        while (stats.mJoiners + stats.mJoinersDropped < params.mJoiners && stats.mPetitionsAccepted > 0)
+        {
+            LoadSession *relay = NULL;
+
+            if (nextJoiner == 0)
+            {
+                nextJoiner = now;
+            }
+
+            if (now < nextJoiner)
+            {
+                break;
+            }
+
+            for (size_t i = 0; i < sessions.size() && relay == NULL; ++i)
+            {
+                LoadSession *session = sessions[(nextRelay + i) % sessions.size()];
+
+                if (session->mState == kLoadStateReady)
+                {
+                    relay     = session;
+                    nextRelay = (nextRelay + i + 1) % sessions.size();
+                }
+            }
+
+            if (relay != NULL)
+            {
+                LoadRelayJoiner(*relay, stats.mJoiners + stats.mJoinersDropped);
+            }
+            else
+            {
+                stats.mJoinersDropped++;
+            }
+
+            nextJoiner += static_cast<uint64_t>(LoadNextArrival(params.mJoinerRate) * 1000000);
+        }
+
+        active = 0;
+        FD_ZERO(&readFdSet);
+        FD_ZERO(&writeFdSet);
+        FD_ZERO(&errorFdSet);
+
+        for (size_t i = 0; i < sessions.size(); ++i)
+        {
+            LoadSession &session = *sessions[i];
+
+            if (session.mState != kLoadStateDone)
+            {
+                session.mClient->UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
+                active++;
+            }
+        }
+
+        if (active == 0 && static_cast<int>(sessions.size()) == params.mCommissioners)
+        {
+            break;
+        }
+
+        if (select(maxFd + 1, &readFdSet, &writeFdSet, &errorFdSet, &timeout) < 0)
+        {
+            if (errno != EINTR)
+            {
+                otbrLog(OTBR_LOG_ERR, "load: select errno=%d", errno);
+                break;
+            }
+
+            /* nothing is ready, the sessions only process their timers */
+            FD_ZERO(&readFdSet);
+            FD_ZERO(&writeFdSet);
+            FD_ZERO(&errorFdSet);
+        }
+
+        for (size_t i = 0; i < sessions.size(); ++i)
+        {
+            LoadSession &session = *sessions[i];
+
+            if (session.mState != kLoadStateDone)
+            {
+                session.mClient->Process(readFdSet, writeFdSet, errorFdSet);
+            }
+
+            /* requests may have been sent above */
+            if (session.mState != kLoadStateDone)
+            {
+                LoadProcessTimers(session, GetMonotonicNowUs());
+            }
+        }
+    }
+
+    if (active > 0)
+    {
+        otbrLog(OTBR_LOG_INFO, "load: envelope timeout with %d sessions active", active);
+    }
+
+    stats.mJoinersDropped = params.mJoiners - stats.mJoiners;
+    LoadPrintReport(stats, GetMonotonicNowUs() - start);
+
+    for (size_t i = 0; i < sessions.size(); ++i)
+    {
+        if (sessions[i]->mState != kLoadStateDone)
+        {
+            LoadClose(*sessions[i]);
+        }
+
+        Coap::Agent::Destroy(sessions[i]->mCoap);
+        Dtls::Client::Destroy(sessions[i]->mClient);
+        delete sessions[i];
+    }
+
+    /* the run fails if no commissioner got through */
+    return stats.mPetitionsAccepted > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,134 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   The file implements the Thread commissioner for test, a single session of libotbr-commissioner configured by
+ *   the command line.
+ */
+#include "commissioner.hpp"
+#include "commissioner_argcargv.hpp"
+
+struct Context gContext;
+
+/** this runs a commissioning session end to end */
+static int commissioning_session(Context &context)
+{
+    int ret;
+
+    if (context.mAgent.mAddress_ascii[0] == 0)
+    {
+        CommissionerUtilsFail("Missing AGENT ip address\n");
+    }
+
+    if (context.mAgent.mPort_ascii[0] == 0)
+    {
+        CommissionerUtilsFail("Missing AGENT ip port\n");
+    }
+
+    if (context.mJoinerCount == 0 && context.mJoiner.mPSKd_ascii[0] == 0 && context.mControl.mPath[0] == 0)
+    {
+        CommissionerUtilsFail("Missing PSKd (joiner passphrase/password)\n");
+    }
+
+    /* the reason is logged by the session */
+    if (CommissionerStart(context) != 0)
+    {
+        CommissionerUtilsFail("Cannot start the commissioning session\n");
+    }
+
+    while (!CommissionerIsFinished(context))
+    {
+        fd_set         readFdSet;
+        fd_set         writeFdSet;
+        fd_set         errorFdSet;
+        struct timeval timeout = {1, 0};
+        int            maxFd   = -1;
+
+        FD_ZERO(&readFdSet);
+        FD_ZERO(&writeFdSet);
+        FD_ZERO(&errorFdSet);
+        CommissionerUpdateFdSet(context, readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
+
+        if (select(maxFd + 1, &readFdSet, &writeFdSet, &errorFdSet, &timeout) < 0)
+        {
+            if (errno != EINTR)
+            {
+                otbrLog(OTBR_LOG_ERR, "commissioner serve, select errno=%d", errno);
+                break;
+            }
+
+            /* nothing is ready, the session only processes its timers */
+            FD_ZERO(&readFdSet);
+            FD_ZERO(&writeFdSet);
+            FD_ZERO(&errorFdSet);
+        }
+
+        CommissionerProcess(context, readFdSet, writeFdSet, errorFdSet);
+    }
+
+    ret = CommissionerStop(context);
+
+    /* Shell can not handle large exit numbers -> 1 for errors */
+    return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[])
+{
+    int ret = 0;
+
+    /* Set the initial log */
+    otbrLogInit(SYSLOG_IDENT, OTBR_LOG_ERR);
+
+    /* set defaults that may be overridden by the cmdline params */
+    CommissionerInit(gContext);
+
+    /* parse command line params */
+    commissioner_argcargv(argc, argv);
+
+    if (gContext.mLoad.mCommissioners > 0)
+    {
+        return CommissionerLoad(gContext);
+    }
+
+    if (gContext.mReplay.mTrace[0] != 0)
+    {
+        return CommissionerReplay(gContext);
+    }
+
+    if (!gContext.commission_device)
+    {
+        fprintf(stderr, "Nothing todo? Try --help\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* be a commissioner */
+    ret = commissioning_session(gContext);
+    otbrLog(OTBR_LOG_INFO, "exit: %d\n", ret);
+    return ret;
+}
@@ -0,0 +1,623 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @file
+ *   The file implements the trace replay of the commissioner test app.
+ *
+ * The CoAP messages otbr-agent received from commissioners, as saved in its trace, are replayed at the recorded
+ * pace, sped up by the given factor, over one DTLS session with the agent per commissioner of the trace. Messages to
+ * and from the Thread network are not replayed, they are answered by the network the agent runs with, e.g. its
+ * simulated NCP. Each confirmable request is timed until the response with its token, so releases can be compared
+ * on the same recorded workload.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "commissioner.hpp"
+#include "agent/packet_trace.hpp"
+#include "common/time.hpp"
+
+enum
+{
+    /* Milliseconds to poll sessions at, which schedules frames and timeouts */
+    kReplayPollInterval = 10,
+
+    /* Max length of a Uri-Path reported */
+    kReplayMaxPath = 32,
+
+    /* Max length of a CoAP token */
+    kReplayMaxToken = 8,
+
+    /* Uri-Path option number and payload marker, RFC 7252 */
+    kCoapOptionUriPath = 11,
+    kCoapPayloadMarker = 0xff,
+};
+
+/**
+ * A CoAP message parsed in place.
+ */
+struct ReplayCoap
+{
+    uint8_t        mType;
+    uint8_t        mCode;
+    const uint8_t *mToken;
+    uint8_t        mTokenLength;
+    char           mPath[kReplayMaxPath];
+    uint16_t       mPayloadOffset;
+};
+
+/**
+ * A replayed confirmable request waiting for its response.
+ */
+struct ReplayRequest
+{
+    uint8_t     mToken[kReplayMaxToken];
+    uint8_t     mTokenLength;
+    uint64_t    mSentTime;
+    std::string mPath;
+};
+
+/**
+ * Results of a replay, latencies are in microseconds.
+ */
+struct ReplayStats
+{
+    ReplayStats(void)
+        : mCommissionerFrames(0)
+        , mOtherFrames(0)
+        , mSkipped(0)
+        , mHandshakeFailures(0)
+        , mSent(0)
+        , mSendErrors(0)
+        , mDropped(0)
+        , mResponses(0)
+        , mUnmatched(0)
+        , mTimeouts(0)
+    {
+    }
+
+    std::vector<uint64_t>                          mLatencies;
+    std::map<std::string, std::vector<uint64_t> > mPathLatencies;
+
+    unsigned long mCommissionerFrames;
+    unsigned long mOtherFrames;
+    unsigned long mSkipped;
+    int           mHandshakeFailures;
+    unsigned long mSent;
+    unsigned long mSendErrors;
+    unsigned long mDropped;
+    unsigned long mResponses;
+    unsigned long mUnmatched;
+    unsigned long mTimeouts;
+};
+
+/**
+ * Replay session of a commissioner of the trace, which is never moved as its client keeps a pointer to it.
+ */
+struct ReplaySession
+{
+    uint8_t                    mIp6[16];
+    uint16_t                   mPort;
+    Dtls::Client *             mClient;
+    ReplayStats *              mStats;
+    uint16_t                   mSessionId; /* granted by the leader in the replay, 0 until then */
+    std::vector<ReplayRequest> mPending;
+};
+
+/**
+ * A frame of the trace replayed over a session, pointing into the mapped trace.
+ */
+struct ReplayFrame
+{
+    ReplaySession *mSession;
+    uint64_t       mTime;
+    const uint8_t *mMessage;
+    uint16_t       mLength;
+};
+
+/** parses the extension of an option delta or length, returns false if it is malformed */
+static bool ReplayParseOptionField(const uint8_t *aMessage, uint16_t aLength, uint32_t &aOffset, uint32_t &aValue)
+{
+    bool ok = true;
+
+    if (aValue == 13)
+    {
+        VerifyOrExit(aOffset + 1 <= aLength, ok = false);
+        aValue = 13 + aMessage[aOffset];
+        aOffset += 1;
+    }
+    else if (aValue == 14)
+    {
+        VerifyOrExit(aOffset + 2 <= aLength, ok = false);
+        aValue = 269 + (aMessage[aOffset] << 8 | aMessage[aOffset + 1]);
+        aOffset += 2;
+    }
+    else if (aValue == 15)
+    {
+        ok = false;
+    }
+
+exit:
+    return ok;
+}
+
+/** parses the header, Uri-Path and payload offset of a CoAP message, returns false if it is malformed */
+static bool ReplayParseCoap(const uint8_t *aMessage, uint16_t aLength, ReplayCoap &aCoap)
+{
+    bool     ok         = false;
+    uint32_t offset     = 4;
+    uint32_t option     = 0;
+    size_t   pathLength = 0;
+
+    VerifyOrExit(aLength >= 4 && (aMessage[0] >> 6) == 1);
+
+    aCoap.mType        = (aMessage[0] >> 4) & 0x3;
+    aCoap.mTokenLength = aMessage[0] & 0xf;
+    aCoap.mCode        = aMessage[1];
+    aCoap.mToken       = &aMessage[offset];
+    aCoap.mPath[0]     = 0;
+
+    VerifyOrExit(aCoap.mTokenLength <= kReplayMaxToken && offset + aCoap.mTokenLength <= aLength);
+    offset += aCoap.mTokenLength;
+
+    while (offset < aLength && aMessage[offset] != kCoapPayloadMarker)
+    {
+        uint32_t delta  = aMessage[offset] >> 4;
+        uint32_t length = aMessage[offset] & 0xf;
+
+        offset++;
+        VerifyOrExit(ReplayParseOptionField(aMessage, aLength, offset, delta) &&
+                     ReplayParseOptionField(aMessage, aLength, offset, length) && length <= aLength - offset);
+        option += delta;
+
+        if (option == kCoapOptionUriPath && pathLength + length + 2 <= sizeof(aCoap.mPath))
+        {
+            if (pathLength > 0)
+            {
+                aCoap.mPath[pathLength++] = '/';
+            }
+
+            memcpy(&aCoap.mPath[pathLength], &aMessage[offset], length);
+            pathLength += length;
+            aCoap.mPath[pathLength] = 0;
+        }
+
+        offset += length;
+    }
+
+    aCoap.mPayloadOffset = static_cast<uint16_t>(offset < aLength ? offset + 1 : aLength);
+    ok                   = true;
+
+exit:
+    return ok;
+}
+
+/** replaces the session id TLVs of a payload */
+static void ReplaySetSessionId(uint8_t *aPayload, uint16_t aLength, uint16_t aSessionId)
+{
+    TlvReader reader(aPayload, aLength);
+
+    for (const Tlv *tlv = reader.GetNext(); tlv != NULL; tlv = reader.GetNext())
+    {
+        if (tlv->GetType() == Meshcop::kCommissionerSessionId && tlv->GetLength() == sizeof(aSessionId))
+        {
+            const_cast<Tlv *>(tlv)->SetValue(aSessionId);
+        }
+    }
+}
+
+/** updates the session id from a response granting one, i.e. that of an accepted petition */
+static void ReplayUpdateSessionId(ReplaySession &aSession, const uint8_t *aPayload, uint16_t aLength)
+{
+    TlvReader reader(aPayload, aLength);
+    uint8_t   state     = 0;
+    uint16_t  sessionId = 0;
+
+    for (const Tlv *tlv = reader.GetNext(); tlv != NULL; tlv = reader.GetNext())
+    {
+        if (tlv->GetType() == Meshcop::kState && tlv->GetLength() == sizeof(state))
+        {
+            state = tlv->GetValueUInt8();
+        }
+        else if (tlv->GetType() == Meshcop::kCommissionerSessionId && tlv->GetLength() == sizeof(sessionId))
+        {
+            sessionId = tlv->GetValueUInt16();
+        }
+    }
+
+    if (state == 1 && sessionId != 0)
+    {
+        aSession.mSessionId = sessionId;
+    }
+}
+
+/** sends a frame over its session, waiting for the response of a confirmable request */
+static void ReplaySend(const ReplayFrame &aFrame)
+{
+    ReplaySession &session = *aFrame.mSession;
+    ReplayStats &  stats   = *session.mStats;
+    uint8_t        buffer[kSizeMaxPacket];
+    ReplayCoap     coap;
+
+    VerifyOrExit(session.mClient->GetState() == Dtls::Session::kStateReady, stats.mDropped++);
+
+    /* the session id granted to the commissioner of the trace is replaced by the one granted in the replay */
+    memcpy(buffer, aFrame.mMessage, aFrame.mLength);
+    ReplayParseCoap(buffer, aFrame.mLength, coap);
+
+    if (session.mSessionId != 0)
+    {
+        ReplaySetSessionId(&buffer[coap.mPayloadOffset], aFrame.mLength - coap.mPayloadOffset, session.mSessionId);
+    }
+
+    VerifyOrExit(session.mClient->Write(buffer, aFrame.mLength) >= 0, stats.mSendErrors++);
+    stats.mSent++;
+
+    if (coap.mType == Coap::kTypeConfirmable)
+    {
+        ReplayRequest request;
+
+        memcpy(request.mToken, coap.mToken, coap.mTokenLength);
+        request.mTokenLength = coap.mTokenLength;
+        request.mSentTime    = GetMonotonicNowUs();
+        request.mPath        = coap.mPath;
+        session.mPending.push_back(request);
+    }
+
+exit:
+    return;
+}
+
+/** handles the messages of the agent, acknowledging confirmable ones and timing responses */
+static void ReplayHandleData(const uint8_t *aBuffer, uint16_t aLength, void *aContext)
+{
+    ReplaySession &session = *static_cast<ReplaySession *>(aContext);
+    ReplayStats &  stats   = *session.mStats;
+    ReplayCoap     coap;
+
+    VerifyOrExit(ReplayParseCoap(aBuffer, aLength, coap));
+
+    /* the acknowledgments of the trace are not replayed, as they are of the recorded message ids */
+    if (coap.mType == Coap::kTypeConfirmable)
+    {
+        uint8_t ack[4] = {static_cast<uint8_t>(0x40 | Coap::kTypeAcknowledgment << 4), 0, aBuffer[2], aBuffer[3]};
+
+        session.mClient->Write(ack, sizeof(ack));
+    }
+
+    /* responses are timed, not empty acknowledgments nor requests of the agent */
+    VerifyOrExit((coap.mCode >> 5) >= 2);
+
+    for (std::vector<ReplayRequest>::iterator it = session.mPending.begin(); it != session.mPending.end(); ++it)
+    {
+        if (it->mTokenLength == coap.mTokenLength && memcmp(it->mToken, coap.mToken, coap.mTokenLength) == 0)
+        {
+            uint64_t elapsed = GetMonotonicNowUs() - it->mSentTime;
+
+            stats.mLatencies.push_back(elapsed);
+            stats.mPathLatencies[it->mPath].push_back(elapsed);
+            stats.mResponses++;
+            session.mPending.erase(it);
+            ReplayUpdateSessionId(session, &aBuffer[coap.mPayloadOffset], aLength - coap.mPayloadOffset);
+            ExitNow();
+        }
+    }
+
+    stats.mUnmatched++;
+
+exit:
+    return;
+}
+
+/** drops the requests waiting too long for their responses */
+static void ReplayProcessTimeouts(ReplaySession &aSession, uint64_t aNow)
+{
+    std::vector<ReplayRequest> &pending = aSession.mPending;
+
+    while (!pending.empty() && aNow - pending.front().mSentTime > kResponseTimeout * 1000ULL)
+    {
+        otbrLog(OTBR_LOG_INFO, "replay: %s timeout", pending.front().mPath.c_str());
+        aSession.mStats->mTimeouts++;
+        pending.erase(pending.begin());
+    }
+}
+
+static ReplaySession *ReplayFindSession(std::vector<ReplaySession *> &aSessions, const PacketTrace::Frame &aFrame)
+{
+    ReplaySession *session = NULL;
+
+    for (size_t i = 0; i < aSessions.size() && session == NULL; ++i)
+    {
+        if (aSessions[i]->mPort == aFrame.mPort && memcmp(aSessions[i]->mIp6, aFrame.mIp6, 16) == 0)
+        {
+            session = aSessions[i];
+        }
+    }
+
+    if (session == NULL)
+    {
+        if (aSessions.size() >= kLoadMaxCommissioners)
+        {
+            CommissionerUtilsFail("Too many commissioners in trace, max %d\n", kLoadMaxCommissioners);
+        }
+
+        session = new ReplaySession();
+        memcpy(session->mIp6, aFrame.mIp6, sizeof(session->mIp6));
+        session->mPort      = aFrame.mPort;
+        session->mClient    = NULL;
+        session->mSessionId = 0;
+        aSessions.push_back(session);
+    }
+
+    return session;
+}
+
+/** loads the commissioner requests of the trace, skipping truncated frames and empty messages */
+static void ReplayLoad(PacketTrace::Reader &         aReader,
+                       std::vector<ReplaySession *> &aSessions,
+                       std::vector<ReplayFrame> &    aFrames,
+                       ReplayStats &                 aStats)
+{
+    PacketTrace::Frame frame;
+
+    while (aReader.Next(frame))
+    {
+        ReplayCoap  coap;
+        ReplayFrame replay;
+
+        if (frame.mPoint != PacketTrace::kPointCommissionerIn)
+        {
+            aStats.mOtherFrames++;
+            continue;
+        }
+
+        aStats.mCommissionerFrames++;
+
+        if (frame.mLength < frame.mOriginalLength || !ReplayParseCoap(frame.mMessage, frame.mLength, coap) ||
+            coap.mCode == 0)
+        {
+            aStats.mSkipped++;
+            continue;
+        }
+
+        replay.mSession = ReplayFindSession(aSessions, frame);
+        replay.mTime    = frame.mTime;
+        replay.mMessage = frame.mMessage;
+        replay.mLength  = frame.mLength;
+        aFrames.push_back(replay);
+    }
+}
+
+/** polls the sessions until the given time, returns the number of sessions ready */
+static int ReplayPoll(std::vector<ReplaySession *> &aSessions, uint64_t aUntil)
+{
+    fd_set         readFdSet;
+    fd_set         writeFdSet;
+    fd_set         errorFdSet;
+    struct timeval timeout = {0, kReplayPollInterval * 1000};
+    uint64_t       now     = GetMonotonicNowUs();
+    int            maxFd   = -1;
+    int            ready   = 0;
+
+    if (aUntil > now && aUntil - now < static_cast<uint64_t>(timeout.tv_usec))
+    {
+        timeout.tv_usec = static_cast<suseconds_t>(aUntil - now);
+    }
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+
+    for (size_t i = 0; i < aSessions.size(); ++i)
+    {
+        aSessions[i]->mClient->UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
+    }
+
+    if (select(maxFd + 1, &readFdSet, &writeFdSet, &errorFdSet, &timeout) < 0)
+    {
+        /* nothing is ready, the sessions only process their timers */
+        FD_ZERO(&readFdSet);
+        FD_ZERO(&writeFdSet);
+        FD_ZERO(&errorFdSet);
+    }
+
+    now = GetMonotonicNowUs();
+
+    for (size_t i = 0; i < aSessions.size(); ++i)
+    {
+        ReplaySession &session = *aSessions[i];
+
+        session.mClient->Process(readFdSet, writeFdSet, errorFdSet);
+        ReplayProcessTimeouts(session, now);
+
+        if (session.mClient->GetState() == Dtls::Session::kStateReady)
+        {
+            ready++;
+        }
+    }
+
+    return ready;
+}
+
+/** we print this in a way scripts can easily parse */
+static void ReplayPrintReport(ReplayStats &aStats, size_t aSessions, uint64_t aElapsed, uint64_t aTraceTime)
+{
+    fprintf(stdout, "replay-duration-s: %.1f\n", aElapsed / 1000000.0);
+    fprintf(stdout, "trace-duration-s: %.1f\n", aTraceTime / 1000000.0);
+    fprintf(stdout, "trace-frames: commissioner=%lu other=%lu skipped=%lu\n", aStats.mCommissionerFrames,
+            aStats.mOtherFrames, aStats.mSkipped);
+    fprintf(stdout, "commissioners: started=%lu handshake-failures=%d\n", static_cast<unsigned long>(aSessions),
+            aStats.mHandshakeFailures);
+    fprintf(stdout, "requests: sent=%lu errors=%lu dropped=%lu responses=%lu unmatched=%lu timeouts=%lu\n",
+            aStats.mSent, aStats.mSendErrors, aStats.mDropped, aStats.mResponses, aStats.mUnmatched,
+            aStats.mTimeouts);
+    CommissionerUtilsPrintLatency("latency", aStats.mLatencies);
+
+    for (std::map<std::string, std::vector<uint64_t> >::iterator it = aStats.mPathLatencies.begin();
+         it != aStats.mPathLatencies.end(); ++it)
+    {
+        std::string name = "latency-" + (it->first.empty() ? std::string("none") : it->first);
+
+        CommissionerUtilsPrintLatency(name.c_str(), it->second);
+    }
+}
+
+/** see: commissioner.hpp, replays the commissioner requests of a trace */
+int CommissionerReplay(Context &aContext)
+{
+    PacketTrace::Reader          reader;
+    ReplayStats                  stats;
+    std::vector<ReplaySession *> sessions;
+    std::vector<ReplayFrame>     frames;
+    uint64_t                     deadline;
+    uint64_t                     start;
+    uint64_t                     traceTime;
+    size_t                       next = 0;
+    int                          ret  = EXIT_FAILURE;
+
+    if (aContext.mAgent.mAddress_ascii[0] == 0 || aContext.mAgent.mPort_ascii[0] == 0)
+    {
+        CommissionerUtilsFail("Missing AGENT ip address or port\n");
+    }
+
+    if (!CommissionerComputePskc(aContext))
+    {
+        CommissionerUtilsFail("Cannot compute PSKc (commissioning shared key)\n");
+    }
+
+    if (reader.Open(aContext.mReplay.mTrace) != OTBR_ERROR_NONE)
+    {
+        CommissionerUtilsFail("Cannot read trace %s: %s\n", aContext.mReplay.mTrace, strerror(errno));
+    }
+
+    ReplayLoad(reader, sessions, frames, stats);
+
+    if (frames.empty())
+    {
+        CommissionerUtilsFail("No commissioner request to replay in %s\n", aContext.mReplay.mTrace);
+    }
+
+    traceTime = frames.back().mTime - frames.front().mTime;
+    deadline  = GetMonotonicNowUs() + aContext.mEnvelopeTimeout * 1000000ULL;
+
+    otbrLog(OTBR_LOG_INFO, "replay: commissioners=%lu frames=%lu", static_cast<unsigned long>(sessions.size()),
+            static_cast<unsigned long>(frames.size()));
+
+    /* all sessions are established before the first frame, so handshakes do not delay the recorded pace */
+    for (size_t i = 0; i < sessions.size(); ++i)
+    {
+        ReplaySession &session = *sessions[i];
+
+        session.mStats  = &stats;
+        session.mClient = Dtls::Client::Create(NULL, &session);
+        session.mClient->SetDataHandler(ReplayHandleData, &session);
+
+        if (session.mClient->SetPSK(aContext.mAgent.mPSKc.bin, OT_PSKC_LENGTH) != OTBR_ERROR_NONE ||
+            session.mClient->Connect(aContext.mAgent.mAddress_ascii, aContext.mAgent.mPort_ascii) != OTBR_ERROR_NONE)
+        {
+            otbrLog(OTBR_LOG_ERR, "replay: cannot start session");
+        }
+    }
+
+    for (bool handshaking = true; handshaking && GetMonotonicNowUs() < deadline;)
+    {
+        ReplayPoll(sessions, deadline);
+        handshaking = false;
+
+        for (size_t i = 0; i < sessions.size(); ++i)
+        {
+            handshaking = handshaking || sessions[i]->mClient->GetState() == Dtls::Session::kStateHandshaking;
+        }
+    }
+
+    for (size_t i = 0; i < sessions.size(); ++i)
+    {
+        if (sessions[i]->mClient->GetState() != Dtls::Session::kStateReady)
+        {
+            stats.mHandshakeFailures++;
+        }
+    }
+
+    start = GetMonotonicNowUs();
+
+    while (GetMonotonicNowUs() < deadline)
+    {
+        uint64_t now     = GetMonotonicNowUs();
+        uint64_t due     = deadline;
+        bool     pending = false;
+
+        for (; next < frames.size(); ++next)
+        {
+            uint64_t offset = frames[next].mTime - frames.front().mTime;
+
+            due = start + (aContext.mReplay.mSpeed > 0 ? offset / aContext.mReplay.mSpeed : 0);
+
+            if (due > now)
+            {
+                break;
+            }
+
+            ReplaySend(frames[next]);
+        }
+
+        for (size_t i = 0; i < sessions.size() && !pending; ++i)
+        {
+            pending = !sessions[i]->mPending.empty();
+        }
+
+        if (next == frames.size() && !pending)
+        {
+            break;
+        }
+
+        if (ReplayPoll(sessions, due) == 0)
+        {
+            /* no session is left, the frames not yet due are dropped */
+            stats.mDropped += frames.size() - next;
+            break;
+        }
+    }
+
+    ReplayPrintReport(stats, sessions.size(), GetMonotonicNowUs() - start, traceTime);
+
+    if (stats.mSent > 0 && stats.mDropped == 0 && stats.mHandshakeFailures == 0)
+    {
+        ret = EXIT_SUCCESS;
+    }
+
+    for (size_t i = 0; i < sessions.size(); ++i)
+    {
+        sessions[i]->mClient->Close();
+        Dtls::Client::Destroy(sessions[i]->mClient);
+        delete sessions[i];
+    }
+
+    return ret;
+}
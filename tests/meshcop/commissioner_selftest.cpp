@@ -50,7 +50,7 @@ static void test_pskc()
         CommissionerUtilsFail("cannot convert xpanid\n");
     }
 
-    CommissionerComputePskc();
+    CommissionerComputePskc(gContext);
 
     static const uint8_t expected[] = {0xc3, 0xf5, 0x93, 0x68, 0x44, 0x5a, 0x1b, 0x61,
                                        0x06, 0xbe, 0x42, 0x0a, 0x70, 0x6d, 0x4c, 0xc9};
@@ -72,12 +72,12 @@ static void test_steering(void)
     gContext.mJoiner.mSteeringData.SetLength(15);
 
     strcpy(gContext.mJoiner.mEui64.ascii, "18b4300000000002");
-    ok = CommissionerComputeHashMac();
+    ok = CommissionerComputeHashMac(gContext);
     if (!ok)
     {
         CommissionerUtilsFail("invalid hashmac\n");
     }
-    ok = CommissionerComputeSteering();
+    ok = CommissionerComputeSteering(gContext);
     if (!ok)
     {
         CommissionerUtilsFail("Cannot compute steering\n");
@@ -31,6 +31,8 @@
  *   Misc functions used by commissioning test app
  */
 
+#include <algorithm>
+
 #include "commissioner.hpp"
 
 /** return a hex string to print for logging */
@@ -47,6 +49,76 @@ const char *CommissionerUtilsHexString(const uint8_t *pBytes, int n)
     return buf;
 }
 
+/** check a joiner PSKd, the joining device credential */
+const char *CommissionerUtilsCheckPskd(const char *aPSKd)
+{
+    const char *whybad;
+    int         ch;
+    int         len, x;
+
+    /* assume not bad */
+    whybad = NULL;
+
+    /*
+     * Problem: Should we "base32" decode this per the specification?
+     * Answer: No - because this needs to be identical to the CLI application
+     * The CLI appication does *NOT* decode preshared key
+     * thus we do not decode the base32 value here
+     * We do however enforce the data..
+     */
+
+    /*
+     * Joining Device Credential
+     * Specification 1.1.1, Section 8.2 Table 8-1
+     * Min Length 6, Max Length 32.
+     *
+     * Digits 0-9, Upper case only Letters A-Z
+     * excluding: I,O,Q,Z
+     *
+     * Note: 26 letters - 4 illegals = 22 letters.
+     * Thus 10 digits + 22 letters = 32 symbols.
+     * Thus, "base32" encoding using the above.
+     */
+    len = strlen(aPSKd);
+    if ((len < 6) || (len > 32))
+    {
+        whybad = "invalid length (range: 6..32)";
+    }
+    else
+    {
+        for (x = 0; x < len; x++)
+        {
+            ch = aPSKd[x];
+
+            switch (ch)
+            {
+            case 'Z':
+            case 'I':
+            case 'O':
+            case 'Q':
+                whybad = "Letters I, O, Q and Z are not allowed";
+                break;
+            default:
+                if (isupper(ch) || isdigit(ch))
+                {
+                    /* all is well */
+                }
+                else
+                {
+                    whybad = "contains non-uppercase or non-digit";
+                }
+                break;
+            }
+            if (whybad)
+            {
+                break;
+            }
+        }
+    }
+
+    return whybad;
+}
+
 /* die and exit */
 void CommissionerUtilsFail(const char *fmt, ...)
 {
@@ -63,3 +135,21 @@ void CommissionerUtilsFail(const char *fmt, ...)
 
     exit(EXIT_FAILURE);
 }
+
+/** print latency percentiles in milliseconds of samples in microseconds, sorting them */
+void CommissionerUtilsPrintLatency(const char *aName, std::vector<uint64_t> &aSamples)
+{
+    size_t count = aSamples.size();
+
+    if (count == 0)
+    {
+        fprintf(stdout, "%s-ms: count=0\n", aName);
+        return;
+    }
+
+    std::sort(aSamples.begin(), aSamples.end());
+    fprintf(stdout, "%s-ms: count=%lu p50=%.1f p90=%.1f p99=%.1f max=%.1f\n", aName,
+            static_cast<unsigned long>(count), aSamples[(count - 1) * 50 / 100] / 1000.0,
+            aSamples[(count - 1) * 90 / 100] / 1000.0, aSamples[(count - 1) * 99 / 100] / 1000.0,
+            aSamples[count - 1] / 1000.0);
+}
@@ -0,0 +1,240 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "agent/admin_server.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/reactor.hpp"
+
+using namespace ot::BorderRouter;
+
+static otbrError HandleEcho(void *aContext, const char *aArgs, std::string &aOutput)
+{
+    ++*static_cast<int *>(aContext);
+    AdminServer::Print(aOutput, "echo %s\n", aArgs);
+
+    return aArgs[0] != '\0' ? OTBR_ERROR_NONE : OTBR_ERROR_ERRNO;
+}
+
+static void PollReactor(Reactor &aReactor)
+{
+    fd_set  readFdSet;
+    fd_set  writeFdSet;
+    fd_set  errorFdSet;
+    timeval timeout = {0, 10000};
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+    aReactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout);
+}
+
+static int Connect(const char *aPath)
+{
+    int         fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un sun;
+
+    memset(&sun, 0, sizeof(sun));
+    sun.sun_family = AF_UNIX;
+    strcpy(sun.sun_path, aPath);
+    CHECK_EQUAL(0, connect(fd, reinterpret_cast<sockaddr *>(&sun), sizeof(sun)));
+
+    return fd;
+}
+
+// Polls the reactor until @p aLength bytes are received by @p aFd.
+static std::string Receive(Reactor &aReactor, int aFd, size_t aLength)
+{
+    std::string received;
+    char        buffer[256];
+
+    for (int i = 0; i < 10 && received.size() < aLength; ++i)
+    {
+        ssize_t rval;
+
+        PollReactor(aReactor);
+
+        while ((rval = recv(aFd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0)
+        {
+            received.append(buffer, static_cast<size_t>(rval));
+        }
+    }
+
+    return received;
+}
+
+TEST_GROUP(AdminServer){};
+
+TEST(AdminServer, TestTextCommands)
+{
+    Reactor     reactor;
+    AdminServer server(reactor);
+    int         calls = 0;
+    char        path[64];
+    int         fd;
+    std::string expected;
+
+    snprintf(path, sizeof(path), "/tmp/otbr-admin-test-%d.sock", static_cast<int>(getpid()));
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, server.AddCommand("echo", "Echo the arguments", HandleEcho, &calls));
+    CHECK_EQUAL(OTBR_ERROR_NONE, server.Start(path));
+
+    fd = Connect(path);
+
+    // Several requests in one write, with a trailing partial one.
+    static const char kRequests[] = "echo hello  world\r\n  echo\nbogus\nech";
+    CHECK_EQUAL(static_cast<ssize_t>(sizeof(kRequests) - 1), send(fd, kRequests, sizeof(kRequests) - 1, 0));
+
+    expected = "echo hello  world\n\nerror: echo \n\nerror: unknown command bogus, try help\n\n";
+    CHECK_EQUAL(expected, Receive(reactor, fd, expected.size()));
+    CHECK_EQUAL(2, calls);
+
+    // The partial request completes.
+    CHECK_EQUAL(4, send(fd, "o x\n", 4, 0));
+    expected = "echo x\n\n";
+    CHECK_EQUAL(expected, Receive(reactor, fd, expected.size()));
+
+    close(fd);
+    server.Stop();
+
+    // The socket file is removed once stopped.
+    CHECK_EQUAL(-1, access(path, F_OK));
+}
+
+TEST(AdminServer, TestBinaryFrames)
+{
+    Reactor     reactor;
+    AdminServer server(reactor);
+    int         calls = 0;
+    char        path[64];
+    int         fd;
+    std::string received;
+
+    snprintf(path, sizeof(path), "/tmp/otbr-admin-test-%d.sock", static_cast<int>(getpid()));
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, server.AddCommand("echo", "Echo the arguments", HandleEcho, &calls));
+    CHECK_EQUAL(OTBR_ERROR_NONE, server.Start(path));
+
+    fd = Connect(path);
+    CHECK_EQUAL(19, send(fd, "binary\necho abc\nech", 19, 0));
+    CHECK_EQUAL(3, send(fd, "o\n\n", 3, 0));
+
+    // The acknowledgment, a successful response and a failed one, each framed by status and length.
+    received = Receive(reactor, fd, 5 + 5 + 9 + 5 + 6);
+    CHECK_EQUAL(std::string("\0\0\0\0\0", 5) + std::string("\0\0\0\0\11echo abc\n", 14) +
+                    std::string("\1\0\0\0\6echo \n", 11),
+                received);
+
+    // An empty line is not a command.
+    CHECK_EQUAL(2, calls);
+
+    close(fd);
+}
+
+TEST(AdminServer, TestMetrics)
+{
+    static Metrics::Counter sRequests("admin_test.requests");
+    static Metrics::Gauge   sSessions("admin_test.sessions");
+    Reactor                 reactor;
+    AdminServer             server(reactor);
+    char                    path[64];
+    int                     fd;
+    std::string             expected;
+
+    snprintf(path, sizeof(path), "/tmp/otbr-admin-test-%d.sock", static_cast<int>(getpid()));
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, server.Start(path));
+
+    sRequests.Add(3);
+    sSessions.Add(-2);
+
+    // Only the metrics of the prefix are printed, the last registered first.
+    fd = Connect(path);
+    CHECK_EQUAL(19, send(fd, "metrics admin_test\n", 19, 0));
+    expected = "admin_test.sessions -2\nadmin_test.requests 3\n\n";
+    CHECK_EQUAL(expected, Receive(reactor, fd, expected.size()));
+
+    close(fd);
+}
+
+TEST(AdminServer, TestLogLevels)
+{
+    Reactor     reactor;
+    AdminServer server(reactor);
+    char        path[64];
+    int         fd;
+    std::string expected;
+    std::string received;
+
+    snprintf(path, sizeof(path), "/tmp/otbr-admin-test-%d.sock", static_cast<int>(getpid()));
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, server.Start(path));
+    otbrLogSetLevel(OTBR_LOG_INFO);
+
+    fd = Connect(path);
+    CHECK_EQUAL(15, send(fd, "log dtls debug\n", 15, 0));
+    expected = "\n";
+    CHECK_EQUAL(expected, Receive(reactor, fd, expected.size()));
+    CHECK_EQUAL(OTBR_LOG_DEBUG, otbrLogGetModuleLevel(OTBR_LOG_MODULE_DTLS));
+    CHECK_EQUAL(OTBR_LOG_INFO, otbrLogGetModuleLevel(OTBR_LOG_MODULE_COAP));
+
+    CHECK_EQUAL(4, send(fd, "log\n", 4, 0));
+    received = Receive(reactor, fd, 1024);
+    CHECK(received.find("all          info\n") == 0);
+    CHECK(received.find("\ncoap         info (global)\n") != std::string::npos);
+    CHECK(received.find("\ndtls         debug\n") != std::string::npos);
+
+    CHECK_EQUAL(33, send(fd, "log mdns 9\nlog bogus 3\nlog all 4\n", 33, 0));
+    expected = "error: invalid level 9\n\nerror: unknown module bogus\n\n\n";
+    CHECK_EQUAL(expected, Receive(reactor, fd, expected.size()));
+    CHECK_EQUAL(OTBR_LOG_WARNING, otbrLogGetModuleLevel(OTBR_LOG_MODULE_COAP));
+    CHECK_EQUAL(OTBR_LOG_DEBUG, otbrLogGetModuleLevel(OTBR_LOG_MODULE_DTLS));
+
+    CHECK_EQUAL(16, send(fd, "log dtls global\n", 16, 0));
+    expected = "\n";
+    CHECK_EQUAL(expected, Receive(reactor, fd, expected.size()));
+    CHECK_EQUAL(OTBR_LOG_WARNING, otbrLogGetModuleLevel(OTBR_LOG_MODULE_DTLS));
+
+    otbrLogSetLevel(OTBR_LOG_INFO);
+    close(fd);
+}
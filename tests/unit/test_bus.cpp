@@ -0,0 +1,104 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+
+#include "common/bus_libdbus.hpp"
+
+using namespace ot::BorderRouter::Bus;
+
+TEST_GROUP(Bus){};
+
+TEST(Bus, TestLibdbusReader)
+{
+    DBusMessage *   message = dbus_message_new_method_call("org.example", "/org/example", "org.example", "Test");
+    DBusMessageIter iter;
+    DBusMessageIter arrayIter;
+    DBusMessageIter variantIter;
+    const uint8_t   kBytes[] = {1, 2, 3};
+    const uint8_t * bytes    = kBytes;
+    const char *    kKey     = "key";
+    int32_t         status   = 7;
+    uint16_t        port     = 0;
+    const char *    string   = NULL;
+    const uint8_t * read     = NULL;
+    size_t          length   = 0;
+    LibdbusReader   reader;
+
+    CHECK(message != NULL);
+    dbus_message_iter_init_append(message, &iter);
+    CHECK(dbus_message_iter_append_basic(&iter, DBUS_TYPE_INT32, &status));
+    CHECK(dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &kKey));
+    CHECK(dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE_AS_STRING, &arrayIter));
+    CHECK(dbus_message_iter_append_fixed_array(&arrayIter, DBUS_TYPE_BYTE, &bytes, sizeof(kBytes)));
+    CHECK(dbus_message_iter_close_container(&iter, &arrayIter));
+    CHECK(dbus_message_iter_open_container(&iter, DBUS_TYPE_VARIANT, DBUS_TYPE_UINT16_AS_STRING, &variantIter));
+    port = 61631;
+    CHECK(dbus_message_iter_append_basic(&variantIter, DBUS_TYPE_UINT16, &port));
+    CHECK(dbus_message_iter_close_container(&iter, &variantIter));
+
+    CHECK(reader.Init(*message));
+
+    // Values are only read as their own type.
+    status = 0;
+    CHECK(!reader.ReadBasic(kTypeUint32, &status));
+    CHECK(reader.ReadBasic(kTypeInt32, &status));
+    CHECK_EQUAL(7, status);
+    CHECK(reader.ReadBasic(kTypeString, &string));
+    STRCMP_EQUAL("key", string);
+
+    // The bytes are read in place.
+    CHECK_EQUAL(kTypeArray, reader.GetType());
+    CHECK_EQUAL(kTypeByte, reader.GetElementType());
+    CHECK(reader.ReadBytes(read, length));
+    CHECK_EQUAL(sizeof(kBytes), length);
+    CHECK(memcmp(read, kBytes, length) == 0);
+
+    CHECK_EQUAL(kTypeVariant, reader.GetType());
+    CHECK(!reader.Leave());
+    CHECK(reader.Enter());
+    port = 0;
+    CHECK(reader.ReadBasic(kTypeUint16, &port));
+    CHECK_EQUAL(61631, port);
+    CHECK_EQUAL(kTypeInvalid, reader.GetType());
+    CHECK(reader.Leave());
+
+    CHECK_EQUAL(kTypeInvalid, reader.GetType());
+    CHECK(!reader.Skip());
+
+    // Containers left early are skipped as a whole.
+    CHECK(reader.Init(*message));
+    CHECK(reader.Skip());
+    CHECK(reader.Skip());
+    CHECK(reader.Enter());
+    CHECK(reader.Leave());
+    CHECK_EQUAL(kTypeVariant, reader.GetType());
+
+    dbus_message_unref(message);
+}
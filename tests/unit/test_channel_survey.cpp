@@ -0,0 +1,116 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include "agent/channel_survey.hpp"
+#include "common/tlv.hpp"
+
+using namespace ot;
+using namespace ot::BorderRouter;
+
+TEST_GROUP(ChannelSurvey){};
+
+TEST(ChannelSurvey, TestEnergyReport)
+{
+    static const uint8_t kReport[]  = {Meshcop::kChannelMask, 6, 0,    4,    0x00, 0x18, 0x00, 0x00, // 11 and 12
+                                      Meshcop::kEnergyList,  4, 0xce, 0xa1, 0xd3, 0x88};            // Two scans
+    static const uint8_t kInvalid[] = {Meshcop::kChannelMask, 6, 0,    4,    0x00, 0x18, 0x00, 0x00,
+                                       Meshcop::kEnergyList,  3, 0xce, 0xa1, 0xd3};
+    ChannelSurvey                       survey;
+    const ChannelSurvey::ChannelEnergy *energy;
+
+    CHECK(survey.GetEnergy(10) == NULL);
+    CHECK(survey.GetEnergy(27) == NULL);
+    CHECK_EQUAL(0, survey.GetEnergy(11)->mSamples);
+
+    CHECK(survey.AddEnergyReport(kReport, sizeof(kReport)));
+
+    energy = survey.GetEnergy(11);
+    CHECK_EQUAL(2, energy->mSamples);
+    CHECK_EQUAL(-45, energy->mMax);
+    CHECK_EQUAL(-45, energy->mLast);
+    CHECK_EQUAL(2, energy->mBuckets[6]);
+
+    energy = survey.GetEnergy(12);
+    CHECK_EQUAL(2, energy->mSamples);
+    CHECK_EQUAL(-95, energy->mMax);
+    CHECK_EQUAL(-120, energy->mLast);
+    CHECK_EQUAL(1, energy->mBuckets[0]);
+    CHECK_EQUAL(1, energy->mBuckets[1]);
+
+    CHECK_EQUAL(0, survey.GetEnergy(13)->mSamples);
+
+    // The energy list does not match the channels.
+    CHECK(!survey.AddEnergyReport(kInvalid, sizeof(kInvalid)));
+    CHECK(!survey.AddEnergyReport(kReport, 8));
+    CHECK_EQUAL(2, survey.GetEnergy(11)->mSamples);
+
+    survey.Clear();
+    CHECK_EQUAL(0, survey.GetEnergy(11)->mSamples);
+}
+
+TEST(ChannelSurvey, TestPanIdConflict)
+{
+    uint8_t report[] = {Meshcop::kPanId, 2, 0xfa, 0xce, Meshcop::kChannelMask, 6, 0, 4, 0x00, 0x10, 0x00, 0x00};
+    ChannelSurvey                       survey;
+    const ChannelSurvey::PanIdConflict *conflicts;
+    uint8_t                             count;
+
+    CHECK(survey.AddPanIdConflict(report, sizeof(report), 0x0400));
+
+    // Channels of the same PAN ID are merged.
+    report[9] = 0x08;
+    CHECK(survey.AddPanIdConflict(report, sizeof(report), 0x0800));
+
+    conflicts = survey.GetConflicts(count);
+    CHECK_EQUAL(1, count);
+    CHECK_EQUAL(0xface, conflicts[0].mPanId);
+    CHECK_EQUAL((1U << 11) | (1U << 12), conflicts[0].mChannelMask);
+    CHECK_EQUAL(0x0800, conflicts[0].mReporter);
+    CHECK_EQUAL(2, conflicts[0].mReports);
+
+    // The least recently reported PAN ID is replaced once full.
+    for (uint16_t i = 1; i <= ChannelSurvey::kMaxConflicts; ++i)
+    {
+        report[2] = static_cast<uint8_t>(i >> 8);
+        report[3] = static_cast<uint8_t>(i);
+        CHECK(survey.AddPanIdConflict(report, sizeof(report), 0x0400));
+    }
+
+    conflicts = survey.GetConflicts(count);
+    CHECK_EQUAL(ChannelSurvey::kMaxConflicts, count);
+
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        CHECK(conflicts[i].mPanId != 0xface);
+    }
+
+    // No channel mask.
+    CHECK(!survey.AddPanIdConflict(report, 4, 0x0400));
+}
@@ -167,3 +167,359 @@ TEST(Coap, TestRequest)
 
     Coap::Agent::Destroy(agent);
 }
+
+TEST(Coap, TestMessagePool)
+{
+    Coap::Message *messages[32];
+    Coap::Message *message;
+    uint16_t       token = htons(1);
+    uint8_t        tokenLength;
+    uint16_t       length;
+
+    agent = Coap::Agent::Create(NULL, NULL);
+
+    message = agent->NewMessage(Coap::kTypeNonConfirmable, Coap::kCodePost, reinterpret_cast<const uint8_t *>(&token),
+                                sizeof(token));
+    message->SetPath("cool");
+    message->SetPayload(reinterpret_cast<const uint8_t *>("hot"), 3);
+    agent->FreeMessage(message);
+
+    // A reused message should not carry anything of the previous one.
+    message = agent->NewMessage(Coap::kTypeConfirmable, Coap::kCodeGet, NULL, 0);
+    CHECK_EQUAL(Coap::kTypeConfirmable, message->GetType());
+    CHECK_EQUAL(Coap::kCodeGet, message->GetCode());
+    message->GetToken(tokenLength);
+    CHECK_EQUAL(0, tokenLength);
+    CHECK(message->GetPayload(length) == NULL);
+    agent->FreeMessage(message);
+    CHECK_EQUAL(0, agent->GetMessagePoolMisses());
+
+    // Messages beyond the pool are still available.
+    for (size_t i = 0; i < sizeof(messages) / sizeof(messages[0]); ++i)
+    {
+        messages[i] = agent->NewMessage(Coap::kTypeNonConfirmable, Coap::kCodePost, NULL, 0);
+        CHECK(messages[i] != NULL);
+    }
+
+    CHECK(agent->GetMessagePoolMisses() > 0);
+
+    for (size_t i = 0; i < sizeof(messages) / sizeof(messages[0]); ++i)
+    {
+        agent->FreeMessage(messages[i]);
+    }
+
+    Coap::Agent::Destroy(agent);
+}
+
+TEST(Coap, TestScopedMessage)
+{
+    agent = Coap::Agent::Create(NULL, NULL);
+
+    // Each scoped message returns to the pool when its scope ends.
+    for (int i = 0; i < 64; ++i)
+    {
+        Coap::ScopedMessage message(*agent, Coap::kTypeNonConfirmable, Coap::kCodePost, NULL, 0);
+
+        CHECK(message.Get() != NULL);
+        message->SetPath("cool");
+        CHECK_EQUAL(Coap::kCodePost, message->GetCode());
+    }
+
+    CHECK_EQUAL(0, agent->GetMessagePoolMisses());
+
+    Coap::Agent::Destroy(agent);
+}
+
+struct ForwardContext
+{
+    Coap::Agent *mForwarder;
+    uint8_t      mBuffer[128];
+    uint16_t     mLength;
+};
+
+void TestForwardHandler(const Coap::Resource &aResource,
+                        const Coap::Message & aRequest,
+                        Coap::Message &       aResponse,
+                        const uint8_t *       aIp6,
+                        uint16_t              aPort,
+                        void *                aContext)
+{
+    ForwardContext &context = *static_cast<ForwardContext *>(aContext);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, context.mForwarder->Forward(aRequest, NULL, 0));
+
+    (void)aResource;
+    (void)aResponse;
+    (void)aIp6;
+    (void)aPort;
+}
+
+ssize_t TestCaptureSender(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort, void *aContext)
+{
+    ForwardContext &context = *static_cast<ForwardContext *>(aContext);
+
+    CHECK(aLength <= sizeof(context.mBuffer));
+    memcpy(context.mBuffer, aBuffer, aLength);
+    context.mLength = aLength;
+
+    (void)aIp6;
+    (void)aPort;
+    return static_cast<ssize_t>(aLength);
+}
+
+TEST(Coap, TestForward)
+{
+    ForwardContext received;
+    ForwardContext forwarded;
+    Coap::Resource resource("c/rx", TestForwardHandler, &received);
+    uint16_t       token = htons(1);
+    Coap::Agent *  forwarder;
+    uint8_t        request[128];
+    uint16_t       length;
+
+    agent               = Coap::Agent::Create(TestCaptureSender, &received);
+    forwarder           = Coap::Agent::Create(TestCaptureSender, &forwarded);
+    received.mForwarder = forwarder;
+    received.mLength    = 0;
+    forwarded.mLength   = 0;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, agent->AddResource(resource));
+
+    {
+        Coap::ScopedMessage message(*agent, Coap::kTypeConfirmable, Coap::kCodePost,
+                                    reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+
+        message->SetPath("c/rx");
+        message->SetPayload(reinterpret_cast<const uint8_t *>("hot"), 3);
+        agent->Send(*message, NULL, 0, NULL, NULL);
+    }
+
+    // The receiving agent sends its acknowledgment into the same buffer, so keep the request.
+    CHECK(received.mLength > 0);
+    length = received.mLength;
+    memcpy(request, received.mBuffer, length);
+    agent->Input(request, length, NULL, 0);
+
+    // Only the type and message id differ from the received message.
+    CHECK_EQUAL(length, forwarded.mLength);
+    CHECK_EQUAL(Coap::kTypeNonConfirmable, (forwarded.mBuffer[0] >> 4) & 0x3);
+    CHECK_EQUAL(request[0] & 0xcf, forwarded.mBuffer[0] & 0xcf);
+    CHECK_EQUAL(request[1], forwarded.mBuffer[1]);
+    CHECK_EQUAL(0, memcmp(request + 4, forwarded.mBuffer + 4, length - 4));
+
+    Coap::Agent::Destroy(forwarder);
+    Coap::Agent::Destroy(agent);
+}
+
+TEST(Coap, TestTransactionLimit)
+{
+    ForwardContext context;
+    uint8_t        response[128];
+    uint16_t       length = 0;
+
+    agent           = Coap::Agent::Create(TestCaptureSender, &context);
+    context.mLength = 0;
+    agent->SetMaxTransactions(2);
+
+    for (uint16_t i = 0; i < 3; ++i)
+    {
+        uint16_t            token = htons(i + 1);
+        Coap::ScopedMessage message(*agent, Coap::kTypeConfirmable, Coap::kCodePost,
+                                    reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+
+        message->SetPath("c/lp");
+
+        if (i < 2)
+        {
+            CHECK_EQUAL(OTBR_ERROR_NONE, agent->Send(*message, NULL, 0, NULL, NULL));
+        }
+        else
+        {
+            // Beyond the limit.
+            CHECK_EQUAL(OTBR_ERROR_ERRNO, agent->Send(*message, NULL, 0, NULL, NULL));
+            CHECK_EQUAL(ENOBUFS, errno);
+        }
+
+        if (i == 0)
+        {
+            length = context.mLength;
+            memcpy(response, context.mBuffer, length);
+        }
+    }
+
+    CHECK_EQUAL(2, agent->GetTransactionCount("c/lp"));
+    CHECK_EQUAL(0, agent->GetTransactionCount("c/la"));
+    CHECK_EQUAL(2, agent->GetTransactionCount(NULL));
+
+    // Acknowledge the first request with a piggybacked 2.04 Changed.
+    response[0] = static_cast<uint8_t>((response[0] & 0xcf) | (Coap::kTypeAcknowledgment << 4));
+    response[1] = Coap::kCodeChanged;
+    agent->Input(response, length, NULL, 0);
+    CHECK_EQUAL(1, agent->GetTransactionCount("c/lp"));
+
+    Coap::Agent::Destroy(agent);
+}
+
+struct BlockContext
+{
+    ForwardContext mCapture;
+    uint32_t       mBlock2;
+    uint32_t       mBlock1;
+    bool           mHasSize1;
+};
+
+void TestBlockHandler(const Coap::Resource &aResource,
+                      const Coap::Message & aRequest,
+                      Coap::Message &       aResponse,
+                      const uint8_t *       aIp6,
+                      uint16_t              aPort,
+                      void *                aContext)
+{
+    BlockContext &context = *static_cast<BlockContext *>(aContext);
+    uint32_t      size1;
+
+    CHECK(aRequest.GetUintOption(Coap::kOptionBlock2, context.mBlock2));
+    CHECK(aRequest.GetUintOption(Coap::kOptionBlock1, context.mBlock1));
+    context.mHasSize1 = aRequest.GetUintOption(Coap::kOptionSize1, size1);
+
+    (void)aResource;
+    (void)aResponse;
+    (void)aIp6;
+    (void)aPort;
+}
+
+TEST(Coap, TestBlockOptions)
+{
+    BlockContext   context;
+    Coap::Resource resource("c/ag", TestBlockHandler, &context);
+    uint8_t        request[128];
+    uint16_t       length;
+
+    agent                    = Coap::Agent::Create(TestCaptureSender, &context.mCapture);
+    context.mCapture.mLength = 0;
+    context.mBlock1          = 0;
+    context.mBlock2          = 0;
+    context.mHasSize1        = true;
+    CHECK_EQUAL(OTBR_ERROR_NONE, agent->AddResource(resource));
+
+    {
+        Coap::ScopedMessage message(*agent, Coap::kTypeNonConfirmable, Coap::kCodePost, NULL, 0);
+
+        // Block 1 of 64 bytes with more to come, and zero which is encoded without value.
+        message->SetPath("c/ag");
+        message->AddUintOption(Coap::kOptionBlock2, 0x1a);
+        message->AddUintOption(Coap::kOptionBlock1, 0);
+        message->SetPayload(reinterpret_cast<const uint8_t *>("hot"), 3);
+        agent->Send(*message, NULL, 0, NULL, NULL);
+    }
+
+    length = context.mCapture.mLength;
+    memcpy(request, context.mCapture.mBuffer, length);
+    agent->Input(request, length, NULL, 0);
+
+    CHECK_EQUAL(0x1a, context.mBlock2);
+    CHECK_EQUAL(0, context.mBlock1);
+    CHECK_EQUAL(false, context.mHasSize1);
+
+    Coap::Agent::Destroy(agent);
+}
+
+TEST(Coap, TestFuture)
+{
+    ForwardContext context;
+    Coap::Future   future;
+    uint8_t        response[128];
+    uint16_t       length;
+    uint16_t       payloadLength;
+    const uint8_t *payload;
+
+    agent           = Coap::Agent::Create(TestCaptureSender, &context);
+    context.mLength = 0;
+    CHECK_EQUAL(Coap::Future::kStateIdle, future.GetState());
+
+    {
+        uint16_t            token = htons(1);
+        Coap::ScopedMessage message(*agent, Coap::kTypeConfirmable, Coap::kCodePost,
+                                    reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+
+        message->SetPath("c/cp");
+        message->SetPayload(reinterpret_cast<const uint8_t *>("pet"), 3);
+        CHECK_EQUAL(OTBR_ERROR_NONE, future.Send(*agent, *message, 1000));
+    }
+
+    CHECK_EQUAL(Coap::Future::kStatePending, future.GetState());
+    CHECK_EQUAL(Coap::Future::kStatePending, future.Poll(future.GetDeadline() - 1));
+
+    // Acknowledge the request with a piggybacked 2.04 Changed echoing its payload.
+    length = context.mLength;
+    memcpy(response, context.mBuffer, length);
+    response[0] = static_cast<uint8_t>((response[0] & 0xcf) | (Coap::kTypeAcknowledgment << 4));
+    response[1] = Coap::kCodeChanged;
+    agent->Input(response, length, NULL, 0);
+
+    CHECK_EQUAL(Coap::Future::kStateReady, future.Poll(future.GetDeadline()));
+    CHECK_EQUAL(Coap::kCodeChanged, future.GetCode());
+    payload = future.GetPayload(payloadLength);
+    CHECK_EQUAL(3, payloadLength);
+    CHECK_EQUAL(0, memcmp(payload, "pet", 3));
+
+    // A future sent again ignores the response to its previous request. A sent confirmable message may be owned by
+    // the engine, so each request is a message of its own.
+    {
+        uint16_t            token = htons(2);
+        Coap::ScopedMessage message(*agent, Coap::kTypeConfirmable, Coap::kCodePost,
+                                    reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+
+        message->SetPath("c/ca");
+        CHECK_EQUAL(OTBR_ERROR_NONE, future.Send(*agent, *message, 1000));
+        length = context.mLength;
+        memcpy(response, context.mBuffer, length);
+        future.Reset();
+    }
+
+    {
+        uint16_t            token = htons(3);
+        Coap::ScopedMessage message(*agent, Coap::kTypeConfirmable, Coap::kCodePost,
+                                    reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+
+        message->SetPath("c/ca");
+        CHECK_EQUAL(OTBR_ERROR_NONE, future.Send(*agent, *message, 1000));
+    }
+
+    response[0] = static_cast<uint8_t>((response[0] & 0xcf) | (Coap::kTypeAcknowledgment << 4));
+    response[1] = Coap::kCodeChanged;
+    agent->Input(response, length, NULL, 0);
+    CHECK_EQUAL(Coap::Future::kStatePending, future.GetState());
+
+    // Without a response until the deadline.
+    CHECK_EQUAL(Coap::Future::kStateTimeout, future.Poll(future.GetDeadline()));
+    CHECK_EQUAL(Coap::kCodeEmpty, future.GetCode());
+
+    Coap::Agent::Destroy(agent);
+}
+
+TEST(Coap, TestGetPriority)
+{
+    const uint8_t kLeaderPetition[]   = {0x42, Coap::kCodePost, 0, 1, 0xaa, 0xbb, 0xb1, 'c', 0x02, 'l', 'p'};
+    const uint8_t kRelayRx[]          = {0x50, Coap::kCodePost, 0, 2, 0xb1, 'c', 0x02, 'r', 'x', 0xff, 0x01};
+    const uint8_t kActiveGet[]        = {0x40, Coap::kCodePost, 0, 3, 0xb1, 'c', 0x02, 'a', 'g'};
+    const uint8_t kLongerPath[]       = {0x40, Coap::kCodePost, 0, 4, 0xb1, 'c', 0x03, 'r', 'x', 'y'};
+    const uint8_t kDeeperPath[]       = {0x40, Coap::kCodePost, 0, 5, 0xb1, 'c', 0x02, 'r', 'x', 0x01, 'a'};
+    const uint8_t kResponse[]         = {0x62, Coap::kCodeChanged, 0, 6, 0xaa, 0xbb};
+    const uint8_t kInvalidToken[]     = {0x4f, Coap::kCodePost, 0, 7};
+    const uint8_t kRelayTxWithQuery[] = {0x50, Coap::kCodePost, 0, 8, 0xb1, 'c', 0x02, 't', 'x', 0x41, 'a'};
+
+    CHECK_EQUAL(kPriorityControl, Coap::GetPriority(kLeaderPetition, sizeof(kLeaderPetition)));
+    CHECK_EQUAL(kPriorityBulk, Coap::GetPriority(kRelayRx, sizeof(kRelayRx)));
+    CHECK_EQUAL(kPriorityBulk, Coap::GetPriority(kRelayTxWithQuery, sizeof(kRelayTxWithQuery)));
+    CHECK_EQUAL(kPriorityManagement, Coap::GetPriority(kActiveGet, sizeof(kActiveGet)));
+    CHECK_EQUAL(kPriorityManagement, Coap::GetPriority(kLongerPath, sizeof(kLongerPath)));
+    CHECK_EQUAL(kPriorityManagement, Coap::GetPriority(kDeeperPath, sizeof(kDeeperPath)));
+
+    // Responses end transactions of the peer, so they are sent first.
+    CHECK_EQUAL(kPriorityControl, Coap::GetPriority(kResponse, sizeof(kResponse)));
+
+    // Messages that cannot be parsed are left to the default priority.
+    CHECK_EQUAL(kPriorityManagement, Coap::GetPriority(kInvalidToken, sizeof(kInvalidToken)));
+    CHECK_EQUAL(kPriorityManagement, Coap::GetPriority(kLeaderPetition, 2));
+}
@@ -0,0 +1,587 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <string.h>
+
+#include "agent/coap_native.hpp"
+#include "common/time.hpp"
+
+using namespace ot::BorderRouter;
+
+struct NativeContext
+{
+    uint8_t  mBuffer[Coap::MessageNative::kMaxMessageSize];
+    uint16_t mLength;
+    int      mSent;
+    int      mResponses;
+};
+
+static ssize_t NativeSender(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort, void *aContext)
+{
+    NativeContext &context = *static_cast<NativeContext *>(aContext);
+
+    memcpy(context.mBuffer, aBuffer, aLength);
+    context.mLength = aLength;
+    context.mSent++;
+
+    (void)aIp6;
+    (void)aPort;
+    return static_cast<ssize_t>(aLength);
+}
+
+// Number of parts of the last message gathered by NativeVectorSender().
+static int sVectorParts;
+
+static ssize_t NativeVectorSender(const struct iovec *aVector,
+                                  int                 aCount,
+                                  const uint8_t *     aIp6,
+                                  uint16_t            aPort,
+                                  void *              aContext)
+{
+    NativeContext &context = *static_cast<NativeContext *>(aContext);
+
+    context.mLength = 0;
+
+    for (int i = 0; i < aCount; ++i)
+    {
+        memcpy(context.mBuffer + context.mLength, aVector[i].iov_base, aVector[i].iov_len);
+        context.mLength = static_cast<uint16_t>(context.mLength + aVector[i].iov_len);
+    }
+
+    context.mSent++;
+    sVectorParts = aCount;
+
+    (void)aIp6;
+    (void)aPort;
+    return static_cast<ssize_t>(context.mLength);
+}
+
+static void NativeResponseHandler(const Coap::Message &aMessage, void *aContext)
+{
+    NativeContext &context = *static_cast<NativeContext *>(aContext);
+
+    CHECK_EQUAL(Coap::kCodeChanged, aMessage.GetCode());
+    context.mResponses++;
+}
+
+TEST_GROUP(CoapNative){};
+
+TEST(CoapNative, TestEncodeParse)
+{
+    Coap::MessageNative message;
+    Coap::MessageNative parsed;
+    uint8_t             token[] = {0xde, 0xad};
+    uint8_t             payload[300];
+    uint8_t             tokenLength;
+    uint16_t            length;
+
+    memset(payload, 0xa5, sizeof(payload));
+    message.Init(Coap::kTypeConfirmable, Coap::kCodePost, 0x1234, token, sizeof(token));
+    message.SetPath("/c/long-enough-to-need-an-extended-option-length");
+    message.SetPayload(payload, sizeof(payload));
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, parsed.Parse(message.GetBuffer(), message.GetLength()));
+    CHECK_EQUAL(Coap::kTypeConfirmable, parsed.GetType());
+    CHECK_EQUAL(Coap::kCodePost, parsed.GetCode());
+    CHECK_EQUAL(0x1234, parsed.GetMessageId());
+    CHECK_EQUAL(0, memcmp(token, parsed.GetToken(tokenLength), sizeof(token)));
+    CHECK_EQUAL(sizeof(token), tokenLength);
+    CHECK(parsed.MatchPath("c/long-enough-to-need-an-extended-option-length"));
+    CHECK(!parsed.MatchPath("c/long-enough"));
+    CHECK(!parsed.MatchPath("c"));
+    CHECK_EQUAL(0, memcmp(payload, parsed.GetPayload(length), sizeof(payload)));
+    CHECK_EQUAL(sizeof(payload), length);
+
+    // Changing the token moves the options and payload along.
+    message.SetToken(NULL, 0);
+    CHECK_EQUAL(OTBR_ERROR_NONE, parsed.Parse(message.GetBuffer(), message.GetLength()));
+    CHECK(parsed.MatchPath("c/long-enough-to-need-an-extended-option-length"));
+    CHECK(parsed.GetPayload(length) != NULL);
+    CHECK_EQUAL(sizeof(payload), length);
+
+    // A payload marker without payload is malformed.
+    {
+        uint8_t truncated[] = {0x40, Coap::kCodePost, 0x00, 0x01, 0xff};
+
+        CHECK_EQUAL(OTBR_ERROR_ERRNO, parsed.Parse(truncated, sizeof(truncated)));
+        CHECK_EQUAL(EBADMSG, errno);
+    }
+}
+
+TEST(CoapNative, TestSendPayload)
+{
+    NativeContext       context = {{0}, 0, 0, 0};
+    Coap::AgentNative   agent(NativeSender, &context, NULL);
+    uint8_t             token[] = {0xbe, 0xef};
+    uint8_t             payload[200];
+    Coap::MessageNative expected;
+    Coap::MessageNative parsed;
+    uint16_t            length;
+
+    memset(payload, 0x5a, sizeof(payload));
+    agent.SetVectorSender(NativeVectorSender);
+    sVectorParts = 0;
+
+    // A non-confirmable message is sent as its header and options, the marker and the payload, encoded as a whole.
+    {
+        Coap::ScopedMessage message(agent, Coap::kTypeNonConfirmable, Coap::kCodeChanged, token, sizeof(token));
+
+        message->AddUintOption(Coap::kOptionObserve, 3);
+        CHECK_EQUAL(OTBR_ERROR_NONE, agent.SendPayload(*message, payload, sizeof(payload), NULL, 0));
+
+        expected.Init(Coap::kTypeNonConfirmable, Coap::kCodeChanged,
+                      static_cast<Coap::MessageNative &>(*message).GetMessageId(), token, sizeof(token));
+        expected.AddUintOption(Coap::kOptionObserve, 3);
+        expected.SetPayload(payload, sizeof(payload));
+    }
+
+    CHECK_EQUAL(1, context.mSent);
+    CHECK_EQUAL(3, sVectorParts);
+    CHECK_EQUAL(expected.GetLength(), context.mLength);
+    MEMCMP_EQUAL(expected.GetBuffer(), context.mBuffer, context.mLength);
+    CHECK_EQUAL(OTBR_ERROR_NONE, parsed.Parse(context.mBuffer, context.mLength));
+    MEMCMP_EQUAL(payload, parsed.GetPayload(length), sizeof(payload));
+
+    // An empty payload is sent without marker.
+    {
+        Coap::ScopedMessage message(agent, Coap::kTypeNonConfirmable, Coap::kCodeChanged, token, sizeof(token));
+
+        CHECK_EQUAL(OTBR_ERROR_NONE, agent.SendPayload(*message, NULL, 0, NULL, 0));
+    }
+
+    CHECK_EQUAL(2, context.mSent);
+    CHECK_EQUAL(1, sVectorParts);
+    CHECK_EQUAL(OTBR_ERROR_NONE, parsed.Parse(context.mBuffer, context.mLength));
+    POINTERS_EQUAL(NULL, parsed.GetPayload(length));
+
+    // A payload beyond the max message size is refused.
+    {
+        Coap::ScopedMessage message(agent, Coap::kTypeNonConfirmable, Coap::kCodeChanged, token, sizeof(token));
+        uint8_t             oversized[Coap::MessageNative::kMaxMessageSize];
+
+        memset(oversized, 0, sizeof(oversized));
+        CHECK_EQUAL(OTBR_ERROR_ERRNO, agent.SendPayload(*message, oversized, sizeof(oversized), NULL, 0));
+        CHECK_EQUAL(EMSGSIZE, errno);
+    }
+
+    CHECK_EQUAL(2, context.mSent);
+
+    // Confirmable messages are kept for retransmission, so they hold their payload and are sent contiguous.
+    sVectorParts = 0;
+
+    {
+        Coap::ScopedMessage message(agent, Coap::kTypeConfirmable, Coap::kCodePost, token, sizeof(token));
+
+        message->SetPath("c/lp");
+        CHECK_EQUAL(OTBR_ERROR_NONE, agent.SendPayload(*message, payload, sizeof(payload), NULL, 0));
+    }
+
+    CHECK_EQUAL(3, context.mSent);
+    CHECK_EQUAL(0, sVectorParts);
+    CHECK_EQUAL(OTBR_ERROR_NONE, parsed.Parse(context.mBuffer, context.mLength));
+    MEMCMP_EQUAL(payload, parsed.GetPayload(length), sizeof(payload));
+}
+
+TEST(CoapNative, TestEncodedPath)
+{
+    static const Coap::EncodedPath kShortPath("c/lp");
+    static const Coap::EncodedPath kLongPath("/c/long-enough-to-need-an-extended-option-length");
+    Coap::MessageNative            expected;
+    Coap::MessageNative            message;
+    uint8_t                        token[] = {0xbe, 0xef};
+
+    // The encoded path gives the same bytes as setting it.
+    expected.Init(Coap::kTypeConfirmable, Coap::kCodePost, 0x1234, token, sizeof(token));
+    expected.SetPath(kLongPath.GetPath());
+    message.Init(Coap::kTypeConfirmable, Coap::kCodePost, 0x1234, token, sizeof(token));
+    message.SetPathEncoded(kLongPath);
+    CHECK_EQUAL(expected.GetLength(), message.GetLength());
+    CHECK_EQUAL(0, memcmp(expected.GetBuffer(), message.GetBuffer(), message.GetLength()));
+
+    expected.Init(Coap::kTypeConfirmable, Coap::kCodePost, 0x1234, token, sizeof(token));
+    expected.SetPath(kShortPath.GetPath());
+    message.Init(Coap::kTypeConfirmable, Coap::kCodePost, 0x1234, token, sizeof(token));
+    message.SetPathEncoded(kShortPath);
+    CHECK_EQUAL(expected.GetLength(), message.GetLength());
+    CHECK_EQUAL(0, memcmp(expected.GetBuffer(), message.GetBuffer(), message.GetLength()));
+    CHECK(message.MatchPath("c/lp"));
+
+    // Once options are set, the path is encoded as usual.
+    expected.SetPath(kShortPath.GetPath());
+    message.SetPathEncoded(kShortPath);
+    CHECK_EQUAL(expected.GetLength(), message.GetLength());
+    CHECK_EQUAL(0, memcmp(expected.GetBuffer(), message.GetBuffer(), message.GetLength()));
+}
+
+TEST(CoapNative, TestObserveOption)
+{
+    Coap::MessageNative message;
+    Coap::MessageNative parsed;
+    uint8_t             token[]   = {0x0b, 0x5e};
+    uint8_t             payload[] = {0x0e, 0x01};
+    uint32_t            value;
+
+    // Registrations encode zero in no byte, notifications keep the Block2 option after the Observe one.
+    message.Init(Coap::kTypeConfirmable, Coap::kCodePost, 0x1234, token, sizeof(token));
+    message.AddUintOption(Coap::kOptionObserve, 0);
+    message.SetPath("c/ag");
+    message.SetPayload(payload, sizeof(payload));
+    CHECK_EQUAL(OTBR_ERROR_NONE, parsed.Parse(message.GetBuffer(), message.GetLength()));
+    CHECK(parsed.GetUintOption(Coap::kOptionObserve, value));
+    CHECK_EQUAL(0, value);
+    CHECK(parsed.MatchPath("c/ag"));
+
+    message.Init(Coap::kTypeNonConfirmable, Coap::kCodeChanged, 0x1235, token, sizeof(token));
+    message.AddUintOption(Coap::kOptionObserve, 0xffffff);
+    message.AddUintOption(Coap::kOptionBlock2, 0x16);
+    message.SetPayload(payload, sizeof(payload));
+    CHECK_EQUAL(OTBR_ERROR_NONE, parsed.Parse(message.GetBuffer(), message.GetLength()));
+    CHECK(parsed.GetUintOption(Coap::kOptionObserve, value));
+    CHECK_EQUAL(0xffffff, value);
+    CHECK(parsed.GetUintOption(Coap::kOptionBlock2, value));
+    CHECK_EQUAL(0x16, value);
+
+    message.Init(Coap::kTypeNonConfirmable, Coap::kCodeChanged, 0x1236, token, sizeof(token));
+    CHECK_EQUAL(OTBR_ERROR_NONE, parsed.Parse(message.GetBuffer(), message.GetLength()));
+    CHECK(!parsed.GetUintOption(Coap::kOptionObserve, value));
+}
+
+TEST(CoapNative, TestRetransmission)
+{
+    NativeContext       context = {{0}, 0, 0, 0};
+    TimerWheel          wheel;
+    Coap::AgentNative   agent(NativeSender, &context, &wheel);
+    uint16_t            token = htons(7);
+    Coap::MessageNative sent;
+    Coap::MessageNative response;
+
+    {
+        Coap::ScopedMessage message(agent, Coap::kTypeConfirmable, Coap::kCodePost,
+                                    reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+
+        message->SetPath("c/lp");
+        CHECK_EQUAL(OTBR_ERROR_NONE, agent.Send(*message, NULL, 0, NativeResponseHandler, &context));
+    }
+
+    CHECK_EQUAL(1, context.mSent);
+
+    // The first retransmission is within ACK_TIMEOUT * ACK_RANDOM_FACTOR.
+    wheel.Process(GetMonotonicNow() + 3000);
+    CHECK_EQUAL(2, context.mSent);
+
+    // Acknowledge the retransmission with a piggybacked response.
+    CHECK_EQUAL(OTBR_ERROR_NONE, sent.Parse(context.mBuffer, context.mLength));
+    response.Copy(sent);
+    response.SetType(Coap::kTypeAcknowledgment);
+    response.SetCode(Coap::kCodeChanged);
+    agent.Input(response.GetBuffer(), response.GetLength(), NULL, 0);
+    CHECK_EQUAL(1, context.mResponses);
+
+    // Nothing is retransmitted once the response is received.
+    wheel.Process(GetMonotonicNow() + 100000);
+    CHECK_EQUAL(2, context.mSent);
+}
+
+TEST(CoapNative, TestSharedCore)
+{
+    NativeContext       tmfContext    = {{0}, 0, 0, 0};
+    NativeContext       secureContext = {{0}, 0, 0, 0};
+    TimerWheel          wheel;
+    Coap::AgentNative   tmf(NativeSender, &tmfContext, &wheel);
+    Coap::AgentNative * secure = new Coap::AgentNative(NativeSender, &secureContext, &wheel, &tmf);
+    uint16_t            token  = htons(9);
+    Coap::MessageNative sent;
+    Coap::MessageNative response;
+    Coap::Message *     message;
+    uint16_t            id;
+    int                 sentBefore;
+
+    // Messages come from one pool and their ids from one space, whichever agent takes or frees them.
+    message = tmf.NewMessage(Coap::kTypeNonConfirmable, Coap::kCodePost, NULL, 0);
+    id      = static_cast<Coap::MessageNative *>(message)->GetMessageId();
+    secure->FreeMessage(message);
+    message = secure->NewMessage(Coap::kTypeNonConfirmable, Coap::kCodePost, NULL, 0);
+    CHECK_EQUAL(static_cast<uint16_t>(id + 1), static_cast<Coap::MessageNative *>(message)->GetMessageId());
+    tmf.FreeMessage(message);
+    CHECK_EQUAL(0, tmf.GetMessagePoolMisses());
+    CHECK_EQUAL(0, secure->GetMessagePoolMisses());
+
+    // Transactions are stored together, but each agent only counts and matches its own.
+    {
+        Coap::ScopedMessage request(tmf, Coap::kTypeConfirmable, Coap::kCodePost,
+                                    reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+
+        request->SetPath("c/lp");
+        CHECK_EQUAL(OTBR_ERROR_NONE, tmf.Send(*request, NULL, 0, NativeResponseHandler, &tmfContext));
+    }
+
+    {
+        Coap::ScopedMessage request(*secure, Coap::kTypeConfirmable, Coap::kCodePost,
+                                    reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+
+        request->SetPath("c/ca");
+        CHECK_EQUAL(OTBR_ERROR_NONE, secure->Send(*request, NULL, 0, NativeResponseHandler, &secureContext));
+    }
+
+    CHECK_EQUAL(1, tmf.GetTransactionCount(NULL));
+    CHECK_EQUAL(1, secure->GetTransactionCount(NULL));
+    CHECK_EQUAL(0, tmf.GetTransactionCount("c/ca"));
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, sent.Parse(tmfContext.mBuffer, tmfContext.mLength));
+    response.Copy(sent);
+    response.SetType(Coap::kTypeAcknowledgment);
+    response.SetCode(Coap::kCodeChanged);
+
+    // The same token and message id do not match the transaction of another agent.
+    secure->Input(response.GetBuffer(), response.GetLength(), NULL, 0);
+    CHECK_EQUAL(0, tmfContext.mResponses);
+    CHECK_EQUAL(0, secureContext.mResponses);
+    CHECK_EQUAL(1, tmf.GetTransactionCount(NULL));
+
+    // The agent left takes its transactions along, their timers never fire.
+    delete secure;
+    sentBefore = secureContext.mSent;
+
+    tmf.Input(response.GetBuffer(), response.GetLength(), NULL, 0);
+    CHECK_EQUAL(1, tmfContext.mResponses);
+    CHECK_EQUAL(0, tmf.GetTransactionCount(NULL));
+
+    wheel.Process(GetMonotonicNow() + 100000);
+    CHECK_EQUAL(sentBefore, secureContext.mSent);
+}
+
+TEST(CoapNative, TestSeparateResponse)
+{
+    NativeContext       context = {{0}, 0, 0, 0};
+    Coap::AgentNative   agent(NativeSender, &context, NULL);
+    uint16_t            token = htons(9);
+    uint16_t            messageId;
+    Coap::MessageNative response;
+
+    {
+        Coap::ScopedMessage message(agent, Coap::kTypeConfirmable, Coap::kCodePost,
+                                    reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+
+        CHECK_EQUAL(OTBR_ERROR_NONE, agent.Send(*message, NULL, 0, NativeResponseHandler, &context));
+    }
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, response.Parse(context.mBuffer, context.mLength));
+    messageId = response.GetMessageId();
+
+    // An empty acknowledgment only tells the response comes later.
+    response.Init(Coap::kTypeAcknowledgment, Coap::kCodeEmpty, messageId, NULL, 0);
+    agent.Input(response.GetBuffer(), response.GetLength(), NULL, 0);
+    CHECK_EQUAL(0, context.mResponses);
+
+    // The separate response is matched by token and acknowledged.
+    response.Init(Coap::kTypeConfirmable, Coap::kCodeChanged, 0x4321, reinterpret_cast<const uint8_t *>(&token),
+                  sizeof(token));
+    agent.Input(response.GetBuffer(), response.GetLength(), NULL, 0);
+    CHECK_EQUAL(1, context.mResponses);
+    CHECK_EQUAL(OTBR_ERROR_NONE, response.Parse(context.mBuffer, context.mLength));
+    CHECK_EQUAL(Coap::kTypeAcknowledgment, response.GetType());
+    CHECK_EQUAL(0x4321, response.GetMessageId());
+}
+
+TEST(CoapNative, TestTransactionsExhausted)
+{
+    NativeContext     context = {{0}, 0, 0, 0};
+    Coap::AgentNative agent(NativeSender, &context, NULL);
+    otbrError         error = OTBR_ERROR_NONE;
+    int               sent  = 0;
+
+    while (error == OTBR_ERROR_NONE && sent < 1000)
+    {
+        Coap::ScopedMessage message(agent, Coap::kTypeConfirmable, Coap::kCodePost, NULL, 0);
+
+        error = agent.Send(*message, NULL, 0, NULL, NULL);
+        sent += (error == OTBR_ERROR_NONE);
+    }
+
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, error);
+    CHECK_EQUAL(ENOBUFS, errno);
+    CHECK(sent > 0 && sent < 1000);
+}
+
+TEST(CoapNative, TestNstart)
+{
+    NativeContext     context    = {{0}, 0, 0, 0};
+    Coap::AgentNative agent(NativeSender, &context, NULL);
+    const uint8_t     kLeader[16] = {0xfd, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xfe, 0, 0xfc, 0x00};
+    const uint8_t     kRouter[16] = {0xfd, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xfe, 0, 0x04, 0x00};
+
+    agent.SetNstart(2);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        Coap::ScopedMessage message(agent, Coap::kTypeConfirmable, Coap::kCodePost, NULL, 0);
+
+        if (i < 2)
+        {
+            CHECK_EQUAL(OTBR_ERROR_NONE, agent.Send(*message, kLeader, 61631, NULL, NULL));
+        }
+        else
+        {
+            // Beyond NSTART of the destination.
+            CHECK_EQUAL(OTBR_ERROR_ERRNO, agent.Send(*message, kLeader, 61631, NULL, NULL));
+            CHECK_EQUAL(ENOBUFS, errno);
+        }
+    }
+
+    // Other destinations have their own limit.
+    {
+        Coap::ScopedMessage message(agent, Coap::kTypeConfirmable, Coap::kCodePost, NULL, 0);
+
+        CHECK_EQUAL(OTBR_ERROR_NONE, agent.Send(*message, kRouter, 61631, NULL, NULL));
+    }
+
+    // Non-confirmable messages are not limited.
+    {
+        Coap::ScopedMessage message(agent, Coap::kTypeNonConfirmable, Coap::kCodePost, NULL, 0);
+
+        CHECK_EQUAL(OTBR_ERROR_NONE, agent.Send(*message, kLeader, 61631, NULL, NULL));
+    }
+}
+
+TEST(CoapNative, TestRetransmissionTimeout)
+{
+    NativeContext       context    = {{0}, 0, 0, 0};
+    TimerWheel          wheel;
+    Coap::AgentNative   agent(NativeSender, &context, &wheel);
+    const uint8_t       kLeader[16] = {0xfd, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xfe, 0, 0xfc, 0x00};
+    Coap::MessageNative sent;
+    Coap::MessageNative response;
+    uint32_t            timeout;
+
+    CHECK_EQUAL(2000, agent.GetRetransmissionTimeout(kLeader));
+
+    // Quick responses to requests never retransmitted shorten the timeout of their destination only.
+    for (uint16_t i = 0; i < 2; ++i)
+    {
+        uint16_t            token = htons(i + 1);
+        Coap::ScopedMessage message(agent, Coap::kTypeConfirmable, Coap::kCodePost,
+                                    reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+
+        CHECK_EQUAL(OTBR_ERROR_NONE, agent.Send(*message, kLeader, 61631, NativeResponseHandler, &context));
+        CHECK_EQUAL(OTBR_ERROR_NONE, sent.Parse(context.mBuffer, context.mLength));
+        response.Copy(sent);
+        response.SetType(Coap::kTypeAcknowledgment);
+        response.SetCode(Coap::kCodeChanged);
+        agent.Input(response.GetBuffer(), response.GetLength(), kLeader, 61631);
+    }
+
+    CHECK_EQUAL(2, context.mResponses);
+    timeout = agent.GetRetransmissionTimeout(kLeader);
+    CHECK(timeout < 1000);
+    CHECK_EQUAL(2000, agent.GetRetransmissionTimeout(NULL));
+
+    // A response to a retransmission weighs less.
+    {
+        uint16_t            token = htons(3);
+        Coap::ScopedMessage message(agent, Coap::kTypeConfirmable, Coap::kCodePost,
+                                    reinterpret_cast<const uint8_t *>(&token), sizeof(token));
+
+        CHECK_EQUAL(OTBR_ERROR_NONE, agent.Send(*message, kLeader, 61631, NativeResponseHandler, &context));
+    }
+
+    wheel.Process(GetMonotonicNow() + 1000);
+    CHECK_EQUAL(4, context.mSent);
+    CHECK_EQUAL(OTBR_ERROR_NONE, sent.Parse(context.mBuffer, context.mLength));
+    response.Copy(sent);
+    response.SetType(Coap::kTypeAcknowledgment);
+    response.SetCode(Coap::kCodeChanged);
+    agent.Input(response.GetBuffer(), response.GetLength(), kLeader, 61631);
+    CHECK_EQUAL(3, context.mResponses);
+    CHECK(agent.GetRetransmissionTimeout(kLeader) < timeout);
+    CHECK(agent.GetRetransmissionTimeout(kLeader) > timeout / 2);
+}
+
+static void HandleDuplicateRequest(const Coap::Resource &aResource,
+                                   const Coap::Message & aRequest,
+                                   Coap::Message &       aResponse,
+                                   const uint8_t *       aIp6,
+                                   uint16_t              aPort,
+                                   void *                aContext)
+{
+    NativeContext &context = *static_cast<NativeContext *>(aContext);
+
+    context.mResponses++;
+    aResponse.SetCode(Coap::kCodeChanged);
+
+    (void)aResource;
+    (void)aRequest;
+    (void)aIp6;
+    (void)aPort;
+}
+
+TEST(CoapNative, TestDuplicateRequest)
+{
+    NativeContext       context     = {{0}, 0, 0, 0};
+    Coap::AgentNative   agent(NativeSender, &context, NULL);
+    Coap::Resource      resource("c/cg", HandleDuplicateRequest, &context);
+    const uint8_t       kPeer[16]   = {0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01};
+    uint16_t            token       = htons(11);
+    uint8_t             ack[Coap::MessageNative::kMaxMessageSize];
+    uint16_t            ackLength;
+    Coap::MessageNative request;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, agent.AddResource(resource));
+    request.Init(Coap::kTypeConfirmable, Coap::kCodePost, 0x2345, reinterpret_cast<const uint8_t *>(&token),
+                 sizeof(token));
+    request.SetPath("c/cg");
+
+    agent.Input(request.GetBuffer(), request.GetLength(), kPeer, 49191);
+    CHECK_EQUAL(1, context.mResponses);
+    CHECK_EQUAL(1, context.mSent);
+    ackLength = context.mLength;
+    memcpy(ack, context.mBuffer, ackLength);
+
+    // The retransmission is answered with the same piggybacked response, without being handled again.
+    agent.Input(request.GetBuffer(), request.GetLength(), kPeer, 49191);
+    CHECK_EQUAL(1, context.mResponses);
+    CHECK_EQUAL(2, context.mSent);
+    CHECK_EQUAL(ackLength, context.mLength);
+    CHECK(memcmp(ack, context.mBuffer, ackLength) == 0);
+
+    // The same message id from another peer is another request.
+    agent.Input(request.GetBuffer(), request.GetLength(), kPeer, 49192);
+    CHECK_EQUAL(2, context.mResponses);
+    CHECK_EQUAL(3, context.mSent);
+
+    // Every request is handled once the detection is disabled.
+    agent.SetDuplicateLifetime(0);
+    agent.Input(request.GetBuffer(), request.GetLength(), kPeer, 49191);
+    CHECK_EQUAL(3, context.mResponses);
+    CHECK_EQUAL(4, context.mSent);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, agent.RemoveResource(resource));
+}
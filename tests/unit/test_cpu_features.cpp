@@ -0,0 +1,97 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+
+#include "utils/cpu_features.hpp"
+
+using ot::Utils::CpuFeatures;
+
+static unsigned int sBindCount     = 0;
+static uint32_t     sBoundFeatures = 0;
+
+static void HandleBind(uint32_t aFeatures)
+{
+    sBindCount++;
+    sBoundFeatures = aFeatures;
+}
+
+// Bindings are statics, run as the program starts.
+static const CpuFeatures::Binding sBinding(HandleBind);
+
+TEST_GROUP(CpuFeatures)
+{
+    void teardown(void) { CpuFeatures::Disable(0); }
+};
+
+TEST(CpuFeatures, TestParseAndFormat)
+{
+    uint32_t features;
+    char     names[64];
+
+    CHECK(CpuFeatures::Parse("aes,clmul", features));
+    LONGS_EQUAL(CpuFeatures::kAes | CpuFeatures::kClmul, features);
+    STRCMP_EQUAL("aes,clmul", CpuFeatures::Format(features, names, sizeof(names)));
+
+    CHECK(CpuFeatures::Parse("all", features));
+    LONGS_EQUAL(CpuFeatures::kAll, features);
+    STRCMP_EQUAL("neon,aes,clmul,sse2,sse4.1,avx2", CpuFeatures::Format(features, names, sizeof(names)));
+
+    CHECK(CpuFeatures::Parse("", features));
+    LONGS_EQUAL(0, features);
+    STRCMP_EQUAL("none", CpuFeatures::Format(features, names, sizeof(names)));
+
+    // Unknown names are reported, the known ones are still parsed.
+    CHECK(!CpuFeatures::Parse("avx2,avx512", features));
+    LONGS_EQUAL(CpuFeatures::kAvx2, features);
+    CHECK(!CpuFeatures::Parse("sse4", features));
+
+    // Names are truncated to the buffer.
+    STRCMP_EQUAL("neon,", CpuFeatures::Format(CpuFeatures::kAll, names, 6));
+}
+
+TEST(CpuFeatures, TestDisable)
+{
+    unsigned int count = sBindCount;
+
+    CHECK(count >= 1);
+    LONGS_EQUAL(CpuFeatures::GetDetected(), sBoundFeatures);
+    LONGS_EQUAL(CpuFeatures::GetDetected(), CpuFeatures::Get());
+
+    // Bindings are run again with the features left.
+    CpuFeatures::Disable(CpuFeatures::kAes | CpuFeatures::kSse2);
+    LONGS_EQUAL(count + 1, sBindCount);
+    LONGS_EQUAL(CpuFeatures::GetDetected() & ~(CpuFeatures::kAes | CpuFeatures::kSse2), sBoundFeatures);
+    LONGS_EQUAL(sBoundFeatures, CpuFeatures::Get());
+
+    CpuFeatures::Disable(0);
+    LONGS_EQUAL(count + 2, sBindCount);
+    LONGS_EQUAL(CpuFeatures::GetDetected(), sBoundFeatures);
+}
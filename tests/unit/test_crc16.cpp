@@ -0,0 +1,146 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+
+#include "utils/cpu_features.hpp"
+#include "utils/crc16.hpp"
+#include "utils/steeringdata.hpp"
+
+TEST_GROUP(Crc16){};
+
+/**
+ * This function computes the CRC16 one bit at a time.
+ *
+ */
+static uint16_t ComputeBitwise(uint16_t aPolynomial, const uint8_t *aBuffer, size_t aLength)
+{
+    uint16_t crc = 0;
+
+    for (size_t i = 0; i < aLength; i++)
+    {
+        crc ^= static_cast<uint16_t>(aBuffer[i] << 8);
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ aPolynomial) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+TEST(Crc16, TestCheckValue)
+{
+    const uint8_t *kCheck = reinterpret_cast<const uint8_t *>("123456789");
+    ot::Crc16      ccitt(ot::Crc16::kCcitt);
+    ot::Crc16      ansi(ot::Crc16::kAnsi);
+
+    ccitt.Update(kCheck, 9);
+    ansi.Update(kCheck, 9);
+
+    LONGS_EQUAL(0x31c3, ccitt.Get());
+    LONGS_EQUAL(0xfee8, ansi.Get());
+}
+
+TEST(Crc16, TestBitwise)
+{
+    uint8_t buffer[256];
+
+    for (size_t i = 0; i < sizeof(buffer); i++)
+    {
+        buffer[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+
+    for (size_t length = 0; length <= sizeof(buffer); length += 17)
+    {
+        ot::Crc16 ccitt(ot::Crc16::kCcitt);
+        ot::Crc16 ansi(ot::Crc16::kAnsi);
+
+        for (size_t i = 0; i < length; i++)
+        {
+            ccitt.Update(buffer[i]);
+        }
+
+        ansi.Update(buffer, length);
+
+        LONGS_EQUAL(ComputeBitwise(ot::Crc16::kCcitt, buffer, length), ccitt.Get());
+        LONGS_EQUAL(ComputeBitwise(ot::Crc16::kAnsi, buffer, length), ansi.Get());
+    }
+}
+
+TEST(Crc16, TestKernels)
+{
+    uint8_t buffer[64];
+
+    for (size_t i = 0; i < sizeof(buffer); i++)
+    {
+        buffer[i] = static_cast<uint8_t>(i * 101 + 7);
+    }
+
+    // The table and the carry-less multiplication kernels agree on every length and continued computation.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        ot::Utils::CpuFeatures::Disable(pass == 0 ? 0 : static_cast<uint32_t>(ot::Utils::CpuFeatures::kClmul));
+
+        for (size_t length = 0; length <= sizeof(buffer); length++)
+        {
+            ot::Crc16 ccitt(ot::Crc16::kCcitt);
+            ot::Crc16 ansi(ot::Crc16::kAnsi);
+
+            ccitt.Update(buffer, length / 3);
+            ccitt.Update(buffer + length / 3, length - length / 3);
+            ansi.Update(buffer, length);
+
+            LONGS_EQUAL(ComputeBitwise(ot::Crc16::kCcitt, buffer, length), ccitt.Get());
+            LONGS_EQUAL(ComputeBitwise(ot::Crc16::kAnsi, buffer, length), ansi.Get());
+        }
+    }
+
+    ot::Utils::CpuFeatures::Disable(0);
+}
+
+TEST(Crc16, TestSteeringData)
+{
+    const uint8_t    kEui64[] = {0x18, 0xb4, 0x30, 0x00, 0x00, 0x00, 0x00, 0x01};
+    ot::SteeringData steeringData;
+    ot::SteeringData expected;
+
+    steeringData.Init();
+    steeringData.SetLength(16);
+    steeringData.ComputeBloomFilter(kEui64);
+
+    expected.Init();
+    expected.SetLength(16);
+    expected.SetBit(ComputeBitwise(ot::Crc16::kCcitt, kEui64, sizeof(kEui64)) % expected.GetNumBits());
+    expected.SetBit(ComputeBitwise(ot::Crc16::kAnsi, kEui64, sizeof(kEui64)) % expected.GetNumBits());
+
+    MEMCMP_EQUAL(expected.GetDataPointer(), steeringData.GetDataPointer(), steeringData.GetLength());
+}
@@ -0,0 +1,157 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+#include <unistd.h>
+
+#include "agent/datagram_io.hpp"
+
+using namespace ot::BorderRouter;
+
+static int OpenSocket(sockaddr_in6 &aSockAddr)
+{
+    int       one = 1;
+    int       fd  = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+    socklen_t len = sizeof(aSockAddr);
+
+    memset(&aSockAddr, 0, sizeof(aSockAddr));
+    aSockAddr.sin6_family = AF_INET6;
+    aSockAddr.sin6_addr   = in6addr_loopback;
+
+    CHECK(fd >= 0);
+    CHECK_EQUAL(0, setsockopt(fd, IPPROTO_IPV6, IPV6_RECVPKTINFO, &one, sizeof(one)));
+    CHECK_EQUAL(0, bind(fd, reinterpret_cast<sockaddr *>(&aSockAddr), sizeof(aSockAddr)));
+    CHECK_EQUAL(0, getsockname(fd, reinterpret_cast<sockaddr *>(&aSockAddr), &len));
+
+    return fd;
+}
+
+TEST_GROUP(DatagramIo){};
+
+TEST(DatagramIo, TestBatchSendReceive)
+{
+    DatagramIo   sender;
+    DatagramIo   receiver;
+    sockaddr_in6 senderAddr;
+    sockaddr_in6 receiverAddr;
+    sockaddr_in6 local;
+    int          senderFd   = OpenSocket(senderAddr);
+    int          receiverFd = OpenSocket(receiverAddr);
+    const int    kCount     = DatagramIo::kMaxBatchSize + 2;
+
+    sender.SetFd(senderFd);
+    receiver.SetFd(receiverFd);
+
+    // Nothing to receive.
+    CHECK_EQUAL(-1, receiver.Receive());
+
+    for (uint8_t i = 0; i < kCount; ++i)
+    {
+        CHECK_EQUAL(OTBR_ERROR_NONE, sender.Send(&i, sizeof(i), receiverAddr, senderAddr));
+    }
+
+    // A full queue is flushed when queuing more.
+    CHECK(sender.HasPending());
+    CHECK_EQUAL(2, sender.Flush());
+    CHECK(!sender.HasPending());
+
+    CHECK_EQUAL(DatagramIo::kMaxBatchSize, receiver.Receive());
+    for (int i = 0; i < DatagramIo::kMaxBatchSize; ++i)
+    {
+        const DatagramIo::Datagram &datagram = receiver.GetReceived(i);
+
+        CHECK_EQUAL(1, datagram.GetLength());
+        CHECK_EQUAL(i, datagram.GetPayload()[0]);
+        CHECK(!datagram.IsTruncated());
+        CHECK_EQUAL(senderAddr.sin6_port, datagram.GetPeerAddress().sin6_port);
+        CHECK(datagram.GetLocalAddress(local, ntohs(receiverAddr.sin6_port)));
+        CHECK_EQUAL(0, memcmp(&local.sin6_addr, &in6addr_loopback, sizeof(local.sin6_addr)));
+        CHECK_EQUAL(receiverAddr.sin6_port, local.sin6_port);
+    }
+
+    CHECK_EQUAL(2, receiver.Receive());
+
+    close(senderFd);
+    close(receiverFd);
+}
+
+TEST(DatagramIo, TestCoalescing)
+{
+    DatagramIo   sender;
+    DatagramIo   receiver;
+    sockaddr_in6 senderAddr;
+    sockaddr_in6 receiverAddr;
+    sockaddr_in6 otherAddr;
+    int          senderFd   = OpenSocket(senderAddr);
+    int          receiverFd = OpenSocket(receiverAddr);
+    int          otherFd    = OpenSocket(otherAddr);
+    uint8_t      payload[40];
+
+    sender.SetFd(senderFd);
+    sender.SetMaxCoalescedLength(100);
+    receiver.SetFd(receiverFd);
+
+    // Two payloads fit a datagram, the third one does not, the payload to another peer goes alone.
+    for (uint8_t i = 0; i < 3; ++i)
+    {
+        memset(payload, i, sizeof(payload));
+        CHECK_EQUAL(OTBR_ERROR_NONE, sender.Send(payload, sizeof(payload), receiverAddr, senderAddr));
+
+        if (i == 0)
+        {
+            CHECK_EQUAL(OTBR_ERROR_NONE, sender.Send(payload, sizeof(payload), otherAddr, senderAddr));
+        }
+    }
+
+    CHECK_EQUAL(3, sender.Flush());
+
+    CHECK_EQUAL(2, receiver.Receive());
+    CHECK_EQUAL(2 * sizeof(payload), receiver.GetReceived(0).GetLength());
+    CHECK_EQUAL(0, receiver.GetReceived(0).GetPayload()[0]);
+    CHECK_EQUAL(1, receiver.GetReceived(0).GetPayload()[sizeof(payload)]);
+    CHECK_EQUAL(sizeof(payload), receiver.GetReceived(1).GetLength());
+    CHECK_EQUAL(2, receiver.GetReceived(1).GetPayload()[0]);
+
+    close(senderFd);
+    close(receiverFd);
+    close(otherFd);
+}
+
+TEST(DatagramIo, TestSendWithoutSocket)
+{
+    DatagramIo   io;
+    sockaddr_in6 sockAddr;
+    uint8_t      byte = 0;
+
+    memset(&sockAddr, 0, sizeof(sockAddr));
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, io.Send(&byte, sizeof(byte), sockAddr, sockAddr));
+    CHECK(!io.HasPending());
+    CHECK_EQUAL(-1, io.Receive());
+}
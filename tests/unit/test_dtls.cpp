@@ -0,0 +1,552 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#include "agent/dtls.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
+
+using namespace ot::BorderRouter;
+
+enum
+{
+    kTestPort = 49391,
+};
+
+static const uint8_t kTestPSK[] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                   0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+
+struct DtlsContext
+{
+    Dtls::Session *mSession;
+    Dtls::Client * mClient;
+    int            mClientState;
+    char           mServerReceived[16];
+    char           mClientReceived[16];
+};
+
+static void HandleServerData(const uint8_t *aBuffer, uint16_t aLength, void *aContext)
+{
+    DtlsContext &context = *static_cast<DtlsContext *>(aContext);
+
+    CHECK(aLength < sizeof(context.mServerReceived));
+    memcpy(context.mServerReceived, aBuffer, aLength);
+    context.mServerReceived[aLength] = '\0';
+
+    // Echo back to the client.
+    CHECK_EQUAL(aLength, context.mSession->Write(aBuffer, aLength));
+}
+
+static void HandleSessionState(Dtls::Session &aSession, Dtls::Session::State aState, void *aContext)
+{
+    DtlsContext &context = *static_cast<DtlsContext *>(aContext);
+
+    if (aState == Dtls::Session::kStateReady)
+    {
+        context.mSession = &aSession;
+        aSession.SetDataHandler(HandleServerData, aContext);
+    }
+    else if (&aSession == context.mSession)
+    {
+        context.mSession = NULL;
+    }
+}
+
+static void HandleClientData(const uint8_t *aBuffer, uint16_t aLength, void *aContext)
+{
+    DtlsContext &context = *static_cast<DtlsContext *>(aContext);
+
+    CHECK(aLength < sizeof(context.mClientReceived));
+    memcpy(context.mClientReceived, aBuffer, aLength);
+    context.mClientReceived[aLength] = '\0';
+}
+
+static void HandleClientState(Dtls::Client &aClient, Dtls::Session::State aState, void *aContext)
+{
+    DtlsContext &context = *static_cast<DtlsContext *>(aContext);
+
+    POINTERS_EQUAL(context.mClient, &aClient);
+    context.mClientState = aState;
+}
+
+static void Poll(Dtls::Server &aServer, Dtls::Client &aClient)
+{
+    fd_set  readFdSet;
+    fd_set  writeFdSet;
+    fd_set  errorFdSet;
+    int     maxFd   = -1;
+    timeval timeout = {0, 100000};
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+    aServer.UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
+    aClient.UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
+
+    if (select(maxFd + 1, &readFdSet, &writeFdSet, &errorFdSet, &timeout) < 0)
+    {
+        FD_ZERO(&readFdSet);
+        FD_ZERO(&writeFdSet);
+        FD_ZERO(&errorFdSet);
+    }
+
+    aServer.Process(readFdSet, writeFdSet, errorFdSet);
+    aClient.Process(readFdSet, writeFdSet, errorFdSet);
+}
+
+struct ConcurrentContext
+{
+    enum
+    {
+        kClients = 3,
+    };
+
+    Dtls::Session *mSessions[kClients];
+    size_t         mSessionCount;
+};
+
+static void HandleConcurrentSessionState(Dtls::Session &aSession, Dtls::Session::State aState, void *aContext)
+{
+    ConcurrentContext &context = *static_cast<ConcurrentContext *>(aContext);
+
+    if (aState == Dtls::Session::kStateReady)
+    {
+        CHECK(context.mSessionCount < ConcurrentContext::kClients);
+        context.mSessions[context.mSessionCount++] = &aSession;
+    }
+}
+
+static void HandleConcurrentClientState(Dtls::Client &aClient, Dtls::Session::State aState, void *aContext)
+{
+    (void)aClient;
+    (void)aState;
+    (void)aContext;
+}
+
+static const Metrics::Metric *FindMetric(const char *aName)
+{
+    for (const Metrics::Metric *metric = Metrics::Metric::GetFirst(); metric != NULL; metric = metric->GetNext())
+    {
+        if (strcmp(metric->GetName(), aName) == 0)
+        {
+            return metric;
+        }
+    }
+
+    return NULL;
+}
+
+TEST_GROUP(Dtls){};
+
+TEST(Dtls, TestClientHandshake)
+{
+    DtlsContext   context;
+    Dtls::Server *server = Dtls::Server::Create(kTestPort, HandleSessionState, &context);
+    Dtls::Client *client = Dtls::Client::Create(HandleClientState, &context);
+    uint64_t      deadline;
+
+    memset(&context, 0, sizeof(context));
+    context.mClient      = client;
+    context.mClientState = -1;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->SetPSK(kTestPSK, sizeof(kTestPSK)));
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->Start());
+    CHECK_EQUAL(OTBR_ERROR_NONE, client->SetPSK(kTestPSK, sizeof(kTestPSK)));
+    CHECK_EQUAL(Dtls::Session::kStateEnd, client->GetState());
+
+    // Connecting never waits for the handshake.
+    CHECK_EQUAL(OTBR_ERROR_NONE, client->Connect("::1", "49391"));
+    CHECK_EQUAL(Dtls::Session::kStateHandshaking, client->GetState());
+
+    deadline = GetMonotonicNow() + 10000;
+    while (client->GetState() == Dtls::Session::kStateHandshaking && GetMonotonicNow() < deadline)
+    {
+        Poll(*server, *client);
+    }
+
+    CHECK_EQUAL(Dtls::Session::kStateReady, client->GetState());
+    CHECK_EQUAL(Dtls::Session::kStateReady, context.mClientState);
+
+    client->SetDataHandler(HandleClientData, &context);
+
+    while (context.mSession == NULL && GetMonotonicNow() < deadline)
+    {
+        Poll(*server, *client);
+    }
+
+    CHECK(context.mSession != NULL);
+    MEMCMP_EQUAL(context.mSession->GetKek(), client->GetKek(), 32);
+
+    CHECK_EQUAL(4, client->Write(reinterpret_cast<const uint8_t *>("ping"), 4));
+
+    while (context.mClientReceived[0] == '\0' && GetMonotonicNow() < deadline)
+    {
+        Poll(*server, *client);
+    }
+
+    STRCMP_EQUAL("ping", context.mServerReceived);
+    STRCMP_EQUAL("ping", context.mClientReceived);
+
+    // The session reports the application data it received and echoed.
+    {
+        Dtls::Server::SessionInfo info;
+        uint8_t                   loopback[16] = {0};
+        uint16_t                  port;
+
+        loopback[15] = 1;
+        CHECK_EQUAL(1, server->GetSessions(&info, 1));
+        CHECK_EQUAL(1, server->GetSessions(NULL, 0));
+        MEMCMP_EQUAL(loopback, info.mPeerAddress, sizeof(loopback));
+        context.mSession->GetPeerAddress(loopback, port);
+        CHECK_EQUAL(port, info.mPeerPort);
+        CHECK_EQUAL(Dtls::Session::kStateReady, info.mState);
+        CHECK_EQUAL(4, info.mRxBytes);
+        CHECK_EQUAL(4, info.mTxBytes);
+        CHECK(info.mHandshakeCpuTime > 0);
+    }
+
+    // The CPU time is accounted to the peer address, whatever its port.
+    {
+        Dtls::Server::SessionInfo session;
+        Dtls::Server::PeerInfo    peer;
+
+        CHECK_EQUAL(1, server->GetSessions(&session, 1));
+        CHECK_EQUAL(1, server->GetPeers(&peer, 1));
+        MEMCMP_EQUAL(session.mPeerAddress, peer.mPeerAddress, sizeof(peer.mPeerAddress));
+        CHECK_EQUAL(1, peer.mSessions);
+        CHECK_EQUAL(session.mHandshakeCpuTime, peer.mHandshakeCpuTime);
+        CHECK_EQUAL(session.mRecordCpuTime, peer.mRecordCpuTime);
+        CHECK_EQUAL(session.mHandlerCpuTime, peer.mHandlerCpuTime);
+    }
+
+    // Parts are encrypted into a single record, refused if they do not fit in one.
+    {
+        static uint8_t oversized[2000];
+        struct iovec   vector[2];
+
+        vector[0].iov_base = const_cast<char *>("po");
+        vector[0].iov_len  = 2;
+        vector[1].iov_base = const_cast<char *>("ng");
+        vector[1].iov_len  = 2;
+        memset(context.mClientReceived, 0, sizeof(context.mClientReceived));
+        CHECK_EQUAL(4, context.mSession->WriteVector(vector, 2));
+
+        while (context.mClientReceived[0] == '\0' && GetMonotonicNow() < deadline)
+        {
+            Poll(*server, *client);
+        }
+
+        STRCMP_EQUAL("pong", context.mClientReceived);
+
+        vector[1].iov_base = oversized;
+        vector[1].iov_len  = sizeof(oversized);
+        CHECK(context.mSession->WriteVector(vector, 2) < 0);
+        CHECK_EQUAL(EMSGSIZE, errno);
+    }
+
+    client->Close();
+    CHECK_EQUAL(Dtls::Session::kStateEnd, client->GetState());
+    CHECK(client->Write(reinterpret_cast<const uint8_t *>("late"), 4) < 0);
+
+    Dtls::Client::Destroy(client);
+    Dtls::Server::Destroy(server);
+}
+
+TEST(Dtls, TestLinkSettings)
+{
+    DtlsContext               context;
+    Dtls::Server *            server = Dtls::Server::Create(kTestPort, HandleSessionState, &context);
+    Dtls::Client *            client = Dtls::Client::Create(HandleClientState, &context);
+    const Metrics::Histogram *retransmissions;
+    const Metrics::Counter *  coalesced;
+    uint64_t                  handshakes;
+    uint64_t                  coalescedBefore;
+    uint64_t                  deadline;
+
+    memset(&context, 0, sizeof(context));
+    context.mClient      = client;
+    context.mClientState = -1;
+
+    // Records are never grouped without MTU.
+    server->SetRetransmissionTimeouts(200, 800);
+    server->SetMtu(0);
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->SetPSK(kTestPSK, sizeof(kTestPSK)));
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->Start());
+    CHECK_EQUAL(OTBR_ERROR_NONE, client->SetPSK(kTestPSK, sizeof(kTestPSK)));
+
+    retransmissions = static_cast<const Metrics::Histogram *>(FindMetric("dtls.handshake_retransmissions"));
+    coalesced       = static_cast<const Metrics::Counter *>(FindMetric("datagram.coalesced"));
+    CHECK(retransmissions != NULL);
+    CHECK(coalesced != NULL);
+    handshakes      = retransmissions->GetCount();
+    coalescedBefore = coalesced->GetValue();
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, client->Connect("::1", "49391"));
+
+    deadline = GetMonotonicNow() + 10000;
+    while ((context.mSession == NULL || client->GetState() == Dtls::Session::kStateHandshaking) &&
+           GetMonotonicNow() < deadline)
+    {
+        Poll(*server, *client);
+    }
+
+    CHECK(context.mSession != NULL);
+    CHECK_EQUAL(Dtls::Session::kStateReady, client->GetState());
+    CHECK_EQUAL(handshakes + 1, retransmissions->GetCount());
+    CHECK_EQUAL(coalescedBefore, coalesced->GetValue());
+
+    Dtls::Client::Destroy(client);
+    Dtls::Server::Destroy(server);
+}
+
+// The clock is set before the server, whose timers start from it.
+TEST_GROUP(DtlsVirtualClock)
+{
+    void setup(void) { VirtualClock::Set(1000000000); }
+    void teardown(void) { VirtualClock::Clear(); }
+};
+
+TEST(DtlsVirtualClock, TestSessionIdleTimeout)
+{
+    DtlsContext   context;
+    Dtls::Server *server;
+    Dtls::Client *client;
+
+    server = Dtls::Server::Create(kTestPort, HandleSessionState, &context);
+    client = Dtls::Client::Create(HandleClientState, &context);
+
+    memset(&context, 0, sizeof(context));
+    context.mClient      = client;
+    context.mClientState = -1;
+
+    server->SetSessionTimeouts(10000, 30000);
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->SetPSK(kTestPSK, sizeof(kTestPSK)));
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->Start());
+    CHECK_EQUAL(OTBR_ERROR_NONE, client->SetPSK(kTestPSK, sizeof(kTestPSK)));
+    CHECK_EQUAL(OTBR_ERROR_NONE, client->Connect("::1", "49391"));
+
+    // Flights are flushed from the next tick, so the clock is advanced by a millisecond for each poll.
+    for (int i = 0; i < 1000 && (context.mSession == NULL || client->GetState() == Dtls::Session::kStateHandshaking);
+         i++)
+    {
+        VirtualClock::Advance(1000);
+        Poll(*server, *client);
+    }
+
+    CHECK(context.mSession != NULL);
+    CHECK_EQUAL(Dtls::Session::kStateReady, client->GetState());
+
+    // The established session expires once the clock passes its idle timeout, without waiting for it.
+    VirtualClock::Advance(29000000);
+    Poll(*server, *client);
+    CHECK(context.mSession != NULL);
+
+    VirtualClock::Advance(1000000);
+    Poll(*server, *client);
+    POINTERS_EQUAL(NULL, context.mSession);
+
+    Dtls::Client::Destroy(client);
+    Dtls::Server::Destroy(server);
+}
+
+TEST(Dtls, TestDeferredHandshakes)
+{
+    DtlsContext             context;
+    Dtls::Server *          server = Dtls::Server::Create(kTestPort, HandleSessionState, &context);
+    Dtls::Client *          client = Dtls::Client::Create(HandleClientState, &context);
+    const Metrics::Counter *deferred;
+    uint64_t                deferredBefore;
+    uint64_t                deadline;
+
+    memset(&context, 0, sizeof(context));
+    context.mClient      = client;
+    context.mClientState = -1;
+
+    server->SetHandshakesDeferred(true);
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->SetPSK(kTestPSK, sizeof(kTestPSK)));
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->Start());
+    CHECK_EQUAL(OTBR_ERROR_NONE, client->SetPSK(kTestPSK, sizeof(kTestPSK)));
+
+    deferred = static_cast<const Metrics::Counter *>(FindMetric("dtls.deferred_handshakes"));
+    CHECK(deferred != NULL);
+    deferredBefore = deferred->GetValue();
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, client->Connect("::1", "49391"));
+
+    // The client keeps getting new cookies, the server never sets up its session.
+    deadline = GetMonotonicNow() + 10000;
+    while (deferred->GetValue() < deferredBefore + 2 && GetMonotonicNow() < deadline)
+    {
+        Poll(*server, *client);
+    }
+
+    CHECK(deferred->GetValue() >= deferredBefore + 2);
+    POINTERS_EQUAL(NULL, context.mSession);
+    CHECK_EQUAL(Dtls::Session::kStateHandshaking, client->GetState());
+
+    server->SetHandshakesDeferred(false);
+
+    deadline = GetMonotonicNow() + 10000;
+    while ((context.mSession == NULL || client->GetState() == Dtls::Session::kStateHandshaking) &&
+           GetMonotonicNow() < deadline)
+    {
+        Poll(*server, *client);
+    }
+
+    CHECK(context.mSession != NULL);
+    CHECK_EQUAL(Dtls::Session::kStateReady, client->GetState());
+
+    Dtls::Client::Destroy(client);
+    Dtls::Server::Destroy(server);
+}
+
+TEST(Dtls, TestRecordFilter)
+{
+    static const uint8_t kJunk[][16] = {
+        {0x16, 0xfe, 0xfd},                                                            // Shorter than a record header.
+        {0x30, 0xfe, 0xfd, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // Unknown content type.
+        {0x16, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // TLS version.
+    };
+    static const size_t kJunkLength[] = {3, 13, 13};
+
+    DtlsContext         context;
+    Dtls::Server *      server = Dtls::Server::Create(kTestPort, HandleSessionState, &context);
+    Dtls::Client *      client = Dtls::Client::Create(HandleClientState, &context);
+    int                 junkFd = socket(AF_INET6, SOCK_DGRAM, 0);
+    struct sockaddr_in6 sin6;
+    uint64_t            deadline;
+
+    memset(&context, 0, sizeof(context));
+    context.mClient      = client;
+    context.mClientState = -1;
+
+    server->SetSharedSocket(true);
+    server->SetRecordFilter(true);
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->SetPSK(kTestPSK, sizeof(kTestPSK)));
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->Start());
+    CHECK_EQUAL(OTBR_ERROR_NONE, client->SetPSK(kTestPSK, sizeof(kTestPSK)));
+
+    memset(&sin6, 0, sizeof(sin6));
+    sin6.sin6_family = AF_INET6;
+    sin6.sin6_port   = htons(kTestPort);
+    sin6.sin6_addr   = in6addr_loopback;
+    CHECK(junkFd >= 0);
+
+    for (size_t i = 0; i < sizeof(kJunkLength) / sizeof(kJunkLength[0]); ++i)
+    {
+        CHECK_EQUAL(static_cast<ssize_t>(kJunkLength[i]), sendto(junkFd, kJunk[i], kJunkLength[i], 0,
+                                                                 reinterpret_cast<struct sockaddr *>(&sin6),
+                                                                 sizeof(sin6)));
+    }
+
+    // Records still pass the filter.
+    CHECK_EQUAL(OTBR_ERROR_NONE, client->Connect("::1", "49391"));
+
+    deadline = GetMonotonicNow() + 10000;
+    while ((context.mSession == NULL || client->GetState() == Dtls::Session::kStateHandshaking) &&
+           GetMonotonicNow() < deadline)
+    {
+        Poll(*server, *client);
+    }
+
+    CHECK(context.mSession != NULL);
+    CHECK_EQUAL(Dtls::Session::kStateReady, client->GetState());
+
+    close(junkFd);
+    Dtls::Client::Destroy(client);
+    Dtls::Server::Destroy(server);
+}
+
+TEST(Dtls, TestConcurrentHandshakes)
+{
+    ConcurrentContext context;
+    Dtls::Server *    server = Dtls::Server::Create(kTestPort, HandleConcurrentSessionState, &context);
+    Dtls::Client *    clients[ConcurrentContext::kClients];
+    uint64_t          deadline;
+    bool              handshaking = true;
+
+    memset(&context, 0, sizeof(context));
+
+    // Handshakes run interleaved on the workers, each session exports its own keys.
+    server->SetHandshakeWorkers(2);
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->SetPSK(kTestPSK, sizeof(kTestPSK)));
+    CHECK_EQUAL(OTBR_ERROR_NONE, server->Start());
+
+    for (size_t i = 0; i < ConcurrentContext::kClients; ++i)
+    {
+        clients[i] = Dtls::Client::Create(HandleConcurrentClientState, &context);
+        CHECK_EQUAL(OTBR_ERROR_NONE, clients[i]->SetPSK(kTestPSK, sizeof(kTestPSK)));
+        CHECK_EQUAL(OTBR_ERROR_NONE, clients[i]->Connect("::1", "49391"));
+    }
+
+    deadline = GetMonotonicNow() + 10000;
+    while ((handshaking || context.mSessionCount < ConcurrentContext::kClients) && GetMonotonicNow() < deadline)
+    {
+        handshaking = false;
+
+        for (size_t i = 0; i < ConcurrentContext::kClients; ++i)
+        {
+            Poll(*server, *clients[i]);
+            handshaking = handshaking || clients[i]->GetState() == Dtls::Session::kStateHandshaking;
+        }
+    }
+
+    CHECK_EQUAL(ConcurrentContext::kClients, context.mSessionCount);
+
+    for (size_t i = 0; i < ConcurrentContext::kClients; ++i)
+    {
+        size_t matches = 0;
+
+        CHECK_EQUAL(Dtls::Session::kStateReady, clients[i]->GetState());
+
+        for (size_t j = 0; j < context.mSessionCount; ++j)
+        {
+            if (memcmp(context.mSessions[j]->GetKek(), clients[i]->GetKek(), 32) == 0)
+            {
+                matches++;
+            }
+        }
+
+        CHECK_EQUAL(1, matches);
+    }
+
+    for (size_t i = 0; i < ConcurrentContext::kClients; ++i)
+    {
+        Dtls::Client::Destroy(clients[i]);
+    }
+
+    Dtls::Server::Destroy(server);
+}
@@ -0,0 +1,162 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "agent/ecjpake_pool.hpp"
+
+using namespace ot::BorderRouter;
+
+static const unsigned char kTestSecret[] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                            0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+
+static int HandleRandom(void *aContext, unsigned char *aBuffer, size_t aLength)
+{
+    for (size_t i = 0; i < aLength; ++i)
+    {
+        aBuffer[i] = static_cast<unsigned char>(rand());
+    }
+
+    (void)aContext;
+
+    return 0;
+}
+
+/**
+ * This function runs an EC-JPAKE exchange and checks both sides derived the same premaster secret.
+ *
+ */
+static void CheckExchange(void)
+{
+    mbedtls_ecjpake_context server;
+    mbedtls_ecjpake_context client;
+    unsigned char           message[512];
+    unsigned char           serverSecret[32];
+    unsigned char           clientSecret[32];
+    size_t                  length;
+    size_t                  serverLength;
+    size_t                  clientLength;
+
+    mbedtls_ecjpake_init(&server);
+    mbedtls_ecjpake_init(&client);
+    CHECK_EQUAL(0, mbedtls_ecjpake_setup(&server, MBEDTLS_ECJPAKE_SERVER, MBEDTLS_MD_SHA256, MBEDTLS_ECP_DP_SECP256R1,
+                                         kTestSecret, sizeof(kTestSecret)));
+    CHECK_EQUAL(0, mbedtls_ecjpake_setup(&client, MBEDTLS_ECJPAKE_CLIENT, MBEDTLS_MD_SHA256, MBEDTLS_ECP_DP_SECP256R1,
+                                         kTestSecret, sizeof(kTestSecret)));
+
+    CHECK_EQUAL(0, mbedtls_ecjpake_write_round_one(&server, message, sizeof(message), &length, HandleRandom, NULL));
+    CHECK_EQUAL(0, mbedtls_ecjpake_read_round_one(&client, message, length));
+    CHECK_EQUAL(0, mbedtls_ecjpake_write_round_one(&client, message, sizeof(message), &length, HandleRandom, NULL));
+    CHECK_EQUAL(0, mbedtls_ecjpake_read_round_one(&server, message, length));
+
+    CHECK_EQUAL(0, mbedtls_ecjpake_write_round_two(&server, message, sizeof(message), &length, HandleRandom, NULL));
+    CHECK_EQUAL(0, mbedtls_ecjpake_read_round_two(&client, message, length));
+    CHECK_EQUAL(0, mbedtls_ecjpake_write_round_two(&client, message, sizeof(message), &length, HandleRandom, NULL));
+    CHECK_EQUAL(0, mbedtls_ecjpake_read_round_two(&server, message, length));
+
+    CHECK_EQUAL(0, mbedtls_ecjpake_derive_secret(&server, serverSecret, sizeof(serverSecret), &serverLength,
+                                                 HandleRandom, NULL));
+    CHECK_EQUAL(0, mbedtls_ecjpake_derive_secret(&client, clientSecret, sizeof(clientSecret), &clientLength,
+                                                 HandleRandom, NULL));
+    CHECK_EQUAL(serverLength, clientLength);
+    CHECK(memcmp(serverSecret, clientSecret, serverLength) == 0);
+
+    mbedtls_ecjpake_free(&server);
+    mbedtls_ecjpake_free(&client);
+}
+
+TEST_GROUP(EcjpakePool){};
+
+TEST(EcjpakePool, TestPrecomputedKeys)
+{
+    Dtls::EcjpakePool pool;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, pool.Init(2));
+    pool.Install();
+    CHECK(!pool.IsFull());
+    CHECK(pool.Precompute(HandleRandom, NULL));
+    CHECK(pool.Precompute(HandleRandom, NULL));
+    CHECK(pool.IsFull());
+    CHECK(!pool.Precompute(HandleRandom, NULL));
+    CHECK_EQUAL(2U, pool.GetCount());
+
+    // Each server takes a key, the client generates its own.
+    CheckExchange();
+    CHECK_EQUAL(1U, pool.GetCount());
+    CHECK(!pool.IsFull());
+    CheckExchange();
+    CHECK_EQUAL(0U, pool.GetCount());
+
+    // The empty pool falls back to generating keys, the taken ones are computed again.
+    CheckExchange();
+    CHECK(pool.Precompute(HandleRandom, NULL));
+    CHECK_EQUAL(1U, pool.GetCount());
+    CheckExchange();
+    CHECK_EQUAL(0U, pool.GetCount());
+
+    pool.Uninstall();
+}
+
+TEST(EcjpakePool, TestUnmatchedContexts)
+{
+    Dtls::EcjpakePool       pool;
+    mbedtls_ecjpake_context context;
+    unsigned char           message[512];
+    size_t                  length;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, pool.Init(1));
+    CHECK_EQUAL(OTBR_ERROR_NONE, pool.Init(4));
+    pool.Install();
+    CHECK(pool.Precompute(HandleRandom, NULL));
+    CHECK(pool.IsFull());
+
+    // Clients do not take the keys of the server.
+    mbedtls_ecjpake_init(&context);
+    CHECK_EQUAL(0, mbedtls_ecjpake_setup(&context, MBEDTLS_ECJPAKE_CLIENT, MBEDTLS_MD_SHA256, MBEDTLS_ECP_DP_SECP256R1,
+                                         kTestSecret, sizeof(kTestSecret)));
+    CHECK_EQUAL(0, mbedtls_ecjpake_write_round_one(&context, message, sizeof(message), &length, HandleRandom, NULL));
+    CHECK_EQUAL(1U, pool.GetCount());
+    mbedtls_ecjpake_free(&context);
+
+    // Buffers too small for the message are left to mbedtls.
+    mbedtls_ecjpake_init(&context);
+    CHECK_EQUAL(0, mbedtls_ecjpake_setup(&context, MBEDTLS_ECJPAKE_SERVER, MBEDTLS_MD_SHA256, MBEDTLS_ECP_DP_SECP256R1,
+                                         kTestSecret, sizeof(kTestSecret)));
+    CHECK(mbedtls_ecjpake_write_round_one(&context, message, 16, &length, HandleRandom, NULL) != 0);
+    CHECK_EQUAL(1U, pool.GetCount());
+    mbedtls_ecjpake_free(&context);
+
+    pool.Uninstall();
+
+    // Uninstalled pools are not used.
+    CheckExchange();
+    CHECK_EQUAL(1U, pool.GetCount());
+}
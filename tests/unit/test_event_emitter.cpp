@@ -178,3 +178,49 @@ TEST(EventEmitter, TestRemoveHandler)
     ee.Emit(event);
     CHECK_EQUAL(3, sCounter);
 }
+
+struct CounterEvent
+{
+    enum
+    {
+        kEvent = 4,
+    };
+
+    int mIncrement;
+};
+
+static void HandleCounterEvent(void *aContext, const CounterEvent &aEvent)
+{
+    *static_cast<int *>(aContext) += aEvent.mIncrement;
+}
+
+TEST(EventEmitter, TestTypedPayload)
+{
+    ot::BorderRouter::EventEmitter ee;
+    int                            counter1 = 0;
+    int                            counter2 = 0;
+    CounterEvent                   event    = {3};
+
+    ee.On(HandleCounterEvent, &counter1);
+    ee.On(HandleCounterEvent, &counter2);
+
+    // Handlers of variadic arguments are not called with payloads, and vice versa.
+    sContext = NULL;
+    sEvent   = CounterEvent::kEvent;
+    sCounter = 0;
+    ee.On(CounterEvent::kEvent, HandleSingleEvent, NULL);
+
+    ee.EmitPayload(event);
+    CHECK_EQUAL(3, counter1);
+    CHECK_EQUAL(3, counter2);
+    CHECK_EQUAL(0, sCounter);
+
+    ee.Emit(CounterEvent::kEvent);
+    CHECK_EQUAL(3, counter1);
+    CHECK_EQUAL(1, sCounter);
+
+    ee.Off(HandleCounterEvent, &counter1);
+    ee.EmitPayload(event);
+    CHECK_EQUAL(3, counter1);
+    CHECK_EQUAL(6, counter2);
+}
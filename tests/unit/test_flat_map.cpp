@@ -0,0 +1,129 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <map>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "common/flat_map.hpp"
+
+using namespace ot::BorderRouter;
+
+TEST_GROUP(FlatMap){};
+
+TEST(FlatMap, TestSetFindErase)
+{
+    FlatMap<int *, int> map;
+    int                 keys[3];
+
+    CHECK_EQUAL(0, map.GetSize());
+    CHECK(map.Find(&keys[0]) == NULL);
+    CHECK(!map.Erase(&keys[0]));
+    CHECK(map.Begin() == map.End());
+
+    CHECK(map.Set(&keys[0], 1));
+    CHECK(map.Set(&keys[1], 2));
+    CHECK(map.Set(&keys[0], 3));
+    CHECK_EQUAL(2, map.GetSize());
+    CHECK_EQUAL(3, *map.Find(&keys[0]));
+    CHECK_EQUAL(2, *map.Find(&keys[1]));
+    CHECK(map.Find(&keys[2]) == NULL);
+
+    CHECK(map.Erase(&keys[0]));
+    CHECK(map.Find(&keys[0]) == NULL);
+    CHECK_EQUAL(2, *map.Find(&keys[1]));
+    CHECK_EQUAL(1, map.GetSize());
+
+    map.Clear();
+    CHECK_EQUAL(0, map.GetSize());
+    CHECK(map.Find(&keys[1]) == NULL);
+}
+
+TEST(FlatMap, TestIterate)
+{
+    FlatMap<uint32_t, uint32_t> map;
+    uint32_t                    sum   = 0;
+    size_t                      count = 0;
+
+    for (uint32_t i = 1; i <= 100; i++)
+    {
+        CHECK(map.Set(i, i * 2));
+    }
+
+    for (FlatMap<uint32_t, uint32_t>::Iterator it = map.Begin(); it != map.End(); ++it)
+    {
+        CHECK_EQUAL(it->mKey * 2, it->mValue);
+        sum += it->mKey;
+        count++;
+    }
+
+    CHECK_EQUAL(100, count);
+    CHECK_EQUAL(5050, sum);
+}
+
+TEST(FlatMap, TestMatchesStdMap)
+{
+    FlatMap<uint32_t, uint32_t>  map;
+    std::map<uint32_t, uint32_t> reference;
+
+    srand(1);
+
+    // Few distinct keys in a growing map make long probe sequences, and erasing shifts them back.
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        uint32_t key = static_cast<uint32_t>(rand()) % 512;
+
+        if (rand() % 3 == 0)
+        {
+            CHECK_EQUAL(reference.erase(key) == 1, map.Erase(key));
+        }
+        else
+        {
+            reference[key] = i;
+            CHECK(map.Set(key, i));
+        }
+    }
+
+    CHECK_EQUAL(reference.size(), map.GetSize());
+
+    for (uint32_t key = 0; key < 512; key++)
+    {
+        std::map<uint32_t, uint32_t>::const_iterator it    = reference.find(key);
+        const uint32_t *                             value = map.Find(key);
+
+        CHECK_EQUAL(it != reference.end(), value != NULL);
+
+        if (value != NULL)
+        {
+            CHECK_EQUAL(it->second, *value);
+        }
+    }
+}
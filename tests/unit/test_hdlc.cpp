@@ -0,0 +1,146 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+
+#include "agent/hdlc.hpp"
+
+using namespace ot::BorderRouter;
+
+struct DecodedFrames
+{
+    int      mCount;
+    uint16_t mLength;
+    uint8_t  mFrame[Hdlc::Decoder::kMaxFrameSize];
+};
+
+static void HandleFrame(const uint8_t *aFrame, uint16_t aLength, void *aContext)
+{
+    DecodedFrames &frames = *static_cast<DecodedFrames *>(aContext);
+
+    frames.mCount++;
+    frames.mLength = aLength;
+    memcpy(frames.mFrame, aFrame, aLength);
+}
+
+TEST_GROUP(Hdlc){};
+
+TEST(Hdlc, TestEncodeFcs)
+{
+    const uint8_t frame[]    = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    uint8_t       buffer[32] = {0};
+    uint16_t      size       = sizeof(buffer);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, Hdlc::Encode(frame, sizeof(frame), buffer, size));
+
+    // CRC-16/X-25 check value of "123456789" is 0x906e.
+    CHECK_EQUAL(sizeof(frame) + 4, size);
+    CHECK_EQUAL(0x7e, buffer[0]);
+    CHECK(memcmp(frame, buffer + 1, sizeof(frame)) == 0);
+    CHECK_EQUAL(0x6e, buffer[size - 3]);
+    CHECK_EQUAL(0x90, buffer[size - 2]);
+    CHECK_EQUAL(0x7e, buffer[size - 1]);
+}
+
+TEST(Hdlc, TestEncodeEscapeAndOverflow)
+{
+    const uint8_t frame[]    = {0x7e, 0x7d, 0x11, 0x13, 0xf8, 0x00};
+    uint8_t       buffer[32] = {0};
+    uint16_t      size       = sizeof(buffer);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, Hdlc::Encode(frame, sizeof(frame), buffer, size));
+    CHECK(size >= 2 + 5 * 2 + 1 + 2);
+    CHECK_EQUAL(0x7d, buffer[1]);
+    CHECK_EQUAL(0x5e, buffer[2]);
+    CHECK_EQUAL(0x7d, buffer[3]);
+    CHECK_EQUAL(0x5d, buffer[4]);
+
+    for (uint16_t i = 1; i + 1 < size; ++i)
+    {
+        CHECK(buffer[i] != 0x7e);
+    }
+
+    size = 8;
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, Hdlc::Encode(frame, sizeof(frame), buffer, size));
+}
+
+TEST(Hdlc, TestDecodeRoundTrip)
+{
+    DecodedFrames frames = {0, 0, {0}};
+    Hdlc::Decoder decoder(HandleFrame, &frames);
+    uint8_t       frame[256];
+    uint8_t       buffer[sizeof(frame) * 2 + 8];
+    uint16_t      size = sizeof(buffer);
+
+    for (size_t i = 0; i < sizeof(frame); ++i)
+    {
+        frame[i] = static_cast<uint8_t>(i);
+    }
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, Hdlc::Encode(frame, sizeof(frame), buffer, size));
+
+    // Noise before the first flag is ignored, and frames may span chunks.
+    decoder.Decode(reinterpret_cast<const uint8_t *>("noise"), 5);
+    for (uint16_t i = 0; i < size; i += 7)
+    {
+        decoder.Decode(buffer + i, static_cast<uint16_t>(size - i < 7 ? size - i : 7));
+    }
+
+    CHECK_EQUAL(1, frames.mCount);
+    CHECK_EQUAL(sizeof(frame), frames.mLength);
+    CHECK(memcmp(frame, frames.mFrame, sizeof(frame)) == 0);
+    CHECK_EQUAL(0, decoder.GetErrorCount());
+
+    // The closing flag of a frame may open the next one.
+    decoder.Decode(buffer + 1, static_cast<uint16_t>(size - 1));
+    CHECK_EQUAL(2, frames.mCount);
+}
+
+TEST(Hdlc, TestDecodeBadFcs)
+{
+    DecodedFrames frames = {0, 0, {0}};
+    Hdlc::Decoder decoder(HandleFrame, &frames);
+    const uint8_t frame[]    = {0x81, 0x06, 0x00};
+    uint8_t       buffer[16] = {0};
+    uint16_t      size       = sizeof(buffer);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, Hdlc::Encode(frame, sizeof(frame), buffer, size));
+    buffer[2] ^= 0x01;
+    decoder.Decode(buffer, size);
+
+    CHECK_EQUAL(0, frames.mCount);
+    CHECK_EQUAL(1, decoder.GetErrorCount());
+
+    // Decoding resumes with the next frame.
+    buffer[2] ^= 0x01;
+    decoder.Decode(buffer, size);
+    CHECK_EQUAL(1, frames.mCount);
+    CHECK_EQUAL(sizeof(frame), frames.mLength);
+}
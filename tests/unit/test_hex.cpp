@@ -0,0 +1,136 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "utils/cpu_features.hpp"
+#include "utils/hex.hpp"
+
+TEST_GROUP(Hex){};
+
+TEST(Hex, TestHex2Bytes)
+{
+    const uint8_t kBytes[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xfe, 0xdc, 0xba, 0x98,
+                              0x76, 0x54, 0x32, 0x10, 0x0f, 0xf0, 0xaa};
+    uint8_t       bytes[sizeof(kBytes)];
+
+    LONGS_EQUAL(sizeof(kBytes), ot::Utils::Hex2Bytes("0123456789abcdefFEDCBA98765432100FF0aA", bytes, sizeof(bytes)));
+    MEMCMP_EQUAL(kBytes, bytes, sizeof(kBytes));
+
+    // An odd number of digits starts with a low nibble.
+    LONGS_EQUAL(2, ot::Utils::Hex2Bytes("abc", bytes, sizeof(bytes)));
+    LONGS_EQUAL(0x0a, bytes[0]);
+    LONGS_EQUAL(0xbc, bytes[1]);
+
+    LONGS_EQUAL(0, ot::Utils::Hex2Bytes("", bytes, sizeof(bytes)));
+    LONGS_EQUAL(-1, ot::Utils::Hex2Bytes("0123", bytes, 1));
+
+    // Digits of a known length need not be null-terminated.
+    LONGS_EQUAL(1, ot::Utils::Hex2Bytes("18b4", 2, bytes, sizeof(bytes)));
+    LONGS_EQUAL(0x18, bytes[0]);
+}
+
+TEST(Hex, TestHex2BytesInvalid)
+{
+    const char kValid[]   = "00112233445566778899aabbccddeeff00112233";
+    const char kInvalid[] = {'/', ':', '@', 'G', '`', 'g', ' ', '\x10', '\x80', '\xb0', '\xe1'};
+    uint8_t    bytes[sizeof(kValid) / 2];
+
+    // Every position of the vector and scalar paths rejects characters around the hex digit ranges.
+    for (size_t i = 0; i < sizeof(kValid) - 1; i++)
+    {
+        for (size_t j = 0; j < sizeof(kInvalid); j++)
+        {
+            char hex[sizeof(kValid)];
+
+            memcpy(hex, kValid, sizeof(hex));
+            hex[i] = kInvalid[j];
+            LONGS_EQUAL(-1, ot::Utils::Hex2Bytes(hex, bytes, sizeof(bytes)));
+        }
+    }
+}
+
+TEST(Hex, TestBytes2Hex)
+{
+    uint8_t bytes[256];
+    char    hex[sizeof(bytes) * 2 + 1];
+    char    expected[sizeof(bytes) * 2 + 1];
+    uint8_t decoded[sizeof(bytes)];
+
+    for (size_t i = 0; i < sizeof(bytes); i++)
+    {
+        bytes[i] = static_cast<uint8_t>(i * 7 + 3);
+        sprintf(&expected[i * 2], "%02X", bytes[i]);
+    }
+
+    for (size_t length = 0; length <= sizeof(bytes); length += 5)
+    {
+        LONGS_EQUAL(length * 2, ot::Utils::Bytes2Hex(bytes, static_cast<uint16_t>(length), hex));
+        LONGS_EQUAL(length * 2, strlen(hex));
+        MEMCMP_EQUAL(expected, hex, length * 2);
+
+        LONGS_EQUAL(length, ot::Utils::Hex2Bytes(hex, length * 2, decoded, sizeof(decoded)));
+        MEMCMP_EQUAL(bytes, decoded, length);
+    }
+}
+
+TEST(Hex, TestLong2Hex)
+{
+    char hex[17];
+
+    LONGS_EQUAL(16, ot::Utils::Long2Hex(0x0123456789abcdefULL, hex));
+    STRCMP_EQUAL("EFCDAB8967452301", hex);
+}
+
+TEST(Hex, TestKernels)
+{
+    uint8_t bytes[40];
+    uint8_t decoded[sizeof(bytes)];
+    char    hex[2][sizeof(bytes) * 2 + 1];
+
+    for (size_t i = 0; i < sizeof(bytes); i++)
+    {
+        bytes[i] = static_cast<uint8_t>(i * 53 + 3);
+    }
+
+    // The vector kernels and the scalar code agree, with every feature detected and none.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        ot::Utils::CpuFeatures::Disable(pass == 0 ? 0 : static_cast<uint32_t>(ot::Utils::CpuFeatures::kAll));
+
+        LONGS_EQUAL(sizeof(bytes) * 2, ot::Utils::Bytes2Hex(bytes, sizeof(bytes), hex[pass]));
+        LONGS_EQUAL(sizeof(bytes), ot::Utils::Hex2Bytes(hex[pass], decoded, sizeof(decoded)));
+        MEMCMP_EQUAL(bytes, decoded, sizeof(bytes));
+    }
+
+    STRCMP_EQUAL(hex[0], hex[1]);
+    ot::Utils::CpuFeatures::Disable(0);
+}
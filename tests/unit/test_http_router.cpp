@@ -0,0 +1,87 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+
+#include <CppUTest/TestHarness.h>
+
+#include "web-service/http_router.hpp"
+
+using ot::Web::HttpRouter;
+
+TEST_GROUP(HttpRouter){};
+
+TEST(HttpRouter, TestFind)
+{
+    HttpRouter<int> router;
+
+    POINTERS_EQUAL(NULL, router.Find("GET", "/metrics"));
+
+    router.Add("GET", "/metrics", 1);
+    router.Add("GET", "/get_properties", 2);
+    router.Add("POST", "/add_prefix", 3);
+    router.Add("GET", "/add_prefix", 4);
+
+    CHECK_EQUAL(1, *router.Find("GET", "/metrics"));
+    CHECK_EQUAL(2, *router.Find("GET", "/get_properties"));
+    CHECK_EQUAL(3, *router.Find("POST", "/add_prefix"));
+    CHECK_EQUAL(4, *router.Find("GET", "/add_prefix"));
+
+    // The query string is ignored, the path and method match exactly.
+    CHECK_EQUAL(1, *router.Find("GET", "/metrics?format=text"));
+    POINTERS_EQUAL(NULL, router.Find("POST", "/metrics"));
+    POINTERS_EQUAL(NULL, router.Find("GET", "/metrics/"));
+    POINTERS_EQUAL(NULL, router.Find("GET", "/metric"));
+    POINTERS_EQUAL(NULL, router.Find("GET", "/"));
+    POINTERS_EQUAL(NULL, router.Find("GET", ""));
+
+    // A route added again replaces the handler.
+    router.Add("GET", "/metrics", 5);
+    CHECK_EQUAL(5, *router.Find("GET", "/metrics"));
+}
+
+TEST(HttpRouter, TestManyRoutes)
+{
+    static char     paths[100][16];
+    HttpRouter<int> router;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        snprintf(paths[i], sizeof(paths[i]), "/route_%d", i);
+        router.Add("GET", paths[i], i);
+    }
+
+    // Every route has a slot of its own.
+    CHECK(router.GetTableSize() >= 200);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        CHECK_EQUAL(i, *router.Find("GET", paths[i]));
+        POINTERS_EQUAL(NULL, router.Find("POST", paths[i]));
+    }
+}
@@ -0,0 +1,182 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include <CppUTest/TestHarness.h>
+
+#include "web-service/interface_table.hpp"
+
+using ot::Web::InterfaceTable;
+
+TEST_GROUP(InterfaceTable){};
+
+static const int     kIfIndex     = 7;
+static const uint8_t kLinkLocal[] = {0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x11, 0x22, 0xff, 0xfe, 0x33, 0x44, 0x55};
+static const uint8_t kMeshLocal[] = {0xfd, 0xde, 0xad, 0x00, 0xbe, 0xef, 0, 0, 0x12, 0x34, 0, 0, 0, 0, 0, 0x01};
+
+static void AppendAttribute(uint8_t *aBuffer, size_t &aLength, uint16_t aType, const void *aData, size_t aSize)
+{
+    struct rtattr *attr = reinterpret_cast<struct rtattr *>(aBuffer + aLength);
+
+    attr->rta_type = aType;
+    attr->rta_len  = RTA_LENGTH(aSize);
+    memcpy(RTA_DATA(attr), aData, aSize);
+    aLength += RTA_SPACE(aSize);
+}
+
+static size_t AppendLink(uint8_t *   aBuffer,
+                         size_t      aOffset,
+                         uint16_t    aType,
+                         int         aIndex,
+                         const char *aName,
+                         unsigned    aFlags)
+{
+    struct nlmsghdr * header = reinterpret_cast<struct nlmsghdr *>(aBuffer + aOffset);
+    struct ifinfomsg *info   = static_cast<struct ifinfomsg *>(NLMSG_DATA(header));
+    size_t            length = NLMSG_LENGTH(sizeof(*info));
+
+    memset(header, 0, length);
+    info->ifi_index = aIndex;
+    info->ifi_flags = aFlags;
+    length          = NLMSG_ALIGN(length);
+    AppendAttribute(reinterpret_cast<uint8_t *>(header), length, IFLA_IFNAME, aName, strlen(aName) + 1);
+    header->nlmsg_type = aType;
+    header->nlmsg_len  = static_cast<uint32_t>(length);
+
+    return aOffset + NLMSG_ALIGN(length);
+}
+
+static size_t AppendAddress(uint8_t *      aBuffer,
+                            size_t         aOffset,
+                            uint16_t       aType,
+                            int            aIndex,
+                            const uint8_t *aAddress,
+                            uint8_t        aPrefixLength)
+{
+    struct nlmsghdr * header = reinterpret_cast<struct nlmsghdr *>(aBuffer + aOffset);
+    struct ifaddrmsg *info   = static_cast<struct ifaddrmsg *>(NLMSG_DATA(header));
+    size_t            length = NLMSG_LENGTH(sizeof(*info));
+
+    memset(header, 0, length);
+    info->ifa_family    = AF_INET6;
+    info->ifa_index     = static_cast<uint32_t>(aIndex);
+    info->ifa_prefixlen = aPrefixLength;
+    length              = NLMSG_ALIGN(length);
+    AppendAttribute(reinterpret_cast<uint8_t *>(header), length, IFA_ADDRESS, aAddress, 16);
+    header->nlmsg_type = aType;
+    header->nlmsg_len  = static_cast<uint32_t>(length);
+
+    return aOffset + NLMSG_ALIGN(length);
+}
+
+TEST(InterfaceTable, TestLinkAndAddresses)
+{
+    InterfaceTable        table;
+    InterfaceTable::State state;
+    uint8_t               buffer[1024];
+    size_t                length = 0;
+
+    CHECK(!table.IsValid());
+
+    // Addresses of an interface not found yet are ignored.
+    length = AppendAddress(buffer, 0, RTM_NEWADDR, kIfIndex, kLinkLocal, 64);
+    CHECK(!table.HandleMessages(buffer, length));
+
+    // Only the link of the interface name is tracked.
+    length = AppendLink(buffer, 0, RTM_NEWLINK, 1, "lo", IFF_UP | IFF_RUNNING);
+    CHECK(!table.HandleMessages(buffer, length));
+
+    table.Open("wpan0");
+    length = AppendLink(buffer, 0, RTM_NEWLINK, 1, "lo", IFF_UP | IFF_RUNNING);
+    length = AppendLink(buffer, length, RTM_NEWLINK, kIfIndex, "wpan0", IFF_UP);
+    length = AppendAddress(buffer, length, RTM_NEWADDR, kIfIndex, kLinkLocal, 64);
+    length = AppendAddress(buffer, length, RTM_NEWADDR, kIfIndex, kMeshLocal, 64);
+    length = AppendAddress(buffer, length, RTM_NEWADDR, 1, kMeshLocal, 128);
+    CHECK(table.HandleMessages(buffer, length));
+
+    table.GetState(state);
+    CHECK(state.mExists);
+    CHECK(state.mUp);
+    CHECK(!state.mRunning);
+    LONGS_EQUAL(2, state.mAddressCount);
+    MEMCMP_EQUAL(kLinkLocal, state.mAddresses[0].mAddress, sizeof(kLinkLocal));
+    MEMCMP_EQUAL(kMeshLocal, state.mAddresses[1].mAddress, sizeof(kMeshLocal));
+    LONGS_EQUAL(64, state.mAddresses[1].mPrefixLength);
+
+    // Repeated messages are no change.
+    CHECK(!table.HandleMessages(buffer, length));
+
+    length = AppendLink(buffer, 0, RTM_NEWLINK, kIfIndex, "wpan0", IFF_UP | IFF_RUNNING);
+    length = AppendAddress(buffer, length, RTM_DELADDR, kIfIndex, kLinkLocal, 64);
+    CHECK(table.HandleMessages(buffer, length));
+
+    table.GetState(state);
+    CHECK(state.mRunning);
+    LONGS_EQUAL(1, state.mAddressCount);
+    MEMCMP_EQUAL(kMeshLocal, state.mAddresses[0].mAddress, sizeof(kMeshLocal));
+
+    // The addresses go with the interface.
+    length = AppendLink(buffer, 0, RTM_DELLINK, kIfIndex, "wpan0", 0);
+    CHECK(table.HandleMessages(buffer, length));
+
+    table.GetState(state);
+    CHECK(!state.mExists);
+    LONGS_EQUAL(0, state.mAddressCount);
+
+    length = AppendAddress(buffer, 0, RTM_NEWADDR, kIfIndex, kLinkLocal, 64);
+    CHECK(!table.HandleMessages(buffer, length));
+}
+
+TEST(InterfaceTable, TestMaxAddresses)
+{
+    InterfaceTable        table;
+    InterfaceTable::State state;
+    uint8_t               buffer[4096];
+    uint8_t               address[16];
+    size_t                length;
+
+    table.Open("wpan0");
+    length = AppendLink(buffer, 0, RTM_NEWLINK, kIfIndex, "wpan0", IFF_UP);
+
+    memcpy(address, kMeshLocal, sizeof(address));
+
+    for (int i = 0; i < InterfaceTable::kMaxAddresses + 2; i++)
+    {
+        address[15] = static_cast<uint8_t>(i);
+        length      = AppendAddress(buffer, length, RTM_NEWADDR, kIfIndex, address, 64);
+    }
+
+    CHECK(table.HandleMessages(buffer, length));
+
+    table.GetState(state);
+    LONGS_EQUAL(InterfaceTable::kMaxAddresses, state.mAddressCount);
+    LONGS_EQUAL(InterfaceTable::kMaxAddresses - 1, state.mAddresses[InterfaceTable::kMaxAddresses - 1].mAddress[15]);
+}
@@ -0,0 +1,149 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "utils/joiner_id_cache.hpp"
+#include "utils/steeringdata_builder.hpp"
+
+TEST_GROUP(JoinerIdCache){};
+
+static void FillEui64s(uint8_t *aEntries, size_t aCount)
+{
+    for (size_t i = 0; i < aCount; i++)
+    {
+        uint8_t *entry = aEntries + i * ot::JoinerIdCache::kEui64Length;
+
+        memset(entry, 0, ot::JoinerIdCache::kEui64Length);
+        entry[0] = 0x18;
+        entry[1] = 0xb4;
+        entry[6] = static_cast<uint8_t>(i >> 8);
+        entry[7] = static_cast<uint8_t>(i);
+    }
+}
+
+TEST(JoinerIdCache, TestPersistent)
+{
+    char              path[] = "/tmp/otbr-joiner-ids-XXXXXX";
+    int               fd     = mkstemp(path);
+    uint8_t           eui64s[16 * ot::JoinerIdCache::kEui64Length];
+    uint8_t           expected[ot::JoinerIdCache::kEui64Length];
+    uint8_t           joinerId[ot::JoinerIdCache::kEui64Length];
+    ot::JoinerIdCache cache;
+    ot::JoinerIdCache other;
+
+    CHECK(fd >= 0);
+    close(fd);
+    FillEui64s(eui64s, 16);
+
+    // A closed cache still computes joiner IDs.
+    cache.ComputeJoinerId(eui64s, joinerId);
+    ot::SteeringDataBuilder::ComputeJoinerId(eui64s, expected);
+    CHECK_EQUAL(0, memcmp(expected, joinerId, sizeof(joinerId)));
+    CHECK(!cache.Find(eui64s, joinerId));
+
+    // The empty file is not a cache file, so it is started again.
+    CHECK(cache.Open(path, 30));
+    CHECK_EQUAL(0, cache.GetCount());
+
+    // The file is locked while open.
+    CHECK(!other.Open(path));
+    CHECK_EQUAL(EWOULDBLOCK, errno);
+
+    for (size_t i = 0; i < 16; i++)
+    {
+        cache.ComputeJoinerId(eui64s + i * ot::JoinerIdCache::kEui64Length, joinerId);
+    }
+
+    cache.ComputeJoinerId(eui64s, joinerId);
+    CHECK_EQUAL(0, memcmp(expected, joinerId, sizeof(joinerId)));
+    CHECK_EQUAL(1, cache.GetHits());
+    CHECK_EQUAL(16, cache.GetMisses());
+
+    // 32 slots keep at most 24 entries.
+    CHECK_EQUAL(16, cache.GetCount());
+    cache.Close();
+
+    // Entries are kept across opens, with the capacity of the file.
+    CHECK(other.Open(path, 4096));
+    CHECK_EQUAL(16, other.GetCount());
+    memset(joinerId, 0, sizeof(joinerId));
+    CHECK(other.Find(eui64s, joinerId));
+    CHECK_EQUAL(0, memcmp(expected, joinerId, sizeof(joinerId)));
+
+    for (size_t i = 0; i < 16; i++)
+    {
+        ot::SteeringDataBuilder::ComputeJoinerId(expected, joinerId);
+        other.Insert(expected, joinerId);
+        expected[0]++;
+    }
+
+    CHECK_EQUAL(24, other.GetCount());
+    CHECK(!other.Insert(expected, joinerId));
+    other.Close();
+
+    unlink(path);
+}
+
+TEST(JoinerIdCache, TestBuilder)
+{
+    char                    path[] = "/tmp/otbr-joiner-ids-XXXXXX";
+    int                     fd     = mkstemp(path);
+    uint8_t                 eui64s[64 * ot::JoinerIdCache::kEui64Length];
+    ot::JoinerIdCache       cache;
+    ot::SteeringDataBuilder plain;
+    ot::SteeringDataBuilder cached;
+
+    CHECK(fd >= 0);
+    close(fd);
+    FillEui64s(eui64s, 64);
+    CHECK(cache.Open(path, 256));
+
+    plain.Init(16);
+    plain.Add(eui64s, 64, ot::SteeringDataBuilder::kEntryEui64, 1);
+
+    // Joiner IDs hashed by the builder are cached, then reused.
+    cached.SetJoinerIdCache(&cache);
+    cached.Init(16);
+    cached.Add(eui64s, 32, ot::SteeringDataBuilder::kEntryEui64, 1);
+    CHECK_EQUAL(32, cache.GetCount());
+    cached.Init(16);
+    cached.Add(eui64s, 64, ot::SteeringDataBuilder::kEntryEui64, 1);
+    CHECK_EQUAL(64, cache.GetCount());
+
+    CHECK_EQUAL(0, memcmp(plain.GetSteeringData().GetDataPointer(), cached.GetSteeringData().GetDataPointer(), 16));
+
+    cache.Close();
+    unlink(path);
+}
@@ -0,0 +1,169 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <CppUTest/TestHarness.h>
+
+#include "web-service/json_stream.hpp"
+
+using ot::Web::JsonReader;
+using ot::Web::JsonWriter;
+
+TEST_GROUP(JsonStream){};
+
+TEST(JsonStream, TestWriteObject)
+{
+    std::string output;
+    JsonWriter  writer(output);
+
+    writer.BeginObject();
+    writer.Key("result");
+    writer.String("a \"quoted\"\\\n\x01");
+    writer.Key("error");
+    writer.Int(-3);
+    writer.Key("info");
+    writer.BeginObject();
+    writer.Key("up");
+    writer.Bool(true);
+    writer.EndObject();
+    writer.Key("empty");
+    writer.BeginObject();
+    writer.EndObject();
+    writer.EndObject();
+
+    STRCMP_EQUAL("{\"result\":\"a \\\"quoted\\\"\\\\\\n\\u0001\",\"error\":-3,\"info\":{\"up\":true},\"empty\":{}}",
+                 output.c_str());
+}
+
+TEST(JsonStream, TestWriteRaw)
+{
+    std::string output;
+    JsonWriter  writer(output);
+
+    writer.BeginObject();
+    writer.Key("result");
+    writer.BeginArray();
+    writer.Raw("{\"result\":\"successful\",\"error\":0}\n");
+    writer.Raw("[1,2]");
+    writer.EndArray();
+    writer.Key("error");
+    writer.Int(0);
+    writer.EndObject();
+
+    STRCMP_EQUAL("{\"result\":[{\"result\":\"successful\",\"error\":0},[1,2]],\"error\":0}", output.c_str());
+}
+
+TEST(JsonStream, TestWriteArray)
+{
+    std::string output;
+    JsonWriter  writer(output);
+
+    writer.BeginArray();
+    writer.Unsigned(4294967295UL);
+    writer.BeginObject();
+    writer.Key("rloc16");
+    writer.String("0x0400");
+    writer.EndObject();
+    writer.BeginArray();
+    writer.EndArray();
+    writer.Bool(false);
+    writer.EndArray();
+
+    STRCMP_EQUAL("[4294967295,{\"rloc16\":\"0x0400\"},[],false]", output.c_str());
+}
+
+TEST(JsonStream, TestReadFlatObject)
+{
+    static const char kJson[] = " {\"prefix\" : \"fd11:22::/64\", \"skipped\": [1], \"index\":7,"
+                               "\"name\":\"a\\\"b\\\\c\\n\", \"other\": -1.5e3, \"defaultRoute\": true, \"x\": null} ";
+    std::string       prefix = "old", name;
+    unsigned int      index  = 1;
+    bool              defaultRoute;
+    JsonReader::Field fields[] = {
+        {"prefix", JsonReader::kTypeString, &prefix},
+        {"index", JsonReader::kTypeUnsigned, &index},
+        {"name", JsonReader::kTypeString, &name},
+        {"defaultRoute", JsonReader::kTypeBool, &defaultRoute},
+    };
+    const size_t      kCount = sizeof(fields) / sizeof(fields[0]);
+
+    // Nested values are not read.
+    CHECK(!JsonReader::Parse(kJson, sizeof(kJson) - 1, fields, kCount));
+
+    static const char kFlat[] = " {\"prefix\" : \"fd11:22::/64\", \"index\":7,"
+                                "\"name\":\"a\\\"b\\\\c\\n\", \"other\": -1.5e3, \"defaultRoute\": true, \"x\": null} ";
+
+    CHECK(JsonReader::Parse(kFlat, sizeof(kFlat) - 1, fields, kCount));
+    STRCMP_EQUAL("fd11:22::/64", prefix.c_str());
+    STRCMP_EQUAL("a\"b\\c\n", name.c_str());
+    UNSIGNED_LONGS_EQUAL(7, index);
+    CHECK(defaultRoute);
+
+    // Missing members and null values are reset.
+    static const char kPartial[] = "{\"name\":null}";
+
+    CHECK(JsonReader::Parse(kPartial, sizeof(kPartial) - 1, fields, kCount));
+    STRCMP_EQUAL("", prefix.c_str());
+    STRCMP_EQUAL("", name.c_str());
+    UNSIGNED_LONGS_EQUAL(0, index);
+    CHECK(!defaultRoute);
+}
+
+TEST(JsonStream, TestReadUnsupported)
+{
+    std::string       prefix;
+    unsigned int      index;
+    JsonReader::Field fields[] = {
+        {"prefix", JsonReader::kTypeString, &prefix},
+        {"index", JsonReader::kTypeUnsigned, &index},
+    };
+    const char *const kInvalid[] = {
+        "",
+        "[]",
+        "{\"prefix\":\"a\"",
+        "{\"prefix\":\"a\",}",
+        "{\"prefix\":\"a\"} x",
+        "{\"prefix\":1}",
+        "{\"index\":\"1\"}",
+        "{\"index\":-1}",
+        "{\"index\":1.5}",
+        "{\"index\":4294967296}",
+        "{\"prefix\":\"\\u0041\"}",
+        "{\"pre\\u0066ix\":\"a\"}",
+    };
+
+    for (size_t i = 0; i < sizeof(kInvalid) / sizeof(kInvalid[0]); i++)
+    {
+        CHECK(!JsonReader::Parse(kInvalid[i], strlen(kInvalid[i]), fields, 2));
+    }
+
+    CHECK(JsonReader::Parse("{}", 2, fields, 2));
+    CHECK(JsonReader::Parse("{\"index\":4294967295}", 20, fields, 2));
+    UNSIGNED_LONGS_EQUAL(4294967295U, index);
+}
@@ -0,0 +1,121 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include "common/load_shedder.hpp"
+
+using namespace ot::BorderRouter;
+
+TEST_GROUP(LoadShedder){};
+
+TEST(LoadShedder, TestDisabled)
+{
+    LoadShedder shedder;
+
+    for (uint64_t now = 1; now < 10000; now += 100)
+    {
+        CHECK_EQUAL(LoadShedder::kLevelNormal, shedder.Update(1000000, 16, 16, now));
+    }
+
+    // The latency is still smoothed.
+    CHECK(shedder.GetLatency() > 990000 && shedder.GetLatency() <= 1000000);
+}
+
+TEST(LoadShedder, TestProgressive)
+{
+    const uint64_t kStart = 123456;
+    LoadShedder    shedder;
+    uint64_t       now = kStart;
+
+    shedder.SetThreshold(10000);
+
+    // Short iterations shed nothing, a single slow one is smoothed out.
+    for (int i = 0; i < 100; ++i)
+    {
+        CHECK_EQUAL(LoadShedder::kLevelNormal, shedder.Update(1000, 0, 32, now++));
+    }
+
+    CHECK_EQUAL(LoadShedder::kLevelNormal, shedder.Update(50000, 0, 32, now++));
+
+    // Sustained slow iterations raise the level at once, then once per hold time.
+    while (shedder.Update(50000, 0, 32, now) == LoadShedder::kLevelNormal)
+    {
+        ++now;
+    }
+
+    CHECK_EQUAL(LoadShedder::kLevelDeferHandshakes, shedder.GetLevel());
+    CHECK_EQUAL(LoadShedder::kLevelDeferHandshakes, shedder.Update(50000, 0, 32, now + 999));
+    CHECK_EQUAL(LoadShedder::kLevelRejectPetitions, shedder.Update(50000, 0, 32, now + 1000));
+    CHECK_EQUAL(LoadShedder::kLevelDropRelay, shedder.Update(50000, 0, 32, now + 2000));
+    CHECK_EQUAL(LoadShedder::kLevelDropRelay, shedder.Update(50000, 0, 32, now + 5000));
+    now += 5000;
+
+    // Between half the threshold and the threshold, the level is kept.
+    while (shedder.GetLatency() >= 10000)
+    {
+        shedder.Update(7000, 0, 32, ++now);
+    }
+
+    CHECK_EQUAL(LoadShedder::kLevelDropRelay, shedder.Update(7000, 0, 32, now + 10000));
+    now += 10000;
+
+    // It falls by one per hold time once the load is low.
+    while (shedder.GetLatency() >= 5000)
+    {
+        shedder.Update(0, 0, 32, ++now);
+    }
+
+    CHECK_EQUAL(LoadShedder::kLevelDropRelay, shedder.Update(0, 0, 32, now + 999));
+    CHECK_EQUAL(LoadShedder::kLevelRejectPetitions, shedder.Update(0, 0, 32, now + 1000));
+    CHECK_EQUAL(LoadShedder::kLevelDeferHandshakes, shedder.Update(0, 0, 32, now + 2000));
+    CHECK_EQUAL(LoadShedder::kLevelNormal, shedder.Update(0, 0, 32, now + 3000));
+    CHECK_EQUAL(LoadShedder::kLevelNormal, shedder.Update(0, 0, 32, now + 9000));
+}
+
+TEST(LoadShedder, TestQueues)
+{
+    LoadShedder shedder;
+
+    shedder.SetThreshold(10000);
+    shedder.SetHoldTime(100);
+
+    CHECK_EQUAL(LoadShedder::kLevelNormal, shedder.Update(0, 23, 32, 1000));
+    CHECK_EQUAL(LoadShedder::kLevelDeferHandshakes, shedder.Update(0, 24, 32, 1001));
+    CHECK_EQUAL(LoadShedder::kLevelRejectPetitions, shedder.Update(0, 24, 32, 1101));
+
+    // Queues more than a quarter full keep the level.
+    CHECK_EQUAL(LoadShedder::kLevelRejectPetitions, shedder.Update(0, 9, 32, 1300));
+    CHECK_EQUAL(LoadShedder::kLevelRejectPetitions, shedder.Update(0, 8, 32, 1301));
+    CHECK_EQUAL(LoadShedder::kLevelDeferHandshakes, shedder.Update(0, 8, 32, 1401));
+
+    // Disabling stops shedding at once.
+    shedder.SetThreshold(0);
+    CHECK_EQUAL(LoadShedder::kLevelNormal, shedder.GetLevel());
+    CHECK_EQUAL(LoadShedder::kLevelNormal, shedder.Update(0, 32, 32, 1402));
+}
@@ -29,9 +29,13 @@
 #include <CppUTest/TestHarness.h>
 
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 
+#include <sys/socket.h>
+#include <sys/un.h>
+
 #include "common/logging.hpp"
 
 TEST_GROUP(Logging){};
@@ -110,3 +114,290 @@ TEST(Logging, TestLoggingDump)
     sprintf(cmd, "grep '%s.*: foobar: 0020: 6f 66 20 74 65 78 74 00' /var/log/syslog", ident);
     CHECK(0 == system(cmd));
 }
+
+static void ReadLog(const char *aFilename, char *aBuffer, size_t aSize)
+{
+    FILE * fp = fopen(aFilename, "r");
+    size_t length;
+
+    CHECK(fp != NULL);
+    length          = fread(aBuffer, 1, aSize - 1, fp);
+    aBuffer[length] = 0;
+    fclose(fp);
+}
+
+TEST(Logging, TestLoggingRing)
+{
+    const char  filename[] = "/tmp/otbr-test-logging-ring.log";
+    char        log[4096];
+    long double value = 2.5;
+
+    otbrLogSetFilename(filename);
+    CHECK_EQUAL(OTBR_ERROR_NONE, otbrLogRingStart(false));
+
+    otbrLog(OTBR_LOG_INFO, "ring-first %d %s %.*s", -7, "string", 3, "truncated");
+    otbrLog(OTBR_LOG_INFO, "ring-second %lu %zu %p %5.2f %%", 123456789UL, static_cast<size_t>(7),
+            static_cast<void *>(NULL), 3.14159);
+    otbrLog(OTBR_LOG_INFO, "ring-null %s", static_cast<const char *>(NULL));
+    otbrLog(OTBR_LOG_INFO, "ring-fallback %.1Lf", value);
+
+    // Nothing is formatted before the ring is drained.
+    ReadLog(filename, log, sizeof(log));
+    CHECK(strstr(log, "ring-first") == NULL);
+
+    otbrLogFlush();
+    ReadLog(filename, log, sizeof(log));
+    CHECK(strstr(log, "ring-first -7 string tru\n") != NULL);
+    CHECK(strstr(log, "ring-second 123456789 7 (nil)  3.14 %\n") != NULL);
+    CHECK(strstr(log, "ring-null (null)\n") != NULL);
+    CHECK(strstr(log, "ring-fallback 2.5\n") != NULL);
+    CHECK(strstr(log, "ring-first") < strstr(log, "ring-second"));
+
+    otbrLogRingStop();
+}
+
+TEST(Logging, TestLoggingRingDropped)
+{
+    const char filename[] = "/tmp/otbr-test-logging-dropped.log";
+    char       log[64 * 1024];
+
+    otbrLogSetFilename(filename);
+    CHECK_EQUAL(OTBR_ERROR_NONE, otbrLogRingStart(false));
+
+    for (int i = 0; i < 300; i++)
+    {
+        otbrLog(OTBR_LOG_INFO, "ring-record %d", i);
+    }
+
+    otbrLogRingStop();
+
+    ReadLog(filename, log, sizeof(log));
+    CHECK(strstr(log, "ring-record 0\n") != NULL);
+    CHECK(strstr(log, "ring-record 255\n") != NULL);
+    CHECK(strstr(log, "ring-record 256\n") == NULL);
+    CHECK(strstr(log, "44 log records dropped\n") != NULL);
+}
+
+TEST(Logging, TestLoggingRingDump)
+{
+    const char filename[] = "/tmp/otbr-test-logging-dump.log";
+    char       log[4096];
+    uint8_t    memory[200];
+
+    for (size_t i = 0; i < sizeof(memory); i++)
+    {
+        memory[i] = static_cast<uint8_t>(i);
+    }
+
+    otbrLogSetFilename(filename);
+    CHECK_EQUAL(OTBR_ERROR_NONE, otbrLogRingStart(true));
+    otbrDump(OTBR_LOG_INFO, "ring-dump", memory, sizeof(memory));
+    otbrLogRingStop();
+
+    ReadLog(filename, log, sizeof(log));
+    CHECK(strstr(log, "ring-dump: 0000: 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f\n") != NULL);
+    CHECK(strstr(log, "ring-dump: 00b0: b0 b1 b2 b3 b4 b5 b6 b7 b8 b9 ba bb bc bd be bf\n") != NULL);
+    CHECK(strstr(log, "ring-dump: 00c0: c0 c1 c2 c3 c4 c5 c6 c7\n") != NULL);
+}
+
+TEST(Logging, TestLoggingLargeDump)
+{
+    const char  filename[] = "/tmp/otbr-test-logging-large-dump.log";
+    static char log[128 * 1024];
+    uint8_t     memory[5000];
+
+    for (size_t i = 0; i < sizeof(memory); i++)
+    {
+        memory[i] = static_cast<uint8_t>(i);
+    }
+
+    // Dumps are recorded in records of consecutive slots, the lines continue across records.
+    otbrLogSetFilename(filename);
+    CHECK_EQUAL(OTBR_ERROR_NONE, otbrLogRingStart(false));
+    otbrDump(OTBR_LOG_INFO, "ring-large", memory, sizeof(memory));
+    otbrLog(OTBR_LOG_INFO, "ring-after");
+    otbrLogRingStop();
+
+    // Without the ring, the lines are encoded in chunks.
+    otbrDump(OTBR_LOG_INFO, "direct-large", memory, sizeof(memory));
+
+    ReadLog(filename, log, sizeof(log));
+    CHECK(strstr(log, "ring-large: 0000: 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f\n") != NULL);
+    CHECK(strstr(log, "ring-large: 0be0: e0 e1 e2 e3 e4 e5 e6 e7 e8 e9 ea eb ec ed ee ef\n") != NULL);
+    CHECK(strstr(log, "ring-large: 0bf0: f0 f1 f2 f3 f4 f5 f6 f7 f8 f9 fa fb fc fd fe ff\n") != NULL);
+    CHECK(strstr(log, "ring-large: 1380: 80 81 82 83 84 85 86 87\n") != NULL);
+    CHECK(strstr(log, "ring-large: 1380:") < strstr(log, "ring-after\n"));
+    CHECK(strstr(log, "direct-large: 0ff0: f0 f1 f2 f3 f4 f5 f6 f7 f8 f9 fa fb fc fd fe ff\n") != NULL);
+    CHECK(strstr(log, "direct-large: 1380: 80 81 82 83 84 85 86 87\n") != NULL);
+}
+
+TEST(Logging, TestLoggingRateLimited)
+{
+    const char filename[] = "/tmp/otbr-test-logging-limited.log";
+    char       log[4096];
+
+    otbrLogSetFilename(filename);
+
+    for (int window = 0; window < 2; window++)
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            otbrLogRateLimited(OTBR_LOG_INFO, 2, 50, "limited %d-%d", window, i);
+        }
+
+        usleep(60000);
+    }
+
+    ReadLog(filename, log, sizeof(log));
+    CHECK(strstr(log, "limited 0-1\n") != NULL);
+    CHECK(strstr(log, "limited 0-2\n") == NULL);
+    CHECK(strstr(log, "3 logs like \"limited %d-%d\" suppressed\n") != NULL);
+    CHECK(strstr(log, "limited 1-1\n") != NULL);
+    CHECK(strstr(log, "limited 1-2\n") == NULL);
+}
+
+TEST(Logging, TestLoggingSampled)
+{
+    const char filename[] = "/tmp/otbr-test-logging-sampled.log";
+    char       log[4096];
+
+    otbrLogSetFilename(filename);
+
+    for (int i = 0; i < 10; i++)
+    {
+        otbrLogSampled(OTBR_LOG_INFO, 4, "sampled %d", i);
+    }
+
+    ReadLog(filename, log, sizeof(log));
+    CHECK(strstr(log, "sampled 0\n") != NULL);
+    CHECK(strstr(log, "sampled 3\n") == NULL);
+    CHECK(strstr(log, "sampled 4\n") != NULL);
+    CHECK(strstr(log, "sampled 8\n") != NULL);
+    CHECK(strstr(log, "sampled 9\n") == NULL);
+}
+
+TEST(Logging, TestLoggingFileWriter)
+{
+    const char filename[] = "/tmp/otbr-test-logging-writer.log";
+    char       log[4096];
+
+    otbrLogSetFilename(filename);
+    CHECK_EQUAL(OTBR_ERROR_NONE, otbrLogStartFileWriter(1024, 0));
+
+    for (int i = 0; i < 10; i++)
+    {
+        otbrLog(OTBR_LOG_INFO, "writer %d", i);
+    }
+
+    otbrLogFlush();
+    ReadLog(filename, log, sizeof(log));
+    CHECK(strstr(log, "writer 0\n") != NULL);
+    CHECK(strstr(log, "writer 9\n") != NULL);
+
+    // Fatal logs are written at once.
+    otbrLog(OTBR_LOG_CRIT, "writer fatal");
+    ReadLog(filename, log, sizeof(log));
+    CHECK(strstr(log, "writer fatal\n") != NULL);
+
+    otbrLogStopFileWriter();
+}
+
+TEST(Logging, TestLoggingFileWriterRotate)
+{
+    const char filename[] = "/tmp/otbr-test-logging-rotate.log";
+    char       log[4096];
+
+    remove("/tmp/otbr-test-logging-rotate.log.1");
+    otbrLogSetFilename(filename);
+    CHECK_EQUAL(OTBR_ERROR_NONE, otbrLogStartFileWriter(1024, 64));
+
+    otbrLog(OTBR_LOG_INFO, "rotate first line of more than sixty-four bytes, which rotates the file");
+    otbrLogFlush();
+    otbrLog(OTBR_LOG_INFO, "rotate second");
+    otbrLogStopFileWriter();
+
+    ReadLog("/tmp/otbr-test-logging-rotate.log.1", log, sizeof(log));
+    CHECK(strstr(log, "rotate first") != NULL);
+    CHECK(strstr(log, "rotate second") == NULL);
+
+    ReadLog(filename, log, sizeof(log));
+    CHECK(strstr(log, "rotate first") == NULL);
+    CHECK(strstr(log, "rotate second\n") != NULL);
+}
+
+TEST(Logging, TestLoggingFileWriterDropped)
+{
+    const char filename[] = "/tmp/otbr-test-logging-writer-dropped.log";
+    char       log[4096];
+    char       line[100];
+
+    memset(line, 'x', sizeof(line) - 1);
+    line[sizeof(line) - 1] = 0;
+
+    otbrLogSetFilename(filename);
+    CHECK_EQUAL(OTBR_ERROR_NONE, otbrLogStartFileWriter(64, 0));
+
+    // Too long for the buffer.
+    otbrLog(OTBR_LOG_INFO, "dropped %s", line);
+    otbrLog(OTBR_LOG_INFO, "kept");
+    otbrLogStopFileWriter();
+
+    ReadLog(filename, log, sizeof(log));
+    CHECK(strstr(log, "dropped xxx") == NULL);
+    CHECK(strstr(log, "1 log writes dropped\n") != NULL);
+    CHECK(strstr(log, "kept\n") != NULL);
+}
+
+TEST(Logging, TestLoggingSyslogSocket)
+{
+    const char         path[] = "/tmp/otbr-test-logging-syslog.sock";
+    struct sockaddr_un address;
+    struct timeval     timeout = {1, 0};
+    char               record[256];
+    char               expected[64];
+    ssize_t            length;
+    int                fd;
+
+    remove(path);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+    fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    CHECK(fd >= 0);
+    CHECK_EQUAL(0, bind(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    otbrLogSetSyslogPath(path);
+    otbrLogInit("otbr-test", OTBR_LOG_INFO);
+
+    // The header is formatted once, without timestamp.
+    otbrLog(OTBR_LOG_INFO, "syslog-direct %d", 1);
+    length = recv(fd, record, sizeof(record) - 1, 0);
+    CHECK(length > 0);
+    record[length] = 0;
+    snprintf(expected, sizeof(expected), "<14>otbr-test[%d]: syslog-direct 1", static_cast<int>(getpid()));
+    STRCMP_EQUAL(expected, record);
+
+    // Records of the ring are sent in a batch when drained, one datagram each.
+    CHECK_EQUAL(OTBR_ERROR_NONE, otbrLogRingStart(false));
+    otbrLog(OTBR_LOG_WARNING, "syslog-ring-first");
+    otbrLog(OTBR_LOG_INFO, "syslog-ring-second");
+    otbrLogFlush();
+
+    length = recv(fd, record, sizeof(record) - 1, 0);
+    CHECK(length > 0);
+    record[length] = 0;
+    snprintf(expected, sizeof(expected), "<12>otbr-test[%d]: syslog-ring-first", static_cast<int>(getpid()));
+    STRCMP_EQUAL(expected, record);
+
+    length = recv(fd, record, sizeof(record) - 1, 0);
+    CHECK(length > 0);
+    record[length] = 0;
+    snprintf(expected, sizeof(expected), "<14>otbr-test[%d]: syslog-ring-second", static_cast<int>(getpid()));
+    STRCMP_EQUAL(expected, record);
+
+    otbrLogDeinit();
+    otbrLogSetSyslogPath("/dev/log");
+    close(fd);
+    remove(path);
+}
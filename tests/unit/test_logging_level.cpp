@@ -0,0 +1,106 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <stdio.h>
+#include <string.h>
+
+// Logs more verbose than info are compiled out of this file.
+#undef OTBR_LOG_LEVEL_MAX
+#define OTBR_LOG_LEVEL_MAX OTBR_LOG_INFO
+
+#include "common/logging.hpp"
+
+static int Count(int &aCounter)
+{
+    return ++aCounter;
+}
+
+TEST_GROUP(LoggingLevel){};
+
+TEST(LoggingLevel, TestCompiledOut)
+{
+    const char filename[] = "/tmp/otbr-test-logging-level.log";
+    char       log[1024];
+    int        counter = 0;
+    FILE *     fp;
+    size_t     length;
+
+    otbrLogSetFilename(filename);
+
+    otbrLog(OTBR_LOG_DEBUG, "level-debug %d", Count(counter));
+    otbrDump(OTBR_LOG_DEBUG, "level-dump", &counter, static_cast<size_t>(Count(counter)));
+    CHECK_EQUAL(0, counter);
+
+    otbrLog(OTBR_LOG_INFO, "level-info %d", Count(counter));
+    CHECK_EQUAL(1, counter);
+
+    fp = fopen(filename, "r");
+    CHECK(fp != NULL);
+    length      = fread(log, 1, sizeof(log) - 1, fp);
+    log[length] = 0;
+    fclose(fp);
+
+    CHECK(strstr(log, "level-debug") == NULL);
+    CHECK(strstr(log, "level-dump") == NULL);
+    CHECK(strstr(log, "level-info 1\n") != NULL);
+}
+
+TEST(LoggingLevel, TestModuleLevel)
+{
+    int counter = 0;
+
+    otbrLogSetLevel(OTBR_LOG_INFO);
+    CHECK_FALSE(otbrLogIsModuleLevelSet(OTBR_LOG_MODULE_DTLS));
+    CHECK_EQUAL(OTBR_LOG_INFO, otbrLogGetModuleLevel(OTBR_LOG_MODULE_DTLS));
+
+    // Logs above the level of their module are not evaluated.
+    otbrLogSetModuleLevel(OTBR_LOG_MODULE, OTBR_LOG_WARNING);
+    otbrLog(OTBR_LOG_INFO, "module-info %d", Count(counter));
+    CHECK_EQUAL(0, counter);
+    CHECK_EQUAL(OTBR_LOG_INFO, otbrLogGetModuleLevel(OTBR_LOG_MODULE_DTLS));
+
+    // Other modules keep following the global level.
+    otbrLogSetModuleLevel(OTBR_LOG_MODULE_DTLS, OTBR_LOG_DEBUG);
+    otbrLogSetLevel(OTBR_LOG_NOTICE);
+    CHECK_EQUAL(OTBR_LOG_DEBUG, otbrLogGetModuleLevel(OTBR_LOG_MODULE_DTLS));
+    CHECK_EQUAL(OTBR_LOG_NOTICE, otbrLogGetModuleLevel(OTBR_LOG_MODULE_COAP));
+    CHECK_EQUAL(OTBR_LOG_WARNING, otbrLogGetModuleLevel(OTBR_LOG_MODULE));
+
+    otbrLogSetModuleLevel(OTBR_LOG_MODULE, -1);
+    otbrLogSetModuleLevel(OTBR_LOG_MODULE_DTLS, -1);
+    otbrLogSetLevel(OTBR_LOG_INFO);
+    otbrLog(OTBR_LOG_INFO, "module-info %d", Count(counter));
+    CHECK_EQUAL(1, counter);
+    CHECK_FALSE(otbrLogIsModuleLevelSet(OTBR_LOG_MODULE_DTLS));
+
+    CHECK_EQUAL(OTBR_LOG_MODULE_BORDER_AGENT, otbrLogFindModule("border-agent"));
+    STRCMP_EQUAL("dtls", otbrLogGetModuleName(OTBR_LOG_MODULE_DTLS));
+    CHECK_EQUAL(-1, otbrLogFindModule("bogus"));
+}
@@ -0,0 +1,109 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include "agent/mdns.hpp"
+
+using namespace ot::BorderRouter;
+
+TEST_GROUP(TxtRecord){};
+
+TEST(TxtRecord, TestSetEntry)
+{
+    Mdns::TxtRecord txt;
+    const uint8_t   kEncoded[] = {5, 'n', 'n', '=', 'a', 'b', 4, 'x', 'p', '=', '1'};
+    const uint8_t   kUpdated[] = {6, 'n', 'n', '=', 'a', 'b', 'c', 4, 'x', 'p', '=', '1'};
+
+    CHECK_EQUAL(0, txt.GetLength());
+    CHECK_EQUAL(OTBR_ERROR_NONE, txt.SetEntry("nn", "ab"));
+    CHECK_EQUAL(OTBR_ERROR_NONE, txt.SetEntry("xp", "1"));
+    CHECK_EQUAL(sizeof(kEncoded), txt.GetLength());
+    CHECK(memcmp(kEncoded, txt.GetData(), sizeof(kEncoded)) == 0);
+
+    // An entry set again keeps its position.
+    CHECK_EQUAL(OTBR_ERROR_NONE, txt.SetEntry("nn", "abc"));
+    CHECK_EQUAL(sizeof(kUpdated), txt.GetLength());
+    CHECK(memcmp(kUpdated, txt.GetData(), sizeof(kUpdated)) == 0);
+
+    // Keys are not matched by prefix.
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, txt.RemoveEntry("n"));
+    CHECK_EQUAL(ENOENT, errno);
+
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, txt.SetEntry("", "1"));
+    CHECK_EQUAL(EINVAL, errno);
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, txt.SetEntry("a=b", "1"));
+    CHECK_EQUAL(EINVAL, errno);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, txt.RemoveEntry("nn"));
+    CHECK_EQUAL(5, txt.GetLength());
+    CHECK(memcmp(kEncoded + 6, txt.GetData(), 5) == 0);
+}
+
+TEST(TxtRecord, TestBinaryValue)
+{
+    Mdns::TxtRecord txt;
+    Mdns::TxtRecord other;
+    const uint8_t   kBitmap[] = {0x00, 0x00, 0x01, 0xb1};
+    const uint8_t * value;
+    uint8_t         length = 0;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, txt.SetEntry("sb", kBitmap, sizeof(kBitmap)));
+    value = txt.GetEntry("sb", length);
+    CHECK(value != NULL);
+    CHECK_EQUAL(sizeof(kBitmap), length);
+    CHECK(memcmp(kBitmap, value, sizeof(kBitmap)) == 0);
+    CHECK(txt.GetEntry("at", length) == NULL);
+
+    CHECK(txt != other);
+    CHECK_EQUAL(OTBR_ERROR_NONE, other.SetEntry("sb", kBitmap, sizeof(kBitmap)));
+    CHECK(txt == other);
+}
+
+TEST(TxtRecord, TestFull)
+{
+    Mdns::TxtRecord txt;
+    uint8_t         value[UINT8_MAX];
+
+    memset(value, 'v', sizeof(value));
+
+    // A single string is at most 255 bytes, key and '=' included.
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, txt.SetEntry("k", value, UINT8_MAX - 1));
+    CHECK_EQUAL(EMSGSIZE, errno);
+    CHECK_EQUAL(OTBR_ERROR_NONE, txt.SetEntry("k", value, 200));
+
+    // Nothing is changed by an entry that does not fit.
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, txt.SetEntry("l", value, 60));
+    CHECK_EQUAL(EMSGSIZE, errno);
+    CHECK_EQUAL(203, txt.GetLength());
+    CHECK_EQUAL(OTBR_ERROR_NONE, txt.SetEntry("l", value, 49));
+    CHECK_EQUAL(Mdns::TxtRecord::kMaxSize, txt.GetLength());
+}
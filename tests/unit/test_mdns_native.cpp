@@ -0,0 +1,414 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "agent/mdns_native.hpp"
+
+using namespace ot::BorderRouter;
+
+static const char    kServiceType[] = "_meshcop._udp";
+static const uint8_t kTxt[]         = {5, 'n', 'n', '=', 'a', 'b'};
+static const uint8_t kAddress[16]   = {0xfd, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+
+struct SentPackets
+{
+    int      mCount;
+    bool     mUnicast;
+    uint16_t mLength;
+    uint8_t  mPacket[Mdns::Responder::kMaxSizeOfPacket];
+};
+
+static void HandleSend(const uint8_t *aBuffer, uint16_t aLength, bool aUnicast, void *aContext)
+{
+    SentPackets &packets = *static_cast<SentPackets *>(aContext);
+
+    packets.mCount++;
+    packets.mUnicast = aUnicast;
+    packets.mLength  = aLength;
+    memcpy(packets.mPacket, aBuffer, aLength);
+}
+
+static uint16_t ReadUint16(const uint8_t *aBuffer)
+{
+    return static_cast<uint16_t>((aBuffer[0] << 8) | aBuffer[1]);
+}
+
+static uint16_t AppendName(uint8_t *aBuffer, const char *aName)
+{
+    uint16_t length = 0;
+
+    while (*aName != '\0')
+    {
+        size_t label = strcspn(aName, ".");
+
+        aBuffer[length++] = static_cast<uint8_t>(label);
+        memcpy(aBuffer + length, aName, label);
+        length += static_cast<uint16_t>(label);
+        aName += label + (aName[label] == '.');
+    }
+
+    aBuffer[length++] = 0;
+
+    return length;
+}
+
+/**
+ * This function builds a PTR query of the meshcop service type, with an optional known answer naming @p aInstance.
+ *
+ */
+static uint16_t BuildQuery(uint8_t *aBuffer, uint16_t aId, const char *aInstance, uint32_t aTtl)
+{
+    uint16_t length = 12;
+
+    memset(aBuffer, 0, length);
+    aBuffer[0] = static_cast<uint8_t>(aId >> 8);
+    aBuffer[1] = static_cast<uint8_t>(aId);
+    aBuffer[5] = 1;
+    aBuffer[7] = (aInstance != NULL);
+
+    length += AppendName(aBuffer + length, "_meshcop._udp.local");
+    aBuffer[length++] = 0;
+    aBuffer[length++] = 12;
+    aBuffer[length++] = 0;
+    aBuffer[length++] = 1;
+
+    if (aInstance != NULL)
+    {
+        uint8_t label = static_cast<uint8_t>(strlen(aInstance));
+
+        // The known answer refers to the question name with compression pointers.
+        aBuffer[length++] = 0xc0;
+        aBuffer[length++] = 12;
+        aBuffer[length++] = 0;
+        aBuffer[length++] = 12;
+        aBuffer[length++] = 0;
+        aBuffer[length++] = 1;
+        aBuffer[length++] = static_cast<uint8_t>(aTtl >> 24);
+        aBuffer[length++] = static_cast<uint8_t>(aTtl >> 16);
+        aBuffer[length++] = static_cast<uint8_t>(aTtl >> 8);
+        aBuffer[length++] = static_cast<uint8_t>(aTtl);
+        aBuffer[length++] = 0;
+        aBuffer[length++] = static_cast<uint8_t>(label + 3);
+        aBuffer[length++] = label;
+        memcpy(aBuffer + length, aInstance, label);
+        length += label;
+        aBuffer[length++] = 0xc0;
+        aBuffer[length++] = 12;
+    }
+
+    return length;
+}
+
+/**
+ * This function builds a response of another host with a SRV record for @p aInstance.
+ *
+ */
+static uint16_t BuildConflict(uint8_t *aBuffer, const char *aInstance)
+{
+    char     name[128];
+    uint16_t length = 12;
+    uint16_t target;
+
+    memset(aBuffer, 0, length);
+    aBuffer[2] = 0x84;
+    aBuffer[7] = 1;
+
+    snprintf(name, sizeof(name), "%s._meshcop._udp.local", aInstance);
+    length += AppendName(aBuffer + length, name);
+    aBuffer[length++] = 0;
+    aBuffer[length++] = 33;
+    aBuffer[length++] = 0x80;
+    aBuffer[length++] = 1;
+    aBuffer[length++] = 0;
+    aBuffer[length++] = 0;
+    aBuffer[length++] = 0;
+    aBuffer[length++] = 120;
+    target            = AppendName(aBuffer + length + 8, "other.local");
+    aBuffer[length++] = 0;
+    aBuffer[length++] = static_cast<uint8_t>(target + 6);
+    memset(aBuffer + length, 0, 4);
+    length += 4;
+    aBuffer[length++] = 0x12;
+    aBuffer[length++] = 0x34;
+    length += target;
+
+    return length;
+}
+
+static void Establish(Mdns::Responder &aResponder, SentPackets &aPackets, uint64_t aNow)
+{
+    uint64_t time;
+
+    aPackets.mCount = 0;
+    CHECK_EQUAL(OTBR_ERROR_NONE, aResponder.Publish("Net", kServiceType, 49191, kTxt, sizeof(kTxt), aNow));
+
+    while (aResponder.GetNextTime(time))
+    {
+        aResponder.Process(time);
+    }
+
+    CHECK(aResponder.IsServiceEstablished(kServiceType, 49191));
+}
+
+TEST_GROUP(MdnsNative){};
+
+TEST(MdnsNative, TestProbeAndAnnounce)
+{
+    SentPackets     packets = {0, false, 0, {0}};
+    Mdns::Responder responder(HandleSend, &packets);
+    uint64_t        time;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.SetHostName("host", NULL));
+    responder.SetAddresses(&kAddress, 1);
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.Publish("Net", kServiceType, 49191, kTxt, sizeof(kTxt), 10000));
+
+    // Three probes with the proposed records in the authority section.
+    for (int i = 0; i < 3; ++i)
+    {
+        CHECK(responder.GetNextTime(time));
+        CHECK_EQUAL(10000U + 250U * i, time);
+        responder.Process(time);
+        CHECK_EQUAL(i + 1, packets.mCount);
+        CHECK_EQUAL(0, ReadUint16(packets.mPacket + 2));
+        CHECK_EQUAL(1, ReadUint16(packets.mPacket + 4));
+        CHECK_EQUAL(2, ReadUint16(packets.mPacket + 8));
+    }
+
+    // Two announcements with the service records and the address.
+    responder.Process(10750);
+    CHECK_EQUAL(4, packets.mCount);
+    CHECK_EQUAL(0x8400, ReadUint16(packets.mPacket + 2));
+    CHECK_EQUAL(3, ReadUint16(packets.mPacket + 6));
+    CHECK_EQUAL(1, ReadUint16(packets.mPacket + 10));
+    CHECK(!responder.IsServiceEstablished(kServiceType, 49191));
+
+    CHECK(responder.GetNextTime(time));
+    CHECK_EQUAL(11750U, time);
+    responder.Process(time);
+    CHECK_EQUAL(5, packets.mCount);
+    CHECK(responder.IsServiceEstablished(kServiceType, 49191));
+    CHECK(!responder.GetNextTime(time));
+    STRCMP_EQUAL("Net", responder.GetServiceName(kServiceType, 49191));
+}
+
+TEST(MdnsNative, TestAnswerAndSuppress)
+{
+    SentPackets     packets = {0, false, 0, {0}};
+    Mdns::Responder responder(HandleSend, &packets);
+    uint8_t         query[512];
+    uint16_t        length;
+    uint8_t         cached[Mdns::Responder::kMaxSizeOfResponse];
+    uint16_t        cachedLength;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.SetHostName("host", NULL));
+    responder.SetAddresses(&kAddress, 1);
+    Establish(responder, packets, 10000);
+    memcpy(cached, packets.mPacket, packets.mLength);
+    cachedLength = packets.mLength;
+
+    // Answered with the cached response.
+    packets.mCount = 0;
+    length         = BuildQuery(query, 0, NULL, 0);
+    responder.HandlePacket(query, length, false, 20000);
+    CHECK_EQUAL(1, packets.mCount);
+    CHECK(!packets.mUnicast);
+    CHECK_EQUAL(cachedLength, packets.mLength);
+    CHECK(memcmp(cached, packets.mPacket, cachedLength) == 0);
+
+    // Not multicast again within a second.
+    responder.HandlePacket(query, length, false, 20500);
+    CHECK_EQUAL(1, packets.mCount);
+
+    // Suppressed by a known answer of enough TTL.
+    length = BuildQuery(query, 0, "Net", 4500);
+    responder.HandlePacket(query, length, false, 30000);
+    CHECK_EQUAL(1, packets.mCount);
+
+    // Known answers about to expire do not suppress.
+    length = BuildQuery(query, 0, "Net", 100);
+    responder.HandlePacket(query, length, false, 30000);
+    CHECK_EQUAL(2, packets.mCount);
+
+    // Legacy resolvers get a unicast response repeating the query ID and question.
+    length = BuildQuery(query, 0x1234, NULL, 0);
+    responder.HandlePacket(query, length, true, 30000);
+    CHECK_EQUAL(3, packets.mCount);
+    CHECK(packets.mUnicast);
+    CHECK_EQUAL(0x1234, ReadUint16(packets.mPacket));
+    CHECK_EQUAL(1, ReadUint16(packets.mPacket + 4));
+    CHECK(memcmp(query + 12, packets.mPacket + 12, length - 12) == 0);
+
+    // Truncated queries are ignored.
+    responder.HandlePacket(query, 20, false, 40000);
+    CHECK_EQUAL(3, packets.mCount);
+}
+
+TEST(MdnsNative, TestConflict)
+{
+    SentPackets     packets = {0, false, 0, {0}};
+    Mdns::Responder responder(HandleSend, &packets);
+    uint8_t         response[512];
+    uint8_t         own[Mdns::Responder::kMaxSizeOfResponse];
+    uint16_t        ownLength;
+    uint16_t        length;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.SetHostName("host", NULL));
+    responder.SetAddresses(&kAddress, 1);
+    Establish(responder, packets, 0);
+
+    // Our own records looped back are no conflict.
+    memcpy(own, packets.mPacket, packets.mLength);
+    ownLength = packets.mLength;
+    responder.HandlePacket(own, ownLength, false, 5000);
+    STRCMP_EQUAL("Net", responder.GetServiceName(kServiceType, 49191));
+    CHECK(responder.IsServiceEstablished(kServiceType, 49191));
+
+    // Another host owning the name, the service is renamed and probed again.
+    length = BuildConflict(response, "Net");
+    responder.HandlePacket(response, length, false, 5000);
+    STRCMP_EQUAL("Net (2)", responder.GetServiceName(kServiceType, 49191));
+    CHECK(!responder.IsServiceEstablished(kServiceType, 49191));
+
+    length = BuildConflict(response, "Net (2)");
+    responder.HandlePacket(response, length, false, 5000);
+    STRCMP_EQUAL("Net (3)", responder.GetServiceName(kServiceType, 49191));
+}
+
+static Mdns::Responder *sRenamingResponder = NULL;
+
+static void HandleConflictRename(const char *aType, uint16_t aPort, void *aContext)
+{
+    (void)aContext;
+
+    sRenamingResponder->Publish("Net #1234", aType, aPort, kTxt, sizeof(kTxt), 5000);
+}
+
+TEST(MdnsNative, TestConflictHandler)
+{
+    SentPackets     packets = {0, false, 0, {0}};
+    Mdns::Responder responder(HandleSend, &packets);
+    uint8_t         response[512];
+    uint16_t        length;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.SetHostName("host", NULL));
+    responder.SetAddresses(&kAddress, 1);
+    Establish(responder, packets, 0);
+    sRenamingResponder = &responder;
+    responder.SetConflictHandler(HandleConflictRename);
+
+    // The name picked by the handler is probed instead of a numbered one.
+    length = BuildConflict(response, "Net");
+    responder.HandlePacket(response, length, false, 5000);
+    STRCMP_EQUAL("Net #1234", responder.GetServiceName(kServiceType, 49191));
+    CHECK(!responder.IsServiceEstablished(kServiceType, 49191));
+
+    // Without a handler, numbers are appended to the name.
+    responder.SetConflictHandler(NULL);
+    length = BuildConflict(response, "Net #1234");
+    responder.HandlePacket(response, length, false, 5000);
+    STRCMP_EQUAL("Net #1234 (2)", responder.GetServiceName(kServiceType, 49191));
+    sRenamingResponder = NULL;
+}
+
+TEST(MdnsNative, TestUpdateAndRename)
+{
+    SentPackets     packets = {0, false, 0, {0}};
+    Mdns::Responder responder(HandleSend, &packets);
+    const uint8_t   txt[]   = {5, 'n', 'n', '=', 'c', 'd'};
+    uint64_t        time;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.SetHostName("host", NULL));
+    Establish(responder, packets, 0);
+
+    // The same records change nothing.
+    packets.mCount = 0;
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.Publish("Net", kServiceType, 49191, kTxt, sizeof(kTxt), 5000));
+    CHECK(!responder.GetNextTime(time));
+
+    // A new text record is announced without probing.
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.Publish("Net", kServiceType, 49191, txt, sizeof(txt), 5000));
+    CHECK(responder.GetNextTime(time));
+    responder.Process(time);
+    CHECK_EQUAL(1, packets.mCount);
+    CHECK_EQUAL(0x8400, ReadUint16(packets.mPacket + 2));
+    responder.Process(time + 1000);
+    CHECK(responder.IsServiceEstablished(kServiceType, 49191));
+
+    // A new name sends goodbyes of zero TTL at once, then probes.
+    packets.mCount = 0;
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.Publish("Other", kServiceType, 49191, txt, sizeof(txt), 10000));
+    CHECK_EQUAL(1, packets.mCount);
+    CHECK_EQUAL(3, ReadUint16(packets.mPacket + 6));
+    CHECK_EQUAL(0, ReadUint16(packets.mPacket + 10));
+    STRCMP_EQUAL("Other", responder.GetServiceName(kServiceType, 49191));
+    CHECK(!responder.IsServiceEstablished(kServiceType, 49191));
+
+    // Service slots are limited.
+    for (uint16_t port = 1; port < Mdns::Responder::kMaxServices; ++port)
+    {
+        CHECK_EQUAL(OTBR_ERROR_NONE, responder.Publish("Net", kServiceType, port, txt, sizeof(txt), 10000));
+    }
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, responder.Publish("Net", kServiceType, 100, txt, sizeof(txt), 10000));
+    CHECK_EQUAL(ENOMEM, errno);
+
+    // Clearing sends goodbyes of announced services only.
+    packets.mCount = 0;
+    responder.Clear();
+    CHECK_EQUAL(0, packets.mCount);
+    CHECK(responder.GetServiceName(kServiceType, 49191) == NULL);
+}
+
+TEST(MdnsNative, TestUnpublish)
+{
+    SentPackets     packets = {0, false, 0, {0}};
+    Mdns::Responder responder(HandleSend, &packets);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.SetHostName("host", NULL));
+    Establish(responder, packets, 0);
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.Publish("Other", kServiceType, 49192, kTxt, sizeof(kTxt), 5000));
+
+    // Only the goodbye of the withdrawn service is sent, the others stay published.
+    packets.mCount = 0;
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.Unpublish(kServiceType, 49191));
+    CHECK_EQUAL(1, packets.mCount);
+    CHECK_EQUAL(3, ReadUint16(packets.mPacket + 6));
+    CHECK(responder.GetServiceName(kServiceType, 49191) == NULL);
+    STRCMP_EQUAL("Other", responder.GetServiceName(kServiceType, 49192));
+
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, responder.Unpublish(kServiceType, 49191));
+    CHECK_EQUAL(ENOENT, errno);
+
+    // A service still being probed has nothing to say goodbye to.
+    CHECK_EQUAL(OTBR_ERROR_NONE, responder.Unpublish(kServiceType, 49192));
+    CHECK_EQUAL(1, packets.mCount);
+}
@@ -0,0 +1,307 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "metrics_server.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/reactor.hpp"
+#include "common/timeline.hpp"
+
+using namespace ot::BorderRouter;
+
+static Metrics::Counter   sTestCounter("test.counter");
+static Metrics::Histogram sTestHistogram("test.histogram");
+static Metrics::Gauge     sTestGauge("test.gauge");
+static Metrics::Histogram sExportHistogram("test.export-us");
+static Metrics::Memory    sTestMemory("test.memory");
+
+static void *AddCounter(void *aContext)
+{
+    Metrics::Counter &counter = *static_cast<Metrics::Counter *>(aContext);
+
+    for (int i = 0; i < 10000; i++)
+    {
+        counter.Add();
+    }
+
+    return NULL;
+}
+
+TEST_GROUP(Metrics){};
+
+TEST(Metrics, TestRegistry)
+{
+    bool counterFound   = false;
+    bool histogramFound = false;
+
+    for (const Metrics::Metric *metric = Metrics::Metric::GetFirst(); metric != NULL; metric = metric->GetNext())
+    {
+        if (strcmp(metric->GetName(), "test.counter") == 0)
+        {
+            CHECK_EQUAL(Metrics::Metric::kTypeCounter, metric->GetType());
+            counterFound = true;
+        }
+        else if (strcmp(metric->GetName(), "test.histogram") == 0)
+        {
+            CHECK_EQUAL(Metrics::Metric::kTypeHistogram, metric->GetType());
+            histogramFound = true;
+        }
+    }
+
+    CHECK(counterFound);
+    CHECK(histogramFound);
+}
+
+TEST(Metrics, TestCounterThreads)
+{
+    pthread_t threads[8];
+
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++)
+    {
+        CHECK_EQUAL(0, pthread_create(&threads[i], NULL, AddCounter, &sTestCounter));
+    }
+
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    sTestCounter.Add(5);
+    CHECK_EQUAL(80005, sTestCounter.GetValue());
+}
+
+TEST(Metrics, TestHistogramBuckets)
+{
+    // Small values are counted exactly.
+    for (uint64_t value = 0; value < 32; value++)
+    {
+        CHECK_EQUAL(value, Metrics::Histogram::GetBucket(value));
+        CHECK_EQUAL(value, Metrics::Histogram::GetBucketLowest(static_cast<unsigned int>(value)));
+    }
+
+    // Buckets are contiguous and within 1/16 of their values.
+    for (unsigned int bucket = 1; bucket < Metrics::Histogram::kBuckets; bucket++)
+    {
+        uint64_t lowest = Metrics::Histogram::GetBucketLowest(bucket);
+
+        CHECK_EQUAL(bucket, Metrics::Histogram::GetBucket(lowest));
+        CHECK_EQUAL(bucket - 1, Metrics::Histogram::GetBucket(lowest - 1));
+        CHECK(lowest - Metrics::Histogram::GetBucketLowest(bucket - 1) <= lowest / 16 + 1);
+    }
+
+    CHECK_EQUAL(Metrics::Histogram::kBuckets - 1, Metrics::Histogram::GetBucket(~static_cast<uint64_t>(0)));
+}
+
+TEST(Metrics, TestHistogramPercentiles)
+{
+    CHECK_EQUAL(0, sTestHistogram.GetPercentile(50));
+
+    for (uint64_t value = 1; value <= 1000; value++)
+    {
+        sTestHistogram.Record(value);
+    }
+
+    CHECK_EQUAL(1000, sTestHistogram.GetCount());
+    CHECK_EQUAL(500500, sTestHistogram.GetSum());
+
+    // Percentiles are within the precision of buckets.
+    CHECK(sTestHistogram.GetPercentile(50) >= 500 && sTestHistogram.GetPercentile(50) <= 500 + 500 / 16);
+    CHECK(sTestHistogram.GetPercentile(99) >= 990 && sTestHistogram.GetPercentile(99) <= 990 + 990 / 16);
+    CHECK(sTestHistogram.GetPercentile(100) >= 1000 && sTestHistogram.GetPercentile(100) <= 1000 + 1000 / 16);
+    CHECK_EQUAL(1, sTestHistogram.GetPercentile(0));
+}
+
+TEST(Metrics, TestDump)
+{
+    const char  filename[] = "/tmp/otbr-test-metrics.log";
+    char        buffer[1024];
+    std::string log;
+    FILE *      fp;
+    size_t      length;
+
+    otbrLogSetFilename(filename);
+    Metrics::Dump(OTBR_LOG_INFO);
+
+    // The dump of all metrics in the binary is longer than any buffer.
+    fp = fopen(filename, "r");
+    CHECK(fp != NULL);
+
+    while ((length = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    {
+        log.append(buffer, length);
+    }
+
+    fclose(fp);
+
+    CHECK(log.find("metric test.counter: ") != std::string::npos);
+    CHECK(log.find("metric test.histogram: count ") != std::string::npos);
+    CHECK(log.find("metric test.memory: 0 bytes in 0 blocks, peak ") != std::string::npos);
+}
+
+TEST(Metrics, TestGauge)
+{
+    sTestGauge.Add(3);
+    sTestGauge.Subtract();
+    CHECK_EQUAL(2, sTestGauge.GetValue());
+    sTestGauge.Subtract(2);
+    CHECK_EQUAL(0, sTestGauge.GetValue());
+}
+
+TEST(Metrics, TestMemory)
+{
+    sTestMemory.Allocate(100);
+    sTestMemory.Allocate(50);
+    sTestMemory.Free(100);
+    CHECK_EQUAL(50, sTestMemory.GetValue());
+    CHECK_EQUAL(1, sTestMemory.GetBlocks());
+    CHECK_EQUAL(150, sTestMemory.GetPeak());
+
+    // The peak is only raised beyond the previous one.
+    sTestMemory.Allocate(60);
+    CHECK_EQUAL(150, sTestMemory.GetPeak());
+    sTestMemory.Allocate(60);
+    CHECK_EQUAL(170, sTestMemory.GetPeak());
+    sTestMemory.Free(60);
+    sTestMemory.Free(60);
+    sTestMemory.Free(50);
+    CHECK_EQUAL(0, sTestMemory.GetValue());
+    CHECK_EQUAL(0, sTestMemory.GetBlocks());
+}
+
+TEST(Metrics, TestExport)
+{
+    std::string output;
+
+    sExportHistogram.Record(1);
+    sExportHistogram.Record(2);
+    sExportHistogram.Record(1000);
+    sExportHistogram.Record(static_cast<uint64_t>(1) << 45);
+    Metrics::Export(output);
+
+    CHECK(output.find("# TYPE otbr_test_counter counter\notbr_test_counter_total ") != std::string::npos);
+    CHECK(output.find("# TYPE otbr_test_gauge gauge\notbr_test_gauge ") != std::string::npos);
+    CHECK(output.find("# TYPE otbr_test_memory_bytes gauge\notbr_test_memory_bytes 0\n") != std::string::npos);
+    CHECK(output.find("# TYPE otbr_test_memory_peak_bytes gauge\notbr_test_memory_peak_bytes ") !=
+          std::string::npos);
+
+    // Buckets are cumulative, the values beyond the last bound are only counted in +Inf.
+    CHECK(output.find("# TYPE otbr_test_export_us histogram\n") != std::string::npos);
+    CHECK(output.find("otbr_test_export_us_bucket{le=\"0\"} 0\n") != std::string::npos);
+    CHECK(output.find("otbr_test_export_us_bucket{le=\"1\"} 1\n") != std::string::npos);
+    CHECK(output.find("otbr_test_export_us_bucket{le=\"3\"} 2\n") != std::string::npos);
+    CHECK(output.find("otbr_test_export_us_bucket{le=\"511\"} 2\n") != std::string::npos);
+    CHECK(output.find("otbr_test_export_us_bucket{le=\"1023\"} 3\n") != std::string::npos);
+    CHECK(output.find("otbr_test_export_us_bucket{le=\"549755813887\"} 3\n") != std::string::npos);
+    CHECK(output.find("otbr_test_export_us_bucket{le=\"+Inf\"} 4\n") != std::string::npos);
+    CHECK(output.find("otbr_test_export_us_count 4\n") != std::string::npos);
+    CHECK(output.find("otbr_test_export_us_sum 35184372089835\n") != std::string::npos);
+}
+
+static std::string RequestMetrics(Reactor &aReactor, uint16_t aPort, const char *aRequest)
+{
+    std::string response;
+    sockaddr_in sin;
+    int         fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family      = AF_INET;
+    sin.sin_port        = htons(aPort);
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK_EQUAL(0, connect(fd, reinterpret_cast<sockaddr *>(&sin), sizeof(sin)));
+    CHECK_EQUAL(static_cast<ssize_t>(strlen(aRequest)), send(fd, aRequest, strlen(aRequest), 0));
+
+    for (int i = 0; i < 100; i++)
+    {
+        fd_set  readFdSet;
+        fd_set  writeFdSet;
+        fd_set  errorFdSet;
+        timeval timeout = {0, 10000};
+        char    buffer[1024];
+        ssize_t rval;
+
+        FD_ZERO(&readFdSet);
+        FD_ZERO(&writeFdSet);
+        FD_ZERO(&errorFdSet);
+        aReactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout);
+
+        while ((rval = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0)
+        {
+            response.append(buffer, static_cast<size_t>(rval));
+        }
+
+        if (rval == 0)
+        {
+            break;
+        }
+    }
+
+    close(fd);
+
+    return response;
+}
+
+TEST(Metrics, TestMetricsServer)
+{
+    const uint16_t port = 49299;
+    Reactor        reactor;
+    MetricsServer  server(reactor);
+    std::string    response;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, server.Start(port));
+
+    response = RequestMetrics(reactor, port, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    CHECK(response.compare(0, 17, "HTTP/1.1 200 OK\r\n") == 0);
+    CHECK(response.find("Content-Type: text/plain; version=0.0.4\r\n") != std::string::npos);
+    CHECK(response.find("\r\n\r\n# TYPE ") != std::string::npos);
+    CHECK(response.find("\notbr_test_counter_total ") != std::string::npos);
+
+    response = RequestMetrics(reactor, port, "GET /metricsfoo HTTP/1.1\r\n\r\n");
+    CHECK(response.compare(0, 24, "HTTP/1.1 404 Not Found\r\n") == 0);
+
+    // The handlers of the reactor record spans while the timeline is started.
+    CHECK_EQUAL(OTBR_ERROR_NONE, Timeline::Start());
+    response = RequestMetrics(reactor, port, "GET /timeline HTTP/1.1\r\n\r\n");
+    Timeline::Stop();
+    CHECK(response.compare(0, 17, "HTTP/1.1 200 OK\r\n") == 0);
+    CHECK(response.find("Content-Type: application/json\r\n") != std::string::npos);
+    CHECK(response.find("\r\n\r\n{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") != std::string::npos);
+
+    server.Stop();
+}
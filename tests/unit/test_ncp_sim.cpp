@@ -0,0 +1,300 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/select.h>
+
+#include "agent/coap_native.hpp"
+#include "agent/ncp_sim.hpp"
+#include "agent/uris.hpp"
+#include "common/time.hpp"
+#include "common/tlv.hpp"
+
+using namespace ot;
+using namespace ot::BorderRouter;
+
+struct SimContext
+{
+    Ncp::ControllerSim *mNcp;
+    Coap::Agent *       mCoap;
+    int                 mResponses;
+    uint8_t             mState;
+    uint16_t            mSessionId;
+    int                 mRelayed;
+    bool                mHasKek;
+};
+
+static ssize_t SimSender(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort, void *aContext)
+{
+    SimContext &context = *static_cast<SimContext *>(aContext);
+    Ip6Address  addr;
+
+    memcpy(addr.m8, aIp6, sizeof(addr.m8));
+
+    return context.mNcp->TmfProxySend(aBuffer, aLength, addr.ToLocator(), aPort) == OTBR_ERROR_NONE ? aLength : -1;
+}
+
+static void SimFeed(void *aContext, const Ncp::TmfProxyStreamEvent &aEvent)
+{
+    SimContext &context = *static_cast<SimContext *>(aContext);
+    Ip6Address  addr(aEvent.mLocator);
+
+    context.mCoap->Input(aEvent.mBuffer, aEvent.mLength, addr.m8, aEvent.mPort);
+}
+
+static void SimResponseHandler(const Coap::Message &aMessage, void *aContext)
+{
+    SimContext &   context = *static_cast<SimContext *>(aContext);
+    uint16_t       length  = 0;
+    const uint8_t *payload = aMessage.GetPayload(length);
+
+    CHECK_EQUAL(Coap::kCodeChanged, aMessage.GetCode());
+    context.mResponses++;
+
+    for (const Tlv *tlv = reinterpret_cast<const Tlv *>(payload); tlv < reinterpret_cast<const Tlv *>(payload + length);
+         tlv            = tlv->GetNext())
+    {
+        if (tlv->GetType() == Meshcop::kState)
+        {
+            context.mState = tlv->GetValueUInt8();
+        }
+        else if (tlv->GetType() == Meshcop::kCommissionerSessionId)
+        {
+            context.mSessionId = tlv->GetValueUInt16();
+        }
+    }
+}
+
+static void SimRelayReceive(const Coap::Resource &aResource,
+                            const Coap::Message & aRequest,
+                            Coap::Message &       aResponse,
+                            const uint8_t *       aIp6,
+                            uint16_t              aPort,
+                            void *                aContext)
+{
+    SimContext &   context = *static_cast<SimContext *>(aContext);
+    uint16_t       length  = 0;
+    const uint8_t *payload = aRequest.GetPayload(length);
+
+    context.mRelayed++;
+
+    for (const Tlv *tlv = reinterpret_cast<const Tlv *>(payload); tlv < reinterpret_cast<const Tlv *>(payload + length);
+         tlv            = tlv->GetNext())
+    {
+        context.mHasKek = context.mHasKek || tlv->GetType() == Meshcop::kJoinerRouterKek;
+    }
+
+    (void)aResource;
+    (void)aResponse;
+    (void)aIp6;
+    (void)aPort;
+}
+
+/**
+ * This function sends a request of TLVs to the simulated leader.
+ *
+ */
+static void SimRequest(SimContext &   aContext,
+                       const char *   aPath,
+                       Coap::Type     aType,
+                       const uint8_t *aPayload,
+                       uint16_t       aLength)
+{
+    static uint16_t     sToken = 0;
+    Coap::ScopedMessage message(*aContext.mCoap, aType, Coap::kCodePost, reinterpret_cast<const uint8_t *>(&sToken),
+                                sizeof(sToken));
+    Ip6Address          leader(0xfc00);
+
+    ++sToken;
+    message->SetPath(aPath);
+    message->SetPayload(aPayload, aLength);
+    CHECK_EQUAL(OTBR_ERROR_NONE, aContext.mCoap->Send(*message, leader.m8, 61631, SimResponseHandler, &aContext));
+}
+
+/**
+ * This function runs the mainloop of the simulated NCP for @p aTimeout milliseconds.
+ *
+ */
+static void SimRun(Ncp::ControllerSim &aNcp, unsigned int aTimeout)
+{
+    uint64_t end = GetMonotonicNow() + aTimeout;
+    uint64_t now;
+
+    while ((now = GetMonotonicNow()) < end)
+    {
+        fd_set  readFdSet;
+        fd_set  writeFdSet;
+        fd_set  errorFdSet;
+        int     maxFd   = -1;
+        timeval timeout = {0, static_cast<suseconds_t>((end - now) * 1000)};
+
+        FD_ZERO(&readFdSet);
+        FD_ZERO(&writeFdSet);
+        FD_ZERO(&errorFdSet);
+        aNcp.UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd);
+
+        if (select(maxFd + 1, &readFdSet, &writeFdSet, &errorFdSet, &timeout) > 0)
+        {
+            aNcp.Process(readFdSet, writeFdSet, errorFdSet);
+        }
+    }
+}
+
+TEST_GROUP(NcpSim){};
+
+TEST(NcpSim, TestPetition)
+{
+    static const uint8_t kPetition[] = {Meshcop::kCommissionerId, 4, 't', 'e', 's', 't'};
+    static const uint8_t kRelay[]    = {Meshcop::kJoinerUdpPort,       2, 0x03, 0xe8, // Joiner UDP Port
+                                     Meshcop::kJoinerRouterLocator, 2, 0x04, 0x00, // Joiner Router Locator
+                                     Meshcop::kJoinerRouterKek,     2, 0xaa, 0xbb};
+    uint8_t              keepAlive[] = {Meshcop::kState, 1, 0xff, Meshcop::kCommissionerSessionId, 2, 0, 0};
+    Ncp::ControllerSim   ncp("", NULL);
+    SimContext           context = {&ncp, NULL, 0, 0, 0, 0, false};
+    Coap::AgentNative    coap(SimSender, &context, NULL);
+    Coap::Resource       relayReceive(OT_URI_PATH_RELAY_RX, SimRelayReceive, &context);
+
+    context.mCoap = &coap;
+    coap.AddResource(relayReceive);
+    ncp.On(SimFeed, &context);
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.Init());
+
+    // Nothing is sent before the TMF proxy starts.
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, ncp.TmfProxySend(kPetition, sizeof(kPetition), 0xfc00, 61631));
+    CHECK_EQUAL(ENOTCONN, errno);
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.TmfProxyStart());
+
+    SimRequest(context, OT_URI_PATH_LEADER_PETITION, Coap::kTypeConfirmable, kPetition, sizeof(kPetition));
+    SimRun(ncp, 10);
+    CHECK_EQUAL(1, context.mResponses);
+    CHECK_EQUAL(1, context.mState);
+    CHECK(context.mSessionId != 0);
+
+    // Only one commissioner is active at a time.
+    SimRequest(context, OT_URI_PATH_LEADER_PETITION, Coap::kTypeConfirmable, kPetition, sizeof(kPetition));
+    SimRun(ncp, 10);
+    CHECK_EQUAL(2, context.mResponses);
+    CHECK_EQUAL(0xff, context.mState);
+
+    // Relayed joiner messages are echoed back without the KEK.
+    SimRequest(context, OT_URI_PATH_RELAY_TX, Coap::kTypeNonConfirmable, kRelay, sizeof(kRelay));
+    SimRun(ncp, 10);
+    CHECK_EQUAL(1, context.mRelayed);
+    CHECK(!context.mHasKek);
+
+    // The commissioner resigns, after which a new one is accepted.
+    keepAlive[5] = static_cast<uint8_t>(context.mSessionId >> 8);
+    keepAlive[6] = static_cast<uint8_t>(context.mSessionId & 0xff);
+    SimRequest(context, OT_URI_PATH_LEADER_KEEP_ALIVE, Coap::kTypeConfirmable, keepAlive, sizeof(keepAlive));
+    SimRun(ncp, 10);
+    CHECK_EQUAL(3, context.mResponses);
+    CHECK_EQUAL(1, context.mState);
+
+    SimRequest(context, OT_URI_PATH_LEADER_PETITION, Coap::kTypeConfirmable, kPetition, sizeof(kPetition));
+    SimRun(ncp, 10);
+    CHECK_EQUAL(4, context.mResponses);
+    CHECK_EQUAL(1, context.mState);
+}
+
+TEST(NcpSim, TestLatency)
+{
+    static const uint8_t kPetition[] = {Meshcop::kCommissionerId, 4, 't', 'e', 's', 't'};
+    Ncp::ControllerSim   ncp("latency=50", NULL);
+    SimContext           context = {&ncp, NULL, 0, 0, 0, 0, false};
+    Coap::AgentNative    coap(SimSender, &context, NULL);
+
+    context.mCoap = &coap;
+    ncp.On(SimFeed, &context);
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.TmfProxyStart());
+
+    SimRequest(context, OT_URI_PATH_LEADER_PETITION, Coap::kTypeConfirmable, kPetition, sizeof(kPetition));
+    SimRun(ncp, 30);
+    CHECK_EQUAL(0, context.mResponses);
+    SimRun(ncp, 40);
+    CHECK_EQUAL(1, context.mResponses);
+}
+
+TEST(NcpSim, TestLoss)
+{
+    static const uint8_t kPetition[] = {Meshcop::kCommissionerId, 4, 't', 'e', 's', 't'};
+    Ncp::ControllerSim   ncp("loss=100", NULL);
+    SimContext           context = {&ncp, NULL, 0, 0, 0, 0, false};
+    Coap::AgentNative    coap(SimSender, &context, NULL);
+    uint32_t             dropped;
+    uint32_t             lost;
+
+    context.mCoap = &coap;
+    ncp.On(SimFeed, &context);
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.TmfProxyStart());
+
+    SimRequest(context, OT_URI_PATH_LEADER_PETITION, Coap::kTypeConfirmable, kPetition, sizeof(kPetition));
+    SimRun(ncp, 10);
+    CHECK_EQUAL(0, context.mResponses);
+    ncp.GetTmfProxyCounters(dropped, lost);
+    CHECK_EQUAL(0, dropped);
+    CHECK_EQUAL(1, lost);
+}
+
+static void SimThreadState(void *aContext, const Ncp::ThreadStateEvent &aEvent)
+{
+    *static_cast<Ncp::ThreadStateEvent *>(aContext) = aEvent;
+}
+
+TEST(NcpSim, TestThreadState)
+{
+    Ncp::ControllerSim    ncp("", NULL);
+    Ncp::ThreadStateEvent state = {false, Ncp::kThreadRoleUnknown};
+
+    ncp.On(SimThreadState, &state);
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.RequestEvent(Ncp::kEventThreadState));
+    CHECK(state.mAssociated);
+    CHECK_EQUAL(Ncp::kThreadRoleRouter, state.mRole);
+}
+
+TEST(NcpSim, TestInvalidParameters)
+{
+    Ncp::ControllerSim unknown("jitter=1", NULL);
+    Ncp::ControllerSim loss("loss=101", NULL);
+    Ncp::ControllerSim latency("latency=", NULL);
+    Ncp::ControllerSim routers("routers=0", NULL);
+
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, unknown.Init());
+    CHECK_EQUAL(EINVAL, errno);
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, loss.Init());
+    CHECK_EQUAL(EINVAL, errno);
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, latency.Init());
+    CHECK_EQUAL(EINVAL, errno);
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, routers.Init());
+    CHECK_EQUAL(EINVAL, errno);
+}
@@ -0,0 +1,168 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include <string>
+
+#include "agent/ncp_sim.hpp"
+#include "agent/network_data.hpp"
+
+using namespace ot;
+using namespace ot::BorderRouter;
+
+TEST_GROUP(NetworkData){};
+
+TEST(NetworkData, TestSimulated)
+{
+    static const uint8_t kPrefix[] = {0xfd, 0x00, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00};
+    Ncp::ControllerSim   ncp("", NULL);
+    NetworkData          networkData(ncp);
+
+    CHECK_EQUAL(0, networkData.GetVersion());
+    STRCMP_EQUAL("{\"version\":0,\"prefixes\":[],\"services\":[]}", networkData.GetJson().c_str());
+
+    networkData.Start();
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.RequestEvent(Ncp::kEventNetworkData));
+    CHECK_EQUAL(1, networkData.GetVersion());
+
+    CHECK_EQUAL(2, networkData.GetPrefixCount());
+
+    const NetworkData::Prefix *prefix = networkData.FindPrefix(kPrefix, 64);
+    CHECK(prefix == &networkData.GetPrefix(0));
+    CHECK_EQUAL(1, prefix->mContextId);
+    CHECK(prefix->mStable);
+    CHECK_EQUAL(1, prefix->mBorderRouterCount);
+    CHECK_EQUAL(0, prefix->mRouteCount);
+
+    const NetworkData::Entry &borderRouter = networkData.GetBorderRouter(prefix->mFirstBorderRouter);
+    CHECK_EQUAL(0x0000, borderRouter.mRloc16);
+    CHECK_EQUAL(0, borderRouter.mPreference);
+    CHECK_EQUAL(NetworkData::kFlagPreferred | NetworkData::kFlagSlaac | NetworkData::kFlagDefault |
+                    NetworkData::kFlagOnMesh,
+                borderRouter.mFlags);
+
+    prefix = networkData.FindPrefix(NULL, 0);
+    CHECK(prefix == &networkData.GetPrefix(1));
+    CHECK_EQUAL(-1, prefix->mContextId);
+    CHECK_EQUAL(0, prefix->mBorderRouterCount);
+    CHECK_EQUAL(1, prefix->mRouteCount);
+    CHECK(networkData.FindPrefix(kPrefix, 48) == NULL);
+
+    CHECK_EQUAL(1, networkData.GetServiceCount());
+    CHECK_EQUAL(44970, networkData.GetService(0).mEnterprise);
+    CHECK_EQUAL(1, networkData.GetService(0).mDataLength);
+    CHECK_EQUAL(0x5c, networkData.GetService(0).mData[0]);
+    CHECK_EQUAL(1, networkData.GetService(0).mServerCount);
+    CHECK_EQUAL(0, networkData.GetServer(networkData.GetService(0).mFirstServer).mDataLength);
+
+    STRCMP_EQUAL("{\"version\":1,\"prefixes\":[{\"prefix\":\"fd00:db8::/64\",\"domainId\":0,\"stable\":true,"
+                 "\"contextId\":1,\"borderRouters\":[{\"rloc16\":\"0x0000\",\"preference\":0,\"stable\":true,"
+                 "\"flags\":[\"preferred\",\"slaac\",\"default\",\"on-mesh\"]}],\"routes\":[]},"
+                 "{\"prefix\":\"::/0\",\"domainId\":0,\"stable\":true,\"borderRouters\":[],\"routes\":[{\"rloc16\":"
+                 "\"0x0000\",\"preference\":0,\"stable\":true,\"nat64\":false}]}],\"services\":[{\"enterpriseNumber\":"
+                 "44970,\"serviceId\":0,\"stable\":true,\"data\":\"5C\",\"servers\":[{\"rloc16\":\"0x0000\","
+                 "\"stable\":true,\"data\":\"\"}]}]}",
+                 networkData.GetJson().c_str());
+    CHECK(networkData.GetText().find("prefix=fd00:db8::/64 domain=0 context=1 stable=1\n  border_router rloc16=0x0000 "
+                                     "preference=0 stable=1 flags=preferred,slaac,default,on-mesh\n") !=
+          std::string::npos);
+
+    // The same data requested again is not a change.
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.RequestEvent(Ncp::kEventNetworkData));
+    CHECK_EQUAL(1, networkData.GetVersion());
+
+    networkData.Stop();
+    CHECK_EQUAL(OTBR_ERROR_NONE, networkData.Update(NULL, 0));
+    CHECK_EQUAL(2, networkData.GetVersion());
+    CHECK_EQUAL(0, networkData.GetPrefixCount());
+    CHECK_EQUAL(0, networkData.GetServiceCount());
+}
+
+TEST(NetworkData, TestEntries)
+{
+    // A route of high preference with NAT64 and a border router of low preference, then a service of enterprise 1.
+    static const uint8_t kData[] = {0x02, 0x13, 0x01, 0x30, 0x20, 0x01, 0x0d, 0xb8, 0x00, 0x04, 0x00, 0x03, 0x1c,
+                                    0x00, 0x60, 0x05, 0x04, 0x14, 0x00, 0xc0, 0x00, 0x0a, 0x0d, 0x00, 0x00, 0x00,
+                                    0x00, 0x01, 0x02, 0xab, 0xcd, 0x0c, 0x03, 0x08, 0x00, 0xef};
+    Ncp::ControllerSim   ncp("", NULL);
+    NetworkData          networkData(ncp);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, networkData.Update(kData, sizeof(kData)));
+    CHECK_EQUAL(1, networkData.GetPrefixCount());
+
+    const NetworkData::Prefix &prefix = networkData.GetPrefix(0);
+    CHECK_FALSE(prefix.mStable);
+    CHECK_EQUAL(1, prefix.mDomainId);
+    CHECK_EQUAL(48, prefix.mLength);
+
+    const NetworkData::Entry &route = networkData.GetRoute(prefix.mFirstRoute);
+    CHECK_EQUAL(0x1c00, route.mRloc16);
+    CHECK_EQUAL(1, route.mPreference);
+    CHECK_EQUAL(NetworkData::kFlagRouteNat64, route.mFlags);
+    CHECK_FALSE(route.mStable);
+
+    const NetworkData::Entry &borderRouter = networkData.GetBorderRouter(prefix.mFirstBorderRouter);
+    CHECK_EQUAL(0x1400, borderRouter.mRloc16);
+    CHECK_EQUAL(-1, borderRouter.mPreference);
+    CHECK_EQUAL(0, borderRouter.mFlags);
+    CHECK(borderRouter.mStable);
+
+    CHECK_EQUAL(1, networkData.GetServiceCount());
+    CHECK_EQUAL(1, networkData.GetService(0).mEnterprise);
+    CHECK_EQUAL(2, networkData.GetService(0).mDataLength);
+    CHECK_FALSE(networkData.GetService(0).mStable);
+
+    const NetworkData::Server &server = networkData.GetServer(networkData.GetService(0).mFirstServer);
+    CHECK_EQUAL(0x0800, server.mRloc16);
+    CHECK_EQUAL(1, server.mDataLength);
+    CHECK_EQUAL(0xef, server.mData[0]);
+}
+
+TEST(NetworkData, TestMalformed)
+{
+    // The second prefix is truncated within the border router entries.
+    static const uint8_t kData[] = {0x03, 0x02, 0x00, 0x00, 0x03, 0x07, 0x00, 0x08, 0xfd, 0x05, 0x03, 0x00, 0x00};
+    Ncp::ControllerSim   ncp("", NULL);
+    NetworkData          networkData(ncp);
+    uint8_t              large[kSizeNetworkData + 1];
+
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, networkData.Update(kData, sizeof(kData)));
+    CHECK_EQUAL(EINVAL, errno);
+    CHECK_EQUAL(1, networkData.GetVersion());
+    CHECK_EQUAL(2, networkData.GetPrefixCount());
+    CHECK_EQUAL(0, networkData.GetPrefix(1).mBorderRouterCount);
+
+    memset(large, 0, sizeof(large));
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, networkData.Update(large, sizeof(large)));
+    CHECK_EQUAL(1, networkData.GetVersion());
+}
@@ -0,0 +1,209 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/select.h>
+
+#include "agent/coap_native.hpp"
+#include "agent/ncp_sim.hpp"
+#include "agent/network_diagnostic.hpp"
+#include "common/time.hpp"
+#include "common/timer.hpp"
+
+using namespace ot;
+using namespace ot::BorderRouter;
+
+struct DiagnosticContext
+{
+    Ncp::ControllerSim *mNcp;
+    Coap::Agent *       mCoap;
+};
+
+static ssize_t DiagnosticSender(const uint8_t *aBuffer,
+                                uint16_t       aLength,
+                                const uint8_t *aIp6,
+                                uint16_t       aPort,
+                                void *         aContext)
+{
+    DiagnosticContext &context = *static_cast<DiagnosticContext *>(aContext);
+    Ip6Address         addr;
+
+    memcpy(addr.m8, aIp6, sizeof(addr.m8));
+
+    return context.mNcp->TmfProxySend(aBuffer, aLength, addr.ToLocator(), aPort) == OTBR_ERROR_NONE ? aLength : -1;
+}
+
+static void DiagnosticFeed(void *aContext, const Ncp::TmfProxyStreamEvent &aEvent)
+{
+    DiagnosticContext &context = *static_cast<DiagnosticContext *>(aContext);
+    Ip6Address         addr(aEvent.mLocator);
+
+    context.mCoap->Input(aEvent.mBuffer, aEvent.mLength, addr.m8, aEvent.mPort);
+}
+
+/**
+ * This function runs the simulated NCP and the timers for @p aTimeout milliseconds.
+ *
+ */
+static void DiagnosticRun(Ncp::ControllerSim &aNcp, TimerWheel &aTimerWheel, unsigned int aTimeout)
+{
+    uint64_t end = GetMonotonicNow() + aTimeout;
+    uint64_t now;
+
+    while ((now = GetMonotonicNow()) < end)
+    {
+        fd_set  readFdSet;
+        fd_set  writeFdSet;
+        fd_set  errorFdSet;
+        int     maxFd   = -1;
+        timeval timeout = {0, static_cast<suseconds_t>((end - now) * 1000)};
+
+        FD_ZERO(&readFdSet);
+        FD_ZERO(&writeFdSet);
+        FD_ZERO(&errorFdSet);
+        aNcp.UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd);
+        aTimerWheel.UpdateTimeout(timeout);
+
+        if (select(maxFd + 1, &readFdSet, &writeFdSet, &errorFdSet, &timeout) > 0)
+        {
+            aNcp.Process(readFdSet, writeFdSet, errorFdSet);
+        }
+
+        aTimerWheel.Process();
+    }
+}
+
+TEST_GROUP(NetworkDiagnostic){};
+
+TEST(NetworkDiagnostic, TestCollect)
+{
+    Ncp::ControllerSim ncp("", NULL);
+    DiagnosticContext  context = {&ncp, NULL};
+    TimerWheel         timerWheel;
+    Coap::AgentNative  coap(DiagnosticSender, &context, &timerWheel);
+    NetworkDiagnostic  diagnostic(coap, timerWheel);
+
+    context.mCoap = &coap;
+    ncp.On(DiagnosticFeed, &context);
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.TmfProxyStart());
+
+    // Nothing is collected before started.
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, diagnostic.Collect());
+    CHECK_EQUAL(ENOTCONN, errno);
+
+    diagnostic.Start();
+    CHECK_EQUAL(OTBR_ERROR_NONE, diagnostic.Collect());
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, diagnostic.Collect());
+    CHECK_EQUAL(EBUSY, errno);
+    CHECK_EQUAL(0, diagnostic.GetTopology().mUpdateTime);
+
+    DiagnosticRun(ncp, timerWheel, 50);
+    CHECK(!diagnostic.IsCollecting());
+
+    const NetworkDiagnostic::Topology &topology = diagnostic.GetTopology();
+
+    CHECK(topology.mUpdateTime != 0);
+    CHECK_EQUAL(0x0000, topology.mLeaderRloc16);
+    CHECK_EQUAL(3, topology.mRouterCount);
+    CHECK_EQUAL(3, topology.mAnswerCount);
+    CHECK_EQUAL(3, topology.mChildCount);
+
+    for (uint8_t i = 0; i < topology.mRouterCount; ++i)
+    {
+        const NetworkDiagnostic::Router &router = topology.mRouters[i];
+
+        CHECK(router.mAnswered);
+        CHECK_EQUAL(i << 10, router.mRloc16);
+        CHECK_EQUAL(i, router.mExtAddress[7]);
+        CHECK_EQUAL(i, router.mChildCount);
+        CHECK_EQUAL(0x7 & ~(1U << i), router.mNeighbors);
+    }
+
+    diagnostic.Stop();
+}
+
+TEST(NetworkDiagnostic, TestInterval)
+{
+    Ncp::ControllerSim ncp("routers=40", NULL);
+    DiagnosticContext  context = {&ncp, NULL};
+    TimerWheel         timerWheel;
+    Coap::AgentNative  coap(DiagnosticSender, &context, &timerWheel);
+    NetworkDiagnostic  diagnostic(coap, timerWheel);
+    uint64_t           updateTime;
+
+    context.mCoap = &coap;
+    ncp.On(DiagnosticFeed, &context);
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.TmfProxyStart());
+
+    diagnostic.SetInterval(100);
+    diagnostic.Start();
+    DiagnosticRun(ncp, timerWheel, 50);
+    CHECK_EQUAL(0, diagnostic.GetTopology().mUpdateTime);
+
+    // More routers than a burst of queries answer.
+    DiagnosticRun(ncp, timerWheel, 200);
+    CHECK_EQUAL(40, diagnostic.GetTopology().mRouterCount);
+    CHECK_EQUAL(40, diagnostic.GetTopology().mAnswerCount);
+    updateTime = diagnostic.GetTopology().mUpdateTime;
+    CHECK(updateTime != 0);
+
+    // The next round starts an interval after the last one completed.
+    DiagnosticRun(ncp, timerWheel, 250);
+    CHECK(diagnostic.GetTopology().mUpdateTime > updateTime);
+}
+
+TEST(NetworkDiagnostic, TestLeaderLost)
+{
+    Ncp::ControllerSim ncp("loss=100", NULL);
+    DiagnosticContext  context = {&ncp, NULL};
+    TimerWheel         timerWheel;
+    Coap::AgentNative  coap(DiagnosticSender, &context, &timerWheel);
+    NetworkDiagnostic  diagnostic(coap, timerWheel);
+
+    context.mCoap = &coap;
+    ncp.On(DiagnosticFeed, &context);
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, ncp.TmfProxyStart());
+
+    diagnostic.SetAnswerTimeout(50);
+    diagnostic.Start();
+    CHECK_EQUAL(OTBR_ERROR_NONE, diagnostic.Collect());
+    DiagnosticRun(ncp, timerWheel, 30);
+    CHECK(diagnostic.IsCollecting());
+
+    // The round is given up, the topology is kept.
+    DiagnosticRun(ncp, timerWheel, 40);
+    CHECK(!diagnostic.IsCollecting());
+    CHECK_EQUAL(0, diagnostic.GetTopology().mUpdateTime);
+    CHECK_EQUAL(0, diagnostic.GetTopology().mRouterCount);
+}
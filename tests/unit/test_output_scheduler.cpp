@@ -0,0 +1,154 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+
+#include "common/output_scheduler.hpp"
+
+using namespace ot::BorderRouter;
+
+static void InitScheduler(OutputScheduler &aScheduler, uint16_t aCapacity)
+{
+    CHECK(aScheduler.Init(kPriorityControl, aCapacity, 16));
+    CHECK(aScheduler.Init(kPriorityManagement, aCapacity, 16));
+    CHECK(aScheduler.Init(kPriorityBulk, aCapacity, 16));
+    CHECK(aScheduler.IsInitialized());
+}
+
+static uint8_t PopFront(OutputScheduler &aScheduler)
+{
+    const uint8_t *packet;
+    uint16_t       length = 0;
+    uint8_t        first  = 0;
+
+    packet = aScheduler.GetFront(length);
+    CHECK(packet != NULL);
+    CHECK(length > 0);
+    first = packet[0];
+    aScheduler.Pop();
+
+    return first;
+}
+
+TEST_GROUP(OutputScheduler){};
+
+TEST(OutputScheduler, TestStrictControl)
+{
+    OutputScheduler scheduler;
+    const uint8_t   kControl[]    = {1};
+    const uint8_t   kManagement[] = {2};
+    const uint8_t   kBulk[]       = {3};
+    uint16_t        length;
+
+    CHECK(!scheduler.IsInitialized());
+    CHECK(!scheduler.Push(kPriorityControl, kControl, sizeof(kControl)));
+    InitScheduler(scheduler, 4);
+    CHECK(scheduler.IsEmpty());
+    CHECK(scheduler.GetFront(length) == NULL);
+
+    CHECK(scheduler.Push(kPriorityBulk, kBulk, sizeof(kBulk)));
+    CHECK(scheduler.Push(kPriorityManagement, kManagement, sizeof(kManagement)));
+    CHECK(scheduler.Push(kPriorityControl, kControl, sizeof(kControl)));
+    CHECK_EQUAL(3, scheduler.GetCount());
+    CHECK_EQUAL(1, scheduler.GetCount(kPriorityBulk));
+
+    // Control packets go first, whenever they are queued.
+    CHECK_EQUAL(1, PopFront(scheduler));
+    CHECK(scheduler.Push(kPriorityControl, kControl, sizeof(kControl)));
+    CHECK_EQUAL(1, PopFront(scheduler));
+    CHECK_EQUAL(2, PopFront(scheduler));
+    CHECK_EQUAL(3, PopFront(scheduler));
+    CHECK(scheduler.IsEmpty());
+}
+
+TEST(OutputScheduler, TestWeightedShare)
+{
+    OutputScheduler scheduler;
+    const uint8_t   kManagement[] = {2, 0, 0, 0};
+    const uint8_t   kBulk[]       = {3, 0, 0, 0};
+    unsigned int    bulk          = 0;
+
+    InitScheduler(scheduler, 8);
+    scheduler.SetQuantum(kPriorityManagement, 8);
+    scheduler.SetQuantum(kPriorityBulk, 4);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        CHECK(scheduler.Push(kPriorityManagement, kManagement, sizeof(kManagement)));
+        CHECK(scheduler.Push(kPriorityBulk, kBulk, sizeof(kBulk)));
+    }
+
+    CHECK(!scheduler.Push(kPriorityBulk, kBulk, sizeof(kBulk)));
+
+    // Management sends two packets per round, bulk one, but bulk is never starved.
+    for (int i = 0; i < 6; ++i)
+    {
+        bulk += PopFront(scheduler) == 3;
+    }
+
+    CHECK_EQUAL(2, bulk);
+    CHECK_EQUAL(6, scheduler.GetCount(kPriorityBulk));
+    CHECK_EQUAL(4, scheduler.GetCount(kPriorityManagement));
+
+    // Once management is drained, bulk has all the rounds.
+    while (scheduler.GetCount(kPriorityManagement) > 0)
+    {
+        PopFront(scheduler);
+    }
+
+    CHECK_EQUAL(3, PopFront(scheduler));
+    scheduler.Clear();
+    CHECK(scheduler.IsEmpty());
+}
+
+TEST(OutputScheduler, TestFrontIsPinned)
+{
+    OutputScheduler scheduler;
+    const uint8_t   kControl[] = {1};
+    const uint8_t   kBulk[]    = {3};
+    const uint8_t * packet;
+    uint16_t        length;
+
+    InitScheduler(scheduler, 2);
+
+    CHECK(scheduler.Push(kPriorityBulk, kBulk, sizeof(kBulk)));
+    packet = scheduler.GetFront(length);
+    CHECK(packet != NULL);
+    CHECK_EQUAL(3, packet[0]);
+
+    // A packet being sent stays at the front, even behind a control packet.
+    CHECK(scheduler.Push(kPriorityControl, kControl, sizeof(kControl)));
+    packet = scheduler.GetFront(length);
+    CHECK_EQUAL(3, packet[0]);
+    scheduler.Pop();
+
+    CHECK_EQUAL(1, PopFront(scheduler));
+    CHECK(scheduler.IsEmpty());
+}
@@ -0,0 +1,186 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <pthread.h>
+#include <string.h>
+
+#include "common/packet_ring.hpp"
+
+using namespace ot::BorderRouter;
+
+TEST_GROUP(PacketRing){};
+
+TEST(PacketRing, TestPushPop)
+{
+    PacketRing     ring;
+    const uint8_t  kPacket1[] = {1, 2, 3};
+    const uint8_t  kPacket2[] = {4, 5};
+    const uint8_t *packet;
+    uint16_t       length = 0;
+
+    CHECK(!ring.IsInitialized());
+    CHECK(!ring.Push(kPacket1, sizeof(kPacket1)));
+    CHECK(ring.Init(2, 4));
+    CHECK(ring.IsInitialized());
+    CHECK(ring.IsEmpty());
+    CHECK(ring.GetFront(length) == NULL);
+
+    CHECK(ring.Push(kPacket1, sizeof(kPacket1)));
+    CHECK(ring.Push(kPacket2, sizeof(kPacket2)));
+    CHECK(!ring.Push(kPacket2, sizeof(kPacket2)));
+    CHECK_EQUAL(2, ring.GetCount());
+
+    packet = ring.GetFront(length);
+    CHECK(packet != NULL);
+    CHECK_EQUAL(sizeof(kPacket1), length);
+    CHECK(memcmp(packet, kPacket1, length) == 0);
+    ring.Pop();
+
+    // Slots are reused once popped.
+    CHECK(ring.Push(kPacket1, sizeof(kPacket1)));
+
+    packet = ring.GetFront(length);
+    CHECK_EQUAL(sizeof(kPacket2), length);
+    CHECK(memcmp(packet, kPacket2, length) == 0);
+    ring.Pop();
+
+    packet = ring.GetFront(length);
+    CHECK_EQUAL(sizeof(kPacket1), length);
+    ring.Pop();
+    CHECK(ring.IsEmpty());
+}
+
+TEST(PacketRing, TestLimits)
+{
+    PacketRing    ring;
+    const uint8_t kPacket[8] = {0};
+
+    CHECK(ring.Init(2, 4));
+    CHECK(!ring.Push(kPacket, sizeof(kPacket)));
+    CHECK(ring.Push(kPacket, 4));
+    CHECK(ring.Push(kPacket, 0));
+    ring.Clear();
+    CHECK(ring.IsEmpty());
+    CHECK(ring.Push(kPacket, 4));
+    CHECK_EQUAL(1, ring.GetCount());
+}
+
+TEST(PacketRing, TestWrapAround)
+{
+    PacketRing     ring;
+    const uint8_t *packet;
+    uint16_t       length = 0;
+    uint8_t        pushed = 0;
+    uint8_t        popped = 0;
+
+    // A capacity not a power of two, wrapped around many times with packets left in the ring.
+    CHECK(ring.Init(3, 1));
+
+    for (int i = 0; i < 1000; i++)
+    {
+        while (ring.Push(&pushed, sizeof(pushed)))
+        {
+            pushed++;
+        }
+
+        CHECK_EQUAL(3, ring.GetCount());
+
+        for (int j = 0; j < 1 + i % 3; j++)
+        {
+            packet = ring.GetFront(length);
+            CHECK(packet != NULL);
+            CHECK_EQUAL(popped, *packet);
+            ring.Pop();
+            popped++;
+        }
+    }
+
+    ring.Clear();
+    CHECK(ring.IsEmpty());
+    CHECK(ring.GetFront(length) == NULL);
+    CHECK(ring.Push(&pushed, sizeof(pushed)));
+    packet = ring.GetFront(length);
+    CHECK(packet != NULL);
+    CHECK_EQUAL(pushed, *packet);
+}
+
+enum
+{
+    kThreadPackets = 100000,
+};
+
+static void *ProducePackets(void *aRing)
+{
+    PacketRing *ring = static_cast<PacketRing *>(aRing);
+
+    for (uint32_t i = 0; i < kThreadPackets;)
+    {
+        uint8_t packet[sizeof(i)];
+
+        memcpy(packet, &i, sizeof(i));
+
+        if (ring->Push(packet, static_cast<uint16_t>(1 + i % sizeof(i))))
+        {
+            ++i;
+        }
+    }
+
+    return NULL;
+}
+
+TEST(PacketRing, TestThreads)
+{
+    PacketRing ring;
+    pthread_t  producer;
+    uint32_t   expected = 0;
+
+    CHECK(ring.Init(16, sizeof(uint32_t)));
+    CHECK_EQUAL(0, pthread_create(&producer, NULL, ProducePackets, &ring));
+
+    while (expected < kThreadPackets)
+    {
+        const uint8_t *packet;
+        uint16_t       length;
+
+        if ((packet = ring.GetFront(length)) == NULL)
+        {
+            continue;
+        }
+
+        // Packets arrive in order, with the bytes written by the producer.
+        CHECK_EQUAL(1 + expected % sizeof(expected), length);
+        CHECK(memcmp(packet, &expected, length) == 0);
+        ring.Pop();
+        ++expected;
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(ring.IsEmpty());
+}
@@ -0,0 +1,229 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "packet_trace.hpp"
+
+using namespace ot::BorderRouter;
+
+static const char    kTraceFile[] = "/tmp/otbr-test-trace.pcapng";
+static const uint8_t kPeer[16]    = {0xfd, 0x00, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xfe, 0, 0xfc, 0x00};
+
+static uint32_t ReadUint32(const uint8_t *aBuffer)
+{
+    uint32_t value;
+
+    memcpy(&value, aBuffer, sizeof(value));
+
+    return value;
+}
+
+static size_t ReadTrace(uint8_t *aBuffer, size_t aSize)
+{
+    FILE * fp = fopen(kTraceFile, "rb");
+    size_t length;
+
+    CHECK(fp != NULL);
+    length = fread(aBuffer, 1, aSize, fp);
+    fclose(fp);
+
+    return length;
+}
+
+TEST_GROUP(PacketTrace){};
+
+TEST(PacketTrace, TestSaveRing)
+{
+    uint8_t  trace[4096];
+    uint8_t  message[5] = {0x40, 0x01, 0x00, 0x00, 0xff};
+    size_t   length;
+    size_t   offset;
+    unsigned count = 0;
+
+    // Nothing is recorded nor saved before started.
+    PacketTrace::Record(PacketTrace::kPointThreadIn, kPeer, 61631, message, sizeof(message));
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, PacketTrace::Save(kTraceFile));
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, PacketTrace::Start(2));
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        message[3] = i;
+        PacketTrace::Record(static_cast<PacketTrace::Point>(i), kPeer, 61631, message, sizeof(message));
+    }
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, PacketTrace::Save(kTraceFile));
+    length = ReadTrace(trace, sizeof(trace));
+
+    // Section header block, then interface description block of the synthetic link type.
+    CHECK_EQUAL(0x0a0d0d0a, ReadUint32(&trace[0]));
+    CHECK_EQUAL(0x1a2b3c4d, ReadUint32(&trace[8]));
+    offset = ReadUint32(&trace[4]);
+    CHECK_EQUAL(1, ReadUint32(&trace[offset]));
+    CHECK_EQUAL(PacketTrace::kLinkType, trace[offset + 8] | (trace[offset + 9] << 8));
+    offset += ReadUint32(&trace[offset + 4]);
+
+    // Only the last two frames are kept, oldest first.
+    while (offset < length)
+    {
+        const uint8_t *frame = &trace[offset + 28];
+
+        CHECK_EQUAL(6, ReadUint32(&trace[offset]));
+        CHECK_EQUAL(PacketTrace::kHeaderSize + sizeof(message), ReadUint32(&trace[offset + 20]));
+        CHECK_EQUAL(count + 1, frame[0]);
+        CHECK_EQUAL(61631, (frame[2] << 8) | frame[3]);
+        CHECK_EQUAL(0, memcmp(&frame[4], kPeer, sizeof(kPeer)));
+        CHECK_EQUAL(count + 1, frame[PacketTrace::kHeaderSize + 3]);
+        CHECK_EQUAL(ReadUint32(&trace[offset + 4]), ReadUint32(&trace[offset + ReadUint32(&trace[offset + 4]) - 4]));
+
+        offset += ReadUint32(&trace[offset + 4]);
+        count++;
+    }
+
+    CHECK_EQUAL(2, count);
+    CHECK_EQUAL(length, offset);
+
+    PacketTrace::Stop();
+    remove(kTraceFile);
+}
+
+TEST(PacketTrace, TestSnapLength)
+{
+    uint8_t trace[4096];
+    uint8_t message[PacketTrace::kSnapLength + 100];
+    size_t  offset;
+
+    memset(message, 0xa5, sizeof(message));
+    CHECK_EQUAL(OTBR_ERROR_NONE, PacketTrace::Start());
+    PacketTrace::Record(PacketTrace::kPointCommissionerIn, kPeer, 49191, message, sizeof(message));
+    CHECK_EQUAL(OTBR_ERROR_NONE, PacketTrace::Save(kTraceFile));
+    ReadTrace(trace, sizeof(trace));
+
+    offset = ReadUint32(&trace[4]);
+    offset += ReadUint32(&trace[offset + 4]);
+
+    // Captured length is truncated, the original length is kept.
+    CHECK_EQUAL(PacketTrace::kHeaderSize + PacketTrace::kSnapLength, ReadUint32(&trace[offset + 20]));
+    CHECK_EQUAL(PacketTrace::kHeaderSize + sizeof(message), ReadUint32(&trace[offset + 24]));
+
+    PacketTrace::Stop();
+    remove(kTraceFile);
+}
+
+TEST(PacketTrace, TestGatheredFrame)
+{
+    PacketTrace::Reader reader;
+    PacketTrace::Frame  frame;
+    uint8_t             message[PacketTrace::kSnapLength + 100];
+    struct iovec        vector[2];
+
+    for (size_t i = 0; i < sizeof(message); i++)
+    {
+        message[i] = static_cast<uint8_t>(i);
+    }
+
+    // The parts are captured as one frame, truncated across them.
+    vector[0].iov_base = message;
+    vector[0].iov_len  = 9;
+    vector[1].iov_base = &message[9];
+    vector[1].iov_len  = sizeof(message) - 9;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, PacketTrace::Start());
+    PacketTrace::Record(PacketTrace::kPointCommissionerOut, kPeer, 49191, vector, 2);
+    CHECK_EQUAL(OTBR_ERROR_NONE, PacketTrace::Save(kTraceFile));
+    PacketTrace::Stop();
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reader.Open(kTraceFile));
+    CHECK(reader.Next(frame));
+    CHECK_EQUAL(PacketTrace::kPointCommissionerOut, frame.mPoint);
+    CHECK_EQUAL(PacketTrace::kSnapLength, frame.mLength);
+    CHECK_EQUAL(sizeof(message), frame.mOriginalLength);
+    CHECK_EQUAL(0, memcmp(frame.mMessage, message, frame.mLength));
+    CHECK(!reader.Next(frame));
+
+    remove(kTraceFile);
+}
+
+TEST(PacketTrace, TestReader)
+{
+    PacketTrace::Reader reader;
+    PacketTrace::Frame  frame;
+    uint8_t             message[PacketTrace::kSnapLength + 100];
+    uint64_t            time;
+    FILE *              fp;
+
+    memset(message, 0xa5, sizeof(message));
+    CHECK_EQUAL(OTBR_ERROR_NONE, PacketTrace::Start());
+    PacketTrace::Record(PacketTrace::kPointCommissionerIn, kPeer, 49191, message, 7);
+    PacketTrace::Record(PacketTrace::kPointThreadOut, kPeer, 61631, message, sizeof(message));
+    CHECK_EQUAL(OTBR_ERROR_NONE, PacketTrace::Save(kTraceFile));
+    PacketTrace::Stop();
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reader.Open(kTraceFile));
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        CHECK(reader.Next(frame));
+        CHECK_EQUAL(PacketTrace::kPointCommissionerIn, frame.mPoint);
+        CHECK_EQUAL(49191, frame.mPort);
+        CHECK_EQUAL(0, memcmp(frame.mIp6, kPeer, sizeof(kPeer)));
+        CHECK_EQUAL(7, frame.mLength);
+        CHECK_EQUAL(7, frame.mOriginalLength);
+        CHECK_EQUAL(0, memcmp(frame.mMessage, message, frame.mLength));
+        time = frame.mTime;
+
+        // Truncated frames keep their original length.
+        CHECK(reader.Next(frame));
+        CHECK_EQUAL(PacketTrace::kPointThreadOut, frame.mPoint);
+        CHECK_EQUAL(61631, frame.mPort);
+        CHECK_EQUAL(PacketTrace::kSnapLength, frame.mLength);
+        CHECK_EQUAL(sizeof(message), frame.mOriginalLength);
+        CHECK(frame.mTime >= time);
+
+        CHECK(!reader.Next(frame));
+        reader.Rewind();
+    }
+
+    // Files other than traces are rejected.
+    fp = fopen(kTraceFile, "wb");
+    CHECK(fp != NULL);
+    CHECK_EQUAL(1, fwrite(message, sizeof(message), 1, fp));
+    fclose(fp);
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, reader.Open(kTraceFile));
+    CHECK_EQUAL(EINVAL, errno);
+    CHECK(!reader.Next(frame));
+
+    remove(kTraceFile);
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, reader.Open(kTraceFile));
+    CHECK_EQUAL(ENOENT, errno);
+}
@@ -0,0 +1,170 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <CppUTest/TestHarness.h>
+
+#include "web-service/prefix_table.hpp"
+
+using ot::Web::PrefixTable;
+
+TEST_GROUP(PrefixTable){};
+
+static PrefixTable::Prefix MakePrefix(const char *aText, bool aDefaultRoute)
+{
+    PrefixTable::Prefix prefix;
+
+    CHECK(PrefixTable::ParsePrefix(aText, prefix.mPrefix));
+    prefix.mDefaultRoute = aDefaultRoute;
+
+    return prefix;
+}
+
+static const char kCurrent[] =
+    "[\"fd00:1:2:3::           prefix_len:64   origin:user     stable:yes flags:0x31 [on-mesh:1 def-route:0 "
+    "config:0 dhcp:0 slaac:1 pref:1 prio:med] rloc:0x0000\","
+    "\"fd00:4:5:6::           prefix_len:64   origin:user     stable:yes flags:0x33 [on-mesh:1 def-route:1 "
+    "config:0 dhcp:0 slaac:1 pref:1 prio:med] rloc:0x0000\","
+    "\"fd00:7:8:9::           prefix_len:64   origin:ncp      stable:yes flags:0x33 [on-mesh:1 def-route:1 "
+    "config:0 dhcp:0 slaac:1 pref:1 prio:med] rloc:0x4400\"]";
+
+TEST(PrefixTable, TestParsePrefix)
+{
+    uint8_t       prefix[PrefixTable::kPrefixSize];
+    const uint8_t kExpected[] = {0xfd, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x03};
+    char          text[64];
+
+    CHECK(PrefixTable::ParsePrefix("fd00:1:2:3::", prefix));
+    MEMCMP_EQUAL(kExpected, prefix, sizeof(kExpected));
+    CHECK(PrefixTable::ParsePrefix("fd00:1:2:3::/64", prefix));
+    MEMCMP_EQUAL(kExpected, prefix, sizeof(kExpected));
+    CHECK(PrefixTable::ParsePrefix("fd00000100020003", prefix));
+    MEMCMP_EQUAL(kExpected, prefix, sizeof(kExpected));
+    CHECK_FALSE(PrefixTable::ParsePrefix("fd00:1:2:3::/48", prefix));
+    CHECK_FALSE(PrefixTable::ParsePrefix("fd00:::1", prefix));
+    CHECK_FALSE(PrefixTable::ParsePrefix(NULL, prefix));
+
+    PrefixTable::FormatPrefix(kExpected, text, sizeof(text));
+    STRCMP_EQUAL("fd00:1:2:3::", text);
+}
+
+TEST(PrefixTable, TestSetCurrent)
+{
+    PrefixTable         table;
+    PrefixTable::Change changes[PrefixTable::kMaxChanges];
+
+    CHECK(table.SetCurrent(kCurrent));
+    // The prefix of another border router is not kept.
+    LONGS_EQUAL(2, table.GetCurrentCount());
+    CHECK(table.SetCurrent("[]"));
+    LONGS_EQUAL(0, table.GetCurrentCount());
+    CHECK_FALSE(table.SetCurrent(""));
+    CHECK_FALSE(table.SetCurrent("[\"fd00:1:2:3::"));
+
+    // Not knowing the prefixes of wpantund, a prefix not desired is removed anyway.
+    LONGS_EQUAL(1, table.Diff(changes, MakePrefix("fd00:1:2:3::", false).mPrefix));
+    CHECK(changes[0].mRemoved);
+}
+
+TEST(PrefixTable, TestDiffUnchanged)
+{
+    PrefixTable               table;
+    PrefixTable::Change       changes[PrefixTable::kMaxChanges];
+    const PrefixTable::Prefix kDesired[] = {MakePrefix("fd00:4:5:6::", true), MakePrefix("fd00:1:2:3::", false)};
+
+    CHECK(table.SetDesired(kDesired, 2));
+    CHECK(table.SetCurrent(kCurrent));
+    LONGS_EQUAL(0, table.Diff(changes));
+}
+
+TEST(PrefixTable, TestDiffChanged)
+{
+    PrefixTable               table;
+    PrefixTable::Change       changes[PrefixTable::kMaxChanges];
+    const PrefixTable::Prefix kDesired[] = {MakePrefix("fd00:4:5:6::", false), MakePrefix("fd00:a::", true)};
+    size_t                    count;
+
+    CHECK(table.SetDesired(kDesired, 2));
+    CHECK(table.SetCurrent(kCurrent));
+    count = table.Diff(changes);
+    LONGS_EQUAL(3, count);
+
+    // The default route changed, a new prefix is added, and the one not desired is removed.
+    MEMCMP_EQUAL(kDesired[0].mPrefix, changes[0].mPrefix.mPrefix, PrefixTable::kPrefixSize);
+    CHECK_FALSE(changes[0].mRemoved);
+    CHECK_FALSE(changes[0].mPrefix.mDefaultRoute);
+    MEMCMP_EQUAL(kDesired[1].mPrefix, changes[1].mPrefix.mPrefix, PrefixTable::kPrefixSize);
+    CHECK_FALSE(changes[1].mRemoved);
+    MEMCMP_EQUAL(MakePrefix("fd00:1:2:3::", false).mPrefix, changes[2].mPrefix.mPrefix, PrefixTable::kPrefixSize);
+    CHECK(changes[2].mRemoved);
+
+    table.Apply(changes, count);
+    LONGS_EQUAL(2, table.GetCurrentCount());
+    LONGS_EQUAL(0, table.Diff(changes));
+}
+
+TEST(PrefixTable, TestDiffOnly)
+{
+    PrefixTable         table;
+    PrefixTable::Change changes[PrefixTable::kMaxChanges];
+
+    CHECK(table.SetCurrent(kCurrent));
+
+    // Adding or deleting a single prefix leaves the others alone.
+    CHECK(table.AddDesired(MakePrefix("fd00:4:5:6::", true)));
+    LONGS_EQUAL(0, table.Diff(changes, MakePrefix("fd00:4:5:6::", true).mPrefix));
+    CHECK(table.AddDesired(MakePrefix("fd00:a::", false)));
+    LONGS_EQUAL(1, table.Diff(changes, MakePrefix("fd00:a::", false).mPrefix));
+    CHECK_FALSE(changes[0].mRemoved);
+
+    table.RemoveDesired(MakePrefix("fd00:b::", false).mPrefix);
+    LONGS_EQUAL(0, table.Diff(changes, MakePrefix("fd00:b::", false).mPrefix));
+    table.RemoveDesired(MakePrefix("fd00:4:5:6::", false).mPrefix);
+    LONGS_EQUAL(1, table.Diff(changes, MakePrefix("fd00:4:5:6::", false).mPrefix));
+    CHECK(changes[0].mRemoved);
+}
+
+TEST(PrefixTable, TestSetDesired)
+{
+    PrefixTable         table;
+    PrefixTable::Prefix prefixes[PrefixTable::kMaxPrefixes + 1];
+
+    for (size_t i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); i++)
+    {
+        prefixes[i]            = MakePrefix("fd00::", false);
+        prefixes[i].mPrefix[7] = static_cast<uint8_t>(i);
+    }
+
+    CHECK_FALSE(table.SetDesired(prefixes, PrefixTable::kMaxPrefixes + 1));
+    CHECK(table.SetDesired(prefixes, PrefixTable::kMaxPrefixes));
+    CHECK_FALSE(table.AddDesired(prefixes[PrefixTable::kMaxPrefixes]));
+    prefixes[1] = prefixes[0];
+    CHECK_FALSE(table.SetDesired(prefixes, 2));
+    LONGS_EQUAL(PrefixTable::kMaxPrefixes, table.GetDesiredCount());
+}
@@ -26,6 +26,10 @@
  *    POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stdio.h>
+
+#include <string>
+
 #include <CppUTest/TestHarness.h>
 
 #include "pskc-generator/pskc.hpp"
@@ -46,3 +50,112 @@ TEST(Pskc, Test123456_0001020304050607_OpenThread)
     pskc = mPSKc.ComputePskc(extpanid, "OpenThread", "123456");
     MEMCMP_EQUAL(expected, pskc, sizeof(expected));
 }
+
+TEST(Pskc, TestCache)
+{
+    uint8_t        extpanid[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
+    uint8_t        expected[OT_PSKC_LENGTH];
+    const uint8_t *pskc = NULL;
+    uint64_t       hits, misses, lastHits, lastMisses;
+
+    ot::Psk::Pskc::ClearCache();
+    ot::Psk::Pskc::GetCacheCounters(lastHits, lastMisses);
+
+    memcpy(expected, mPSKc.ComputePskc(extpanid, "OpenThread", "123456"), sizeof(expected));
+    ot::Psk::Pskc::GetCacheCounters(hits, misses);
+    CHECK_EQUAL(lastHits, hits);
+    CHECK_EQUAL(lastMisses + 1, misses);
+
+    pskc = mPSKc.ComputePskc(extpanid, "OpenThread", "123456");
+    MEMCMP_EQUAL(expected, pskc, sizeof(expected));
+    ot::Psk::Pskc::GetCacheCounters(hits, misses);
+    CHECK_EQUAL(lastHits + 1, hits);
+    CHECK_EQUAL(lastMisses + 1, misses);
+
+    // A different salt is derived again.
+    mPSKc.ComputePskc(extpanid, "OpenThreaD", "123456");
+    ot::Psk::Pskc::GetCacheCounters(hits, misses);
+    CHECK_EQUAL(lastMisses + 2, misses);
+
+    ot::Psk::Pskc::ClearCache();
+    pskc = mPSKc.ComputePskc(extpanid, "OpenThread", "123456");
+    MEMCMP_EQUAL(expected, pskc, sizeof(expected));
+    ot::Psk::Pskc::GetCacheCounters(hits, misses);
+    CHECK_EQUAL(lastHits + 1, hits);
+    CHECK_EQUAL(lastMisses + 3, misses);
+}
+
+TEST(Pskc, TestComputeBatch)
+{
+    uint8_t expected[] = {
+        0xb7, 0x83, 0x81, 0x27, 0x89, 0x91, 0x1e, 0xb4, 0xea, 0x76, 0x59, 0x6c, 0x9c, 0xed, 0x2a, 0x69,
+    };
+    ot::Psk::Pskc::BatchItem items[5];
+    char                     passphrases[5][8];
+
+    for (size_t i = 0; i < 5; i++)
+    {
+        for (size_t j = 0; j < sizeof(items[i].mExtPanId); j++)
+        {
+            items[i].mExtPanId[j] = static_cast<uint8_t>(j);
+        }
+
+        snprintf(passphrases[i], sizeof(passphrases[i]), "other%u", static_cast<unsigned int>(i));
+        items[i].mNetworkName = "OpenThread";
+        items[i].mPassphrase  = passphrases[i];
+    }
+
+    snprintf(passphrases[4], sizeof(passphrases[4]), "123456");
+    ot::Psk::Pskc::ComputeBatch(items, 5, 3);
+
+    MEMCMP_EQUAL(expected, items[4].mPskc, sizeof(expected));
+    for (size_t i = 0; i < 4; i++)
+    {
+        MEMCMP_EQUAL(mPSKc.ComputePskc(items[i].mExtPanId, "OpenThread", passphrases[i]), items[i].mPskc,
+                     OT_PSKC_LENGTH);
+    }
+}
+
+TEST(Pskc, TestMultiBuffer)
+{
+    ot::Psk::Pskc::BatchItem items[11];
+    uint8_t                  expected[11][OT_PSKC_LENGTH];
+    std::string              passphrases[11];
+
+    // Passphrases of other lengths than the AES key are hashed into it, long ones are not cached.
+    for (size_t i = 0; i < 11; i++)
+    {
+        for (size_t j = 0; j < sizeof(items[i].mExtPanId); j++)
+        {
+            items[i].mExtPanId[j] = static_cast<uint8_t>(i + j);
+        }
+
+        passphrases[i].assign(i * 29 + 1, static_cast<char>('a' + i));
+        items[i].mNetworkName = (i % 2) ? "OpenThread" : "Thread Network";
+        items[i].mPassphrase  = passphrases[i].c_str();
+    }
+
+    ot::Psk::Pskc::SetMultiBuffer(false);
+    for (size_t i = 0; i < 11; i++)
+    {
+        ot::Psk::Pskc::ClearCache();
+        memcpy(expected[i], mPSKc.ComputePskc(items[i].mExtPanId, items[i].mNetworkName, items[i].mPassphrase),
+               OT_PSKC_LENGTH);
+    }
+
+    // The kernel is not available on every CPU, the batch is then derived one at a time again.
+    ot::Psk::Pskc::SetMultiBuffer(true);
+    ot::Psk::Pskc::ClearCache();
+    ot::Psk::Pskc::ComputeBatch(items, 11, 1);
+
+    for (size_t i = 0; i < 11; i++)
+    {
+        MEMCMP_EQUAL(expected[i], items[i].mPskc, OT_PSKC_LENGTH);
+    }
+
+    ot::Psk::Pskc::ClearCache();
+    ot::Psk::Pskc::ComputeBatch(items, 11, 2);
+    MEMCMP_EQUAL(expected[10], items[10].mPskc, OT_PSKC_LENGTH);
+    MEMCMP_EQUAL(expected[5], mPSKc.ComputePskc(items[5].mExtPanId, items[5].mNetworkName, items[5].mPassphrase),
+                 OT_PSKC_LENGTH);
+}
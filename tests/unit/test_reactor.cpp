@@ -0,0 +1,487 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "common/reactor.hpp"
+#include "common/time.hpp"
+
+using namespace ot::BorderRouter;
+
+struct ReactorContext
+{
+    Reactor *       mReactor;
+    Reactor::Watch *mRemove;
+    int             mCounter;
+    unsigned int    mEvents;
+};
+
+static void HandleReadable(void *aContext, int aFd, unsigned int aEvents)
+{
+    ReactorContext &context = *static_cast<ReactorContext *>(aContext);
+    char            byte;
+
+    context.mCounter++;
+    context.mEvents = aEvents;
+
+    if (context.mRemove != NULL)
+    {
+        context.mReactor->Remove(*context.mRemove);
+    }
+    else
+    {
+        CHECK_EQUAL(1, read(aFd, &byte, sizeof(byte)));
+    }
+}
+
+static volatile sig_atomic_t sSignaled = 0;
+
+static void HandleSignal(int aSignal)
+{
+    (void)aSignal;
+    sSignaled = 1;
+}
+
+TEST_GROUP(Reactor){};
+
+TEST(Reactor, TestDispatchReadyOnly)
+{
+    Reactor        reactor;
+    Reactor::Watch watch1;
+    Reactor::Watch watch2;
+    ReactorContext context1 = {&reactor, NULL, 0, 0};
+    ReactorContext context2 = {&reactor, NULL, 0, 0};
+    int            pipe1[2];
+    int            pipe2[2];
+    fd_set         readFdSet;
+    fd_set         writeFdSet;
+    fd_set         errorFdSet;
+    timeval        timeout = {0, 0};
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(0, pipe(pipe1));
+    CHECK_EQUAL(0, pipe(pipe2));
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(watch1, pipe1[0], Reactor::kEventReadable, HandleReadable, &context1));
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(watch2, pipe2[0], Reactor::kEventReadable, HandleReadable, &context2));
+
+    CHECK_EQUAL(1, write(pipe2[1], "x", 1));
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+    CHECK_EQUAL(1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+    CHECK_EQUAL(0, context1.mCounter);
+    CHECK_EQUAL(1, context2.mCounter);
+    CHECK_EQUAL(static_cast<unsigned int>(Reactor::kEventReadable), context2.mEvents);
+
+    // Nothing is ready any more.
+    CHECK_EQUAL(0, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+    CHECK_EQUAL(1, context2.mCounter);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(watch1));
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(watch2));
+
+    // Removing twice should fail.
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, reactor.Remove(watch2));
+
+    close(pipe1[0]);
+    close(pipe1[1]);
+    close(pipe2[0]);
+    close(pipe2[1]);
+}
+
+TEST(Reactor, TestSharedFdAndRemoveInHandler)
+{
+    Reactor        reactor;
+    Reactor::Watch watch1;
+    Reactor::Watch watch2;
+    ReactorContext context1 = {&reactor, &watch2, 0, 0};
+    ReactorContext context2 = {&reactor, &watch1, 0, 0};
+    int            fds[2];
+    fd_set         readFdSet;
+    fd_set         writeFdSet;
+    fd_set         errorFdSet;
+    timeval        timeout = {0, 0};
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(0, pipe(fds));
+
+    // Two watches on the same file descriptor, whichever runs first removes the other.
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(watch1, fds[0], Reactor::kEventReadable, HandleReadable, &context1));
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(watch2, fds[0], Reactor::kEventReadable, HandleReadable, &context2));
+    CHECK_EQUAL(1, write(fds[1], "x", 1));
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+    CHECK_EQUAL(1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+    CHECK_EQUAL(1, context1.mCounter + context2.mCounter);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(Reactor, TestLegacyFdSet)
+{
+    Reactor        reactor;
+    Reactor::Watch watch;
+    ReactorContext context = {&reactor, NULL, 0, 0};
+    int            reactorFds[2];
+    int            legacyFds[2];
+    fd_set         readFdSet;
+    fd_set         writeFdSet;
+    fd_set         errorFdSet;
+    timeval        timeout = {0, 0};
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(0, pipe(reactorFds));
+    CHECK_EQUAL(0, pipe(legacyFds));
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(watch, reactorFds[0], Reactor::kEventReadable, HandleReadable, &context));
+
+    CHECK_EQUAL(1, write(reactorFds[1], "x", 1));
+    CHECK_EQUAL(1, write(legacyFds[1], "x", 1));
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+    FD_SET(legacyFds[0], &readFdSet);
+    CHECK(reactor.Poll(readFdSet, writeFdSet, errorFdSet, legacyFds[0], timeout) > 0);
+    CHECK(FD_ISSET(legacyFds[0], &readFdSet));
+    CHECK_EQUAL(1, context.mCounter);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(watch));
+
+    close(reactorFds[0]);
+    close(reactorFds[1]);
+    close(legacyFds[0]);
+    close(legacyFds[1]);
+}
+
+static void HandleSlowReadable(void *aContext, int aFd, unsigned int aEvents)
+{
+    usleep(20000);
+    HandleReadable(aContext, aFd, aEvents);
+}
+
+TEST(Reactor, TestSlowestHandler)
+{
+    Reactor        reactor;
+    Reactor::Watch watch1;
+    Reactor::Watch watch2;
+    ReactorContext context1 = {&reactor, NULL, 0, 0};
+    ReactorContext context2 = {&reactor, NULL, 0, 0};
+    int            pipe1[2];
+    int            pipe2[2];
+    fd_set         readFdSet;
+    fd_set         writeFdSet;
+    fd_set         errorFdSet;
+    timeval        timeout = {0, 0};
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(0, pipe(pipe1));
+    CHECK_EQUAL(0, pipe(pipe2));
+
+    CHECK_EQUAL(OTBR_ERROR_NONE,
+                reactor.Add(watch1, pipe1[0], Reactor::kEventReadable, HandleReadable, &context1, "fast"));
+    CHECK_EQUAL(OTBR_ERROR_NONE,
+                reactor.Add(watch2, pipe2[0], Reactor::kEventReadable, HandleSlowReadable, &context2, "slow"));
+
+    CHECK_EQUAL(1, write(pipe1[1], "x", 1));
+    CHECK_EQUAL(1, write(pipe2[1], "x", 1));
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+    CHECK_EQUAL(2, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+    STRCMP_EQUAL("slow", reactor.GetSlowestHandler().mName);
+    CHECK_EQUAL(pipe2[0], reactor.GetSlowestHandler().mFd);
+    CHECK(reactor.GetSlowestHandler().mTime >= 20000);
+    CHECK(reactor.GetWakeTime() > 0);
+
+    // Each wakeup starts over.
+    CHECK_EQUAL(0, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+    POINTERS_EQUAL(NULL, reactor.GetSlowestHandler().mName);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(watch1));
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(watch2));
+
+    close(pipe1[0]);
+    close(pipe1[1]);
+    close(pipe2[0]);
+    close(pipe2[1]);
+}
+
+// The loop clock read by the last call of HandleLoopClock().
+static uint64_t sHandlerNowUs = 0;
+
+static void HandleLoopClock(void *aContext, int aFd, unsigned int aEvents)
+{
+    char byte;
+
+    sHandlerNowUs = LoopClock::GetNowUs();
+    CHECK_EQUAL(1, read(aFd, &byte, sizeof(byte)));
+
+    (void)aContext;
+    (void)aEvents;
+}
+
+TEST(Reactor, TestLoopClock)
+{
+    Reactor        reactor;
+    Reactor::Watch watch;
+    int            fds[2];
+    fd_set         readFdSet;
+    fd_set         writeFdSet;
+    fd_set         errorFdSet;
+    timeval        timeout = {0, 0};
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(0, pipe(fds));
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(watch, fds[0], Reactor::kEventReadable, HandleLoopClock, NULL));
+
+    // Handlers read the time the reactor woke up at.
+    CHECK_EQUAL(1, write(fds[1], "x", 1));
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+    CHECK_EQUAL(1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+    CHECK_EQUAL(reactor.GetWakeTime(), sHandlerNowUs);
+
+    // The clock is stopped on return, so the current time is read afterwards.
+    usleep(2000);
+    CHECK(LoopClock::GetNowUs() >= reactor.GetWakeTime() + 2000);
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(watch));
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(Reactor, TestSignalMask)
+{
+    Reactor  reactor;
+    sigset_t signals;
+    sigset_t oldMask;
+    fd_set   readFdSet;
+    fd_set   writeFdSet;
+    fd_set   errorFdSet;
+    timeval  timeout = {10, 0};
+    int      legacyFds[2];
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(0, pipe(legacyFds));
+    signal(SIGUSR1, HandleSignal);
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    CHECK_EQUAL(0, pthread_sigmask(SIG_BLOCK, &signals, &oldMask));
+    reactor.SetSignalMask(&oldMask);
+
+    // The signal raised while blocked is delivered once waiting, instead of the wait running to the timeout.
+    sSignaled = 0;
+    raise(SIGUSR1);
+    CHECK_EQUAL(0, sSignaled);
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+    CHECK_EQUAL(-1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+    CHECK_EQUAL(EINTR, errno);
+    CHECK_EQUAL(1, sSignaled);
+
+    // So does the fd_set interface.
+    sSignaled = 0;
+    raise(SIGUSR1);
+    FD_SET(legacyFds[0], &readFdSet);
+    CHECK_EQUAL(-1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, legacyFds[0], timeout));
+    CHECK_EQUAL(EINTR, errno);
+    CHECK_EQUAL(1, sSignaled);
+
+    CHECK_EQUAL(0, pthread_sigmask(SIG_SETMASK, &oldMask, NULL));
+    signal(SIGUSR1, SIG_DFL);
+    close(legacyFds[0]);
+    close(legacyFds[1]);
+}
+
+static void HandleCount(void *aContext, int aFd, unsigned int aEvents)
+{
+    ReactorContext &context = *static_cast<ReactorContext *>(aContext);
+
+    context.mCounter++;
+    context.mEvents = aEvents;
+
+    (void)aFd;
+}
+
+static void TestBackend(Reactor::Backend aBackend)
+{
+    Reactor        reactor;
+    Reactor::Watch level;
+    Reactor::Watch edge;
+    ReactorContext levelContext = {&reactor, NULL, 0, 0};
+    ReactorContext edgeContext  = {&reactor, NULL, 0, 0};
+    int            levelFds[2];
+    int            edgeFds[2];
+    int            legacyFds[2];
+    char           bytes[2];
+    fd_set         readFdSet;
+    fd_set         writeFdSet;
+    fd_set         errorFdSet;
+    timeval        timeout = {0, 0};
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init(aBackend));
+    CHECK_EQUAL(0, pipe(levelFds));
+    CHECK_EQUAL(0, pipe(edgeFds));
+    CHECK_EQUAL(0, pipe(legacyFds));
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(level, levelFds[0], Reactor::kEventReadable, HandleReadable, &levelContext));
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(edge, edgeFds[0], Reactor::kEventReadable | Reactor::kEventEdge,
+                                             HandleCount, &edgeContext));
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+    CHECK_EQUAL(0, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+
+    // A level-triggered watch not drained is dispatched again.
+    CHECK_EQUAL(2, write(levelFds[1], "xy", 2));
+    CHECK_EQUAL(1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+    CHECK_EQUAL(1, levelContext.mCounter);
+    CHECK_EQUAL(1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+    CHECK_EQUAL(2, levelContext.mCounter);
+    CHECK_EQUAL(0, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+
+    // An edge-triggered watch is dispatched for new data only, select() has no edge-triggered events.
+    if (reactor.GetBackend() != Reactor::kBackendSelect)
+    {
+        CHECK_EQUAL(1, write(edgeFds[1], "x", 1));
+        CHECK_EQUAL(1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+        CHECK_EQUAL(1, edgeContext.mCounter);
+        CHECK_EQUAL(0, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+        CHECK_EQUAL(1, write(edgeFds[1], "y", 1));
+        CHECK_EQUAL(1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+        CHECK_EQUAL(2, edgeContext.mCounter);
+        CHECK_EQUAL(2, read(edgeFds[0], bytes, sizeof(bytes)));
+    }
+
+    // A changed watch is dispatched for its new events.
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(edge));
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(edge, edgeFds[1], 0, HandleCount, &edgeContext));
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Modify(edge, Reactor::kEventWritable));
+    edgeContext.mCounter = 0;
+    CHECK_EQUAL(1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+    CHECK_EQUAL(1, edgeContext.mCounter);
+    CHECK_EQUAL(static_cast<unsigned int>(Reactor::kEventWritable), edgeContext.mEvents);
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(edge));
+
+    // Watches are dispatched alongside legacy file descriptors.
+    CHECK_EQUAL(1, write(levelFds[1], "x", 1));
+    CHECK_EQUAL(1, write(legacyFds[1], "x", 1));
+    FD_SET(legacyFds[0], &readFdSet);
+    CHECK(reactor.Poll(readFdSet, writeFdSet, errorFdSet, legacyFds[0], timeout) > 0);
+    CHECK(FD_ISSET(legacyFds[0], &readFdSet));
+    CHECK_EQUAL(3, levelContext.mCounter);
+
+    // A removed watch is no longer dispatched.
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(level));
+    CHECK_EQUAL(1, write(levelFds[1], "x", 1));
+    FD_ZERO(&readFdSet);
+    CHECK_EQUAL(0, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+    CHECK_EQUAL(3, levelContext.mCounter);
+
+    for (int i = 0; i < 2; i++)
+    {
+        close(levelFds[i]);
+        close(edgeFds[i]);
+        close(legacyFds[i]);
+    }
+}
+
+TEST(Reactor, TestSelectBackend)
+{
+    TestBackend(Reactor::kBackendSelect);
+}
+
+TEST(Reactor, TestUringBackend)
+{
+    // Falls back to epoll unless built with io_uring and running on a kernel supporting it.
+    TestBackend(Reactor::kBackendUring);
+}
+
+TEST(Reactor, TestWatchesWithoutEvents)
+{
+    const Reactor::Backend backends[] = {Reactor::kBackendSelect, Reactor::kBackendEpoll, Reactor::kBackendUring};
+
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++)
+    {
+        Reactor        reactor;
+        Reactor::Watch idle;
+        Reactor::Watch watch;
+        ReactorContext idleContext = {&reactor, NULL, 0, 0};
+        ReactorContext context     = {&reactor, NULL, 0, 0};
+        int            fds[2];
+        fd_set         readFdSet;
+        fd_set         writeFdSet;
+        fd_set         errorFdSet;
+        timeval        timeout = {0, 0};
+
+        CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init(backends[i]));
+        CHECK_EQUAL(0, pipe(fds));
+        FD_ZERO(&readFdSet);
+        FD_ZERO(&writeFdSet);
+        FD_ZERO(&errorFdSet);
+
+        // A watch added without events is still registered.
+        CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(idle, fds[0], 0, HandleReadable, &idleContext));
+        CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(idle));
+        CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(idle, fds[0], 0, HandleReadable, &idleContext));
+        CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Add(watch, fds[0], Reactor::kEventReadable, HandleReadable, &context));
+        CHECK_EQUAL(1, write(fds[1], "x", 1));
+        CHECK_EQUAL(1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+        CHECK_EQUAL(0, idleContext.mCounter);
+        CHECK_EQUAL(1, context.mCounter);
+
+        // The events of a watch are cleared and set again.
+        CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(idle));
+        CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Modify(watch, 0));
+        CHECK_EQUAL(1, write(fds[1], "x", 1));
+        FD_ZERO(&readFdSet);
+        CHECK_EQUAL(0, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+        CHECK_EQUAL(1, context.mCounter);
+        CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Modify(watch, Reactor::kEventReadable));
+        CHECK_EQUAL(1, reactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout));
+        CHECK_EQUAL(2, context.mCounter);
+        CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Remove(watch));
+
+        close(fds[0]);
+        close(fds[1]);
+    }
+}
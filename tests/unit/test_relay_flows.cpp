@@ -0,0 +1,116 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <CppUTest/TestHarness.h>
+
+#include "agent/relay_flows.hpp"
+
+using namespace ot::BorderRouter;
+
+TEST_GROUP(RelayFlowTable){};
+
+TEST(RelayFlowTable, TestExchange)
+{
+    static const uint8_t kIid[RelayFlowTable::kJoinerIidSize] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    RelayFlowTable       table;
+    RelayFlowTable::Flow flow;
+
+    LONGS_EQUAL(0, table.GetFlows(&flow, 1));
+
+    // The joiner sends twice, the commissioner answers after 5ms, the mesh and joiner after 20ms.
+    table.Record(RelayFlowTable::kDirectionReceive, kIid, 0x1000, 100, 1000000, 50);
+    table.Record(RelayFlowTable::kDirectionReceive, kIid, 0x1000, 60, 1003000, 30);
+    table.Record(RelayFlowTable::kDirectionTransmit, kIid, 0x1000, 80, 1008000, 40);
+    table.Record(RelayFlowTable::kDirectionReceive, kIid, 0x1000, 70, 1028000, 10);
+
+    LONGS_EQUAL(1, table.GetFlows(&flow, 1));
+    MEMCMP_EQUAL(kIid, flow.mJoinerIid, sizeof(kIid));
+    LONGS_EQUAL(0x1000, flow.mLocator);
+    CHECK_EQUAL(1000000, flow.mFirstTime);
+    CHECK_EQUAL(1028000, flow.mLastTime);
+
+    const RelayFlowTable::Stats &rx = flow.mStats[RelayFlowTable::kDirectionReceive];
+    const RelayFlowTable::Stats &tx = flow.mStats[RelayFlowTable::kDirectionTransmit];
+
+    LONGS_EQUAL(3, rx.mPackets);
+    CHECK_EQUAL(230, rx.mBytes);
+    CHECK_EQUAL(28000, rx.mGapTotal);
+    LONGS_EQUAL(25000, rx.mGapMax);
+    CHECK_EQUAL(90, rx.mForwardTotal);
+    LONGS_EQUAL(50, rx.mForwardMax);
+    LONGS_EQUAL(1, rx.mTurnarounds);
+    LONGS_EQUAL(20000, rx.mTurnaroundMax);
+
+    LONGS_EQUAL(1, tx.mPackets);
+    CHECK_EQUAL(80, tx.mBytes);
+    CHECK_EQUAL(0, tx.mGapTotal);
+    LONGS_EQUAL(1, tx.mTurnarounds);
+    CHECK_EQUAL(5000, tx.mTurnaroundTotal);
+}
+
+TEST(RelayFlowTable, TestLeastRecentlyUsed)
+{
+    RelayFlowTable       table;
+    RelayFlowTable::Flow flows[RelayFlowTable::kMaxFlows];
+    uint8_t              iid[RelayFlowTable::kJoinerIidSize];
+
+    memset(iid, 0, sizeof(iid));
+
+    for (unsigned int i = 0; i < RelayFlowTable::kMaxFlows; ++i)
+    {
+        iid[0] = static_cast<uint8_t>(i);
+        table.Record(RelayFlowTable::kDirectionReceive, iid, 0x1000, 10, 1000 + i, 0);
+    }
+
+    // Using the first flow again makes the second one the least recently used.
+    iid[0] = 0;
+    table.Record(RelayFlowTable::kDirectionTransmit, iid, 0x1000, 10, 5000, 0);
+    iid[0] = 0xff;
+    table.Record(RelayFlowTable::kDirectionReceive, iid, 0x1000, 10, 6000, 0);
+
+    LONGS_EQUAL(RelayFlowTable::kMaxFlows, table.GetFlows(flows, RelayFlowTable::kMaxFlows));
+    LONGS_EQUAL(0xff, flows[0].mJoinerIid[0]);
+    LONGS_EQUAL(0, flows[1].mJoinerIid[0]);
+
+    for (unsigned int i = 0; i < RelayFlowTable::kMaxFlows; ++i)
+    {
+        CHECK(RelayFlowTable::kMaxFlows == 1 || flows[i].mJoinerIid[0] != 1);
+        CHECK(i == 0 || flows[i - 1].mLastTime >= flows[i].mLastTime);
+    }
+
+    // A flow is identified by the router locator too, and only the most recent ones are returned if asked for fewer.
+    table.Record(RelayFlowTable::kDirectionReceive, iid, 0x2000, 10, 7000, 0);
+    LONGS_EQUAL(1, table.GetFlows(flows, 1));
+    LONGS_EQUAL(0x2000, flows[0].mLocator);
+
+    table.Clear();
+    LONGS_EQUAL(0, table.GetFlows(flows, RelayFlowTable::kMaxFlows));
+}
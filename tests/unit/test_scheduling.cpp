@@ -0,0 +1,110 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+
+#include <CppUTest/TestHarness.h>
+
+#include "agent/scheduling.hpp"
+
+using namespace ot::BorderRouter;
+
+TEST_GROUP(Scheduling){};
+
+TEST(Scheduling, TestParseCpus)
+{
+    cpu_set_t set;
+
+    LONGS_EQUAL(OTBR_ERROR_NONE, Scheduling::ParseCpus("0,2-4", set));
+    LONGS_EQUAL(4, CPU_COUNT(&set));
+    CHECK(CPU_ISSET(0, &set));
+    CHECK(!CPU_ISSET(1, &set));
+    CHECK(CPU_ISSET(2, &set));
+    CHECK(CPU_ISSET(4, &set));
+
+    LONGS_EQUAL(OTBR_ERROR_NONE, Scheduling::ParseCpus("3", set));
+    LONGS_EQUAL(1, CPU_COUNT(&set));
+    CHECK(CPU_ISSET(3, &set));
+
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParseCpus("", set));
+    LONGS_EQUAL(EINVAL, errno);
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParseCpus("1,", set));
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParseCpus("3-1", set));
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParseCpus("1;2", set));
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParseCpus("-1", set));
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParseCpus("100000", set));
+}
+
+TEST(Scheduling, TestParsePriority)
+{
+    Scheduling::Priority priority;
+
+    LONGS_EQUAL(OTBR_ERROR_NONE, Scheduling::ParsePriority("fifo=10", priority));
+    LONGS_EQUAL(SCHED_FIFO, priority.mPolicy);
+    LONGS_EQUAL(10, priority.mValue);
+
+    LONGS_EQUAL(OTBR_ERROR_NONE, Scheduling::ParsePriority("nice=-5", priority));
+    LONGS_EQUAL(SCHED_OTHER, priority.mPolicy);
+    LONGS_EQUAL(-5, priority.mValue);
+
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParsePriority("fifo=0", priority));
+    LONGS_EQUAL(EINVAL, errno);
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParsePriority("nice=20", priority));
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParsePriority("nice=", priority));
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParsePriority("rr=10", priority));
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParsePriority("fifo=10x", priority));
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::ParsePriority("10", priority));
+}
+
+TEST(Scheduling, TestSetAffinity)
+{
+    cpu_set_t saved;
+    cpu_set_t set;
+
+    // Pinning to the CPUs currently allowed always succeeds.
+    LONGS_EQUAL(0, sched_getaffinity(0, sizeof(saved), &saved));
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &saved))
+        {
+            char cpus[16];
+
+            snprintf(cpus, sizeof(cpus), "%d", cpu);
+            LONGS_EQUAL(OTBR_ERROR_NONE, Scheduling::SetAffinity(cpus));
+            LONGS_EQUAL(0, sched_getaffinity(0, sizeof(set), &set));
+            LONGS_EQUAL(1, CPU_COUNT(&set));
+            CHECK(CPU_ISSET(cpu, &set));
+            break;
+        }
+    }
+
+    LONGS_EQUAL(0, sched_setaffinity(0, sizeof(saved), &saved));
+    LONGS_EQUAL(OTBR_ERROR_ERRNO, Scheduling::SetAffinity("x"));
+}
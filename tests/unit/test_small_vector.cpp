@@ -0,0 +1,89 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include "common/small_vector.hpp"
+
+using namespace ot::BorderRouter;
+
+TEST_GROUP(SmallVector){};
+
+TEST(SmallVector, TestInline)
+{
+    SmallVector<int, 4> vector;
+    const int *         inlineData;
+
+    CHECK_EQUAL(0, vector.GetSize());
+    CHECK(vector.Begin() == vector.End());
+
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(vector.PushBack(i));
+    }
+
+    // The inline elements are stored within the vector itself.
+    inlineData = vector.Begin();
+    CHECK(reinterpret_cast<const char *>(inlineData) >= reinterpret_cast<const char *>(&vector));
+    CHECK(reinterpret_cast<const char *>(inlineData) < reinterpret_cast<const char *>(&vector + 1));
+
+    vector.Erase(vector.Begin() + 1);
+    CHECK_EQUAL(3, vector.GetSize());
+    CHECK_EQUAL(0, vector[0]);
+    CHECK_EQUAL(2, vector[1]);
+    CHECK_EQUAL(3, vector[2]);
+
+    vector.Clear();
+    CHECK_EQUAL(0, vector.GetSize());
+}
+
+TEST(SmallVector, TestGrow)
+{
+    SmallVector<int, 2> vector;
+    int                 sum = 0;
+
+    for (int i = 0; i < 100; i++)
+    {
+        CHECK(vector.PushBack(i));
+    }
+
+    CHECK_EQUAL(100, vector.GetSize());
+
+    for (const int *it = vector.Begin(); it != vector.End(); ++it)
+    {
+        sum += *it;
+    }
+
+    CHECK_EQUAL(4950, sum);
+
+    vector.Erase(vector.End() - 1);
+    vector.Erase(vector.Begin());
+    CHECK_EQUAL(98, vector.GetSize());
+    CHECK_EQUAL(1, vector[0]);
+    CHECK_EQUAL(98, vector[97]);
+}
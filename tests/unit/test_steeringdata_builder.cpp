@@ -0,0 +1,167 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "utils/steeringdata_builder.hpp"
+#include "common/tlv.hpp"
+
+TEST_GROUP(SteeringDataBuilder){};
+
+static void FillEui64s(uint8_t *aEntries, size_t aCount)
+{
+    for (size_t i = 0; i < aCount; i++)
+    {
+        uint8_t *entry = aEntries + i * ot::SteeringDataBuilder::kEui64Length;
+
+        memset(entry, 0, ot::SteeringDataBuilder::kEui64Length);
+        entry[0] = 0x18;
+        entry[1] = 0xb4;
+        entry[5] = static_cast<uint8_t>(i >> 16);
+        entry[6] = static_cast<uint8_t>(i >> 8);
+        entry[7] = static_cast<uint8_t>(i);
+    }
+}
+
+TEST(SteeringDataBuilder, TestJoinerId)
+{
+    // The joiner ID is the first bytes of the SHA-256 of the EUI-64, with the locally administered bit set.
+    const uint8_t kEui64[]    = {0x18, 0xb4, 0x30, 0x00, 0x00, 0x00, 0x00, 0x01};
+    const uint8_t kJoinerId[] = {0xcf, 0xe0, 0xd8, 0xdd, 0x4e, 0xfc, 0x29, 0x73};
+    uint8_t       joinerId[ot::SteeringDataBuilder::kEui64Length];
+
+    ot::SteeringDataBuilder::ComputeJoinerId(kEui64, joinerId);
+    MEMCMP_EQUAL(kJoinerId, joinerId, sizeof(joinerId));
+}
+
+TEST(SteeringDataBuilder, TestEmpty)
+{
+    ot::SteeringDataBuilder builder;
+
+    CHECK(builder.GetSteeringData().IsCleared());
+    LONGS_EQUAL(0, builder.GetCount());
+    CHECK(builder.GetFalsePositiveRate() == 0);
+}
+
+TEST(SteeringDataBuilder, TestSerial)
+{
+    enum
+    {
+        kCount = 100,
+    };
+    uint8_t                 entries[kCount * ot::SteeringDataBuilder::kEui64Length];
+    ot::SteeringDataBuilder builder;
+    ot::SteeringData        expected;
+    uint8_t                 tlv[32];
+
+    FillEui64s(entries, kCount);
+    builder.Init(8);
+    builder.Add(entries, kCount, ot::SteeringDataBuilder::kEntryEui64, 0);
+
+    expected.SetLength(8);
+    expected.Clear();
+
+    for (size_t i = 0; i < kCount; i++)
+    {
+        uint8_t joinerId[ot::SteeringDataBuilder::kEui64Length];
+
+        ot::SteeringDataBuilder::ComputeJoinerId(entries + i * ot::SteeringDataBuilder::kEui64Length, joinerId);
+        expected.ComputeBloomFilter(joinerId);
+    }
+
+    LONGS_EQUAL(kCount, builder.GetCount());
+    MEMCMP_EQUAL(expected.GetDataPointer(), builder.GetSteeringData().GetDataPointer(), 8);
+    CHECK(builder.GetFalsePositiveRate() > 0.5);
+    CHECK(builder.GetFalsePositiveRate() <= 1);
+
+    LONGS_EQUAL(0, builder.WriteTlv(tlv, 9));
+    LONGS_EQUAL(10, builder.WriteTlv(tlv, sizeof(tlv)));
+    LONGS_EQUAL(ot::Meshcop::kSteeringData, tlv[0]);
+    LONGS_EQUAL(8, tlv[1]);
+    MEMCMP_EQUAL(expected.GetDataPointer(), tlv + 2, 8);
+}
+
+TEST(SteeringDataBuilder, TestParallel)
+{
+    const size_t            kCount  = ot::SteeringDataBuilder::kParallelThreshold * 4 + 3;
+    uint8_t *               entries = new uint8_t[kCount * ot::SteeringDataBuilder::kEui64Length];
+    ot::SteeringDataBuilder serial;
+    ot::SteeringDataBuilder parallel;
+
+    FillEui64s(entries, kCount);
+
+    serial.Init(16);
+    serial.Add(entries, kCount, ot::SteeringDataBuilder::kEntryJoinerId, 1);
+    parallel.Init(16);
+    parallel.Add(entries, kCount, ot::SteeringDataBuilder::kEntryJoinerId, 4);
+
+    LONGS_EQUAL(kCount, parallel.GetCount());
+    MEMCMP_EQUAL(serial.GetSteeringData().GetDataPointer(), parallel.GetSteeringData().GetDataPointer(), 16);
+
+    delete[] entries;
+}
+
+TEST(SteeringDataBuilder, TestFile)
+{
+    char                    path[] = "/tmp/otbr-joiners-XXXXXX";
+    int                     fd     = mkstemp(path);
+    FILE *                  file   = fdopen(fd, "w");
+    ot::SteeringDataBuilder builder;
+    ot::SteeringData        expected;
+    unsigned long           line;
+
+    CHECK(file != NULL);
+    fputs("# joiners\n18b4300000000001\n\n  18B4300000000002  \n", file);
+    fclose(file);
+
+    expected.Init();
+    expected.ComputeBloomFilterAscii("18b4300000000001");
+    expected.ComputeBloomFilterAscii("18b4300000000002");
+
+    CHECK(builder.AddFile(path, ot::SteeringDataBuilder::kEntryJoinerId, 0, line));
+    LONGS_EQUAL(2, builder.GetCount());
+    MEMCMP_EQUAL(expected.GetDataPointer(), builder.GetSteeringData().GetDataPointer(), 16);
+
+    file = fopen(path, "a");
+    fputs("18b430000000003\n", file);
+    fclose(file);
+
+    builder.Init(16);
+    CHECK(!builder.AddFile(path, ot::SteeringDataBuilder::kEntryJoinerId, 0, line));
+    LONGS_EQUAL(5, line);
+    LONGS_EQUAL(0, builder.GetCount());
+
+    unlink(path);
+
+    CHECK(!builder.AddFile(path, ot::SteeringDataBuilder::kEntryJoinerId, 0, line));
+    LONGS_EQUAL(0, line);
+}
@@ -0,0 +1,119 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+
+#include "utils/steeringdata_builder.hpp"
+#include "utils/steeringdata_counting.hpp"
+#include "common/tlv.hpp"
+
+TEST_GROUP(CountingSteeringData){};
+
+static void FillJoinerIds(uint8_t *aEntries, size_t aCount)
+{
+    for (size_t i = 0; i < aCount; i++)
+    {
+        uint8_t *entry = aEntries + i * ot::SteeringDataBuilder::kEui64Length;
+        uint8_t  eui64[ot::SteeringDataBuilder::kEui64Length] = {0x18, 0xb4, 0x30, 0, 0, 0, 0, 0};
+
+        eui64[6] = static_cast<uint8_t>(i >> 8);
+        eui64[7] = static_cast<uint8_t>(i);
+        ot::SteeringDataBuilder::ComputeJoinerId(eui64, entry);
+    }
+}
+
+static void CheckSameData(ot::CountingSteeringData &aCounting, const uint8_t *aEntries, size_t aCount, uint8_t aLength)
+{
+    ot::SteeringDataBuilder builder;
+
+    builder.Init(aLength);
+    builder.Add(aEntries, aCount, ot::SteeringDataBuilder::kEntryJoinerId, 1);
+    CHECK_EQUAL(aCount, aCounting.GetCount());
+    CHECK_EQUAL(builder.GetSteeringData().GetLength(), aCounting.GetSteeringData().GetLength());
+    CHECK_EQUAL(0, memcmp(builder.GetSteeringData().GetDataPointer(), aCounting.GetSteeringData().GetDataPointer(),
+                          aLength));
+}
+
+TEST(CountingSteeringData, TestAddRemove)
+{
+    enum
+    {
+        kCount = 64,
+    };
+
+    uint8_t                  entries[kCount * ot::SteeringDataBuilder::kEui64Length];
+    ot::CountingSteeringData counting;
+
+    FillJoinerIds(entries, kCount);
+    counting.Init(4);
+    CHECK(counting.GetSteeringData().IsCleared());
+
+    for (size_t i = 0; i < kCount; i++)
+    {
+        counting.Add(entries + i * ot::SteeringDataBuilder::kEui64Length);
+    }
+
+    CheckSameData(counting, entries, kCount, 4);
+
+    // Removing the second half leaves the steering data of the first half.
+    for (size_t i = kCount / 2; i < kCount; i++)
+    {
+        CHECK(counting.Remove(entries + i * ot::SteeringDataBuilder::kEui64Length));
+    }
+
+    CheckSameData(counting, entries, kCount / 2, 4);
+
+    for (size_t i = 0; i < kCount / 2; i++)
+    {
+        CHECK(counting.Remove(entries + i * ot::SteeringDataBuilder::kEui64Length));
+    }
+
+    CHECK(counting.GetSteeringData().IsCleared());
+    CHECK(!counting.Remove(entries));
+    CHECK_EQUAL(0, counting.GetCount());
+}
+
+TEST(CountingSteeringData, TestWriteTlv)
+{
+    uint8_t                  joinerId[ot::SteeringDataBuilder::kEui64Length];
+    uint8_t                  buffer[2 + ot::CountingSteeringData::kMaxLength];
+    ot::CountingSteeringData counting;
+    const ot::Tlv *          tlv = reinterpret_cast<const ot::Tlv *>(buffer);
+
+    FillJoinerIds(joinerId, 1);
+    counting.Init(8);
+    counting.Add(joinerId);
+
+    CHECK_EQUAL(0, counting.WriteTlv(buffer, 9));
+    CHECK_EQUAL(10, counting.WriteTlv(buffer, sizeof(buffer)));
+    CHECK_EQUAL(ot::Meshcop::kSteeringData, tlv->GetType());
+    CHECK_EQUAL(8, tlv->GetLength());
+    CHECK_EQUAL(0, memcmp(tlv->GetValue(), counting.GetSteeringData().GetDataPointer(), 8));
+}
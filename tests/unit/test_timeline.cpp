@@ -0,0 +1,139 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string>
+#include <string.h>
+#include <unistd.h>
+
+#include "common/timeline.hpp"
+
+using namespace ot::BorderRouter;
+
+static size_t CountOf(const std::string &aText, const char *aPattern)
+{
+    size_t count = 0;
+
+    for (size_t i = aText.find(aPattern); i != std::string::npos; i = aText.find(aPattern, i + 1))
+    {
+        ++count;
+    }
+
+    return count;
+}
+
+static void *RecordSpan(void *aContext)
+{
+    Timeline::Span span(static_cast<const char *>(aContext));
+
+    return NULL;
+}
+
+TEST_GROUP(Timeline){};
+
+TEST(Timeline, TestExport)
+{
+    std::string output;
+    char        pid[32];
+
+    // Nothing is recorded until started.
+    Timeline::Stop();
+    Timeline::Begin("test.stopped");
+    Timeline::End("test.stopped");
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, Timeline::Start(16));
+
+    {
+        Timeline::Span span("test.outer");
+
+        Timeline::Begin("test.\"quoted\"");
+        Timeline::End("test.\"quoted\"");
+    }
+
+    Timeline::Complete("test.complete", 1000, 250);
+    CHECK_EQUAL(5, Timeline::Export(output));
+    Timeline::Stop();
+
+    snprintf(pid, sizeof(pid), "\"pid\":%ld", static_cast<long>(getpid()));
+    CHECK(output.compare(0, 39, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+    CHECK(output.find("test.stopped") == std::string::npos);
+    CHECK_EQUAL(2, CountOf(output, "\"name\":\"test.outer\""));
+    CHECK_EQUAL(2, CountOf(output, "\"name\":\"test.\\\"quoted\\\"\""));
+    CHECK_EQUAL(3, CountOf(output, "\"ph\":\"B\"") + CountOf(output, "\"ph\":\"X\""));
+    CHECK(output.find("\"name\":\"test.complete\",\"cat\":\"otbr\",\"ph\":\"X\",\"ts\":1000") != std::string::npos);
+    CHECK(output.find("\"dur\":250}") != std::string::npos);
+    CHECK_EQUAL(5, CountOf(output, pid));
+    STRCMP_EQUAL("\n]}\n", output.substr(output.size() - 4).c_str());
+}
+
+TEST(Timeline, TestRing)
+{
+    std::string output;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, Timeline::Start(16));
+
+    for (int i = 0; i < 100; ++i)
+    {
+        Timeline::Complete("test.ring", static_cast<uint64_t>(i), 1);
+    }
+
+    // Only the newest events are kept, oldest first.
+    CHECK_EQUAL(16, Timeline::Export(output));
+    CHECK(output.find("\"ts\":83,") == std::string::npos);
+    CHECK(output.find("\"ts\":84,") < output.find("\"ts\":99,"));
+
+    // Starting again drops the events recorded.
+    output.clear();
+    CHECK_EQUAL(OTBR_ERROR_NONE, Timeline::Start(16));
+    CHECK_EQUAL(0, Timeline::Export(output));
+    Timeline::Stop();
+}
+
+TEST(Timeline, TestThreads)
+{
+    static const char kName[] = "test.thread";
+    std::string       output;
+    pthread_t         thread;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, Timeline::Start(16));
+    Timeline::Begin("test.main");
+    CHECK_EQUAL(0, pthread_create(&thread, NULL, RecordSpan, const_cast<char *>(kName)));
+    CHECK_EQUAL(0, pthread_join(thread, NULL));
+    Timeline::End("test.main");
+
+    // Each thread records to a ring of its own.
+    CHECK_EQUAL(4, Timeline::Export(output));
+    Timeline::Stop();
+
+    CHECK_EQUAL(2, CountOf(output, "\"name\":\"test.thread\""));
+    CHECK_EQUAL(2, CountOf(output, "\"name\":\"test.main\""));
+    STRCMP_EQUAL("application/json", Timeline::kExportContentType);
+}
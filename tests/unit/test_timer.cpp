@@ -0,0 +1,258 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <pthread.h>
+#include <string.h>
+
+#include "common/timer.hpp"
+
+using namespace ot::BorderRouter;
+
+struct TimerContext
+{
+    TimerWheel *mWheel;
+    Timer *     mOther;
+    uint64_t    mNow;
+    uint64_t    mFired;
+    int         mCounter;
+};
+
+static void HandleTimer(void *aContext)
+{
+    TimerContext &context = *static_cast<TimerContext *>(aContext);
+
+    context.mCounter++;
+    context.mFired = context.mNow;
+
+    if (context.mOther != NULL)
+    {
+        context.mWheel->Stop(*context.mOther);
+    }
+}
+
+TEST_GROUP(TimerWheel){};
+
+TEST(TimerWheel, TestFireOnTime)
+{
+    static const uint64_t kDelays[] = {0, 1, 63, 64, 65, 1000, 4095, 4096, 300000, 20000000};
+    const uint64_t        kStart    = 123456;
+    TimerWheel            wheel(kStart);
+    TimerContext          contexts[sizeof(kDelays) / sizeof(kDelays[0])];
+    Timer *               timers[sizeof(kDelays) / sizeof(kDelays[0])];
+    uint64_t              next;
+
+    CHECK(!wheel.GetNextTime(next));
+
+    for (size_t i = 0; i < sizeof(kDelays) / sizeof(kDelays[0]); ++i)
+    {
+        TimerContext context = {&wheel, NULL, 0, 0, 0};
+
+        contexts[i] = context;
+        timers[i]   = new Timer(HandleTimer, &contexts[i]);
+        wheel.StartAt(*timers[i], kStart + kDelays[i]);
+    }
+
+    // Process with coarse steps, each timer must fire in the first step after its fire time.
+    for (uint64_t now = kStart; now < kStart + 20000000 + 7; now += 7)
+    {
+        for (size_t i = 0; i < sizeof(kDelays) / sizeof(kDelays[0]); ++i)
+        {
+            contexts[i].mNow = now;
+        }
+
+        CHECK(wheel.GetNextTime(next));
+        CHECK(next >= now - 7);
+        wheel.Process(now);
+    }
+
+    for (size_t i = 0; i < sizeof(kDelays) / sizeof(kDelays[0]); ++i)
+    {
+        CHECK_EQUAL(1, contexts[i].mCounter);
+        CHECK(contexts[i].mFired >= kStart + kDelays[i]);
+        CHECK(contexts[i].mFired < kStart + kDelays[i] + 7);
+        CHECK(!timers[i]->IsRunning());
+        delete timers[i];
+    }
+
+    CHECK(!wheel.GetNextTime(next));
+}
+
+TEST(TimerWheel, TestNextTime)
+{
+    TimerWheel   wheel(0);
+    TimerContext context = {&wheel, NULL, 0, 0, 0};
+    Timer        timer1(HandleTimer, &context);
+    Timer        timer2(HandleTimer, &context);
+    uint64_t     next;
+
+    wheel.StartAt(timer1, 10);
+    CHECK(wheel.GetNextTime(next));
+    CHECK_EQUAL(10, next);
+
+    // A farther timer never makes the wheel to be processed later.
+    wheel.StartAt(timer2, 5000);
+    CHECK(wheel.GetNextTime(next));
+    CHECK_EQUAL(10, next);
+
+    wheel.Stop(timer1);
+    CHECK(!timer1.IsRunning());
+    CHECK(wheel.GetNextTime(next));
+    CHECK(next <= 5000);
+
+    wheel.Process(4999);
+    CHECK_EQUAL(0, context.mCounter);
+    CHECK(wheel.GetNextTime(next));
+    CHECK_EQUAL(5000, next);
+
+    wheel.Process(5000);
+    CHECK_EQUAL(1, context.mCounter);
+    CHECK(!wheel.GetNextTime(next));
+}
+
+TEST(TimerWheel, TestStopInHandler)
+{
+    TimerWheel   wheel(0);
+    TimerContext context1 = {&wheel, NULL, 0, 0, 0};
+    TimerContext context2 = {&wheel, NULL, 0, 0, 0};
+    Timer        timer1(HandleTimer, &context1);
+    Timer        timer2(HandleTimer, &context2);
+
+    context1.mOther = &timer2;
+    context2.mOther = &timer1;
+
+    // Both timers expire at the same time, the first fired stops the other.
+    wheel.StartAt(timer1, 100);
+    wheel.StartAt(timer2, 100);
+    wheel.Process(200);
+
+    CHECK_EQUAL(1, context1.mCounter + context2.mCounter);
+    CHECK(!timer1.IsRunning());
+    CHECK(!timer2.IsRunning());
+
+    // Restarting a running timer only fires it once.
+    context1.mOther = NULL;
+    wheel.StartAt(timer1, 300);
+    wheel.StartAt(timer1, 250);
+    wheel.Process(1000);
+    CHECK_EQUAL(2, context1.mCounter + context2.mCounter);
+}
+
+static void *ReadLoopClock(void *aContext)
+{
+    *static_cast<uint64_t *>(aContext) = LoopClock::GetNowUs();
+
+    return NULL;
+}
+
+TEST_GROUP(LoopClock){};
+
+TEST(LoopClock, TestIteration)
+{
+    uint64_t  start = GetMonotonicNowUs();
+    uint64_t  other = 0;
+    pthread_t thread;
+
+    // The iteration reads the time it started at.
+    LoopClock::Start(1000);
+    CHECK_EQUAL(1000, LoopClock::GetNowUs());
+    CHECK_EQUAL(1, LoopClock::GetNow());
+
+    // Other threads still read the current time.
+    CHECK_EQUAL(0, pthread_create(&thread, NULL, ReadLoopClock, &other));
+    CHECK_EQUAL(0, pthread_join(thread, NULL));
+    CHECK(other >= start);
+
+    // Timers are started relative to the iteration.
+    {
+        TimerWheel   wheel(0);
+        TimerContext context;
+        Timer        timer(HandleTimer, &context);
+        uint64_t     next = 0;
+
+        memset(&context, 0, sizeof(context));
+        wheel.Start(timer, 10);
+        CHECK(wheel.GetNextTime(next));
+        CHECK_EQUAL(11, next);
+    }
+
+    LoopClock::Stop();
+    CHECK(LoopClock::GetNowUs() >= start);
+}
+
+TEST_GROUP(VirtualClock)
+{
+    void setup(void) { VirtualClock::Set(5000000); }
+    void teardown(void) { VirtualClock::Clear(); }
+};
+
+TEST(VirtualClock, TestAdvance)
+{
+    uint64_t  other = 0;
+    pthread_t thread;
+
+    CHECK_EQUAL(5000000, GetMonotonicNowUs());
+    CHECK_EQUAL(5000, GetMonotonicNow());
+    CHECK_EQUAL(5000, LoopClock::GetNow());
+
+    // Every thread reads the virtual clock.
+    CHECK_EQUAL(0, pthread_create(&thread, NULL, ReadLoopClock, &other));
+    CHECK_EQUAL(0, pthread_join(thread, NULL));
+    CHECK_EQUAL(5000000, other);
+
+    // Timers expire as soon as the clock is advanced past them.
+    {
+        TimerWheel   wheel;
+        TimerContext context;
+        Timer        timer(HandleTimer, &context);
+
+        memset(&context, 0, sizeof(context));
+        wheel.Start(timer, 30000);
+        VirtualClock::Advance(29999000);
+        wheel.Process();
+        CHECK_EQUAL(0, context.mCounter);
+        VirtualClock::Advance(1000);
+        wheel.Process();
+        CHECK_EQUAL(1, context.mCounter);
+    }
+
+    VirtualClock::Clear();
+    CHECK_EQUAL(0, VirtualClock::GetNowUs());
+}
+
+TEST(VirtualClock, TestLoopClock)
+{
+    // The virtual clock is read even during an iteration.
+    LoopClock::Start(1000);
+    CHECK_EQUAL(5000000, LoopClock::GetNowUs());
+    CHECK_EQUAL(5000, LoopClock::GetNow());
+    VirtualClock::Clear();
+    CHECK_EQUAL(1000, LoopClock::GetNowUs());
+    LoopClock::Stop();
+}
@@ -0,0 +1,179 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include "common/tlv.hpp"
+
+using ot::Tlv;
+using ot::TlvReader;
+using ot::TlvWriter;
+
+TEST_GROUP(Tlv){};
+
+TEST(Tlv, TestWriteRead)
+{
+    uint8_t       buffer[512];
+    uint8_t       value[300];
+    TlvWriter     writer(buffer, sizeof(buffer));
+    const uint8_t kTypes[] = {ot::Meshcop::kJoinerRouterLocator, ot::Meshcop::kState, ot::Meshcop::kSteeringData};
+    const Tlv *   tlvs[sizeof(kTypes)];
+
+    for (size_t i = 0; i < sizeof(value); i++)
+    {
+        value[i] = static_cast<uint8_t>(i);
+    }
+
+    CHECK(writer.AppendUInt8(ot::Meshcop::kState, 1));
+    CHECK(writer.AppendUInt16(ot::Meshcop::kJoinerRouterLocator, 0x1234));
+    // An extended-length TLV.
+    CHECK(writer.Append(ot::Meshcop::kJoinerDtlsEncapsulation, value, sizeof(value)));
+    CHECK(writer.AppendUInt8(ot::Meshcop::kState, 2));
+    LONGS_EQUAL(3 + 4 + 304 + 3, writer.GetLength());
+
+    {
+        TlvReader  reader(buffer, writer.GetLength());
+        const Tlv *tlv = reader.Find(ot::Meshcop::kJoinerDtlsEncapsulation);
+
+        CHECK(tlv != NULL);
+        LONGS_EQUAL(sizeof(value), tlv->GetLength());
+        MEMCMP_EQUAL(value, tlv->GetValue(), sizeof(value));
+
+        tlv = reader.GetNext();
+        CHECK(tlv != NULL);
+        LONGS_EQUAL(2, tlv->GetValueUInt8());
+        CHECK(reader.GetNext() == NULL);
+        CHECK(!reader.IsMalformed());
+    }
+
+    {
+        TlvReader reader(buffer, writer.GetLength());
+
+        CHECK(reader.Index(kTypes, tlvs, sizeof(kTypes)));
+        LONGS_EQUAL(0x1234, tlvs[0]->GetValueUInt16());
+        // The first TLV of a type is indexed.
+        LONGS_EQUAL(1, tlvs[1]->GetValueUInt8());
+        CHECK(tlvs[2] == NULL);
+    }
+}
+
+TEST(Tlv, TestWriterFull)
+{
+    uint8_t   buffer[8];
+    uint8_t   value[8] = {0};
+    TlvWriter writer(buffer, sizeof(buffer));
+
+    CHECK(writer.AppendUInt16(ot::Meshcop::kJoinerUdpPort, 1000));
+    CHECK(!writer.Append(ot::Meshcop::kJoinerIid, value, sizeof(value)));
+    LONGS_EQUAL(4, writer.GetLength());
+    CHECK(writer.AppendUInt16(ot::Meshcop::kJoinerUdpPort, 1001));
+    CHECK(!writer.AppendUInt8(ot::Meshcop::kState, 1));
+    LONGS_EQUAL(8, writer.GetLength());
+}
+
+TEST(Tlv, TestTruncated)
+{
+    // A state TLV, then a TLV claiming more bytes than the payload has.
+    const uint8_t kPayload[] = {ot::Meshcop::kState, 1, 1, ot::Meshcop::kJoinerRouterLocator, 4, 0x12, 0x34};
+    // An extended length cut in the middle.
+    const uint8_t kExtended[] = {ot::Meshcop::kJoinerDtlsEncapsulation, 0xff, 0x01};
+
+    {
+        TlvReader reader(kPayload, sizeof(kPayload));
+
+        CHECK(reader.GetNext() != NULL);
+        CHECK(reader.GetNext() == NULL);
+        CHECK(reader.IsMalformed());
+        CHECK(reader.GetNext() == NULL);
+    }
+
+    {
+        TlvReader reader(kPayload, sizeof(kPayload));
+
+        CHECK(reader.Find(ot::Meshcop::kJoinerRouterLocator) == NULL);
+        CHECK(reader.IsMalformed());
+    }
+
+    {
+        TlvReader  reader(kPayload, sizeof(kPayload));
+        const Tlv *tlvs[1];
+
+        CHECK(!reader.Index(kPayload, tlvs, 1));
+        CHECK(tlvs[0] != NULL);
+    }
+
+    {
+        TlvReader reader(kExtended, sizeof(kExtended));
+
+        CHECK(reader.GetNext() == NULL);
+        CHECK(reader.IsMalformed());
+    }
+
+    {
+        // A lone type byte.
+        TlvReader reader(kPayload, 1);
+
+        CHECK(reader.GetNext() == NULL);
+        CHECK(reader.IsMalformed());
+    }
+}
+
+TEST(Tlv, TestIndex)
+{
+    uint8_t       buffer[64];
+    TlvWriter     writer(buffer, sizeof(buffer));
+    ot::TlvIndex  index;
+    uint16_t      offset;
+    const uint8_t kIid[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    CHECK(index.Get(ot::Meshcop::kState) == NULL);
+
+    CHECK(writer.AppendUInt16(ot::Meshcop::kJoinerUdpPort, 1000));
+    CHECK(writer.Append(ot::Meshcop::kJoinerIid, kIid, sizeof(kIid)));
+    CHECK(writer.AppendUInt16(ot::Meshcop::kJoinerRouterLocator, 0x0400));
+    CHECK(writer.AppendUInt16(ot::Meshcop::kJoinerUdpPort, 1001));
+    CHECK(writer.AppendUInt16(ot::Meshcop::kCommissionerSessionId, 0x1234));
+
+    CHECK(index.Build(buffer, writer.GetLength()));
+    LONGS_EQUAL(1000, index.Get(ot::Meshcop::kJoinerUdpPort)->GetValueUInt16());
+    MEMCMP_EQUAL(kIid, index.Get(ot::Meshcop::kJoinerIid)->GetValue(), sizeof(kIid));
+    LONGS_EQUAL(0x0400, index.Get(ot::Meshcop::kJoinerRouterLocator)->GetValueUInt16());
+    CHECK(index.Get(ot::Meshcop::kState) == NULL);
+
+    // The offsets rewrite a field in place.
+    CHECK(index.GetOffset(ot::Meshcop::kCommissionerSessionId, offset));
+    LONGS_EQUAL(writer.GetLength() - 4, offset);
+    buffer[offset + 2] = 0x56;
+    LONGS_EQUAL(0x5634, index.Get(ot::Meshcop::kCommissionerSessionId)->GetValueUInt16());
+    CHECK(!index.GetOffset(ot::Meshcop::kState, offset));
+
+    // Building again drops the TLVs indexed before, and keeps those before a truncated TLV.
+    CHECK(!index.Build(buffer, writer.GetLength() - 1));
+    CHECK(index.Get(ot::Meshcop::kCommissionerSessionId) == NULL);
+    CHECK(index.Get(ot::Meshcop::kJoinerRouterLocator) != NULL);
+}
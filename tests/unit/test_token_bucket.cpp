@@ -0,0 +1,96 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include "common/token_bucket.hpp"
+
+using namespace ot::BorderRouter;
+
+TEST_GROUP(TokenBucket){};
+
+TEST(TokenBucket, TestUnlimited)
+{
+    TokenBucket bucket;
+
+    CHECK(!bucket.IsLimited());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        CHECK(bucket.Consume(0));
+    }
+
+    bucket.Init(0, 10, 0);
+    CHECK(!bucket.IsLimited());
+    CHECK(bucket.Consume(0));
+}
+
+TEST(TokenBucket, TestBurst)
+{
+    const uint64_t kStart = 123456;
+    TokenBucket    bucket;
+
+    bucket.Init(10, 3, kStart);
+    CHECK(bucket.IsLimited());
+
+    CHECK(bucket.Consume(kStart));
+    CHECK(bucket.Consume(kStart));
+    CHECK(bucket.Consume(kStart));
+    CHECK(!bucket.Consume(kStart));
+
+    // One token every 100 milliseconds.
+    CHECK(!bucket.Consume(kStart + 99));
+    CHECK(bucket.Consume(kStart + 100));
+    CHECK(!bucket.Consume(kStart + 100));
+
+    // An idle bucket fills up to the burst only.
+    CHECK(bucket.Consume(kStart + 100000));
+    CHECK(bucket.Consume(kStart + 100000));
+    CHECK(bucket.Consume(kStart + 100000));
+    CHECK(!bucket.Consume(kStart + 100000));
+}
+
+TEST(TokenBucket, TestRate)
+{
+    TokenBucket bucket;
+    int         consumed = 0;
+
+    // Burst defaults to the rate.
+    bucket.Init(3, 0, 0);
+
+    for (uint64_t now = 0; now < 10000; ++now)
+    {
+        while (bucket.Consume(now))
+        {
+            ++consumed;
+        }
+    }
+
+    // The initial burst plus 3 tokens every second, without drift from the fractional refill.
+    CHECK_EQUAL(3 + 29, consumed);
+}
@@ -0,0 +1,142 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <CppUTest/TestHarness.h>
+
+#include "agent/warm_state.hpp"
+
+using ot::BorderRouter::WarmState;
+
+static const char    kStateFile[] = "/tmp/otbr-test-warm.state";
+static const uint8_t kExtPanId[]  = {0xde, 0xad, 0x00, 0xbe, 0xef, 0x00, 0xca, 0xfe};
+static const uint8_t kPSKc[]      = {0xc2, 0x3a, 0x76, 0xe9, 0x8f, 0x1a, 0x64, 0x83,
+                                     0x63, 0x9b, 0x1a, 0xc1, 0x27, 0x1e, 0x2e, 0x27};
+
+TEST_GROUP(WarmState)
+{
+    void setup(void) { unlink(kStateFile); }
+    void teardown(void) { unlink(kStateFile); }
+};
+
+TEST(WarmState, TestRestore)
+{
+    WarmState   state;
+    struct stat st;
+
+    LONGS_EQUAL(OTBR_ERROR_NONE, state.Open(kStateFile, "wpan0"));
+    POINTERS_EQUAL(NULL, state.GetRestored());
+    LONGS_EQUAL(0, stat(kStateFile, &st));
+    LONGS_EQUAL(S_IRUSR | S_IWUSR, st.st_mode & 0777);
+
+    state.SetNetworkName("OpenThread");
+    state.SetExtPanId(kExtPanId);
+    state.SetPSKc(kPSKc);
+    state.SetThreadState(true, 3);
+    state.SetNameConflicts(1);
+    state.Close();
+
+    {
+        WarmState                  restarted;
+        const WarmState::Snapshot *snapshot;
+
+        LONGS_EQUAL(OTBR_ERROR_NONE, restarted.Open(kStateFile, "wpan0"));
+        snapshot = restarted.GetRestored();
+        CHECK(snapshot != NULL);
+        STRCMP_EQUAL("OpenThread", snapshot->mNetworkName);
+        CHECK(snapshot->mHasExtPanId);
+        MEMCMP_EQUAL(kExtPanId, snapshot->mExtPanId, sizeof(kExtPanId));
+        CHECK(snapshot->mHasPSKc);
+        MEMCMP_EQUAL(kPSKc, snapshot->mPSKc, sizeof(kPSKc));
+        CHECK(!snapshot->mHasEui64);
+        CHECK(snapshot->mThreadStarted);
+        LONGS_EQUAL(3, snapshot->mThreadRole);
+        LONGS_EQUAL(1, snapshot->mNameConflicts);
+
+        // Changes after the restart are kept along with the restored state.
+        restarted.SetThreadState(false, 0);
+    }
+
+    {
+        WarmState restarted;
+
+        LONGS_EQUAL(OTBR_ERROR_NONE, restarted.Open(kStateFile, "wpan0"));
+        CHECK(restarted.GetRestored() != NULL);
+        STRCMP_EQUAL("OpenThread", restarted.GetRestored()->mNetworkName);
+        CHECK(!restarted.GetRestored()->mThreadStarted);
+    }
+}
+
+TEST(WarmState, TestOtherInterface)
+{
+    WarmState state;
+
+    LONGS_EQUAL(OTBR_ERROR_NONE, state.Open(kStateFile, "wpan0"));
+    state.SetNetworkName("OpenThread");
+    state.Close();
+
+    LONGS_EQUAL(OTBR_ERROR_NONE, state.Open(kStateFile, "wpan1"));
+    POINTERS_EQUAL(NULL, state.GetRestored());
+    state.Close();
+
+    // The snapshot of the other interface was dropped.
+    LONGS_EQUAL(OTBR_ERROR_NONE, state.Open(kStateFile, "wpan0"));
+    POINTERS_EQUAL(NULL, state.GetRestored());
+}
+
+TEST(WarmState, TestCorrupted)
+{
+    WarmState state;
+    uint8_t   byte;
+    int       fd;
+
+    LONGS_EQUAL(OTBR_ERROR_NONE, state.Open(kStateFile, "wpan0"));
+    state.SetNetworkName("OpenThread");
+    state.Close();
+
+    // A byte of the snapshot changed fails the checksum.
+    fd = open(kStateFile, O_RDWR);
+    CHECK(fd >= 0);
+    LONGS_EQUAL(1, pread(fd, &byte, 1, 100));
+    byte ^= 0x01;
+    LONGS_EQUAL(1, pwrite(fd, &byte, 1, 100));
+    close(fd);
+
+    LONGS_EQUAL(OTBR_ERROR_NONE, state.Open(kStateFile, "wpan0"));
+    POINTERS_EQUAL(NULL, state.GetRestored());
+    state.Close();
+
+    // A truncated file is reset.
+    LONGS_EQUAL(0, truncate(kStateFile, 10));
+    LONGS_EQUAL(OTBR_ERROR_NONE, state.Open(kStateFile, "wpan0"));
+    POINTERS_EQUAL(NULL, state.GetRestored());
+}
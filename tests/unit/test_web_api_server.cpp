@@ -0,0 +1,162 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "agent/web_api_server.hpp"
+#include "common/reactor.hpp"
+
+using namespace ot::BorderRouter;
+
+static otbrError HandleEcho(void *aContext, const char *aQuery, std::string &aOutput)
+{
+    std::string value;
+
+    ++*static_cast<int *>(aContext);
+
+    if (!WebApiServer::GetParameter(aQuery, "name", value))
+    {
+        aOutput += "{\"error\":1}";
+        return OTBR_ERROR_ERRNO;
+    }
+
+    aOutput += "{\"name\":";
+    WebApiServer::AppendString(aOutput, value.c_str());
+    aOutput += "}";
+
+    return OTBR_ERROR_NONE;
+}
+
+static void PollReactor(Reactor &aReactor)
+{
+    fd_set  readFdSet;
+    fd_set  writeFdSet;
+    fd_set  errorFdSet;
+    timeval timeout = {0, 10000};
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+    aReactor.Poll(readFdSet, writeFdSet, errorFdSet, -1, timeout);
+}
+
+// Sends @p aRequest and polls the reactor until the server closes the connection.
+static std::string Request(Reactor &aReactor, uint16_t aPort, const char *aRequest)
+{
+    int         fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in sin;
+    std::string received;
+    char        buffer[256];
+    bool        closed = false;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family      = AF_INET;
+    sin.sin_port        = htons(aPort);
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK_EQUAL(0, connect(fd, reinterpret_cast<sockaddr *>(&sin), sizeof(sin)));
+    CHECK_EQUAL(static_cast<ssize_t>(strlen(aRequest)), send(fd, aRequest, strlen(aRequest), 0));
+
+    for (int i = 0; i < 20 && !closed; ++i)
+    {
+        ssize_t rval;
+
+        PollReactor(aReactor);
+
+        while ((rval = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0)
+        {
+            received.append(buffer, static_cast<size_t>(rval));
+        }
+
+        closed = (rval == 0);
+    }
+
+    close(fd);
+    CHECK(closed);
+
+    return received;
+}
+
+TEST_GROUP(WebApiServer){};
+
+TEST(WebApiServer, TestRoutes)
+{
+    Reactor      reactor;
+    WebApiServer server(reactor);
+    uint16_t     port  = static_cast<uint16_t>(20000 + getpid() % 10000);
+    int          calls = 0;
+    std::string  response;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, reactor.Init());
+    CHECK_EQUAL(OTBR_ERROR_NONE, server.AddRoute("/echo", HandleEcho, &calls));
+    CHECK_EQUAL(OTBR_ERROR_NONE, server.Start(port));
+
+    response = Request(reactor, port, "GET /echo?x=1&name=a\"b HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    CHECK_EQUAL(0, response.compare(0, 15, "HTTP/1.1 200 OK"));
+    CHECK(response.find("Content-Type: application/json\r\n") != std::string::npos);
+    CHECK(response.find("\r\n\r\n{\"name\":\"a\\\"b\"}") != std::string::npos);
+    CHECK_EQUAL(1, calls);
+
+    // A failing handler still answers its document.
+    response = Request(reactor, port, "GET /echo HTTP/1.1\r\n\r\n");
+    CHECK_EQUAL(0, response.compare(0, 34, "HTTP/1.1 500 Internal Server Error"));
+    CHECK(response.find("\r\n\r\n{\"error\":1}") != std::string::npos);
+    CHECK_EQUAL(2, calls);
+
+    response = Request(reactor, port, "GET /echoes?name=a HTTP/1.1\r\n\r\n");
+    CHECK_EQUAL(0, response.compare(0, 22, "HTTP/1.1 404 Not Found"));
+
+    response = Request(reactor, port, "POST /echo?name=a HTTP/1.1\r\n\r\n");
+    CHECK_EQUAL(0, response.compare(0, 31, "HTTP/1.1 405 Method Not Allowed"));
+    CHECK_EQUAL(2, calls);
+
+    server.Stop();
+}
+
+TEST(WebApiServer, TestJson)
+{
+    std::string output;
+    std::string value;
+
+    WebApiServer::AppendString(output, "a\"b\\c\n");
+    STRCMP_EQUAL("\"a\\\"b\\\\c\\u000a\"", output.c_str());
+
+    CHECK(WebApiServer::GetParameter("interface=wpan1&x=", "interface", value));
+    STRCMP_EQUAL("wpan1", value.c_str());
+    CHECK(WebApiServer::GetParameter("interface=wpan1&x=", "x", value));
+    STRCMP_EQUAL("", value.c_str());
+    CHECK_FALSE(WebApiServer::GetParameter("interfaces=wpan1", "interface", value));
+    CHECK_FALSE(WebApiServer::GetParameter("", "interface", value));
+}
@@ -0,0 +1,130 @@
+/*
+ *    Copyright (c) 2017, The OpenThread Authors.
+ *    All rights reserved.
+ *
+ *    Redistribution and use in source and binary forms, with or without
+ *    modification, are permitted provided that the following conditions are met:
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *    3. Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *    POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <sys/select.h>
+
+#include "common/worker_pool.hpp"
+
+using namespace ot::BorderRouter;
+
+struct WorkerContext
+{
+    pthread_t mMainThread;
+    bool      mOffloaded;
+    int       mCompleted;
+};
+
+static void HandleWork(void *aContext)
+{
+    WorkerContext &context = *static_cast<WorkerContext *>(aContext);
+
+    context.mOffloaded = !pthread_equal(context.mMainThread, pthread_self());
+}
+
+static void HandleDone(void *aContext)
+{
+    WorkerContext &context = *static_cast<WorkerContext *>(aContext);
+
+    CHECK(pthread_equal(context.mMainThread, pthread_self()));
+    context.mCompleted++;
+}
+
+TEST_GROUP(WorkerPool){};
+
+TEST(WorkerPool, TestRunJobs)
+{
+    WorkerPool       pool;
+    const int        kCount = 8;
+    WorkerContext    contexts[kCount];
+    WorkerPool::Job *jobs[kCount];
+    int              completed = 0;
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, pool.Start(2));
+
+    for (int i = 0; i < kCount; ++i)
+    {
+        contexts[i].mMainThread = pthread_self();
+        contexts[i].mOffloaded  = false;
+        contexts[i].mCompleted  = 0;
+        jobs[i]                 = new WorkerPool::Job(HandleWork, HandleDone, &contexts[i]);
+        CHECK_EQUAL(OTBR_ERROR_NONE, pool.Submit(*jobs[i]));
+        CHECK(jobs[i]->IsPending());
+    }
+
+    // Pending jobs cannot be submitted again.
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, pool.Submit(*jobs[0]));
+
+    while (completed < kCount)
+    {
+        fd_set  readFdSet;
+        timeval timeout = {1, 0};
+
+        FD_ZERO(&readFdSet);
+        FD_SET(pool.GetFd(), &readFdSet);
+        CHECK_EQUAL(1, select(pool.GetFd() + 1, &readFdSet, NULL, NULL, &timeout));
+
+        pool.Process();
+
+        completed = 0;
+        for (int i = 0; i < kCount; ++i)
+        {
+            completed += contexts[i].mCompleted;
+        }
+    }
+
+    for (int i = 0; i < kCount; ++i)
+    {
+        CHECK(contexts[i].mOffloaded);
+        CHECK_EQUAL(1, contexts[i].mCompleted);
+        CHECK(!jobs[i]->IsPending());
+        delete jobs[i];
+    }
+
+    pool.Stop();
+    CHECK(!pool.IsRunning());
+}
+
+TEST(WorkerPool, TestStopCompletesJobs)
+{
+    WorkerPool      pool;
+    WorkerContext   context = {pthread_self(), false, 0};
+    WorkerPool::Job job(HandleWork, HandleDone, &context);
+
+    // Not running.
+    CHECK_EQUAL(OTBR_ERROR_ERRNO, pool.Submit(job));
+
+    CHECK_EQUAL(OTBR_ERROR_NONE, pool.Start(1));
+    CHECK_EQUAL(OTBR_ERROR_NONE, pool.Submit(job));
+
+    pool.Stop();
+    CHECK(context.mOffloaded);
+    CHECK_EQUAL(1, context.mCompleted);
+    CHECK(!job.IsPending());
+}
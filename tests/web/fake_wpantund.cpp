@@ -0,0 +1,370 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements a fake wpantund, linked in place of the D-Bus controller and property watch of otbr-web.
+ */
+
+#include "fake_wpantund.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "wpan-controller/dbus_get.hpp"
+#include "wpan-controller/dbus_prop_watch.hpp"
+#include "wpan-controller/wpan_controller.hpp"
+
+namespace ot {
+
+namespace Web {
+
+namespace Bench {
+
+enum
+{
+    kFakeNetworkCount = 8, ///< Number of networks each scan finds.
+};
+
+struct FakeProperty
+{
+    const char *mName;
+    const char *mValue;
+};
+
+static const FakeProperty kFakeProperties[] = {
+    {kWPANTUNDProperty_NCPState, "associated"},
+    {kWPANTUNDProperty_DaemonEnabled, "true"},
+    {kWPANTUNDProperty_NCPVersion, "OPENTHREAD/20180926-00632-g2d4d1ec3-dirty; NRF52840; Dec 12 2018"},
+    {kWPANTUNDProperty_DaemonVersion, "0.08.00d (0.07.01-343-g7ee8799; Dec 12 2018 02:37:27)"},
+    {kWPANTUNDProperty_ConfigNCPDriverName, "spinel"},
+    {kWPANTUNDProperty_NCPHardwareAddress, "[F6D1A90A4F54C5A4]"},
+    {kWPANTUNDProperty_NCPChannel, "15"},
+    {kWPANTUNDProperty_NetworkNodeType, "leader"},
+    {kWPANTUNDProperty_NetworkName, "\"OpenThreadBench\""},
+    {kWPANTUNDProperty_NetworkXPANID, "0xDEAD00BEEF00CAFE"},
+    {kWPANTUNDProperty_NetworkPANID, "0x1234"},
+    {kWPANTUNDProperty_IPv6LinkLocalAddress, "fe80::f4d1:a90a:4f54:c5a4"},
+    {kWPANTUNDProperty_IPv6MeshLocalAddress, "fd11:22::4a1b:1d9b:e7a3:5c4e"},
+    {kWPANTUNDProperty_IPv6MeshLocalPrefix, "fd11:22::/64"},
+};
+
+static uint32_t sGetLatency    = 0;
+static uint32_t sScanLatency   = 0;
+static bool     sPropertyWatch = false;
+static uint64_t sRequestCount  = 0;
+
+void SetFakeLatency(uint32_t aGetLatency, uint32_t aScanLatency)
+{
+    sGetLatency  = aGetLatency;
+    sScanLatency = aScanLatency;
+}
+
+void SetFakePropertyWatch(bool aEnabled)
+{
+    sPropertyWatch = aEnabled;
+}
+
+uint64_t GetFakeRequestCount(void)
+{
+    return __atomic_load_n(&sRequestCount, __ATOMIC_RELAXED);
+}
+
+static void Reply(uint32_t aLatency)
+{
+    __atomic_fetch_add(&sRequestCount, 1, __ATOMIC_RELAXED);
+
+    if (aLatency > 0)
+    {
+        usleep(aLatency);
+    }
+}
+
+static const char *FindProperty(const char *aName)
+{
+    const char *value = "";
+
+    for (size_t i = 0; i < sizeof(kFakeProperties) / sizeof(kFakeProperties[0]); ++i)
+    {
+        if (strcmp(kFakeProperties[i].mName, aName) == 0)
+        {
+            value = kFakeProperties[i].mValue;
+            break;
+        }
+    }
+
+    return value;
+}
+
+} // namespace Bench
+
+} // namespace Web
+
+namespace Dbus {
+
+using Web::Bench::FindProperty;
+using Web::Bench::Reply;
+using Web::Bench::kFakeNetworkCount;
+using Web::Bench::sGetLatency;
+using Web::Bench::sScanLatency;
+
+WPANController::WPANController(void)
+    : mConnection(NULL)
+{
+    mIfName[0]   = '\0';
+    mDBusName[0] = '\0';
+}
+
+WPANController::~WPANController(void)
+{
+}
+
+int WPANController::Scan(ScanBeaconHandler aHandler, void *aContext)
+{
+    Reply(sScanLatency);
+
+    mScannedNetworkCount = kFakeNetworkCount;
+
+    for (int i = 0; i < mScannedNetworkCount; ++i)
+    {
+        WpanNetworkInfo &network = mScannedNetworks[i];
+
+        memset(&network, 0, sizeof(network));
+        snprintf(network.mNetworkName, sizeof(network.mNetworkName), "OpenThread-%02x", i);
+        network.mAllowingJoin = (i % 2 == 0);
+        network.mPanId        = static_cast<uint16_t>(0x1000 + i);
+        network.mChannel      = static_cast<uint16_t>(11 + i);
+        network.mExtPanId     = 0xdead00beef00ca00ULL + static_cast<uint64_t>(i);
+        network.mRssi         = static_cast<int8_t>(-40 - i);
+        memset(network.mHardwareAddress, 0x10 + i, sizeof(network.mHardwareAddress));
+
+        if (aHandler != NULL)
+        {
+            aHandler(network, aContext);
+        }
+    }
+
+    return kWpantundStatus_Ok;
+}
+
+const WpanNetworkInfo *WPANController::GetScanNetworksInfo(void) const
+{
+    return mScannedNetworks;
+}
+
+int WPANController::GetScanNetworksInfoCount(void) const
+{
+    return mScannedNetworkCount;
+}
+
+const char *WPANController::GetDBusInterfaceName(void) const
+{
+    return "com.nestlabs.WPANTunnelDriver";
+}
+
+int WPANController::Leave(void)
+{
+    Reply(sGetLatency);
+    return kWpantundStatus_Ok;
+}
+
+int WPANController::Form(const char *aNetworkName, uint16_t aChannel)
+{
+    (void)aNetworkName;
+    (void)aChannel;
+    Reply(sGetLatency);
+    return kWpantundStatus_Ok;
+}
+
+int WPANController::Join(const char *aNetworkName, uint16_t aChannel, uint64_t aExtPanId, uint16_t aPanId)
+{
+    (void)aNetworkName;
+    (void)aChannel;
+    (void)aExtPanId;
+    (void)aPanId;
+    Reply(sGetLatency);
+    return kWpantundStatus_Ok;
+}
+
+std::string WPANController::Get(const char *aPropertyName) const
+{
+    Reply(sGetLatency);
+    return FindProperty(aPropertyName);
+}
+
+int WPANController::Get(PropertyNameValue *aProperties, size_t aCount) const
+{
+    Reply(sGetLatency);
+
+    for (size_t i = 0; i < aCount; ++i)
+    {
+        strncpy(aProperties[i].value, FindProperty(aProperties[i].name), sizeof(aProperties[i].value));
+        aProperties[i].value[sizeof(aProperties[i].value) - 1] = '\0';
+    }
+
+    return kWpantundStatus_Ok;
+}
+
+int WPANController::Set(uint8_t aType, const char *aPropertyName, const char *aPropertyValue)
+{
+    (void)aType;
+    (void)aPropertyName;
+    (void)aPropertyValue;
+    Reply(sGetLatency);
+    return kWpantundStatus_Ok;
+}
+
+int WPANController::AddGateway(const char *aPrefix, bool aIsDefaultRoute)
+{
+    (void)aPrefix;
+    (void)aIsDefaultRoute;
+    Reply(sGetLatency);
+    return kWpantundStatus_Ok;
+}
+
+int WPANController::RemoveGateway(const char *aPrefix)
+{
+    (void)aPrefix;
+    Reply(sGetLatency);
+    return kWpantundStatus_Ok;
+}
+
+void WPANController::SetInterfaceName(const char *aIfName)
+{
+    snprintf(mIfName, sizeof(mIfName), "%s", aIfName);
+}
+
+// Steps of transactions are only counted, all of them succeed when committed.
+WPANController::Transaction::Transaction(WPANController &aController)
+    : mController(aController)
+    , mStepCount(0)
+    , mFailedStep(kMaxSteps)
+    , mError(kWpantundStatus_Ok)
+{
+}
+
+WPANController::Transaction::~Transaction(void)
+{
+}
+
+void WPANController::Transaction::Leave(void)
+{
+    mStepCount++;
+}
+
+void WPANController::Transaction::Form(const char *aNetworkName, uint16_t aChannel)
+{
+    (void)aNetworkName;
+    (void)aChannel;
+    mStepCount++;
+}
+
+void WPANController::Transaction::Join(const char *aNetworkName, uint16_t aChannel, uint64_t aExtPanId, uint16_t aPanId)
+{
+    (void)aNetworkName;
+    (void)aChannel;
+    (void)aExtPanId;
+    (void)aPanId;
+    mStepCount++;
+}
+
+void WPANController::Transaction::Set(uint8_t aType, const char *aPropertyName, const char *aPropertyValue)
+{
+    (void)aType;
+    (void)aPropertyName;
+    (void)aPropertyValue;
+    mStepCount++;
+}
+
+void WPANController::Transaction::AddGateway(const char *aPrefix, bool aIsDefaultRoute)
+{
+    (void)aPrefix;
+    (void)aIsDefaultRoute;
+    mStepCount++;
+}
+
+void WPANController::Transaction::RemoveGateway(const char *aPrefix)
+{
+    (void)aPrefix;
+    mStepCount++;
+}
+
+int WPANController::Transaction::Commit(void)
+{
+    for (size_t i = 0; i < mStepCount; ++i)
+    {
+        Reply(sGetLatency);
+    }
+
+    return kWpantundStatus_Ok;
+}
+
+int WPANController::Transaction::GetFailure(void) const
+{
+    return mError;
+}
+
+// The watch never receives changes, it only lets otbr-web serve the status from its snapshot.
+DBusPropWatch::DBusPropWatch(void)
+    : mConnection(NULL)
+    , mHandler(NULL)
+    , mContext(NULL)
+{
+    mPath[0] = '\0';
+}
+
+DBusPropWatch::~DBusPropWatch(void)
+{
+}
+
+int DBusPropWatch::Start(const char *aIfName, ChangeHandler aHandler, void *aContext)
+{
+    (void)aIfName;
+    mHandler = aHandler;
+    mContext = aContext;
+
+    return Web::Bench::sPropertyWatch ? kWpantundStatus_Ok : kWpantundStatus_InvalidConnection;
+}
+
+bool DBusPropWatch::Process(int aTimeout)
+{
+    usleep(static_cast<useconds_t>(aTimeout) * 1000);
+
+    return true;
+}
+
+void DBusPropWatch::Stop(void)
+{
+    mHandler = NULL;
+    mContext = NULL;
+}
+
+} // namespace Dbus
+
+} // namespace ot
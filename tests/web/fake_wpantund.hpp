@@ -0,0 +1,79 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for the fake wpantund backing otbr-web in benchmarks.
+ */
+
+#ifndef FAKE_WPANTUND_HPP_
+#define FAKE_WPANTUND_HPP_
+
+#include <stdint.h>
+
+namespace ot {
+
+namespace Web {
+
+namespace Bench {
+
+/**
+ * This function sets how long the fake wpantund takes to reply, to emulate the D-Bus round trips.
+ *
+ * @param[in]   aGetLatency     Time in microseconds each property get takes.
+ * @param[in]   aScanLatency    Time in microseconds each scan takes.
+ *
+ */
+void SetFakeLatency(uint32_t aGetLatency, uint32_t aScanLatency);
+
+/**
+ * This function sets whether the fake wpantund accepts watching its property changes.
+ *
+ * When accepted, otbr-web serves the status from its snapshot, otherwise every status request gets the properties.
+ * This function must be called before the web server starts.
+ *
+ * @param[in]   aEnabled    Whether the property changes can be watched.
+ *
+ */
+void SetFakePropertyWatch(bool aEnabled);
+
+/**
+ * This function returns the number of requests the fake wpantund has replied to.
+ *
+ * @returns The number of requests, a multi-property get counts once.
+ *
+ */
+uint64_t GetFakeRequestCount(void);
+
+} // namespace Bench
+
+} // namespace Web
+
+} // namespace ot
+
+#endif // FAKE_WPANTUND_HPP_
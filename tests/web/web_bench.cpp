@@ -0,0 +1,539 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements a load generator for otbr-web, which runs the web server against a fake wpantund.
+ *
+ * Each connection sends keep-alive requests one after the other, going through the enabled kinds of targets. Every
+ * report interval, a line with the requests per second, the latency percentiles over the interval, the resident set
+ * size of the process and the requests reaching the fake wpantund per second is printed, then a summary per kind.
+ * The process runs both the server and the clients, the resident set size includes the few pages of the clients.
+ */
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "fake_wpantund.hpp"
+#include "common/code_utils.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
+#include "web-service/web_server.hpp"
+
+using ot::BorderRouter::GetMonotonicNowUs;
+using ot::BorderRouter::Metrics::Histogram;
+
+enum
+{
+    kDefaultConnections = 8,     ///< Default number of concurrent connections.
+    kDefaultDuration    = 10,    ///< Default seconds the load runs.
+    kDefaultInterval    = 1,     ///< Default seconds between reports.
+    kDefaultPort        = 18080, ///< Default port of the web server.
+    kConnectTimeout     = 5000,  ///< Milliseconds the server is waited for before giving up.
+    kReceiveTimeout     = 5,     ///< Seconds a response is waited for before the connection is dropped.
+    kMaxHeaderSize      = 4096,  ///< Max bytes of the header of a response.
+};
+
+enum
+{
+    kKindStatic     = 1 << 0, ///< Static files of the frontend.
+    kKindProperties = 1 << 1, ///< The status of the network.
+    kKindNetworks   = 1 << 2, ///< The networks of the last scan.
+};
+
+struct Target
+{
+    unsigned int mKind;
+    const char * mPath;
+    Histogram *  mLatency;
+};
+
+static Histogram sStaticLatency("web_bench.static_latency_us");
+static Histogram sPropertiesLatency("web_bench.get_properties_latency_us");
+static Histogram sNetworksLatency("web_bench.available_network_latency_us");
+
+static const Target kTargets[] = {
+    {kKindStatic, "/", &sStaticLatency},
+    {kKindProperties, "/get_properties", &sPropertiesLatency},
+    {kKindStatic, "/res/js/app.js", &sStaticLatency},
+    {kKindNetworks, "/available_network", &sNetworksLatency},
+    {kKindStatic, "/res/css/styles.css", &sStaticLatency},
+    {kKindStatic, "/res/img/openthread_logo.png", &sStaticLatency},
+};
+
+static const Histogram *const kLatencies[] = {&sStaticLatency, &sPropertiesLatency, &sNetworksLatency};
+
+static std::atomic<bool>     sStopping(false);
+static std::atomic<uint64_t> sRequests(0);
+static std::atomic<uint64_t> sErrors(0);
+static std::atomic<uint64_t> sBytes(0);
+
+static int Connect(uint16_t aPort)
+{
+    int            fd      = socket(AF_INET, SOCK_STREAM, 0);
+    int            one     = 1;
+    struct timeval timeout = {kReceiveTimeout, 0};
+    sockaddr_in    addr;
+
+    VerifyOrExit(fd >= 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(aPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+
+exit:
+    return fd;
+}
+
+static bool WaitServer(uint16_t aPort)
+{
+    uint64_t deadline = GetMonotonicNowUs() + kConnectTimeout * 1000ULL;
+    int      fd;
+
+    while ((fd = Connect(aPort)) < 0 && GetMonotonicNowUs() < deadline)
+    {
+        usleep(10000);
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    return fd >= 0;
+}
+
+static bool SendAll(int aFd, const char *aData, size_t aLength)
+{
+    while (aLength > 0)
+    {
+        ssize_t sent = send(aFd, aData, aLength, MSG_NOSIGNAL);
+
+        if (sent <= 0)
+        {
+            break;
+        }
+
+        aData += sent;
+        aLength -= static_cast<size_t>(sent);
+    }
+
+    return aLength == 0;
+}
+
+/**
+ * This function sends a request and receives its response, whose body is skipped.
+ *
+ * @returns Whether a successful response was received, the connection can only be used again if so.
+ *
+ */
+static bool Request(int aFd, const char *aPath)
+{
+    char        buffer[kMaxHeaderSize + 1];
+    size_t      length = 0;
+    const char *end    = NULL;
+    size_t      body   = 0;
+    bool        ok     = false;
+    int         status = 0;
+    ssize_t     received;
+
+    snprintf(buffer, sizeof(buffer), "GET %s HTTP/1.1\r\nHost: localhost\r\nAccept-Encoding: gzip\r\n\r\n", aPath);
+    VerifyOrExit(SendAll(aFd, buffer, strlen(buffer)));
+
+    while (end == NULL)
+    {
+        VerifyOrExit(length < kMaxHeaderSize);
+        VerifyOrExit((received = recv(aFd, buffer + length, kMaxHeaderSize - length, 0)) > 0);
+        length += static_cast<size_t>(received);
+        buffer[length] = '\0';
+        end            = strstr(buffer, "\r\n\r\n");
+    }
+
+    VerifyOrExit(sscanf(buffer, "HTTP/1.%*d %d", &status) == 1 && status == 200);
+
+    // Responses not streamed carry their length, which is all the client needs to reuse the connection.
+    for (const char *line = strstr(buffer, "\r\n"); line != NULL && line < end; line = strstr(line + 2, "\r\n"))
+    {
+        if (strncasecmp(line + 2, "Content-Length:", sizeof("Content-Length:") - 1) == 0)
+        {
+            body = strtoul(line + 2 + sizeof("Content-Length:") - 1, NULL, 10);
+            break;
+        }
+    }
+
+    end += sizeof("\r\n\r\n") - 1;
+    sBytes += body;
+    VerifyOrExit(static_cast<size_t>(buffer + length - end) <= body);
+    body -= static_cast<size_t>(buffer + length - end);
+
+    while (body > 0)
+    {
+        VerifyOrExit((received = recv(aFd, buffer, body < sizeof(buffer) ? body : sizeof(buffer), 0)) > 0);
+        body -= static_cast<size_t>(received);
+    }
+
+    ok = true;
+
+exit:
+    return ok;
+}
+
+static void RunClient(uint16_t aPort, unsigned int aKinds, size_t aFirst)
+{
+    const size_t kCount = sizeof(kTargets) / sizeof(kTargets[0]);
+    int          fd     = -1;
+
+    for (size_t i = aFirst; !sStopping; ++i)
+    {
+        const Target &target = kTargets[i % kCount];
+        uint64_t      start;
+
+        if ((target.mKind & aKinds) == 0)
+        {
+            continue;
+        }
+
+        if (fd < 0 && (fd = Connect(aPort)) < 0)
+        {
+            sErrors++;
+            usleep(1000);
+            continue;
+        }
+
+        start = GetMonotonicNowUs();
+
+        if (Request(fd, target.mPath))
+        {
+            target.mLatency->Record(GetMonotonicNowUs() - start);
+            sRequests++;
+        }
+        else
+        {
+            sErrors++;
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+static unsigned long GetResidentSize(void)
+{
+    FILE *        file     = fopen("/proc/self/statm", "r");
+    unsigned long size     = 0;
+    unsigned long resident = 0;
+
+    if (file != NULL)
+    {
+        if (fscanf(file, "%lu %lu", &size, &resident) != 2)
+        {
+            resident = 0;
+        }
+
+        fclose(file);
+    }
+
+    return resident * static_cast<unsigned long>(sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+/**
+ * This function sums the buckets of all latencies, so that percentiles over an interval are the difference of sums.
+ *
+ */
+static void SumLatencies(std::vector<uint64_t> &aCounts)
+{
+    aCounts.assign(Histogram::kBuckets, 0);
+
+    for (size_t i = 0; i < sizeof(kLatencies) / sizeof(kLatencies[0]); ++i)
+    {
+        for (unsigned int bucket = 0; bucket < Histogram::kBuckets; ++bucket)
+        {
+            aCounts[bucket] += kLatencies[i]->GetBucketCount(bucket);
+        }
+    }
+}
+
+static uint64_t GetPercentile(const std::vector<uint64_t> &aCounts,
+                              const std::vector<uint64_t> &aPrevious,
+                              unsigned int                 aPercent)
+{
+    uint64_t count = 0;
+    uint64_t seen  = 0;
+    uint64_t rank;
+    uint64_t value = 0;
+
+    for (unsigned int bucket = 0; bucket < Histogram::kBuckets; ++bucket)
+    {
+        count += aCounts[bucket] - aPrevious[bucket];
+    }
+
+    rank = (count * aPercent + 99) / 100;
+    rank = rank > 0 ? rank : 1;
+
+    for (unsigned int bucket = 0; count > 0 && bucket < Histogram::kBuckets; ++bucket)
+    {
+        seen += aCounts[bucket] - aPrevious[bucket];
+
+        if (seen >= rank)
+        {
+            value = (bucket + 1 < Histogram::kBuckets) ? Histogram::GetBucketLowest(bucket + 1) - 1
+                                                       : Histogram::GetBucketLowest(bucket);
+            break;
+        }
+    }
+
+    return value;
+}
+
+static bool ParseKinds(const char *aKinds, unsigned int &aMask)
+{
+    std::string kinds(aKinds);
+    size_t      begin = 0;
+    bool        ok    = true;
+
+    aMask = 0;
+
+    while (ok && begin <= kinds.size())
+    {
+        size_t      end  = kinds.find(',', begin);
+        std::string kind = kinds.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+
+        if (kind == "static")
+        {
+            aMask |= kKindStatic;
+        }
+        else if (kind == "properties")
+        {
+            aMask |= kKindProperties;
+        }
+        else if (kind == "networks")
+        {
+            aMask |= kKindNetworks;
+        }
+        else
+        {
+            ok = false;
+        }
+
+        begin = (end == std::string::npos) ? kinds.size() + 1 : end + 1;
+    }
+
+    return ok && aMask != 0;
+}
+
+static void PrintUsage(const char *aProgram)
+{
+    fprintf(stderr,
+            "Usage: %s [-c CONNECTIONS] [-d DURATION_S] [-i INTERVAL_S] [-k KINDS] [-l GET_LATENCY_US]\n"
+            "       [-p PORT] [-s SCAN_LATENCY_US] [-t THREADS] [-w]\n"
+            "  KINDS is a comma separated list of static, properties and networks, all by default.\n"
+            "  -w lets the web server watch property changes, so that the status is served from its snapshot.\n",
+            aProgram);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int             connections = kDefaultConnections;
+    unsigned int             duration    = kDefaultDuration;
+    unsigned int             interval    = kDefaultInterval;
+    unsigned int             kinds       = kKindStatic | kKindProperties | kKindNetworks;
+    uint32_t                 getLatency  = 0;
+    uint32_t                 scanLatency = 0;
+    uint16_t                 port        = kDefaultPort;
+    int                      threads     = 1;
+    int                      ret         = EXIT_SUCCESS;
+    ot::Web::WebServer       server;
+    std::thread              serverThread;
+    std::vector<std::thread> clients;
+    std::vector<uint64_t>    counts, previous(Histogram::kBuckets, 0);
+    uint64_t                 start, lastRequests = 0, lastErrors = 0, lastBackend = 0;
+    int                      opt;
+
+    while ((opt = getopt(argc, argv, "c:d:i:k:l:p:s:t:w")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+            connections = static_cast<unsigned int>(atoi(optarg));
+            break;
+
+        case 'd':
+            duration = static_cast<unsigned int>(atoi(optarg));
+            break;
+
+        case 'i':
+            interval = static_cast<unsigned int>(atoi(optarg));
+            break;
+
+        case 'k':
+            VerifyOrExit(ParseKinds(optarg, kinds), PrintUsage(argv[0]), ret = EXIT_FAILURE);
+            break;
+
+        case 'l':
+            getLatency = static_cast<uint32_t>(atoi(optarg));
+            break;
+
+        case 'p':
+            port = static_cast<uint16_t>(atoi(optarg));
+            break;
+
+        case 's':
+            scanLatency = static_cast<uint32_t>(atoi(optarg));
+            break;
+
+        case 't':
+            threads = atoi(optarg);
+            break;
+
+        case 'w':
+            ot::Web::Bench::SetFakePropertyWatch(true);
+            break;
+
+        default:
+            PrintUsage(argv[0]);
+            ExitNow(ret = EXIT_FAILURE);
+        }
+    }
+
+    VerifyOrExit(connections > 0 && duration > 0 && interval > 0 && threads > 0, PrintUsage(argv[0]),
+                 ret = EXIT_FAILURE);
+
+    otbrLogInit("otbr-web-bench", OTBR_LOG_WARNING);
+    ot::Web::Bench::SetFakeLatency(getLatency, scanLatency);
+
+    server.SetThreadPoolSize(static_cast<size_t>(threads));
+    serverThread = std::thread([&server, port]() { server.StartWebServer("wpan0", port); });
+    VerifyOrExit(WaitServer(port), fprintf(stderr, "web server is not listening on port %u\n", port),
+                 ret = EXIT_FAILURE);
+
+    for (unsigned int i = 0; i < connections; ++i)
+    {
+        clients.push_back(std::thread(RunClient, port, kinds, static_cast<size_t>(i)));
+    }
+
+    printf("%8s %10s %8s %8s %8s %8s %10s %10s\n", "time_s", "req_per_s", "errors", "p50_us", "p90_us", "p99_us",
+           "rss_kb", "backend/s");
+
+    start = GetMonotonicNowUs();
+
+    for (unsigned int elapsed = interval; elapsed <= duration; elapsed += interval)
+    {
+        uint64_t requests, errors, backend, wakeup = start + elapsed * 1000000ULL, now;
+
+        while ((now = GetMonotonicNowUs()) < wakeup)
+        {
+            usleep(static_cast<useconds_t>(wakeup - now));
+        }
+
+        requests = sRequests;
+        errors   = sErrors;
+        backend  = ot::Web::Bench::GetFakeRequestCount();
+        SumLatencies(counts);
+
+        printf("%8u %10.1f %8llu %8llu %8llu %8llu %10lu %10.1f\n", elapsed,
+               static_cast<double>(requests - lastRequests) / interval,
+               static_cast<unsigned long long>(errors - lastErrors),
+               static_cast<unsigned long long>(GetPercentile(counts, previous, 50)),
+               static_cast<unsigned long long>(GetPercentile(counts, previous, 90)),
+               static_cast<unsigned long long>(GetPercentile(counts, previous, 99)), GetResidentSize(),
+               static_cast<double>(backend - lastBackend) / interval);
+        fflush(stdout);
+
+        lastRequests = requests;
+        lastErrors   = errors;
+        lastBackend  = backend;
+        previous.swap(counts);
+    }
+
+    sStopping = true;
+
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+        clients[i].join();
+    }
+
+    printf("\n%-40s %10s %8s %8s %8s\n", "latency", "requests", "p50_us", "p90_us", "p99_us");
+
+    for (size_t i = 0; i < sizeof(kLatencies) / sizeof(kLatencies[0]); ++i)
+    {
+        const Histogram &latency = *kLatencies[i];
+
+        printf("%-40s %10llu %8llu %8llu %8llu\n", latency.GetName(),
+               static_cast<unsigned long long>(latency.GetCount()),
+               static_cast<unsigned long long>(latency.GetPercentile(50)),
+               static_cast<unsigned long long>(latency.GetPercentile(90)),
+               static_cast<unsigned long long>(latency.GetPercentile(99)));
+    }
+
+    printf("\n%llu requests, %llu errors, %.1f MB received, %llu requests to wpantund\n",
+           static_cast<unsigned long long>(sRequests.load()), static_cast<unsigned long long>(sErrors.load()),
+           static_cast<double>(sBytes.load()) / 1e6,
+           static_cast<unsigned long long>(ot::Web::Bench::GetFakeRequestCount()));
+
+exit:
+    if (serverThread.joinable())
+    {
+        // The web server stops on SIGTERM, it handles the signal on its own thread.
+        kill(getpid(), SIGTERM);
+        serverThread.join();
+    }
+
+    otbrLogDeinit();
+
+    return ret;
+}
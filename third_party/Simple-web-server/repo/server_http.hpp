@@ -5,6 +5,7 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/functional/hash.hpp>
 
+#include <limits>
 #include <map>
 #include <unordered_map>
 #include <thread>
@@ -114,7 +115,8 @@ namespace SimpleWeb {
             unsigned short remote_endpoint_port;
             
         private:
-            Request(const socket_type &socket): content(streambuf) {
+            Request(const socket_type &socket, size_t max_request_streambuf_size=std::numeric_limits<size_t>::max()):
+                    content(streambuf), streambuf(max_request_streambuf_size) {
                 try {
                     remote_endpoint_address=socket.lowest_layer().remote_endpoint().address().to_string();
                     remote_endpoint_port=socket.lowest_layer().remote_endpoint().port();
@@ -138,6 +140,9 @@ namespace SimpleWeb {
             size_t timeout_request=5;
             /// Timeout on content handling. Defaults to 300 seconds.
             size_t timeout_content=300;
+            /// Maximum size of a request, header and content. Defaults to no limit.
+            /// Requests with a larger header are dropped, those with a larger content are answered 413.
+            size_t max_request_streambuf_size=std::numeric_limits<size_t>::max();
             /// IPv4 address in dotted decimal form or IPv6 address in hexadecimal notation.
             /// If empty, the address will be any address.
             std::string address;
@@ -253,7 +258,7 @@ namespace SimpleWeb {
         void read_request_and_content(const std::shared_ptr<socket_type> &socket) {
             //Create new streambuf (Request::streambuf) for async_read_until()
             //shared_ptr is used to pass temporary objects to the asynchronous functions
-            std::shared_ptr<Request> request(new Request(*socket));
+            std::shared_ptr<Request> request(new Request(*socket, config.max_request_streambuf_size));
 
             //Set timeout on the following boost::asio::async-read or write function
             auto timer=this->get_timeout_timer(socket, config.timeout_request);
@@ -284,6 +289,13 @@ namespace SimpleWeb {
                                 on_error(request, boost::system::error_code(boost::system::errc::protocol_error, boost::system::generic_category()));
                             return;
                         }
+                        if(content_length>request->streambuf.max_size()) {
+                            //The connection is closed once the response is sent, the content is not read
+                            auto response=std::shared_ptr<Response>(new Response(socket));
+                            *response << "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                            this->send(response);
+                            return;
+                        }
                         if(content_length>num_additional_bytes) {
                             //Set timeout on the following boost::asio::async-read or write function
                             auto timer=this->get_timeout_timer(socket, config.timeout_content);
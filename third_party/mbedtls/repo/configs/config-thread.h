@@ -86,6 +86,14 @@
 /* Save ROM and a few bytes of RAM by specifying our own ciphersuite list */
 #define MBEDTLS_SSL_CIPHERSUITES MBEDTLS_TLS_ECJPAKE_WITH_AES_128_CCM_8
 
+/* Let the border agent provide EC-JPAKE first round messages precomputed off the handshake path */
+#define MBEDTLS_ECJPAKE_ROUND_ONE_HOOK
+
+/* Alternative implementations, e.g. of a crypto engine, selected at configure time */
+#if defined(MBEDTLS_USER_CONFIG_FILE)
+#include MBEDTLS_USER_CONFIG_FILE
+#endif
+
 #include "mbedtls/check_config.h"
 
 #endif /* MBEDTLS_CONFIG_H */
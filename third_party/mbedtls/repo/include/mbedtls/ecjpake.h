@@ -146,6 +146,29 @@ int mbedtls_ecjpake_write_round_one( mbedtls_ecjpake_context *ctx,
                             int (*f_rng)(void *, unsigned char *, size_t),
                             void *p_rng );
 
+#if defined(MBEDTLS_ECJPAKE_ROUND_ONE_HOOK)
+/**
+ * \brief           Set a function providing first round messages generated
+ *                  ahead of time, e.g. from a pool of precomputed keys
+ *
+ * \note            The function is shared by all contexts, and may be called
+ *                  from several threads at once.
+ *
+ * \param f_hook    Function called by mbedtls_ecjpake_write_round_one() with
+ *                  p_hook, the context, buf, len and olen. It either sets
+ *                  the private and public keys of the context, writes the
+ *                  message and returns 0, or returns
+ *                  MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE to have the keys
+ *                  generated. NULL to always generate them.
+ * \param p_hook    Parameter of f_hook
+ */
+void mbedtls_ecjpake_set_round_one_hook( int (*f_hook)( void *,
+                                                        mbedtls_ecjpake_context *,
+                                                        unsigned char *, size_t,
+                                                        size_t * ),
+                                         void *p_hook );
+#endif /* MBEDTLS_ECJPAKE_ROUND_ONE_HOOK */
+
 /**
  * \brief           Read and process the first round message
  *                  (TLS: contents of the Client/ServerHello extension,
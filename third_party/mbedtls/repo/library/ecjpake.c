@@ -508,6 +508,25 @@ int mbedtls_ecjpake_read_round_one( mbedtls_ecjpake_context *ctx,
                                buf, len ) );
 }
 
+#if defined(MBEDTLS_ECJPAKE_ROUND_ONE_HOOK)
+static int (*ecjpake_round_one_hook)( void *, mbedtls_ecjpake_context *,
+                                      unsigned char *, size_t, size_t * );
+static void *ecjpake_round_one_hook_ctx;
+
+/*
+ * Set the provider of first round messages generated ahead of time
+ */
+void mbedtls_ecjpake_set_round_one_hook( int (*f_hook)( void *,
+                                                        mbedtls_ecjpake_context *,
+                                                        unsigned char *, size_t,
+                                                        size_t * ),
+                                         void *p_hook )
+{
+    ecjpake_round_one_hook_ctx = p_hook;
+    ecjpake_round_one_hook = f_hook;
+}
+#endif /* MBEDTLS_ECJPAKE_ROUND_ONE_HOOK */
+
 /*
  * Generate and write the first round message
  */
@@ -516,6 +535,17 @@ int mbedtls_ecjpake_write_round_one( mbedtls_ecjpake_context *ctx,
                             int (*f_rng)(void *, unsigned char *, size_t),
                             void *p_rng )
 {
+#if defined(MBEDTLS_ECJPAKE_ROUND_ONE_HOOK)
+    if( ecjpake_round_one_hook != NULL )
+    {
+        int ret = ecjpake_round_one_hook( ecjpake_round_one_hook_ctx, ctx,
+                                          buf, len, olen );
+
+        if( ret != MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE )
+            return( ret );
+    }
+#endif /* MBEDTLS_ECJPAKE_ROUND_ONE_HOOK */
+
     return( ecjpake_kkpp_write( ctx->md_info, &ctx->grp, ctx->point_format,
                                 &ctx->grp.G,
                                 &ctx->xm1, &ctx->Xm1, &ctx->xm2, &ctx->Xm2,
@@ -0,0 +1,525 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements a tool comparing two result files of otbr-benchmark.
+ *
+ * A benchmark regresses when its median time per operation grows by more than the threshold, and the samples of its
+ * repetitions are slower with significance, by a one-sided Mann-Whitney U test. Files without samples fall back to
+ * requiring the ranges of repetitions not to overlap.
+ */
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common/code_utils.hpp"
+
+enum
+{
+    kExitRegression = 1,  ///< Exit status when a benchmark regressed.
+    kExitError      = 2,  ///< Exit status when a file cannot be compared.
+    kMaxExactSize   = 20, ///< Max repetitions of either file for the exact distribution of U.
+};
+
+struct Benchmark
+{
+    double              mNsPerOp;
+    double              mMin;
+    double              mMax;
+    std::vector<double> mSamples;
+};
+
+typedef std::map<std::string, Benchmark> Results;
+
+/**
+ * This class parses the JSON written by otbr-benchmark, values other than the benchmarks are skipped.
+ *
+ */
+class Parser
+{
+public:
+    explicit Parser(const std::string &aText)
+        : mText(aText)
+        , mPosition(0)
+    {
+    }
+
+    bool Parse(Results &aResults)
+    {
+        bool        ok = false;
+        std::string key;
+
+        VerifyOrExit(Consume('{'));
+
+        do
+        {
+            VerifyOrExit(ParseString(key) && Consume(':'));
+
+            if (key == "benchmarks")
+            {
+                VerifyOrExit(ParseBenchmarks(aResults));
+            }
+            else
+            {
+                VerifyOrExit(SkipValue());
+            }
+        } while (Consume(','));
+
+        ok = Consume('}');
+
+    exit:
+        return ok;
+    }
+
+    size_t GetPosition(void) const { return mPosition; }
+
+private:
+    bool ParseBenchmarks(Results &aResults)
+    {
+        bool ok = false;
+
+        VerifyOrExit(Consume('['));
+        VerifyOrExit(!Consume(']'), ok = true);
+
+        do
+        {
+            std::string name, key;
+            Benchmark   benchmark;
+
+            benchmark.mNsPerOp = benchmark.mMin = benchmark.mMax = -1;
+            VerifyOrExit(Consume('{'));
+
+            do
+            {
+                VerifyOrExit(ParseString(key) && Consume(':'));
+
+                if (key == "name")
+                {
+                    VerifyOrExit(ParseString(name));
+                }
+                else if (key == "ns_per_op")
+                {
+                    VerifyOrExit(ParseNumber(benchmark.mNsPerOp));
+                }
+                else if (key == "min_ns_per_op")
+                {
+                    VerifyOrExit(ParseNumber(benchmark.mMin));
+                }
+                else if (key == "max_ns_per_op")
+                {
+                    VerifyOrExit(ParseNumber(benchmark.mMax));
+                }
+                else if (key == "samples_ns_per_op")
+                {
+                    VerifyOrExit(ParseSamples(benchmark.mSamples));
+                }
+                else
+                {
+                    VerifyOrExit(SkipValue());
+                }
+            } while (Consume(','));
+
+            VerifyOrExit(Consume('}') && !name.empty() && benchmark.mNsPerOp >= 0);
+            benchmark.mMin    = benchmark.mMin < 0 ? benchmark.mNsPerOp : benchmark.mMin;
+            benchmark.mMax    = benchmark.mMax < 0 ? benchmark.mNsPerOp : benchmark.mMax;
+            aResults[name] = benchmark;
+        } while (Consume(','));
+
+        ok = Consume(']');
+
+    exit:
+        return ok;
+    }
+
+    bool ParseSamples(std::vector<double> &aSamples)
+    {
+        bool   ok = false;
+        double sample;
+
+        VerifyOrExit(Consume('['));
+        VerifyOrExit(!Consume(']'), ok = true);
+
+        do
+        {
+            VerifyOrExit(ParseNumber(sample));
+            aSamples.push_back(sample);
+        } while (Consume(','));
+
+        ok = Consume(']');
+
+    exit:
+        return ok;
+    }
+
+    bool Consume(char aChar)
+    {
+        bool consumed;
+
+        SkipSpace();
+        consumed = (mPosition < mText.size() && mText[mPosition] == aChar);
+        mPosition += consumed ? 1 : 0;
+
+        return consumed;
+    }
+
+    void SkipSpace(void)
+    {
+        while (mPosition < mText.size() && strchr(" \t\r\n", mText[mPosition]) != NULL)
+        {
+            mPosition++;
+        }
+    }
+
+    bool ParseString(std::string &aString)
+    {
+        bool ok = false;
+
+        aString.clear();
+        VerifyOrExit(Consume('"'));
+
+        for (; mPosition < mText.size() && mText[mPosition] != '"'; ++mPosition)
+        {
+            // Escapes are kept as they are, names of benchmarks do not have any.
+            if (mText[mPosition] == '\\' && mPosition + 1 < mText.size())
+            {
+                aString += mText[mPosition++];
+            }
+
+            aString += mText[mPosition];
+        }
+
+        VerifyOrExit(mPosition < mText.size());
+        mPosition++;
+        ok = true;
+
+    exit:
+        return ok;
+    }
+
+    bool ParseNumber(double &aNumber)
+    {
+        const char *begin;
+        char *      end;
+
+        SkipSpace();
+        begin   = mText.c_str() + mPosition;
+        aNumber = strtod(begin, &end);
+        mPosition += static_cast<size_t>(end - begin);
+
+        return end != begin;
+    }
+
+    bool SkipValue(void)
+    {
+        bool        ok = false;
+        std::string string;
+        double      number;
+
+        SkipSpace();
+        VerifyOrExit(mPosition < mText.size());
+
+        switch (mText[mPosition])
+        {
+        case '"':
+            ok = ParseString(string);
+            break;
+
+        case '{':
+        case '[':
+        {
+            char close = (mText[mPosition] == '{') ? '}' : ']';
+
+            mPosition++;
+            VerifyOrExit(!Consume(close), ok = true);
+
+            do
+            {
+                if (close == '}')
+                {
+                    VerifyOrExit(ParseString(string) && Consume(':'));
+                }
+
+                VerifyOrExit(SkipValue());
+            } while (Consume(','));
+
+            ok = Consume(close);
+            break;
+        }
+
+        default:
+            if (mText.compare(mPosition, 4, "true") == 0 || mText.compare(mPosition, 4, "null") == 0)
+            {
+                mPosition += 4;
+                ok = true;
+            }
+            else if (mText.compare(mPosition, 5, "false") == 0)
+            {
+                mPosition += 5;
+                ok = true;
+            }
+            else
+            {
+                ok = ParseNumber(number);
+            }
+            break;
+        }
+
+    exit:
+        return ok;
+    }
+
+    const std::string &mText;
+    size_t             mPosition;
+};
+
+static bool Load(const char *aPath, Results &aResults)
+{
+    FILE *      file = fopen(aPath, "r");
+    std::string text;
+    char        buffer[4096];
+    size_t      length;
+    bool        ok = false;
+
+    VerifyOrExit(file != NULL, perror(aPath));
+
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        text.append(buffer, length);
+    }
+
+    {
+        Parser parser(text);
+
+        VerifyOrExit(parser.Parse(aResults),
+                     fprintf(stderr, "%s: invalid benchmark results at offset %zu\n", aPath, parser.GetPosition()));
+    }
+
+    ok = true;
+
+exit:
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+
+    return ok;
+}
+
+/**
+ * This function returns the probability that U is at least @p aU when samples of both sizes come from the same
+ * distribution, exactly for small sizes, normally approximated otherwise.
+ *
+ */
+static double GetUpperTail(size_t aSize1, size_t aSize2, double aU)
+{
+    double p;
+
+    if (aSize1 <= kMaxExactSize && aSize2 <= kMaxExactSize)
+    {
+        // counts[i][u] is the number of orderings of i samples of the first size and j of the second with U = u,
+        // computed over j by counts(i, j, u) = counts(i - 1, j, u - j) + counts(i, j - 1, u).
+        size_t                            maxU = aSize1 * aSize2;
+        std::vector<std::vector<double> > counts(aSize1 + 1, std::vector<double>(maxU + 1, 0));
+        double                            total = 0;
+        double                            tail  = 0;
+
+        for (size_t i = 0; i <= aSize1; ++i)
+        {
+            counts[i][0] = 1;
+        }
+
+        for (size_t j = 1; j <= aSize2; ++j)
+        {
+            for (size_t i = 1; i <= aSize1; ++i)
+            {
+                for (size_t u = maxU; u >= j; --u)
+                {
+                    counts[i][u] = counts[i - 1][u - j] + counts[i][u];
+                }
+            }
+        }
+
+        for (size_t u = 0; u <= maxU; ++u)
+        {
+            total += counts[aSize1][u];
+            tail += (u + 0.25 >= aU) ? counts[aSize1][u] : 0;
+        }
+
+        p = tail / total;
+    }
+    else
+    {
+        double mean  = aSize1 * aSize2 / 2.0;
+        double sigma = sqrt(aSize1 * aSize2 * (aSize1 + aSize2 + 1) / 12.0);
+
+        p = 0.5 * erfc((aU - 0.5 - mean) / (sigma * sqrt(2.0)));
+    }
+
+    return p;
+}
+
+/**
+ * This function returns the p-value of the current samples being slower than the baseline ones.
+ *
+ */
+static double GetSlowerPValue(const std::vector<double> &aBaseline, const std::vector<double> &aCurrent)
+{
+    double u = 0;
+
+    // U counts the pairs where the current sample is slower, ties count half.
+    for (size_t i = 0; i < aCurrent.size(); ++i)
+    {
+        for (size_t j = 0; j < aBaseline.size(); ++j)
+        {
+            u += (aCurrent[i] > aBaseline[j]) ? 1 : (aCurrent[i] == aBaseline[j] ? 0.5 : 0);
+        }
+    }
+
+    return GetUpperTail(aCurrent.size(), aBaseline.size(), u);
+}
+
+static void PrintUsage(const char *aProgram)
+{
+    fprintf(stderr,
+            "Usage: %s [-a ALPHA] [-t THRESHOLD_PERCENT] BASELINE.json CURRENT.json\n"
+            "  Compares results of otbr-benchmark, exits with %d if any benchmark regressed, %d on errors.\n"
+            "  ALPHA is the significance level, 0.05 by default, THRESHOLD_PERCENT the change of the median time\n"
+            "  per operation that matters, 5 by default.\n",
+            aProgram, kExitRegression, kExitError);
+}
+
+int main(int argc, char *argv[])
+{
+    double       alpha     = 0.05;
+    double       threshold = 5;
+    Results      baseline, current;
+    unsigned int regressions = 0, improvements = 0, compared = 0;
+    int          ret         = EXIT_SUCCESS;
+    int          opt;
+
+    while ((opt = getopt(argc, argv, "a:t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'a':
+            alpha = atof(optarg);
+            break;
+
+        case 't':
+            threshold = atof(optarg);
+            break;
+
+        default:
+            PrintUsage(argv[0]);
+            ExitNow(ret = kExitError);
+        }
+    }
+
+    VerifyOrExit(optind + 2 == argc && alpha > 0 && alpha < 1 && threshold >= 0, PrintUsage(argv[0]),
+                 ret = kExitError);
+    VerifyOrExit(Load(argv[optind], baseline) && Load(argv[optind + 1], current), ret = kExitError);
+
+    printf("%-40s %12s %12s %9s %8s  %s\n", "benchmark", "baseline_ns", "current_ns", "change", "p_value", "verdict");
+
+    for (Results::const_iterator it = current.begin(); it != current.end(); ++it)
+    {
+        Results::const_iterator base = baseline.find(it->first);
+        const Benchmark &       now  = it->second;
+        const char *            verdict;
+        double                  change;
+        double                  slower = -1, faster = -1;
+        char                    pValue[16];
+
+        if (base == baseline.end())
+        {
+            printf("%-40s %12s %12.2f %9s %8s  %s\n", it->first.c_str(), "-", now.mNsPerOp, "-", "-", "added");
+            continue;
+        }
+
+        compared++;
+        change = (base->second.mNsPerOp > 0) ? (now.mNsPerOp / base->second.mNsPerOp - 1) * 100 : 0;
+
+        if (!base->second.mSamples.empty() && !now.mSamples.empty())
+        {
+            slower = GetSlowerPValue(base->second.mSamples, now.mSamples);
+            faster = GetSlowerPValue(now.mSamples, base->second.mSamples);
+            snprintf(pValue, sizeof(pValue), "%.4f", change >= 0 ? slower : faster);
+        }
+        else
+        {
+            // Without samples, only changes beyond the range of repetitions are significant.
+            slower = (now.mMin > base->second.mMax) ? 0 : 1;
+            faster = (now.mMax < base->second.mMin) ? 0 : 1;
+            snprintf(pValue, sizeof(pValue), "-");
+        }
+
+        if (change > threshold && slower < alpha)
+        {
+            verdict = "REGRESSION";
+            regressions++;
+        }
+        else if (change < -threshold && faster < alpha)
+        {
+            verdict = "improved";
+            improvements++;
+        }
+        else
+        {
+            verdict = "ok";
+        }
+
+        printf("%-40s %12.2f %12.2f %+8.1f%% %8s  %s\n", it->first.c_str(), base->second.mNsPerOp, now.mNsPerOp,
+               change, pValue, verdict);
+    }
+
+    for (Results::const_iterator it = baseline.begin(); it != baseline.end(); ++it)
+    {
+        if (current.find(it->first) == current.end())
+        {
+            printf("%-40s %12.2f %12s %9s %8s  %s\n", it->first.c_str(), it->second.mNsPerOp, "-", "-", "-",
+                   "removed");
+        }
+    }
+
+    printf("\n%u compared, %u regressed, %u improved, threshold %.1f%%, alpha %.3f\n", compared, regressions,
+           improvements, threshold, alpha);
+
+    ret = (regressions > 0) ? kExitRegression : EXIT_SUCCESS;
+
+exit:
+    return ret;
+}
@@ -1,8 +1,13 @@
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
 
 #include "common/code_utils.hpp"
 #include "pskc-generator/pskc.hpp"
 #include "utils/hex.hpp"
+#include "web-service/json_stream.hpp"
 
 /**
  * Constants.
@@ -12,6 +17,19 @@ enum
     kMaxNetworkName = 16,
     kMaxPassphrase  = 255,
     kSizeExtPanId   = 8,
+    kBatchSize      = 256, ///< Number of lines computed before their results are written.
+};
+
+/**
+ * This structure keeps a line of a batch.
+ *
+ */
+struct BatchLine
+{
+    std::string mPassphrase;
+    std::string mExtPanId;
+    std::string mNetworkName;
+    char        mError[64]; ///< The error of the line, empty if valid.
 };
 
 void help(void)
@@ -19,55 +37,212 @@ void help(void)
     printf("pskc - generate PSKc\n"
            "SYNTAX:\n"
            "    pskc <PASSPHRASE> <EXTPANID> <NETWORK_NAME>\n"
+           "    pskc --batch [THREADS]\n"
+           "        Read lines of PASSPHRASE,EXTPANID,NETWORK_NAME or JSON objects with passphrase, extPanId and\n"
+           "        networkName from stdin, and write the PSKc, or error, of each line in order. Passphrases with\n"
+           "        commas must be given as JSON. THREADS defaults to the number of CPUs.\n"
            "EXAMPLE:\n"
-           "    pskc 654321 1122334455667788 OpenThread\n");
+           "    pskc 654321 1122334455667788 OpenThread\n"
+           "    echo '{\"passphrase\":\"654321\",\"extPanId\":\"1122334455667788\",\"networkName\":\"OpenThread\"}' | "
+           "pskc --batch\n");
 }
 
-int printPSKc(const char *aPassphrase, const char *aExtPanId, const char *aNetworkName)
+bool checkInput(const char *aPassphrase,
+                const char *aExtPanId,
+                const char *aNetworkName,
+                uint8_t *   aExtPanIdBytes,
+                char *      aError,
+                size_t      aErrorSize)
 {
-    uint8_t extpanid[kSizeExtPanId];
-    size_t  length;
-    int     ret = -1;
-
-    ot::Psk::Pskc  pskcComputer;
-    const uint8_t *pskc;
+    size_t length;
+    bool   ok = false;
 
     length = strlen(aPassphrase);
-    VerifyOrExit(length > 0, printf("PASSPHRASE must not be empty.\n"));
+    VerifyOrExit(length > 0, snprintf(aError, aErrorSize, "PASSPHRASE must not be empty."));
     VerifyOrExit(length <= kMaxPassphrase,
-                 printf("PASSPHRASE Passphrase must be no more than %d bytes.\n", kMaxPassphrase));
+                 snprintf(aError, aErrorSize, "PASSPHRASE must be no more than %d bytes.", kMaxPassphrase));
 
     length = strlen(aExtPanId);
-    VerifyOrExit(length == kSizeExtPanId * 2, printf("EXTPANID length must be %d bytes.\n", kSizeExtPanId));
+    VerifyOrExit(length == kSizeExtPanId * 2,
+                 snprintf(aError, aErrorSize, "EXTPANID length must be %d bytes.", kSizeExtPanId));
     for (size_t i = 0; i < length; i++)
     {
         VerifyOrExit((aExtPanId[i] <= '9' && aExtPanId[i] >= '0') || (aExtPanId[i] <= 'f' && aExtPanId[i] >= 'a') ||
                          (aExtPanId[i] <= 'F' && aExtPanId[i] >= 'A'),
-                     printf("EXTPANID must be encoded in hex.\n"));
+                     snprintf(aError, aErrorSize, "EXTPANID must be encoded in hex."));
     }
-    ot::Utils::Hex2Bytes(aExtPanId, extpanid, sizeof(extpanid));
+    ot::Utils::Hex2Bytes(aExtPanId, aExtPanIdBytes, kSizeExtPanId);
 
     length = strlen(aNetworkName);
-    VerifyOrExit(length > 0, printf("NETWORK_NAME must not be empty.\n"));
+    VerifyOrExit(length > 0, snprintf(aError, aErrorSize, "NETWORK_NAME must not be empty."));
     VerifyOrExit(length <= kMaxNetworkName,
-                 printf("NETWOR_KNAME length must be no more than %d bytes.\n", kMaxNetworkName));
+                 snprintf(aError, aErrorSize, "NETWORK_NAME length must be no more than %d bytes.", kMaxNetworkName));
 
-    pskc = pskcComputer.ComputePskc(extpanid, aNetworkName, aPassphrase);
-    for (int i = 0; i < 16; i++)
+    aError[0] = '\0';
+    ok        = true;
+
+exit:
+    return ok;
+}
+
+void printHex(const uint8_t *aPskc)
+{
+    for (int i = 0; i < OT_PSKC_LENGTH; i++)
     {
-        printf("%02x", pskc[i]);
+        printf("%02x", aPskc[i]);
     }
     printf("\n");
+}
+
+int printPSKc(const char *aPassphrase, const char *aExtPanId, const char *aNetworkName)
+{
+    uint8_t extpanid[kSizeExtPanId];
+    char    error[sizeof(BatchLine().mError)];
+    int     ret = -1;
+
+    ot::Psk::Pskc pskcComputer;
+
+    VerifyOrExit(checkInput(aPassphrase, aExtPanId, aNetworkName, extpanid, error, sizeof(error)),
+                 printf("%s\n", error));
+
+    printHex(pskcComputer.ComputePskc(extpanid, aNetworkName, aPassphrase));
     ret = 0;
 
 exit:
     return ret;
 }
 
+bool parseLine(const std::string &aLine, BatchLine &aBatchLine)
+{
+    bool ok = false;
+
+    if (!aLine.empty() && aLine[0] == '{')
+    {
+        const ot::Web::JsonReader::Field kFields[] = {
+            {"passphrase", ot::Web::JsonReader::kTypeString, &aBatchLine.mPassphrase},
+            {"extPanId", ot::Web::JsonReader::kTypeString, &aBatchLine.mExtPanId},
+            {"networkName", ot::Web::JsonReader::kTypeString, &aBatchLine.mNetworkName},
+        };
+
+        ok = ot::Web::JsonReader::Parse(aLine.data(), aLine.size(), kFields, sizeof(kFields) / sizeof(kFields[0]));
+    }
+    else
+    {
+        // The network name is the last field, so that it may contain commas.
+        size_t first  = aLine.find(',');
+        size_t second = (first == std::string::npos) ? first : aLine.find(',', first + 1);
+
+        VerifyOrExit(second != std::string::npos);
+        aBatchLine.mPassphrase.assign(aLine, 0, first);
+        aBatchLine.mExtPanId.assign(aLine, first + 1, second - first - 1);
+        aBatchLine.mNetworkName.assign(aLine, second + 1, std::string::npos);
+        ok = true;
+    }
+
+exit:
+    return ok;
+}
+
+int computeBatch(std::vector<BatchLine> &aLines, size_t aCount, unsigned int aThreads)
+{
+    std::vector<ot::Psk::Pskc::BatchItem> items;
+    size_t                                next = 0;
+    int                                   ret  = 0;
+
+    for (size_t i = 0; i < aCount; i++)
+    {
+        BatchLine &              line = aLines[i];
+        ot::Psk::Pskc::BatchItem item;
+
+        if (line.mError[0] == '\0' && checkInput(line.mPassphrase.c_str(), line.mExtPanId.c_str(),
+                                                 line.mNetworkName.c_str(), item.mExtPanId, line.mError,
+                                                 sizeof(line.mError)))
+        {
+            item.mPassphrase  = line.mPassphrase.c_str();
+            item.mNetworkName = line.mNetworkName.c_str();
+            items.push_back(item);
+        }
+    }
+
+    if (!items.empty())
+    {
+        ot::Psk::Pskc::ComputeBatch(&items[0], items.size(), aThreads);
+    }
+
+    // Results are written in the order of the lines, errors take the place of their PSKc.
+    for (size_t i = 0; i < aCount; i++)
+    {
+        if (aLines[i].mError[0] != '\0')
+        {
+            printf("error: %s\n", aLines[i].mError);
+            ret = -1;
+        }
+        else
+        {
+            printHex(items[next++].mPskc);
+        }
+    }
+
+    fflush(stdout);
+
+    return ret;
+}
+
+int printBatch(unsigned int aThreads)
+{
+    std::vector<BatchLine> lines(kBatchSize);
+    std::string            line;
+    size_t                 count = 0;
+    int                    c;
+    int                    ret = 0;
+
+    while ((c = getchar()) != EOF || !line.empty())
+    {
+        if (c != EOF && c != '\n')
+        {
+            line += static_cast<char>(c);
+            continue;
+        }
+
+        if (!line.empty() && line[line.size() - 1] == '\r')
+        {
+            line.erase(line.size() - 1);
+        }
+
+        lines[count].mError[0] = '\0';
+        if (!parseLine(line, lines[count]))
+        {
+            snprintf(lines[count].mError, sizeof(lines[count].mError), "invalid line.");
+        }
+        line.clear();
+
+        if (++count == kBatchSize)
+        {
+            ret |= computeBatch(lines, count, aThreads);
+            count = 0;
+        }
+
+        if (c == EOF)
+        {
+            break;
+        }
+    }
+
+    ret |= computeBatch(lines, count, aThreads);
+
+    return ret;
+}
+
 int main(int argc, char *argv[])
 {
     int ret = 0;
 
+    if (argc >= 2 && strcmp(argv[1], "--batch") == 0)
+    {
+        VerifyOrExit(argc <= 3 && (argc == 2 || atoi(argv[2]) > 0), help(), ret = -1);
+        ExitNow(ret = printBatch(argc == 3 ? static_cast<unsigned int>(atoi(argv[2])) : 0));
+    }
+
     VerifyOrExit(argc == 4, help(), ret = -1);
     ret = printPSKc(argv[1], argv[2], argv[3]);
 